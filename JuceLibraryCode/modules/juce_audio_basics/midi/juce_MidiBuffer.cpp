@@ -120,19 +120,45 @@ void MidiBuffer::addEvent (const void* const newData, const int maxBytes, const
     const int numBytes = maxBytes;
     // =======================================================================
 
+    if (uint8* const d = reserveEvent (numBytes, sampleNumber))
+        memcpy (d, newData, (size_t) numBytes);
+}
+
+// <Open-Ephys>
+// Added by Open-Ephys.
+// =======================================================================
+uint8* MidiBuffer::reserveEvent (const int numBytes, const int sampleNumber)
+{
+    if (numBytes <= 0)
+        return nullptr;
+
+    const size_t newItemSize = (size_t) numBytes + sizeof (int32) + sizeof (uint16);
+    const int offset = (int) (MidiBufferHelpers::findEventAfter (data.begin(), data.end(), sampleNumber) - data.begin());
+
+    data.insertMultiple (offset, 0, (int) newItemSize);
+
+    uint8* const d = data.begin() + offset;
+    writeUnaligned<int32>  (d, sampleNumber);
+    writeUnaligned<uint16> (d + 4, static_cast<uint16> (numBytes));
+    return d + 6;
+}
+
+void MidiBuffer::appendEvent (const void* const rawData, const int numBytes, const int sampleNumber)
+{
+    jassert (sampleNumber >= getLastEventTime());
+
     if (numBytes > 0)
     {
-        const size_t newItemSize = (size_t) numBytes + sizeof (int32) + sizeof (uint16);
-        const int offset = (int) (MidiBufferHelpers::findEventAfter (data.begin(), data.end(), sampleNumber) - data.begin());
-
-        data.insertMultiple (offset, 0, (int) newItemSize);
+        const int offset = data.size();
+        data.insertMultiple (offset, 0, numBytes + (int) (sizeof (int32) + sizeof (uint16)));
 
         uint8* const d = data.begin() + offset;
         writeUnaligned<int32>  (d, sampleNumber);
         writeUnaligned<uint16> (d + 4, static_cast<uint16> (numBytes));
-        memcpy (d + 6, newData, (size_t) numBytes);
+        memcpy (d + 6, rawData, (size_t) numBytes);
     }
 }
+// =======================================================================
 
 void MidiBuffer::addEvents (const MidiBuffer& otherBuffer,
                             const int startSample,
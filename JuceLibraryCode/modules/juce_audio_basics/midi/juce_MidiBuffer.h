@@ -116,6 +116,24 @@ public:
                    int maxBytesOfMidiData,
                    int sampleNumber);
 
+    // <Open-Ephys>
+    // Added by Open-Ephys.
+    // =======================================================================
+    /** Makes room for an event of numBytes bytes at the given sample position and
+        returns a pointer to its (zeroed) data, so that it can be written in place
+        instead of being built in a temporary block and copied. Events are ordered
+        as with addEvent(). The pointer is only valid until the buffer is modified
+        again. Returns nullptr if numBytes is not positive.
+    */
+    uint8* reserveEvent (int numBytes, int sampleNumber);
+
+    /** Adds an event at the end of the buffer without searching for its position.
+        The sample number must not be lower than that of the last event already in
+        the buffer; use it when merging or copying events that are already sorted.
+    */
+    void appendEvent (const void* rawData, int numBytes, int sampleNumber);
+    // =======================================================================
+
     /** Adds some events from another buffer to this one.
 
         @param otherBuffer          the buffer containing the events you want to add
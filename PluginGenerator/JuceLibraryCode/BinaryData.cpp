@@ -304,8 +304,720 @@ static const unsigned char temp_binary_data_1[] =
 
 const char* OE_GUI_MoonShard_h = (const char*) temp_binary_data_1;
 
+//================== openEphys_BlockProcessorBenchmark.example ==================
+static const unsigned char temp_binary_data_2[] =
+"\r\n"
+"#Runs the processor benchmark of the GUI on this plugin, for a few channel counts and block\r\n"
+"#sizes, once the plugin is built and installed, e.g.\r\n"
+"#make benchmark OPENEPHYS=../../Build/Release/open-ephys BENCHMARK_OPTIONS=\"channels=384 blocks=1024\"\r\n"
+"OPENEPHYS ?= open-ephys\r\n"
+"BENCHMARK_OPTIONS ?= channels=16,64,256 blocks=256,1024\r\n"
+"\r\n"
+".PHONY: benchmark\r\n"
+"\r\n"
+"benchmark: $(OUTDIR)/$(TARGET)\r\n"
+"\t@echo \"Benchmarking BENCHMARKPROCESSORNAME\"\r\n"
+"\t@$(OPENEPHYS) --benchmark-processors processors=BENCHMARKPROCESSORNAME $(BENCHMARK_OPTIONS)\r\n";
+
+const char* openEphys_BlockProcessorBenchmark_example = (const char*) temp_binary_data_2;
+
+//================== openEphys_BlockProcessorPluginTemplate.cpp ==================
+static const unsigned char temp_binary_data_3[] =
+"/*\r\n"
+"    ------------------------------------------------------------------\r\n"
+"\r\n"
+"    This file is part of the Open Ephys GUI\r\n"
+"    Copyright (C) 2016 Open Ephys\r\n"
+"\r\n"
+"    ------------------------------------------------------------------\r\n"
+"\r\n"
+"    This program is free software: you can redistribute it and/or modify\r\n"
+"    it under the terms of the GNU General Public License as published by\r\n"
+"    the Free Software Foundation, either version 3 of the License, or\r\n"
+"    (at your option) any later version.\r\n"
+"\r\n"
+"    This program is distributed in the hope that it will be useful,\r\n"
+"    but WITHOUT ANY WARRANTY; without even the implied warranty of\r\n"
+"    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the\r\n"
+"    GNU General Public License for more details.\r\n"
+"\r\n"
+"    You should have received a copy of the GNU General Public License\r\n"
+"    along with this program.  If not, see <http://www.gnu.org/licenses/>.\r\n"
+"\r\n"
+"*/\r\n"
+"\r\n"
+"\r\n"
+"#include <stdio.h>\r\n"
+"\r\n"
+"PROCESSORHEADERS\r\n"
+"\r\n"
+"\r\n"
+"PROCESSORCLASSNAME::PROCESSORCLASSNAME()\r\n"
+"    : GenericProcessor (\"PLUGINGUINAME\")\r\n"
+"    , mailboxChanged (true)\r\n"
+"    , displayFifo (DISPLAY_RING_FRAMES)\r\n"
+"    , numDisplayChannels (0)\r\n"
+"    , numDroppedDisplayFrames (0)\r\n"
+"{\r\n"
+"    setProcessorType (PROCESSORTYPE);\r\n"
+"\r\n"
+"    // Open Ephys Plugin Generator will insert generated code for parameters here. Don't edit this section.\r\n"
+"    //[OPENEPHYS_PARAMETERS_SECTION_BEGIN]\r\n"
+"    //[OPENEPHYS_PARAMETERS_SECTION_END]\r\n"
+"\r\n"
+"    // the mailbox starts from the default of every parameter, and a unit gain if there is none\r\n"
+"    for (int i = 0; i < MAX_PARAMETERS; ++i)\r\n"
+"        mailbox[i] = 0.0f;\r\n"
+"    mailbox[GAIN] = 1.0f;\r\n"
+"\r\n"
+"    for (int i = 0; i < jmin (parameters.size(), int (MAX_PARAMETERS)); ++i)\r\n"
+"        mailbox[i] = float (parameters[i]->getDefaultValue());\r\n"
+"\r\n"
+"    for (int i = 0; i < MAX_PARAMETERS; ++i)\r\n"
+"        blockValues[i] = mailbox[i];\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"PROCESSORCLASSNAME::~PROCESSORCLASSNAME()\r\n"
+"{\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"/**\r\n"
+"  If the processor uses a custom editor, this method must be present.\r\n"
+"*/\r\n"
+"AudioProcessorEditor* PROCESSORCLASSNAME::createEditor()\r\n"
+"{\r\n"
+"    editor = new EDITORCLASSNAME (this, true);\r\n"
+"\r\n"
+"    return editor;\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"void PROCESSORCLASSNAME::setParameter (int parameterIndex, float newValue)\r\n"
+"{\r\n"
+"    if (isPositiveAndBelow (parameterIndex, int (MAX_PARAMETERS)))\r\n"
+"    {\r\n"
+"        mailbox[parameterIndex].store (newValue, std::memory_order_relaxed);\r\n"
+"        mailboxChanged.store (true, std::memory_order_release);\r\n"
+"    }\r\n"
+"\r\n"
+"    // keeps the generated parameters and their editor controls in step\r\n"
+"    if (isPositiveAndBelow (parameterIndex, parameters.size()))\r\n"
+"        GenericProcessor::setParameter (parameterIndex, newValue);\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"void PROCESSORCLASSNAME::updateSettings()\r\n"
+"{\r\n"
+"    processedChannels.clearQuick();\r\n"
+"\r\n"
+"    for (int i = 0; i < getNumInputs(); ++i)\r\n"
+"        processedChannels.add (i);\r\n"
+"\r\n"
+"    numDisplayChannels = jmin (processedChannels.size(), int (MAX_DISPLAY_CHANNELS));\r\n"
+"    displayRing.allocate ((size_t) DISPLAY_RING_FRAMES * jmax (1, numDisplayChannels), true);\r\n"
+"    displayFrame.allocate ((size_t) jmax (1, numDisplayChannels), true);\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"bool PROCESSORCLASSNAME::enable()\r\n"
+"{\r\n"
+"    displayFifo.reset();\r\n"
+"    numDroppedDisplayFrames = 0;\r\n"
+"    mailboxChanged = true;\r\n"
+"\r\n"
+"    return true;\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"int PROCESSORCLASSNAME::getNumDisplayChannels() const\r\n"
+"{\r\n"
+"    return numDisplayChannels;\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"int PROCESSORCLASSNAME::getNumDroppedDisplayFrames() const\r\n"
+"{\r\n"
+"    return numDroppedDisplayFrames;\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"void PROCESSORCLASSNAME::collectParameters()\r\n"
+"{\r\n"
+"    if (! mailboxChanged.exchange (false, std::memory_order_acquire))\r\n"
+"        return;\r\n"
+"\r\n"
+"    for (int i = 0; i < MAX_PARAMETERS; ++i)\r\n"
+"        blockValues[i] = mailbox[i].load (std::memory_order_relaxed);\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"void PROCESSORCLASSNAME::process (AudioSampleBuffer& buffer)\r\n"
+"{\r\n"
+"    collectParameters();\r\n"
+"\r\n"
+"    const int numChannels = processedChannels.size();\r\n"
+"    if (numChannels == 0)\r\n"
+"        return;\r\n"
+"\r\n"
+"    const float gain = blockValues[GAIN];\r\n"
+"\r\n"
+"    /* =============================================================================\r\n"
+"      Every task gets a contiguous range of channels. Keep the work of a channel in\r\n"
+"      kernels over the whole block (FloatVectorOperations, or plain loops over\r\n"
+"      float arrays the compiler can vectorise), and do not allocate, lock or\r\n"
+"      touch the editor from here: the ranges run at the same time on several threads.\r\n"
+"      =============================================================================== */\r\n"
+"    parallelFor (numChannels, [this, &buffer, gain] (int firstChannel, int lastChannel)\r\n"
+"    {\r\n"
+"        for (int i = firstChannel; i < lastChannel; ++i)\r\n"
+"        {\r\n"
+"            const int chan = processedChannels.getUnchecked (i);\r\n"
+"            const int numSamples = getNumSamples (chan);\r\n"
+"            float* samples = buffer.getWritePointer (chan);\r\n"
+"\r\n"
+"            removeMeanAndScale (samples, numSamples, gain);\r\n"
+"\r\n"
+"            if (i < numDisplayChannels)\r\n"
+"                displayFrame[i] = peakToPeak (samples, numSamples);\r\n"
+"        }\r\n"
+"    });\r\n"
+"\r\n"
+"    pushDisplayFrame();\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"void PROCESSORCLASSNAME::removeMeanAndScale (float* samples, int numSamples, float gain)\r\n"
+"{\r\n"
+"    if (numSamples <= 0)\r\n"
+"        return;\r\n"
+"\r\n"
+"    // independent partial sums let the compiler keep them in one vector register\r\n"
+"    float sums[4] = { 0, 0, 0, 0 };\r\n"
+"    int n = 0;\r\n"
+"    for (; n + 4 <= numSamples; n += 4)\r\n"
+"    {\r\n"
+"        sums[0] += samples[n];\r\n"
+"        sums[1] += samples[n + 1];\r\n"
+"        sums[2] += samples[n + 2];\r\n"
+"        sums[3] += samples[n + 3];\r\n"
+"    }\r\n"
+"    for (; n < numSamples; ++n)\r\n"
+"        sums[0] += samples[n];\r\n"
+"\r\n"
+"    const float mean = (sums[0] + sums[1] + sums[2] + sums[3]) / numSamples;\r\n"
+"\r\n"
+"    FloatVectorOperations::add (samples, -mean, numSamples);\r\n"
+"    FloatVectorOperations::multiply (samples, gain, numSamples);\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"float PROCESSORCLASSNAME::peakToPeak (const float* samples, int numSamples)\r\n"
+"{\r\n"
+"    if (numSamples <= 0)\r\n"
+"        return 0.0f;\r\n"
+"\r\n"
+"    return FloatVectorOperations::findMinAndMax (samples, numSamples).getLength();\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"void PROCESSORCLASSNAME::pushDisplayFrame()\r\n"
+"{\r\n"
+"    if (numDisplayChannels == 0)\r\n"
+"        return;\r\n"
+"\r\n"
+"    int start1, size1, start2, size2;\r\n"
+"    displayFifo.prepareToWrite (1, start1, size1, start2, size2);\r\n"
+"\r\n"
+"    if (size1 + size2 == 0)\r\n"
+"    {\r\n"
+"        ++numDroppedDisplayFrames;\r\n"
+"        return;\r\n"
+"    }\r\n"
+"\r\n"
+"    const int frame = size1 > 0 ? start1 : start2;\r\n"
+"    FloatVectorOperations::copy (displayRing + (size_t) frame * numDisplayChannels, displayFrame, numDisplayChannels);\r\n"
+"    displayFifo.finishedWrite (1);\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"int PROCESSORCLASSNAME::readDisplayFrames (float* dest, int maxFrames)\r\n"
+"{\r\n"
+"    if (numDisplayChannels == 0)\r\n"
+"        return 0;\r\n"
+"\r\n"
+"    int start1, size1, start2, size2;\r\n"
+"    displayFifo.prepareToRead (maxFrames, start1, size1, start2, size2);\r\n"
+"\r\n"
+"    if (size1 > 0)\r\n"
+"        FloatVectorOperations::copy (dest, displayRing + (size_t) start1 * numDisplayChannels, size1 * numDisplayChannels);\r\n"
+"    if (size2 > 0)\r\n"
+"        FloatVectorOperations::copy (dest + (size_t) size1 * numDisplayChannels,\r\n"
+"                                     displayRing + (size_t) start2 * numDisplayChannels, size2 * numDisplayChannels);\r\n"
+"\r\n"
+"    displayFifo.finishedRead (size1 + size2);\r\n"
+"    return size1 + size2;\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"void PROCESSORCLASSNAME::saveCustomParametersToXml (XmlElement* parentElement)\r\n"
+"{\r\n"
+"    XmlElement* mainNode = parentElement->createNewChildElement (\"PROCESSORCLASSNAME\");\r\n"
+"    mainNode->setAttribute (\"numParameters\", getNumParameters());\r\n"
+"\r\n"
+"    // Open Ephys Plugin Generator will insert generated code to save parameters here. Don't edit this section.\r\n"
+"    //[OPENEPHYS_PARAMETERS_SAVE_SECTION_BEGIN]\r\n"
+"    for (int i = 0; i < getNumParameters(); ++i)\r\n"
+"    {\r\n"
+"        XmlElement* parameterNode = mainNode->createNewChildElement (\"Parameter\");\r\n"
+"\r\n"
+"        auto parameter = getParameterObject(i);\r\n"
+"        parameterNode->setAttribute (\"name\", parameter->getName());\r\n"
+"        parameterNode->setAttribute (\"type\", parameter->getParameterTypeString());\r\n"
+"\r\n"
+"        auto parameterValue = getParameterVar (i, currentChannel);\r\n"
+"\r\n"
+"        if (parameter->isBoolean())\r\n"
+"            parameterNode->setAttribute (\"value\", (int)parameterValue);\r\n"
+"        else if (parameter->isContinuous() || parameter->isDiscrete() || parameter->isNumerical())\r\n"
+"            parameterNode->setAttribute (\"value\", (double)parameterValue);\r\n"
+"    }\r\n"
+"    //[OPENEPHYS_PARAMETERS_SAVE_SECTION_END]\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"void PROCESSORCLASSNAME::loadCustomParametersFromXml()\r\n"
+"{\r\n"
+"    if (parametersAsXml == nullptr) // prevent double-loading\r\n"
+"        return;\r\n"
+"\r\n"
+"    // use parametersAsXml to restore state\r\n"
+"\r\n"
+"    // Open Ephys Plugin Generator will insert generated code to load parameters here. Don't edit this section.\r\n"
+"    //[OPENEPHYS_PARAMETERS_LOAD_SECTION_BEGIN]\r\n"
+"    forEachXmlChildElement (*parametersAsXml, mainNode)\r\n"
+"    {\r\n"
+"        if (mainNode->hasTagName (\"PROCESSORCLASSNAME\"))\r\n"
+"        {\r\n"
+"            int parameterIdx = -1;\r\n"
+"\r\n"
+"            forEachXmlChildElement (*mainNode, parameterNode)\r\n"
+"            {\r\n"
+"                if (parameterNode->hasTagName (\"Parameter\"))\r\n"
+"                {\r\n"
+"                    ++parameterIdx;\r\n"
+"\r\n"
+"                    String parameterType = parameterNode->getStringAttribute (\"type\");\r\n"
+"                    if (parameterType == \"Boolean\")\r\n"
+"                        setParameter (parameterIdx, parameterNode->getBoolAttribute (\"value\"));\r\n"
+"                    else if (parameterType == \"Continuous\" || parameterType == \"Numerical\")\r\n"
+"                        setParameter (parameterIdx, parameterNode->getDoubleAttribute (\"value\"));\r\n"
+"                    else if (parameterType == \"Discrete\")\r\n"
+"                        setParameter (parameterIdx, parameterNode->getIntAttribute (\"value\"));\r\n"
+"                }\r\n"
+"            }\r\n"
+"        }\r\n"
+"    }\r\n"
+"    //[OPENEPHYS_PARAMETERS_LOAD_SECTION_END]\r\n"
+"}\r\n";
+
+const char* openEphys_BlockProcessorPluginTemplate_cpp = (const char*) temp_binary_data_3;
+
+//================== openEphys_BlockProcessorPluginTemplate.h ==================
+static const unsigned char temp_binary_data_4[] =
+"/*\r\n"
+"    ------------------------------------------------------------------\r\n"
+"\r\n"
+"    This file is part of the Open Ephys GUI\r\n"
+"    Copyright (C) 2016 Open Ephys\r\n"
+"\r\n"
+"    ------------------------------------------------------------------\r\n"
+"\r\n"
+"    This program is free software: you can redistribute it and/or modify\r\n"
+"    it under the terms of the GNU General Public License as published by\r\n"
+"    the Free Software Foundation, either version 3 of the License, or\r\n"
+"    (at your option) any later version.\r\n"
+"\r\n"
+"    This program is distributed in the hope that it will be useful,\r\n"
+"    but WITHOUT ANY WARRANTY; without even the implied warranty of\r\n"
+"    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the\r\n"
+"    GNU General Public License for more details.\r\n"
+"\r\n"
+"    You should have received a copy of the GNU General Public License\r\n"
+"    along with this program.  If not, see <http://www.gnu.org/licenses/>.\r\n"
+"\r\n"
+"*/\r\n"
+"\r\n"
+"#ifndef HEADERGUARD\r\n"
+"#define HEADERGUARD\r\n"
+"\r\n"
+"#ifdef _WIN32\r\n"
+"#include <Windows.h>\r\n"
+"#endif\r\n"
+"\r\n"
+"#include <ProcessorHeaders.h>\r\n"
+"#include <atomic>\r\n"
+"\r\n"
+"/**\r\n"
+"    This class serves as a template for processors that work on whole blocks.\r\n"
+"\r\n"
+"    process() splits the channels into ranges that run on the processor thread pool\r\n"
+"    with parallelFor(), and every range runs the vector kernels below over whole\r\n"
+"    channels, so nothing is done sample by sample in scalar code.\r\n"
+"\r\n"
+"    Values set from the editor are posted to a lock-free mailbox and taken once at the\r\n"
+"    start of every block, so a block is always processed with one set of values and the\r\n"
+"    audio thread never waits for the message thread.\r\n"
+"\r\n"
+"    After every block, one peak to peak value per displayed channel is pushed to a display\r\n"
+"    ring, which a visualizer empties from its own timer. If the visualizer falls behind,\r\n"
+"    frames are dropped instead of holding up the processor.\r\n"
+"\r\n"
+"    @see GenericProcessor\r\n"
+"*/\r\n"
+"class PROCESSORCLASSNAME : public GenericProcessor\r\n"
+"\r\n"
+"{\r\n"
+"public:\r\n"
+"    /** The class constructor, used to initialize any members. */\r\n"
+"    PROCESSORCLASSNAME();\r\n"
+"\r\n"
+"    /** The class destructor, used to deallocate memory */\r\n"
+"    ~PROCESSORCLASSNAME();\r\n"
+"\r\n"
+"    /** If the processor has a custom editor, this method must be defined to instantiate it. */\r\n"
+"    AudioProcessorEditor* createEditor() override;\r\n"
+"\r\n"
+"    /** Runs the kernels over ranges of channels on the processor thread pool. */\r\n"
+"    void process (AudioSampleBuffer& buffer) override;\r\n"
+"\r\n"
+"    /** Posts the value to the mailbox, to be used from the next block. Safe to call while acquiring. */\r\n"
+"    void setParameter (int parameterIndex, float newValue) override;\r\n"
+"\r\n"
+"    /** Picks the processed channels and sizes the display ring. */\r\n"
+"    void updateSettings() override;\r\n"
+"\r\n"
+"    /** Empties the display ring and makes the next block take the mailbox values. */\r\n"
+"    bool enable() override;\r\n"
+"\r\n"
+"    /** Saving custom settings to XML. */\r\n"
+"    virtual void saveCustomParametersToXml (XmlElement* parentElement) override;\r\n"
+"\r\n"
+"    /** Load custom settings from XML*/\r\n"
+"    virtual void loadCustomParametersFromXml() override;\r\n"
+"\r\n"
+"    enum\r\n"
+"    {\r\n"
+"        /** Index of the parameter used by the example kernel as a gain */\r\n"
+"        GAIN = 0,\r\n"
+"        /** Parameter indices the mailbox holds */\r\n"
+"        MAX_PARAMETERS = 32,\r\n"
+"\r\n"
+"        /** Frames the display ring holds, one per block */\r\n"
+"        DISPLAY_RING_FRAMES = 256,\r\n"
+"        MAX_DISPLAY_CHANNELS = 64\r\n"
+"    };\r\n"
+"\r\n"
+"    /** Number of values in every frame of the display ring */\r\n"
+"    int getNumDisplayChannels() const;\r\n"
+"\r\n"
+"    /** Copies up to maxFrames frames of the display ring into dest, oldest first, and returns\r\n"
+"        how many were copied. Must only be called from one thread, usually the visualizer's timer. */\r\n"
+"    int readDisplayFrames (float* dest, int maxFrames);\r\n"
+"\r\n"
+"    /** Frames dropped because the display ring was full */\r\n"
+"    int getNumDroppedDisplayFrames() const;\r\n"
+"\r\n"
+"private:\r\n"
+"    /** Example kernel: removes the block mean of a channel and scales it. */\r\n"
+"    static void removeMeanAndScale (float* samples, int numSamples, float gain);\r\n"
+"\r\n"
+"    /** Difference between the largest and the smallest sample. */\r\n"
+"    static float peakToPeak (const float* samples, int numSamples);\r\n"
+"\r\n"
+"    /** Copies the mailbox into blockValues if anything was posted since the last block. */\r\n"
+"    void collectParameters();\r\n"
+"\r\n"
+"    /** Pushes displayFrame to the display ring, or drops it if the ring is full. */\r\n"
+"    void pushDisplayFrame();\r\n"
+"\r\n"
+"    // parameter mailbox, written from any thread and read at the start of every block\r\n"
+"    std::atomic<float> mailbox[MAX_PARAMETERS];\r\n"
+"    std::atomic<bool> mailboxChanged;\r\n"
+"    /** The values the current block is processed with. Audio thread only */\r\n"
+"    float blockValues[MAX_PARAMETERS];\r\n"
+"\r\n"
+"    /** Indices of the processed channels, set in updateSettings */\r\n"
+"    Array<int> processedChannels;\r\n"
+"\r\n"
+"    // display ring, written by the audio thread and read by the visualizer\r\n"
+"    AbstractFifo displayFifo;\r\n"
+"    HeapBlock<float> displayRing;\r\n"
+"    HeapBlock<float> displayFrame;\r\n"
+"    int numDisplayChannels;\r\n"
+"    std::atomic<int> numDroppedDisplayFrames;\r\n"
+"\r\n"
+"    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PROCESSORCLASSNAME);\r\n"
+"};\r\n"
+"\r\n"
+"\r\n"
+"#endif  // HEADERGUARD\r\n";
+
+const char* openEphys_BlockProcessorPluginTemplate_h = (const char*) temp_binary_data_4;
+
+//================== openEphys_BlockVisualizerCanvasTemplate.cpp ==================
+static const unsigned char temp_binary_data_5[] =
+"/*\r\n"
+"   ------------------------------------------------------------------\r\n"
+"\r\n"
+"   This file is part of the Open Ephys GUI\r\n"
+"   Copyright (C) 2016 Open Ephys\r\n"
+"\r\n"
+"   ------------------------------------------------------------------\r\n"
+"\r\n"
+"   This program is free software: you can redistribute it and/or modify\r\n"
+"   it under the terms of the GNU General Public License as published by\r\n"
+"   the Free Software Foundation, either version 3 of the License, or\r\n"
+"   (at your option) any later version.\r\n"
+"\r\n"
+"   This program is distributed in the hope that it will be useful,\r\n"
+"   but WITHOUT ANY WARRANTY; without even the implied warranty of\r\n"
+"   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the\r\n"
+"   GNU General Public License for more details.\r\n"
+"\r\n"
+"   You should have received a copy of the GNU General Public License\r\n"
+"   along with this program.  If not, see <http://www.gnu.org/licenses/>.\r\n"
+"*/\r\n"
+"\r\n"
+"#include \"EDITORCANVASCLASSNAME.h\"\r\n"
+"#include \"PROCESSORCLASSNAME.h\"\r\n"
+"\r\n"
+"\r\n"
+"EDITORCANVASCLASSNAME::EDITORCANVASCLASSNAME (PROCESSORCLASSNAME* processor_)\r\n"
+"    : processor  (processor_)\r\n"
+"    , frames     ((size_t) PROCESSORCLASSNAME::DISPLAY_RING_FRAMES * PROCESSORCLASSNAME::MAX_DISPLAY_CHANNELS)\r\n"
+"    , history    (Image::RGB, HISTORY_FRAMES, PROCESSORCLASSNAME::MAX_DISPLAY_CHANNELS, true)\r\n"
+"    , nextColumn (0)\r\n"
+"    , scale      (1.0f)\r\n"
+"{\r\n"
+"    // Open Ephys Plugin Generator will insert generated code for editor here. Don't edit this section.\r\n"
+"    //[OPENEPHYS_EDITOR_PRE_CONSTRUCTOR_SECTION_BEGIN]\r\n"
+"\r\n"
+"    //m_contentLookAndFeel = new LOOKANDFEELCLASSNAME();\r\n"
+"    //content.setLookAndFeel (m_contentLookAndFeel);\r\n"
+"    addAndMakeVisible (&content);\r\n"
+"\r\n"
+"    //[OPENEPHYS_EDITOR_PRE_CONSTRUCTOR_SECTION_END]\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"EDITORCANVASCLASSNAME::~EDITORCANVASCLASSNAME()\r\n"
+"{\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"void EDITORCANVASCLASSNAME::paint (Graphics& g)\r\n"
+"{\r\n"
+"    g.fillAll (Colours::black);\r\n"
+"\r\n"
+"    const int numChannels = processor->getNumDisplayChannels();\r\n"
+"    if (numChannels == 0)\r\n"
+"        return;\r\n"
+"\r\n"
+"    // oldest columns on the left: the part after nextColumn, then the one before it\r\n"
+"    g.setImageResamplingQuality (Graphics::lowResamplingQuality);\r\n"
+"\r\n"
+"    const int width = getWidth();\r\n"
+"    const int oldWidth = width * (HISTORY_FRAMES - nextColumn) / HISTORY_FRAMES;\r\n"
+"    g.drawImage (history, 0, 0, oldWidth, getHeight(), nextColumn, 0, HISTORY_FRAMES - nextColumn, numChannels);\r\n"
+"    g.drawImage (history, oldWidth, 0, width - oldWidth, getHeight(), 0, 0, nextColumn, numChannels);\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"void EDITORCANVASCLASSNAME::resized()\r\n"
+"{\r\n"
+"    content.setBounds (getLocalBounds());\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"void EDITORCANVASCLASSNAME::refreshState()\r\n"
+"{\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"void EDITORCANVASCLASSNAME::update()\r\n"
+"{\r\n"
+"    history.clear (history.getBounds(), Colours::black);\r\n"
+"    nextColumn = 0;\r\n"
+"    scale = 1.0f;\r\n"
+"    repaint();\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"void EDITORCANVASCLASSNAME::refresh()\r\n"
+"{\r\n"
+"    const int numChannels = processor->getNumDisplayChannels();\r\n"
+"    const int numFrames = processor->readDisplayFrames (frames, PROCESSORCLASSNAME::DISPLAY_RING_FRAMES);\r\n"
+"\r\n"
+"    for (int f = 0; f < numFrames; ++f)\r\n"
+"        drawFrame (frames + (size_t) f * numChannels, numChannels);\r\n"
+"\r\n"
+"    if (numFrames > 0)\r\n"
+"        repaint();\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"void EDITORCANVASCLASSNAME::drawFrame (const float* frame, int numChannels)\r\n"
+"{\r\n"
+"    const float frameMax = FloatVectorOperations::findMaximum (frame, numChannels);\r\n"
+"    scale = jmax (frameMax, scale * 0.999f, 1.0e-6f);\r\n"
+"\r\n"
+"    for (int c = 0; c < numChannels; ++c)\r\n"
+"    {\r\n"
+"        const float level = jlimit (0.0f, 1.0f, frame[c] / scale);\r\n"
+"        history.setPixelAt (nextColumn, c, Colour::greyLevel (level));\r\n"
+"    }\r\n"
+"\r\n"
+"    nextColumn = (nextColumn + 1) % HISTORY_FRAMES;\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"void EDITORCANVASCLASSNAME::beginAnimation()\r\n"
+"{\r\n"
+"    startCallbacks();\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"void EDITORCANVASCLASSNAME::endAnimation()\r\n"
+"{\r\n"
+"    stopCallbacks();\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"void EDITORCANVASCLASSNAME::setParameter (int parameter, float newValue)\r\n"
+"{\r\n"
+"}\r\n"
+"\r\n"
+"\r\n"
+"void EDITORCANVASCLASSNAME::setParameter (int parameter, int val1, int val2, float newValue)\r\n"
+"{\r\n"
+"}\r\n";
+
+const char* openEphys_BlockVisualizerCanvasTemplate_cpp = (const char*) temp_binary_data_5;
+
+//================== openEphys_BlockVisualizerCanvasTemplate.h ==================
+static const unsigned char temp_binary_data_6[] =
+"/*\r\n"
+"   ------------------------------------------------------------------\r\n"
+"\r\n"
+"   This file is part of the Open Ephys GUI\r\n"
+"   Copyright (C) 2016 Open Ephys\r\n"
+"\r\n"
+"   ------------------------------------------------------------------\r\n"
+"\r\n"
+"   This program is free software: you can redistribute it and/or modify\r\n"
+"   it under the terms of the GNU General Public License as published by\r\n"
+"   the Free Software Foundation, either version 3 of the License, or\r\n"
+"   (at your option) any later version.\r\n"
+"\r\n"
+"   This program is distributed in the hope that it will be useful,\r\n"
+"   but WITHOUT ANY WARRANTY; without even the implied warranty of\r\n"
+"   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the\r\n"
+"   GNU General Public License for more details.\r\n"
+"\r\n"
+"   You should have received a copy of the GNU General Public License\r\n"
+"   along with this program.  If not, see <http://www.gnu.org/licenses/>.\r\n"
+"*/\r\n"
+"\r\n"
+"#ifndef HEADERGUARD\r\n"
+"#define HEADERGUARD\r\n"
+"\r\n"
+"#include <VisualizerEditorHeaders.h>\r\n"
+"#include <AllLookAndFeels.h>\r\n"
+"\r\n"
+"#include \"PROCESSORCLASSNAME.h\"\r\n"
+"#include \"CONTENTCOMPONENTCLASSNAME.h\"\r\n"
+"\r\n"
+"/**\r\n"
+"    Class for displaying the display ring of a block processor either in the tab or separate window.\r\n"
+"\r\n"
+"    Everything drawn is prepared on the message thread: refresh() empties the processor's\r\n"
+"    display ring and writes one column per frame into a history image, and paint() only\r\n"
+"    scales that image, so the cost of the display does not grow with the number of frames\r\n"
+"    shown and the processor never waits for it.\r\n"
+"\r\n"
+"    @see Visualizer, PROCESSORCLASSNAME\r\n"
+"*/\r\n"
+"class EDITORCANVASCLASSNAME : public Visualizer\r\n"
+"{\r\n"
+"public:\r\n"
+"    /** The class constructor, used to initialize any members. */\r\n"
+"    EDITORCANVASCLASSNAME (PROCESSORCLASSNAME* processor);\r\n"
+"\r\n"
+"    /** The class destructor, used to deallocate memory */\r\n"
+"    ~EDITORCANVASCLASSNAME();\r\n"
+"\r\n"
+"    /** Draws the history image behind the content. */\r\n"
+"    void paint (Graphics& g) override;\r\n"
+"\r\n"
+"    /** Called every time when canvas is resized or moved. */\r\n"
+"    void resized() override;\r\n"
+"\r\n"
+"    /** Called when the component's tab becomes visible again.*/\r\n"
+"    void refreshState() override;\r\n"
+"\r\n"
+"    /** Called when parameters of underlying data processor are changed.*/\r\n"
+"    void update() override;\r\n"
+"\r\n"
+"    /** Empties the display ring into the history image.*/\r\n"
+"    void refresh() override;\r\n"
+"\r\n"
+"    /** Called when data acquisition is active.*/\r\n"
+"    void beginAnimation() override;\r\n"
+"\r\n"
+"    /** Called when data acquisition ends.*/\r\n"
+"    void endAnimation() override;\r\n"
+"\r\n"
+"    /** Called by an editor to initiate a parameter change.*/\r\n"
+"    void setParameter (int, float) override;\r\n"
+"\r\n"
+"    /** Called by an editor to initiate a parameter change.*/\r\n"
+"    void setParameter (int, int, int, float) override;\r\n"
+"\r\n"
+"private:\r\n"
+"    enum { HISTORY_FRAMES = 512 };\r\n"
+"\r\n"
+"    /** Writes one frame of the display ring into the next column of the history. */\r\n"
+"    void drawFrame (const float* frame, int numChannels);\r\n"
+"\r\n"
+"    PROCESSORCLASSNAME* processor;\r\n"
+"\r\n"
+"    /** Frames read from the display ring, at most a full ring */\r\n"
+"    HeapBlock<float> frames;\r\n"
+"    /** One column per frame and one row per displayed channel */\r\n"
+"    Image history;\r\n"
+"    int nextColumn;\r\n"
+"    /** Largest value seen, used to scale the brightness */\r\n"
+"    float scale;\r\n"
+"\r\n"
+"    // This component contains all components and graphics that were added using Projucer.\r\n"
+"    // It's bounds initially have same bounds as the canvas itself.\r\n"
+"    CONTENTCOMPONENTCLASSNAME content;\r\n"
+"    //\r\n"
+"    //ScopedPointer<LookAndFeel> m_contentLookAndFeel;\r\n"
+"\r\n"
+"    // ========================================================================\r\n"
+"    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EDITORCANVASCLASSNAME);\r\n"
+"};\r\n"
+"\r\n"
+"\r\n"
+"#endif // HEADERGUARD\r\n";
+
+const char* openEphys_BlockVisualizerCanvasTemplate_h = (const char*) temp_binary_data_6;
+
 //================== openEphys_DataThreadPluginTemplate.cpp ==================
-static const unsigned char temp_binary_data_2[] =
+static const unsigned char temp_binary_data_7[] =
 "/*\r\n"
 "    ------------------------------------------------------------------\r\n"
 "\r\n"
@@ -373,10 +1085,10 @@ static const unsigned char temp_binary_data_2[] =
 "    return true;\r\n"
 "}\r\n";
 
-const char* openEphys_DataThreadPluginTemplate_cpp = (const char*) temp_binary_data_2;
+const char* openEphys_DataThreadPluginTemplate_cpp = (const char*) temp_binary_data_7;
 
 //================== openEphys_DataThreadPluginTemplate.h ==================
-static const unsigned char temp_binary_data_3[] =
+static const unsigned char temp_binary_data_8[] =
 "/*\r\n"
 "    ------------------------------------------------------------------\r\n"
 "\r\n"
@@ -442,10 +1154,10 @@ static const unsigned char temp_binary_data_3[] =
 "\r\n"
 "#endif // HEADERGUARD\r\n";
 
-const char* openEphys_DataThreadPluginTemplate_h = (const char*) temp_binary_data_3;
+const char* openEphys_DataThreadPluginTemplate_h = (const char*) temp_binary_data_8;
 
 //================== openEphys_FileSourcePluginTemplate.cpp ==================
-static const unsigned char temp_binary_data_4[] =
+static const unsigned char temp_binary_data_9[] =
 "/*\r\n"
 "    ------------------------------------------------------------------\r\n"
 "\r\n"
@@ -520,10 +1232,10 @@ static const unsigned char temp_binary_data_4[] =
 "{\r\n"
 "}\r\n";
 
-const char* openEphys_FileSourcePluginTemplate_cpp = (const char*) temp_binary_data_4;
+const char* openEphys_FileSourcePluginTemplate_cpp = (const char*) temp_binary_data_9;
 
 //================== openEphys_FileSourcePluginTemplate.h ==================
-static const unsigned char temp_binary_data_5[] =
+static const unsigned char temp_binary_data_10[] =
 "/*\r\n"
 "    ------------------------------------------------------------------\r\n"
 "\r\n"
@@ -576,10 +1288,10 @@ static const unsigned char temp_binary_data_5[] =
 "\r\n"
 "#endif // HEADERGUARD\r\n";
 
-const char* openEphys_FileSourcePluginTemplate_h = (const char*) temp_binary_data_5;
+const char* openEphys_FileSourcePluginTemplate_h = (const char*) temp_binary_data_10;
 
 //================== openEphys_OpenEphysLibTemplate.cpp ==================
-static const unsigned char temp_binary_data_6[] =
+static const unsigned char temp_binary_data_11[] =
 "/*\r\n"
 "   ------------------------------------------------------------------\r\n"
 "\r\n"
@@ -692,10 +1404,10 @@ static const unsigned char temp_binary_data_6[] =
 "\r\n"
 "#endif\r\n";
 
-const char* openEphys_OpenEphysLibTemplate_cpp = (const char*) temp_binary_data_6;
+const char* openEphys_OpenEphysLibTemplate_cpp = (const char*) temp_binary_data_11;
 
 //================== openEphys_PluginMakefile.example ==================
-static const unsigned char temp_binary_data_7[] =
+static const unsigned char temp_binary_data_12[] =
 "\r\n"
 "LIBNAME := $(notdir $(CURDIR))\r\n"
 "OBJDIR := $(OBJDIR)/$(LIBNAME)\r\n"
@@ -742,10 +1454,10 @@ static const unsigned char temp_binary_data_7[] =
 "\r\n"
 "-include $(OBJ:%.o=%.d)\r\n";
 
-const char* openEphys_PluginMakefile_example = (const char*) temp_binary_data_7;
+const char* openEphys_PluginMakefile_example = (const char*) temp_binary_data_12;
 
 //================== openEphys_ProcessorContentComponentTemplate.cpp ==================
-static const unsigned char temp_binary_data_8[] =
+static const unsigned char temp_binary_data_13[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -849,10 +1561,10 @@ static const unsigned char temp_binary_data_8[] =
 "//[EndFile] You can add extra defines here...\r\n"
 "//[/EndFile]\r\n";
 
-const char* openEphys_ProcessorContentComponentTemplate_cpp = (const char*) temp_binary_data_8;
+const char* openEphys_ProcessorContentComponentTemplate_cpp = (const char*) temp_binary_data_13;
 
 //================== openEphys_ProcessorContentComponentTemplate.h ==================
-static const unsigned char temp_binary_data_9[] =
+static const unsigned char temp_binary_data_14[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -926,10 +1638,10 @@ static const unsigned char temp_binary_data_9[] =
 "\r\n"
 "#endif   // HEADERGUARD\r\n";
 
-const char* openEphys_ProcessorContentComponentTemplate_h = (const char*) temp_binary_data_9;
+const char* openEphys_ProcessorContentComponentTemplate_h = (const char*) temp_binary_data_14;
 
 //================== openEphys_ProcessorEditorPluginTemplate.cpp ==================
-static const unsigned char temp_binary_data_10[] =
+static const unsigned char temp_binary_data_15[] =
 "/*\r\n"
 "   ------------------------------------------------------------------\r\n"
 "\r\n"
@@ -1041,10 +1753,10 @@ static const unsigned char temp_binary_data_10[] =
 "{\r\n"
 "}\r\n";
 
-const char* openEphys_ProcessorEditorPluginTemplate_cpp = (const char*) temp_binary_data_10;
+const char* openEphys_ProcessorEditorPluginTemplate_cpp = (const char*) temp_binary_data_15;
 
 //================== openEphys_ProcessorEditorPluginTemplate.h ==================
-static const unsigned char temp_binary_data_11[] =
+static const unsigned char temp_binary_data_16[] =
 "/*\r\n"
 "   ------------------------------------------------------------------\r\n"
 "\r\n"
@@ -1142,10 +1854,10 @@ static const unsigned char temp_binary_data_11[] =
 "\r\n"
 "#endif // HEADERGUARD\r\n";
 
-const char* openEphys_ProcessorEditorPluginTemplate_h = (const char*) temp_binary_data_11;
+const char* openEphys_ProcessorEditorPluginTemplate_h = (const char*) temp_binary_data_16;
 
 //================== openEphys_ProcessorPluginTemplate.cpp ==================
-static const unsigned char temp_binary_data_12[] =
+static const unsigned char temp_binary_data_17[] =
 "/*\r\n"
 "    ------------------------------------------------------------------\r\n"
 "\r\n"
@@ -1340,10 +2052,10 @@ static const unsigned char temp_binary_data_12[] =
 "    //[OPENEPHYS_PARAMETERS_LOAD_SECTION_END]\r\n"
 "}\r\n";
 
-const char* openEphys_ProcessorPluginTemplate_cpp = (const char*) temp_binary_data_12;
+const char* openEphys_ProcessorPluginTemplate_cpp = (const char*) temp_binary_data_17;
 
 //================== openEphys_ProcessorPluginTemplate.h ==================
-static const unsigned char temp_binary_data_13[] =
+static const unsigned char temp_binary_data_18[] =
 "/*\r\n"
 "    ------------------------------------------------------------------\r\n"
 "\r\n"
@@ -1451,10 +2163,10 @@ static const unsigned char temp_binary_data_13[] =
 "\r\n"
 "#endif  // HEADERGUARD\r\n";
 
-const char* openEphys_ProcessorPluginTemplate_h = (const char*) temp_binary_data_13;
+const char* openEphys_ProcessorPluginTemplate_h = (const char*) temp_binary_data_18;
 
 //================== openEphys_ProcessorVisualizerCanvasTemplate.cpp ==================
-static const unsigned char temp_binary_data_14[] =
+static const unsigned char temp_binary_data_19[] =
 "/*\r\n"
 "   ------------------------------------------------------------------\r\n"
 "\r\n"
@@ -1541,10 +2253,10 @@ static const unsigned char temp_binary_data_14[] =
 "{\r\n"
 "}\r\n";
 
-const char* openEphys_ProcessorVisualizerCanvasTemplate_cpp = (const char*) temp_binary_data_14;
+const char* openEphys_ProcessorVisualizerCanvasTemplate_cpp = (const char*) temp_binary_data_19;
 
 //================== openEphys_ProcessorVisualizerCanvasTemplate.h ==================
-static const unsigned char temp_binary_data_15[] =
+static const unsigned char temp_binary_data_20[] =
 "/*\r\n"
 "   ------------------------------------------------------------------\r\n"
 "\r\n"
@@ -1630,10 +2342,10 @@ static const unsigned char temp_binary_data_15[] =
 "\r\n"
 "#endif // HEADERGUARD\r\n";
 
-const char* openEphys_ProcessorVisualizerCanvasTemplate_h = (const char*) temp_binary_data_15;
+const char* openEphys_ProcessorVisualizerCanvasTemplate_h = (const char*) temp_binary_data_20;
 
 //================== openEphys_ProcessorVisualizerEditorPluginTemplate.cpp ==================
-static const unsigned char temp_binary_data_16[] =
+static const unsigned char temp_binary_data_21[] =
 "/*\r\n"
 "   ------------------------------------------------------------------\r\n"
 "\r\n"
@@ -1755,10 +2467,10 @@ static const unsigned char temp_binary_data_16[] =
 "    return new EDITORCANVASCLASSNAME (processor);\r\n"
 "}\r\n";
 
-const char* openEphys_ProcessorVisualizerEditorPluginTemplate_cpp = (const char*) temp_binary_data_16;
+const char* openEphys_ProcessorVisualizerEditorPluginTemplate_cpp = (const char*) temp_binary_data_21;
 
 //================== openEphys_ProcessorVisualizerEditorPluginTemplate.h ==================
-static const unsigned char temp_binary_data_17[] =
+static const unsigned char temp_binary_data_22[] =
 "/*\r\n"
 "   ------------------------------------------------------------------\r\n"
 "\r\n"
@@ -1857,10 +2569,10 @@ static const unsigned char temp_binary_data_17[] =
 "\r\n"
 "#endif // HEADERGUARD\r\n";
 
-const char* openEphys_ProcessorVisualizerEditorPluginTemplate_h = (const char*) temp_binary_data_17;
+const char* openEphys_ProcessorVisualizerEditorPluginTemplate_h = (const char*) temp_binary_data_22;
 
 //================== openEphys_RecordEnginePluginTemplate.cpp ==================
-static const unsigned char temp_binary_data_18[] =
+static const unsigned char temp_binary_data_23[] =
 "/*\r\n"
 "    ------------------------------------------------------------------\r\n"
 "\r\n"
@@ -1963,10 +2675,10 @@ static const unsigned char temp_binary_data_18[] =
 "    return man;\r\n"
 "}\r\n";
 
-const char* openEphys_RecordEnginePluginTemplate_cpp = (const char*) temp_binary_data_18;
+const char* openEphys_RecordEnginePluginTemplate_cpp = (const char*) temp_binary_data_23;
 
 //================== openEphys_RecordEnginePluginTemplate.h ==================
-static const unsigned char temp_binary_data_19[] =
+static const unsigned char temp_binary_data_24[] =
 "/*\r\n"
 "    ------------------------------------------------------------------\r\n"
 "\r\n"
@@ -2029,10 +2741,10 @@ static const unsigned char temp_binary_data_19[] =
 "\r\n"
 "#endif // HEADERGUARD\r\n";
 
-const char* openEphys_RecordEnginePluginTemplate_h = (const char*) temp_binary_data_19;
+const char* openEphys_RecordEnginePluginTemplate_h = (const char*) temp_binary_data_24;
 
 //================== jucer_AnimatedComponentTemplate.cpp ==================
-static const unsigned char temp_binary_data_20[] =
+static const unsigned char temp_binary_data_25[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -2105,10 +2817,10 @@ static const unsigned char temp_binary_data_20[] =
 "\r\n"
 "#endif  // MAINCOMPONENT_H_INCLUDED\r\n";
 
-const char* jucer_AnimatedComponentTemplate_cpp = (const char*) temp_binary_data_20;
+const char* jucer_AnimatedComponentTemplate_cpp = (const char*) temp_binary_data_25;
 
 //================== jucer_AudioComponentTemplate.cpp ==================
-static const unsigned char temp_binary_data_21[] =
+static const unsigned char temp_binary_data_26[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -2209,10 +2921,10 @@ static const unsigned char temp_binary_data_21[] =
 "\r\n"
 "#endif  // MAINCOMPONENT_H_INCLUDED\r\n";
 
-const char* jucer_AudioComponentTemplate_cpp = (const char*) temp_binary_data_21;
+const char* jucer_AudioComponentTemplate_cpp = (const char*) temp_binary_data_26;
 
 //================== jucer_AudioPluginEditorTemplate.cpp ==================
-static const unsigned char temp_binary_data_22[] =
+static const unsigned char temp_binary_data_27[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -2255,10 +2967,10 @@ static const unsigned char temp_binary_data_22[] =
 "    // subcomponents in your editor..\r\n"
 "}\r\n";
 
-const char* jucer_AudioPluginEditorTemplate_cpp = (const char*) temp_binary_data_22;
+const char* jucer_AudioPluginEditorTemplate_cpp = (const char*) temp_binary_data_27;
 
 //================== jucer_AudioPluginEditorTemplate.h ==================
-static const unsigned char temp_binary_data_23[] =
+static const unsigned char temp_binary_data_28[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -2299,10 +3011,10 @@ static const unsigned char temp_binary_data_23[] =
 "\r\n"
 "#endif  // HEADERGUARD\r\n";
 
-const char* jucer_AudioPluginEditorTemplate_h = (const char*) temp_binary_data_23;
+const char* jucer_AudioPluginEditorTemplate_h = (const char*) temp_binary_data_28;
 
 //================== jucer_AudioPluginFilterTemplate.cpp ==================
-static const unsigned char temp_binary_data_24[] =
+static const unsigned char temp_binary_data_29[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -2472,10 +3184,10 @@ static const unsigned char temp_binary_data_24[] =
 "    return new FILTERCLASSNAME();\r\n"
 "}\r\n";
 
-const char* jucer_AudioPluginFilterTemplate_cpp = (const char*) temp_binary_data_24;
+const char* jucer_AudioPluginFilterTemplate_cpp = (const char*) temp_binary_data_29;
 
 //================== jucer_AudioPluginFilterTemplate.h ==================
-static const unsigned char temp_binary_data_25[] =
+static const unsigned char temp_binary_data_30[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -2542,10 +3254,10 @@ static const unsigned char temp_binary_data_25[] =
 "\r\n"
 "#endif  // HEADERGUARD\r\n";
 
-const char* jucer_AudioPluginFilterTemplate_h = (const char*) temp_binary_data_25;
+const char* jucer_AudioPluginFilterTemplate_h = (const char*) temp_binary_data_30;
 
 //================== jucer_ComponentTemplate.cpp ==================
-static const unsigned char temp_binary_data_26[] =
+static const unsigned char temp_binary_data_31[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -2621,10 +3333,10 @@ static const unsigned char temp_binary_data_26[] =
 "//[EndFile] You can add extra defines here...\r\n"
 "//[/EndFile]\r\n";
 
-const char* jucer_ComponentTemplate_cpp = (const char*) temp_binary_data_26;
+const char* jucer_ComponentTemplate_cpp = (const char*) temp_binary_data_31;
 
 //================== jucer_ComponentTemplate.h ==================
-static const unsigned char temp_binary_data_27[] =
+static const unsigned char temp_binary_data_32[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -2690,10 +3402,10 @@ static const unsigned char temp_binary_data_27[] =
 "\r\n"
 "#endif   // %%headerGuard%%\r\n";
 
-const char* jucer_ComponentTemplate_h = (const char*) temp_binary_data_27;
+const char* jucer_ComponentTemplate_h = (const char*) temp_binary_data_32;
 
 //================== jucer_ContentCompTemplate.cpp ==================
-static const unsigned char temp_binary_data_28[] =
+static const unsigned char temp_binary_data_33[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -2731,10 +3443,10 @@ static const unsigned char temp_binary_data_28[] =
 "    // update their positions.\r\n"
 "}\r\n";
 
-const char* jucer_ContentCompTemplate_cpp = (const char*) temp_binary_data_28;
+const char* jucer_ContentCompTemplate_cpp = (const char*) temp_binary_data_33;
 
 //================== jucer_ContentCompTemplate.h ==================
-static const unsigned char temp_binary_data_29[] =
+static const unsigned char temp_binary_data_34[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -2772,10 +3484,10 @@ static const unsigned char temp_binary_data_29[] =
 "\r\n"
 "#endif  // HEADERGUARD\r\n";
 
-const char* jucer_ContentCompTemplate_h = (const char*) temp_binary_data_29;
+const char* jucer_ContentCompTemplate_h = (const char*) temp_binary_data_34;
 
 //================== jucer_InlineComponentTemplate.h ==================
-static const unsigned char temp_binary_data_30[] =
+static const unsigned char temp_binary_data_35[] =
 "//==============================================================================\r\n"
 "class COMPONENTCLASS    : public Component\r\n"
 "{\r\n"
@@ -2817,10 +3529,10 @@ static const unsigned char temp_binary_data_30[] =
 "    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (COMPONENTCLASS)\r\n"
 "};\r\n";
 
-const char* jucer_InlineComponentTemplate_h = (const char*) temp_binary_data_30;
+const char* jucer_InlineComponentTemplate_h = (const char*) temp_binary_data_35;
 
 //================== jucer_MainConsoleAppTemplate.cpp ==================
-static const unsigned char temp_binary_data_31[] =
+static const unsigned char temp_binary_data_36[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -2844,10 +3556,10 @@ static const unsigned char temp_binary_data_31[] =
 "    return 0;\r\n"
 "}\r\n";
 
-const char* jucer_MainConsoleAppTemplate_cpp = (const char*) temp_binary_data_31;
+const char* jucer_MainConsoleAppTemplate_cpp = (const char*) temp_binary_data_36;
 
 //================== jucer_MainTemplate_NoWindow.cpp ==================
-static const unsigned char temp_binary_data_32[] =
+static const unsigned char temp_binary_data_37[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -2903,10 +3615,10 @@ static const unsigned char temp_binary_data_32[] =
 "// This macro generates the main() routine that launches the app.\r\n"
 "START_JUCE_APPLICATION (APPCLASSNAME)\r\n";
 
-const char* jucer_MainTemplate_NoWindow_cpp = (const char*) temp_binary_data_32;
+const char* jucer_MainTemplate_NoWindow_cpp = (const char*) temp_binary_data_37;
 
 //================== jucer_MainTemplate_SimpleWindow.cpp ==================
-static const unsigned char temp_binary_data_33[] =
+static const unsigned char temp_binary_data_38[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -3009,10 +3721,10 @@ static const unsigned char temp_binary_data_33[] =
 "// This macro generates the main() routine that launches the app.\r\n"
 "START_JUCE_APPLICATION (APPCLASSNAME)\r\n";
 
-const char* jucer_MainTemplate_SimpleWindow_cpp = (const char*) temp_binary_data_33;
+const char* jucer_MainTemplate_SimpleWindow_cpp = (const char*) temp_binary_data_38;
 
 //================== jucer_MainTemplate_Window.cpp ==================
-static const unsigned char temp_binary_data_34[] =
+static const unsigned char temp_binary_data_39[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -3113,10 +3825,10 @@ static const unsigned char temp_binary_data_34[] =
 "// This macro generates the main() routine that launches the app.\r\n"
 "START_JUCE_APPLICATION (APPCLASSNAME)\r\n";
 
-const char* jucer_MainTemplate_Window_cpp = (const char*) temp_binary_data_34;
+const char* jucer_MainTemplate_Window_cpp = (const char*) temp_binary_data_39;
 
 //================== jucer_NewComponentTemplate.cpp ==================
-static const unsigned char temp_binary_data_35[] =
+static const unsigned char temp_binary_data_40[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -3169,10 +3881,10 @@ static const unsigned char temp_binary_data_35[] =
 "\r\n"
 "}\r\n";
 
-const char* jucer_NewComponentTemplate_cpp = (const char*) temp_binary_data_35;
+const char* jucer_NewComponentTemplate_cpp = (const char*) temp_binary_data_40;
 
 //================== jucer_NewComponentTemplate.h ==================
-static const unsigned char temp_binary_data_36[] =
+static const unsigned char temp_binary_data_41[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -3207,10 +3919,10 @@ static const unsigned char temp_binary_data_36[] =
 "\r\n"
 "#endif  // HEADERGUARD\r\n";
 
-const char* jucer_NewComponentTemplate_h = (const char*) temp_binary_data_36;
+const char* jucer_NewComponentTemplate_h = (const char*) temp_binary_data_41;
 
 //================== jucer_NewCppFileTemplate.cpp ==================
-static const unsigned char temp_binary_data_37[] =
+static const unsigned char temp_binary_data_42[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -3223,10 +3935,10 @@ static const unsigned char temp_binary_data_37[] =
 "\r\n"
 "INCLUDE_CORRESPONDING_HEADER\r\n";
 
-const char* jucer_NewCppFileTemplate_cpp = (const char*) temp_binary_data_37;
+const char* jucer_NewCppFileTemplate_cpp = (const char*) temp_binary_data_42;
 
 //================== jucer_NewCppFileTemplate.h ==================
-static const unsigned char temp_binary_data_38[] =
+static const unsigned char temp_binary_data_43[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -3246,10 +3958,10 @@ static const unsigned char temp_binary_data_38[] =
 "\r\n"
 "#endif  // HEADERGUARD\r\n";
 
-const char* jucer_NewCppFileTemplate_h = (const char*) temp_binary_data_38;
+const char* jucer_NewCppFileTemplate_h = (const char*) temp_binary_data_43;
 
 //================== jucer_NewInlineComponentTemplate.h ==================
-static const unsigned char temp_binary_data_39[] =
+static const unsigned char temp_binary_data_44[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -3316,10 +4028,10 @@ static const unsigned char temp_binary_data_39[] =
 "\r\n"
 "#endif  // HEADERGUARD\r\n";
 
-const char* jucer_NewInlineComponentTemplate_h = (const char*) temp_binary_data_39;
+const char* jucer_NewInlineComponentTemplate_h = (const char*) temp_binary_data_44;
 
 //================== jucer_OpenGLComponentTemplate.cpp ==================
-static const unsigned char temp_binary_data_40[] =
+static const unsigned char temp_binary_data_45[] =
 "/*\r\n"
 "  ==============================================================================\r\n"
 "\r\n"
@@ -3397,10 +4109,10 @@ static const unsigned char temp_binary_data_40[] =
 "\r\n"
 "#endif  // MAINCOMPONENT_H_INCLUDED\r\n";
 
-const char* jucer_OpenGLComponentTemplate_cpp = (const char*) temp_binary_data_40;
+const char* jucer_OpenGLComponentTemplate_cpp = (const char*) temp_binary_data_45;
 
 //================== background_logo.svg ==================
-static const unsigned char temp_binary_data_41[] =
+static const unsigned char temp_binary_data_46[] =
 "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n"
 "<svg version=\"1.1\" id=\"Layer_1\" xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" x=\"0px\" y=\"0px\"\r\n"
 "\t viewBox=\"0 0 451.7 451.7\" enable-background=\"new 0 0 451.7 451.7\" xml:space=\"preserve\">\r\n"
@@ -3439,17 +4151,17 @@ static const unsigned char temp_binary_data_41[] =
 "</g>\r\n"
 "</svg>\r\n";
 
-const char* background_logo_svg = (const char*) temp_binary_data_41;
+const char* background_logo_svg = (const char*) temp_binary_data_46;
 
 //================== background_tile.png ==================
-static const unsigned char temp_binary_data_42[] =
+static const unsigned char temp_binary_data_47[] =
 { 137,80,78,71,13,10,26,10,0,0,0,13,73,72,68,82,0,0,0,7,0,0,0,7,8,6,0,0,0,196,82,87,211,0,0,0,94,73,68,65,84,120,218,85,141,73,14,0,33,8,4,253,137,226,18,19,245,234,255,127,70,75,155,232,56,135,10,132,94,112,33,4,37,222,123,205,57,107,74,105,239,196,137,
 8,72,239,29,99,12,204,57,209,90,227,237,19,45,113,161,209,12,234,172,18,49,70,88,229,134,34,103,173,245,159,60,134,82,10,238,79,166,223,106,238,91,100,229,73,191,80,92,47,179,68,223,148,158,98,226,0,0,0,0,73,69,78,68,174,66,96,130,0,0 };
 
-const char* background_tile_png = (const char*) temp_binary_data_42;
+const char* background_tile_png = (const char*) temp_binary_data_47;
 
 //================== colourscheme_dark.xml ==================
-static const unsigned char temp_binary_data_43[] =
+static const unsigned char temp_binary_data_48[] =
 "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n"
 "\r\n"
 "<COLOUR_SCHEME font=\"&lt;Monospaced&gt;; 13.0\">\r\n"
@@ -3474,10 +4186,10 @@ static const unsigned char temp_binary_data_43[] =
 "  <COLOUR name=\"Error\" colour=\"FFE60000\"/>\r\n"
 "</COLOUR_SCHEME>\r\n";
 
-const char* colourscheme_dark_xml = (const char*) temp_binary_data_43;
+const char* colourscheme_dark_xml = (const char*) temp_binary_data_48;
 
 //================== colourscheme_light.xml ==================
-static const unsigned char temp_binary_data_44[] =
+static const unsigned char temp_binary_data_49[] =
 "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n"
 "\r\n"
 "<COLOUR_SCHEME font=\"&lt;Monospaced&gt;; 13.0\">\r\n"
@@ -3502,10 +4214,10 @@ static const unsigned char temp_binary_data_44[] =
 "  <COLOUR name=\"Error\" colour=\"ffcc0000\"/>\r\n"
 "</COLOUR_SCHEME>\r\n";
 
-const char* colourscheme_light_xml = (const char*) temp_binary_data_44;
+const char* colourscheme_light_xml = (const char*) temp_binary_data_49;
 
 //================== juce_icon.png ==================
-static const unsigned char temp_binary_data_45[] =
+static const unsigned char temp_binary_data_50[] =
 { 137,80,78,71,13,10,26,10,0,0,0,13,73,72,68,82,0,0,2,0,0,0,2,0,8,6,0,0,0,244,120,212,250,0,0,0,25,116,69,88,116,83,111,102,116,119,97,114,101,0,65,100,111,98,101,32,73,109,97,103,101,82,101,97,100,121,113,201,101,60,0,0,3,40,105,84,88,116,88,77,76,58,
 99,111,109,46,97,100,111,98,101,46,120,109,112,0,0,0,0,0,60,63,120,112,97,99,107,101,116,32,98,101,103,105,110,61,34,239,187,191,34,32,105,100,61,34,87,53,77,48,77,112,67,101,104,105,72,122,114,101,83,122,78,84,99,122,107,99,57,100,34,63,62,32,60,120,
 58,120,109,112,109,101,116,97,32,120,109,108,110,115,58,120,61,34,97,100,111,98,101,58,110,115,58,109,101,116,97,47,34,32,120,58,120,109,112,116,107,61,34,65,100,111,98,101,32,88,77,80,32,67,111,114,101,32,53,46,54,45,99,48,54,55,32,55,57,46,49,53,55,
@@ -4151,10 +4863,10 @@ static const unsigned char temp_binary_data_45[] =
 0,0,0,2,0,0,16,0,0,128,0,0,0,4,0,0,32,0,0,0,1,0,0,8,0,0,64,0,0,0,2,0,0,16,0,0,128,0,0,0,4,0,0,32,0,0,0,1,0,0,8,0,0,64,0,0,128,0,0,0,4,0,0,32,0,0,0,1,0,0,8,0,0,64,0,0,0,2,0,0,16,0,0,128,0,0,0,4,0,0,32,0,0,128,191,246,33,192,0,100,235,173,153,70,62,64,
 37,0,0,0,0,73,69,78,68,174,66,96,130,0,0 };
 
-const char* juce_icon_png = (const char*) temp_binary_data_45;
+const char* juce_icon_png = (const char*) temp_binary_data_50;
 
 //================== projectIconAndroid.png ==================
-static const unsigned char temp_binary_data_46[] =
+static const unsigned char temp_binary_data_51[] =
 { 137,80,78,71,13,10,26,10,0,0,0,13,73,72,68,82,0,0,0,128,0,0,0,128,8,6,0,0,0,195,62,97,203,0,0,0,25,116,69,88,116,83,111,102,116,119,97,114,101,0,65,100,111,98,101,32,73,109,97,103,101,82,101,97,100,121,113,201,101,60,0,0,3,134,105,84,88,116,88,77,76,
 58,99,111,109,46,97,100,111,98,101,46,120,109,112,0,0,0,0,0,60,63,120,112,97,99,107,101,116,32,98,101,103,105,110,61,34,239,187,191,34,32,105,100,61,34,87,53,77,48,77,112,67,101,104,105,72,122,114,101,83,122,78,84,99,122,107,99,57,100,34,63,62,32,60,
 120,58,120,109,112,109,101,116,97,32,120,109,108,110,115,58,120,61,34,97,100,111,98,101,58,110,115,58,109,101,116,97,47,34,32,120,58,120,109,112,116,107,61,34,65,100,111,98,101,32,88,77,80,32,67,111,114,101,32,53,46,54,45,99,48,49,52,32,55,57,46,49,53,
@@ -4271,10 +4983,10 @@ static const unsigned char temp_binary_data_46[] =
 139,240,165,4,64,57,166,132,157,54,246,220,165,230,39,27,156,211,4,232,176,247,44,193,125,203,174,137,229,132,198,114,231,150,74,124,238,9,19,9,244,154,7,0,175,121,0,240,154,7,0,175,121,0,240,154,7,0,175,121,0,240,154,7,0,175,189,235,246,255,2,12,0,158,
 137,39,54,252,6,9,64,0,0,0,0,73,69,78,68,174,66,96,130,0,0 };
 
-const char* projectIconAndroid_png = (const char*) temp_binary_data_46;
+const char* projectIconAndroid_png = (const char*) temp_binary_data_51;
 
 //================== projectIconCodeblocks.png ==================
-static const unsigned char temp_binary_data_47[] =
+static const unsigned char temp_binary_data_52[] =
 { 137,80,78,71,13,10,26,10,0,0,0,13,73,72,68,82,0,0,0,128,0,0,0,128,8,6,0,0,0,195,62,97,203,0,0,0,25,116,69,88,116,83,111,102,116,119,97,114,101,0,65,100,111,98,101,32,73,109,97,103,101,82,101,97,100,121,113,201,101,60,0,0,3,134,105,84,88,116,88,77,76,
 58,99,111,109,46,97,100,111,98,101,46,120,109,112,0,0,0,0,0,60,63,120,112,97,99,107,101,116,32,98,101,103,105,110,61,34,239,187,191,34,32,105,100,61,34,87,53,77,48,77,112,67,101,104,105,72,122,114,101,83,122,78,84,99,122,107,99,57,100,34,63,62,32,60,
 120,58,120,109,112,109,101,116,97,32,120,109,108,110,115,58,120,61,34,97,100,111,98,101,58,110,115,58,109,101,116,97,47,34,32,120,58,120,109,112,116,107,61,34,65,100,111,98,101,32,88,77,80,32,67,111,114,101,32,53,46,54,45,99,48,49,52,32,55,57,46,49,53,
@@ -4444,10 +5156,10 @@ static const unsigned char temp_binary_data_47[] =
 202,84,15,91,2,120,13,161,41,237,191,111,130,252,4,17,176,224,208,111,140,253,56,221,147,207,16,11,238,233,234,37,192,250,248,241,59,248,122,10,214,12,176,62,214,12,176,62,214,12,176,62,214,12,176,62,214,12,176,62,214,12,176,62,214,12,176,62,214,12,176,
 62,214,12,176,62,214,12,176,62,214,12,176,62,214,12,176,62,214,12,176,62,214,12,176,62,126,28,143,255,39,192,0,238,147,31,89,162,25,31,21,0,0,0,0,73,69,78,68,174,66,96,130,0,0 };
 
-const char* projectIconCodeblocks_png = (const char*) temp_binary_data_47;
+const char* projectIconCodeblocks_png = (const char*) temp_binary_data_52;
 
 //================== projectIconLinuxMakefile.png ==================
-static const unsigned char temp_binary_data_48[] =
+static const unsigned char temp_binary_data_53[] =
 { 137,80,78,71,13,10,26,10,0,0,0,13,73,72,68,82,0,0,0,110,0,0,0,128,8,6,0,0,0,234,21,92,9,0,0,10,65,105,67,67,80,73,67,67,32,80,114,111,102,105,108,101,0,0,72,13,157,150,119,84,83,217,22,135,207,189,55,189,208,18,34,32,37,244,26,122,9,32,210,59,72,21,4,
 81,137,73,128,80,2,134,132,38,118,68,5,70,20,17,41,86,100,84,192,1,71,135,34,99,69,20,11,131,130,98,215,9,242,16,80,198,193,81,68,69,229,221,140,107,9,239,173,53,243,222,154,253,199,89,223,217,231,183,215,217,103,239,125,215,186,0,80,252,130,4,194,116,
 88,1,128,52,161,88,20,238,235,193,92,18,19,203,196,247,2,24,16,1,14,88,1,192,225,102,102,4,71,248,68,2,212,252,189,61,153,153,168,72,198,179,246,238,46,128,100,187,219,44,191,80,38,115,214,255,127,145,34,55,67,36,6,0,10,69,213,54,60,126,38,23,229,2,148,
@@ -4683,10 +5395,10 @@ static const unsigned char temp_binary_data_48[] =
 194,72,142,254,249,31,79,111,60,173,241,241,124,82,34,189,246,233,251,163,179,223,129,178,15,181,97,103,68,217,251,253,17,198,63,35,254,218,150,109,129,235,236,183,141,63,16,97,60,125,157,93,199,211,219,217,245,128,211,250,223,12,238,70,210,82,169,25,
 10,0,0,0,0,73,69,78,68,174,66,96,130,0,0 };
 
-const char* projectIconLinuxMakefile_png = (const char*) temp_binary_data_48;
+const char* projectIconLinuxMakefile_png = (const char*) temp_binary_data_53;
 
 //================== projectIconVisualStudio.png ==================
-static const unsigned char temp_binary_data_49[] =
+static const unsigned char temp_binary_data_54[] =
 { 137,80,78,71,13,10,26,10,0,0,0,13,73,72,68,82,0,0,0,128,0,0,0,128,8,6,0,0,0,195,62,97,203,0,0,0,1,115,82,71,66,0,174,206,28,233,0,0,4,166,105,84,88,116,88,77,76,58,99,111,109,46,97,100,111,98,101,46,120,109,112,0,0,0,0,0,60,120,58,120,109,112,109,101,
 116,97,32,120,109,108,110,115,58,120,61,34,97,100,111,98,101,58,110,115,58,109,101,116,97,47,34,32,120,58,120,109,112,116,107,61,34,88,77,80,32,67,111,114,101,32,53,46,52,46,48,34,62,10,32,32,32,60,114,100,102,58,82,68,70,32,120,109,108,110,115,58,114,
 100,102,61,34,104,116,116,112,58,47,47,119,119,119,46,119,51,46,111,114,103,47,49,57,57,57,47,48,50,47,50,50,45,114,100,102,45,115,121,110,116,97,120,45,110,115,35,34,62,10,32,32,32,32,32,32,60,114,100,102,58,68,101,115,99,114,105,112,116,105,111,110,
@@ -4789,10 +5501,10 @@ static const unsigned char temp_binary_data_49[] =
 60,9,167,156,184,49,164,154,223,25,2,227,183,193,73,245,49,24,79,213,175,147,166,128,166,128,166,128,166,128,166,128,166,128,166,128,166,128,166,128,166,128,166,128,166,128,166,128,166,128,166,128,166,128,166,128,166,128,166,128,166,128,166,192,129,64,
 129,255,7,47,12,150,8,60,209,161,194,0,0,0,0,73,69,78,68,174,66,96,130,0,0 };
 
-const char* projectIconVisualStudio_png = (const char*) temp_binary_data_49;
+const char* projectIconVisualStudio_png = (const char*) temp_binary_data_54;
 
 //================== projectIconXcode.png ==================
-static const unsigned char temp_binary_data_50[] =
+static const unsigned char temp_binary_data_55[] =
 { 137,80,78,71,13,10,26,10,0,0,0,13,73,72,68,82,0,0,0,128,0,0,0,128,8,6,0,0,0,195,62,97,203,0,0,0,25,116,69,88,116,83,111,102,116,119,97,114,101,0,65,100,111,98,101,32,73,109,97,103,101,82,101,97,100,121,113,201,101,60,0,0,3,40,105,84,88,116,88,77,76,58,
 99,111,109,46,97,100,111,98,101,46,120,109,112,0,0,0,0,0,60,63,120,112,97,99,107,101,116,32,98,101,103,105,110,61,34,239,187,191,34,32,105,100,61,34,87,53,77,48,77,112,67,101,104,105,72,122,114,101,83,122,78,84,99,122,107,99,57,100,34,63,62,32,60,120,
 58,120,109,112,109,101,116,97,32,120,109,108,110,115,58,120,61,34,97,100,111,98,101,58,110,115,58,109,101,116,97,47,34,32,120,58,120,109,112,116,107,61,34,65,100,111,98,101,32,88,77,80,32,67,111,114,101,32,53,46,54,45,99,48,49,52,32,55,57,46,49,53,54,
@@ -5052,10 +5764,10 @@ static const unsigned char temp_binary_data_50[] =
 94,156,0,232,23,120,134,102,179,249,235,17,128,9,19,38,192,59,223,249,206,152,182,172,169,75,67,169,119,178,110,237,223,246,242,196,143,188,48,28,50,88,157,63,127,254,175,124,82,161,71,186,231,200,203,63,99,234,231,229,216,252,127,248,207,255,19,96,0,
 221,83,18,25,240,8,112,38,0,0,0,0,73,69,78,68,174,66,96,130,0,0 };
 
-const char* projectIconXcode_png = (const char*) temp_binary_data_50;
+const char* projectIconXcode_png = (const char*) temp_binary_data_55;
 
 //================== projectIconXcodeIOS.png ==================
-static const unsigned char temp_binary_data_51[] =
+static const unsigned char temp_binary_data_56[] =
 { 137,80,78,71,13,10,26,10,0,0,0,13,73,72,68,82,0,0,0,128,0,0,0,128,8,6,0,0,0,195,62,97,203,0,0,0,25,116,69,88,116,83,111,102,116,119,97,114,101,0,65,100,111,98,101,32,73,109,97,103,101,82,101,97,100,121,113,201,101,60,0,0,3,134,105,84,88,116,88,77,76,
 58,99,111,109,46,97,100,111,98,101,46,120,109,112,0,0,0,0,0,60,63,120,112,97,99,107,101,116,32,98,101,103,105,110,61,34,239,187,191,34,32,105,100,61,34,87,53,77,48,77,112,67,101,104,105,72,122,114,101,83,122,78,84,99,122,107,99,57,100,34,63,62,32,60,
 120,58,120,109,112,109,101,116,97,32,120,109,108,110,115,58,120,61,34,97,100,111,98,101,58,110,115,58,109,101,116,97,47,34,32,120,58,120,109,112,116,107,61,34,65,100,111,98,101,32,88,77,80,32,67,111,114,101,32,53,46,54,45,99,48,49,52,32,55,57,46,49,53,
@@ -5313,10 +6025,10 @@ static const unsigned char temp_binary_data_51[] =
 4,97,9,162,191,203,0,199,198,0,162,157,87,213,105,220,35,12,64,131,146,62,249,201,79,186,117,103,130,86,133,76,84,14,16,185,67,123,223,37,252,241,103,134,146,206,234,228,201,147,143,250,164,172,171,29,174,239,254,252,101,253,188,235,155,255,31,255,249,
 255,2,12,0,235,154,52,248,249,240,115,28,0,0,0,0,73,69,78,68,174,66,96,130,0,0 };
 
-const char* projectIconXcodeIOS_png = (const char*) temp_binary_data_51;
+const char* projectIconXcodeIOS_png = (const char*) temp_binary_data_56;
 
 //================== projucer_EULA.txt ==================
-static const unsigned char temp_binary_data_52[] =
+static const unsigned char temp_binary_data_57[] =
 "\r\n"
 "IMPORTANT NOTICE: PLEASE READ CAREFULLY BEFORE INSTALLING THE SOFTWARE:\r\n"
 "\r\n"
@@ -5480,10 +6192,10 @@ static const unsigned char temp_binary_data_52[] =
 "\r\n"
 "10.6. Please note that this Licence, its subject matter and its formation, are governed by English law. You and we both agree to that the courts of England and Wales will have exclusive jurisdiction. \r\n";
 
-const char* projucer_EULA_txt = (const char*) temp_binary_data_52;
+const char* projucer_EULA_txt = (const char*) temp_binary_data_57;
 
 //================== projucer_login_bg.svg ==================
-static const unsigned char temp_binary_data_53[] =
+static const unsigned char temp_binary_data_58[] =
 "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n"
 "<!-- Generator: Adobe Illustrator 19.1.0, SVG Export Plug-In . SVG Version: 6.00 Build 0)  -->\r\n"
 "<svg version=\"1.1\" id=\"Layer_1\" xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" x=\"0px\" y=\"0px\"\r\n"
@@ -5547,10 +6259,10 @@ static const unsigned char temp_binary_data_53[] =
 "\tc7.6,0,12,4.8,12,11c0,5.4-4,9.8-9,10l13,15.5H343.9z\"/>\r\n"
 "</svg>\r\n";
 
-const char* projucer_login_bg_svg = (const char*) temp_binary_data_53;
+const char* projucer_login_bg_svg = (const char*) temp_binary_data_58;
 
 //================== RecentFilesMenuTemplate.nib ==================
-static const unsigned char temp_binary_data_54[] =
+static const unsigned char temp_binary_data_59[] =
 { 98,112,108,105,115,116,48,48,212,0,1,0,2,0,3,0,4,0,5,0,6,1,53,1,54,88,36,118,101,114,115,105,111,110,88,36,111,98,106,101,99,116,115,89,36,97,114,99,104,105,118,101,114,84,36,116,111,112,18,0,1,134,160,175,16,74,0,7,0,8,0,31,0,35,0,36,0,42,0,46,0,50,
 0,53,0,57,0,74,0,77,0,78,0,86,0,87,0,97,0,112,0,113,0,114,0,119,0,120,0,121,0,124,0,128,0,129,0,132,0,143,0,144,0,145,0,149,0,153,0,162,0,163,0,164,0,169,0,173,0,180,0,181,0,182,0,185,0,192,0,193,0,200,0,201,0,208,0,209,0,216,0,217,0,224,0,225,0,226,
 0,229,0,230,0,232,0,249,1,11,1,29,1,30,1,31,1,32,1,33,1,34,1,35,1,36,1,37,1,38,1,39,1,40,1,41,1,42,1,43,1,44,1,47,1,50,85,36,110,117,108,108,219,0,9,0,10,0,11,0,12,0,13,0,14,0,15,0,16,0,17,0,18,0,19,0,20,0,21,0,22,0,23,0,24,0,25,0,26,0,27,0,28,0,29,0,
@@ -5587,10 +6299,10 @@ static const unsigned char temp_binary_data_54[] =
 7,157,7,159,7,161,7,163,7,165,7,167,7,169,7,171,7,173,7,175,7,177,7,179,7,181,7,190,7,192,7,225,7,227,7,229,7,231,7,233,7,235,7,237,7,239,7,241,7,243,7,245,7,247,7,249,7,251,7,253,7,255,8,2,8,5,8,8,8,11,8,14,8,17,8,20,8,23,8,26,8,29,8,32,8,35,8,38,8,
 41,8,44,8,53,8,55,8,56,8,65,8,67,8,68,8,77,8,92,8,97,8,115,8,120,8,134,0,0,0,0,0,0,2,2,0,0,0,0,0,0,1,57,0,0,0,0,0,0,0,0,0,0,0,0,0,0,8,136,0,0 };
 
-const char* RecentFilesMenuTemplate_nib = (const char*) temp_binary_data_54;
+const char* RecentFilesMenuTemplate_nib = (const char*) temp_binary_data_59;
 
 //================== wizard_AnimatedApp.svg ==================
-static const unsigned char temp_binary_data_55[] =
+static const unsigned char temp_binary_data_60[] =
 "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n"
 "<!-- Generator: Adobe Illustrator 18.0.0, SVG Export Plug-In . SVG Version: 6.00 Build 0)  -->\r\n"
 "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\" \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\">\r\n"
@@ -5637,10 +6349,10 @@ static const unsigned char temp_binary_data_55[] =
 "<line opacity=\"0.7\" fill=\"none\" stroke=\"#F29100\" stroke-width=\"1.3469\" stroke-miterlimit=\"10\" x1=\"57.7\" y1=\"48.4\" x2=\"34.2\" y2=\"48.4\"/>\r\n"
 "</svg>\r\n";
 
-const char* wizard_AnimatedApp_svg = (const char*) temp_binary_data_55;
+const char* wizard_AnimatedApp_svg = (const char*) temp_binary_data_60;
 
 //================== wizard_AudioApp.svg ==================
-static const unsigned char temp_binary_data_56[] =
+static const unsigned char temp_binary_data_61[] =
 "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n"
 "<!-- Generator: Adobe Illustrator 18.0.0, SVG Export Plug-In . SVG Version: 6.00 Build 0)  -->\r\n"
 "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\" \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\">\r\n"
@@ -5714,10 +6426,10 @@ static const unsigned char temp_binary_data_56[] =
 "<line fill=\"none\" stroke=\"#F29300\" stroke-width=\"1.5\" stroke-linecap=\"round\" stroke-miterlimit=\"10\" x1=\"118.8\" y1=\"43.8\" x2=\"118.8\" y2=\"44.5\"/>\r\n"
 "</svg>\r\n";
 
-const char* wizard_AudioApp_svg = (const char*) temp_binary_data_56;
+const char* wizard_AudioApp_svg = (const char*) temp_binary_data_61;
 
 //================== wizard_AudioPlugin.svg ==================
-static const unsigned char temp_binary_data_57[] =
+static const unsigned char temp_binary_data_62[] =
 "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n"
 "<!-- Generator: Adobe Illustrator 18.0.0, SVG Export Plug-In . SVG Version: 6.00 Build 0)  -->\r\n"
 "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\" \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\">\r\n"
@@ -5828,10 +6540,10 @@ static const unsigned char temp_binary_data_57[] =
 "</g>\r\n"
 "</svg>\r\n";
 
-const char* wizard_AudioPlugin_svg = (const char*) temp_binary_data_57;
+const char* wizard_AudioPlugin_svg = (const char*) temp_binary_data_62;
 
 //================== wizard_ConsoleApp.svg ==================
-static const unsigned char temp_binary_data_58[] =
+static const unsigned char temp_binary_data_63[] =
 "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n"
 "<!-- Generator: Adobe Illustrator 18.0.0, SVG Export Plug-In . SVG Version: 6.00 Build 0)  -->\r\n"
 "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\" \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\">\r\n"
@@ -5854,10 +6566,10 @@ static const unsigned char temp_binary_data_58[] =
 "</g>\r\n"
 "</svg>\r\n";
 
-const char* wizard_ConsoleApp_svg = (const char*) temp_binary_data_58;
+const char* wizard_ConsoleApp_svg = (const char*) temp_binary_data_63;
 
 //================== wizard_DLL.svg ==================
-static const unsigned char temp_binary_data_59[] =
+static const unsigned char temp_binary_data_64[] =
 "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n"
 "<!-- Generator: Adobe Illustrator 18.0.0, SVG Export Plug-In . SVG Version: 6.00 Build 0)  -->\r\n"
 "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\" \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\">\r\n"
@@ -5900,10 +6612,10 @@ static const unsigned char temp_binary_data_59[] =
 "\tl-7.7,5.3c-0.7,0.5-1.7,0.3-2.2-0.4L70.1,31\"/>\r\n"
 "</svg>\r\n";
 
-const char* wizard_DLL_svg = (const char*) temp_binary_data_59;
+const char* wizard_DLL_svg = (const char*) temp_binary_data_64;
 
 //================== wizard_GUI.svg ==================
-static const unsigned char temp_binary_data_60[] =
+static const unsigned char temp_binary_data_65[] =
 "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n"
 "<!-- Generator: Adobe Illustrator 18.0.0, SVG Export Plug-In . SVG Version: 6.00 Build 0)  -->\r\n"
 "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\" \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\">\r\n"
@@ -5954,10 +6666,10 @@ static const unsigned char temp_binary_data_60[] =
 "\tC0,3.1,3.1,0,6.9,0H130c3.8,0,6.9,3.1,6.9,6.9v101.1C136.9,111.7,133.9,114.8,130,114.8z\"/>\r\n"
 "</svg>\r\n";
 
-const char* wizard_GUI_svg = (const char*) temp_binary_data_60;
+const char* wizard_GUI_svg = (const char*) temp_binary_data_65;
 
 //================== wizard_Highlight.svg ==================
-static const unsigned char temp_binary_data_61[] =
+static const unsigned char temp_binary_data_66[] =
 "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n"
 "<!-- Generator: Adobe Illustrator 18.0.0, SVG Export Plug-In . SVG Version: 6.00 Build 0)  -->\r\n"
 "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\" \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\">\r\n"
@@ -5967,10 +6679,10 @@ static const unsigned char temp_binary_data_61[] =
 "\tV108C136.9,111.8,133.9,114.8,130.1,114.8z\"/>\r\n"
 "</svg>\r\n";
 
-const char* wizard_Highlight_svg = (const char*) temp_binary_data_61;
+const char* wizard_Highlight_svg = (const char*) temp_binary_data_66;
 
 //================== wizard_Openfile.svg ==================
-static const unsigned char temp_binary_data_62[] =
+static const unsigned char temp_binary_data_67[] =
 "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n"
 "<!-- Generator: Adobe Illustrator 18.0.0, SVG Export Plug-In . SVG Version: 6.00 Build 0)  -->\r\n"
 "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\" \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\">\r\n"
@@ -5980,10 +6692,10 @@ static const unsigned char temp_binary_data_62[] =
 "\tc0-3.8,3.1-6.9,6.9-6.9h151.5c3.8,0,6.9,3.1,6.9,6.9v20.9C171.6,68.3,168.5,71.4,164.7,71.4z\"/>\r\n"
 "</svg>\r\n";
 
-const char* wizard_Openfile_svg = (const char*) temp_binary_data_62;
+const char* wizard_Openfile_svg = (const char*) temp_binary_data_67;
 
 //================== wizard_OpenGL.svg ==================
-static const unsigned char temp_binary_data_63[] =
+static const unsigned char temp_binary_data_68[] =
 "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n"
 "<!-- Generator: Adobe Illustrator 18.0.0, SVG Export Plug-In . SVG Version: 6.00 Build 0)  -->\r\n"
 "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\" \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\">\r\n"
@@ -6011,10 +6723,10 @@ static const unsigned char temp_binary_data_63[] =
 "\ts-13.4-19.6-6.9-30\"/>\r\n"
 "</svg>\r\n";
 
-const char* wizard_OpenGL_svg = (const char*) temp_binary_data_63;
+const char* wizard_OpenGL_svg = (const char*) temp_binary_data_68;
 
 //================== wizard_StaticLibrary.svg ==================
-static const unsigned char temp_binary_data_64[] =
+static const unsigned char temp_binary_data_69[] =
 "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n"
 "<!-- Generator: Adobe Illustrator 18.0.0, SVG Export Plug-In . SVG Version: 6.00 Build 0)  -->\r\n"
 "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\" \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\">\r\n"
@@ -6057,7 +6769,7 @@ static const unsigned char temp_binary_data_64[] =
 "\tc-1,0-1.8-0.8-1.8-1.8V20.8\"/>\r\n"
 "</svg>\r\n";
 
-const char* wizard_StaticLibrary_svg = (const char*) temp_binary_data_64;
+const char* wizard_StaticLibrary_svg = (const char*) temp_binary_data_69;
 
 
 const char* getNamedResource (const char*, int&) throw();
@@ -6072,6 +6784,11 @@ const char* getNamedResource (const char* resourceNameUTF8, int& numBytes) throw
     {
         case 0x44af8d54:  numBytes = 8293; return OE_GUI_MoonShard_cpp;
         case 0x636f4459:  numBytes = 2656; return OE_GUI_MoonShard_h;
+        case 0x02a4b491:  numBytes = 529; return openEphys_BlockProcessorBenchmark_example;
+        case 0xad4503e8:  numBytes = 9774; return openEphys_BlockProcessorPluginTemplate_cpp;
+        case 0xde594fed:  numBytes = 5185; return openEphys_BlockProcessorPluginTemplate_h;
+        case 0x1872c36f:  numBytes = 3963; return openEphys_BlockVisualizerCanvasTemplate_cpp;
+        case 0x272f4534:  numBytes = 3711; return openEphys_BlockVisualizerCanvasTemplate_h;
         case 0x49aa52f7:  numBytes = 1627; return openEphys_DataThreadPluginTemplate_cpp;
         case 0x9a9516bc:  numBytes = 1881; return openEphys_DataThreadPluginTemplate_h;
         case 0xd768da9a:  numBytes = 1560; return openEphys_FileSourcePluginTemplate_cpp;
@@ -6146,6 +6863,11 @@ const char* namedResourceList[] =
 {
     "OE_GUI_MoonShard_cpp",
     "OE_GUI_MoonShard_h",
+    "openEphys_BlockProcessorBenchmark_example",
+    "openEphys_BlockProcessorPluginTemplate_cpp",
+    "openEphys_BlockProcessorPluginTemplate_h",
+    "openEphys_BlockVisualizerCanvasTemplate_cpp",
+    "openEphys_BlockVisualizerCanvasTemplate_h",
     "openEphys_DataThreadPluginTemplate_cpp",
     "openEphys_DataThreadPluginTemplate_h",
     "openEphys_FileSourcePluginTemplate_cpp",
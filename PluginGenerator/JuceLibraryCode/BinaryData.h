@@ -15,6 +15,21 @@ namespace BinaryData
     extern const char*   OE_GUI_MoonShard_h;
     const int            OE_GUI_MoonShard_hSize = 2656;
 
+    extern const char*   openEphys_BlockProcessorBenchmark_example;
+    const int            openEphys_BlockProcessorBenchmark_exampleSize = 529;
+
+    extern const char*   openEphys_BlockProcessorPluginTemplate_cpp;
+    const int            openEphys_BlockProcessorPluginTemplate_cppSize = 9774;
+
+    extern const char*   openEphys_BlockProcessorPluginTemplate_h;
+    const int            openEphys_BlockProcessorPluginTemplate_hSize = 5185;
+
+    extern const char*   openEphys_BlockVisualizerCanvasTemplate_cpp;
+    const int            openEphys_BlockVisualizerCanvasTemplate_cppSize = 3963;
+
+    extern const char*   openEphys_BlockVisualizerCanvasTemplate_h;
+    const int            openEphys_BlockVisualizerCanvasTemplate_hSize = 3711;
+
     extern const char*   openEphys_DataThreadPluginTemplate_cpp;
     const int            openEphys_DataThreadPluginTemplate_cppSize = 1627;
 
@@ -208,7 +223,7 @@ namespace BinaryData
     extern const char* namedResourceList[];
 
     // Number of elements in the namedResourceList array.
-    const int namedResourceListSize = 65;
+    const int namedResourceListSize = 70;
 
     // If you provide the name of one of the binary resource variables above, this function will
     // return the corresponding data and its size (or a null pointer if the name isn't found).
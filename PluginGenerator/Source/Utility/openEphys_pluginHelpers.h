@@ -183,13 +183,14 @@ static String getProcessorTypeHumanReadableName (PluginProcessorType processorTy
 // ============================================================================
 // ============================================================================
 
-/** Returns the name of the file which contains template of the processor of a plugin of given type */
-static String getTemplateProcessorFileName (PluginType pluginType)
+/** Returns the name of the file which contains template of the processor of a plugin of given type.
+    Processors can start from the block processing template instead of the basic one. */
+static String getTemplateProcessorFileName (PluginType pluginType, bool useBlockProcessing = false)
 {
     switch (pluginType)
     {
         case PLUGIN_TYPE_PROCESSOR:
-            return "openEphys_ProcessorPluginTemplate";
+            return useBlockProcessing ? "openEphys_BlockProcessorPluginTemplate" : "openEphys_ProcessorPluginTemplate";
         case PLUGIN_TYPE_RECORD_ENGINE:
             return "openEphys_RecordEnginePluginTemplate";
         case PLUGIN_TYPE_DATA_THREAD:
@@ -40,6 +40,7 @@ PluginTemplatesPageComponent::PluginTemplatesPageComponent()
     , m_pluginTypeLabel                     (new Label (String::empty, TRANS("Plugin type") + ":"))
     , m_processorTypeLabel                  (new Label (String::empty, TRANS("Processor type") + ":"))
     , m_shouldUseVisualizerEditorButton     (new ToggleButton ("Use visualizer"))
+    , m_shouldUseBlockProcessingButton      (new ToggleButton ("Process whole blocks"))
     , m_shouldUseDataThreadButton           (new ToggleButton ("Use separate thread"))
     , m_genericEditorTemplatesManager       (new TiledButtonGroupManager)
     , m_visualizerEditorTemplatesManager    (new TiledButtonGroupManager)
@@ -90,6 +91,13 @@ PluginTemplatesPageComponent::PluginTemplatesPageComponent()
     m_shouldUseVisualizerEditorButton->setColour (ToggleButton::textColourId, Colours::white);
     addAndMakeVisible (m_shouldUseVisualizerEditorButton);
 
+    m_shouldUseBlockProcessingButton->addListener (this);
+    m_shouldUseBlockProcessingButton->setColour (ToggleButton::textColourId, Colours::white);
+    m_shouldUseBlockProcessingButton->setTooltip ("Start from a processor that runs vector kernels over ranges of channels "
+                                                  "on the processor thread pool, takes parameters from a lock-free mailbox, "
+                                                  "feeds its visualizer through a lock-free ring and comes with a benchmark target");
+    addAndMakeVisible (m_shouldUseBlockProcessingButton);
+
     m_shouldUseDataThreadButton->addListener (this);
     m_shouldUseDataThreadButton->setColour (ToggleButton::textColourId, Colours::white);
     addChildComponent (m_shouldUseDataThreadButton);
@@ -187,6 +195,8 @@ void PluginTemplatesPageComponent::resized()
     configComponentsBounds.removeFromLeft (20);
     if (m_shouldUseDataThreadButton->isVisible())
         m_shouldUseDataThreadButton->setBounds (configComponentsBounds.removeFromLeft (160));
+    if (m_shouldUseBlockProcessingButton->isVisible())
+        m_shouldUseBlockProcessingButton->setBounds (configComponentsBounds.removeFromLeft (180));
     m_shouldUseVisualizerEditorButton->setBounds (configComponentsBounds);
 
     localBounds.removeFromTop (10);
@@ -275,6 +285,7 @@ void PluginTemplatesPageComponent::updateComponentsVisibility()
     // These components should be visible only if the Processor plugin type was selected
     m_processorTypeComboBox->setVisible            (isProcessorPlugin || isDataThreadPlugin);
     m_shouldUseVisualizerEditorButton->setVisible  (isProcessorPlugin);
+    m_shouldUseBlockProcessingButton->setVisible   (isProcessorPlugin && ! isSourcePlugin);
     m_lookAndFeelsComboBox->setVisible             (isProcessorPlugin);
     m_tabsButtonManager->setVisible                (isProcessorPlugin);
 
@@ -398,6 +409,16 @@ bool PluginTemplatesPageComponent::shouldUseVisualizerEditor() const noexcept
 }
 
 
+bool PluginTemplatesPageComponent::shouldUseBlockProcessing() const noexcept
+{
+    const bool isProcessorPlugin = getSelectedPluginType() == Plugin::PLUGIN_TYPE_PROCESSOR;
+
+    return isProcessorPlugin
+            && getSelectedProcessorType() != Plugin::PROCESSOR_TYPE_SOURCE
+            && m_shouldUseBlockProcessingButton->getToggleState();
+}
+
+
 bool PluginTemplatesPageComponent::shouldUseDataThreadSource() const noexcept
 {
     return isProcessorSourcePlugin() && m_shouldUseDataThreadButton->getToggleState();
@@ -52,6 +52,7 @@ public:
     Plugin::PluginProcessorType getSelectedProcessorType() const noexcept;
 
     bool shouldUseVisualizerEditor() const noexcept;
+    bool shouldUseBlockProcessing()  const noexcept;
     bool shouldUseDataThreadSource() const noexcept;
 
     String getSelectedTemplateName()            const noexcept;
@@ -107,6 +108,7 @@ private:
     ScopedPointer<Label> m_processorTypeLabel;
 
     ScopedPointer<ToggleButton> m_shouldUseVisualizerEditorButton;
+    ScopedPointer<ToggleButton> m_shouldUseBlockProcessingButton;
     ScopedPointer<ToggleButton> m_shouldUseDataThreadButton;
 
     ScopedPointer<TiledButtonGroupManager> m_genericEditorTemplatesManager;
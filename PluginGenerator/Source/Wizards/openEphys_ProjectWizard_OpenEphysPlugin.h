@@ -59,6 +59,7 @@ struct OpenEphysPluginAppWizard   : public NewProjectWizard
         m_processorType = configPage->getSelectedProcessorType();
 
         m_shouldUseVisualizerEditor = configPage->shouldUseVisualizerEditor();
+        m_shouldUseBlockProcessing  = configPage->shouldUseBlockProcessing();
 
         m_guiTemplateName           = configPage->getSelectedTemplateName();
         m_guiVisualizerTemplateName = configPage->getSelectedVisualizerTemplateName();
@@ -115,7 +116,7 @@ struct OpenEphysPluginAppWizard   : public NewProjectWizard
 
         //String appHeaders (CodeHelpers::createIncludeStatement (project.getAppIncludeFile(), filterCppFile));
 
-        generatePluginMakeFile  (project, sourceGroup);
+        generatePluginMakeFile  (project, sourceGroup, pluginFriendlyName);
         generatePluginLibFile   (project, sourceGroup, pluginProcessorName, pluginFriendlyName);
         generatePluginProcessorFiles (project, sourceGroup, pluginProcessorName, pluginEditorName, pluginFriendlyName);
 
@@ -182,9 +183,15 @@ struct OpenEphysPluginAppWizard   : public NewProjectWizard
     }
 
 
-    bool generatePluginMakeFile (const Project& project, Project::Item& sourceGroup)
+    bool generatePluginMakeFile (const Project& project, Project::Item& sourceGroup, const String& pluginFriendlyName)
     {
         String templatePluginMakeFileContent = project.getFileTemplate ("openEphys_PluginMakefile_example");
+
+        // Block processors get a target running the processor benchmark of the GUI on them.
+        // The benchmark takes underscores for the spaces of processor names.
+        if (m_shouldUseBlockProcessing)
+            templatePluginMakeFileContent << project.getFileTemplate ("openEphys_BlockProcessorBenchmark_example")
+                .replace ("BENCHMARKPROCESSORNAME", pluginFriendlyName.replaceCharacter (' ', '_'), false);
         const auto sourceFolder = getSourceFilesFolder();
 
         auto newPluginMakeFile = sourceFolder.getChildFile ("Makefile");
@@ -214,7 +221,7 @@ struct OpenEphysPluginAppWizard   : public NewProjectWizard
         auto newProcessorHFile    = sourceFolder.getChildFile (processorName + ".h");
         auto newEditorHFile       = sourceFolder.getChildFile (editorName + ".h");
 
-        String processorFileTemplateName = getTemplateProcessorFileName (m_pluginType);
+        String processorFileTemplateName = getTemplateProcessorFileName (m_pluginType, m_shouldUseBlockProcessing);
         String processorType             = getProcessorTypeString (m_processorType);
 
         String processorHeaders = CodeHelpers::createIncludeStatement (newProcessorHFile, newProcessorCppFile) + newLine;
@@ -416,11 +423,16 @@ struct OpenEphysPluginAppWizard   : public NewProjectWizard
         String canvasComponentCppFileContent;
         String canvasComponentHFileContent;
 
-        canvasComponentCppFileContent = project.getFileTemplate ("openEphys_ProcessorVisualizerCanvasTemplate_cpp")
+        // The canvas of a block processor reads its display ring
+        const String canvasTemplateName = m_shouldUseBlockProcessing
+                                            ? "openEphys_BlockVisualizerCanvasTemplate"
+                                            : "openEphys_ProcessorVisualizerCanvasTemplate";
+
+        canvasComponentCppFileContent = project.getFileTemplate (canvasTemplateName + "_cpp")
             .replace ("PROCESSORCLASSNAME", processorName, false)
             .replace ("EDITORCANVASCLASSNAME", editorName, false);
 
-        canvasComponentHFileContent = project.getFileTemplate ("openEphys_ProcessorVisualizerCanvasTemplate_h")
+        canvasComponentHFileContent = project.getFileTemplate (canvasTemplateName + "_h")
             .replace ("PROCESSORCLASSNAME", processorName,false)
             .replace ("EDITORCANVASCLASSNAME", editorName, false)
             .replace ("CONTENTCOMPONENTCLASSNAME", contentComponentName, false)
@@ -485,6 +497,7 @@ private:
     String m_contentLookAndFeelClassName;
 
     bool m_shouldUseVisualizerEditor;
+    bool m_shouldUseBlockProcessing { false };
     bool m_shouldChangeContentLookAndFeel;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OpenEphysPluginAppWizard)
@@ -32,6 +32,8 @@ ArduinoOutput::ArduinoOutput()
     , outputChannel         (13)
     , inputChannel          (-1)
     , gateChannel           (-1)
+    , outputQueue           (arduino)
+    , outputDelay           (0.0f)
     , state                 (true)
     , acquisitionIsActive   (false)
     , deviceSelected        (false)
@@ -42,6 +44,8 @@ ArduinoOutput::ArduinoOutput()
 
 ArduinoOutput::~ArduinoOutput()
 {
+    outputQueue.stop();
+
     if (arduino.isInitialized())
         arduino.disconnect();
 }
@@ -102,11 +106,13 @@ void ArduinoOutput::handleEvent (const EventChannel* eventInfo, const MidiMessag
 {
     if (Event::getEventType(event) == EventChannel::TTL)
     {
-		TTLEventPtr ttl = TTLEvent::deserializeFromMessage(event, eventInfo);
+        TTLEventView ttl (event, eventInfo);
+        if (! ttl.isValid())
+            return;
 
         //int eventNodeId = *(dataptr+1);
-        const int eventId         = ttl->getState() ? 1: 0;
-        const int eventChannel    = ttl->getChannel();
+        const int eventId         = ttl.getState() ? 1: 0;
+        const int eventChannel    = ttl.getChannel();
 
         // std::cout << "Received event from " << eventNodeId
         //           << " on channel " << eventChannel
@@ -124,14 +130,13 @@ void ArduinoOutput::handleEvent (const EventChannel* eventInfo, const MidiMessag
         {
             if (inputChannel == -1 || eventChannel == inputChannel)
             {
-                if (eventId == 0)
-                {
-                    arduino.sendDigital (outputChannel, ARD_LOW);
-                }
-                else
-                {
-                    arduino.sendDigital (outputChannel, ARD_HIGH);
-                }
+                DigitalWrite write;
+                write.pin = outputChannel;
+                write.value = eventId == 0 ? ARD_LOW : ARD_HIGH;
+
+                const uint32 sourceId = getProcessorFullId (eventInfo->getTimestampOriginProcessor(),
+                                                            eventInfo->getTimestampOriginSubProcessor());
+                outputQueue.pushAt (write, OutputQueue::getTargetTimestamp (sourceId, ttl.getTimestamp(), outputDelay));
             }
         }
     }
@@ -140,9 +145,24 @@ void ArduinoOutput::handleEvent (const EventChannel* eventInfo, const MidiMessag
 
 void ArduinoOutput::setParameter (int parameterIndex, float newValue)
 {
-    // make sure current output channel is off:
+    if (parameterIndex == 3)
+    {
+        outputDelay = jmax (0.0f, newValue);
+        return;
+    }
+
+    // make sure current output channel is off, without the output queue writing at the same time:
+    if (acquisitionIsActive)
+        outputQueue.stop();
+
     arduino.sendDigital(outputChannel, ARD_LOW);
 
+    if (acquisitionIsActive)
+    {
+        outputQueue.resetPinStates();
+        outputQueue.resume();
+    }
+
     if (parameterIndex == 0)
     {
         outputChannel = (int) newValue;
@@ -181,16 +201,37 @@ void ArduinoOutput::setGateChannel (int chan)
 }
 
 
+void ArduinoOutput::setOutputDelay (float delayMs)
+{
+    setParameter (3, delayMs);
+}
+
+
+float ArduinoOutput::getOutputDelay() const
+{
+    return outputDelay;
+}
+
+
 bool ArduinoOutput::enable()
 {
     acquisitionIsActive = true;
 
+    if (deviceSelected)
+    {
+        outputQueue.resetPinStates();
+        outputQueue.start();
+    }
+
     return deviceSelected;
 }
 
 
 bool ArduinoOutput::disable()
 {
+    outputQueue.stop();
+    std::cout << "Arduino Output: " << outputQueue.getStatistics() << std::endl;
+
     arduino.sendDigital (outputChannel, ARD_LOW);
     acquisitionIsActive = false;
 
@@ -202,3 +243,39 @@ void ArduinoOutput::process (AudioSampleBuffer& buffer)
 {
     checkForEvents ();
 }
+
+
+ArduinoOutput::OutputQueue::OutputQueue (ofArduino& arduino_)
+    : SerialCommandQueue<DigitalWrite> ("Arduino Output", 256)
+    , arduino (arduino_)
+{
+}
+
+
+ArduinoOutput::OutputQueue::~OutputQueue()
+{
+    stop();
+}
+
+
+void ArduinoOutput::OutputQueue::resetPinStates()
+{
+    pinStates.clearQuick();
+}
+
+
+bool ArduinoOutput::OutputQueue::sendCommand (const DigitalWrite& command)
+{
+    if (command.pin < 0)
+        return false;
+
+    while (pinStates.size() <= command.pin)
+        pinStates.add (-1);
+
+    if (pinStates[command.pin] == command.value)
+        return false;
+
+    arduino.sendDigital (command.pin, command.value);
+    pinStates.set (command.pin, command.value);
+    return true;
+}
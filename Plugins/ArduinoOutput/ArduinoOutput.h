@@ -37,6 +37,11 @@
 
     Based on Open Frameworks ofArduino class.
 
+    The digital writes are sent to the board by a SerialCommandQueue, so that the serial port
+    is never written from the audio callback. Each one is scheduled for the timestamp of the
+    event that caused it plus the output delay. Writes that would not change the state of the
+    pin are skipped.
+
     @see GenericProcessor
  */
 class ArduinoOutput : public GenericProcessor
@@ -47,6 +52,9 @@ public:
 
     /** Searches for events and triggers the Arduino output when appropriate. */
     void process (AudioSampleBuffer& buffer) override;
+    bool readsContinuousData() const override { return false; }
+    bool modifiesContinuousData() const override { return false; }
+    bool emitsEvents() const override { return false; }
 
     /** Currently unused. Future uses may include changing the TTL trigger channel
     or the output channel of the Arduino. */
@@ -68,6 +76,10 @@ public:
     void setInputChannel  (int);
     void setGateChannel   (int);
 
+    /** Sets the time between an input event and the output write, in ms */
+    void setOutputDelay (float delayMs);
+    float getOutputDelay() const;
+
     void setDevice (String deviceString);
 
     int outputChannel;
@@ -79,6 +91,33 @@ private:
     /** An open-frameworks Arduino object. */
     ofArduino arduino;
 
+    struct DigitalWrite
+    {
+        int pin;
+        int value;
+    };
+
+    /** Sends the digital writes queued by handleEvent() */
+    class OutputQueue : public SerialCommandQueue<DigitalWrite>
+    {
+    public:
+        OutputQueue (ofArduino& arduino);
+        ~OutputQueue();
+
+        /** Forgets the states written so far, so that the next write to every pin is sent */
+        void resetPinStates();
+
+    private:
+        bool sendCommand (const DigitalWrite& command) override;
+
+        ofArduino& arduino;
+        Array<int> pinStates;
+    };
+
+    OutputQueue outputQueue;
+
+    float outputDelay;
+
     bool state;
     bool acquisitionIsActive;
     bool deviceSelected;
@@ -96,6 +96,19 @@ ArduinoOutputEditor::ArduinoOutputEditor(GenericProcessor* parentNode, bool useD
     gateChannelSelector->setSelectedId(1, dontSendNotification);
     addAndMakeVisible(gateChannelSelector);
 
+    delayCaption = new Label("DelayCaption", "Delay (ms)");
+    delayCaption->setFont(Font("Small Text", 12, Font::plain));
+    delayCaption->setBounds(70,30,70,20);
+    addAndMakeVisible(delayCaption);
+
+    delayLabel = new Label("Delay", String(arduino->getOutputDelay()));
+    delayLabel->setEditable(true,false,false);
+    delayLabel->addListener(this);
+    delayLabel->setTooltip("Time between the input event and the output, the write is scheduled on the event's timestamp");
+    delayLabel->setBounds(70,55,65,20);
+    delayLabel->setColour(Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible(delayLabel);
+
 }
 
 ArduinoOutputEditor::~ArduinoOutputEditor()
@@ -127,6 +140,15 @@ void ArduinoOutputEditor::comboBoxChanged(ComboBox* comboBoxThatHasChanged)
     }
 }
 
+void ArduinoOutputEditor::labelTextChanged(Label* label)
+{
+    if (label == delayLabel)
+    {
+        arduino->setOutputDelay(label->getText().getFloatValue());
+        label->setText(String(arduino->getOutputDelay()), dontSendNotification);
+    }
+}
+
 void ArduinoOutputEditor::timerCallback()
 {
 
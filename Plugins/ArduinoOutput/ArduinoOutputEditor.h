@@ -40,7 +40,8 @@ class ImageIcon;
 */
 
 class ArduinoOutputEditor : public GenericEditor,
-                            public ComboBox::Listener
+                            public ComboBox::Listener,
+                            public Label::Listener
 
 {
 public:
@@ -52,6 +53,7 @@ public:
     ImageIcon* icon;
 
     void comboBoxChanged(ComboBox* comboBoxThatHasChanged);
+    void labelTextChanged(Label* label);
 
     ArduinoOutput* arduino;
 
@@ -64,6 +66,8 @@ private:
     ScopedPointer<ComboBox> outputChannelSelector;
     ScopedPointer<ComboBox> gateChannelSelector;
     ScopedPointer<ComboBox> deviceSelector;
+    ScopedPointer<Label> delayCaption;
+    ScopedPointer<Label> delayLabel;
 
     void timerCallback();
 
@@ -0,0 +1,299 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include "BandPowerCanvas.h"
+#include "BandPowerNode.h"
+
+
+namespace
+{
+    const int topMargin = 30;
+    const int leftMargin = 60;
+    const int rightMargin = 70;
+    const int bottomMargin = 20;
+
+    // columns between two recomputations of the colour range
+    const int redrawInterval = 30;
+}
+
+
+BandPowerCanvas::BandPowerCanvas(BandPowerNode* p)
+    : processor(p),
+      band(BandPowerNode::THETA),
+      numChannels(0),
+      numColumns(0),
+      columnsDrawn(0),
+      columnsSinceRedraw(0),
+      minPower(0.0f),
+      maxPower(1.0f)
+{
+    // a new column comes every few hundred ms at most
+    refreshRate = 10;
+
+    // blue for low power through green to red for high power
+    for (int i = 0; i < 256; ++i)
+        colourMap[i] = Colour::fromHSV((1.0f - i / 255.0f) * 0.67f, 1.0f, 1.0f, 1.0f);
+
+    bandSelector = new ComboBox("band selector");
+    for (int b = 0; b < BandPowerNode::NUM_BANDS; ++b)
+        bandSelector->addItem(BandPowerNode::getBandName(b) + " ("
+                              + String(BandPowerNode::getBandLow(b)) + "-"
+                              + String(BandPowerNode::getBandHigh(b)) + " Hz)", b + 1);
+    bandSelector->setSelectedId(band + 1, dontSendNotification);
+    bandSelector->addListener(this);
+    addAndMakeVisible(bandSelector);
+
+    update();
+}
+
+BandPowerCanvas::~BandPowerCanvas()
+{
+
+}
+
+
+void BandPowerCanvas::update()
+{
+    numChannels = processor->getNumAnalysedChannels();
+    numColumns = processor->getNumColumns();
+
+    heatMap = Image(Image::RGB, jmax(1, numColumns), jmax(1, numChannels), true);
+    columnBuffer.assign(jmax(1, numChannels), 0.0f);
+
+    redrawAll();
+    repaint();
+}
+
+
+void BandPowerCanvas::refreshState()
+{
+    redrawAll();
+    repaint();
+}
+
+
+void BandPowerCanvas::beginAnimation()
+{
+    columnsDrawn = 0;
+    redrawAll();
+
+    startCallbacks();
+}
+
+
+void BandPowerCanvas::endAnimation()
+{
+    stopCallbacks();
+}
+
+
+void BandPowerCanvas::refresh()
+{
+    if (processor->getNumAnalysedChannels() != numChannels)
+    {
+        update();
+        return;
+    }
+
+    const int64 numComputed = processor->getNumColumnsComputed();
+    const int64 numNew = numComputed - columnsDrawn;
+
+    if (numNew == 0)
+        return;
+
+    if (numNew < 0 || numNew >= numColumns || columnsSinceRedraw + numNew >= redrawInterval)
+    {
+        redrawAll();
+    }
+    else
+    {
+        // new columns only widen the range, redrawAll() narrows it again
+        for (int age = int(numNew) - 1; age >= 0; --age)
+        {
+            if (! processor->getColumn(band, age, columnBuffer.data()))
+                continue;
+
+            for (int c = 0; c < numChannels; ++c)
+            {
+                minPower = jmin(minPower, columnBuffer[c]);
+                maxPower = jmax(maxPower, columnBuffer[c]);
+            }
+
+            drawColumn(numComputed - 1 - age, columnBuffer.data());
+        }
+
+        columnsDrawn = numComputed;
+        columnsSinceRedraw += int(numNew);
+    }
+
+    repaint();
+}
+
+
+void BandPowerCanvas::redrawAll()
+{
+    heatMap.clear(heatMap.getBounds());
+
+    const int64 numComputed = processor->getNumColumnsComputed();
+    const int numShown = int(jmin(numComputed, int64(numColumns)));
+
+    columnsDrawn = numComputed;
+    columnsSinceRedraw = 0;
+
+    if (numChannels == 0 || numShown == 0)
+        return;
+
+    std::vector<float> shown(size_t(numShown) * numChannels);
+
+    for (int age = 0; age < numShown; ++age)
+        processor->getColumn(band, age, shown.data() + size_t(age) * numChannels);
+
+    minPower = *std::min_element(shown.begin(), shown.end());
+    maxPower = *std::max_element(shown.begin(), shown.end());
+
+    for (int age = 0; age < numShown; ++age)
+        drawColumn(numComputed - 1 - age, shown.data() + size_t(age) * numChannels);
+}
+
+
+void BandPowerCanvas::drawColumn(int64 index, const float* power)
+{
+    const int x = int(index % numColumns);
+    const float scale = 255.0f / jmax(maxPower - minPower, 1e-3f);
+
+    Image::BitmapData pixels(heatMap, Image::BitmapData::writeOnly);
+
+    for (int c = 0; c < numChannels; ++c)
+        pixels.setPixelColour(x, c, colourMap[jlimit(0, 255, roundToInt((power[c] - minPower) * scale))]);
+}
+
+
+Rectangle<int> BandPowerCanvas::getMapArea() const
+{
+    return Rectangle<int>(leftMargin, topMargin,
+                          jmax(1, getWidth() - leftMargin - rightMargin),
+                          jmax(1, getHeight() - topMargin - bottomMargin));
+}
+
+
+void BandPowerCanvas::resized()
+{
+    bandSelector->setBounds(leftMargin, 5, 180, 20);
+}
+
+
+void BandPowerCanvas::paint(Graphics& g)
+{
+    g.fillAll(Colours::black);
+
+    const Rectangle<int> area = getMapArea();
+
+    g.setColour(Colours::grey);
+    g.setFont(12);
+
+    if (numChannels == 0)
+    {
+        g.drawText("No input channels", area, Justification::centred);
+        return;
+    }
+
+    // the oldest column is the one after the newest in the ring, and goes on the left
+    const int newest = columnsDrawn > 0 ? int((columnsDrawn - 1) % numColumns) : numColumns - 1;
+    const int numOlder = numColumns - 1 - newest;
+    const int split = area.getX() + area.getWidth() * numOlder / numColumns;
+
+    g.setImageResamplingQuality(Graphics::lowResamplingQuality);
+
+    if (numOlder > 0)
+        g.drawImage(heatMap, area.getX(), area.getY(), split - area.getX(), area.getHeight(),
+                    newest + 1, 0, numOlder, numChannels);
+
+    g.drawImage(heatMap, split, area.getY(), area.getRight() - split, area.getHeight(),
+                0, 0, newest + 1, numChannels);
+
+    // channel names, as many as fit
+    const float rowHeight = area.getHeight() / float(numChannels);
+    const int step = jmax(1, int(std::ceil(14.0f / rowHeight)));
+
+    g.setColour(Colours::lightgrey);
+
+    for (int c = 0; c < numChannels; c += step)
+    {
+        const int y = area.getY() + int(rowHeight * (c + 0.5f)) - 7;
+        g.drawText(processor->getDataChannel(processor->getInputChannel(c))->getName(),
+                   0, y, leftMargin - 5, 14, Justification::centredRight);
+    }
+
+    // time axis
+    const float duration = numColumns * processor->getColumnInterval();
+    g.drawText(String(-duration, 1) + " s", area.getX(), area.getBottom() + 2, 80, 16, Justification::left);
+    g.drawText("0 s", area.getRight() - 80, area.getBottom() + 2, 80, 16, Justification::right);
+
+    // colour scale
+    const int barX = area.getRight() + 10;
+    const int barWidth = 12;
+
+    for (int y = 0; y < area.getHeight(); ++y)
+    {
+        g.setColour(colourMap[jlimit(0, 255, 255 - y * 256 / area.getHeight())]);
+        g.fillRect(barX, area.getY() + y, barWidth, 1);
+    }
+
+    g.setColour(Colours::lightgrey);
+    g.drawText(String(maxPower, 1) + " dB", barX + barWidth + 2, area.getY(), rightMargin - barWidth - 12, 14, Justification::left);
+    g.drawText(String(minPower, 1) + " dB", barX + barWidth + 2, area.getBottom() - 14, rightMargin - barWidth - 12, 14, Justification::left);
+}
+
+
+void BandPowerCanvas::comboBoxChanged(ComboBox* comboBox)
+{
+    if (comboBox == bandSelector)
+    {
+        band = bandSelector->getSelectedId() - 1;
+        redrawAll();
+        repaint();
+    }
+}
+
+
+void BandPowerCanvas::saveVisualizerParameters(XmlElement* xml)
+{
+    XmlElement* xmlNode = xml->createNewChildElement("BANDPOWER");
+    xmlNode->setAttribute("Band", band);
+}
+
+
+void BandPowerCanvas::loadVisualizerParameters(XmlElement* xml)
+{
+    forEachXmlChildElement(*xml, xmlNode)
+    {
+        if (xmlNode->hasTagName("BANDPOWER"))
+        {
+            const int b = xmlNode->getIntAttribute("Band", band);
+
+            if (isPositiveAndBelow(b, int(BandPowerNode::NUM_BANDS)))
+                bandSelector->setSelectedId(b + 1, sendNotificationSync);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef __BANDPOWERCANVAS_H__
+#define __BANDPOWERCANVAS_H__
+
+#include <VisualizerWindowHeaders.h>
+
+class BandPowerNode;
+
+/**
+
+  Shows the power of one band in every analysed channel as a heat map, channels
+  from top to bottom and the newest column on the right.
+
+  The colours span the range of the columns shown, which is recomputed every few
+  columns so that it follows slow changes of the signal level.
+
+  @see BandPowerNode, BandPowerEditor
+
+*/
+
+class BandPowerCanvas : public Visualizer,
+    public ComboBox::Listener
+{
+public:
+    BandPowerCanvas(BandPowerNode* processor);
+    ~BandPowerCanvas();
+
+    void paint(Graphics& g);
+    void resized();
+
+    void refresh();
+    void refreshState();
+    void update();
+    void beginAnimation();
+    void endAnimation();
+    void setParameter(int, float) {}
+    void setParameter(int, int, int, float) {}
+
+    void comboBoxChanged(ComboBox* comboBox);
+
+    void saveVisualizerParameters(XmlElement* xml);
+    void loadVisualizerParameters(XmlElement* xml);
+
+private:
+    /** Redraws every column kept by the processor, recomputing the colour range */
+    void redrawAll();
+
+    void drawColumn(int64 index, const float* power);
+
+    Rectangle<int> getMapArea() const;
+
+    BandPowerNode* processor;
+
+    ScopedPointer<ComboBox> bandSelector;
+    int band;
+
+    Image heatMap; // one pixel per channel and column, columns stored as a ring
+    Colour colourMap[256];
+    std::vector<float> columnBuffer;
+    int numChannels;
+    int numColumns;
+    int64 columnsDrawn;
+    int columnsSinceRedraw;
+    float minPower;
+    float maxPower;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BandPowerCanvas);
+
+};
+
+
+
+#endif  // __BANDPOWERCANVAS_H__
@@ -0,0 +1,119 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include "BandPowerEditor.h"
+#include "BandPowerNode.h"
+#include "BandPowerCanvas.h"
+
+
+namespace
+{
+    // selectable window lengths in seconds, item ids counting from 1
+    const float windowLengths[] = { 0.5f, 1.0f, 2.0f, 4.0f };
+    const int numWindowLengths = 4;
+}
+
+
+BandPowerEditor::BandPowerEditor(GenericProcessor* parentNode, bool useDefaultParameterEditors=true)
+    : VisualizerEditor(parentNode, 150, useDefaultParameterEditors)
+
+{
+    bandPowerNode = (BandPowerNode*) parentNode;
+    tabText = "Band Power";
+
+    windowLabel = new Label("window label", "Window:");
+    windowLabel->setBounds(10,30,120,20);
+    windowLabel->setFont(Font("Small Text", 12, Font::plain));
+    windowLabel->setColour(Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible(windowLabel);
+
+    windowSelector = new ComboBox("window selector");
+    for (int i = 0; i < numWindowLengths; ++i)
+        windowSelector->addItem(String(windowLengths[i]) + " s", i + 1);
+    windowSelector->setBounds(15,50,70,18);
+    windowSelector->setTooltip("Length of the segments the band power is computed over; they overlap by three quarters");
+    windowSelector->addListener(this);
+    addAndMakeVisible(windowSelector);
+
+    channelsLabel = new Label("channels label", "");
+    channelsLabel->setBounds(10,75,130,20);
+    channelsLabel->setFont(Font("Small Text", 10, Font::plain));
+    channelsLabel->setColour(Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible(channelsLabel);
+
+    updateSettings();
+}
+
+BandPowerEditor::~BandPowerEditor()
+{
+
+}
+
+
+void BandPowerEditor::updateSettings()
+{
+    int selected = 1;
+
+    for (int i = 0; i < numWindowLengths; ++i)
+    {
+        if (std::abs(windowLengths[i] - bandPowerNode->getWindowLength())
+            < std::abs(windowLengths[selected - 1] - bandPowerNode->getWindowLength()))
+            selected = i + 1;
+    }
+
+    windowSelector->setSelectedId(selected, dontSendNotification);
+
+    const int numChannels = bandPowerNode->getNumAnalysedChannels();
+    channelsLabel->setText(numChannels > 0 ? String(numChannels) + " channels" : "", dontSendNotification);
+}
+
+
+void BandPowerEditor::comboBoxChanged(ComboBox* comboBox)
+{
+    if (comboBox == windowSelector)
+    {
+        bandPowerNode->setParameter(0, windowLengths[windowSelector->getSelectedId() - 1]);
+
+        // the segments get their new size
+        CoreServices::updateSignalChain(this);
+    }
+}
+
+
+void BandPowerEditor::startAcquisition()
+{
+    windowSelector->setEnabled(false);
+}
+
+
+void BandPowerEditor::stopAcquisition()
+{
+    windowSelector->setEnabled(true);
+}
+
+
+Visualizer* BandPowerEditor::createNewCanvas()
+{
+    return new BandPowerCanvas(bandPowerNode);
+}
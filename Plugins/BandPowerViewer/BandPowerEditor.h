@@ -0,0 +1,69 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef __BANDPOWEREDITOR_H__
+#define __BANDPOWEREDITOR_H__
+
+#include <VisualizerEditorHeaders.h>
+
+class BandPowerNode;
+
+/**
+
+  User interface for the BandPowerNode processor.
+
+  @see BandPowerNode, BandPowerCanvas
+
+*/
+
+class BandPowerEditor : public VisualizerEditor,
+    public ComboBox::Listener
+{
+public:
+    BandPowerEditor(GenericProcessor* parentNode, bool useDefaultParameterEditors);
+    virtual ~BandPowerEditor();
+
+    void comboBoxChanged(ComboBox* comboBox);
+
+    void updateSettings();
+
+    void startAcquisition() override;
+    void stopAcquisition() override;
+
+    Visualizer* createNewCanvas();
+
+private:
+    BandPowerNode* bandPowerNode;
+
+    ScopedPointer<Label> windowLabel;
+    ScopedPointer<ComboBox> windowSelector;
+    ScopedPointer<Label> channelsLabel;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BandPowerEditor);
+
+};
+
+
+
+#endif  // __BANDPOWEREDITOR_H__
@@ -0,0 +1,356 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include "BandPowerNode.h"
+#include "BandPowerEditor.h"
+
+
+namespace
+{
+    const float bandEdges[BandPowerNode::NUM_BANDS + 1] = { 1.0f, 4.0f, 8.0f, 13.0f, 30.0f, 80.0f, 150.0f };
+    const char* const bandNames[BandPowerNode::NUM_BANDS] = { "Delta", "Theta", "Alpha", "Beta", "Gamma", "High gamma" };
+
+    // columns kept for the display, and most samples analysed by the worker thread at once
+    const int numColumnsKept = 480;
+    const int maxChunkSize = 4096;
+}
+
+
+String BandPowerNode::getBandName (int band)
+{
+    return isPositiveAndBelow (band, int (NUM_BANDS)) ? bandNames[band] : "";
+}
+
+
+float BandPowerNode::getBandLow (int band)
+{
+    return isPositiveAndBelow (band, int (NUM_BANDS)) ? bandEdges[band] : 0.0f;
+}
+
+
+float BandPowerNode::getBandHigh (int band)
+{
+    return isPositiveAndBelow (band, int (NUM_BANDS)) ? bandEdges[band + 1] : 0.0f;
+}
+
+
+BandPowerNode::BandPowerNode()
+    : GenericProcessor      ("Band Power Viewer")
+    , Thread                ("Band power analysis")
+    , sampleRate            (0.0f)
+    , windowLength          (1.0f)
+    , analyser              (*this)
+    , binWidth              (1.0f)
+    , numColumnsComputed    (0)
+{
+    setProcessorType (PROCESSOR_TYPE_SINK);
+
+    for (int b = 0; b < NUM_BANDS; ++b)
+        firstBin[b] = lastBin[b] = 0;
+}
+
+
+BandPowerNode::~BandPowerNode()
+{
+    stopThread (1000);
+}
+
+
+AudioProcessorEditor* BandPowerNode::createEditor()
+{
+    editor = new BandPowerEditor (this, true);
+
+    return editor;
+}
+
+
+void BandPowerNode::setParameter (int parameterIndex, float newValue)
+{
+    // takes effect through updateSettings(), which resizes the segments
+    if (parameterIndex == 0)
+        windowLength = jlimit (0.25f, 8.0f, newValue);
+}
+
+
+void BandPowerNode::updateSettings()
+{
+    channels.clear();
+    sampleRate = 0.0f;
+
+    for (int n = 0; n < getNumInputs(); ++n)
+    {
+        const float rate = dataChannelArray[n]->getSampleRate();
+
+        if (channels.size() == 0)
+            sampleRate = rate;
+
+        if (rate == sampleRate)
+            channels.add (n);
+    }
+
+    const int numChannels = channels.size();
+
+    // decimate for as long as the highest band stays below a third of the rate
+    int numStages = 0;
+    while (numStages < 8 && sampleRate / float (2 << numStages) >= 3.0f * getBandHigh (HIGH_GAMMA))
+        ++numStages;
+
+    decimator.setup (numChannels, numStages);
+
+    const float decimatedRate = sampleRate > 0 ? sampleRate / decimator.getFactor() : 1.0f;
+    const int segmentSize = nextPowerOfTwo (jmax (16, roundToInt (windowLength * decimatedRate)));
+
+    analyser.setup (numChannels, segmentSize, segmentSize / 4, decimatedRate);
+    binWidth = decimatedRate / segmentSize;
+
+    // the bands don't share bins, and each has at least one
+    const int numBins = analyser.getNumBins();
+
+    for (int b = 0; b < NUM_BANDS; ++b)
+    {
+        firstBin[b] = jlimit (1, numBins - 1, roundToInt (getBandLow (b) / binWidth));
+        lastBin[b] = jlimit (firstBin[b], numBins - 1, roundToInt (getBandHigh (b) / binWidth) - 1);
+    }
+
+    // a couple of seconds of input lets the worker thread fall behind without losing samples
+    const int fifoSize = jmax (16384, nextPowerOfTwo (roundToInt (2 * sampleRate)));
+    fifo = new AbstractFifo (fifoSize);
+    fifoBuffer.setSize (jmax (1, numChannels), fifoSize);
+
+    decimatedBuffer.setSize (jmax (1, numChannels), maxChunkSize);
+    inputPointers.calloc (jmax (1, numChannels));
+    outputPointers.calloc (jmax (1, numChannels));
+
+    for (int c = 0; c < numChannels; ++c)
+        outputPointers[c] = decimatedBuffer.getWritePointer (c);
+
+    const ScopedLock sl (columnLock);
+    columns.assign (size_t (numColumnsKept) * NUM_BANDS * numChannels, 0.0f);
+    numColumnsComputed = 0;
+}
+
+
+bool BandPowerNode::enable()
+{
+    decimator.reset();
+    analyser.reset();
+
+    if (fifo != nullptr)
+        fifo->reset();
+
+    {
+        const ScopedLock sl (columnLock);
+        std::fill (columns.begin(), columns.end(), 0.0f);
+        numColumnsComputed = 0;
+    }
+
+    if (channels.size() > 0)
+        startThread();
+
+    return isEnabled;
+}
+
+
+bool BandPowerNode::disable()
+{
+    stopThread (1000);
+
+    return true;
+}
+
+
+void BandPowerNode::process (AudioSampleBuffer& buffer)
+{
+    const int numChannels = channels.size();
+
+    if (numChannels == 0 || fifo == nullptr)
+        return;
+
+    // samples that don't fit are dropped: the display shows a gap rather than hold up
+    // the audio thread
+    const int numSamples = getNumSamples (channels[0]);
+    int start1, size1, start2, size2;
+    fifo->prepareToWrite (numSamples, start1, size1, start2, size2);
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        const int available = jmin (int (getNumSamples (channels[c])), buffer.getNumSamples());
+        const int count1 = jlimit (0, size1, available);
+        const int count2 = jlimit (0, size2, available - size1);
+
+        fifoBuffer.copyFrom (c, start1, buffer, channels[c], 0, count1);
+        fifoBuffer.clear (c, start1 + count1, size1 - count1);
+
+        fifoBuffer.copyFrom (c, start2, buffer, channels[c], size1, count2);
+        fifoBuffer.clear (c, start2 + count2, size2 - count2);
+    }
+
+    fifo->finishedWrite (size1 + size2);
+}
+
+
+void BandPowerNode::run()
+{
+    const int numChannels = channels.size();
+
+    while (! threadShouldExit())
+    {
+        const int numReady = jmin (fifo->getNumReady(), maxChunkSize);
+
+        if (numReady == 0)
+        {
+            wait (10);
+            continue;
+        }
+
+        int start1, size1, start2, size2;
+        fifo->prepareToRead (numReady, start1, size1, start2, size2);
+
+        const int starts[2] = { start1, start2 };
+        const int sizes[2] = { size1, size2 };
+
+        for (int block = 0; block < 2; ++block)
+        {
+            if (sizes[block] == 0)
+                continue;
+
+            for (int c = 0; c < numChannels; ++c)
+                inputPointers[c] = fifoBuffer.getReadPointer (c, starts[block]);
+
+            const int numDecimated = decimator.process (0, numChannels, sizes[block],
+                                                        inputPointers, outputPointers);
+            analyser.process (numDecimated, outputPointers);
+        }
+
+        fifo->finishedRead (size1 + size2);
+    }
+}
+
+
+void BandPowerNode::Analyser::addSegment (const float* spectra)
+{
+    owner.addColumn (spectra);
+}
+
+
+void BandPowerNode::addColumn (const float* spectra)
+{
+    const int numChannels = channels.size();
+    const int numBins = analyser.getNumBins();
+
+    const ScopedLock sl (columnLock);
+
+    float* column = columns.data() + size_t (numColumnsComputed % numColumnsKept) * NUM_BANDS * numChannels;
+
+    for (int b = 0; b < NUM_BANDS; ++b)
+    {
+        for (int c = 0; c < numChannels; ++c)
+        {
+            const float* density = spectra + size_t (c) * numBins;
+            float power = 0.0f;
+
+            for (int k = firstBin[b]; k <= lastBin[b]; ++k)
+                power += density[k];
+
+            column[b * numChannels + c] = 10.0f * std::log10 (jmax (power * binWidth, 1e-12f));
+        }
+    }
+
+    ++numColumnsComputed;
+}
+
+
+float BandPowerNode::getWindowLength() const
+{
+    return windowLength;
+}
+
+
+float BandPowerNode::getColumnInterval() const
+{
+    return sampleRate > 0 ? float (analyser.getSegmentSize() / 4) * decimator.getFactor() / sampleRate : 0.0f;
+}
+
+
+int BandPowerNode::getNumAnalysedChannels() const
+{
+    return channels.size();
+}
+
+
+int BandPowerNode::getInputChannel (int channel) const
+{
+    return channels[channel];
+}
+
+
+int BandPowerNode::getNumColumns() const
+{
+    return numColumnsKept;
+}
+
+
+int64 BandPowerNode::getNumColumnsComputed() const
+{
+    const ScopedLock sl (columnLock);
+
+    return numColumnsComputed;
+}
+
+
+bool BandPowerNode::getColumn (int band, int age, float* power) const
+{
+    const int numChannels = channels.size();
+
+    const ScopedLock sl (columnLock);
+
+    if (! isPositiveAndBelow (band, int (NUM_BANDS)) || ! isPositiveAndBelow (age, numColumnsKept)
+        || age >= numColumnsComputed)
+        return false;
+
+    const int64 index = (numColumnsComputed - 1 - age) % numColumnsKept;
+    const float* column = columns.data() + size_t (index) * NUM_BANDS * numChannels + size_t (band) * numChannels;
+    std::copy (column, column + numChannels, power);
+
+    return true;
+}
+
+
+void BandPowerNode::saveCustomParametersToXml (XmlElement* parentElement)
+{
+    XmlElement* mainNode = parentElement->createNewChildElement ("BANDPOWER");
+    mainNode->setAttribute ("window", windowLength);
+}
+
+
+void BandPowerNode::loadCustomParametersFromXml()
+{
+    if (parametersAsXml == nullptr)
+        return;
+
+    forEachXmlChildElementWithTagName (*parametersAsXml, mainNode, "BANDPOWER")
+    {
+        windowLength = jlimit (0.25f, 8.0f, float (mainNode->getDoubleAttribute ("window", 1.0)));
+    }
+}
@@ -0,0 +1,151 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __BANDPOWERNODE_H__
+#define __BANDPOWERNODE_H__
+
+#include <ProcessorHeaders.h>
+#include <DspLib.h>
+
+
+/**
+    Computes the power of every input channel in the classic frequency bands, over
+    a sliding window, for display as a channel by time heat map.
+
+    The audio thread only copies the channels into a lock-free FIFO. A worker thread
+    reads them from there, decimates them with a cascade of half-band filters, and
+    computes Hann windowed spectra of overlapping segments of the window length.
+    The power of each band is kept, in dB, for the last getNumColumns() segments.
+
+    Only the channels at the sample rate of the first input are analysed.
+
+    @see BandPowerCanvas, BandPowerEditor, Dsp::ShortTimeSpectrum
+*/
+class BandPowerNode : public GenericProcessor,
+    private Thread
+{
+public:
+    enum Band
+    {
+        DELTA = 0,
+        THETA,
+        ALPHA,
+        BETA,
+        GAMMA,
+        HIGH_GAMMA,
+        NUM_BANDS
+    };
+
+    static String getBandName (int band);
+    static float getBandLow (int band);
+    static float getBandHigh (int band);
+
+    BandPowerNode();
+    ~BandPowerNode();
+
+    AudioProcessorEditor* createEditor() override;
+
+    bool hasEditor() const override { return true; }
+
+    void process (AudioSampleBuffer& buffer) override;
+    bool modifiesContinuousData() const override { return false; }
+    bool readsEvents() const override { return false; }
+    bool emitsEvents() const override { return false; }
+
+    /** Parameter 0 sets the window length in seconds. Takes effect through updateSettings(). */
+    void setParameter (int parameterIndex, float newValue) override;
+
+    void updateSettings() override;
+
+    bool enable() override;
+    bool disable() override;
+
+    void saveCustomParametersToXml (XmlElement* parentElement) override;
+    void loadCustomParametersFromXml() override;
+
+    float getWindowLength() const;
+
+    /** Time between two columns, in seconds */
+    float getColumnInterval() const;
+
+    /** Number of analysed channels */
+    int getNumAnalysedChannels() const;
+
+    /** Index in the input of an analysed channel */
+    int getInputChannel (int channel) const;
+
+    /** Number of columns kept */
+    int getNumColumns() const;
+
+    /** Number of columns computed since acquisition started */
+    int64 getNumColumnsComputed() const;
+
+    /** Copies the power, in dB, of every analysed channel in a band, in the column computed
+        age columns before the latest one. Returns false if that column isn't kept. */
+    bool getColumn (int band, int age, float* power) const;
+
+private:
+    void run() override;
+
+    /** Band powers of every segment computed by the worker thread */
+    class Analyser : public Dsp::ShortTimeSpectrum
+    {
+    public:
+        Analyser (BandPowerNode& node) : owner (node) {}
+
+    protected:
+        void addSegment (const float* spectra) override;
+
+    private:
+        BandPowerNode& owner;
+    };
+
+    void addColumn (const float* spectra);
+
+    Array<int> channels;
+    float sampleRate;
+    float windowLength;
+
+    // written by the audio thread, read by the worker thread
+    ScopedPointer<AbstractFifo> fifo;
+    AudioSampleBuffer fifoBuffer;
+
+    // worker thread only
+    Dsp::HalfBandDecimator decimator;
+    Analyser analyser;
+    AudioSampleBuffer decimatedBuffer;
+    HeapBlock<const float*> inputPointers;
+    HeapBlock<float*> outputPointers;
+    int firstBin[NUM_BANDS];
+    int lastBin[NUM_BANDS];
+    float binWidth;
+
+    // written by the worker thread, read by the canvas
+    CriticalSection columnLock;
+    std::vector<float> columns; // column after column, band after band, then channel
+    int64 numColumnsComputed;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BandPowerNode);
+};
+
+#endif  // __BANDPOWERNODE_H__
@@ -2,7 +2,7 @@
 ------------------------------------------------------------------
 
 This file is part of the Open Ephys GUI
-Copyright (C) 2013 Open Ephys
+Copyright (C) 2018 Open Ephys
 
 ------------------------------------------------------------------
 
@@ -22,7 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <PluginInfo.h>
-#include "LfpDisplayNode.h"
+#include "BandPowerNode.h"
 #include <string>
 #ifdef WIN32
 #include <Windows.h>
@@ -32,14 +32,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #endif
 
 using namespace Plugin;
-using namespace LfpDisplayNodeBeta;
-
 #define NUM_PLUGINS 1
 
 extern "C" EXPORT void getLibInfo(Plugin::LibraryInfo* info)
 {
 	info->apiVersion = PLUGIN_API_VER;
-	info->name = "LFP viewer Beta";
+	info->name = "Band Power Viewer";
 	info->libVersion = 1;
 	info->numPlugins = NUM_PLUGINS;
 }
@@ -50,9 +48,9 @@ extern "C" EXPORT int getPluginInfo(int index, Plugin::PluginInfo* info)
 	{
 	case 0:
 		info->type = Plugin::PLUGIN_TYPE_PROCESSOR;
-		info->processor.name = "LFP Viewer Beta";
+		info->processor.name = "Band Power Viewer";
 		info->processor.type = Plugin::SinkProcessor;
-		info->processor.creator = &(Plugin::createProcessor<LfpDisplayNodeBeta::LfpDisplayNode>);
+		info->processor.creator = &(Plugin::createProcessor<BandPowerNode>);
 		break;
 	default:
 		return -1;
@@ -0,0 +1,263 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "BandSplitter.h"
+#include "BandSplitterEditor.h"
+
+
+BandSplitter::BandSplitter()
+    : GenericProcessor  ("Band Splitter")
+    , numStages         (4)
+    , spikeBandCutoff   (300.0f)
+    , needsReset        (true)
+{
+    setProcessorType (PROCESSOR_TYPE_FILTER);
+}
+
+
+BandSplitter::~BandSplitter()
+{
+}
+
+
+AudioProcessorEditor* BandSplitter::createEditor()
+{
+    editor = new BandSplitterEditor (this, true);
+
+    return editor;
+}
+
+
+void BandSplitter::updateSettings()
+{
+    const int numInputs = getNumInputs();
+
+    // group the inputs by stream, each stream becoming one LFP subprocessor
+    streams.clear();
+
+    for (int n = 0; n < numInputs; ++n)
+    {
+        const DataChannel* chan = dataChannelArray[n];
+        Stream* stream = nullptr;
+
+        for (int s = 0; s < streams.size(); ++s)
+        {
+            if (streams[s]->sourceNodeId == chan->getSourceNodeID()
+                && streams[s]->subProcessorIdx == chan->getSubProcessorIdx()
+                && streams[s]->sampleRate == chan->getSampleRate())
+            {
+                stream = streams[s];
+                break;
+            }
+        }
+
+        if (stream == nullptr)
+        {
+            stream = new Stream();
+            stream->sourceNodeId = chan->getSourceNodeID();
+            stream->subProcessorIdx = chan->getSubProcessorIdx();
+            stream->sampleRate = chan->getSampleRate();
+            streams.add (stream);
+        }
+
+        stream->channels.add (n);
+    }
+
+    // the LFP channels follow the inputs, stream by stream
+    for (int s = 0; s < streams.size(); ++s)
+    {
+        Stream* stream = streams[s];
+        stream->firstLfpChannel = dataChannelArray.size();
+        stream->decimator.setup (stream->channels.size(), numStages);
+
+        for (int i = 0; i < stream->channels.size(); ++i)
+        {
+            const DataChannel* source = dataChannelArray[stream->channels[i]];
+
+            DataChannel* chan = new DataChannel (source->getChannelType(),
+                                                 stream->sampleRate / stream->decimator.getFactor(),
+                                                 this, s);
+            chan->setName (source->getName() + " LFP");
+            chan->setDescription ("Decimated copy of " + source->getName());
+            chan->setBitVolts (source->getBitVolts());
+            chan->setDataUnits (source->getDataUnits());
+            chan->setRecordState (source->getRecordState());
+            dataChannelArray.add (chan);
+        }
+    }
+
+    settings.numOutputs = dataChannelArray.size();
+
+    // a second order high pass is one biquad
+    filterBank.setup (numInputs, 1);
+    setSpikeBandFilters();
+}
+
+
+int BandSplitter::getNumSubProcessors() const
+{
+    return jmax (1, streams.size());
+}
+
+
+float BandSplitter::getSampleRate (int subProcessorIdx) const
+{
+    if (subProcessorIdx < 0 || subProcessorIdx >= streams.size())
+        return getDefaultSampleRate();
+
+    return streams[subProcessorIdx]->sampleRate / streams[subProcessorIdx]->decimator.getFactor();
+}
+
+
+int BandSplitter::getNumStages() const
+{
+    return numStages;
+}
+
+
+float BandSplitter::getSpikeBandCutoff() const
+{
+    return spikeBandCutoff;
+}
+
+
+float BandSplitter::getLfpSampleRate() const
+{
+    return streams.size() > 0 ? getSampleRate (0) : 0.0f;
+}
+
+
+void BandSplitter::setSpikeBandFilters()
+{
+    for (int n = 0; n < filterBank.getNumChannels() && n < dataChannelArray.size(); ++n)
+    {
+        Dsp::Params params;
+        params[0] = dataChannelArray[n]->getSampleRate(); // sample rate
+        params[1] = 2;                                  // order
+        params[2] = jmin (spikeBandCutoff, 0.45f * float (params[0])); // cutoff frequency
+
+        filterDesign.setParams (params);
+        filterBank.setCoefficients (n, 1, filterDesign);
+    }
+
+    filterBank.reset();
+}
+
+
+void BandSplitter::setParameter (int parameterIndex, float newValue)
+{
+    if (parameterIndex == 0)
+    {
+        // takes effect through updateSettings(), which rebuilds the LFP channels
+        numStages = jlimit (1, 8, int (newValue));
+    }
+    else if (parameterIndex == 1)
+    {
+        // the filters are redesigned by updateSettings() or enable(), so the
+        // coefficients never change while process() runs them
+        spikeBandCutoff = jmax (0.0f, newValue);
+    }
+}
+
+
+bool BandSplitter::enable()
+{
+    setSpikeBandFilters();
+    needsReset = true;
+
+    return isEnabled;
+}
+
+
+void BandSplitter::process (AudioSampleBuffer& buffer)
+{
+    // the decimators are aligned to the timestamps, so that every LFP sample has the
+    // timestamp of its input sample divided by the decimation factor
+    if (needsReset)
+    {
+        for (int s = 0; s < streams.size(); ++s)
+        {
+            if (streams[s]->channels.size() > 0)
+                streams[s]->decimator.reset (getTimestamp (streams[s]->channels[0]));
+        }
+
+        needsReset = false;
+    }
+
+    // the LFP band is decimated from the unfiltered inputs, before the spike band
+    // filters change them in place
+    for (int s = 0; s < streams.size(); ++s)
+    {
+        Stream* stream = streams[s];
+        const int numChannels = stream->channels.size();
+
+        if (numChannels == 0)
+            continue;
+
+        const int firstInput = stream->channels[0];
+        const int numSamples = getNumSamples (firstInput);
+        const int numLfpSamples = stream->decimator.getNumOutputSamples (0, numSamples);
+
+        parallelFor (numChannels, [this, &buffer, stream, numSamples] (int first, int last)
+        {
+            for (int i = first; i < last; ++i)
+            {
+                const float* input = buffer.getReadPointer (stream->channels[i]);
+                float* output = buffer.getWritePointer (stream->firstLfpChannel + i);
+                stream->decimator.process (i, 1, numSamples, &input, &output);
+            }
+        });
+
+        const juce::uint64 factor = stream->decimator.getFactor();
+        setTimestampAndSamples ((getTimestamp (firstInput) + factor - 1) / factor, numLfpSamples, s);
+    }
+
+    if (spikeBandCutoff <= 0)
+        return;
+
+    // the spike band is filtered LaneWidth adjacent channels at a time, as in FilterNode
+    float** channels = buffer.getArrayOfWritePointers();
+    const int laneWidth = Dsp::MultiChannelCascade::LaneWidth;
+    const int numChannels = filterBank.getNumChannels();
+    const int numGroups = (numChannels + laneWidth - 1) / laneWidth;
+
+    parallelFor (numGroups, [this, channels, numChannels, laneWidth] (int firstGroup, int lastGroup)
+    {
+        for (int g = firstGroup; g < lastGroup; ++g)
+        {
+            const int last = jmin ((g + 1) * laneWidth, numChannels);
+
+            // channels from different sources can have different numbers of samples
+            for (int first = g * laneWidth; first < last;)
+            {
+                const int numSamples = getNumSamples (first);
+                int end = first + 1;
+                while (end < last && getNumSamples (end) == numSamples)
+                    ++end;
+
+                filterBank.process (first, end - first, numSamples, channels + first);
+                first = end;
+            }
+        }
+    });
+}
@@ -0,0 +1,105 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __BANDSPLITTER_H__
+#define __BANDSPLITTER_H__
+
+#include <ProcessorHeaders.h>
+#include <DspLib.h>
+
+
+/**
+    Splits wideband data into a full rate spike band and a decimated LFP band.
+
+    Every input channel is passed on at its own rate, high-passed when a spike band
+    cutoff is set, and is followed by a copy decimated by a cascade of half-band FIR
+    filters. The decimated copies of the channels coming from one stream form a
+    subprocessor of this node, with its own sample rate and timestamps counted in
+    its own samples, so recording and display only handle a fraction of the samples.
+
+    @see GenericProcessor, BandSplitterEditor, Dsp::HalfBandDecimator
+*/
+class BandSplitter : public GenericProcessor
+{
+public:
+    BandSplitter();
+    ~BandSplitter();
+
+    AudioProcessorEditor* createEditor() override;
+
+    bool hasEditor() const override { return true; }
+
+    void process (AudioSampleBuffer& buffer) override;
+
+    /** Parameter 0 sets the number of halvings of the LFP sample rate,
+        parameter 1 the spike band high-pass cutoff in Hz (0 to pass the input unchanged).
+        Both take effect on the next updateSettings() or enable(), never during acquisition */
+    void setParameter (int parameterIndex, float newValue) override;
+
+    void updateSettings() override;
+
+    bool enable() override;
+
+    /** Returns the number of LFP subprocessors, one per input stream */
+    int getNumSubProcessors() const override;
+
+    /** Returns the sample rate of an LFP subprocessor */
+    float getSampleRate (int subProcessorIdx = 0) const override;
+
+    int getNumStages() const;
+
+    float getSpikeBandCutoff() const;
+
+    /** Returns the LFP sample rate of the first input stream, or 0 without inputs */
+    float getLfpSampleRate() const;
+
+private:
+    void setSpikeBandFilters();
+
+    /** Input channels sharing a source and sample rate, and their LFP subprocessor */
+    struct Stream
+    {
+        uint16 sourceNodeId;
+        uint16 subProcessorIdx;
+        float sampleRate;
+        Array<int> channels;
+        int firstLfpChannel;
+        Dsp::HalfBandDecimator decimator;
+    };
+
+    OwnedArray<Stream> streams;
+
+    /** Spike band high-pass filters of every input channel */
+    Dsp::MultiChannelCascade filterBank;
+    Dsp::Butterworth::Design::HighPass<2> filterDesign;
+
+    int numStages;
+    float spikeBandCutoff;
+
+    /** The decimators start at the timestamps of the first block after acquisition starts */
+    bool needsReset;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BandSplitter);
+};
+
+#endif  // __BANDSPLITTER_H__
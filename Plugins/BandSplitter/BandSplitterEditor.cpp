@@ -0,0 +1,158 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "BandSplitterEditor.h"
+#include "BandSplitter.h"
+
+
+BandSplitterEditor::BandSplitterEditor(GenericProcessor* parentNode, bool useDefaultParameterEditors=true)
+    : GenericEditor(parentNode, useDefaultParameterEditors)
+
+{
+    desiredWidth = 150;
+
+    BandSplitter* processor = (BandSplitter*) getProcessor();
+
+    factorLabel = new Label("factor label", "LFP decimation:");
+    factorLabel->setBounds(10,25,120,20);
+    factorLabel->setFont(Font("Small Text", 12, Font::plain));
+    factorLabel->setColour(Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible(factorLabel);
+
+    factorSelector = new ComboBox("factor selector");
+    for (int stages = 1; stages <= 6; ++stages)
+        factorSelector->addItem(String(1 << stages) + "x", stages);
+    factorSelector->setSelectedId(processor->getNumStages(), dontSendNotification);
+    factorSelector->setBounds(15,45,60,18);
+    factorSelector->setTooltip("Each halving of the LFP sample rate adds one half-band filter stage");
+    factorSelector->addListener(this);
+    addAndMakeVisible(factorSelector);
+
+    lfpRateLabel = new Label("lfp rate label", "");
+    lfpRateLabel->setBounds(80,45,65,18);
+    lfpRateLabel->setFont(Font("Small Text", 10, Font::plain));
+    lfpRateLabel->setColour(Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible(lfpRateLabel);
+
+    cutoffLabel = new Label("cutoff label", "Spike high pass:");
+    cutoffLabel->setBounds(10,65,120,20);
+    cutoffLabel->setFont(Font("Small Text", 12, Font::plain));
+    cutoffLabel->setColour(Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible(cutoffLabel);
+
+    cutoffValue = new Label("cutoff value", String(roundFloatToInt(processor->getSpikeBandCutoff())));
+    cutoffValue->setBounds(15,85,60,18);
+    cutoffValue->setFont(Font("Default", 15, Font::plain));
+    cutoffValue->setColour(Label::textColourId, Colours::white);
+    cutoffValue->setColour(Label::backgroundColourId, Colours::grey);
+    cutoffValue->setEditable(true);
+    cutoffValue->addListener(this);
+    cutoffValue->setTooltip("High pass cutoff of the full rate channels in Hz, 0 to pass them unfiltered");
+    addAndMakeVisible(cutoffValue);
+
+}
+
+BandSplitterEditor::~BandSplitterEditor()
+{
+
+}
+
+
+void BandSplitterEditor::updateSettings()
+{
+    BandSplitter* processor = (BandSplitter*) getProcessor();
+
+    const float rate = processor->getLfpSampleRate();
+    lfpRateLabel->setText(rate > 0 ? String(rate, 0) + " Hz" : "", dontSendNotification);
+}
+
+
+void BandSplitterEditor::startAcquisition()
+{
+    factorSelector->setEnabled(false);
+    cutoffValue->setEnabled(false);
+}
+
+
+void BandSplitterEditor::stopAcquisition()
+{
+    factorSelector->setEnabled(true);
+    cutoffValue->setEnabled(true);
+}
+
+
+void BandSplitterEditor::comboBoxChanged(ComboBox* comboBox)
+{
+    if (comboBox == factorSelector)
+    {
+        BandSplitter* processor = (BandSplitter*) getProcessor();
+        processor->setParameter(0, factorSelector->getSelectedId());
+
+        // the LFP channels get their new sample rate
+        CoreServices::updateSignalChain(this);
+    }
+}
+
+
+void BandSplitterEditor::labelTextChanged(Label* label)
+{
+    BandSplitter* processor = (BandSplitter*) getProcessor();
+
+    Value val = label->getTextValue();
+    double requestedValue = double(val.getValue());
+
+    if (requestedValue < 0 || requestedValue > 10000)
+    {
+        CoreServices::sendStatusMessage("Value out of range.");
+        label->setText(String(roundFloatToInt(processor->getSpikeBandCutoff())), dontSendNotification);
+        return;
+    }
+
+    processor->setParameter(1, requestedValue);
+}
+
+
+void BandSplitterEditor::saveCustomParameters(XmlElement* xml)
+{
+
+    xml->setAttribute("Type", "BandSplitterEditor");
+
+    XmlElement* values = xml->createNewChildElement("VALUES");
+    values->setAttribute("Stages", factorSelector->getSelectedId());
+    values->setAttribute("SpikeHighPass", cutoffValue->getText());
+}
+
+void BandSplitterEditor::loadCustomParameters(XmlElement* xml)
+{
+
+    forEachXmlChildElement(*xml, xmlNode)
+    {
+        if (xmlNode->hasTagName("VALUES"))
+        {
+            factorSelector->setSelectedId(xmlNode->getIntAttribute("Stages", factorSelector->getSelectedId()), sendNotificationSync);
+            cutoffValue->setText(xmlNode->getStringAttribute("SpikeHighPass", cutoffValue->getText()), sendNotificationSync);
+        }
+    }
+
+
+}
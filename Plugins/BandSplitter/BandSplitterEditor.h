@@ -0,0 +1,72 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __BANDSPLITTEREDITOR_H__
+#define __BANDSPLITTEREDITOR_H__
+
+#include <EditorHeaders.h>
+
+/**
+
+  User interface for the BandSplitter processor.
+
+  @see BandSplitter
+
+*/
+
+class BandSplitterEditor : public GenericEditor,
+    public Label::Listener,
+    public ComboBox::Listener
+{
+public:
+    BandSplitterEditor(GenericProcessor* parentNode, bool useDefaultParameterEditors);
+    virtual ~BandSplitterEditor();
+
+    void labelTextChanged(Label* label);
+    void comboBoxChanged(ComboBox* comboBox);
+
+    void updateSettings();
+
+    /** The decimation and the cutoff can't change under a running process() */
+    void startAcquisition() override;
+    void stopAcquisition() override;
+
+    void saveCustomParameters(XmlElement* xml);
+    void loadCustomParameters(XmlElement* xml);
+
+private:
+
+    ScopedPointer<Label> factorLabel;
+    ScopedPointer<ComboBox> factorSelector;
+    ScopedPointer<Label> lfpRateLabel;
+
+    ScopedPointer<Label> cutoffLabel;
+    ScopedPointer<Label> cutoffValue;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BandSplitterEditor);
+
+};
+
+
+
+#endif  // __BANDSPLITTEREDITOR_H__
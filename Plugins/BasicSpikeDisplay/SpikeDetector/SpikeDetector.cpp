@@ -28,8 +28,11 @@
 SpikeDetector::SpikeDetector()
     : GenericProcessor      ("Spike Detector")
     , overflowBuffer        (2, 100)
-    , dataBuffer            (nullptr),
-      overflowBufferSize    (100)
+    , dataBuffer            (nullptr)
+    , autoThreshold         (0.0f)
+    , int16Waveforms        (false)
+    , dedupSamples          (0)
+    , overflowBufferSize    (100)
     , currentElectrode      (-1)
     , uniqueID              (0)
 {
@@ -100,6 +103,7 @@ void SpikeDetector::createSpikeChannels()
 		}
 		SpikeChannel* spk = new SpikeChannel(SpikeChannel::typeFromNumChannels(nChans), this, chans);
 		spk->setNumSamples(elec->prePeakSamples, elec->postPeakSamples);
+		spk->setInt16Waveforms(int16Waveforms);
 		spikeChannelArray.add(spk);
 	}
 }
@@ -113,6 +117,26 @@ void SpikeDetector::updateSettings()
 		overflowBuffer.clear();
 	}
 
+	allocateElectrodeScratch();
+}
+
+
+void SpikeDetector::allocateElectrodeScratch()
+{
+    int numElectrodeChannels = 0;
+    int maxChannels = 0;
+
+    for (int i = 0; i < electrodes.size(); ++i)
+    {
+        numElectrodeChannels += electrodes[i]->numChannels;
+        maxChannels = jmax (maxChannels, electrodes[i]->numChannels);
+    }
+
+    electrodeWindows.resize (maxChannels);
+    nextCrossings.resize (maxChannels);
+    crossingPosition.resize (numElectrodeChannels);
+    electrodeSlots.ensureStorageAllocated (numElectrodeChannels);
+    electrodeLimits.ensureStorageAllocated (numElectrodeChannels);
 }
 
 
@@ -164,6 +188,8 @@ bool SpikeDetector::addElectrode (int nChans, int electrodeID)
     newElectrode->thresholds.malloc (nChans);
     newElectrode->isActive.malloc (nChans);
     newElectrode->channels.malloc (nChans);
+    newElectrode->spikeWaveforms.malloc (nChans * (newElectrode->prePeakSamples + newElectrode->postPeakSamples));
+    newElectrode->spikeThresholds.malloc (nChans);
     newElectrode->isMonitored = false;
 
     for (int i = 0; i < nChans; ++i)
@@ -321,6 +347,46 @@ double SpikeDetector::getChannelThreshold(int electrodeNum, int channelNum) cons
 }
 
 
+void SpikeDetector::setAutoThreshold (float multiplier)
+{
+    std::cout << "Setting automatic threshold to " << multiplier << " x noise level" << std::endl;
+
+    setParameter (97, multiplier);
+}
+
+
+float SpikeDetector::getAutoThreshold() const
+{
+    return autoThreshold;
+}
+
+
+void SpikeDetector::setDedupWindow (int samples)
+{
+    std::cout << "Setting spike dedup window to " << samples << " samples" << std::endl;
+
+    setParameter (96, (float) samples);
+}
+
+
+int SpikeDetector::getDedupWindow() const
+{
+    return dedupSamples;
+}
+
+
+void SpikeDetector::setInt16Waveforms (bool int16)
+{
+    int16Waveforms = int16;
+}
+
+
+bool SpikeDetector::getInt16Waveforms() const
+{
+    return int16Waveforms;
+}
+
+
 void SpikeDetector::setParameter (int parameterIndex, float newValue)
 {
     //editor->updateParameterButtons(parameterIndex);
@@ -329,6 +395,20 @@ void SpikeDetector::setParameter (int parameterIndex, float newValue)
     {
         *(electrodes[currentElectrode]->thresholds + currentChannelIndex) = newValue;
     }
+    else if (parameterIndex == 97)
+    {
+        // the noise levels are only computed while the thresholds follow them
+        const bool wasAutomatic = autoThreshold > 0;
+        autoThreshold = jmax (0.0f, newValue);
+        if (autoThreshold > 0 && ! wasAutomatic)
+            subscribeToInputStatistics();
+        else if (autoThreshold <= 0 && wasAutomatic)
+            unsubscribeFromInputStatistics();
+    }
+    else if (parameterIndex == 96)
+    {
+        dedupSamples = jmax (0, (int) newValue);
+    }
     else if (parameterIndex == 98 && currentElectrode > -1)
     {
         if (newValue == 0.0f)
@@ -348,6 +428,12 @@ bool SpikeDetector::enable()
     for (int i = 0; i < electrodes.size(); ++i)
         useOverflowBuffer.add (false);
 
+    for (int i = 0; i < recentPeaks.size(); ++i)
+        recentPeaks[i]->clearQuick();
+
+    // the electrodes may have changed since the last updateSettings()
+    allocateElectrodeScratch();
+
     return true;
 }
 
@@ -363,198 +449,339 @@ bool SpikeDetector::disable()
 }
 
 
-void SpikeDetector::addWaveformToSpikeObject (SpikeEvent::SpikeBuffer& s,
-                                              int& peakIndex,
-                                              int& electrodeNumber,
-                                              int& currentChannel)
+void SpikeDetector::updateAutoThresholds()
 {
-    int spikeLength = electrodes[electrodeNumber]->prePeakSamples
-                      + electrodes[electrodeNumber]->postPeakSamples;
-
+    const ChannelStatistics& statistics = getInputStatistics();
 
-    const int chan = *(electrodes[electrodeNumber]->channels + currentChannel);
-
-    if (isChannelActive (electrodeNumber, currentChannel))
+    for (int i = 0; i < electrodes.size(); ++i)
     {
-		
-        for (int sample = 0; sample < spikeLength; ++sample)
+        SimpleElectrode* electrode = electrodes[i];
+
+        for (int j = 0; j < electrode->numChannels; ++j)
         {
-            s.set(currentChannel,sample, getNextSample (*(electrodes[electrodeNumber]->channels+currentChannel)));
-            ++sampleIndex;
+            const int chan = *(electrode->channels + j);
 
-            //std::cout << currentIndex << std::endl;
+            if (! *(electrode->isActive + j) || chan < 0 || chan >= statistics.getNumChannels())
+                continue;
+
+            // thresholds stay put until the estimate has warmed up
+            const float noise = statistics.getNoiseLevel (chan);
+
+            if (noise > 0)
+                *(electrode->thresholds + j) = autoThreshold * noise;
         }
     }
-    else
+}
+
+
+/** Adds every index in [start, end) whose sample lies below the limit to the list.
+    Whole chunks are tested with a vectorised minimum so that the scalar search only
+    runs over chunks that actually contain a crossing. */
+static void findCrossings (const float* data, int start, int end, double limit, Array<int>& crossings)
+{
+    const int chunkSize = 32;
+
+    for (int chunk = start; chunk < end; chunk += chunkSize)
     {
-        for (int sample = 0; sample < spikeLength; ++sample)
+        const int n = jmin (chunkSize, end - chunk);
+
+        if (FloatVectorOperations::findMinimum (data + chunk, n) < limit)
         {
-            // insert a blank spike if the
-			s.set(currentChannel, sample, 0);
-            ++sampleIndex;
-            //std::cout << currentIndex << std::endl;
+            for (int k = chunk; k < chunk + n; ++k)
+            {
+                if (data[k] < limit)
+                    crossings.add (k);
+            }
         }
     }
-
-    sampleIndex -= spikeLength; // reset sample index
 }
 
 
-void SpikeDetector::process (AudioSampleBuffer& buffer)
+void SpikeDetector::prepareScannedChannels (AudioSampleBuffer& buffer)
 {
-    // cycle through electrodes
-    SimpleElectrode* electrode;
-    dataBuffer = &buffer;
+    // every input channel of an electrode gets one window and one list of crossings,
+    // however many electrodes it belongs to
+    channelSlot.resize (buffer.getNumChannels());
+    for (int i = 0; i < scannedChannels.size(); ++i)
+        channelSlot.set (scannedChannels[i], -1);
+
+    scannedChannels.clearQuick();
+    electrodeSlots.clearQuick();
+    electrodeLimits.clearQuick();
+    lowestThreshold.clearQuick();
 
-    //std::cout << dataBuffer.getMagnitude(0,nSamples) << std::endl;
+    int maxSpikeLength = 0;
 
     for (int i = 0; i < electrodes.size(); ++i)
     {
-        //  std::cout << "ELECTRODE " << i << std::endl;
-
-        electrode = electrodes[i];
-
-        // refresh buffer index for this electrode
-        sampleIndex = electrode->lastBufferIndex - 1; // subtract 1 to account for
-        // increment at start of getNextSample()
-
-        const int nSamples = getNumSamples (*electrode->channels);
+        SimpleElectrode* electrode = electrodes[i];
+        maxSpikeLength = jmax (maxSpikeLength, electrode->prePeakSamples + electrode->postPeakSamples);
 
-        // cycle through samples
-        while (samplesAvailable (nSamples))
+        for (int j = 0; j < electrode->numChannels; ++j)
         {
-            ++sampleIndex;
+            const int chan = *(electrode->channels + j);
+            // the thresholds are read once, so the crossings found for the lowest one hold for all
+            const double threshold = *(electrode->thresholds + j);
+            const bool active = *(electrode->isActive + j);
 
-            // cycle through channels
-            for (int chan = 0; chan < electrode->numChannels; ++chan)
+            int slot = -1;
+            if (chan >= 0 && chan < channelSlot.size())
             {
-                // std::cout << "  channel " << chan << std::endl;
-                if (*(electrode->isActive + chan))
+                slot = channelSlot[chan];
+                if (slot < 0)
                 {
-                    int currentChannel = *(electrode->channels + chan);
-
-                    if (-getNextSample (currentChannel) > *(electrode->thresholds + chan)) // trigger spike
-                    {
-                        //std::cout << "Spike detected on electrode " << i << std::endl;
-                        // find the peak
-                        int peakIndex = sampleIndex;
-
-                        while (-getCurrentSample(currentChannel) < -getNextSample(currentChannel)
-                               && sampleIndex < peakIndex + electrode->postPeakSamples)
-                        {
-                            ++sampleIndex;
-                        }
-
-                        peakIndex = sampleIndex;
-                        sampleIndex -= (electrode->prePeakSamples + 1);
-
-						const SpikeChannel* spikeChan = getSpikeChannel(i);
-						SpikeEvent::SpikeBuffer spikeData(spikeChan);
-						Array<float> thresholds;
-						for (int channel = 0; channel < electrode->numChannels; ++channel)
-						{
-							addWaveformToSpikeObject(spikeData,
-								peakIndex,
-								i,
-								channel);
-							thresholds.add((int)*(electrode->thresholds + channel));
-						}
-						int64 timestamp = getTimestamp(electrode->channels[0]) + peakIndex;
-						SpikeEventPtr newSpike = SpikeEvent::createSpikeEvent(spikeChan, timestamp, thresholds, spikeData, 0);
-
-                        // package spikes;
-                        
-						addSpike(spikeChan, newSpike, peakIndex);
-
-
-                        // advance the sample index
-                        sampleIndex = peakIndex + electrode->postPeakSamples;
-
-                        // quit spike "for" loop
-                        break;
-
-                    // end spike trigger
-                    }
-
-                // end if channel is active
+                    slot = scannedChannels.size();
+                    scannedChannels.add (chan);
+                    channelSlot.set (chan, slot);
+                    lowestThreshold.add (std::numeric_limits<double>::max());
                 }
 
-            // end cycle through channels on electrode
+                if (active)
+                    lowestThreshold.set (slot, jmin (lowestThreshold[slot], threshold));
             }
 
-        // end cycle through samples
+            electrodeSlots.add (slot);
+            electrodeLimits.add (-threshold);
         }
+    }
 
-        electrode->lastBufferIndex = sampleIndex - nSamples; // should be negative
+    int maxSamples = 0;
+    for (int i = 0; i < scannedChannels.size(); ++i)
+        maxSamples = jmax (maxSamples, (int) getNumSamples (scannedChannels[i]));
 
-        if (nSamples > overflowBufferSize)
-        {
-            for (int j = 0; j < electrode->numChannels; ++j)
-            {
-                overflowBuffer.copyFrom (*electrode->channels+j,
-                                         0,
-                                         buffer,
-                                         *electrode->channels + j,
-                                         nSamples-overflowBufferSize,
-                                         overflowBufferSize);
-            }
+    // each window holds the overflow samples, the current block and enough zeros to
+    // cover a spike peaking near the block end
+    const int windowLength = overflowBufferSize + maxSamples + 2 * maxSpikeLength + 2;
 
-            useOverflowBuffer.set (i, true);
-        }
-        else
+    if (windowBuffer.getNumChannels() < scannedChannels.size() || windowBuffer.getNumSamples() < windowLength)
+        windowBuffer.setSize (jmax (scannedChannels.size(), windowBuffer.getNumChannels()),
+                              jmax (windowLength, windowBuffer.getNumSamples()),
+                              false, false, true);
+
+    while (crossings.size() < scannedChannels.size())
+        crossings.add (new Array<int>());
+    while (recentPeaks.size() < scannedChannels.size())
+        recentPeaks.add (new Array<RecentPeak>());
+
+    const int scanEnd = maxSamples - overflowBufferSize / 2 + 1;
+
+    for (int s = 0; s < scannedChannels.size(); ++s)
+    {
+        const int chan = scannedChannels[s];
+        const int numValid = getNumSamples (chan);
+        float* w = windowBuffer.getWritePointer (s);
+
+        FloatVectorOperations::copy (w, overflowBuffer.getReadPointer (chan), overflowBufferSize);
+        FloatVectorOperations::copy (w + overflowBufferSize, buffer.getReadPointer (chan), numValid);
+        FloatVectorOperations::clear (w + overflowBufferSize + numValid, windowLength - overflowBufferSize - numValid);
+
+        crossings[s]->clearQuick();
+        if (lowestThreshold[s] < std::numeric_limits<double>::max())
+            findCrossings (w + overflowBufferSize, 1 - overflowBufferSize, scanEnd, -lowestThreshold[s], *crossings[s]);
+
+        // peaks too old to be matched by a spike of this block
+        Array<RecentPeak>& peaks = *recentPeaks[s];
+        const int64 oldest = getTimestamp (chan) - overflowBufferSize - dedupSamples;
+        for (int i = peaks.size(); --i >= 0;)
         {
-            useOverflowBuffer.set (i, false);
+            if (peaks.getReference (i).timestamp < oldest)
+                peaks.remove (i);
         }
-
-    // end cycle through electrodes
     }
+
+    for (int s = scannedChannels.size(); s < recentPeaks.size(); ++s)
+        recentPeaks[s]->clearQuick();
 }
 
 
-float SpikeDetector::getNextSample (int& chan)
+int SpikeDetector::nextCrossing (int electrodeChannel, int from, int scanEnd)
 {
-    if (sampleIndex < 0)
-    {
-        const int ind = overflowBufferSize + sampleIndex;
+    const int slot = electrodeSlots[electrodeChannel];
+    const Array<int>& list = *crossings[slot];
+    const float* w = windowBuffer.getReadPointer (slot) + overflowBufferSize;
+    const double limit = electrodeLimits[electrodeChannel];
 
-        if (ind < overflowBuffer.getNumSamples())
-            return *overflowBuffer.getWritePointer (chan, ind);
-        else
-            return 0;
+    // the position only moves forward while an electrode is scanned
+    int& position = crossingPosition.getReference (electrodeChannel);
 
-    }
-    else
+    while (position < list.size())
     {
-        if (sampleIndex < getNumSamples(chan))
-            return *dataBuffer->getWritePointer (chan, sampleIndex);
-        else
-            return 0;
+        const int k = list.getUnchecked (position);
+
+        if (k >= scanEnd)
+            break;
+
+        if (k >= from && w[k] < limit)
+            return k;
+
+        ++position;
     }
+
+    return scanEnd;
 }
 
 
-float SpikeDetector::getCurrentSample (int& chan)
+bool SpikeDetector::isDuplicate (int slot, int electrodeIndex, int64 timestamp) const
 {
-    if (sampleIndex < 1)
-    {
-        return *overflowBuffer.getWritePointer (chan, overflowBufferSize + sampleIndex - 1);
-    }
-    else
+    const Array<RecentPeak>& peaks = *recentPeaks[slot];
+
+    for (int i = peaks.size(); --i >= 0;)
     {
-        return *dataBuffer->getWritePointer (chan, sampleIndex - 1);
+        const RecentPeak& peak = peaks.getReference (i);
+
+        if (peak.electrode != electrodeIndex && std::abs (peak.timestamp - timestamp) <= dedupSamples)
+            return true;
     }
+
+    return false;
 }
 
 
-bool SpikeDetector::samplesAvailable (int nSamples)
+void SpikeDetector::process (AudioSampleBuffer& buffer)
 {
-    if (sampleIndex > nSamples - overflowBufferSize/2)
+    dataBuffer = &buffer;
+
+    if (autoThreshold > 0)
+        updateAutoThresholds();
+
+    prepareScannedChannels (buffer);
+
+    const int dedup = dedupSamples;
+    int firstChannel = 0;
+
+    for (int i = 0; i < electrodes.size(); ++i)
     {
-        return false;
+        SimpleElectrode* electrode = electrodes[i];
+
+        const int nSamples    = getNumSamples (*electrode->channels);
+        const int numChannels = electrode->numChannels;
+        const int spikeLength = electrode->prePeakSamples + electrode->postPeakSamples;
+
+        // sized by allocateElectrodeScratch() for the electrodes acquisition started with
+        jassert (numChannels <= nextCrossings.size() && firstChannel + numChannels <= crossingPosition.size());
+
+        // window pointers are offset so that index 0 is the first sample of the block
+        const float** window = electrodeWindows.getRawDataPointer();
+
+        for (int j = 0; j < numChannels; ++j)
+        {
+            const int slot = electrodeSlots[firstChannel + j];
+            window[j] = slot < 0 ? nullptr : windowBuffer.getReadPointer (slot) + overflowBufferSize;
+        }
+
+        // samples in [scanStart, scanEnd) are searched; the rest of the block is
+        // scanned in the next callback once its trailing context has arrived
+        int scanStart = jmax (electrode->lastBufferIndex, 1 - overflowBufferSize);
+        const int scanEnd = nSamples - overflowBufferSize / 2 + 1;
+
+        for (int j = 0; j < numChannels; ++j)
+        {
+            crossingPosition.set (firstChannel + j, 0);
+            nextCrossings.set (j, *(electrode->isActive + j) && window[j] != nullptr
+                               ? nextCrossing (firstChannel + j, scanStart, scanEnd)
+                               : scanEnd);
+        }
+
+        for (;;)
+        {
+            // the earliest crossing triggers; on a tie the lower channel wins
+            int triggerChannel = -1;
+            int crossing = scanEnd;
+
+            for (int j = 0; j < numChannels; ++j)
+            {
+                if (nextCrossings[j] < crossing)
+                {
+                    crossing = nextCrossings[j];
+                    triggerChannel = j;
+                }
+            }
+
+            if (triggerChannel < 0)
+                break;
+
+            // find the peak
+            const float* w = window[triggerChannel];
+            int peakIndex = crossing;
+
+            while (w[peakIndex] < w[peakIndex - 1]
+                   && peakIndex < crossing + electrode->postPeakSamples)
+            {
+                ++peakIndex;
+            }
+
+            int64 timestamp = getTimestamp (electrode->channels[0]) + peakIndex;
+            const int triggerSlot = electrodeSlots[firstChannel + triggerChannel];
+
+            // a spike another electrode already sent from this channel is skipped like a sent one
+            if (dedup == 0 || ! isDuplicate (triggerSlot, i, timestamp))
+            {
+                const int waveformStart = peakIndex - electrode->prePeakSamples - 1;
+                const int skipped = jmax (0, -overflowBufferSize - waveformStart);
+
+                // the spike is assembled in the electrode's own storage and written straight
+                // into the event buffer
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    float* waveform = electrode->spikeWaveforms + channel * spikeLength;
+
+                    if (*(electrode->isActive + channel) && window[channel] != nullptr)
+                    {
+                        FloatVectorOperations::clear (waveform, skipped);
+                        FloatVectorOperations::copy (waveform + skipped, window[channel] + waveformStart + skipped, spikeLength - skipped);
+                    }
+                    else
+                    {
+                        // insert a blank spike
+                        FloatVectorOperations::clear (waveform, spikeLength);
+                    }
+
+                    *(electrode->spikeThresholds + channel) = (float) (int) *(electrode->thresholds + channel);
+                }
+
+                addSpike (getSpikeChannel (i), timestamp, electrode->spikeThresholds, electrode->spikeWaveforms, 0, peakIndex);
+
+                if (dedup > 0)
+                {
+                    RecentPeak peak;
+                    peak.timestamp = timestamp;
+                    peak.electrode = i;
+
+                    for (int j = 0; j < numChannels; ++j)
+                    {
+                        const int slot = electrodeSlots[firstChannel + j];
+                        if (*(electrode->isActive + j) && slot >= 0)
+                            recentPeaks[slot]->add (peak);
+                    }
+                }
+            }
+
+            // advance past the spike and refresh the crossings it swallowed
+            scanStart = peakIndex + electrode->postPeakSamples + 1;
+
+            for (int j = 0; j < numChannels; ++j)
+            {
+                if (nextCrossings[j] < scanStart)
+                    nextCrossings.set (j, nextCrossing (firstChannel + j, scanStart, scanEnd));
+            }
+        }
+
+        electrode->lastBufferIndex = jmax (scanStart, scanEnd) - 1 - nSamples; // should be negative
+
+        useOverflowBuffer.set (i, nSamples > overflowBufferSize);
+        firstChannel += numChannels;
+
+    // end cycle through electrodes
     }
-    else
+
+    // the overflow of a channel shared by several electrodes is kept once
+    for (int s = 0; s < scannedChannels.size(); ++s)
     {
-        return true;
+        const int chan = scannedChannels[s];
+        const int nSamples = getNumSamples (chan);
+
+        if (nSamples > overflowBufferSize)
+            overflowBuffer.copyFrom (chan, 0, buffer, chan, nSamples - overflowBufferSize, overflowBufferSize);
     }
 }
 
@@ -578,6 +805,15 @@ void SpikeDetector::saveCustomParametersToXml (XmlElement* parentElement)
             channelNode->setAttribute ("isActive",  *(electrodes[i]->isActive + j));
         }
     }
+
+    XmlElement* autoThresholdNode = parentElement->createNewChildElement ("AUTO_THRESHOLD");
+    autoThresholdNode->setAttribute ("multiplier", autoThreshold);
+
+    XmlElement* waveformsNode = parentElement->createNewChildElement ("WAVEFORMS");
+    waveformsNode->setAttribute ("int16", int16Waveforms);
+
+    XmlElement* dedupNode = parentElement->createNewChildElement ("DEDUP");
+    dedupNode->setAttribute ("samples", dedupSamples);
 }
 
 
@@ -623,6 +859,20 @@ void SpikeDetector::loadCustomParametersFromXml()
                     }
                 }
             }
+            else if (xmlNode->hasTagName ("AUTO_THRESHOLD"))
+            {
+                setAutoThreshold ((float) xmlNode->getDoubleAttribute ("multiplier"));
+                sde->refreshAutoThreshold();
+            }
+            else if (xmlNode->hasTagName ("WAVEFORMS"))
+            {
+                setInt16Waveforms (xmlNode->getBoolAttribute ("int16"));
+            }
+            else if (xmlNode->hasTagName ("DEDUP"))
+            {
+                setDedupWindow (xmlNode->getIntAttribute ("samples"));
+                sde->refreshDedupWindow();
+            }
         }
 
         sde->checkSettings();
@@ -25,6 +25,7 @@
 #define __SPIKEDETECTOR_H_3F920F95__
 
 #include <ProcessorHeaders.h>
+#include <DspLib.h>
 #include "SpikeDetectorEditor.h"
 
 
@@ -44,6 +45,11 @@ struct SimpleElectrode
     HeapBlock<int> channels;
     HeapBlock<double> thresholds;
     HeapBlock<bool> isActive;
+
+    /** Storage reused by every spike of the electrode: the waveforms, channel after
+        channel, and the thresholds sent along with them. */
+    HeapBlock<float> spikeWaveforms;
+    HeapBlock<float> spikeThresholds;
 };
 
 
@@ -143,27 +149,94 @@ public:
 
     double getChannelThreshold (int electrodeNum, int channelNum) const;
 
+    /** Sets every threshold to a multiple of the noise level of its channel, tracked
+        during acquisition. A multiplier of zero returns to manual thresholds. */
+    void setAutoThreshold (float multiplier);
+
+    float getAutoThreshold() const;
+
+    /** Sends the waveforms as int16 multiples of the bitVolts of their channels instead of
+        floats, halving the size of the spike events. Takes effect on the next settings update. */
+    void setInt16Waveforms (bool int16);
+
+    bool getInt16Waveforms() const;
+
+    /** Skips a spike whose trigger channel already carries a spike sent by another electrode
+        within this many samples, so that a spike on a channel shared by overlapping electrodes
+        is only sent once. Electrodes earlier in the list win. Zero sends every spike. */
+    void setDedupWindow (int samples);
+
+    int getDedupWindow() const;
+
 
 private:
 
     float getDefaultThreshold() const;
 
-    float getNextSample (int& chan);
-    float getCurrentSample (int& chan);
-    bool samplesAvailable (int nSamples);
+    void resetElectrode (SimpleElectrode*);
 
-      void addWaveformToSpikeObject (SpikeEvent::SpikeBuffer& s,
-                                   int& peakIndex,
-                                   int& electrodeNumber,
-                                   int& currentChannel);
+    /** Adds the block to the noise estimates and moves the thresholds with them. */
+    void updateAutoThresholds();
 
-    void resetElectrode (SimpleElectrode*);
+    /** Sizes the per electrode channel lists process() fills, so that it doesn't allocate. */
+    void allocateElectrodeScratch();
+
+    /** Copies every input channel used by an electrode into its window once and lists its
+        threshold crossings for the lowest threshold any electrode gives it. */
+    void prepareScannedChannels (AudioSampleBuffer& buffer);
+
+    /** Next crossing at or after from of one channel of the flattened electrode list,
+        or scanEnd if there is none. */
+    int nextCrossing (int electrodeChannel, int from, int scanEnd);
+
+    bool isDuplicate (int slot, int electrodeIndex, int64 timestamp) const;
 
     /** Pointer to a continuous buffer. */
     AudioSampleBuffer* dataBuffer;
 
+    /** Per scanned channel: the overflow samples followed by the current block,
+        so that threshold crossings can be searched without branching on the index. */
+    AudioSampleBuffer windowBuffer;
+
+    /** Input channels used by any electrode, each with one window, and the window of
+        every input channel (-1 if it is not used). */
+    Array<int> scannedChannels;
+    Array<int> channelSlot;
+
+    /** Per scanned channel: the lowest active threshold and the samples below it. */
+    Array<double> lowestThreshold;
+    OwnedArray<Array<int>> crossings;
+
+    /** Per channel of all electrodes in order: its window, the negated threshold read at
+        the start of the block, and how far it has walked its window's crossings. */
+    Array<int> electrodeSlots;
+    Array<double> electrodeLimits;
+    Array<int> crossingPosition;
+
+    /** Per channel of the current electrode: the start of the block in its window, or
+        nullptr if it has none, and its first pending threshold crossing. */
+    Array<const float*> electrodeWindows;
+    Array<int> nextCrossings;
+
+    struct RecentPeak
+    {
+        int64 timestamp;
+        int electrode;
+    };
+
+    /** Per scanned channel: peaks of the spikes sent lately, for the dedup window. */
+    OwnedArray<Array<RecentPeak>> recentPeaks;
+
+    /** Multiple of the noise level used as threshold, or zero for manual thresholds. */
+    float autoThreshold;
+
+    /** Spike channels carry int16 waveforms, see SpikeChannel::setInt16Waveforms. */
+    bool int16Waveforms;
+
+    /** Samples within which a spike already sent from a channel is not sent again. */
+    int dedupSamples;
+
     int overflowBufferSize;
-    int sampleIndex;
 
     Array<int> electrodeCounter;
 
@@ -119,6 +119,34 @@ SpikeDetectorEditor::SpikeDetectorEditor(GenericProcessor* parentNode, bool useD
     thresholdLabel->setColour(Label::textColourId, Colours::grey);
     addAndMakeVisible(thresholdLabel);
 
+    Label* autoLabel = new Label("Auto","Auto");
+    autoLabel->setFont(font);
+    autoLabel->setBounds(135, 62, 60, 12);
+    autoLabel->setColour(Label::textColourId, Colours::grey);
+    addAndMakeVisible(autoLabel);
+
+    autoThresholdLabel = new Label("Auto Threshold", "off");
+    autoThresholdLabel->setEditable(true);
+    autoThresholdLabel->addListener(this);
+    autoThresholdLabel->setBounds(135, 75, 60, 20);
+    autoThresholdLabel->setColour(Label::textColourId, Colours::white);
+    autoThresholdLabel->setTooltip("Thresholds as a multiple of the noise level of each channel (median based); 0 or off for manual thresholds");
+    addAndMakeVisible(autoThresholdLabel);
+
+    Label* dedupLabel = new Label("Dedup","Dedup");
+    dedupLabel->setFont(font);
+    dedupLabel->setBounds(135, 95, 30, 14);
+    dedupLabel->setColour(Label::textColourId, Colours::grey);
+    addAndMakeVisible(dedupLabel);
+
+    dedupWindowLabel = new Label("Dedup Window", "off");
+    dedupWindowLabel->setEditable(true);
+    dedupWindowLabel->addListener(this);
+    dedupWindowLabel->setBounds(165, 95, 35, 14);
+    dedupWindowLabel->setColour(Label::textColourId, Colours::white);
+    dedupWindowLabel->setTooltip("Samples within which a spike on a channel already sent by another electrode is dropped; 0 or off sends it from every electrode");
+    addAndMakeVisible(dedupWindowLabel);
+
     // create a custom channel selector
     //deleteAndZero(channelSelector);
 
@@ -407,6 +435,22 @@ void SpikeDetectorEditor::channelChanged (int channel, bool /*newState*/)
 
 }
 
+void SpikeDetectorEditor::refreshAutoThreshold()
+{
+    SpikeDetector* processor = (SpikeDetector*) getProcessor();
+    const float multiplier = processor->getAutoThreshold();
+
+    autoThresholdLabel->setText(multiplier > 0 ? String(multiplier, 1) + " x" : "off", dontSendNotification);
+}
+
+void SpikeDetectorEditor::refreshDedupWindow()
+{
+    SpikeDetector* processor = (SpikeDetector*) getProcessor();
+    const int samples = processor->getDedupWindow();
+
+    dedupWindowLabel->setText(samples > 0 ? String(samples) : "off", dontSendNotification);
+}
+
 void SpikeDetectorEditor::refreshElectrodeList()
 {
 
@@ -471,6 +515,22 @@ void SpikeDetectorEditor::removeElectrode(int index)
 
 void SpikeDetectorEditor::labelTextChanged(Label* label)
 {
+    if (label == autoThresholdLabel)
+    {
+        SpikeDetector* processor = (SpikeDetector*) getProcessor();
+        processor->setAutoThreshold(jmax(0.0f, label->getText().getFloatValue()));
+        refreshAutoThreshold();
+        return;
+    }
+
+    if (label == dedupWindowLabel)
+    {
+        SpikeDetector* processor = (SpikeDetector*) getProcessor();
+        processor->setDedupWindow(jmax(0, label->getText().getIntValue()));
+        refreshDedupWindow();
+        return;
+    }
+
     if (label->getText().equalsIgnoreCase("1") && isPlural)
     {
         for (int n = 1; n < electrodeTypes->getNumItems()+1; n++)
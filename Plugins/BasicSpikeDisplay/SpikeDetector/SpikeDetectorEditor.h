@@ -65,6 +65,8 @@ public:
 
     void checkSettings();
     void refreshElectrodeList();
+    void refreshAutoThreshold();
+    void refreshDedupWindow();
 
 private:
 
@@ -74,6 +76,8 @@ private:
     ComboBox* electrodeList;
     Label* numElectrodes;
     Label* thresholdLabel;
+    Label* autoThresholdLabel;
+    Label* dedupWindowLabel;
     TriangleButton* upButton;
     TriangleButton* downButton;
     UtilityButton* plusButton;
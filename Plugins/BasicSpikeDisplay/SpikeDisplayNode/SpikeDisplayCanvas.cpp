@@ -146,14 +146,14 @@ void SpikeDisplayCanvas::refresh()
 {
     processSpikeEvents();
 
-    repaint();
+    spikeDisplay->refresh();
 }
 
 
 void SpikeDisplayCanvas::processSpikeEvents()
 {
 
-    processor->setParameter(2, 0.0f); // request redraw
+    processor->updateSpikePlots();
 
 }
 
@@ -456,6 +456,14 @@ void SpikeDisplay::plotSpike(const SpikeEvent* spike, int electrodeNum)
     spikePlots[electrodeNum]->processSpikeObject(spike);
 }
 
+void SpikeDisplay::refresh()
+{
+    for (int i = 0; i < spikePlots.size(); i++)
+    {
+        spikePlots[i]->refresh();
+    }
+}
+
 void SpikeDisplay::registerThresholdCoordinator(SpikeThresholdCoordinator* stc)
 {
     thresholdCoordinator = stc;
@@ -611,6 +619,15 @@ void SpikePlot::processSpikeObject(const SpikeEvent* s)
 
 }
 
+void SpikePlot::refresh()
+{
+    for (int i = 0; i < nWaveAx; i++)
+        wAxes[i]->refresh();
+
+    for (int i = 0; i < nProjAx; i++)
+        pAxes[i]->refresh();
+}
+
 void SpikePlot::select()
 {
     isSelected = true;
@@ -867,9 +884,15 @@ WaveAxes::WaveAxes(int channel) : GenericAxes(channel),
     drawGrid(true),
     displayThresholdLevel(0.0f),
     detectorThresholdLevel(0.0f),
-    spikesReceivedSinceLastRedraw(0),
+    waveSamples(0),
     spikeIndex(0),
+    numRecentWaves(0),
+    newWaves(false),
     bufferSize(5),
+    displayedSamples(0),
+    displayedIndex(0),
+    numDisplayedWaves(0),
+    waveImageNeedsUpdate(true),
     range(250.0f),
     isOverThresholdSlider(false),
     isDraggingThresholdSlider(false),
@@ -883,11 +906,6 @@ WaveAxes::WaveAxes(int channel) : GenericAxes(channel),
     thresholdColour = Colours::red;
 
     font = Font("Small Text",10,Font::plain);
-
-    for (int n = 0; n < bufferSize; n++)
-    {
-        spikeBuffer.add(nullptr);
-    }
 }
 
 void WaveAxes::setRange(float r)
@@ -897,9 +915,15 @@ void WaveAxes::setRange(float r)
 
     range = r;
 
+    waveImageNeedsUpdate = true;
     repaint();
 }
 
+void WaveAxes::resized()
+{
+    waveImageNeedsUpdate = true;
+}
+
 void WaveAxes::paint(Graphics& g)
 {
     g.setColour(Colours::black);
@@ -923,34 +947,53 @@ void WaveAxes::paint(Graphics& g)
     }
 
 
-    for (int spikeNum = 0; spikeNum < bufferSize; spikeNum++)
+    if (waveImageNeedsUpdate)
+        updateWaveImage();
+
+    g.drawImageAt(waveImage, 0, 0);
+
+}
+
+void WaveAxes::refresh()
+{
     {
+        const SpinLock::ScopedLockType lock(waveLock);
+
+        if (!newWaves)
+            return;
 
-        if (spikeNum != spikeIndex)
+        if (displayedSamples != waveSamples)
         {
-            g.setColour(Colours::grey);
-            plotSpike(spikeBuffer[spikeNum], g);
+            displayedWaves.allocate(bufferSize * waveSamples, false);
+            displayedSamples = waveSamples;
         }
 
+        memcpy(displayedWaves, recentWaves, bufferSize * waveSamples * sizeof(float));
+        displayedIndex = spikeIndex;
+        numDisplayedWaves = numRecentWaves;
+        newWaves = false;
     }
 
-    
-    plotSpike(spikeBuffer[spikeIndex], g);
-
-
-    spikesReceivedSinceLastRedraw = 0;
-
+    waveImageNeedsUpdate = true;
+    repaint();
 }
 
-void WaveAxes::plotSpike(const SpikeEvent* s, Graphics& g)
+void WaveAxes::updateWaveImage()
 {
-	if (!s) return;
+    waveImageNeedsUpdate = false;
 
-    float h = getHeight();
+    const int w = jmax(1, getWidth());
+    const int h = jmax(1, getHeight());
 
-    //compute the spatial width for each waveform sample
-	int nSamples = s->getChannelInfo()->getTotalSamples();
-	float dx = getWidth() / float(nSamples);
+    if (waveImage.getWidth() != w || waveImage.getHeight() != h)
+        waveImage = Image(Image::ARGB, w, h, true);
+    else
+        waveImage.clear(waveImage.getBounds());
+
+    if (numDisplayedWaves == 0)
+        return;
+
+    Graphics g(waveImage);
 
     //TODO: check for special metadata for this
 	//if (s.sortedId > 0)
@@ -958,46 +1001,44 @@ void WaveAxes::plotSpike(const SpikeEvent* s, Graphics& g)
     //else
        g.setColour(Colours::white);
 
-    // type corresponds to channel so we need to calculate the starting
-    // sample based upon which channel is getting plotted
-    int sampIdx = nSamples*type; //spikeBuffer[0].nSamples * type; //
-
-    int dSamples = 1;
+    for (int n = 0; n < numDisplayedWaves; n++)
+    {
+        const int index = (displayedIndex - n + bufferSize) % bufferSize;
+        g.strokePath(getWaveformPath(displayedWaves + index * displayedSamples, displayedSamples),
+                     PathStrokeType(1.0f));
+    }
+}
 
-    float x = 0.0f;
-	const float* data = s->getDataPointer();
+Path WaveAxes::getWaveformPath(const float* data, int nSamples)
+{
+    float h = getHeight();
 
-	for (int i = 0; i < nSamples - 1; i++)
-	{
-		//std::cout << s.data[sampIdx] << std::endl;
+    //compute the spatial width for each waveform sample
+	float dx = getWidth() / float(nSamples);
 
+    Path path;
+    path.preallocateSpace(3 * nSamples);
 
+    float x = 0.0f;
 
-		float s1, s2;
+	for (int i = 0; i < nSamples; i++)
+	{
+		float y;
 
 		if (spikesInverted)
-		{
-			s1 = h / 2 + data[sampIdx] / range * h;
-			s2 = h / 2 + data[sampIdx + 1] / range * h;
-		}
+			y = h / 2 + data[i] / range * h;
 		else
-		{
-			s1 = h / 2 - data[sampIdx] / range * h;
-			s2 = h / 2 - data[sampIdx + 1] / range * h;
-
-		}
-		g.drawLine(x,
-			s1,
-			x + dx,
-			s2);
-
-
+			y = h / 2 - data[i] / range * h;
 
+		if (i == 0)
+			path.startNewSubPath(x, y);
+		else
+			path.lineTo(x, y);
 
-		sampIdx += dSamples;
 		x += dx;
 	}
 
+	return path;
 }
 
 void WaveAxes::drawThresholdSlider(Graphics& g)
@@ -1051,19 +1092,26 @@ bool WaveAxes::updateSpikeData(const SpikeEvent* s)
         gotFirstSpike = true;
     }
 
-    if (spikesReceivedSinceLastRedraw < bufferSize)
-    {
+	int nSamples = s->getChannelInfo()->getTotalSamples();
+	const float* data = s->getDataPointer() + nSamples*type;
 
-        SpikeEvent* newSpike = new SpikeEvent(*s);
+    const SpinLock::ScopedLockType lock(waveLock);
 
-        spikeIndex++;
-        spikeIndex %= bufferSize;
+    if (nSamples != waveSamples)
+    {
+        recentWaves.allocate(bufferSize * nSamples, true);
+        waveSamples = nSamples;
+        numRecentWaves = 0;
+    }
 
-        spikeBuffer.set(spikeIndex, newSpike);
+    // overwrite the oldest waveform, so only the latest ones are drawn
+    spikeIndex++;
+    spikeIndex %= bufferSize;
 
-        spikesReceivedSinceLastRedraw++;
+    memcpy(recentWaves + spikeIndex * nSamples, data, nSamples * sizeof(float));
 
-    }
+    numRecentWaves = jmin(numRecentWaves + 1, bufferSize);
+    newWaves = true;
 
     return true;
 
@@ -1093,14 +1141,16 @@ bool WaveAxes::checkThreshold(const SpikeEvent* s)
 void WaveAxes::clear()
 {
 
-    spikeBuffer.clear();
-    spikeIndex = 0;
-
-    for (int n = 0; n < bufferSize; n++)
     {
-        spikeBuffer.add(nullptr);
+        const SpinLock::ScopedLockType lock(waveLock);
+        spikeIndex = 0;
+        numRecentWaves = 0;
+        newWaves = false;
     }
 
+    numDisplayedWaves = 0;
+    waveImageNeedsUpdate = true;
+
     repaint();
 }
 
@@ -1235,10 +1285,14 @@ void WaveAxes::setDisplayThreshold(float threshold)
 // --------------------------------------------------
 
 ProjectionAxes::ProjectionAxes(int projectionNum) : GenericAxes(projectionNum), imageDim(500),
-    rangeX(250), rangeY(250), spikesReceivedSinceLastRedraw(0)
+    rangeX(250), rangeY(250)
 {
     projectionImage = Image(Image::RGB, imageDim, imageDim, true);
 
+    pointColour = Colours::white;
+    pendingPoints.ensureStorageAllocated(MAX_PROJECTION_POINTS_PER_REFRESH);
+    drawnPoints.ensureStorageAllocated(MAX_PROJECTION_POINTS_PER_REFRESH);
+
     clear();
     //Graphics g(projectionImage);
     //g.setColour(Colours::red);
@@ -1279,36 +1333,57 @@ bool ProjectionAxes::updateSpikeData(const SpikeEvent* s)
     int idx1, idx2;
     calcWaveformPeakIdx(s, ampDim1, ampDim2, &idx1, &idx2);
 
-    // add peaks to image
-    Colour col;
+	const float* data = s->getDataPointer();
 
-	//Again, fix this adding proper metadata check
-    //if (s.sortedId > 0)
-    //    col = Colour(s.color[0], s.color[1], s.color[2]);
-    //else
-        col = Colours::white;
+    // queue the peaks for the next refresh, dropping them once the budget is used up
+    const SpinLock::ScopedLockType lock(pointLock);
 
-	const float* data = s->getDataPointer();
-    updateProjectionImage(data[idx1], data[idx2], 1, col);
+    if (pendingPoints.size() < MAX_PROJECTION_POINTS_PER_REFRESH)
+        pendingPoints.add(Point<float>(data[idx1], data[idx2]));
 
     return true;
 }
 
-void ProjectionAxes::updateProjectionImage(float x, float y, float gain, Colour col)
+void ProjectionAxes::refresh()
+{
+    {
+        const SpinLock::ScopedLockType lock(pointLock);
+
+        if (pendingPoints.size() == 0)
+            return;
+
+        drawnPoints.swapWith(pendingPoints);
+    }
+
+    updateProjectionImage(drawnPoints);
+    drawnPoints.clearQuick();
+
+    repaint();
+}
+
+void ProjectionAxes::updateProjectionImage(const Array<Point<float>>& points)
 {
-    Graphics g(projectionImage);
+    // add peaks to image
+	//Again, fix this adding proper metadata check
+    //if (s.sortedId > 0)
+    //    col = Colour(s.color[0], s.color[1], s.color[2]);
+    //else
+    //    col = pointColour;
 
-    // h/2 + float(s.data[sampIdx]-32768)/float(*s.gain)*1000.0f / range * h;
+    Image::BitmapData bitmap(projectionImage, Image::BitmapData::readWrite);
 
-    if (gain != 0)
+    // each point is a 2x2 pixel square, values in microvolts
+    for (int i = 0; i < points.size(); i++)
     {
-		float xf = x;
-        float yf = float(imageDim) - y; // in microvolts
+        const int x = roundToInt(points.getReference(i).x);
+        const int y = imageDim - roundToInt(points.getReference(i).y);
 
-        g.setColour(col);
-        g.fillEllipse(xf,yf,2.0f,2.0f);
+        for (int px = jmax(x, 0); px < jmin(x + 2, imageDim); px++)
+        {
+            for (int py = jmax(y, 0); py < jmin(y + 2, imageDim); py++)
+                bitmap.setPixelColour(px, py, pointColour);
+        }
     }
-
 }
 
 void ProjectionAxes::calcWaveformPeakIdx(const SpikeEvent* s, int d1, int d2, int* idx1, int* idx2)
@@ -1338,6 +1413,11 @@ void ProjectionAxes::calcWaveformPeakIdx(const SpikeEvent* s, int d1, int d2, in
 
 void ProjectionAxes::clear()
 {
+    {
+        const SpinLock::ScopedLockType lock(pointLock);
+        pendingPoints.clearQuick();
+    }
+
     projectionImage.clear(Rectangle<int>(0, 0, projectionImage.getWidth(), projectionImage.getHeight()),
                           Colours::black);
 
@@ -48,6 +48,9 @@
 #define MAX_NUMBER_OF_SPIKE_SOURCES 128
 #define MAX_N_CHAN 4
 
+// Most projection points drawn per refresh; spikes beyond this are not shown
+#define MAX_PROJECTION_POINTS_PER_REFRESH 256
+
 class SpikeDisplayNode;
 
 class SpikeDisplay;
@@ -143,6 +146,9 @@ public:
 
     void plotSpike(const SpikeEvent* spike, int electrodeNum);
 
+    /** Draws the spikes received by every plot since the last refresh */
+    void refresh();
+
     void invertSpikes(bool);
 
     int getTotalHeight()
@@ -206,6 +212,9 @@ public:
 
     void processSpikeObject(const SpikeEvent* s);
 
+    /** Draws the spikes received since the last refresh and repaints the axes that changed */
+    void refresh();
+
     SpikeDisplayCanvas* canvas;
 
     bool isSelected;
@@ -316,6 +325,11 @@ protected:
 
   Class for drawing spike waveforms.
 
+  updateSpikeData() copies the samples of each spike into a ring holding the most
+  recent ones, so a burst of spikes only ever costs a redraw of the last few. On
+  refresh() the ring is handed to the message thread and, if it changed, all its
+  waveforms are drawn into an image in one pass; paint() then just blits it.
+
 */
 
 class WaveAxes : public GenericAxes
@@ -328,8 +342,10 @@ public:
     bool checkThreshold(const SpikeEvent* spike);
 
     void paint(Graphics& g);
+    void resized();
 
-    void plotSpike(const SpikeEvent* s, Graphics& g);
+    /** Repaints the axes if spikes arrived since the last refresh */
+    void refresh();
 
     void clear();
 
@@ -356,6 +372,7 @@ public:
     void invertSpikes(bool shouldInvert)
     {
         spikesInverted = shouldInvert;
+        waveImageNeedsUpdate = true;
         repaint();
     }
 
@@ -374,15 +391,30 @@ private:
 
     void drawThresholdSlider(Graphics& g);
 
-    int spikesReceivedSinceLastRedraw;
+    /** Redraws waveImage from the waveforms last handed over by refresh() */
+    void updateWaveImage();
+    Path getWaveformPath(const float* data, int nSamples);
 
     Font font;
 
-   OwnedArray<SpikeEvent> spikeBuffer;
-
+    // the most recent waveforms, written by updateSpikeData()
+    SpinLock waveLock;
+    HeapBlock<float> recentWaves;
+    int waveSamples;
     int spikeIndex;
+    int numRecentWaves;
+    bool newWaves;
+
     int bufferSize;
 
+    // message thread copy of the ring, drawn into waveImage
+    HeapBlock<float> displayedWaves;
+    int displayedSamples;
+    int displayedIndex;
+    int numDisplayedWaves;
+    Image waveImage;
+    bool waveImageNeedsUpdate;
+
     float range;
 
     bool isOverThresholdSlider;
@@ -403,6 +435,10 @@ private:
 
   Class for drawing the peak projections of spike waveforms.
 
+  Peaks are queued by updateSpikeData(), up to MAX_PROJECTION_POINTS_PER_REFRESH
+  of them, and written straight into the pixels of the projection image on the
+  next refresh().
+
 */
 
 class ProjectionAxes : public GenericAxes
@@ -415,6 +451,9 @@ public:
 
     void paint(Graphics& g);
 
+    /** Draws the points queued since the last refresh into the projection image */
+    void refresh();
+
     void clear();
 
     void setRange(float, float);
@@ -423,7 +462,7 @@ public:
 
 private:
 
-    void updateProjectionImage(float, float, float, Colour);
+    void updateProjectionImage(const Array<Point<float>>& points);
 
     void calcWaveformPeakIdx(const SpikeEvent*, int, int, int*, int*);
 
@@ -439,7 +478,9 @@ private:
     int rangeX;
     int rangeY;
 
-    int spikesReceivedSinceLastRedraw;
+    SpinLock pointLock;
+    Array<Point<float>> pendingPoints;
+    Array<Point<float>> drawnPoints;
 
 };
 
@@ -29,8 +29,6 @@
 
 SpikeDisplayNode::SpikeDisplayNode()
     : GenericProcessor  ("Spike Viewer")
-    , displayBufferSize (5)
-    ,  redrawRequested  (false)
     , isRecording       (false)
 {
     setProcessorType (PROCESSOR_TYPE_SINK);
@@ -57,18 +55,19 @@ void SpikeDisplayNode::updateSettings()
 	for (int i = 0; i < spikeChannelArray.size(); ++i)
 	{
 
+		const SpikeChannel* chan = spikeChannelArray[i];
+
 		Electrode* elec = new Electrode();
-		elec->numChannels = spikeChannelArray[i]->getNumChannels();
-		elec->bitVolts = spikeChannelArray[i]->getChannelBitVolts(0); //lets assume all channels have the same bitvolts
-		elec->name = spikeChannelArray[i]->getName();
-		elec->currentSpikeIndex = 0;
-		elec->mostRecentSpikes.ensureStorageAllocated(displayBufferSize);
+		elec->numChannels = chan->getNumChannels();
+		elec->bitVolts = chan->getChannelBitVolts(0); //lets assume all channels have the same bitvolts
+		elec->name = chan->getName();
+		elec->spikePlot = nullptr;
 
-		for (int j = 0; j < elec->numChannels; ++j)
-		{
-			elec->displayThresholds.add(0);
-			elec->detectorThresholds.add(0);
-		}
+		elec->displayThresholds.allocate(elec->numChannels, true);
+
+		elec->spikeSize = SPIKE_BASE_SIZE + elec->numChannels * sizeof(float) + chan->getWaveformDataSize()
+			+ chan->getTotalEventMetaDataSize();
+		elec->spikeData.allocate(mailboxSize * elec->spikeSize, false);
 
 		electrodes.add(elec);
 
@@ -86,6 +85,7 @@ bool SpikeDisplayNode::enable()
 	{
 		Electrode* elec = electrodes[i];
 		elec->recordIndex = CoreServices::RecordNode::addSpikeElectrode(spikeChannelArray[i]);
+		elec->spikeFifo.reset();
 	}
 
     editor->enable();
@@ -177,65 +177,34 @@ void SpikeDisplayNode::setParameter (int param, float val)
     {
         isRecording = true;
     }
-    else if (param == 2)   // redraw
-    {
-        redrawRequested = true;
-    }
 }
 
 
 void SpikeDisplayNode::process (AudioSampleBuffer& buffer)
 {
     checkForEvents (true); // automatically calls 'handleEvent
-
-    if (redrawRequested)
-    {
-        // update incoming thresholds
-        for (int i = 0; i < getNumElectrodes(); ++i)
-        {
-            Electrode* e = electrodes[i];
-
-            // update thresholds
-            for (int j = 0; j < e->numChannels; ++j)
-            {
-                e->displayThresholds.set (j,
-                                         e->spikePlot->getDisplayThresholdForChannel (j));
-
-                e->spikePlot->setDetectorThresholdForChannel (j, e->detectorThresholds[j]);
-            }
-
-            // transfer buffered spikes to spike plot
-            for (int j = 0; j < e->currentSpikeIndex; ++j)
-            {
-                //std::cout << "Transferring spikes." << std::endl;
-                e->spikePlot->processSpikeObject (e->mostRecentSpikes[j]);
-                e->currentSpikeIndex = 0;
-            }
-        }
-
-        redrawRequested = false;
-    }
 }
 
 
 void SpikeDisplayNode::handleSpike(const SpikeChannel* spikeInfo, const MidiMessage& event, int samplePosition)
 {
-	SpikeEventPtr newSpike = SpikeEvent::deserializeFromMessage(event, spikeInfo);
-	if (!newSpike) return;
+	// Only the samples are needed to check the threshold, so read them in place
+	SpikeEventView newSpike(event, spikeInfo);
+	if (!newSpike.isValid()) return;
 
-	int electrodeNum = getSpikeChannelIndex(newSpike);
+	// spikeInfo is this processor's copy of the channel, so it already knows its index
+	int electrodeNum = spikeInfo->getCurrentNodeChannelIdx();
+	if (electrodeNum >= electrodes.size()) return;
 
 	Electrode* e = electrodes[electrodeNum];
 	// std::cout << electrodeNum << std::endl;
 
 	bool aboveThreshold = false;
 
-	// update threshold / check threshold
+	// check threshold
 	for (int i = 0; i < e->numChannels; ++i)
 	{
-		e->detectorThresholds.set(i, float(newSpike->getThreshold(i))); // / float(newSpike.gain[i]));
-
-		aboveThreshold = aboveThreshold | checkThreshold(i, e->displayThresholds[i], newSpike);
+		aboveThreshold = aboveThreshold | checkThreshold(i, e->displayThresholds[i].get(), newSpike);
 	}
 
 	if (aboveThreshold)
@@ -243,28 +212,79 @@ void SpikeDisplayNode::handleSpike(const SpikeChannel* spikeInfo, const MidiMess
 		// save spike
 		if (isRecording)
 		{
-			CoreServices::RecordNode::writeSpike(newSpike, spikeInfo);
+			// the record node takes a SpikeEvent, so recorded spikes are still deserialized here
+			SpikeEventPtr spike = SpikeEvent::deserializeFromMessage(event, spikeInfo);
+			if (spike)
+				CoreServices::RecordNode::writeSpike(spike, spikeInfo);
 		}
-		// add to buffer
-		if (e->currentSpikeIndex < displayBufferSize)
+
+		// add to the mailbox, or drop it if the canvas hasn't kept up
+		if (event.getRawDataSize() == e->spikeSize)
 		{
-			//This releases the spike from the smart pointer to avoid copies, so it's done latest.
-			e->mostRecentSpikes.set(e->currentSpikeIndex, newSpike.release());
-			e->currentSpikeIndex++;
+			int start1, size1, start2, size2;
+			e->spikeFifo.prepareToWrite(1, start1, size1, start2, size2);
+
+			if (size1 > 0)
+			{
+				memcpy(e->spikeData + start1 * e->spikeSize, event.getRawData(), e->spikeSize);
+				e->spikeFifo.finishedWrite(1);
+			}
 		}
-
-		
 	}
 }
 
 
-bool SpikeDisplayNode::checkThreshold (int chan, float thresh, SpikeEvent* s)
+void SpikeDisplayNode::updateSpikePlots()
+{
+    for (int i = 0; i < getNumElectrodes(); ++i)
+    {
+        Electrode* e = electrodes[i];
+
+        if (e->spikePlot == nullptr)
+            continue;
+
+        // update thresholds
+        for (int j = 0; j < e->numChannels; ++j)
+        {
+            e->displayThresholds[j].set (e->spikePlot->getDisplayThresholdForChannel (j));
+        }
+
+        const SpikeChannel* spikeInfo = getSpikeChannel(i);
+
+        // transfer the queued spikes to the spike plot
+        int start1, size1, start2, size2;
+        e->spikeFifo.prepareToRead (e->spikeFifo.getNumReady(), start1, size1, start2, size2);
+
+        for (int j = 0; j < size1 + size2; ++j)
+        {
+            const int slot = j < size1 ? start1 + j : start2 + j - size1;
+
+            MidiMessage event (e->spikeData + slot * e->spikeSize, e->spikeSize, 0);
+            SpikeEventPtr spike = SpikeEvent::deserializeFromMessage (event, spikeInfo);
+
+            if (!spike)
+                continue;
+
+            for (int k = 0; k < e->numChannels; ++k)
+            {
+                e->spikePlot->setDetectorThresholdForChannel (k, spike->getThreshold (k));
+            }
+
+            e->spikePlot->processSpikeObject (spike);
+        }
+
+        e->spikeFifo.finishedRead (size1 + size2);
+    }
+}
+
+
+bool SpikeDisplayNode::checkThreshold (int chan, float thresh, const SpikeEventView& s)
 {
-	int nSamples = getSpikeChannel(getSpikeChannelIndex(s))->getTotalSamples();
+	int nSamples = s.getChannelInfo()->getTotalSamples();
 
     for (int i = 0; i < nSamples-1; ++i)
     {
-        if  (s->getDataPointer(chan)[i]  > thresh)
+        if  (s.getSample (chan, i)  > thresh)
         {
             return true;
         }
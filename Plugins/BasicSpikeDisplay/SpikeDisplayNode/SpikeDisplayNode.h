@@ -33,7 +33,12 @@ class SpikePlot;
 
 /**
   Takes in MidiEvents and extracts SpikeObjects from the MidiEvent buffers.
-  Those Events are then held in a queue until they are pulled by the SpikeDisplayCanvas.
+
+  Spikes above the display threshold are copied, still serialized, into a
+  single-producer single-consumer mailbox per electrode. The SpikeDisplayCanvas
+  drains the mailboxes on the message thread through updateSpikePlots(), which
+  is where the spikes are deserialized, so the audio thread only deserializes
+  the spikes it has to write to disk.
 
   @see GenericProcessor, SpikeDisplayEditor, SpikeDisplayCanvas
 */
@@ -46,6 +51,9 @@ public:
     AudioProcessorEditor* createEditor() override;
 
     void process (AudioSampleBuffer& buffer) override;
+    bool readsContinuousData() const override { return false; }
+    bool modifiesContinuousData() const override { return false; }
+    bool emitsEvents() const override { return false; }
 
     void setParameter (int parameterIndex, float newValue) override;
 
@@ -66,32 +74,40 @@ public:
     void addSpikePlotForElectrode (SpikePlot* sp, int i);
     void removeSpikePlots();
 
-    bool checkThreshold (int, float, SpikeEvent*);
+    /** Hands the spikes queued since the last call to their plots, and reads the
+        display thresholds back from them. Called by the canvas on the message thread. */
+    void updateSpikePlots();
+
+    bool checkThreshold (int, float, const SpikeEventView&);
 
 
 private:
     struct Electrode
     {
+        Electrode() : spikeFifo (mailboxSize) {}
+
         String name;
 
         int numChannels;
         int recordIndex;
-        int currentSpikeIndex;
 
-        Array<float> displayThresholds;
-        Array<float> detectorThresholds;
+        /** Set by the message thread, read by the audio thread */
+        HeapBlock<Atomic<float>> displayThresholds;
 
-        OwnedArray<SpikeEvent> mostRecentSpikes;
+        // serialized spikes, written by the audio thread and read by the message thread
+        AbstractFifo spikeFifo;
+        HeapBlock<uint8> spikeData;
+        int spikeSize;
 
 		float bitVolts;
 
         SpikePlot* spikePlot;
     };
 
-    OwnedArray<Electrode> electrodes;
+    /** Spikes each electrode can queue between two canvas refreshes; more are dropped */
+    static const int mailboxSize = 64;
 
-    int displayBufferSize;
-    bool redrawRequested;
+    OwnedArray<Electrode> electrodes;
 
     // members for recording
     bool isRecording;
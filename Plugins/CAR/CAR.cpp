@@ -26,13 +26,29 @@
 #include "CAR.h"
 #include "CAREditor.h"
 
+#include <algorithm>
+
+
+namespace
+{
+    // Samples are processed in tiles whose reference channel data fits in the L1 cache,
+    // so each sample is read from memory once for the reference and once when it is corrected
+    const int maxTileSamples = 1024;
+    const int minTileSamples = 16;
+    const int tileBytes      = 32 * 1024;
+}
 
 CAR::CAR()
     : GenericProcessor ("Common Avg Ref") //, threshold(200.0), state(true)
+    , m_numActiveReferenceChannels  (0)
+    , m_maxGroupReferenceChannels   (0)
+    , m_scratchSize                 (0)
+    , m_valuesSize                  (0)
 {
     setProcessorType (PROCESSOR_TYPE_FILTER);
 
-    m_avgBuffer = AudioSampleBuffer (1, 10000); // 1-dimensional buffer to hold the avg
+    m_referenceMode = MEAN_REFERENCE;
+    m_activeGroups.ensureStorageAllocated (NUM_REFERENCE_GROUPS);
 }
 
 
@@ -61,81 +77,274 @@ void CAR::setGainLevel (float newGain)
 }
 
 
-void CAR::process (AudioSampleBuffer& buffer)
+CAR::ReferenceMode CAR::getReferenceMode() const
 {
-    const int numSamples            = buffer.getNumSamples();
-    const int numReferenceChannels  = m_referenceChannels.size();
-    const int numAffectedChannels   = m_affectedChannels.size();
+    return static_cast<ReferenceMode> (m_referenceMode.get());
+}
+
+
+void CAR::setReferenceMode (ReferenceMode newMode)
+{
+    m_referenceMode = newMode;
+}
+
+
+bool CAR::enable()
+{
+    // every parallelFor() range gets its scratch here, so that process() never allocates.
+    // A group has at most one reference per input, and tiles are shortened to fit
+    m_valuesSize  = jmax (tileBytes / int (sizeof (float)), getNumInputs() * minTileSamples);
+    m_scratchSize = NUM_REFERENCE_GROUPS * maxTileSamples + m_valuesSize;
+    m_scratch.malloc ((size_t) getMaxParallelRanges() * m_scratchSize);
+
+    return GenericProcessor::enable();
+}
 
-    // There are no sense to do any processing if either number of reference or affected channels is zero.
-    if (! numReferenceChannels
-        || ! numAffectedChannels)
+
+void CAR::updateActiveGroups()
+{
+    // There are no sense to do any processing for groups where either number of reference or affected channels is zero.
+    m_activeGroups.clearQuick();
+    m_numActiveReferenceChannels = 0;
+    m_maxGroupReferenceChannels = 0;
+
+    for (int g = 0; g < NUM_REFERENCE_GROUPS; ++g)
     {
-        return;
+        if (m_groups[g].referenceChannels.size() > 0
+            && m_groups[g].affectedChannels.size() > 0)
+        {
+            m_activeGroups.add (&m_groups[g]);
+            m_numActiveReferenceChannels += m_groups[g].referenceChannels.size();
+            m_maxGroupReferenceChannels = jmax (m_maxGroupReferenceChannels, m_groups[g].referenceChannels.size());
+        }
     }
+}
 
-    m_avgBuffer.clear();
 
-    for (int i = 0; i < numReferenceChannels; ++i)
+void CAR::computeReference (const AudioSampleBuffer& buffer, const Array<int>& referenceChannels,
+                            int startSample, int numSamples, float* reference, float* values) const
+{
+    const int numReferenceChannels = referenceChannels.size();
+
+    if (getReferenceMode() == MEDIAN_REFERENCE)
     {
-        m_avgBuffer.addFrom (0,                         // destChannel
-                             0,                         // destStartSample
-                             buffer,                    // source
-                             m_referenceChannels[i],    // sourceChannel
-                             0,                         // sourceStartSample
-                             numSamples,                // numSamples
-                             1.0f);                     // gain to apply
+        // gather the tile sample by sample, then select the middle value of each sample
+        for (int i = 0; i < numReferenceChannels; ++i)
+        {
+            const float* source = buffer.getReadPointer (referenceChannels[i], startSample);
+
+            for (int n = 0; n < numSamples; ++n)
+                values[(size_t) n * numReferenceChannels + i] = source[n];
+        }
+
+        const int middle = numReferenceChannels / 2;
+
+        for (int n = 0; n < numSamples; ++n)
+        {
+            float* first = values + (size_t) n * numReferenceChannels;
+            std::nth_element (first, first + middle, first + numReferenceChannels);
+
+            float median = first[middle];
+
+            // with an even number of channels, average the two middle values
+            if (numReferenceChannels % 2 == 0)
+                median = 0.5f * (median + *std::max_element (first, first + middle));
+
+            reference[n] = median;
+        }
+    }
+    else
+    {
+        FloatVectorOperations::copy (reference, buffer.getReadPointer (referenceChannels[0], startSample), numSamples);
+
+        for (int i = 1; i < numReferenceChannels; ++i)
+            FloatVectorOperations::add (reference, buffer.getReadPointer (referenceChannels[i], startSample), numSamples);
+
+        FloatVectorOperations::multiply (reference, 1.0f / float (numReferenceChannels), numSamples);
     }
+}
+
+
+void CAR::process (AudioSampleBuffer& buffer)
+{
+    const ScopedLock myScopedLock (objectLock);
 
-    m_avgBuffer.applyGain (1.0f / float (numReferenceChannels));
+    const int numSamples = buffer.getNumSamples();
+    const Array<const ReferenceGroup*>& groups = m_activeGroups;
+
+    if (groups.size() == 0)
+        return;
 
     m_gainLevel.updateTarget();
     const float gain = -1.0f * m_gainLevel.getNextValue() / 100.f;
 
-    for (int i = 0; i < numAffectedChannels; ++i)
+    int tileSamples = jlimit (minTileSamples, maxTileSamples,
+                              tileBytes / int (sizeof (float) * m_numActiveReferenceChannels));
+    tileSamples = jmax (1, jmin (tileSamples, m_valuesSize / m_maxGroupReferenceChannels));
+    const int numTiles = (numSamples + tileSamples - 1) / tileSamples;
+
+    // tiles cover separate samples of every channel, so they can be processed concurrently
+    parallelFor (numTiles, [this, &buffer, &groups, numSamples, tileSamples, gain] (int firstTile, int lastTile)
     {
-        buffer.addFrom (m_affectedChannels[i],  // destChannel
-                        0,                      // destStartSample
-                        m_avgBuffer,            // source
-                        0,                      // sourceChannel
-                        0,                      // sourceStartSample
-                        numSamples,             // numSamples
-                        gain);                  // gain to apply
-    }
+        float* const references = m_scratch + (size_t) getParallelRangeIndex() * m_scratchSize;
+        float* const values = references + NUM_REFERENCE_GROUPS * maxTileSamples;
+
+        for (int t = firstTile; t < lastTile; ++t)
+        {
+            const int startSample = t * tileSamples;
+            const int tileLength  = jmin (tileSamples, numSamples - startSample);
+
+            // every reference is taken before any channel is corrected, so groups
+            // whose affected channels are another group's references stay independent
+            for (int g = 0; g < groups.size(); ++g)
+            {
+                computeReference (buffer, groups[g]->referenceChannels, startSample, tileLength,
+                                  references + (size_t) g * tileSamples, values);
+            }
+
+            for (int g = 0; g < groups.size(); ++g)
+            {
+                const Array<int>& affectedChannels = groups[g]->affectedChannels;
+                const float* reference = references + (size_t) g * tileSamples;
+
+                for (int i = 0; i < affectedChannels.size(); ++i)
+                {
+                    FloatVectorOperations::addWithMultiply (buffer.getWritePointer (affectedChannels[i], startSample),
+                                                            reference, gain, tileLength);
+                }
+            }
+        }
+    });
 }
 
 
-void CAR::setReferenceChannels (const Array<int>& newReferenceChannels)
+void CAR::setReferenceChannels (const Array<int>& newReferenceChannels, int group)
 {
     const ScopedLock myScopedLock (objectLock);
 
-    m_referenceChannels = Array<int> (newReferenceChannels);
+    m_groups[group].referenceChannels = Array<int> (newReferenceChannels);
+
+    updateActiveGroups();
 }
 
 
-void CAR::setAffectedChannels (const Array<int>& newAffectedChannels)
+void CAR::setAffectedChannels (const Array<int>& newAffectedChannels, int group)
 {
     const ScopedLock myScopedLock (objectLock);
 
-    m_affectedChannels = Array<int> (newAffectedChannels);
+    m_groups[group].affectedChannels = Array<int> (newAffectedChannels);
+
+    updateActiveGroups();
 }
 
 
-void CAR::setReferenceChannelState (int channel, bool newState)
+void CAR::setReferenceChannelState (int channel, bool newState, int group)
 {
+    const ScopedLock myScopedLock (objectLock);
+
     if (! newState)
-        m_referenceChannels.removeFirstMatchingValue (channel);
+        m_groups[group].referenceChannels.removeFirstMatchingValue (channel);
     else
-        m_referenceChannels.addIfNotAlreadyThere (channel);
+        m_groups[group].referenceChannels.addIfNotAlreadyThere (channel);
+
+    updateActiveGroups();
 }
 
 
-void CAR::setAffectedChannelState (int channel, bool newState)
+void CAR::setAffectedChannelState (int channel, bool newState, int group)
 {
+    const ScopedLock myScopedLock (objectLock);
+
     if (! newState)
-        m_affectedChannels.removeFirstMatchingValue (channel);
+        m_groups[group].affectedChannels.removeFirstMatchingValue (channel);
     else
-        m_affectedChannels.add (channel);
+        m_groups[group].affectedChannels.addIfNotAlreadyThere (channel);
+
+    updateActiveGroups();
+}
+
+
+bool CAR::loadGroupMap (const File& file)
+{
+    var json = JSON::parse (file);
+    DynamicObject* map = json.getDynamicObject();
+
+    if (map == nullptr)
+    {
+        std::cerr << "CAR: " << file.getFullPathName() << " is not a JSON channel map" << std::endl;
+        return false;
+    }
+
+    ReferenceGroup loaded[NUM_REFERENCE_GROUPS];
+    int numLoaded = 0;
+    int numDropped = 0;
+
+    // process() reads and writes the listed channels unchecked, so those this node doesn't have are dropped
+    auto addChannels = [this, &numDropped] (const Array<var>& list, Array<int>& channels)
+    {
+        for (int i = 0; i < list.size(); ++i)
+        {
+            const var& value = list.getReference (i);
+            const int channel = int (value);
+
+            if ((value.isInt() || value.isInt64() || value.isDouble()) && isPositiveAndBelow (channel, getNumInputs()))
+                channels.addIfNotAlreadyThere (channel);
+            else
+                ++numDropped;
+        }
+    };
+
+    for (int g = 0; g < NUM_REFERENCE_GROUPS; ++g)
+    {
+        const var group = map->getProperty (Identifier (String (g)));
+        if (group.isVoid())
+            continue;
+
+        const Array<var>* channels  = group["channels"].getArray();
+        const Array<var>* reference = group["reference"].getArray();
+
+        if (channels == nullptr)
+        {
+            std::cerr << "CAR: group " << g << " of " << file.getFileName() << " has no channels" << std::endl;
+            return false;
+        }
+
+        addChannels (*channels, loaded[g].affectedChannels);
+
+        if (reference != nullptr)
+            addChannels (*reference, loaded[g].referenceChannels);
+        else
+        {
+            loaded[g].referenceChannels = loaded[g].affectedChannels;
+        }
+
+        ++numLoaded;
+    }
+
+    if (numLoaded == 0)
+    {
+        std::cerr << "CAR: " << file.getFileName() << " has no groups numbered 0 to "
+                  << NUM_REFERENCE_GROUPS - 1 << std::endl;
+        return false;
+    }
+
+    if (numDropped > 0)
+    {
+        std::cerr << "CAR: ignored " << numDropped << " channel numbers of " << file.getFileName()
+                  << " that are not between 0 and " << getNumInputs() - 1 << std::endl;
+    }
+
+    const ScopedLock myScopedLock (objectLock);
+
+    for (int g = 0; g < NUM_REFERENCE_GROUPS; ++g)
+    {
+        m_groups[g].referenceChannels.swapWith (loaded[g].referenceChannels);
+        m_groups[g].affectedChannels.swapWith  (loaded[g].affectedChannels);
+    }
+
+    updateActiveGroups();
+
+    return true;
 }
 
 void CAR::saveCustomChannelParametersToXml(XmlElement* channelElement,
@@ -143,15 +352,27 @@ void CAR::saveCustomChannelParametersToXml(XmlElement* channelElement,
 {
     if (channelType == InfoObjectCommon::DATA_CHANNEL)
     {
-        XmlElement* groupState = channelElement->createNewChildElement("GROUPSTATE");
-        
-        const Array<int>& referenceChannels = getReferenceChannels();
-        bool isReferenceChannel = referenceChannels.contains(channelNumber);
-        groupState->setAttribute("reference", isReferenceChannel);
-
-        const Array<int>& affectedChannels = getAffectedChannels();
-        bool isAffectedChannel = affectedChannels.contains(channelNumber);
-        groupState->setAttribute("affected", isAffectedChannel);
+        // one GROUPSTATE for each group the channel belongs to. Group 0 is always
+        // written, so configurations without groups read the same as before
+        for (int g = 0; g < NUM_REFERENCE_GROUPS; ++g)
+        {
+            const Array<int>& referenceChannels = getReferenceChannels (g);
+            bool isReferenceChannel = referenceChannels.contains(channelNumber);
+
+            const Array<int>& affectedChannels = getAffectedChannels (g);
+            bool isAffectedChannel = affectedChannels.contains(channelNumber);
+
+            if (g > 0 && ! isReferenceChannel && ! isAffectedChannel)
+                continue;
+
+            XmlElement* groupState = channelElement->createNewChildElement("GROUPSTATE");
+
+            if (g > 0)
+                groupState->setAttribute("group", g);
+
+            groupState->setAttribute("reference", isReferenceChannel);
+            groupState->setAttribute("affected", isAffectedChannel);
+        }
     }
 }
 
@@ -164,17 +385,21 @@ void CAR::loadCustomChannelParametersFromXml(XmlElement* channelElement,
 
         forEachXmlChildElementWithTagName(*channelElement, groupState, "GROUPSTATE")
         {
+            const int group = groupState->getIntAttribute("group", 0);
+            if (group < 0 || group >= NUM_REFERENCE_GROUPS)
+                continue;
+
             if (groupState->hasAttribute("reference"))
             {
                 bool isReferenceChannel = groupState->getBoolAttribute("reference");
-                setReferenceChannelState(channelNumber, isReferenceChannel);
+                setReferenceChannelState(channelNumber, isReferenceChannel, group);
             }
 
             if (groupState->hasAttribute("affected"))
             {
                 bool isAffectedChannel = groupState->getBoolAttribute("affected");
-                setAffectedChannelState(channelNumber, isAffectedChannel);
+                setAffectedChannelState(channelNumber, isAffectedChannel, group);
             }
         }
     }
-}
\ No newline at end of file
+}
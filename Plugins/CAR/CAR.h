@@ -38,6 +38,13 @@
     See Ludwig et al. 2009 Using a common average reference to improve cortical
     neuron recordings from microelectrode arrays. J. Neurophys, 2009 for a detailed
     discussion
+
+    Instead of the mean, the reference can be the median of the reference channels,
+    which is not pulled away by a few channels with large spikes or artifacts.
+
+    Channels can be split into independent reference groups, e.g. one per probe shank,
+    each with its own reference and affected channels. All groups are computed in the
+    same pass over the buffer.
 */
 class CAR : public GenericProcessor
 {
@@ -68,17 +75,41 @@ public:
     /** Sets the new gain level that will be used in the processor */
     void setGainLevel (float newGain);
 
+    enum ReferenceMode
+    {
+        MEAN_REFERENCE = 0,
+        MEDIAN_REFERENCE
+    };
+
+    ReferenceMode getReferenceMode() const;
+
+    /** Sets whether the mean or the median of the reference channels is subtracted */
+    void setReferenceMode (ReferenceMode newMode);
+
     /** Creates the CAREditor. */
     AudioProcessorEditor* createEditor() override;
 
-    Array<int> getReferenceChannels() const     { return m_referenceChannels; }
-    Array<int> getAffectedChannels()  const     { return m_affectedChannels; }
+    /** Allocates the scratch buffers process() works in */
+    bool enable() override;
+
+    enum { NUM_REFERENCE_GROUPS = 16 };
+
+    Array<int> getReferenceChannels (int group = 0) const     { return m_groups[group].referenceChannels; }
+    Array<int> getAffectedChannels  (int group = 0) const     { return m_groups[group].affectedChannels; }
 
-    void setReferenceChannels (const Array<int>& newReferenceChannels);
-    void setAffectedChannels  (const Array<int>& newAffectedChannels);
+    void setReferenceChannels (const Array<int>& newReferenceChannels, int group = 0);
+    void setAffectedChannels  (const Array<int>& newAffectedChannels,  int group = 0);
 
-    void setReferenceChannelState (int channel, bool newState);
-    void setAffectedChannelState  (int channel, bool newState);
+    void setReferenceChannelState (int channel, bool newState, int group = 0);
+    void setAffectedChannelState  (int channel, bool newState, int group = 0);
+
+    /** Replaces all groups with those of a JSON channel map, keyed by group number:
+            { "0": { "channels": [0, 1, ...], "reference": [0, 1, ...] }, "1": ... }
+        Channel numbers start from zero; those this node has no input for are ignored. The
+        reference of a group is taken over all its channels, each channel included, unless the
+        group lists its own "reference" channels. Returns false, leaving the groups unchanged,
+        if the file is not a valid map. */
+    bool loadGroupMap (const File& file);
 
     /** Saving/loading channel parameters */
     void saveCustomChannelParametersToXml(XmlElement* channelElement,
@@ -87,12 +118,20 @@ public:
         InfoObjectCommon::InfoObjectType channelType);
 
 private:
+    /** Computes the reference of numSamples samples from startSample into reference. The median
+        gathers the samples into values, which holds referenceChannels.size() * numSamples floats */
+    void computeReference (const AudioSampleBuffer& buffer, const Array<int>& referenceChannels,
+                           int startSample, int numSamples, float* reference, float* values) const;
+
+    /** Rebuilds m_activeGroups, with objectLock held */
+    void updateActiveGroups();
+
     LinearSmoothedValueAtomic<float> m_gainLevel;
 
-    AudioSampleBuffer m_avgBuffer;
+    Atomic<int> m_referenceMode;
 
     /** We should add this for safety to prevent any app crashes or invalid data processing.
-        Since we use m_referenceChannels and m_affectedChannels arrays in the process() function,
+        Since we use the reference and affected channel arrays of m_groups in the process() function,
         which works in audioThread, we may stumble upon the situation when we start changing
         either reference or affected channels by copying array and in the middle of copying process
         we will be interrupted by audioThread. So it most probably will lead to app crash or
@@ -100,11 +139,27 @@ private:
     */
     CriticalSection objectLock;
 
-    /** Array of channels which will be used to calculate mean signal. */
-    Array<int> m_referenceChannels;
+    struct ReferenceGroup
+    {
+        /** Array of channels which will be used to calculate mean signal. */
+        Array<int> referenceChannels;
+
+        /** Array of channels that will be affected by adding/substracting of mean signal of reference channels */
+        Array<int> affectedChannels;
+    };
+
+    ReferenceGroup m_groups[NUM_REFERENCE_GROUPS];
+
+    /** Groups with both reference and affected channels, the only ones process() works on */
+    Array<const ReferenceGroup*> m_activeGroups;
+    int m_numActiveReferenceChannels;
+    int m_maxGroupReferenceChannels;
 
-    /** Array of channels that will be affected by adding/substracting of mean signal of reference channels */
-    Array<int> m_affectedChannels;
+    /** Scratch of every parallelFor() range, m_scratchSize floats each: the references of a
+        tile for every group, then m_valuesSize floats for the median */
+    HeapBlock<float> m_scratch;
+    int m_scratchSize;
+    int m_valuesSize;
 
     // ==================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CAR);
@@ -33,7 +33,9 @@ static const Colour COLOUR_ACCENT  (Colour::fromRGB (3, 169, 244));
 CAREditor::CAREditor (GenericProcessor* parentProcessor, bool useDefaultParameterEditors)
     : GenericEditor (parentProcessor, useDefaultParameterEditors)
     , m_currentChannelsView          (REFERENCE_CHANNELS)
+    , m_currentGroup                 (0)
     , m_channelSelectorButtonManager (new LinearButtonGroupManager)
+    , m_referenceModeButtonManager   (new LinearButtonGroupManager)
     , m_gainSlider                   (new ParameterSlider (0.0, 100.0, 100.0, Font("Default", 13.f, Font::plain)))
 {
     TextButton* referenceChannelsButton = new TextButton ("Reference", "Switch to reference channels");
@@ -61,6 +63,44 @@ CAREditor::CAREditor (GenericProcessor* parentProcessor, bool useDefaultParamete
     m_channelSelectorButtonManager->setColour (LinearButtonGroupManager::accentColourId, COLOUR_ACCENT);
     addAndMakeVisible (m_channelSelectorButtonManager);
 
+    TextButton* meanButton = new TextButton ("Mean", "Subtract the mean of the reference channels");
+    meanButton->setClickingTogglesState (true);
+    meanButton->setToggleState (true, dontSendNotification);
+    meanButton->setColour (TextButton::buttonColourId,     Colour (0x0));
+    meanButton->setColour (TextButton::buttonOnColourId,   Colour (0x0));
+    meanButton->setColour (TextButton::textColourOffId,    COLOUR_PRIMARY);
+    meanButton->setColour (TextButton::textColourOnId,     COLOUR_ACCENT);
+
+    m_medianButton = new TextButton ("Median", "Subtract the median of the reference channels");
+    m_medianButton->setClickingTogglesState (true);
+    m_medianButton->setColour (TextButton::buttonColourId,     Colour (0x0));
+    m_medianButton->setColour (TextButton::buttonOnColourId,   Colour (0x0));
+    m_medianButton->setColour (TextButton::textColourOffId,    COLOUR_PRIMARY);
+    m_medianButton->setColour (TextButton::textColourOnId,     COLOUR_ACCENT);
+
+    m_referenceModeButtonManager->addButton (meanButton);
+    m_referenceModeButtonManager->addButton (m_medianButton);
+    m_referenceModeButtonManager->setRadioButtonMode (true);
+    m_referenceModeButtonManager->setButtonListener (this);
+    m_referenceModeButtonManager->setButtonsLookAndFeel (m_materialButtonLookAndFeel);
+    m_referenceModeButtonManager->setColour (ButtonGroupManager::backgroundColourId,   Colours::white);
+    m_referenceModeButtonManager->setColour (ButtonGroupManager::outlineColourId,      Colour (0x0));
+    m_referenceModeButtonManager->setColour (LinearButtonGroupManager::accentColourId, COLOUR_ACCENT);
+    addAndMakeVisible (m_referenceModeButtonManager);
+
+    m_groupSelector = new ComboBox ("Group selector");
+    for (int g = 0; g < CAR::NUM_REFERENCE_GROUPS; ++g)
+        m_groupSelector->addItem ("Group " + String (g + 1), g + 1);
+    m_groupSelector->setSelectedId (1, dontSendNotification);
+    m_groupSelector->setTooltip ("Each group is re-referenced independently, e.g. one group per shank");
+    m_groupSelector->addListener (this);
+    addAndMakeVisible (m_groupSelector);
+
+    m_loadMapButton = new UtilityButton ("LOAD MAP", Font ("Small Text", 10, Font::plain));
+    m_loadMapButton->setTooltip ("Load the reference groups from a JSON channel map");
+    m_loadMapButton->addListener (this);
+    addAndMakeVisible (m_loadMapButton);
+
     m_gainSlider->setColour (Slider::rotarySliderFillColourId, Colour::fromRGB (255, 193, 7));
     m_gainSlider->setName ("Gain (%)");
     m_gainSlider->addListener (this);
@@ -68,7 +108,7 @@ CAREditor::CAREditor (GenericProcessor* parentProcessor, bool useDefaultParamete
 
     channelSelector->paramButtonsToggledByDefault (false);
 
-    setDesiredWidth (280);
+    setDesiredWidth (360);
 }
 
 
@@ -93,7 +133,11 @@ void CAREditor::paint (Graphics& g)
 
 void CAREditor::resized()
 {
-    m_channelSelectorButtonManager->setBounds (110, 50, 150, 36);
+    m_channelSelectorButtonManager->setBounds (110, 40, 150, 36);
+    m_referenceModeButtonManager->setBounds   (110, 84, 150, 28);
+
+    m_groupSelector->setBounds (270, 45, 80, 20);
+    m_loadMapButton->setBounds (270, 88, 80, 20);
 
     m_gainSlider->setBounds (15, 30, 80, 80);
 
@@ -108,32 +152,83 @@ void CAREditor::buttonClicked (Button* buttonThatWasClicked)
     // "Reference channels" button clicked
     if (buttonName.startsWith ("reference"))
     {
-        channelSelector->setActiveChannels (static_cast<CAR*> (getProcessor())->getReferenceChannels());
-
         m_currentChannelsView = REFERENCE_CHANNELS;
+        updateChannelSelector();
     }
     // "Affected channels" button clicked
     else if (buttonName.startsWith ("affected"))
     {
-        channelSelector->setActiveChannels (static_cast<CAR*> (getProcessor())->getAffectedChannels());
-
         m_currentChannelsView = AFFECTED_CHANNELS;
+        updateChannelSelector();
+    }
+    else if (buttonThatWasClicked == m_loadMapButton)
+    {
+        FileChooser fc ("Choose a channel map to load...",
+                        CoreServices::getDefaultUserSaveDirectory(),
+                        "*.json;*.prb",
+                        true);
+
+        if (fc.browseForFileToOpen())
+        {
+            File fileToOpen = fc.getResult();
+
+            if (static_cast<CAR*> (getProcessor())->loadGroupMap (fileToOpen))
+            {
+                updateChannelSelector();
+                CoreServices::sendStatusMessage ("Loaded " + fileToOpen.getFileName());
+            }
+            else
+            {
+                CoreServices::sendStatusMessage ("Not a valid channel map.");
+            }
+        }
+
+        return;
+    }
+    // "Mean" or "Median" button clicked
+    else if (buttonName == "mean" || buttonName == "median")
+    {
+        static_cast<CAR*> (getProcessor())->setReferenceMode (m_medianButton->getToggleState()
+                                                              ? CAR::MEDIAN_REFERENCE
+                                                              : CAR::MEAN_REFERENCE);
+        return;
     }
 
     GenericEditor::buttonClicked (buttonThatWasClicked);
 }
 
 
+void CAREditor::comboBoxChanged (ComboBox* comboBoxThatHasChanged)
+{
+    if (comboBoxThatHasChanged == m_groupSelector)
+    {
+        m_currentGroup = m_groupSelector->getSelectedId() - 1;
+        updateChannelSelector();
+    }
+}
+
+
+void CAREditor::updateChannelSelector()
+{
+    auto processor = static_cast<CAR*> (getProcessor());
+
+    if (m_currentChannelsView == REFERENCE_CHANNELS)
+        channelSelector->setActiveChannels (processor->getReferenceChannels (m_currentGroup));
+    else
+        channelSelector->setActiveChannels (processor->getAffectedChannels (m_currentGroup));
+}
+
+
 void CAREditor::channelChanged (int channel, bool newState)
 {
     auto processor = static_cast<CAR*> (getProcessor());
     if (m_currentChannelsView == REFERENCE_CHANNELS)
     {
-        processor->setReferenceChannelState (channel, newState);
+        processor->setReferenceChannelState (channel, newState, m_currentGroup);
     }
     else
     {
-        processor->setAffectedChannelState (channel, newState);
+        processor->setAffectedChannelState (channel, newState, m_currentGroup);
     }
 }
 
@@ -153,6 +248,7 @@ void CAREditor::saveCustomParameters(XmlElement* xml)
 
     XmlElement* paramValues = xml->createNewChildElement("VALUES");
     paramValues->setAttribute("gainLevel", processor->getGainLevel());
+    paramValues->setAttribute("median", processor->getReferenceMode() == CAR::MEDIAN_REFERENCE);
 }
 
 void CAREditor::loadCustomParameters(XmlElement* xml)
@@ -163,5 +259,9 @@ void CAREditor::loadCustomParameters(XmlElement* xml)
     {
         double gain = xmlNode->getDoubleAttribute("gainLevel", m_gainSlider->getValue());
         m_gainSlider->setValue(gain, sendNotificationSync);
+
+        const bool median = xmlNode->getBoolAttribute("median", false);
+        processor->setReferenceMode(median ? CAR::MEDIAN_REFERENCE : CAR::MEAN_REFERENCE);
+        m_referenceModeButtonManager->getButtonAt(median ? 1 : 0)->setToggleState(true, dontSendNotification);
     }
 }
\ No newline at end of file
@@ -58,8 +58,9 @@ ChannelMappingEditor::ChannelMappingEditor(GenericProcessor* parentNode, bool us
     addAndMakeVisible(electrodeButtonViewport = new Viewport());
     electrodeButtonViewport->setBounds(10,30,330,70);
     electrodeButtonViewport->setScrollBarsShown(true,false,true,true);
-    electrodeButtonHolder = new Component();
-    electrodeButtonViewport->setViewedComponent(electrodeButtonHolder,false);
+    electrodeGrid = new ChannelMapGrid(this);
+    electrodeGrid->addMouseListener(this, false); // dragging and double clicks while remapping
+    electrodeButtonViewport->setViewedComponent(electrodeGrid,false);
     
 
     loadButton = new LoadButton();
@@ -136,7 +137,7 @@ void ChannelMappingEditor::createElectrodeButtons(int numNeeded, bool clearPrevi
 
     if (clearPrevious)
     {
-        electrodeButtons.clear();
+        electrodeGrid->setNumButtons(0);
 
         referenceArray.clear();
         channelArray.clear();
@@ -154,60 +155,34 @@ void ChannelMappingEditor::createElectrodeButtons(int numNeeded, bool clearPrevi
     }
     else
     {
-        startButton = electrodeButtons.size();
+        startButton = electrodeGrid->getNumButtons();
         if (startButton > numNeeded) return;
         //row = startButton/16;
         //column = startButton % 16;
     }
 
+    electrodeGrid->setNumButtons(numNeeded);
+    electrodeGrid->setClickingTogglesState(!reorderActive);
+
     for (int i = startButton; i < numNeeded; i++)
     {
-        ElectrodeButton* button = new ElectrodeButton(i+1);
-        electrodeButtons.add(button);
-
-        button->setRadioGroupId(0);
-
-        // if (!getCollapsedState())
-        //     addAndMakeVisible(button);
-        // else
-        electrodeButtonHolder->addAndMakeVisible(button); // determine visibility in refreshButtonLocations()
-
-        button->addListener(this);
-        if (reorderActive)
-        {
-            button->setToggleState(true,dontSendNotification);
-            electrodeButtons[i]->setClickingTogglesState(false);
-            electrodeButtons[i]->addMouseListener(this,false);
-        }
-        else
-        {
-            button->setToggleState(false,dontSendNotification);
-            electrodeButtons[i]->setClickingTogglesState(true);
-        }
-
-        referenceArray.add(-1);
+        // enabled channels are shown toggled while remapping
+        electrodeGrid->setToggleState(i, reorderActive);
 
-        getProcessor()->setCurrentChannel(i);
-        getProcessor()->setParameter(0,i); // set channel mapping to standard channel
-        getProcessor()->setParameter(1,-1); // set reference to none
-        getProcessor()->setParameter(3,1); //enable channel
-
-        channelArray.add(i+1);
+        referenceArray.add(-1); // no reference
+        channelArray.add(i+1); // standard channel
         enabledChannelArray.add(true);
-
     }
 
     if (clearPrevious)
     {
-        getProcessor()->setCurrentChannel(-1);
         for (int i = 0; i < NUM_REFERENCES; i++)
         {
-
-            getProcessor()->setParameter(2,i); //Clear reference
-            referenceChannels.add(-1);
+            referenceChannels.add(-1); //Clear reference
             referenceButtons[i]->setEnabled(true);
         }
     }
+    applyMap();
     channelSelector->setRadioStatus(true);
 
     refreshButtonLocations();
@@ -216,29 +191,10 @@ void ChannelMappingEditor::createElectrodeButtons(int numNeeded, bool clearPrevi
 void ChannelMappingEditor::refreshButtonLocations()
 {
     electrodeButtonViewport->setVisible(!getCollapsedState());
-    int width = 19;
-    int height = 15;
-    int row = 0;
-    int column = 0;
-    int totalWidth = 0;
-    int totalHeight = 0;
-    for (int i = 0; i < electrodeButtons.size(); i++)
-    {
-        ElectrodeButton* button = electrodeButtons[i];
-        button->setBounds(column*width, row*height, width, height);
-        totalWidth =  jmax(totalWidth, ++column*width);
-        
-        if (column == 1)
-        {
-            totalHeight = jmax(totalHeight, (row + 1)*height);
-        }
-        else if (column == 16)
-        {
-            row++;
-            column = 0;            
-        }
-    }
-    electrodeButtonHolder->setSize(totalWidth,totalHeight);
+    const int numButtons = electrodeGrid->getNumButtons();
+    const int numRows = (numButtons + ChannelMapGrid::numColumns - 1) / ChannelMapGrid::numColumns;
+    electrodeGrid->setSize(jmin(numButtons, (int) ChannelMapGrid::numColumns) * ChannelMapGrid::buttonWidth,
+                           numRows * ChannelMapGrid::buttonHeight);
 }
 
 void ChannelMappingEditor::collapsedStateChanged()
@@ -251,11 +207,12 @@ void ChannelMappingEditor::buttonEvent(Button* button)
 
     if (button == selectAllButton)
     {
-        for (int i = 0; i < electrodeButtons.size(); i++)
+        for (int i = 0; i < electrodeGrid->getNumButtons(); i++)
         {
-            electrodeButtons[i]->setToggleState(true,dontSendNotification);
-            setChannelReference(electrodeButtons[i]);
+            electrodeGrid->setToggleState(i, true);
+            setChannelReference(i, false);
         }
+        applyMap();
         previousClickedChan = -1;
         setConfigured(true);
     }
@@ -305,26 +262,12 @@ void ChannelMappingEditor::buttonEvent(Button* button)
             }
             channelSelector->setActiveChannels(a);
 
-            for (int i = 0; i < electrodeButtons.size(); i++)
+            electrodeGrid->setClickingTogglesState(true);
+            for (int i = 0; i < electrodeGrid->getNumButtons(); i++)
             {
-                electrodeButtons[i]->setClickingTogglesState(true);
-                electrodeButtons[i]->removeMouseListener(this);
-                if (referenceArray[electrodeButtons[i]->getChannelNum()-1] == selectedReference)
-                {
-                    electrodeButtons[i]->setToggleState(true, dontSendNotification);
-                }
-                else
-                {
-                    electrodeButtons[i]->setToggleState(false, dontSendNotification);
-                }
-                if ((enabledChannelArray[electrodeButtons[i]->getChannelNum()-1]) && (electrodeButtons[i]->getChannelNum() <= getProcessor()->getNumInputs()))
-                {
-                    electrodeButtons[i]->setEnabled(true);
-                }
-                else
-                {
-                    electrodeButtons[i]->setEnabled(false);
-                }
+                const int chan = electrodeGrid->getChannelNum(i);
+                electrodeGrid->setToggleState(i, referenceArray[chan-1] == selectedReference);
+                electrodeGrid->setButtonEnabled(i, enabledChannelArray[chan-1] && chan <= getProcessor()->getNumInputs());
             }
             selectAllButton->setEnabled(true);
         }
@@ -339,20 +282,11 @@ void ChannelMappingEditor::buttonEvent(Button* button)
                 referenceButtons[i]->setToggleState(false, dontSendNotification);
             }
 
-            for (int i = 0; i < electrodeButtons.size(); i++)
+            electrodeGrid->setClickingTogglesState(false);
+            for (int i = 0; i < electrodeGrid->getNumButtons(); i++)
             {
-                electrodeButtons[i]->setClickingTogglesState(false);
-                electrodeButtons[i]->setEnabled(true);
-                if (enabledChannelArray[electrodeButtons[i]->getChannelNum()-1])
-                {
-                    electrodeButtons[i]->setToggleState(true, dontSendNotification);
-                }
-                else
-                {
-                    electrodeButtons[i]->setToggleState(false, dontSendNotification);
-                }
-                electrodeButtons[i]->addMouseListener(this,false);
-
+                electrodeGrid->setButtonEnabled(i, true);
+                electrodeGrid->setToggleState(i, enabledChannelArray[electrodeGrid->getChannelNum(i)-1]);
             }
             selectAllButton->setEnabled(false);
         }
@@ -370,154 +304,15 @@ void ChannelMappingEditor::buttonEvent(Button* button)
         }
         channelSelector->setActiveChannels(a);
 
-        for (int i = 0; i < electrodeButtons.size(); i++)
+        for (int i = 0; i < electrodeGrid->getNumButtons(); i++)
         {
-            if (referenceArray[electrodeButtons[i]->getChannelNum()-1] == selectedReference)
-            {
-                electrodeButtons[i]->setToggleState(true, dontSendNotification);
-            }
-            else
-            {
-                electrodeButtons[i]->setToggleState(false, dontSendNotification);
-            }
+            electrodeGrid->setToggleState(i, referenceArray[electrodeGrid->getChannelNum(i)-1] == selectedReference);
         }
         previousClickedChan = -1;
 
     }
-    else if (electrodeButtons.contains((ElectrodeButton*)button))
-    {
-        if (!reorderActive)
-        {
-            setConfigured(true);
-            int clickedChan = electrodeButtons.indexOf((ElectrodeButton*)button);
-
-            if (ModifierKeys::getCurrentModifiers().isShiftDown() && (previousClickedChan >= 0))
-            {
-                int toChanA = 0;
-                int toChanD = 0;
-                int fromChanA = 0;
-                int fromChanD = 0;
-
-                if (previousShiftClickedChan < 0)
-                {
-                    previousShiftClickedChan = clickedChan;
-                    if (clickedChan > previousClickedChan)
-                    {
-                        toChanA = clickedChan;
-                        fromChanA = previousClickedChan;
-                    }
-                    else
-                    {
-                        toChanA = previousClickedChan;
-                        fromChanA = clickedChan;
-                    }
-                    for (int i = fromChanA; i <= toChanA; i++)
-                    {
-                        electrodeButtons[i]->setToggleState(previousClickedState, dontSendNotification);
-                        setChannelReference(electrodeButtons[i]);
-                    }
-                }
-                else
-                {
-                    if ((clickedChan > previousClickedChan) && (clickedChan > previousShiftClickedChan))
-                    {
-                        fromChanA = previousShiftClickedChan+1;
-                        toChanA = clickedChan;
-                        if (previousShiftClickedChan < previousClickedChan)
-                        {
-                            fromChanD = previousShiftClickedChan;
-                            toChanD = previousClickedChan-1;
-                        }
-                        else
-                        {
-                            fromChanD = -1;
-                        }
-                    }
-                    else if ((clickedChan > previousClickedChan) && (clickedChan < previousShiftClickedChan))
-                    {
-                        fromChanA = -1;
-                        fromChanD = clickedChan+1;
-                        toChanD = previousShiftClickedChan;
-                        button->setToggleState(previousClickedState, dontSendNotification); // Do not toggle this button;
-                    }
-                    else if ((clickedChan < previousClickedChan) && (clickedChan < previousShiftClickedChan))
-                    {
-                        fromChanA = clickedChan;
-                        toChanA = previousShiftClickedChan-1;
-                        if (previousShiftClickedChan > previousClickedChan)
-                        {
-                            fromChanD = previousClickedChan+1;
-                            toChanD = previousShiftClickedChan;
-                        }
-                        else
-                        {
-                            fromChanD = -1;
-                        }
-                    }
-                    else if ((clickedChan < previousClickedChan) && (clickedChan > previousShiftClickedChan))
-                    {
-                        fromChanA = -1;
-                        fromChanD = previousShiftClickedChan;
-                        toChanD = clickedChan - 1;
-                        button->setToggleState(previousClickedState, dontSendNotification); // Do not toggle this button;
-                    }
-                    else if (clickedChan == previousShiftClickedChan)
-                    {
-                        fromChanA = -1;
-                        fromChanD = -1;
-                        button->setToggleState(previousClickedState, dontSendNotification); // Do not toggle this button;
-                    }
-                    else
-                    {
-                        fromChanA = -1;
-                        button->setToggleState(previousClickedState, dontSendNotification); // Do not toggle this button;
-                        if (previousShiftClickedChan < previousClickedChan)
-                        {
-                            fromChanD = previousShiftClickedChan;
-                            toChanD = previousClickedChan - 1;
-                        }
-                        else if (previousShiftClickedChan > previousClickedChan)
-                        {
-                            fromChanD = previousClickedChan + 1;
-                            toChanD = previousShiftClickedChan;
-                        }
-                        else
-                        {
-                            fromChanD = -1;
-                        }
-                    }
-
-                    if (fromChanA >= 0)
-                    {
-                        for (int i = fromChanA; i <= toChanA; i++)
-                        {
-                            electrodeButtons[i]->setToggleState(previousClickedState, dontSendNotification);
-                            setChannelReference(electrodeButtons[i]);
-                        }
-                    }
-                    if (fromChanD >= 0)
-                    {
-                        for (int i = fromChanD; i <= toChanD; i++)
-                        {
-                            electrodeButtons[i]->setToggleState(!previousClickedState, dontSendNotification);
-                            setChannelReference(electrodeButtons[i]);
-                        }
-                    }
-                }
-
-                previousShiftClickedChan = clickedChan;
-            }
-            else
-            {
-                previousClickedChan = clickedChan;
-                previousShiftClickedChan = -1;
-                setChannelReference((ElectrodeButton*)button);
-                previousClickedState = button->getToggleState();
-            }
-
+    else if (button == saveButton)
 
-        }
-    } else if (button == saveButton)
     {
         //std::cout << "Save button clicked." << std::endl;
 
@@ -565,22 +360,159 @@ void ChannelMappingEditor::buttonEvent(Button* button)
     }
 }
 
-void ChannelMappingEditor::setChannelReference(ElectrodeButton* button)
+void ChannelMappingEditor::electrodeButtonClicked(int clickedChan)
 {
-    int chan = button->getChannelNum()-1;
-    getProcessor()->setCurrentChannel(chan);
+    if (reorderActive)
+        return;
+
+    setConfigured(true);
 
-    if (button->getToggleState())
+    if (ModifierKeys::getCurrentModifiers().isShiftDown() && (previousClickedChan >= 0))
     {
-        referenceArray.set(chan,selectedReference);
-        getProcessor()->setParameter(1,selectedReference);
+        int toChanA = 0;
+        int toChanD = 0;
+        int fromChanA = 0;
+        int fromChanD = 0;
+
+        if (previousShiftClickedChan < 0)
+        {
+            previousShiftClickedChan = clickedChan;
+            if (clickedChan > previousClickedChan)
+            {
+                toChanA = clickedChan;
+                fromChanA = previousClickedChan;
+            }
+            else
+            {
+                toChanA = previousClickedChan;
+                fromChanA = clickedChan;
+            }
+            for (int i = fromChanA; i <= toChanA; i++)
+            {
+                electrodeGrid->setToggleState(i, previousClickedState);
+                setChannelReference(i, false);
+            }
+        }
+        else
+        {
+            if ((clickedChan > previousClickedChan) && (clickedChan > previousShiftClickedChan))
+            {
+                fromChanA = previousShiftClickedChan+1;
+                toChanA = clickedChan;
+                if (previousShiftClickedChan < previousClickedChan)
+                {
+                    fromChanD = previousShiftClickedChan;
+                    toChanD = previousClickedChan-1;
+                }
+                else
+                {
+                    fromChanD = -1;
+                }
+            }
+            else if ((clickedChan > previousClickedChan) && (clickedChan < previousShiftClickedChan))
+            {
+                fromChanA = -1;
+                fromChanD = clickedChan+1;
+                toChanD = previousShiftClickedChan;
+                electrodeGrid->setToggleState(clickedChan, previousClickedState); // Do not toggle this button;
+            }
+            else if ((clickedChan < previousClickedChan) && (clickedChan < previousShiftClickedChan))
+            {
+                fromChanA = clickedChan;
+                toChanA = previousShiftClickedChan-1;
+                if (previousShiftClickedChan > previousClickedChan)
+                {
+                    fromChanD = previousClickedChan+1;
+                    toChanD = previousShiftClickedChan;
+                }
+                else
+                {
+                    fromChanD = -1;
+                }
+            }
+            else if ((clickedChan < previousClickedChan) && (clickedChan > previousShiftClickedChan))
+            {
+                fromChanA = -1;
+                fromChanD = previousShiftClickedChan;
+                toChanD = clickedChan - 1;
+                electrodeGrid->setToggleState(clickedChan, previousClickedState); // Do not toggle this button;
+            }
+            else if (clickedChan == previousShiftClickedChan)
+            {
+                fromChanA = -1;
+                fromChanD = -1;
+                electrodeGrid->setToggleState(clickedChan, previousClickedState); // Do not toggle this button;
+            }
+            else
+            {
+                fromChanA = -1;
+                electrodeGrid->setToggleState(clickedChan, previousClickedState); // Do not toggle this button;
+                if (previousShiftClickedChan < previousClickedChan)
+                {
+                    fromChanD = previousShiftClickedChan;
+                    toChanD = previousClickedChan - 1;
+                }
+                else if (previousShiftClickedChan > previousClickedChan)
+                {
+                    fromChanD = previousClickedChan + 1;
+                    toChanD = previousShiftClickedChan;
+                }
+                else
+                {
+                    fromChanD = -1;
+                }
+            }
+
+            if (fromChanA >= 0)
+            {
+                for (int i = fromChanA; i <= toChanA; i++)
+                {
+                    electrodeGrid->setToggleState(i, previousClickedState);
+                    setChannelReference(i, false);
+                }
+            }
+            if (fromChanD >= 0)
+            {
+                for (int i = fromChanD; i <= toChanD; i++)
+                {
+                    electrodeGrid->setToggleState(i, !previousClickedState);
+                    setChannelReference(i, false);
+                }
+            }
+        }
+
+        applyMap();
+        previousShiftClickedChan = clickedChan;
     }
     else
     {
-        referenceArray.set(chan,-1);
-        getProcessor()->setParameter(1,-1);
+        previousClickedChan = clickedChan;
+        previousShiftClickedChan = -1;
+        setChannelReference(clickedChan);
+        previousClickedState = electrodeGrid->getToggleState(clickedChan);
     }
+}
+
+void ChannelMappingEditor::setChannelReference(int position, bool updateProcessor)
+{
+    int chan = electrodeGrid->getChannelNum(position)-1;
+    referenceArray.set(chan, electrodeGrid->getToggleState(position) ? selectedReference : -1);
 
+    if (updateProcessor)
+    {
+        getProcessor()->setCurrentChannel(chan);
+        getProcessor()->setParameter(1,referenceArray[chan]);
+    }
+}
+
+void ChannelMappingEditor::applyMap()
+{
+    Array<int> channels;
+    for (int i = 0; i < channelArray.size(); i++)
+    {
+        channels.add(channelArray[i]-1);
+    }
+    static_cast<ChannelMappingNode*>(getProcessor())->setChannelMap(channels, referenceArray, enabledChannelArray, referenceChannels);
 }
 
 void ChannelMappingEditor::channelChanged (int channel, bool /*newState*/)
@@ -648,20 +580,8 @@ void ChannelMappingEditor::loadCustomParameters(XmlElement* xml)
             referenceArray.set(mapping-1, reference);
             enabledChannelArray.set(mapping-1,enabled);
 
-            electrodeButtons[i]->setChannelNum(mapping);
-            electrodeButtons[i]->setEnabled(enabled);
-            electrodeButtons[i]->repaint();
-
-
-            getProcessor()->setCurrentChannel(i);
-
-            getProcessor()->setParameter(0, mapping-1); // set mapping
-
-            getProcessor()->setCurrentChannel(mapping-1);
-
-            getProcessor()->setParameter(1, reference); // set reference
-
-            getProcessor()->setParameter(3,enabled ? 1 : 0); //set enabled
+            electrodeGrid->setChannelNum(i, mapping);
+            electrodeGrid->setButtonEnabled(i, enabled);
         }
 
     }
@@ -672,26 +592,16 @@ void ChannelMappingEditor::loadCustomParameters(XmlElement* xml)
 
         if (i < referenceChannels.size())
         {
-            int channel = referenceXml->getIntAttribute("Channel");
-
-            referenceChannels.set(i,channel);
-
-            getProcessor()->setCurrentChannel(channel);
-
-            getProcessor()->setParameter(2,i);
+            referenceChannels.set(i, referenceXml->getIntAttribute("Channel"));
         }
     }
 
-    for (int i = 0; i < electrodeButtons.size(); i++)
+    // the whole map goes to the processor at once
+    applyMap();
+
+    for (int i = 0; i < electrodeGrid->getNumButtons(); i++)
     {
-        if (referenceArray[electrodeButtons[i]->getChannelNum()-1] == selectedReference)
-        {
-            electrodeButtons[i]->setToggleState(true, dontSendNotification);
-        }
-        else
-        {
-            electrodeButtons[i]->setToggleState(false, dontSendNotification);
-        }
+        electrodeGrid->setToggleState(i, referenceArray[electrodeGrid->getChannelNum(i)-1] == selectedReference);
     }
 
     refreshButtonLocations();
@@ -700,22 +610,27 @@ void ChannelMappingEditor::loadCustomParameters(XmlElement* xml)
 
 void ChannelMappingEditor::mouseDrag(const MouseEvent& e)
 {
-    if (reorderActive)
+    if (reorderActive && e.originalComponent == electrodeGrid)
     {
-        if ((!isDragging) && (electrodeButtons.contains((ElectrodeButton*) e.originalComponent)))
+        MouseEvent ev = e.getEventRelativeTo(electrodeGrid);
+
+        if (!isDragging)
         {
-            ElectrodeButton* button = (ElectrodeButton*)e.originalComponent;
+            int position = electrodeGrid->getButtonAt(ev.getMouseDownPosition());
+            if (position < 0)
+                return;
+
             isDragging = true;
 
             String desc = "EditorDrag/MAP/";
-            desc += button->getChannelNum();
+            desc += electrodeGrid->getChannelNum(position);
 
             const String dragDescription = desc;
 
             Image dragImage(Image::ARGB,20,15,true);
 
             Graphics g(dragImage);
-            if (button->getToggleState())
+            if (electrodeGrid->getToggleState(position))
             {
                 g.setColour(Colours::orange);
             }
@@ -725,89 +640,51 @@ void ChannelMappingEditor::mouseDrag(const MouseEvent& e)
             }
             g.fillAll();
             g.setColour(Colours::black);
-            g.drawText(String(button->getChannelNum()),0,0,20,15,Justification::centred,true);
+            g.drawText(String(electrodeGrid->getChannelNum(position)),0,0,20,15,Justification::centred,true);
 
             dragImage.multiplyAllAlphas(0.6f);
 
             startDragging(dragDescription,this,dragImage,false);
-            button->setVisible(false);
-            initialDraggedButton = electrodeButtons.indexOf(button);
+            electrodeGrid->setHiddenButton(position);
+            initialDraggedButton = position;
             lastHoverButton = initialDraggedButton;
-            draggingChannel = button->getChannelNum();
+            draggingChannel = electrodeGrid->getChannelNum(position);
         }
-        else if (isDragging)
+        else
         {
-            MouseEvent ev = e.getEventRelativeTo(this);
-            int mouseDownY = ev.getMouseDownY()-30;
-            int mouseDownX = ev.getMouseDownX()-10;
-            Point<int> viewPosition =electrodeButtonViewport->getViewPosition();
-            
-            int distanceY = ev.getDistanceFromDragStartY();
-            int distanceX = ev.getDistanceFromDragStartX();
-            
-            int newPosY = viewPosition.getY()+ mouseDownY + distanceY;
-            int newPosX = viewPosition.getX()+ mouseDownX + distanceX;
-            if ( mouseDownY + distanceY > 70){
-                electrodeButtonViewport->setViewPosition(viewPosition.getX(),newPosY);
-            }else if( mouseDownY + distanceY < 0 ){
-                electrodeButtonViewport->setViewPosition(viewPosition.getX(),newPosY);
-            }
-            
-            
-            int col = (newPosX / 19);
-            if (col < 0) col = 0;
-            else if (col > 16) col = 16;
-            int row = (newPosY / 15);
-            if (row < 0) row = 0;
+            // scroll when the mouse is held near the top or bottom of the view
+            MouseEvent viewportEvent = e.getEventRelativeTo(electrodeButtonViewport);
+            electrodeButtonViewport->autoScroll(viewportEvent.x, viewportEvent.y, 10, 8);
 
-            int hoverButton = row*16+col;
+            int col = jlimit(0, ChannelMapGrid::numColumns - 1, ev.x / ChannelMapGrid::buttonWidth);
+            int row = jmax(0, ev.y / ChannelMapGrid::buttonHeight);
 
-            if (hoverButton >= electrodeButtons.size())
-            {
-                hoverButton = electrodeButtons.size() -1;
-            }
+            int hoverButton = jmin(row*ChannelMapGrid::numColumns+col, electrodeGrid->getNumButtons() - 1);
 
             if (hoverButton != lastHoverButton)
             {
-
-                electrodeButtons[lastHoverButton]->setVisible(true);
-                electrodeButtons[hoverButton]->setVisible(false);
-
+                // the channels in between move one position towards where the dragged channel was
                 if (lastHoverButton > hoverButton)
                 {
                     for (int i = lastHoverButton; i > hoverButton; i--)
                     {
-                        electrodeButtons[i]->setChannelNum(electrodeButtons[i-1]->getChannelNum());
-                        if (enabledChannelArray[electrodeButtons[i]->getChannelNum()-1]) //Could be more compact, but definitely less legible
-                        {
-                            electrodeButtons[i]->setToggleState(true, dontSendNotification);
-                        }
-                        else
-                        {
-                            electrodeButtons[i]->setToggleState(false, dontSendNotification);
-                        }
+                        electrodeGrid->setChannelNum(i, electrodeGrid->getChannelNum(i-1));
+                        electrodeGrid->setToggleState(i, enabledChannelArray[electrodeGrid->getChannelNum(i)-1]);
                     }
                 }
                 else
                 {
                     for (int i = lastHoverButton; i < hoverButton; i++)
                     {
-                        electrodeButtons[i]->setChannelNum(electrodeButtons[i+1]->getChannelNum());
-                        if (enabledChannelArray[electrodeButtons[i]->getChannelNum()-1])
-                        {
-                            electrodeButtons[i]->setToggleState(true, dontSendNotification);
-                        }
-                        else
-                        {
-                            electrodeButtons[i]->setToggleState(false, dontSendNotification);
-                        }
+                        electrodeGrid->setChannelNum(i, electrodeGrid->getChannelNum(i+1));
+                        electrodeGrid->setToggleState(i, enabledChannelArray[electrodeGrid->getChannelNum(i)-1]);
                     }
                 }
-                electrodeButtons[hoverButton]->setChannelNum(draggingChannel);
-                electrodeButtons[hoverButton]->setToggleState(enabledChannelArray[draggingChannel-1], dontSendNotification);
+                electrodeGrid->setChannelNum(hoverButton, draggingChannel);
+                electrodeGrid->setToggleState(hoverButton, enabledChannelArray[draggingChannel-1]);
+                electrodeGrid->setHiddenButton(hoverButton);
 
                 lastHoverButton = hoverButton;
-                repaint();
             }
 
         }
@@ -820,7 +697,7 @@ void ChannelMappingEditor::mouseUp(const MouseEvent& e)
     if (isDragging)
     {
         isDragging = false;
-        electrodeButtons[lastHoverButton]->setVisible(true);
+        electrodeGrid->setHiddenButton(-1);
         int from, to;
         if (lastHoverButton == initialDraggedButton)
         {
@@ -839,8 +716,9 @@ void ChannelMappingEditor::mouseUp(const MouseEvent& e)
 
         for (int i=from; i <= to; i++)
         {
-            setChannelPosition(i,electrodeButtons[i]->getChannelNum());
+            setChannelPosition(i,electrodeGrid->getChannelNum(i));
         }
+        applyMap();
         setConfigured(true);
 		CoreServices::updateSignalChain(this);
     }
@@ -848,54 +726,36 @@ void ChannelMappingEditor::mouseUp(const MouseEvent& e)
 
 void ChannelMappingEditor::setChannelPosition(int position, int channel)
 {
-    getProcessor()->setCurrentChannel(position);
-    getProcessor()->setParameter(0,channel-1);
     channelArray.set(position,channel);
 }
 
 void ChannelMappingEditor::mouseDoubleClick(const MouseEvent& e)
 {
-    if ((reorderActive) && electrodeButtons.contains((ElectrodeButton*)e.originalComponent))
+    if (reorderActive && e.originalComponent == electrodeGrid)
     {
+        int position = electrodeGrid->getButtonAt(e.getEventRelativeTo(electrodeGrid).getPosition());
+        if (position < 0)
+            return;
+
         setConfigured(true);
-        ElectrodeButton* button = (ElectrodeButton*)e.originalComponent;
-        if (button->getToggleState())
-        {
-            button->setToggleState(false, dontSendNotification);
-            enabledChannelArray.set(button->getChannelNum()-1,false);
-            getProcessor()->setCurrentChannel(button->getChannelNum()-1);
-            getProcessor()->setParameter(3,0);
-        }
-        else
-        {
-            button->setToggleState(true, dontSendNotification);
-            enabledChannelArray.set(button->getChannelNum()-1,true);
-            getProcessor()->setCurrentChannel(button->getChannelNum()-1);
-            getProcessor()->setParameter(3,1);
-        }
+        int chan = electrodeGrid->getChannelNum(position);
+        bool enabled = !electrodeGrid->getToggleState(position);
+
+        electrodeGrid->setToggleState(position, enabled);
+        enabledChannelArray.set(chan-1,enabled);
+        getProcessor()->setCurrentChannel(chan-1);
+        getProcessor()->setParameter(3,enabled ? 1 : 0);
+
 		CoreServices::updateSignalChain(this);
     }
 }
 
 void ChannelMappingEditor::checkUnusedChannels()
 {
-    for (int i = 0; i < electrodeButtons.size(); i++)
+    for (int i = 0; i < electrodeGrid->getNumButtons(); i++)
     {
-        if (electrodeButtons[i]->getChannelNum() > getProcessor()->getNumInputs())
-        {
-            electrodeButtons[i]->setEnabled(false);
-        }
-        else
-        {
-            if (enabledChannelArray[electrodeButtons[i]->getChannelNum()-1])
-            {
-                electrodeButtons[i]->setEnabled(true);
-            }
-            else
-            {
-                electrodeButtons[i]->setEnabled(false);
-            }
-        }
+        const int chan = electrodeGrid->getChannelNum(i);
+        electrodeGrid->setButtonEnabled(i, chan <= getProcessor()->getNumInputs() && enabledChannelArray[chan-1]);
     }
 }
 void ChannelMappingEditor::setConfigured(bool state)
@@ -1001,6 +861,12 @@ String ChannelMappingEditor::loadPrbFile(File filename)
     var mapping = channelGroup[Identifier("mapping")];
     Array<var>* map = mapping.getArray();
 
+    if (map == nullptr)
+    {
+        return "Not a valid .prb file.";
+    }
+
+    // a probe map may give just the order of the channels
     var reference = channelGroup[Identifier("reference")];
     Array<var>* ref = reference.getArray();
 
@@ -1014,50 +880,46 @@ String ChannelMappingEditor::loadPrbFile(File filename)
 
     for (int i = 0; i < map->size(); i++)
     {
-        int ch = map->getUnchecked(i); 
+        int ch = map->getUnchecked(i);
+        if (ch < 1 || ch > electrodeGrid->getNumButtons())
+        {
+            return "Channel " + String(ch) + " of " + filename.getFileName() + " is out of range";
+        }
+    }
+
+    for (int i = 0; i < map->size(); i++)
+    {
+        int ch = map->getUnchecked(i);
         channelArray.set(i, ch);
 
-        int rf = ref->getUnchecked(i);
+        int rf = (ref != nullptr && i < ref->size()) ? int(ref->getUnchecked(i)) : -1;
         referenceArray.set(ch-1, rf);
 
-        bool en = enbl->getUnchecked(i);
+        bool en = (enbl != nullptr && i < enbl->size()) ? bool(enbl->getUnchecked(i)) : true;
         enabledChannelArray.set(ch-1, en);
 
-        electrodeButtons[i]->setChannelNum(ch);
-        electrodeButtons[i]->setEnabled(en);
-		
-		getProcessor()->setCurrentChannel(i);
-		getProcessor()->setParameter(0,ch-1);
-		getProcessor()->setCurrentChannel(ch-1);
-		getProcessor()->setParameter(1, rf);
-		getProcessor()->setParameter(3, en ? 1 : 0);
+        electrodeGrid->setChannelNum(i, ch);
+        electrodeGrid->setButtonEnabled(i, en);
     }
-	checkUnusedChannels();
 
     var refChans = json[Identifier("refs")];
     var channels = refChans[Identifier("channels")];
     Array<var>* chans = channels.getArray();
 
-    for (int i = 0; i < chans->size(); i++)
+    for (int i = 0; chans != nullptr && i < chans->size(); i++)
     {
-        int ch = chans->getUnchecked(i);
-        referenceChannels.set(i,ch);
-        getProcessor()->setCurrentChannel(ch);
-        getProcessor()->setParameter(2,i);
+        referenceChannels.set(i, chans->getUnchecked(i));
     }
 
+    // one update of the processor for the whole map
+    applyMap();
+	checkUnusedChannels();
+
     referenceButtons[0]->setToggleState(true, sendNotificationSync);
 
-    for (int i = 0; i < electrodeButtons.size(); i++)
+    for (int i = 0; i < electrodeGrid->getNumButtons(); i++)
     {
-        if (referenceArray[electrodeButtons[i]->getChannelNum()-1] == 0)
-        {
-            electrodeButtons[i]->setToggleState(true, dontSendNotification);
-        }
-        else
-        {
-            electrodeButtons[i]->setToggleState(false, dontSendNotification);
-        }
+        electrodeGrid->setToggleState(i, referenceArray[electrodeGrid->getChannelNum(i)-1] == 0);
     }
 
 	setConfigured(true);
@@ -1067,7 +929,7 @@ String ChannelMappingEditor::loadPrbFile(File filename)
 	var recording = recChans[Identifier("channels")];
 	Array<var>* rec = recording.getArray();
 
-	for (int i = 0; i < rec->size(); i++)
+	for (int i = 0; rec != nullptr && i < rec->size(); i++)
 	{
 		bool recEnabled = rec->getUnchecked(i);
 		channelSelector->setRecordStatus(i,recEnabled);
@@ -1076,3 +938,192 @@ String ChannelMappingEditor::loadPrbFile(File filename)
     return "Loaded " + filename.getFileName();
 
 }
+
+ChannelMapGrid::ChannelMapGrid(ChannelMappingEditor* editor_)
+    : editor(editor_), clickingTogglesState(true), hiddenButton(-1), hoverButton(-1), pressedButton(-1)
+{
+}
+
+void ChannelMapGrid::setNumButtons(int numButtons)
+{
+    if (numButtons < channelNums.size())
+    {
+        channelNums.removeLast(channelNums.size() - numButtons);
+        toggleStates.removeLast(toggleStates.size() - numButtons);
+        enabledStates.removeLast(enabledStates.size() - numButtons);
+    }
+
+    for (int i = channelNums.size(); i < numButtons; i++)
+    {
+        channelNums.add(i+1);
+        toggleStates.add(false);
+        enabledStates.add(true);
+    }
+
+    if (hoverButton >= numButtons)
+        hoverButton = -1;
+
+    repaint();
+}
+
+int ChannelMapGrid::getNumButtons() const
+{
+    return channelNums.size();
+}
+
+int ChannelMapGrid::getChannelNum(int position) const
+{
+    return channelNums[position];
+}
+
+void ChannelMapGrid::setChannelNum(int position, int channel)
+{
+    if (position >= 0 && position < channelNums.size() && channelNums[position] != channel)
+    {
+        channelNums.set(position, channel);
+        repaintButton(position);
+    }
+}
+
+bool ChannelMapGrid::getToggleState(int position) const
+{
+    return toggleStates[position];
+}
+
+void ChannelMapGrid::setToggleState(int position, bool state)
+{
+    if (position >= 0 && position < toggleStates.size() && toggleStates[position] != state)
+    {
+        toggleStates.set(position, state);
+        repaintButton(position);
+    }
+}
+
+bool ChannelMapGrid::isButtonEnabled(int position) const
+{
+    return enabledStates[position];
+}
+
+void ChannelMapGrid::setButtonEnabled(int position, bool enabled)
+{
+    if (position >= 0 && position < enabledStates.size() && enabledStates[position] != enabled)
+    {
+        enabledStates.set(position, enabled);
+        repaintButton(position);
+    }
+}
+
+void ChannelMapGrid::setClickingTogglesState(bool shouldToggle)
+{
+    clickingTogglesState = shouldToggle;
+}
+
+void ChannelMapGrid::setHiddenButton(int position)
+{
+    if (position != hiddenButton)
+    {
+        repaintButton(hiddenButton);
+        hiddenButton = position;
+        repaintButton(hiddenButton);
+    }
+}
+
+juce::Rectangle<int> ChannelMapGrid::getButtonBounds(int position) const
+{
+    return juce::Rectangle<int>((position % numColumns) * buttonWidth, (position / numColumns) * buttonHeight,
+                                buttonWidth, buttonHeight);
+}
+
+int ChannelMapGrid::getButtonAt(Point<int> point) const
+{
+    if (point.x < 0 || point.y < 0 || point.x >= numColumns * buttonWidth)
+        return -1;
+
+    const int position = (point.y / buttonHeight) * numColumns + point.x / buttonWidth;
+
+    return position < channelNums.size() ? position : -1;
+}
+
+void ChannelMapGrid::repaintButton(int position)
+{
+    if (position >= 0)
+        repaint(getButtonBounds(position));
+}
+
+void ChannelMapGrid::paint(Graphics& g)
+{
+    // only the buttons in view are drawn
+    const juce::Rectangle<int> clip = g.getClipBounds();
+    const int first = jmax(0, clip.getY() / buttonHeight) * numColumns;
+    const int last = jmin(channelNums.size(), (clip.getBottom() / buttonHeight + 1) * numColumns);
+
+    for (int i = first; i < last; i++)
+    {
+        if (i == hiddenButton)
+            continue;
+
+        const juce::Rectangle<int> bounds = getButtonBounds(i);
+        const bool enabled = enabledStates.getUnchecked(i);
+        const int chan = channelNums.getUnchecked(i);
+
+        // as drawn by ElectrodeButton
+        if (!enabled)
+            g.setColour(Colours::black);
+        else if (i == hoverButton)
+            g.setColour(Colours::white);
+        else if (toggleStates.getUnchecked(i))
+            g.setColour(Colours::orange);
+        else
+            g.setColour(Colours::darkgrey);
+
+        g.fillRect(bounds);
+
+        g.setColour(Colours::black);
+        g.drawRect(bounds, 1);
+
+        if (!enabled)
+            g.setColour(Colours::grey);
+
+        g.setFont(chan < 100 ? 10.f : 8.f);
+        g.drawText(String(chan), bounds, Justification::centred, true);
+    }
+}
+
+void ChannelMapGrid::mouseMove(const MouseEvent& e)
+{
+    const int position = getButtonAt(e.getPosition());
+
+    if (position != hoverButton)
+    {
+        repaintButton(hoverButton);
+        hoverButton = position;
+        repaintButton(hoverButton);
+    }
+}
+
+void ChannelMapGrid::mouseExit(const MouseEvent& e)
+{
+    repaintButton(hoverButton);
+    hoverButton = -1;
+}
+
+void ChannelMapGrid::mouseDown(const MouseEvent& e)
+{
+    pressedButton = getButtonAt(e.getPosition());
+}
+
+void ChannelMapGrid::mouseUp(const MouseEvent& e)
+{
+    const int position = getButtonAt(e.getPosition());
+
+    if (position >= 0 && position == pressedButton && !e.mouseWasDraggedSinceMouseDown()
+        && enabledStates[position])
+    {
+        if (clickingTogglesState)
+            setToggleState(position, !toggleStates[position]);
+
+        editor->electrodeButtonClicked(position);
+    }
+
+    pressedButton = -1;
+}
@@ -28,6 +28,75 @@
 
 #define NUM_REFERENCES 4
 
+class ChannelMappingEditor;
+
+/**
+
+  The channels of the Channel Mapping editor, drawn as a grid of electrode buttons.
+
+  Every position is painted by this one component, so a probe with hundreds of
+  channels doesn't need a button component per channel. A click on an enabled
+  position toggles it and is passed to the editor.
+
+  @see ChannelMappingEditor
+
+*/
+
+class ChannelMapGrid : public Component
+{
+public:
+    ChannelMapGrid (ChannelMappingEditor* editor);
+
+    /** Adds or removes positions at the end, new positions show their own channel*/
+    void setNumButtons (int numButtons);
+    int getNumButtons() const;
+
+    int getChannelNum (int position) const;
+    void setChannelNum (int position, int channel);
+
+    bool getToggleState (int position) const;
+    void setToggleState (int position, bool state);
+
+    bool isButtonEnabled (int position) const;
+    void setButtonEnabled (int position, bool enabled);
+
+    void setClickingTogglesState (bool shouldToggle);
+
+    /** Leaves a position empty, e.g. while its channel is being dragged. -1 for none*/
+    void setHiddenButton (int position);
+
+    /** Position at a point of the component, or -1*/
+    int getButtonAt (Point<int> point) const;
+
+    void paint (Graphics& g) override;
+
+    void mouseMove (const MouseEvent& e) override;
+    void mouseExit (const MouseEvent& e) override;
+    void mouseDown (const MouseEvent& e) override;
+    void mouseUp (const MouseEvent& e) override;
+
+    static const int buttonWidth = 19;
+    static const int buttonHeight = 15;
+    static const int numColumns = 16;
+
+private:
+    juce::Rectangle<int> getButtonBounds (int position) const;
+    void repaintButton (int position);
+
+    ChannelMappingEditor* editor;
+
+    Array<int> channelNums;
+    Array<bool> toggleStates;
+    Array<bool> enabledStates;
+
+    bool clickingTogglesState;
+    int hiddenButton;
+    int hoverButton;
+    int pressedButton;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChannelMapGrid);
+};
+
 /**
 
   User interface for the Channel Mapping processor.
@@ -50,6 +119,9 @@ public:
 
     void createElectrodeButtons(int numNeeded, bool clearPrevious = true);
 
+    /** Called by the grid when an enabled position is clicked*/
+    void electrodeButtonClicked(int position);
+
     void saveCustomParameters(XmlElement* xml);
     void loadCustomParameters(XmlElement* xml);
 
@@ -72,14 +144,17 @@ public:
 
 private:
 
-    void setChannelReference(ElectrodeButton* button);
+    void setChannelReference(int position, bool updateProcessor = true);
     void setChannelPosition(int position, int channel);
+
+    /** Sends the whole map to the processor in one step*/
+    void applyMap();
     void checkUnusedChannels();
     void setConfigured(bool state);
 
     void refreshButtonLocations();
 
-    OwnedArray<ElectrodeButton> electrodeButtons;
+    ScopedPointer<ChannelMapGrid> electrodeGrid;
     OwnedArray<ElectrodeButton> referenceButtons;
     ScopedPointer<ElectrodeEditorButton> selectAllButton;
     ScopedPointer<ElectrodeEditorButton> modifyButton;
@@ -87,7 +162,6 @@ private:
     ScopedPointer<LoadButton> loadButton;
     ScopedPointer<SaveButton> saveButton;
     ScopedPointer<Viewport> electrodeButtonViewport;
-    ScopedPointer<Component> electrodeButtonHolder;
 
     Array<int> channelArray;
     Array<int> referenceArray;
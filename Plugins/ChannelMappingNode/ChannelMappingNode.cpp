@@ -25,9 +25,19 @@
 #include "ChannelMappingEditor.h"
 
 
+namespace
+{
+    // samples moved at a time, so every channel of a tile is moved while the references are in cache
+    const int tileSamples = 256;
+}
+
+
 ChannelMappingNode::ChannelMappingNode()
     : GenericProcessor  ("Channel Map")
     , channelBuffer     (1, 10000)
+    , remappingIsStale  (true)
+    , remappingIsInPlace (false)
+    , remappedChannels  (0)
 {
     setProcessorType (PROCESSOR_TYPE_FILTER);
 
@@ -63,11 +73,36 @@ AudioProcessorEditor* ChannelMappingNode::createEditor()
 }
 
 
+bool ChannelMappingNode::enable()
+{
+    // a tile of every distinct reference and of the first channel of a cycle, for every
+    // parallelFor() range, so that process() never allocates
+    savedTiles.malloc ((size_t) getMaxParallelRanges() * (NUM_REFERENCES + 1) * tileSamples);
+
+    return GenericProcessor::enable();
+}
+
+
 void ChannelMappingNode::updateSettings()
 {
     if (getNumInputs() > 0)
         channelBuffer.setSize (getNumInputs(), 10000);
 
+    {
+        const SpinLock::ScopedLockType lock (mapLock);
+
+        // the remapping is rebuilt in process() without growing these
+        const int numChannels = jmax (getNumInputs(), getNumOutputs());
+        sourceChannels.ensureStorageAllocated (numChannels);
+        referenceSources.ensureStorageAllocated (numChannels);
+        distinctReferences.ensureStorageAllocated (NUM_REFERENCES);
+        referenceSlots.ensureStorageAllocated (numChannels);
+        cycles.ensureStorageAllocated (2 * numChannels);
+        isSourceUsed.ensureStorageAllocated (numChannels);
+
+        remappingIsStale = true;
+    }
+
     if (editorIsConfigured)
     {
         OwnedArray<DataChannel> oldChannels;
@@ -101,6 +136,10 @@ void ChannelMappingNode::updateSettings()
 
 void ChannelMappingNode::setParameter (int parameterIndex, float newValue)
 {
+    const SpinLock::ScopedLockType lock (mapLock);
+
+    remappingIsStale = true;
+
     if (parameterIndex == 1)
     {
         referenceArray.set (currentChannel, (int) newValue);
@@ -124,8 +163,213 @@ void ChannelMappingNode::setParameter (int parameterIndex, float newValue)
 }
 
 
+void ChannelMappingNode::setChannelMap (const Array<int>& channels, const Array<int>& references,
+                                        const Array<bool>& enabled, const Array<int>& newReferenceChannels)
+{
+    // built outside the lock, which only covers the swap
+    const int size = jmax (1024, channels.size(), references.size(), enabled.size());
+
+    Array<int> newChannelArray;
+    Array<int> newReferenceArray;
+    Array<bool> newEnabledChannelArray;
+    Array<int> newReferences;
+
+    newChannelArray.ensureStorageAllocated (size);
+    newReferenceArray.ensureStorageAllocated (size);
+    newEnabledChannelArray.ensureStorageAllocated (size);
+
+    for (int i = 0; i < size; ++i)
+    {
+        newChannelArray.add        (i < channels.size()   ? channels[i]   : i);
+        newReferenceArray.add      (i < references.size() ? references[i] : -1);
+        newEnabledChannelArray.add (i < enabled.size()    ? enabled[i]    : true);
+    }
+
+    for (int i = 0; i < NUM_REFERENCES; ++i)
+        newReferences.add (i < newReferenceChannels.size() ? newReferenceChannels[i] : -1);
+
+    const SpinLock::ScopedLockType lock (mapLock);
+
+    channelArray.swapWith        (newChannelArray);
+    referenceArray.swapWith      (newReferenceArray);
+    enabledChannelArray.swapWith (newEnabledChannelArray);
+    referenceChannels.swapWith   (newReferences);
+
+    remappingIsStale = true;
+}
+
+
+bool ChannelMappingNode::updateRemapping (int numChannels)
+{
+    sourceChannels.clearQuick();
+    referenceSources.clearQuick();
+    distinctReferences.clearQuick();
+    referenceSlots.clearQuick();
+    cycles.clearQuick();
+    isSourceUsed.clearQuick();
+    isSourceUsed.insertMultiple (0, false, numChannels);
+
+    int j = 0;
+    int i = 0;
+
+    while (j < settings.numOutputs && i < channelArray.size())
+    {
+        const int realChan = channelArray[i];
+
+        if ((realChan < numChannels)
+            && (enabledChannelArray[realChan]))
+        {
+            if (isSourceUsed[realChan])
+                return false;
+
+            isSourceUsed.set (realChan, true);
+            sourceChannels.add (realChan);
+
+            int reference = -1;
+            if ((referenceArray[realChan] > -1)
+                && (referenceChannels[referenceArray[realChan]] > -1)
+                && (referenceChannels[referenceArray[realChan]] < numChannels)
+                && (channelArray[referenceChannels[referenceArray[realChan]]] < numChannels))
+            {
+                reference = channelArray[referenceChannels[referenceArray[realChan]]];
+            }
+
+            if (reference > -1)
+                distinctReferences.addIfNotAlreadyThere (reference);
+
+            referenceSources.add (reference);
+            referenceSlots.add (distinctReferences.indexOf (reference));
+            ++j;
+        }
+
+        ++i;
+    }
+
+    // the channels past the outputs take the inputs nobody uses, which completes the permutation
+    for (int source = 0; sourceChannels.size() < numChannels; ++source)
+    {
+        if (! isSourceUsed[source])
+            sourceChannels.add (source);
+    }
+
+    // list the cycles, reusing isSourceUsed to mark the channels already visited
+    isSourceUsed.clearQuick();
+    isSourceUsed.insertMultiple (0, false, numChannels);
+
+    for (int start = 0; start < numChannels; ++start)
+    {
+        if (isSourceUsed[start] || sourceChannels[start] == start)
+            continue;
+
+        for (int dest = start; ! isSourceUsed[dest]; dest = sourceChannels[dest])
+        {
+            isSourceUsed.set (dest, true);
+            cycles.add (dest);
+        }
+
+        cycles.add (-1);
+    }
+
+    return true;
+}
+
+
 void ChannelMappingNode::process (AudioSampleBuffer& buffer)
 {
+    const int numChannels = buffer.getNumChannels();
+    const int numSamples  = buffer.getNumSamples();
+
+    bool isInPlace;
+    {
+        const SpinLock::ScopedLockType lock (mapLock);
+
+        // only worked out again after the map or the channels changed
+        if (remappingIsStale || numChannels != remappedChannels)
+        {
+            remappingIsInPlace = updateRemapping (numChannels);
+            remappedChannels = numChannels;
+            remappingIsStale = false;
+        }
+
+        isInPlace = remappingIsInPlace;
+    }
+
+    if (isInPlace)
+    {
+        // Move every channel to its output in place, one tile of samples at a time. A cycle
+        // of channels is moved by saving its first channel and shifting the others in turn,
+        // and the references, saved before anything moves, are subtracted on the way.
+        const int numTiles = (numSamples + tileSamples - 1) / tileSamples;
+        const int numOutputs = referenceSources.size();
+
+        parallelFor (numTiles, [this, &buffer, numSamples, numOutputs] (int firstTile, int lastTile)
+        {
+            float* const saved = savedTiles + (size_t) getParallelRangeIndex() * (NUM_REFERENCES + 1) * tileSamples;
+            float* const firstOfCycle = saved + (size_t) distinctReferences.size() * tileSamples;
+
+            for (int t = firstTile; t < lastTile; ++t)
+            {
+                const int startSample = t * tileSamples;
+                const int tileLength  = jmin (tileSamples, numSamples - startSample);
+
+                for (int r = 0; r < distinctReferences.size(); ++r)
+                    FloatVectorOperations::copy (saved + (size_t) r * tileSamples,
+                                                 buffer.getReadPointer (distinctReferences[r], startSample),
+                                                 tileLength);
+
+                // writes channel source of the tile into channel dest, minus the reference of dest
+                auto moveTile = [&] (int dest, const float* source)
+                {
+                    float* destData = buffer.getWritePointer (dest, startSample);
+                    const int slot = dest < numOutputs ? referenceSlots[dest] : -1;
+
+                    if (slot < 0)
+                    {
+                        if (destData != source)
+                            FloatVectorOperations::copy (destData, source, tileLength);
+                        return;
+                    }
+
+                    const float* reference = saved + (size_t) slot * tileSamples;
+                    const int numReferenced = jlimit (0, tileLength, int (getNumSamples (dest)) - startSample);
+
+                    FloatVectorOperations::subtract (destData, source, reference, numReferenced);
+                    if (destData != source)
+                        FloatVectorOperations::copy (destData + numReferenced, source + numReferenced,
+                                                     tileLength - numReferenced);
+                };
+
+                for (int c = 0; c < cycles.size(); ++c)
+                {
+                    const int first = cycles[c];
+                    FloatVectorOperations::copy (firstOfCycle, buffer.getReadPointer (first, startSample), tileLength);
+
+                    int dest = first;
+                    for (; cycles[c + 1] != -1; ++c)
+                    {
+                        moveTile (dest, buffer.getReadPointer (sourceChannels[dest], startSample));
+                        dest = sourceChannels[dest];
+                    }
+
+                    moveTile (dest, firstOfCycle);
+                    ++c; // skip the -1
+                }
+
+                // channels that stay where they are only need their reference
+                for (int j = 0; j < numOutputs; ++j)
+                {
+                    if (sourceChannels[j] == j && referenceSlots[j] > -1)
+                        moveTile (j, buffer.getReadPointer (j, startSample));
+                }
+            }
+        });
+
+        return;
+    }
+
+    // an input feeds several outputs, so the outputs are copied from a copy of the buffer
+    const SpinLock::ScopedLockType lock (mapLock);
+
     int j = 0;
     int i = 0;
     int realChan;
@@ -168,4 +412,3 @@ void ChannelMappingNode::process (AudioSampleBuffer& buffer)
         ++i;
     }
 }
-
@@ -51,8 +51,21 @@ public:
 
     void updateSettings() override;
 
+    /** Allocates the tiles process() saves channels into */
+    bool enable() override;
+
+    /** Replaces the whole map at once, so the audio thread never sees part of an old map.
+        channels maps each output position to an input, references and enabled are indexed
+        by input, and referenceChannels gives the channel of each reference. */
+    void setChannelMap (const Array<int>& channels, const Array<int>& references,
+                        const Array<bool>& enabled, const Array<int>& referenceChannels);
+
 
 private:
+    /** Works out how to produce the outputs by moving the channels of the buffer in
+        place. Returns false if an input feeds more than one output, which needs a copy. */
+    bool updateRemapping (int numChannels);
+
     Array<int> referenceArray;
     Array<int> referenceChannels;
     Array<int> channelArray;
@@ -60,8 +73,29 @@ private:
 
     bool editorIsConfigured;
 
+    /** Held while the map is changed, and while the audio thread reads it */
+    SpinLock mapLock;
+
     AudioSampleBuffer channelBuffer;
 
+    /** Buffer channel that takes the data of each buffer channel, a permutation of the buffer */
+    Array<int> sourceChannels;
+    /** Input channel subtracted from each output, or -1 */
+    Array<int> referenceSources;
+    /** Distinct input channels in referenceSources, and the index of each output's reference among them */
+    Array<int> distinctReferences;
+    Array<int> referenceSlots;
+    /** Channels of each cycle of sourceChannels in the order they are moved, each cycle followed by -1 */
+    Array<int> cycles;
+    Array<bool> isSourceUsed;
+    /** Set when the map or the settings change, so process() works the remapping out again */
+    bool remappingIsStale;
+    bool remappingIsInPlace;
+    int remappedChannels;
+
+    /** Scratch tiles of every parallelFor() range, see enable() */
+    HeapBlock<float> savedTiles;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChannelMappingNode);
 };
 
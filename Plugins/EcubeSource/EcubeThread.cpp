@@ -23,6 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "EcubeThread.h"
 #include "EcubeDialogComponent.h"
 #include <stdint.h>
+#include <algorithm>
 
 #ifdef ECUBE_COMPILE
 #import "libid:60C0AAC2-1E0B-4FE5-A921-AF9CEEAAA582"
@@ -46,11 +47,17 @@ public:
     std::vector<IEcubeChannelPtr> vpChannels;
     IEcubeChannelPtr pSpeakerChannel;
     unsigned n_channel_objects;
-    std::map<int, int> chid_map;
     IEcubeAnalogAcquisitionPtr pStrmA;
     IEcubeDigitalInputStreamingPtr pStrmD;
     HeapBlock<float, true> interleaving_buffer;
+    // Channel-major samples of the separate-channel buffers sharing a timestamp,
+    // and which channels have arrived for it
+    AudioSampleBuffer group_buffer;
+    HeapBlock<bool, true> group_received;
+    unsigned group_count;
+    bool group_sent;
     HeapBlock<uint64_t, true> event_buffer;
+    HeapBlock<int64, true> timestamp_buffer;
     HeapBlock<uint32_t, true> bit_conversion_tables;
     bool buf_timestamp_locked;
     unsigned long buf_timestamp;
@@ -58,6 +65,42 @@ public:
     unsigned long int_buf_size;
     DataFormat data_format;
     unsigned long sampletime_80mhz;
+
+    // Stream IDs of the channels opened so far, in channel order
+    void addStream(unsigned long stream_id)
+    {
+        stream_ids.push_back(stream_id);
+        n_channel_objects++;
+    }
+
+    // Replaces the stream ID lookup by a dense table, once all the channels are opened.
+    // The IDs of the channels of a device are assumed to span a small range.
+    void buildStreamTable()
+    {
+        first_stream_id = 0;
+        channel_index.clear();
+        if (stream_ids.empty())
+            return;
+
+        first_stream_id = *std::min_element(stream_ids.begin(), stream_ids.end());
+        unsigned long last_stream_id = *std::max_element(stream_ids.begin(), stream_ids.end());
+        channel_index.assign(last_stream_id - first_stream_id + 1, -1);
+        for (size_t i = 0; i < stream_ids.size(); i++)
+            channel_index[stream_ids[i] - first_stream_id] = (int)i;
+    }
+
+    // Channel index of a stream, or -1 for a stream that was not opened
+    int getChannelIndex(unsigned long stream_id) const
+    {
+        // IDs below the first one wrap around to beyond the end of the table
+        unsigned long k = stream_id - first_stream_id;
+        return k < channel_index.size() ? channel_index[k] : -1;
+    }
+
+private:
+    std::vector<unsigned long> stream_ids;
+    std::vector<int> channel_index;
+    unsigned long first_stream_id;
 };
 
 static const char bits_port0[16] = { 23, 22, -1, 14, 11, -1, -1, 28, 12, 10, 27, 26, -1, -1, -1, -1 };
@@ -221,15 +264,15 @@ EcubeThread::EcubeThread(SourceNode* sn) : DataThread(sn), numberingScheme(1), a
                             }
                             else
                                 pDevInt->pStrmA->AddChannel(pch);
-                            pDevInt->chid_map[pch->GetID()] = pDevInt->n_channel_objects;
-                            pDevInt->n_channel_objects++;
+                            pDevInt->addStream(pch->GetID());
                             pDevInt->vpChannels.push_back(pch);
                         }
                     }
                 }
                 sourceBuffers.set(0,new DataBuffer(pDevInt->n_channel_objects, 10000));
-                // Create the interleaving buffer based on the number of channels
-                pDevInt->interleaving_buffer.malloc(sizeof(float)* 1500 * pDevInt->n_channel_objects);
+                // The buffers of one timestamp are gathered channel by channel and written in one block
+                pDevInt->group_buffer.setSize(pDevInt->n_channel_objects, 1500);
+                pDevInt->group_received.malloc(pDevInt->n_channel_objects);
             }
             else if (selmod == "Panel Analog Input")
             {
@@ -247,8 +290,7 @@ EcubeThread::EcubeThread(SourceNode* sn) : DataThread(sn), numberingScheme(1), a
                     }
                     else
                         pDevInt->pStrmA->AddChannel(pch);
-                    pDevInt->chid_map[pch->GetID()] = pDevInt->n_channel_objects;
-                    pDevInt->n_channel_objects++;
+                    pDevInt->addStream(pch->GetID());
                 }
                 m_samplerate = component.GetSampleRate(); // Initial user-specified sample rate
                 pDevInt->pStrmA->PutSampleRate(m_samplerate);
@@ -259,6 +301,8 @@ EcubeThread::EcubeThread(SourceNode* sn) : DataThread(sn), numberingScheme(1), a
                 sourceBuffers.set(0,new DataBuffer(32, 10000));
                 // The interleaving buffer is there just for short->float conversion
                 pDevInt->interleaving_buffer.malloc(sizeof(float)* 1500);
+                // Analog blocks carry no TTL words, so this stays zeroed
+                pDevInt->event_buffer.calloc(sizeof(uint64_t)* 1500);
             }
             else if (selmod == "Panel Digital Input")
             {
@@ -279,8 +323,7 @@ EcubeThread::EcubeThread(SourceNode* sn) : DataThread(sn), numberingScheme(1), a
                     }
                     else
                         pDevInt->pStrmD->AddChannel(pch);
-                    pDevInt->chid_map[pch->GetID()] = pDevInt->n_channel_objects;
-                    pDevInt->n_channel_objects++;
+                    pDevInt->addStream(pch->GetID());
                 }
 
                 sourceBuffers.set(0,new DataBuffer(64, 10000));
@@ -295,7 +338,12 @@ EcubeThread::EcubeThread(SourceNode* sn) : DataThread(sn), numberingScheme(1), a
                 throw std::runtime_error("Invlid module selection");
         }
 
+        pDevInt->buildStreamTable();
         pDevInt->buf_timestamp_locked = false;
+        pDevInt->group_count = 0;
+        pDevInt->group_sent = false;
+        // Per-sample timestamps of one interleaving buffer, handed to the DataBuffer in one block
+        pDevInt->timestamp_buffer.malloc(sizeof(int64)* 1500);
 
         setDefaultChannelNames();
 
@@ -455,9 +503,8 @@ bool EcubeThread::updateBuffer()
                 ab = pDevInt->pStrmA->FetchNextBuffer();
             else
                 ab = pDevInt->pStrmD->FetchNextBuffer();
-            unsigned long chid = ab->GetStreamID();
-            std::map<int, int>::const_iterator chit = pDevInt->chid_map.find(chid);
-            if (chit != pDevInt->chid_map.end())
+            int chid = pDevInt->getChannelIndex(ab->GetStreamID());
+            if (chid >= 0)
             {
                 unsigned long bts = ab->GetTimestamp();
                 unsigned long datasize = ab->GetDataSize() / 2; // Data size is returned in bytes, not in samples
@@ -472,36 +519,42 @@ bool EcubeThread::updateBuffer()
                         // or interleaving buffer is empty
                         if (pDevInt->buf_timestamp_locked)
                         {
-                            // Interleaving buffer is not empty.
-                            // Send its contents out to the application
-                            int64 cts = pDevInt->buf_timestamp64 / pDevInt->sampletime_80mhz; // Convert eCube 80MHz timestamp into a 25kHz timestamp
-                            for (unsigned long j = 0; j < pDevInt->int_buf_size; j++)
-                            {
-								sourceBuffers[0]->addToBuffer(pDevInt->interleaving_buffer + j*nchan, &cts, &ttlEventWords.getReference(0), 1);
-                                cts++;
-                            }
+                            // The group is not empty.
+                            // Send what has arrived of it, unless all its channels already went out
+                            if (!pDevInt->group_sent)
+                                sendChannelGroup();
                             // Update the 64-bit timestamp, take account of its wrap-around
                             unsigned tsdif = bts - pDevInt->buf_timestamp;
                             pDevInt->buf_timestamp64 += tsdif;
                         }
                         else
                         {
-                            // The interleaving buffer is empty
+                            // The group is empty
                             pDevInt->buf_timestamp64 = bts;
                         }
                         pDevInt->int_buf_size = datasize;
                         pDevInt->buf_timestamp = bts;
                         pDevInt->buf_timestamp_locked = true;
-                        // Clear the interleaving buffer within the new packet's size
-                        memset(pDevInt->interleaving_buffer, 0, sizeof(float)*datasize*nchan);
+                        if ((int)datasize > pDevInt->group_buffer.getNumSamples())
+                            pDevInt->group_buffer.setSize(nchan, datasize);
+                        memset(pDevInt->group_received, 0, nchan * sizeof(bool));
+                        pDevInt->group_count = 0;
+                        pDevInt->group_sent = false;
                     }
-                    chid = chit->second; // Adjust the channel id to become the channel index
-                    unsigned char* dp = ab->GetDataPointer();
-                    const short* pData = (const short*)dp;
+                    // A channel sent twice for the same timestamp, after its group went out
+                    if (pDevInt->group_sent || pDevInt->group_received[chid])
+                        continue;
+
+                    const short* pData = (const short*)ab->GetDataPointer();
+                    float* dest = pDevInt->group_buffer.getWritePointer(chid);
+                    const float scale = 6.25e3f / 32768; // Convert into microvolts
                     for (unsigned long j = 0; j < datasize; j++)
-                    {
-                        pDevInt->interleaving_buffer[chid + nchan*j] = pData[j] * 6.25e3 / 32768; // Convert into microvolts
-                    }
+                        dest[j] = pData[j] * scale;
+                    pDevInt->group_received[chid] = true;
+
+                    // Every channel of this timestamp is in, no need to wait for the next one
+                    if (++pDevInt->group_count == (unsigned)nchan)
+                        sendChannelGroup();
                 }
                 else if (pDevInt->data_format == EcubeDevInt::dfInterleavedChannelsAnalog)
                 {
@@ -526,10 +579,8 @@ bool EcubeThread::updateBuffer()
                     unsigned long datasam = datasize / 32;
                     int64 cts = pDevInt->buf_timestamp64 / pDevInt->sampletime_80mhz; // Convert eCube's 80MHz timestamps into number of samples on the Panel Analog input (orig sample rate 1144)
                     for (unsigned long j = 0; j < datasam; j++)
-                    {
-						sourceBuffers[0]->addToBuffer(pDevInt->interleaving_buffer + j * 32, &cts, &ttlEventWords.getReference(0), 1);
-                        cts++;
-                    }
+                        pDevInt->timestamp_buffer[j] = cts + j;
+                    sourceBuffers[0]->addInterleavedBlock(pDevInt->interleaving_buffer, pDevInt->timestamp_buffer, pDevInt->event_buffer, datasam);
                 }
                 else // Digital data
                 {
@@ -544,10 +595,8 @@ bool EcubeThread::updateBuffer()
                             // Send its contents out to the application
                             int64 cts = pDevInt->buf_timestamp64 / pDevInt->sampletime_80mhz; // Convert eCube 80MHz timestamp into a 25kHz timestamp
                             for (unsigned long j = 0; j < pDevInt->int_buf_size; j++)
-                            {
-                                sourceBuffers[0]->addToBuffer(pDevInt->interleaving_buffer + j*64, &cts, pDevInt->event_buffer+j, 1);
-                                cts++;
-                            }
+                                pDevInt->timestamp_buffer[j] = cts + j;
+                            sourceBuffers[0]->addInterleavedBlock(pDevInt->interleaving_buffer, pDevInt->timestamp_buffer, pDevInt->event_buffer, pDevInt->int_buf_size);
                             // Update the 64-bit timestamp, take account of its wrap-around
                             pDevInt->buf_timestamp64 += tsdif;
                         }
@@ -565,7 +614,6 @@ bool EcubeThread::updateBuffer()
                         memset(pDevInt->event_buffer, 0, sizeof(uint64_t)*datasize);
                     }
                     // Convert data from ecube buffer into the interleaving buffer format
-                    chid = chit->second; // Adjust the channel id to become the channel index
                     unsigned char* dp = ab->GetDataPointer();
                     const uint16_t* pData = (const uint16_t*)dp;
                     const char* pbits;
@@ -622,9 +670,47 @@ bool EcubeThread::updateBuffer()
     return true;
 }
 
+void EcubeThread::sendChannelGroup()
+{
+    const int nchan = pDevInt->n_channel_objects;
+    const int numSamples = pDevInt->int_buf_size;
+
+    // Channels that did not arrive for this timestamp are sent as zeroes
+    for (int c = 0; c < nchan; c++)
+    {
+        if (!pDevInt->group_received[c])
+            FloatVectorOperations::clear(pDevInt->group_buffer.getWritePointer(c), numSamples);
+    }
+
+    // samples that don't fit are counted as dropped by the buffer stats
+    DataBuffer* buffer = sourceBuffers[0];
+    DataBuffer::WriteSpans spans;
+    buffer->prepareToWrite(spans, numSamples);
+
+    int offset = 0;
+    for (int region = 0; region < 2; region++)
+    {
+        const int regionSize = spans.blockSize[region];
+        if (regionSize <= 0)
+            continue;
+
+        for (int c = 0; c < nchan; c++)
+            FloatVectorOperations::copy(buffer->getWritePointer(spans, c, region), pDevInt->group_buffer.getReadPointer(c, offset), regionSize);
+        offset += regionSize;
+    }
+
+    // Convert eCube 80MHz timestamp into a 25kHz timestamp
+    buffer->setFirstTimestamp(spans, pDevInt->buf_timestamp64 / pDevInt->sampletime_80mhz);
+    buffer->finishedWrite(spans);
+
+    pDevInt->group_sent = true;
+}
+
 bool EcubeThread::startAcquisition()
 {
     pDevInt->buf_timestamp_locked = false;
+    pDevInt->group_count = 0;
+    pDevInt->group_sent = false;
     if (!isThreadRunning())
         startThread();
 
@@ -94,6 +94,9 @@ private:
     int numberingScheme;
     void setDefaultChannelNames() override;
 
+    /** Writes the headstage samples gathered for the current timestamp to the DataBuffer in one block */
+    void sendChannelGroup();
+
     ScopedPointer<EcubeDevInt> pDevInt;
 
     double m_samplerate;
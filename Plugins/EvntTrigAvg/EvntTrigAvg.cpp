@@ -32,8 +32,12 @@ EvntTrigAvg::EvntTrigAvg()
 
 {
     setProcessorType (PROCESSOR_TYPE_FILTER);
+    setEventClassesOfInterest (TTL_EVENT_CLASS | SPIKE_EVENT_CLASS);
     windowSize = getDefaultSampleRate(); // 1 sec in samples
     binSize = getDefaultSampleRate()/100; // 10 milliseconds in samples
+    snapshots[0] = new HistogramSnapshot();
+    snapshots[1] = new HistogramSnapshot();
+    publishedSnapshot = snapshots[0];
     updateSettings();
 }
 
@@ -65,11 +69,22 @@ void EvntTrigAvg::setParameter(int parameterIndex, float newValue)
     }
     else if (parameterIndex == 4)
         changed = true;
+    else if (parameterIndex == 5 && maxTrials != jmax(0, static_cast<int>(newValue))){
+        maxTrials = jmax(0, static_cast<int>(newValue));
+        changed = true;
+    }
+    else if (parameterIndex == 6 && lfpAveraging != (newValue > 0)){
+        lfpAveraging = newValue > 0;
+        changed = true;
+    }
     
     // If anything was changed, delete all data and start over
     if (changed){
-        spikeData.clear();
-        ttlTimestampBuffer.clear();
+        const ScopedLock lock(mut);
+        pendingTrials.clear();
+        completedTrials.clear();
+        recentSpikes.clear();
+        resetLfpAverages(0);
         lastTTLCalculated=0;
         updateSettings();
     }
@@ -85,16 +100,10 @@ void EvntTrigAvg::updateSettings()
  //   electrodeMap = createElectrodeMap();
     electrodeLabels.clear();
     electrodeLabels = createElectrodeLabels();
-    if(spikeData.size()!=getTotalSpikeChannels())
-        spikeData.resize(getTotalSpikeChannels());
-    electrodeSortedId.clear();
-    if(electrodeSortedId.size()!=getTotalSpikeChannels())
-        electrodeSortedId.resize(getTotalSpikeChannels());
-    for(int electrodeIt = 0 ; electrodeIt < spikeData.size() ; electrodeIt++){
-        electrodeSortedId[electrodeIt].push_back(0);
-        if(spikeData[electrodeIt].size()<1)
-            spikeData[electrodeIt].resize(1);
-    }
+    rebuildHistogramRowIndex();
+
+    const ScopedLock lock(mut);
+    publishSnapshot();
 }
 void EvntTrigAvg::initializeHistogramArray()
 {
@@ -107,7 +116,9 @@ void EvntTrigAvg::initializeHistogramArray()
         for (int data = 3 ; data < 1003 ; data++){
             histogramData[i][data] = 0;
         }
+        rowVersions.add(snapshotVersion+1);
     }
+    layoutVersion+=1;
 }
 
 void EvntTrigAvg::initializeMinMaxMean()
@@ -129,6 +140,8 @@ void EvntTrigAvg::clearHistogramArray()
     for (int i = 0 ; i < histogramData.size() ; i++)
         delete[] histogramData[i];
     histogramData.clear();
+    rowVersions.clear();
+    layoutVersion+=1;
 }
 void EvntTrigAvg::clearMinMaxMean()
 {
@@ -149,31 +162,66 @@ bool EvntTrigAvg::disable()
 }
 
 
+void EvntTrigAvg::getMemoryUsage(MemoryUsage& usage) const
+{
+    GenericProcessor::getMemoryUsage(usage);
+
+    const ScopedLock lock(mut);
+    usage.add("Histograms", int64(histogramData.size()) * 1003 * sizeof(uint64) + int64(minMaxMean.size()) * 5 * sizeof(float));
+    usage.add("Histogram snapshots", int64(snapshots[0]->binCapacity + snapshots[1]->binCapacity) * sizeof(uint64)
+        + int64(snapshots[0]->rows.size() + snapshots[1]->rows.size()) * sizeof(HistogramSnapshot::Row));
+
+    int64 trials = int64(pendingTrials.size() + completedTrials.size()) * sizeof(Trial) + spareIncrements.capacity() * sizeof(int64);
+    for (const Trial& trial : pendingTrials)
+        trials += trial.increments.capacity() * sizeof(int64);
+    for (const Trial& trial : completedTrials)
+        trials += trial.increments.capacity() * sizeof(int64);
+    usage.add("Trials", trials);
+    usage.add("Recent spikes", int64(recentSpikes.size()) * sizeof(RecentSpike));
+
+    usage.add("Continuous averages", MemoryUsage::getBytes(lfpHistory) + MemoryUsage::getBytes(lfpSums)
+        + int64(lfpSums.getNumSamples()) * sizeof(float) + int64(lfpTrials.size()) * sizeof(LfpTrial));
+}
+
+
 void EvntTrigAvg::process(AudioSampleBuffer& buffer)
 {
-    
+    const ScopedLock lock(mut);
     checkForEvents(true);// see if got any spikes
     
     if(buffer.getNumChannels() != numChannels)
         numChannels = buffer.getNumChannels();
-    if(ttlTimestampBuffer.size() > lastTTLCalculated && buffer.getNumSamples() + getTimestamp(0) >= ttlTimestampBuffer[lastTTLCalculated+1] + windowSize/2){ // if need to recalc
-        recalc = true;
-    }
-    if(recalc){ // triggered after window time has expirered
-        //process the data
-        processSpikeData(spikeData, ttlTimestampBuffer);
-        
-        //clear the data
-        for(int channelIterator = 0 ; channelIterator < spikeData.size() ; channelIterator++){
-            for(int sortedIdIterator = 0 ; sortedIdIterator < spikeData[channelIterator].size() ; sortedIdIterator++){
-                spikeData[channelIterator][sortedIdIterator].clear();
+
+    const uint64 now = getTimestamp(0) + buffer.getNumSamples();
+    const uint64 halfWindow = windowSize/2;
+
+    // a trigger is complete once no further spike can fall into its window
+    bool triggerCompleted = false;
+    while (!pendingTrials.empty() && pendingTrials.front().timestamp + halfWindow < now){
+        if (maxTrials > 0){
+            completedTrials.push_back(std::move(pendingTrials.front()));
+            // rolling window: the oldest trial leaves the histograms
+            while (completedTrials.size() > maxTrials){
+                removeTrial(completedTrials.front());
+                spareIncrements.swap(completedTrials.front().increments);
+                completedTrials.pop_front();
+                lastTTLCalculated-=1;
             }
         }
-        //advance the TTL that needs to be calculated
+        pendingTrials.pop_front();
         lastTTLCalculated+=1;
-        //just recalculated, don't need to again until next ttl window has expired
-        recalc=false;
+        triggerCompleted = true;
     }
+    if (triggerCompleted)
+        updateMinMaxMean();
+    else if (snapshotPending)
+        publishSnapshot();
+
+    if (lfpAveraging)
+        processLfp(buffer);
+
+    while (!recentSpikes.empty() && recentSpikes.front().timestamp + halfWindow < now)
+        recentSpikes.pop_front();
 }
 
 void EvntTrigAvg::handleEvent(const EventChannel* eventInfo, const MidiMessage& event, int sampleNum)
@@ -181,55 +229,275 @@ void EvntTrigAvg::handleEvent(const EventChannel* eventInfo, const MidiMessage&
     if (triggerEvent < 0) return;
     else if (eventInfo->getChannelType() == EventChannel::TTL && eventInfo == eventChannelArray[triggerEvent])
     {// if TTL from right channel
-        TTLEventPtr ttl = TTLEvent::deserializeFromMessage(event, eventInfo);
-        if (ttl->getChannel() == triggerChannel && ttl->getState())
-            ttlTimestampBuffer.push_back(Event::getTimestamp(event)); // add timestamp of TTL to buffer
+        TTLEventView ttl(event, eventInfo);
+        if (ttl.isValid() && ttl.getChannel() == triggerChannel && ttl.getState()){
+            if (lfpAveraging){
+                LfpTrial lfpTrial;
+                lfpTrial.start = int64(ttl.getTimestamp()) - int64(windowSize/2);
+                lfpTrial.next = lfpTrial.start;
+                lfpTrials.push_back(lfpTrial);
+                numLfpTrials+=1;
+            }
+
+            Trial trial;
+            trial.timestamp = ttl.getTimestamp();
+            trial.increments.swap(spareIncrements);
+            trial.increments.clear();
+            pendingTrials.push_back(std::move(trial));
+            // spikes already seen in the pre-trigger part of the window
+            for (int i = 0 ; i < recentSpikes.size() ; i++)
+                binSpike(recentSpikes[i].electrode, recentSpikes[i].sortedId, recentSpikes[i].timestamp, pendingTrials.back());
+        }
     }
 }
 
 void EvntTrigAvg::handleSpike(const SpikeChannel* spikeInfo, const MidiMessage& event, int samplePosition)
 {
-    SpikeEventPtr newSpike = SpikeEvent::deserializeFromMessage(event, spikeInfo);
-    if (!newSpike)
+    // Only the timestamp and sorted ID are needed, so read them in place
+    SpikeEventView newSpike(event, spikeInfo);
+    if (!newSpike.isValid())
         return;
     else {
         // extract information from spike
-        
-        const SpikeChannel* chan = newSpike->getChannelInfo();
-        Array<SourceChannelInfo> chanInfo = chan->getSourceChannelInfo();
-        //int chanIDX = chanInfo[0].channelIDX;
-        int electrode = getSpikeChannelIndex(newSpike);
-        //std::cout<<"chanIDX: " << chanIDX << "\n";
-        int sortedID = newSpike->getSortedID();
-        //int electrode = electrodeMap[chanInfo];
-        if(sortedID!=0 && sortedID>idIndex.size()){ // respond to new sortedID
-            idIndex.push_back(spikeData[electrode].size());// update map of what sorted ID is on what electrode
-        }
-            
-        bool newID = true;
-        //for(int i = 0 ; i < electrodeSortedId[chanIDX].size() ; i++){
-        for(int i = 0 ; i < electrodeSortedId[electrode].size() ; i++){
-            //if(sortedID == electrodeSortedId[chanIDX][i])
-           if(sortedID == electrodeSortedId[electrode][i])
-               newID=false;
-        }
-        if(newID){
-            //electrodeSortedId[chanIDX].push_back(sortedID);
-            electrodeSortedId[electrode].push_back(sortedID);
+        int electrode = spikeInfo->getCurrentNodeChannelIdx();
+        if (electrode >= getTotalSpikeChannels())
+            return;
+        int sortedID = newSpike.getSortedID();
+        if (findHistogramRow(electrode, sortedID) < 0){ // respond to new sortedID
             addNewSortedIdMinMaxMean(electrode,sortedID);
             addNewSortedIdHistoData(electrode,sortedID); //insert new sortedId into histogramArray
-            spikeData[electrode].resize(spikeData[electrode].size()+1);
-            }
-        
-        int relativeSortedID = 0;
-        if (sortedID>0)
-            relativeSortedID = idIndex[sortedID-1];
-        spikeData[electrode][0].push_back(newSpike->getTimestamp());
-        if (sortedID>0)
-            spikeData[electrode][relativeSortedID].push_back(newSpike->getTimestamp());
+            rebuildHistogramRowIndex();
+        }
+
+        RecentSpike spike;
+        spike.timestamp = newSpike.getTimestamp();
+        spike.electrode = electrode;
+        spike.sortedId = sortedID;
+        for (int i = 0 ; i < pendingTrials.size() ; i++)
+            binSpike(electrode, sortedID, spike.timestamp, pendingTrials[i]);
+        recentSpikes.push_back(spike);
+        // keep the history bounded even if spikes come in far faster than the window drains
+        const int maxRecentSpikes = 100000;
+        if (recentSpikes.size() > maxRecentSpikes)
+            recentSpikes.pop_front();
+    }
+}
+
+int EvntTrigAvg::getNumBins()
+{
+    // rows have room for 1000 bins
+    return binSize > 0 ? int(jmin(uint64(1000), windowSize/binSize)) : 0;
+}
+
+int EvntTrigAvg::findHistogramRow(int electrode, int sortedId)
+{
+    const int64 key = (int64(electrode) << 16) | sortedId;
+    return histogramRows.contains(key) ? histogramRows[key] : -1;
+}
+
+void EvntTrigAvg::rebuildHistogramRowIndex()
+{
+    const ScopedLock lock(mut);
+    histogramRows.clear();
+    histogramRows.remapTable(jmax(101, 2*histogramData.size()));
+    for (int i = 0 ; i < histogramData.size() ; i++)
+        histogramRows.set((int64(histogramData[i][0]) << 16) | int64(histogramData[i][1]), i);
+}
+
+/** adds a spike to the histograms of its electrode and of its unit, if it is in the trigger's window */
+void EvntTrigAvg::binSpike(int electrode, int sortedId, uint64 spikeTimestamp, Trial& trial)
+{
+    const int64 halfWindow = windowSize/2;
+    const int64 relativeSpikeValue = int64(spikeTimestamp) - int64(trial.timestamp);
+    const int numBins = getNumBins();
+    if (numBins == 0 || relativeSpikeValue < -halfWindow || relativeSpikeValue > halfWindow)
+        return;
+
+    const int bin = jmin(numBins-1, int((relativeSpikeValue+halfWindow)/int64(binSize)));
+    addToHistograms(electrode, sortedId, bin, 1);
+    if (maxTrials > 0)
+        trial.increments.push_back((((int64(electrode) << 16) | sortedId) << 10) | bin);
+}
+
+void EvntTrigAvg::addToHistograms(int electrode, int sortedId, int bin, int count)
+{
+    const int electrodeRow = findHistogramRow(electrode, 0);
+    if (electrodeRow >= 0){
+        histogramData[electrodeRow][3+bin] += count;
+        markRowChanged(electrodeRow);
+    }
+    if (sortedId != 0){
+        const int unitRow = findHistogramRow(electrode, sortedId);
+        if (unitRow >= 0){
+            histogramData[unitRow][3+bin] += count;
+            markRowChanged(unitRow);
+        }
+    }
+}
+
+void EvntTrigAvg::markRowChanged(int row)
+{
+    rowVersions.set(row, snapshotVersion+1);
+}
+
+void EvntTrigAvg::removeTrial(Trial& trial)
+{
+    for (int i = 0 ; i < trial.increments.size() ; i++){
+        const int64 entry = trial.increments[i];
+        addToHistograms(int(entry >> 26), int((entry >> 10) & 0xffff), int(entry & 0x3ff), -1);
     }
 }
 
+void EvntTrigAvg::resetLfpAverages(int numChannels_)
+{
+    const ScopedLock lock(mut);
+    const int windowSamples = int(windowSize);
+    lfpTrials.clear();
+    lfpHistory.setSize(numChannels_, jmax(1, windowSamples/2));
+    lfpHistoryStart = lfpHistoryEnd = 0;
+    lfpSums.setSize(numChannels_, windowSamples);
+    lfpSums.clear();
+    lfpCounts.calloc(jmax(1, windowSamples));
+    numLfpTrials = 0;
+}
+
+void EvntTrigAvg::processLfp(AudioSampleBuffer& buffer)
+{
+    const int nCh = buffer.getNumChannels();
+    const int nSamples = buffer.getNumSamples();
+    const int windowSamples = int(windowSize);
+    if (lfpSums.getNumChannels() != nCh || lfpSums.getNumSamples() != windowSamples)
+        resetLfpAverages(nCh);
+    if (nCh == 0 || windowSamples == 0)
+        return;
+
+    const int64 blockStart = int64(getTimestamp(0));
+    const int64 blockEnd = blockStart + nSamples;
+    if (blockStart != lfpHistoryEnd) // timestamps jumped, the ring holds nothing useful
+        lfpHistoryStart = lfpHistoryEnd = blockStart;
+
+    for (int i = 0 ; i < lfpTrials.size() ; ){
+        LfpTrial& trial = lfpTrials[i];
+        const int64 end = trial.start + windowSamples;
+
+        // pre-trigger samples from earlier blocks, as far as the ring still has them
+        if (trial.next < blockStart){
+            const int64 from = jmax(trial.next, lfpHistoryStart);
+            const int64 to = jmin(blockStart, end);
+            if (from < to)
+                addLfpHistory(from, to, trial.start);
+            trial.next = to;
+        }
+        if (trial.next < end && trial.next < blockEnd){
+            const int64 from = jmax(trial.next, blockStart);
+            const int64 to = jmin(end, blockEnd);
+            for (int ch = 0 ; ch < nCh ; ch++)
+                FloatVectorOperations::add(lfpSums.getWritePointer(ch, int(from - trial.start)), buffer.getReadPointer(ch, int(from - blockStart)), int(to - from));
+            FloatVectorOperations::add(lfpCounts + (from - trial.start), 1.0f, int(to - from));
+            trial.next = to;
+        }
+
+        if (trial.next >= end)
+            lfpTrials.erase(lfpTrials.begin() + i);
+        else
+            i++;
+    }
+
+    // keep the most recent samples for the pre-trigger part of the next triggers
+    const int capacity = lfpHistory.getNumSamples();
+    const int toKeep = jmin(nSamples, capacity);
+    for (int64 t = blockEnd - toKeep ; t < blockEnd ; ){
+        const int pos = int(t % capacity);
+        const int n = int(jmin(int64(capacity - pos), blockEnd - t));
+        for (int ch = 0 ; ch < nCh ; ch++)
+            lfpHistory.copyFrom(ch, pos, buffer, ch, int(t - blockStart), n);
+        t += n;
+    }
+    lfpHistoryEnd = blockEnd;
+    lfpHistoryStart = jmax(lfpHistoryStart, lfpHistoryEnd - capacity);
+}
+
+/** adds the samples [from, to) held by the history ring to the sums of a trial starting at trialStart */
+void EvntTrigAvg::addLfpHistory(int64 from, int64 to, int64 trialStart)
+{
+    const int capacity = lfpHistory.getNumSamples();
+    while (from < to){
+        const int pos = int(from % capacity);
+        const int n = int(jmin(int64(capacity - pos), to - from));
+        for (int ch = 0 ; ch < lfpSums.getNumChannels() ; ch++)
+            FloatVectorOperations::add(lfpSums.getWritePointer(ch, int(from - trialStart)), lfpHistory.getReadPointer(ch, pos), n);
+        FloatVectorOperations::add(lfpCounts + (from - trialStart), 1.0f, n);
+        from += n;
+    }
+}
+
+/** refreshes the displayed statistics, once per completed trigger */
+void EvntTrigAvg::updateMinMaxMean()
+{
+    const int numBins = getNumBins();
+    for (int row = 0 ; row < histogramData.size() ; row++){
+        histogramData[row][2]=numBins;
+        const float min = findMin(&histogramData[row][3]);
+        const float max = findMax(&histogramData[row][3]);
+        const float mean = findMean(&histogramData[row][3]);
+        if (min != minMaxMean[row][2] || max != minMaxMean[row][3] || mean != minMaxMean[row][4])
+            markRowChanged(row);
+        minMaxMean[row][2]= min;
+        minMaxMean[row][3]= max;
+        minMaxMean[row][4]= mean;
+    }
+    publishSnapshot();
+}
+
+void EvntTrigAvg::publishSnapshot()
+{
+    HistogramSnapshot* back = publishedSnapshot == snapshots[0] ? snapshots[1] : snapshots[0];
+    // still shown by the canvas, which lets go of it at its next refresh
+    if (back->getReferenceCount() > 1){
+        snapshotPending = true;
+        return;
+    }
+    snapshotPending = false;
+
+    const int numRows = histogramData.size();
+    const int numBins = getNumBins();
+    const uint32 version = snapshotVersion+1;
+
+    // rows that haven't changed since this snapshot was last filled are still in it
+    const bool relayout = back->layoutVersion != layoutVersion || back->numBins != numBins || back->rows.size() != numRows;
+    if (relayout){
+        if (back->binCapacity < numRows*numBins){
+            back->binCapacity = numRows*numBins;
+            back->binData.malloc(back->binCapacity);
+        }
+        back->rows.resize(numRows);
+    }
+
+    for (int row = 0 ; row < numRows ; row++){
+        HistogramSnapshot::Row& r = back->rows.getReference(row);
+        if (!relayout && rowVersions[row] <= back->version)
+            continue;
+        r.electrode = int(histogramData[row][0]);
+        r.sortedId = int(histogramData[row][1]);
+        r.min = minMaxMean[row][2];
+        r.max = minMaxMean[row][3];
+        r.mean = minMaxMean[row][4];
+        r.version = rowVersions[row];
+        uint64* bins = back->binData + row*numBins;
+        memcpy(bins, &histogramData[row][3], numBins*sizeof(uint64));
+        r.bins = bins;
+    }
+
+    back->version = version;
+    back->layoutVersion = layoutVersion;
+    back->numBins = numBins;
+    back->numTrials = lastTTLCalculated;
+    snapshotVersion = version;
+
+    const SpinLock::ScopedLockType lock(snapshotLock);
+    publishedSnapshot = back;
+}
+
 void EvntTrigAvg::addNewSortedIdHistoData(int electrode,int sortedId)
 {
     const ScopedLock myScopedLock(mut);
@@ -238,7 +506,8 @@ void EvntTrigAvg::addNewSortedIdHistoData(int electrode,int sortedId)
         histogramData.getLast()[0]=electrode;//electrode
         histogramData.getLast()[1]=sortedId;//sortedID
         histogramData.getLast()[2]=windowSize/binSize;//num bins used
-
+        rowVersions.add(snapshotVersion+1);
+        layoutVersion+=1;
         return;
     }
     else{
@@ -248,6 +517,8 @@ void EvntTrigAvg::addNewSortedIdHistoData(int electrode,int sortedId)
                 histogramData[i][0]=electrode;//electrode
                 histogramData[i][1]=sortedId;//sortedID
                 histogramData[i][2]=windowSize/binSize;//num bins used
+                rowVersions.insert(i, snapshotVersion+1);
+                layoutVersion+=1;
                 return;
             }
         }
@@ -336,106 +607,55 @@ std::vector<String> EvntTrigAvg::createElectrodeLabels()
     return map;
 }
 
-/** passes data into createHistogramData() by electrode and sorted ID */
-void EvntTrigAvg::processSpikeData(std::vector<std::vector<std::vector<uint64>>> spikeData,std::vector<uint64> ttlData)
+uint64 EvntTrigAvg::getBinSize()
 {
-    
-    for (int channelIterator = 0 ; channelIterator < getTotalSpikeChannels() ; channelIterator++){
-        const ScopedLock myScopedLock(mut);
-        for (int sortedIdIterator = 0 ; sortedIdIterator < spikeData[channelIterator].size() ; sortedIdIterator++){
-            uint64* data = createHistogramData(spikeData[channelIterator][sortedIdIterator],ttlData);
-            histogramData[channelIterator+sortedIdIterator][2]=windowSize/binSize;
-            for(int dataIterator = 3 ; dataIterator<windowSize/binSize+3 ; dataIterator++){
-                histogramData[channelIterator+sortedIdIterator][dataIterator] += (data[dataIterator-3]);
-            }
-        minMaxMean[channelIterator+sortedIdIterator][2]= findMin(&histogramData[channelIterator+sortedIdIterator][3]);
-            
-        minMaxMean[channelIterator+sortedIdIterator][3]= findMax(&histogramData[channelIterator+sortedIdIterator][3]);
-            
-        minMaxMean[channelIterator+sortedIdIterator][4] = findMean(&histogramData[channelIterator+sortedIdIterator][3]);
-        }
-    }
+    return binSize;
 }
 
-/** returns bin counts */
-uint64* EvntTrigAvg::createHistogramData(std::vector<uint64> spikeData, std::vector<uint64> ttlData)
+uint64 EvntTrigAvg::getWindowSize()
 {
-    uint64 numberOfBins = windowSize/binSize;
-    std::vector<uint64> histoData;
-    for(int ttlIterator = 0 ; ttlIterator < ttlData.size() ; ttlIterator++){
-        for(int spikeIterator = 0 ; spikeIterator < spikeData.size() ; spikeIterator++){
-            int relativeSpikeValue = int(spikeData[spikeIterator])-int(ttlData[ttlIterator]);
-            if (relativeSpikeValue >= -int(windowSize)/2 && relativeSpikeValue <= int(windowSize)/2){
-                uint64 bin = binDataPoint(0, numberOfBins, binSize, relativeSpikeValue+windowSize/2);
-                histoData.push_back(bin);
-            }
-        }
-    }
-    return binCount(histoData,numberOfBins);
+    return windowSize;
 }
 
-
-/** Returns the bin a data point belongs to given the very first bin, the very last bin, bin size and the data point to bin, currently only works for positive numbers (can get around by adding minimum value to all values*/
-uint64 EvntTrigAvg::binDataPoint(uint64 startBin, uint64 endBin, uint64 binSize, uint64 dataPoint)
+int EvntTrigAvg::getMaxTrials()
 {
-    uint64 binsInRange = (endBin-startBin);
-    uint64 binsToSearch = binsInRange/2;
-    if (binsToSearch <= 1){
-        
-        if (dataPoint < (startBin+binsToSearch)*binSize){
-            return startBin;
-        }
-        else if (dataPoint < (startBin+1+binsToSearch) * binSize){
-            return startBin+1;
-        }
-        else{
-            return startBin+2;
-        }
-    }
-
-    else if (dataPoint < (startBin+binsToSearch)*binSize){ // if in first half of search range
-        return binDataPoint(startBin,startBin+(binsToSearch),binSize,dataPoint);
-    }
-    else if (dataPoint >= (startBin+binsToSearch) * binSize){ // if in second half of search range
-        return binDataPoint(startBin+(binsToSearch),endBin,binSize,dataPoint);
-    }
-    else{
-        return (uint64) NULL;
-    }
+    return maxTrials;
 }
 
-/** count the number of bin instances */
-uint64* EvntTrigAvg::binCount(std::vector<uint64> binData,uint64 numberOfBins)
+bool EvntTrigAvg::getLfpAveraging()
 {
-    for (int i = 0 ; i < 1000 ; i++){
-        bins[i]=0;
-    }
-    for (int dataIterator = 0 ; dataIterator < binData.size() ; dataIterator++){
-        bins[binData[dataIterator]] = bins[binData[dataIterator]]+1;
-    }
-    return bins;
+    return lfpAveraging;
 }
 
-uint64 EvntTrigAvg::getBinSize()
+int EvntTrigAvg::getNumLfpTrials()
 {
-    return binSize;
+    return numLfpTrials;
 }
 
-uint64 EvntTrigAvg::getWindowSize()
+int EvntTrigAvg::getNumLfpChannels()
 {
-    return windowSize;
+    const ScopedLock myScopedLock(mut);
+    return lfpSums.getNumChannels();
 }
 
-Array<uint64 *> EvntTrigAvg::getHistoData()
+void EvntTrigAvg::getLfpAverage(int channel, std::vector<float>& average)
 {
     const ScopedLock myScopedLock(mut);
-    return histogramData;
+    if (channel < 0 || channel >= lfpSums.getNumChannels()){
+        average.clear();
+        return;
+    }
+    const int windowSamples = lfpSums.getNumSamples();
+    const float* sums = lfpSums.getReadPointer(channel);
+    average.resize(windowSamples);
+    for (int i = 0 ; i < windowSamples ; i++)
+        average[i] = lfpCounts[i] > 0 ? sums[i]/lfpCounts[i] : 0;
 }
 
-Array<float *> EvntTrigAvg::getMinMaxMean()
+EvntTrigAvg::HistogramSnapshot::Ptr EvntTrigAvg::getHistogramSnapshot()
 {
-    const ScopedLock myScopedLock(mut);
-    return minMaxMean;
+    const SpinLock::ScopedLockType lock(snapshotLock);
+    return publishedSnapshot;
 }
 
 float EvntTrigAvg::findMin(uint64* data_)
@@ -443,7 +663,7 @@ float EvntTrigAvg::findMin(uint64* data_)
     const ScopedLock myScopedLock(mut);
     //uint64 min = UINT64_MAX;
     uint64 min = 18446744073709551614U;
-    for (int i = 0 ; i < windowSize/binSize ; i++){
+    for (int i = 0 ; i < getNumBins() ; i++){
         if(data_[i]<min){
             min=data_[i];
         }
@@ -455,7 +675,7 @@ float EvntTrigAvg::findMax(uint64* data_)
 {
     const ScopedLock myScopedLock(mut);
     uint64 max = 0;
-    for (int i = 0 ; i < windowSize/binSize ; i++){
+    for (int i = 0 ; i < getNumBins() ; i++){
         if(data_[i]>max){
             max=data_[i];
         }
@@ -467,10 +687,11 @@ float EvntTrigAvg::findMean(uint64* data_)
 {
     const ScopedLock myScopedLock(mut);
     uint64 runningSum=0;
-    for(int i=0 ; i < windowSize/binSize ; i++){
+    const int numBins = getNumBins();
+    for(int i=0 ; i < numBins ; i++){
         runningSum += data_[i];
     }
-    float mean = float(runningSum)/(float(windowSize)/float(binSize));
+    float mean = numBins > 0 ? float(runningSum)/float(numBins) : 0;
     return mean;
 }
 
@@ -495,6 +716,8 @@ void EvntTrigAvg::saveCustomParametersToXml (XmlElement* parentElement)
     mainNode->setAttribute ("trigger", triggerChannel);
     mainNode->setAttribute ("bin", int(binSize/(getSampleRate()/1000)));
     mainNode->setAttribute ("window", int(windowSize/(getSampleRate()/1000)));
+    mainNode->setAttribute ("trials", maxTrials);
+    mainNode->setAttribute ("lfp", lfpAveraging);
 }
 
 void EvntTrigAvg::loadCustomParametersFromXml()
@@ -518,6 +741,11 @@ void EvntTrigAvg::loadCustomParametersFromXml()
                 windowSize = uint64(mainNode->getIntAttribute("window"));
                 std::cout<<"set window size to: " << windowSize << "\n";
                 ed->setWindow(mainNode->getIntAttribute("window"));
+
+                maxTrials = jmax(0, mainNode->getIntAttribute("trials", 0));
+                ed->setTrials(maxTrials);
+
+                lfpAveraging = mainNode->getBoolAttribute("lfp", false);
             }
         }
     }
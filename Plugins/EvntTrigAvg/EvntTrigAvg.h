@@ -28,6 +28,7 @@
 #include "EvntTrigAvgEditor.h"
 #include <vector>
 #include <map>
+#include <deque>
 
 class EvntTrigAvgEditor;
 
@@ -54,6 +55,8 @@ public:
     void handleEvent (const EventChannel* eventInfo, const MidiMessage& event, int sampleNum) override;
     void handleSpike(const SpikeChannel* channelInfo, const MidiMessage& event, int samplePosition) override;
     void process(AudioSampleBuffer& buffer) override;
+    bool modifiesContinuousData() const override { return false; }
+    bool emitsEvents() const override { return false; }
 
     /** Used to alter parameters of data acquisition. */
     void setParameter(int parameterIndex, float newValue) override;
@@ -67,6 +70,9 @@ public:
     /** Called after acquisition is finished. */
     bool disable() override;
 
+    /** Adds the histograms, the trials and spikes kept for them and the continuous averages. */
+    void getMemoryUsage(MemoryUsage& usage) const override;
+
     /** Creates the EvntTrigAvgEditor. */
     //AudioProcessorEditor* createEditor() override;
     AudioProcessorEditor* createEditor() override;
@@ -75,17 +81,51 @@ public:
     int getLastTTLCalculated();
     uint64 getWindowSize();
     uint64 getBinSize();
+    /** number of most recent trials in the histograms, 0 for all trials */
+    int getMaxTrials();
+    /** whether the continuous channels are averaged around each trigger as well */
+    bool getLfpAveraging();
+    int getNumLfpTrials();
+    int getNumLfpChannels();
+    /** copies the event-triggered average of a continuous channel, one value per sample of the window */
+    void getLfpAverage(int channel, std::vector<float>& average);
     std::vector<String> getElectrodeLabels();
     CriticalSection* getMutex() { return &mut; }
-    //get pointers to shared data
-    Array<uint64 *> getHistoData();
-    Array<float *> getMinMaxMean();
-
-    //create histogram data
-    uint64* createHistogramData(std::vector<uint64> spikeData, std::vector<uint64> ttlData); // shared data
-    uint64 binDataPoint(uint64 startBin, uint64 endBin, uint64 binSize, uint64 dataPoint); // shared data
-    void processSpikeData(std::vector<std::vector<std::vector<uint64>>> spikeData,std::vector<uint64> ttlData);
-    uint64* binCount(std::vector<uint64> binData, uint64 numberOfBins); // shared data
+
+    /** The histograms and their statistics as of the last completed trigger. Two of these
+        are filled in turn, and the one being filled is never one the canvas still holds,
+        so the canvas reads it without locking or copying. */
+    class HistogramSnapshot : public ReferenceCountedObject
+    {
+    public:
+        typedef ReferenceCountedObjectPtr<HistogramSnapshot> Ptr;
+
+        struct Row
+        {
+            int electrode;
+            int sortedId; // 0 for all the spikes of the electrode
+            float min;
+            float max;
+            float mean;
+            uint32 version; // version of the snapshot the row last changed in
+            const uint64* bins;
+        };
+
+        uint32 version = 0;
+        uint32 layoutVersion = 0; // changes when rows are added or removed or the bins change
+        int numBins = 0;
+        int numTrials = 0;
+        Array<Row> rows;
+
+    private:
+        friend class EvntTrigAvg;
+        HeapBlock<uint64> binData;
+        int binCapacity = 0;
+    };
+
+    /** Takes the latest snapshot; it stays unchanged for as long as it is held */
+    HistogramSnapshot::Ptr getHistogramSnapshot();
+
     bool shouldReadHistoData();
     float findMin(uint64* data_);
     float findMax(uint64* data_);
@@ -108,23 +148,72 @@ private:
     std::atomic<int> triggerEvent;
     std::atomic<int> triggerChannel;
 
-    uint64 bins[1000]; // workspace for bin counting
-
     int numChannels = 0;
-    bool recalc = false;
     int lastTTLCalculated = 0;
     uint64 windowSize;
     uint64 binSize;
-    
-    std::vector<uint64> ttlTimestampBuffer;
-    std::vector<std::vector<std::vector<uint64>>> spikeData;// channel.sortedID.spikeInstance.timestamp
+
+    // Spikes are binned as they arrive against the triggers whose window is still open,
+    // and triggers against the recent spikes that fall into their window, so every
+    // spike/trigger pair is counted once by whichever of the two comes second.
+    struct RecentSpike
+    {
+        uint64 timestamp;
+        int electrode;
+        int sortedId;
+    };
+    struct Trial
+    {
+        uint64 timestamp;
+        std::vector<int64> increments; // binned spikes, to take the trial out of the histograms again
+    };
+    std::deque<Trial> pendingTrials; // triggers whose window is still open, in arrival order
+    std::deque<Trial> completedTrials; // trials in the histograms, when only the last maxTrials are kept
+    std::vector<int64> spareIncrements; // storage of the last dropped trial, reused by the next trigger
+    int maxTrials = 0;
+    std::deque<RecentSpike> recentSpikes; // spikes a later trigger's window can still reach
+    HashMap<int64, int> histogramRows; // (electrode, sortedId) -> row of histogramData and minMaxMean
+    int getNumBins();
+    int findHistogramRow(int electrode, int sortedId);
+    void rebuildHistogramRowIndex();
+    void binSpike(int electrode, int sortedId, uint64 spikeTimestamp, Trial& trial);
+    void addToHistograms(int electrode, int sortedId, int bin, int count);
+    void markRowChanged(int row);
+    /** fills the snapshot the canvas doesn't hold with the rows changed since it was last filled */
+    void publishSnapshot();
+    void removeTrial(Trial& trial);
+
+    // Event-triggered averages of the continuous channels. The last half window of samples
+    // is kept in a ring, so a trigger can pick up its pre-trigger part; the rest of its
+    // window is added from the blocks as they arrive.
+    struct LfpTrial
+    {
+        int64 start; // timestamp of the first sample of the window
+        int64 next; // next sample to add
+    };
+    bool lfpAveraging = false;
+    std::deque<LfpTrial> lfpTrials; // triggers whose window is still being filled
+    AudioSampleBuffer lfpHistory;
+    int64 lfpHistoryStart = 0, lfpHistoryEnd = 0; // timestamps held by the ring
+    AudioSampleBuffer lfpSums; // running sum of every channel over the window
+    HeapBlock<float> lfpCounts; // number of trials summed at each sample of the window
+    int numLfpTrials = 0;
+    void resetLfpAverages(int numChannels);
+    void processLfp(AudioSampleBuffer& buffer);
+    void addLfpHistory(int64 from, int64 to, int64 trialStart);
+    void updateMinMaxMean();
     void clearHistogramData(uint64 * const);
     Array<uint64*> histogramData; // shared data
     Array<float*> minMaxMean; // shared data
+    Array<uint32> rowVersions; // per row of histogramData, the snapshot version it changes in
+    HistogramSnapshot::Ptr snapshots[2];
+    HistogramSnapshot::Ptr publishedSnapshot;
+    SpinLock snapshotLock;
+    uint32 snapshotVersion = 0; // version of the last snapshot published
+    uint32 layoutVersion = 1;
+    bool snapshotPending = false; // the canvas held both snapshots when the last one was due
     //std::map<SourceChannelInfo,int> electrodeMap; // Used to identify what electrode a spike came from
     std::vector<String> electrodeLabels;
-    std::vector<int> idIndex; //sorted ID, electrode. used to match a sortedID with its electrode
-    std::vector<std::vector<int>> electrodeSortedId; 
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EvntTrigAvg);
 
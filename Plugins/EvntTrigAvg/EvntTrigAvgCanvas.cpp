@@ -35,8 +35,22 @@ EvntTrigAvgCanvas::EvntTrigAvgCanvas(EvntTrigAvg* n) :
     clearHisto->setBounds(80,5,65,15);
     clearHisto->setClickingTogglesState(false);
     addAndMakeVisible(clearHisto);
+    
+    lfpButton = new UtilityButton("LFP", Font("Default", 12, Font::plain));
+    lfpButton->addListener(this);
+    lfpButton->setRadius(3.0f);
+    lfpButton->setBounds(150,5,40,15);
+    lfpButton->setClickingTogglesState(true);
+    lfpButton->setToggleState(processor->getLfpAveraging(), dontSendNotification);
+    addAndMakeVisible(lfpButton);
     setWantsKeyboardFocus(true);
     
+    lfpPlot = new MatlabLikePlot();
+    lfpPlot->setTitle("Event-triggered average (ms)");
+    lfpPlot->setAutoRescale(true);
+    lfpPlot->setVertical0Visible(true);
+    addChildComponent(lfpPlot);
+    
     viewport = new Viewport();
     viewport->setScrollBarsShown(true,true);
     scrollBarThickness = viewport->getScrollBarThickness();
@@ -100,6 +114,7 @@ void EvntTrigAvgCanvas::resized()
     else
         display->setBounds(0,100,getWidth()-scrollBarThickness, getHeight()-yOffset-40);
     scale->setBounds(0, getHeight()-40, getWidth()-scrollBarThickness, 40);
+    lfpPlot->setBounds(0, yOffset, getWidth(), getHeight()-yOffset);
     repaint();
 }
 
@@ -118,17 +133,14 @@ void EvntTrigAvgCanvas::paint(Graphics& g)
     g.setColour(Colours::snow);
     
     g.drawText("Electrode",5, 5, width/8, 20, juce::Justification::left);
+    if (processor->getLfpAveraging()){
+        g.drawText("Trials: " + String(processor->getNumLfpTrials()),(xOffset+drawWidth)/2-50,5,100,20,Justification::centred);
+        return;
+    }
     g.drawText("Trials: " + String(processor->getLastTTLCalculated()),(xOffset+drawWidth)/2-50,5,100,20,Justification::centred);
     g.drawText("Min.", width-180-scrollBarThickness, 5, 60, 20, Justification::right);
     g.drawText("Max", width-120-scrollBarThickness, 5, 60, 20, Justification::right);
     g.drawText("Mean", width-60-scrollBarThickness, 5, 60, 20, Justification::right);
-    //delete scale;
-    //scale = new Timescale(processor->getWindowSize(),processor->getSampleRate(),data,bin,processor->getBinSize());
-    //removeChildComponent(scale);
-    scale = new Timescale(processor->getWindowSize(),processor->getSampleRate(),data,bin,processor->getBinSize());
-    scale->setBounds(0, getHeight()-40, width-scrollBarThickness, 40);
-    addAndMakeVisible(scale,true);
-    repaint();
 }
 
 void EvntTrigAvgCanvas::repaintDisplay(){
@@ -138,8 +150,49 @@ void EvntTrigAvgCanvas::repaintDisplay(){
 void EvntTrigAvgCanvas::refresh()
 {
     // called every 10 Hz
-    display->refresh(); // dont know if this ever gets called
-    repaint();
+    const bool lfp = processor->getLfpAveraging();
+    lfpButton->setToggleState(lfp, dontSendNotification);
+    if (lfpPlot->isVisible() != lfp){
+        lfpPlot->setVisible(lfp);
+        viewport->setVisible(!lfp);
+        scale->setVisible(!lfp);
+        lfpTrialsShown = -1;
+    }
+    if (lfp)
+        updateLfpPlot();
+    else{
+        scale->update(int(processor->getWindowSize()), uint64(processor->getSampleRate()));
+        scale->setBinSize(int(processor->getBinSize()));
+        scale->repaint();
+        display->refresh();
+    }
+    // the trial count; the units repaint themselves when their histogram changes
+    repaint(0, 0, getWidth(), 25);
+}
+
+void EvntTrigAvgCanvas::updateLfpPlot()
+{
+    // the averages only change when a trigger arrives
+    const int numTrials = processor->getNumLfpTrials();
+    if (numTrials == lfpTrialsShown)
+        return;
+    lfpTrialsShown = numTrials;
+    
+    lfpPlot->clearplot();
+    const float sampleRate = float(processor->getSampleRate());
+    if (sampleRate <= 0)
+        return;
+    const int numChannels = processor->getNumLfpChannels();
+    const float dx = 1000.0f/sampleRate;
+    const float x0 = -float(processor->getWindowSize()/2)*dx;
+    std::vector<float> average;
+    for (int ch = 0 ; ch < numChannels ; ch++){
+        processor->getLfpAverage(ch, average);
+        if (average.size() == 0)
+            continue;
+        lfpPlot->plotxy(XYline(x0, dx, std::move(average), 1.0f, Colour::fromHSV(float(ch)/numChannels, 0.7f, 0.9f, 1.0f)));
+    }
+    lfpPlot->repaint();
 }
 
 bool EvntTrigAvgCanvas::keyPressed(const KeyPress& key)
@@ -150,23 +203,32 @@ bool EvntTrigAvgCanvas::keyPressed(const KeyPress& key)
 void EvntTrigAvgCanvas::buttonClicked(Button* button)
 {
     if (button == clearHisto){
-        histoData.clear();
-        minMaxMean.clear();
         processor->setParameter(4,0);
+        lfpTrialsShown = -1;
+    }
+    else if (button == lfpButton){
+        processor->setParameter(6, lfpButton->getToggleState() ? 1 : 0);
+        lfpTrialsShown = -1;
     }
      repaint();
 }
 
 void EvntTrigAvgCanvas::setBin(int bin_){
     bin = bin_;
+    scale->setBin(bin);
+    scale->repaint();
 }
 
 void EvntTrigAvgCanvas::setBinSize(int binSize_){
     binSize = binSize_;
+    scale->setBinSize(binSize);
+    scale->repaint();
 }
 
 void EvntTrigAvgCanvas::setData(int data_){
     data=data_;
+    scale->setData(data);
+    scale->repaint();
 }
 
 //--------------------------------------------------------------------
@@ -210,50 +272,59 @@ void EvntTrigAvgDisplay::viewedComponentChanged(Component* newComponent){
 void EvntTrigAvgDisplay::resized()
 {
     int width = getWidth();
-    for(int i = 0 ; i < graphs.size() ; i++){
-        graphs[i]->setBounds(20, 40*(i+1), width-20-width/4, 40);
-        graphs[i]->resized();
-    }
+    for(int i = 0 ; i < graphs.size() ; i++)
+        graphs[i]->setBounds(0, 40*i, width-20, 40);
 }
 
 void EvntTrigAvgDisplay::paint(Graphics &g)
 {
 
-    histoData.clear();
-    histoData = processor->getHistoData();
-    minMaxMean.clear();
-    minMaxMean = processor->getMinMaxMean();
-    int width=getWidth();
-    g.setColour(Colours::snow);
-    std::vector<String> labels = processor->getElectrodeLabels();
-    deleteAllChildren();
-    graphs.clear();
-    int graphCount = 0;
-    
-    for (int i = 0 ; i < histoData.size() ; i++){
-        GraphUnit* graph;
-        ScopedLock myScopedLock(*processor->getMutex());
-        if(histoData[i][1]==0){ // if sortedId == 0
-                graph = new GraphUnit(processor,canvas,channelColours[(histoData[i][0])%16],labels[histoData[i][0]],&minMaxMean[i][2],&histoData[i][2]); // pass &histoData[i][2] instead of 3 to pass on how many bins are used
-        }
-            else{
-                graph = new GraphUnit(processor,canvas,channelColours[(histoData[i][0])%16],"ID "+String(histoData[i][1]),&minMaxMean[i][2],&histoData[i][2]);
-            }
-            graphs.push_back(graph);
-            graph->setBounds(0, 40*(graphCount), width-20, 40);
-            addAndMakeVisible(graph,true);
-            graphCount += 1;
-    }
-    repaint(); // ideally find better method than this
 }
 
 void EvntTrigAvgDisplay::refresh()
 {
+    EvntTrigAvg::HistogramSnapshot::Ptr latest = processor->getHistogramSnapshot();
+    // a snapshot isn't written while it is held, so the same one has nothing new
+    if (latest == snapshot)
+        return;
+
+    const bool relayout = snapshot == nullptr || latest->layoutVersion != snapshot->layoutVersion
+        || latest->numBins != snapshot->numBins || latest->rows.size() != graphs.size();
+    const uint32 shownVersion = snapshot != nullptr ? snapshot->version : 0;
+    snapshot = latest;
+
+    if (relayout){
+        rebuildGraphs();
+        return;
+    }
+
+    // units scrolled out of view are repainted, and their outline rebuilt, when they come back
     for (int i = 0 ; i < graphs.size() ; i++){
-        graphs[i]->repaint();
+        const EvntTrigAvg::HistogramSnapshot::Row& row = snapshot->rows.getReference(i);
+        graphs[i]->setRow(&row, row.version > shownVersion);
     }
 }
 
+void EvntTrigAvgDisplay::rebuildGraphs()
+{
+    deleteAllChildren();
+    graphs.clear();
+    std::vector<String> labels = processor->getElectrodeLabels();
+
+    for (int i = 0 ; i < snapshot->rows.size() ; i++){
+        const EvntTrigAvg::HistogramSnapshot::Row& row = snapshot->rows.getReference(i);
+        String name = "ID "+String(row.sortedId);
+        if (row.sortedId == 0)
+            name = row.electrode < labels.size() ? labels[row.electrode] : String(row.electrode);
+        GraphUnit* graph = new GraphUnit(canvas,channelColours[row.electrode%16],name,snapshot->numBins);
+        graph->setRow(&row, true);
+        graphs.push_back(graph);
+        addAndMakeVisible(graph,true);
+    }
+    canvas->resized();
+    resized();
+}
+
 int EvntTrigAvgDisplay::getNumGraphs()
 {
     return graphs.size();
@@ -327,17 +398,16 @@ void inline Timescale::setBinSize(int binSize_)
 //--------------------------------------------------------------------
 
 
-GraphUnit::GraphUnit(EvntTrigAvg* processor_, EvntTrigAvgCanvas* canvas_,juce::Colour color_, String name_, float  * stats_,uint64 * data_){
-    ScopedLock myScopedLock(*processor_->getMutex());
+GraphUnit::GraphUnit(EvntTrigAvgCanvas* canvas_,juce::Colour color_, String name_, int numBins_){
     color = color_;
     LD = new LabelDisplay(color_,name_);
     LD->setBounds(0,0,30,40);
     addAndMakeVisible(LD,false);
     
-    HG = new HistoGraph(processor_,canvas_,color_,data_[0], stats_[1], &data_[1]);
+    HG = new HistoGraph(canvas_,color_,numBins_);
     HG->setBounds(30,0,getWidth()-210,40);
     addAndMakeVisible(HG,false);
-    SD = new StatDisplay(processor_,color_,stats_);
+    SD = new StatDisplay(color_);
     SD->setBounds(getWidth()-180,0,180,40);
     addAndMakeVisible(SD,false);
 }
@@ -355,6 +425,11 @@ void GraphUnit::resized()
     SD->setBounds(getWidth()-180,0,180,40);
     HG->setBounds(30,0,getWidth()-210,40);
 }
+void GraphUnit::setRow(const EvntTrigAvg::HistogramSnapshot::Row* row, bool changed)
+{
+    HG->setRow(row, changed);
+    SD->setRow(row, changed);
+}
 
 //----------------
 
@@ -379,13 +454,10 @@ void LabelDisplay::resized()
 
 //----------------
 
-HistoGraph::HistoGraph(EvntTrigAvg* processor_,EvntTrigAvgCanvas* canvas_, juce::Colour color_, uint64 bins_, float max_, uint64 * histoData_)
+HistoGraph::HistoGraph(EvntTrigAvgCanvas* canvas_, juce::Colour color_, int bins_)
 {
     color = color_;
-    histoData = histoData_;
     bins = bins_;
-    max = uint64(max_);
-    processor=processor_;
     canvas = canvas_;
 }
 
@@ -401,21 +473,35 @@ void HistoGraph::paint(Graphics& g)
     g.setOpacity(0.5);
     g.drawVerticalLine(getWidth()/2,5, getHeight());
     g.setColour(color);
-    for (int i = 1 ; i < bins ; i++){
-        ScopedLock myScopedLock(*processor->getMutex());
-        if(max!=0){
-            g.drawLine(float(i-1)*float(getWidth())/float(bins),getHeight()-(histoData[i-1]*getHeight()/max),float(i)*float(getWidth())/float(bins),getHeight()-(histoData[i]*getHeight()/max));
-        }
-        else
-            g.drawLine(float(i-1)*float(getWidth())/float(bins),getHeight()-(histoData[i-1]*getHeight()),float(i)*float(getWidth())/float(bins),getHeight()-(histoData[i]*getHeight()));
+    if (row == nullptr || bins < 2)
+        return;
+    if (!pathValid){
+        const uint64* histoData = row->bins;
+        const float max = row->max != 0 ? float(uint64(row->max)) : 1.0f;
+        path.clear();
+        path.startNewSubPath(0, getHeight()-(histoData[0]*getHeight()/max));
+        for (int i = 1 ; i < bins ; i++)
+            path.lineTo(float(i)*float(getWidth())/float(bins),getHeight()-(histoData[i]*getHeight()/max));
+        pathValid = true;
     }
+    g.strokePath(path, PathStrokeType(1.0f));
 }
 
 void HistoGraph::resized()
 {
+    pathValid = false;
     repaint();
 }
 
+void HistoGraph::setRow(const EvntTrigAvg::HistogramSnapshot::Row* row_, bool changed)
+{
+    row = row_;
+    if (changed){
+        pathValid = false;
+        repaint();
+    }
+}
+
 void HistoGraph::select()
 {
     
@@ -433,23 +519,18 @@ void HistoGraph::clear()
 
 void HistoGraph::mouseMove(const MouseEvent &event)
 {
-    if(bins>0){
-        int posX = event.x;
-        ScopedLock myScopedLock(*processor->getMutex());
-        int valueY = histoData[int(float(posX)/float(getWidth())*float(bins))];
-        canvas->setData(valueY);
-        canvas->setBin(int(float(posX)/float(getWidth())*float(bins))-(bins/2));
-        canvas->repaint();
+    if(bins>0 && row != nullptr){
+        const int bin = jlimit(0, bins-1, int(float(event.x)/float(getWidth())*float(bins)));
+        canvas->setData(int(row->bins[bin]));
+        canvas->setBin(bin-(bins/2));
     }
 }
 
 //----------------
 
-StatDisplay::StatDisplay(EvntTrigAvg* processor_, juce::Colour c, float * s)
+StatDisplay::StatDisplay(juce::Colour c)
 {
-    processor=processor_;
     color = c;
-    stats = s;
 }
 
 StatDisplay::~StatDisplay()
@@ -459,11 +540,12 @@ StatDisplay::~StatDisplay()
 
 void StatDisplay::paint(Graphics& g)
 {
-    ScopedLock myScopedLock(*processor->getMutex());
+    if (row == nullptr)
+        return;
     g.setColour(color);
-    g.drawText(String(stats[0]),0, 0, 60, 40, juce::Justification::right);
-    g.drawText(String(stats[1]),60, 0, 60, 40, juce::Justification::right);
-    g.drawText(String(stats[2]),120, 0, 60, 40, juce::Justification::right);
+    g.drawText(String(row->min),0, 0, 60, 40, juce::Justification::right);
+    g.drawText(String(row->max),60, 0, 60, 40, juce::Justification::right);
+    g.drawText(String(row->mean),120, 0, 60, 40, juce::Justification::right);
     }
 
 void StatDisplay::resized()
@@ -471,6 +553,13 @@ void StatDisplay::resized()
     
 }
 
+void StatDisplay::setRow(const EvntTrigAvg::HistogramSnapshot::Row* row_, bool changed)
+{
+    row = row_;
+    if (changed)
+        repaint();
+}
+
 
 
 
@@ -74,12 +74,15 @@ public:
 
 private:
 
-    Array<uint64*> histoData;
-    std::vector<std::vector<float>> minMaxMean;
     void removeUnitOrBox();
     ScopedPointer<Viewport> viewport;
     ScopedPointer<EvntTrigAvgDisplay> display;
     ScopedPointer<UtilityButton> clearHisto;
+    ScopedPointer<UtilityButton> lfpButton;
+    /** event-triggered averages of the continuous channels, shown instead of the histograms in LFP mode */
+    ScopedPointer<MatlabLikePlot> lfpPlot;
+    int lfpTrialsShown = -1;
+    void updateLfpPlot();
     int scrollBarThickness;
     int border = 20;
     int triggerChannel = -1;
@@ -108,17 +111,20 @@ public:
     void viewedComponentChanged (Component* newComponent);
     void resized();
     void paint(Graphics &g);
+    /** Takes the latest histograms and repaints the units that changed since the last ones */
     void refresh();
     int getNumGraphs();
 private:
+    /** Creates a unit for every row of the snapshot */
+    void rebuildGraphs();
 
     EvntTrigAvg* processor;
     EvntTrigAvgCanvas* canvas;
     Viewport* viewport;
     std::vector<GraphUnit*> graphs;
     juce::Colour channelColours[16];
-    Array<uint64 *> histoData;
-    Array<float *> minMaxMean;
+    /** Held until the next one is taken; the units point into its rows */
+    EvntTrigAvg::HistogramSnapshot::Ptr snapshot;
     int border = 20;
 };
 
@@ -153,10 +159,12 @@ private:
 class GraphUnit : public Component
 {
 public:
-    GraphUnit(EvntTrigAvg* processor_,EvntTrigAvgCanvas* canvas_,juce::Colour color_, String name_, float * stats_, uint64 * data_);
+    GraphUnit(EvntTrigAvgCanvas* canvas_,juce::Colour color_, String name_, int numBins_);
     ~GraphUnit();
     void paint(Graphics& g);
     void resized();
+    /** Points the unit at its row of a new snapshot, repainting it if the row changed */
+    void setRow(const EvntTrigAvg::HistogramSnapshot::Row* row, bool changed);
 private:
     LabelDisplay* LD;
     HistoGraph* HG;
@@ -184,11 +192,12 @@ class HistoGraph : public Component
 {
     
 public:
-    HistoGraph(EvntTrigAvg* processor_,EvntTrigAvgCanvas* canvas_,juce::Colour color_, uint64 bins_, float max_, uint64 * histoData_);
+    HistoGraph(EvntTrigAvgCanvas* canvas_,juce::Colour color_, int bins_);
     ~HistoGraph();
     
     void paint(Graphics& g);
     void resized();
+    void setRow(const EvntTrigAvg::HistogramSnapshot::Row* row_, bool changed);
     
     void select();
     void deselect();
@@ -197,12 +206,13 @@ public:
     
     
 private:
-    uint64 bins = 0;
+    int bins = 0;
     Colour color;
-    float max;
-    uint64 const * histoData;
+    const EvntTrigAvg::HistogramSnapshot::Row* row = nullptr;
+    /** Built when first painted after the row or the size changed, so units off screen cost nothing */
+    Path path;
+    bool pathValid = false;
     int valueY=0;
-    EvntTrigAvg* processor;
     EvntTrigAvgCanvas* canvas;
     
 };
@@ -212,14 +222,14 @@ private:
 class StatDisplay : public Component
 {
 public:
-    StatDisplay(EvntTrigAvg* display_, juce::Colour c, float * s);
+    StatDisplay(juce::Colour c);
     ~StatDisplay();
     void paint(Graphics& g);
     void resized();
+    void setRow(const EvntTrigAvg::HistogramSnapshot::Row* row_, bool changed);
 private:
-    EvntTrigAvg* processor;
     Colour color;
-    float const * stats;
+    const EvntTrigAvg::HistogramSnapshot::Row* row = nullptr;
     
 };
 
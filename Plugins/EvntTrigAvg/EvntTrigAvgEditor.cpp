@@ -48,7 +48,7 @@ EvntTrigAvgEditor::EvntTrigAvgEditor(GenericProcessor* parentNode, bool useDefau
     binSize = new Label("binSize","bin size");
     binSize->setFont(Font("Default", 12, Font::plain));
     binSize->setEditable(true);
-    binSize->setBounds(100,60,80,20);
+    binSize->setBounds(100,55,80,20);
     binSize->addListener(this);
     binSize->setColour(Label::textColourId, Colours::white);
     binSize->setTooltip("Set the bin size of the histogram in milliseconds");
@@ -58,12 +58,22 @@ EvntTrigAvgEditor::EvntTrigAvgEditor(GenericProcessor* parentNode, bool useDefau
     windowSize = new Label("windowSize","windowSize");
     windowSize->setFont(Font("Default", 12, Font::plain));
     windowSize->setEditable(true);
-    windowSize->setBounds(100,90,80,20);
+    windowSize->setBounds(100,80,80,20);
     windowSize->addListener(this);
     windowSize->setColour(Label::textColourId, Colours::white);
     windowSize->setTooltip("Set the window size of the histogram in milliseconds");
     windowSize->setText(String(1000),dontSendNotification);
     addAndMakeVisible(windowSize);
+
+    numTrials = new Label("numTrials","numTrials");
+    numTrials->setFont(Font("Default", 12, Font::plain));
+    numTrials->setEditable(true);
+    numTrials->setBounds(100,105,80,20);
+    numTrials->addListener(this);
+    numTrials->setColour(Label::textColourId, Colours::white);
+    numTrials->setTooltip("Average over the most recent trials only, 0 to keep all trials");
+    numTrials->setText(String(0),dontSendNotification);
+    addAndMakeVisible(numTrials);
     
     channelLabel = new Label("channelLabel","channel label");
     channelLabel->setFont(Font("Default", 12, Font::plain));
@@ -76,7 +86,7 @@ EvntTrigAvgEditor::EvntTrigAvgEditor(GenericProcessor* parentNode, bool useDefau
     binLabel = new Label("binLabel","bin label");
     binLabel->setFont(Font("Default", 12, Font::plain));
     binLabel->setEditable(false);
-    binLabel->setBounds(10,60,80,20);
+    binLabel->setBounds(10,55,80,20);
     binLabel->setColour(Label::textColourId, Colours::white);
     binLabel->setText("Bin Size (ms): ",dontSendNotification);
     addAndMakeVisible(binLabel);
@@ -84,11 +94,19 @@ EvntTrigAvgEditor::EvntTrigAvgEditor(GenericProcessor* parentNode, bool useDefau
     windowLabel = new Label("binLabel","bin label");
     windowLabel->setFont(Font("Default", 12, Font::plain));
     windowLabel->setEditable(false);
-    windowLabel->setBounds(10,90,90,20);
+    windowLabel->setBounds(10,80,90,20);
     windowLabel->setColour(Label::textColourId, Colours::white);
     windowLabel->setText("Window Size (ms): ",dontSendNotification);
     addAndMakeVisible(windowLabel);
 
+    trialsLabel = new Label("trialsLabel","trials label");
+    trialsLabel->setFont(Font("Default", 12, Font::plain));
+    trialsLabel->setEditable(false);
+    trialsLabel->setBounds(10,105,90,20);
+    trialsLabel->setColour(Label::textColourId, Colours::white);
+    trialsLabel->setText("Last Trials: ",dontSendNotification);
+    addAndMakeVisible(trialsLabel);
+
 }
 
 Visualizer* EvntTrigAvgEditor::createNewCanvas()
@@ -158,6 +176,14 @@ void EvntTrigAvgEditor::labelTextChanged(Label* label)
             label->setText(String(wms),juce::NotificationType::dontSendNotification);
         }
     }
+    else if (label == numTrials){
+        if(label->getText().getIntValue() < 0){
+            CoreServices::sendStatusMessage("Number of trials cannot be negative");
+            label->setText(String(processor->getMaxTrials()),juce::NotificationType::dontSendNotification);
+        }
+        else
+            processor->setParameter(5,label->getText().getIntValue());
+    }
 }
 
 
@@ -224,3 +250,7 @@ void  EvntTrigAvgEditor::setWindow(int val)
 {
     windowSize->setText(String(val),juce::NotificationType::dontSendNotification);
 }
+void  EvntTrigAvgEditor::setTrials(int val)
+{
+    numTrials->setText(String(val),juce::NotificationType::dontSendNotification);
+}
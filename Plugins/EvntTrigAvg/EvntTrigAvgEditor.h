@@ -55,6 +55,7 @@ public:
     void setTrigger(int val);
     void setBin(int val);
     void setWindow(int val);
+    void setTrials(int val);
     Visualizer* createNewCanvas();
     
     EvntTrigAvgCanvas* evntTrigAvgCanvas;
@@ -71,7 +72,7 @@ private:
     
     EvntTrigAvg* processor;
     ScopedPointer<ComboBox> triggerChannel;
-    ScopedPointer<Label> binSize, windowSize, channelLabel, binLabel, windowLabel;
+    ScopedPointer<Label> binSize, windowSize, numTrials, channelLabel, binLabel, windowLabel, trialsLabel;
     Font font;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EvntTrigAvgEditor);
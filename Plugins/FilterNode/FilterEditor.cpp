@@ -82,6 +82,22 @@ FilterEditor::FilterEditor(GenericProcessor* parentNode, bool useDefaultParamete
     applyFilterOnChan->setTooltip("When this button is off, selected channels will not be filtered");
     addAndMakeVisible(applyFilterOnChan);
 
+    firModeButton = new UtilityButton("FIR",Font("Default", 10, Font::plain));
+    firModeButton->addListener(this);
+    firModeButton->setBounds(90,42,40,18);
+    firModeButton->setClickingTogglesState(true);
+    firModeButton->setTooltip("When this button is on, all channels are filtered by linear phase FIR filters, "
+                              "which keep the shape of spikes but delay the signal and need a low cut of a few hundred Hz");
+    addAndMakeVisible(firModeButton);
+
+    hardwareHighPassButton = new UtilityButton("HW",Font("Default", 10, Font::plain));
+    hardwareHighPassButton->addListener(this);
+    hardwareHighPassButton->setBounds(90,24,40,16);
+    hardwareHighPassButton->setClickingTogglesState(true);
+    hardwareHighPassButton->setTooltip("When this button is on, channels already high-pass filtered by their acquisition hardware "
+                                       "at or above the low cut are only low pass filtered");
+    addAndMakeVisible(hardwareHighPassButton);
+
 }
 
 FilterEditor::~FilterEditor()
@@ -134,35 +150,15 @@ void FilterEditor::labelTextChanged(Label* label)
     // This needs to change, since there's not enough feedback about whether
     // or not individual channel settings were altered:
 
-    for (int n = 0; n < chans.size(); n++)
+    if (label == highCutValue)
     {
-
-        if (label == highCutValue)
-        {
-            double minVal = fn->getLowCutValueForChannel(chans[n]);
-
-            if (requestedValue > minVal)
-            {
-                fn->setCurrentChannel(chans[n]);
-                fn->setParameter(1, requestedValue);
-            }
-
-            lastHighCutString = label->getText();
-
-        }
-        else
-        {
-            double maxVal = fn->getHighCutValueForChannel(chans[n]);
-
-            if (requestedValue < maxVal)
-            {
-                fn->setCurrentChannel(chans[n]);
-                fn->setParameter(0, requestedValue);
-            }
-
-            lastLowCutString = label->getText();
-        }
-
+        fn->setHighCut(chans, requestedValue);
+        lastHighCutString = label->getText();
+    }
+    else
+    {
+        fn->setLowCut(chans, requestedValue);
+        lastLowCutString = label->getText();
     }
 
 }
@@ -186,19 +182,27 @@ void FilterEditor::buttonEvent(Button* button)
         fn->setApplyOnADC(applyFilterOnADC->getToggleState());
 
     }
-    else if (button == applyFilterOnChan)
+    else if (button == firModeButton)
     {
         FilterNode* fn = (FilterNode*) getProcessor();
+        fn->setParameter(3, firModeButton->getToggleState() ? 1.0 : 0.0);
 
-        Array<int> chans = getActiveChannels();
+        if (firModeButton->getToggleState())
+            CoreServices::sendStatusMessage("FIR filters delay the signal by " + String(fn->getFirDelay()) + " samples");
+    }
+    else if (button == hardwareHighPassButton)
+    {
+        FilterNode* fn = (FilterNode*) getProcessor();
+        fn->setUseHardwareHighPass(hardwareHighPassButton->getToggleState());
 
-        for (int n = 0; n < chans.size(); n++)
-        {
-            float newValue = button->getToggleState() ? 1.0 : 0.0;
+        if (hardwareHighPassButton->getToggleState())
+            CoreServices::sendStatusMessage(String(fn->getNumHardwareHighPassChannels()) + " channels use the high-pass of their hardware");
+    }
+    else if (button == applyFilterOnChan)
+    {
+        FilterNode* fn = (FilterNode*) getProcessor();
 
-            fn->setCurrentChannel(chans[n]);
-            fn->setParameter(2, newValue);
-        }
+        fn->setChannelsFiltered(getActiveChannels(), button->getToggleState());
     }
 }
 
@@ -215,6 +219,8 @@ void FilterEditor::saveCustomParameters(XmlElement* xml)
     textLabelValues->setAttribute("HighCut",lastHighCutString);
     textLabelValues->setAttribute("LowCut",lastLowCutString);
     textLabelValues->setAttribute("ApplyToADC",	applyFilterOnADC->getToggleState());
+    textLabelValues->setAttribute("FIR", firModeButton->getToggleState());
+    textLabelValues->setAttribute("HardwareHighPass", hardwareHighPassButton->getToggleState());
 }
 
 void FilterEditor::loadCustomParameters(XmlElement* xml)
@@ -229,6 +235,8 @@ void FilterEditor::loadCustomParameters(XmlElement* xml)
             resetToSavedText();
 
             applyFilterOnADC->setToggleState(xmlNode->getBoolAttribute("ApplyToADC",false), sendNotification);
+            firModeButton->setToggleState(xmlNode->getBoolAttribute("FIR",false), sendNotification);
+            hardwareHighPassButton->setToggleState(xmlNode->getBoolAttribute("HardwareHighPass",false), sendNotification);
         }
     }
 
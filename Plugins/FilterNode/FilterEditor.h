@@ -67,6 +67,8 @@ private:
     ScopedPointer<Label> lowCutValue;
     ScopedPointer<UtilityButton> applyFilterOnADC;
     ScopedPointer<UtilityButton> applyFilterOnChan;
+    ScopedPointer<UtilityButton> firModeButton;
+    ScopedPointer<UtilityButton> hardwareHighPassButton;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FilterEditor);
 
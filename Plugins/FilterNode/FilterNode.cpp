@@ -27,6 +27,10 @@
 
 FilterNode::FilterNode()
     : GenericProcessor  ("Bandpass Filter")
+    , useHardwareHighPass (false)
+    , filterMode        (IIR_FILTER)
+    , firTaps           (511)
+    , loadingChannelParameters (false)
     , defaultLowCut     (300.0f)
     , defaultHighCut    (6000.0f)
 {
@@ -129,8 +133,17 @@ void FilterNode::updateSettings()
 {
     //int id = nodeId;
     int numInputs = getNumInputs();
-    int numfilt = filters.size();
-    if (numInputs < 1024 && numInputs != numfilt)
+    int numfilt = filterBank.getNumChannels();
+
+    // a source changing its hardware filters redesigns the channels relying on them
+    Array<float> newHardwareHighPass;
+    for (int n = 0; n < dataChannelArray.size(); ++n)
+        newHardwareHighPass.add (dataChannelArray[n]->getHardwareHighPass());
+
+    const bool hardwareChanged = newHardwareHighPass != hardwareHighPass;
+    hardwareHighPass.swapWith (newHardwareHighPass);
+
+    if (numInputs != numfilt)
     {
         // SO fixed this. I think values were never restored correctly because you cleared lowCuts.
         Array<double> oldlowCuts;
@@ -138,20 +151,15 @@ void FilterNode::updateSettings()
         oldlowCuts = lowCuts;
         oldhighCuts = highCuts;
 
-        filters.clear();
+        // a second order band pass is two biquads
+        filterBank.setup (numInputs, 2);
+        firBank.setup (numInputs, firTaps);
         lowCuts.clear();
         highCuts.clear();
-        shouldFilterChannel.clear();
+        shouldFilterChannel.setNumChannels (numInputs, true);
 
         for (int n = 0; n < getNumInputs(); ++n)
         {
-            filters.add (new Dsp::SmoothedFilterDesign
-                         <Dsp::Butterworth::Design::BandPass    // design type
-                         <2>,                                   // order
-                         1,                                     // number of channels (must be const)
-                         Dsp::DirectFormII> (1));               // realization
-
-
             //Parameter& p1 =  parameters.getReference(0);
             //p1.setValue(600.0f, n);
             //Parameter& p2 =  parameters.getReference(1);
@@ -159,8 +167,6 @@ void FilterNode::updateSettings()
 
             // restore defaults
 
-            shouldFilterChannel.add (true);
-
             float newLowCut  = 0.f;
             float newHighCut = 0.f;
 
@@ -177,9 +183,13 @@ void FilterNode::updateSettings()
 
             lowCuts.add  (newLowCut);
             highCuts.add (newHighCut);
-
-            setFilterParameters (newLowCut, newHighCut, n);
         }
+
+        setFilterParametersForAllChannels();
+    }
+    else if (hardwareChanged && useHardwareHighPass)
+    {
+        setFilterParametersForAllChannels();
     }
 
     setApplyOnADC (applyOnADC);
@@ -200,13 +210,75 @@ double FilterNode::getHighCutValueForChannel (int chan) const
 
 bool FilterNode::getBypassStatusForChannel (int chan) const
 {
-    return shouldFilterChannel[chan];
+    return shouldFilterChannel.get (chan);
+}
+
+
+void FilterNode::setLowCut (const Array<int>& channels, double lowCut)
+{
+    Array<int> changed;
+
+    for (int i = 0; i < channels.size(); ++i)
+    {
+        if (isPositiveAndBelow (channels[i], lowCuts.size()) && lowCut < highCuts[channels[i]])
+        {
+            lowCuts.set (channels[i], lowCut);
+            changed.add (channels[i]);
+        }
+    }
+
+    setFilterParameters (changed);
+}
+
+
+void FilterNode::setHighCut (const Array<int>& channels, double highCut)
+{
+    Array<int> changed;
+
+    for (int i = 0; i < channels.size(); ++i)
+    {
+        if (isPositiveAndBelow (channels[i], highCuts.size()) && highCut > lowCuts[channels[i]])
+        {
+            highCuts.set (channels[i], highCut);
+            changed.add (channels[i]);
+        }
+    }
+
+    setFilterParameters (changed);
 }
 
 
-void FilterNode::setFilterParameters (double lowCut, double highCut, int chan)
+void FilterNode::setChannelsFiltered (const Array<int>& channels, bool shouldFilter)
 {
-    if (dataChannelArray.size() - 1 < chan)
+    shouldFilterChannel.set (channels, shouldFilter);
+    shouldFilterChannel.publish();
+}
+
+
+FilterNode::FilterMode FilterNode::getFilterMode() const
+{
+    return filterMode;
+}
+
+
+int FilterNode::getFirDelay() const
+{
+    return (firTaps - 1) / 2;
+}
+
+
+bool FilterNode::usesHardwareHighPass (int chan, double lowCut) const
+{
+    return useHardwareHighPass && filterMode == IIR_FILTER
+        && isPositiveAndBelow (chan, hardwareHighPass.size())
+        && hardwareHighPass[chan] > 0 && hardwareHighPass[chan] >= lowCut;
+}
+
+
+void FilterNode::setFilterParameters (double lowCut, double highCut, int chan, int numChannels)
+{
+    numChannels = jmin (numChannels, dataChannelArray.size() - chan);
+    if (chan < 0 || numChannels <= 0)
         return;
 
     Dsp::Params params;
@@ -215,8 +287,72 @@ void FilterNode::setFilterParameters (double lowCut, double highCut, int chan)
     params[2] = (highCut + lowCut) / 2;     // center frequency
     params[3] = highCut - lowCut;           // bandwidth
 
-    if (filters.size() > chan)
-        filters[chan]->setParams (params);
+    if (filterBank.getNumChannels() >= chan + numChannels)
+    {
+        if (usesHardwareHighPass (chan, lowCut))
+        {
+            // a single section; the second one passes through and is skipped
+            Dsp::Params lowPassParams;
+            lowPassParams[0] = params[0];
+            lowPassParams[1] = 2;           // order
+            lowPassParams[2] = highCut;     // cutoff frequency
+            lowPassDesign.setParams (lowPassParams);
+            filterBank.setCoefficients (chan, numChannels, lowPassDesign);
+        }
+        else
+        {
+            filterDesign.setParams (params);
+            filterBank.setCoefficients (chan, numChannels, filterDesign);
+        }
+    }
+
+    // FIR filters are only designed while they are used
+    if (filterMode == FIR_FILTER && firBank.getNumChannels() >= chan + numChannels)
+    {
+        firBank.setImpulseResponse (chan, numChannels, Dsp::FirDesign::bandPass (params[0], lowCut, highCut, firTaps));
+    }
+}
+
+
+void FilterNode::setFilterParametersForAllChannels()
+{
+    Array<int> channels;
+
+    for (int n = 0; n < lowCuts.size(); ++n)
+        channels.add (n);
+
+    setFilterParameters (channels);
+}
+
+
+void FilterNode::setFilterParameters (const Array<int>& sortedChannels)
+{
+    // adjacent channels with the same settings share a single design
+    const int numChannels = jmin (lowCuts.size(), dataChannelArray.size());
+
+    for (int i = 0, n; i < sortedChannels.size(); i += n)
+    {
+        const int first = sortedChannels[i];
+        if (! isPositiveAndBelow (first, numChannels))
+        {
+            n = 1;
+            continue;
+        }
+
+        const float sampleRate = dataChannelArray[first]->getSampleRate();
+
+        for (n = 1; i + n < sortedChannels.size() && first + n < numChannels; ++n)
+        {
+            if (sortedChannels[i + n] != first + n
+                || lowCuts[first + n] != lowCuts[first]
+                || highCuts[first + n] != highCuts[first]
+                || dataChannelArray[first + n]->getSampleRate() != sampleRate
+                || usesHardwareHighPass (first + n, lowCuts[first]) != usesHardwareHighPass (first, lowCuts[first]))
+                break;
+        }
+
+        setFilterParameters (lowCuts[first], highCuts[first], first, n);
+    }
 }
 
 
@@ -242,49 +378,115 @@ void FilterNode::setParameter (int parameterIndex, float newValue)
 
         editor->updateParameterButtons (parameterIndex);
     }
+    // change filter mode for all channels
+    else if (parameterIndex == 3)
+    {
+        filterMode = newValue == 0 ? IIR_FILTER : FIR_FILTER;
+
+        // the IIR filters also change for the channels relying on their hardware high-pass
+        if (filterMode == FIR_FILTER || useHardwareHighPass)
+            setFilterParametersForAllChannels();
+
+        // the filters of the other mode kept no state while unused
+        filterBank.reset();
+        firBank.reset();
+    }
+    // rely on hardware high-pass filters where there are any
+    else if (parameterIndex == 4)
+    {
+        useHardwareHighPass = newValue != 0;
+        setFilterParametersForAllChannels();
+    }
     // change channel bypass state
     else
     {
-        if (newValue == 0)
-        {
-            shouldFilterChannel.set (currentChannel, false);
-        }
-        else
-        {
-            shouldFilterChannel.set (currentChannel, true);
-        }
+        shouldFilterChannel.set (currentChannel, newValue != 0);
+        shouldFilterChannel.publish();
     }
 }
 
 
 void FilterNode::process (AudioSampleBuffer& buffer)
 {
-    for (int n = 0; n < getNumOutputs(); ++n)
+    // Channels are filtered in groups of LaneWidth, each with its own filter state,
+    // so groups can be filtered concurrently
+    float** channels = buffer.getArrayOfWritePointers();
+    const int laneWidth = Dsp::MultiChannelCascade::LaneWidth;
+    const int numChannels = jmin (getNumOutputs(), filterBank.getNumChannels());
+    const int numGroups = (numChannels + laneWidth - 1) / laneWidth;
+    const bool useFir = filterMode == FIR_FILTER;
+    const bool* shouldFilter = shouldFilterChannel.acquire();
+
+    parallelFor (numGroups, [this, channels, numChannels, laneWidth, useFir, shouldFilter] (int firstGroup, int lastGroup)
     {
-        if (shouldFilterChannel[n])
+        float* groupChannels[Dsp::MultiChannelCascade::LaneWidth];
+
+        for (int g = firstGroup; g < lastGroup; ++g)
         {
-            float* ptr = buffer.getWritePointer (n);
-            filters[n]->process (getNumSamples (n), &ptr);
+            const int last = jmin ((g + 1) * laneWidth, numChannels);
+
+            // channels from different sources can have different numbers of samples
+            for (int first = g * laneWidth; first < last;)
+            {
+                const int numSamples = getNumSamples (first);
+                int end = first + 1;
+                while (end < last && (int) getNumSamples (end) == numSamples)
+                    ++end;
+
+                for (int n = first; n < end; ++n)
+                    groupChannels[n - first] = shouldFilter[n] ? channels[n] : nullptr;
+
+                if (useFir)
+                    firBank.process (first, end - first, numSamples, groupChannels);
+                else
+                    filterBank.process (first, end - first, numSamples, groupChannels);
+                first = end;
+            }
         }
-    }
+    });
 }
 
 
 void FilterNode::setApplyOnADC (bool state)
 {
+    Array<int> channels;
+
     for (int n = 0; n < dataChannelArray.size(); ++n)
     {
         if (dataChannelArray[n]->getChannelType() == DataChannel::ADC_CHANNEL
             || dataChannelArray[n]->getChannelType() == DataChannel::AUX_CHANNEL)
         {
-            setCurrentChannel (n);
-
-            if (state)
-                setParameter (2,1.0);
-            else
-                setParameter (2,0.0);
+            channels.add (n);
         }
     }
+
+    setChannelsFiltered (channels, state);
+}
+
+
+void FilterNode::setUseHardwareHighPass (bool state)
+{
+    setParameter (4, state ? 1.0f : 0.0f);
+}
+
+
+bool FilterNode::getUseHardwareHighPass() const
+{
+    return useHardwareHighPass;
+}
+
+
+int FilterNode::getNumHardwareHighPassChannels() const
+{
+    int count = 0;
+
+    for (int n = 0; n < lowCuts.size(); ++n)
+    {
+        if (usesHardwareHighPass (n, lowCuts[n]))
+            ++count;
+    }
+
+    return count;
 }
 
 
@@ -299,7 +501,7 @@ void FilterNode::saveCustomChannelParametersToXml(XmlElement* channelInfo, int c
         XmlElement* channelParams = channelInfo->createNewChildElement ("PARAMETERS");
         channelParams->setAttribute ("highcut",         highCuts[channelNumber]);
         channelParams->setAttribute ("lowcut",          lowCuts[channelNumber]);
-        channelParams->setAttribute ("shouldFilter",    shouldFilterChannel[channelNumber]);
+        channelParams->setAttribute ("shouldFilter",    shouldFilterChannel.get (channelNumber));
     }
 }
 
@@ -321,8 +523,30 @@ void FilterNode::loadCustomChannelParametersFromXml(XmlElement* channelInfo, Inf
                 lowCuts.set  (channelNum, subNode->getDoubleAttribute ("lowcut",  defaultLowCut));
                 shouldFilterChannel.set (channelNum, subNode->getBoolAttribute ("shouldFilter", true));
 
-                setFilterParameters (lowCuts[channelNum], highCuts[channelNum], channelNum);
+                if (! loadingChannelParameters)
+                {
+                    setFilterParameters (lowCuts[channelNum], highCuts[channelNum], channelNum);
+                    shouldFilterChannel.publish();
+                }
             }
         }
     }
 }
+
+
+void FilterNode::loadAllChannelParametersFromXml (const Array<XmlElement*>& channelElements, InfoObjectCommon::InfoObjectType channelType)
+{
+    if (channelType != InfoObjectCommon::DATA_CHANNEL)
+    {
+        GenericProcessor::loadAllChannelParametersFromXml (channelElements, channelType);
+        return;
+    }
+
+    // the filters are designed once all the cutoffs are known
+    loadingChannelParameters = true;
+    GenericProcessor::loadAllChannelParametersFromXml (channelElements, channelType);
+    loadingChannelParameters = false;
+
+    setFilterParametersForAllChannels();
+    shouldFilterChannel.publish();
+}
@@ -30,7 +30,10 @@
 /**
     Filters data using a filter from the DSP library.
 
-    The user can select the low- and high-frequency cutoffs.
+    The user can select the low- and high-frequency cutoffs, and whether channels are
+    filtered by a Butterworth IIR filter, or by a linear phase FIR filter that delays
+    every frequency by the same (firTaps - 1) / 2 samples and so keeps the shape of
+    spikes and other waveforms.
 
     @see GenericProcessor, FilterEditor
 */
@@ -52,26 +55,76 @@ public:
 
     void saveCustomChannelParametersToXml(XmlElement* channelInfo, int channelNumber, InfoObjectCommon::InfoObjectType channelTypel) override;
     void loadCustomChannelParametersFromXml(XmlElement* channelInfo, InfoObjectCommon::InfoObjectType channelType)  override;
+    void loadAllChannelParametersFromXml (const Array<XmlElement*>& channelElements, InfoObjectCommon::InfoObjectType channelType) override;
 
     double getLowCutValueForChannel  (int chan) const;
     double getHighCutValueForChannel (int chan) const;
 
     bool getBypassStatusForChannel (int chan) const;
 
+    /** Sets the low cut of every given channel whose high cut is above it, designing their filters together */
+    void setLowCut (const Array<int>& channels, double lowCut);
+
+    /** Sets the high cut of every given channel whose low cut is below it, designing their filters together */
+    void setHighCut (const Array<int>& channels, double highCut);
+
+    /** Turns filtering on or off for the given channels, all in the same block of process() */
+    void setChannelsFiltered (const Array<int>& channels, bool shouldFilter);
+
+    enum FilterMode { IIR_FILTER = 0, FIR_FILTER };
+
+    FilterMode getFilterMode() const;
+
+    /** Returns the delay of the FIR filters, in samples */
+    int getFirDelay() const;
+
     void setApplyOnADC (bool state);
 
+    /** When on, IIR filters leave out the low cut of channels whose hardware already
+        high-passes them at or above it (see DataChannel::getHardwareHighPass), running
+        a single low pass section instead of the two band pass ones */
+    void setUseHardwareHighPass (bool state);
+
+    bool getUseHardwareHighPass() const;
+
+    /** Returns the number of channels currently relying on the hardware high-pass */
+    int getNumHardwareHighPassChannels() const;
+
 
 private:
-    void setFilterParameters (double, double, int);
+    void setFilterParameters (double lowCut, double highCut, int firstChannel, int numChannels = 1);
+    void setFilterParameters (const Array<int>& sortedChannels);
+    void setFilterParametersForAllChannels();
+
+    /** True if chan is low pass filtered only, its hardware covering a low cut of lowCut */
+    bool usesHardwareHighPass (int chan, double lowCut) const;
 
     Array<double> lowCuts;
     Array<double> highCuts;
 
-    OwnedArray<Dsp::Filter> filters;
-    Array<bool> shouldFilterChannel;
+    /** Filter state and coefficients of every channel, filtered LaneWidth adjacent channels at a time */
+    Dsp::MultiChannelCascade filterBank;
+    /** Computes the coefficients set in filterBank */
+    Dsp::Butterworth::Design::BandPass<2> filterDesign;
+    /** Used instead for channels whose hardware already removes the low frequencies */
+    Dsp::Butterworth::Design::LowPass<2> lowPassDesign;
+    /** FIR filters of every channel, used instead of filterBank in FIR_FILTER mode */
+    Dsp::OverlapSaveConvolver firBank;
+    /** Read by process(), so changed in batches from the message thread */
+    ChannelParameterBlock<bool> shouldFilterChannel;
 
     bool applyOnADC;
 
+    bool useHardwareHighPass;
+    /** High-pass cutoff applied by the hardware to each input, 0 if there is none */
+    Array<float> hardwareHighPass;
+
+    FilterMode filterMode;
+    const int firTaps;
+
+    /** Set while loading saved channel parameters, which are applied all together afterwards */
+    bool loadingChannelParameters;
+
     double defaultLowCut;
     double defaultHighCut;
 
@@ -0,0 +1,301 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "GpuSpikeDetector.h"
+#include "GpuSpikeDetectorEditor.h"
+
+// longer blocks are sent to the device in pieces of this size
+#define MAX_DEVICE_BLOCK 4096
+// per block; at 2048 channels and a 1024 sample block that is 4 spikes per channel
+#define MAX_SPIKES_PER_BLOCK 8192
+#define PRE_PEAK_SAMPLES 8
+#define POST_PEAK_SAMPLES 32
+
+
+GpuSpikeDetector::GpuSpikeDetector()
+    : GenericProcessor  ("GPU Spike Detector")
+    , pipeline          (new OpenClPipeline())
+    , deviceAvailable   (false)
+    , lowCut            (300.0)
+    , highCut           (6000.0)
+    , threshold         (50.0f)
+    , subtractReference (true)
+    , settingsChanged   (false)
+    , numDropped        (0)
+{
+    setProcessorType (PROCESSOR_TYPE_FILTER);
+
+    deviceAvailable = pipeline->initialise();
+    spikeThreshold.malloc (1);
+}
+
+
+GpuSpikeDetector::~GpuSpikeDetector()
+{
+}
+
+
+AudioProcessorEditor* GpuSpikeDetector::createEditor()
+{
+    editor = new GpuSpikeDetectorEditor (this);
+    return editor;
+}
+
+
+String GpuSpikeDetector::getDeviceDescription() const
+{
+    if (deviceAvailable)
+        return pipeline->getDeviceName();
+
+    return pipeline->getLastError();
+}
+
+
+int64 GpuSpikeDetector::getNumDroppedSpikes() const
+{
+    return numDropped;
+}
+
+
+void GpuSpikeDetector::createSpikeChannels()
+{
+    detectedChannels.clearQuick();
+
+    for (int i = 0; i < dataChannelArray.size(); ++i)
+    {
+        if (dataChannelArray[i]->getChannelType() == DataChannel::HEADSTAGE_CHANNEL)
+            detectedChannels.add (i);
+    }
+
+    for (int i = 0; i < detectedChannels.size(); ++i)
+    {
+        Array<const DataChannel*> chans;
+        chans.add (getDataChannel (detectedChannels[i]));
+
+        SpikeChannel* spk = new SpikeChannel (SpikeChannel::SINGLE, this, chans);
+        spk->setNumSamples (PRE_PEAK_SAMPLES, POST_PEAK_SAMPLES);
+        spikeChannelArray.add (spk);
+    }
+}
+
+
+void GpuSpikeDetector::updateSettings()
+{
+    designFilters();
+}
+
+
+void GpuSpikeDetector::designFilters()
+{
+    const SpinLock::ScopedLockType lock (settingsLock);
+
+    const int numChannels = detectedChannels.size();
+    coefficients.allocate ((size_t) numChannels * OpenClPipeline::numStages * OpenClPipeline::numCoefficients, true);
+    thresholds.allocate ((size_t) numChannels, true);
+
+    if (numChannels == 0)
+        return;
+
+    Dsp::Params params;
+    params[0] = getDataChannel (detectedChannels[0])->getSampleRate(); // sample rate
+    params[1] = 2;                          // order
+    params[2] = (highCut + lowCut) / 2;     // center frequency
+    params[3] = highCut - lowCut;           // bandwidth
+    filterDesign.setParams (params);
+
+    // the same coefficients the Filter Node gives Dsp::MultiChannelCascade
+    for (int s = 0; s < OpenClPipeline::numStages; ++s)
+    {
+        double c[OpenClPipeline::numCoefficients] = { 1., 0., 0., 0., 0. };
+        if (s < filterDesign.getNumStages())
+        {
+            const Dsp::Cascade::Stage& stage = filterDesign[s];
+            const double a0 = stage.getA0();
+            c[0] = stage.getB0() / a0;
+            c[1] = stage.getB1() / a0;
+            c[2] = stage.getB2() / a0;
+            c[3] = stage.getA1() / a0;
+            c[4] = stage.getA2() / a0;
+        }
+
+        for (int i = 0; i < OpenClPipeline::numCoefficients; ++i)
+        {
+            double* dest = coefficients + ((size_t) s * OpenClPipeline::numCoefficients + i) * numChannels;
+            std::fill (dest, dest + numChannels, c[i]);
+        }
+    }
+
+    std::fill (thresholds.getData(), thresholds + numChannels, threshold);
+    settingsChanged = true;
+}
+
+
+void GpuSpikeDetector::setParameter (int parameterIndex, float newValue)
+{
+    switch (parameterIndex)
+    {
+        case LOW_CUT:
+        case HIGH_CUT:
+            // the limits of the Filter Node
+            if (newValue <= 0.01 || newValue >= 10000.0f)
+                return;
+            if (parameterIndex == LOW_CUT && newValue < highCut)
+                lowCut = newValue;
+            else if (parameterIndex == HIGH_CUT && newValue > lowCut)
+                highCut = newValue;
+            designFilters();
+            break;
+        case THRESHOLD:
+        {
+            const SpinLock::ScopedLockType lock (settingsLock);
+            threshold = jmax (0.0f, newValue);
+            std::fill (thresholds.getData(), thresholds + detectedChannels.size(), threshold);
+            settingsChanged = true;
+            break;
+        }
+        case REFERENCE:
+            subtractReference = newValue != 0;
+            settingsChanged = true;
+            break;
+        default:
+            break;
+    }
+}
+
+
+bool GpuSpikeDetector::enable()
+{
+    if (! deviceAvailable)
+    {
+        CoreServices::sendStatusMessage ("GPU spike detector: " + pipeline->getLastError());
+        return false;
+    }
+
+    if (detectedChannels.size() == 0)
+        return true;
+
+    if (! pipeline->setup (detectedChannels.size(), MAX_DEVICE_BLOCK, PRE_PEAK_SAMPLES, POST_PEAK_SAMPLES, MAX_SPIKES_PER_BLOCK))
+    {
+        CoreServices::sendStatusMessage ("GPU spike detector: " + pipeline->getLastError());
+        return false;
+    }
+
+    settingsChanged = true;
+    numDropped = 0;
+    return uploadSettings();
+}
+
+
+bool GpuSpikeDetector::disable()
+{
+    // the spikes of the last block are not sent, there is no block left to carry them
+    pipeline->reset();
+
+    if (numDropped > 0)
+        std::cout << "GPU spike detector: " << numDropped << " spikes dropped" << std::endl;
+
+    return true;
+}
+
+
+bool GpuSpikeDetector::uploadSettings()
+{
+    const SpinLock::ScopedLockType lock (settingsLock);
+
+    if (! settingsChanged)
+        return true;
+
+    settingsChanged = false;
+    pipeline->setReferenceEnabled (subtractReference);
+    *spikeThreshold = (float) (int) threshold;
+
+    return pipeline->getNumChannels() == detectedChannels.size()
+        && pipeline->setCoefficients (coefficients)
+        && pipeline->setThresholds (thresholds);
+}
+
+
+void GpuSpikeDetector::process (AudioSampleBuffer& buffer)
+{
+    if (! deviceAvailable || detectedChannels.size() == 0 || pipeline->getNumChannels() == 0)
+        return;
+
+    if (settingsChanged && ! uploadSettings())
+    {
+        std::cout << "GPU spike detector: " << pipeline->getLastError() << std::endl;
+        return;
+    }
+
+    // all the channels are expected to come from the same source
+    const int numSamples = getNumSamples (detectedChannels[0]);
+    const int64 timestamp = getTimestamp (detectedChannels[0]);
+    const int maxBlock = pipeline->getMaxBlockSize();
+
+    for (int start = 0; start < numSamples; start += maxBlock)
+    {
+        if (pipeline->getNumPending() == OpenClPipeline::numSlots && ! emitSpikes (timestamp))
+            return;
+
+        if (! pipeline->submit (buffer, detectedChannels.getRawDataPointer(), start, jmin (maxBlock, numSamples - start), timestamp + start))
+        {
+            std::cout << "GPU spike detector: " << pipeline->getLastError() << std::endl;
+            pipeline->reset();
+            return;
+        }
+    }
+
+    // the block just submitted runs while the rest of the chain does
+    while (pipeline->getNumPending() > 1)
+    {
+        if (! emitSpikes (timestamp))
+            return;
+    }
+}
+
+
+bool GpuSpikeDetector::emitSpikes (int64 blockTimestamp)
+{
+    int64 spikesTimestamp;
+    int dropped;
+
+    if (! pipeline->collect (spikes, spikesTimestamp, dropped))
+    {
+        std::cout << "GPU spike detector: " << pipeline->getLastError() << std::endl;
+        pipeline->reset();
+        return false;
+    }
+
+    numDropped += dropped;
+
+    for (int i = 0; i < spikes.size(); ++i)
+    {
+        const OpenClPipeline::Spike& spike = spikes.getReference (i);
+        const int64 timestamp = spikesTimestamp + spike.peak;
+
+        // spikes of the previous block go at the start of this one
+        addSpike (getSpikeChannel (spike.channel), timestamp, spikeThreshold, spike.waveform, 0,
+                  (int) jmax (int64 (0), timestamp - blockTimestamp));
+    }
+
+    return true;
+}
@@ -0,0 +1,120 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __GPUSPIKEDETECTOR_H_5D8E02B4__
+#define __GPUSPIKEDETECTOR_H_5D8E02B4__
+
+#include <ProcessorHeaders.h>
+#include <DspLib.h>
+#include <atomic>
+#include "OpenClPipeline.h"
+
+/**
+    Band-pass filters, references and detects spikes on every headstage channel,
+    on the GPU, for channel counts the CPU processors can't keep up with.
+
+    The result is that of a Filter Node (Butterworth band-pass), a Common Avg Ref
+    taking the mean of all channels, and a Spike Detector with a single electrode
+    per channel and the same threshold on all of them, placed one after the other:
+    the crossings, peaks and waveforms follow the same rules. The filters run in
+    double precision where the device supports it, so the spikes match those of
+    the CPU path up to rounding.
+
+    Every block is handed to the device and the spikes of the previous one are
+    collected, so spikes come out one block late with their own timestamps. The
+    continuous data go through unchanged.
+
+    @see OpenClPipeline, GpuSpikeDetectorEditor
+*/
+class GpuSpikeDetector : public GenericProcessor
+{
+public:
+    GpuSpikeDetector();
+    ~GpuSpikeDetector();
+
+    AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override { return true; }
+
+    void process (AudioSampleBuffer& buffer) override;
+    bool modifiesContinuousData() const override { return false; }
+
+    void updateSettings() override;
+    void createSpikeChannels() override;
+
+    void setParameter (int parameterIndex, float newValue) override;
+
+    bool enable() override;
+    bool disable() override;
+
+    enum Parameters
+    {
+        LOW_CUT = 0,
+        HIGH_CUT,
+        /** Spikes are detected below minus this value, in the units of the channels */
+        THRESHOLD,
+        /** Non-zero to subtract the mean of all channels */
+        REFERENCE
+    };
+
+    /** The OpenCL device in use, or why there is none */
+    String getDeviceDescription() const;
+
+    /** Spikes lost because a block had more than the device's spike buffer holds */
+    int64 getNumDroppedSpikes() const;
+
+private:
+    /** Designs the band-pass of every channel and marks the settings to be sent to the device */
+    void designFilters();
+
+    /** Sends new filters, thresholds and reference setting to the device, if there are any */
+    bool uploadSettings();
+
+    /** Adds the spikes of the oldest block on the device to the current block */
+    bool emitSpikes (int64 blockTimestamp);
+
+    ScopedPointer<OpenClPipeline> pipeline;
+    bool deviceAvailable;
+
+    double lowCut;
+    double highCut;
+    float threshold;
+    bool subtractReference;
+
+    /** Input channel of every device channel and spike channel */
+    Array<int> detectedChannels;
+
+    /** Built on the message thread, uploaded by process() */
+    SpinLock settingsLock;
+    HeapBlock<double> coefficients;
+    HeapBlock<float> thresholds;
+    std::atomic<bool> settingsChanged;
+    Dsp::Butterworth::Design::BandPass<2> filterDesign;
+
+    Array<OpenClPipeline::Spike> spikes;
+    HeapBlock<float> spikeThreshold;
+    std::atomic<int64> numDropped;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GpuSpikeDetector);
+};
+
+#endif  // __GPUSPIKEDETECTOR_H_5D8E02B4__
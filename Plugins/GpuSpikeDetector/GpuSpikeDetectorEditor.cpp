@@ -0,0 +1,154 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "GpuSpikeDetectorEditor.h"
+#include "GpuSpikeDetector.h"
+
+GpuSpikeDetectorEditor::GpuSpikeDetectorEditor (GenericProcessor* parentNode)
+    : GenericEditor (parentNode, false)
+    , detector (static_cast<GpuSpikeDetector*> (parentNode))
+{
+    desiredWidth = 220;
+
+    lowCutLabel = addSetting ("Low cut (Hz)", "300", 25);
+    highCutLabel = addSetting ("High cut (Hz)", "6000", 45);
+    thresholdLabel = addSetting ("Threshold", "50", 65);
+    thresholdLabel->setTooltip ("Spikes are detected below minus this value, on every channel");
+
+    referenceButton = new UtilityButton ("CAR", Font ("Small Text", 10, Font::plain));
+    referenceButton->addListener (this);
+    referenceButton->setClickingTogglesState (true);
+    referenceButton->setToggleState (true, dontSendNotification);
+    referenceButton->setBounds (160, 65, 45, 18);
+    referenceButton->setTooltip ("Subtract the mean of all channels before detecting");
+    addAndMakeVisible (referenceButton);
+
+    deviceLabel = new Label ("Device", detector->getDeviceDescription());
+    deviceLabel->setFont (Font ("Small Text", 10, Font::plain));
+    deviceLabel->setColour (Label::textColourId, Colours::darkgrey);
+    deviceLabel->setBounds (10, 90, 200, 18);
+    deviceLabel->setTooltip (detector->getDeviceDescription());
+    addAndMakeVisible (deviceLabel);
+
+    droppedLabel = new Label ("Dropped", String());
+    droppedLabel->setFont (Font ("Small Text", 10, Font::plain));
+    droppedLabel->setColour (Label::textColourId, Colours::darkgrey);
+    droppedLabel->setBounds (10, 108, 200, 18);
+    addAndMakeVisible (droppedLabel);
+}
+
+GpuSpikeDetectorEditor::~GpuSpikeDetectorEditor()
+{
+}
+
+Label* GpuSpikeDetectorEditor::addSetting (const String& name, const String& value, int y)
+{
+    Label* title = new Label (name, name);
+    title->setFont (Font ("Small Text", 10, Font::plain));
+    title->setBounds (10, y, 75, 18);
+    title->setColour (Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible (title);
+    staticLabels.add (title);
+
+    Label* setting = new Label (name + " value", value);
+    setting->setFont (Font ("Small Text", 10, Font::plain));
+    setting->setColour (Label::textColourId, Colours::darkgrey);
+    setting->setEditable (true, false, false);
+    setting->addListener (this);
+    setting->setBounds (85, y, 60, 18);
+    setting->setColour (Label::backgroundColourId, Colours::lightgrey);
+    addAndMakeVisible (setting);
+    return setting;
+}
+
+void GpuSpikeDetectorEditor::labelTextChanged (Label* label)
+{
+    const float value = label->getText().getFloatValue();
+
+    if (label == lowCutLabel)
+    {
+        detector->setParameter (GpuSpikeDetector::LOW_CUT, value);
+    }
+    else if (label == highCutLabel)
+    {
+        detector->setParameter (GpuSpikeDetector::HIGH_CUT, value);
+    }
+    else if (label == thresholdLabel)
+    {
+        const float threshold = jmax (0.0f, value);
+        label->setText (String (threshold), dontSendNotification);
+        detector->setParameter (GpuSpikeDetector::THRESHOLD, threshold);
+    }
+}
+
+void GpuSpikeDetectorEditor::buttonEvent (Button* button)
+{
+    if (button == referenceButton)
+        detector->setParameter (GpuSpikeDetector::REFERENCE, referenceButton->getToggleState() ? 1.0f : 0.0f);
+}
+
+void GpuSpikeDetectorEditor::updateFromProcessor()
+{
+    const int64 dropped = detector->getNumDroppedSpikes();
+    droppedLabel->setText (dropped > 0 ? String (dropped) + " spikes dropped" : String(), dontSendNotification);
+}
+
+void GpuSpikeDetectorEditor::startAcquisition()
+{
+    // the filters are designed for the whole chain, so they only change while stopped
+    lowCutLabel->setEnabled (false);
+    highCutLabel->setEnabled (false);
+    droppedLabel->setText (String(), dontSendNotification);
+}
+
+void GpuSpikeDetectorEditor::stopAcquisition()
+{
+    lowCutLabel->setEnabled (true);
+    highCutLabel->setEnabled (true);
+}
+
+void GpuSpikeDetectorEditor::saveCustomParameters (XmlElement* xml)
+{
+    XmlElement* info = xml->createNewChildElement ("PARAMETERS");
+
+    info->setAttribute ("Type", "GpuSpikeDetectorEditor");
+    info->setAttribute ("LowCut", lowCutLabel->getText().getDoubleValue());
+    info->setAttribute ("HighCut", highCutLabel->getText().getDoubleValue());
+    info->setAttribute ("Threshold", thresholdLabel->getText().getDoubleValue());
+    info->setAttribute ("Reference", referenceButton->getToggleState());
+}
+
+void GpuSpikeDetectorEditor::loadCustomParameters (XmlElement* xml)
+{
+    forEachXmlChildElement (*xml, xmlNode)
+    {
+        if (xmlNode->hasTagName ("PARAMETERS"))
+        {
+            // the high cut first, so a low cut above the default is accepted
+            highCutLabel->setText (String (xmlNode->getDoubleAttribute ("HighCut", 6000.0)), sendNotificationSync);
+            lowCutLabel->setText (String (xmlNode->getDoubleAttribute ("LowCut", 300.0)), sendNotificationSync);
+            thresholdLabel->setText (String (xmlNode->getDoubleAttribute ("Threshold", 50.0)), sendNotificationSync);
+            referenceButton->setToggleState (xmlNode->getBoolAttribute ("Reference", true), sendNotificationSync);
+        }
+    }
+}
@@ -0,0 +1,73 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __GPUSPIKEDETECTOREDITOR_H_47A1C6E3__
+#define __GPUSPIKEDETECTOREDITOR_H_47A1C6E3__
+
+#include <EditorHeaders.h>
+
+class GpuSpikeDetector;
+
+/**
+
+  User interface for the GpuSpikeDetector processor.
+
+  Takes the band-pass cuts, the threshold and whether the mean of all channels
+  is subtracted, and shows the device in use.
+
+  @see GpuSpikeDetector
+
+*/
+
+class GpuSpikeDetectorEditor : public GenericEditor,
+    public Label::Listener
+{
+public:
+    GpuSpikeDetectorEditor (GenericProcessor* parentNode);
+    ~GpuSpikeDetectorEditor();
+
+    void labelTextChanged (Label* label) override;
+    void buttonEvent (Button* button) override;
+
+    void updateFromProcessor() override;
+
+    void startAcquisition() override;
+    void stopAcquisition() override;
+
+    void saveCustomParameters (XmlElement* xml) override;
+    void loadCustomParameters (XmlElement* xml) override;
+
+private:
+    Label* addSetting (const String& name, const String& value, int y);
+
+    GpuSpikeDetector* detector;
+
+    ScopedPointer<Label> lowCutLabel, highCutLabel, thresholdLabel;
+    ScopedPointer<Label> deviceLabel, droppedLabel;
+    ScopedPointer<UtilityButton> referenceButton;
+    OwnedArray<Label> staticLabels;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GpuSpikeDetectorEditor);
+};
+
+#endif  // __GPUSPIKEDETECTOREDITOR_H_47A1C6E3__
@@ -0,0 +1,664 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "OpenClPipeline.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    // window rows are samples, laid out channel after channel, so that neighbouring
+    // work items of the per channel kernels read neighbouring addresses
+    const char* kernelSource = R"(
+#ifdef USE_DOUBLE
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+typedef double real;
+#else
+typedef float real;
+#endif
+
+#define NUM_STAGES 2
+
+__kernel void bandPass (__global const float* input, const int numChannels, const int numSamples,
+                        __global const real* coefficients, __global real* state,
+                        __global float* window, const int history)
+{
+    const int ch = get_global_id (0);
+    if (ch >= numChannels)
+        return;
+
+    real b0[NUM_STAGES], b1[NUM_STAGES], b2[NUM_STAGES], a1[NUM_STAGES], a2[NUM_STAGES];
+    real v1[NUM_STAGES], v2[NUM_STAGES];
+
+    for (int s = 0; s < NUM_STAGES; ++s)
+    {
+        b0[s] = coefficients[(s * 5 + 0) * numChannels + ch];
+        b1[s] = coefficients[(s * 5 + 1) * numChannels + ch];
+        b2[s] = coefficients[(s * 5 + 2) * numChannels + ch];
+        a1[s] = coefficients[(s * 5 + 3) * numChannels + ch];
+        a2[s] = coefficients[(s * 5 + 4) * numChannels + ch];
+        v1[s] = state[(s * 2) * numChannels + ch];
+        v2[s] = state[(s * 2 + 1) * numChannels + ch];
+    }
+
+    __global const float* in = input + (size_t) ch * numSamples;
+
+    // Direct Form II, as Dsp::MultiChannelCascade
+    for (int i = 0; i < numSamples; ++i)
+    {
+        real x = in[i];
+
+        for (int s = 0; s < NUM_STAGES; ++s)
+        {
+            const real w = x - a1[s] * v1[s] - a2[s] * v2[s];
+            x = b0[s] * w + b1[s] * v1[s] + b2[s] * v2[s];
+            v2[s] = v1[s];
+            v1[s] = w;
+        }
+
+        window[(size_t) (history + i) * numChannels + ch] = (float) x;
+    }
+
+    for (int s = 0; s < NUM_STAGES; ++s)
+    {
+        state[(s * 2) * numChannels + ch] = v1[s];
+        state[(s * 2 + 1) * numChannels + ch] = v2[s];
+    }
+}
+
+__kernel void reference (__global float* window, const int numChannels, const int history,
+                         const int numSamples, const int numRows, const int subtractMean)
+{
+    const int row = get_global_id (0);
+    if (row >= numRows)
+        return;
+
+    __global float* samples = window + (size_t) (history + row) * numChannels;
+
+    // the rows after the block are zeros, for spikes peaking near its end
+    if (row >= numSamples)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            samples[ch] = 0.0f;
+        return;
+    }
+
+    if (! subtractMean)
+        return;
+
+    float sum = 0.0f;
+    for (int ch = 0; ch < numChannels; ++ch)
+        sum += samples[ch];
+
+    const float mean = sum / numChannels;
+    for (int ch = 0; ch < numChannels; ++ch)
+        samples[ch] -= mean;
+}
+
+__kernel void detect (__global const float* window, const int numChannels, const int history,
+                      const int numSamples, __global const float* thresholds, __global int* lastIndex,
+                      const int prePeak, const int postPeak, const int maxSpikes,
+                      __global int* spikeCount, __global int* spikeChannels, __global int* spikePeaks,
+                      __global float* waveforms)
+{
+    const int ch = get_global_id (0);
+    if (ch >= numChannels)
+        return;
+
+    #define W(i) window[(size_t) ((i) + history) * numChannels + ch]
+
+    const float limit = -thresholds[ch];
+    const int spikeLength = prePeak + postPeak;
+
+    // the same scan as the SpikeDetector: the end of the block waits for its trailing context
+    int scanStart = max (lastIndex[ch], 1 - history);
+    const int scanEnd = numSamples - history / 2 + 1;
+
+    for (int i = scanStart; i < scanEnd; ++i)
+    {
+        if (W (i) >= limit)
+            continue;
+
+        int peak = i;
+        while (W (peak) < W (peak - 1) && peak < i + postPeak)
+            ++peak;
+
+        const int slot = atomic_inc (spikeCount);
+        if (slot < maxSpikes)
+        {
+            const int start = peak - prePeak - 1;
+            const int skipped = max (0, -history - start);
+            __global float* waveform = waveforms + (size_t) slot * spikeLength;
+
+            for (int k = 0; k < spikeLength; ++k)
+                waveform[k] = k < skipped ? 0.0f : W (start + k);
+
+            spikeChannels[slot] = ch;
+            spikePeaks[slot] = peak;
+        }
+
+        scanStart = peak + postPeak + 1;
+        i = scanStart - 1;
+    }
+
+    lastIndex[ch] = max (scanStart, scanEnd) - 1 - numSamples;
+}
+)";
+
+    bool compareSpikes (const OpenClPipeline::Spike& a, const OpenClPipeline::Spike& b)
+    {
+        return a.channel != b.channel ? a.channel < b.channel : a.peak < b.peak;
+    }
+}
+
+
+OpenClPipeline::OpenClPipeline()
+    : context           (nullptr)
+    , queue             (nullptr)
+    , program           (nullptr)
+    , bandPassKernel    (nullptr)
+    , referenceKernel   (nullptr)
+    , detectKernel      (nullptr)
+    , useDouble         (false)
+    , coefficientBuffer (nullptr)
+    , stateBuffer       (nullptr)
+    , windowBuffer      (nullptr)
+    , thresholdBuffer   (nullptr)
+    , lastIndexBuffer   (nullptr)
+    , numChannels       (0)
+    , maxBlockSize      (0)
+    , prePeakSamples    (8)
+    , postPeakSamples   (32)
+    , maxSpikes         (0)
+    , windowRows        (0)
+    , subtractMean      (1)
+    , zero              (0)
+    , nextSlot          (0)
+    , numPending        (0)
+{
+}
+
+
+OpenClPipeline::~OpenClPipeline()
+{
+    if (queue != nullptr)
+        clFinish (queue);
+
+    releaseBuffers();
+
+    if (detectKernel != nullptr)    clReleaseKernel (detectKernel);
+    if (referenceKernel != nullptr) clReleaseKernel (referenceKernel);
+    if (bandPassKernel != nullptr)  clReleaseKernel (bandPassKernel);
+    if (program != nullptr)         clReleaseProgram (program);
+    if (queue != nullptr)           clReleaseCommandQueue (queue);
+    if (context != nullptr)         clReleaseContext (context);
+}
+
+
+bool OpenClPipeline::check (cl_int error, const char* what)
+{
+    if (error == CL_SUCCESS)
+        return true;
+
+    lastError = String (what) + " failed (OpenCL error " + String (error) + ")";
+    return false;
+}
+
+
+String OpenClPipeline::getDeviceName() const
+{
+    return deviceName;
+}
+
+
+String OpenClPipeline::getLastError() const
+{
+    return lastError;
+}
+
+
+bool OpenClPipeline::initialise()
+{
+    if (context != nullptr)
+        return true;
+
+    cl_uint numPlatforms = 0;
+    if (! check (clGetPlatformIDs (0, nullptr, &numPlatforms), "Listing the OpenCL platforms") || numPlatforms == 0)
+    {
+        lastError = "No OpenCL platform";
+        return false;
+    }
+
+    std::vector<cl_platform_id> platforms (numPlatforms);
+    clGetPlatformIDs (numPlatforms, platforms.data(), nullptr);
+
+    // a GPU on any platform first, then whatever device there is
+    cl_device_id device = nullptr;
+    const cl_device_type types[] = { CL_DEVICE_TYPE_GPU, CL_DEVICE_TYPE_ALL };
+
+    for (int t = 0; t < 2 && device == nullptr; ++t)
+    {
+        for (cl_uint p = 0; p < numPlatforms && device == nullptr; ++p)
+        {
+            cl_uint numDevices = 0;
+            if (clGetDeviceIDs (platforms[p], types[t], 1, &device, &numDevices) != CL_SUCCESS || numDevices == 0)
+                device = nullptr;
+        }
+    }
+
+    if (device == nullptr)
+    {
+        lastError = "No OpenCL device";
+        return false;
+    }
+
+    char name[256] = { 0 };
+    clGetDeviceInfo (device, CL_DEVICE_NAME, sizeof (name) - 1, name, nullptr);
+
+    // the filters keep the precision of the CPU path where the device allows it
+    cl_device_fp_config doubleConfig = 0;
+    clGetDeviceInfo (device, CL_DEVICE_DOUBLE_FP_CONFIG, sizeof (doubleConfig), &doubleConfig, nullptr);
+    useDouble = doubleConfig != 0;
+
+    cl_int error;
+    context = clCreateContext (nullptr, 1, &device, nullptr, nullptr, &error);
+    if (! check (error, "Creating the OpenCL context"))
+        return false;
+
+    queue = clCreateCommandQueue (context, device, 0, &error);
+    if (! check (error, "Creating the command queue"))
+        return false;
+
+    program = clCreateProgramWithSource (context, 1, &kernelSource, nullptr, &error);
+    if (! check (error, "Creating the program"))
+        return false;
+
+    error = clBuildProgram (program, 1, &device, useDouble ? "-DUSE_DOUBLE" : "", nullptr, nullptr);
+    if (error != CL_SUCCESS)
+    {
+        size_t logSize = 0;
+        clGetProgramBuildInfo (program, device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &logSize);
+        HeapBlock<char> log (logSize + 1, true);
+        clGetProgramBuildInfo (program, device, CL_PROGRAM_BUILD_LOG, logSize, log, nullptr);
+        std::cout << "GPU spike detector: building the kernels failed" << std::endl << log.getData() << std::endl;
+        return check (error, "Building the kernels");
+    }
+
+    if (! createKernels())
+        return false;
+
+    deviceName = String (name) + (useDouble ? "" : " (single precision)");
+    return true;
+}
+
+
+bool OpenClPipeline::createKernels()
+{
+    cl_int error;
+
+    bandPassKernel = clCreateKernel (program, "bandPass", &error);
+    if (! check (error, "Creating the band-pass kernel"))
+        return false;
+
+    referenceKernel = clCreateKernel (program, "reference", &error);
+    if (! check (error, "Creating the reference kernel"))
+        return false;
+
+    detectKernel = clCreateKernel (program, "detect", &error);
+    return check (error, "Creating the detection kernel");
+}
+
+
+cl_mem OpenClPipeline::createBuffer (cl_mem_flags flags, size_t size)
+{
+    cl_int error;
+    cl_mem buffer = clCreateBuffer (context, flags, jmax (size, (size_t) 4), nullptr, &error);
+    check (error, "Allocating device memory");
+    return buffer;
+}
+
+
+void OpenClPipeline::releaseBuffers()
+{
+    for (int i = 0; i < slots.size(); ++i)
+    {
+        Slot* slot = slots[i];
+
+        if (slot->done != nullptr)
+            clReleaseEvent (slot->done);
+
+        if (slot->mappedInput != nullptr)
+            clEnqueueUnmapMemObject (queue, slot->hostInput, slot->mappedInput, 0, nullptr, nullptr);
+        if (slot->mappedWaveforms != nullptr)
+            clEnqueueUnmapMemObject (queue, slot->hostWaveforms, slot->mappedWaveforms, 0, nullptr, nullptr);
+
+        cl_mem buffers[] = { slot->hostInput, slot->input, slot->hostWaveforms, slot->spikeCount,
+                             slot->spikeChannels, slot->spikePeaks, slot->waveforms };
+
+        for (int b = 0; b < numElementsInArray (buffers); ++b)
+        {
+            if (buffers[b] != nullptr)
+                clReleaseMemObject (buffers[b]);
+        }
+    }
+
+    if (queue != nullptr)
+        clFinish (queue);
+
+    slots.clear();
+
+    cl_mem buffers[] = { coefficientBuffer, stateBuffer, windowBuffer, thresholdBuffer, lastIndexBuffer };
+
+    for (int b = 0; b < numElementsInArray (buffers); ++b)
+    {
+        if (buffers[b] != nullptr)
+            clReleaseMemObject (buffers[b]);
+    }
+
+    coefficientBuffer = stateBuffer = windowBuffer = thresholdBuffer = lastIndexBuffer = nullptr;
+    numPending = 0;
+    nextSlot = 0;
+}
+
+
+bool OpenClPipeline::setup (int channels, int blockSize, int prePeak, int postPeak, int maxSpikesPerBlock)
+{
+    if (context == nullptr && ! initialise())
+        return false;
+
+    releaseBuffers();
+
+    numChannels = channels;
+    maxBlockSize = blockSize;
+    prePeakSamples = prePeak;
+    postPeakSamples = postPeak;
+    maxSpikes = maxSpikesPerBlock;
+
+    const int spikeLength = prePeak + postPeak;
+    // as the SpikeDetector's window: the history, the block and zeros for spikes at its end
+    windowRows = historySamples + maxBlockSize + 2 * spikeLength + 2;
+
+    const size_t realSize = useDouble ? sizeof (double) : sizeof (float);
+    const size_t n = (size_t) numChannels;
+
+    coefficientBuffer = createBuffer (CL_MEM_READ_ONLY, n * numStages * numCoefficients * realSize);
+    stateBuffer = createBuffer (CL_MEM_READ_WRITE, n * numStages * 2 * realSize);
+    windowBuffer = createBuffer (CL_MEM_READ_WRITE, n * windowRows * sizeof (float));
+    thresholdBuffer = createBuffer (CL_MEM_READ_ONLY, n * sizeof (float));
+    lastIndexBuffer = createBuffer (CL_MEM_READ_WRITE, n * sizeof (cl_int));
+
+    if (coefficientBuffer == nullptr || stateBuffer == nullptr || windowBuffer == nullptr
+        || thresholdBuffer == nullptr || lastIndexBuffer == nullptr)
+        return false;
+
+    for (int i = 0; i < numSlots; ++i)
+    {
+        Slot* slot = new Slot();
+        slots.add (slot);
+
+        // page-locked host copies, so the transfers run without staging
+        slot->hostInput = createBuffer (CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, n * maxBlockSize * sizeof (float));
+        slot->input = createBuffer (CL_MEM_READ_ONLY, n * maxBlockSize * sizeof (float));
+        slot->hostWaveforms = createBuffer (CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, (size_t) maxSpikes * spikeLength * sizeof (float));
+        slot->spikeCount = createBuffer (CL_MEM_READ_WRITE, sizeof (cl_int));
+        slot->spikeChannels = createBuffer (CL_MEM_WRITE_ONLY, (size_t) maxSpikes * sizeof (cl_int));
+        slot->spikePeaks = createBuffer (CL_MEM_WRITE_ONLY, (size_t) maxSpikes * sizeof (cl_int));
+        slot->waveforms = createBuffer (CL_MEM_WRITE_ONLY, (size_t) maxSpikes * spikeLength * sizeof (float));
+
+        if (slot->hostInput == nullptr || slot->input == nullptr || slot->hostWaveforms == nullptr
+            || slot->spikeCount == nullptr || slot->spikeChannels == nullptr || slot->spikePeaks == nullptr
+            || slot->waveforms == nullptr)
+            return false;
+
+        cl_int error;
+        slot->mappedInput = (float*) clEnqueueMapBuffer (queue, slot->hostInput, CL_TRUE, CL_MAP_WRITE, 0,
+                                                         n * maxBlockSize * sizeof (float), 0, nullptr, nullptr, &error);
+        if (! check (error, "Mapping the input"))
+            return false;
+
+        slot->mappedWaveforms = (float*) clEnqueueMapBuffer (queue, slot->hostWaveforms, CL_TRUE, CL_MAP_READ, 0,
+                                                             (size_t) maxSpikes * spikeLength * sizeof (float), 0, nullptr, nullptr, &error);
+        if (! check (error, "Mapping the waveforms"))
+            return false;
+
+        slot->channels.malloc (jmax (1, maxSpikes));
+        slot->peaks.malloc (jmax (1, maxSpikes));
+    }
+
+    // pass-through filters and thresholds nothing crosses until they are set
+    HeapBlock<double> coefficients ((size_t) numChannels * numStages * numCoefficients, true);
+    for (int s = 0; s < numStages; ++s)
+        std::fill (coefficients + (size_t) s * numCoefficients * numChannels, coefficients + ((size_t) s * numCoefficients + 1) * numChannels, 1.);
+
+    HeapBlock<float> thresholds ((size_t) numChannels);
+    std::fill (thresholds.getData(), thresholds + numChannels, std::numeric_limits<float>::max());
+
+    return setCoefficients (coefficients) && setThresholds (thresholds) && reset();
+}
+
+
+bool OpenClPipeline::setCoefficients (const double* coefficients)
+{
+    if (coefficientBuffer == nullptr)
+        return false;
+
+    clFinish (queue);
+
+    const size_t count = (size_t) numChannels * numStages * numCoefficients;
+
+    if (useDouble)
+        return check (clEnqueueWriteBuffer (queue, coefficientBuffer, CL_TRUE, 0, count * sizeof (double), coefficients, 0, nullptr, nullptr),
+                      "Writing the filter coefficients");
+
+    HeapBlock<float> singles (count);
+    for (size_t i = 0; i < count; ++i)
+        singles[i] = (float) coefficients[i];
+
+    return check (clEnqueueWriteBuffer (queue, coefficientBuffer, CL_TRUE, 0, count * sizeof (float), singles, 0, nullptr, nullptr),
+                  "Writing the filter coefficients");
+}
+
+
+bool OpenClPipeline::setThresholds (const float* thresholds)
+{
+    if (thresholdBuffer == nullptr)
+        return false;
+
+    clFinish (queue);
+
+    return check (clEnqueueWriteBuffer (queue, thresholdBuffer, CL_TRUE, 0, (size_t) numChannels * sizeof (float), thresholds, 0, nullptr, nullptr),
+                  "Writing the thresholds");
+}
+
+
+void OpenClPipeline::setReferenceEnabled (bool shouldSubtractMean)
+{
+    subtractMean = shouldSubtractMean ? 1 : 0;
+}
+
+
+bool OpenClPipeline::reset()
+{
+    if (windowBuffer == nullptr)
+        return false;
+
+    clFinish (queue);
+
+    for (int i = 0; i < slots.size(); ++i)
+    {
+        if (slots[i]->done != nullptr)
+        {
+            clReleaseEvent (slots[i]->done);
+            slots[i]->done = nullptr;
+        }
+    }
+
+    numPending = 0;
+    nextSlot = 0;
+
+    const size_t realSize = useDouble ? sizeof (double) : sizeof (float);
+    const cl_float zeroFloat = 0;
+
+    return check (clEnqueueFillBuffer (queue, stateBuffer, &zero, sizeof (zero), 0, (size_t) numChannels * numStages * 2 * realSize, 0, nullptr, nullptr), "Clearing the filters")
+        && check (clEnqueueFillBuffer (queue, windowBuffer, &zeroFloat, sizeof (zeroFloat), 0, (size_t) numChannels * windowRows * sizeof (float), 0, nullptr, nullptr), "Clearing the history")
+        && check (clEnqueueFillBuffer (queue, lastIndexBuffer, &zero, sizeof (zero), 0, (size_t) numChannels * sizeof (cl_int), 0, nullptr, nullptr), "Clearing the scan positions")
+        && check (clFinish (queue), "Clearing the buffers");
+}
+
+
+bool OpenClPipeline::submit (const AudioSampleBuffer& buffer, const int* channels, int startSample, int numSamples, int64 timestamp)
+{
+    jassert (numPending < numSlots && numSamples <= maxBlockSize);
+    if (numPending >= numSlots || numSamples > maxBlockSize || windowBuffer == nullptr)
+        return false;
+
+    Slot& slot = *slots[nextSlot];
+    slot.numSamples = numSamples;
+    slot.timestamp = timestamp;
+
+    // channels are packed one after the other, numSamples apart
+    for (int ch = 0; ch < numChannels; ++ch)
+        FloatVectorOperations::copy (slot.mappedInput + (size_t) ch * numSamples, buffer.getReadPointer (channels[ch], startSample), numSamples);
+
+    const size_t n = (size_t) numChannels;
+    const cl_int history = historySamples;
+    const cl_int channelCount = numChannels;
+    const cl_int sampleCount = numSamples;
+    const cl_int numRows = numSamples + (windowRows - historySamples - maxBlockSize);
+    const cl_int prePeak = prePeakSamples;
+    const cl_int postPeak = postPeakSamples;
+    const cl_int spikeCapacity = maxSpikes;
+
+    if (! check (clEnqueueWriteBuffer (queue, slot.input, CL_FALSE, 0, n * numSamples * sizeof (float), slot.mappedInput, 0, nullptr, nullptr), "Writing the block")
+        || ! check (clEnqueueWriteBuffer (queue, slot.spikeCount, CL_FALSE, 0, sizeof (cl_int), &zero, 0, nullptr, nullptr), "Clearing the spike count"))
+        return false;
+
+    // arguments are taken when a kernel is enqueued, so they can be set again for the next block
+    clSetKernelArg (bandPassKernel, 0, sizeof (cl_mem), &slot.input);
+    clSetKernelArg (bandPassKernel, 1, sizeof (cl_int), &channelCount);
+    clSetKernelArg (bandPassKernel, 2, sizeof (cl_int), &sampleCount);
+    clSetKernelArg (bandPassKernel, 3, sizeof (cl_mem), &coefficientBuffer);
+    clSetKernelArg (bandPassKernel, 4, sizeof (cl_mem), &stateBuffer);
+    clSetKernelArg (bandPassKernel, 5, sizeof (cl_mem), &windowBuffer);
+    clSetKernelArg (bandPassKernel, 6, sizeof (cl_int), &history);
+
+    clSetKernelArg (referenceKernel, 0, sizeof (cl_mem), &windowBuffer);
+    clSetKernelArg (referenceKernel, 1, sizeof (cl_int), &channelCount);
+    clSetKernelArg (referenceKernel, 2, sizeof (cl_int), &history);
+    clSetKernelArg (referenceKernel, 3, sizeof (cl_int), &sampleCount);
+    clSetKernelArg (referenceKernel, 4, sizeof (cl_int), &numRows);
+    clSetKernelArg (referenceKernel, 5, sizeof (cl_int), &subtractMean);
+
+    clSetKernelArg (detectKernel, 0, sizeof (cl_mem), &windowBuffer);
+    clSetKernelArg (detectKernel, 1, sizeof (cl_int), &channelCount);
+    clSetKernelArg (detectKernel, 2, sizeof (cl_int), &history);
+    clSetKernelArg (detectKernel, 3, sizeof (cl_int), &sampleCount);
+    clSetKernelArg (detectKernel, 4, sizeof (cl_mem), &thresholdBuffer);
+    clSetKernelArg (detectKernel, 5, sizeof (cl_mem), &lastIndexBuffer);
+    clSetKernelArg (detectKernel, 6, sizeof (cl_int), &prePeak);
+    clSetKernelArg (detectKernel, 7, sizeof (cl_int), &postPeak);
+    clSetKernelArg (detectKernel, 8, sizeof (cl_int), &spikeCapacity);
+    clSetKernelArg (detectKernel, 9, sizeof (cl_mem), &slot.spikeCount);
+    clSetKernelArg (detectKernel, 10, sizeof (cl_mem), &slot.spikeChannels);
+    clSetKernelArg (detectKernel, 11, sizeof (cl_mem), &slot.spikePeaks);
+    clSetKernelArg (detectKernel, 12, sizeof (cl_mem), &slot.waveforms);
+
+    const size_t groupSize = 64;
+    const size_t channelItems = (n + groupSize - 1) / groupSize * groupSize;
+    const size_t rowItems = ((size_t) numRows + groupSize - 1) / groupSize * groupSize;
+
+    if (! check (clEnqueueNDRangeKernel (queue, bandPassKernel, 1, nullptr, &channelItems, &groupSize, 0, nullptr, nullptr), "Running the band-pass filters")
+        || ! check (clEnqueueNDRangeKernel (queue, referenceKernel, 1, nullptr, &rowItems, &groupSize, 0, nullptr, nullptr), "Running the reference")
+        || ! check (clEnqueueNDRangeKernel (queue, detectKernel, 1, nullptr, &channelItems, &groupSize, 0, nullptr, nullptr), "Running the detection"))
+        return false;
+
+    // the last samples become the history of the next block; the SpikeDetector keeps
+    // its overflow buffer when a block is shorter than it
+    if (numSamples > historySamples)
+    {
+        if (! check (clEnqueueCopyBuffer (queue, windowBuffer, windowBuffer, (size_t) numSamples * n * sizeof (float), 0,
+                                          (size_t) historySamples * n * sizeof (float), 0, nullptr, nullptr), "Keeping the history"))
+            return false;
+    }
+
+    if (! check (clEnqueueReadBuffer (queue, slot.spikeCount, CL_FALSE, 0, sizeof (cl_int), &slot.count, 0, nullptr, nullptr), "Reading the spike count")
+        || ! check (clEnqueueReadBuffer (queue, slot.spikeChannels, CL_FALSE, 0, (size_t) maxSpikes * sizeof (cl_int), slot.channels, 0, nullptr, nullptr), "Reading the spike channels")
+        || ! check (clEnqueueReadBuffer (queue, slot.spikePeaks, CL_FALSE, 0, (size_t) maxSpikes * sizeof (cl_int), slot.peaks, 0, nullptr, &slot.done), "Reading the spike peaks"))
+        return false;
+
+    clFlush (queue);
+
+    nextSlot = (nextSlot + 1) % numSlots;
+    ++numPending;
+    return true;
+}
+
+
+bool OpenClPipeline::collect (Array<Spike>& spikes, int64& timestamp, int& numDropped)
+{
+    spikes.clearQuick();
+    numDropped = 0;
+
+    if (numPending == 0)
+        return false;
+
+    Slot& slot = *slots[(nextSlot - numPending + numSlots) % numSlots];
+    --numPending;
+
+    const cl_int error = clWaitForEvents (1, &slot.done);
+    clReleaseEvent (slot.done);
+    slot.done = nullptr;
+
+    if (! check (error, "Waiting for the device"))
+        return false;
+
+    timestamp = slot.timestamp;
+
+    const int count = jmin ((int) slot.count, maxSpikes);
+    numDropped = (int) slot.count - count;
+
+    if (count == 0)
+        return true;
+
+    const size_t spikeLength = (size_t) (prePeakSamples + postPeakSamples);
+
+    if (! check (clEnqueueReadBuffer (queue, slot.waveforms, CL_TRUE, 0, count * spikeLength * sizeof (float), slot.mappedWaveforms, 0, nullptr, nullptr),
+                 "Reading the waveforms"))
+        return false;
+
+    spikes.ensureStorageAllocated (count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        Spike spike;
+        spike.channel = slot.channels[i];
+        spike.peak = slot.peaks[i];
+        spike.waveform = slot.mappedWaveforms + i * spikeLength;
+        spikes.add (spike);
+    }
+
+    // the spikes come from all channels at once; the SpikeDetector goes channel by channel
+    std::sort (spikes.begin(), spikes.end(), compareSpikes);
+    return true;
+}
@@ -0,0 +1,180 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __OPENCLPIPELINE_H_91C3D2A7__
+#define __OPENCLPIPELINE_H_91C3D2A7__
+
+#include <ProcessorHeaders.h>
+
+#define CL_TARGET_OPENCL_VERSION 120
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+/**
+    Band-pass filters, references and thresholds many channels on an OpenCL device.
+
+    Each block goes through three kernels: a cascade of second order sections per
+    channel, the subtraction of the mean of all channels at every sample, and the
+    search for threshold crossings per channel. The crossings, peaks and waveforms
+    follow the rules of the SpikeDetector, on a window that keeps the last samples
+    of the previous block.
+
+    Blocks are copied into one of two page-locked slots and processed while the
+    caller goes on, so one block can be on the device while the spikes of the
+    previous one are read back. The device keeps the filter state, so blocks must
+    be submitted in order.
+
+    @see GpuSpikeDetector
+*/
+class OpenClPipeline
+{
+public:
+    OpenClPipeline();
+    ~OpenClPipeline();
+
+    enum
+    {
+        numSlots = 2,
+        numStages = 2,
+        numCoefficients = 5,
+        /** Samples of the previous block kept before the current one, as in the SpikeDetector */
+        historySamples = 100
+    };
+
+    struct Spike
+    {
+        int channel;
+        /** Index of the peak in the block, negative for peaks in the previous block */
+        int peak;
+        const float* waveform;
+    };
+
+    /** Picks a GPU, or any OpenCL device if there is none, and builds the kernels.
+        Returns false if no device could be used, see getLastError(). */
+    bool initialise();
+
+    /** Name of the device, empty until initialise() succeeded */
+    String getDeviceName() const;
+
+    String getLastError() const;
+
+    /** Allocates the buffers of every slot. Clears the filters and the history. */
+    bool setup (int numChannels, int maxBlockSize, int prePeakSamples, int postPeakSamples, int maxSpikesPerBlock);
+
+    int getNumChannels() const      { return numChannels; }
+    int getMaxBlockSize() const     { return maxBlockSize; }
+
+    /** Coefficients b0, b1, b2, a1, a2 (divided by a0) of every channel for each stage,
+        laid out as in Dsp::MultiChannelCascade. Waits for the blocks on the device. */
+    bool setCoefficients (const double* coefficients);
+
+    /** Negative crossing level of every channel. Waits for the blocks on the device. */
+    bool setThresholds (const float* thresholds);
+
+    void setReferenceEnabled (bool subtractMean);
+
+    /** Clears the filter state, the history and any block still on the device */
+    bool reset();
+
+    /** Number of blocks submitted and not collected yet */
+    int getNumPending() const       { return numPending; }
+
+    /** Copies numSamples samples from startSample of the given buffer channels into the
+        next slot and starts processing them. There must be a free slot. */
+    bool submit (const AudioSampleBuffer& buffer, const int* channels, int startSample, int numSamples, int64 timestamp);
+
+    /** Waits for the oldest block submitted and returns its spikes, sorted by channel and
+        peak, and its timestamp. The waveforms stay valid until the next call to submit(). */
+    bool collect (Array<Spike>& spikes, int64& timestamp, int& numDropped);
+
+private:
+    struct Slot
+    {
+        Slot()
+            : hostInput (nullptr), input (nullptr), hostWaveforms (nullptr), spikeCount (nullptr)
+            , spikeChannels (nullptr), spikePeaks (nullptr), waveforms (nullptr)
+            , mappedInput (nullptr), mappedWaveforms (nullptr), count (0), done (nullptr)
+            , numSamples (0), timestamp (0)
+        {
+        }
+
+        cl_mem hostInput;
+        cl_mem input;
+        cl_mem hostWaveforms;
+        cl_mem spikeCount;
+        cl_mem spikeChannels;
+        cl_mem spikePeaks;
+        cl_mem waveforms;
+
+        float* mappedInput;
+        float* mappedWaveforms;
+        cl_int count;
+        HeapBlock<cl_int> channels;
+        HeapBlock<cl_int> peaks;
+        cl_event done;
+
+        int numSamples;
+        int64 timestamp;
+    };
+
+    bool check (cl_int error, const char* what);
+    bool createKernels();
+    void releaseBuffers();
+    cl_mem createBuffer (cl_mem_flags flags, size_t size);
+
+    cl_context context;
+    cl_command_queue queue;
+    cl_program program;
+    cl_kernel bandPassKernel;
+    cl_kernel referenceKernel;
+    cl_kernel detectKernel;
+    String deviceName;
+    String lastError;
+    bool useDouble;
+
+    cl_mem coefficientBuffer;
+    cl_mem stateBuffer;
+    cl_mem windowBuffer;
+    cl_mem thresholdBuffer;
+    cl_mem lastIndexBuffer;
+    OwnedArray<Slot> slots;
+
+    int numChannels;
+    int maxBlockSize;
+    int prePeakSamples;
+    int postPeakSamples;
+    int maxSpikes;
+    int windowRows;
+    cl_int subtractMean;
+    const cl_int zero;
+
+    int nextSlot;
+    int numPending;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OpenClPipeline);
+};
+
+#endif  // __OPENCLPIPELINE_H_91C3D2A7__
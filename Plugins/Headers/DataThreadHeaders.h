@@ -28,4 +28,5 @@ data from external hardware.
 
 #include "../../JuceLibraryCode/JuceHeader.h"
 #include "../../Source/Processors/DataThreads/DataThread.h"
+#include "../../Source/Processors/DataThreads/SampleConversion.h"
 #include "../../Source/Processors/SourceNode/SourceNode.h"
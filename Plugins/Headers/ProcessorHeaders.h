@@ -24,9 +24,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 /*
 This header contains all the headers needed by processor nodes.
 Should be included in the source files which declare a processor class.
+
+The channels of the buffers given to GenericProcessor::process, and those of DataBuffer
+and DataQueue, are LockedMemoryBlock::channelAlignment (64) byte aligned and padded to
+LockedMemoryBlock::getChannelStride() samples; see LockedMemoryBlock.
 */
 
 #include "../../JuceLibraryCode/JuceHeader.h"
 #include "../../Source/Processors/GenericProcessor/GenericProcessor.h"
 #include "../../Source/Processors/Events/Events.h"
+#include "../../Source/Processors/GenericProcessor/ThreadPolicy.h"
+#include "../../Source/Processors/GenericProcessor/LockedMemoryBlock.h"
+#include "../../Source/Processors/GenericProcessor/StreamScheduler.h"
 
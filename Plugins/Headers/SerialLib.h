@@ -26,3 +26,5 @@ This header provides access to the simple serial library included in the GUI cod
 */
 
 #include "../../Source/Processors/Serial/ofSerial.h"
+#include "../../Source/Processors/Serial/SerialCommandQueue.h"
+#include "../../Source/Processors/Serial/SerialReader.h"
@@ -48,6 +48,9 @@ using namespace IntanRecordingController;
 
 #define INIT_STEP 256
 
+// Data blocks the USB thread can read ahead of the data thread
+#define NUM_USB_BUFFERS 32
+
 //#define SCAN_DEBUG
 #ifdef SCAN_DEBUG
 #define PRINT_ARRAYS  for (int i = 0; i < MAX_NUM_HEADSTAGES; i++) {\
@@ -106,6 +109,9 @@ RHD2000Thread::RHD2000Thread(SourceNode* sn) : DataThread(sn),
 	impedanceThread = new RHDImpedanceMeasure(this);
 	memset(auxBuffer, 0, sizeof(auxBuffer));
 	memset(auxSamples, 0, sizeof(auxSamples));
+	blockSamples.malloc(MAX_NUM_CHANNELS * SAMPLES_PER_DATA_BLOCK);
+	blockTimestamps.malloc(SAMPLES_PER_DATA_BLOCK);
+	blockEventCodes.malloc(SAMPLES_PER_DATA_BLOCK);
 
     for (int i=0; i < MAX_NUM_HEADSTAGES; i++)
         headstagesArray.add(new RHDHeadstage(i));
@@ -382,7 +388,7 @@ void RHD2000Thread::initializeBoard()
     }
 
 	//Instantiate usb thread
-	usbThread = new USBThread(evalBoard);
+	usbThread = new USBThread(evalBoard, NUM_USB_BUFFERS);
 
     // Initialize the board
     std::cout << "Initializing acquisition board." << std::endl;
@@ -1556,11 +1562,14 @@ bool RHD2000Thread::updateBuffer()
 	int auxIndex, chanIndex;
 	int numStreams = enabledStreams.size();
 	int nSamps = Rhd2000DataBlockUsb3::getSamplesPerDataBlock();
+	const int nChansTotal = getNumChannels();
+	int samp;
 
 	//evalBoard->printFIFOmetrics();
-	for (int samp = 0; samp < nSamps; samp++)
+	for (samp = 0; samp < nSamps; samp++)
 	{
 		int channel = -1;
+		float* thisSample = blockSamples + samp * nChansTotal;
 
 		if (!Rhd2000DataBlockUsb3::checkUsbHeader(bufferPtr, index))
 		{
@@ -1570,26 +1579,23 @@ bool RHD2000Thread::updateBuffer()
 		}
 
 		index += 8;
-		timestamps.set(0, Rhd2000DataBlockUsb3::convertUsbTimeStamp(bufferPtr, index));
+		blockTimestamps[samp] = Rhd2000DataBlockUsb3::convertUsbTimeStamp(bufferPtr, index);
 		index += 4;
 		auxIndex = index;
 		//skip the aux channels
 		index += numStreams * 6;
-		// do the neural data channels first
+		// do the neural data channels first, converting all streams at once into one run of words per stream
+		SampleConversion::transposeUInt16ToFloat(neuralSamples, (const uint16*)(bufferPtr + index), numStreams, CHANNELS_PER_STREAM, numStreams, 32768.0f, 0.195f);
 		for (int dataStream = 0; dataStream < numStreams; dataStream++)
 		{
 			int nChans = numChannelsPerDataStream[dataStream];
-			chanIndex = index + 2 * dataStream;
+			chanIndex = dataStream * CHANNELS_PER_STREAM;
 			if ((chipId[dataStream] == CHIP_ID_RHD2132) && (nChans == 16)) //RHD2132 16ch. headstage
 			{
-				chanIndex += 2 * RHD2132_16CH_OFFSET*numStreams;
-			}
-			for (int chan = 0; chan < nChans; chan++)
-			{
-				channel++;
-				thisSample[channel] = float(*(uint16*)(bufferPtr + chanIndex) - 32768)*0.195f;
-				chanIndex += 2 * numStreams;
+				chanIndex += RHD2132_16CH_OFFSET;
 			}
+			FloatVectorOperations::copy(thisSample + channel + 1, neuralSamples + chanIndex, nChans);
+			channel += nChans;
 		}
 		index += 2 * CHANNELS_PER_STREAM * numStreams;
 		//now we can do the aux channels
@@ -1636,11 +1642,13 @@ bool RHD2000Thread::updateBuffer()
 		{
 			index += 16;
 		}
-		ttlEventWords.set(0, *(uint16*)(bufferPtr + index));
+		blockEventCodes[samp] = *(uint16*)(bufferPtr + index);
 		index += 4;
-		sourceBuffers[0]->addToBuffer(thisSample, &timestamps.getReference(0), &ttlEventWords.getReference(0), 1);
 	}
 
+	if (samp > 0)
+		sourceBuffers[0]->addInterleavedBlock(blockSamples, blockTimestamps, blockEventCodes, samp);
+
 
 
 
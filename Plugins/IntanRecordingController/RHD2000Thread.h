@@ -160,7 +160,12 @@ namespace IntanRecordingController
 		int numChannels;
 		bool deviceFound;
 
-		float thisSample[MAX_NUM_CHANNELS];
+		// interleaved samples, timestamps and TTL words of a whole USB block, pushed to the DataBuffer at once
+		HeapBlock<float> blockSamples;
+		HeapBlock<int64> blockTimestamps;
+		HeapBlock<uint64> blockEventCodes;
+		// amplifier words of one frame converted to microvolts, the words of each stream in turn
+		float neuralSamples[MAX_NUM_DATA_STREAMS * 32];
 		// aux inputs are only sampled every 4th sample, so use this to buffer the samples so they can be handles just like the regular neural channels later
 		float auxBuffer[MAX_NUM_CHANNELS];
 		float auxSamples[MAX_NUM_DATA_STREAMS][3];
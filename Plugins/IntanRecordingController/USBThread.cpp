@@ -22,12 +22,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
 #include "USBThread.h"
+#include "RHD2000Thread.h"
 #include "rhythm-api/rhd2000evalboardusb3.h"
 
 using namespace IntanRecordingController;
 
-USBThread::USBThread(Rhd2000EvalBoardUsb3* b)
-	: m_board(b), Thread("USBThread")
+USBThread::USBThread(Rhd2000EvalBoardUsb3* b, int numBuffers)
+	: Thread("USBThread"), m_board(b), m_numBuffers(jmax(numBuffers, 2))
 {
 }
 
@@ -38,15 +39,19 @@ USBThread::~USBThread()
 
 void USBThread::startAcquisition(int nBytes)
 {
-    ScopedLock lock(m_lock);
-	for (int i = 0; i < 2; i++)
-	{
-		m_lastRead[i] = 0;
-		m_buffers[i].malloc(nBytes);
-	}
-	m_curBuffer = 0;
-	m_readBuffer = 0;
-	m_canRead = true;
+	//All the transfer buffers are allocated here, in one block, so none is allocated while running
+	m_bufferSize = nBytes;
+	m_buffers.malloc(size_t(m_numBuffers) * nBytes);
+	m_lastRead.calloc(m_numBuffers);
+	m_writeIndex = 0;
+	m_readIndex = 0;
+	m_holding = false;
+	m_dataReady.reset();
+	m_numTransfers = 0;
+	m_numRingFull = 0;
+	m_lastWordsInFifo = 0;
+	m_maxWordsInFifo = 0;
+	m_ringHighWaterMark = 0;
 	startThread();
 }
 
@@ -60,47 +65,82 @@ void USBThread::stopAcquisition()
 			std::cerr << "USB Thread could not stop cleanly. Force quitting it" << std::endl;
 		}
 	}
+	Stats stats = getStats();
+	std::cout << "USB thread: " << stats.numTransfers << " transfers, ring full " << stats.numRingFull
+		<< " times, up to " << stats.ringHighWaterMark << " of " << m_numBuffers << " blocks waiting, up to "
+		<< stats.maxWordsInFifo << " words in FIFO" << std::endl;
 }
 
 long USBThread::usbRead(unsigned char*& buffer)
 {
-	ScopedLock lock(m_lock);
-	if (m_readBuffer == m_curBuffer)
-		return 0;
-	buffer = m_buffers[m_readBuffer].getData();
-	long read = m_lastRead[m_readBuffer];
-	m_readBuffer = ++m_readBuffer % 2;
-	m_canRead = true;
-	notify();
-	return read;
+	int64 readIndex = m_readIndex.load(std::memory_order_relaxed);
+	if (m_holding)
+	{
+		//Give the previous block back to the USB thread
+		m_readIndex.store(++readIndex, std::memory_order_release);
+		m_holding = false;
+		notify();
+	}
+
+	if (m_writeIndex.load(std::memory_order_acquire) == readIndex)
+	{
+		m_dataReady.wait(5);
+		if (m_writeIndex.load(std::memory_order_acquire) == readIndex)
+			return 0;
+	}
+
+	int slot = int(readIndex % m_numBuffers);
+	buffer = m_buffers + size_t(slot) * m_bufferSize;
+	m_holding = true;
+	return m_lastRead[slot];
+}
+
+USBThread::Stats USBThread::getStats() const
+{
+	Stats stats;
+	stats.numTransfers = m_numTransfers.load();
+	stats.numRingFull = m_numRingFull.load();
+	stats.lastWordsInFifo = m_lastWordsInFifo.load();
+	stats.maxWordsInFifo = m_maxWordsInFifo.load();
+	stats.ringHighWaterMark = m_ringHighWaterMark.load();
+	return stats;
 }
 
 void USBThread::run()
 {
+	ThreadPolicy::applyToCurrentThread(ThreadPolicy::Acquisition);
+	bool wasFull = false;
 	while (!threadShouldExit())
 	{
-		m_lock.enter();
-		if (m_canRead)
+		int64 writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+		int pending = int(writeIndex - m_readIndex.load(std::memory_order_acquire));
+		if (pending >= m_numBuffers)
 		{
-			m_lock.exit();
-			long read;
-			do
-			{
-				if (threadShouldExit())
-					break;
-				read = m_board->readDataBlocksRaw(1, m_buffers[m_curBuffer].getData());
-			} while (read <= 0);
-			{
-				ScopedLock lock(m_lock);
-				m_lastRead[m_curBuffer] = read;
-				m_curBuffer = ++m_curBuffer % 2;
-				m_canRead = false;
-			}
-		}
-		else
-			m_lock.exit();
-
-		if (!threadShouldExit())
+			//The data thread is behind. Count each time it happens, not each time we check
+			if (!wasFull)
+				m_numRingFull++;
+			wasFull = true;
 			wait(100);
+			continue;
+		}
+		wasFull = false;
+
+		int slot = int(writeIndex % m_numBuffers);
+		long read = m_board->readDataBlocksRaw(1, m_buffers + size_t(slot) * m_bufferSize);
+		if (read <= 0)
+			continue; //not a full block in the FIFO yet
+
+		//readDataBlocksRaw checked the FIFO level right before the transfer
+		unsigned int words = m_board->getLastNumWordsInFifo();
+		m_lastWordsInFifo = words;
+		if (words > m_maxWordsInFifo.load(std::memory_order_relaxed))
+			m_maxWordsInFifo = words;
+		if (pending + 1 > m_ringHighWaterMark.load(std::memory_order_relaxed))
+			m_ringHighWaterMark = pending + 1;
+		m_numTransfers++;
+
+		m_lastRead[slot] = read;
+		m_writeIndex.store(writeIndex + 1, std::memory_order_release);
+		m_dataReady.signal();
 	}
 }
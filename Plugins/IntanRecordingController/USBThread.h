@@ -30,23 +30,61 @@ class Rhd2000EvalBoardUsb3;
 namespace IntanRecordingController
 {
 
+	/**
+		Reads raw data blocks from the board into a ring of buffers allocated when
+		acquisition starts. The thread keeps transferring into free slots while the
+		data thread parses the blocks already read, so a slow parsing pass only fills the
+		ring instead of backing up the FPGA FIFO.
+	*/
 	class USBThread : Thread
 	{
 	public:
-		USBThread(Rhd2000EvalBoardUsb3*);
+		struct Stats
+		{
+			/** Number of blocks transferred */
+			int64 numTransfers;
+			/** Number of times the ring was full and transfers had to wait for the data thread */
+			int64 numRingFull;
+			/** Words in the FPGA FIFO before the last transfer */
+			unsigned int lastWordsInFifo;
+			/** Largest number of words in the FPGA FIFO before a transfer */
+			unsigned int maxWordsInFifo;
+			/** Largest number of blocks waiting in the ring */
+			int ringHighWaterMark;
+		};
+
+		USBThread(Rhd2000EvalBoardUsb3*, int numBuffers = 16);
 		~USBThread();
 		void run() override;
 		void startAcquisition(int nBytes);
 		void stopAcquisition();
+
+		/** Gets the oldest block not yet read, waiting a few milliseconds if there is none.
+		The buffer stays valid until the next call, which releases it. Returns the number of
+		bytes read by the transfer, or 0 if no block is ready. Only the data thread can call this. */
 		long usbRead(unsigned char*&);
+
+		/** Can be called from any thread */
+		Stats getStats() const;
 	private:
 		Rhd2000EvalBoardUsb3* const m_board;
-		HeapBlock<unsigned char> m_buffers[2];
-		long m_lastRead[2];
-		unsigned short m_curBuffer{ 0 };
-		unsigned short m_readBuffer{ 0 };
-		bool m_canRead{ false };
-		CriticalSection m_lock;
+		const int m_numBuffers;
+		int m_bufferSize{ 0 };
+		HeapBlock<unsigned char> m_buffers;
+		HeapBlock<long> m_lastRead;
+
+		// Both only increase, the slot of an index is index % m_numBuffers. The producer
+		// owns the slots from m_readIndex + m_holding up to m_writeIndex excluded.
+		std::atomic<int64> m_writeIndex{ 0 };
+		std::atomic<int64> m_readIndex{ 0 };
+		bool m_holding{ false };
+		WaitableEvent m_dataReady;
+
+		std::atomic<int64> m_numTransfers{ 0 };
+		std::atomic<int64> m_numRingFull{ 0 };
+		std::atomic<unsigned int> m_lastWordsInFifo{ 0 };
+		std::atomic<unsigned int> m_maxWordsInFifo{ 0 };
+		std::atomic<int> m_ringHighWaterMark{ 0 };
 	};
 }
 #endif
@@ -41,6 +41,13 @@ JuliaEditor::JuliaEditor(GenericProcessor* parentNode, bool useDefaultParameterE
     reloadFileButton->setBounds(100+10,85,60,25);
     addAndMakeVisible(reloadFileButton);
 
+    asyncButton = new UtilityButton("async",Font("Small Text", 13, Font::plain));
+    asyncButton->setClickingTogglesState(true);
+    asyncButton->setTooltip("Run Julia alongside acquisition, one block behind, instead of waiting for it on every block");
+    asyncButton->addListener(this);
+    asyncButton->setBounds(10,60,50,20);
+    addAndMakeVisible(asyncButton);
+
     fileNameLabel = new Label("FileNameLabel", "No file selected.");
     fileNameLabel->setBounds(10,85+20,140,25);
     addAndMakeVisible(fileNameLabel);
@@ -88,8 +95,23 @@ void JuliaEditor::setFile(String file)
     // repaint();
 }
 
+void JuliaEditor::setAsynchronous(bool shouldRunAsynchronously)
+{
+    asyncButton->setToggleState(shouldRunAsynchronously, dontSendNotification);
+    juliaProcessor->setAsynchronous(shouldRunAsynchronously);
+}
+
 void JuliaEditor::buttonEvent(Button* button)
 {
+    if (button == asyncButton)
+    {
+        // the mode can't change in the middle of acquisition
+        if (acquisitionIsActive)
+            asyncButton->setToggleState(juliaProcessor->isAsynchronous(), dontSendNotification);
+        else
+            juliaProcessor->setAsynchronous(asyncButton->getToggleState());
+    }
+
     if (!acquisitionIsActive)
     {
         if (button == fileButton)
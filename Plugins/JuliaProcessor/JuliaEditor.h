@@ -45,6 +45,7 @@ public:
     void buttonEvent(Button* button);
     void labelTextChanged(Label* te);
     void setFile(String file);
+    void setAsynchronous(bool shouldRunAsynchronously);
     void saveEditorParameters(XmlElement*);
     void loadEditorParameters(XmlElement*);
     ImageIcon* icon;
@@ -52,6 +53,7 @@ public:
 private:
     ScopedPointer<UtilityButton> fileButton;
     ScopedPointer<UtilityButton> reloadFileButton;
+    ScopedPointer<UtilityButton> asyncButton;
     ScopedPointer<Label> fileNameLabel;
     ScopedPointer<Label> bufferSizeSelection;
     ScopedPointer<Label> bufferSizeSelectionLabel;
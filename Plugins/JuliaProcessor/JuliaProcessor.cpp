@@ -25,8 +25,23 @@
 #include <stdio.h>
 #include <julia.h>
 
+namespace
+{
+    // samples per channel that can be waiting for, or coming back from, the Julia thread
+    const int fifoSize = 16384;
+}
+
 JuliaProcessor::JuliaProcessor()
     : GenericProcessor("Julia Processor")
+    , Thread("Julia")
+    , asynchronous(false)
+    , inputFifo(fifoSize)
+    , outputFifo(fifoSize)
+    , numBlockChannels(0)
+    , processFunction(nullptr)
+    , matrixType(nullptr)
+    , blockMatrix(nullptr)
+    , blockMatrixSamples(0)
 {
 	hasJuliaInstance = false;
     dataHistoryBufferNumChannels = 256;
@@ -36,7 +51,10 @@ JuliaProcessor::JuliaProcessor()
 
 JuliaProcessor::~JuliaProcessor()
 {
-	jl_atexit_hook(0);
+	// the Julia thread shuts Julia down as it exits
+	signalThreadShouldExit();
+	workToDo.signal();
+	stopThread(5000);
 	deleteAndZero(dataHistoryBuffer);
 }
 
@@ -52,6 +70,15 @@ void JuliaProcessor::setFile(String fullpath)
 	hasJuliaInstance = true;
 	filePath = fullpath;
 
+	String juliaString = "include(\"" + filePath + "\")";
+	run_julia_string(juliaString);
+
+	if (!isThreadRunning())
+		startThread();
+}
+
+void JuliaProcessor::initialiseJulia()
+{
 	FILE* fp = popen("echo $JULIA", "r");
 	char input[255];
 	fgets(input, sizeof(input), fp);
@@ -67,9 +94,6 @@ void JuliaProcessor::setFile(String fullpath)
 	const char* jsys = julia_sys_dir.toRawUTF8();
 	
 	jl_init_with_image(jbin, jsys);
-
-	String juliaString = "include(\"" + filePath + "\")";
-	run_julia_string(juliaString);
 }
 
 void JuliaProcessor::reloadFile()
@@ -107,15 +131,132 @@ void JuliaProcessor::setBuffersize(int bufferSize)
 
 void JuliaProcessor::run_julia_string(String juliaString)
 {
-    // need to convert from juce String to char array
-    const char* jstr = juliaString.toRawUTF8();
+    // run by the Julia thread before the next block
+    const ScopedLock sl(commandLock);
+    pendingCommands.add(juliaString);
+    workToDo.signal();
+}
+
+void JuliaProcessor::runPendingCommands()
+{
+    StringArray commands;
+    {
+        const ScopedLock sl(commandLock);
+        commands.swapWith(pendingCommands);
+    }
+
+    if (commands.isEmpty())
+        return;
+
+    for (int i = 0; i < commands.size(); i++)
+    {
+        // need to convert from juce String to char array
+        const char* jstr = commands[i].toRawUTF8();
+
+        printf("executing julia cmd: %s\n", jstr);
+
+        jl_eval_string(jstr);
+
+        if (jl_exception_occurred())
+            printf("%s \n", jl_typeof_str(jl_exception_occurred()));
+    }
+
+    // the file might have redefined the function, so it is looked up here rather than on every block
+    processFunction = jl_get_function(jl_main_module, "oe_process!");
+    matrixType = jl_apply_array_type(jl_float32_type, 2); // last arg is nDims
+
+    if (processFunction == nullptr)
+        printf("oe_process! is not defined\n");
+
+    juliaReady = 1;
+}
+
+void JuliaProcessor::run()
+{
+    initialiseJulia();
 
-    printf("executing julia cmd: %s\n", jstr);
+    while (!threadShouldExit())
+    {
+        workToDo.wait(100);
 
-    jl_eval_string(jstr);
+        runPendingCommands();
+        processPendingSamples();
+    }
 
-    if (jl_exception_occurred())
-    	printf("%s \n", jl_typeof_str(jl_exception_occurred()));
+    jl_atexit_hook(0);
+}
+
+void JuliaProcessor::processPendingSamples()
+{
+    const ScopedLock sl(blockLock);
+
+    const int numSamples = jmin(inputFifo.getNumReady(), outputFifo.getFreeSpace());
+    if (numSamples == 0 || numBlockChannels == 0)
+        return;
+
+    int start1, size1, start2, size2;
+
+    if (processFunction != nullptr && matrixType != nullptr)
+    {
+        // the matrix is kept in a global, so that it stays rooted between blocks
+        if (blockMatrix == nullptr || blockMatrixSamples != numSamples)
+        {
+            jl_value_t* newMatrix = (jl_value_t*) jl_alloc_array_2d(matrixType, numSamples, numBlockChannels);
+            JL_GC_PUSH1(&newMatrix);
+            jl_set_global(jl_main_module, jl_symbol("oe_block"), newMatrix);
+            JL_GC_POP();
+            blockMatrix = newMatrix;
+            blockMatrixSamples = numSamples;
+        }
+
+        // column major: one column of samples per channel
+        float* matrix = (float*) jl_array_data((jl_array_t*) blockMatrix);
+
+        inputFifo.prepareToRead(numSamples, start1, size1, start2, size2);
+        for (int ch = 0; ch < numBlockChannels; ch++)
+        {
+            float* column = matrix + ch * numSamples;
+            FloatVectorOperations::copy(column, inputSamples.getReadPointer(ch, start1), size1);
+            if (size2 > 0)
+                FloatVectorOperations::copy(column + size1, inputSamples.getReadPointer(ch, start2), size2);
+        }
+        inputFifo.finishedRead(size1 + size2);
+
+        jl_call1(processFunction, blockMatrix);
+
+        if (jl_exception_occurred())
+            printf("%s \n", jl_typeof_str(jl_exception_occurred()));
+
+        outputFifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+        for (int ch = 0; ch < numBlockChannels; ch++)
+        {
+            const float* column = matrix + ch * numSamples;
+            outputSamples.copyFrom(ch, start1, column, size1);
+            if (size2 > 0)
+                outputSamples.copyFrom(ch, start2, column + size1, size2);
+        }
+        outputFifo.finishedWrite(size1 + size2);
+    }
+    else
+    {
+        // nothing to run, so the samples go back untouched
+        inputFifo.prepareToRead(numSamples, start1, size1, start2, size2);
+        int out1, outSize1, out2, outSize2;
+        outputFifo.prepareToWrite(numSamples, out1, outSize1, out2, outSize2);
+
+        for (int i = 0; i < numSamples; i++)
+        {
+            const int in = i < size1 ? start1 + i : start2 + i - size1;
+            const int out = i < outSize1 ? out1 + i : out2 + i - outSize1;
+            for (int ch = 0; ch < numBlockChannels; ch++)
+                outputSamples.setSample(ch, out, inputSamples.getSample(ch, in));
+        }
+
+        inputFifo.finishedRead(numSamples);
+        outputFifo.finishedWrite(numSamples);
+    }
+
+    blockDone.signal();
 }
 
 
@@ -125,30 +266,98 @@ String JuliaProcessor::getFile()
     return filePath;
 }
 
-void JuliaProcessor::process(AudioSampleBuffer& buffer, MidiBuffer& midiMessages)
+bool JuliaProcessor::enable()
+{
+    const ScopedLock sl(blockLock);
+
+    numBlockChannels = jmin(getNumOutputs(), getNumInputs());
+    inputSamples.setSize(numBlockChannels, fifoSize);
+    outputSamples.setSize(numBlockChannels, fifoSize);
+    inputFifo.reset();
+    outputFifo.reset();
+    numDroppedSamples = 0;
+
+    return true;
+}
+
+bool JuliaProcessor::disable()
 {
-	if (hasJuliaInstance)
+    if (numDroppedSamples.get() > 0)
+        std::cout << "Julia could not keep up, " << numDroppedSamples.get() << " samples were not processed" << std::endl;
+
+    return true;
+}
+
+void JuliaProcessor::process(AudioSampleBuffer& buffer)
+{
+	// until Julia has started and loaded the file, the data goes through untouched
+	if (!hasJuliaInstance || juliaReady.get() == 0)
+		return;
+
+	const int numSamples = buffer.getNumSamples();
+	const int numChannels = jmin(numBlockChannels, buffer.getNumChannels());
+	int start1, size1, start2, size2;
+
+	if (inputFifo.getFreeSpace() >= numSamples)
 	{
-		jl_function_t *func = jl_get_function(jl_main_module, "oe_process!");    
-	
-		// create 2D array of float64 type
-		jl_value_t *array_type = jl_apply_array_type(jl_float32_type, 1); // last arg is nDims
+		inputFifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+		for (int n = 0; n < numChannels; n++)
+		{
+			inputSamples.copyFrom(n, start1, buffer, n, 0, size1);
+			if (size2 > 0)
+				inputSamples.copyFrom(n, start2, buffer, n, size1, size2);
+		}
+		inputFifo.finishedWrite(size1 + size2);
+	}
+	else
+	{
+		numDroppedSamples += numSamples;
+	}
+
+	workToDo.signal();
+
+	// gives up after a second, so that a stuck script can't hang acquisition
+	if (!asynchronous)
+	{
+		while (outputFifo.getNumReady() < numSamples && blockDone.wait(1000))
+		{
+		}
+	}
 
-		for (int n = 0; n < getNumOutputs(); n++)
+	if (outputFifo.getNumReady() >= numSamples)
+	{
+		outputFifo.prepareToRead(numSamples, start1, size1, start2, size2);
+		for (int n = 0; n < numChannels; n++)
 		{
-			float* ptr = buffer.getWritePointer(n); // to perform in-place edits to the buffer
-			jl_array_t *x = jl_ptr_to_array_1d(array_type, ptr , buffer.getNumSamples(), 0);
-			JL_GC_PUSH1(&x);
-			jl_call1(func, (jl_value_t*)x);
-			JL_GC_POP();
+			buffer.copyFrom(n, 0, outputSamples, n, start1, size1);
+			if (size2 > 0)
+				buffer.copyFrom(n, size1, outputSamples, n, start2, size2);
 		}
+		outputFifo.finishedRead(size1 + size2);
 	}
+	else
+	{
+		// the first block in asynchronous mode, or Julia fell behind
+		for (int n = 0; n < numChannels; n++)
+			buffer.clear(n, 0, numSamples);
+	}
+}
+
+void JuliaProcessor::setAsynchronous(bool shouldRunAsynchronously)
+{
+    asynchronous = shouldRunAsynchronously;
+}
+
+bool JuliaProcessor::isAsynchronous() const
+{
+    return asynchronous;
 }
 
 void JuliaProcessor::saveCustomParametersToXml(XmlElement* parentElement)
 {
     XmlElement* childNode = parentElement->createNewChildElement("FILENAME");
     childNode->setAttribute("path", getFile());
+    childNode->setAttribute("asynchronous", asynchronous);
 }
 
 void JuliaProcessor::loadCustomParametersFromXml()
@@ -163,6 +372,7 @@ void JuliaProcessor::loadCustomParametersFromXml()
                 String filepath = xmlNode->getStringAttribute("path");
                 JuliaEditor* fre = (JuliaEditor*) getEditor();
                 fre->setFile(filepath);
+                fre->setAsynchronous(xmlNode->getBoolAttribute("asynchronous", false));
             }
         }
     }
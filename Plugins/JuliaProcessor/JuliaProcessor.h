@@ -25,15 +25,23 @@
 
 #include <ProcessorHeaders.h>
 
+struct _jl_value_t;
+
 /**
   Julia Processor.
 
   Allows the user to select a Julia Programming Language file to use as filter
 
+  Julia is only ever called from a thread of its own, which initialises it. Every block is
+  passed to oe_process! as a single samples x channels Float32 matrix. In synchronous
+  mode process() waits for the result; in asynchronous mode it returns the output of the
+  previous blocks, so Julia can take up to a block's time without stalling acquisition, at
+  the cost of one block of latency.
+
   @see GenericProcessor, JuliaEditor
 */
 
-class JuliaProcessor : public GenericProcessor
+class JuliaProcessor : public GenericProcessor, private Thread
 
 {
 public:
@@ -42,9 +50,11 @@ public:
     void setFile(String fullpath);
     String getFile();
     void reloadFile();
-    void process(AudioSampleBuffer& buffer, MidiBuffer& midiMessages);
+    void process(AudioSampleBuffer& buffer) override;
     void setParameter(int parameterIndex, float newValue);
     void setBuffersize(int bufferSize);
+    bool enable() override;
+    bool disable() override;
     AudioProcessorEditor* createEditor();
     bool hasEditor() const
     {
@@ -53,6 +63,10 @@ public:
     void saveCustomParametersToXml(XmlElement* parentElement);
     void loadCustomParametersFromXml();
 
+    /** Not to be changed while acquisition is active */
+    void setAsynchronous(bool shouldRunAsynchronously);
+    bool isAsynchronous() const;
+
 private:
     bool hasJuliaInstance;
     String filePath;
@@ -61,6 +75,37 @@ private:
     AudioSampleBuffer* dataHistoryBuffer;
     void run_julia_string(String juliaString);
 
+    // Julia thread
+    void run() override;
+    void initialiseJulia();
+    void runPendingCommands();
+    void processPendingSamples();
+
+    /** Julia code to run on the Julia thread before the next block */
+    CriticalSection commandLock;
+    StringArray pendingCommands;
+
+    WaitableEvent workToDo;
+    WaitableEvent blockDone;
+
+    bool asynchronous;
+
+    /** Samples on their way to and from the Julia thread, which holds blockLock while it uses them */
+    CriticalSection blockLock;
+    AbstractFifo inputFifo;
+    AbstractFifo outputFifo;
+    AudioSampleBuffer inputSamples;
+    AudioSampleBuffer outputSamples;
+    int numBlockChannels;
+    Atomic<int> numDroppedSamples;
+    Atomic<int> juliaReady;
+
+    // Julia thread only, looked up again each time a file is loaded
+    _jl_value_t* processFunction;
+    _jl_value_t* matrixType;
+    _jl_value_t* blockMatrix;
+    int blockMatrixSamples;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(JuliaProcessor);
 };
 
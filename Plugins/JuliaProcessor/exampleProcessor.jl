@@ -1,8 +1,8 @@
 # set things up here
-#global last=100
+global last=Float32[]
 
 # this function is called once per buffer upddate and is passed
-# the current buffer in data
+# the current buffer in data, a samples x channels matrix
 
 #data[:]=sin(data/tscale)*200;
 
@@ -11,11 +11,17 @@ function oe_process!(data)
 	
 	global last;	
 
+	if length(last) != size(data, 2)
+		last = zeros(Float32, size(data, 2));
+	end
+
 	f=0.05;
-	for i in eachindex(data)
-		
-		data[i]=f*data[i] + (1-f)*last;
-		last = data[i];
+	for ch in 1:size(data, 2)
+		for i in 1:size(data, 1)
+			
+			data[i, ch]=f*data[i, ch] + (1-f)*last[ch];
+			last[ch] = data[i, ch];
+		end
 	end
 
 end
\ No newline at end of file
@@ -0,0 +1,368 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "LatencyTester.h"
+#include "LatencyTesterEditor.h"
+
+// measurements waiting for the message thread; at a pulse every 10 ms that is 40 s
+#define MEASUREMENT_RING_SIZE 4096
+#define HISTOGRAM_BINS 20
+
+
+LatencyTester::LatencyTester()
+    : GenericProcessor  ("Latency Tester")
+    , clockChannel      (0)
+    , inputEvent        (-1)
+    , inputLine         (0)
+    , threshold         (1.0f)
+    , intervalMs        (500.0f)
+    , pulseMs           (10.0f)
+    , outputChannel     (nullptr)
+    , intervalSamples   (0)
+    , pulseSamples      (0)
+    , nextPulse         (-1)
+    , pulseEnd          (0)
+    , outputHigh        (false)
+    , inputHigh         (false)
+    , measurementFifo   (MEASUREMENT_RING_SIZE)
+    , numMissed         (0)
+    , numSpurious       (0)
+    , numDropped        (0)
+    , clockRate         (30000.0f)
+{
+    setProcessorType (PROCESSOR_TYPE_FILTER);
+    measurementRing.malloc (MEASUREMENT_RING_SIZE);
+}
+
+
+LatencyTester::~LatencyTester()
+{
+}
+
+
+AudioProcessorEditor* LatencyTester::createEditor()
+{
+    editor = new LatencyTesterEditor (this);
+    return editor;
+}
+
+
+void LatencyTester::createEventChannels()
+{
+    outputChannel = nullptr;
+    const DataChannel* clock = getDataChannel (clockChannel);
+    if (clock == nullptr)
+        return;
+
+    // the pulses carry the timestamps of the clock channel's stream, which is what the
+    // output processors schedule against
+    EventChannel* chan = new EventChannel (EventChannel::TTL, 1, 1, clock, this);
+    chan->setName ("Latency tester pulses");
+    chan->setDescription ("Pulses to loop back through an output into an input, to measure the latency");
+    chan->setIdentifier ("latencytester.pulse");
+    eventChannelArray.add (chan);
+    outputChannel = chan;
+}
+
+
+void LatencyTester::setParameter (int parameterIndex, float newValue)
+{
+    switch (parameterIndex)
+    {
+        case CLOCK_CHANNEL:
+            clockChannel = jmax (0, int (newValue));
+            break;
+        case INPUT_EVENT:
+            inputEvent = int (newValue);
+            break;
+        case INPUT_LINE:
+            inputLine = jmax (0, int (newValue));
+            break;
+        case THRESHOLD:
+            threshold = newValue;
+            break;
+        case INTERVAL_MS:
+            intervalMs = jmax (1.0f, newValue);
+            break;
+        case PULSE_MS:
+            pulseMs = jmax (0.1f, newValue);
+            break;
+        default:
+            break;
+    }
+}
+
+
+bool LatencyTester::enable()
+{
+    const DataChannel* clock = getDataChannel (clockChannel);
+    if (clock == nullptr || outputChannel == nullptr)
+    {
+        CoreServices::sendStatusMessage ("Latency tester: no clock channel");
+        return false;
+    }
+
+    clockRate = clock->getSampleRate();
+    intervalSamples = jmax (int64 (1), int64 (intervalMs * clockRate / 1000.0f));
+    // the pulse must end before the next one starts
+    pulseSamples = jlimit (int64 (1), jmax (int64 (1), intervalSamples - 1), int64 (pulseMs * clockRate / 1000.0f));
+
+    nextPulse = -1;
+    outputHigh = false;
+    inputHigh = false;
+    waitingPulses.clearQuick();
+    waitingPulses.ensureStorageAllocated (64);
+
+    measurementFifo.reset();
+    numMissed = 0;
+    numSpurious = 0;
+    numDropped = 0;
+    measurements.clearQuick();
+
+    return true;
+}
+
+
+bool LatencyTester::disable()
+{
+    collectMeasurements();
+    printReport (std::cout);
+    return true;
+}
+
+
+void LatencyTester::process (AudioSampleBuffer& buffer)
+{
+    const int clock = clockChannel;
+    const int numSamples = getNumSamples (clock);
+    const int64 timestamp = getTimestamp (clock);
+
+    if (nextPulse < 0)
+        nextPulse = timestamp + intervalSamples;
+
+    // inputs first, an edge in this block can't belong to a pulse emitted in it
+    if (inputEvent < 0)
+    {
+        const float* data = buffer.getReadPointer (clock);
+        const float level = threshold;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            // half the threshold to come back down, so noise on the edge counts once
+            if (! inputHigh && data[i] >= level)
+            {
+                inputHigh = true;
+                inputEdge (timestamp + i);
+            }
+            else if (inputHigh && data[i] < level * 0.5f)
+            {
+                inputHigh = false;
+            }
+        }
+    }
+    else
+    {
+        checkForEvents();
+    }
+
+    const int64 blockEnd = timestamp + numSamples;
+    for (;;)
+    {
+        if (outputHigh && pulseEnd < blockEnd)
+        {
+            addOutputEvent (false, pulseEnd, timestamp);
+            outputHigh = false;
+        }
+        else if (! outputHigh && nextPulse < blockEnd)
+        {
+            addOutputEvent (true, nextPulse, timestamp);
+            waitingPulses.add (nextPulse);
+            outputHigh = true;
+            pulseEnd = nextPulse + pulseSamples;
+            nextPulse += intervalSamples;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    expirePulses (blockEnd);
+}
+
+
+void LatencyTester::handleEvent (const EventChannel* eventInfo, const MidiMessage& event, int)
+{
+    const int index = inputEvent;
+    if (index < 0 || eventInfo != eventChannelArray[index] || eventInfo->getChannelType() != EventChannel::TTL)
+        return;
+
+    TTLEventView ttl (event, eventInfo);
+    if (ttl.isValid() && ttl.getChannel() == inputLine && ttl.getState())
+        inputEdge (ttl.getTimestamp());
+}
+
+
+void LatencyTester::addOutputEvent (bool state, int64 eventTimestamp, int64 blockTimestamp)
+{
+    const uint8 ttlData = state ? 1 : 0;
+    TTLEventPtr event = TTLEvent::createTTLEvent (outputChannel, eventTimestamp, &ttlData, sizeof (ttlData), 0);
+    addEvent (outputChannel, event, int (eventTimestamp - blockTimestamp));
+}
+
+
+void LatencyTester::inputEdge (int64 edgeTimestamp)
+{
+    expirePulses (edgeTimestamp);
+
+    if (waitingPulses.size() == 0 || waitingPulses[0] > edgeTimestamp)
+    {
+        ++numSpurious;
+        return;
+    }
+
+    int start1, size1, start2, size2;
+    measurementFifo.prepareToWrite (1, start1, size1, start2, size2);
+    if (size1 > 0)
+    {
+        measurementRing[start1].emitted = waitingPulses[0];
+        measurementRing[start1].detected = edgeTimestamp;
+        measurementFifo.finishedWrite (1);
+    }
+    else
+    {
+        ++numDropped;
+    }
+    waitingPulses.remove (0);
+}
+
+
+void LatencyTester::expirePulses (int64 now)
+{
+    // a pulse that didn't come back before the next one was due is lost
+    while (waitingPulses.size() > 0 && now - waitingPulses[0] > intervalSamples)
+    {
+        waitingPulses.remove (0);
+        ++numMissed;
+    }
+}
+
+
+void LatencyTester::collectMeasurements()
+{
+    int start1, size1, start2, size2;
+    measurementFifo.prepareToRead (measurementFifo.getNumReady(), start1, size1, start2, size2);
+    for (int i = 0; i < size1; ++i)
+        measurements.add (measurementRing[start1 + i]);
+    for (int i = 0; i < size2; ++i)
+        measurements.add (measurementRing[start2 + i]);
+    measurementFifo.finishedRead (size1 + size2);
+}
+
+
+double LatencyTester::toMs (int64 samples) const
+{
+    return 1000.0 * double (samples) / clockRate;
+}
+
+
+LatencyTester::Summary LatencyTester::getSummary() const
+{
+    Summary summary;
+    summary.numMeasured = measurements.size();
+    summary.numMissed = numMissed;
+    summary.numSpurious = numSpurious;
+    if (measurements.size() == 0)
+        return summary;
+
+    Array<int64> latencies;
+    latencies.ensureStorageAllocated (measurements.size());
+    int64 total = 0;
+    for (int i = 0; i < measurements.size(); ++i)
+    {
+        const int64 latency = measurements.getReference (i).detected - measurements.getReference (i).emitted;
+        latencies.add (latency);
+        total += latency;
+    }
+    latencies.sort();
+
+    const int n = latencies.size();
+    summary.minMs = toMs (latencies[0]);
+    summary.meanMs = toMs (total) / n;
+    summary.medianMs = toMs (latencies[n / 2]);
+    summary.p95Ms = toMs (latencies[jmin (n - 1, int (n * 0.95))]);
+    summary.p99Ms = toMs (latencies[jmin (n - 1, int (n * 0.99))]);
+    summary.maxMs = toMs (latencies[n - 1]);
+    return summary;
+}
+
+
+void LatencyTester::resetMeasurements()
+{
+    measurements.clear();
+    numMissed = 0;
+    numSpurious = 0;
+}
+
+
+bool LatencyTester::saveMeasurements (const File& file) const
+{
+    String text = "emitted_timestamp,input_timestamp,latency_ms\n";
+    for (int i = 0; i < measurements.size(); ++i)
+    {
+        const Measurement& m = measurements.getReference (i);
+        text << String (m.emitted) << "," << String (m.detected) << "," << String (toMs (m.detected - m.emitted), 3) << "\n";
+    }
+    return file.replaceWithText (text);
+}
+
+
+void LatencyTester::printReport (std::ostream& out) const
+{
+    Summary summary = getSummary();
+    out << "Latency tester: " << summary.numMeasured << " pulses measured, " << summary.numMissed << " missed, "
+        << summary.numSpurious << " spurious edges";
+    if (numDropped > 0)
+        out << ", " << numDropped << " measurements dropped";
+    out << std::endl;
+
+    if (summary.numMeasured == 0)
+        return;
+
+    out << "  min " << summary.minMs << " ms, mean " << summary.meanMs << " ms, median " << summary.medianMs
+        << " ms, p95 " << summary.p95Ms << " ms, p99 " << summary.p99Ms << " ms, max " << summary.maxMs << " ms" << std::endl;
+
+    // equal bins from min to max
+    const double width = jmax (toMs (1), (summary.maxMs - summary.minMs) / HISTOGRAM_BINS);
+    int counts[HISTOGRAM_BINS + 1] = { 0 };
+    for (int i = 0; i < measurements.size(); ++i)
+    {
+        const double ms = toMs (measurements.getReference (i).detected - measurements.getReference (i).emitted);
+        counts[jmin (HISTOGRAM_BINS, int ((ms - summary.minMs) / width))]++;
+    }
+    for (int b = 0; b <= HISTOGRAM_BINS; ++b)
+    {
+        if (counts[b] == 0)
+            continue;
+        out << "  " << String (summary.minMs + b * width, 3) << " ms: " << counts[b] << std::endl;
+    }
+}
@@ -0,0 +1,153 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __LATENCYTESTER_H_6E1A93D0__
+#define __LATENCYTESTER_H_6E1A93D0__
+
+#include <ProcessorHeaders.h>
+#include <atomic>
+
+/**
+    Measures the closed-loop latency of the rig: from the sample that triggers an
+    output to the sample at which the output pulse comes back in.
+
+    The tester emits a TTL pulse on its own event channel at a fixed interval. An
+    output processor placed after it (Arduino Output, Pulse Pal Output) is set to
+    follow that channel, and its physical output is wired back into an ADC or a
+    TTL input of the acquisition board. Every rising edge seen on that input is
+    paired with the oldest pulse still waiting, and the difference of the two
+    sample timestamps is the latency.
+
+    The input must come from the same stream as the clock channel, so both
+    timestamps count the same samples. Pulses not seen back within one interval
+    are counted as missed, and edges with no pulse waiting as spurious.
+
+    @see LatencyTesterEditor
+*/
+class LatencyTester : public GenericProcessor
+{
+public:
+    LatencyTester();
+    ~LatencyTester();
+
+    AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override { return true; }
+
+    void process (AudioSampleBuffer& buffer) override;
+    bool modifiesContinuousData() const override { return false; }
+
+    void createEventChannels() override;
+
+    void setParameter (int parameterIndex, float newValue) override;
+
+    bool enable() override;
+    bool disable() override;
+
+    enum Parameters
+    {
+        /** Data channel clocking the pulses, also the input in continuous mode */
+        CLOCK_CHANNEL = 0,
+        /** Index of the TTL event channel to watch, or -1 to watch the clock channel */
+        INPUT_EVENT,
+        INPUT_LINE,
+        /** Level of the returning pulse on the clock channel, in the channel's units */
+        THRESHOLD,
+        INTERVAL_MS,
+        PULSE_MS
+    };
+
+    struct Measurement
+    {
+        int64 emitted;
+        int64 detected;
+    };
+
+    struct Summary
+    {
+        int numMeasured{ 0 };
+        int64 numMissed{ 0 };
+        int64 numSpurious{ 0 };
+        double minMs{ 0 };
+        double meanMs{ 0 };
+        double medianMs{ 0 };
+        double p95Ms{ 0 };
+        double p99Ms{ 0 };
+        double maxMs{ 0 };
+    };
+
+    /** Moves the measurements of the audio thread to the message thread's list.
+    Called from the message thread. */
+    void collectMeasurements();
+
+    Summary getSummary() const;
+
+    /** Clears the measurements. Only while not acquiring. */
+    void resetMeasurements();
+
+    /** Writes one line per measurement: emit and input timestamps and latency in ms */
+    bool saveMeasurements (const File& file) const;
+
+    /** Prints the summary and a histogram of the latencies */
+    void printReport (std::ostream& out) const;
+
+private:
+    void handleEvent (const EventChannel* eventInfo, const MidiMessage& event, int sampleNum) override;
+
+    void addOutputEvent (bool state, int64 timestamp, int64 blockTimestamp);
+    void inputEdge (int64 timestamp);
+    void expirePulses (int64 now);
+
+    double toMs (int64 samples) const;
+
+    std::atomic<int> clockChannel;
+    std::atomic<int> inputEvent;
+    std::atomic<int> inputLine;
+    std::atomic<float> threshold;
+    float intervalMs;
+    float pulseMs;
+
+    const EventChannel* outputChannel;
+
+    // audio thread state
+    int64 intervalSamples;
+    int64 pulseSamples;
+    int64 nextPulse;
+    int64 pulseEnd;
+    bool outputHigh;
+    bool inputHigh;
+    Array<int64> waitingPulses;
+
+    // measurements handed to the message thread
+    AbstractFifo measurementFifo;
+    HeapBlock<Measurement> measurementRing;
+    std::atomic<int64> numMissed;
+    std::atomic<int64> numSpurious;
+    std::atomic<int64> numDropped;
+
+    Array<Measurement> measurements;
+    float clockRate;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LatencyTester);
+};
+
+#endif  // __LATENCYTESTER_H_6E1A93D0__
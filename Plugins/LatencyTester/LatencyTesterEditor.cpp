@@ -0,0 +1,296 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "LatencyTesterEditor.h"
+#include "LatencyTester.h"
+
+LatencyTesterEditor::LatencyTesterEditor (GenericProcessor* parentNode, bool useDefaultParameterEditors)
+    : GenericEditor (parentNode, useDefaultParameterEditors)
+    , tester (static_cast<LatencyTester*> (parentNode))
+{
+    desiredWidth = 300;
+
+    addSetting ("Clock", String(), 10, 25, false);
+    clockSelector = new ComboBox ("Clock channel");
+    clockSelector->setEditableText (false);
+    clockSelector->setJustificationType (Justification::centredLeft);
+    clockSelector->addListener (this);
+    clockSelector->setBounds (60, 25, 100, 18);
+    clockSelector->setTooltip ("Channel whose samples time the pulses");
+    addAndMakeVisible (clockSelector);
+
+    addSetting ("Input", String(), 10, 47, false);
+    inputSelector = new ComboBox ("Input");
+    inputSelector->setEditableText (false);
+    inputSelector->setJustificationType (Justification::centredLeft);
+    inputSelector->addListener (this);
+    inputSelector->setBounds (60, 47, 100, 18);
+    inputSelector->setTooltip ("Where the looped back pulses come in: the level of the clock channel, or a TTL line");
+    addAndMakeVisible (inputSelector);
+
+    thresholdLabel = addSetting ("Threshold", "1", 10, 69, true);
+    thresholdLabel->setTooltip ("Level of the returning pulse on the clock channel");
+    intervalLabel = addSetting ("Interval (ms)", "500", 10, 89, true);
+    pulseLabel = addSetting ("Pulse (ms)", "10", 10, 109, true);
+
+    countLabel = addSetting ("Pulses", "-", 175, 25, false);
+    medianLabel = addSetting ("Median", "-", 175, 41, false);
+    p99Label = addSetting ("p99", "-", 175, 57, false);
+    maxLabel = addSetting ("Max", "-", 175, 73, false);
+    missedLabel = addSetting ("Missed", "-", 175, 89, false);
+
+    saveButton = new UtilityButton ("SAVE", Font ("Small Text", 10, Font::plain));
+    saveButton->addListener (this);
+    saveButton->setBounds (180, 110, 50, 18);
+    saveButton->setTooltip ("Save every measurement as CSV");
+    addAndMakeVisible (saveButton);
+
+    resetButton = new UtilityButton ("RESET", Font ("Small Text", 10, Font::plain));
+    resetButton->addListener (this);
+    resetButton->setBounds (235, 110, 50, 18);
+    addAndMakeVisible (resetButton);
+}
+
+LatencyTesterEditor::~LatencyTesterEditor()
+{
+}
+
+Label* LatencyTesterEditor::addSetting (const String& name, const String& value, int x, int y, bool editable)
+{
+    Label* title = new Label (name, name);
+    title->setFont (Font ("Small Text", 10, Font::plain));
+    title->setBounds (x, y, editable ? 70 : 50, 18);
+    title->setColour (Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible (title);
+    staticLabels.add (title);
+
+    if (value.isEmpty())
+        return title;
+
+    Label* setting = new Label (name + " value", value);
+    setting->setFont (Font ("Small Text", 10, Font::plain));
+    setting->setColour (Label::textColourId, Colours::darkgrey);
+    if (editable)
+    {
+        setting->setEditable (true, false, false);
+        setting->addListener (this);
+        setting->setBounds (x + 75, y, 75, 18);
+        setting->setColour (Label::backgroundColourId, Colours::lightgrey);
+    }
+    else
+    {
+        setting->setBounds (x + 50, y, 70, 18);
+    }
+    addAndMakeVisible (setting);
+    return setting;
+}
+
+void LatencyTesterEditor::comboBoxChanged (ComboBox* comboBox)
+{
+    if (comboBox == clockSelector)
+    {
+        tester->setParameter (LatencyTester::CLOCK_CHANNEL, clockSelector->getSelectedId() - 1);
+        // the pulse channel takes the clock channel's stream
+        CoreServices::updateSignalChain (this);
+    }
+    else if (comboBox == inputSelector)
+    {
+        setInput();
+    }
+}
+
+void LatencyTesterEditor::setInput()
+{
+    const int index = inputSelector->getSelectedId() - 2;
+    if (index >= 0 && index < eventSourceArray.size())
+    {
+        //invalidate the input first so the event index and line always match
+        tester->setParameter (LatencyTester::INPUT_EVENT, -1);
+        tester->setParameter (LatencyTester::INPUT_LINE, eventSourceArray[index].channel);
+        tester->setParameter (LatencyTester::INPUT_EVENT, eventSourceArray[index].eventIndex);
+    }
+    else
+    {
+        tester->setParameter (LatencyTester::INPUT_EVENT, -1);
+    }
+    thresholdLabel->setEnabled (index < 0);
+}
+
+void LatencyTesterEditor::labelTextChanged (Label* label)
+{
+    if (label == thresholdLabel)
+    {
+        tester->setParameter (LatencyTester::THRESHOLD, label->getText().getFloatValue());
+    }
+    else if (label == intervalLabel)
+    {
+        float interval = jmax (1.0f, label->getText().getFloatValue());
+        label->setText (String (interval), dontSendNotification);
+        tester->setParameter (LatencyTester::INTERVAL_MS, interval);
+    }
+    else if (label == pulseLabel)
+    {
+        float pulse = jmax (0.1f, label->getText().getFloatValue());
+        label->setText (String (pulse), dontSendNotification);
+        tester->setParameter (LatencyTester::PULSE_MS, pulse);
+    }
+}
+
+void LatencyTesterEditor::buttonEvent (Button* button)
+{
+    if (button == saveButton)
+    {
+        FileChooser fc ("Save the latencies...",
+                        CoreServices::getDefaultUserSaveDirectory(),
+                        "*.csv",
+                        true);
+
+        if (fc.browseForFileToSave (true))
+        {
+            if (tester->saveMeasurements (fc.getResult()))
+                CoreServices::sendStatusMessage ("Saved latencies to " + fc.getResult().getFileName());
+            else
+                CoreServices::sendStatusMessage ("Could not write " + fc.getResult().getFileName());
+        }
+    }
+    else if (button == resetButton)
+    {
+        tester->resetMeasurements();
+        showSummary();
+    }
+}
+
+void LatencyTesterEditor::updateSettings()
+{
+    int oldClock = clockSelector->getSelectedId();
+    clockSelector->clear (dontSendNotification);
+    int nData = tester->getTotalDataChannels();
+    for (int i = 0; i < nData; i++)
+        clockSelector->addItem (tester->getDataChannel (i)->getName(), i + 1);
+    if (oldClock < 1 || oldClock > nData)
+        oldClock = 1;
+    clockSelector->setSelectedId (oldClock, dontSendNotification);
+    tester->setParameter (LatencyTester::CLOCK_CHANNEL, oldClock - 1);
+
+    EventSources s;
+    int oldInput = inputSelector->getSelectedId();
+    inputSelector->clear (dontSendNotification);
+    eventSourceArray.clear();
+    inputSelector->addItem ("Clock channel level", 1);
+    int nextItem = 2;
+    int nEvents = tester->getTotalEventChannels();
+    for (int i = 0; i < nEvents; i++)
+    {
+        const EventChannel* event = tester->getEventChannel (i);
+        // our own pulses can't be the input
+        if (event->getChannelType() != EventChannel::TTL || event->getSourceNodeID() == tester->getNodeId())
+            continue;
+
+        s.eventIndex = i;
+        int nChans = event->getNumChannels();
+        for (int c = 0; c < nChans; c++)
+        {
+            s.channel = c;
+            eventSourceArray.add (s);
+            inputSelector->addItem (event->getSourceName() + " (TTL" + String (c + 1) + ")", nextItem++);
+        }
+    }
+    if (oldInput < 1 || oldInput > inputSelector->getNumItems())
+        oldInput = 1;
+    inputSelector->setSelectedId (oldInput, dontSendNotification);
+    setInput();
+}
+
+void LatencyTesterEditor::updateFromProcessor()
+{
+    tester->collectMeasurements();
+    showSummary();
+}
+
+void LatencyTesterEditor::showSummary()
+{
+    LatencyTester::Summary summary = tester->getSummary();
+    countLabel->setText (String (summary.numMeasured), dontSendNotification);
+    missedLabel->setText (String (summary.numMissed) + " / " + String (summary.numSpurious), dontSendNotification);
+    missedLabel->setTooltip ("Pulses that never came back / edges with no pulse");
+
+    if (summary.numMeasured == 0)
+    {
+        medianLabel->setText ("-", dontSendNotification);
+        p99Label->setText ("-", dontSendNotification);
+        maxLabel->setText ("-", dontSendNotification);
+        return;
+    }
+    medianLabel->setText (String (summary.medianMs, 2) + " ms", dontSendNotification);
+    p99Label->setText (String (summary.p99Ms, 2) + " ms", dontSendNotification);
+    maxLabel->setText (String (summary.maxMs, 2) + " ms", dontSendNotification);
+}
+
+void LatencyTesterEditor::startAcquisition()
+{
+    clockSelector->setEnabled (false);
+    inputSelector->setEnabled (false);
+    thresholdLabel->setEnabled (false);
+    intervalLabel->setEnabled (false);
+    pulseLabel->setEnabled (false);
+    resetButton->setEnabled (false);
+}
+
+void LatencyTesterEditor::stopAcquisition()
+{
+    clockSelector->setEnabled (true);
+    inputSelector->setEnabled (true);
+    thresholdLabel->setEnabled (inputSelector->getSelectedId() == 1);
+    intervalLabel->setEnabled (true);
+    pulseLabel->setEnabled (true);
+    resetButton->setEnabled (true);
+}
+
+void LatencyTesterEditor::saveCustomParameters (XmlElement* xml)
+{
+    XmlElement* info = xml->createNewChildElement ("PARAMETERS");
+
+    info->setAttribute ("Type", "LatencyTesterEditor");
+    info->setAttribute ("Clock", clockSelector->getSelectedId());
+    info->setAttribute ("Input", inputSelector->getSelectedId());
+    info->setAttribute ("Threshold", thresholdLabel->getText().getFloatValue());
+    info->setAttribute ("Interval", intervalLabel->getText().getFloatValue());
+    info->setAttribute ("Pulse", pulseLabel->getText().getFloatValue());
+}
+
+void LatencyTesterEditor::loadCustomParameters (XmlElement* xml)
+{
+    forEachXmlChildElement (*xml, xmlNode)
+    {
+        if (xmlNode->hasTagName ("PARAMETERS"))
+        {
+            thresholdLabel->setText (String (xmlNode->getDoubleAttribute ("Threshold", 1.0)), sendNotificationSync);
+            intervalLabel->setText (String (xmlNode->getDoubleAttribute ("Interval", 500.0)), sendNotificationSync);
+            pulseLabel->setText (String (xmlNode->getDoubleAttribute ("Pulse", 10.0)), sendNotificationSync);
+
+            // the lists are filled by updateSettings, which keeps these selections
+            clockSelector->setSelectedId (xmlNode->getIntAttribute ("Clock", 1), dontSendNotification);
+            inputSelector->setSelectedId (xmlNode->getIntAttribute ("Input", 1), dontSendNotification);
+        }
+    }
+}
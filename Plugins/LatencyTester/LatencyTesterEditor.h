@@ -0,0 +1,86 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __LATENCYTESTEREDITOR_H_2B7C4E91__
+#define __LATENCYTESTEREDITOR_H_2B7C4E91__
+
+#include <EditorHeaders.h>
+
+class LatencyTester;
+
+/**
+
+  User interface for the LatencyTester processor.
+
+  Takes the clock channel, the input the pulses come back on and the pulse timing,
+  and shows the latency so far while acquiring.
+
+  @see LatencyTester
+
+*/
+
+class LatencyTesterEditor : public GenericEditor,
+    public ComboBox::Listener,
+    public Label::Listener
+{
+public:
+    LatencyTesterEditor (GenericProcessor* parentNode, bool useDefaultParameterEditors = true);
+    ~LatencyTesterEditor();
+
+    void comboBoxChanged (ComboBox* comboBox) override;
+    void labelTextChanged (Label* label) override;
+    void buttonEvent (Button* button) override;
+
+    void updateSettings() override;
+    void updateFromProcessor() override;
+
+    void startAcquisition() override;
+    void stopAcquisition() override;
+
+    void saveCustomParameters (XmlElement* xml) override;
+    void loadCustomParameters (XmlElement* xml) override;
+
+private:
+    struct EventSources
+    {
+        int eventIndex;
+        int channel;
+    };
+
+    Label* addSetting (const String& name, const String& value, int x, int y, bool editable);
+    void setInput();
+    void showSummary();
+
+    LatencyTester* tester;
+
+    Array<EventSources> eventSourceArray;
+    ScopedPointer<ComboBox> clockSelector, inputSelector;
+    ScopedPointer<Label> thresholdLabel, intervalLabel, pulseLabel;
+    ScopedPointer<Label> countLabel, medianLabel, p99Label, maxLabel, missedLabel;
+    ScopedPointer<UtilityButton> saveButton, resetButton;
+    OwnedArray<Label> staticLabels;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LatencyTesterEditor);
+};
+
+#endif  // __LATENCYTESTEREDITOR_H_2B7C4E91__
@@ -22,6 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "LfpDisplayCanvas.h"
+#include "LfpOpenGLDisplay.h"
 
 #include <math.h>
 
@@ -31,9 +32,14 @@ using namespace LfpViewer;
 
 #pragma mark - LfpDisplayCanvas -
 
+static int getNumDecimationThreads()
+{
+    return jmax(1, SystemStats::getNumCpus() / 2);
+}
+
 LfpDisplayCanvas::LfpDisplayCanvas(LfpDisplayNode* processor_) :
      timebase(1.0f), displayGain(1.0f),   timeOffset(0.0f), 
-    processor(processor_)
+    processor(processor_), decimationPool(getNumDecimationThreads())
 {
 
 	nChans = processor->getNumSubprocessorChannels();
@@ -72,6 +78,9 @@ LfpDisplayCanvas::LfpDisplayCanvas(LfpDisplayNode* processor_) :
     //viewport->getVerticalScrollBar()->addListener(this->scrollBarMoved(viewport->getVerticalScrollBar(), 1.0));
 
     addAndMakeVisible(viewport);
+
+    openGLDisplay = new LfpOpenGLDisplay(this, lfpDisplay, viewport);
+    addChildComponent(openGLDisplay);
     addAndMakeVisible(timescale);
     addAndMakeVisible(options);
 
@@ -79,6 +88,9 @@ LfpDisplayCanvas::LfpDisplayCanvas(LfpDisplayNode* processor_) :
 
     resizeSamplesPerPixelBuffer(nChans);
 
+    for (int i = 0; i < getNumDecimationThreads(); i++)
+        decimationJobs.add(new DecimationJob(*this));
+
     TopLevelWindow::getTopLevelWindow(0)->addKeyListener(this);
 
     optionsDrawerIsOpen = false;
@@ -87,6 +99,7 @@ LfpDisplayCanvas::LfpDisplayCanvas(LfpDisplayNode* processor_) :
 
 LfpDisplayCanvas::~LfpDisplayCanvas()
 {
+    decimationPool.removeAllJobs(true, -1);
 
     // de-allocate 3d-array samplesPerPixel [nChans][MAX_N_SAMP][MAX_N_SAMP_PER_PIXEL];
 
@@ -110,9 +123,23 @@ void LfpDisplayCanvas::resizeSamplesPerPixelBuffer(int numCh)
     // allocate samplesPerPixel, behaves like float samplesPerPixel[nChans][MAX_N_SAMP][MAX_N_SAMP_PER_PIXEL]
     //samplesPerPixel = (float***)malloc(nChans * sizeof(float **));
 
+    waitForDecimation();
+
     // 3D array: dimensions channels x samples x samples per pixel
     samplesPerPixel.clear();
     samplesPerPixel.resize(numCh);
+    sampleCountPerPixel.clear();
+    sampleCountPerPixel.resize(numCh + 1);
+
+    channelVisible.assign(numCh, 1);
+    channelStale.assign(numCh + 1, 0);
+
+    spikeRasterCrossings.clear();
+    spikeRasterCrossings.resize(numCh);
+    medianOffset.resize(numCh);
+    medianStep.resize(numCh);
+    spikeRasterCrossingsThreshold.resize(numCh);
+    resetColumnStatistics();
 
     //for(int i = 0; i < numCh; i++)
     //{
@@ -162,6 +189,10 @@ void LfpDisplayCanvas::resized()
     else
         options->setBounds(0, getHeight()-55, getWidth(), 55);
 
+    // the OpenGL surface is drawn over its siblings, so keep it clear of the options drawer
+    openGLDisplay->setBounds(leftmargin, viewport->getY(), viewport->getViewWidth()-leftmargin,
+                             jmin(viewport->getY()+viewport->getViewHeight(), options->getY())-viewport->getY());
+
 }
 
 void LfpDisplayCanvas::resizeToChannels(bool respectViewportPosition)
@@ -189,6 +220,7 @@ void LfpDisplayCanvas::beginAnimation()
 	if (true)
 	{
 
+		waitForDecimation();
 		displayBufferSize = displayBuffer->getNumSamples();
 
 		for (int i = 0; i < screenBufferIndex.size(); i++)
@@ -207,11 +239,13 @@ void LfpDisplayCanvas::endAnimation()
 		std::cout << "Ending animation." << std::endl;
 
 		stopCallbacks();
+		waitForDecimation();
 	}
 }
 
 void LfpDisplayCanvas::update()
 {
+    waitForDecimation();
     nChans = jmax(processor->getNumSubprocessorChannels(), 0);
 
     std::cout << "Num chans: " << nChans << std::endl;
@@ -306,6 +340,8 @@ void LfpDisplayCanvas::refreshState()
 {
     // called when the component's tab becomes visible again
 
+	waitForDecimation();
+
 	if (true)
 	{
 		for (int i = 0; i <= displayBufferIndex.size(); i++) // include event channel
@@ -320,6 +356,8 @@ void LfpDisplayCanvas::refreshState()
 
 void LfpDisplayCanvas::refreshScreenBuffer()
 {
+	waitForDecimation();
+
 	if (true)
 	{
 		for (int i = 0; i < screenBufferIndex.size(); i++)
@@ -329,198 +367,346 @@ void LfpDisplayCanvas::refreshScreenBuffer()
 		screenBufferMin->clear();
 		screenBufferMean->clear();
 		screenBufferMax->clear();
+		resetColumnStatistics();
+	}
+
+}
+
+void LfpDisplayCanvas::resetColumnStatistics()
+{
+	std::fill(medianOffset.begin(), medianOffset.end(), 0.0f);
+	std::fill(medianStep.begin(), medianStep.end(), -1.0f);
+	// NaN never equals the current threshold
+	std::fill(spikeRasterCrossingsThreshold.begin(), spikeRasterCrossingsThreshold.end(),
+		std::numeric_limits<float>::quiet_NaN());
+}
+
+void LfpDisplayCanvas::updateMedianOffset(int channel, float columnMean)
+{
+	float& median = medianOffset[channel];
+	float& step = medianStep[channel];
+
+	if (step < 0)
+	{
+		median = columnMean;
+		step = 0;
+		return;
+	}
+
+	// a step proportional to the typical deviation moves just as fast whatever the signal's scale,
+	// and stepping by the sign of the deviation settles where half the columns are on either side
+	const float deviation = columnMean - median;
+	step += 0.01f * (std::abs(deviation) - step);
+	median += deviation > 0 ? 0.05f * step : -0.05f * step;
+}
+
+LfpDisplayCanvas::DecimationJob::DecimationJob(LfpDisplayCanvas& c)
+	: ThreadPoolJob("LFP display decimation"), firstChannel(0), lastChannel(0), canvas(c)
+{}
+
+ThreadPoolJob::JobStatus LfpDisplayCanvas::DecimationJob::runJob()
+{
+	for (int channel = firstChannel; channel < lastChannel; channel++)
+		canvas.decimateChannel(channel);
+	return jobHasFinished;
+}
+
+bool LfpDisplayCanvas::isDecimating()
+{
+	for (auto* job : decimationJobs)
+	{
+		if (decimationPool.contains(job))
+			return true;
+	}
+	return false;
+}
+
+bool LfpDisplayCanvas::updateChannelVisibility()
+{
+	const Rectangle<int> viewArea = viewport->getViewArea();
+	bool staleChannelInView = false;
+
+	for (int i = 0, n = jmin(nChans, lfpDisplay->channels.size(), int(channelVisible.size())); i < n; i++)
+	{
+		LfpChannelDisplay* channel = lfpDisplay->channels[i];
+		const bool visible = channel->getEnabledState() && !channel->getHidden()
+			&& channel->getBounds().intersects(viewArea);
+
+		channelVisible[i] = visible;
+		staleChannelInView |= visible && channelStale[i];
 	}
 
+	return staleChannelInView;
+}
+
+void LfpDisplayCanvas::waitForDecimation()
+{
+	for (auto* job : decimationJobs)
+		decimationPool.waitForJobToFinish(job, -1);
 }
 
 void LfpDisplayCanvas::updateScreenBuffer()
 {
-	if (true)
+	// copy new samples from the displayBuffer into the screenBuffer. This runs on the
+	// decimation pool, split by channel, and is drawn on the next refresh() once all jobs are done.
+	// The displayBuffer is read without locking: the processor only advances the indices after
+	// writing the samples, at worst a frame shows samples that are being overwritten
+	decimationMaxSamples = lfpDisplay->getWidth() - leftmargin;
+
+	// this number is crucial: converting from samples to values (in px) for the screen buffer
+	decimationRatio = sampleRate * timebase / float(getWidth() - leftmargin - scrollBarThickness); // samples / pixel
+	decimationSpikeThreshold = lfpDisplay->getSpikeRasterThreshold();
+
+	const int numChannels = nChans + 1; // pull one extra channel for event display
+	const int numJobs = jmin(decimationJobs.size(), numChannels);
+
+	for (int i = 0; i < numJobs; i++)
 	{
-		// copy new samples from the displayBuffer into the screenBuffer
-		int maxSamples = lfpDisplay->getWidth() - leftmargin;
+		DecimationJob* job = decimationJobs[i];
+		job->firstChannel = numChannels * i / numJobs;
+		job->lastChannel = numChannels * (i + 1) / numJobs;
+		decimationPool.addJob(job, false);
+	}
+}
+
+void LfpDisplayCanvas::decimateChannel(int channel)
+{
 
-		ScopedLock displayLock(*processor->getMutex());
+		//if (channel == 0)
+		//	std::cout << sampleRate[channel] << std::endl;
 
-		for (int channel = 0; channel <= nChans; channel++) // pull one extra channel for event display
+		if (screenBufferIndex[channel] >= decimationMaxSamples) // wrap around if we reached right edge before
+			screenBufferIndex.set(channel, 0);
+
+		// a new raster threshold applies to the columns already on screen too
+		if (channel < nChans && spikeRasterCrossingsThreshold[channel] != decimationSpikeThreshold)
 		{
+			const float* minimum = screenBufferMin->getReadPointer(channel);
+			const float* mean = screenBufferMean->getReadPointer(channel);
+			char* crossings = spikeRasterCrossings[channel].data();
 
-			//if (channel == 0)
-			//	std::cout << sampleRate[channel] << std::endl;
+			for (int k = 0; k < decimationMaxSamples; k++)
+				crossings[k] = minimum[k] - mean[k] < decimationSpikeThreshold;
 
-			if (screenBufferIndex[channel] >= maxSamples) // wrap around if we reached right edge before
-				screenBufferIndex.set(channel, 0);
+			spikeRasterCrossingsThreshold[channel] = decimationSpikeThreshold;
+		}
 
-			// hold these values locally for each channel - is this a good idea?
-			int sbi = screenBufferIndex[channel];
-			int dbi = displayBufferIndex[channel];
+		// hold these values locally for each channel - is this a good idea?
+		int sbi = screenBufferIndex[channel];
+		int dbi = displayBufferIndex[channel];
 
-			
+		
 
-			lastScreenBufferIndex.set(channel, sbi);
+		lastScreenBufferIndex.set(channel, sbi);
 
-			int index = processor->getDisplayBufferIndex(channel);
+		int index = processor->getDisplayBufferIndex(channel);
 
-			int nSamples = index - dbi; // N new samples (not pixels) to be added to displayBufferIndex
+		int nSamples = index - dbi; // N new samples (not pixels) to be added to displayBufferIndex
 
-			if (nSamples < 0) // buffer has reset to 0 -- xxx 2do bug: this shouldnt happen because it makes the range/histogram display not work properly/look off for one pixel
-			{
-				nSamples = (displayBufferSize - dbi) + index + 1;
-				//  std::cout << "nsamples 0 " ;
-			}
+		if (nSamples < 0) // buffer has reset to 0 -- xxx 2do bug: this shouldnt happen because it makes the range/histogram display not work properly/look off for one pixel
+		{
+			nSamples = (displayBufferSize - dbi) + index + 1;
+			//  std::cout << "nsamples 0 " ;
+		}
 
-			//if (channel == 15 || channel == 16)
-			//     std::cout << channel << " " << sbi << " " << dbi << " " << nSamples << std::endl;
+		//if (channel == 15 || channel == 16)
+		//     std::cout << channel << " " << sbi << " " << dbi << " " << nSamples << std::endl;
 
 
-			float ratio = sampleRate * timebase / float(getWidth() - leftmargin - scrollBarThickness); // samples / pixel
-			// this number is crucial: converting from samples to values (in px) for the screen buffer
-			int valuesNeeded = (int) float(nSamples) / ratio; // N pixels needed for this update
+		const float ratio = decimationRatio;
+		const bool visible = channel == nChans || channelVisible[channel]; // the event channel is drawn on every channel
+		int valuesNeeded = (int) float(nSamples) / ratio; // N pixels needed for this update
 
-			if (sbi + valuesNeeded > maxSamples)  // crop number of samples to fit canvas width
-			{
-				valuesNeeded = maxSamples - sbi;
-			}
-			float subSampleOffset = 0.0;
-
-			dbi %= displayBufferSize; // make sure we're not overshooting
-			int nextPos = (dbi + 1) % displayBufferSize; //  position next to displayBufferIndex in display buffer to copy from
-
-			//         if (channel == 0)
-			//             std::cout << "Channel " 
-			//                       << channel << " : " 
-			//                       << sbi << " : " 
-			//                       << index << " : " 
-			//                       << dbi << " : " 
-			//                       << valuesNeeded << " : " 
-			//                       << ratio 
-			//                                     << std::endl;
-
-			if (valuesNeeded > 0 && valuesNeeded < 1000000)
+		if (sbi + valuesNeeded > decimationMaxSamples)  // crop number of samples to fit canvas width
+		{
+			valuesNeeded = decimationMaxSamples - sbi;
+		}
+		float subSampleOffset = 0.0;
+
+		dbi %= displayBufferSize; // make sure we're not overshooting
+		int nextPos = (dbi + 1) % displayBufferSize; //  position next to displayBufferIndex in display buffer to copy from
+
+		//         if (channel == 0)
+		//             std::cout << "Channel " 
+		//                       << channel << " : " 
+		//                       << sbi << " : " 
+		//                       << index << " : " 
+		//                       << dbi << " : " 
+		//                       << valuesNeeded << " : " 
+		//                       << ratio 
+		//                                     << std::endl;
+
+		if (valuesNeeded > 0 && valuesNeeded < 1000000)
+		{
+			for (int i = 0; i < valuesNeeded; i++) // also fill one extra sample for line drawing interpolation to match across draws
 			{
-				for (int i = 0; i < valuesNeeded; i++) // also fill one extra sample for line drawing interpolation to match across draws
+				//If paused don't update screen buffers, but update all indexes as needed
+				if (!lfpDisplay->isPaused)
+				{
+					dbi %= displayBufferSize; // just to be sure
+
+					if (visible)
+						decimatePixel(channel, sbi, dbi, nextPos, (float)subSampleOffset);
+					sbi++;
+				}
+
+				subSampleOffset += ratio;
+
+				while (subSampleOffset >= 1.0)
 				{
-					//If paused don't update screen buffers, but update all indexes as needed
-					if (!lfpDisplay->isPaused)
-					{
-						float gain = 1.0;
-						float alpha = (float)subSampleOffset;
-						float invAlpha = 1.0f - alpha;
-
-						screenBuffer->clear(channel, sbi, 1);
-						screenBufferMean->clear(channel, sbi, 1);
-						screenBufferMin->clear(channel, sbi, 1);
-						screenBufferMax->clear(channel, sbi, 1);
-
-						dbi %= displayBufferSize; // just to be sure
-
-						// update continuous data channels
-						if (channel != nChans)
-						{
-							// interpolate between two samples with invAlpha and alpha
-							screenBuffer->addFrom(channel, // destChannel
-								sbi, // destStartSample
-								displayBuffer->getReadPointer(channel, dbi), // source
-								1, // numSamples
-								invAlpha*gain); // gain
-
-
-							screenBuffer->addFrom(channel, // destChannel
-								sbi, // destStartSample
-								displayBuffer->getReadPointer(channel, nextPos), // source
-								1, // numSamples
-								alpha*gain); // gain
-						}
-						
-
-						// same thing again, but this time add the min,mean, and max of all samples in current pixel
-						float sample_min = 10000000;
-						float sample_max = -10000000;
-						float sample_mean = 0;
-
-						int nextpix = (dbi + (int)ratio + 1) % (displayBufferSize + 1); //  position to next pixels index
-
-						if (nextpix <= dbi) { // at the end of the displaybuffer, this can occur and it causes the display to miss one pixel woth of sample - this circumvents that
-							//    std::cout << "np " ;
-							nextpix = dbi;
-						}
-
-						for (int j = dbi; j < nextpix; j++)
-						{
-
-							float sample_current = displayBuffer->getSample(channel, j);
-							sample_mean = sample_mean + sample_current;
-
-							if (sample_min > sample_current)
-							{
-								sample_min = sample_current;
-							}
-
-							if (sample_max < sample_current)
-							{
-								sample_max = sample_current;
-							}
-
-						}
-
-						// update event channel
-						if (channel == nChans)
-						{
-							//std::cout << sample_max << std::endl;
-							screenBuffer->setSample(channel, sbi, sample_max);
-							//if (screenBuffer->getSample(channel, sbi - 1) != sample_max)
-							//	std::cout << "Sample changed" << std::endl;
-							//screenBuffer->setSample(channel, sbi, sample_max);
-						}
-
-						// similarly, for each pixel on the screen, we want a list of all values so we can draw a histogram later
-						// for simplicity, we'll just do this as 2d array, samplesPerPixel[px][samples]
-						// with an additional array sampleCountPerPixel[px] that holds the N samples per pixel
-						if (channel < nChans) // we're looping over one 'extra' channel for events above, so make sure not to loop over that one here
-						{
-							int c = 0;
-							for (int j = dbi; j < nextpix && c < MAX_N_SAMP_PER_PIXEL; j++)
-							{
-								float sample_current = displayBuffer->getSample(channel, j);
-								samplesPerPixel[channel][sbi][c] = sample_current;
-								c++;
-							}
-							if (c > 0){
-								sampleCountPerPixel[sbi] = c - 1; // save count of samples for this pixel
-							}
-							else{
-								sampleCountPerPixel[sbi] = 0;
-							}
-							sample_mean = sample_mean / c;
-							screenBufferMean->addSample(channel, sbi, sample_mean*gain);
-
-							screenBufferMin->addSample(channel, sbi, sample_min*gain);
-							screenBufferMax->addSample(channel, sbi, sample_max*gain);
-						}
-						sbi++;
-					}
-
-					subSampleOffset += ratio;
-
-					while (subSampleOffset >= 1.0)
-					{
-						if (++dbi > displayBufferSize)
-							dbi = 0;
-
-						nextPos = (dbi + 1) % displayBufferSize;
-						subSampleOffset -= 1.0;
-					}
+					if (++dbi > displayBufferSize)
+						dbi = 0;
 
+					nextPos = (dbi + 1) % displayBufferSize;
+					subSampleOffset -= 1.0;
 				}
 
-				// update values after we're done
-				screenBufferIndex.set(channel, sbi);
-				displayBufferIndex.set(channel, dbi);
 			}
 
+			// update values after we're done
+			screenBufferIndex.set(channel, sbi);
+			displayBufferIndex.set(channel, dbi);
+
+			if (!visible && !lfpDisplay->isPaused)
+				channelStale[channel] = true;
+		}
+
+		if (visible && channelStale[channel])
+		{
+			rebuildScreenBuffer(channel);
+			channelStale[channel] = false;
+		}
+}
+
+void LfpDisplayCanvas::rebuildScreenBuffer(int channel)
+{
+	// column k shows the pixel (sbi - k) columns before the most recent one, wrapping around the sweep
+	const int sbi = screenBufferIndex[channel];
+	const int dbi = displayBufferIndex[channel] % displayBufferSize;
+
+	for (int k = 0; k < decimationMaxSamples; k++)
+	{
+		const int columnsBack = k < sbi ? sbi - k : sbi + decimationMaxSamples - k;
+		const double samplesBack = columnsBack * double(decimationRatio);
+
+		if (samplesBack >= displayBufferSize - 1) // no longer in the display buffer
+		{
+			screenBuffer->clear(channel, k, 1);
+			screenBufferMean->clear(channel, k, 1);
+			screenBufferMin->clear(channel, k, 1);
+			screenBufferMax->clear(channel, k, 1);
+			sampleCountPerPixel[channel][k] = 0;
+			continue;
 		}
+
+		double position = dbi - samplesBack;
+		if (position < 0)
+			position += displayBufferSize;
+
+		const int pos = int(position);
+		decimatePixel(channel, k, pos, (pos + 1) % displayBufferSize, float(position - pos));
 	}
+}
+
+void LfpDisplayCanvas::decimatePixel(int channel, int sbi, int dbi, int nextPos, float alpha)
+{
+	float gain = 1.0;
+	float invAlpha = 1.0f - alpha;
+
+	screenBuffer->clear(channel, sbi, 1);
+	screenBufferMean->clear(channel, sbi, 1);
+	screenBufferMin->clear(channel, sbi, 1);
+	screenBufferMax->clear(channel, sbi, 1);
+
+	// update continuous data channels
+	if (channel != nChans)
+	{
+		// interpolate between two samples with invAlpha and alpha
+		screenBuffer->addFrom(channel, // destChannel
+			sbi, // destStartSample
+			displayBuffer->getReadPointer(channel, dbi), // source
+			1, // numSamples
+			invAlpha*gain); // gain
+
+
+		screenBuffer->addFrom(channel, // destChannel
+			sbi, // destStartSample
+			displayBuffer->getReadPointer(channel, nextPos), // source
+			1, // numSamples
+			alpha*gain); // gain
+	}
+	
+
+	// same thing again, but this time add the min,mean, and max of all samples in current pixel
+	float sample_min = 10000000;
+	float sample_max = -10000000;
+	float sample_mean = 0;
+
+	int nextpix = (dbi + (int)decimationRatio + 1) % (displayBufferSize + 1); //  position to next pixels index
+
+	if (nextpix <= dbi) { // at the end of the displaybuffer, this can occur and it causes the display to miss one pixel woth of sample - this circumvents that
+		//    std::cout << "np " ;
+		nextpix = dbi;
+	}
+
+	for (int j = dbi; j < nextpix; j++)
+	{
+
+		float sample_current = displayBuffer->getSample(channel, j);
+		sample_mean = sample_mean + sample_current;
+
+		if (sample_min > sample_current)
+		{
+			sample_min = sample_current;
+		}
+
+		if (sample_max < sample_current)
+		{
+			sample_max = sample_current;
+		}
+
+	}
+
+	// update event channel
+	if (channel == nChans)
+	{
+		//std::cout << sample_max << std::endl;
+		screenBuffer->setSample(channel, sbi, sample_max);
+		//if (screenBuffer->getSample(channel, sbi - 1) != sample_max)
+		//	std::cout << "Sample changed" << std::endl;
+		//screenBuffer->setSample(channel, sbi, sample_max);
+	}
+
+	// similarly, for each pixel on the screen, we want a list of all values so we can draw a histogram later
+	// for simplicity, we'll just do this as 2d array, samplesPerPixel[px][samples]
+	// with an additional array sampleCountPerPixel[px] that holds the N samples per pixel
+	if (channel < nChans) // we're looping over one 'extra' channel for events above, so make sure not to loop over that one here
+	{
+		int c = 0;
+		for (int j = dbi; j < nextpix && c < MAX_N_SAMP_PER_PIXEL; j++)
+		{
+			float sample_current = displayBuffer->getSample(channel, j);
+			samplesPerPixel[channel][sbi][c] = sample_current;
+			c++;
+		}
+		if (c > 0){
+			sampleCountPerPixel[channel][sbi] = c - 1; // save count of samples for this pixel
+		}
+		else{
+			sampleCountPerPixel[channel][sbi] = 0;
+		}
+		sample_mean = sample_mean / c;
+		screenBufferMean->addSample(channel, sbi, sample_mean*gain);
+
+		screenBufferMin->addSample(channel, sbi, sample_min*gain);
+		screenBufferMax->addSample(channel, sbi, sample_max*gain);
+
+		// the maximum is never further below the mean than the minimum
+		spikeRasterCrossings[channel][sbi] = c > 0 && (sample_min - sample_mean) * gain < decimationSpikeThreshold;
 
+		if (c > 0)
+			updateMedianOffset(channel, sample_mean*gain);
+	}
 }
 
 const float LfpDisplayCanvas::getXCoord(int chan, int samp)
@@ -565,9 +751,9 @@ std::array<float, MAX_N_SAMP_PER_PIXEL> LfpDisplayCanvas::getSamplesPerPixel(int
 {
     return samplesPerPixel[chan][px];
 }
-const int LfpDisplayCanvas::getSampleCountPerPixel(int px)
+const int LfpDisplayCanvas::getSampleCountPerPixel(int chan, int px)
 {
-    return sampleCountPerPixel[px];
+    return sampleCountPerPixel[chan][px];
 }
 
 float LfpDisplayCanvas::getMean(int chan)
@@ -588,6 +774,16 @@ float LfpDisplayCanvas::getMean(int chan)
     return total / numPts;
 }
 
+float LfpDisplayCanvas::getMedianOffset(int chan)
+{
+    return medianOffset[chan];
+}
+
+bool LfpDisplayCanvas::getSpikeRasterCrossing(int chan, int samp)
+{
+    return spikeRasterCrossings[chan][samp] != 0;
+}
+
 float LfpDisplayCanvas::getStd(int chan)
 {
     float std = 0.0f;
@@ -634,6 +830,17 @@ void LfpDisplayCanvas::setDrawableSubprocessor(uint32 sp)
 	update();
 }
 
+void LfpDisplayCanvas::setOpenGLDrawing(bool state)
+{
+    openGLDisplay->setActive(state);
+    redraw();
+}
+
+LfpOpenGLDisplay* LfpDisplayCanvas::getOpenGLDisplay()
+{
+    return openGLDisplay;
+}
+
 void LfpDisplayCanvas::redraw()
 {
     fullredraw=true;
@@ -680,12 +887,15 @@ void LfpDisplayCanvas::paint(Graphics& g)
 
 void LfpDisplayCanvas::refresh()
 {
-	if (true)
-	{ 
-    updateScreenBuffer();
+    if (isDecimating())
+        return; // don't wait on the workers, the previous frame is drawn on the next tick
 
-    lfpDisplay->refresh(); // redraws only the new part of the screen buffer
-	}
+    if (updateChannelVisibility())
+        fullredraw = true; // channels scrolled into view are decimated again first and drawn on the next tick
+    else
+        lfpDisplay->refresh(); // redraws only the part of the screen buffer decimated since the last tick
+
+    updateScreenBuffer();
 }
 
 bool LfpDisplayCanvas::keyPressed(const KeyPress& key)
@@ -1100,6 +1310,16 @@ LfpDisplayOptions::LfpDisplayOptions(LfpDisplayCanvas* canvas_, LfpTimescale* ti
     drawMethodButton->setClickingTogglesState(true);
     drawMethodButton->setToggleState(false, sendNotification);
     addAndMakeVisible(drawMethodButton);
+
+    //button for drawing the traces with OpenGL instead of the bitmap plotters
+    openGLButton = new UtilityButton("OpenGL", Font("Small Text", 13, Font::plain));
+    openGLButton->setRadius(5.0f);
+    openGLButton->setEnabledState(true);
+    openGLButton->setCorners(true, true, true, true);
+    openGLButton->addListener(this);
+    openGLButton->setClickingTogglesState(true);
+    openGLButton->setToggleState(false, dontSendNotification);
+    addAndMakeVisible(openGLButton);
     
     // two sliders for the two histogram components of the supersampled plotting mode
     // todo: rename these
@@ -1201,6 +1421,7 @@ void LfpDisplayOptions::resized()
 
     invertInputButton->setBounds(35,getHeight()-190,100,22);
     drawMethodButton->setBounds(35,getHeight()-160,100,22);
+    openGLButton->setBounds(35,getHeight()-130,100,22);
 
     pauseButton->setBounds(450,getHeight()-50,50,44);
     
@@ -1442,6 +1663,11 @@ void LfpDisplayOptions::buttonClicked(Button* b)
         }
         return;
     }
+    if (b == openGLButton)
+    {
+        canvas->setOpenGLDrawing(b->getToggleState());
+        return;
+    }
     if (b == drawMethodButton)
     {
         lfpDisplay->setDrawMethod(b->getToggleState()); // this should be done the same way as drawClipWarning - or the other way around.
@@ -1896,6 +2122,7 @@ void LfpDisplayOptions::saveParameters(XmlElement* xml)
     xmlNode->setAttribute("colorGrouping",colorGroupingSelection->getSelectedId());
     xmlNode->setAttribute("isInverted",invertInputButton->getToggleState());
     xmlNode->setAttribute("drawMethod",drawMethodButton->getToggleState());
+    xmlNode->setAttribute("openGL",openGLButton->getToggleState());
 
     int eventButtonState = 0;
 
@@ -1971,6 +2198,8 @@ void LfpDisplayOptions::loadParameters(XmlElement* xml)
 
             drawMethodButton->setToggleState(xmlNode->getBoolAttribute("drawMethod", true), sendNotification);
 
+            openGLButton->setToggleState(xmlNode->getBoolAttribute("openGL", false), sendNotification);
+
             canvas->viewport->setViewPosition(xmlNode->getIntAttribute("ScrollX"),
                                       xmlNode->getIntAttribute("ScrollY"));
 
@@ -2454,6 +2683,21 @@ void LfpDisplay::refresh()
     
     if (fillfrom<0){fillfrom=0;};
     if (fillto>lfpChannelBitmap.getWidth()){fillto=lfpChannelBitmap.getWidth();};
+
+    if (canvas->getOpenGLDisplay()->isActive())
+    {
+        // the traces are drawn by the OpenGL display, over the viewport
+        canvas->getOpenGLDisplay()->update(fillfrom, fillto, canvas->fullredraw);
+
+        if (canvas->fullredraw)
+        {
+            for (int i = 0; i < numChans; i++)
+                channelInfo[i]->repaint();
+        }
+
+        canvas->fullredraw = false;
+        return;
+    }
     
     int topBorder = viewport->getViewPositionY();
     int bottomBorder = viewport->getViewHeight() + topBorder;
@@ -3237,6 +3481,7 @@ void LfpChannelDisplay::pxPaint()
     }
     
     bool drawWithOffsetCorrection = display->getMedianOffsetPlotting();
+    const double offset = drawWithOffsetCorrection ? canvas->getMedianOffset(chan)/range*channelHeightFloat : 0.0;
     
     LfpBitmapPlotterInfo plotterInfo; // hold and pass plotting info for each plotting method class
     
@@ -3297,12 +3542,10 @@ void LfpChannelDisplay::pxPaint()
             double a = (canvas->getYCoordMax(chan, i)/range*channelHeightFloat);
             double b = (canvas->getYCoordMin(chan, i)/range*channelHeightFloat);
             
-            double mean = (canvas->getMean(chan)/range*channelHeightFloat);
-            
             if (drawWithOffsetCorrection)
             {
-                a -= mean;
-                b -= mean;
+                a -= offset;
+                b -= offset;
             }
             
             double a_raw = canvas->getYCoordMax(chan, i);
@@ -3341,8 +3584,7 @@ void LfpChannelDisplay::pxPaint()
             
             bool spikeFlag = display->getSpikeRasterPlotting()
                 && !(saturateWarningHi || saturateWarningLo)
-                && (from_raw - canvas->getYCoordMean(chan, i) < display->getSpikeRasterThreshold()
-                        || to_raw - canvas->getYCoordMean(chan, i) < display->getSpikeRasterThreshold());
+                && canvas->getSpikeRasterCrossing(chan, i);
             
             from = from + getHeight()/2;       // so the plot is centered in the channeldisplay
             to = to + getHeight()/2;
@@ -3360,7 +3602,7 @@ void LfpChannelDisplay::pxPaint()
                 plotterInfo.lineColourDark = lineColourDark;
                 plotterInfo.range = range;
                 plotterInfo.channelHeightFloat = channelHeightFloat;
-                plotterInfo.sampleCountPerPixel = canvas->getSampleCountPerPixel(i);
+                plotterInfo.sampleCountPerPixel = canvas->getSampleCountPerPixel(chan, i);
                 plotterInfo.samplesPerPixel = canvas->getSamplesPerPixel(chan, i);
                 plotterInfo.histogramParameterA = canvas->histogramParameterA;
                 plotterInfo.samplerange = samplerange;
@@ -49,6 +49,7 @@ class LfpBitmapPlotter;
 class PerPixelBitmapPlotter;
 class SupersampledBitmapPlotter;
 class LfpChannelColourScheme;
+class LfpOpenGLDisplay;
 
     
     
@@ -123,11 +124,17 @@ public:
         this canvas */
     void setDrawableSubprocessor(uint32 sp);
 
+    /** Switches between the OpenGL trace display and the bitmap plotters */
+    void setOpenGLDrawing(bool state);
+
+    /** Returns the OpenGL trace display, drawing only if it is active */
+    LfpOpenGLDisplay* getOpenGLDisplay();
+
     const float getXCoord(int chan, int samp);
     const float getYCoord(int chan, int samp);
     
     std::array<float, MAX_N_SAMP_PER_PIXEL> getSamplesPerPixel(int chan, int px);
-    const int getSampleCountPerPixel(int px);
+    const int getSampleCountPerPixel(int chan, int px);
     
     const float getYCoordMin(int chan, int samp);
     const float getYCoordMean(int chan, int samp);
@@ -136,6 +143,12 @@ public:
     float getMean(int chan);
     float getStd(int chan);
 
+    /** Running median of the channel's column means, kept up to date by the decimation */
+    float getMedianOffset(int chan);
+
+    /** True if the column's minimum is below its mean by more than the spike raster threshold */
+    bool getSpikeRasterCrossing(int chan, int samp);
+
     Array<int> screenBufferIndex;
     Array<int> lastScreenBufferIndex;
 
@@ -198,8 +211,45 @@ private:
     
     ScopedPointer<LfpDisplayOptions> options;
 
+    ScopedPointer<LfpOpenGLDisplay> openGLDisplay;
+
     void refreshScreenBuffer();
+
+    /** Decimates a range of channels from the displayBuffer into the screen buffers on the decimation pool */
+    class DecimationJob : public ThreadPoolJob
+    {
+    public:
+        DecimationJob(LfpDisplayCanvas& canvas);
+        JobStatus runJob() override;
+
+        int firstChannel;
+        int lastChannel;
+
+    private:
+        LfpDisplayCanvas& canvas;
+    };
+
+    /** Starts decimating the new samples of every channel in the background */
     void updateScreenBuffer();
+    void decimateChannel(int channel);
+    /** Computes one screen buffer column of a channel from the display buffer at dbi */
+    void decimatePixel(int channel, int sbi, int dbi, int nextPos, float alpha);
+    /** Decimates every column of a channel again, for channels that weren't visible while they scrolled */
+    void rebuildScreenBuffer(int channel);
+    bool isDecimating();
+    /** Works out which channels intersect the viewport, returns true if one of them needs rebuilding */
+    bool updateChannelVisibility();
+    /** Must be called before anything but refresh() touches the screen buffers */
+    void waitForDecimation();
+
+    int decimationMaxSamples; // set by updateScreenBuffer() for the running jobs
+    float decimationRatio;
+    float decimationSpikeThreshold;
+
+    /** Moves the running median of a channel towards a new column mean */
+    void updateMedianOffset(int channel, float columnMean);
+    /** Clears the running medians and marks every channel's crossings to be computed again */
+    void resetColumnStatistics();
 
     Array<int> displayBufferIndex;
     int displayBufferSize;
@@ -212,7 +262,21 @@ private:
 	void resizeSamplesPerPixelBuffer(int numChannels);
     std::vector<std::array<std::array<float, MAX_N_SAMP_PER_PIXEL>, MAX_N_SAMP>> samplesPerPixel;
 
-    int sampleCountPerPixel[MAX_N_SAMP];
+    std::vector<std::array<int, MAX_N_SAMP>> sampleCountPerPixel;
+
+    // statistics kept by the decimation, so drawing doesn't scan the screen buffer every frame
+    std::vector<float> medianOffset;
+    std::vector<float> medianStep; // follows the typical deviation from the median, negative before the first column
+    std::vector<std::array<char, MAX_N_SAMP>> spikeRasterCrossings;
+    std::vector<float> spikeRasterCrossingsThreshold; // threshold each channel's crossings were computed at
+
+    // only channels in the viewport are decimated; the others just advance their indices
+    // and are marked stale, to be rebuilt from the display buffer when they come into view
+    std::vector<char> channelVisible;
+    std::vector<char> channelStale;
+
+    OwnedArray<DecimationJob> decimationJobs;
+    ThreadPool decimationPool;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LfpDisplayCanvas);
 
@@ -352,6 +416,7 @@ private:
     ScopedPointer<ComboBox> colorGroupingSelection;
     ScopedPointer<UtilityButton> invertInputButton;
     ScopedPointer<UtilityButton> drawMethodButton;
+    ScopedPointer<UtilityButton> openGLButton;
     ScopedPointer<UtilityButton> pauseButton;
     OwnedArray<UtilityButton> typeButtons;
     
@@ -671,6 +736,7 @@ private:
  */
 class LfpChannelDisplay : public Component
 {
+    friend class LfpOpenGLDisplay;
 public:
     LfpChannelDisplay(LfpDisplayCanvas*, LfpDisplay*, LfpDisplayOptions*, int channelNumber);
     ~LfpChannelDisplay();
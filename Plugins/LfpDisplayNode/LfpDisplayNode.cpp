@@ -30,6 +30,7 @@ using namespace LfpViewer;
 
 LfpDisplayNode::LfpDisplayNode()
     : GenericProcessor  ("LFP Viewer")
+    , numDisplayBufferChannels (0)
     , displayGain       (1)
     , bufferLength      (10.0f)
     , abstractFifo      (100)
@@ -196,11 +197,11 @@ bool LfpDisplayNode::resizeBuffer()
 	if (nSamples > 0 && nInputs > 0)
 	{
 		abstractFifo.setTotalSize(nSamples);
-		displayBuffer->setSize(nInputs + 1, nSamples); // add extra channel for TTLs
-		displayBuffer->clear();
+		displayMemory.allocateAudioBuffer(*displayBuffer, nInputs + 1, nSamples); // add extra channel for TTLs
 
-		displayBufferIndex.clear();
-		displayBufferIndex.insertMultiple(0, 0, nInputs + 1);
+		// only called while acquisition is stopped, so the canvas isn't reading the indices
+		displayBufferIndex.calloc(nInputs + 1);
+		numDisplayBufferChannels = nInputs + 1;
 
 		return true;
 	}
@@ -212,6 +213,14 @@ bool LfpDisplayNode::resizeBuffer()
 }
 
 
+void LfpDisplayNode::getMemoryUsage (MemoryUsage& usage) const
+{
+	GenericProcessor::getMemoryUsage (usage);
+
+	usage.add ("Display buffer", displayMemory.getSize() + numDisplayBufferChannels * sizeof (Atomic<int>));
+}
+
+
 bool LfpDisplayNode::enable()
 {
 
@@ -288,7 +297,7 @@ void LfpDisplayNode::handleEvent(const EventChannel* eventInfo, const MidiMessag
         if (eventSourceNodeId == subprocessorToDraw)
         {
             const int chan          = numChannelsInSubprocessor[eventSourceNodeId];
-            const int index         = (displayBufferIndex[chan] + eventTime) % displayBuffer->getNumSamples();
+            const int index         = (displayBufferIndex[chan].get() + eventTime) % displayBuffer->getNumSamples();
             const int samplesLeft   = displayBuffer->getNumSamples() - index;
             const int nSamples      = getNumSourceSamples(eventSourceNodeId) - eventTime;
 
@@ -332,7 +341,7 @@ void LfpDisplayNode::initializeEventChannels()
 	//std::cout << "Initializing events..." << std::endl;
 
     const int chan          = numChannelsInSubprocessor[subprocessorToDraw];
-    const int index         = displayBufferIndex[chan];
+    const int index         = displayBufferIndex[chan].get();
     const int samplesLeft   = displayBuffer->getNumSamples() - index;
 	const int nSamples      = getNumSourceSamples(subprocessorToDraw);
 
@@ -368,7 +377,7 @@ void LfpDisplayNode::initializeEventChannels()
 void LfpDisplayNode::finalizeEventChannels()
 {
     const int chan          = numChannelsInSubprocessor[subprocessorToDraw];
-    const int index         = displayBufferIndex[chan];
+    const int index         = displayBufferIndex[chan].get();
     const int samplesLeft   = displayBuffer->getNumSamples() - index;
     const int nSamples      = getNumSourceSamples(subprocessorToDraw);
         
@@ -383,7 +392,7 @@ void LfpDisplayNode::finalizeEventChannels()
         newIdx = nSamples - samplesLeft;
     }
         
-    displayBufferIndex.set(chan, newIdx);
+    displayBufferIndex[chan].set(newIdx); // publishes the event samples to the canvas
 }
 
 
@@ -392,10 +401,10 @@ void LfpDisplayNode::process (AudioSampleBuffer& buffer)
     // 1. place any new samples into the displayBuffer
     //std::cout << "Display node sample count: " << nSamples << std::endl; ///buffer.getNumSamples() << std::endl;
 
+	// No lock here: the canvas reads the display buffer concurrently and may occasionally
+	// see a partly overwritten frame, but acquisition never waits on the GUI.
 	if (true)
 	{
-		ScopedLock displayLock(displayMutex);
-
 		if (true)
 		{
 			initializeEventChannels();
@@ -412,26 +421,27 @@ void LfpDisplayNode::process (AudioSampleBuffer& buffer)
 				if (getDataSubprocId(chan) == subprocessorToDraw)
 				{
 					channelIndex++;
-					const int samplesLeft = displayBuffer->getNumSamples() - displayBufferIndex[channelIndex];
+					const int index = displayBufferIndex[channelIndex].get();
+					const int samplesLeft = displayBuffer->getNumSamples() - index;
 					const int nSamples = getNumSamples(chan);
 
 					if (nSamples < samplesLeft)
 					{
 						displayBuffer->copyFrom(channelIndex,                      // destChannel
-							displayBufferIndex[channelIndex],  // destStartSample
+							index,                     // destStartSample
 							buffer,                    // source
 							chan,                      // source channel
 							0,                         // source start sample
 							nSamples);                 // numSamples
 
-						displayBufferIndex.set(channelIndex, displayBufferIndex[channelIndex] + nSamples);
+						displayBufferIndex[channelIndex].set(index + nSamples);
 					}
 					else
 					{
 						const int extraSamples = nSamples - samplesLeft;
 
 						displayBuffer->copyFrom(channelIndex,                      // destChannel
-							displayBufferIndex[channelIndex],  // destStartSample
+							index,                     // destStartSample
 							buffer,                    // source
 							chan,                      // source channel
 							0,                         // source start sample
@@ -444,7 +454,7 @@ void LfpDisplayNode::process (AudioSampleBuffer& buffer)
 							samplesLeft,               // source start sample
 							extraSamples);             // numSamples
 
-						displayBufferIndex.set(channelIndex, extraSamples);
+						displayBufferIndex[channelIndex].set(extraSamples);
 					}
 				}
 			}
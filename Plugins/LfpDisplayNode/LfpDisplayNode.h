@@ -52,11 +52,15 @@ public:
     AudioProcessorEditor* createEditor() override;
 
     void process (AudioSampleBuffer& buffer) override;
+    bool modifiesContinuousData() const override { return false; }
+    bool emitsEvents() const override { return false; }
 
     void setParameter (int parameterIndex, float newValue) override;
 
     void updateSettings() override;
 
+    void getMemoryUsage (MemoryUsage& usage) const override;
+
     bool enable()   override;
     bool disable()  override;
 
@@ -64,9 +68,13 @@ public:
 
     AudioSampleBuffer* getDisplayBufferAddress() const { return displayBuffer; }
 
-    int getDisplayBufferIndex (int chan) const { return displayBufferIndex[chan]; }
-
-    CriticalSection* getMutex() { return &displayMutex; }
+    /** Position the next sample of a channel will be written to. The display buffer is only
+        written by the audio thread, which publishes a channel's samples by advancing this
+        index, so the canvas can read it without locking. */
+    int getDisplayBufferIndex (int chan) const
+    {
+        return isPositiveAndBelow (chan, numDisplayBufferChannels) ? displayBufferIndex[chan].get() : 0;
+    }
 
 	void setSubprocessor(uint32 sp);
     uint32 getSubprocessor() const;
@@ -82,8 +90,10 @@ private:
     void finalizeEventChannels();
 
     ScopedPointer<AudioSampleBuffer> displayBuffer;
+    LockedMemoryBlock displayMemory;
 
-    Array<int> displayBufferIndex;
+    HeapBlock<Atomic<int>> displayBufferIndex;
+    int numDisplayBufferChannels;
     Array<uint32> eventSourceNodes;
 
     float displayGain; //
@@ -103,8 +113,6 @@ private:
 	std::map<uint32, int> numChannelsInSubprocessor;
 	std::map<uint32, float> subprocessorSampleRate;
 
-    CriticalSection displayMutex;
-
     static uint32 getEventSourceId(const EventChannel* event);
     static uint32 getChannelSourceId(const InfoObjectCommon* chan);
 
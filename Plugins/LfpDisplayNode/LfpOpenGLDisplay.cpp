@@ -0,0 +1,390 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2013 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "LfpOpenGLDisplay.h"
+#include "LfpDisplayCanvas.h"
+
+using namespace LfpViewer;
+
+// a sample value far outside of any channel, clipped to its full height
+static const GLfloat fullHeight = 1.0e6f;
+
+static const char* vertexShaderSource =
+    "attribute vec2 position;\n" // pixel column, and which end of the column's line (-1 or 1)
+    "attribute vec2 sample;\n" // sample value, and its visibility (the event bits for an event trace)
+    "uniform vec2 viewSize;\n"
+    "uniform float centre;\n"
+    "uniform float scale;\n"
+    "uniform float clip;\n"
+    "uniform float offset;\n"
+    "uniform float columnOffset;\n"
+    "uniform float eventBit;\n"
+    "varying " JUCE_MEDIUMP " float visibility;\n"
+    "void main()\n"
+    "{\n"
+    "    float y = centre + clamp((sample.x - offset) * scale, -clip, clip) + 0.5 * position.y * sign(scale);\n"
+    "    float x = position.x + columnOffset + 0.5;\n"
+    "    visibility = eventBit > 0.0 ? mod(floor(sample.y / eventBit), 2.0) : sample.y;\n"
+    "    gl_Position = vec4(2.0 * x / viewSize.x - 1.0, 1.0 - 2.0 * y / viewSize.y, 0.0, 1.0);\n"
+    "}\n";
+
+static const char* fragmentShaderSource =
+    "uniform " JUCE_LOWP " vec4 colour;\n"
+    "varying " JUCE_MEDIUMP " float visibility;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_FragColor = vec4(colour.rgb, colour.a * visibility);\n"
+    "}\n";
+
+#pragma mark - LfpOpenGLDisplay -
+
+LfpOpenGLDisplay::LfpOpenGLDisplay(LfpDisplayCanvas* canvas_, LfpDisplay* display_, Viewport* viewport_)
+    : canvas(canvas_), display(display_), viewport(viewport_),
+      numChannels(0), numColumns(0), needsNewBuffers(true), dirtyFrom(0), dirtyTo(0),
+      viewWidth(0), viewHeight(0), positionBuffer(0), sampleBuffer(0)
+{
+    setInterceptsMouseClicks(false, false);
+
+    context.setRenderer(this);
+    context.setComponentPaintingEnabled(false);
+    context.setContinuousRepainting(false);
+}
+
+LfpOpenGLDisplay::~LfpOpenGLDisplay()
+{
+    context.detach();
+}
+
+void LfpOpenGLDisplay::setActive(bool active)
+{
+    if (active == isActive())
+        return;
+
+    if (active)
+    {
+        setVisible(true);
+        context.attachTo(*this);
+    }
+    else
+    {
+        context.detach();
+        setVisible(false);
+    }
+}
+
+bool LfpOpenGLDisplay::isActive() const
+{
+    return context.isAttached();
+}
+
+int LfpOpenGLDisplay::getChannelSamples(int channel) const
+{
+    return 2 + 2 * numColumns * (channel + 1);
+}
+
+void LfpOpenGLDisplay::update(int fillFrom, int fillTo, bool fullRedraw)
+{
+    const ScopedLock lock(dataLock);
+
+    const int nChans = display->getNumChannels();
+    const int nColumns = jlimit(0, MAX_N_SAMP, display->lfpChannelBitmap.getWidth());
+
+    if (nChans != numChannels || nColumns != numColumns)
+    {
+        numChannels = nChans;
+        numColumns = nColumns;
+        samples.calloc(2 * getChannelSamples(numChannels));
+
+        // the cursor is a line over the whole height, moved by its column offset
+        samples[0] = -fullHeight;
+        samples[1] = 1.0f;
+        samples[2] = fullHeight;
+        samples[3] = 1.0f;
+
+        needsNewBuffers = true;
+        fullRedraw = true;
+    }
+
+    if (fullRedraw)
+    {
+        fillFrom = 0;
+        fillTo = numColumns;
+    }
+
+    fillFrom = jmax(fillFrom - 1, 0); // the column before was drawn before its samples were complete
+    fillTo = jmin(fillTo + 1, numColumns);
+
+    if (fillFrom < fillTo)
+    {
+        // events, as a line over the whole height carrying the event bits
+        GLfloat* events = samples + 2 * 2;
+        for (int i = fillFrom; i < fillTo; i++)
+        {
+            const GLfloat eventState = canvas->getYCoord(canvas->getNumChannels(), i);
+            events[4 * i] = -fullHeight;
+            events[4 * i + 1] = eventState;
+            events[4 * i + 2] = fullHeight;
+            events[4 * i + 3] = eventState;
+        }
+
+        const bool spikeRaster = display->getSpikeRasterPlotting();
+        const float saturation = display->options->selectedSaturationValueFloat;
+
+        for (int ch = 0; ch < numChannels; ch++)
+        {
+            GLfloat* channelSamples = samples + 2 * getChannelSamples(ch);
+
+            for (int i = fillFrom; i < fillTo; i++)
+            {
+                GLfloat lo = canvas->getYCoordMin(ch, i);
+                GLfloat hi = canvas->getYCoordMax(ch, i);
+                GLfloat visibility = 1.0f;
+
+                if (spikeRaster)
+                {
+                    const bool saturated = lo < -saturation || hi > saturation;
+
+                    visibility = (!saturated && canvas->getSpikeRasterCrossing(ch, i)) ? 1.0f : 0.0f;
+                    lo = -fullHeight;
+                    hi = fullHeight;
+                }
+
+                channelSamples[4 * i] = lo;
+                channelSamples[4 * i + 1] = visibility;
+                channelSamples[4 * i + 2] = hi;
+                channelSamples[4 * i + 3] = visibility;
+            }
+        }
+
+        if (dirtyFrom < dirtyTo)
+        {
+            dirtyFrom = jmin(dirtyFrom, fillFrom);
+            dirtyTo = jmax(dirtyTo, fillTo);
+        }
+        else
+        {
+            dirtyFrom = fillFrom;
+            dirtyTo = fillTo;
+        }
+    }
+
+    // the layout is taken again every frame, so scrolling and resizing need no upload
+    viewWidth = getWidth();
+    viewHeight = getHeight();
+    backgroundColour = display->backgroundColour;
+    traces.clearQuick();
+
+    Trace trace;
+    trace.firstPosition = 0;
+    trace.numVertices = 2 * numColumns;
+    trace.columnOffset = 0;
+
+    trace.firstSample = 2;
+    trace.centre = viewHeight / 2.0f;
+    trace.scale = 1.0f;
+    trace.clip = viewHeight / 2.0f;
+    trace.offset = 0;
+
+    for (int ev = 0; ev < 8; ev++)
+    {
+        if (display->getEventDisplayState(ev))
+        {
+            trace.eventBit = float(1 << ev);
+            trace.colour = display->channelColours[ev * 2].withAlpha(0.3f);
+            traces.add(trace);
+        }
+    }
+
+    trace.eventBit = 0;
+
+    const int viewTop = viewport->getViewPositionY();
+    const bool medianOffset = display->getMedianOffsetPlotting();
+
+    for (int ch = 0; ch < numChannels; ch++)
+    {
+        LfpChannelDisplay* channel = display->channels[ch];
+
+        if (!channel->getEnabledState() || channel->getHidden() || channel->range == 0)
+            continue;
+
+        const int top = channel->getY() - viewTop;
+
+        if (top > viewHeight || top + channel->getHeight() < 0)
+            continue;
+
+        trace.firstSample = getChannelSamples(ch);
+        trace.centre = top + channel->getHeight() / 2;
+        trace.scale = channel->channelHeightFloat / channel->range;
+        trace.clip = std::abs(channel->channelHeightFloat * canvas->channelOverlapFactor);
+        trace.offset = medianOffset ? canvas->getMedianOffset(ch) : 0.0f;
+        trace.colour = channel->lineColour;
+        traces.add(trace);
+    }
+
+    // most recently drawn column
+    trace.firstPosition = 2 * numColumns;
+    trace.firstSample = 0;
+    trace.numVertices = 2;
+    trace.centre = viewHeight / 2.0f;
+    trace.scale = 1.0f;
+    trace.clip = viewHeight / 2.0f;
+    trace.offset = 0;
+    trace.columnOffset = float(canvas->screenBufferIndex[0] + 1);
+    trace.colour = Colours::yellow;
+    traces.add(trace);
+
+    context.triggerRepaint();
+}
+
+void LfpOpenGLDisplay::newOpenGLContextCreated()
+{
+    shader = new OpenGLShaderProgram(context);
+
+    if (!shader->addVertexShader(OpenGLHelpers::translateVertexShaderToV3(vertexShaderSource))
+        || !shader->addFragmentShader(OpenGLHelpers::translateFragmentShaderToV3(fragmentShaderSource))
+        || !shader->link())
+    {
+        std::cout << "LfpOpenGLDisplay: could not build the shaders: " << shader->getLastError() << std::endl;
+        shader = nullptr;
+        return;
+    }
+
+    position = new OpenGLShaderProgram::Attribute(*shader, "position");
+    sample = new OpenGLShaderProgram::Attribute(*shader, "sample");
+    viewSize = new OpenGLShaderProgram::Uniform(*shader, "viewSize");
+    centre = new OpenGLShaderProgram::Uniform(*shader, "centre");
+    scale = new OpenGLShaderProgram::Uniform(*shader, "scale");
+    clip = new OpenGLShaderProgram::Uniform(*shader, "clip");
+    offset = new OpenGLShaderProgram::Uniform(*shader, "offset");
+    columnOffset = new OpenGLShaderProgram::Uniform(*shader, "columnOffset");
+    eventBit = new OpenGLShaderProgram::Uniform(*shader, "eventBit");
+    colour = new OpenGLShaderProgram::Uniform(*shader, "colour");
+
+    context.extensions.glGenBuffers(1, &positionBuffer);
+    context.extensions.glGenBuffers(1, &sampleBuffer);
+
+    const ScopedLock lock(dataLock);
+    needsNewBuffers = true;
+}
+
+void LfpOpenGLDisplay::openGLContextClosing()
+{
+    context.extensions.glDeleteBuffers(1, &positionBuffer);
+    context.extensions.glDeleteBuffers(1, &sampleBuffer);
+    positionBuffer = sampleBuffer = 0;
+
+    position = sample = nullptr;
+    viewSize = centre = scale = clip = offset = columnOffset = eventBit = colour = nullptr;
+    shader = nullptr;
+}
+
+void LfpOpenGLDisplay::renderOpenGL()
+{
+    const ScopedLock lock(dataLock);
+
+    OpenGLHelpers::clear(backgroundColour);
+
+    if (shader == nullptr || numColumns == 0 || viewWidth == 0 || viewHeight == 0)
+        return;
+
+    OpenGLExtensionFunctions& gl = context.extensions;
+
+    if (needsNewBuffers)
+    {
+        // two ends of every column's line, and of the cursor
+        HeapBlock<GLfloat> positions(4 * (numColumns + 1));
+        for (int i = 0; i <= numColumns; i++)
+        {
+            const GLfloat x = i < numColumns ? GLfloat(i) : 0.0f;
+            positions[4 * i] = x;
+            positions[4 * i + 1] = -1.0f;
+            positions[4 * i + 2] = x;
+            positions[4 * i + 3] = 1.0f;
+        }
+
+        gl.glBindBuffer(GL_ARRAY_BUFFER, positionBuffer);
+        gl.glBufferData(GL_ARRAY_BUFFER, 4 * (numColumns + 1) * sizeof(GLfloat), positions, GL_STATIC_DRAW);
+
+        gl.glBindBuffer(GL_ARRAY_BUFFER, sampleBuffer);
+        gl.glBufferData(GL_ARRAY_BUFFER, 2 * getChannelSamples(numChannels) * sizeof(GLfloat), samples, GL_DYNAMIC_DRAW);
+
+        needsNewBuffers = false;
+    }
+    else if (dirtyFrom < dirtyTo)
+    {
+        // only the columns that changed since the last frame, for the events and every channel
+        gl.glBindBuffer(GL_ARRAY_BUFFER, sampleBuffer);
+
+        const int columnFloats = 4;
+        for (int ch = -1; ch < numChannels; ch++)
+        {
+            const int first = 2 * getChannelSamples(ch) + columnFloats * dirtyFrom;
+            gl.glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(GLfloat),
+                               columnFloats * (dirtyTo - dirtyFrom) * sizeof(GLfloat), samples + first);
+        }
+    }
+    dirtyFrom = dirtyTo = 0;
+
+    const float renderingScale = (float) context.getRenderingScale();
+    glViewport(0, 0, roundToInt(renderingScale * viewWidth), roundToInt(renderingScale * viewHeight));
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    shader->use();
+    viewSize->set(GLfloat(viewWidth), GLfloat(viewHeight));
+
+    gl.glEnableVertexAttribArray(position->attributeID);
+    gl.glEnableVertexAttribArray(sample->attributeID);
+
+    for (const Trace& trace : traces)
+        drawTrace(trace);
+
+    gl.glDisableVertexAttribArray(position->attributeID);
+    gl.glDisableVertexAttribArray(sample->attributeID);
+    gl.glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void LfpOpenGLDisplay::drawTrace(const Trace& trace)
+{
+    OpenGLExtensionFunctions& gl = context.extensions;
+
+    gl.glBindBuffer(GL_ARRAY_BUFFER, positionBuffer);
+    gl.glVertexAttribPointer(position->attributeID, 2, GL_FLOAT, GL_FALSE, 0,
+                             (GLvoid*) (2 * trace.firstPosition * sizeof(GLfloat)));
+
+    gl.glBindBuffer(GL_ARRAY_BUFFER, sampleBuffer);
+    gl.glVertexAttribPointer(sample->attributeID, 2, GL_FLOAT, GL_FALSE, 0,
+                             (GLvoid*) (2 * trace.firstSample * sizeof(GLfloat)));
+
+    centre->set(trace.centre);
+    scale->set(trace.scale);
+    clip->set(trace.clip);
+    offset->set(trace.offset);
+    columnOffset->set(trace.columnOffset);
+    eventBit->set(trace.eventBit);
+    colour->set(trace.colour.getFloatRed(), trace.colour.getFloatGreen(),
+                trace.colour.getFloatBlue(), trace.colour.getFloatAlpha());
+
+    glDrawArrays(GL_LINES, 0, trace.numVertices);
+}
@@ -0,0 +1,117 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2013 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#ifndef __LFPOPENGLDISPLAY_H_Alpha__
+#define __LFPOPENGLDISPLAY_H_Alpha__
+
+#include <VisualizerWindowHeaders.h>
+
+namespace LfpViewer {
+
+class LfpDisplayCanvas;
+class LfpDisplay;
+
+#pragma mark - LfpOpenGLDisplay -
+//==============================================================================
+/**
+    Draws the traces of an LfpDisplay with OpenGL instead of the bitmap plotters.
+
+    Sits over the visible part of the viewport, right of the channel names, and lets
+    mouse clicks through to the LfpDisplay underneath. On every refresh it copies the
+    pixel columns decimated since the last one; they are uploaded to a vertex buffer
+    holding the whole screen width of every channel, and each visible channel is drawn
+    with a single call, its position, range, offset and colour set as uniforms.
+
+    @see LfpDisplay, LfpDisplayCanvas
+ */
+class LfpOpenGLDisplay : public Component,
+    private OpenGLRenderer
+{
+public:
+    LfpOpenGLDisplay(LfpDisplayCanvas*, LfpDisplay*, Viewport*);
+    ~LfpOpenGLDisplay();
+
+    /** Attaches the OpenGL context and shows the component, or detaches and hides it */
+    void setActive(bool);
+    bool isActive() const;
+
+    /** Copies the screen buffer columns [fillFrom, fillTo) of every channel and the current
+        channel layout, and triggers a new frame. Called from LfpDisplay::refresh(). */
+    void update(int fillFrom, int fillTo, bool fullRedraw);
+
+private:
+    void newOpenGLContextCreated() override;
+    void renderOpenGL() override;
+    void openGLContextClosing() override;
+
+    /** One draw call: numVertices vertices from the given offsets into the position and sample buffers */
+    struct Trace
+    {
+        int firstPosition;
+        int firstSample;
+        int numVertices;
+        float centre; // px from the top of the component
+        float scale; // px per unit of the sample values
+        float clip; // largest distance from the centre, in px
+        float offset; // subtracted from the sample values
+        float columnOffset;
+        float eventBit; // draw the columns with this event bit set, 0 for normal traces
+        Colour colour;
+    };
+
+    void drawTrace(const Trace&);
+
+    /** Offset (in vertices) of the samples of a channel in the sample buffer */
+    int getChannelSamples(int channel) const;
+
+    LfpDisplayCanvas* canvas;
+    LfpDisplay* display;
+    Viewport* viewport;
+
+    OpenGLContext context;
+
+    // data handed from the message thread to the render thread
+    CriticalSection dataLock;
+    int numChannels;
+    int numColumns;
+    HeapBlock<GLfloat> samples; // (value, visibility) for both ends of every column: cursor, events, then channels
+    bool needsNewBuffers;
+    int dirtyFrom;
+    int dirtyTo;
+    Array<Trace> traces;
+    int viewWidth;
+    int viewHeight;
+    Colour backgroundColour;
+
+    // render thread only
+    ScopedPointer<OpenGLShaderProgram> shader;
+    ScopedPointer<OpenGLShaderProgram::Attribute> position, sample;
+    ScopedPointer<OpenGLShaderProgram::Uniform> viewSize, centre, scale, clip, offset, columnOffset, eventBit, colour;
+    GLuint positionBuffer;
+    GLuint sampleBuffer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LfpOpenGLDisplay);
+};
+
+};
+
+#endif  // __LFPOPENGLDISPLAY_H_Alpha__
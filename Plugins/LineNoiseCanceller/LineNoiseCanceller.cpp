@@ -0,0 +1,338 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "LineNoiseCanceller.h"
+#include "LineNoiseCancellerEditor.h"
+
+// cosine and sine of every harmonic
+#define WEIGHTS_PER_CHANNEL (2 * MAX_HARMONICS)
+// samples the oscillator basis is first allocated for
+#define INITIAL_BASIS_SAMPLES 4096
+// how far the tracked frequency may drift from the nominal one
+#define MAX_DRIFT 0.02
+// share of the measured drift or period applied at each block or edge
+#define TRACKING_GAIN 0.1
+#define LOCKING_GAIN 0.2
+
+
+LineNoiseCanceller::LineNoiseCanceller()
+    : GenericProcessor  ("Line Noise Canceller")
+    , nominalFrequency  (60.0f)
+    , numHarmonics      (3)
+    , adaptationTime    (1.0f)
+    , trackingMode      (FIXED_FREQUENCY)
+    , referenceEvent    (-1)
+    , referenceLine     (0)
+    , sampleRate        (30000.0f)
+    , phase             (0.0)
+    , frequency         (60.0)
+    , activeHarmonics   (0)
+    , basisSize         (0)
+    , lastEdge          (-1)
+{
+    setProcessorType (PROCESSOR_TYPE_FILTER);
+}
+
+
+LineNoiseCanceller::~LineNoiseCanceller()
+{
+}
+
+
+AudioProcessorEditor* LineNoiseCanceller::createEditor()
+{
+    editor = new LineNoiseCancellerEditor (this);
+    return editor;
+}
+
+
+double LineNoiseCanceller::getCurrentFrequency() const
+{
+    return frequency;
+}
+
+
+void LineNoiseCanceller::updateSettings()
+{
+    cleanedChannels.clearQuick();
+
+    for (int i = 0; i < dataChannelArray.size(); ++i)
+    {
+        const DataChannel* chan = dataChannelArray[i];
+        if (chan->getChannelType() != DataChannel::HEADSTAGE_CHANNEL)
+            continue;
+
+        // the oscillators are shared, so all channels must run at the same rate
+        if (cleanedChannels.size() == 0)
+            sampleRate = chan->getSampleRate();
+        else if (chan->getSampleRate() != sampleRate)
+            continue;
+
+        cleanedChannels.add (i);
+    }
+
+    weights.allocate ((size_t) cleanedChannels.size() * WEIGHTS_PER_CHANNEL, true);
+    previousPhasors.allocate ((size_t) cleanedChannels.size() * 2, true);
+}
+
+
+void LineNoiseCanceller::setParameter (int parameterIndex, float newValue)
+{
+    switch (parameterIndex)
+    {
+        case FREQUENCY:
+            nominalFrequency = jlimit (10.0f, 1000.0f, newValue);
+            frequency = nominalFrequency.load();
+            break;
+        case NUM_HARMONICS:
+            numHarmonics = jlimit (1, int (MAX_HARMONICS), int (newValue));
+            break;
+        case ADAPTATION_TIME:
+            adaptationTime = jmax (0.01f, newValue);
+            break;
+        case TRACKING_MODE:
+            trackingMode = jlimit (int (FIXED_FREQUENCY), int (LOCK_TO_TTL), int (newValue));
+            // a fixed frequency goes back to the nominal one
+            if (trackingMode == FIXED_FREQUENCY)
+                frequency = nominalFrequency.load();
+            break;
+        case REFERENCE_EVENT:
+            referenceEvent = int (newValue);
+            break;
+        case REFERENCE_LINE:
+            referenceLine = jmax (0, int (newValue));
+            break;
+        default:
+            break;
+    }
+}
+
+
+bool LineNoiseCanceller::enable()
+{
+    phase = 0.0;
+    frequency = nominalFrequency.load();
+    activeHarmonics = 0;
+    lastEdge = -1;
+    edges.clearQuick();
+    edges.ensureStorageAllocated (64);
+
+    const size_t numWeights = (size_t) cleanedChannels.size() * WEIGHTS_PER_CHANNEL;
+    if (numWeights > 0)
+    {
+        weights.clear (numWeights);
+        previousPhasors.clear ((size_t) cleanedChannels.size() * 2);
+    }
+
+    if (basisSize < INITIAL_BASIS_SAMPLES * WEIGHTS_PER_CHANNEL)
+    {
+        basisSize = INITIAL_BASIS_SAMPLES * WEIGHTS_PER_CHANNEL;
+        basis.malloc (basisSize);
+    }
+
+    return true;
+}
+
+
+void LineNoiseCanceller::handleEvent (const EventChannel* eventInfo, const MidiMessage& event, int)
+{
+    const int index = referenceEvent;
+    if (index < 0 || eventInfo != eventChannelArray[index] || eventInfo->getChannelType() != EventChannel::TTL)
+        return;
+
+    TTLEventView ttl (event, eventInfo);
+    if (ttl.isValid() && ttl.getChannel() == referenceLine && ttl.getState())
+        edges.add (ttl.getTimestamp());
+}
+
+
+void LineNoiseCanceller::process (AudioSampleBuffer& buffer)
+{
+    const int numChannels = cleanedChannels.size();
+    if (numChannels == 0)
+        return;
+
+    const int mode = trackingMode;
+    if (mode == LOCK_TO_TTL)
+        checkForEvents();
+
+    const int numSamples = getNumSamples (cleanedChannels[0]);
+    if (numSamples == 0)
+        return;
+
+    if (mode == LOCK_TO_TTL)
+        lockToEdges (getTimestamp (cleanedChannels[0]));
+
+    // harmonics at or above Nyquist can't be represented
+    int harmonics = numHarmonics;
+    while (harmonics > 1 && harmonics * frequency >= sampleRate / 2)
+        --harmonics;
+
+    // harmonics that come back start from nothing
+    if (harmonics != activeHarmonics)
+    {
+        for (int i = 0; i < numChannels; ++i)
+        {
+            float* w = weights + (size_t) i * WEIGHTS_PER_CHANNEL;
+            FloatVectorOperations::clear (w + 2 * harmonics, WEIGHTS_PER_CHANNEL - 2 * harmonics);
+        }
+        activeHarmonics = harmonics;
+    }
+
+    computeOscillators (numSamples, harmonics);
+
+    // at a step of mu the amplitudes settle in about 2 / mu samples
+    const float mu = jmin (0.5f, 2.0f / (adaptationTime * sampleRate));
+    const int stride = 2 * harmonics;
+
+    parallelFor (numChannels, [this, &buffer, numSamples, mu, stride] (int firstChannel, int lastChannel)
+    {
+        for (int i = firstChannel; i < lastChannel; ++i)
+        {
+            float* x = buffer.getWritePointer (cleanedChannels[i]);
+            float* w = weights + (size_t) i * WEIGHTS_PER_CHANNEL;
+            const float* b = basis;
+            const int n = jmin (numSamples, (int) getNumSamples (cleanedChannels[i]));
+
+            for (int s = 0; s < n; ++s, b += stride)
+            {
+                float model = 0;
+                for (int j = 0; j < stride; ++j)
+                    model += w[j] * b[j];
+
+                const float error = x[s] - model;
+                const float step = mu * error;
+                for (int j = 0; j < stride; ++j)
+                    w[j] += step * b[j];
+
+                x[s] = error;
+            }
+        }
+    });
+
+    if (mode == TRACK_FREQUENCY)
+        trackFrequency (numSamples);
+}
+
+
+void LineNoiseCanceller::computeOscillators (int numSamples, int harmonics)
+{
+    const int stride = 2 * harmonics;
+    if ((size_t) numSamples * stride > basisSize)
+    {
+        basisSize = (size_t) numSamples * WEIGHTS_PER_CHANNEL;
+        basis.malloc (basisSize);
+    }
+
+    // the fundamental is rotated sample by sample and the harmonics are its powers;
+    // starting every block from the stored phase keeps rounding from building up
+    const double omega = 2.0 * double_Pi * frequency / sampleRate;
+    const double cosOmega = std::cos (omega);
+    const double sinOmega = std::sin (omega);
+    double c = std::cos (phase);
+    double s = std::sin (phase);
+
+    float* b = basis;
+    for (int n = 0; n < numSamples; ++n, b += stride)
+    {
+        double ck = c;
+        double sk = s;
+        b[0] = (float) c;
+        b[1] = (float) s;
+
+        for (int k = 1; k < harmonics; ++k)
+        {
+            const double next = ck * c - sk * s;
+            sk = sk * c + ck * s;
+            ck = next;
+            b[2 * k] = (float) ck;
+            b[2 * k + 1] = (float) sk;
+        }
+
+        const double next = c * cosOmega - s * sinOmega;
+        s = s * cosOmega + c * sinOmega;
+        c = next;
+    }
+
+    phase = std::fmod (phase + omega * numSamples, 2.0 * double_Pi);
+}
+
+
+void LineNoiseCanceller::trackFrequency (int numSamples)
+{
+    // the fitted phasor a - ib of the fundamental turns at the difference between
+    // the mains and the oscillator frequency; summing z * conj(previous z) over the
+    // channels weighs every channel by the interference it carries
+    double sumRe = 0;
+    double sumIm = 0;
+
+    for (int i = 0; i < cleanedChannels.size(); ++i)
+    {
+        const float* w = weights + (size_t) i * WEIGHTS_PER_CHANNEL;
+        float* previous = previousPhasors + (size_t) i * 2;
+
+        const double re = w[0];
+        const double im = -w[1];
+        sumRe += re * previous[0] + im * previous[1];
+        sumIm += im * previous[0] - re * previous[1];
+
+        previous[0] = (float) re;
+        previous[1] = (float) im;
+    }
+
+    if (sumRe == 0 && sumIm == 0)
+        return;
+
+    const double drift = std::atan2 (sumIm, sumRe) * sampleRate / (2.0 * double_Pi * numSamples);
+    const double nominal = nominalFrequency;
+    frequency = jlimit (nominal * (1.0 - MAX_DRIFT), nominal * (1.0 + MAX_DRIFT), frequency + TRACKING_GAIN * drift);
+}
+
+
+void LineNoiseCanceller::lockToEdges (int64 blockTimestamp)
+{
+    const double nominal = nominalFrequency;
+    const double expectedPeriod = sampleRate / nominal;
+
+    for (int i = 0; i < edges.size(); ++i)
+    {
+        const int64 edge = edges.getUnchecked (i);
+
+        // edges too far from a mains cycle apart are missed or spurious ones
+        if (lastEdge >= 0)
+        {
+            const double period = double (edge - lastEdge);
+            if (period > expectedPeriod * (1.0 - MAX_DRIFT) && period < expectedPeriod * (1.0 + MAX_DRIFT))
+                frequency = frequency + LOCKING_GAIN * (sampleRate / period - frequency);
+        }
+        lastEdge = edge;
+
+        // the fundamental's cosine peaks at every edge
+        const double omega = 2.0 * double_Pi * frequency / sampleRate;
+        const double edgePhase = phase + omega * double (edge - blockTimestamp);
+        const double error = std::remainder (edgePhase, 2.0 * double_Pi);
+        phase -= LOCKING_GAIN * error;
+    }
+
+    edges.clearQuick();
+}
@@ -0,0 +1,125 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __LINENOISECANCELLER_H_A4C1E7F2__
+#define __LINENOISECANCELLER_H_A4C1E7F2__
+
+#include <ProcessorHeaders.h>
+#include <atomic>
+
+/**
+    Removes mains interference and its harmonics from every headstage channel in
+    a single pass, instead of one notch Filter Node per harmonic.
+
+    The interference of each channel is modelled as a sum of sines and cosines at
+    the mains frequency and its harmonics, whose amplitudes are adapted sample by
+    sample (LMS) and subtracted. The oscillators are computed once per block and
+    shared by all channels, so each channel only adds one dot product and one
+    weight update per sample.
+
+    The frequency can be fixed, tracked from the drift of the fitted phases across
+    channels, or locked to a TTL line carrying one rising edge per mains cycle.
+    Only headstage channels with the sample rate of the first one are cleaned.
+
+    @see LineNoiseCancellerEditor
+*/
+class LineNoiseCanceller : public GenericProcessor
+{
+public:
+    LineNoiseCanceller();
+    ~LineNoiseCanceller();
+
+    AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override { return true; }
+
+    void process (AudioSampleBuffer& buffer) override;
+
+    void updateSettings() override;
+
+    void setParameter (int parameterIndex, float newValue) override;
+
+    bool enable() override;
+
+    enum Parameters
+    {
+        /** Nominal mains frequency in Hz, 50 or 60 */
+        FREQUENCY = 0,
+        NUM_HARMONICS,
+        /** Time constant of the amplitude adaptation, in seconds */
+        ADAPTATION_TIME,
+        TRACKING_MODE,
+        /** Index of the TTL event channel locked to, or -1 */
+        REFERENCE_EVENT,
+        REFERENCE_LINE
+    };
+
+    enum TrackingMode
+    {
+        FIXED_FREQUENCY = 0,
+        TRACK_FREQUENCY,
+        LOCK_TO_TTL
+    };
+
+    enum { MAX_HARMONICS = 10 };
+
+    /** The frequency the oscillators currently run at */
+    double getCurrentFrequency() const;
+
+private:
+    void handleEvent (const EventChannel* eventInfo, const MidiMessage& event, int sampleNum) override;
+
+    /** Fills the basis with the cosine and sine of every harmonic, sample after sample */
+    void computeOscillators (int numSamples, int numHarmonics);
+
+    /** Moves the frequency towards the rotation of the fundamental's fitted phase */
+    void trackFrequency (int numSamples);
+
+    /** Moves the frequency and phase towards the edges received in this block */
+    void lockToEdges (int64 blockTimestamp);
+
+    std::atomic<float> nominalFrequency;
+    std::atomic<int> numHarmonics;
+    std::atomic<float> adaptationTime;
+    std::atomic<int> trackingMode;
+    std::atomic<int> referenceEvent;
+    std::atomic<int> referenceLine;
+
+    /** Input channels that are cleaned */
+    Array<int> cleanedChannels;
+    float sampleRate;
+
+    // audio thread state
+    double phase;
+    std::atomic<double> frequency;
+    int activeHarmonics;
+    HeapBlock<float> basis;
+    size_t basisSize;
+    HeapBlock<float> weights;
+    HeapBlock<float> previousPhasors;
+    Array<int64> edges;
+    int64 lastEdge;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LineNoiseCanceller);
+};
+
+#endif  // __LINENOISECANCELLER_H_A4C1E7F2__
@@ -0,0 +1,196 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "LineNoiseCancellerEditor.h"
+#include "LineNoiseCanceller.h"
+
+LineNoiseCancellerEditor::LineNoiseCancellerEditor (GenericProcessor* parentNode, bool useDefaultParameterEditors)
+    : GenericEditor (parentNode, useDefaultParameterEditors)
+    , canceller (static_cast<LineNoiseCanceller*> (parentNode))
+{
+    desiredWidth = 220;
+
+    addSetting ("Mains", String(), 10, 25, false);
+    frequencySelector = new ComboBox ("Mains frequency");
+    frequencySelector->setEditableText (false);
+    frequencySelector->setJustificationType (Justification::centredLeft);
+    frequencySelector->addItem ("50 Hz", 50);
+    frequencySelector->addItem ("60 Hz", 60);
+    frequencySelector->setSelectedId (60, dontSendNotification);
+    frequencySelector->addListener (this);
+    frequencySelector->setBounds (70, 25, 80, 18);
+    addAndMakeVisible (frequencySelector);
+
+    addSetting ("Follow", String(), 10, 47, false);
+    referenceSelector = new ComboBox ("Reference");
+    referenceSelector->setEditableText (false);
+    referenceSelector->setJustificationType (Justification::centredLeft);
+    referenceSelector->addListener (this);
+    referenceSelector->setBounds (70, 47, 140, 18);
+    referenceSelector->setTooltip ("Keep the mains frequency fixed, track its drift from the data, or lock it to a TTL line with one edge per cycle");
+    addAndMakeVisible (referenceSelector);
+
+    harmonicsLabel = addSetting ("Harmonics", "3", 10, 69, true);
+    harmonicsLabel->setTooltip ("Number of harmonics removed, the fundamental included");
+    adaptationLabel = addSetting ("Adapt (s)", "1", 10, 89, true);
+    adaptationLabel->setTooltip ("How fast the interference amplitudes follow changes; longer removes a narrower band");
+
+    currentLabel = addSetting ("Current", "-", 10, 109, false);
+}
+
+LineNoiseCancellerEditor::~LineNoiseCancellerEditor()
+{
+}
+
+Label* LineNoiseCancellerEditor::addSetting (const String& name, const String& value, int x, int y, bool editable)
+{
+    Label* title = new Label (name, name);
+    title->setFont (Font ("Small Text", 10, Font::plain));
+    title->setBounds (x, y, editable ? 60 : 55, 18);
+    title->setColour (Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible (title);
+    staticLabels.add (title);
+
+    if (value.isEmpty())
+        return title;
+
+    Label* setting = new Label (name + " value", value);
+    setting->setFont (Font ("Small Text", 10, Font::plain));
+    setting->setColour (Label::textColourId, Colours::darkgrey);
+    setting->setBounds (x + 60, y, 80, 18);
+    if (editable)
+    {
+        setting->setEditable (true, false, false);
+        setting->addListener (this);
+        setting->setColour (Label::backgroundColourId, Colours::lightgrey);
+    }
+    addAndMakeVisible (setting);
+    return setting;
+}
+
+void LineNoiseCancellerEditor::comboBoxChanged (ComboBox* comboBox)
+{
+    if (comboBox == frequencySelector)
+        canceller->setParameter (LineNoiseCanceller::FREQUENCY, frequencySelector->getSelectedId());
+    else if (comboBox == referenceSelector)
+        setReference();
+}
+
+void LineNoiseCancellerEditor::setReference()
+{
+    const int id = referenceSelector->getSelectedId();
+    const int index = id - 3;
+    if (index >= 0 && index < eventSourceArray.size())
+    {
+        //invalidate the reference first so the event index and line always match
+        canceller->setParameter (LineNoiseCanceller::REFERENCE_EVENT, -1);
+        canceller->setParameter (LineNoiseCanceller::REFERENCE_LINE, eventSourceArray[index].channel);
+        canceller->setParameter (LineNoiseCanceller::REFERENCE_EVENT, eventSourceArray[index].eventIndex);
+        canceller->setParameter (LineNoiseCanceller::TRACKING_MODE, LineNoiseCanceller::LOCK_TO_TTL);
+    }
+    else
+    {
+        canceller->setParameter (LineNoiseCanceller::REFERENCE_EVENT, -1);
+        canceller->setParameter (LineNoiseCanceller::TRACKING_MODE,
+                                 id == 2 ? LineNoiseCanceller::TRACK_FREQUENCY : LineNoiseCanceller::FIXED_FREQUENCY);
+    }
+}
+
+void LineNoiseCancellerEditor::labelTextChanged (Label* label)
+{
+    if (label == harmonicsLabel)
+    {
+        int harmonics = jlimit (1, int (LineNoiseCanceller::MAX_HARMONICS), label->getText().getIntValue());
+        label->setText (String (harmonics), dontSendNotification);
+        canceller->setParameter (LineNoiseCanceller::NUM_HARMONICS, harmonics);
+    }
+    else if (label == adaptationLabel)
+    {
+        float adaptation = jmax (0.01f, label->getText().getFloatValue());
+        label->setText (String (adaptation), dontSendNotification);
+        canceller->setParameter (LineNoiseCanceller::ADAPTATION_TIME, adaptation);
+    }
+}
+
+void LineNoiseCancellerEditor::updateSettings()
+{
+    EventSources s;
+    int oldReference = referenceSelector->getSelectedId();
+    referenceSelector->clear (dontSendNotification);
+    eventSourceArray.clear();
+    referenceSelector->addItem ("Fixed frequency", 1);
+    referenceSelector->addItem ("Track drift", 2);
+    int nextItem = 3;
+    int nEvents = canceller->getTotalEventChannels();
+    for (int i = 0; i < nEvents; i++)
+    {
+        const EventChannel* event = canceller->getEventChannel (i);
+        if (event->getChannelType() != EventChannel::TTL)
+            continue;
+
+        s.eventIndex = i;
+        int nChans = event->getNumChannels();
+        for (int c = 0; c < nChans; c++)
+        {
+            s.channel = c;
+            eventSourceArray.add (s);
+            referenceSelector->addItem (event->getSourceName() + " (TTL" + String (c + 1) + ")", nextItem++);
+        }
+    }
+    if (oldReference < 1 || oldReference > referenceSelector->getNumItems())
+        oldReference = 1;
+    referenceSelector->setSelectedId (oldReference, dontSendNotification);
+    setReference();
+}
+
+void LineNoiseCancellerEditor::updateFromProcessor()
+{
+    currentLabel->setText (String (canceller->getCurrentFrequency(), 3) + " Hz", dontSendNotification);
+}
+
+void LineNoiseCancellerEditor::saveCustomParameters (XmlElement* xml)
+{
+    XmlElement* info = xml->createNewChildElement ("PARAMETERS");
+
+    info->setAttribute ("Type", "LineNoiseCancellerEditor");
+    info->setAttribute ("Frequency", frequencySelector->getSelectedId());
+    info->setAttribute ("Reference", referenceSelector->getSelectedId());
+    info->setAttribute ("Harmonics", harmonicsLabel->getText().getIntValue());
+    info->setAttribute ("Adaptation", adaptationLabel->getText().getFloatValue());
+}
+
+void LineNoiseCancellerEditor::loadCustomParameters (XmlElement* xml)
+{
+    forEachXmlChildElement (*xml, xmlNode)
+    {
+        if (xmlNode->hasTagName ("PARAMETERS"))
+        {
+            frequencySelector->setSelectedId (xmlNode->getIntAttribute ("Frequency", 60), sendNotificationSync);
+            harmonicsLabel->setText (String (xmlNode->getIntAttribute ("Harmonics", 3)), sendNotificationSync);
+            adaptationLabel->setText (String (xmlNode->getDoubleAttribute ("Adaptation", 1.0)), sendNotificationSync);
+
+            // the list is filled by updateSettings, which keeps this selection
+            referenceSelector->setSelectedId (xmlNode->getIntAttribute ("Reference", 1), dontSendNotification);
+        }
+    }
+}
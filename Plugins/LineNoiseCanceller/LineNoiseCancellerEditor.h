@@ -0,0 +1,79 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __LINENOISECANCELLEREDITOR_H_7F03B6D9__
+#define __LINENOISECANCELLEREDITOR_H_7F03B6D9__
+
+#include <EditorHeaders.h>
+
+class LineNoiseCanceller;
+
+/**
+
+  User interface for the LineNoiseCanceller processor.
+
+  Takes the mains frequency, the number of harmonics, the adaptation time and
+  what the frequency follows, and shows the frequency in use while acquiring.
+
+  @see LineNoiseCanceller
+
+*/
+
+class LineNoiseCancellerEditor : public GenericEditor,
+    public ComboBox::Listener,
+    public Label::Listener
+{
+public:
+    LineNoiseCancellerEditor (GenericProcessor* parentNode, bool useDefaultParameterEditors = true);
+    ~LineNoiseCancellerEditor();
+
+    void comboBoxChanged (ComboBox* comboBox) override;
+    void labelTextChanged (Label* label) override;
+
+    void updateSettings() override;
+    void updateFromProcessor() override;
+
+    void saveCustomParameters (XmlElement* xml) override;
+    void loadCustomParameters (XmlElement* xml) override;
+
+private:
+    struct EventSources
+    {
+        int eventIndex;
+        int channel;
+    };
+
+    Label* addSetting (const String& name, const String& value, int x, int y, bool editable);
+    void setReference();
+
+    LineNoiseCanceller* canceller;
+
+    Array<EventSources> eventSourceArray;
+    ScopedPointer<ComboBox> frequencySelector, referenceSelector;
+    ScopedPointer<Label> harmonicsLabel, adaptationLabel, currentLabel;
+    OwnedArray<Label> staticLabels;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LineNoiseCancellerEditor);
+};
+
+#endif  // __LINENOISECANCELLEREDITOR_H_7F03B6D9__
@@ -0,0 +1,472 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "NWBFile.h"
+
+#define NWB_VERSION "2.2.5"
+//Rows of the chunks of the event and timestamp datasets
+#define EVENT_CHUNK_ROWS 1024
+#define TIMESTAMP_CHUNK_ROWS 65536
+//Approximate size of the chunks of the continuous data
+#define CONTINUOUS_CHUNK_BYTES (256 * 1024)
+
+using namespace NWBRecordingEngine;
+
+NWBFile::NWBFile (const String& path_, int compressionLevel_)
+    : path (path_), compressionLevel (jlimit (0, 9, compressionLevel_)), file (-1), numElectrodes (0)
+{
+}
+
+NWBFile::~NWBFile()
+{
+    close();
+}
+
+bool NWBFile::open (const String& identifier, const String& sessionDescription, Time startTime,
+                    const Array<ElectrodeGroupInfo>& groups, const Array<ElectrodeInfo>& electrodes)
+{
+    close();
+    file = H5Fcreate (path.toRawUTF8(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    if (file < 0)
+    {
+        std::cerr << "Error creating NWB file " << path << std::endl;
+        return false;
+    }
+
+    setNeurodataType (file, "NWBFile", "core");
+    setStringAttribute (file, "nwb_version", NWB_VERSION);
+
+    const char* requiredGroups[] = { "acquisition", "analysis", "processing", "stimulus", "stimulus/presentation",
+        "stimulus/templates", "general", "general/devices", "general/extracellular_ephys", "specifications" };
+    for (int i = 0; i < numElementsInArray (requiredGroups); i++)
+        H5Gclose (createGroup (file, requiredGroups[i]));
+
+    writeStringDataset (file, "identifier", StringArray (identifier), true);
+    writeStringDataset (file, "session_description", StringArray (sessionDescription), true);
+    writeStringDataset (file, "session_start_time", StringArray (startTime.toISO8601 (true)), true);
+    writeStringDataset (file, "timestamps_reference_time", StringArray (startTime.toISO8601 (true)), true);
+    writeStringDataset (file, "file_create_date", StringArray (Time::getCurrentTime().toISO8601 (true)), false);
+
+    StringArray devices;
+    for (int i = 0; i < groups.size(); i++)
+    {
+        const String& device = groups.getReference (i).device;
+        if (devices.contains (device))
+            continue;
+        devices.add (device);
+        hid_t deviceGroup = createGroup (file, ("general/devices/" + device).toRawUTF8());
+        setNeurodataType (deviceGroup, "Device", "core");
+        setStringAttribute (deviceGroup, "description", device);
+        H5Gclose (deviceGroup);
+    }
+
+    StringArray groupPaths;
+    for (int i = 0; i < groups.size(); i++)
+    {
+        const ElectrodeGroupInfo& info = groups.getReference (i);
+        groupPaths.add ("/general/extracellular_ephys/" + info.name);
+        hid_t group = createGroup (file, groupPaths[i].toRawUTF8());
+        setNeurodataType (group, "ElectrodeGroup", "core");
+        setStringAttribute (group, "description", info.description);
+        setStringAttribute (group, "location", "unknown");
+        H5Lcreate_soft (("/general/devices/" + info.device).toRawUTF8(), group, "device", H5P_DEFAULT, H5P_DEFAULT);
+        H5Gclose (group);
+    }
+
+    //The electrodes table, one column dataset each
+    numElectrodes = electrodes.size();
+    hid_t table = createGroup (file, "general/extracellular_ephys/electrodes");
+    setNeurodataType (table, "DynamicTable", "hdmf-common");
+    setStringAttribute (table, "description", "Recorded channels");
+    StringArray columns = StringArray::fromTokens ("x y z imp location filtering group group_name", false);
+    setStringArrayAttribute (table, "colnames", columns);
+
+    HeapBlock<int> ids (numElectrodes + 1);
+    HeapBlock<float> nans (numElectrodes + 1);
+    HeapBlock<hobj_ref_t> references (numElectrodes + 1);
+    StringArray locations, filtering, electrodeGroupNames;
+    for (int i = 0; i < numElectrodes; i++)
+    {
+        const ElectrodeInfo& info = electrodes.getReference (i);
+        ids[i] = i;
+        nans[i] = std::numeric_limits<float>::quiet_NaN();
+        locations.add ("unknown");
+        filtering.add (info.filtering);
+        electrodeGroupNames.add (groups[info.group].name);
+        H5Rcreate (&references[i], file, groupPaths[info.group].toRawUTF8(), H5R_OBJECT, -1);
+    }
+
+    writeDataset (table, "id", H5T_NATIVE_INT32, numElectrodes, ids);
+    for (int i = 0; i < 4; i++)
+        writeDataset (table, columns[i].toRawUTF8(), H5T_NATIVE_FLOAT, numElectrodes, nans);
+    writeStringDataset (table, "location", locations, false);
+    writeStringDataset (table, "filtering", filtering, false);
+    writeDataset (table, "group", H5T_STD_REF_OBJ, numElectrodes, references);
+    writeStringDataset (table, "group_name", electrodeGroupNames, false);
+
+    hid_t idSet = H5Dopen2 (table, "id", H5P_DEFAULT);
+    setNeurodataType (idSet, "ElementIdentifiers", "hdmf-common");
+    H5Dclose (idSet);
+    for (int i = 0; i < columns.size(); i++)
+    {
+        hid_t column = H5Dopen2 (table, columns[i].toRawUTF8(), H5P_DEFAULT);
+        setNeurodataType (column, "VectorData", "hdmf-common");
+        setStringAttribute (column, "description", columns[i]);
+        H5Dclose (column);
+    }
+    H5Gclose (table);
+    return true;
+}
+
+void NWBFile::close()
+{
+    series.clear();
+    if (file >= 0)
+        H5Fclose (file);
+    file = -1;
+}
+
+bool NWBFile::isOpen() const
+{
+    return file >= 0;
+}
+
+hid_t NWBFile::createSeries (Series* s, const String& name, const char* neurodataType, const String& description, float sampleRate)
+{
+    s->group = createGroup (file, ("acquisition/" + name).toRawUTF8());
+    setNeurodataType (s->group, neurodataType, "core");
+    setStringAttribute (s->group, "description", description);
+    setStringAttribute (s->group, "comments", "no comments");
+    s->sampleRate = sampleRate;
+    s->timesSize = 0;
+    s->timestamps = new Dataset (s->group, "timestamps", H5T_NATIVE_DOUBLE, 1, nullptr, TIMESTAMP_CHUNK_ROWS, compressionLevel);
+    int interval = 1;
+    setAttribute (s->timestamps->getId(), "interval", H5T_NATIVE_INT32, &interval);
+    setStringAttribute (s->timestamps->getId(), "unit", "seconds");
+    return s->group;
+}
+
+int NWBFile::addContinuousSeries (const ContinuousSeriesInfo& info)
+{
+    Series* s = new Series();
+    series.add (s);
+    createSeries (s, info.name, "ElectricalSeries", info.description, info.sampleRate);
+
+    const int numChannels = info.bitVolts.size();
+    hsize_t rowDims[1] = { hsize_t (numChannels) };
+    hsize_t chunkRows = jmax (256, CONTINUOUS_CHUNK_BYTES / (numChannels * int (sizeof (int16))));
+    s->data = new Dataset (s->group, "data", H5T_NATIVE_INT16, 2, rowDims, chunkRows, compressionLevel);
+    s->rowSize = numChannels;
+
+    //Samples are in bits; channel_conversion turns them into microvolts and conversion into volts
+    float conversion = 1e-6f;
+    float resolution = -1.0f;
+    setAttribute (s->data->getId(), "conversion", H5T_NATIVE_FLOAT, &conversion);
+    setAttribute (s->data->getId(), "resolution", H5T_NATIVE_FLOAT, &resolution);
+    setStringAttribute (s->data->getId(), "unit", "volts");
+
+    writeDataset (s->group, "channel_conversion", H5T_NATIVE_FLOAT, numChannels, info.bitVolts.begin());
+    hid_t channelConversion = H5Dopen2 (s->group, "channel_conversion", H5P_DEFAULT);
+    int axis = 1;
+    setAttribute (channelConversion, "axis", H5T_NATIVE_INT32, &axis);
+    H5Dclose (channelConversion);
+
+    writeElectrodes (s->group, info.electrodes);
+    return series.size() - 1;
+}
+
+int NWBFile::addEventSeries (const EventSeriesInfo& info)
+{
+    Series* s = new Series();
+    series.add (s);
+    s->rowSize = 1;
+
+    float conversion = 1.0f;
+    float resolution = -1.0f;
+    if (info.type == EventSeriesInfo::TEXT_SERIES)
+    {
+        createSeries (s, info.name, "AnnotationSeries", info.description, info.sampleRate);
+        s->isText = true;
+        hid_t stringType = createStringType();
+        //Filters would only compress the references to the strings
+        s->data = new Dataset (s->group, "data", stringType, 1, nullptr, EVENT_CHUNK_ROWS, 0);
+        H5Tclose (stringType);
+    }
+    else if (info.type == EventSeriesInfo::TTL_SERIES)
+    {
+        createSeries (s, info.name, "TimeSeries", info.description, info.sampleRate);
+        s->data = new Dataset (s->group, "data", H5T_NATIVE_INT16, 1, nullptr, EVENT_CHUNK_ROWS, compressionLevel);
+    }
+    else
+    {
+        createSeries (s, info.name, "TimeSeries", info.description, info.sampleRate);
+        hsize_t rowDims[1] = { hsize_t (info.length) };
+        s->data = new Dataset (s->group, "data", getH5Type (info.dataType), 2, rowDims, EVENT_CHUNK_ROWS, compressionLevel);
+        s->rowSize = info.length;
+    }
+    setAttribute (s->data->getId(), "conversion", H5T_NATIVE_FLOAT, &conversion);
+    setAttribute (s->data->getId(), "resolution", H5T_NATIVE_FLOAT, &resolution);
+    setStringAttribute (s->data->getId(), "unit", "n/a");
+    return series.size() - 1;
+}
+
+int NWBFile::addSpikeSeries (const SpikeSeriesInfo& info)
+{
+    Series* s = new Series();
+    series.add (s);
+    createSeries (s, info.name, "SpikeEventSeries", info.description, info.sampleRate);
+
+    hsize_t rowDims[2] = { hsize_t (info.numChannels), hsize_t (info.numSamples) };
+    s->data = new Dataset (s->group, "data", H5T_NATIVE_FLOAT, 3, rowDims, EVENT_CHUNK_ROWS, compressionLevel);
+    s->rowSize = info.numChannels * info.numSamples;
+
+    float conversion = 1e-6f;
+    float resolution = -1.0f;
+    setAttribute (s->data->getId(), "conversion", H5T_NATIVE_FLOAT, &conversion);
+    setAttribute (s->data->getId(), "resolution", H5T_NATIVE_FLOAT, &resolution);
+    setStringAttribute (s->data->getId(), "unit", "volts");
+
+    writeElectrodes (s->group, info.electrodes);
+    return series.size() - 1;
+}
+
+void NWBFile::writeContinuous (int index, const int16* data, const int64* timestamps, int numFrames)
+{
+    Series* s = series[index];
+    if (s == nullptr || numFrames <= 0)
+        return;
+    s->data->append (data, numFrames);
+    appendTimes (s, timestamps, numFrames);
+}
+
+void NWBFile::writeEvent (int index, double time, const void* data)
+{
+    Series* s = series[index];
+    if (s == nullptr)
+        return;
+    if (s->isText)
+    {
+        //Variable-length strings are written from an array of pointers
+        const char* text = static_cast<const char*> (data);
+        s->data->append (&text, 1);
+    }
+    else
+        s->data->append (data, 1);
+    s->timestamps->append (&time, 1);
+}
+
+void NWBFile::writeSpike (int index, double time, const float* waveform)
+{
+    Series* s = series[index];
+    if (s == nullptr)
+        return;
+    s->data->append (waveform, 1);
+    s->timestamps->append (&time, 1);
+}
+
+void NWBFile::appendTimes (Series* s, const int64* timestamps, int numFrames)
+{
+    if (s->timesSize < numFrames)
+    {
+        s->times.malloc (numFrames);
+        s->timesSize = numFrames;
+    }
+    for (int i = 0; i < numFrames; i++)
+        s->times[i] = double (timestamps[i]) / s->sampleRate;
+    s->timestamps->append (s->times, numFrames);
+}
+
+void NWBFile::writeElectrodes (hid_t parent, const Array<int>& electrodes)
+{
+    writeDataset (parent, "electrodes", H5T_NATIVE_INT32, electrodes.size(), electrodes.begin());
+    hid_t region = H5Dopen2 (parent, "electrodes", H5P_DEFAULT);
+    setNeurodataType (region, "DynamicTableRegion", "hdmf-common");
+    setStringAttribute (region, "description", "Electrodes of the series");
+    setReferenceAttribute (region, "table", "/general/extracellular_ephys/electrodes");
+    H5Dclose (region);
+}
+
+hid_t NWBFile::getH5Type (MetaDataDescriptor::MetaDataTypes type)
+{
+    switch (type)
+    {
+    case MetaDataDescriptor::INT8: return H5T_NATIVE_INT8;
+    case MetaDataDescriptor::UINT8: return H5T_NATIVE_UINT8;
+    case MetaDataDescriptor::INT16: return H5T_NATIVE_INT16;
+    case MetaDataDescriptor::UINT16: return H5T_NATIVE_UINT16;
+    case MetaDataDescriptor::INT32: return H5T_NATIVE_INT32;
+    case MetaDataDescriptor::UINT32: return H5T_NATIVE_UINT32;
+    case MetaDataDescriptor::INT64: return H5T_NATIVE_INT64;
+    case MetaDataDescriptor::UINT64: return H5T_NATIVE_UINT64;
+    case MetaDataDescriptor::FLOAT: return H5T_NATIVE_FLOAT;
+    case MetaDataDescriptor::DOUBLE: return H5T_NATIVE_DOUBLE;
+    default: return H5T_NATIVE_CHAR;
+    }
+}
+
+hid_t NWBFile::createStringType()
+{
+    hid_t type = H5Tcopy (H5T_C_S1);
+    H5Tset_size (type, H5T_VARIABLE);
+    H5Tset_cset (type, H5T_CSET_UTF8);
+    return type;
+}
+
+void NWBFile::setStringAttribute (hid_t object, const char* name, const String& value)
+{
+    hid_t type = createStringType();
+    hid_t space = H5Screate (H5S_SCALAR);
+    hid_t attribute = H5Acreate2 (object, name, type, space, H5P_DEFAULT, H5P_DEFAULT);
+    const char* text = value.toRawUTF8();
+    H5Awrite (attribute, type, &text);
+    H5Aclose (attribute);
+    H5Sclose (space);
+    H5Tclose (type);
+}
+
+void NWBFile::setStringArrayAttribute (hid_t object, const char* name, const StringArray& values)
+{
+    Array<const char*> texts;
+    for (int i = 0; i < values.size(); i++)
+        texts.add (values[i].toRawUTF8());
+    hid_t type = createStringType();
+    hsize_t size = values.size();
+    hid_t space = H5Screate_simple (1, &size, nullptr);
+    hid_t attribute = H5Acreate2 (object, name, type, space, H5P_DEFAULT, H5P_DEFAULT);
+    H5Awrite (attribute, type, texts.getRawDataPointer());
+    H5Aclose (attribute);
+    H5Sclose (space);
+    H5Tclose (type);
+}
+
+void NWBFile::setAttribute (hid_t object, const char* name, hid_t type, const void* value)
+{
+    hid_t space = H5Screate (H5S_SCALAR);
+    hid_t attribute = H5Acreate2 (object, name, type, space, H5P_DEFAULT, H5P_DEFAULT);
+    H5Awrite (attribute, type, value);
+    H5Aclose (attribute);
+    H5Sclose (space);
+}
+
+void NWBFile::setNeurodataType (hid_t object, const char* neurodataType, const char* nameSpace)
+{
+    setStringAttribute (object, "namespace", nameSpace);
+    setStringAttribute (object, "neurodata_type", neurodataType);
+    setStringAttribute (object, "object_id", Uuid().toDashedString());
+}
+
+void NWBFile::setReferenceAttribute (hid_t object, const char* name, const char* path)
+{
+    hobj_ref_t reference;
+    H5Rcreate (&reference, file, path, H5R_OBJECT, -1);
+    setAttribute (object, name, H5T_STD_REF_OBJ, &reference);
+}
+
+void NWBFile::writeStringDataset (hid_t parent, const char* name, const StringArray& values, bool scalar)
+{
+    Array<const char*> texts;
+    for (int i = 0; i < values.size(); i++)
+        texts.add (values[i].toRawUTF8());
+    hid_t type = createStringType();
+    hsize_t size = values.size();
+    hid_t space = scalar ? H5Screate (H5S_SCALAR) : H5Screate_simple (1, &size, nullptr);
+    hid_t dataset = H5Dcreate2 (parent, name, type, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    if (values.size() > 0)
+        H5Dwrite (dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, texts.getRawDataPointer());
+    H5Dclose (dataset);
+    H5Sclose (space);
+    H5Tclose (type);
+}
+
+void NWBFile::writeDataset (hid_t parent, const char* name, hid_t type, hsize_t size, const void* values)
+{
+    hid_t space = H5Screate_simple (1, &size, nullptr);
+    hid_t dataset = H5Dcreate2 (parent, name, type, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    if (size > 0)
+        H5Dwrite (dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, values);
+    H5Dclose (dataset);
+    H5Sclose (space);
+}
+
+hid_t NWBFile::createGroup (hid_t parent, const char* name)
+{
+    return H5Gcreate2 (parent, name, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+}
+
+//Dataset
+
+NWBFile::Dataset::Dataset (hid_t parent, const char* name, hid_t type_, int rank_, const hsize_t* rowDims,
+                           hsize_t chunkRows, int compressionLevel)
+    : type (H5Tcopy (type_)), rank (rank_)
+{
+    hsize_t maxDims[3];
+    hsize_t chunk[3];
+    dims[0] = dims[1] = dims[2] = 0;
+    maxDims[0] = H5S_UNLIMITED;
+    chunk[0] = chunkRows;
+    for (int i = 1; i < rank; i++)
+        dims[i] = maxDims[i] = chunk[i] = rowDims[i - 1];
+
+    hid_t space = H5Screate_simple (rank, dims, maxDims);
+    hid_t properties = H5Pcreate (H5P_DATASET_CREATE);
+    H5Pset_chunk (properties, rank, chunk);
+    if (compressionLevel > 0)
+    {
+        H5Pset_shuffle (properties);
+        H5Pset_deflate (properties, compressionLevel);
+    }
+    id = H5Dcreate2 (parent, name, type, space, H5P_DEFAULT, properties, H5P_DEFAULT);
+    H5Pclose (properties);
+    H5Sclose (space);
+}
+
+NWBFile::Dataset::~Dataset()
+{
+    if (id >= 0)
+        H5Dclose (id);
+    H5Tclose (type);
+}
+
+void NWBFile::Dataset::append (const void* data, hsize_t numRows)
+{
+    if (id < 0 || numRows == 0)
+        return;
+
+    hsize_t newDims[3] = { dims[0] + numRows, dims[1], dims[2] };
+    H5Dset_extent (id, newDims);
+
+    hsize_t start[3] = { dims[0], 0, 0 };
+    hsize_t count[3] = { numRows, dims[1], dims[2] };
+    hid_t fileSpace = H5Dget_space (id);
+    H5Sselect_hyperslab (fileSpace, H5S_SELECT_SET, start, nullptr, count, nullptr);
+    hid_t memSpace = H5Screate_simple (rank, count, nullptr);
+    H5Dwrite (id, type, memSpace, fileSpace, H5P_DEFAULT, data);
+    H5Sclose (memSpace);
+    H5Sclose (fileSpace);
+    dims[0] = newDims[0];
+}
+
+hid_t NWBFile::Dataset::getId() const
+{
+    return id;
+}
@@ -0,0 +1,184 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef NWBFILE_H
+#define NWBFILE_H
+
+#include <RecordingLib.h>
+#include <hdf5.h>
+
+namespace NWBRecordingEngine
+{
+
+    /** Row of the electrodes table */
+    struct ElectrodeInfo
+    {
+        int group;
+        String filtering;
+    };
+
+    /** Electrode group, with the device it belongs to */
+    struct ElectrodeGroupInfo
+    {
+        String name;
+        String description;
+        String device;
+    };
+
+    struct ContinuousSeriesInfo
+    {
+        String name;
+        String description;
+        float sampleRate;
+        Array<float> bitVolts;
+        Array<int> electrodes;
+    };
+
+    struct EventSeriesInfo
+    {
+        enum Type { TTL_SERIES, TEXT_SERIES, BINARY_SERIES };
+
+        String name;
+        String description;
+        float sampleRate;
+        Type type;
+        /** Binary series only */
+        MetaDataDescriptor::MetaDataTypes dataType;
+        int length;
+    };
+
+    struct SpikeSeriesInfo
+    {
+        String name;
+        String description;
+        float sampleRate;
+        int numChannels;
+        int numSamples;
+        Array<int> electrodes;
+    };
+
+    /**
+        Writes a recording as an NWB 2.x file, through the HDF5 C library.
+
+        The file structure, electrodes table and series are all created before any data is
+        written. Every series then has datasets that grow along their first dimension, in
+        chunks compressed with the shuffle and deflate filters. Continuous series are
+        ElectricalSeries with int16 data and a channel_conversion to volts, spikes are
+        SpikeEventSeries, TTL and binary events are TimeSeries and text events are
+        AnnotationSeries. All timestamps are in seconds from the start of acquisition.
+
+        HDF5 is not thread-safe, so a file must only be used by one thread at a time.
+
+        @see NWBRecording
+    */
+    class NWBFile
+    {
+    public:
+        NWBFile (const String& path, int compressionLevel);
+        ~NWBFile();
+
+        /** Creates the file, its required groups and datasets, and the electrodes table */
+        bool open (const String& identifier, const String& sessionDescription, Time startTime,
+                   const Array<ElectrodeGroupInfo>& groups, const Array<ElectrodeInfo>& electrodes);
+        void close();
+        bool isOpen() const;
+
+        /** Add the series to the acquisition group, returning their index */
+        int addContinuousSeries (const ContinuousSeriesInfo& info);
+        int addEventSeries (const EventSeriesInfo& info);
+        int addSpikeSeries (const SpikeSeriesInfo& info);
+
+        /** Appends numFrames frames of interleaved samples, with the timestamp of each frame in samples */
+        void writeContinuous (int series, const int16* data, const int64* timestamps, int numFrames);
+        /** Appends an event. TTL series take an int16 state, text series a null-terminated string
+            and binary series length values of their type */
+        void writeEvent (int series, double time, const void* data);
+        /** Appends a spike of numChannels * numSamples values, in microvolts */
+        void writeSpike (int series, double time, const float* waveform);
+
+    private:
+        /** A dataset that grows along its first dimension */
+        class Dataset
+        {
+        public:
+            Dataset (hid_t parent, const char* name, hid_t type, int rank, const hsize_t* rowDims, hsize_t chunkRows, int compressionLevel);
+            ~Dataset();
+            void append (const void* data, hsize_t numRows);
+            hid_t getId() const;
+
+        private:
+            hid_t id;
+            hid_t type;
+            int rank;
+            hsize_t dims[3];
+        };
+
+        struct Series
+        {
+            Series() : group (-1), sampleRate (0), rowSize (0), timesSize (0), isText (false) {}
+            ~Series()
+            {
+                data = nullptr;
+                timestamps = nullptr;
+                if (group >= 0)
+                    H5Gclose (group);
+            }
+
+            hid_t group;
+            ScopedPointer<Dataset> data;
+            ScopedPointer<Dataset> timestamps;
+            float sampleRate;
+            int rowSize;
+            HeapBlock<double> times;
+            int timesSize;
+            bool isText;
+        };
+
+        hid_t createSeries (Series* series, const String& name, const char* neurodataType, const String& description, float sampleRate);
+        void writeElectrodes (hid_t parent, const Array<int>& electrodes);
+        void appendTimes (Series* series, const int64* timestamps, int numFrames);
+
+        static hid_t getH5Type (MetaDataDescriptor::MetaDataTypes type);
+        static hid_t createStringType();
+
+        static void setStringAttribute (hid_t object, const char* name, const String& value);
+        static void setStringArrayAttribute (hid_t object, const char* name, const StringArray& values);
+        static void setAttribute (hid_t object, const char* name, hid_t type, const void* value);
+        static void setNeurodataType (hid_t object, const char* neurodataType, const char* nameSpace);
+        void setReferenceAttribute (hid_t object, const char* name, const char* path);
+        static void writeStringDataset (hid_t parent, const char* name, const StringArray& values, bool scalar);
+        static void writeDataset (hid_t parent, const char* name, hid_t type, hsize_t size, const void* values);
+        static hid_t createGroup (hid_t parent, const char* name);
+
+        const String path;
+        const int compressionLevel;
+        hid_t file;
+        OwnedArray<Series> series;
+        int numElectrodes;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NWBFile);
+    };
+
+}
+
+#endif
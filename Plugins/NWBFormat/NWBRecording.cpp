@@ -0,0 +1,376 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "NWBRecording.h"
+#include <DataThreadHeaders.h>
+
+using namespace NWBRecordingEngine;
+
+NWBRecording::NWBRecording()
+    : m_syncSeries (-1)
+{
+}
+
+NWBRecording::~NWBRecording()
+{
+    closeFiles();
+}
+
+String NWBRecording::getEngineID() const
+{
+    return "NWB2";
+}
+
+String NWBRecording::getSeriesName (const InfoObjectCommon* channelInfo)
+{
+    String name = channelInfo->getCurrentNodeName().replaceCharacter (' ', '_') + "-" + String (channelInfo->getCurrentNodeID());
+    if (channelInfo->getCurrentNodeID() != channelInfo->getSourceNodeID())
+        name += "_" + String (channelInfo->getSourceNodeID());
+    name += "." + String (channelInfo->getSubProcessorIdx());
+    //Slashes would make HDF5 paths
+    return name.replaceCharacter ('/', '_');
+}
+
+void NWBRecording::openFiles (File rootFolder, int experimentNumber, int recordingNumber)
+{
+    String path = rootFolder.getFullPathName() + File::separatorString + "experiment" + String (experimentNumber)
+        + "_recording" + String (recordingNumber + 1) + ".nwb";
+
+    Array<ElectrodeGroupInfo> groups;
+    Array<ElectrodeInfo> electrodes;
+
+    //One series per source processor, as the Binary format continuous files
+    int nChans = getNumRecordedChannels();
+    m_blockIndexes.insertMultiple (0, 0, nChans);
+    m_channelIndexes.insertMultiple (0, 0, nChans);
+    Array<ContinuousSeriesInfo> continuousSeries;
+    Array<const DataChannel*> seriesSources;
+    int nProcessors = getNumRecordedProcessors();
+    int lastId = 0;
+    for (int proc = 0; proc < nProcessors; proc++)
+    {
+        const RecordProcessorInfo& pInfo = getProcessorInfo (proc);
+        for (int chan = 0; chan < pInfo.recordedChannels.size(); chan++)
+        {
+            int recordedChan = pInfo.recordedChannels[chan];
+            const DataChannel* channelInfo = getDataChannel (getRealChannel (recordedChan));
+            int index = -1;
+            for (int i = lastId; i < seriesSources.size(); i++)
+            {
+                if (channelInfo->getSourceNodeID() == seriesSources[i]->getSourceNodeID()
+                    && channelInfo->getSubProcessorIdx() == seriesSources[i]->getSubProcessorIdx())
+                {
+                    index = i;
+                    break;
+                }
+            }
+            if (index < 0)
+            {
+                index = seriesSources.size();
+                seriesSources.add (channelInfo);
+
+                ContinuousSeriesInfo info;
+                info.name = getSeriesName (channelInfo);
+                info.description = "Continuous data from " + channelInfo->getSourceName();
+                info.sampleRate = channelInfo->getSampleRate();
+                continuousSeries.add (info);
+
+                ElectrodeGroupInfo group;
+                group.name = info.name;
+                group.description = info.description;
+                group.device = channelInfo->getSourceName().replaceCharacter ('/', '_');
+                groups.add (group);
+            }
+            ContinuousSeriesInfo& info = continuousSeries.getReference (index);
+            m_blockIndexes.set (recordedChan, index);
+            m_channelIndexes.set (recordedChan, info.bitVolts.size());
+            info.bitVolts.add (channelInfo->getBitVolts());
+            info.electrodes.add (electrodes.size());
+
+            ElectrodeInfo electrode;
+            electrode.group = index;
+            electrode.filtering = channelInfo->getHistoricString();
+            electrodes.add (electrode);
+        }
+        lastId = seriesSources.size();
+    }
+
+    //Spike channels have electrode groups of their own
+    int nSpikes = getNumRecordedSpikes();
+    Array<SpikeSeriesInfo> spikeSeries;
+    std::map<uint32, int> groupMap;
+    for (int sp = 0; sp < nSpikes; sp++)
+    {
+        const SpikeChannel* ch = getSpikeChannel (sp);
+        uint32 procID = GenericProcessor::getProcessorFullId (ch->getSourceNodeID(), ch->getSubProcessorIdx());
+
+        SpikeSeriesInfo info;
+        info.name = getSeriesName (ch) + "_spike_group_" + String (++groupMap[procID]);
+        info.description = ch->getName();
+        info.sampleRate = ch->getSampleRate();
+        info.numChannels = ch->getNumChannels();
+        info.numSamples = ch->getTotalSamples();
+        for (int i = 0; i < info.numChannels; i++)
+        {
+            info.electrodes.add (electrodes.size());
+            ElectrodeInfo electrode;
+            electrode.group = groups.size();
+            electrodes.add (electrode);
+        }
+        spikeSeries.add (info);
+
+        ElectrodeGroupInfo group;
+        group.name = info.name;
+        group.description = ch->getName();
+        group.device = ch->getSourceName().replaceCharacter ('/', '_');
+        groups.add (group);
+    }
+
+    m_file = new NWBFile (path, m_compressionLevel);
+    if (!m_file->open (Uuid().toDashedString(), "Recorded with the Open Ephys GUI " + CoreServices::getGUIVersion(),
+                       Time::getCurrentTime(), groups, electrodes))
+    {
+        m_file = nullptr;
+        return;
+    }
+
+    for (int i = 0; i < continuousSeries.size(); i++)
+    {
+        ContinuousBlock* block = new ContinuousBlock();
+        block->series = m_file->addContinuousSeries (continuousSeries.getReference (i));
+        block->numChannels = continuousSeries.getReference (i).bitVolts.size();
+        block->size = 0;
+        block->numFrames.insertMultiple (0, 0, block->numChannels);
+        m_continuousBlocks.add (block);
+    }
+
+    int nEvents = getNumRecordedEvents();
+    for (int ev = 0; ev < nEvents; ev++)
+    {
+        const EventChannel* chan = getEventChannel (ev);
+        EventSeriesInfo info;
+        info.name = getSeriesName (chan);
+        switch (chan->getChannelType())
+        {
+        case EventChannel::TEXT:
+            info.name += "_TEXT_group";
+            info.type = EventSeriesInfo::TEXT_SERIES;
+            break;
+        case EventChannel::TTL:
+            info.name += "_TTL";
+            info.type = EventSeriesInfo::TTL_SERIES;
+            break;
+        default:
+            info.name += "_BINARY_group";
+            info.type = EventSeriesInfo::BINARY_SERIES;
+            break;
+        }
+        info.name += "_" + String (chan->getSourceIndex() + 1);
+        info.description = chan->getName() + ": " + chan->getDescription();
+        info.sampleRate = chan->getSampleRate();
+        info.dataType = chan->getEquivalentMetaDataType();
+        info.length = chan->getLength();
+        m_eventSeries.add (m_file->addEventSeries (info));
+    }
+
+    for (int i = 0; i < spikeSeries.size(); i++)
+        m_spikeSeries.add (m_file->addSpikeSeries (spikeSeries.getReference (i)));
+
+    EventSeriesInfo syncInfo;
+    syncInfo.name = "sync_messages";
+    syncInfo.description = "Timestamp sync text of the sources";
+    syncInfo.sampleRate = 0;
+    syncInfo.type = EventSeriesInfo::TEXT_SERIES;
+    syncInfo.dataType = MetaDataDescriptor::CHAR;
+    syncInfo.length = 0;
+    m_syncSeries = m_file->addEventSeries (syncInfo);
+
+    m_writer = new NWBWriter (m_file, int64 (m_queueMegabytes) << 20);
+    m_writer->startThread();
+}
+
+void NWBRecording::closeFiles()
+{
+    //The writer must be done with the file before it is closed
+    if (m_writer)
+        m_writer->finish();
+    m_writer = nullptr;
+    m_file = nullptr;
+    resetChannels();
+}
+
+void NWBRecording::resetChannels()
+{
+    m_continuousBlocks.clear();
+    m_blockIndexes.clear();
+    m_channelIndexes.clear();
+    m_eventSeries.clear();
+    m_spikeSeries.clear();
+    m_syncSeries = -1;
+}
+
+void NWBRecording::writeData (int writeChannel, int realChannel, const float* buffer, int size)
+{
+    if (!m_writer)
+        return;
+    ContinuousBlock* block = m_continuousBlocks[m_blockIndexes[writeChannel]];
+    int column = m_channelIndexes[writeChannel];
+    int position = block->numFrames[column];
+    //Blocks grow to the largest the record thread writes, and are reused afterwards
+    if (position + size > block->size)
+    {
+        block->size = position + size;
+        block->samples.realloc (block->size * block->numChannels);
+        block->timestamps.realloc (block->size);
+    }
+
+    float scale = 1.0f / getDataChannel (realChannel)->getBitVolts();
+    SampleConversion::convertFloatToInt16 (block->samples + position * block->numChannels + column,
+                                           block->numChannels, buffer, size, scale);
+    //Every frame has its timestamp, so snippets and dropped samples need nothing else
+    if (column == 0)
+    {
+        int64 baseTS = getTimestamp (writeChannel);
+        for (int i = 0; i < size; i++)
+            block->timestamps[position + i] = baseTS + i;
+    }
+    block->numFrames.set (column, position + size);
+}
+
+void NWBRecording::endChannelBlock (bool lastBlock)
+{
+    if (!m_writer)
+        return;
+    for (int i = 0; i < m_continuousBlocks.size(); i++)
+    {
+        ContinuousBlock* block = m_continuousBlocks[i];
+        int numFrames = block->numFrames[0];
+        if (numFrames > 0)
+        {
+            NWBWriter::Job* job = m_writer->getJob();
+            job->type = NWBWriter::Job::CONTINUOUS;
+            job->series = block->series;
+            job->numFrames = numFrames;
+            job->data.replaceWith (block->samples, numFrames * block->numChannels * sizeof (int16));
+            job->timestamps.replaceWith (block->timestamps, numFrames * sizeof (int64));
+            m_writer->submit (job);
+        }
+        for (int c = 0; c < block->numChannels; c++)
+            block->numFrames.set (c, 0);
+    }
+}
+
+void NWBRecording::submitEvent (int series, int64 timestamp, float sampleRate, const void* data, size_t dataSize, bool text)
+{
+    NWBWriter::Job* job = m_writer->getJob();
+    job->type = NWBWriter::Job::EVENT;
+    job->series = series;
+    job->time = double (timestamp) / sampleRate;
+    if (text)
+    {
+        //Text events are not always null-terminated
+        job->data.setSize (dataSize + 1);
+        job->data.copyFrom (data, 0, dataSize);
+        static_cast<char*> (job->data.getData())[dataSize] = 0;
+    }
+    else
+        job->data.replaceWith (data, dataSize);
+    m_writer->submit (job);
+}
+
+void NWBRecording::writeEvent (int eventIndex, const MidiMessage& event)
+{
+    if (!m_writer)
+        return;
+    const EventChannel* info = getEventChannel (eventIndex);
+    EventPtr ev = Event::deserializeFromMessage (event, info);
+    if (!ev)
+        return;
+    int series = m_eventSeries[eventIndex];
+    float sampleRate = info->getSampleRate();
+
+    if (info->isBatched())
+    {
+        //Each record is an event of its own, as in the Binary format
+        BinaryEvent* batch = static_cast<BinaryEvent*> (ev.get());
+        for (int r = 0; r < batch->getNumRecords(); r++)
+            submitEvent (series, batch->getRecordTimestamp (r), sampleRate, batch->getRecordPointer (r), info->getRecordSize(), false);
+        return;
+    }
+
+    if (ev->getEventType() == EventChannel::TTL)
+    {
+        TTLEvent* ttl = static_cast<TTLEvent*> (ev.get());
+        int16 data = (ttl->getChannel() + 1) * (ttl->getState() ? 1 : -1);
+        submitEvent (series, ev->getTimestamp(), sampleRate, &data, sizeof (int16), false);
+    }
+    else
+        submitEvent (series, ev->getTimestamp(), sampleRate, ev->getRawDataPointer(), info->getDataSize(),
+                     ev->getEventType() == EventChannel::TEXT);
+}
+
+void NWBRecording::writeTimestampSyncText (uint16 sourceID, uint16 sourceIdx, int64 timestamp, float sourceSampleRate, String text)
+{
+    if (!m_writer)
+        return;
+    submitEvent (m_syncSeries, timestamp, sourceSampleRate, text.toRawUTF8(), text.getNumBytesAsUTF8(), true);
+}
+
+void NWBRecording::addSpikeElectrode (int index, const SpikeChannel* elec)
+{
+}
+
+void NWBRecording::writeSpike (int electrodeIndex, const SpikeEvent* spike)
+{
+    if (!m_writer)
+        return;
+    const SpikeChannel* channel = getSpikeChannel (electrodeIndex);
+    NWBWriter::Job* job = m_writer->getJob();
+    job->type = NWBWriter::Job::SPIKE;
+    job->series = m_spikeSeries[electrodeIndex];
+    job->time = double (spike->getTimestamp()) / channel->getSampleRate();
+    job->data.replaceWith (spike->getDataPointer(), channel->getNumChannels() * channel->getTotalSamples() * sizeof (float));
+    m_writer->submit (job);
+}
+
+bool NWBRecording::supportsSnippetRecording() const
+{
+    return true;
+}
+
+RecordEngineManager* NWBRecording::getEngineManager()
+{
+    RecordEngineManager* man = new RecordEngineManager ("NWB2", "NWB 2", &(engineFactory<NWBRecording>));
+    EngineParameter* param;
+    param = new EngineParameter (EngineParameter::INT, 0, "Compression level (0 for none)", 1, 0, 9);
+    man->addParameter (param);
+    param = new EngineParameter (EngineParameter::INT, 1, "Writer queue size (MB)", 64, 1, 4096);
+    man->addParameter (param);
+    return man;
+}
+
+void NWBRecording::setParameter (EngineParameter& parameter)
+{
+    intParameter (0, m_compressionLevel);
+    intParameter (1, m_queueMegabytes);
+}
@@ -0,0 +1,98 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#ifndef NWBRECORDING_H
+#define NWBRECORDING_H
+
+#include <RecordingLib.h>
+#include "NWBFile.h"
+#include "NWBWriter.h"
+
+namespace NWBRecordingEngine
+{
+
+    /**
+        Records to a single NWB 2.x file per recording.
+
+        The continuous channels of each source processor are one ElectricalSeries, in the
+        same groups as the Binary format files, each event channel is a TimeSeries or an
+        AnnotationSeries and each spike channel a SpikeEventSeries. Samples are converted to
+        int16 interleaved frames on the record thread, and every HDF5 call runs on an
+        NWBWriter thread.
+
+        @see NWBFile, NWBWriter
+    */
+    class NWBRecording : public RecordEngine
+    {
+    public:
+        NWBRecording();
+        ~NWBRecording();
+
+        String getEngineID() const override;
+        void openFiles (File rootFolder, int experimentNumber, int recordingNumber) override;
+        void closeFiles() override;
+        void writeData (int writeChannel, int realChannel, const float* buffer, int size) override;
+        void endChannelBlock (bool lastBlock) override;
+        void writeEvent (int eventIndex, const MidiMessage& event) override;
+        void resetChannels() override;
+        void addSpikeElectrode (int index, const SpikeChannel* elec) override;
+        void writeSpike (int electrodeIndex, const SpikeEvent* spike) override;
+        void writeTimestampSyncText (uint16 sourceID, uint16 sourceIdx, int64 timestamp, float sourceSampleRate, String text) override;
+        void setParameter (EngineParameter& parameter) override;
+        bool supportsSnippetRecording() const override;
+
+        static RecordEngineManager* getEngineManager();
+
+    private:
+        /** The frames of a continuous series written in the current block */
+        struct ContinuousBlock
+        {
+            int series;
+            int numChannels;
+            HeapBlock<int16> samples;
+            HeapBlock<int64> timestamps;
+            int size;
+            /** Frames written so far in this block, per channel */
+            Array<int> numFrames;
+        };
+
+        static String getSeriesName (const InfoObjectCommon* channelInfo);
+        void submitEvent (int series, int64 timestamp, float sampleRate, const void* data, size_t dataSize, bool text);
+
+        int m_compressionLevel{ 1 };
+        int m_queueMegabytes{ 64 };
+
+        ScopedPointer<NWBFile> m_file;
+        ScopedPointer<NWBWriter> m_writer;
+
+        OwnedArray<ContinuousBlock> m_continuousBlocks;
+        Array<int> m_blockIndexes;
+        Array<int> m_channelIndexes;
+        Array<int> m_eventSeries;
+        Array<int> m_spikeSeries;
+        int m_syncSeries;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,129 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "NWBWriter.h"
+#include <ProcessorHeaders.h>
+
+using namespace NWBRecordingEngine;
+
+NWBWriter::NWBWriter (NWBFile* file_, int64 queueLimitBytes)
+    : Thread ("NWB Writer"), file (file_), queueLimit (queueLimitBytes), queuedBytes (0)
+{
+}
+
+NWBWriter::~NWBWriter()
+{
+    finish();
+}
+
+NWBWriter::Job* NWBWriter::getJob()
+{
+    const ScopedLock sl (queueLock);
+    if (unused.size() > 0)
+        return unused.remove (unused.size() - 1);
+    return jobs.add (new Job());
+}
+
+void NWBWriter::submit (Job* job)
+{
+    for (;;)
+    {
+        {
+            const ScopedLock sl (queueLock);
+            if (queuedBytes < queueLimit || !isThreadRunning())
+            {
+                queued.add (job);
+                queuedBytes += getJobSize (job);
+                break;
+            }
+        }
+        jobWritten.wait (100);
+    }
+    notify();
+}
+
+void NWBWriter::finish()
+{
+    if (isThreadRunning())
+    {
+        signalThreadShouldExit();
+        notify();
+        stopThread (-1);
+    }
+    //Whatever was queued after the thread stopped
+    while (queued.size() > 0)
+        write (queued.remove (0));
+    queuedBytes = 0;
+}
+
+void NWBWriter::run()
+{
+    ThreadPolicy::applyToCurrentThread(ThreadPolicy::Writer);
+
+    for (;;)
+    {
+        Job* job = nullptr;
+        {
+            const ScopedLock sl (queueLock);
+            if (queued.size() > 0)
+                job = queued.remove (0);
+        }
+        if (job == nullptr)
+        {
+            if (threadShouldExit())
+                return;
+            wait (100);
+            continue;
+        }
+
+        write (job);
+        {
+            const ScopedLock sl (queueLock);
+            queuedBytes -= getJobSize (job);
+            unused.add (job);
+        }
+        jobWritten.signal();
+    }
+}
+
+void NWBWriter::write (Job* job)
+{
+    switch (job->type)
+    {
+    case Job::CONTINUOUS:
+        file->writeContinuous (job->series, static_cast<const int16*> (job->data.getData()),
+                               static_cast<const int64*> (job->timestamps.getData()), job->numFrames);
+        break;
+    case Job::EVENT:
+        file->writeEvent (job->series, job->time, job->data.getData());
+        break;
+    case Job::SPIKE:
+        file->writeSpike (job->series, job->time, static_cast<const float*> (job->data.getData()));
+        break;
+    }
+}
+
+int64 NWBWriter::getJobSize (const Job* job)
+{
+    return job->data.getSize() + job->timestamps.getSize();
+}
@@ -0,0 +1,91 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#ifndef NWBWRITER_H
+#define NWBWRITER_H
+
+#include "NWBFile.h"
+
+namespace NWBRecordingEngine
+{
+
+    /**
+        Runs all the HDF5 calls of an NWBFile on a thread of its own, so the record thread
+        never waits on compression or on the HDF5 library.
+
+        The record engine takes a job, fills its buffers and submits it; the writer thread
+        writes the jobs in the order they were submitted and then hands them back for reuse,
+        so no memory is allocated once the buffers have grown to their working size. When
+        more than the queue limit is waiting to be written, submit() blocks until the
+        writer has caught up.
+
+        @see NWBRecording, NWBFile
+    */
+    class NWBWriter : public Thread
+    {
+    public:
+        struct Job
+        {
+            enum Type { CONTINUOUS, EVENT, SPIKE };
+
+            Type type;
+            int series;
+            /** Continuous jobs: frames of interleaved int16 samples, with a timestamp each */
+            int numFrames;
+            MemoryBlock timestamps;
+            /** Event and spike jobs: time in seconds */
+            double time;
+            MemoryBlock data;
+        };
+
+        NWBWriter (NWBFile* file, int64 queueLimitBytes);
+        ~NWBWriter();
+
+        /** Gets an unused job, to be filled and submitted */
+        Job* getJob();
+        /** Queues a job for writing, waiting first for the queue to drop below its limit */
+        void submit (Job* job);
+
+        /** Writes all the queued jobs and stops the thread */
+        void finish();
+
+    private:
+        void run() override;
+        void write (Job* job);
+        static int64 getJobSize (const Job* job);
+
+        NWBFile* const file;
+        const int64 queueLimit;
+
+        CriticalSection queueLock;
+        OwnedArray<Job> jobs;
+        Array<Job*> queued;
+        Array<Job*> unused;
+        int64 queuedBytes;
+        WaitableEvent jobWritten;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NWBWriter);
+    };
+
+}
+
+#endif
@@ -0,0 +1,132 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "NetworkSourceEditor.h"
+#include "NetworkThread.h"
+
+using namespace NetworkSource;
+
+NetworkSourceEditor::NetworkSourceEditor(GenericProcessor* parentNode, NetworkThread* thread_)
+	: GenericEditor(parentNode, false), thread(thread_)
+{
+	desiredWidth = 180;
+
+	portLabel = addSetting("Port", String(thread->getPort()), 25);
+	groupLabel = addSetting("Group", thread->getMulticastGroup(), 45);
+	groupLabel->setTooltip("Multicast group to join, leave empty to receive datagrams sent to this machine");
+	channelsLabel = addSetting("Channels", String(thread->getNumChannels()), 65);
+	sampleRateLabel = addSetting("Rate (Hz)", String(thread->getSampleRate(0)), 85);
+	bitVoltsLabel = addSetting("uV/bit", String(thread->getBitVolts(nullptr)), 105);
+	bitVoltsLabel->setTooltip("Scale of int16 samples, float samples are taken as microvolts");
+}
+
+Label* NetworkSourceEditor::addSetting(const String& name, const String& value, int y)
+{
+	Label* title = new Label(name, name);
+	title->setFont(Font("Small Text", 10, Font::plain));
+	title->setBounds(10, y, 60, 18);
+	title->setColour(Label::textColourId, Colours::darkgrey);
+	addAndMakeVisible(title);
+	staticLabels.add(title);
+
+	Label* setting = new Label(name + " value", value);
+	setting->setFont(Font("Small Text", 10, Font::plain));
+	setting->setEditable(true, false, false);
+	setting->addListener(this);
+	setting->setBounds(70, y, 100, 18);
+	setting->setColour(Label::textColourId, Colours::darkgrey);
+	setting->setColour(Label::backgroundColourId, Colours::lightgrey);
+	addAndMakeVisible(setting);
+	return setting;
+}
+
+void NetworkSourceEditor::labelTextChanged(Label* label)
+{
+	updateSettings();
+}
+
+void NetworkSourceEditor::updateSettings()
+{
+	int numChannels = thread->getNumChannels();
+	float sampleRate = thread->getSampleRate(0);
+	float bitVolts = thread->getBitVolts(nullptr);
+
+	thread->setPort(jlimit(1, 65535, portLabel->getText().getIntValue()));
+	thread->setMulticastGroup(groupLabel->getText());
+	thread->setNumChannels(channelsLabel->getText().getIntValue());
+	thread->setSampleRate(sampleRateLabel->getText().getFloatValue());
+	thread->setBitVolts(bitVoltsLabel->getText().getFloatValue());
+
+	portLabel->setText(String(thread->getPort()), dontSendNotification);
+	channelsLabel->setText(String(thread->getNumChannels()), dontSendNotification);
+	sampleRateLabel->setText(String(thread->getSampleRate(0)), dontSendNotification);
+	bitVoltsLabel->setText(String(thread->getBitVolts(nullptr)), dontSendNotification);
+
+	if (numChannels != thread->getNumChannels() || sampleRate != thread->getSampleRate(0) || bitVolts != thread->getBitVolts(nullptr))
+		CoreServices::updateSignalChain(this);
+}
+
+void NetworkSourceEditor::startAcquisition()
+{
+	portLabel->setEnabled(false);
+	groupLabel->setEnabled(false);
+	channelsLabel->setEnabled(false);
+	sampleRateLabel->setEnabled(false);
+	bitVoltsLabel->setEnabled(false);
+}
+
+void NetworkSourceEditor::stopAcquisition()
+{
+	portLabel->setEnabled(true);
+	groupLabel->setEnabled(true);
+	channelsLabel->setEnabled(true);
+	sampleRateLabel->setEnabled(true);
+	bitVoltsLabel->setEnabled(true);
+}
+
+void NetworkSourceEditor::saveCustomParameters(XmlElement* xml)
+{
+	XmlElement* parameters = xml->createNewChildElement("PARAMETERS");
+
+	parameters->setAttribute("port", thread->getPort());
+	parameters->setAttribute("group", thread->getMulticastGroup());
+	parameters->setAttribute("channels", thread->getNumChannels());
+	parameters->setAttribute("sampleRate", thread->getSampleRate(0));
+	parameters->setAttribute("bitVolts", thread->getBitVolts(nullptr));
+}
+
+void NetworkSourceEditor::loadCustomParameters(XmlElement* xml)
+{
+	forEachXmlChildElement(*xml, subNode)
+	{
+		if (subNode->hasTagName("PARAMETERS"))
+		{
+			portLabel->setText(subNode->getStringAttribute("port", String(thread->getPort())), dontSendNotification);
+			groupLabel->setText(subNode->getStringAttribute("group"), dontSendNotification);
+			channelsLabel->setText(subNode->getStringAttribute("channels", String(thread->getNumChannels())), dontSendNotification);
+			sampleRateLabel->setText(subNode->getStringAttribute("sampleRate", String(thread->getSampleRate(0))), dontSendNotification);
+			bitVoltsLabel->setText(subNode->getStringAttribute("bitVolts", String(thread->getBitVolts(nullptr))), dontSendNotification);
+			updateSettings();
+		}
+	}
+}
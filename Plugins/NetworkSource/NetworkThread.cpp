@@ -0,0 +1,283 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "NetworkThread.h"
+#include "NetworkSourceEditor.h"
+
+using namespace NetworkSource;
+
+DataThread* NetworkThread::createDataThread(SourceNode* sn)
+{
+	return new NetworkThread(sn);
+}
+
+NetworkThread::NetworkThread(SourceNode* sn) : DataThread(sn),
+	port(5000), numChannels(32), sampleRate(30000.0f), bitVolts(0.195f),
+	nextSampleIndex(-1), numPackets(0), numBadPackets(0), numLatePackets(0),
+	numLostSamples(0), lastSenderTimestamp(0)
+{
+	packetBuffer.malloc(MAX_PACKET_BYTES);
+	sourceBuffers.add(new DataBuffer(numChannels, 10000));
+}
+
+NetworkThread::~NetworkThread()
+{
+	if (isThreadRunning())
+		stopAcquisition();
+}
+
+GenericEditor* NetworkThread::createEditor(SourceNode* sn)
+{
+	return new NetworkSourceEditor(sn, this);
+}
+
+bool NetworkThread::foundInputSource()
+{
+	// datagrams can't be probed for, the socket is opened when acquisition starts
+	return true;
+}
+
+int NetworkThread::getNumDataOutputs(DataChannel::DataChannelTypes type, int subProcessorIdx) const
+{
+	if (subProcessorIdx > 0 || type != DataChannel::HEADSTAGE_CHANNEL)
+		return 0;
+	return numChannels;
+}
+
+int NetworkThread::getNumTTLOutputs(int subProcessorIdx) const
+{
+	return 0;
+}
+
+float NetworkThread::getSampleRate(int subProcessorIdx) const
+{
+	return sampleRate;
+}
+
+float NetworkThread::getBitVolts(const DataChannel* chan) const
+{
+	return bitVolts;
+}
+
+void NetworkThread::resizeBuffers()
+{
+	sourceBuffers[0]->resize(numChannels, 10000);
+}
+
+void NetworkThread::setPort(int port_)
+{
+	port = port_;
+}
+
+int NetworkThread::getPort() const
+{
+	return port;
+}
+
+void NetworkThread::setMulticastGroup(const String& group)
+{
+	multicastGroup = group.trim();
+}
+
+String NetworkThread::getMulticastGroup() const
+{
+	return multicastGroup;
+}
+
+void NetworkThread::setNumChannels(int numChannels_)
+{
+	numChannels = jmax(1, numChannels_);
+}
+
+int NetworkThread::getNumChannels() const
+{
+	return numChannels;
+}
+
+void NetworkThread::setSampleRate(float sampleRate_)
+{
+	if (sampleRate_ > 0)
+		sampleRate = sampleRate_;
+}
+
+void NetworkThread::setBitVolts(float bitVolts_)
+{
+	if (bitVolts_ > 0)
+		bitVolts = bitVolts_;
+}
+
+NetworkThread::Stats NetworkThread::getStats() const
+{
+	Stats stats;
+	stats.numPackets = numPackets;
+	stats.numBadPackets = numBadPackets;
+	stats.numLatePackets = numLatePackets;
+	stats.numLostSamples = numLostSamples;
+	stats.lastSenderTimestamp = lastSenderTimestamp;
+	return stats;
+}
+
+bool NetworkThread::startAcquisition()
+{
+	socket = new DatagramSocket(false);
+
+	// several hosts can listen to the same multicast stream
+	if (multicastGroup.isNotEmpty())
+		socket->setEnablePortReuse(true);
+
+	if (!socket->bindToPort(port))
+	{
+		std::cerr << "Network source: could not bind to UDP port " << port << std::endl;
+		socket = nullptr;
+		return false;
+	}
+
+	if (multicastGroup.isNotEmpty() && !socket->joinMulticast(multicastGroup))
+	{
+		std::cerr << "Network source: could not join multicast group " << multicastGroup << std::endl;
+		socket = nullptr;
+		return false;
+	}
+
+	std::cout << "Network source listening on port " << port
+		<< (multicastGroup.isNotEmpty() ? " in group " + multicastGroup : String::empty) << std::endl;
+
+	nextSampleIndex = -1;
+	numPackets = 0;
+	numBadPackets = 0;
+	numLatePackets = 0;
+	numLostSamples = 0;
+
+	startThread();
+	return true;
+}
+
+bool NetworkThread::stopAcquisition()
+{
+	signalThreadShouldExit();
+
+	// wakes up a blocking read
+	if (socket != nullptr)
+		socket->shutdown();
+
+	if (!waitForThreadToExit(500))
+		std::cout << "Network source thread failed to exit, continuing anyway..." << std::endl;
+
+	if (socket != nullptr && multicastGroup.isNotEmpty())
+		socket->leaveMulticast(multicastGroup);
+	socket = nullptr;
+
+	Stats stats = getStats();
+	std::cout << "Network source received " << stats.numPackets << " packets, " << stats.numBadPackets << " bad, "
+		<< stats.numLatePackets << " late, " << stats.numLostSamples << " samples lost." << std::endl;
+
+	sourceBuffers[0]->clear();
+	return true;
+}
+
+bool NetworkThread::updateBuffer()
+{
+	// time out now and then so the thread can exit
+	if (socket->waitUntilReady(true, 100) != 1)
+		return true;
+
+	int numBytes = socket->read(packetBuffer, MAX_PACKET_BYTES, false);
+	if (numBytes < int(sizeof(NetworkPacket::Header)))
+	{
+		if (numBytes > 0)
+			numBadPackets++;
+		return true;
+	}
+
+	NetworkPacket::Header header;
+	memcpy(&header, packetBuffer, sizeof(NetworkPacket::Header));
+
+	if (header.magic == NETWORK_PACKET_MAGIC && header.format == NetworkPacket::EVENTS)
+		return true;
+
+	const int sampleBytes = header.format == NetworkPacket::FLOAT32_SAMPLES ? 4 : 2;
+	if (header.magic != NETWORK_PACKET_MAGIC || header.version != NETWORK_PACKET_VERSION
+		|| header.format > NetworkPacket::FLOAT32_SAMPLES || header.numChannels != numChannels
+		|| numBytes < int(sizeof(NetworkPacket::Header)) + int(header.numSamples) * numChannels * sampleBytes)
+	{
+		numBadPackets++;
+		return true;
+	}
+
+	if (nextSampleIndex >= 0 && header.sampleIndex < nextSampleIndex)
+	{
+		numLatePackets++;
+		return true;
+	}
+
+	if (nextSampleIndex >= 0)
+		numLostSamples += header.sampleIndex - nextSampleIndex;
+
+	numPackets++;
+	lastSenderTimestamp = header.timestamp;
+
+	ingestPacket(header, packetBuffer + sizeof(NetworkPacket::Header));
+	nextSampleIndex = header.sampleIndex + header.numSamples;
+
+	return true;
+}
+
+void NetworkThread::ingestPacket(const NetworkPacket::Header& header, const char* samples)
+{
+	DataBuffer* buffer = sourceBuffers[0];
+
+	// frames that don't fit are counted as dropped by the buffer stats
+	DataBuffer::WriteSpans spans;
+	buffer->prepareToWrite(spans, header.numSamples);
+
+	int frame = 0;
+	for (int region = 0; region < 2; region++)
+	{
+		const int blockSize = spans.blockSize[region];
+		if (blockSize <= 0)
+			continue;
+
+		for (int chan = 0; chan < numChannels; chan++)
+		{
+			float* dest = buffer->getWritePointer(spans, chan, region);
+
+			if (header.format == NetworkPacket::FLOAT32_SAMPLES)
+			{
+				const float* src = reinterpret_cast<const float*>(samples) + frame * numChannels + chan;
+				SampleConversion::gather(dest, src, numChannels, blockSize);
+			}
+			else
+			{
+				const int16* src = reinterpret_cast<const int16*>(samples) + frame * numChannels + chan;
+				for (int k = 0; k < blockSize; k++)
+					dest[k] = float(src[k * numChannels]) * bitVolts;
+			}
+		}
+
+		frame += blockSize;
+	}
+
+	// event codes stay 0, the packets carry none
+	buffer->setFirstTimestamp(spans, header.sampleIndex);
+	buffer->finishedWrite(spans);
+}
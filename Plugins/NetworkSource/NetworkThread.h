@@ -0,0 +1,124 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __NETWORKTHREAD_H_3F1C9A2E__
+#define __NETWORKTHREAD_H_3F1C9A2E__
+
+#include <DataThreadHeaders.h>
+#include <atomic>
+#include "../../Source/Processors/NetworkSink/NetworkPacket.h"
+
+namespace NetworkSource
+{
+
+	/**
+		Receives continuous data blocks over UDP, sent to a port of this machine or to
+		a multicast group, so acquisition boxes can stream to the GUI over the network.
+
+		Each datagram is converted straight into the free space of the DataBuffer. Packets
+		that arrive after a later one are discarded and gaps in the sample indices are
+		counted as lost samples. Event packets are ignored.
+
+		@see NetworkPacket, DataThread
+	*/
+	class NetworkThread : public DataThread
+	{
+	public:
+		NetworkThread(SourceNode* sn);
+		~NetworkThread();
+
+		static DataThread* createDataThread(SourceNode* sn);
+
+		GenericEditor* createEditor(SourceNode* sn) override;
+
+		bool foundInputSource() override;
+
+		int getNumDataOutputs(DataChannel::DataChannelTypes type, int subProcessorIdx) const override;
+		int getNumTTLOutputs(int subProcessorIdx) const override;
+		float getSampleRate(int subProcessorIdx) const override;
+		float getBitVolts(const DataChannel* chan) const override;
+
+		void resizeBuffers() override;
+
+		/** The stream settings must match the sender and can only change while not acquiring. */
+		void setPort(int port);
+		int getPort() const;
+
+		/** Multicast group to join, or an empty string to receive datagrams sent to this machine. */
+		void setMulticastGroup(const String& group);
+		String getMulticastGroup() const;
+
+		void setNumChannels(int numChannels);
+		int getNumChannels() const;
+
+		void setSampleRate(float sampleRate);
+
+		/** Microvolts per bit of int16 samples. */
+		void setBitVolts(float bitVolts);
+
+		struct Stats
+		{
+			int64 numPackets;
+			// wrong magic, version, channel count or size
+			int64 numBadPackets;
+			// arrived after a later packet
+			int64 numLatePackets;
+			// sample indices skipped by the sender or lost on the way
+			int64 numLostSamples;
+			int64 lastSenderTimestamp;
+		};
+		Stats getStats() const;
+
+	private:
+		bool updateBuffer() override;
+
+		bool startAcquisition() override;
+		bool stopAcquisition() override;
+
+		/** Converts the frames of a packet into the DataBuffer. */
+		void ingestPacket(const NetworkPacket::Header& header, const char* samples);
+
+		ScopedPointer<DatagramSocket> socket;
+		HeapBlock<char> packetBuffer;
+
+		int port;
+		String multicastGroup;
+		int numChannels;
+		float sampleRate;
+		float bitVolts;
+
+		// sample index the next packet should start at, -1 before the first packet
+		int64 nextSampleIndex;
+
+		std::atomic<int64> numPackets;
+		std::atomic<int64> numBadPackets;
+		std::atomic<int64> numLatePackets;
+		std::atomic<int64> numLostSamples;
+		std::atomic<int64> lastSenderTimestamp;
+
+		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NetworkThread);
+	};
+
+}
+
+#endif  // __NETWORKTHREAD_H_3F1C9A2E__
@@ -32,8 +32,10 @@ PhaseDetector::PhaseDetector()
     , risingNeg             (false)
     , fallingPos            (false)
     , fallingNeg            (false)
+    , needsEstimatorReset   (true)
 {
     setProcessorType (PROCESSOR_TYPE_FILTER);
+    setEventClassesOfInterest (TTL_EVENT_CLASS);
 	lastNumInputs = 0;
 }
 
@@ -64,8 +66,12 @@ void PhaseDetector::addModule()
     m.samplesSinceTrigger = 5000;
     m.wasTriggered = false;
     m.phase = NO_PHASE;
+    m.usesEstimator = false;
+    m.targetPhase = 0.0f;
+    m.lastPhaseError = 0.0f;
 
     modules.add (m);
+    estimators.add (new PhaseEstimator());
 }
 
 
@@ -129,6 +135,12 @@ void PhaseDetector::setParameter (int parameterIndex, float newValue)
             module.isActive = false;
         }
     }
+    else if (parameterIndex == 5)   // target phase in degrees, negative for none
+    {
+        module.usesEstimator = newValue >= 0;
+        module.targetPhase = float_Pi / 180.0f * std::fmod (jmax (0.0f, newValue), 360.0f);
+        module.lastPhaseError = 0.0f;
+    }
 }
 
 //Usually, to be more ordered, we'd create the event channels overriding the createEventChannels() method.
@@ -143,6 +155,8 @@ void PhaseDetector::updateSettings()
 		if (getNumInputs() != lastNumInputs)
 			modules.getReference(i).inputChan = -1;
 		const DataChannel* in = getDataChannel(modules[i].inputChan);
+		if (in)
+			estimators[i]->setup(in->getSampleRate());
 		EventChannel *ev;
 		if (in)
 			ev = new EventChannel(EventChannel::TTL, 8, 1, in, this);
@@ -161,6 +175,11 @@ void PhaseDetector::updateSettings()
 		case RISING_ZERO: typeDesc = "Zero crossing with positive slope"; identifier += "zero.positive"; break;
 		default: typeDesc = "No phase selected"; break;
 		}
+		if (modules[i].usesEstimator)
+		{
+			typeDesc = "Estimated phase " + String(roundFloatToInt(modules[i].targetPhase * 180.0f / float_Pi)) + " deg";
+			identifier = "dataderived.phase.estimated";
+		}
 		ev->setIdentifier(identifier);
 		MetaDataDescriptor md(MetaDataDescriptor::CHAR, 34, "Phase Type", "Description of the phase condition", "channelInfo.extra");
 		MetaDataValue mv(md);
@@ -182,11 +201,17 @@ void PhaseDetector::updateSettings()
 		moduleEventChannels.add(ev);
 	}
 	lastNumInputs = getNumInputs();
+
+	// room for the estimates of one part of a block at any interval
+	phases.resize(PhaseEstimator::MaxInputSamples + 1);
+	offsets.resize(PhaseEstimator::MaxInputSamples + 1);
 }
 
 
 bool PhaseDetector::enable()
 {
+    needsEstimatorReset = true;
+
     return true;
 }
 
@@ -200,11 +225,13 @@ void PhaseDetector::handleEvent (const EventChannel* channelInfo, const MidiMess
 
     if (Event::getEventType(event)  == EventChannel::TTL)
     {
-		TTLEventPtr ttl = TTLEvent::deserializeFromMessage(event, channelInfo);
+        TTLEventView ttl (event, channelInfo);
+        if (! ttl.isValid())
+            return;
 
         // int eventNodeId = *(dataptr+1);
-		const int eventId = ttl->getState() ? 1 : 0;
-		const int eventChannel = ttl->getChannel();
+		const int eventId = ttl.getState() ? 1 : 0;
+		const int eventChannel = ttl.getChannel();
 
         for (int i = 0; i < modules.size(); ++i)
         {
@@ -230,28 +257,79 @@ void PhaseDetector::process (AudioSampleBuffer& buffer)
     for (int m = 0; m < modules.size(); ++m)
     {
         DetectorModule& module = modules.getReference (m);
+        PhaseEstimator& estimator = *estimators[m];
+
+        // check to see if it has a channel
+        if (module.outputChan < 0
+            || module.inputChan < 0
+            || module.inputChan >= buffer.getNumChannels())
+            continue;
+
+        const int numSamples = getNumSamples (module.inputChan);
+        const juce::uint64 timestamp = getTimestamp (module.inputChan);
+        const float* samples = buffer.getReadPointer (module.inputChan);
 
-        // check to see if it's active and has a channel
-        if (module.isActive && module.outputChan >= 0
-            && module.inputChan >= 0
-            && module.inputChan < buffer.getNumChannels())
+        if (needsEstimatorReset)
+            estimator.reset (timestamp);
+
+        // the estimator takes the block in parts of at most MaxInputSamples, and keeps
+        // following the signal while the module is gated off
+        int numEstimates = 0;
+        int nextEstimate = 0;
+        int estimatedFrom = 0;
+        int estimatedTo = 0;
+
+        auto feedEstimator = [&] (int from)
+        {
+            const int numInput = jmin (PhaseEstimator::MaxInputSamples, numSamples - from);
+            numEstimates = estimator.process (samples + from, numInput, timestamp + from,
+                                              phases.getRawDataPointer(), offsets.getRawDataPointer());
+            nextEstimate = 0;
+            estimatedFrom = from;
+            estimatedTo = from + numInput;
+        };
+
+        if (! module.isActive)
+        {
+            if (module.usesEstimator)
+                for (int i = 0; i < numSamples; i += PhaseEstimator::MaxInputSamples)
+                    feedEstimator (i);
+
+            continue;
+        }
+
+        for (int i = 0; i < numSamples; ++i)
         {
-            for (int i = 0; i < getNumSamples (module.inputChan); ++i)
+            bool shouldTrigger = false;
+
+            if (module.usesEstimator)
             {
-                const float sample = *buffer.getReadPointer (module.inputChan, i);
+                if (i == estimatedTo)
+                    feedEstimator (i);
+
+                for (; nextEstimate < numEstimates && estimatedFrom + offsets.getUnchecked (nextEstimate) == i; ++nextEstimate)
+                {
+                    // the phase goes past the target when the error turns positive; once
+                    // per cycle the error also jumps from pi to -pi, which is not a crossing
+                    const float error = std::remainder (phases.getUnchecked (nextEstimate) - module.targetPhase,
+                                                        2.0f * float_Pi);
+
+                    if (module.lastPhaseError < 0 && module.lastPhaseError > -float_Pi / 2 && error >= 0)
+                        shouldTrigger = true;
+
+                    module.lastPhaseError = error;
+                }
+            }
+            else
+            {
+                const float sample = samples[i];
 
                 if (sample < module.lastSample
                     && sample > 0
                     && module.phase != FALLING_POS)
                 {
                     if (module.type == PEAK)
-                    {
-						uint8 ttlData = 1 << module.outputChan;
-						TTLEventPtr event = TTLEvent::createTTLEvent(moduleEventChannels[m], getTimestamp(module.inputChan) + i, &ttlData, sizeof(uint8), module.outputChan);
-						addEvent(moduleEventChannels[m], event, i);
-                        module.samplesSinceTrigger = 0;
-                        module.wasTriggered = true;
-                    }
+                        shouldTrigger = true;
 
                     module.phase = FALLING_POS;
                 }
@@ -260,26 +338,14 @@ void PhaseDetector::process (AudioSampleBuffer& buffer)
                          && module.phase != FALLING_NEG)
                 {
                     if (module.type == FALLING_ZERO)
-                    {
-						uint8 ttlData = 1 << module.outputChan;
-						TTLEventPtr event = TTLEvent::createTTLEvent(moduleEventChannels[m], getTimestamp(module.inputChan) + i, &ttlData, sizeof(uint8), module.outputChan);
-						addEvent(moduleEventChannels[m], event, i);
-                        module.samplesSinceTrigger = 0;
-                        module.wasTriggered = true;
-                    }
+                        shouldTrigger = true;
 
                     module.phase = FALLING_NEG;
                 }
                 else if (sample > module.lastSample && sample < 0 && module.phase != RISING_NEG)
                 {
                     if (module.type == TROUGH)
-                    {
-						uint8 ttlData = 1 << module.outputChan;
-						TTLEventPtr event = TTLEvent::createTTLEvent(moduleEventChannels[m], getTimestamp(module.inputChan) + i, &ttlData, sizeof(uint8), module.outputChan);
-						addEvent(moduleEventChannels[m], event, i);
-                        module.samplesSinceTrigger = 0;
-                        module.wasTriggered = true;
-                    }
+                        shouldTrigger = true;
 
                     module.phase = RISING_NEG;
                 }
@@ -288,36 +354,39 @@ void PhaseDetector::process (AudioSampleBuffer& buffer)
                          && module.phase != RISING_POS)
                 {
                     if (module.type == RISING_ZERO)
-                    {
-						uint8 ttlData = 1 << module.outputChan;
-						TTLEventPtr event = TTLEvent::createTTLEvent(moduleEventChannels[m], getTimestamp(module.inputChan) + i, &ttlData, sizeof(uint8), module.outputChan);
-						addEvent(moduleEventChannels[m], event, i);
-                        module.samplesSinceTrigger = 0;
-                        module.wasTriggered = true;
-                    }
+                        shouldTrigger = true;
 
                     module.phase = RISING_POS;
                 }
 
                 module.lastSample = sample;
+            }
 
-                if (module.wasTriggered)
+            if (shouldTrigger)
+            {
+				uint8 ttlData = 1 << module.outputChan;
+				addTTLEvent(moduleEventChannels[m], timestamp + i, &ttlData, module.outputChan, i);
+                module.samplesSinceTrigger = 0;
+                module.wasTriggered = true;
+            }
+
+            if (module.wasTriggered)
+            {
+                if (module.samplesSinceTrigger > 1000)
                 {
-                    if (module.samplesSinceTrigger > 1000)
-                    {
-						uint8 ttlData = 0;
-						TTLEventPtr event = TTLEvent::createTTLEvent(moduleEventChannels[m], getTimestamp(module.inputChan) + i, &ttlData, sizeof(uint8), module.outputChan);
-						addEvent(moduleEventChannels[m], event, i);
-                        module.wasTriggered = false;
-                    }
-                    else
-                    {
-                        module.samplesSinceTrigger++;
-                    }
+					uint8 ttlData = 0;
+					addTTLEvent(moduleEventChannels[m], timestamp + i, &ttlData, module.outputChan, i);
+                    module.wasTriggered = false;
+                }
+                else
+                {
+                    module.samplesSinceTrigger++;
                 }
             }
         }
     }
+
+    needsEstimatorReset = false;
 }
 
 
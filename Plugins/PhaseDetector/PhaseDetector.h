@@ -26,6 +26,7 @@
 
 
 #include <ProcessorHeaders.h>
+#include "PhaseEstimator.h"
 
 #define NUM_INTERVALS 5
 
@@ -34,6 +35,10 @@
 
     Uses peaks to estimate the phase of a continuous signal.
 
+    A module with a target phase instead triggers when the instantaneous phase given by
+    a PhaseEstimator crosses that phase, without waiting for the next peak or zero
+    crossing.
+
     @see GenericProcessor, PhaseDetectorEditor
 */
 class PhaseDetector : public GenericProcessor
@@ -46,6 +51,7 @@ public:
     bool hasEditor() const override { return true; }
 
     void process (AudioSampleBuffer& buffer) override;
+    bool modifiesContinuousData() const override { return false; }
 
     void setParameter (int parameterIndex, float newValue) override;
 
@@ -84,11 +90,24 @@ private:
         bool isActive;
         bool wasTriggered;
 
+        /** Whether the module triggers at targetPhase, estimated by its PhaseEstimator */
+        bool usesEstimator;
+        float targetPhase;
+        float lastPhaseError;
+
         ModuleType type;
         PhaseType phase;
     };
 
     Array<DetectorModule> modules;
+    OwnedArray<PhaseEstimator> estimators;
+
+    /** Estimates of one call to PhaseEstimator::process(), sized by updateSettings() */
+    Array<float> phases;
+    Array<int> offsets;
+
+    /** The estimators start at the timestamps of the first block after acquisition starts */
+    bool needsEstimatorReset;
 
     int activeModule;
 
@@ -189,6 +189,7 @@ void PhaseDetectorEditor::saveCustomParameters(XmlElement* xml)
         d->setAttribute("INPUT",interfaces[i]->getInputChan());
         d->setAttribute("GATE",interfaces[i]->getGateChan());
         d->setAttribute("OUTPUT",interfaces[i]->getOutputChan());
+        d->setAttribute("TARGET",interfaces[i]->getTargetPhase());
     }
 }
 
@@ -211,6 +212,7 @@ void PhaseDetectorEditor::loadCustomParameters(XmlElement* xml)
             interfaces[i]->setInputChan(xmlNode->getIntAttribute("INPUT"));
             interfaces[i]->setGateChan(xmlNode->getIntAttribute("GATE"));
             interfaces[i]->setOutputChan(xmlNode->getIntAttribute("OUTPUT"));
+            interfaces[i]->setTargetPhase(xmlNode->getStringAttribute("TARGET"));
 
             i++;
         }
@@ -293,6 +295,17 @@ DetectorInterface::DetectorInterface(PhaseDetector* pd, Colour c, int id) :
     outputSelector->setSelectedId(1);
     addAndMakeVisible(outputSelector);
 
+    targetPhaseLabel = new Label("target phase", "");
+    targetPhaseLabel->setBounds(5,60,40,16);
+    targetPhaseLabel->setFont(Font("Default", 13, Font::plain));
+    targetPhaseLabel->setColour(Label::textColourId, Colours::white);
+    targetPhaseLabel->setColour(Label::backgroundColourId, Colours::grey);
+    targetPhaseLabel->setEditable(true);
+    targetPhaseLabel->addListener(this);
+    targetPhaseLabel->setTooltip("Phase in degrees, 0 at the peaks, to trigger at from the estimated "
+                                 "instantaneous phase. Leave empty to trigger at the selected peak or zero crossing.");
+    addAndMakeVisible(targetPhaseLabel);
+
 
     std::cout << "Updating channels" << std::endl;
 
@@ -352,6 +365,14 @@ void DetectorInterface::buttonClicked(Button* b)
 
 }
 
+void DetectorInterface::labelTextChanged(Label* label)
+{
+    setTargetPhase(label->getText());
+
+    // the event channel describes the phase
+    CoreServices::updateSignalChain(processor->getEditor());
+}
+
 void DetectorInterface::updateChannels(int numChannels)
 {
 
@@ -434,6 +455,23 @@ void DetectorInterface::setGateChan(int chan)
     processor->setParameter(4, (float) chan);
 }
 
+void DetectorInterface::setTargetPhase(const String& phase)
+{
+    const String text = phase.trim();
+    const bool hasPhase = text.isNotEmpty() && text.containsOnly("0123456789.");
+
+    targetPhaseLabel->setText(hasPhase ? String(text.getFloatValue()) : String(), dontSendNotification);
+
+    processor->setActiveModule(idNum);
+
+    processor->setParameter(5, hasPhase ? text.getFloatValue() : -1.0f);
+}
+
+String DetectorInterface::getTargetPhase()
+{
+    return targetPhaseLabel->getText();
+}
+
 int DetectorInterface::getInputChan()
 {
     return inputSelector->getSelectedId()-2;
@@ -451,6 +489,7 @@ int DetectorInterface::getGateChan()
 void DetectorInterface::setEnableStatus(bool status)
 {
 	inputSelector->setEnabled(status);
+	targetPhaseLabel->setEnabled(status);
 	for (int i = 0; i < phaseButtons.size(); i++)
 		phaseButtons[i]->setEnabled(status);
 }
\ No newline at end of file
@@ -85,7 +85,8 @@ private:
 
 class DetectorInterface : public Component,
     public ComboBox::Listener,
-    public Button::Listener
+    public Button::Listener,
+    public Label::Listener
 {
 public:
     DetectorInterface(PhaseDetector*, Colour, int);
@@ -95,6 +96,7 @@ public:
 
     void comboBoxChanged(ComboBox*);
     void buttonClicked(Button*);
+    void labelTextChanged(Label*);
 
     void updateChannels(int);
 
@@ -103,10 +105,14 @@ public:
     void setOutputChan(int);
     void setGateChan(int);
 
+    /** Sets the phase in degrees the estimator triggers at, or an empty string to use the peaks and zero crossings */
+    void setTargetPhase(const String&);
+
     int getPhase();
     int getInputChan();
     int getOutputChan();
     int getGateChan();
+    String getTargetPhase();
 
 	void setEnableStatus(bool status);
 
@@ -126,6 +132,7 @@ private:
     ScopedPointer<ComboBox> inputSelector;
     ScopedPointer<ComboBox> gateSelector;
     ScopedPointer<ComboBox> outputSelector;
+    ScopedPointer<Label> targetPhaseLabel;
 
 };
 
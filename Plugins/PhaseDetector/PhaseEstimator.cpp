@@ -0,0 +1,213 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "PhaseEstimator.h"
+#include <algorithm>
+#include <cmath>
+
+
+PhaseEstimator::PhaseEstimator()
+    : hilbertDelay      (0)
+    , decimatorDelay    (0)
+    , modelOrder        (0)
+    , hasModel          (false)
+    , windowLength      (0)
+    , historyWrite      (0)
+    , historySize       (0)
+    , numWorkReal       (0)
+{
+}
+
+
+void PhaseEstimator::setup (float sampleRate, float lowestFrequency, int order)
+{
+    // halve the rate down to between 1 and 2 kHz
+    int numStages = 0;
+    while (numStages < 8 && sampleRate / (2 << numStages) >= 1000.0f)
+        ++numStages;
+
+    decimator.setup (1, numStages);
+
+    const float rate = sampleRate / decimator.getFactor();
+    decimatorDelay = (decimator.getDelay() + decimator.getFactor() / 2) / decimator.getFactor();
+
+    // the Hilbert transformer passes frequencies down to about 2 * rate / numTaps; half as
+    // many taps still gives the right phase at lowestFrequency, with less to predict
+    const int numTaps = std::min (1023, std::max (7, int (rate / std::max (0.1f, lowestFrequency))));
+    const std::vector<double> taps = Dsp::FirDesign::hilbert (numTaps, 4.);
+
+    hilbertDelay = int (taps.size()) / 2;
+    hilbertTaps.clear();
+    for (int m = 1; m <= hilbertDelay; m += 2)
+        hilbertTaps.push_back (float (taps[hilbertDelay + m]));
+
+    modelOrder = std::max (1, order);
+    windowLength = std::max (int (rate), std::max (int (taps.size()) + modelOrder, 8 * modelOrder));
+
+    model.assign (modelOrder, 0.);
+    nextModel.assign (modelOrder, 0.);
+    previousModel.assign (modelOrder, 0.);
+    forwardError.assign (windowLength, 0.);
+    backwardError.assign (windowLength, 0.);
+
+    // every sample is written at its ring position and windowLength after it, so the
+    // latest windowLength samples can always be read in one piece
+    history.assign (2 * windowLength, 0.0f);
+    decimated.assign (MaxInputSamples, 0.0f);
+
+    // an estimate reads back to hilbertDelay samples before its centre, and the model
+    // needs modelOrder samples to start predicting
+    numWorkReal = std::max (hilbertDelay - decimatorDelay + 1, modelOrder);
+    work.assign (numWorkReal + decimatorDelay + hilbertDelay, 0.0f);
+
+    reset (0);
+}
+
+
+void PhaseEstimator::reset (juce::uint64 position)
+{
+    decimator.reset (position);
+    historyWrite = 0;
+    historySize = 0;
+    hasModel = false;
+}
+
+
+void PhaseEstimator::fitModel()
+{
+    // Burg's method on the latest windowLength samples
+    const int N = windowLength;
+    const float* x = historyEnd() - N;
+
+    double* f = forwardError.data();
+    double* b = backwardError.data();
+    double* a = nextModel.data();
+    double* previous = previousModel.data();
+
+    std::copy (x, x + N, f);
+    std::copy (x, x + N, b);
+    std::fill (a, a + modelOrder, 0.);
+
+    for (int m = 0; m < modelOrder; ++m)
+    {
+        double num = 0;
+        double den = 0;
+
+        for (int n = m + 1; n < N; ++n)
+        {
+            num += f[n] * b[n - 1];
+            den += f[n] * f[n] + b[n - 1] * b[n - 1];
+        }
+
+        if (den <= 0)
+        {
+            hasModel = false;
+            return;
+        }
+
+        const double k = 2 * num / den;
+
+        // Levinson update of the predictor
+        std::copy (a, a + m, previous);
+        a[m] = k;
+        for (int i = 0; i < m; ++i)
+            a[i] = previous[i] - k * previous[m - 1 - i];
+
+        // forward and backward prediction errors of the next order
+        for (int n = N - 1; n > m; --n)
+        {
+            const double forward = f[n];
+            f[n] = forward - k * b[n - 1];
+            b[n] = b[n - 1] - k * forward;
+        }
+    }
+
+    model.swap (nextModel);
+    hasModel = true;
+}
+
+
+float PhaseEstimator::estimate()
+{
+    // the decimated signal lags by decimatorDelay samples, and the Hilbert transformer
+    // needs hilbertDelay samples after its centre
+    const int numPredicted = decimatorDelay + hilbertDelay;
+    const float* end = historyEnd();
+
+    std::copy (end - numWorkReal, end, work.data());
+
+    for (int p = 0; p < numPredicted; ++p)
+    {
+        const float* last = work.data() + numWorkReal + p - 1;
+        double prediction = 0;
+        for (int k = 0; k < modelOrder; ++k)
+            prediction += model[k] * last[-k];
+        work[numWorkReal + p] = float (prediction);
+    }
+
+    const float* c = work.data() + numWorkReal - 1 + decimatorDelay;
+    float imaginary = 0;
+    for (int j = 0; j < int (hilbertTaps.size()); ++j)
+    {
+        const int m = 2 * j + 1;
+        imaginary += hilbertTaps[j] * (c[-m] - c[m]);
+    }
+
+    return std::atan2 (imaginary, c[0]);
+}
+
+
+int PhaseEstimator::process (const float* input, int numSamples, juce::uint64 timestamp,
+                             float* phases, int* offsets)
+{
+    jassert (numSamples <= MaxInputSamples);
+    numSamples = std::min (numSamples, MaxInputSamples);
+
+    if (historySize == windowLength)
+        fitModel();
+
+    float* output = decimated.data();
+    const int numDecimated = decimator.process (0, 1, numSamples, &input, &output);
+
+    // the decimator keeps the samples whose timestamps are multiples of its factor
+    const int factor = decimator.getFactor();
+    const int firstOffset = int ((factor - timestamp % factor) % factor);
+    int numEstimates = 0;
+
+    for (int k = 0; k < numDecimated; ++k)
+    {
+        history[historyWrite] = decimated[k];
+        history[historyWrite + windowLength] = decimated[k];
+        historyWrite = (historyWrite + 1) % windowLength;
+        historySize = std::min (historySize + 1, windowLength);
+
+        if (hasModel)
+        {
+            phases[numEstimates] = estimate();
+            offsets[numEstimates] = firstOffset + k * factor;
+            ++numEstimates;
+        }
+    }
+
+    return numEstimates;
+}
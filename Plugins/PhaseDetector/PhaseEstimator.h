@@ -0,0 +1,110 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __PHASEESTIMATOR_H__
+#define __PHASEESTIMATOR_H__
+
+#include <DspLib.h>
+#include <vector>
+
+
+/**
+
+    Estimates the instantaneous phase of a narrowband signal with no delay.
+
+    The input is decimated to between 1 and 2 kHz, and the phase is that of the analytic
+    signal given by a FIR Hilbert transformer. The Hilbert transformer and the decimator
+    delay the signal, so the samples they would need from the future are predicted by an
+    autoregressive model, refitted to the latest second of data with Burg's method at the
+    start of every block. The phase is zero at the peaks of the signal and increases
+    through pi / 2 at the falling zero crossings.
+
+    The input should be band-passed around the rhythm of interest beforehand.
+
+    @see PhaseDetector, Dsp::FirDesign::hilbert
+
+*/
+class PhaseEstimator
+{
+public:
+    PhaseEstimator();
+
+    /** Sets the input rate and the lowest frequency whose phase should be estimated */
+    void setup (float sampleRate, float lowestFrequency = 4.0f, int modelOrder = 20);
+
+    /** Clears the history. position is the timestamp of the next input sample. */
+    void reset (juce::uint64 position);
+
+    /** The most input samples one call to process() takes; longer blocks are fed in parts */
+    static const int MaxInputSamples = 1024;
+
+    /** Returns the number of input samples between two estimates */
+    int getInterval() const { return decimator.getFactor(); }
+
+    /** Returns the most estimates one call to process() writes */
+    int getMaxEstimates() const { return MaxInputSamples / getInterval() + 1; }
+
+    /** Feeds numSamples input samples, at most MaxInputSamples, starting at the given
+        timestamp, and writes the phase at every estimate, in radians from -pi to pi, with
+        the offsets of the input samples they are for. Returns the number of estimates,
+        which is zero until a second of data was seen. Doesn't allocate. */
+    int process (const float* input, int numSamples, juce::uint64 timestamp,
+                 float* phases, int* offsets);
+
+private:
+    /** Fits the autoregressive model to the history */
+    void fitModel();
+
+    /** Returns the phase at the newest sample of the history */
+    float estimate();
+
+    /** Returns the end of the latest samples of the history, which are contiguous */
+    const float* historyEnd() const { return history.data() + historyWrite + windowLength; }
+
+    Dsp::HalfBandDecimator decimator;
+
+    std::vector<float> hilbertTaps;     // taps at odd distances from the centre, nearest first
+    int hilbertDelay;
+    int decimatorDelay;                 // in decimated samples
+
+    int modelOrder;
+    std::vector<double> model;          // x[n] is predicted as the sum of model[k] * x[n - 1 - k]
+    bool hasModel;
+
+    // Burg's method scratch, sized by setup()
+    std::vector<double> forwardError;
+    std::vector<double> backwardError;
+    std::vector<double> nextModel;
+    std::vector<double> previousModel;
+
+    int windowLength;
+    std::vector<float> history;         // ring of the latest decimated samples, stored twice over
+    int historyWrite;                   // where the next sample goes, below windowLength
+    int historySize;
+    std::vector<float> decimated;
+    std::vector<float> work;            // real and predicted samples around an estimate
+    int numWorkReal;
+};
+
+
+#endif  // __PHASEESTIMATOR_H__
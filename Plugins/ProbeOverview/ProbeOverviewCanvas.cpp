@@ -0,0 +1,313 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include "ProbeOverviewCanvas.h"
+#include "ProbeOverviewNode.h"
+
+
+namespace
+{
+    const int topMargin = 30;
+    const int sideMargin = 20;
+    const int bottomMargin = 40;
+    const int legendWidth = 70;
+
+    // relative to the median RMS of all channels
+    const float deadLevel = 0.1f;
+    const float noisyLevel = 3.0f;
+
+    // share of the latest measured rate blended into the shown one
+    const float rateSmoothing = 0.3f;
+
+    enum { RMS_MAP = 0, RATE_MAP = 1 };
+}
+
+
+ProbeOverviewCanvas::ProbeOverviewCanvas(ProbeOverviewNode* p)
+    : processor(p),
+      numChannels(0),
+      numColumns(1),
+      numRows(0),
+      lastTime(0),
+      medianRms(0.0f),
+      maxRms(1.0f),
+      maxRate(1.0f),
+      hoveredChannel(-1)
+{
+    // an overview, refreshed slowly enough to cost next to nothing
+    refreshRate = 2;
+
+    // blue for low values through green to red for high ones
+    for (int i = 0; i < 256; ++i)
+        colourMap[i] = Colour::fromHSV((1.0f - i / 255.0f) * 0.67f, 1.0f, 1.0f, 1.0f);
+
+    update();
+}
+
+ProbeOverviewCanvas::~ProbeOverviewCanvas()
+{
+
+}
+
+
+void ProbeOverviewCanvas::update()
+{
+    numChannels = processor->getNumOverviewChannels();
+    numColumns = jmax(1, processor->getNumColumns());
+    numRows = (numChannels + numColumns - 1) / numColumns;
+
+    rms.assign(numChannels, 0.0f);
+    rates.assign(numChannels, 0.0f);
+    lastCounts.assign(numChannels, 0);
+    lastTime = Time::getMillisecondCounterHiRes();
+    medianRms = 0.0f;
+    hoveredChannel = -1;
+
+    repaint();
+}
+
+
+void ProbeOverviewCanvas::refreshState()
+{
+    repaint();
+}
+
+
+void ProbeOverviewCanvas::beginAnimation()
+{
+    // the counts start again from zero
+    update();
+
+    startCallbacks();
+}
+
+
+void ProbeOverviewCanvas::endAnimation()
+{
+    stopCallbacks();
+}
+
+
+void ProbeOverviewCanvas::refresh()
+{
+    if (processor->getNumOverviewChannels() != numChannels
+        || processor->getNumColumns() != numColumns)
+    {
+        update();
+        return;
+    }
+
+    readValues();
+    repaint();
+}
+
+
+void ProbeOverviewCanvas::readValues()
+{
+    const double now = Time::getMillisecondCounterHiRes();
+    const float elapsed = float((now - lastTime) / 1000.0);
+    lastTime = now;
+
+    maxRms = 0.0f;
+    maxRate = 0.0f;
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        rms[c] = processor->getRms(c);
+        maxRms = jmax(maxRms, rms[c]);
+
+        const uint32 count = processor->getSpikeCount(c);
+
+        if (elapsed > 0)
+        {
+            const float rate = float(count - lastCounts[c]) / elapsed;
+            rates[c] += rateSmoothing * (rate - rates[c]);
+        }
+
+        lastCounts[c] = count;
+        maxRate = jmax(maxRate, rates[c]);
+    }
+
+    if (numChannels > 0)
+    {
+        std::vector<float> sorted(rms);
+        std::nth_element(sorted.begin(), sorted.begin() + numChannels / 2, sorted.end());
+        medianRms = sorted[numChannels / 2];
+    }
+}
+
+
+Rectangle<int> ProbeOverviewCanvas::getMapArea(int map) const
+{
+    const int mapWidth = jmax(1, getWidth() / 2 - 2 * sideMargin - legendWidth);
+    const int x = (map == RMS_MAP ? 0 : getWidth() / 2) + sideMargin;
+
+    return Rectangle<int>(x, topMargin, mapWidth, jmax(1, getHeight() - topMargin - bottomMargin));
+}
+
+
+Rectangle<int> ProbeOverviewCanvas::getSiteBounds(const Rectangle<int>& area, int channel) const
+{
+    // square sites if they fit, centred in the area
+    const float size = jmin(area.getWidth() / float(numColumns), area.getHeight() / float(jmax(1, numRows)));
+    const float left = area.getCentreX() - size * numColumns / 2;
+    const float bottom = area.getCentreY() + size * numRows / 2;
+
+    const int column = channel % numColumns;
+    const int row = channel / numColumns;
+
+    return Rectangle<float>(left + column * size, bottom - (row + 1) * size, size, size)
+           .reduced(size > 6 ? 1.0f : 0.0f).getSmallestIntegerContainer();
+}
+
+
+void ProbeOverviewCanvas::paint(Graphics& g)
+{
+    g.fillAll(Colours::black);
+
+    g.setColour(Colours::grey);
+    g.setFont(12);
+
+    if (numChannels == 0)
+    {
+        g.drawText("No input channels", getLocalBounds(), Justification::centred);
+        return;
+    }
+
+    drawMap(g, RMS_MAP);
+    drawMap(g, RATE_MAP);
+
+    // values of the site under the mouse
+    g.setColour(Colours::lightgrey);
+
+    if (isPositiveAndBelow(hoveredChannel, numChannels))
+    {
+        String status = processor->getDataChannel(hoveredChannel)->getName()
+                        + "   RMS " + String(rms[hoveredChannel], 1)
+                        + " " + processor->getDataChannel(hoveredChannel)->getDataUnits()
+                        + "   " + String(rates[hoveredChannel], 1) + " spikes/s";
+
+        if (medianRms > 0 && rms[hoveredChannel] < deadLevel * medianRms)
+            status += "   dead?";
+        else if (medianRms > 0 && rms[hoveredChannel] > noisyLevel * medianRms)
+            status += "   noisy?";
+
+        g.drawText(status, sideMargin, getHeight() - bottomMargin + 15, getWidth() - 2 * sideMargin, 16, Justification::left);
+    }
+}
+
+
+void ProbeOverviewCanvas::drawMap(Graphics& g, int map)
+{
+    const Rectangle<int> area = getMapArea(map);
+    const std::vector<float>& values = map == RMS_MAP ? rms : rates;
+    const float maxValue = jmax(map == RMS_MAP ? maxRms : maxRate, 1e-3f);
+    const float scale = 255.0f / maxValue;
+
+    g.setColour(Colours::lightgrey);
+    g.drawText(map == RMS_MAP ? "RMS" : "Spike rate", area.getX(), 5, area.getWidth(), 20, Justification::centred);
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        const Rectangle<int> site = getSiteBounds(area, c);
+
+        g.setColour(colourMap[jlimit(0, 255, roundToInt(values[c] * scale))]);
+        g.fillRect(site);
+
+        if (map == RMS_MAP && medianRms > 0)
+        {
+            // dead sites are greyed out, noisy ones outlined
+            if (rms[c] < deadLevel * medianRms)
+            {
+                g.setColour(Colours::darkgrey);
+                g.fillRect(site);
+                g.setColour(Colours::black);
+                g.drawLine(float(site.getX()), float(site.getY()), float(site.getRight()), float(site.getBottom()));
+            }
+            else if (rms[c] > noisyLevel * medianRms)
+            {
+                g.setColour(Colours::white);
+                g.drawRect(site, 2);
+            }
+        }
+
+        if (c == hoveredChannel)
+        {
+            g.setColour(Colours::yellow);
+            g.drawRect(site, 1);
+        }
+    }
+
+    // colour scale
+    const int barX = area.getRight() + 10;
+    const int barWidth = 12;
+
+    for (int y = 0; y < area.getHeight(); ++y)
+    {
+        g.setColour(colourMap[jlimit(0, 255, 255 - y * 256 / area.getHeight())]);
+        g.fillRect(barX, area.getY() + y, barWidth, 1);
+    }
+
+    const String units = map == RMS_MAP ? processor->getDataChannel(0)->getDataUnits() : String("Hz");
+
+    g.setColour(Colours::lightgrey);
+    g.drawText(String(maxValue, 1) + " " + units, barX + barWidth + 2, area.getY(), legendWidth - barWidth - 12, 14, Justification::left);
+    g.drawText("0 " + units, barX + barWidth + 2, area.getBottom() - 14, legendWidth - barWidth - 12, 14, Justification::left);
+}
+
+
+void ProbeOverviewCanvas::mouseMove(const MouseEvent& event)
+{
+    int channel = -1;
+
+    for (int map = RMS_MAP; map <= RATE_MAP && channel < 0; ++map)
+    {
+        const Rectangle<int> area = getMapArea(map);
+
+        for (int c = 0; c < numChannels; ++c)
+        {
+            if (getSiteBounds(area, c).contains(event.getPosition()))
+            {
+                channel = c;
+                break;
+            }
+        }
+    }
+
+    if (channel != hoveredChannel)
+    {
+        hoveredChannel = channel;
+        repaint();
+    }
+}
+
+
+void ProbeOverviewCanvas::mouseExit(const MouseEvent&)
+{
+    if (hoveredChannel >= 0)
+    {
+        hoveredChannel = -1;
+        repaint();
+    }
+}
@@ -0,0 +1,99 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef __PROBEOVERVIEWCANVAS_H__
+#define __PROBEOVERVIEWCANVAS_H__
+
+#include <VisualizerWindowHeaders.h>
+
+class ProbeOverviewNode;
+
+/**
+
+  Shows the RMS and the spike rate of every input channel as two heat maps of the
+  probe, side by side. Channels fill the selected number of site columns from the
+  bottom row up, so channel 0 is at the tip.
+
+  Channels far below the median RMS are marked as dead and channels far above it
+  as noisy. The rates are measured between two refreshes, which come twice a
+  second, and smoothed over a few of them. Hovering over a site shows its values.
+
+  @see ProbeOverviewNode, ProbeOverviewEditor
+
+*/
+
+class ProbeOverviewCanvas : public Visualizer
+{
+public:
+    ProbeOverviewCanvas(ProbeOverviewNode* processor);
+    ~ProbeOverviewCanvas();
+
+    void paint(Graphics& g);
+
+    void refresh();
+    void refreshState();
+    void update();
+    void beginAnimation();
+    void endAnimation();
+    void setParameter(int, float) {}
+    void setParameter(int, int, int, float) {}
+
+    void mouseMove(const MouseEvent& event);
+    void mouseExit(const MouseEvent& event);
+
+private:
+    /** Reads the RMS and updates the rates from the spike counts of every channel */
+    void readValues();
+
+    Rectangle<int> getMapArea(int map) const;
+
+    /** Bounds of a channel's site inside a map area */
+    Rectangle<int> getSiteBounds(const Rectangle<int>& area, int channel) const;
+
+    void drawMap(Graphics& g, int map);
+
+    ProbeOverviewNode* processor;
+
+    Colour colourMap[256];
+    int numChannels;
+    int numColumns;
+    int numRows;
+
+    std::vector<float> rms;
+    std::vector<float> rates;
+    std::vector<uint32> lastCounts;
+    double lastTime;
+    float medianRms;
+    float maxRms;
+    float maxRate;
+
+    int hoveredChannel;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProbeOverviewCanvas);
+
+};
+
+
+
+#endif  // __PROBEOVERVIEWCANVAS_H__
@@ -0,0 +1,107 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include "ProbeOverviewEditor.h"
+#include "ProbeOverviewNode.h"
+#include "ProbeOverviewCanvas.h"
+
+
+namespace
+{
+    // selectable numbers of site columns, item ids counting from 1
+    const int columnCounts[] = { 1, 2, 4, 8, 16, 32 };
+    const int numColumnCounts = 6;
+}
+
+
+ProbeOverviewEditor::ProbeOverviewEditor(GenericProcessor* parentNode, bool useDefaultParameterEditors=true)
+    : VisualizerEditor(parentNode, 150, useDefaultParameterEditors)
+
+{
+    probeOverviewNode = (ProbeOverviewNode*) parentNode;
+    tabText = "Probe Overview";
+
+    columnsLabel = new Label("columns label", "Site columns:");
+    columnsLabel->setBounds(10,30,120,20);
+    columnsLabel->setFont(Font("Small Text", 12, Font::plain));
+    columnsLabel->setColour(Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible(columnsLabel);
+
+    columnsSelector = new ComboBox("columns selector");
+    for (int i = 0; i < numColumnCounts; ++i)
+        columnsSelector->addItem(String(columnCounts[i]), i + 1);
+    columnsSelector->setBounds(15,50,70,18);
+    columnsSelector->setTooltip("Number of columns of sites on the probe; channels fill it from the bottom row up, left to right");
+    columnsSelector->addListener(this);
+    addAndMakeVisible(columnsSelector);
+
+    channelsLabel = new Label("channels label", "");
+    channelsLabel->setBounds(10,75,130,20);
+    channelsLabel->setFont(Font("Small Text", 10, Font::plain));
+    channelsLabel->setColour(Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible(channelsLabel);
+
+    updateSettings();
+}
+
+ProbeOverviewEditor::~ProbeOverviewEditor()
+{
+
+}
+
+
+void ProbeOverviewEditor::updateSettings()
+{
+    int selected = 1;
+
+    for (int i = 0; i < numColumnCounts; ++i)
+    {
+        if (columnCounts[i] <= probeOverviewNode->getNumColumns())
+            selected = i + 1;
+    }
+
+    columnsSelector->setSelectedId(selected, dontSendNotification);
+
+    const int numChannels = probeOverviewNode->getNumOverviewChannels();
+    channelsLabel->setText(numChannels > 0 ? String(numChannels) + " channels" : "", dontSendNotification);
+}
+
+
+void ProbeOverviewEditor::comboBoxChanged(ComboBox* comboBox)
+{
+    // only changes the layout, so it can be changed while acquiring
+    if (comboBox == columnsSelector)
+    {
+        probeOverviewNode->setParameter(0, float(columnCounts[columnsSelector->getSelectedId() - 1]));
+
+        if (canvas != nullptr)
+            canvas->update();
+    }
+}
+
+
+Visualizer* ProbeOverviewEditor::createNewCanvas()
+{
+    return new ProbeOverviewCanvas(probeOverviewNode);
+}
@@ -2,7 +2,7 @@
     ------------------------------------------------------------------
 
     This file is part of the Open Ephys GUI
-    Copyright (C) 2013 Open Ephys
+    Copyright (C) 2018 Open Ephys
 
     ------------------------------------------------------------------
 
@@ -18,44 +18,49 @@
 
     You should have received a copy of the GNU General Public License
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
-
 */
 
-#ifndef __LFPDISPLAYEDITOR_H_BETA__
-#define __LFPDISPLAYEDITOR_H_BETA__
 
-#include <VisualizerEditorHeaders.h>
-#include "LfpDisplayNode.h"
-#include "LfpDisplayCanvas.h"
 
-class Visualizer;
+#ifndef __PROBEOVERVIEWEDITOR_H__
+#define __PROBEOVERVIEWEDITOR_H__
 
-namespace LfpDisplayNodeBeta { 
+#include <VisualizerEditorHeaders.h>
+
+class ProbeOverviewNode;
 
 /**
 
-  User interface for the LfpDisplayNode sink.
+  User interface for the ProbeOverviewNode processor.
 
-  @see LfpDisplayNode, LfpDisplayCanvas
+  @see ProbeOverviewNode, ProbeOverviewCanvas
 
 */
 
-class LfpDisplayEditor : public VisualizerEditor
+class ProbeOverviewEditor : public VisualizerEditor,
+    public ComboBox::Listener
 {
 public:
-    LfpDisplayEditor(GenericProcessor*, bool useDefaultParameterEditors);
-    ~LfpDisplayEditor();
+    ProbeOverviewEditor(GenericProcessor* parentNode, bool useDefaultParameterEditors);
+    virtual ~ProbeOverviewEditor();
+
+    void comboBoxChanged(ComboBox* comboBox);
 
-    // not really being used (yet) ...
-    void buttonEvent(Button* button);
+    void updateSettings();
 
     Visualizer* createNewCanvas();
 
 private:
+    ProbeOverviewNode* probeOverviewNode;
 
+    ScopedPointer<Label> columnsLabel;
+    ScopedPointer<ComboBox> columnsSelector;
+    ScopedPointer<Label> channelsLabel;
 
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LfpDisplayEditor);
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProbeOverviewEditor);
 
 };
-};
-#endif  // __LFPDISPLAYEDITOR_H_BETA__
+
+
+
+#endif  // __PROBEOVERVIEWEDITOR_H__
@@ -0,0 +1,178 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include "ProbeOverviewNode.h"
+#include "ProbeOverviewEditor.h"
+
+
+ProbeOverviewNode::ProbeOverviewNode()
+    : GenericProcessor      ("Probe Overview")
+    , numColumns            (2)
+    , subscribed            (false)
+    , numCountedChannels    (0)
+{
+    setProcessorType (PROCESSOR_TYPE_SINK);
+}
+
+
+ProbeOverviewNode::~ProbeOverviewNode()
+{
+    if (subscribed)
+        unsubscribeFromInputStatistics();
+}
+
+
+AudioProcessorEditor* ProbeOverviewNode::createEditor()
+{
+    editor = new ProbeOverviewEditor (this, true);
+
+    return editor;
+}
+
+
+void ProbeOverviewNode::setParameter (int parameterIndex, float newValue)
+{
+    if (parameterIndex == 0)
+        numColumns = jlimit (1, 64, int (newValue));
+}
+
+
+int ProbeOverviewNode::getNumColumns() const
+{
+    return numColumns;
+}
+
+
+void ProbeOverviewNode::updateSettings()
+{
+    numCountedChannels = dataChannelArray.size();
+    spikeCounts.allocate ((size_t) jmax (1, numCountedChannels), true);
+}
+
+
+bool ProbeOverviewNode::enable()
+{
+    for (int c = 0; c < numCountedChannels; ++c)
+        spikeCounts[c] = 0;
+
+    if (! subscribed)
+    {
+        subscribeToInputStatistics();
+        subscribed = true;
+    }
+
+    return true;
+}
+
+
+bool ProbeOverviewNode::disable()
+{
+    if (subscribed)
+    {
+        unsubscribeFromInputStatistics();
+        subscribed = false;
+    }
+
+    return true;
+}
+
+
+void ProbeOverviewNode::process (AudioSampleBuffer& buffer)
+{
+    checkForEvents (true);
+}
+
+
+void ProbeOverviewNode::handleSpike (const SpikeChannel* spikeInfo, const MidiMessage& event, int)
+{
+    SpikeEventView spike (event, spikeInfo);
+    if (! spike.isValid())
+        return;
+
+    const Array<int>& sources = spikeInfo->getCurrentNodeSourceChannels();
+    const int peak = (int) spikeInfo->getPrePeakSamples();
+    int best = -1;
+    float largest = -1.0f;
+
+    for (int c = 0; c < sources.size(); ++c)
+    {
+        if (! isPositiveAndBelow (sources[c], numCountedChannels))
+            continue;
+
+        const float value = std::abs (spike.getSample (c, peak));
+        if (value > largest)
+        {
+            largest = value;
+            best = sources[c];
+        }
+    }
+
+    if (best >= 0)
+        spikeCounts[best].fetch_add (1, std::memory_order_relaxed);
+}
+
+
+int ProbeOverviewNode::getNumOverviewChannels() const
+{
+    return numCountedChannels;
+}
+
+
+float ProbeOverviewNode::getRms (int channel) const
+{
+    const ChannelStatistics& statistics = getInputStatistics();
+
+    if (! subscribed || ! isPositiveAndBelow (channel, statistics.getNumChannels()))
+        return 0.0f;
+
+    return statistics.getValues (channel).rms;
+}
+
+
+uint32 ProbeOverviewNode::getSpikeCount (int channel) const
+{
+    if (! isPositiveAndBelow (channel, numCountedChannels))
+        return 0;
+
+    return spikeCounts[channel].load (std::memory_order_relaxed);
+}
+
+
+void ProbeOverviewNode::saveCustomParametersToXml (XmlElement* parentElement)
+{
+    XmlElement* mainNode = parentElement->createNewChildElement ("PROBEOVERVIEW");
+    mainNode->setAttribute ("columns", getNumColumns());
+}
+
+
+void ProbeOverviewNode::loadCustomParametersFromXml()
+{
+    if (parametersAsXml == nullptr)
+        return;
+
+    forEachXmlChildElementWithTagName (*parametersAsXml, mainNode, "PROBEOVERVIEW")
+    {
+        setParameter (0, float (mainNode->getIntAttribute ("columns", 2)));
+    }
+}
@@ -0,0 +1,93 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef __PROBEOVERVIEWNODE_H__
+#define __PROBEOVERVIEWNODE_H__
+
+#include <ProcessorHeaders.h>
+#include <atomic>
+
+
+/**
+    Collects what the probe overview shows for every input channel: the running
+    RMS, from the input statistics shared with other processors, and the number of
+    spikes detected on it, from the SpikeChannel events of the input.
+
+    Each spike is credited to the one channel of its electrode where its peak is
+    largest, so a tetrode spike counts once, on the site nearest the unit. The
+    audio thread only increments a counter per spike; the canvas turns the counts
+    into rates at its own, low, refresh rate.
+
+    @see ProbeOverviewCanvas, ProbeOverviewEditor, ChannelStatistics
+*/
+class ProbeOverviewNode : public GenericProcessor
+{
+public:
+    ProbeOverviewNode();
+    ~ProbeOverviewNode();
+
+    AudioProcessorEditor* createEditor() override;
+
+    bool hasEditor() const override { return true; }
+
+    void process (AudioSampleBuffer& buffer) override;
+    bool modifiesContinuousData() const override { return false; }
+    bool emitsEvents() const override { return false; }
+
+    /** Parameter 0 sets the number of columns of sites the channels are laid out in */
+    void setParameter (int parameterIndex, float newValue) override;
+
+    void updateSettings() override;
+
+    bool enable() override;
+    bool disable() override;
+
+    void saveCustomParametersToXml (XmlElement* parentElement) override;
+    void loadCustomParametersFromXml() override;
+
+    int getNumColumns() const;
+
+    /** Number of input channels with an RMS and a spike count */
+    int getNumOverviewChannels() const;
+
+    /** Running RMS of an input channel, in its data units, zero while not acquiring */
+    float getRms (int channel) const;
+
+    /** Spikes credited to an input channel since acquisition started */
+    uint32 getSpikeCount (int channel) const;
+
+private:
+    void handleSpike (const SpikeChannel* spikeInfo, const MidiMessage& event, int samplePosition) override;
+
+    std::atomic<int> numColumns;
+    bool subscribed;
+
+    // written by the audio thread, read by the canvas
+    HeapBlock<std::atomic<uint32>> spikeCounts;
+    int numCountedChannels;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProbeOverviewNode);
+};
+
+#endif  // __PROBEOVERVIEWNODE_H__
@@ -40,6 +40,8 @@
 PulsePalOutput::PulsePalOutput()
     : GenericProcessor ("Pulse Pal")
     , channelToChange (0)
+    , triggerQueue (*this)
+    , queueRunning (false)
 {
     setProcessorType (PROCESSOR_TYPE_SINK);
 
@@ -49,6 +51,16 @@ PulsePalOutput::PulsePalOutput()
     pulsePal.updateDisplay("PulsePal Output GUI Connected","Click for menu");
     pulsePalVersion = pulsePal.getFirmwareVersion();
 
+    for (int i = 1; i <= PULSEPALCHANNELS; ++i)
+    {
+        pendingParams[i] = pulsePal.currentOutputParams[i];
+        pendingContinuous[i] = 0;
+        // not known until it has been sent once
+        sentContinuous[i] = -1;
+    }
+    for (int i = 0; i < 3; ++i)
+        pendingTriggerModes[i] = pulsePal.currentInputParams[i].triggerMode;
+
     // Init Pulsa Pal parameter arrays
     m_isBiphasic = vector<int>(PULSEPALCHANNELS, 0);
     m_phase1Duration = vector<float>(PULSEPALCHANNELS, DEF_PHASE_DURATION);
@@ -77,6 +89,7 @@ PulsePalOutput::PulsePalOutput()
 
 PulsePalOutput::~PulsePalOutput()
 {
+    triggerQueue.stop();
     pulsePal.updateDisplay ("PULSE PAL v1.0","Click for menu");
 }
 
@@ -95,6 +108,8 @@ void PulsePalOutput::handleEvent (const EventChannel* eventInfo, const MidiMessa
         const int eventId       = ttl->getSourceIndex();
         const int sourceId      = ttl->getSourceID();
         const int eventChannel  = ttl->getChannel();
+        const uint32 originId   = getProcessorFullId (eventInfo->getTimestampOriginProcessor(),
+                                                      eventInfo->getTimestampOriginSubProcessor());
 
         for (int i = 0; i < PULSEPALCHANNELS; ++i)
         {
@@ -104,8 +119,7 @@ void PulsePalOutput::handleEvent (const EventChannel* eventInfo, const MidiMessa
                 if (eventId == s.eventIndex && sourceId == s.sourceId
                         && eventChannel == s.channel && state)
                 {
-                    std::cout << "Trigger " << i + 1 << std::endl;
-                    pulsePal.triggerChannel (i + 1);
+                    triggerQueue.pushAt (i + 1, TriggerQueue::getTargetTimestamp (originId, ttl->getTimestamp(), 0.0));
                 }
             }
             if (channelTtlGate[i] != -1)
@@ -163,6 +177,42 @@ void PulsePalOutput::process (AudioSampleBuffer& buffer)
     checkForEvents ();
 }
 
+bool PulsePalOutput::enable()
+{
+    triggerQueue.start();
+    queueRunning = true;
+    return isEnabled;
+}
+
+bool PulsePalOutput::disable()
+{
+    triggerQueue.stop();
+    queueRunning = false;
+    std::cout << "Pulse Pal: " << triggerQueue.getStatistics() << std::endl;
+    return true;
+}
+
+PulsePalOutput::TriggerQueue::TriggerQueue (PulsePalOutput& processor_)
+    : SerialCommandQueue<int> ("Pulse Pal", 256)
+    , processor (processor_)
+{
+}
+
+PulsePalOutput::TriggerQueue::~TriggerQueue()
+{
+    stop();
+}
+
+bool PulsePalOutput::TriggerQueue::sendCommand (const int& channel)
+{
+    if (channel == UPLOAD_PARAMETERS)
+        return processor.uploadParameters();
+
+    std::cout << "Trigger " << channel << std::endl;
+    processor.pulsePal.triggerChannel (channel);
+    return true;
+}
+
 void PulsePalOutput::addEventSource(EventSources s)
 {
     sources.add (s);
@@ -179,29 +229,75 @@ bool PulsePalOutput::updatePulsePal(int chan)
     if (pulsePalVersion != 0)
     {
         int actual_chan = chan + 1;
-        pulsePal.setBiphasic(actual_chan, m_isBiphasic[chan]);
-        pulsePal.setPhase1Duration(actual_chan, float(m_phase1Duration[chan])/1000);
-        pulsePal.setPhase2Duration(actual_chan, float(m_phase2Duration[chan])/1000);
-        pulsePal.setInterPhaseInterval(actual_chan, float(m_interPhaseInterval[chan])/1000);
-        pulsePal.setPhase1Voltage(actual_chan, float(m_phase1Voltage[chan]));
-        pulsePal.setPhase2Voltage(actual_chan, float(m_phase2Voltage[chan]));
-        pulsePal.setRestingVoltage(actual_chan, float(m_restingVoltage[chan]));
-        pulsePal.setInterPulseInterval(actual_chan, float(m_interPulseInterval[chan])/1000);
-        pulsePal.setBurstDuration(actual_chan, float(m_burstDuration[chan])/1000);
-        pulsePal.setBurstInterval(actual_chan, float(m_interBurstInterval[chan])/1000);
-        pulsePal.setPulseTrainDuration(actual_chan, float(m_trainDuration[chan])/1000);
-        pulsePal.setPulseTrainDelay(actual_chan, float(m_trainDelay[chan])/1000);
-
-        pulsePal.setTrigger1Link(actual_chan, m_linkTriggerChannel1[chan]);
-        pulsePal.setTrigger2Link(actual_chan, m_linkTriggerChannel2[chan]);
-        pulsePal.setTriggerMode(actual_chan, m_triggerMode[chan]);
-		pulsePal.setContinuousLoop(actual_chan, m_continuous[chan]);
+        {
+            const SpinLock::ScopedLockType lock (parameterLock);
+
+            PulsePal::OutputParams& params = pendingParams[actual_chan];
+            params.isBiphasic = m_isBiphasic[chan] ? 1 : 0;
+            params.phase1Duration = float(m_phase1Duration[chan])/1000;
+            params.phase2Duration = float(m_phase2Duration[chan])/1000;
+            params.interPhaseInterval = float(m_interPhaseInterval[chan])/1000;
+            params.phase1Voltage = float(m_phase1Voltage[chan]);
+            params.phase2Voltage = float(m_phase2Voltage[chan]);
+            params.restingVoltage = float(m_restingVoltage[chan]);
+            params.interPulseInterval = float(m_interPulseInterval[chan])/1000;
+            params.burstDuration = float(m_burstDuration[chan])/1000;
+            params.interBurstInterval = float(m_interBurstInterval[chan])/1000;
+            params.pulseTrainDuration = float(m_trainDuration[chan])/1000;
+            params.pulseTrainDelay = float(m_trainDelay[chan])/1000;
+            params.linkTriggerChannel1 = m_linkTriggerChannel1[chan];
+            params.linkTriggerChannel2 = m_linkTriggerChannel2[chan];
+
+            // only the first two channels have a trigger input of their own
+            if (actual_chan < 3)
+                pendingTriggerModes[actual_chan] = m_triggerMode[chan];
+            pendingContinuous[actual_chan] = m_continuous[chan];
+        }
+
+        // while acquiring the trigger queue owns the serial port; one upload
+        // takes all the changes made until it is sent
+        if (! queueRunning)
+            uploadParameters();
+        else if (uploadQueued.compareAndSetBool (1, 0) && ! triggerQueue.push (TriggerQueue::UPLOAD_PARAMETERS))
+            uploadQueued = 0;
+
         return true;
     }
     else
         return false;
 }
 
+bool PulsePalOutput::uploadParameters()
+{
+    int continuous[PULSEPALCHANNELS + 1];
+    {
+        const SpinLock::ScopedLockType lock (parameterLock);
+        uploadQueued = 0;
+
+        for (int i = 1; i <= PULSEPALCHANNELS; ++i)
+        {
+            pulsePal.setOutputParams(i, pendingParams[i]);
+            continuous[i] = pendingContinuous[i];
+        }
+        for (int i = 1; i < 3; ++i)
+            pulsePal.currentInputParams[i].triggerMode = pendingTriggerModes[i];
+    }
+
+    pulsePal.syncAllParams();
+
+    // the loop state is not part of the bulk transfer
+    for (int i = 1; i <= PULSEPALCHANNELS; ++i)
+    {
+        if (continuous[i] != sentContinuous[i])
+        {
+            pulsePal.setContinuousLoop(i, continuous[i]);
+            sentContinuous[i] = continuous[i];
+        }
+    }
+
+    return true;
+}
+
 bool PulsePalOutput::getIsBiphasic(int chan) const
 {
     if (m_isBiphasic[chan])
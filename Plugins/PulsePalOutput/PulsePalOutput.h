@@ -67,6 +67,11 @@ struct EventSources
     Allows the user to set all Pulse Pal (Sanworks - www.sanworks.io) parameters and to trigger
     and gate Pulse Pal stimulation in response to TTL events.
 
+    The triggers are sent to the Pulse Pal by a SerialCommandQueue, so that the serial port is
+    never written from the audio callback. They are scheduled for the timestamp of the event
+    that caused them, so the jitter of each one is written to the recording; the stimulus delay
+    itself is the train delay of the Pulse Pal channel, timed by the device.
+
     @see GenericProcessor, PulsePalOutputEditor, PulsePalOutputCanvas, PulsePal
 */
 class PulsePalOutput : public GenericProcessor
@@ -87,12 +92,19 @@ public:
      */
     AudioProcessorEditor* createEditor() override;
     void process (AudioSampleBuffer& buffer) override;
+    bool readsContinuousData() const override { return false; }
+    bool modifiesContinuousData() const override { return false; }
+    bool emitsEvents() const override { return false; }
     void setParameter (int parameterIndex, float newValue) override;
     void handleEvent (const EventChannel* eventInfo, const MidiMessage& event, int sampleNum) override;
+    bool enable() override;
+    bool disable() override;
     void saveCustomParametersToXml(XmlElement *parentElement);
     void loadCustomParametersFromXml();
     /**
-     * @brief updatePulsePal sets parameters of channel chan to the Pulse Pal
+     * @brief updatePulsePal sets parameters of channel chan to the Pulse Pal.
+     * All the parameters are sent in one bulk transfer, from the trigger queue
+     * while acquiring, and changes made before it is sent share the transfer.
      * @param chan: channel number (0-1-2-3) to update
      * @return true if Pulse Pal is connected, false otherwise
      */
@@ -197,6 +209,36 @@ private:
     PulsePal pulsePal;
     uint32_t pulsePalVersion;
 
+    /** Sends the whole parameter set taken by updatePulsePal() in one transfer */
+    bool uploadParameters();
+
+    /** Sends the channel triggers queued by handleEvent(), numbered from 1, and the
+        parameter uploads queued as channel 0 */
+    class TriggerQueue : public SerialCommandQueue<int>
+    {
+    public:
+        TriggerQueue (PulsePalOutput& processor);
+        ~TriggerQueue();
+
+        enum { UPLOAD_PARAMETERS = 0 };
+
+    private:
+        bool sendCommand (const int& channel) override;
+
+        PulsePalOutput& processor;
+    };
+
+    TriggerQueue triggerQueue;
+    bool queueRunning;
+
+    // parameters waiting for uploadParameters(), guarded by parameterLock
+    SpinLock parameterLock;
+    PulsePal::OutputParams pendingParams[PULSEPALCHANNELS + 1];
+    int pendingTriggerModes[3];
+    int pendingContinuous[PULSEPALCHANNELS + 1];
+    int sentContinuous[PULSEPALCHANNELS + 1];
+    Atomic<int> uploadQueued;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PulsePalOutput);
 };
 #endif  // __PULSEPALOUTPUT_H_A8BF66D6__
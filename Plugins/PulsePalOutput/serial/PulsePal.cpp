@@ -230,7 +230,7 @@ void PulsePal::setInterPulseInterval(uint8_t channel, float timeInSeconds)
     uint32_t timeInCycles = (uint32_t)(timeInSeconds * CycleFreq);
     constrain(&timeInCycles, 1, MAX_Cycles);
     program(channel, 7, timeInCycles);
-    PulsePal::currentOutputParams[channel].interPhaseInterval = timeInSeconds;
+    PulsePal::currentOutputParams[channel].interPulseInterval = timeInSeconds;
 }
 
 void PulsePal::setBurstDuration(uint8_t channel, float timeInSeconds)
@@ -306,7 +306,7 @@ void PulsePal::program(uint8_t channel, uint8_t paramCode, uint32_t paramValue)
     message[4] = (paramValue & 0xff);
     message[5] = (paramValue & 0xff00) >> 8;
     message[6] = (paramValue & 0xff0000) >> 16;
-    message[7] = (paramValue & 0xff00000) >> 24;
+    message[7] = (paramValue & 0xff000000) >> 24;
     serial.writeBytes(message, 8);
     //std::cout << "Message 2: " << (int) message2[0] << " " << (int) message2[1] << " " << (int) message2[2] <<  " " << (int) message2[3] << (int) message2[4] << (int) message2[5] << (int) message2[6] << (int) message2[7] << std::endl;
 }
@@ -495,6 +495,32 @@ void PulsePal::sendCustomPulseTrain(uint8_t ID, uint16_t nPulses, float customPu
     serial.writeBytes(messageBytes, byteIndex);
 }
 
+void PulsePal::setOutputParams(uint8_t channel, const OutputParams& params)
+{
+    OutputParams& current = currentOutputParams[channel];
+    current = params;
+    current.phase1Duration = constrainTime(params.phase1Duration, 1);
+    current.interPhaseInterval = constrainTime(params.interPhaseInterval, 1);
+    current.phase2Duration = constrainTime(params.phase2Duration, 1);
+    current.interPulseInterval = constrainTime(params.interPulseInterval, 1);
+    current.burstDuration = constrainTime(params.burstDuration, 0);
+    current.interBurstInterval = constrainTime(params.interBurstInterval, 0);
+    current.pulseTrainDuration = constrainTime(params.pulseTrainDuration, 1);
+    current.pulseTrainDelay = constrainTime(params.pulseTrainDelay, 1);
+}
+
+float PulsePal::constrainTime(float timeInSeconds, uint32_t minCycles)
+{
+    uint32_t timeInCycles = (uint32_t)(timeInSeconds * CycleFreq);
+    uint32_t constrained = timeInCycles;
+    constrain(&constrained, minCycles, MAX_Cycles);
+
+    // times in range are kept as they are, so syncAllParams() rounds them like the setters do
+    if (constrained == timeInCycles)
+        return timeInSeconds;
+    return float(constrained) / CycleFreq;
+}
+
 void PulsePal::syncAllParams() {
 
     uint8_t messageBytes[180] = { 0 };
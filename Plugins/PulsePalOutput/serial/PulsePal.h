@@ -109,8 +109,12 @@ public:
         int triggerMode;
     } currentInputParams[3]; // Use 1-indexing for the trigger channels
 
+    // Set the fields of one output channel for the next syncAllParams(), constrained like the single parameter setters
+    void setOutputParams(uint8_t channel, const OutputParams& params);
+
 private:
     void constrain(uint32_t* value, uint32_t min, uint32_t max);
+    float constrainTime(float timeInSeconds, uint32_t minCycles);
     void program(uint8_t channel, uint8_t paramCode, uint32_t paramValue);
     void program(uint8_t channel, uint8_t paramCode, uint16_t paramValue);
     void program(uint8_t channel, uint8_t paramCode, uint8_t paramValue);
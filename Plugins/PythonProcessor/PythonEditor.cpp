@@ -0,0 +1,125 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PythonEditor.h"
+#include "PythonProcessor.h"
+
+PythonEditor::PythonEditor(GenericProcessor* parentNode, bool useDefaultParameterEditors=true)
+    : GenericEditor(parentNode, useDefaultParameterEditors)
+{
+    pythonProcessor = (PythonProcessor*) parentNode;
+
+    lastFilePath = File::getCurrentWorkingDirectory();
+
+    fileButton = new UtilityButton("Select file",Font("Small Text", 13, Font::plain));
+    fileButton->addListener(this);
+    fileButton->setBounds(10,85,100,25);
+    addAndMakeVisible(fileButton);
+
+    reloadFileButton = new UtilityButton("refresh",Font("Small Text", 13, Font::plain));
+    reloadFileButton->addListener(this);
+    reloadFileButton->setBounds(100+10,85,60,25);
+    addAndMakeVisible(reloadFileButton);
+
+    inlineButton = new UtilityButton("inline",Font("Small Text", 13, Font::plain));
+    inlineButton->setClickingTogglesState(true);
+    inlineButton->setTooltip("Call Python from the audio callback on the buffer itself, instead of on a thread of its own");
+    inlineButton->addListener(this);
+    inlineButton->setBounds(10,60,50,20);
+    addAndMakeVisible(inlineButton);
+
+    asyncButton = new UtilityButton("async",Font("Small Text", 13, Font::plain));
+    asyncButton->setClickingTogglesState(true);
+    asyncButton->setTooltip("Run Python alongside acquisition, one block behind, instead of waiting for it on every block");
+    asyncButton->addListener(this);
+    asyncButton->setBounds(65,60,50,20);
+    addAndMakeVisible(asyncButton);
+
+    fileNameLabel = new Label("FileNameLabel", "No file selected.");
+    fileNameLabel->setBounds(10,85+20,160,25);
+    addAndMakeVisible(fileNameLabel);
+
+    desiredWidth = 180;
+
+    setEnabledState(false);
+}
+
+PythonEditor::~PythonEditor()
+{
+
+}
+
+void PythonEditor::setFile(String file)
+{
+    File fileToRead(file);
+    lastFilePath = fileToRead.getParentDirectory();
+    pythonProcessor->setFile(fileToRead.getFullPathName());
+    fileNameLabel->setText(fileToRead.getFileName(), dontSendNotification);
+}
+
+void PythonEditor::setInline(bool shouldRunInline)
+{
+    inlineButton->setToggleState(shouldRunInline, dontSendNotification);
+    asyncButton->setEnabled(!shouldRunInline);
+    pythonProcessor->setInline(shouldRunInline);
+}
+
+void PythonEditor::setAsynchronous(bool shouldRunAsynchronously)
+{
+    asyncButton->setToggleState(shouldRunAsynchronously, dontSendNotification);
+    pythonProcessor->setAsynchronous(shouldRunAsynchronously);
+}
+
+void PythonEditor::buttonEvent(Button* button)
+{
+    // the mode can't change in the middle of acquisition
+    if (button == inlineButton)
+    {
+        if (acquisitionIsActive)
+            inlineButton->setToggleState(pythonProcessor->isInline(), dontSendNotification);
+        else
+            setInline(inlineButton->getToggleState());
+    }
+
+    if (button == asyncButton)
+    {
+        if (acquisitionIsActive)
+            asyncButton->setToggleState(pythonProcessor->isAsynchronous(), dontSendNotification);
+        else
+            pythonProcessor->setAsynchronous(asyncButton->getToggleState());
+    }
+
+    if (!acquisitionIsActive)
+    {
+        if (button == fileButton)
+        {
+            FileChooser choosePythonFile("Please select the file you want to load...", lastFilePath, "*.py");
+
+            if (choosePythonFile.browseForFileToOpen())
+                setFile(choosePythonFile.getResult().getFullPathName());
+        }
+        if (button == reloadFileButton)
+        {
+            pythonProcessor->reloadFile();
+        }
+    }
+}
@@ -0,0 +1,62 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PYTHONEDITOR_H_INCLUDED
+#define PYTHONEDITOR_H_INCLUDED
+
+#include <EditorHeaders.h>
+
+class PythonProcessor;
+
+/**
+
+  User interface for the Python processor.
+
+  @see PythonProcessor
+
+*/
+
+class PythonEditor : public GenericEditor
+
+{
+public:
+    PythonEditor(GenericProcessor* parentNode, bool useDefaultParameterEditors);
+    virtual ~PythonEditor();
+    void buttonEvent(Button* button) override;
+    void setFile(String file);
+    void setInline(bool shouldRunInline);
+    void setAsynchronous(bool shouldRunAsynchronously);
+
+private:
+    ScopedPointer<UtilityButton> fileButton;
+    ScopedPointer<UtilityButton> reloadFileButton;
+    ScopedPointer<UtilityButton> inlineButton;
+    ScopedPointer<UtilityButton> asyncButton;
+    ScopedPointer<Label> fileNameLabel;
+    PythonProcessor* pythonProcessor;
+    File lastFilePath;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PythonEditor);
+};
+
+
+#endif  // PYTHONEDITOR_H_INCLUDED
@@ -0,0 +1,525 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Python.h has to come before any system header
+#include <Python.h>
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+#include <numpy/arrayobject.h>
+
+#include "PythonProcessor.h"
+#include "PythonEditor.h"
+
+namespace
+{
+    // blocks that can be waiting for the interpreter thread
+    const int numBlocks = 8;
+    // larger buffers are handed over in several blocks
+    const int maxBlockSamples = 4096;
+    // events beyond this in one block are not passed to Python
+    const int maxBlockEvents = 512;
+    // samples per channel that can be coming back from the interpreter thread
+    const int fifoSize = 16384;
+
+    /** Distance in floats between consecutive channels, or 0 if they are not evenly spaced */
+    int getChannelStride(AudioSampleBuffer& buffer, int numChannels)
+    {
+        if (numChannels < 2)
+            return buffer.getNumSamples();
+
+        const float* first = buffer.getReadPointer(0);
+        const ptrdiff_t stride = buffer.getReadPointer(1) - first;
+
+        if (stride < buffer.getNumSamples())
+            return 0;
+
+        for (int ch = 2; ch < numChannels; ch++)
+        {
+            if (buffer.getReadPointer(ch) - first != ch * stride)
+                return 0;
+        }
+
+        return (int) stride;
+    }
+}
+
+PythonProcessor::PythonProcessor()
+    : GenericProcessor("Python Processor")
+    , Thread("Python")
+    , runInline(false)
+    , asynchronous(false)
+    , blockFifo(numBlocks)
+    , outputFifo(fifoSize)
+    , numBlockChannels(0)
+    , processFunction(nullptr)
+    , mainThreadState(nullptr)
+{
+    for (int i = 0; i < numBlocks; i++)
+        blocks.add(new Block());
+}
+
+PythonProcessor::~PythonProcessor()
+{
+    // the interpreter thread shuts Python down as it exits
+    signalThreadShouldExit();
+    workToDo.signal();
+    stopThread(5000);
+}
+
+AudioProcessorEditor* PythonProcessor::createEditor()
+{
+    editor = new PythonEditor(this, true);
+    std::cout << "Creating Python editor." << std::endl;
+    return editor;
+}
+
+void PythonProcessor::setFile(String fullpath)
+{
+    filePath = fullpath;
+    runFile(filePath);
+
+    if (!isThreadRunning())
+        startThread();
+}
+
+String PythonProcessor::getFile()
+{
+    return filePath;
+}
+
+void PythonProcessor::reloadFile()
+{
+    if (filePath.isNotEmpty())
+        runFile(filePath);
+    else
+        std::cout << "No Python file loaded - cant refresh" << std::endl;
+}
+
+void PythonProcessor::runFile(const String& path)
+{
+    const ScopedLock sl(fileLock);
+    pendingFiles.add(path);
+    workToDo.signal();
+}
+
+bool PythonProcessor::initialisePython()
+{
+    // leaves the signal handlers of the GUI alone
+    Py_InitializeEx(0);
+
+#if PY_VERSION_HEX < 0x03070000
+    PyEval_InitThreads();
+#endif
+
+    if (_import_array() < 0)
+    {
+        PyErr_Print();
+        std::cout << "Python Processor: NumPy could not be imported." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void PythonProcessor::run()
+{
+    const bool initialised = initialisePython();
+
+    // the GIL is only held while Python code runs, so that process() can take it in inline mode
+    mainThreadState = PyEval_SaveThread();
+
+    while (!threadShouldExit())
+    {
+        workToDo.wait(100);
+
+        StringArray paths;
+        {
+            const ScopedLock sl(fileLock);
+            paths.swapWith(pendingFiles);
+        }
+
+        if (!initialised || (paths.isEmpty() && blockFifo.getNumReady() == 0))
+            continue;
+
+        const ScopedLock sl(interpreterLock);
+        PyEval_RestoreThread(mainThreadState);
+
+        runFiles(paths);
+        processPendingBlocks();
+
+        mainThreadState = PyEval_SaveThread();
+    }
+
+    PyEval_RestoreThread(mainThreadState);
+    Py_CLEAR(processFunction);
+    Py_Finalize();
+}
+
+void PythonProcessor::runFiles(const StringArray& paths)
+{
+    if (paths.isEmpty())
+        return;
+
+    PyObject* mainModule = PyImport_AddModule("__main__");
+    PyObject* globals = PyModule_GetDict(mainModule);
+
+    for (int i = 0; i < paths.size(); i++)
+    {
+        std::cout << "Running Python file " << paths[i] << std::endl;
+
+        const String code = File(paths[i]).loadFileAsString();
+        PyObject* compiled = Py_CompileString(code.toRawUTF8(), paths[i].toRawUTF8(), Py_file_input);
+
+        if (compiled == nullptr)
+        {
+            PyErr_Print();
+            continue;
+        }
+
+        PyObject* result = PyEval_EvalCode(compiled, globals, globals);
+        Py_DECREF(compiled);
+
+        if (result == nullptr)
+            PyErr_Print();
+        else
+            Py_DECREF(result);
+    }
+
+    // the file might have redefined the function, so it is looked up here rather than on every block
+    Py_CLEAR(processFunction);
+    processFunction = PyObject_GetAttrString(mainModule, "oe_process");
+
+    if (processFunction == nullptr || !PyCallable_Check(processFunction))
+    {
+        PyErr_Clear();
+        Py_CLEAR(processFunction);
+        std::cout << "oe_process is not defined" << std::endl;
+    }
+
+    pythonReady = 1;
+}
+
+void PythonProcessor::callProcessFunction(float* samples, int numChannels, int channelStride, int numSamples,
+                                          juce::int64* events, int numEvents)
+{
+    if (processFunction == nullptr)
+        return;
+
+    npy_intp sampleDims[2] = { numChannels, numSamples };
+    npy_intp sampleStrides[2] = { channelStride * (npy_intp) sizeof(float), sizeof(float) };
+    npy_intp eventDims[2] = { numEvents, NUM_EVENT_FIELDS };
+
+    // views of our own memory, nothing is copied
+    PyObject* sampleArray = PyArray_New(&PyArray_Type, 2, sampleDims, NPY_FLOAT32, sampleStrides, samples,
+                                        0, NPY_ARRAY_WRITEABLE | NPY_ARRAY_ALIGNED, nullptr);
+    PyObject* eventArray = PyArray_SimpleNewFromData(2, eventDims, NPY_INT64, events);
+
+    PyObject* result = nullptr;
+
+    if (sampleArray != nullptr && eventArray != nullptr)
+        result = PyObject_CallFunctionObjArgs(processFunction, sampleArray, eventArray, nullptr);
+
+    if (result == nullptr)
+    {
+        // rather than printing the same traceback for every block
+        PyErr_Print();
+        Py_CLEAR(processFunction);
+        std::cout << "oe_process failed, it won't be called again until the file is reloaded" << std::endl;
+    }
+
+    Py_XDECREF(result);
+    Py_XDECREF(sampleArray);
+    Py_XDECREF(eventArray);
+}
+
+void PythonProcessor::copyEvents(Block& block, int firstSample, int numSamples)
+{
+    const EventIndex& index = getEventIndex();
+
+    block.numEvents = 0;
+
+    for (int n = 0; n < index.getNumEvents() && block.numEvents < maxBlockEvents; n++)
+    {
+        const int sample = index.getSamplePosition(n);
+        if (sample < firstSample || sample >= firstSample + numSamples)
+            continue;
+
+        const EventType type = index.getBaseType(n);
+        juce::int64* row = block.events + block.numEvents * NUM_EVENT_FIELDS;
+
+        row[EVENT_SAMPLE] = sample - firstSample;
+        row[EVENT_TYPE] = type;
+        row[EVENT_SUBTYPE] = index.getSubType(n);
+        row[EVENT_SOURCE_ID] = index.getSourceID(n);
+        row[EVENT_SUBPROCESSOR] = index.getSubProcessorIdx(n);
+        row[EVENT_SOURCE_INDEX] = index.getSourceIndex(n);
+        row[EVENT_TIMESTAMP] = index.getTimestamp(n);
+        row[EVENT_CHANNEL] = -1;
+        row[EVENT_STATE] = -1;
+
+        if (type == PROCESSOR_EVENT && index.getDataSize(n) >= EVENT_BASE_SIZE)
+        {
+            const uint8* data = index.getData(n);
+            const uint16 channel = *reinterpret_cast<const uint16*>(data + 16);
+            row[EVENT_CHANNEL] = channel;
+
+            // the state of a TTL event is the channel's bit of the TTL word
+            if (index.getSubType(n) == EventChannel::TTL && index.getDataSize(n) > EVENT_BASE_SIZE + channel / 8)
+                row[EVENT_STATE] = (data[EVENT_BASE_SIZE + channel / 8] >> (channel % 8)) & 1;
+        }
+
+        block.numEvents++;
+    }
+}
+
+void PythonProcessor::processPendingBlocks()
+{
+    const ScopedLock sl(blockLock);
+
+    int start1, size1, start2, size2;
+
+    while (blockFifo.getNumReady() > 0)
+    {
+        blockFifo.prepareToRead(1, start1, size1, start2, size2);
+        Block& block = *blocks[start1];
+
+        if (outputFifo.getFreeSpace() < block.numSamples)
+            break;
+
+        callProcessFunction(block.samples.getWritePointer(0), numBlockChannels,
+                            getChannelStride(block.samples, numBlockChannels), block.numSamples,
+                            block.events, block.numEvents);
+
+        outputFifo.prepareToWrite(block.numSamples, start1, size1, start2, size2);
+        for (int ch = 0; ch < numBlockChannels; ch++)
+        {
+            outputSamples.copyFrom(ch, start1, block.samples, ch, 0, size1);
+            if (size2 > 0)
+                outputSamples.copyFrom(ch, start2, block.samples, ch, size1, size2);
+        }
+        outputFifo.finishedWrite(size1 + size2);
+
+        blockFifo.finishedRead(1);
+    }
+
+    blockDone.signal();
+}
+
+bool PythonProcessor::enable()
+{
+    const ScopedLock sl(blockLock);
+
+    numBlockChannels = jmin(getNumOutputs(), getNumInputs());
+
+    for (int i = 0; i < numBlocks; i++)
+    {
+        blocks[i]->samples.setSize(numBlockChannels, maxBlockSamples);
+        blocks[i]->events.malloc(maxBlockEvents * NUM_EVENT_FIELDS);
+        blocks[i]->numSamples = 0;
+        blocks[i]->numEvents = 0;
+    }
+
+    inlineBlock.samples.setSize(numBlockChannels, maxBlockSamples);
+    inlineBlock.events.malloc(maxBlockEvents * NUM_EVENT_FIELDS);
+    inlineBlock.numEvents = 0;
+
+    outputSamples.setSize(numBlockChannels, fifoSize);
+    blockFifo.reset();
+    outputFifo.reset();
+    numDroppedSamples = 0;
+    numSkippedBlocks = 0;
+
+    return true;
+}
+
+bool PythonProcessor::disable()
+{
+    if (numDroppedSamples.get() > 0)
+        std::cout << "Python could not keep up, " << numDroppedSamples.get() << " samples were not processed" << std::endl;
+
+    if (numSkippedBlocks.get() > 0)
+        std::cout << numSkippedBlocks.get() << " blocks went through unprocessed while a Python file was loading" << std::endl;
+
+    return true;
+}
+
+void PythonProcessor::process(AudioSampleBuffer& buffer)
+{
+    // until Python has started and loaded the file, the data goes through untouched
+    if (pythonReady.get() == 0 || numBlockChannels == 0 || buffer.getNumSamples() == 0)
+        return;
+
+    if (runInline)
+        processInline(buffer);
+    else
+        processOnThread(buffer);
+}
+
+void PythonProcessor::processInline(AudioSampleBuffer& buffer)
+{
+    // the interpreter thread is running a file
+    if (!interpreterLock.tryEnter())
+    {
+        numSkippedBlocks += 1;
+        return;
+    }
+
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = jmin(numBlockChannels, buffer.getNumChannels());
+    const int stride = getChannelStride(buffer, numChannels);
+
+    const PyGILState_STATE gil = PyGILState_Ensure();
+
+    if (stride > 0)
+    {
+        copyEvents(inlineBlock, 0, numSamples);
+        callProcessFunction(buffer.getWritePointer(0), numChannels, stride, numSamples,
+                            inlineBlock.events, inlineBlock.numEvents);
+    }
+    else
+    {
+        // the channels can't be viewed as a single array, so they go through inlineBlock
+        const int blockStride = getChannelStride(inlineBlock.samples, numChannels);
+
+        for (int first = 0; first < numSamples; first += maxBlockSamples)
+        {
+            const int size = jmin(maxBlockSamples, numSamples - first);
+
+            for (int ch = 0; ch < numChannels; ch++)
+                inlineBlock.samples.copyFrom(ch, 0, buffer, ch, first, size);
+
+            copyEvents(inlineBlock, first, size);
+            callProcessFunction(inlineBlock.samples.getWritePointer(0), numChannels, blockStride, size,
+                                inlineBlock.events, inlineBlock.numEvents);
+
+            for (int ch = 0; ch < numChannels; ch++)
+                buffer.copyFrom(ch, first, inlineBlock.samples, ch, 0, size);
+        }
+    }
+
+    PyGILState_Release(gil);
+    interpreterLock.exit();
+}
+
+void PythonProcessor::processOnThread(AudioSampleBuffer& buffer)
+{
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = jmin(numBlockChannels, buffer.getNumChannels());
+    int start1, size1, start2, size2;
+
+    for (int first = 0; first < numSamples; first += maxBlockSamples)
+    {
+        const int size = jmin(maxBlockSamples, numSamples - first);
+
+        if (blockFifo.getFreeSpace() == 0)
+        {
+            numDroppedSamples += size;
+            continue;
+        }
+
+        blockFifo.prepareToWrite(1, start1, size1, start2, size2);
+        Block& block = *blocks[start1];
+
+        for (int ch = 0; ch < numChannels; ch++)
+            block.samples.copyFrom(ch, 0, buffer, ch, first, size);
+
+        block.numSamples = size;
+        copyEvents(block, first, size);
+
+        blockFifo.finishedWrite(1);
+    }
+
+    workToDo.signal();
+
+    // gives up after a second, so that a stuck script can't hang acquisition
+    if (!asynchronous)
+    {
+        while (outputFifo.getNumReady() < numSamples && blockDone.wait(1000))
+        {
+        }
+    }
+
+    if (outputFifo.getNumReady() >= numSamples)
+    {
+        outputFifo.prepareToRead(numSamples, start1, size1, start2, size2);
+        for (int ch = 0; ch < numChannels; ch++)
+        {
+            buffer.copyFrom(ch, 0, outputSamples, ch, start1, size1);
+            if (size2 > 0)
+                buffer.copyFrom(ch, size1, outputSamples, ch, start2, size2);
+        }
+        outputFifo.finishedRead(size1 + size2);
+    }
+    else
+    {
+        // the first block in asynchronous mode, or Python fell behind
+        for (int ch = 0; ch < numChannels; ch++)
+            buffer.clear(ch, 0, numSamples);
+    }
+}
+
+void PythonProcessor::setInline(bool shouldRunInline)
+{
+    runInline = shouldRunInline;
+}
+
+bool PythonProcessor::isInline() const
+{
+    return runInline;
+}
+
+void PythonProcessor::setAsynchronous(bool shouldRunAsynchronously)
+{
+    asynchronous = shouldRunAsynchronously;
+}
+
+bool PythonProcessor::isAsynchronous() const
+{
+    return asynchronous;
+}
+
+void PythonProcessor::saveCustomParametersToXml(XmlElement* parentElement)
+{
+    XmlElement* childNode = parentElement->createNewChildElement("FILENAME");
+    childNode->setAttribute("path", getFile());
+    childNode->setAttribute("inline", runInline);
+    childNode->setAttribute("asynchronous", asynchronous);
+}
+
+void PythonProcessor::loadCustomParametersFromXml()
+{
+    if (parametersAsXml != nullptr)
+    {
+        forEachXmlChildElement(*parametersAsXml, xmlNode)
+        {
+            if (xmlNode->hasTagName("FILENAME"))
+            {
+                PythonEditor* pe = (PythonEditor*) getEditor();
+                pe->setInline(xmlNode->getBoolAttribute("inline", false));
+                pe->setAsynchronous(xmlNode->getBoolAttribute("asynchronous", false));
+
+                String filepath = xmlNode->getStringAttribute("path");
+                if (filepath.isNotEmpty())
+                    pe->setFile(filepath);
+            }
+        }
+    }
+}
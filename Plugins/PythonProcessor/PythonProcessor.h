@@ -0,0 +1,167 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PYTHONPROCESSOR_H_INCLUDED
+#define PYTHONPROCESSOR_H_INCLUDED
+
+#include <ProcessorHeaders.h>
+
+struct _object;
+struct _ts;
+
+/**
+  Python Processor.
+
+  Runs a Python script on the data. The script defines
+
+      oe_process(samples, events)
+
+  which is called once per block with samples, a channels x samples float32 NumPy array
+  to be modified in place, and events, an int64 NumPy array with one row per event received
+  in the block (see PythonProcessor::EventField for the columns). Both arrays are views of
+  the processor's own memory, so no data is copied into Python objects; they are only valid
+  during the call.
+
+  The interpreter is initialised on a thread of its own, which also runs the scripts. By
+  default the blocks are handed to that thread through a lock-free ring of preallocated
+  blocks, and oe_process runs there, so the audio callback never waits for the GIL. In
+  synchronous mode process() waits for the result; in asynchronous mode it returns the
+  output of the previous blocks, at the cost of one block of latency.
+
+  In inline mode oe_process is called directly from process() on the audio buffer itself,
+  with no copy and no latency. The audio callback then takes the GIL for every block, so
+  the script must not start Python threads of its own; blocks arriving while a script is
+  being loaded go through untouched.
+
+  @see GenericProcessor, PythonEditor, JuliaProcessor
+*/
+
+class PythonProcessor : public GenericProcessor, private Thread
+
+{
+public:
+    PythonProcessor();
+    ~PythonProcessor();
+    void setFile(String fullpath);
+    String getFile();
+    void reloadFile();
+    void process(AudioSampleBuffer& buffer) override;
+    bool enable() override;
+    bool disable() override;
+    AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override
+    {
+        return true;
+    }
+    void saveCustomParametersToXml(XmlElement* parentElement) override;
+    void loadCustomParametersFromXml() override;
+
+    /** Not to be changed while acquisition is active */
+    void setInline(bool shouldRunInline);
+    bool isInline() const;
+
+    /** Not to be changed while acquisition is active. Only used when not running inline. */
+    void setAsynchronous(bool shouldRunAsynchronously);
+    bool isAsynchronous() const;
+
+    /** Columns of the events array */
+    enum EventField
+    {
+        EVENT_SAMPLE = 0, // sample position in the block
+        EVENT_TYPE, // EventType
+        EVENT_SUBTYPE, // event channel type, system event type or electrode type
+        EVENT_SOURCE_ID,
+        EVENT_SUBPROCESSOR,
+        EVENT_SOURCE_INDEX,
+        EVENT_TIMESTAMP,
+        EVENT_CHANNEL, // virtual channel of processor events, -1 otherwise
+        EVENT_STATE, // 1 or 0 for TTL events, -1 otherwise
+        NUM_EVENT_FIELDS
+    };
+
+private:
+    /** A block waiting for, or being processed by, the interpreter thread */
+    struct Block
+    {
+        AudioSampleBuffer samples;
+        int numSamples;
+        HeapBlock<juce::int64> events;
+        int numEvents;
+    };
+
+    // interpreter thread
+    void run() override;
+    bool initialisePython();
+    void runFiles(const StringArray& paths);
+    void processPendingBlocks();
+
+    /** Calls oe_process on numSamples samples of numChannels channels, channelStride floats
+        apart, and on numEvents rows of events. The GIL must be held. */
+    void callProcessFunction(float* samples, int numChannels, int channelStride, int numSamples,
+                             juce::int64* events, int numEvents);
+
+    /** Adds the events of the current block in [firstSample, firstSample + numSamples) to a block */
+    void copyEvents(Block& block, int firstSample, int numSamples);
+
+    void processInline(AudioSampleBuffer& buffer);
+    void processOnThread(AudioSampleBuffer& buffer);
+
+    /** Runs a script on the interpreter thread before the next block */
+    void runFile(const String& path);
+
+    String filePath;
+
+    /** Scripts to run on the interpreter thread before the next block */
+    CriticalSection fileLock;
+    StringArray pendingFiles;
+
+    WaitableEvent workToDo;
+    WaitableEvent blockDone;
+
+    bool runInline;
+    bool asynchronous;
+
+    /** Held by whoever runs Python code; the audio callback only ever tries to enter it */
+    CriticalSection interpreterLock;
+
+    /** Blocks on their way to the interpreter thread, and samples on their way back. The
+        interpreter thread holds blockLock while it uses them. */
+    CriticalSection blockLock;
+    OwnedArray<Block> blocks;
+    AbstractFifo blockFifo;
+    AbstractFifo outputFifo;
+    AudioSampleBuffer outputSamples;
+    Block inlineBlock;
+    int numBlockChannels;
+    Atomic<int> numDroppedSamples;
+    Atomic<int> numSkippedBlocks;
+    Atomic<int> pythonReady;
+
+    // interpreter thread, or the GIL holder
+    _object* processFunction;
+    _ts* mainThreadState;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PythonProcessor);
+};
+
+
+#endif  // PYTHONPROCESSOR_H_INCLUDED
@@ -0,0 +1,25 @@
+# set things up here
+import numpy as np
+
+last = None
+
+# this function is called once per block and is passed the current block
+# in samples, a channels x samples float32 array to be modified in place,
+# and the events of the block in events, one row per event:
+# sample, type, subtype, source id, subprocessor, source index,
+# timestamp, channel, state
+
+def oe_process(samples, events):
+
+    global last
+
+    if last is None or len(last) != samples.shape[0]:
+        last = np.zeros(samples.shape[0], dtype=np.float32)
+
+    f = 0.05
+    for i in range(samples.shape[1]):
+        samples[:, i] = f * samples[:, i] + (1 - f) * last
+        last = samples[:, i]
+
+    # the arrays are only valid during the call
+    last = last.copy()
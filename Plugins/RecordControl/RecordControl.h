@@ -41,6 +41,9 @@ public:
     AudioProcessorEditor* createEditor() override;
 
     void process (AudioSampleBuffer& buffer) override;
+    bool readsContinuousData() const override { return false; }
+    bool modifiesContinuousData() const override { return false; }
+    bool emitsEvents() const override { return false; }
 
     void setParameter (int parameterIndex, float newValue) override;
     void handleEvent (const EventChannel* eventInfo, const MidiMessage& event, int) override;
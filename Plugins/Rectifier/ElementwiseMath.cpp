@@ -0,0 +1,230 @@
+/*
+   ------------------------------------------------------------------
+
+   This file is part of the Open Ephys GUI
+   Copyright (C) 2018 Open Ephys
+
+   ------------------------------------------------------------------
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "ElementwiseMath.h"
+#include "ElementwiseMathEditor.h"
+
+namespace
+{
+    /** Samples of a channel processed by the whole chain at once, small enough to stay in the L1 cache */
+    const int tileSamples = 1024;
+}
+
+
+ElementwiseMath::ElementwiseMath (const String& name)
+    : GenericProcessor (name)
+{
+    setProcessorType (PROCESSOR_TYPE_FILTER);
+}
+
+
+ElementwiseMath::~ElementwiseMath()
+{
+}
+
+
+AudioProcessorEditor* ElementwiseMath::createEditor()
+{
+    editor = new ElementwiseMathEditor (this, true);
+
+    return editor;
+}
+
+
+bool ElementwiseMath::setOperations (const String& chain)
+{
+    Array<Operation> newOperations;
+
+    StringArray steps;
+    steps.addTokens (chain, "|", "");
+    steps.trim();
+    steps.removeEmptyStrings();
+
+    for (int i = 0; i < steps.size(); ++i)
+    {
+        StringArray tokens;
+        tokens.addTokens (steps[i], " \t", "");
+        tokens.removeEmptyStrings();
+
+        const String name = tokens[0].toLowerCase();
+        const int numArguments = tokens.size() - 1;
+
+        Operation op;
+        op.a = 0.0f;
+        op.b = 0.0f;
+
+        if (name == "abs" && numArguments == 0)
+        {
+            op.type = ABS;
+        }
+        else if (name == "square" && numArguments == 0)
+        {
+            op.type = SQUARE;
+        }
+        else if (name == "scale" && numArguments == 1)
+        {
+            op.type = SCALE_OFFSET;
+            op.a = tokens[1].getFloatValue();
+        }
+        else if (name == "offset" && numArguments == 1)
+        {
+            op.type = SCALE_OFFSET;
+            op.a = 1.0f;
+            op.b = tokens[1].getFloatValue();
+        }
+        else if (name == "clamp" && numArguments == 2)
+        {
+            op.type = CLAMP;
+            op.a = tokens[1].getFloatValue();
+            op.b = tokens[2].getFloatValue();
+
+            if (op.a > op.b)
+            {
+                std::cerr << "ElementwiseMath: clamp needs its low limit below its high limit" << std::endl;
+                return false;
+            }
+        }
+        else if (name == "log" && numArguments <= 1)
+        {
+            op.type = LOG;
+            op.a = numArguments == 1 ? tokens[1].getFloatValue() : 1e-6f;
+
+            if (op.a <= 0)
+            {
+                std::cerr << "ElementwiseMath: the floor of log must be positive" << std::endl;
+                return false;
+            }
+        }
+        else
+        {
+            std::cerr << "ElementwiseMath: cannot parse operation \"" << steps[i] << "\"" << std::endl;
+            return false;
+        }
+
+        // fold consecutive scales and offsets: a2 * (a1 * x + b1) + b2
+        if (op.type == SCALE_OFFSET && newOperations.size() > 0
+            && newOperations.getLast().type == SCALE_OFFSET)
+        {
+            Operation& previous = newOperations.getReference (newOperations.size() - 1);
+            previous.a = op.a * previous.a;
+            previous.b = op.a * previous.b + op.b;
+        }
+        else
+        {
+            newOperations.add (op);
+        }
+    }
+
+    const ScopedLock myScopedLock (objectLock);
+
+    operations.swapWith (newOperations);
+    operationsText = steps.joinIntoString (" | ");
+
+    return true;
+}
+
+
+String ElementwiseMath::getOperations() const
+{
+    return operationsText;
+}
+
+
+void ElementwiseMath::applyOperations (float* samples, int numSamples) const
+{
+    for (int i = 0; i < operations.size(); ++i)
+    {
+        const Operation& op = operations.getReference (i);
+
+        switch (op.type)
+        {
+            case ABS:
+                FloatVectorOperations::abs (samples, samples, numSamples);
+                break;
+
+            case SQUARE:
+                FloatVectorOperations::multiply (samples, samples, numSamples);
+                break;
+
+            case SCALE_OFFSET:
+                if (op.a != 1.0f)
+                    FloatVectorOperations::multiply (samples, op.a, numSamples);
+                if (op.b != 0.0f)
+                    FloatVectorOperations::add (samples, op.b, numSamples);
+                break;
+
+            case CLAMP:
+                FloatVectorOperations::clip (samples, samples, op.a, op.b, numSamples);
+                break;
+
+            case LOG:
+                FloatVectorOperations::max (samples, samples, op.a, numSamples);
+                for (int n = 0; n < numSamples; ++n)
+                    samples[n] = std::log10 (samples[n]);
+                break;
+        }
+    }
+}
+
+
+void ElementwiseMath::updateSettings()
+{
+    streams.update (this);
+
+    for (int s = 0; s < streams.getNumStreams(); ++s)
+    {
+        streams.setCallback (s, [this] (AudioSampleBuffer& streamBuffer, const StreamScheduler::Block& block)
+        {
+            processStream (streamBuffer, block);
+        });
+    }
+}
+
+
+void ElementwiseMath::process (AudioSampleBuffer& buffer)
+{
+    const ScopedLock myScopedLock (objectLock);
+
+    if (operations.size() == 0)
+        return;
+
+    streams.process (buffer);
+}
+
+
+void ElementwiseMath::processStream (AudioSampleBuffer& streamBuffer, const StreamScheduler::Block& block)
+{
+    const int numSamples = block.numSamples;
+
+    parallelFor (streamBuffer.getNumChannels(), [this, &streamBuffer, numSamples] (int firstChannel, int lastChannel)
+    {
+        for (int ch = firstChannel; ch < lastChannel; ++ch)
+        {
+            float* samples = streamBuffer.getWritePointer (ch);
+
+            for (int start = 0; start < numSamples; start += tileSamples)
+                applyOperations (samples + start, jmin (tileSamples, numSamples - start));
+        }
+    });
+}
@@ -0,0 +1,114 @@
+/*
+   ------------------------------------------------------------------
+
+   This file is part of the Open Ephys GUI
+   Copyright (C) 2018 Open Ephys
+
+   ------------------------------------------------------------------
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ELEMENTWISEMATH_H_INCLUDED
+#define ELEMENTWISEMATH_H_INCLUDED
+
+#ifdef _WIN32
+    #include <Windows.h>
+#endif
+
+#include <ProcessorHeaders.h>
+
+
+/**
+    Applies a chain of element-wise operations to every sample of every channel.
+
+    The chain is written as operations separated by '|', each followed by its
+    arguments, for instance "abs | scale 2 | clamp 0 100 | log":
+
+    - abs: absolute value
+    - square: the sample times itself
+    - scale a: multiplies by a
+    - offset b: adds b
+    - clamp low high: limits to the range [low, high]
+    - log [floor]: decimal logarithm of the sample, no less than floor (1e-6 by default)
+
+    The whole chain runs in one pass over the data: each channel is processed in tiles
+    that stay in the cache while every operation of the chain is applied to them with
+    the vectorised FloatVectorOperations. Consecutive scales and offsets are folded into
+    a single multiply and add.
+
+    Each source subprocessor is processed as its own stream through a StreamScheduler,
+    over the samples that stream got in the block, so a low-rate stream next to a fast
+    one is not walked up to the length of the fast one.
+*/
+class ElementwiseMath : public GenericProcessor
+{
+public:
+    ElementwiseMath (const String& name = "Elementwise Math");
+
+    ~ElementwiseMath();
+
+    AudioProcessorEditor* createEditor() override;
+
+    bool hasEditor() const override { return true; }
+
+    void process (AudioSampleBuffer& buffer) override;
+
+    void updateSettings() override;
+
+    /** Parses and sets the chain of operations. Returns false, keeping the previous
+        chain, if the chain cannot be parsed. */
+    bool setOperations (const String& chain);
+
+    /** Returns the chain of operations as set by setOperations() */
+    String getOperations() const;
+
+
+private:
+    enum OperationType
+    {
+        ABS = 0,
+        SQUARE,
+        SCALE_OFFSET,
+        CLAMP,
+        LOG
+    };
+
+    struct Operation
+    {
+        OperationType type;
+        float a;
+        float b;
+    };
+
+    /** Applies the operations to numSamples samples in place */
+    void applyOperations (float* samples, int numSamples) const;
+
+    /** Applies the operations to every channel of a stream */
+    void processStream (AudioSampleBuffer& streamBuffer, const StreamScheduler::Block& block);
+
+    Array<Operation> operations;
+    String operationsText;
+
+    StreamScheduler streams;
+
+    CriticalSection objectLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ElementwiseMath);
+};
+
+
+
+#endif  // ELEMENTWISEMATH_H_INCLUDED
@@ -0,0 +1,93 @@
+/*
+   ------------------------------------------------------------------
+
+   This file is part of the Open Ephys GUI
+   Copyright (C) 2018 Open Ephys
+
+   ------------------------------------------------------------------
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ElementwiseMathEditor.h"
+#include "ElementwiseMath.h"
+
+
+ElementwiseMathEditor::ElementwiseMathEditor(GenericProcessor* parentNode, bool useDefaultParameterEditors=true)
+    : GenericEditor(parentNode, useDefaultParameterEditors)
+
+{
+    desiredWidth = 220;
+
+    ElementwiseMath* processor = (ElementwiseMath*) getProcessor();
+
+    operationsLabel = new Label("operations label", "Operations:");
+    operationsLabel->setBounds(10,30,120,20);
+    operationsLabel->setFont(Font("Small Text", 12, Font::plain));
+    operationsLabel->setColour(Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible(operationsLabel);
+
+    operationsValue = new Label("operations value", processor->getOperations());
+    operationsValue->setBounds(15,52,190,18);
+    operationsValue->setFont(Font("Default", 13, Font::plain));
+    operationsValue->setColour(Label::textColourId, Colours::white);
+    operationsValue->setColour(Label::backgroundColourId, Colours::grey);
+    operationsValue->setEditable(true);
+    operationsValue->addListener(this);
+    operationsValue->setTooltip("Operations applied in turn to every sample, separated by '|': "
+                                "abs, square, scale a, offset b, clamp low high, log [floor]");
+    addAndMakeVisible(operationsValue);
+
+}
+
+ElementwiseMathEditor::~ElementwiseMathEditor()
+{
+
+}
+
+
+void ElementwiseMathEditor::labelTextChanged(Label* label)
+{
+    ElementwiseMath* processor = (ElementwiseMath*) getProcessor();
+
+    if (! processor->setOperations(label->getText()))
+        CoreServices::sendStatusMessage("Invalid operations: " + label->getText());
+
+    label->setText(processor->getOperations(), dontSendNotification);
+}
+
+
+void ElementwiseMathEditor::saveCustomParameters(XmlElement* xml)
+{
+
+    xml->setAttribute("Type", "ElementwiseMathEditor");
+
+    XmlElement* values = xml->createNewChildElement("VALUES");
+    values->setAttribute("Operations", operationsValue->getText());
+}
+
+void ElementwiseMathEditor::loadCustomParameters(XmlElement* xml)
+{
+
+    forEachXmlChildElement(*xml, xmlNode)
+    {
+        if (xmlNode->hasTagName("VALUES"))
+        {
+            operationsValue->setText(xmlNode->getStringAttribute("Operations", operationsValue->getText()), sendNotificationSync);
+        }
+    }
+
+
+}
@@ -0,0 +1,60 @@
+/*
+   ------------------------------------------------------------------
+
+   This file is part of the Open Ephys GUI
+   Copyright (C) 2018 Open Ephys
+
+   ------------------------------------------------------------------
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ELEMENTWISEMATHEDITOR_H_INCLUDED
+#define ELEMENTWISEMATHEDITOR_H_INCLUDED
+
+#include <EditorHeaders.h>
+
+/**
+
+  User interface for the ElementwiseMath processor, which edits its chain of operations.
+
+  @see ElementwiseMath
+
+*/
+
+class ElementwiseMathEditor : public GenericEditor,
+    public Label::Listener
+{
+public:
+    ElementwiseMathEditor(GenericProcessor* parentNode, bool useDefaultParameterEditors);
+    virtual ~ElementwiseMathEditor();
+
+    void labelTextChanged(Label* label);
+
+    void saveCustomParameters(XmlElement* xml);
+    void loadCustomParameters(XmlElement* xml);
+
+private:
+
+    ScopedPointer<Label> operationsLabel;
+    ScopedPointer<Label> operationsValue;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ElementwiseMathEditor);
+
+};
+
+
+
+#endif  // ELEMENTWISEMATHEDITOR_H_INCLUDED
@@ -27,9 +27,9 @@
 
 
 Rectifier::Rectifier()
-    : GenericProcessor ("Rectifier")
+    : ElementwiseMath ("Rectifier")
 {
-    setProcessorType (PROCESSOR_TYPE_FILTER);
+    setOperations ("abs");
 
     // It would be nice to have the option to do -abs for negative events (e.g. sharp waves)
     //parameters.add(Parameter("Sign", -1.0, 1.0, 1.0, -1.0));
@@ -41,6 +41,12 @@ Rectifier::~Rectifier()
 }
 
 
+AudioProcessorEditor* Rectifier::createEditor()
+{
+    return GenericProcessor::createEditor();
+}
+
+
 void Rectifier::setParameter (int parameterIndex, float newValue)
 {
     editor->updateParameterButtons (parameterIndex);
@@ -52,18 +58,3 @@ void Rectifier::setParameter (int parameterIndex, float newValue)
     }
 }
 
-
-void Rectifier::process (AudioSampleBuffer& buffer)
-{
-    const int nChannels = buffer.getNumChannels();
-
-    for (int ch = 0; ch < nChannels ; ++ch)
-    {
-        const int nSamples = buffer.getNumSamples();
-        float* bufPtr = buffer.getWritePointer (ch);
-        for (int n = 0; n < nSamples; ++n)
-        {
-            *(bufPtr + n) = fabsf (*(bufPtr + n));
-        }
-    }
-}
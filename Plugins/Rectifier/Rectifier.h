@@ -30,10 +30,11 @@
 #endif
 
 #include <ProcessorHeaders.h>
+#include "ElementwiseMath.h"
 
 
-/** A simple rectifier */
-class Rectifier : public GenericProcessor
+/** A simple rectifier: an ElementwiseMath processor taking the absolute value of every sample */
+class Rectifier : public ElementwiseMath
 {
 public:
     /** The class constructor, used to initialize any members. */
@@ -42,19 +43,10 @@ public:
     /** The class destructor, used to deallocate memory */
     ~Rectifier();
 
-    /** Defines the functionality of the processor.
+    /** The rectifier has no settings, so it uses the default editor */
+    AudioProcessorEditor* createEditor() override;
 
-     The process method is called every time a new data buffer is available.
-
-     Processors can either use this method to add new data, manipulate existing
-     data, or send data to an external target (such as a display or other hardware).
-
-     Continuous signals arrive in the "buffer" variable, event data (such as TTLs
-     and spikes) is contained in the "events" variable, and "nSamples" holds the
-     number of continous samples in the current buffer (which may differ from the
-     size of the buffer).
-     */
-    void process (AudioSampleBuffer& buffer) override;
+    bool hasEditor() const override { return false; }
 
     /** Any variables used by the "process" function _must_ be modified only through
      this method while data acquisition is active. If they are modified in any
@@ -105,7 +105,11 @@ void FPGAchannelList::buttonClicked(Button* btn)
     RHD2000Editor* p = (RHD2000Editor*)proc->getEditor();
     if (btn == impedanceButton)
     {
-        p->measureImpedance();
+        // a second click cancels a measurement in progress
+        if (p->isMeasuringImpedance())
+            p->cancelImpedanceMeasurement();
+        else
+            p->measureImpedance();
     }
     else if (btn == saveImpedanceButton)
     {
@@ -549,7 +553,7 @@ RHD2000Editor::RHD2000Editor(GenericProcessor* parentNode,
     : VisualizerEditor(parentNode, useDefaultParameterEditors), board(board_)
 {
     canvas = nullptr;
-    desiredWidth = 340;
+    desiredWidth = 410;
     tabText = "FPGA";
     measureWhenRecording = false;
     saveImpedances = false;
@@ -704,6 +708,23 @@ RHD2000Editor::RHD2000Editor(GenericProcessor* parentNode,
     ledButton->setTooltip("Toggle board LEDs");
     addAndMakeVisible(ledButton);
     ledButton->setToggleState(true, dontSendNotification);
+
+    readLatencyLabel = new Label("USB reads", "USB reads");
+    readLatencyLabel->setFont(Font("Small Text", 10, Font::plain));
+    readLatencyLabel->setBounds(325, 20, 70, 20);
+    readLatencyLabel->setColour(Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible(readLatencyLabel);
+
+    readLatencyCombo = new ComboBox("ReadLatencyComboBox");
+    readLatencyCombo->setBounds(330, 35, 70, 18);
+    readLatencyCombo->addListener(this);
+    readLatencyCombo->addItem("Low latency", 1);
+    readLatencyCombo->addItem("Balanced", 2);
+    readLatencyCombo->addItem("Throughput", 3);
+    readLatencyCombo->addItem("Closed loop", 4);
+    readLatencyCombo->setTooltip("Low latency reads each block as soon as it is ready. Larger reads lower the USB overhead for high channel counts. Closed loop reads a few samples at a time and processes them right away, from the next acquisition on");
+    readLatencyCombo->setSelectedId(1, sendNotification);
+    addAndMakeVisible(readLatencyCombo);
 }
 
 RHD2000Editor::~RHD2000Editor()
@@ -722,6 +743,16 @@ void RHD2000Editor::measureImpedance()
     board->runImpedanceTest(impedanceData);
 }
 
+void RHD2000Editor::cancelImpedanceMeasurement()
+{
+    board->cancelImpedanceTest();
+}
+
+bool RHD2000Editor::isMeasuringImpedance() const
+{
+    return board->isImpedanceTestRunning();
+}
+
 void RHD2000Editor::handleAsyncUpdate()
 {
     if (!impedanceData->valid)
@@ -806,6 +837,17 @@ void RHD2000Editor::comboBoxChanged(ComboBox* comboBox)
             board->setDAChpf(HPFvalues[selection-2],true);
         }
     }
+    else if (comboBox == readLatencyCombo)
+    {
+        // how long data may wait in the FIFO to be read in larger transfers, in ms
+        float latencies[3] = {0.0f, 25.0f, 80.0f};
+        int selection = readLatencyCombo->getSelectedId();
+        if (selection >= 1 && selection <= 3)
+            board->setReadLatency(latencies[selection-1]);
+        else if (selection == 4)
+            board->setReadLatency(0.0f);
+        board->setClosedLoopMode(selection == 4);
+    }
 }
 
 
@@ -850,6 +892,8 @@ void RHD2000Editor::buttonEvent(Button* button)
     {
         std::cout << "DSP offset " << button->getToggleState() << "\n";
         board->setDSPOffset(button->getToggleState());
+        // downstream filters follow the hardware high-pass
+        CoreServices::updateSignalChain(this);
     }
     else if (button == ledButton)
     {
@@ -929,6 +973,7 @@ void RHD2000Editor::saveCustomParameters(XmlElement* xml)
     xml->setAttribute("auto_measure_impedances",measureWhenRecording);
     xml->setAttribute("LEDs", ledButton->getToggleState());
     xml->setAttribute("ClockDivideRatio", clockInterface->getClockDivideRatio());
+    xml->setAttribute("USBReadMode", readLatencyCombo->getSelectedId());
     for (int i = 0; i < 8; i++)
     {
         XmlElement* adc = xml->createNewChildElement("ADCRANGE");
@@ -959,6 +1004,7 @@ void RHD2000Editor::loadCustomParameters(XmlElement* xml)
     measureWhenRecording = xml->getBoolAttribute("auto_measure_impedances");
     ledButton->setToggleState(xml->getBoolAttribute("LEDs", true),sendNotification);
     clockInterface->setClockDivideRatio(xml->getIntAttribute("ClockDivideRatio"));
+    readLatencyCombo->setSelectedId(xml->getIntAttribute("USBReadMode", 1));
     forEachXmlChildElementWithTagName(*xml, adc, "ADCRANGE")
     {
         int channel = adc->getIntAttribute("Channel", -1);
@@ -1062,6 +1108,8 @@ void BandwidthInterface::labelTextChanged(Label* label)
             std::cout << "Actual Lower Bandwidth:  " <<  actualLowerBandwidth  << "\n";
 
             label->setText(String(round(actualLowerBandwidth*10.f)/10.f), dontSendNotification);
+
+            CoreServices::updateSignalChain(editor);
         }
     }
     else if (editor->acquisitionIsActive)
@@ -1536,6 +1584,8 @@ void DSPInterface::labelTextChanged(Label* label)
             std::cout << "Setting DSP Cutoff Freq to " << requestedValue << "\n";
             std::cout << "Actual DSP Cutoff Freq:  " <<  actualDspCutoffFreq  << "\n";
             label->setText(String(round(actualDspCutoffFreq*10.f)/10.f), dontSendNotification);
+
+            CoreServices::updateSignalChain(editor);
         }
     }
     else if (editor->acquisitionIsActive)
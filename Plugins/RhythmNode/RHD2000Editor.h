@@ -178,6 +178,8 @@ namespace RhythmNode
 		void loadCustomParameters(XmlElement* xml);
 		Visualizer* createNewCanvas(void);
 		void measureImpedance();
+		void cancelImpedanceMeasurement();
+		bool isMeasuringImpedance() const;
 
 		void setSaveImpedance(bool en);
 		void setAutoMeasureImpedance(bool en);
@@ -204,10 +206,10 @@ namespace RhythmNode
 		ScopedPointer<UtilityButton> ledButton;
 
 		ScopedPointer<UtilityButton> dspoffsetButton;
-		ScopedPointer<ComboBox> ttlSettleCombo, dacHPFcombo;
+		ScopedPointer<ComboBox> ttlSettleCombo, dacHPFcombo, readLatencyCombo;
 
 
-		ScopedPointer<Label> audioLabel, ttlSettleLabel, dacHPFlabel;
+		ScopedPointer<Label> audioLabel, ttlSettleLabel, dacHPFlabel, readLatencyLabel;
 
 		bool saveImpedances, measureWhenRecording;
 
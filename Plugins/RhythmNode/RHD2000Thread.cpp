@@ -22,6 +22,7 @@
 */
 
 #include "RHD2000Thread.h"
+#include "USBThread.h"
 #include "RHD2000Editor.h"
 using namespace RhythmNode;
 
@@ -49,6 +50,9 @@ using namespace RhythmNode;
 
 #define INIT_STEP ( evalBoard->isUSB3() ? 256 : 60)
 
+// Transfers the USB thread can read ahead of the data thread
+#define NUM_USB_BUFFERS 8
+
 // Allocates memory for a 3-D array of doubles.
 void allocateDoubleArray3D(std::vector<std::vector<std::vector<double> > >& array3D,
                            int xSize, int ySize, int zSize)
@@ -92,11 +96,16 @@ RHD2000Thread::RHD2000Thread(SourceNode* sn) : DataThread(sn),
     savedSampleRateIndex(16),
     cableLengthPortA(0.914f), cableLengthPortB(0.914f), cableLengthPortC(0.914f), cableLengthPortD(0.914f), // default is 3 feet (0.914 m),
     audioOutputL(-1), audioOutputR(-1) ,numberingScheme(1),
-    newScan(true), ledsEnabled(true)
+    newScan(true), ledsEnabled(true),
+    readLatencyMs(0.0f), minBlocksPerRead(1), maxBlocksPerRead(1),
+    closedLoopMode(false), closedLoopSamples(0)
 {
     impedanceThread = new RHDImpedanceMeasure(this);
     memset(auxBuffer, 0, sizeof(auxBuffer));
     memset(auxSamples, 0, sizeof(auxSamples));
+    blockSamples.malloc(MAX_NUM_CHANNELS * MAX_SAMPLES_PER_DATA_BLOCK * MAX_BLOCKS_PER_READ);
+    blockTimestamps.malloc(MAX_SAMPLES_PER_DATA_BLOCK * MAX_BLOCKS_PER_READ);
+    blockEventCodes.malloc(MAX_SAMPLES_PER_DATA_BLOCK * MAX_BLOCKS_PER_READ);
 
     for (int i = 0; i < 8; i++)
         adcRangeSettings[i] = 0;
@@ -105,6 +114,7 @@ RHD2000Thread::RHD2000Thread(SourceNode* sn) : DataThread(sn),
         headstagesArray.add(new RHDHeadstage(static_cast<Rhd2000EvalBoard::BoardDataSource>(i)));
 
     evalBoard = new Rhd2000EvalBoard;
+    usbThread = new USBThread(this, NUM_USB_BUFFERS);
     sourceBuffers.add(new DataBuffer(2, 10000)); // start with 2 channels and automatically resize
 
     // Open Opal Kelly XEM6010 board.
@@ -177,6 +187,9 @@ RHD2000Thread::~RHD2000Thread()
 {
     std::cout << "RHD2000 interface destroyed." << std::endl;
 
+    usbThread->stopAcquisition();
+    stopParseWorkers();
+
     if (deviceFound)
     {
         int ledArray[8] = {0, 0, 0, 0, 0, 0, 0, 0};
@@ -421,7 +434,7 @@ void RHD2000Thread::initializeBoard()
 
     // Read the resulting single data block from the USB interface. We don't
     // need to do anything with this, since it was only used for ADC calibration
-    ScopedPointer<Rhd2000DataBlock> dataBlock = new Rhd2000DataBlock(evalBoard->getNumEnabledDataStreams(), evalBoard->isUSB3());
+    dataBlock->reset(evalBoard->getNumEnabledDataStreams());
 
     evalBoard->readDataBlock(dataBlock, INIT_STEP);
     // Now that ADC calibration has been performed, we switch to the command sequence
@@ -528,8 +541,7 @@ void RHD2000Thread::scanPorts()
     evalBoard->setMaxTimeStep(INIT_STEP);
     evalBoard->setContinuousRunMode(false);
 
-    ScopedPointer<Rhd2000DataBlock> dataBlock =
-        new Rhd2000DataBlock(evalBoard->getNumEnabledDataStreams(), evalBoard->isUSB3());
+    dataBlock->reset(evalBoard->getNumEnabledDataStreams());
 
     Array<int> sumGoodDelays;
     sumGoodDelays.insertMultiple(0, 0, 8);
@@ -710,14 +722,14 @@ int RHD2000Thread::deviceId(Rhd2000DataBlock* dataBlock, int stream, int& regist
     // the initial chip name ROM registers 24-26 that hold 'RHD'.
     // This is just used to verify that we are getting good data over the SPI
     // communication channel.
-    intanChipPresent = ((char) dataBlock->auxiliaryData[stream][2][32] == 'I' &&
-                        (char) dataBlock->auxiliaryData[stream][2][33] == 'N' &&
-                        (char) dataBlock->auxiliaryData[stream][2][34] == 'T' &&
-                        (char) dataBlock->auxiliaryData[stream][2][35] == 'A' &&
-                        (char) dataBlock->auxiliaryData[stream][2][36] == 'N' &&
-                        (char) dataBlock->auxiliaryData[stream][2][24] == 'R' &&
-                        (char) dataBlock->auxiliaryData[stream][2][25] == 'H' &&
-                        (char) dataBlock->auxiliaryData[stream][2][26] == 'D');
+    intanChipPresent = ((char) dataBlock->auxiliary(stream, 2, 32) == 'I' &&
+                        (char) dataBlock->auxiliary(stream, 2, 33) == 'N' &&
+                        (char) dataBlock->auxiliary(stream, 2, 34) == 'T' &&
+                        (char) dataBlock->auxiliary(stream, 2, 35) == 'A' &&
+                        (char) dataBlock->auxiliary(stream, 2, 36) == 'N' &&
+                        (char) dataBlock->auxiliary(stream, 2, 24) == 'R' &&
+                        (char) dataBlock->auxiliary(stream, 2, 25) == 'H' &&
+                        (char) dataBlock->auxiliary(stream, 2, 26) == 'D');
 
     // If the SPI communication is bad, return -1.  Otherwise, return the Intan
     // chip ID number stored in ROM regstier 63.
@@ -728,8 +740,8 @@ int RHD2000Thread::deviceId(Rhd2000DataBlock* dataBlock, int stream, int& regist
     }
     else
     {
-        register59Value = dataBlock->auxiliaryData[stream][2][23]; // Register 59
-        return dataBlock->auxiliaryData[stream][2][19]; // chip ID (Register 63)
+        register59Value = dataBlock->auxiliary(stream, 2, 23); // Register 59
+        return dataBlock->auxiliary(stream, 2, 19); // chip ID (Register 63)
     }
 }
 
@@ -953,6 +965,19 @@ String RHD2000Thread::getChannelUnits(int chanIndex) const
     }
 }
 
+float RHD2000Thread::getHardwareHighPass(int chanIndex) const
+{
+    // the auxiliary inputs and ADCs bypass the amplifier filters, and the
+    // registers are only set once a board is found
+    if (!deviceFound || sn->getDataChannel(chanIndex)->getChannelType() != DataChannel::HEADSTAGE_CHANNEL)
+        return 0;
+
+    if (dspEnabled)
+        return float(jmax(actualDspCutoffFreq, actualLowerBandwidth));
+
+    return float(actualLowerBandwidth);
+}
+
 
 int RHD2000Thread::getNumTTLOutputs(int subproc) const
 {
@@ -1197,100 +1222,80 @@ void RHD2000Thread::setSampleRate(int sampleRateIndex, bool isTemporary)
         savedSampleRateIndex = sampleRateIndex;
     }
 
-    int numUsbBlocksToRead = 0; // placeholder - make this change the number of blocks that are read in RHD2000Thread::updateBuffer()
-
     Rhd2000EvalBoard::AmplifierSampleRate sampleRate; // just for local use
 
     switch (sampleRateIndex)
     {
         case 0:
             sampleRate = Rhd2000EvalBoard::SampleRate1000Hz;
-            numUsbBlocksToRead = 1;
             boardSampleRate = 1000.0f;
             break;
         case 1:
             sampleRate = Rhd2000EvalBoard::SampleRate1250Hz;
-            numUsbBlocksToRead = 1;
             boardSampleRate = 1250.0f;
             break;
         case 2:
             sampleRate = Rhd2000EvalBoard::SampleRate1500Hz;
-            numUsbBlocksToRead = 1;
             boardSampleRate = 1500.0f;
             break;
         case 3:
             sampleRate = Rhd2000EvalBoard::SampleRate2000Hz;
-            numUsbBlocksToRead = 1;
             boardSampleRate = 2000.0f;
             break;
         case 4:
             sampleRate = Rhd2000EvalBoard::SampleRate2500Hz;
-            numUsbBlocksToRead = 1;
             boardSampleRate = 2500.0f;
             break;
         case 5:
             sampleRate = Rhd2000EvalBoard::SampleRate3000Hz;
-            numUsbBlocksToRead = 2;
             boardSampleRate = 3000.0f;
             break;
         case 6:
             sampleRate = Rhd2000EvalBoard::SampleRate3333Hz;
-            numUsbBlocksToRead = 2;
             boardSampleRate = 3333.0f;
             break;
         case 7:
             sampleRate = Rhd2000EvalBoard::SampleRate4000Hz;
-            numUsbBlocksToRead = 2;
             boardSampleRate = 4000.0f;
             break;
         case 8:
             sampleRate = Rhd2000EvalBoard::SampleRate5000Hz;
-            numUsbBlocksToRead = 3;
             boardSampleRate = 5000.0f;
             break;
         case 9:
             sampleRate = Rhd2000EvalBoard::SampleRate6250Hz;
-            numUsbBlocksToRead = 3;
             boardSampleRate = 6250.0f;
             break;
         case 10:
             sampleRate = Rhd2000EvalBoard::SampleRate8000Hz;
-            numUsbBlocksToRead = 4;
             boardSampleRate = 8000.0f;
             break;
         case 11:
             sampleRate = Rhd2000EvalBoard::SampleRate10000Hz;
-            numUsbBlocksToRead = 6;
             boardSampleRate = 10000.0f;
             break;
         case 12:
             sampleRate = Rhd2000EvalBoard::SampleRate12500Hz;
-            numUsbBlocksToRead = 7;
             boardSampleRate = 12500.0f;
             break;
         case 13:
             sampleRate = Rhd2000EvalBoard::SampleRate15000Hz;
-            numUsbBlocksToRead = 8;
             boardSampleRate = 15000.0f;
             break;
         case 14:
             sampleRate = Rhd2000EvalBoard::SampleRate20000Hz;
-            numUsbBlocksToRead = 12;
             boardSampleRate = 20000.0f;
             break;
         case 15:
             sampleRate = Rhd2000EvalBoard::SampleRate25000Hz;
-            numUsbBlocksToRead = 14;
             boardSampleRate = 25000.0f;
             break;
         case 16:
             sampleRate = Rhd2000EvalBoard::SampleRate30000Hz;
-            numUsbBlocksToRead = 16;
             boardSampleRate = 30000.0f;
             break;
         default:
             sampleRate = Rhd2000EvalBoard::SampleRate10000Hz;
-            numUsbBlocksToRead = 6;
             boardSampleRate = 10000.0f;
     }
 
@@ -1308,7 +1313,35 @@ void RHD2000Thread::setSampleRate(int sampleRateIndex, bool isTemporary)
     evalBoard->setCableLengthMeters(Rhd2000EvalBoard::PortD, cableLengthPortD);
 
     updateRegisters();
+    updateBlocksPerRead();
+
+}
 
+void RHD2000Thread::setReadLatency(float ms)
+{
+    readLatencyMs = jmax(ms, 0.0f);
+    updateBlocksPerRead();
+}
+
+float RHD2000Thread::getReadLatency() const
+{
+    return readLatencyMs;
+}
+
+void RHD2000Thread::setClosedLoopMode(bool enabled)
+{
+    closedLoopMode = enabled;
+}
+
+bool RHD2000Thread::getClosedLoopMode() const
+{
+    return closedLoopMode;
+}
+
+void RHD2000Thread::updateBlocksPerRead()
+{
+    double blockMs = 1000.0 * Rhd2000DataBlock::getSamplesPerDataBlock(evalBoard->isUSB3()) / boardSampleRate;
+    minBlocksPerRead = jlimit(1, MAX_BLOCKS_PER_READ, int(readLatencyMs / blockMs));
 }
 
 void RHD2000Thread::updateRegisters()
@@ -1422,7 +1455,7 @@ void RHD2000Thread::setCableLength(int hsNum, float length)
 bool RHD2000Thread::startAcquisition()
 {
     impedanceThread->waitSafely();
-    dataBlock = new Rhd2000DataBlock(evalBoard->getNumEnabledDataStreams(), evalBoard->isUSB3());
+    dataBlock->reset(evalBoard->getNumEnabledDataStreams());
 
     std::cout << "Expecting " << getNumChannels() << " channels." << std::endl;
 
@@ -1454,7 +1487,23 @@ bool RHD2000Thread::startAcquisition()
 
     blockSize = dataBlock->calculateDataBlockSizeInWords(evalBoard->getNumEnabledDataStreams(), evalBoard->isUSB3());
     std::cout << "Expecting blocksize of " << blockSize << " for " << evalBoard->getNumEnabledDataStreams() << " streams" << std::endl;
+    maxBlocksPerRead = jlimit(1, MAX_BLOCKS_PER_READ, int(USB_BUFFER_SIZE / (2 * blockSize)));
+    updateBlocksPerRead();
+    closedLoopSamples = 0;
+    if (closedLoopMode)
+    {
+        closedLoopSamples = evalBoard->isUSB3() ? int(Rhd2000DataBlock::getSamplesPerDataBlock(true)) : CLOSED_LOOP_SAMPLES;
+        maxBlocksPerRead = 1;
+        std::cout << "Closed-loop mode, reading " << closedLoopSamples << " samples per transfer" << std::endl;
+    }
+    else
+    {
+        std::cout << "Reading " << minBlocksPerRead << " to " << maxBlocksPerRead << " blocks per transfer" << std::endl;
+    }
+    setDrivesProcessing(closedLoopMode);
     //evalBoard->printFIFOmetrics();
+    startParseWorkers();
+    usbThread->startAcquisition(2 * blockSize * maxBlocksPerRead);
     startThread();
 
 
@@ -1468,6 +1517,8 @@ bool RHD2000Thread::stopAcquisition()
 
     //  isTransmitting = false;
     std::cout << "RHD2000 data thread stopping acquisition." << std::endl;
+    usbThread->stopAcquisition();
+    setDrivesProcessing(false);
 
     if (isThreadRunning())
     {
@@ -1483,6 +1534,7 @@ bool RHD2000Thread::stopAcquisition()
     {
         std::cout << "Thread failed to exit, continuing anyway..." << std::endl;
     }
+    stopParseWorkers();
 
     if (deviceFound)
     {
@@ -1514,114 +1566,180 @@ bool RHD2000Thread::stopAcquisition()
     return true;
 }
 
-bool RHD2000Thread::updateBuffer()
+class RHD2000Thread::ParseWorker : public Thread
 {
-    //int chOffset;
-    unsigned char* bufferPtr;
-    //cout << "Number of 16-bit words in FIFO: " << evalBoard->numWordsInFifo() << endl;
-    //cout << "Block size: " << blockSize << endl;
+public:
+    ParseWorker(RHD2000Thread* owner, int group)
+        : Thread("Rhythm parse " + String(group)), owner(owner), group(group)
+    {
+    }
+
+    void parse()
+    {
+        start.signal();
+    }
 
-    //std::cout << "Current number of words: " <<  evalBoard->numWordsInFifo() << " for " << blockSize << std::endl;
-    if (evalBoard->isUSB3() || evalBoard->numWordsInFifo() >= blockSize)
+    void run() override
     {
-        bool return_code;
+        while (!threadShouldExit())
+        {
+            if (!start.wait(100) || threadShouldExit())
+                continue;
+            owner->parseStreamGroup(group);
+            if (--owner->pendingParseWorkers == 0)
+                owner->parseWorkersDone.signal();
+        }
+    }
 
-        return_code = evalBoard->readRawDataBlock(&bufferPtr);
-        // see Rhd2000DataBlock::fillFromUsbBuffer() for an idea of data order in bufferPtr
+private:
+    RHD2000Thread* const owner;
+    const int group;
+    WaitableEvent start;
+};
 
-        int index = 0;
-        int auxIndex, chanIndex;
-        int numStreams = enabledStreams.size();
-        int nSamps = Rhd2000DataBlock::getSamplesPerDataBlock(evalBoard->isUSB3());
+void RHD2000Thread::startParseWorkers()
+{
+    const int numStreams = enabledStreams.size();
+    const int nChansTotal = getNumChannels();
 
-        //evalBoard->printFIFOmetrics();
-        for (int samp = 0; samp < nSamps; samp++)
+    // output channels: the neural channels of every stream, then 3 aux channels per stream
+    // (except the second half of an RHD2164), then the 8 ADC channels
+    int channel = 0;
+    for (int dataStream = 0; dataStream < numStreams; dataStream++)
+    {
+        streamNeuralOffset[dataStream] = channel;
+        channel += numChannelsPerDataStream[dataStream];
+    }
+    for (int dataStream = 0; dataStream < numStreams; dataStream++)
+    {
+        streamAuxOffset[dataStream] = -1;
+        if (acquireAuxChannels && chipId[dataStream] != CHIP_ID_RHD2164_B)
         {
-            int channel = -1;
+            streamAuxOffset[dataStream] = channel;
+            channel += 3;
+        }
+    }
+    adcChannelOffset = channel;
+    parseNumChannels = nChansTotal;
 
-            if (!Rhd2000DataBlock::checkUsbHeader(bufferPtr, index))
-            {
-                cerr << "Error in Rhd2000EvalBoard::readDataBlock: Incorrect header." << endl;
-                break;
-            }
+    // leave a core for the USB thread and one for the data thread
+    int numGroups = jlimit(1, 4, jmin(numStreams / 2, SystemStats::getNumCpus() - 2));
+    groupFirstStream.clearQuick();
+    for (int group = 0; group <= numGroups; group++)
+        groupFirstStream.add(group * numStreams / numGroups);
 
-            index += 8; // magic number header width (bytes)
-            timestamps.set(0, Rhd2000DataBlock::convertUsbTimeStamp(bufferPtr, index));
-            index += 4; // timestamp width
-            auxIndex = index; // aux chans start at this offset
-            // skip aux channels for now
-            index += 6 * numStreams; // width of the 3 aux chans
-            // copy 64 neural data channels
-            for (int dataStream = 0; dataStream < numStreams; dataStream++)
-            {
-                int nChans = numChannelsPerDataStream[dataStream];
-                chanIndex = index + 2*dataStream;
-                if ((chipId[dataStream] == CHIP_ID_RHD2132) && (nChans == 16)) //RHD2132 16ch. headstage
-                {
-                    chanIndex += 2 * RHD2132_16CH_OFFSET*numStreams;
-                }
-                for (int chan = 0; chan < nChans; chan++)
-                {
-                    channel++;
-                    thisSample[channel] = float(*(uint16*)(bufferPtr + chanIndex) - 32768)*0.195f;
-                    chanIndex += 2*numStreams; // single chan width (2 bytes)
-                }
-            }
-            index += 64 * numStreams; // neural data width
-            auxIndex += 2 * numStreams; // skip AuxCmd1 slots (see updateRegisters())
-            // copy the 3 aux channels
-            if (acquireAuxChannels)
-            {
-                for (int dataStream = 0; dataStream < numStreams; dataStream++)
-                {
-                    if (chipId[dataStream] != CHIP_ID_RHD2164_B)
-                    {
-                        int auxNum = (samp+3) % 4;
-                        if (auxNum < 3)
-                        {
-                            auxSamples[dataStream][auxNum] = float(*(uint16*)(bufferPtr + auxIndex) - 32768)*0.0000374;
-                        }
-                        for (int chan = 0; chan < 3; chan++)
-                        {
-                            channel++;
-                            if (auxNum == 3)
-                            {
-                                auxBuffer[channel] = auxSamples[dataStream][chan];
-                            }
-                            thisSample[channel] = auxBuffer[channel];
-                        }
-                    }
-                    auxIndex += 2; // single chan width (2 bytes)
-                }
-            }
-            index += 2 * numStreams; // skip over filler word at the end of each data stream
-            // copy the 8 ADC channels
-            if (acquireAdcChannels)
-            {
-                for (int adcChan = 0; adcChan < 8; ++adcChan)
-                {
+    stopParseWorkers();
+    for (int group = 1; group < numGroups; group++)
+    {
+        ParseWorker* worker = new ParseWorker(this, group);
+        parseWorkers.add(worker);
+        worker->startThread();
+    }
+    std::cout << "Parsing " << numStreams << " streams on " << numGroups << " threads" << std::endl;
+}
 
-                    channel++;
-                    // ADC waveform units = volts
-                    thisSample[channel] = adcRangeSettings[adcChan] == 0 ?
-                        //0.000050354 * float(dataBlock->boardAdcData[adcChan][samp]);
-                        0.00015258789 * float(*(uint16*)(bufferPtr + index)) - 5 - 0.4096 : // account for +/-5V input range and DC offset
-                        0.00030517578 * float(*(uint16*)(bufferPtr + index));
-                    index += 2; // single chan width (2 bytes)
-                }
-            }
-            else
+void RHD2000Thread::stopParseWorkers()
+{
+    for (int i = 0; i < parseWorkers.size(); i++)
+    {
+        parseWorkers[i]->signalThreadShouldExit();
+        parseWorkers[i]->parse();
+    }
+    for (int i = 0; i < parseWorkers.size(); i++)
+        parseWorkers[i]->stopThread(500);
+    parseWorkers.clear();
+}
+
+void RHD2000Thread::parseStreamGroup(int group)
+{
+    const int numStreams = enabledStreams.size();
+    // see Rhd2000DataBlock::fillFromUsbBuffer() for an idea of data order in the buffer
+    const int auxIndex = 12 + 2 * numStreams; // after the header, the timestamp and the AuxCmd1 slots (see updateRegisters())
+    const int neuralIndex = 12 + 6 * numStreams; // after the 3 aux slots of every stream
+
+    const int firstStream = groupFirstStream[group];
+    const int numGroupStreams = groupFirstStream[group + 1] - firstStream;
+
+    // amplifier words of the group's streams in one frame, the 32 words of each stream in turn
+    float streamWords[MAX_NUM_DATA_STREAMS_USB3 * 32];
+
+    // A group often has fewer than 4 streams, which would leave the transpose without a
+    // single 4x4 vector tile. It is given a multiple of 4 columns instead: the words read
+    // past the group's streams are still in the frame, since the filler, ADC and TTL words
+    // follow the amplifier words, and their columns are never copied out.
+    const int numColumns = (numGroupStreams + 3) & ~3;
+
+    for (int samp = 0; samp < parseNumSamples; samp++)
+    {
+        const unsigned char* frame = parseBuffer + samp * parseFrameBytes;
+        float* thisSample = blockSamples + samp * parseNumChannels;
+
+        // amplifier words are interleaved by channel, one per stream
+        SampleConversion::transposeUInt16ToFloat(streamWords, reinterpret_cast<const uint16*>(frame + neuralIndex) + firstStream,
+                                                 numStreams, 32, numColumns, 32768.0f, 0.195f);
+
+        for (int s = 0; s < numGroupStreams; s++)
+        {
+            const int dataStream = firstStream + s;
+            const int nChans = numChannelsPerDataStream[dataStream];
+            int chanIndex = s * 32;
+            if ((chipId[dataStream] == CHIP_ID_RHD2132) && (nChans == 16)) //RHD2132 16ch. headstage
             {
-                index += 16; // skip ADC chans (8 * 2 bytes)
+                chanIndex += RHD2132_16CH_OFFSET;
             }
-            ttlEventWords.set(0, *(uint16*)(bufferPtr + index));
-            index += 4;
-            sourceBuffers[0]->addToBuffer(thisSample, &timestamps.getReference(0), &ttlEventWords.getReference(0), 1);
+            FloatVectorOperations::copy(thisSample + streamNeuralOffset[dataStream], streamWords + chanIndex, nChans);
         }
+    }
 
+    for (int dataStream = firstStream; dataStream < firstStream + numGroupStreams; dataStream++)
+    {
+        if (streamAuxOffset[dataStream] >= 0)
+            parseAuxChannels(dataStream, auxIndex + 2 * dataStream, streamAuxOffset[dataStream]);
     }
+}
 
+void RHD2000Thread::parseAuxChannels(int dataStream, int wordIndex, int auxOffset)
+{
+    // The 3 aux inputs take turns in the AuxCmd2 slot, one on each of the last 3 samples
+    // of every group of 4. The values of a group are held for the whole next group, so
+    // the outputs only change once per group. Reads always start on a group boundary.
+    float* held = auxBuffer + auxOffset;
+    float* latest = auxSamples[dataStream];
+    int samp = 0;
+
+    for (; samp + 4 <= parseNumSamples; samp += 4)
+    {
+        held[0] = latest[0];
+        held[1] = latest[1];
+        held[2] = latest[2];
+        for (int auxNum = 0; auxNum < 3; auxNum++)
+        {
+            const unsigned char* frame = parseBuffer + (samp + auxNum + 1) * parseFrameBytes;
+            latest[auxNum] = float(*(const uint16*)(frame + wordIndex) - 32768) * 0.0000374;
+        }
+        for (int k = 0; k < 4; k++)
+        {
+            float* thisSample = blockSamples + (samp + k) * parseNumChannels + auxOffset;
+            thisSample[0] = held[0];
+            thisSample[1] = held[1];
+            thisSample[2] = held[2];
+        }
+    }
 
+    // a read cut short by a bad header can end inside a group
+    for (; samp < parseNumSamples; samp++)
+    {
+        const int auxNum = (samp + 3) % 4;
+        if (auxNum < 3)
+            latest[auxNum] = float(*(const uint16*)(parseBuffer + samp * parseFrameBytes + wordIndex) - 32768) * 0.0000374;
+        else
+            memcpy(held, latest, 3 * sizeof(float));
+        memcpy(blockSamples + samp * parseNumChannels + auxOffset, held, 3 * sizeof(float));
+    }
+}
+
+int RHD2000Thread::readUsbBlocks(unsigned char* buffer)
+{
     if (dacOutputShouldChange)
     {
         std::cout << "DAC" << std::endl;
@@ -1656,6 +1774,107 @@ bool RHD2000Thread::updateBuffer()
         dacOutputShouldChange = false;
     }
 
+    if (closedLoopSamples > 0)
+    {
+        // smallest possible transfer, for the lowest latency
+        if (evalBoard->numWordsInFifo() < Rhd2000DataBlock::calculateDataBlockSizeInWords(evalBoard->getNumEnabledDataStreams(), evalBoard->isUSB3(), closedLoopSamples))
+            return 0;
+
+        evalBoard->readDataBlocksRaw(1, buffer, closedLoopSamples);
+        return closedLoopSamples;
+    }
+
+    // Read everything that is already waiting, so a FIFO that fills up is drained with larger
+    // transfers, but never less than the latency setting asks for.
+    unsigned int wordsInFifo = evalBoard->numWordsInFifo();
+    int minBlocks = jmin(int(minBlocksPerRead), maxBlocksPerRead);
+    int numBlocks = jlimit(minBlocks, maxBlocksPerRead, int(wordsInFifo / blockSize));
+    if (wordsInFifo < numBlocks * blockSize)
+        return 0;
+
+    evalBoard->readDataBlocksRaw(numBlocks, buffer);
+    return numBlocks * Rhd2000DataBlock::getSamplesPerDataBlock(evalBoard->isUSB3());
+}
+
+bool RHD2000Thread::updateBuffer()
+{
+    unsigned char* bufferPtr;
+    int nSamps = usbThread->usbRead(bufferPtr);
+    if (nSamps <= 0)
+        return true;
+
+    const int numStreams = enabledStreams.size();
+    const int frameBytes = 2 * Rhd2000DataBlock::calculateDataBlockSizeInWords(numStreams, evalBoard->isUSB3(), 1);
+    // ADCs come after the header, timestamp, aux, neural and filler words
+    const int adcIndex = 12 + 6 * numStreams + 64 * numStreams + 2 * numStreams;
+    int samp;
+
+    // neighbouring ADC channels with the same input range are converted in one go,
+    // which is a single vector conversion of all 8 in the usual case
+    AdcRun adcRuns[8];
+    int numAdcRuns = 0;
+    if (acquireAdcChannels)
+    {
+        for (int adcChan = 0; adcChan < 8; ++adcChan)
+        {
+            const bool bipolar = adcRangeSettings[adcChan] == 0;
+            if (numAdcRuns > 0 && adcRuns[numAdcRuns - 1].bipolar == bipolar)
+            {
+                adcRuns[numAdcRuns - 1].count++;
+                continue;
+            }
+            AdcRun& run = adcRuns[numAdcRuns++];
+            run.first = adcChan;
+            run.count = 1;
+            run.bipolar = bipolar;
+            // ADC waveform units = volts
+            run.scale = bipolar ? 0.00015258789f : 0.00030517578f;
+            run.offset = bipolar ? (5.0f + 0.4096f) / 0.00015258789f : 0.0f; // account for +/-5V input range and DC offset
+        }
+    }
+
+    // headers, timestamps, ADCs and TTL words here, the streams next
+    for (samp = 0; samp < nSamps; samp++)
+    {
+        unsigned char* frame = bufferPtr + samp * frameBytes;
+        float* thisSample = blockSamples + samp * parseNumChannels;
+
+        if (!Rhd2000DataBlock::checkUsbHeader(frame, 0))
+        {
+            CoreServices::logMessage(RealtimeLog::LOG_ERROR, "Error in Rhd2000EvalBoard::readDataBlock: Incorrect header.");
+            break;
+        }
+
+        blockTimestamps[samp] = Rhd2000DataBlock::convertUsbTimeStamp(frame, 8);
+        // convert the 8 ADC channels
+        const uint16* adcWords = reinterpret_cast<const uint16*>(frame + adcIndex);
+        for (int r = 0; r < numAdcRuns; r++)
+        {
+            const AdcRun& run = adcRuns[r];
+            SampleConversion::convertUInt16ToFloat(thisSample + adcChannelOffset + run.first, adcWords + run.first, run.count, run.offset, run.scale);
+        }
+        blockEventCodes[samp] = adcWords[8]; // TTL inputs follow the ADC chans (8 * 2 bytes)
+    }
+
+    if (samp > 0)
+    {
+        parseBuffer = bufferPtr;
+        parseNumSamples = samp;
+        parseFrameBytes = frameBytes;
+
+        pendingParseWorkers = parseWorkers.size();
+        for (int i = 0; i < parseWorkers.size(); i++)
+            parseWorkers[i]->parse();
+        parseStreamGroup(0);
+        while (pendingParseWorkers > 0)
+            parseWorkersDone.wait(10);
+
+        sourceBuffers[0]->addInterleavedBlock(blockSamples, blockTimestamps, blockEventCodes, samp);
+
+        if (closedLoopSamples > 0)
+            notifyNewData();
+    }
+
     return true;
 
 }
@@ -1807,6 +2026,21 @@ void RHD2000Thread::runImpedanceTest(ImpedanceData* data)
     impedanceThread->startThread();
 }
 
+void RHD2000Thread::cancelImpedanceTest()
+{
+    impedanceThread->stopThreadSafely();
+}
+
+bool RHD2000Thread::isImpedanceTestRunning() const
+{
+    return impedanceThread->isThreadRunning();
+}
+
+float RHD2000Thread::getImpedanceTestProgress() const
+{
+    return impedanceThread->getProgress();
+}
+
 
 RHDHeadstage::RHDHeadstage(Rhd2000EvalBoard::BoardDataSource stream) :
     dataStream(stream), numStreams(0), channelsPerStream(32), halfChannels(false)
@@ -1868,12 +2102,11 @@ bool RHDHeadstage::isPlugged() const
 /***********************************/
 /* Below is code for impedance measurements */
 
-RHDImpedanceMeasure::RHDImpedanceMeasure(RHD2000Thread* b) : Thread(""), data(nullptr), board(b)
+RHDImpedanceMeasure::RHDImpedanceMeasure(RHD2000Thread* b) : Thread(""),
+    fitPool(jlimit(1, 8, SystemStats::getNumCpus() - 1)),
+    fitStart(0), fitLength(0), numRuns(0), numRunsFitted(0), lastReportedPercent(0),
+    data(nullptr), board(b)
 {
-    // to perform electrode impedance measurements at very low frequencies.
-    const int maxNumBlocks = 120;
-    int numStreams = 8;
-    allocateDoubleArray3D(amplifierPreFilter, numStreams, 32, MAX_SAMPLES_PER_DATA_BLOCK * maxNumBlocks);
 }
 
 RHDImpedanceMeasure::~RHDImpedanceMeasure()
@@ -1895,13 +2128,20 @@ void RHDImpedanceMeasure::stopThreadSafely()
 
 void RHDImpedanceMeasure::waitSafely()
 {
-    if (!waitForThreadToExit(120000)) //two minutes should be enough for completing a scan
+    // A sweep of a large array can take minutes, so only give up once it stops advancing
+    int lastRunsFitted = -1;
+    while (!waitForThreadToExit(10000))
     {
-        CoreServices::sendStatusMessage("Impedance measurement took too much. Aborting.");
-        if (!stopThread(3000)) //wait three seconds max for it to exit gracefully
+        if (numRunsFitted == lastRunsFitted)
         {
-            std::cerr << "ERROR: Impedance measurement thread did not exit. Force killed it. This might led to crashes." << std::endl;
+            CoreServices::sendStatusMessage("Impedance measurement took too much. Aborting.");
+            if (!stopThread(3000)) //wait three seconds max for it to exit gracefully
+            {
+                std::cerr << "ERROR: Impedance measurement thread did not exit. Force killed it. This might led to crashes." << std::endl;
+            }
+            return;
         }
+        lastRunsFitted = numRunsFitted;
     }
 }
 
@@ -1910,6 +2150,27 @@ void RHDImpedanceMeasure::prepareData(ImpedanceData* d)
     data = d;
 }
 
+float RHDImpedanceMeasure::getProgress() const
+{
+    return numRuns > 0 ? float(numRunsFitted) / numRuns : 0.0f;
+}
+
+void RHDImpedanceMeasure::reportProgress()
+{
+    const int percent = numRuns > 0 ? 100 * numRunsFitted / numRuns : 0;
+    if (percent / 10 > lastReportedPercent / 10)
+    {
+        lastReportedPercent = percent;
+        CoreServices::sendStatusMessage("Measuring impedance: " + String(percent) + "%");
+    }
+}
+
+void RHDImpedanceMeasure::waitForFits()
+{
+    while (fitPool.getNumJobs() > 0 && !threadShouldExit())
+        wait(5);
+}
+
 
 // Update electrode impedance measurement frequency, after checking that
 // requested test frequency lies within acceptable ranges based on the
@@ -1957,111 +2218,95 @@ float RHDImpedanceMeasure::updateImpedanceFrequency(float desiredImpedanceFreq,
 }
 
 
-// Reads numBlocks blocks of raw USB data stored in a queue of Rhd2000DataBlock
-// objects, loads this data into this SignalProcessor object, scaling the raw
-// data to generate waveforms with units of volts or microvolts.
-int RHDImpedanceMeasure::loadAmplifierData(queue<Rhd2000DataBlock>& dataQueue,
-    int numBlocks, int numDataStreams)
-{
-
-    int block, t, channel, stream;
-    int indexAmp = 0;
-    /*
-    int indexAux = 0;
-    int indexSupply = 0;
-    int indexAdc = 0;
-    int indexDig = 0;
-    int numWordsWritten = 0;
-
-    int bufferIndex;
-    int16 tempQint16;
-    uint16 tempQuint16;
-    int32 tempQint32;
-
-    bool triggerFound = false;
-    const double AnalogTriggerThreshold = 1.65;
-     */
+#define PI  3.14159265359
+#define TWO_PI  6.28318530718
+#define DEGREES_TO_RADIANS  0.0174532925199
+#define RADIANS_TO_DEGREES  57.2957795132
 
+// Measures the magnitude and phase (in degrees) of the test frequency component on one
+// chip channel of several streams, from a window copied out of the blocks of one run.
+class RHDImpedanceMeasure::FitJob : public ThreadPoolJob
+{
+public:
+    FitJob(RHDImpedanceMeasure& owner, int capIndex, int chipChannel, const Array<int>& streams)
+        : ThreadPoolJob("Impedance fit"), owner(owner), capIndex(capIndex), chipChannel(chipChannel), streams(streams)
+    {
+        samples.malloc(jmax(1, streams.size() * owner.fitLength));
+    }
 
-    for (block = 0; block < numBlocks; ++block)
+    double* getSamples(int streamSlot)
     {
+        return samples + streamSlot * owner.fitLength;
+    }
 
-        // Load and scale RHD2000 amplifier waveforms
-        // (sampled at amplifier sampling rate)
-        for (t = 0; t < SAMPLES_PER_DATA_BLOCK(board->evalBoard->isUSB3()); ++t)
+    JobStatus runJob() override
+    {
+        for (int i = 0; i < streams.size() && !shouldExit(); ++i)
         {
-            for (channel = 0; channel < 32; ++channel)
-            {
-                for (stream = 0; stream < numDataStreams; ++stream)
-                {
-                    // Amplifier waveform units = microvolts
-                    amplifierPreFilter[stream][channel][indexAmp] = 0.195 *
-                        (dataQueue.front().amplifierData[stream][channel][t] - 32768);
-                }
-            }
-            ++indexAmp;
+            const int stream = streams[i];
+            double iComponent, qComponent;
+
+            // Measure real (iComponent) and imaginary (qComponent) amplitude of frequency component.
+            owner.amplitudeOfFreqComponent(iComponent, qComponent, getSamples(i));
+            // Calculate magnitude and phase from real (I) and imaginary (Q) components.
+            owner.measuredMagnitude[stream][chipChannel][capIndex] =
+                sqrt(iComponent * iComponent + qComponent * qComponent);
+            owner.measuredPhase[stream][chipChannel][capIndex] =
+                RADIANS_TO_DEGREES *atan2(qComponent, iComponent);
         }
-        // We are done with this Rhd2000DataBlock object; remove it from dataQueue
-        dataQueue.pop();
+        ++owner.numRunsFitted;
+        return jobHasFinished;
     }
 
-    return 0;
-}
+private:
+    RHDImpedanceMeasure& owner;
+    const int capIndex;
+    const int chipChannel;
+    const Array<int> streams;
+    HeapBlock<double> samples;
+};
 
-#define PI  3.14159265359
-#define TWO_PI  6.28318530718
-#define DEGREES_TO_RADIANS  0.0174532925199
-#define RADIANS_TO_DEGREES  57.2957795132
-
-// Return the magnitude and phase (in degrees) of a selected frequency component (in Hz)
-// for a selected amplifier channel on the selected USB data stream.
-void RHDImpedanceMeasure::measureComplexAmplitude(std::vector<std::vector<std::vector<double>>>& measuredMagnitude,
-    std::vector<std::vector<std::vector<double>>>& measuredPhase,
-    int capIndex, int stream, int chipChannel, int numBlocks,
-    double sampleRate, double frequency, int numPeriods)
+void RHDImpedanceMeasure::queueFit(queue<Rhd2000DataBlock>& dataQueue, int numBlocks, int capIndex, int chipChannel, const Array<int>& streams)
 {
-    int period = (sampleRate / frequency);
-    int startIndex = 0;
-    int endIndex = startIndex + numPeriods * period - 1;
+    const int samplesPerBlock = SAMPLES_PER_DATA_BLOCK(board->evalBoard->isUSB3());
+    FitJob* job = new FitJob(*this, capIndex, chipChannel, streams);
 
-    // Move the measurement window to the end of the waveform to ignore start-up transient.
-    while (endIndex < SAMPLES_PER_DATA_BLOCK(board->evalBoard->isUSB3()) * numBlocks - period)
+    for (int block = 0; block < numBlocks; ++block)
     {
-        startIndex += period;
-        endIndex += period;
+        Rhd2000DataBlock& dataBlock = dataQueue.front();
+        for (int t = 0; t < samplesPerBlock; ++t)
+        {
+            const int index = block * samplesPerBlock + t - fitStart;
+            if (index < 0 || index >= fitLength)
+                continue;
+            for (int i = 0; i < streams.size(); ++i)
+            {
+                // Amplifier waveform units = microvolts
+                job->getSamples(i)[index] = 0.195 * (dataBlock.amplifier(streams[i], chipChannel, t) - 32768);
+            }
+        }
+        // We are done with this Rhd2000DataBlock object; the board reuses it for the next read
+        board->evalBoard->recycleDataBlock(std::move(dataBlock));
+        dataQueue.pop();
     }
 
-    double iComponent, qComponent;
-
-    // Measure real (iComponent) and imaginary (qComponent) amplitude of frequency component.
-    amplitudeOfFreqComponent(iComponent, qComponent, amplifierPreFilter[stream][chipChannel],
-        startIndex, endIndex, sampleRate, frequency);
-    // Calculate magnitude and phase from real (I) and imaginary (Q) components.
-    measuredMagnitude[stream][chipChannel][capIndex] =
-        sqrt(iComponent * iComponent + qComponent * qComponent);
-    measuredPhase[stream][chipChannel][capIndex] =
-        RADIANS_TO_DEGREES *atan2(qComponent, iComponent);
+    fitPool.addJob(job, true);
 }
 
-// Returns the real and imaginary amplitudes of a selected frequency component in the vector
-// data, between a start index and end index.
+// Returns the real and imaginary amplitudes of the test frequency component in a
+// measurement window, by correlation with the precomputed sine and cosine waveforms.
 void RHDImpedanceMeasure::amplitudeOfFreqComponent(double& realComponent, double& imagComponent,
-    const std::vector<double>& data, int startIndex,
-    int endIndex, double sampleRate, double frequency)
+    const double* data) const
 {
-    int length = endIndex - startIndex + 1;
-    const double k = TWO_PI * frequency / sampleRate;  // precalculate for speed
-
-    // Perform correlation with sine and cosine waveforms.
     double meanI = 0.0;
     double meanQ = 0.0;
-    for (int t = startIndex; t <= endIndex; ++t)
+    for (int t = 0; t < fitLength; ++t)
     {
-        meanI += data.at(t) * cos(k * t);
-        meanQ += data.at(t) * -1.0 * sin(k * t);
+        meanI += data[t] * cosTable[t];
+        meanQ += data[t] * -1.0 * sinTable[t];
     }
-    meanI /= (double)length;
-    meanQ /= (double)length;
+    meanI /= (double)fitLength;
+    meanQ /= (double)fitLength;
 
     realComponent = 2.0 * meanI;
     imagComponent = 2.0 * meanQ;
@@ -2119,7 +2364,11 @@ void RHDImpedanceMeasure::run()
     if (data == nullptr)
         return;
     runImpedanceMeasurement();
+    // drop fits still pending after a cancelled sweep
+    fitPool.removeAllJobs(true, 5000);
     restoreFPGA();
+    if (threadShouldExit())
+        CoreServices::sendStatusMessage("Impedance measurement cancelled.");
     ed->triggerAsyncUpdate();
     data = nullptr;
 }
@@ -2186,6 +2435,26 @@ void RHDImpedanceMeasure::runImpedanceMeasurement()
     int numBlocks = ceil((numPeriods + 2.0) * period / 60.0);  // + 2 periods to give time to settle initially
     if (numBlocks < 2) numBlocks = 2;   // need first block for command to switch channels to take effect.
 
+    // Move the measurement window to the end of the waveform to ignore start-up transient.
+    const int periodSamples = (board->boardSampleRate / actualImpedanceFreq);
+    fitStart = 0;
+    int endIndex = numPeriods * periodSamples - 1;
+    while (endIndex < SAMPLES_PER_DATA_BLOCK(board->evalBoard->isUSB3()) * numBlocks - periodSamples)
+    {
+        fitStart += periodSamples;
+        endIndex += periodSamples;
+    }
+    fitLength = endIndex - fitStart + 1;
+
+    const double k = TWO_PI * actualImpedanceFreq / board->boardSampleRate;
+    cosTable.malloc(fitLength);
+    sinTable.malloc(fitLength);
+    for (int t = 0; t < fitLength; ++t)
+    {
+        cosTable[t] = cos(k * (fitStart + t));
+        sinTable[t] = sin(k * (fitStart + t));
+    }
+
     CHECK_EXIT;
     board->actualDspCutoffFreq = board->chipRegisters.setDspCutoffFreq(board->desiredDspCutoffFreq);
     board->actualLowerBandwidth = board->chipRegisters.setLowerBandwidth(board->desiredLowerBandwidth);
@@ -2208,22 +2477,24 @@ void RHDImpedanceMeasure::runImpedanceMeasurement()
 
     // Create matrices of doubles of size (numStreams x 32 x 3) to store complex amplitudes
     // of all amplifier channels (32 on each data stream) at three different Cseries values.
-    std::vector<std::vector<std::vector<double>>>  measuredMagnitude;
-    std::vector<std::vector<std::vector<double>>>  measuredPhase;
+    allocateDoubleArray3D(measuredMagnitude, numdataStreams, 32, 3);
+    allocateDoubleArray3D(measuredPhase, numdataStreams, 32, 3);
 
-    measuredMagnitude.resize(board->evalBoard->getNumEnabledDataStreams());
-    measuredPhase.resize(board->evalBoard->getNumEnabledDataStreams());
-    for (int i = 0; i < board->evalBoard->getNumEnabledDataStreams(); ++i)
+    // The second half of an RHD2164 is measured with the Zcheck select register set to channels 32-63
+    Array<int> firstHalfStreams, secondHalfStreams;
+    for (stream = 0; stream < numdataStreams; ++stream)
     {
-        measuredMagnitude[i].resize(32);
-        measuredPhase[i].resize(32);
-        for (int j = 0; j < 32; ++j)
-        {
-            measuredMagnitude[i][j].resize(3);
-            measuredPhase[i][j].resize(3);
-        }
+        if (board->chipId[stream] == CHIP_ID_RHD2164_B)
+            secondHalfStreams.add(stream);
+        else
+            firstHalfStreams.add(stream);
     }
 
+    numRuns = 3 * 32 * (rhd2164ChipPresent ? 2 : 1);
+    numRunsFitted = 0;
+    lastReportedPercent = 0;
+    CoreServices::sendStatusMessage("Measuring impedance. Press Measure Impedance again to cancel.");
+
 
 
     double distance, minDistance, current, Cseries;
@@ -2282,16 +2553,8 @@ void RHDImpedanceMeasure::runImpedanceMeasurement()
             }
             queue<Rhd2000DataBlock> dataQueue;
             board->evalBoard->readDataBlocks(numBlocks, dataQueue);
-            loadAmplifierData(dataQueue, numBlocks, numdataStreams);
-            for (stream = 0; stream < numdataStreams; ++stream)
-            {
-                if (board->chipId[stream] != CHIP_ID_RHD2164_B)
-                {
-                    measureComplexAmplitude(measuredMagnitude, measuredPhase,
-                        capRange, stream, channel, numBlocks, board->boardSampleRate,
-                        actualImpedanceFreq, numPeriods);
-                }
-            }
+            queueFit(dataQueue, numBlocks, capRange, channel, firstHalfStreams);
+            reportProgress();
 
             // If an RHD2164 chip is plugged in, we have to set the Zcheck select register to channels 32-63
             // and repeat the previous steps.
@@ -2310,21 +2573,15 @@ void RHDImpedanceMeasure::runImpedanceMeasurement()
 
                 }
                 board->evalBoard->readDataBlocks(numBlocks, dataQueue);
-                loadAmplifierData(dataQueue, numBlocks, numdataStreams);
-
-                for (stream = 0; stream < board->evalBoard->getNumEnabledDataStreams(); ++stream)
-                {
-                    if (board->chipId[stream] == CHIP_ID_RHD2164_B)
-                    {
-                        measureComplexAmplitude(measuredMagnitude, measuredPhase,
-                            capRange, stream, channel, numBlocks, board->boardSampleRate,
-                            actualImpedanceFreq, numPeriods);
-                    }
-                }
+                queueFit(dataQueue, numBlocks, capRange, channel, secondHalfStreams);
+                reportProgress();
             }
         }
     }
 
+    waitForFits();
+    CHECK_EXIT;
+
     data->streams.clear();
     data->channels.clear();
     data->magnitudes.clear();
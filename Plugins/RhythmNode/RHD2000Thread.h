@@ -42,11 +42,19 @@
 
 #define MAX_NUM_CHANNELS MAX_NUM_DATA_STREAMS_USB3*35
 
+// Largest number of USB data blocks read in a single transfer
+#define MAX_BLOCKS_PER_READ 8
+
+// Samples per read in closed-loop mode on USB2, a multiple of the 4 sample aux command
+// cycle. USB3 block pipes can only transfer whole data blocks.
+#define CLOSED_LOOP_SAMPLES 4
+
 namespace RhythmNode
 {
 
 	class RHDHeadstage;
 	class RHDImpedanceMeasure;
+	class USBThread;
 
 	struct ImpedanceData
 	{
@@ -66,6 +74,7 @@ namespace RhythmNode
 		, public Timer
 	{
 		friend class RHDImpedanceMeasure;
+		friend class USBThread;
 
 	public:
 		RHD2000Thread(SourceNode* sn);
@@ -130,6 +139,9 @@ namespace RhythmNode
 
 		String getChannelUnits(int chanIndex) const override;
 
+		/** The amplifier's lower bandwidth, or the DSP offset removal cutoff if that is enabled and higher */
+		float getHardwareHighPass(int chanIndex) const override;
+
 		int getHeadstageChannels(int hsNum) const;
 		int getActiveChannelsInHeadstage(int hsNum) const;
 
@@ -138,13 +150,33 @@ namespace RhythmNode
 		/*Gets the headstage relative channel index from the absolute channel index*/
 		int getHeadstageChannel(int& hs, int ch) const;
 
+		/** Starts measuring impedances in the background. The editor is notified when done. */
 		void runImpedanceTest(ImpedanceData* data);
+		void cancelImpedanceTest();
+		bool isImpedanceTestRunning() const;
+		/** Fraction of the running impedance test that has completed, from 0 to 1 */
+		float getImpedanceTestProgress() const;
 		void enableBoardLeds(bool enable);
 		int setClockDivider(int divide_ratio);
 
 		void setAdcRange(int adcChannel, short rangeType);
 		short getAdcRange(int adcChannel) const;
 
+		/** Sets how long data can wait in the FIFO so that several blocks are read in one
+		transfer, in ms. With 0 every block is read as soon as it is complete, which suits
+		closed-loop work; larger values cut the USB overhead at high channel counts. In all
+		cases a read takes everything already waiting, up to MAX_BLOCKS_PER_READ blocks,
+		so a FIFO that starts to fill up is drained with larger transfers. */
+		void setReadLatency(float ms);
+		float getReadLatency() const;
+
+		/** In closed-loop mode every read takes the smallest amount of data the board can
+		transfer (CLOSED_LOOP_SAMPLES samples on USB2, one data block on USB3) and the graph
+		processes each read as soon as it is in the DataBuffer, instead of at the next audio
+		buffer. Costs much more CPU and USB overhead. Takes effect when acquisition starts. */
+		void setClosedLoopMode(bool enabled);
+		bool getClosedLoopMode() const;
+
 		GenericEditor* createEditor(SourceNode* sn);
 
 		static DataThread* createDataThread(SourceNode* sn);
@@ -171,13 +203,63 @@ namespace RhythmNode
 		int numChannels;
 		bool deviceFound;
 
-		float thisSample[MAX_NUM_CHANNELS];
+		// interleaved samples, timestamps and TTL words of a whole USB block, pushed to the DataBuffer at once
+		HeapBlock<float> blockSamples;
+		HeapBlock<int64> blockTimestamps;
+		HeapBlock<uint64> blockEventCodes;
 		// aux inputs are only sampled every 4th sample, so use this to buffer the samples so they can be handles just like the regular neural channels later
 		float auxBuffer[MAX_NUM_CHANNELS];
 		float auxSamples[MAX_NUM_DATA_STREAMS_USB3][3];
 
 		unsigned int blockSize;
 
+		void updateBlocksPerRead();
+		float readLatencyMs;
+		// smallest read, from the latency setting, and largest read the USB buffer allows
+		std::atomic<int> minBlocksPerRead;
+		int maxBlocksPerRead;
+		bool closedLoopMode;
+		// samples per read while acquiring in closed-loop mode, 0 otherwise
+		int closedLoopSamples;
+
+		/** Called from the USB thread: applies pending board settings, then reads as many blocks
+		as the FIFO and the latency setting allow into buffer. Returns the number of samples read. */
+		int readUsbBlocks(unsigned char* buffer);
+		ScopedPointer<USBThread> usbThread;
+
+		// The neural and aux channels of each data stream are parsed independently, so the streams
+		// are split in groups, the first parsed by the data thread and the others by ParseWorkers
+		class ParseWorker;
+		void startParseWorkers();
+		void stopParseWorkers();
+		void parseStreamGroup(int group);
+		void parseAuxChannels(int dataStream, int wordIndex, int auxOffset);
+
+		/** ADC channels converted together because they share an input range */
+		struct AdcRun
+		{
+			int first;
+			int count;
+			bool bipolar;
+			float offset;
+			float scale;
+		};
+
+		OwnedArray<ParseWorker> parseWorkers;
+		Array<int> groupFirstStream;
+		std::atomic<int> pendingParseWorkers;
+		WaitableEvent parseWorkersDone;
+		// layout of the interleaved block: output channel of the first neural and aux channel of each
+		// stream (-1 for no aux channels) and of the first ADC channel
+		int streamNeuralOffset[MAX_NUM_DATA_STREAMS_USB3];
+		int streamAuxOffset[MAX_NUM_DATA_STREAMS_USB3];
+		int adcChannelOffset;
+		// the transfer being parsed
+		unsigned char* parseBuffer;
+		int parseNumSamples;
+		int parseFrameBytes;
+		int parseNumChannels;
+
 		bool isTransmitting;
 
 		bool dacOutputShouldChange;
@@ -281,19 +363,24 @@ namespace RhythmNode
 		void stopThreadSafely();
 		void waitSafely();
 
+		/** Fraction of the sweep that has been recorded and fitted, from 0 to 1 */
+		float getProgress() const;
+
 
 	private:
+		class FitJob;
+
 		void runImpedanceMeasurement();
 		void restoreFPGA();
 
-		void measureComplexAmplitude(std::vector<std::vector<std::vector<double>>>& measuredMagnitude,
-			std::vector<std::vector<std::vector<double>>>& measuredPhase,
-			int capIndex, int stream, int chipChannel, int numBlocks,
-			double sampleRate, double frequency, int numPeriods);
+		/** Copies the measurement window of one chip channel on the given streams out of
+		the blocks just read, and fits it on the worker pool while the board records the next one */
+		void queueFit(queue<Rhd2000DataBlock>& dataQueue, int numBlocks, int capIndex, int chipChannel, const Array<int>& streams);
+		void waitForFits();
+		void reportProgress();
 
 		void amplitudeOfFreqComponent(double& realComponent, double& imagComponent,
-			const std::vector<double>& data, int startIndex,
-			int endIndex, double sampleRate, double frequency);
+			const double* data) const;
 
 		void factorOutParallelCapacitance(double& impedanceMagnitude, double& impedancePhase,
 			double frequency, double parasiticCapacitance);
@@ -302,10 +389,23 @@ namespace RhythmNode
 			double boardSampleRate);
 
 		float updateImpedanceFrequency(float desiredImpedanceFreq, bool& impedanceFreqValid);
-		int loadAmplifierData(queue<Rhd2000DataBlock>& dataQueue,
-			int numBlocks, int numDataStreams);
 
-		std::vector<std::vector<std::vector<double>>> amplifierPreFilter;
+		ThreadPool fitPool;
+
+		// Complex amplitudes of the 32 channels of every stream at the three Cseries values,
+		// each element written by a single FitJob
+		std::vector<std::vector<std::vector<double>>> measuredMagnitude;
+		std::vector<std::vector<std::vector<double>>> measuredPhase;
+
+		// Every fit uses the same window, so the reference waveforms are computed once
+		int fitStart;
+		int fitLength;
+		HeapBlock<double> cosTable;
+		HeapBlock<double> sinTable;
+
+		int numRuns;
+		std::atomic<int> numRunsFitted;
+		int lastReportedPercent;
 
 		ImpedanceData* data;
 		RHD2000Thread* board;
@@ -0,0 +1,121 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2016 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "USBThread.h"
+#include "RHD2000Thread.h"
+
+using namespace RhythmNode;
+
+USBThread::USBThread(RHD2000Thread* owner, int numBuffers)
+	: Thread("Rhythm USB"), m_owner(owner), m_numBuffers(jmax(numBuffers, 2))
+{
+}
+
+USBThread::~USBThread()
+{
+	stopAcquisition();
+}
+
+void USBThread::startAcquisition(int bufferBytes)
+{
+	m_bufferSize = bufferBytes;
+	m_buffers.malloc(size_t(m_numBuffers) * bufferBytes);
+	m_numSamples.calloc(m_numBuffers);
+	m_writeIndex = 0;
+	m_readIndex = 0;
+	m_holding = false;
+	m_dataReady.reset();
+	m_numRingFull = 0;
+	startThread();
+}
+
+void USBThread::stopAcquisition()
+{
+	if (isThreadRunning())
+	{
+		signalThreadShouldExit();
+		notify();
+		if (!stopThread(1000))
+		{
+			std::cerr << "Rhythm USB thread could not stop cleanly. Force quitting it" << std::endl;
+		}
+		std::cout << "Rhythm USB thread stopped, ring was full " << m_numRingFull << " times" << std::endl;
+	}
+}
+
+int USBThread::usbRead(unsigned char*& buffer)
+{
+	int64 readIndex = m_readIndex.load(std::memory_order_relaxed);
+	if (m_holding)
+	{
+		//Give the previous buffer back to the USB thread
+		m_readIndex.store(++readIndex, std::memory_order_release);
+		m_holding = false;
+		notify();
+	}
+
+	if (m_writeIndex.load(std::memory_order_acquire) == readIndex)
+	{
+		m_dataReady.wait(5);
+		if (m_writeIndex.load(std::memory_order_acquire) == readIndex)
+			return 0;
+	}
+
+	int slot = int(readIndex % m_numBuffers);
+	buffer = m_buffers + size_t(slot) * m_bufferSize;
+	m_holding = true;
+	return m_numSamples[slot];
+}
+
+int64 USBThread::getNumRingFull() const
+{
+	return m_numRingFull.load();
+}
+
+void USBThread::run()
+{
+	ThreadPolicy::applyToCurrentThread(ThreadPolicy::Acquisition);
+	bool wasFull = false;
+	while (!threadShouldExit())
+	{
+		int64 writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+		if (writeIndex - m_readIndex.load(std::memory_order_acquire) >= m_numBuffers)
+		{
+			//The data thread is behind, count each time it happens, not each time we check
+			if (!wasFull)
+				m_numRingFull++;
+			wasFull = true;
+			wait(100);
+			continue;
+		}
+		wasFull = false;
+
+		int slot = int(writeIndex % m_numBuffers);
+		int numSamples = m_owner->readUsbBlocks(m_buffers + size_t(slot) * m_bufferSize);
+		if (numSamples <= 0)
+			continue; //not enough data in the FIFO yet
+
+		m_numSamples[slot] = numSamples;
+		m_writeIndex.store(writeIndex + 1, std::memory_order_release);
+		m_dataReady.signal();
+	}
+}
@@ -0,0 +1,79 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2016 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RHYTHMNODE_USBTHREAD_H_INCLUDED
+#define RHYTHMNODE_USBTHREAD_H_INCLUDED
+
+#include <BasicJuceHeader.h>
+#include <atomic>
+
+namespace RhythmNode
+{
+	class RHD2000Thread;
+
+	/**
+		Reads raw data from the board into a ring of buffers allocated when acquisition
+		starts, so that USB transfers keep going while the data thread parses what was
+		already read. All other accesses to the board during acquisition go through this
+		thread too, since the board interface is not thread safe.
+
+		@see RHD2000Thread
+	*/
+	class USBThread : public Thread
+	{
+	public:
+		USBThread(RHD2000Thread* owner, int numBuffers);
+		~USBThread();
+
+		void run() override;
+
+		void startAcquisition(int bufferBytes);
+		void stopAcquisition();
+
+		/** Gets the oldest transfer not yet parsed, waiting a few milliseconds if there is none.
+		The buffer stays valid until the next call, which releases it. Returns the number of
+		samples in the buffer, or 0 if nothing is ready. Only the data thread can call this. */
+		int usbRead(unsigned char*& buffer);
+
+		/** Number of times the ring was full and reads had to wait for the data thread */
+		int64 getNumRingFull() const;
+
+	private:
+		RHD2000Thread* const m_owner;
+		const int m_numBuffers;
+		int m_bufferSize{ 0 };
+		HeapBlock<unsigned char> m_buffers;
+		HeapBlock<int> m_numSamples;
+
+		// Both only increase, the slot of an index is index % m_numBuffers
+		std::atomic<int64> m_writeIndex{ 0 };
+		std::atomic<int64> m_readIndex{ 0 };
+		bool m_holding{ false };
+		WaitableEvent m_dataReady;
+
+		std::atomic<int64> m_numRingFull{ 0 };
+
+		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(USBThread);
+	};
+}
+
+#endif  // RHYTHMNODE_USBTHREAD_H_INCLUDED
@@ -31,51 +31,23 @@ using namespace std;
 // from a Rhythm FPGA interface controlling up to eight RHD2000 chips.
 
 // Constructor.  Allocates memory for data block.
-Rhd2000DataBlock::Rhd2000DataBlock(int numDataStreams, bool usb3) : samplesPerBlock(SAMPLES_PER_DATA_BLOCK(usb3)), usb3(usb3)
+Rhd2000DataBlock::Rhd2000DataBlock(int numDataStreams, bool usb3) : samplesPerBlock(SAMPLES_PER_DATA_BLOCK(usb3)), usb3(usb3), numDataStreams(0)
 {
-    allocateUIntArray1D(timeStamp, samplesPerBlock);
-    allocateIntArray3D(amplifierData, numDataStreams, 32, samplesPerBlock);
-    allocateIntArray3D(auxiliaryData, numDataStreams, 3, samplesPerBlock);
-    allocateIntArray2D(boardAdcData, 8, samplesPerBlock);
-    allocateIntArray1D(ttlIn, samplesPerBlock);
-    allocateIntArray1D(ttlOut, samplesPerBlock);
-}
-
-// Allocates memory for a 1-D array of integers.
-void Rhd2000DataBlock::allocateIntArray1D(vector<int> &array1D, int xSize)
-{
-    array1D.resize(xSize);
-}
-
-// Allocates memory for a 1-D array of unsigned integers.
-void Rhd2000DataBlock::allocateUIntArray1D(vector<unsigned int> &array1D, int xSize)
-{
-    array1D.resize(xSize);
-}
+    timeStamp.resize(samplesPerBlock);
+    boardAdcData.resize(8 * samplesPerBlock);
+    ttlIn.resize(samplesPerBlock);
+    ttlOut.resize(samplesPerBlock);
 
-// Allocates memory for a 2-D array of integers.
-void Rhd2000DataBlock::allocateIntArray2D(vector<vector<int> > & array2D, int xSize, int ySize)
-{
-    int i;
-
-    array2D.resize(xSize);
-    for (i = 0; i < xSize; ++i)
-        array2D[i].resize(ySize);
+    reset(numDataStreams);
 }
 
-// Allocates memory for a 3-D array of integers.
-void Rhd2000DataBlock::allocateIntArray3D(vector<vector<vector<int> > > &array3D, int xSize, int ySize, int zSize)
+// Sizes the per-stream data for numDataStreams streams.  Shrinking keeps the capacity, so a
+// block reused for fewer streams and back does not allocate again.
+void Rhd2000DataBlock::reset(int numStreams)
 {
-    int i, j;
-
-    array3D.resize(xSize);
-    for (i = 0; i < xSize; ++i) {
-        array3D[i].resize(ySize);
-
-        for (j = 0; j < ySize; ++j) {
-            array3D[i][j].resize(zSize);
-        }
-    }
+    numDataStreams = numStreams;
+    amplifierData.resize(numStreams * 32 * samplesPerBlock);
+    auxiliaryData.resize(numStreams * 3 * samplesPerBlock);
 }
 
 // Returns the number of samples in a USB data block.
@@ -144,6 +116,9 @@ void Rhd2000DataBlock::fillFromUsbBuffer(unsigned char usbBuffer[], int blockInd
     int samplesToRead = nSamples <= 0 ? samplesPerBlock : nSamples;
     int num = 0;
 
+    if (numDataStreams > this->numDataStreams)
+        reset(numDataStreams);
+
     index = blockIndex * 2 * calculateDataBlockSizeInWords(numDataStreams, usb3);
     for (t = 0; t < samplesToRead; ++t) {
         if (!checkUsbHeader(usbBuffer, index)) {
@@ -160,7 +135,7 @@ void Rhd2000DataBlock::fillFromUsbBuffer(unsigned char usbBuffer[], int blockInd
         // Read auxiliary results
         for (channel = 0; channel < 3; ++channel) {
             for (stream = 0; stream < numDataStreams; ++stream) {
-                auxiliaryData[stream][channel][t] = convertUsbWord(usbBuffer, index);
+                auxiliary(stream, channel, t) = convertUsbWord(usbBuffer, index);
                 index += 2;
             }
         }
@@ -168,7 +143,7 @@ void Rhd2000DataBlock::fillFromUsbBuffer(unsigned char usbBuffer[], int blockInd
         // Read amplifier channels
         for (channel = 0; channel < 32; ++channel) {
             for (stream = 0; stream < numDataStreams; ++stream) {
-                amplifierData[stream][channel][t] = convertUsbWord(usbBuffer, index);
+                amplifier(stream, channel, t) = convertUsbWord(usbBuffer, index);
                 index += 2;
             }
         }
@@ -178,7 +153,7 @@ void Rhd2000DataBlock::fillFromUsbBuffer(unsigned char usbBuffer[], int blockInd
 
         // Read from AD5662 ADCs
         for (i = 0; i < 8; ++i) {
-            boardAdcData[i][t] = convertUsbWord(usbBuffer, index);
+            boardAdc(i, t) = convertUsbWord(usbBuffer, index);
             index += 2;
         }
 
@@ -202,24 +177,24 @@ void Rhd2000DataBlock::print(int stream) const
     cout << "RHD 2000 Data Block contents:" << endl;
     cout << "  ROM contents:" << endl;
     cout << "    Chip Name: " <<
-           (char) auxiliaryData[stream][2][24] <<
-           (char) auxiliaryData[stream][2][25] <<
-           (char) auxiliaryData[stream][2][26] <<
-           (char) auxiliaryData[stream][2][27] <<
-           (char) auxiliaryData[stream][2][28] <<
-           (char) auxiliaryData[stream][2][29] <<
-           (char) auxiliaryData[stream][2][30] <<
-           (char) auxiliaryData[stream][2][31] << endl;
+           (char) auxiliary(stream, 2, 24) <<
+           (char) auxiliary(stream, 2, 25) <<
+           (char) auxiliary(stream, 2, 26) <<
+           (char) auxiliary(stream, 2, 27) <<
+           (char) auxiliary(stream, 2, 28) <<
+           (char) auxiliary(stream, 2, 29) <<
+           (char) auxiliary(stream, 2, 30) <<
+           (char) auxiliary(stream, 2, 31) << endl;
     cout << "    Company Name:" <<
-           (char) auxiliaryData[stream][2][32] <<
-           (char) auxiliaryData[stream][2][33] <<
-           (char) auxiliaryData[stream][2][34] <<
-           (char) auxiliaryData[stream][2][35] <<
-           (char) auxiliaryData[stream][2][36] << endl;
-    cout << "    Intan Chip ID: " << auxiliaryData[stream][2][19] << endl;
-    cout << "    Number of Amps: " << auxiliaryData[stream][2][20] << endl;
+           (char) auxiliary(stream, 2, 32) <<
+           (char) auxiliary(stream, 2, 33) <<
+           (char) auxiliary(stream, 2, 34) <<
+           (char) auxiliary(stream, 2, 35) <<
+           (char) auxiliary(stream, 2, 36) << endl;
+    cout << "    Intan Chip ID: " << auxiliary(stream, 2, 19) << endl;
+    cout << "    Number of Amps: " << auxiliary(stream, 2, 20) << endl;
     cout << "    Unipolar/Bipolar Amps: ";
-    switch (auxiliaryData[stream][2][21]) {
+    switch (auxiliary(stream, 2, 21)) {
         case 0:
             cout << "bipolar";
             break;
@@ -230,51 +205,51 @@ void Rhd2000DataBlock::print(int stream) const
             cout << "UNKNOWN";
     }
     cout << endl;
-    cout << "    Die Revision: " << auxiliaryData[stream][2][22] << endl;
-    cout << "    Future Expansion Register: " << auxiliaryData[stream][2][23] << endl;
+    cout << "    Die Revision: " << auxiliary(stream, 2, 22) << endl;
+    cout << "    Future Expansion Register: " << auxiliary(stream, 2, 23) << endl;
 
     cout << "  RAM contents:" << endl;
-    cout << "    ADC reference BW:      " << ((auxiliaryData[stream][2][RamOffset + 0] & 0xc0) >> 6) << endl;
-    cout << "    amp fast settle:       " << ((auxiliaryData[stream][2][RamOffset + 0] & 0x20) >> 5) << endl;
-    cout << "    amp Vref enable:       " << ((auxiliaryData[stream][2][RamOffset + 0] & 0x10) >> 4) << endl;
-    cout << "    ADC comparator bias:   " << ((auxiliaryData[stream][2][RamOffset + 0] & 0x0c) >> 2) << endl;
-    cout << "    ADC comparator select: " << ((auxiliaryData[stream][2][RamOffset + 0] & 0x03) >> 0) << endl;
-    cout << "    VDD sense enable:      " << ((auxiliaryData[stream][2][RamOffset + 1] & 0x40) >> 6) << endl;
-    cout << "    ADC buffer bias:       " << ((auxiliaryData[stream][2][RamOffset + 1] & 0x3f) >> 0) << endl;
-    cout << "    MUX bias:              " << ((auxiliaryData[stream][2][RamOffset + 2] & 0x3f) >> 0) << endl;
-    cout << "    MUX load:              " << ((auxiliaryData[stream][2][RamOffset + 3] & 0xe0) >> 5) << endl;
-    cout << "    tempS2, tempS1:        " << ((auxiliaryData[stream][2][RamOffset + 3] & 0x10) >> 4) << "," <<
-           ((auxiliaryData[stream][2][RamOffset + 3] & 0x08) >> 3) << endl;
-    cout << "    tempen:                " << ((auxiliaryData[stream][2][RamOffset + 3] & 0x04) >> 2) << endl;
-    cout << "    digout HiZ:            " << ((auxiliaryData[stream][2][RamOffset + 3] & 0x02) >> 1) << endl;
-    cout << "    digout:                " << ((auxiliaryData[stream][2][RamOffset + 3] & 0x01) >> 0) << endl;
-    cout << "    weak MISO:             " << ((auxiliaryData[stream][2][RamOffset + 4] & 0x80) >> 7) << endl;
-    cout << "    twoscomp:              " << ((auxiliaryData[stream][2][RamOffset + 4] & 0x40) >> 6) << endl;
-    cout << "    absmode:               " << ((auxiliaryData[stream][2][RamOffset + 4] & 0x20) >> 5) << endl;
-    cout << "    DSPen:                 " << ((auxiliaryData[stream][2][RamOffset + 4] & 0x10) >> 4) << endl;
-    cout << "    DSP cutoff freq:       " << ((auxiliaryData[stream][2][RamOffset + 4] & 0x0f) >> 0) << endl;
-    cout << "    Zcheck DAC power:      " << ((auxiliaryData[stream][2][RamOffset + 5] & 0x40) >> 6) << endl;
-    cout << "    Zcheck load:           " << ((auxiliaryData[stream][2][RamOffset + 5] & 0x20) >> 5) << endl;
-    cout << "    Zcheck scale:          " << ((auxiliaryData[stream][2][RamOffset + 5] & 0x18) >> 3) << endl;
-    cout << "    Zcheck conn all:       " << ((auxiliaryData[stream][2][RamOffset + 5] & 0x04) >> 2) << endl;
-    cout << "    Zcheck sel pol:        " << ((auxiliaryData[stream][2][RamOffset + 5] & 0x02) >> 1) << endl;
-    cout << "    Zcheck en:             " << ((auxiliaryData[stream][2][RamOffset + 5] & 0x01) >> 0) << endl;
-    cout << "    Zcheck DAC:            " << ((auxiliaryData[stream][2][RamOffset + 6] & 0xff) >> 0) << endl;
-    cout << "    Zcheck select:         " << ((auxiliaryData[stream][2][RamOffset + 7] & 0x3f) >> 0) << endl;
-    cout << "    ADC aux1 en:           " << ((auxiliaryData[stream][2][RamOffset + 9] & 0x80) >> 7) << endl;
-    cout << "    ADC aux2 en:           " << ((auxiliaryData[stream][2][RamOffset + 11] & 0x80) >> 7) << endl;
-    cout << "    ADC aux3 en:           " << ((auxiliaryData[stream][2][RamOffset + 13] & 0x80) >> 7) << endl;
-    cout << "    offchip RH1:           " << ((auxiliaryData[stream][2][RamOffset + 8] & 0x80) >> 7) << endl;
-    cout << "    offchip RH2:           " << ((auxiliaryData[stream][2][RamOffset + 10] & 0x80) >> 7) << endl;
-    cout << "    offchip RL:            " << ((auxiliaryData[stream][2][RamOffset + 12] & 0x80) >> 7) << endl;
-
-    int rH1Dac1 = auxiliaryData[stream][2][RamOffset + 8] & 0x3f;
-    int rH1Dac2 = auxiliaryData[stream][2][RamOffset + 9] & 0x1f;
-    int rH2Dac1 = auxiliaryData[stream][2][RamOffset + 10] & 0x3f;
-    int rH2Dac2 = auxiliaryData[stream][2][RamOffset + 11] & 0x1f;
-    int rLDac1 = auxiliaryData[stream][2][RamOffset + 12] & 0x7f;
-    int rLDac2 = auxiliaryData[stream][2][RamOffset + 13] & 0x3f;
-    int rLDac3 = auxiliaryData[stream][2][RamOffset + 13] & 0x40 >> 6;
+    cout << "    ADC reference BW:      " << ((auxiliary(stream, 2, RamOffset + 0) & 0xc0) >> 6) << endl;
+    cout << "    amp fast settle:       " << ((auxiliary(stream, 2, RamOffset + 0) & 0x20) >> 5) << endl;
+    cout << "    amp Vref enable:       " << ((auxiliary(stream, 2, RamOffset + 0) & 0x10) >> 4) << endl;
+    cout << "    ADC comparator bias:   " << ((auxiliary(stream, 2, RamOffset + 0) & 0x0c) >> 2) << endl;
+    cout << "    ADC comparator select: " << ((auxiliary(stream, 2, RamOffset + 0) & 0x03) >> 0) << endl;
+    cout << "    VDD sense enable:      " << ((auxiliary(stream, 2, RamOffset + 1) & 0x40) >> 6) << endl;
+    cout << "    ADC buffer bias:       " << ((auxiliary(stream, 2, RamOffset + 1) & 0x3f) >> 0) << endl;
+    cout << "    MUX bias:              " << ((auxiliary(stream, 2, RamOffset + 2) & 0x3f) >> 0) << endl;
+    cout << "    MUX load:              " << ((auxiliary(stream, 2, RamOffset + 3) & 0xe0) >> 5) << endl;
+    cout << "    tempS2, tempS1:        " << ((auxiliary(stream, 2, RamOffset + 3) & 0x10) >> 4) << "," <<
+           ((auxiliary(stream, 2, RamOffset + 3) & 0x08) >> 3) << endl;
+    cout << "    tempen:                " << ((auxiliary(stream, 2, RamOffset + 3) & 0x04) >> 2) << endl;
+    cout << "    digout HiZ:            " << ((auxiliary(stream, 2, RamOffset + 3) & 0x02) >> 1) << endl;
+    cout << "    digout:                " << ((auxiliary(stream, 2, RamOffset + 3) & 0x01) >> 0) << endl;
+    cout << "    weak MISO:             " << ((auxiliary(stream, 2, RamOffset + 4) & 0x80) >> 7) << endl;
+    cout << "    twoscomp:              " << ((auxiliary(stream, 2, RamOffset + 4) & 0x40) >> 6) << endl;
+    cout << "    absmode:               " << ((auxiliary(stream, 2, RamOffset + 4) & 0x20) >> 5) << endl;
+    cout << "    DSPen:                 " << ((auxiliary(stream, 2, RamOffset + 4) & 0x10) >> 4) << endl;
+    cout << "    DSP cutoff freq:       " << ((auxiliary(stream, 2, RamOffset + 4) & 0x0f) >> 0) << endl;
+    cout << "    Zcheck DAC power:      " << ((auxiliary(stream, 2, RamOffset + 5) & 0x40) >> 6) << endl;
+    cout << "    Zcheck load:           " << ((auxiliary(stream, 2, RamOffset + 5) & 0x20) >> 5) << endl;
+    cout << "    Zcheck scale:          " << ((auxiliary(stream, 2, RamOffset + 5) & 0x18) >> 3) << endl;
+    cout << "    Zcheck conn all:       " << ((auxiliary(stream, 2, RamOffset + 5) & 0x04) >> 2) << endl;
+    cout << "    Zcheck sel pol:        " << ((auxiliary(stream, 2, RamOffset + 5) & 0x02) >> 1) << endl;
+    cout << "    Zcheck en:             " << ((auxiliary(stream, 2, RamOffset + 5) & 0x01) >> 0) << endl;
+    cout << "    Zcheck DAC:            " << ((auxiliary(stream, 2, RamOffset + 6) & 0xff) >> 0) << endl;
+    cout << "    Zcheck select:         " << ((auxiliary(stream, 2, RamOffset + 7) & 0x3f) >> 0) << endl;
+    cout << "    ADC aux1 en:           " << ((auxiliary(stream, 2, RamOffset + 9) & 0x80) >> 7) << endl;
+    cout << "    ADC aux2 en:           " << ((auxiliary(stream, 2, RamOffset + 11) & 0x80) >> 7) << endl;
+    cout << "    ADC aux3 en:           " << ((auxiliary(stream, 2, RamOffset + 13) & 0x80) >> 7) << endl;
+    cout << "    offchip RH1:           " << ((auxiliary(stream, 2, RamOffset + 8) & 0x80) >> 7) << endl;
+    cout << "    offchip RH2:           " << ((auxiliary(stream, 2, RamOffset + 10) & 0x80) >> 7) << endl;
+    cout << "    offchip RL:            " << ((auxiliary(stream, 2, RamOffset + 12) & 0x80) >> 7) << endl;
+
+    int rH1Dac1 = auxiliary(stream, 2, RamOffset + 8) & 0x3f;
+    int rH1Dac2 = auxiliary(stream, 2, RamOffset + 9) & 0x1f;
+    int rH2Dac1 = auxiliary(stream, 2, RamOffset + 10) & 0x3f;
+    int rH2Dac2 = auxiliary(stream, 2, RamOffset + 11) & 0x1f;
+    int rLDac1 = auxiliary(stream, 2, RamOffset + 12) & 0x7f;
+    int rLDac2 = auxiliary(stream, 2, RamOffset + 13) & 0x3f;
+    int rLDac3 = auxiliary(stream, 2, RamOffset + 13) & 0x40 >> 6;
 
     double rH1 = 2630.0 + rH1Dac2 * 30800.0 + rH1Dac1 * 590.0;
     double rH2 = 8200.0 + rH2Dac2 * 38400.0 + rH2Dac1 * 730.0;
@@ -290,44 +265,44 @@ void Rhd2000DataBlock::print(int stream) const
             (rL / 1000) << " kOhm" << endl;
 
     cout << "    amp power[31:0]:       " <<
-           ((auxiliaryData[stream][2][RamOffset + 17] & 0x80) >> 7) <<
-           ((auxiliaryData[stream][2][RamOffset + 17] & 0x40) >> 6) <<
-           ((auxiliaryData[stream][2][RamOffset + 17] & 0x20) >> 5) <<
-           ((auxiliaryData[stream][2][RamOffset + 17] & 0x10) >> 4) <<
-           ((auxiliaryData[stream][2][RamOffset + 17] & 0x08) >> 3) <<
-           ((auxiliaryData[stream][2][RamOffset + 17] & 0x04) >> 2) <<
-           ((auxiliaryData[stream][2][RamOffset + 17] & 0x02) >> 1) <<
-           ((auxiliaryData[stream][2][RamOffset + 17] & 0x01) >> 0) << " " <<
-           ((auxiliaryData[stream][2][RamOffset + 16] & 0x80) >> 7) <<
-           ((auxiliaryData[stream][2][RamOffset + 16] & 0x40) >> 6) <<
-           ((auxiliaryData[stream][2][RamOffset + 16] & 0x20) >> 5) <<
-           ((auxiliaryData[stream][2][RamOffset + 16] & 0x10) >> 4) <<
-           ((auxiliaryData[stream][2][RamOffset + 16] & 0x08) >> 3) <<
-           ((auxiliaryData[stream][2][RamOffset + 16] & 0x04) >> 2) <<
-           ((auxiliaryData[stream][2][RamOffset + 16] & 0x02) >> 1) <<
-           ((auxiliaryData[stream][2][RamOffset + 16] & 0x01) >> 0) << " " <<
-           ((auxiliaryData[stream][2][RamOffset + 15] & 0x80) >> 7) <<
-           ((auxiliaryData[stream][2][RamOffset + 15] & 0x40) >> 6) <<
-           ((auxiliaryData[stream][2][RamOffset + 15] & 0x20) >> 5) <<
-           ((auxiliaryData[stream][2][RamOffset + 15] & 0x10) >> 4) <<
-           ((auxiliaryData[stream][2][RamOffset + 15] & 0x08) >> 3) <<
-           ((auxiliaryData[stream][2][RamOffset + 15] & 0x04) >> 2) <<
-           ((auxiliaryData[stream][2][RamOffset + 15] & 0x02) >> 1) <<
-           ((auxiliaryData[stream][2][RamOffset + 15] & 0x01) >> 0) << " " <<
-           ((auxiliaryData[stream][2][RamOffset + 14] & 0x80) >> 7) <<
-           ((auxiliaryData[stream][2][RamOffset + 14] & 0x40) >> 6) <<
-           ((auxiliaryData[stream][2][RamOffset + 14] & 0x20) >> 5) <<
-           ((auxiliaryData[stream][2][RamOffset + 14] & 0x10) >> 4) <<
-           ((auxiliaryData[stream][2][RamOffset + 14] & 0x08) >> 3) <<
-           ((auxiliaryData[stream][2][RamOffset + 14] & 0x04) >> 2) <<
-           ((auxiliaryData[stream][2][RamOffset + 14] & 0x02) >> 1) <<
-           ((auxiliaryData[stream][2][RamOffset + 14] & 0x01) >> 0) << endl;
+           ((auxiliary(stream, 2, RamOffset + 17) & 0x80) >> 7) <<
+           ((auxiliary(stream, 2, RamOffset + 17) & 0x40) >> 6) <<
+           ((auxiliary(stream, 2, RamOffset + 17) & 0x20) >> 5) <<
+           ((auxiliary(stream, 2, RamOffset + 17) & 0x10) >> 4) <<
+           ((auxiliary(stream, 2, RamOffset + 17) & 0x08) >> 3) <<
+           ((auxiliary(stream, 2, RamOffset + 17) & 0x04) >> 2) <<
+           ((auxiliary(stream, 2, RamOffset + 17) & 0x02) >> 1) <<
+           ((auxiliary(stream, 2, RamOffset + 17) & 0x01) >> 0) << " " <<
+           ((auxiliary(stream, 2, RamOffset + 16) & 0x80) >> 7) <<
+           ((auxiliary(stream, 2, RamOffset + 16) & 0x40) >> 6) <<
+           ((auxiliary(stream, 2, RamOffset + 16) & 0x20) >> 5) <<
+           ((auxiliary(stream, 2, RamOffset + 16) & 0x10) >> 4) <<
+           ((auxiliary(stream, 2, RamOffset + 16) & 0x08) >> 3) <<
+           ((auxiliary(stream, 2, RamOffset + 16) & 0x04) >> 2) <<
+           ((auxiliary(stream, 2, RamOffset + 16) & 0x02) >> 1) <<
+           ((auxiliary(stream, 2, RamOffset + 16) & 0x01) >> 0) << " " <<
+           ((auxiliary(stream, 2, RamOffset + 15) & 0x80) >> 7) <<
+           ((auxiliary(stream, 2, RamOffset + 15) & 0x40) >> 6) <<
+           ((auxiliary(stream, 2, RamOffset + 15) & 0x20) >> 5) <<
+           ((auxiliary(stream, 2, RamOffset + 15) & 0x10) >> 4) <<
+           ((auxiliary(stream, 2, RamOffset + 15) & 0x08) >> 3) <<
+           ((auxiliary(stream, 2, RamOffset + 15) & 0x04) >> 2) <<
+           ((auxiliary(stream, 2, RamOffset + 15) & 0x02) >> 1) <<
+           ((auxiliary(stream, 2, RamOffset + 15) & 0x01) >> 0) << " " <<
+           ((auxiliary(stream, 2, RamOffset + 14) & 0x80) >> 7) <<
+           ((auxiliary(stream, 2, RamOffset + 14) & 0x40) >> 6) <<
+           ((auxiliary(stream, 2, RamOffset + 14) & 0x20) >> 5) <<
+           ((auxiliary(stream, 2, RamOffset + 14) & 0x10) >> 4) <<
+           ((auxiliary(stream, 2, RamOffset + 14) & 0x08) >> 3) <<
+           ((auxiliary(stream, 2, RamOffset + 14) & 0x04) >> 2) <<
+           ((auxiliary(stream, 2, RamOffset + 14) & 0x02) >> 1) <<
+           ((auxiliary(stream, 2, RamOffset + 14) & 0x01) >> 0) << endl;
 
     cout << endl;
 
-    int tempA = auxiliaryData[stream][1][12];
-    int tempB = auxiliaryData[stream][1][20];
-    int vddSample = auxiliaryData[stream][1][28];
+    int tempA = auxiliary(stream, 1, 12);
+    int tempB = auxiliary(stream, 1, 20);
+    int vddSample = auxiliary(stream, 1, 28);
 
     double tempUnitsC = ((double)(tempB - tempA)) / 98.9 - 273.15;
     double tempUnitsF = (9.0/5.0) * tempUnitsC + 32.0;
@@ -372,16 +347,16 @@ void Rhd2000DataBlock::write(ofstream &saveOut, int numDataStreams) const
         writeWordLittleEndian(saveOut, timeStamp[t]);
         for (channel = 0; channel < 32; ++channel) {
             for (stream = 0; stream < numDataStreams; ++stream) {
-                writeWordLittleEndian(saveOut, amplifierData[stream][channel][t]);
+                writeWordLittleEndian(saveOut, amplifier(stream, channel, t));
             }
         }
         for (channel = 0; channel < 3; ++channel) {
             for (stream = 0; stream < numDataStreams; ++stream) {
-                writeWordLittleEndian(saveOut, auxiliaryData[stream][channel][t]);
+                writeWordLittleEndian(saveOut, auxiliary(stream, channel, t));
             }
         }
         for (i = 0; i < 8; ++i) {
-            writeWordLittleEndian(saveOut, boardAdcData[i][t]);
+            writeWordLittleEndian(saveOut, boardAdc(i, t));
         }
         writeWordLittleEndian(saveOut, ttlIn[t]);
         writeWordLittleEndian(saveOut, ttlOut[t]);
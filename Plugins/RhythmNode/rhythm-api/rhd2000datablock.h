@@ -36,10 +36,30 @@ class Rhd2000DataBlock
 public:
     Rhd2000DataBlock(int numDataStreams, bool usb3);
 
+    // Resizes the block for numDataStreams streams, keeping its storage when it is large enough,
+    // so that a block can be reused for every read instead of constructing a new one.
+    void reset(int numDataStreams);
+
+    int getNumDataStreams() const { return numDataStreams; }
+
+    // Sample t of each signal.  Every channel of every stream is stored contiguously, channel
+    // after channel in one flat array, so that whole channels can be converted at once.
+    int& amplifier(int stream, int channel, int t) { return amplifierData[(stream * 32 + channel) * samplesPerBlock + t]; }
+    int amplifier(int stream, int channel, int t) const { return amplifierData[(stream * 32 + channel) * samplesPerBlock + t]; }
+    int& auxiliary(int stream, int channel, int t) { return auxiliaryData[(stream * 3 + channel) * samplesPerBlock + t]; }
+    int auxiliary(int stream, int channel, int t) const { return auxiliaryData[(stream * 3 + channel) * samplesPerBlock + t]; }
+    int& boardAdc(int channel, int t) { return boardAdcData[channel * samplesPerBlock + t]; }
+    int boardAdc(int channel, int t) const { return boardAdcData[channel * samplesPerBlock + t]; }
+
+    // The samplesPerBlock samples of one channel
+    const int* amplifierChannel(int stream, int channel) const { return &amplifierData[(stream * 32 + channel) * samplesPerBlock]; }
+    const int* auxiliaryChannel(int stream, int channel) const { return &auxiliaryData[(stream * 3 + channel) * samplesPerBlock]; }
+    const int* boardAdcChannel(int channel) const { return &boardAdcData[channel * samplesPerBlock]; }
+
     vector<unsigned int> timeStamp;
-    vector<vector<vector<int> > > amplifierData;
-    vector<vector<vector<int> > > auxiliaryData;
-    vector<vector<int> > boardAdcData;
+    vector<int> amplifierData;
+    vector<int> auxiliaryData;
+    vector<int> boardAdcData;
     vector<int> ttlIn;
     vector<int> ttlOut;
 
@@ -54,16 +74,12 @@ public:
     static int convertUsbWord(unsigned char usbBuffer[], int index);
 
 private:
-    void allocateIntArray3D(vector<vector<vector<int> > > &array3D, int xSize, int ySize, int zSize);
-    void allocateIntArray2D(vector<vector<int> > &array2D, int xSize, int ySize);
-    void allocateIntArray1D(vector<int> &array1D, int xSize);
-    void allocateUIntArray1D(vector<unsigned int> &array1D, int xSize);
-
     void writeWordLittleEndian(ofstream &outputStream, int dataWord) const;
 
 
-    const unsigned int samplesPerBlock;
+    unsigned int samplesPerBlock;
     bool usb3;
+    int numDataStreams;
 };
 
 #endif // RHD2000DATABLOCK_H
@@ -1454,7 +1454,6 @@ bool Rhd2000EvalBoard::readDataBlock(Rhd2000DataBlock *dataBlock, int nSamples)
 bool Rhd2000EvalBoard::readRawDataBlock(unsigned char** bufferPtr, int nSamples)
 {
     unsigned int numBytesToRead;
-    long res;
 
     numBytesToRead = 2 * Rhd2000DataBlock::calculateDataBlockSizeInWords(numDataStreams, usb3, nSamples);
 
@@ -1465,23 +1464,37 @@ bool Rhd2000EvalBoard::readRawDataBlock(unsigned char** bufferPtr, int nSamples)
         return false;
     }
 
+    readDataBlocksRaw(1, usbBuffer, nSamples);
+    *bufferPtr = usbBuffer;
+    return true;
+}
+
+// Reads numBlocks raw data blocks of nSamples samples (a standard block if nSamples <= 0) into
+// buffer, which must hold 2 * numBlocks * calculateDataBlockSizeInWords() bytes.  Does not check
+// the FIFO level.  Returns the result of the pipe read.
+long Rhd2000EvalBoard::readDataBlocksRaw(int numBlocks, unsigned char* buffer, int nSamples)
+{
+    unsigned int numBytesToRead;
+    long res;
+
+    numBytesToRead = 2 * numBlocks * Rhd2000DataBlock::calculateDataBlockSizeInWords(numDataStreams, usb3, nSamples);
+
     if (usb3)
     {
         //std::cout << "usb3 read : " << numBytesToRead << " in " << USB3_BLOCK_SIZE << " blocks" << std::endl;
-        res = dev->ReadFromBlockPipeOut(PipeOutData, USB3_BLOCK_SIZE, numBytesToRead, usbBuffer);
+        res = dev->ReadFromBlockPipeOut(PipeOutData, USB3_BLOCK_SIZE, numBytesToRead, buffer);
 
     }
     else
     {
         //std::cout << "usb2 read: " << numBytesToRead << std::endl;
-        res = dev->ReadFromPipeOut(PipeOutData, numBytesToRead, usbBuffer);
+        res = dev->ReadFromPipeOut(PipeOutData, numBytesToRead, buffer);
     }
     if (res == ok_Timeout)
     {
         cerr << "CRITICAL: Timeout on pipe read. Check block and buffer sizes." << endl;
     }
-    *bufferPtr = usbBuffer;
-    return true;
+    return res;
 }
 
 // Reads a certain number of USB data blocks, if the specified number is available, and appends them
@@ -1490,10 +1503,9 @@ bool Rhd2000EvalBoard::readDataBlocks(int numBlocks, queue<Rhd2000DataBlock> &da
 {
     unsigned int numWordsToRead, numBytesToRead;
     int i;
-    Rhd2000DataBlock *dataBlock;
     long res;
 
-    numWordsToRead = numBlocks * dataBlock->calculateDataBlockSizeInWords(numDataStreams, usb3);
+    numWordsToRead = numBlocks * Rhd2000DataBlock::calculateDataBlockSizeInWords(numDataStreams, usb3);
 
     if (numWordsInFifo() < numWordsToRead)
         return false;
@@ -1519,16 +1531,28 @@ bool Rhd2000EvalBoard::readDataBlocks(int numBlocks, queue<Rhd2000DataBlock> &da
         cerr << "CRITICAL: Timeout on pipe read. Check block and buffer sizes." << endl;
     }
 
-    dataBlock = new Rhd2000DataBlock(numDataStreams, usb3);
     for (i = 0; i < numBlocks; ++i) {
-        dataBlock->fillFromUsbBuffer(usbBuffer, i, numDataStreams);
-        dataQueue.push(*dataBlock);
+        if (spareBlocks.empty()) {
+            dataQueue.push(Rhd2000DataBlock(numDataStreams, usb3));
+        }
+        else {
+            dataQueue.push(std::move(spareBlocks.back()));
+            spareBlocks.pop_back();
+            dataQueue.back().reset(numDataStreams);
+        }
+        dataQueue.back().fillFromUsbBuffer(usbBuffer, i, numDataStreams);
     }
-    delete dataBlock;
 
     return true;
 }
 
+// Hands a data block taken from a queue filled by readDataBlocks() back to the board, which
+// refills it on a later read instead of allocating a new one.
+void Rhd2000EvalBoard::recycleDataBlock(Rhd2000DataBlock &&dataBlock)
+{
+    spareBlocks.push_back(std::move(dataBlock));
+}
+
 // Writes the contents of a data block queue (dataQueue) to a binary output stream (saveOut).
 // Returns the number of data blocks written.
 int Rhd2000EvalBoard::queueToFile(queue<Rhd2000DataBlock> &dataQueue, ofstream &saveOut)
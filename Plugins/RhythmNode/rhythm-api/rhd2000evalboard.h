@@ -34,6 +34,9 @@
 #define DDR_BLOCK_SIZE 32
 
 #include <queue>
+#include <vector>
+#include <fstream>
+#include "rhd2000datablock.h"
 
 using namespace std;
 
@@ -41,7 +44,6 @@ namespace OpalKellyLegacy
 {
     class okCFrontPanel;
 }
-class Rhd2000DataBlock;
 
 class Rhd2000EvalBoard
 {
@@ -160,6 +162,7 @@ public:
     void flush();
     bool readDataBlock(Rhd2000DataBlock *dataBlock, int nSamples = -1);
     bool readDataBlocks(int numBlocks, queue<Rhd2000DataBlock> &dataQueue);
+    void recycleDataBlock(Rhd2000DataBlock &&dataBlock);
     int queueToFile(queue<Rhd2000DataBlock> &dataQueue, std::ofstream &saveOut);
     int getBoardMode() const;
     int getCableDelay(BoardPort port) const;
@@ -173,6 +176,7 @@ public:
     bool isUSB3();
     void printFIFOmetrics();
     bool readRawDataBlock(unsigned char** bufferPtr, int nSamples = -1);
+    long readDataBlocksRaw(int numBlocks, unsigned char* buffer, int nSamples = -1);
 
 private:
     OpalKellyLegacy::okCFrontPanel *dev;
@@ -184,6 +188,9 @@ private:
     // Buffer for reading bytes from USB interface
     unsigned char usbBuffer[USB_BUFFER_SIZE];
 
+    // Blocks handed back by recycleDataBlock(), refilled by readDataBlocks()
+    vector<Rhd2000DataBlock> spareBlocks;
+
     // Opal Kelly module USB interface endpoint addresses
     enum OkEndPoint {
         WireInResetRun = 0x00,
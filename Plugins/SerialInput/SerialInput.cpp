@@ -25,6 +25,7 @@
 #include <stdio.h>
 #include "SerialInput.h"
 #define MAX_MSG_SIZE 10000
+#define MAX_MESSAGES 64
 
 const int SerialInput::BAUDRATES[12] = 
 {
@@ -46,15 +47,19 @@ const int SerialInput::BAUDRATES[12] =
 SerialInput::SerialInput()
     : GenericProcessor  ("Serial Port")
     , baudrate          (0)
-	, lastRecv			(0)
+    , connected         (false)
+    , reader            ("Serial Input", MAX_MESSAGES * MAX_MSG_SIZE, MAX_MESSAGES)
+    , readErrorReported (false)
 {
     setProcessorType (PROCESSOR_TYPE_SOURCE);
-	dataBuffer.calloc(MAX_MSG_SIZE);
+    messageData.calloc (MAX_MSG_SIZE);
 }
 
 
 SerialInput::~SerialInput()
 {
+    reader.stop();
+    cancelPendingUpdate();
     serial.close();
 }
 
@@ -104,6 +109,14 @@ void SerialInput::setBaudrate (int baudrate)
 }
 
 
+bool SerialInput::prepareForAcquisition()
+{
+    // the errors are reported by isReady(), on the message thread
+    connected = device != "" && baudrate != 0 && serial.setup (device, baudrate);
+    return true;
+}
+
+
 bool SerialInput::isReady()
 {
     if (device == "" || baudrate == 0)
@@ -111,7 +124,7 @@ bool SerialInput::isReady()
         AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon, "SerialInput connection error!", "Please set device and baudrate to use first!");
         return false;
     }
-    if (! serial.setup (device, baudrate))
+    if (! connected)
     {
         AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon, "SerialInput connection error!", "Could not connect to specified serial device. Check log files for details.");
         return false;
@@ -120,9 +133,19 @@ bool SerialInput::isReady()
 }
 
 
+bool SerialInput::enable()
+{
+    readErrorReported = false;
+    reader.start (serial);
+    return true;
+}
+
+
 bool SerialInput::disable()
 {
+    reader.stop();
     serial.close();
+    connected = false;
     return true;
 }
 
@@ -132,44 +155,36 @@ void SerialInput::process (AudioSampleBuffer&)
 	int64 timestamp = CoreServices::getGlobalTimestamp();
 	setTimestampAndSamples(timestamp, 0);
 
-    int bytesAvailable = serial.available();
-
-    if (bytesAvailable == OF_SERIAL_ERROR)
+    if (reader.hasFailed() && ! readErrorReported)
     {
-        // ToDo: Properly warn about problem here!
-        AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon, "SerialInput device access error!", "Could not access serial device.");
-        return;
+        readErrorReported = true;
+        triggerAsyncUpdate();
     }
 
-    if (bytesAvailable > 0)
-    {
+    if (reader.getNumReady() == 0)
+        return;
+
+    const EventChannel* chan = getEventChannel(getEventChannelIndex(0, getNodeId()));
+
+    // one event per read of the port, split when it is longer than an event holds
+    juce::int64 messageTimestamp;
+    int numBytes;
 
-        int bytesRead = serial.readBytes (dataBuffer, bytesAvailable);
-
-        if (bytesRead > 0)
-        {
-			//Clear the rest of the buffer so we don't send garbage.
-			if (bytesRead < lastRecv)
-				zeromem(dataBuffer.getData() + bytesRead, lastRecv - bytesRead);
-			lastRecv = bytesRead;
-			MetaDataValueArray metadata;
-			MetaDataValuePtr bufferRead = new MetaDataValue(MetaDataDescriptor::UINT64, 1);
-			bufferRead->setValue(static_cast<uint64>(bytesRead));
-			metadata.add(bufferRead);
-			const EventChannel* chan = getEventChannel(getEventChannelIndex(0, getNodeId()));
-			BinaryEventPtr event = BinaryEvent::createBinaryEvent(chan, timestamp, static_cast<uint8*>(dataBuffer.getData()), MAX_MSG_SIZE, metadata);
-			addEvent(chan, event, 0);
-        }
-        else if (bytesRead < 0)
-        {
-            // ToDo: Properly warn about problem here!
-            AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon, "SerialInput device read error!", "Could not read serial input, even though data should be available.");
-            return;
-        }
+    while ((numBytes = reader.readChunk (messageData, MAX_MSG_SIZE, messageTimestamp)) > 0)
+    {
+        //The event is zero padded past the read bytes, and their count written in place as metadata
+        MetaDataEventWriter metaData = addBinaryEvent (chan, messageTimestamp, messageData, numBytes, 0);
+        metaData.setValue (0, static_cast<uint64> (numBytes));
     }
 }
 
 
+void SerialInput::handleAsyncUpdate()
+{
+    AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon, "SerialInput device read error!", "Could not read serial input, no more data will be received from the device.");
+}
+
+
 AudioProcessorEditor* SerialInput::createEditor()
 {
     editor = new SerialInputEditor (this);
@@ -37,9 +37,13 @@
 /**
     This source processor allows you to pipe binary serial data input straight to the event cue/buffer.
 
+    The port is read by a SerialReader, which waits for data on a thread of its own and timestamps
+    it on arrival. process() only drains what has been read so far, so a stuck device can't hold up
+    the signal chain.
+
     @see SerialInputEditor
 */
-class SerialInput : public GenericProcessor
+class SerialInput : public GenericProcessor, private AsyncUpdater
 {
 public:
     /** The class constructor, used to initialize any members. */
@@ -59,18 +63,27 @@ public:
     void process (AudioSampleBuffer& buffer) override;
 
     /**
-        This should only be run by the ProcessorGraph, before acquisition will be started.
+        Called by the ProcessorGraph on a worker thread, before acquisition will be started.
+
+        It tries to open the serial port previsouly specified by the setDevice and setBaudrate setters,
+        so that opening it doesn't hold up the other processors.
+    */
+    bool prepareForAcquisition() override;
 
-        It tries to open the serial port previsouly specified by the setDevice and setBaudrate setters.
+    /**
+        This should only be run by the ProcessorGraph, before acquisition will be started.
 
-        Returns true on success, false if port could not be opened.
+        Returns true if the port was opened by prepareForAcquisition(), false otherwise.
     */
     bool isReady() override;
 
+    /** Starts the reader thread */
+    bool enable() override;
+
     /**
         Called immediately after the end of data acquisition by the ProcessorGraph.
 
-        It closes the open port serial port.
+        It stops the reader thread and closes the open serial port.
      */
     bool disable() override;
 
@@ -94,9 +107,15 @@ protected:
 
 
 private:
+    /** Reports read errors of the reader thread, on the message thread */
+    void handleAsyncUpdate() override;
+
     // The current serial connection
     ofSerial serial;
 
+    // Whether prepareForAcquisition() opened the port
+    bool connected;
+
     // The serial device to be used
     string device;
 
@@ -106,8 +125,14 @@ private:
     // List of baudrates that are available by default.
     static const int BAUDRATES[12];
 
-	HeapBlock<unsigned char> dataBuffer;
-	int lastRecv;
+    // Reads the port during acquisition
+    SerialReader reader;
+
+    // Whether the read error of the current acquisition was reported
+    bool readErrorReported;
+
+    // The bytes of the event being added
+    HeapBlock<unsigned char> messageData;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SerialInput);
 };
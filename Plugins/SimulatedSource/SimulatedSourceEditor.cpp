@@ -0,0 +1,137 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SimulatedSourceEditor.h"
+#include "SimulatedThread.h"
+
+using namespace SimulatedSource;
+
+SimulatedSourceEditor::SimulatedSourceEditor(GenericProcessor* parentNode, SimulatedThread* thread_)
+	: GenericEditor(parentNode, false), thread(thread_)
+{
+	desiredWidth = 180;
+
+	channelsLabel = addSetting("Channels", String(thread->getNumChannels()), 25);
+	channelsLabel->setTooltip("Channels per subprocessor, from 64 to 4096");
+	subProcessorsLabel = addSetting("Subprocs", String(thread->getNumSubProcessors()), 42);
+	sampleRateLabel = addSetting("Rate (Hz)", String(thread->getSampleRate(0)), 59);
+	noiseLabel = addSetting("Noise (uV)", String(thread->getNoiseLevel()), 76);
+	noiseLabel->setTooltip("Standard deviation of the white noise");
+	firingRateLabel = addSetting("Units (Hz)", String(thread->getFiringRate()), 93);
+	firingRateLabel->setTooltip("Mean firing rate of each simulated unit");
+	seedLabel = addSetting("Seed", String(thread->getSeed()), 110);
+	seedLabel->setTooltip("Runs with the same seed and settings generate the same data");
+}
+
+Label* SimulatedSourceEditor::addSetting(const String& name, const String& value, int y)
+{
+	Label* title = new Label(name, name);
+	title->setFont(Font("Small Text", 10, Font::plain));
+	title->setBounds(10, y, 60, 16);
+	title->setColour(Label::textColourId, Colours::darkgrey);
+	addAndMakeVisible(title);
+	staticLabels.add(title);
+
+	Label* setting = new Label(name + " value", value);
+	setting->setFont(Font("Small Text", 10, Font::plain));
+	setting->setEditable(true, false, false);
+	setting->addListener(this);
+	setting->setBounds(70, y, 100, 16);
+	setting->setColour(Label::textColourId, Colours::darkgrey);
+	setting->setColour(Label::backgroundColourId, Colours::lightgrey);
+	addAndMakeVisible(setting);
+	return setting;
+}
+
+void SimulatedSourceEditor::labelTextChanged(Label* label)
+{
+	updateSettings();
+}
+
+void SimulatedSourceEditor::updateSettings()
+{
+	int numChannels = thread->getNumChannels();
+	int numSubProcessors = thread->getNumSubProcessors();
+	float sampleRate = thread->getSampleRate(0);
+
+	thread->setNumChannels(channelsLabel->getText().getIntValue());
+	thread->setNumSubProcessors(subProcessorsLabel->getText().getIntValue());
+	thread->setSampleRate(sampleRateLabel->getText().getFloatValue());
+	thread->setNoiseLevel(noiseLabel->getText().getFloatValue());
+	thread->setFiringRate(firingRateLabel->getText().getFloatValue());
+	thread->setSeed(seedLabel->getText().getIntValue());
+
+	channelsLabel->setText(String(thread->getNumChannels()), dontSendNotification);
+	subProcessorsLabel->setText(String(thread->getNumSubProcessors()), dontSendNotification);
+	sampleRateLabel->setText(String(thread->getSampleRate(0)), dontSendNotification);
+	noiseLabel->setText(String(thread->getNoiseLevel()), dontSendNotification);
+	firingRateLabel->setText(String(thread->getFiringRate()), dontSendNotification);
+	seedLabel->setText(String(thread->getSeed()), dontSendNotification);
+
+	if (numChannels != thread->getNumChannels() || numSubProcessors != int(thread->getNumSubProcessors())
+		|| sampleRate != thread->getSampleRate(0))
+		CoreServices::updateSignalChain(this);
+}
+
+void SimulatedSourceEditor::startAcquisition()
+{
+	for (Label* label : { channelsLabel.get(), subProcessorsLabel.get(), sampleRateLabel.get(),
+		noiseLabel.get(), firingRateLabel.get(), seedLabel.get() })
+		label->setEnabled(false);
+}
+
+void SimulatedSourceEditor::stopAcquisition()
+{
+	for (Label* label : { channelsLabel.get(), subProcessorsLabel.get(), sampleRateLabel.get(),
+		noiseLabel.get(), firingRateLabel.get(), seedLabel.get() })
+		label->setEnabled(true);
+}
+
+void SimulatedSourceEditor::saveCustomParameters(XmlElement* xml)
+{
+	XmlElement* parameters = xml->createNewChildElement("PARAMETERS");
+
+	parameters->setAttribute("channels", thread->getNumChannels());
+	parameters->setAttribute("subprocessors", int(thread->getNumSubProcessors()));
+	parameters->setAttribute("sampleRate", thread->getSampleRate(0));
+	parameters->setAttribute("noise", thread->getNoiseLevel());
+	parameters->setAttribute("firingRate", thread->getFiringRate());
+	parameters->setAttribute("seed", thread->getSeed());
+}
+
+void SimulatedSourceEditor::loadCustomParameters(XmlElement* xml)
+{
+	forEachXmlChildElement(*xml, subNode)
+	{
+		if (subNode->hasTagName("PARAMETERS"))
+		{
+			channelsLabel->setText(subNode->getStringAttribute("channels", String(thread->getNumChannels())), dontSendNotification);
+			subProcessorsLabel->setText(subNode->getStringAttribute("subprocessors", String(thread->getNumSubProcessors())), dontSendNotification);
+			sampleRateLabel->setText(subNode->getStringAttribute("sampleRate", String(thread->getSampleRate(0))), dontSendNotification);
+			noiseLabel->setText(subNode->getStringAttribute("noise", String(thread->getNoiseLevel())), dontSendNotification);
+			firingRateLabel->setText(subNode->getStringAttribute("firingRate", String(thread->getFiringRate())), dontSendNotification);
+			seedLabel->setText(subNode->getStringAttribute("seed", String(thread->getSeed())), dontSendNotification);
+			updateSettings();
+		}
+	}
+}
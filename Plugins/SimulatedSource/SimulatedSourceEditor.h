@@ -0,0 +1,69 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __SIMULATEDSOURCEEDITOR_H_2A9C61F3__
+#define __SIMULATEDSOURCEEDITOR_H_2A9C61F3__
+
+#include <EditorHeaders.h>
+
+namespace SimulatedSource
+{
+
+	class SimulatedThread;
+
+	class SimulatedSourceEditor : public GenericEditor, public Label::Listener
+	{
+	public:
+		SimulatedSourceEditor(GenericProcessor* parentNode, SimulatedThread* thread);
+
+		/** Pushes an edited setting to the thread. */
+		void labelTextChanged(Label* label) override;
+
+		void startAcquisition() override;
+		void stopAcquisition() override;
+
+		void saveCustomParameters(XmlElement* xml) override;
+		void loadCustomParameters(XmlElement* xml) override;
+
+	private:
+		Label* addSetting(const String& name, const String& value, int y);
+
+		/** Reads all the labels into the thread, then shows the values it accepted. */
+		void updateSettings();
+
+		OwnedArray<Label> staticLabels;
+		ScopedPointer<Label> channelsLabel;
+		ScopedPointer<Label> subProcessorsLabel;
+		ScopedPointer<Label> sampleRateLabel;
+		ScopedPointer<Label> noiseLabel;
+		ScopedPointer<Label> firingRateLabel;
+		ScopedPointer<Label> seedLabel;
+
+		SimulatedThread* thread;
+
+		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SimulatedSourceEditor);
+	};
+
+}
+
+#endif  // __SIMULATEDSOURCEEDITOR_H_2A9C61F3__
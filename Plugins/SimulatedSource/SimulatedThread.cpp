@@ -0,0 +1,426 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SimulatedThread.h"
+#include "SimulatedSourceEditor.h"
+
+using namespace SimulatedSource;
+
+namespace
+{
+	const int NUM_TTL_LINES = 8;
+	// a prime, so the channels reading the table don't line up
+	const int NOISE_TABLE_SIZE = 65521;
+	// at most this many blocks per call, so the thread can exit while catching up
+	const int MAX_BLOCKS_PER_UPDATE = 16;
+
+	const double TEMPLATE_MS = 1.6;
+	const double TEMPLATE_PEAK_MS = 0.4;
+	const double REFRACTORY_MS = 2.0;
+	const double SYNC_PULSE_MS = 10.0;
+	const double GROUND_TRUTH_PULSE_MS = 1.0;
+
+	const float DELTA_UV = 40.0f;
+	const float THETA_UV = 60.0f;
+}
+
+DataThread* SimulatedThread::createDataThread(SourceNode* sn)
+{
+	return new SimulatedThread(sn);
+}
+
+SimulatedThread::SimulatedThread(SourceNode* sn) : DataThread(sn),
+	numChannels(256), numSubProcessors(1), sampleRate(30000.0f), noiseLevel(10.0f),
+	firingRate(5.0f), seed(1), blockSize(30), startTicks(0), numSamplesGenerated(0),
+	noiseTableSize(NOISE_TABLE_SIZE), templateLength(0), templatePeak(0)
+{
+	sourceBuffers.add(new DataBuffer(numChannels, 10000));
+}
+
+SimulatedThread::~SimulatedThread()
+{
+	if (isThreadRunning())
+		stopAcquisition();
+}
+
+GenericEditor* SimulatedThread::createEditor(SourceNode* sn)
+{
+	return new SimulatedSourceEditor(sn, this);
+}
+
+bool SimulatedThread::foundInputSource()
+{
+	return true;
+}
+
+unsigned int SimulatedThread::getNumSubProcessors() const
+{
+	return numSubProcessors;
+}
+
+int SimulatedThread::getNumDataOutputs(DataChannel::DataChannelTypes type, int subProcessorIdx) const
+{
+	if (subProcessorIdx >= numSubProcessors || type != DataChannel::HEADSTAGE_CHANNEL)
+		return 0;
+	return numChannels;
+}
+
+int SimulatedThread::getNumTTLOutputs(int subProcessorIdx) const
+{
+	return subProcessorIdx < numSubProcessors ? NUM_TTL_LINES : 0;
+}
+
+float SimulatedThread::getSampleRate(int subProcessorIdx) const
+{
+	return sampleRate;
+}
+
+float SimulatedThread::getBitVolts(const DataChannel* chan) const
+{
+	// samples are generated in microvolts
+	return 0.195f;
+}
+
+void SimulatedThread::resizeBuffers()
+{
+	// a quarter of a second, and at least as much as the other sources keep
+	const int bufferSize = jmax(10000, int(sampleRate / 4));
+
+	while (sourceBuffers.size() > numSubProcessors)
+		sourceBuffers.removeLast();
+	for (int i = 0; i < sourceBuffers.size(); i++)
+		sourceBuffers[i]->resize(numChannels, bufferSize);
+	while (sourceBuffers.size() < numSubProcessors)
+		sourceBuffers.add(new DataBuffer(numChannels, bufferSize));
+}
+
+void SimulatedThread::setNumChannels(int numChannels_)
+{
+	numChannels = jlimit(int(MIN_CHANNELS), int(MAX_CHANNELS), numChannels_);
+}
+
+int SimulatedThread::getNumChannels() const
+{
+	return numChannels;
+}
+
+void SimulatedThread::setNumSubProcessors(int numSubProcessors_)
+{
+	numSubProcessors = jlimit(1, int(MAX_SUBPROCESSORS), numSubProcessors_);
+}
+
+void SimulatedThread::setSampleRate(float sampleRate_)
+{
+	// below 1 kHz the spike templates would be a couple of samples long
+	if (sampleRate_ >= 1000.0f)
+		sampleRate = sampleRate_;
+}
+
+void SimulatedThread::setNoiseLevel(float microvolts)
+{
+	if (microvolts >= 0)
+		noiseLevel = microvolts;
+}
+
+float SimulatedThread::getNoiseLevel() const
+{
+	return noiseLevel;
+}
+
+void SimulatedThread::setFiringRate(float rate)
+{
+	if (rate >= 0)
+		firingRate = rate;
+}
+
+float SimulatedThread::getFiringRate() const
+{
+	return firingRate;
+}
+
+void SimulatedThread::setSeed(int seed_)
+{
+	seed = seed_;
+}
+
+int SimulatedThread::getSeed() const
+{
+	return seed;
+}
+
+float SimulatedThread::getTemplateValue(int unit, double ms) const
+{
+	// a sharp trough followed by a slower repolarisation, wider and smaller for each unit
+	const double amplitude = 120.0 - 30.0 * unit;
+	const double troughWidth = 0.12 + 0.05 * unit;
+	const double peakDelay = 0.35 + 0.1 * unit;
+	const double peakWidth = 0.25 + 0.05 * unit;
+
+	const double trough = (ms - TEMPLATE_PEAK_MS) / troughWidth;
+	const double peak = (ms - TEMPLATE_PEAK_MS - peakDelay) / peakWidth;
+	return float(-amplitude * std::exp(-trough * trough) + 0.35 * amplitude * std::exp(-peak * peak));
+}
+
+void SimulatedThread::getSpikeTemplate(int unit, Array<float>& samples) const
+{
+	samples.clearQuick();
+	const int length = roundToInt(TEMPLATE_MS * sampleRate / 1000.0);
+	for (int i = 0; i < length; i++)
+		samples.add(getTemplateValue(unit, i * 1000.0 / sampleRate));
+}
+
+int SimulatedThread::getTemplatePeak() const
+{
+	return roundToInt(TEMPLATE_PEAK_MS * sampleRate / 1000.0);
+}
+
+void SimulatedThread::buildTables()
+{
+	blockSize = jmax(1, roundToInt(sampleRate / 1000.0f));
+
+	// the table is followed by a copy of its first block, so a channel can always
+	// read a whole block from its position without wrapping
+	Random random((int64) seed);
+	noiseTable.malloc(noiseTableSize + blockSize);
+	for (int i = 0; i < noiseTableSize; i++)
+	{
+		const double u1 = 1.0 - random.nextDouble();
+		const double u2 = random.nextDouble();
+		noiseTable[i] = float(std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * double_Pi * u2));
+	}
+	for (int i = 0; i < blockSize; i++)
+		noiseTable[noiseTableSize + i] = noiseTable[i % noiseTableSize];
+
+	Array<float> unitTemplate;
+	templatePeak = getTemplatePeak();
+	templateLength = roundToInt(TEMPLATE_MS * sampleRate / 1000.0);
+	templates.malloc(UNITS_PER_GROUP * templateLength);
+	for (int u = 0; u < UNITS_PER_GROUP; u++)
+	{
+		getSpikeTemplate(u, unitTemplate);
+		FloatVectorOperations::copy(templates + u * templateLength, unitTemplate.getRawDataPointer(), templateLength);
+	}
+
+	// the LFP grows along the probe
+	lfpGain.malloc(numChannels);
+	for (int c = 0; c < numChannels; c++)
+		lfpGain[c] = 0.5f + float(c) / numChannels;
+}
+
+int64 SimulatedThread::drawInterval(Random& random) const
+{
+	const double refractory = REFRACTORY_MS * sampleRate / 1000.0;
+	if (firingRate <= 0)
+		return std::numeric_limits<int64>::max() / 2;
+
+	const double mean = sampleRate / firingRate;
+	return int64(refractory - std::log(1.0 - random.nextDouble()) * jmax(0.0, mean - refractory)) + 1;
+}
+
+void SimulatedThread::resetGenerator(Generator& gen, int subProcessor)
+{
+	gen.random.setSeed(int64(seed) * 1000003 + subProcessor + 1);
+	gen.sampleNumber = 0;
+	gen.lastCode = 0;
+	gen.activeSpikes.clearQuick();
+
+	gen.block.setSize(numChannels, blockSize);
+	gen.lfp.malloc(blockSize);
+	gen.codes.malloc(blockSize);
+
+	gen.noisePosition.malloc(numChannels);
+	for (int c = 0; c < numChannels; c++)
+		gen.noisePosition[c] = gen.random.nextInt(noiseTableSize);
+
+	// every unit is closest to one channel of its group and smaller on the others
+	const int numGroups = (numChannels + CHANNELS_PER_GROUP - 1) / CHANNELS_PER_GROUP;
+	gen.nextSpike.malloc(numGroups * UNITS_PER_GROUP);
+	gen.spikeGain.malloc(numGroups * UNITS_PER_GROUP * CHANNELS_PER_GROUP);
+	for (int i = 0; i < numGroups * UNITS_PER_GROUP; i++)
+	{
+		gen.nextSpike[i] = drawInterval(gen.random);
+		const int closest = gen.random.nextInt(CHANNELS_PER_GROUP);
+		for (int c = 0; c < CHANNELS_PER_GROUP; c++)
+			gen.spikeGain[i * CHANNELS_PER_GROUP + c] = c == closest ? 1.0f : 0.2f + 0.6f * gen.random.nextFloat();
+	}
+}
+
+void SimulatedThread::generateBlock(Generator& gen, int numSamples)
+{
+	const int64 start = gen.sampleNumber;
+	const int64 end = start + numSamples;
+
+	for (int c = 0; c < numChannels; c++)
+	{
+		int& position = gen.noisePosition[c];
+		FloatVectorOperations::copyWithMultiply(gen.block.getWritePointer(c), noiseTable + position, noiseLevel, numSamples);
+		position += numSamples;
+		if (position >= noiseTableSize)
+			position -= noiseTableSize;
+	}
+
+	for (int k = 0; k < numSamples; k++)
+	{
+		const double t = double(start + k) / sampleRate;
+		gen.lfp[k] = float(DELTA_UV * std::sin(2.0 * double_Pi * t) + THETA_UV * std::sin(2.0 * double_Pi * 8.0 * t));
+	}
+	for (int c = 0; c < numChannels; c++)
+		FloatVectorOperations::addWithMultiply(gen.block.getWritePointer(c), gen.lfp.getData(), lfpGain[c], numSamples);
+
+	const int numGroups = (numChannels + CHANNELS_PER_GROUP - 1) / CHANNELS_PER_GROUP;
+	for (int i = 0; i < numGroups * UNITS_PER_GROUP; i++)
+	{
+		while (gen.nextSpike[i] < end)
+		{
+			Spike spike;
+			spike.group = i / UNITS_PER_GROUP;
+			spike.unit = i % UNITS_PER_GROUP;
+			spike.start = gen.nextSpike[i];
+			gen.activeSpikes.add(spike);
+			gen.nextSpike[i] += drawInterval(gen.random);
+		}
+	}
+
+	// TTL line 0: 1 Hz sync train
+	const int64 period = roundToInt(sampleRate);
+	const int64 syncPulse = roundToInt(SYNC_PULSE_MS * sampleRate / 1000.0);
+	for (int k = 0; k < numSamples; k++)
+		gen.codes[k] = (start + k) % period < syncPulse ? 1 : 0;
+
+	const int groundTruthPulse = roundToInt(GROUND_TRUTH_PULSE_MS * sampleRate / 1000.0);
+	for (int i = gen.activeSpikes.size() - 1; i >= 0; i--)
+	{
+		const Spike& spike = gen.activeSpikes.getReference(i);
+		const int from = int(jmax(start, spike.start) - start);
+		const int to = int(jmin(end, spike.start + templateLength) - start);
+		const float* unitTemplate = templates + spike.unit * templateLength + (start + from - spike.start);
+		const float* gains = gen.spikeGain + (spike.group * UNITS_PER_GROUP + spike.unit) * CHANNELS_PER_GROUP;
+
+		for (int c = 0; c < CHANNELS_PER_GROUP; c++)
+		{
+			const int chan = spike.group * CHANNELS_PER_GROUP + c;
+			if (chan < numChannels && to > from)
+				FloatVectorOperations::addWithMultiply(gen.block.getWritePointer(chan, from), unitTemplate, gains[c], to - from);
+		}
+
+		// TTL line 1: ground truth for unit 0 of the first group, from its trough on
+		if (spike.group == 0 && spike.unit == 0)
+		{
+			const int64 pulseStart = spike.start + templatePeak;
+			for (int64 s = jmax(start, pulseStart); s < jmin(end, pulseStart + groundTruthPulse); s++)
+				gen.codes[s - start] |= 2;
+		}
+
+		if (spike.start + templateLength <= end)
+			gen.activeSpikes.remove(i);
+	}
+
+	gen.sampleNumber = end;
+}
+
+void SimulatedThread::writeBlock(Generator& gen, DataBuffer* buffer, int numSamples)
+{
+	// samples that don't fit are counted as dropped by the buffer stats
+	DataBuffer::WriteSpans spans;
+	const int numWritten = buffer->prepareToWrite(spans, numSamples);
+
+	int offset = 0;
+	for (int region = 0; region < 2; region++)
+	{
+		const int regionSize = spans.blockSize[region];
+		if (regionSize <= 0)
+			continue;
+
+		for (int c = 0; c < numChannels; c++)
+			FloatVectorOperations::copy(buffer->getWritePointer(spans, c, region), gen.block.getReadPointer(c, offset), regionSize);
+		offset += regionSize;
+	}
+
+	buffer->setFirstTimestamp(spans, gen.sampleNumber - numSamples);
+	for (int k = 0; k < numWritten; k++)
+	{
+		if (gen.codes[k] != gen.lastCode)
+		{
+			buffer->setEventCode(spans, k, gen.codes[k]);
+			gen.lastCode = gen.codes[k];
+		}
+	}
+	buffer->finishedWrite(spans);
+}
+
+bool SimulatedThread::startAcquisition()
+{
+	buildTables();
+
+	generators.clear();
+	for (int s = 0; s < numSubProcessors; s++)
+	{
+		Generator* gen = new Generator();
+		resetGenerator(*gen, s);
+		generators.add(gen);
+		sourceBuffers[s]->clear();
+	}
+
+	std::cout << "Simulated source: " << numSubProcessors << " x " << numChannels << " channels at "
+		<< sampleRate << " Hz, seed " << seed << std::endl;
+
+	startTicks = Time::getHighResolutionTicks();
+	numSamplesGenerated = 0;
+	startThread();
+	return true;
+}
+
+bool SimulatedThread::stopAcquisition()
+{
+	signalThreadShouldExit();
+
+	if (!waitForThreadToExit(500))
+		std::cout << "Simulated source thread failed to exit, continuing anyway..." << std::endl;
+
+	for (int s = 0; s < sourceBuffers.size(); s++)
+		sourceBuffers[s]->clear();
+	return true;
+}
+
+bool SimulatedThread::updateBuffer()
+{
+	const double elapsed = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+	const int64 due = int64(elapsed * sampleRate);
+
+	if (due - numSamplesGenerated < blockSize)
+	{
+		wait(1);
+		return true;
+	}
+
+	for (int b = 0; b < MAX_BLOCKS_PER_UPDATE && due - numSamplesGenerated >= blockSize; b++)
+	{
+		for (int s = 0; s < generators.size(); s++)
+		{
+			generateBlock(*generators[s], blockSize);
+			writeBlock(*generators[s], sourceBuffers[s], blockSize);
+		}
+		numSamplesGenerated += blockSize;
+	}
+	return true;
+}
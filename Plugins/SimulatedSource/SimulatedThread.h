@@ -0,0 +1,175 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __SIMULATEDTHREAD_H_5B8E2D74__
+#define __SIMULATEDTHREAD_H_5B8E2D74__
+
+#include <DataThreadHeaders.h>
+
+namespace SimulatedSource
+{
+
+	/**
+		Generates synthetic recordings in real time, to load test signal chains and
+		record engines at channel counts no hardware here has, and to run benchmarks
+		that give the same data every time.
+
+		Every subprocessor has the same number of channels and the same sample rate.
+		Each channel carries white noise, a common LFP (1 Hz delta and 8 Hz theta,
+		growing in amplitude along the probe) and the spikes of the units of its group
+		of four adjacent channels. Each group has UNITS_PER_GROUP units firing as Poisson
+		processes, with the templates returned by getSpikeTemplate() scaled differently
+		on each channel of the group.
+
+		TTL line 0 is a 1 Hz train of 10 ms pulses, TTL line 1 pulses for 1 ms at
+		every spike of unit 0 of the first group, as ground truth for spike detection.
+
+		The data is generated in blocks of about a millisecond and written in place
+		into the DataBuffers. With the same seed, the same samples come out on every
+		run; samples that do not fit in a full buffer are dropped rather than delayed,
+		as hardware would.
+
+		@see DataThread, DataBuffer
+	*/
+	class SimulatedThread : public DataThread
+	{
+	public:
+		SimulatedThread(SourceNode* sn);
+		~SimulatedThread();
+
+		static DataThread* createDataThread(SourceNode* sn);
+
+		GenericEditor* createEditor(SourceNode* sn) override;
+
+		bool foundInputSource() override;
+
+		unsigned int getNumSubProcessors() const override;
+		int getNumDataOutputs(DataChannel::DataChannelTypes type, int subProcessorIdx) const override;
+		int getNumTTLOutputs(int subProcessorIdx) const override;
+		float getSampleRate(int subProcessorIdx) const override;
+		float getBitVolts(const DataChannel* chan) const override;
+
+		void resizeBuffers() override;
+
+		/** The settings can only change while not acquiring. */
+		void setNumChannels(int numChannels);
+		int getNumChannels() const;
+
+		void setNumSubProcessors(int numSubProcessors);
+
+		void setSampleRate(float sampleRate);
+
+		/** Standard deviation of the noise, in microvolts. */
+		void setNoiseLevel(float microvolts);
+		float getNoiseLevel() const;
+
+		/** Mean firing rate of each unit, in Hz. */
+		void setFiringRate(float rate);
+		float getFiringRate() const;
+
+		void setSeed(int seed);
+		int getSeed() const;
+
+		static const int MIN_CHANNELS = 64;
+		static const int MAX_CHANNELS = 4096;
+		static const int MAX_SUBPROCESSORS = 8;
+		static const int CHANNELS_PER_GROUP = 4;
+		static const int UNITS_PER_GROUP = 3;
+
+		/** Fills a buffer with the template of a unit, in microvolts, at the current
+		sample rate. The peak is at sample getTemplatePeak(). The templates of unit
+		u appear on every group, scaled per channel. */
+		void getSpikeTemplate(int unit, Array<float>& samples) const;
+		int getTemplatePeak() const;
+
+	private:
+		bool updateBuffer() override;
+
+		bool startAcquisition() override;
+		bool stopAcquisition() override;
+
+		struct Spike
+		{
+			int unit;
+			int group;
+			// sample number of the first sample of the template
+			int64 start;
+		};
+
+		/** State of the generator of one subprocessor */
+		struct Generator
+		{
+			Random random;
+			int64 sampleNumber;
+			// next spike of every unit of every group, as a sample number
+			HeapBlock<int64> nextSpike;
+			// spikes whose template is not over yet
+			Array<Spike> activeSpikes;
+			HeapBlock<int> noisePosition;
+			// gain of every unit of every group on each channel of the group
+			HeapBlock<float> spikeGain;
+			uint64 lastCode;
+			AudioSampleBuffer block;
+			HeapBlock<float> lfp;
+			HeapBlock<uint64> codes;
+		};
+
+		void buildTables();
+		void resetGenerator(Generator& gen, int subProcessor);
+
+		/** Generates the next numSamples of a subprocessor into gen.block, gen.codes. */
+		void generateBlock(Generator& gen, int numSamples);
+
+		void writeBlock(Generator& gen, DataBuffer* buffer, int numSamples);
+
+		int64 drawInterval(Random& random) const;
+		float getTemplateValue(int unit, double milliseconds) const;
+
+		int numChannels;
+		int numSubProcessors;
+		float sampleRate;
+		float noiseLevel;
+		float firingRate;
+		int seed;
+
+		int blockSize;
+		int64 startTicks;
+		int64 numSamplesGenerated;
+
+		// unit-variance gaussian noise, read at a different position by each channel
+		HeapBlock<float> noiseTable;
+		int noiseTableSize;
+		// UNITS_PER_GROUP templates of templateLength samples
+		HeapBlock<float> templates;
+		int templateLength;
+		int templatePeak;
+		HeapBlock<float> lfpGain;
+
+		OwnedArray<Generator> generators;
+
+		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SimulatedThread);
+	};
+
+}
+
+#endif  // __SIMULATEDTHREAD_H_5B8E2D74__
@@ -0,0 +1,311 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SpikeBinner.h"
+#include "SpikeBinnerEditor.h"
+
+// bins the open one may lag behind the block before the timestamps are taken to have jumped
+#define MAX_BIN_LAG 16
+#define UNIT_TEXT_LENGTH 64
+
+
+SpikeBinner::SpikeBinner()
+    : GenericProcessor  ("Spike Binner")
+    , binSize           (20.0f)
+    , smoothing         (0.0f)
+    , unitsPerElectrode (4)
+    , binChannel        (nullptr)
+    , unitChannel       (nullptr)
+    , sampleRate        (30000.0f)
+    , numElectrodes     (0)
+    , numSlots          (0)
+    , mappedSlots       (-1)
+    , mappedUnitsPerElectrode (0)
+    , numUnits          (0)
+    , blockTimestamp    (0)
+    , blockSamples      (0)
+    , binStart          (-1)
+    , binSamples        (1)
+    , announceUnits     (false)
+    , numBins           (0)
+{
+    setProcessorType (PROCESSOR_TYPE_FILTER);
+}
+
+
+SpikeBinner::~SpikeBinner()
+{
+}
+
+
+AudioProcessorEditor* SpikeBinner::createEditor()
+{
+    editor = new SpikeBinnerEditor (this);
+    return editor;
+}
+
+
+int SpikeBinner::getUnitsPerElectrode() const
+{
+    return unitsPerElectrode;
+}
+
+
+int SpikeBinner::getNumUnits() const
+{
+    return numUnits;
+}
+
+
+int64 SpikeBinner::getNumBins() const
+{
+    return numBins;
+}
+
+
+void SpikeBinner::createEventChannels()
+{
+    binChannel = nullptr;
+    unitChannel = nullptr;
+
+    // every spike channel coming in is an electrode
+    numElectrodes = spikeChannelArray.size();
+    numSlots = numElectrodes * unitsPerElectrode;
+    sampleRate = dataChannelArray.size() > 0 ? dataChannelArray[0]->getSampleRate() : CoreServices::getGlobalSampleRate();
+
+    if (numSlots == 0)
+        return;
+
+    EventChannel* chan = new EventChannel (EventChannel::FLOAT_ARRAY, 1, numSlots, sampleRate, this);
+    chan->setName ("Spike counts");
+    chan->setDescription ("Spike counts of every unit in a bin, " + String (unitsPerElectrode) + " units per electrode");
+    chan->setIdentifier ("spikecounts.bin");
+    eventChannelArray.add (chan);
+    binChannel = chan;
+
+    chan = new EventChannel (EventChannel::TEXT, 1, UNIT_TEXT_LENGTH, sampleRate, this);
+    chan->setName ("Spike count units");
+    chan->setDescription ("Electrode and sorted ID counted at an index of the spike counts");
+    chan->setIdentifier ("spikecounts.unit");
+    eventChannelArray.add (chan);
+    unitChannel = chan;
+}
+
+
+void SpikeBinner::updateSettings()
+{
+    // the units keep their slots while the layout of the vector stays the same
+    if (numSlots != mappedSlots || unitsPerElectrode != mappedUnitsPerElectrode)
+    {
+        slotIds.malloc ((size_t) jmax (1, numSlots));
+        for (int i = 0; i < numSlots; ++i)
+            slotIds[i] = i % unitsPerElectrode == 0 ? 0 : -1;
+        numUnits = 0;
+        mappedSlots = numSlots;
+        mappedUnitsPerElectrode = unitsPerElectrode;
+    }
+
+    counts.allocate ((size_t) jmax (1, numSlots), true);
+    smoothed.allocate ((size_t) jmax (1, numSlots), true);
+}
+
+
+void SpikeBinner::setParameter (int parameterIndex, float newValue)
+{
+    switch (parameterIndex)
+    {
+        case BIN_SIZE:
+            binSize = jlimit (1.0f, 10000.0f, newValue);
+            break;
+        case UNITS_PER_ELECTRODE:
+            unitsPerElectrode = jlimit (1, int (MAX_UNITS_PER_ELECTRODE), int (newValue));
+            break;
+        case SMOOTHING:
+            smoothing = jmax (0.0f, newValue);
+            break;
+        default:
+            break;
+    }
+}
+
+
+bool SpikeBinner::enable()
+{
+    binStart = -1;
+    binSamples = getBinSamples();
+    numBins = 0;
+    pending.clearQuick();
+    pending.ensureStorageAllocated (1024);
+
+    if (numSlots > 0)
+    {
+        FloatVectorOperations::clear (counts, numSlots);
+        FloatVectorOperations::clear (smoothed, numSlots);
+    }
+
+    // units given a slot in an earlier acquisition
+    announceUnits = true;
+    return true;
+}
+
+
+int64 SpikeBinner::getBinSamples() const
+{
+    return jmax<int64> (1, roundToInt (binSize * sampleRate / 1000.0f));
+}
+
+
+int SpikeBinner::getUnitIndex (int electrode, uint16 sortedId)
+{
+    const int first = electrode * unitsPerElectrode;
+    if (sortedId == 0)
+        return first;
+
+    for (int slot = first + 1; slot < first + unitsPerElectrode; ++slot)
+    {
+        if (slotIds[slot] == sortedId)
+            return slot;
+
+        if (slotIds[slot] < 0)
+        {
+            slotIds[slot] = sortedId;
+            ++numUnits;
+            announceUnit (slot);
+            return slot;
+        }
+    }
+
+    // no slot left, counted with the unsorted spikes
+    return first;
+}
+
+
+void SpikeBinner::announceUnit (int slot)
+{
+    char text[UNIT_TEXT_LENGTH];
+    const int numBytes = snprintf (text, sizeof (text), "unit %d electrode %d sorted %d",
+                                   slot, slot / unitsPerElectrode, slotIds[slot]);
+
+    addTextEvent (unitChannel, blockTimestamp, text, (size_t) jlimit (0, UNIT_TEXT_LENGTH - 1, numBytes), 0);
+}
+
+
+void SpikeBinner::handleSpike (const SpikeChannel* spikeInfo, const MidiMessage& event, int)
+{
+    SpikeEventView spike (event, spikeInfo);
+    if (! spike.isValid())
+        return;
+
+    const int electrode = spikeInfo->getCurrentNodeChannelIdx();
+    if (electrode < 0 || electrode >= numElectrodes)
+        return;
+
+    const int64 timestamp = spike.getTimestamp();
+    const int unit = getUnitIndex (electrode, spike.getSortedID());
+
+    if (timestamp < binStart + binSamples)
+    {
+        counts[unit] += 1.0f;
+    }
+    else
+    {
+        PendingSpike p = { timestamp, unit };
+        pending.add (p);
+    }
+}
+
+
+void SpikeBinner::process (AudioSampleBuffer&)
+{
+    if (numSlots == 0 || dataChannelArray.size() == 0)
+        return;
+
+    blockTimestamp = getTimestamp (0);
+    blockSamples = getNumSamples (0);
+
+    // start over when playback jumps, e.g. when a File Reader seeks
+    if (binStart < 0 || blockTimestamp < binStart || blockTimestamp - binStart > MAX_BIN_LAG * binSamples)
+    {
+        binStart = blockTimestamp;
+        binSamples = getBinSamples();
+        FloatVectorOperations::clear (counts, numSlots);
+        pending.clearQuick();
+    }
+
+    if (announceUnits)
+    {
+        for (int slot = 0; slot < numSlots; ++slot)
+        {
+            if (slot % unitsPerElectrode != 0 && slotIds[slot] >= 0)
+                announceUnit (slot);
+        }
+        announceUnits = false;
+    }
+
+    checkForEvents (true);
+
+    // spikes of different electrodes don't come in time order
+    if (pending.size() > 1)
+    {
+        std::sort (pending.begin(), pending.end(),
+                   [] (const PendingSpike& a, const PendingSpike& b) { return a.timestamp < b.timestamp; });
+    }
+
+    const int64 blockEnd = blockTimestamp + blockSamples;
+    int next = 0;
+    while (binStart + binSamples <= blockEnd)
+    {
+        closeBin();
+
+        for (; next < pending.size() && pending.getReference (next).timestamp < binStart + binSamples; ++next)
+            counts[pending.getReference (next).unit] += 1.0f;
+    }
+
+    pending.removeRange (0, next);
+}
+
+
+void SpikeBinner::closeBin()
+{
+    const int64 binEnd = binStart + binSamples;
+    const float* vector = counts;
+
+    // the kernel is a decay of the past bins by the same factor, applied over the whole vector
+    const float timeConstant = smoothing;
+    if (timeConstant > 0)
+    {
+        const float decay = std::exp (-1000.0f * float (binSamples) / (timeConstant * sampleRate));
+        FloatVectorOperations::multiply (smoothed, decay, numSlots);
+        FloatVectorOperations::addWithMultiply (smoothed, counts, 1.0f - decay, numSlots);
+        vector = smoothed;
+    }
+
+    const int sampleNum = int (jlimit<int64> (0, jmax (0, blockSamples - 1), binEnd - 1 - blockTimestamp));
+    addBinaryEvent (binChannel, binStart, vector, sizeof (float) * (size_t) numSlots, sampleNum);
+
+    FloatVectorOperations::clear (counts, numSlots);
+    ++numBins;
+
+    binStart = binEnd;
+    binSamples = getBinSamples();
+}
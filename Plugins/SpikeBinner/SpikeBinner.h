@@ -0,0 +1,144 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __SPIKEBINNER_H_5E2B9C41__
+#define __SPIKEBINNER_H_5E2B9C41__
+
+#include <ProcessorHeaders.h>
+#include <atomic>
+
+/**
+    Counts the spikes of every unit in fixed time bins, for decoders that take one
+    vector of counts per bin instead of parsing every spike event.
+
+    A unit is a sorted ID on one electrode. Each electrode gets a fixed number of
+    slots in the vector: the first one counts its unsorted spikes, and the others
+    are taken by its sorted IDs in the order they are first seen. Spikes of sorted
+    IDs that find no free slot are counted with the unsorted ones. Whenever a slot
+    is taken, a text event "unit <index> electrode <electrode> sorted <id>" gives
+    the mapping.
+
+    When a bin closes its whole vector is sent as one float array event, timestamped
+    with the first sample of the bin. The counts can be smoothed first with an
+    exponential kernel, applied to the whole vector at once. Spikes that arrive after
+    their bin has closed are counted in the open one.
+
+    The bins follow the timestamps of the first continuous channel.
+
+    @see SpikeBinnerEditor
+*/
+class SpikeBinner : public GenericProcessor
+{
+public:
+    SpikeBinner();
+    ~SpikeBinner();
+
+    AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override { return true; }
+
+    void process (AudioSampleBuffer& buffer) override;
+
+    void updateSettings() override;
+
+    void setParameter (int parameterIndex, float newValue) override;
+
+    bool enable() override;
+
+    enum Parameters
+    {
+        /** Bin width in ms */
+        BIN_SIZE = 0,
+        /** Slots in the vector for each electrode, changes the event channel */
+        UNITS_PER_ELECTRODE,
+        /** Time constant of the smoothing kernel in ms, 0 for raw counts */
+        SMOOTHING
+    };
+
+    enum { MAX_UNITS_PER_ELECTRODE = 32 };
+
+    int getUnitsPerElectrode() const;
+
+    /** Number of units that have been given a slot */
+    int getNumUnits() const;
+
+    /** Number of bins sent since acquisition started */
+    int64 getNumBins() const;
+
+protected:
+    void createEventChannels() override;
+
+private:
+    void handleSpike (const SpikeChannel* spikeInfo, const MidiMessage& event, int samplePosition) override;
+
+    /** Returns the index in the vector of the unit, giving it a slot the first time */
+    int getUnitIndex (int electrode, uint16 sortedId);
+
+    /** Sends the text event giving the electrode and sorted ID of a slot */
+    void announceUnit (int slot);
+
+    /** Sends the counts of the open bin and starts the next one */
+    void closeBin();
+
+    /** Bin width in samples, at least one */
+    int64 getBinSamples() const;
+
+    std::atomic<float> binSize;
+    std::atomic<float> smoothing;
+    int unitsPerElectrode;
+
+    const EventChannel* binChannel;
+    const EventChannel* unitChannel;
+    float sampleRate;
+    int numElectrodes;
+    int numSlots;
+
+    /** For every slot, the sorted ID counted in it, or -1 while it is free. Kept
+        while numSlots and unitsPerElectrode stay at the mapped ones */
+    HeapBlock<int> slotIds;
+    int mappedSlots;
+    int mappedUnitsPerElectrode;
+    std::atomic<int> numUnits;
+
+    // audio thread state
+    HeapBlock<float> counts;
+    HeapBlock<float> smoothed;
+    int64 blockTimestamp;
+    int blockSamples;
+    int64 binStart;
+    int64 binSamples;
+    bool announceUnits;
+    std::atomic<int64> numBins;
+
+    struct PendingSpike
+    {
+        int64 timestamp;
+        int unit;
+    };
+
+    /** Spikes of the block past the end of the open bin, counted once it closes */
+    Array<PendingSpike> pending;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpikeBinner);
+};
+
+#endif  // __SPIKEBINNER_H_5E2B9C41__
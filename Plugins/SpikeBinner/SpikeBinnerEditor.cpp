@@ -0,0 +1,134 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SpikeBinnerEditor.h"
+#include "SpikeBinner.h"
+
+SpikeBinnerEditor::SpikeBinnerEditor (GenericProcessor* parentNode, bool useDefaultParameterEditors)
+    : GenericEditor (parentNode, useDefaultParameterEditors)
+    , binner (static_cast<SpikeBinner*> (parentNode))
+{
+    desiredWidth = 170;
+
+    binSizeLabel = addSetting ("Bin (ms)", "20", 10, 30, true);
+    binSizeLabel->setTooltip ("Width of the bins the spikes are counted in");
+    unitsLabel = addSetting ("Units/elec", "4", 10, 52, true);
+    unitsLabel->setTooltip ("Units counted for each electrode, the unsorted spikes included. "
+                            "Sets the length of the spike count vector");
+    smoothingLabel = addSetting ("Smooth (ms)", "0", 10, 74, true);
+    smoothingLabel->setTooltip ("Time constant of the exponential kernel smoothing the counts, 0 to send them as they are");
+
+    countedLabel = addSetting ("Counted", "-", 10, 100, false);
+}
+
+SpikeBinnerEditor::~SpikeBinnerEditor()
+{
+}
+
+Label* SpikeBinnerEditor::addSetting (const String& name, const String& value, int x, int y, bool editable)
+{
+    Label* title = new Label (name, name);
+    title->setFont (Font ("Small Text", 10, Font::plain));
+    title->setBounds (x, y, 65, 18);
+    title->setColour (Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible (title);
+    staticLabels.add (title);
+
+    Label* setting = new Label (name + " value", value);
+    setting->setFont (Font ("Small Text", 10, Font::plain));
+    setting->setColour (Label::textColourId, Colours::darkgrey);
+    setting->setBounds (x + 65, y, editable ? 60 : 85, 18);
+    if (editable)
+    {
+        setting->setEditable (true, false, false);
+        setting->addListener (this);
+        setting->setColour (Label::backgroundColourId, Colours::lightgrey);
+    }
+    addAndMakeVisible (setting);
+    return setting;
+}
+
+void SpikeBinnerEditor::labelTextChanged (Label* label)
+{
+    if (label == binSizeLabel)
+    {
+        float binSize = jlimit (1.0f, 10000.0f, label->getText().getFloatValue());
+        label->setText (String (binSize), dontSendNotification);
+        binner->setParameter (SpikeBinner::BIN_SIZE, binSize);
+    }
+    else if (label == unitsLabel)
+    {
+        int units = jlimit (1, int (SpikeBinner::MAX_UNITS_PER_ELECTRODE), label->getText().getIntValue());
+        label->setText (String (units), dontSendNotification);
+        if (units != binner->getUnitsPerElectrode())
+        {
+            // the vector changes length, so does the event channel
+            binner->setParameter (SpikeBinner::UNITS_PER_ELECTRODE, units);
+            CoreServices::updateSignalChain (this);
+        }
+    }
+    else if (label == smoothingLabel)
+    {
+        float smoothing = jmax (0.0f, label->getText().getFloatValue());
+        label->setText (String (smoothing), dontSendNotification);
+        binner->setParameter (SpikeBinner::SMOOTHING, smoothing);
+    }
+}
+
+void SpikeBinnerEditor::startAcquisition()
+{
+    unitsLabel->setEditable (false, false, false);
+}
+
+void SpikeBinnerEditor::stopAcquisition()
+{
+    unitsLabel->setEditable (true, false, false);
+}
+
+void SpikeBinnerEditor::updateFromProcessor()
+{
+    countedLabel->setText (String (binner->getNumUnits()) + " units, " + String (binner->getNumBins()) + " bins", dontSendNotification);
+}
+
+void SpikeBinnerEditor::saveCustomParameters (XmlElement* xml)
+{
+    XmlElement* info = xml->createNewChildElement ("PARAMETERS");
+
+    info->setAttribute ("Type", "SpikeBinnerEditor");
+    info->setAttribute ("BinSize", binSizeLabel->getText().getFloatValue());
+    info->setAttribute ("UnitsPerElectrode", unitsLabel->getText().getIntValue());
+    info->setAttribute ("Smoothing", smoothingLabel->getText().getFloatValue());
+}
+
+void SpikeBinnerEditor::loadCustomParameters (XmlElement* xml)
+{
+    forEachXmlChildElement (*xml, xmlNode)
+    {
+        if (xmlNode->hasTagName ("PARAMETERS"))
+        {
+            binSizeLabel->setText (String (xmlNode->getDoubleAttribute ("BinSize", 20.0)), sendNotificationSync);
+            unitsLabel->setText (String (xmlNode->getIntAttribute ("UnitsPerElectrode", 4)), sendNotificationSync);
+            smoothingLabel->setText (String (xmlNode->getDoubleAttribute ("Smoothing", 0.0)), sendNotificationSync);
+        }
+    }
+}
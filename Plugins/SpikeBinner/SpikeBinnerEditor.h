@@ -0,0 +1,69 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __SPIKEBINNEREDITOR_H_5E2B9C41__
+#define __SPIKEBINNEREDITOR_H_5E2B9C41__
+
+#include <EditorHeaders.h>
+
+class SpikeBinner;
+
+/**
+
+  User interface for the SpikeBinner processor.
+
+  Takes the bin width, the number of units per electrode and the smoothing time
+  constant, and shows the units and bins counted while acquiring.
+
+  @see SpikeBinner
+
+*/
+
+class SpikeBinnerEditor : public GenericEditor,
+    public Label::Listener
+{
+public:
+    SpikeBinnerEditor (GenericProcessor* parentNode, bool useDefaultParameterEditors = true);
+    ~SpikeBinnerEditor();
+
+    void labelTextChanged (Label* label) override;
+
+    void startAcquisition() override;
+    void stopAcquisition() override;
+    void updateFromProcessor() override;
+
+    void saveCustomParameters (XmlElement* xml) override;
+    void loadCustomParameters (XmlElement* xml) override;
+
+private:
+    Label* addSetting (const String& name, const String& value, int x, int y, bool editable);
+
+    SpikeBinner* binner;
+
+    ScopedPointer<Label> binSizeLabel, unitsLabel, smoothingLabel, countedLabel;
+    OwnedArray<Label> staticLabels;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpikeBinnerEditor);
+};
+
+#endif  // __SPIKEBINNEREDITOR_H_5E2B9C41__
@@ -0,0 +1,341 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "OfflineResorter.h"
+#include <RecordingLib.h>
+
+namespace
+{
+    // spikes classified at once by a job, like a block of spikes during acquisition
+    const int batchSize = 1024;
+}
+
+bool OfflineResorter::MappedNpy::open(const File& file, MemoryMappedFile::AccessMode mode, size_t recordBytes)
+{
+    data = nullptr;
+    numRecords = 0;
+    map = new MemoryMappedFile(file, mode);
+
+    char* bytes = static_cast<char*>(map->getData());
+    const size_t size = map->getSize();
+    if (bytes == nullptr || size < 10 || memcmp(bytes, "\x93NUMPY", 6) != 0)
+        return false;
+
+    // the header length field is 2 bytes in version 1.0 files and 4 bytes in later versions
+    const size_t headerStart = bytes[6] == 1 ? 10 : 12;
+    if (size < headerStart)
+        return false;
+    const size_t headerEnd = headerStart + (headerStart == 10 ? (uint8(bytes[8]) | (uint8(bytes[9]) << 8))
+                                                              : ByteOrder::littleEndianInt(bytes + 8));
+    if (headerEnd > size)
+        return false;
+
+    // the shape counts the records written, space after them may only be preallocated
+    const String header(bytes + headerStart, headerEnd - headerStart);
+    const int shape = header.indexOf("'shape': (");
+    if (shape < 0)
+        return false;
+
+    numRecords = jlimit(int64(0), int64((size - headerEnd) / recordBytes), header.substring(shape + 10).getLargeIntValue());
+    data = bytes + headerEnd;
+    return true;
+}
+
+class OfflineResorter::ElectrodeJob : public ThreadPoolJob
+{
+public:
+    ElectrodeJob(OfflineResorter& o, SpikeGroup& g, int e, const Array<int>& s)
+        : ThreadPoolJob("Re-sort electrode"), owner(o), group(g), electrodeIndex(e), spikes(s)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        Electrode* electrode = owner.sorter->getElectrode(electrodeIndex);
+        const SpikeChannel* channel = owner.sorter->getSpikeChannel(electrodeIndex);
+        const int numValues = channel->getNumChannels() * channel->getTotalSamples();
+
+        // the Binary format stores the waveforms in steps of the first channel's bit volts
+        const float bitVolts = channel->getChannelBitVolts(0);
+        const int16* waveforms = reinterpret_cast<const int16*>(group.waveforms.data);
+        uint16* clusters = reinterpret_cast<uint16*>(group.clusters.data);
+
+        SorterSpikePool pool;
+        pool.setCapacity(batchSize);
+        SorterSpikeArray batch;
+
+        for (int first = 0; first < spikes.size(); first += batchSize)
+        {
+            if (shouldExit())
+                break;
+
+            const int n = jmin(batchSize, spikes.size() - first);
+            batch.clearQuick();
+
+            for (int i = 0; i < n; i++)
+            {
+                SorterSpikePtr so = pool.getSpike(channel, 0);
+                const int16* recorded = waveforms + int64(spikes.getUnchecked(first + i)) * numValues;
+                float* data = so->getWritableData();
+                for (int k = 0; k < numValues; k++)
+                    data[k] = recorded[k] * bitVolts;
+                batch.add(so);
+            }
+
+            electrode->spikeSort->resortSpikes(batch, true);
+
+            int changed = 0;
+            for (int i = 0; i < n; i++)
+            {
+                uint16& sortedId = clusters[spikes.getUnchecked(first + i)];
+                if (sortedId != batch.getUnchecked(i)->sortedId)
+                {
+                    sortedId = batch.getUnchecked(i)->sortedId;
+                    changed++;
+                }
+            }
+
+            owner.numChanged += changed;
+            owner.numProcessed += n;
+        }
+
+        return jobHasFinished;
+    }
+
+private:
+    OfflineResorter& owner;
+    SpikeGroup& group;
+    const int electrodeIndex;
+    const Array<int> spikes;
+};
+
+OfflineResorter::OfflineResorter(SpikeSorter* s, const File& file)
+    : ThreadWithProgressWindow("Re-sorting recorded spikes", true, true),
+      sorter(s), structureFile(file), numSpikes(0), numElectrodes(0), numUnmatched(0), numProcessed(0), numChanged(0)
+{
+}
+
+OfflineResorter::~OfflineResorter()
+{
+}
+
+bool OfflineResorter::openGroups()
+{
+    const var structure = JSON::parse(structureFile);
+    const Array<var>* spikeFiles = structure["spikes"].getArray();
+    if (spikeFiles == nullptr || spikeFiles->size() == 0)
+    {
+        error = "No spikes in " + structureFile.getFullPathName();
+        return false;
+    }
+
+    const File spikesFolder = structureFile.getSiblingFile("spikes");
+
+    for (int i = 0; i < spikeFiles->size(); i++)
+    {
+        const var& info = spikeFiles->getReference(i);
+        const int numChannels = info["num_channels"];
+        const int numSamples = int(info["pre_peak_samples"]) + int(info["post_peak_samples"]);
+        const Array<var>* channels = info["channels"].getArray();
+        if (numChannels <= 0 || numSamples <= 0 || channels == nullptr)
+            continue;
+
+        ScopedPointer<SpikeGroup> group = new SpikeGroup();
+        group->folder = spikesFolder.getChildFile(info["folder_name"].toString());
+
+        for (int e = 0; e < channels->size(); e++)
+            group->electrodes.add(findElectrode(channels->getReference(e), numSamples));
+
+        // nothing to do in the groups of other processors
+        bool anyMatched = false;
+        for (int e = 0; e < group->electrodes.size(); e++)
+            anyMatched = anyMatched || group->electrodes[e] >= 0;
+        if (! anyMatched)
+            continue;
+
+        if (! group->waveforms.open(group->folder.getChildFile("spike_waveforms.npy"), MemoryMappedFile::readOnly, size_t(numChannels) * numSamples * sizeof(int16))
+            || ! group->electrodeIndices.open(group->folder.getChildFile("spike_electrode_indices.npy"), MemoryMappedFile::readOnly, sizeof(uint16))
+            || ! group->clusters.open(group->folder.getChildFile("spike_clusters.npy"), MemoryMappedFile::readWrite, sizeof(uint16)))
+        {
+            error = "Could not open the spike files in " + group->folder.getFullPathName();
+            return false;
+        }
+
+        group->numSpikes = jmin(group->waveforms.numRecords, group->electrodeIndices.numRecords, group->clusters.numRecords);
+        groups.add(group.release());
+    }
+
+    if (groups.size() == 0)
+    {
+        error = "No electrode of this sorter in " + structureFile.getFullPathName();
+        return false;
+    }
+
+    return true;
+}
+
+int OfflineResorter::findElectrode(const var& channel, int numSamples) const
+{
+    const Array<var>* sources = channel["source_channel_info"].getArray();
+    if (sources == nullptr)
+        return -1;
+
+    for (int i = 0; i < sorter->getNumElectrodes(); i++)
+    {
+        const SpikeChannel* spikeChannel = sorter->getSpikeChannel(i);
+        if (spikeChannel == nullptr || spikeChannel->getNumChannels() != sources->size()
+            || spikeChannel->getTotalSamples() != numSamples)
+            continue;
+
+        bool same = true;
+        for (int c = 0; c < sources->size() && same; c++)
+        {
+            const SourceChannelInfo& info = spikeChannel->getSourceChannelInfo(c);
+            const var& source = sources->getReference(c);
+            same = int(source["source_processor_id"]) == info.processorID
+                   && int(source["source_processor_sub_idx"]) == info.subProcessorID
+                   && int(source["source_processor_channel"]) == info.channelIDX;
+        }
+        if (same)
+            return i;
+    }
+    return -1;
+}
+
+void OfflineResorter::run()
+{
+    if (! openGroups())
+        return;
+
+    for (int g = 0; g < groups.size(); g++)
+        numSpikes += groups[g]->numSpikes;
+
+    ThreadPool pool(jmax(1, SystemStats::getNumCpus() - 1));
+
+    for (int g = 0; g < groups.size(); g++)
+    {
+        SpikeGroup& group = *groups[g];
+
+        // one pass over the electrode indices, which count from 1, splits the spikes by electrode
+        std::vector<Array<int>> spikesOfElectrode(group.electrodes.size() + 1);
+        const uint16* indices = reinterpret_cast<const uint16*>(group.electrodeIndices.data);
+        for (int64 i = 0; i < group.numSpikes; i++)
+        {
+            if (indices[i] < spikesOfElectrode.size())
+                spikesOfElectrode[indices[i]].add(int(i));
+        }
+
+        for (int e = 0; e < group.electrodes.size(); e++)
+        {
+            const Array<int>& spikes = spikesOfElectrode[e + 1];
+            if (spikes.size() == 0)
+                continue;
+
+            if (group.electrodes[e] < 0)
+            {
+                numUnmatched += spikes.size();
+                numProcessed += spikes.size();
+                continue;
+            }
+
+            numElectrodes++;
+            pool.addJob(new ElectrodeJob(*this, group, group.electrodes[e], spikes), true);
+        }
+    }
+
+    while (pool.getNumJobs() > 0)
+    {
+        if (threadShouldExit())
+        {
+            // the spikes done so far keep their new units
+            pool.removeAllJobs(true, 10000);
+            break;
+        }
+        setProgress(numSpikes > 0 ? double(numProcessed) / numSpikes : 1.0);
+        wait(100);
+    }
+
+    // unmapping writes the clusters back
+    for (int g = 0; g < groups.size(); g++)
+    {
+        groups[g]->waveforms.map = nullptr;
+        groups[g]->electrodeIndices.map = nullptr;
+        groups[g]->clusters.map = nullptr;
+    }
+
+    updateChecksums();
+}
+
+void OfflineResorter::updateChecksums()
+{
+    const File folder = structureFile.getParentDirectory();
+    const File manifestFile = folder.getChildFile(ChecksumManifest::getDefaultFileName());
+    if (! manifestFile.existsAsFile())
+        return;
+
+    var manifest = JSON::parse(manifestFile);
+    const Array<var>* files = manifest["files"].getArray();
+    if (files == nullptr || manifest.getDynamicObject() == nullptr)
+        return;
+
+    for (int g = 0; g < groups.size(); g++)
+    {
+        const File clustersFile = groups[g]->folder.getChildFile("spike_clusters.npy");
+        const String path = clustersFile.getRelativePathFrom(folder).replaceCharacter('\\', '/');
+
+        for (int i = 0; i < files->size(); i++)
+        {
+            DynamicObject* entry = files->getReference(i).getDynamicObject();
+            if (entry == nullptr || entry->getProperty("path").toString() != path)
+                continue;
+
+            // the rewritten part only, the file may hold preallocated space after it
+            FileChecksum checksum;
+            if (checksum.updateFromFile(clustersFile, int64(entry->getProperty("bytes"))))
+                entry->setProperty("crc32c", checksum.toString());
+        }
+    }
+
+    manifestFile.deleteFile();
+    FileOutputStream stream(manifestFile);
+    if (stream.failedToOpen())
+    {
+        std::cerr << "Error writing checksum file " << manifestFile.getFullPathName() << std::endl;
+        return;
+    }
+    manifest.getDynamicObject()->writeAsJSON(stream, 2, false);
+}
+
+String OfflineResorter::getSummary() const
+{
+    if (error.isNotEmpty())
+        return error;
+
+    String summary = "Re-sorted " + String(numProcessed - numUnmatched) + " of " + String(numSpikes)
+                     + " spikes on " + String(numElectrodes) + " electrodes, "
+                     + String(numChanged) + " changed unit.";
+    if (numUnmatched > 0)
+        summary += " " + String(numUnmatched) + " spikes of electrodes this sorter doesn't have were left as they were.";
+    return summary;
+}
@@ -0,0 +1,101 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef __OFFLINERESORTER_H_51C0E7A4__
+#define __OFFLINERESORTER_H_51C0E7A4__
+
+#include "SpikeSorter.h"
+#include <atomic>
+
+/**
+
+  Re-sorts the spikes of a Binary format recording with the current units of a
+  SpikeSorter, and rewrites their spike_clusters.npy files in place.
+
+  The waveform files are memory-mapped instead of read. Each recorded electrode is
+  matched to the electrode of the sorter whose spikes come from the same source
+  channels, and the electrodes are classified in parallel, a block of spikes at a
+  time, with SpikeSortBoxes::resortSpikes(). Spikes of electrodes the sorter no
+  longer has are left as they were. If the recording has a checksum list, the
+  entries of the rewritten files are updated.
+
+  @see SpikeSorter, BinaryRecording
+
+*/
+
+class OfflineResorter : public ThreadWithProgressWindow
+{
+public:
+    /** structureFile is the structure.oebin of the recording */
+    OfflineResorter(SpikeSorter* sorter, const File& structureFile);
+    ~OfflineResorter();
+
+    void run() override;
+
+    /** What was re-sorted, or why nothing was */
+    String getSummary() const;
+
+private:
+    class ElectrodeJob;
+
+    /** A memory-mapped .npy file of the Binary format */
+    struct MappedNpy
+    {
+        bool open(const File& file, MemoryMappedFile::AccessMode mode, size_t recordBytes);
+
+        ScopedPointer<MemoryMappedFile> map;
+        char* data;
+        int64 numRecords;
+    };
+
+    /** The files of one spike group, with the sorter electrode of each recorded one */
+    struct SpikeGroup
+    {
+        File folder;
+        MappedNpy waveforms;
+        MappedNpy electrodeIndices;
+        MappedNpy clusters;
+        int64 numSpikes;
+        Array<int> electrodes; // by index in the group, -1 if the sorter has no such electrode
+    };
+
+    bool openGroups();
+    int findElectrode(const var& channel, int numSamples) const;
+    void updateChecksums();
+
+    SpikeSorter* sorter;
+    const File structureFile;
+    OwnedArray<SpikeGroup> groups;
+
+    String error;
+    int64 numSpikes;
+    int numElectrodes;
+    int64 numUnmatched;
+    std::atomic<int64> numProcessed;
+    std::atomic<int64> numChanged;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OfflineResorter);
+};
+
+#endif  // __OFFLINERESORTER_H_51C0E7A4__
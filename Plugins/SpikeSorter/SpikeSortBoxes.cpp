@@ -157,15 +157,15 @@ bool Box::isWaveFormInside(SorterSpikePtr so)
     int BinLeft = microSecondsToSpikeTimeBin(so,x);
     int BinRight = microSecondsToSpikeTimeBin(so,x+w);
 
-    /*
-    float minValue=1e10, maxValue=1e-10;
-    for (int pt = 0; pt < so->nSamples; pt++)
-    {
-    	float v = spikeDataBinToMicrovolts(so, pt, channel);
-    	minValue = MIN(minValue,v);
-    	maxValue = MAX(maxValue,v);
-    }
-    */
+    if (BinRight <= BinLeft)
+        return false;
+
+    // the waveform can only cross an edge if it reaches the voltage range of the box
+    // somewhere in its time window, which rules out most boxes with a single vector pass
+    Range<float> range = FloatVectorOperations::findMinAndMax(so->getData() + channel * so->getChannel()->getTotalSamples() + BinLeft,
+                                                              BinRight - BinLeft + 1);
+    if (range.getStart() > y || range.getEnd() < (y - h))
+        return false;
 
     for (int pt = BinLeft; pt < BinRight; pt++)
     {
@@ -612,13 +612,41 @@ SpikeSortBoxes::SpikeSortBoxes(UniqueIDgenerator* uniqueIDgenerator_,PCAcomputin
     numChannels = numch;
     waveformLength = WaveFormLength;
 
-    pc1 = new float[numChannels * waveformLength];
-    pc2 = new float[numChannels * waveformLength];
+    pc1 = new float[numChannels * waveformLength]();
+    pc2 = new float[numChannels * waveformLength]();
     for (int n = 0; n < bufferSize; n++)
     {
 
         spikeBuffer.add(nullptr);
     }
+    resetSpikeStatistics();
+}
+
+void SpikeSortBoxes::resetSpikeStatistics()
+{
+    const int dim = numChannels * waveformLength;
+    spikeSum.assign(dim, 0.0);
+    spikeProductSum.assign(dim * dim, 0.0);
+    numBufferedSpikes = 0;
+}
+
+void SpikeSortBoxes::accumulateSpike(SorterSpikePtr so, int sign)
+{
+    const int dim = numChannels * waveformLength;
+    if (so->getChannel()->getNumChannels() * so->getChannel()->getTotalSamples() != dim)
+        return;
+
+    // only the upper triangle is kept, the PCA job mirrors it
+    const float* data = so->getData();
+    for (int i = 0; i < dim; i++)
+    {
+        const double vi = sign * (double)data[i];
+        double* row = &spikeProductSum[i * dim];
+        spikeSum[i] += vi;
+        for (int j = i; j < dim; j++)
+            row[j] += vi * data[j];
+    }
+    numBufferedSpikes += sign;
 }
 
 void SpikeSortBoxes::resizeWaveform(int numSamples)
@@ -628,13 +656,14 @@ void SpikeSortBoxes::resizeWaveform(int numSamples)
     waveformLength = numSamples;
     delete[] pc1;
     delete[] pc2;
-    pc1 = new float[numChannels * waveformLength];
-    pc2 = new float[numChannels * waveformLength];
+    pc1 = new float[numChannels * waveformLength]();
+    pc2 = new float[numChannels * waveformLength]();
     spikeBuffer.clear();
     for (int n = 0; n < bufferSize; n++)
     {
         spikeBuffer.add(nullptr);
     }
+    resetSpikeStatistics();
     bPCAcomputed = false;
     spikeBufferIndex = -1;
 	bPCAJobSubmitted = false;
@@ -861,44 +890,71 @@ void SpikeSortBoxes::getSelectedUnitAndBox(int& unitID, int& boxid)
     boxid = selectedBox;
 }
 
-void SpikeSortBoxes::projectOnPrincipalComponents(SorterSpikePtr so)
+static void projectOnComponents(SorterSpikePtr so, const float* pc1, const float* pc2, int dim)
+{
+    if (so->getChannel()->getNumChannels()*so->getChannel()->getTotalSamples() != dim)
+        return;
+
+    const float* data = so->getData();
+    float proj1 = 0, proj2 = 0;
+    for (int k = 0; k < dim; k++)
+    {
+        proj1 += pc1[k] * data[k];
+        proj2 += pc2[k] * data[k];
+    }
+    so->pcProj[0] = proj1;
+    so->pcProj[1] = proj2;
+}
+
+bool SpikeSortBoxes::bufferSpike(SorterSpikePtr so)
 {
     spikeBufferIndex++;
     spikeBufferIndex %= bufferSize;
+    // keep the sums in step with the buffer contents, so a RePCA only has to solve for the components
+    if (spikeBuffer[spikeBufferIndex] != nullptr)
+        accumulateSpike(spikeBuffer[spikeBufferIndex], -1);
     spikeBuffer.set(spikeBufferIndex, so);
+    accumulateSpike(so, 1);
     if (bPCAjobFinished)
     {
         bPCAcomputed = true;
     }
 
-    if (bPCAcomputed)
-    {
-        so->pcProj[0] = so->pcProj[1] = 0;
-        for (int k=0; k<so->getChannel()->getNumChannels()*so->getChannel()->getTotalSamples(); k++)
-        {
-            float v = spikeDataIndexToMicrovolts(so, k);
-            so->pcProj[0] += pc1[k]* v;
-            so->pcProj[1] += pc2[k]* v;
-        }
-        if (so->pcProj[0] > 1e5 || so->pcProj[0] < -1e5 || so->pcProj[1] > 1e5 || so->pcProj[1] < -1e5)
-        {
-            //int dbg = 1;
-        }
-    }
-    else
+    if (!bPCAcomputed)
     {
         // add a spike object to the buffer.
         // if we have enough spikes, start the PCA computation thread.
-        if ((spikeBufferIndex == bufferSize -1 && !bPCAcomputed && !bPCAJobSubmitted) || bRePCA)
+        if ((spikeBufferIndex == bufferSize -1 && !bPCAJobSubmitted) || bRePCA)
         {
             bPCAJobSubmitted = true;
-	    bPCAcomputed = false;
             bRePCA = false;
             // submit a new job to compute the spike buffer.
-            PCAJobPtr job = new PCAjob(spikeBuffer,pc1,pc2, pc1min, pc2min, pc1max, pc2max, bPCAjobFinished);
+            PCAJobPtr job = new PCAjob(spikeBuffer, spikeSum, spikeProductSum, numBufferedSpikes,
+                                       pc1, pc2, pc1min, pc2min, pc1max, pc2max, pcaLock, bPCAjobFinished);
             computingThread->addPCAjob(job);
         }
     }
+    return bPCAcomputed;
+}
+
+void SpikeSortBoxes::projectOnPrincipalComponents(SorterSpikePtr so)
+{
+    if (bufferSpike(so))
+        projectOnComponents(so, pc1, pc2, numChannels * waveformLength);
+}
+
+void SpikeSortBoxes::projectOnPrincipalComponents(const SorterSpikeArray& spikes)
+{
+    bool computed = false;
+    for (int i = 0; i < spikes.size(); i++)
+        computed = bufferSpike(spikes.getUnchecked(i));
+
+    // the (2 x dim) components times the (dim x spikes) block of waveforms
+    if (computed)
+    {
+        for (int i = 0; i < spikes.size(); i++)
+            projectOnComponents(spikes.getUnchecked(i), pc1, pc2, numChannels * waveformLength);
+    }
 }
 
 void SpikeSortBoxes::getPCArange(float& p1min,float& p2min, float& p1max,  float& p2max)
@@ -927,6 +983,14 @@ bool SpikeSortBoxes::isPCAfinished()
 {
     return bPCAjobFinished;
 }
+
+size_t SpikeSortBoxes::getMemorySize() const
+{
+    // the buffered spikes are those of the electrode's pool, only the references are counted here
+    return size_t(bufferSize) * sizeof(SorterSpikePtr)
+        + (spikeSum.capacity() + spikeProductSum.capacity()) * sizeof(double)
+        + 2 * size_t(numChannels) * waveformLength * sizeof(float);
+}
 void SpikeSortBoxes::RePCA()
 {
     bPCAcomputed = false;
@@ -1177,6 +1241,196 @@ void SpikeSortBoxes::updateBoxUnits(std::vector<BoxUnit> _units)
 bool SpikeSortBoxes::sortSpike(SorterSpikePtr so, bool PCAfirst)
 {
     const ScopedLock myScopedLock(mut);
+    for (int k=0; k<pcaUnits.size(); k++)
+        pcaUnits[k].prepareForSorting();
+
+    return classifySpike(so, PCAfirst);
+}
+
+// sorts a block of spikes, preparing the unit polygons once for all of them.
+// With templatesFirst, spikes go to the unit with the nearest mean waveform; the ones no
+// template accepts still go through the boxes and polygons, which is how units get seeded.
+void SpikeSortBoxes::sortSpikes(const SorterSpikeArray& spikes, bool PCAfirst, bool templatesFirst)
+{
+    const ScopedLock myScopedLock(mut);
+    for (int k=0; k<pcaUnits.size(); k++)
+        pcaUnits[k].prepareForSorting();
+
+    if (templatesFirst)
+        prepareTemplates();
+
+    for (int i = 0; i < spikes.size(); i++)
+    {
+        SorterSpikePtr so = spikes.getUnchecked(i);
+        if (!templatesFirst || !matchTemplate(so))
+            classifySpike(so, PCAfirst);
+    }
+}
+
+// Unlike sortSpikes, the units, their waveform statistics and the PCA buffer are left as they
+// are, so it can run on any thread while the sorter keeps sorting. Spikes no unit accepts get 0.
+void SpikeSortBoxes::resortSpikes(const SorterSpikeArray& spikes, bool PCAfirst)
+{
+    std::vector<BoxUnit> boxes;
+    std::vector<PCAUnit> polygons;
+    {
+        const ScopedLock myScopedLock(mut);
+        boxes = boxUnits;
+        polygons = pcaUnits;
+    }
+
+    // without components the projections, and so the polygons, mean nothing
+    const int dim = numChannels * waveformLength;
+    std::vector<float> components;
+    {
+        const ScopedLock pcaScopedLock(pcaLock);
+        if (bPCAcomputed || bPCAjobFinished)
+        {
+            components.assign(pc1, pc1 + dim);
+            components.insert(components.end(), pc2, pc2 + dim);
+        }
+    }
+    if (components.empty())
+        polygons.clear();
+
+    for (int k=0; k<polygons.size(); k++)
+        polygons[k].prepareForSorting();
+
+    for (int i = 0; i < spikes.size(); i++)
+    {
+        SorterSpikePtr so = spikes.getUnchecked(i);
+        so->sortedId = 0;
+
+        if (!components.empty())
+            projectOnComponents(so, components.data(), components.data() + dim, dim);
+
+        for (int pass = 0; pass < 2 && so->sortedId == 0; pass++)
+        {
+            if ((pass == 0) == PCAfirst)
+            {
+                for (int k=0; k<polygons.size(); k++)
+                {
+                    if (polygons[k].isWaveFormInsidePolygon(so))
+                    {
+                        so->sortedId = polygons[k].getUnitID();
+                        break;
+                    }
+                }
+            }
+            else
+            {
+                for (int k=0; k<boxes.size(); k++)
+                {
+                    if (boxes[k].isWaveFormInsideAllBoxes(so))
+                    {
+                        so->sortedId = boxes[k].getUnitID();
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void SpikeSortBoxes::prepareTemplates()
+{
+    unitTemplates.clear();
+    templateWaveforms.clear();
+
+    for (int k=0; k<boxUnits.size(); k++)
+        addUnitTemplate(boxUnits[k].WaveformStat, true, k);
+    for (int k=0; k<pcaUnits.size(); k++)
+        addUnitTemplate(pcaUnits[k].WaveformStat, false, k);
+}
+
+void SpikeSortBoxes::addUnitTemplate(const RunningStats& stats, bool isBoxUnit, int unitIndex)
+{
+    // a template needs a few spikes before its mean and spread mean anything
+    const int minSpikes = 10;
+    if (stats.numSamples < minSpikes || stats.WaveFormMean.size() != numChannels)
+        return;
+    for (int ch = 0; ch < numChannels; ch++)
+    {
+        if (stats.WaveFormMean[ch].size() != waveformLength)
+            return;
+    }
+
+    UnitTemplate t;
+    t.isBoxUnit = isBoxUnit;
+    t.unitIndex = unitIndex;
+    t.norm = 0;
+    double variance = 0;
+    for (int ch = 0; ch < numChannels; ch++)
+    {
+        for (int j = 0; j < waveformLength; j++)
+        {
+            const float m = stats.WaveFormMean[ch][j];
+            templateWaveforms.push_back(m);
+            t.norm += m * m;
+            variance += stats.WaveFormSk[ch][j] / (stats.numSamples - 1);
+        }
+    }
+    // noise adds about the summed variance to the squared distance of a member spike
+    t.limit = 2 * variance;
+    unitTemplates.push_back(t);
+}
+
+bool SpikeSortBoxes::matchTemplate(SorterSpikePtr so)
+{
+    const int dim = numChannels * waveformLength;
+    if (unitTemplates.size() == 0 || so->getChannel()->getNumChannels()*so->getChannel()->getTotalSamples() != dim)
+        return false;
+
+    const float* data = so->getData();
+    float spikeNorm = 0;
+    for (int k = 0; k < dim; k++)
+        spikeNorm += data[k] * data[k];
+
+    int best = -1;
+    float bestDistance = 0;
+    for (int t = 0; t < unitTemplates.size(); t++)
+    {
+        const float* w = &templateWaveforms[t * dim];
+        float dot = 0;
+        for (int k = 0; k < dim; k++)
+            dot += w[k] * data[k];
+
+        // |x - t|^2 = |x|^2 - 2 x.t + |t|^2, with |t|^2 computed once per block
+        const float distance = spikeNorm - 2 * dot + unitTemplates[t].norm;
+        if (distance <= unitTemplates[t].limit && (best < 0 || distance < bestDistance))
+        {
+            best = t;
+            bestDistance = distance;
+        }
+    }
+    if (best < 0)
+        return false;
+
+    // the running means keep following the units, so the templates track slow drift
+    const UnitTemplate& t = unitTemplates[best];
+    if (t.isBoxUnit)
+    {
+        BoxUnit& unit = boxUnits[t.unitIndex];
+        so->sortedId = unit.getUnitID();
+        so->color[0] = unit.ColorRGB[0];
+        so->color[1] = unit.ColorRGB[1];
+        so->color[2] = unit.ColorRGB[2];
+        unit.updateWaveform(so);
+    }
+    else
+    {
+        PCAUnit& unit = pcaUnits[t.unitIndex];
+        so->sortedId = unit.getUnitID();
+        so->color[0] = unit.ColorRGB[0];
+        so->color[1] = unit.ColorRGB[1];
+        so->color[2] = unit.ColorRGB[2];
+        unit.updateWaveform(so);
+    }
+    return true;
+}
+
+bool SpikeSortBoxes::classifySpike(SorterSpikePtr so, bool PCAfirst)
+{
     if (PCAfirst)
     {
 
@@ -1637,6 +1891,66 @@ bool cPolygon::isPointInside(PointD p)
     return inside;
 }
 
+void cPolygon::prepareEdges()
+{
+    edges.clear();
+
+    if (pts.size() < 3)
+    {
+        return;
+    }
+
+    PointD oldPoint(pts[pts.size()- 1].X + offset.X, pts[pts.size()- 1].Y + offset.Y);
+    minX = maxX = oldPoint.X;
+    minY = maxY = oldPoint.Y;
+
+    for (int i = 0; i < pts.size(); i++)
+    {
+        PointD newPoint(pts[i].X + offset.X, pts[i].Y + offset.Y);
+        const PointD& p1 = newPoint.X > oldPoint.X ? oldPoint : newPoint;
+        const PointD& p2 = newPoint.X > oldPoint.X ? newPoint : oldPoint;
+
+        Edge e;
+        e.oldX = oldPoint.X;
+        e.newX = newPoint.X;
+        e.x1 = p1.X;
+        e.y1 = p1.Y;
+        e.dx = p2.X - p1.X;
+        e.dy = p2.Y - p1.Y;
+        edges.push_back(e);
+
+        minX = jmin(minX, newPoint.X);
+        maxX = jmax(maxX, newPoint.X);
+        minY = jmin(minY, newPoint.Y);
+        maxY = jmax(maxY, newPoint.Y);
+
+        oldPoint = newPoint;
+    }
+}
+
+// same crossing test as isPointInside, on the table built by prepareEdges()
+bool cPolygon::isPointInsideEdges(PointD p) const
+{
+    if (edges.size() == 0 || p.X < minX || p.X > maxX || p.Y < minY || p.Y > maxY)
+    {
+        return false;
+    }
+
+    bool inside = false;
+
+    for (int i = 0; i < edges.size(); i++)
+    {
+        const Edge& e = edges[i];
+        if ((e.newX < p.X) == (p.X <= e.oldX)
+            && ((p.Y - e.y1) * e.dx < e.dy * (p.X - e.x1)))
+        {
+            inside = !inside;
+        }
+    }
+
+    return inside;
+}
+
 
 
 
@@ -1682,9 +1996,15 @@ bool PCAUnit::isPointInsidePolygon(PointD p)
     return poly.isPointInside(p);
 }
 
+void PCAUnit::prepareForSorting()
+{
+    poly.prepareEdges();
+}
+
+// requires prepareForSorting() after the polygon was last changed
 bool PCAUnit::isWaveFormInsidePolygon(SorterSpikePtr so)
 {
-    return poly.isPointInside(PointD(so->pcProj[0],so->pcProj[1]));
+    return poly.isPointInsideEdges(PointD(so->pcProj[0],so->pcProj[1]));
 }
 
 void PCAUnit::resizeWaveform(int newlength)
@@ -1700,32 +2020,16 @@ void PCAUnit::updateWaveform(SorterSpikePtr so)
 /***************************/
 
 
-/*
-  An implementation of SVD from Numerical Recipes in C and Mike Erhdmann's lectures
-*/
-
-
-#define SIGN(a,b) ((b) > 0.0 ? fabs(a) : - fabs(a))
-
-static double maxarg1,maxarg2;
-#define FMAX(a,b) (maxarg1 = (a),maxarg2 = (b),(maxarg1) > (maxarg2) ? (maxarg1) : (maxarg2))
-
-static int iminarg1,iminarg2;
-#define IMIN(a,b) (iminarg1 = (a),iminarg2 = (b),(iminarg1 < (iminarg2) ? (iminarg1) : iminarg2))
-
-static double sqrarg;
-#define SQR(a) ((sqrarg = (a)) == 0.0 ? 0.0 : sqrarg * sqrarg)
-
-PCAjob::PCAjob(SorterSpikeArray& _spikes, float* _pc1, float* _pc2,
-                std::atomic<float>& pc1Min,  std::atomic<float>& pc2Min,  std::atomic<float>&pc1Max,  std::atomic<float>& pc2Max, std::atomic<bool>& _reportDone) : spikes(_spikes),
-pc1min(pc1Min), pc2min(pc2Min), pc1max(pc1Max), pc2max(pc2Max), reportDone(_reportDone)
+PCAjob::PCAjob(SorterSpikeArray& _spikes, const std::vector<double>& spikeSum, const std::vector<double>& spikeProductSum, int numSpikes,
+               float* _pc1, float* _pc2, std::atomic<float>& pc1Min,  std::atomic<float>& pc2Min,  std::atomic<float>&pc1Max,  std::atomic<float>& pc2Max,
+               CriticalSection& _resultLock, std::atomic<bool>& _reportDone) : spikes(_spikes),
+pc1min(pc1Min), pc2min(pc2Min), pc1max(pc1Max), pc2max(pc2Max), resultLock(_resultLock), reportDone(_reportDone),
+sum(spikeSum), productSum(spikeProductSum), count(numSpikes)
 {
-	SorterSpikePtr spike = spikes[0];
-    cov = nullptr;
     pc1 = _pc1;
     pc2 = _pc2;
 
-    dim = spike->getChannel()->getNumChannels()*spike->getChannel()->getTotalSamples();
+    dim = sum.size();
 
 };
 
@@ -1734,384 +2038,105 @@ PCAjob::~PCAjob()
 
 }
 
-
-
-// calculates sqrt( a^2 + b^2 ) with decent precision
-float PCAjob::pythag(float a, float b)
-{
-    float absa,absb;
-
-    absa = fabs(a);
-    absb = fabs(b);
-
-    if (absa > absb)
-        return (absa * sqrt(1.0 + SQR(absb/absa)));
-    else
-        return (absb == 0.0 ? 0.0 : absb * sqrt(1.0 + SQR(absa / absb)));
-}
-
-/*
-  Modified from Numerical Recipes in C
-  Given a matrix a[nRows][nCols], svdcmp() computes its singular value
-  decomposition, A = U * W * Vt.  A is replaced by U when svdcmp
-  returns.  The diagonal matrix W is output as a vector w[nCols].
-  V (not V transpose) is output as the matrix V[nCols][nCols].
-*/
-int PCAjob::svdcmp(float** a, int nRows, int nCols, float* w, float** v)
+void PCAjob::computeCov()
 {
+    // cov[i][j] = (sum_k Xi*Xj - sum_k Xi * sum_k Xj / n) / (n-1), from the running sums of the electrode
+    cov.assign(dim * dim, 0.0);
+    if (count < 2)
+        return;
 
-    int flag, i, its, j, jj, k, l = 0, nm = 0;
-    float anorm, c, f, g, h, s, scale, x, y, z, *rv1;
-
-    rv1 = new float[nCols];
-    if (rv1 == NULL)
-    {
-        printf("svdcmp(): Unable to allocate vector\n");
-        return (-1);
-    }
-
-    g = scale = anorm = 0.0;
-    for (i = 0; i < nCols; i++)
-    {
-        l = i+1;
-        rv1[i] = scale*g;
-        g = s = scale = 0.0;
-        if (i < nRows)
-        {
-            for (k = i; k < nRows; k++)
-            {
-                //std::cout << k << " " << i << std::endl;
-                scale += fabs(a[k][i]);
-            }
-
-            if (scale)
-            {
-                for (k = i; k < nRows; k++)
-                {
-                    a[k][i] /= scale;
-                    s += a[k][i] * a[k][i];
-                }
-                f = a[i][i];
-                g = -SIGN(sqrt(s),f);
-                h = f * g - s;
-                a[i][i] = f - g;
-
-                for (j = l; j < nCols; j++)
-                {
-                    for (s = 0.0, k = i; k < nRows; k++) s += a[k][i] * a[k][j];
-                    f = s / h;
-                    for (k = i; k < nRows; k++) a[k][j] += f * a[k][i];
-                }
-
-                for (k = i; k < nRows; k++)
-                    a[k][i] *= scale;
-            } // end if (scale)
-        } // end if (i < nRows)
-        w[i] = scale * g;
-        g = s = scale = 0.0;
-        if (i < nRows && i != nCols-1)
-        {
-            for (k = l; k < nCols; k++) scale += fabs(a[i][k]);
-            if (scale)
-            {
-                for (k = l; k < nCols; k++)
-                {
-                    a[i][k] /= scale;
-                    s += a[i][k] * a[i][k];
-                }
-                f = a[i][l];
-                g = - SIGN(sqrt(s),f);
-                h = f * g - s;
-                a[i][l] = f - g;
-                for (k=l; k<nCols; k++) rv1[k] = a[i][k] / h;
-                for (j=l; j<nRows; j++)
-                {
-                    for (s=0.0,k=l; k<nCols; k++) s += a[j][k] * a[i][k];
-                    for (k=l; k<nCols; k++) a[j][k] += s * rv1[k];
-                }
-                for (k=l; k<nCols; k++) a[i][k] *= scale;
-            }
-        }
-        anorm = FMAX(anorm, (fabs(w[i]) + fabs(rv1[i])));
-
-
-    }
-
-    for (i=nCols-1; i>=0; i--)
-    {
-        if (i < nCols-1)
-        {
-            if (g)
-            {
-                for (j=l; j<nCols; j++)
-                    v[j][i] = (a[i][j] / a[i][l]) / g;
-                for (j=l; j<nCols; j++)
-                {
-                    for (s=0.0,k=l; k<nCols; k++) s += a[i][k] * v[k][j];
-                    for (k=l; k<nCols; k++) v[k][j] += s * v[k][i];
-                }
-            }
-            for (j=l; j<nCols; j++) v[i][j] = v[j][i] = 0.0;
-        }
-        v[i][i] = 1.0;
-        g = rv1[i];
-        l = i;
-    }
-
-    for (i=IMIN(nRows,nCols) - 1; i >= 0; i--)
+    for (int i = 0; i < dim; i++)
     {
-        l = i + 1;
-        g = w[i];
-        for (j=l; j<nCols; j++) a[i][j] = 0.0;
-        if (g)
+        for (int j = i; j < dim; j++)
         {
-            g = 1.0 / g;
-            for (j=l; j<nCols; j++)
-            {
-                for (s=0.0,k=l; k<nRows; k++) s += a[k][i] * a[k][j];
-                f = (s / a[i][i]) * g;
-                for (k=i; k<nRows; k++) a[k][j] += f * a[k][i];
-            }
-            for (j=i; j<nRows; j++) a[j][i] *= g;
+            double c = (productSum[i * dim + j] - sum[i] * sum[j] / count) / (count - 1);
+            cov[i * dim + j] = c;
+            cov[j * dim + i] = c;
         }
-        else
-            for (j=i; j<nRows; j++) a[j][i] = 0.0;
-        ++a[i][i];
     }
+}
 
-    for (k=nCols-1; k>=0; k--)
+static double normalize(std::vector<double>& v)
+{
+    double norm = 0;
+    for (int k = 0; k < v.size(); k++)
+        norm += v[k] * v[k];
+    norm = sqrt(norm);
+    if (norm > 0)
     {
-        for (its=0; its<30; its++)
-        {
-            flag = 1;
-            for (l=k; l>=0; l--)
-            {
-                nm = l-1;
-                if ((fabs(rv1[l]) + anorm) == anorm)
-                {
-                    flag =  0;
-                    break;
-                }
-                if ((fabs(w[nm]) + anorm) == anorm) break;
-            }
-            if (flag)
-            {
-                c = 0.0;
-                s = 1.0;
-                for (i=l; i<=k; i++)
-                {
-                    f = s * rv1[i];
-                    rv1[i] = c * rv1[i];
-                    if ((fabs(f) + anorm) == anorm) break;
-                    g = w[i];
-                    h = pythag(f,g);
-                    w[i] = h;
-                    h = 1.0 / h;
-                    c = g * h;
-                    s = -f * h;
-                    for (j=0; j<nRows; j++)
-                    {
-                        y = a[j][nm];
-                        z = a[j][i];
-                        a[j][nm] = y * c + z * s;
-                        a[j][i] = z * c - y * s;
-                    }
-                }
-            }
-            z = w[k];
-            if (l == k)
-            {
-                if (z < 0.0)
-                {
-                    w[k] = -z;
-                    for (j=0; j<nCols; j++) v[j][k] = -v[j][k];
-                }
-                break;
-            }
-            //if(its == 29) printf("no convergence in 30 svdcmp iterations\n");
-            x = w[l];
-            nm = k-1;
-            y = w[nm];
-            g = rv1[nm];
-            h = rv1[k];
-            f = ((y - z) * (y + z) + (g - h) * (g + h)) / (2.0 * h * y);
-            g = pythag(f,1.0);
-            f = ((x - z) * (x + z) + h * ((y / (f + SIGN(g,f))) - h)) / x;
-            c = s = 1.0;
-            for (j=l; j<=nm; j++)
-            {
-                i = j+1;
-                g = rv1[i];
-                y = w[i];
-                h = s * g;
-                g = c * g;
-                z = pythag(f,h);
-                rv1[j] = z;
-                c = f/z;
-                s = h/z;
-                f = x * c + g * s;
-                g = g * c - x * s;
-                h = y * s;
-                y *= c;
-                for (jj=0; jj<nCols; jj++)
-                {
-                    x = v[jj][j];
-                    z = v[jj][i];
-                    v[jj][j] = x * c + z * s;
-                    v[jj][i] = z * c - x * s;
-                }
-                z = pythag(f,h);
-                w[j] = z;
-                if (z)
-                {
-                    z = 1.0 / z;
-                    c = f * z;
-                    s = h * z;
-                }
-                f = c * g + s * y;
-                x = c * y - s * g;
-                for (jj=0; jj < nRows; jj++)
-                {
-                    y = a[jj][j];
-                    z = a[jj][i];
-                    a[jj][j] = y * c + z * s;
-                    a[jj][i] = z * c - y * s;
-                }
-            }
-            rv1[l] = 0.0;
-            rv1[k] = f;
-            w[k] = x;
-        }
+        for (int k = 0; k < v.size(); k++)
+            v[k] /= norm;
     }
-
-    delete[] rv1;
-
-    return (0);
+    return norm;
 }
 
-
-void PCAjob::computeCov()
+void PCAjob::computePrincipalComponents()
 {
-    // allocate and zero
-    cov = new float*[dim];
-    float* mean  = new float[dim];
-    for (int k = 0; k < dim; k++)
-    {
-        cov[k] = new float[dim];
-        for (int j=0; j<dim; j++)
-        {
-            cov[k][j] = 0;
-        }
-    }
-    // compute mean
+    if (count < 2)
+        return;
 
-    for (int j=0; j<dim; j++)
+    // Only the two leading eigenvectors are needed, so instead of a full decomposition
+    // iterate the covariance on a pair of vectors, keeping the second orthogonal to the first.
+    std::vector<double> u(dim), v(dim), cu(dim), cv(dim);
+    Random rng(dim);
+    for (int k = 0; k < dim; k++)
     {
-        mean[j] = 0;
-        for (int i=0; i<spikes.size(); i++)
-        {
-            SorterSpikePtr spike = spikes[i];
-            float v = spikeDataIndexToMicrovolts(spike, j) ;
-            mean[j] += v / dim;
-        }
+        u[k] = rng.nextDouble() - 0.5;
+        v[k] = rng.nextDouble() - 0.5;
     }
-    // aggregate
-
+    normalize(u);
 
-    for (int i=0; i<dim; i++)
+    const int maxIterations = 500;
+    for (int it = 0; it < maxIterations; it++)
     {
-        for (int j=i; j<dim; j++)
+        for (int i = 0; i < dim; i++)
         {
-            // cov[i][j] = sum_k[ (X(i,:)) * (Xj-mue(j) ]
-            float sum = 0 ;
-            for (int k=0; k<spikes.size(); k++)
+            const double* row = &cov[i * dim];
+            double su = 0, sv = 0;
+            for (int j = 0; j < dim; j++)
             {
-
-                SorterSpikePtr spike = spikes[k];
-                float vi = spikeDataIndexToMicrovolts(spike, i);
-                float vj = spikeDataIndexToMicrovolts(spike, j);
-                sum += (vi-mean[i]) * (vj-mean[j]);
+                su += row[j] * u[j];
+                sv += row[j] * v[j];
             }
-            cov[i][j] = sum / (dim-1);
-            cov[j][i] = sum / (dim-1);
+            cu[i] = su;
+            cv[i] = sv;
         }
-    }
-    delete[] mean;
-
-    // delete covariances
-    //for (int k = 0; k < dim; k++)
-    //delete cov[k];
-
-    //delete(cov);
-    //cov = nullptr;
-
-}
-
-std::vector<int> sort_indexes(std::vector<float> v)
-{
-    // initialize original index locations
-    std::vector<int> idx(v.size());
-
-    for (int i = 0; i != idx.size(); ++i)
-    {
-        idx[i] = i;
-    }
-
-    //sort indexes based on comparing values in v
-    sort(
-        idx.begin(),
-        idx.end()//,
-        //[&v](size_t i1, size_t i2)
-        //{
-        //	return v[i1] > v[i2];
-        //}
-    );
-
-    return idx;
-}
-
-void PCAjob::computeSVD()
-{
-
+        if (normalize(cu) == 0)
+            break;
 
-    float** eigvec, *sigvalues;
-    sigvalues = new float[dim];
+        double proj = 0;
+        for (int k = 0; k < dim; k++)
+            proj += cv[k] * cu[k];
+        for (int k = 0; k < dim; k++)
+            cv[k] -= proj * cu[k];
+        normalize(cv);
 
-    eigvec = new float*[dim];
-    for (int k = 0; k < dim; k++)
-    {
-        eigvec[k] = new float[dim];
-        for (int j=0; j<dim; j++)
+        double du = 0, dv = 0;
+        for (int k = 0; k < dim; k++)
         {
-            eigvec[k][j] = 0;
+            du += cu[k] * u[k];
+            dv += cv[k] * v[k];
         }
+        u.swap(cu);
+        v.swap(cv);
+        if (fabs(du) > 1 - 1e-9 && fabs(dv) > 1 - 1e-9)
+            break;
     }
 
-    svdcmp(cov, dim, dim, sigvalues, eigvec);
-
-    std::vector<float> sig;
-    sig.resize(dim);
-    for (int k = 0; k < dim; k++)
-        sig[k] = sigvalues[k];
-
-    std::vector<int> sortind = sort_indexes(sig);
-
-    for (int k = 0; k < dim; k++)
-    {
-        pc1[k] = eigvec[k][sortind[0]];
-        pc2[k] = eigvec[k][sortind[1]];
-    }
     // project samples to find the display range
     float min1 = 1e10, min2 = 1e10, max1 = -1e10, max2 = -1e10;
 
     for (int j = 0; j < spikes.size(); j++)
     {
+        SorterSpikePtr spike = spikes[j];
+        if (spike == nullptr || spike->getChannel()->getNumChannels()*spike->getChannel()->getTotalSamples() != dim)
+            continue;
+
         float sum1 = 0, sum2=0;
         for (int k = 0; k < dim; k++)
         {
-            SorterSpikePtr spike = spikes[j];
-            sum1 += spikeDataIndexToMicrovolts(spike,k) * pc1[k];
-            sum2 += spikeDataIndexToMicrovolts(spike,k) * pc2[k];
+            sum1 += spikeDataIndexToMicrovolts(spike,k) * u[k];
+            sum2 += spikeDataIndexToMicrovolts(spike,k) * v[k];
         }
         if (sum1 < min1)
             min1 = sum1;
@@ -2123,69 +2148,54 @@ void PCAjob::computeSVD()
             max2 = sum2;
     }
 
+    const ScopedLock myScopedLock(resultLock);
+    for (int k = 0; k < dim; k++)
+    {
+        pc1[k] = u[k];
+        pc2[k] = v[k];
+    }
 
     pc1min = min1 - 1.5 * (max1-min1);
     pc2min = min2 - 1.5 * (max2-min2);
     pc1max = max1 + 1.5 * (max1-min1);
     pc2max = max2 + 1.5 * (max2-min2);
-
-    // clear memory
-    for (int k = 0; k < dim; k++)
-    {
-        delete[] eigvec[k];
-    }
-    delete[] eigvec;
-    delete[] sigvalues;
-
-    // delete covariances
-    for (int k = 0; k < dim; k++)
-        delete[] cov[k];
-
-    delete[] cov;
-    cov = nullptr;
-
 }
 
 
 /**********************/
 
-
-void PCAcomputingThread::addPCAjob(PCAJobPtr job)
+class PCAcomputingThread::Job : public ThreadPoolJob
 {
-	{
-		ScopedLock critical(lock);
-		jobs.add(job);
-	}
-	
-    if (!isThreadRunning())
-    {
-        startThread();
-    }
-}
+public:
+    Job(PCAJobPtr j) : ThreadPoolJob("PCA"), job(j) {}
 
-void PCAcomputingThread::run()
-{
-    while (jobs.size() > 0)
+    JobStatus runJob() override
     {
-		lock.enter();
-        PCAJobPtr J = jobs.removeAndReturn(0);
-	if (J == nullptr) continue;
-		lock.exit();
+        // the pool's threads are shared by all jobs, so each job sets them up again
+        ThreadPolicy::applyToCurrentThread(ThreadPolicy::Compute);
+
         // compute PCA
-        // 1. Compute Covariance matrix
-        // 2. Apply SVD on covariance matrix
-        // 3. Extract the two principal components corresponding to the largest singular values
+        // 1. Compute Covariance matrix from the electrode's running sums
+        // 2. Extract the two principal components corresponding to the largest eigenvalues
+        job->computeCov();
+        job->computePrincipalComponents();
+
+        // 3. Report to the spike sorting electrode that PCA is finished
+        job->reportDone = true;
+        return jobHasFinished;
+    }
 
-        J->computeCov();
-        J->computeSVD();
+private:
+    PCAJobPtr job;
+};
 
-        // 4. Report to the spike sorting electrode that PCA is finished
-        J->reportDone = true;
-    }
+void PCAcomputingThread::addPCAjob(PCAJobPtr job)
+{
+    pool.addJob(new Job(job), true);
 }
 
 
-PCAcomputingThread::PCAcomputingThread() : Thread("PCA")
+PCAcomputingThread::PCAcomputingThread() : pool(jmax(1, SystemStats::getNumCpus() / 2))
 {
 
 }
@@ -2225,20 +2235,41 @@ int microSecondsToSpikeTimeBin(SorterSpikePtr s, float t, int ch)
 
 
 SorterSpikeContainer::SorterSpikeContainer(const SpikeChannel* channel, SpikeEvent::SpikeBuffer& spikedata, int64 timestamp)
+	: SorterSpikeContainer(channel, timestamp)
+{
+	memcpy(samples, spikedata.getRawPointer(), chan->getNumChannels() * chan->getTotalSamples() * sizeof(float));
+}
+
+SorterSpikeContainer::SorterSpikeContainer(const SpikeChannel* channel, int64 timestamp)
+{
+	data.malloc(channel->getNumChannels() * channel->getTotalSamples());
+	samples = data.getData();
+	reset(channel, timestamp);
+}
+
+SorterSpikeContainer::SorterSpikeContainer(SorterSpikeStorage* storage_, float* samples_)
+	: storage(storage_), samples(samples_)
+{
+	reset(nullptr, 0);
+}
+
+void SorterSpikeContainer::reset(const SpikeChannel* channel, int64 timestamp_)
 {
 	color[0] = color[1] = color[2] = 127;
 	pcProj[0] = pcProj[1] = 0;
 	sortedId = 0;
-	this->timestamp = timestamp;
+	timestamp = timestamp_;
 	chan = channel;
-	int nSamples = chan->getNumChannels() * chan->getTotalSamples();
-	data.malloc(nSamples);
-	memcpy(data.getData(), spikedata.getRawPointer(), nSamples*sizeof(float));
 }
 
 const float* SorterSpikeContainer::getData() const
 {
-	return data.getData();
+	return samples;
+}
+
+float* SorterSpikeContainer::getWritableData()
+{
+	return samples;
 }
 
 const SpikeChannel* SorterSpikeContainer::getChannel() const
@@ -2250,3 +2281,58 @@ int64 SorterSpikeContainer::getTimestamp() const
 {
 	return timestamp;
 }
+
+
+SorterSpikePool::SorterSpikePool() : capacity(1024), numValues(0), nextSpike(0)
+{
+}
+
+void SorterSpikePool::setCapacity(int numSpikes)
+{
+	capacity = jmax(1, numSpikes);
+	// the block is rebuilt on the next spike; spikes still held elsewhere keep the old one
+	spikes.clear();
+	storage = nullptr;
+	numValues = 0;
+}
+
+int SorterSpikePool::getCapacity() const
+{
+	return capacity;
+}
+
+size_t SorterSpikePool::getMemorySize() const
+{
+	return size_t(spikes.size()) * (sizeof(SorterSpikeContainer) + numValues * sizeof(float));
+}
+
+SorterSpikePtr SorterSpikePool::getSpike(const SpikeChannel* channel, int64 timestamp)
+{
+	const int n = channel->getNumChannels() * channel->getTotalSamples();
+	if (n != numValues)
+	{
+		numValues = n;
+		nextSpike = 0;
+		spikes.clear();
+		storage = new SorterSpikeStorage();
+		storage->data.malloc(capacity * n);
+		for (int k = 0; k < capacity; k++)
+			spikes.add(new SorterSpikeContainer(storage, storage->data + k * n));
+	}
+
+	// spikes are released roughly in the order they were handed out, so the
+	// one after the last is almost always free
+	for (int k = 0; k < capacity; k++)
+	{
+		SorterSpikeContainer* spike = spikes.getObjectPointerUnchecked(nextSpike);
+		nextSpike = (nextSpike + 1) % capacity;
+		if (spike->getReferenceCount() == 1)
+		{
+			spike->reset(channel, timestamp);
+			return spike;
+		}
+	}
+
+	// every pooled spike is still buffered or displayed somewhere
+	return new SorterSpikeContainer(channel, timestamp);
+}
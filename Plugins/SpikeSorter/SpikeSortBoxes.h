@@ -30,27 +30,62 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <queue>
 #include <atomic>
 
+// Contiguous waveform storage shared by the spikes of a SorterSpikePool
+class SorterSpikeStorage : public ReferenceCountedObject
+{
+public:
+	HeapBlock<float> data;
+};
+
 class SorterSpikeContainer : public ReferenceCountedObject
 {
+	friend class SorterSpikePool;
 public:
 	//This invalidates the original SpikeEventPtr, so be careful
 	SorterSpikeContainer(const SpikeChannel* channel, SpikeEvent::SpikeBuffer& data, int64 timestamp);
 	SorterSpikeContainer() = delete;
 
 	const float* getData() const;
+	// for filling in the waveform of a spike obtained from a SorterSpikePool
+	float* getWritableData();
 	const SpikeChannel* getChannel() const;
 	int64 getTimestamp() const;
 	uint8 color[3];
 	float pcProj[2];
 	uint16 sortedId;
 private:
+	SorterSpikeContainer(const SpikeChannel* channel, int64 timestamp);
+	SorterSpikeContainer(SorterSpikeStorage* storage, float* samples);
+	void reset(const SpikeChannel* channel, int64 timestamp);
+
 	int64 timestamp;
 	HeapBlock<float> data;
+	ReferenceCountedObjectPtr<SorterSpikeStorage> storage; // keeps the block of a pooled spike alive
+	float* samples;
 	const SpikeChannel* chan;
 };
 typedef ReferenceCountedObjectPtr<SorterSpikeContainer> SorterSpikePtr;
 typedef ReferenceCountedArray<SorterSpikeContainer, CriticalSection> SorterSpikeArray;
 
+// A fixed number of spike containers for one electrode, with their waveforms in one
+// contiguous block. A container is handed out again as soon as only the pool still
+// references it, so sorting does not allocate per spike and memory stays bounded.
+class SorterSpikePool
+{
+public:
+	SorterSpikePool();
+	void setCapacity(int numSpikes);
+	int getCapacity() const;
+	// bytes of the containers and their waveforms
+	size_t getMemorySize() const;
+	// returns a cleared spike whose waveform is to be written through getWritableData()
+	SorterSpikePtr getSpike(const SpikeChannel* channel, int64 timestamp);
+private:
+	ReferenceCountedArray<SorterSpikeContainer> spikes;
+	ReferenceCountedObjectPtr<SorterSpikeStorage> storage;
+	int capacity, numValues, nextSpike;
+};
+
 class PCAcomputingThread;
 class UniqueIDgenerator;
 class PointD
@@ -180,47 +215,59 @@ PCAjob();
 class PCAjob : public ReferenceCountedObject
 {
 public:
-    PCAjob(SorterSpikeArray& _spikes, float* _pc1, float* _pc2,
-           std::atomic<float>&,  std::atomic<float>&,  std::atomic<float>&,  std::atomic<float>&, std::atomic<bool>& _reportDone);
+    PCAjob(SorterSpikeArray& _spikes, const std::vector<double>& spikeSum, const std::vector<double>& spikeProductSum, int numSpikes,
+           float* _pc1, float* _pc2, std::atomic<float>&,  std::atomic<float>&,  std::atomic<float>&,  std::atomic<float>&,
+           CriticalSection& _resultLock, std::atomic<bool>& _reportDone);
     ~PCAjob();
     void computeCov();
-    void computeSVD();
+    void computePrincipalComponents();
 
-    float** cov;
+    std::vector<double> cov;
     SorterSpikeArray spikes;
     float* pc1, *pc2;
     std::atomic<float>& pc1min, &pc2min, &pc1max, &pc2max;
+    CriticalSection& resultLock;
     std::atomic<bool>& reportDone;
 private:
-    int svdcmp(float** a, int nRows, int nCols, float* w, float** v);
-    float pythag(float a, float b);
+    std::vector<double> sum, productSum;
+    int count;
     int dim;
 };
 
 typedef ReferenceCountedObjectPtr<PCAjob> PCAJobPtr;
-typedef ReferenceCountedArray<PCAjob, CriticalSection> PCAJobArray;
 
 class cPolygon
 {
 public:
     cPolygon();
     bool isPointInside(PointD p);
+    // builds the edge table used by isPointInsideEdges, once for a batch of points
+    void prepareEdges();
+    bool isPointInsideEdges(PointD p) const;
     std::vector<PointD> pts;
     PointD offset;
+private:
+    struct Edge
+    {
+        float oldX, newX; // vertex order, for the crossing condition
+        float x1, y1, dx, dy; // left end point and extent
+    };
+    std::vector<Edge> edges;
+    float minX, minY, maxX, maxY;
 };
 
 
 
-class PCAcomputingThread : juce::Thread
+// Runs the PCA jobs of several electrodes concurrently on a small pool of background threads.
+class PCAcomputingThread
 {
 public:
     PCAcomputingThread();
-    void run(); // computes PCA on waveforms
     void addPCAjob(PCAJobPtr job);
 
 private:
-    PCAJobArray jobs;
-	CriticalSection lock;
+    class Job;
+    ThreadPool pool;
 };
 
 class PCAUnit
@@ -230,6 +277,7 @@ public:
     PCAUnit(int ID, int localID);
     PCAUnit(cPolygon B, int ID, int localID_);
     ~PCAUnit();
+    void prepareForSorting();
     int getUnitID();
     int getLocalID();
 	bool isWaveFormInsidePolygon(SorterSpikePtr so);
@@ -260,7 +308,11 @@ public:
 
 
 	void projectOnPrincipalComponents(SorterSpikePtr so);
+	void projectOnPrincipalComponents(const SorterSpikeArray& spikes);
 	bool sortSpike(SorterSpikePtr so, bool PCAfirst);
+	void sortSpikes(const SorterSpikeArray& spikes, bool PCAfirst, bool templatesFirst = false);
+	// classifies spikes read back from a recording with a copy of the current units, see OfflineResorter
+	void resortSpikes(const SorterSpikeArray& spikes, bool PCAfirst);
     void RePCA();
     void addPCAunit(PCAUnit unit);
     int addBoxUnit(int channel);
@@ -270,6 +322,8 @@ public:
     void setPCArange(float p1min,float p2min, float p1max,  float p2max);
     void resetJobStatus();
     bool isPCAfinished();
+    // bytes of the spike history kept for the PCA, its running sums and the components
+    size_t getMemorySize() const;
 
     bool removeUnit(int unitID);
 
@@ -293,6 +347,13 @@ public:
     void saveCustomParametersToXml(XmlElement* electrodeNode);
     void loadCustomParametersFromXml(XmlElement* electrodeNode);
 private:
+    void resetSpikeStatistics();
+    void accumulateSpike(SorterSpikePtr so, int sign);
+    bool bufferSpike(SorterSpikePtr so);
+    bool classifySpike(SorterSpikePtr so, bool PCAfirst);
+    void prepareTemplates();
+    void addUnitTemplate(const RunningStats& stats, bool isBoxUnit, int unitIndex);
+    bool matchTemplate(SorterSpikePtr so);
     //void  StartCriticalSection();
     //void  EndCriticalSection();
     UniqueIDgenerator* uniqueIDgenerator;
@@ -305,6 +366,20 @@ private:
     std::atomic<float> pc1min, pc2min, pc1max, pc2max;
     SorterSpikeArray spikeBuffer;
     int bufferSize,spikeBufferIndex;
+    // running sums over the buffered spikes, so that a PCA job does not have to rebuild the covariance
+    std::vector<double> spikeSum, spikeProductSum;
+    int numBufferedSpikes;
+    CriticalSection pcaLock;
+    // mean waveforms of the units with enough spikes, rebuilt for each block when matching templates
+    struct UnitTemplate
+    {
+        bool isBoxUnit;
+        int unitIndex;
+        float norm; // squared norm of the mean waveform
+        float limit; // largest squared distance still assigned to the unit
+    };
+    std::vector<UnitTemplate> unitTemplates;
+    std::vector<float> templateWaveforms;
     PCAcomputingThread* computingThread;
     bool bPCAJobSubmitted,bPCAcomputed,bRePCA;
     std::atomic<bool> bPCAjobFinished ;
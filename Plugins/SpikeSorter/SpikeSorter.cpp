@@ -28,9 +28,74 @@
 
 class spikeSorter;
 
+namespace
+{
+    // samples kept on both sides of a detected waveform, so it can be shifted by up to a sample
+    const int alignmentMargin = 3;
+    // steps per sample at which the interpolated peak is searched
+    const int upsampling = 8;
+    // spikes of an electrode that can wait between the audio and the sorting thread
+    const int queueLength = 512;
+
+    // Catmull-Rom interpolation between x[i] and x[i + 1], at fraction f
+    inline float interpolate(const float* x, int i, float f)
+    {
+        const float p0 = x[i - 1], p1 = x[i], p2 = x[i + 1], p3 = x[i + 2];
+        return p1 + 0.5f * f * (p2 - p0 + f * (2 * p0 - 5 * p1 + 4 * p2 - p3 + f * (3 * (p1 - p2) + p3 - p0)));
+    }
+
+    // Resamples the waveforms of a spike detected at a whole sample so that its peak, searched
+    // for at a finer step on the cubic interpolation of the channel where it is largest, falls
+    // exactly on the peak sample. The snippets have alignmentMargin extra samples on both sides.
+    void alignWaveforms(const float* snippets, int numChannels, int spikeLength, int peak, float* aligned)
+    {
+        const int snippetLength = spikeLength + 2 * alignmentMargin;
+        const int centre = alignmentMargin + peak;
+
+        int alignmentChannel = 0;
+        for (int c = 1; c < numChannels; c++)
+        {
+            if (std::abs(snippets[c * snippetLength + centre]) > std::abs(snippets[alignmentChannel * snippetLength + centre]))
+                alignmentChannel = c;
+        }
+
+        const float* x = snippets + alignmentChannel * snippetLength;
+        const float sign = x[centre] < 0 ? -1.0f : 1.0f;
+        float shift = 0;
+        float peakValue = sign * x[centre];
+
+        for (int k = 1 - upsampling; k < upsampling; k++)
+        {
+            const float t = float(k) / upsampling;
+            const float value = k < 0 ? sign * interpolate(x, centre - 1, 1 + t) : sign * interpolate(x, centre, t);
+            if (k != 0 && value > peakValue)
+            {
+                peakValue = value;
+                shift = t;
+            }
+        }
+
+        const int whole = shift < 0 ? -1 : 0;
+        const float f = shift - whole;
+
+        for (int c = 0; c < numChannels; c++)
+        {
+            const float* source = snippets + c * snippetLength + alignmentMargin + whole;
+            float* dest = aligned + c * spikeLength;
+
+            if (shift == 0)
+                memcpy(dest, source, spikeLength * sizeof(float));
+            else
+                for (int s = 0; s < spikeLength; s++)
+                    dest[s] = interpolate(source, s, f);
+        }
+    }
+}
+
 SpikeSorter::SpikeSorter()
     : GenericProcessor("Spike Sorter"),
-      overflowBuffer(2,100), dataBuffer(nullptr),
+      Thread("Spike sorting"),
+      dataBuffer(nullptr),
       overflowBufferSize(100), currentElectrode(-1),
       numPreSamples(8),numPostSamples(32)
 {
@@ -46,7 +111,20 @@ SpikeSorter::SpikeSorter()
     PCAbeforeBoxes = true;
     autoDACassignment = false;
     syncThresholds = false;
+    autoThreshold = 0;
     flipSignal = false;
+    templateMatching = false;
+    spikeHistorySize = 1024;
+}
+
+bool SpikeSorter::getTemplateMatchingState()
+{
+    return templateMatching;
+}
+
+void SpikeSorter::setTemplateMatchingState(bool state)
+{
+    templateMatching = state;
 }
 
 bool SpikeSorter::getFlipSignalState()
@@ -95,6 +173,24 @@ void SpikeSorter::setThresholdSyncStatus(bool status)
     syncThresholds= status;
 }
 
+float SpikeSorter::getAutoThreshold()
+{
+    return autoThreshold;
+}
+
+void SpikeSorter::setAutoThreshold(float multiplier)
+{
+    mut.enter();
+    // the noise levels are only computed while the thresholds follow them
+    const bool wasAutomatic = autoThreshold > 0;
+    autoThreshold = jmax(0.0f, multiplier);
+    if (autoThreshold > 0 && !wasAutomatic)
+        subscribeToInputStatistics();
+    else if (autoThreshold <= 0 && wasAutomatic)
+        unsubscribeFromInputStatistics();
+    mut.exit();
+}
+
 
 void SpikeSorter::seteAutoDacAssignment(bool status)
 {
@@ -106,6 +202,7 @@ void SpikeSorter::setNumPreSamples(int numSamples)
     // we need to update all electrodes, and also inform other modules that this has happened....
     numPreSamples = numSamples;
 
+    const ScopedWriteLock electrodesWriteLock(electrodesLock);
     for (int k = 0; k < electrodes.size(); k++)
     {
         electrodes[k]->resizeWaveform(numPreSamples,numPostSamples);
@@ -115,6 +212,8 @@ void SpikeSorter::setNumPreSamples(int numSamples)
 void SpikeSorter::setNumPostSamples(int numSamples)
 {
     numPostSamples = numSamples;
+
+    const ScopedWriteLock electrodesWriteLock(electrodesLock);
     for (int k = 0; k < electrodes.size(); k++)
     {
         electrodes[k]->resizeWaveform(numPreSamples,numPostSamples);
@@ -160,6 +259,8 @@ void SpikeSorter::increaseUniqueProbeID(String type)
 
 SpikeSorter::~SpikeSorter()
 {
+    stopThread(1000);
+
     if (channelBuffers != nullptr)
         delete channelBuffers;
 
@@ -180,12 +281,6 @@ void SpikeSorter::updateSettings()
     mut.enter();
 	sorterReady = false;
     int numChannels = getNumInputs();
-	if (numChannels > 0)
-	{
-		overflowBuffer.setSize(getNumInputs(), overflowBufferSize);
-		overflowBuffer.clear();
-	}
-
     if (channelBuffers != nullptr)
         delete channelBuffers;
 
@@ -206,6 +301,7 @@ void SpikeSorter::updateSettings()
 			if (!ch)
 			{
 				//not enough channels for the electrodes
+				mut.exit();
 				return;
 			}
 			chans.add(ch);
@@ -262,6 +358,7 @@ Electrode::Electrode(int ID, UniqueIDgenerator* uniqueIDgenerator_, PCAcomputing
         voltageScale[i] = 500;
     }
     spikePlot = nullptr;
+    thumbnail = nullptr;
 
     if (computingThread != nullptr)
         spikeSort = new SpikeSortBoxes(uniqueIDgenerator, computingThread, numChannels, samplingRate, pre+post);
@@ -269,6 +366,8 @@ Electrode::Electrode(int ID, UniqueIDgenerator* uniqueIDgenerator_, PCAcomputing
         spikeSort = nullptr;
 
     isMonitored = false;
+
+    allocateQueues();
 }
 
 void Electrode::resizeWaveform(int numPre, int numPost)
@@ -281,6 +380,48 @@ void Electrode::resizeWaveform(int numPre, int numPost)
     //spikePlot = nullptr;
     spikeSort->resizeWaveform(prePeakSamples+postPeakSamples);
 
+    allocateQueues();
+}
+
+size_t Electrode::getMemorySize() const
+{
+    const int snippetLength = prePeakSamples + postPeakSamples + 2 * alignmentMargin;
+    const size_t queues = size_t(queueLength) * (2 * sizeof(SorterSpikePtr)
+        + numChannels * (snippetLength + 2) * sizeof(float));
+
+    return spikePool.getMemorySize() + queues + MemoryUsage::getBytes(overflowBuffer);
+}
+
+void Electrode::allocateQueues()
+{
+    const int snippetLength = prePeakSamples + postPeakSamples + 2 * alignmentMargin;
+
+    pendingQueue.setTotalSize(queueLength);
+    pendingSpikes.clear();
+    pendingSpikes.insertMultiple(0, nullptr, queueLength);
+    pendingWaveforms.malloc(queueLength * numChannels * snippetLength);
+    pendingThresholds.malloc(queueLength * numChannels);
+
+    sortedQueue.setTotalSize(queueLength);
+    sortedSpikes.clear();
+    sortedSpikes.insertMultiple(0, nullptr, queueLength);
+    sortedThresholds.malloc(queueLength * numChannels);
+
+    numDropped = 0;
+}
+
+void Electrode::resetQueues()
+{
+    pendingQueue.reset();
+    sortedQueue.reset();
+
+    for (int i = 0; i < queueLength; i++)
+    {
+        pendingSpikes.getReference(i) = nullptr;
+        sortedSpikes.getReference(i) = nullptr;
+    }
+
+    numDropped = 0;
 }
 
 void SpikeSorter::setElectrodeVoltageScale(int electrodeID, int index, float newvalue)
@@ -426,6 +567,7 @@ void SpikeSorter::assignDACtoChannel(int dacOutput, int channel)
 void SpikeSorter::addElectrode(Electrode* newElectrode)
 {
     mut.enter();
+    const ScopedWriteLock electrodesWriteLock(electrodesLock);
     resetElectrode(newElectrode);
     electrodes.add(newElectrode);
     // inform PSTH sink, if it exists, about this new electrode.
@@ -437,6 +579,7 @@ bool SpikeSorter::addElectrode(int nChans, String name, double Depth)
 {
 
     mut.enter();
+    const ScopedWriteLock electrodesWriteLock(electrodesLock);
     int firstChan;
 
     if (electrodes.size() == 0)
@@ -461,6 +604,7 @@ bool SpikeSorter::addElectrode(int nChans, String name, double Depth)
 
     Electrode* newElectrode = new Electrode(++uniqueID, &uniqueIDgenerator, &computingThread, name, nChans, chans, getDefaultThreshold(),
 		numPreSamples, numPostSamples, getSampleRate(), dataChannelArray[chans[0]]->getSourceNodeID(), dataChannelArray[chans[0]]->getSubProcessorIdx());
+    newElectrode->spikePool.setCapacity(spikeHistorySize);
 
     newElectrode->depthOffsetMM = Depth;
     String log = "Added electrode (ID "+ String(uniqueID)+") with " + String(nChans) + " channels." ;
@@ -505,11 +649,14 @@ StringArray SpikeSorter::getElectrodeNames()
 void SpikeSorter::resetElectrode(Electrode* e)
 {
     e->lastBufferIndex = 0;
+    e->overflowBuffer.setSize(e->numChannels, overflowBufferSize);
+    e->overflowBuffer.clear();
 }
 
 bool SpikeSorter::removeElectrode(int index)
 {
     mut.enter();
+    const ScopedWriteLock electrodesWriteLock(electrodesLock);
     // std::cout << "Spike detector removing electrode" << std::endl;
 
     if (index > electrodes.size() || index < 0)
@@ -553,6 +700,7 @@ void SpikeSorter::setElectrodeName(int index, String newName)
 void SpikeSorter::setChannel(int electrodeIndex, int channelNum, int newChannel)
 {
     mut.enter();
+    const ScopedWriteLock electrodesWriteLock(electrodesLock);
     String log = "Setting electrode " + String(electrodeIndex) + " channel " + String(channelNum)+
                  " to " + String(newChannel);
     std::cout << log<< std::endl;
@@ -677,6 +825,10 @@ bool SpikeSorter::enable()
     SpikeSorterEditor* editor = (SpikeSorterEditor*) getEditor();
     editor->enable();
 
+    for (int i = 0; i < electrodes.size(); i++)
+        electrodes[i]->resetQueues();
+    startThread();
+
     return true;
 }
 
@@ -687,12 +839,37 @@ bool SpikeSorter::isReady()
 }
 
 
+void SpikeSorter::getMemoryUsage(MemoryUsage& usage) const
+{
+    GenericProcessor::getMemoryUsage(usage);
+
+    const ScopedReadLock electrodesReadLock(electrodesLock);
+
+    int64 electrodeBytes = 0;
+    int64 historyBytes = 0;
+    for (int i = 0; i < electrodes.size(); i++)
+    {
+        electrodeBytes += electrodes[i]->getMemorySize();
+        historyBytes += electrodes[i]->spikeSort->getMemorySize();
+    }
+
+    usage.add("Spikes and queues", electrodeBytes);
+    usage.add("Sorting histories", historyBytes);
+}
+
+
 bool SpikeSorter::disable()
 {
+    // spikes still waiting to be sorted or sent are let go
+    stopThread(1000);
+
     mut.enter();
     for (int n = 0; n < electrodes.size(); n++)
     {
         resetElectrode(electrodes[n]);
+        if (electrodes[n]->numDropped > 0)
+            std::cout << "SpikeSorter: " << electrodes[n]->numDropped << " spikes dropped on " << electrodes[n]->name << std::endl;
+        electrodes[n]->resetQueues();
     }
     //editor->disable();
     mut.exit();
@@ -708,24 +885,18 @@ Electrode* SpikeSorter::getActiveElectrode()
 }
 
 
-void SpikeSorter::addWaveformToSpikeObject(SpikeEvent::SpikeBuffer& s,
-                                           int& peakIndex,
-                                           int& electrodeNumber,
-                                           int& currentChannel)
+void SpikeSorter::addWaveformToSpikeObject(float* waveform,
+                                           int sampleIndex,
+                                           Electrode* electrode,
+                                           int currentChannel,
+                                           int spikeLength)
 {
-    mut.enter();
-	int spikeLength = electrodes[electrodeNumber]->prePeakSamples
-		+ electrodes[electrodeNumber]->postPeakSamples;
-
-	const int chan = *(electrodes[electrodeNumber]->channels + currentChannel);
-
-
-	if (isChannelActive(electrodeNumber, currentChannel))
+	if (electrode->isActive[currentChannel])
 	{
 
 		for (int sample = 0; sample < spikeLength; ++sample)
 		{
-			s.set(currentChannel, sample, getNextSample(*(electrodes[electrodeNumber]->channels + currentChannel)));
+			waveform[sample] = getNextSample(electrode, currentChannel, sampleIndex);
 			++sampleIndex;
 
 			//std::cout << currentIndex << std::endl;
@@ -736,15 +907,11 @@ void SpikeSorter::addWaveformToSpikeObject(SpikeEvent::SpikeBuffer& s,
 		for (int sample = 0; sample < spikeLength; ++sample)
 		{
 			// insert a blank spike if the
-			s.set(currentChannel, sample, 0);
-			++sampleIndex;
+			waveform[sample] = 0;
 			//std::cout << currentIndex << std::endl;
 		}
 	}
 
-	sampleIndex -= spikeLength; // reset sample index
-    mut.exit();
-
 }
 
 void SpikeSorter::startRecording()
@@ -849,254 +1016,337 @@ void SpikeSorter::clearRunningStatForSelectedElectrode()
     electrodes[currentElectrode]->runningStats[0].Clear();
 }
 
+void SpikeSorter::updateAutoThresholds()
+{
+    const ChannelStatistics& statistics = getInputStatistics();
+
+    for (int i = 0; i < electrodes.size(); i++)
+    {
+        Electrode* electrode = electrodes[i];
+
+        for (int j = 0; j < electrode->numChannels; j++)
+        {
+            const int chan = electrode->channels[j];
+
+            if (!electrode->isActive[j] || chan < 0 || chan >= statistics.getNumChannels())
+                continue;
+
+            // thresholds stay put until the estimate has warmed up, and keep their polarity
+            const float noise = statistics.getNoiseLevel(chan);
+
+            if (noise > 0)
+            {
+                const double threshold = (electrode->thresholds[j] > 0 ? 1 : -1) * autoThreshold * noise;
+                electrode->thresholds[j] = threshold;
+
+                if (electrode->spikePlot != nullptr)
+                    electrode->spikePlot->setDisplayThresholdForChannel(j, threshold);
+            }
+        }
+    }
+}
+
 void SpikeSorter::process(AudioSampleBuffer& buffer)
 {
+    // edits of thresholds and sorting units do not wait for the block: the units are guarded
+    // by the lock of each electrode's SpikeSortBoxes, and only changes to the electrode list,
+    // channel mapping or plots hold the write lock
+    const ScopedReadLock electrodesReadLock(electrodesLock);
 
-    //printf("Entering Spike Detector::process\n");
-    mut.enter();
-    uint16_t samplingFrequencyHz = getSampleRate();//buffer.getSamplingFrequency();
-    // cycle through electrodes
-    Electrode* electrode;
     dataBuffer = &buffer;
-	const SpikeChannel* spikeChan;
 
     //channelBuffers->update(buffer, hardware_timestamp,software_timestamp, nSamples);
 
-    for (int i = 0; i < electrodes.size(); i++)
+    if (autoThreshold > 0)
+        updateAutoThresholds();
+
+    // electrodes keep their own overflow samples, so they can be processed concurrently
+    parallelFor(electrodes.size(), [this](int firstElectrode, int lastElectrode)
     {
+        for (int i = firstElectrode; i < lastElectrode; i++)
+            processElectrode(i);
+    });
 
-        //  std::cout << "ELECTRODE " << i << std::endl;
+    notify();
+}
 
-        electrode = electrodes[i];
-		spikeChan = spikeChannelArray[i];
+void SpikeSorter::run()
+{
+    while (!threadShouldExit())
+    {
+        wait(20);
 
-        // refresh buffer index for this electrode
-        sampleIndex = electrode->lastBufferIndex - 1; // subtract 1 to account for
-        // increment at start of getNextSample()
+        const ScopedReadLock electrodesReadLock(electrodesLock);
+        for (int i = 0; i < electrodes.size() && !threadShouldExit(); i++)
+            sortPendingSpikes(electrodes[i], spikeChannelArray[i]);
+    }
+}
 
-        int nSamples = getNumSamples(*electrode->channels); // get the number of samples for this buffer
+void SpikeSorter::processElectrode(int i)
+{
+    Electrode* electrode = electrodes[i];
+	const SpikeChannel* spikeChan = spikeChannelArray[i];
 
-        // cycle through samples
-        while (samplesAvailable(nSamples))
-        {
+    // the spikes sorted since the last block go at its start
+    sendSortedSpikes(electrode, spikeChan);
 
-            sampleIndex++;
+    // refresh buffer index for this electrode
+    int sampleIndex = electrode->lastBufferIndex - 1; // subtract 1 to account for
+    // increment at start of getNextSample()
 
-            // cycle through channels
-            for (int chan = 0; chan < electrode->numChannels; chan++)
-            {
+    int nSamples = getNumSamples(*electrode->channels); // get the number of samples for this buffer
 
-                // std::cout << "  channel " << chan << std::endl;
+    // cycle through samples
+    while (samplesAvailable(sampleIndex, nSamples))
+    {
 
-                if (*(electrode->isActive+chan))
-                {
-                    //float v = getNextSample(currentChannel);
+        sampleIndex++;
 
-                    int currentChannel = electrode->channels[chan];
-                    float currentValue = getNextSample(currentChannel);
-                    electrode->runningStats[chan].Push(currentValue);
+        // cycle through channels
+        for (int chan = 0; chan < electrode->numChannels; chan++)
+        {
 
-                    bool bSpikeDetectedPositive  = electrode->thresholds[chan] > 0 &&
-                                                   (currentValue > electrode->thresholds[chan]); // rising edge
-                    bool bSpikeDetectedNegative = electrode->thresholds[chan] < 0 &&
-                                                  (currentValue < electrode->thresholds[chan]); // falling edge
+            if (*(electrode->isActive+chan))
+            {
+                float currentValue = getNextSample(electrode, chan, sampleIndex);
+                electrode->runningStats[chan].Push(currentValue);
 
-                    if (bSpikeDetectedPositive || bSpikeDetectedNegative)
-                    {
+                bool bSpikeDetectedPositive  = electrode->thresholds[chan] > 0 &&
+                                               (currentValue > electrode->thresholds[chan]); // rising edge
+                bool bSpikeDetectedNegative = electrode->thresholds[chan] < 0 &&
+                                              (currentValue < electrode->thresholds[chan]); // falling edge
 
-                        //std::cout << "Spike detected on electrode " << i << std::endl;
-                        // find the peak
-                        int peakIndex = sampleIndex;
+                if (bSpikeDetectedPositive || bSpikeDetectedNegative)
+                {
 
-                        //if (sampleIndex == 0 && i == 0)
-                        //    std::cout << getCurrentSample(currentChannel) << std::endl;
+                    // find the peak
+                    int peakIndex = sampleIndex;
 
-                        if (bSpikeDetectedPositive)
+                    if (bSpikeDetectedPositive)
+                    {
+                        // find localmaxima
+                        while (getCurrentSample(electrode, chan, sampleIndex) < getNextSample(electrode, chan, sampleIndex) &&
+                               sampleIndex < peakIndex + electrode->postPeakSamples)
                         {
-                            // find localmaxima
-                            while (getCurrentSample(currentChannel) < getNextSample(currentChannel) &&
-                                   sampleIndex < peakIndex + electrode->postPeakSamples)
-                            {
-                                sampleIndex++;
-                            }
+                            sampleIndex++;
                         }
-                        else
-                        {
-                            // find local minimum
+                    }
+                    else
+                    {
+                        // find local minimum
 
-                            while (getCurrentSample(currentChannel) > getNextSample(currentChannel) &&
-                                   sampleIndex < peakIndex + electrode->postPeakSamples)
-                            {
-                                sampleIndex++;
-                            }
+                        while (getCurrentSample(electrode, chan, sampleIndex) > getNextSample(electrode, chan, sampleIndex) &&
+                               sampleIndex < peakIndex + electrode->postPeakSamples)
+                        {
+                            sampleIndex++;
                         }
+                    }
 
-                        peakIndex = sampleIndex;
-                        sampleIndex -= (electrode->prePeakSamples+1);
-
-						const SpikeChannel* spikeChan = getSpikeChannel(i);
-						SpikeEvent::SpikeBuffer spikeData(spikeChan);
-						Array<float> thresholds;
+                    peakIndex = sampleIndex;
+                    sampleIndex -= (electrode->prePeakSamples+1);
+
+					int64 timestamp = getTimestamp(electrode->channels[0]) + peakIndex;
+					const int snippetLength = electrode->prePeakSamples + electrode->postPeakSamples + 2 * alignmentMargin;
+
+					// the waveform is aligned and sorted on the sorting thread
+					int start1, size1, start2, size2;
+					electrode->pendingQueue.prepareToWrite(1, start1, size1, start2, size2);
+					if (size1 == 0)
+					{
+						electrode->numDropped++;
+					}
+					else
+					{
+						float* snippets = electrode->pendingWaveforms + start1 * electrode->numChannels * snippetLength;
 						for (int channel = 0; channel < electrode->numChannels; ++channel)
 						{
-							addWaveformToSpikeObject(spikeData,
-								peakIndex,
-								i,
-								channel);
-							thresholds.add((int)*(electrode->thresholds + channel));
+							addWaveformToSpikeObject(snippets + channel * snippetLength,
+								sampleIndex - alignmentMargin,
+								electrode,
+								channel,
+								snippetLength);
+							electrode->pendingThresholds[start1 * electrode->numChannels + channel] = (int)*(electrode->thresholds + channel);
 						}
-						int64 timestamp = getTimestamp(electrode->channels[0]) + peakIndex;
 
-						SorterSpikePtr sorterSpike = new SorterSpikeContainer(spikeChan, spikeData, timestamp);
+						electrode->pendingSpikes.getReference(start1) = electrode->spikePool.getSpike(spikeChan, timestamp);
+						electrode->pendingQueue.finishedWrite(1);
+					}
 
-                        /*
-                        bool perfectMatch = true;
-                        for (int k=0;k<40;k++) {
-                        	perfectMatch = perfectMatch & (prevSpike.data[k] == newSpike.data[k]);
-                        }
-                        if (perfectMatch)
-                        {
-                        	int x;
-                        	x++;
-                        }
-                        */
+                    // advance the sample index
+                    sampleIndex = peakIndex + electrode->postPeakSamples;
 
-                        //for (int xxx = 0; xxx < 1000; xxx++) // overload with spikes for testing purposes
-						electrode->spikeSort->projectOnPrincipalComponents(sorterSpike);
+                    break; // quit spike "for" loop
+                } // end spike trigger
 
-                        // Add spike to drawing buffer....
-						electrode->spikeSort->sortSpike(sorterSpike, PCAbeforeBoxes);
+            } // end if channel is active
+        } // end cycle through channels on electrode
 
 
-                        // transfer buffered spikes to spike plot
-                        if (electrode->spikePlot != nullptr)
-                        {
-                            if (electrode->spikeSort->isPCAfinished())
-                            {
-                                electrode->spikeSort->resetJobStatus();
-                                float p1min,p2min, p1max,  p2max;
-                                electrode->spikeSort->getPCArange(p1min,p2min, p1max,  p2max);
-                                electrode->spikePlot->setPCARange(p1min,p2min, p1max,  p2max);
-                            }
+    } // end cycle through samples
 
+    electrode->lastBufferIndex = sampleIndex - nSamples; // should be negative
 
-							electrode->spikePlot->processSpikeObject(sorterSpike);
-                        }
+    if (nSamples > overflowBufferSize)
+    {
 
-						MetaDataValueArray md;
-						md.add(new MetaDataValue(MetaDataDescriptor::UINT8, 3, sorterSpike->color));
-						SpikeEventPtr newSpike = SpikeEvent::createSpikeEvent(spikeChan, timestamp, thresholds, spikeData, sorterSpike->sortedId, md);
+        for (int j = 0; j < electrode->numChannels; j++)
+        {
+            electrode->overflowBuffer.copyFrom(j, 0,
+                                               *dataBuffer, *(electrode->channels+j),
+                                               nSamples-overflowBufferSize,
+                                               overflowBufferSize);
 
-                        addSpike(spikeChan, newSpike, peakIndex);
-                        //prevSpike = newSpike;
-                        // advance the sample index
-                        sampleIndex = peakIndex + electrode->postPeakSamples;
+        }
 
-                        break; // quit spike "for" loop
-                    } // end spike trigger
+        useOverflowBuffer.set(i, true);
+
+    }
+    else
+    {
+        useOverflowBuffer.set(i, false);
+    }
+}
 
-                } // end if channel is active
-            } // end cycle through channels on electrode
+// aligns, projects and sorts the spikes waiting on an electrode in one go, then queues them
+// to be sent by the audio thread
+void SpikeSorter::sortPendingSpikes(Electrode* electrode, const SpikeChannel* spikeChan)
+{
+    const int numChannels = electrode->numChannels;
+    const int spikeLength = electrode->prePeakSamples + electrode->postPeakSamples;
+    const int snippetLength = spikeLength + 2 * alignmentMargin;
 
+    int start1, size1, start2, size2;
+    electrode->pendingQueue.prepareToRead(electrode->pendingQueue.getNumReady(), start1, size1, start2, size2);
+    if (size1 + size2 == 0)
+        return;
 
-        } // end cycle through samples
+    sortingBatch.clearQuick();
+    sortingThresholds.clearQuick();
 
-        //float vv = getNextSample(currentChannel);
-        electrode->lastBufferIndex = sampleIndex - nSamples; // should be negative
+    for (int n = 0; n < size1 + size2; n++)
+    {
+        const int slot = n < size1 ? start1 + n : start2 + n - size1;
+        SorterSpikePtr sorterSpike = electrode->pendingSpikes[slot];
+        electrode->pendingSpikes.getReference(slot) = nullptr;
 
-        //jassert(electrode->lastBufferIndex < 0);
+        alignWaveforms(electrode->pendingWaveforms + slot * numChannels * snippetLength, numChannels, spikeLength,
+                       electrode->prePeakSamples, sorterSpike->getWritableData());
 
-        if (nSamples > overflowBufferSize)
-        {
+        sortingBatch.add(sorterSpike);
+        sortingThresholds.addArray(static_cast<const float*>(electrode->pendingThresholds + slot * numChannels), numChannels);
+    }
+    electrode->pendingQueue.finishedRead(size1 + size2);
 
-            for (int j = 0; j < electrode->numChannels; j++)
-            {
-                //std::cout << "Processing " << *electrode->channels+i << std::endl;
+    electrode->spikeSort->projectOnPrincipalComponents(sortingBatch);
+    electrode->spikeSort->sortSpikes(sortingBatch, PCAbeforeBoxes, templateMatching);
 
-                overflowBuffer.copyFrom(*(electrode->channels+j), 0,
-                                        buffer, *(electrode->channels+j),
-                                        nSamples-overflowBufferSize,
-                                        overflowBufferSize);
+    for (int s = 0; s < sortingBatch.size(); s++)
+    {
+        SorterSpikePtr sorterSpike = sortingBatch.getUnchecked(s);
 
+        // transfer buffered spikes to spike plot
+        if (electrode->spikePlot != nullptr)
+        {
+            if (electrode->spikeSort->isPCAfinished())
+            {
+                electrode->spikeSort->resetJobStatus();
+                float p1min,p2min, p1max,  p2max;
+                electrode->spikeSort->getPCArange(p1min,p2min, p1max,  p2max);
+                electrode->spikePlot->setPCARange(p1min,p2min, p1max,  p2max);
             }
 
-            useOverflowBuffer.set(i, true);
-
+            electrode->spikePlot->processSpikeObject(sorterSpike);
         }
-        else
+        else if (electrode->thumbnail != nullptr)
         {
-            useOverflowBuffer.set(i, false);
+            electrode->thumbnail->addSpike(sorterSpike);
         }
+    }
 
-    } // end cycle through electrodes
+    electrode->sortedQueue.prepareToWrite(sortingBatch.size(), start1, size1, start2, size2);
+    electrode->numDropped += sortingBatch.size() - size1 - size2;
 
+    for (int n = 0; n < size1 + size2; n++)
+    {
+        const int slot = n < size1 ? start1 + n : start2 + n - size1;
+        electrode->sortedSpikes.getReference(slot) = sortingBatch.getUnchecked(n);
+        memcpy(electrode->sortedThresholds + slot * numChannels, sortingThresholds.getRawDataPointer() + n * numChannels, numChannels * sizeof(float));
+    }
+    electrode->sortedQueue.finishedWrite(size1 + size2);
 
-    mut.exit();
-    //printf("Exitting Spike Detector::process\n");
+    sortingBatch.clearQuick();
 }
 
-float SpikeSorter::getNextSample(int& chan)
+void SpikeSorter::sendSortedSpikes(Electrode* electrode, const SpikeChannel* spikeChan)
 {
+    int start1, size1, start2, size2;
+    electrode->sortedQueue.prepareToRead(electrode->sortedQueue.getNumReady(), start1, size1, start2, size2);
+    if (size1 + size2 == 0)
+        return;
 
+    const int numSamples = spikeChan->getTotalSamples();
 
+    for (int n = 0; n < size1 + size2; n++)
+    {
+        const int slot = n < size1 ? start1 + n : start2 + n - size1;
+        SorterSpikePtr sorterSpike = electrode->sortedSpikes[slot];
+        electrode->sortedSpikes.getReference(slot) = nullptr;
+
+        SpikeEvent::SpikeBuffer spikeData(spikeChan);
+        for (int channel = 0; channel < electrode->numChannels; ++channel)
+            spikeData.set(channel, sorterSpike->getData() + channel * numSamples, numSamples);
+
+        Array<float> thresholds(electrode->sortedThresholds + slot * electrode->numChannels, electrode->numChannels);
 
-    //if (useOverflowBuffer)
-    //{
+        MetaDataValueArray md;
+        md.add(new MetaDataValue(MetaDataDescriptor::UINT8, 3, sorterSpike->color));
+        SpikeEventPtr newSpike = SpikeEvent::createSpikeEvent(spikeChan, sorterSpike->getTimestamp(), thresholds, spikeData, sorterSpike->sortedId, md);
+
+        addSpike(spikeChan, newSpike, 0);
+    }
+    electrode->sortedQueue.finishedRead(size1 + size2);
+}
+
+float SpikeSorter::getNextSample(Electrode* electrode, int chan, int sampleIndex)
+{
     if (sampleIndex < 0)
     {
-        // std::cout << "  sample index " << sampleIndex << "from overflowBuffer" << std::endl;
         int ind = overflowBufferSize + sampleIndex;
 
-        if (ind < overflowBuffer.getNumSamples())
-            return (*overflowBuffer.getReadPointer(chan, ind));
+        if (ind < electrode->overflowBuffer.getNumSamples())
+            return (*electrode->overflowBuffer.getReadPointer(chan, ind));
         else
             return 0;
 
     }
     else
     {
-        //  useOverflowBuffer = false;
-        // std::cout << "  sample index " << sampleIndex << "from regular buffer" << std::endl;
+        const int channel = electrode->channels[chan];
 
-        if (sampleIndex < getNumSamples(chan))
-            return (*dataBuffer->getReadPointer(chan, sampleIndex));
+        if (sampleIndex < getNumSamples(channel))
+            return (*dataBuffer->getReadPointer(channel, sampleIndex));
         else
             return 0;
     }
-    //} else {
-    //    std::cout << "  sample index " << sampleIndex << "from regular buffer" << std::endl;
-    //     return *dataBuffer.getSampleData(chan, sampleIndex);
-    //}
 
 }
 
-float SpikeSorter::getCurrentSample(int& chan)
+float SpikeSorter::getCurrentSample(Electrode* electrode, int chan, int sampleIndex)
 {
 
-    // if (useOverflowBuffer)
-    // {
-    //     return *overflowBuffer.getSampleData(chan, overflowBufferSize + sampleIndex - 1);
-    // } else {
-    //     return *dataBuffer.getSampleData(chan, sampleIndex - 1);
-    // }
-
     if (sampleIndex < 1)
     {
-        //std::cout << "  sample index " << sampleIndex << "from overflowBuffer" << std::endl;
-        return (*overflowBuffer.getReadPointer(chan, overflowBufferSize + sampleIndex - 1)) ;
+        return (*electrode->overflowBuffer.getReadPointer(chan, overflowBufferSize + sampleIndex - 1)) ;
     }
     else
     {
-        //  useOverflowBuffer = false;
-        // std::cout << "  sample index " << sampleIndex << "from regular buffer" << std::endl;
-        return (*dataBuffer->getReadPointer(chan, sampleIndex - 1));
+        return (*dataBuffer->getReadPointer(electrode->channels[chan], sampleIndex - 1));
     }
-    //} else {
 
 }
 
 
-bool SpikeSorter::samplesAvailable(int nSamples)
+bool SpikeSorter::samplesAvailable(int sampleIndex, int nSamples)
 {
 
     if (sampleIndex > nSamples - overflowBufferSize/2)
@@ -1191,8 +1441,11 @@ void SpikeSorter::saveCustomParametersToXml(XmlElement* parentElement)
     mainNode->setAttribute("numPostSamples", numPostSamples);
     mainNode->setAttribute("autoDACassignment",	autoDACassignment);
     mainNode->setAttribute("syncThresholds",syncThresholds);
+    mainNode->setAttribute("autoThreshold",autoThreshold);
     mainNode->setAttribute("uniqueID",uniqueID);
     mainNode->setAttribute("flipSignal",flipSignal);
+    mainNode->setAttribute("templateMatching",templateMatching);
+    mainNode->setAttribute("spikeHistorySize",spikeHistorySize);
 
     XmlElement* countNode = mainNode->createNewChildElement("ELECTRODE_COUNTER");
 
@@ -1253,8 +1506,11 @@ void SpikeSorter::loadCustomParametersFromXml()
                 numPostSamples = mainNode->getIntAttribute("numPostSamples");
                 autoDACassignment = mainNode->getBoolAttribute("autoDACassignment");
                 syncThresholds = mainNode->getBoolAttribute("syncThresholds");
+                setAutoThreshold((float) mainNode->getDoubleAttribute("autoThreshold", 0));
                 uniqueID = mainNode->getIntAttribute("uniqueID");
                 flipSignal = mainNode->getBoolAttribute("flipSignal");
+                templateMatching = mainNode->getBoolAttribute("templateMatching", false);
+                spikeHistorySize = jmax(1, mainNode->getIntAttribute("spikeHistorySize", 1024));
 
                 forEachXmlChildElement(*mainNode, xmlNode)
                 {
@@ -1309,6 +1565,7 @@ void SpikeSorter::loadCustomParametersFromXml()
 
                         Electrode* newElectrode = new Electrode(electrodeID, &uniqueIDgenerator,&computingThread, electrodeName, channelsPerElectrode, channels,getDefaultThreshold(),
                                                                 numPreSamples,numPostSamples, getSampleRate(), sourceNodeId,0);
+                        newElectrode->spikePool.setCapacity(spikeHistorySize);
                         for (int k=0; k<channelsPerElectrode; k++)
                         {
                             newElectrode->thresholds[k] = thres[k];
@@ -1350,10 +1607,12 @@ void SpikeSorter::loadCustomParametersFromXml()
 void SpikeSorter::removeSpikePlots()
 {
     mut.enter();
+    const ScopedWriteLock electrodesWriteLock(electrodesLock);
     for (int i = 0; i < getNumElectrodes(); i++)
     {
         Electrode* ee = electrodes[i];
         ee->spikePlot = nullptr;
+        ee->thumbnail = nullptr;
     }
     mut.exit();
 }
@@ -1407,11 +1666,21 @@ String SpikeSorter::getNameForElectrode(int i)
 void SpikeSorter::addSpikePlotForElectrode(SpikeHistogramPlot* sp, int i)
 {
     mut.enter();
+    const ScopedWriteLock electrodesWriteLock(electrodesLock);
     Electrode* ee = electrodes[i];
     ee->spikePlot = sp;
     mut.exit();
 }
 
+void SpikeSorter::addThumbnailForElectrode(SpikeThumbnail* th, int i)
+{
+    mut.enter();
+    const ScopedWriteLock electrodesWriteLock(electrodesLock);
+    Electrode* ee = electrodes[i];
+    ee->thumbnail = th;
+    mut.exit();
+}
+
 int SpikeSorter::getCurrentElectrodeIndex()
 {
     return currentElectrode;
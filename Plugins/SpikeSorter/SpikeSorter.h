@@ -25,6 +25,7 @@
 #define __SPIKESORTER_H_3F920F95__
 
 #include <ProcessorHeaders.h>
+#include <DspLib.h>
 #include "SpikeSorterEditor.h"
 #include "SpikeSortBoxes.h"
 #include <algorithm>    // std::sort
@@ -35,6 +36,7 @@
 
 class SpikeSorterEditor;
 class SpikeHistogramPlot;
+class SpikeThumbnail;
 class Trial;
 /**
 
@@ -173,12 +175,40 @@ public:
 
     RunningStat* runningStats;
     SpikeHistogramPlot* spikePlot;
+    SpikeThumbnail* thumbnail; // small view shown under the plot of the selected electrode
     
     PCAcomputingThread* computingThread;
     UniqueIDgenerator* uniqueIDgenerator;
 
 	ScopedPointer<SpikeSortBoxes> spikeSort;
+    SorterSpikePool spikePool; // storage of the spikes detected on this electrode
     bool isMonitored;
+
+    /** Extra samples of each channel are placed in this buffer to allow seamless
+        transitions between callbacks. */
+    AudioSampleBuffer overflowBuffer;
+
+    /** Spikes detected by the audio thread, with their waveforms and a few samples more on
+        both sides, waiting to be aligned and sorted by the sorting thread */
+    AbstractFifo pendingQueue{ 1 };
+    Array<SorterSpikePtr> pendingSpikes;
+    HeapBlock<float> pendingWaveforms;
+    HeapBlock<float> pendingThresholds;
+
+    /** Sorted spikes waiting to be sent by the audio thread */
+    AbstractFifo sortedQueue{ 1 };
+    Array<SorterSpikePtr> sortedSpikes;
+    HeapBlock<float> sortedThresholds;
+
+    /** Spikes lost because one of the queues was full */
+    std::atomic<int> numDropped;
+
+    /** Sizes the queues for the current waveform length. Not while acquiring */
+    void allocateQueues();
+    void resetQueues();
+
+    /** Bytes of the spike pool, the queues and the overflow buffer */
+    size_t getMemorySize() const;
 };
 
 class ContinuousCircularBuffer
@@ -212,7 +242,13 @@ public:
 
 
 
-class SpikeSorter : public GenericProcessor
+/**
+  Detection runs on the audio thread, which only copies the waveforms of the spikes into
+  the queues of their electrode. A sorting thread aligns them on their interpolated peak,
+  projects and sorts them, and they are sent at the start of the next block.
+*/
+class SpikeSorter : public GenericProcessor,
+    private Thread
 {
 public:
 
@@ -243,6 +279,9 @@ public:
     /** Called after acquisition is finished. */
     bool disable() override;
 
+    /** Adds the spike pools, sorting histories and queues of all electrodes. */
+    void getMemoryUsage(MemoryUsage& usage) const override;
+
 
     bool isReady() override;
     /** Creates the SpikeSorterEditor. */
@@ -255,13 +294,6 @@ public:
 
     void postEventsInQueue(MidiBuffer& events);
 
-    // INTERNAL BUFFERS //
-
-    /** Extra samples are placed in this buffer to allow seamless
-        transitions between callbacks. */
-    AudioSampleBuffer overflowBuffer;
-
-
     // CREATE AND DELETE ELECTRODES //
 
     /** Adds an electrode with n channels to be processed. */
@@ -323,12 +355,13 @@ public:
     /** returns the number of electrodes */
     int getNumElectrodes();
 
-    /** clears up the spike plots. Called during updates */
+    /** clears up the spike plots and thumbnails. Called during updates */
     void removeSpikePlots();
 
     int getNumberOfChannelsForElectrode(int i);
     String getNameForElectrode(int i);
     void addSpikePlotForElectrode(SpikeHistogramPlot* sp, int i);
+    void addThumbnailForElectrode(SpikeThumbnail* th, int i);
     int getCurrentElectrodeIndex();
     Electrode* setCurrentElectrodeIndex(int i);
     Electrode* getElectrode(int i);
@@ -351,8 +384,14 @@ public:
     void updateDACthreshold(int dacChannel, float threshold);
     bool getThresholdSyncStatus();
     void setThresholdSyncStatus(bool status);
+    /** multiple of the noise level of each channel used as its threshold, 0 for manual thresholds */
+    float getAutoThreshold();
+    void setAutoThreshold(float multiplier);
     bool getFlipSignalState();
     void setFlipSignalState(bool state);
+    /** assign spikes to the unit with the nearest mean waveform before trying boxes and polygons */
+    bool getTemplateMatchingState();
+    void setTemplateMatchingState(bool state);
     void startRecording();
     std::vector<float> getElectrodeVoltageScales(int electrodeID);
     //void getElectrodePCArange(int electrodeID, float &minX,float &maxX,float &minY,float &maxY);
@@ -405,12 +444,21 @@ private:
 
     int overflowBufferSize;
 
-    int sampleIndex;
-
     std::vector<int> electrodeCounter;
-    float getNextSample(int& chan);
-    float getCurrentSample(int& chan);
-    bool samplesAvailable(int nSamples);
+    float getNextSample(Electrode* electrode, int chan, int sampleIndex);
+    float getCurrentSample(Electrode* electrode, int chan, int sampleIndex);
+    bool samplesAvailable(int sampleIndex, int nSamples);
+
+    /** sends the spikes of one electrode sorted since the last buffer, and queues the ones
+        detected in the current buffer */
+    void processElectrode(int electrodeIndex);
+    void sendSortedSpikes(Electrode* electrode, const SpikeChannel* spikeChan);
+
+    /** sorting thread */
+    void run() override;
+    void sortPendingSpikes(Electrode* electrode, const SpikeChannel* spikeChan);
+    SorterSpikeArray sortingBatch;
+    Array<float> sortingThresholds;
 
     Array<bool> useOverflowBuffer;
 
@@ -427,19 +475,27 @@ private:
 
     void resetElectrode(Electrode*);
     CriticalSection mut;
+    /** held for reading by process() and for writing by the edits that add, remove or rewire
+        electrodes or their plots, which therefore wait for the current block */
+    ReadWriteLock electrodesLock;
     bool autoDACassignment;
     bool syncThresholds;
+    float autoThreshold;
+    void updateAutoThresholds(); // from the noise levels of the input statistics
  //   RHD2000Thread* getRhythmAccess();
     bool flipSignal;
+    bool templateMatching;
+    int spikeHistorySize; // capacity of the spike pool of each electrode
 
 	bool sorterReady{ false };
 
     Time timer;
 
-    void addWaveformToSpikeObject(SpikeEvent::SpikeBuffer& s,
-                                  int& peakIndex,
-                                  int& electrodeNumber,
-                                  int& currentChannel);
+    void addWaveformToSpikeObject(float* waveform,
+                                  int sampleIndex,
+                                  Electrode* electrode,
+                                  int currentChannel,
+                                  int spikeLength);
 
 
     OwnedArray<Electrode> electrodes;
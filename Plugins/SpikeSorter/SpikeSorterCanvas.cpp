@@ -22,6 +22,7 @@
 */
 
 #include "SpikeSorterCanvas.h"
+#include "OfflineResorter.h"
 
 
 SpikeSorterCanvas::SpikeSorterCanvas(SpikeSorter* n) :
@@ -87,6 +88,12 @@ SpikeSorterCanvas::SpikeSorterCanvas(SpikeSorter* n) :
     editAllThresholds->setBounds(140,30,60,20);
     editAllThresholds->setClickingTogglesState(true);
     addAndMakeVisible(editAllThresholds);
+
+    resortButton = new UtilityButton("Re-sort recording", Font("Small Text", 13, Font::plain));
+    resortButton->setRadius(3.0f);
+    resortButton->addListener(this);
+    resortButton->setTooltip("Classify the spikes of a Binary recording again with the current units, rewriting their spike_clusters.npy");
+    addAndMakeVisible(resortButton);
     //
     
     addAndMakeVisible(viewport);
@@ -99,7 +106,8 @@ SpikeSorterCanvas::SpikeSorterCanvas(SpikeSorter* n) :
 
 SpikeSorterCanvas::~SpikeSorterCanvas()
 {
-
+    // the plots and thumbnails go with the display
+    processor->removeSpikePlots();
 }
 
 void SpikeSorterCanvas::beginAnimation()
@@ -136,6 +144,17 @@ void SpikeSorterCanvas::update()
         electrode->spikePlot->setFlipSignal(processor->getFlipSignalState());
         electrode->spikePlot->updateUnitsFromProcessor();
 
+        // the other electrodes only get a thumbnail
+        for (int i = 0; i < nPlots; i++)
+        {
+            if (i == currentElectrode)
+                continue;
+
+            const Electrode* e = processor->getElectrode(i);
+            SpikeThumbnail* th = spikeDisplay->addThumbnail(i, processor->getNameForElectrode(i),
+                                                            processor->getElectrodeVoltageScales(e->electrodeID)[0]);
+            processor->addThumbnailForElectrode(th, i);
+        }
     }
     spikeDisplay->resized();
     spikeDisplay->repaint();
@@ -169,6 +188,8 @@ void SpikeSorterCanvas::resized()
     
     editAllThresholds->setBounds(0, 330, 120,20);
 
+    resortButton->setBounds(0, 370, 120,20);
+
 }
 
 void SpikeSorterCanvas::paint(Graphics& g)
@@ -180,10 +201,9 @@ void SpikeSorterCanvas::paint(Graphics& g)
 
 void SpikeSorterCanvas::refresh()
 {
-    // called every 10 Hz
     processSpikeEvents();
 
-    repaint();
+    spikeDisplay->refresh();
 }
 
 
@@ -331,6 +351,25 @@ bool SpikeSorterCanvas::keyPressed(const KeyPress& key)
 
 }
 
+void SpikeSorterCanvas::resortRecording()
+{
+    // the files of a recording in progress are still being written
+    if (CoreServices::getAcquisitionStatus())
+    {
+        CoreServices::sendStatusMessage("Stop acquisition to re-sort a recording");
+        return;
+    }
+
+    FileChooser chooser("Select the structure.oebin of a recording", CoreServices::RecordNode::getRecordingPath(), "*.oebin");
+    if (!chooser.browseForFileToOpen())
+        return;
+
+    OfflineResorter resorter(processor, chooser.getResult());
+    resorter.runThread();
+
+    AlertWindow::showMessageBoxAsync(AlertWindow::InfoIcon, "Re-sort recording", resorter.getSummary());
+}
+
 void SpikeSorterCanvas::buttonClicked(Button* button)
 {
     int channel = 0;
@@ -414,6 +453,10 @@ void SpikeSorterCanvas::buttonClicked(Button* button)
     else if (button == editAllThresholds){
         
     }
+    else if (button == resortButton)
+    {
+        resortRecording();
+    }
     
     // new
     if (button == editAllThresholds){
@@ -458,6 +501,7 @@ void SpikeThresholdDisplay::clear()
 void SpikeThresholdDisplay::removePlots()
 {
     spikePlots.clear();
+    thumbnails.clear();
 
 }
 
@@ -473,6 +517,27 @@ SpikeHistogramPlot* SpikeThresholdDisplay::addSpikePlot(int numChannels, int ele
     return spikePlot;
 }
 
+SpikeThumbnail* SpikeThresholdDisplay::addThumbnail(int electrodeIndex, String name_, float range)
+{
+    SpikeThumbnail* thumbnail = new SpikeThumbnail(processor, electrodeIndex, name_, range);
+    thumbnails.add(thumbnail);
+    addAndMakeVisible(thumbnail);
+
+    return thumbnail;
+}
+
+void SpikeThresholdDisplay::refresh()
+{
+    // the waveforms fade to a tenth in about two seconds
+    const float fade = std::pow(0.1f, 1.0f / (2.0f * jmax(1.0f, canvas->refreshRate)));
+
+    for (int i = 0; i < spikePlots.size(); i++)
+        spikePlots[i]->refresh(fade);
+
+    for (int i = 0; i < thumbnails.size(); i++)
+        thumbnails[i]->refresh(fade);
+}
+
 void SpikeThresholdDisplay::paint(Graphics& g)
 {
 
@@ -498,8 +563,22 @@ void SpikeThresholdDisplay::resized()
 
         spikePlots[0]->setBounds(0, 0, w, h);
 
+        // thumbnails fill rows under the plot
+        const int thumbnailWidth = 160;
+        const int thumbnailHeight = 70;
+        const int numThumbnailColumns = jmax(1, w / (thumbnailWidth + 5));
+
+        for (int i = 0; i < thumbnails.size(); i++)
+        {
+            thumbnails[i]->setBounds(5 + (i % numThumbnailColumns) * (thumbnailWidth + 5),
+                                     h + 5 + (i / numThumbnailColumns) * (thumbnailHeight + 5),
+                                     thumbnailWidth, thumbnailHeight);
+        }
 
-        setBounds(0, 0, w, h);
+        const int numThumbnailRows = (thumbnails.size() + numThumbnailColumns - 1) / numThumbnailColumns;
+        totalHeight = h + 5 + numThumbnailRows * (thumbnailHeight + 5);
+
+        setBounds(0, 0, w, totalHeight);
     }
 
 }
@@ -516,17 +595,135 @@ void SpikeThresholdDisplay::plotSpike(SorterSpikePtr spike, int electrodeNum)
 }
 
 
+// ----------------------------------------------------------------
+
+// most spikes a thumbnail draws per refresh, the rest are dropped
+#define MAX_THUMBNAIL_SPIKES_PER_REFRESH 8
+
+SpikeThumbnail::SpikeThumbnail(SpikeSorter* p, int electrodeIndex_, String name_, float range_) :
+    processor(p), electrodeIndex(electrodeIndex_), name(name_), range(range_)
+{
+    pendingSpikes.ensureStorageAllocated(MAX_THUMBNAIL_SPIKES_PER_REFRESH);
+    receivedSpikes.ensureStorageAllocated(MAX_THUMBNAIL_SPIKES_PER_REFRESH);
+
+    setMouseCursor(MouseCursor::PointingHandCursor);
+}
+
+SpikeThumbnail::~SpikeThumbnail()
+{
+
+}
+
+void SpikeThumbnail::addSpike(SorterSpikePtr s)
+{
+    const SpinLock::ScopedLockType pendingScopedLock(pendingLock);
+
+    if (pendingSpikes.size() < MAX_THUMBNAIL_SPIKES_PER_REFRESH)
+        pendingSpikes.add(s);
+}
+
+void SpikeThumbnail::refresh(float fade)
+{
+    {
+        const SpinLock::ScopedLockType pendingScopedLock(pendingLock);
+        receivedSpikes.swapWith(pendingSpikes);
+    }
+
+    if (spikeImage.isNull())
+        return;
+
+    spikeImage.multiplyAllAlphas(fade);
+
+    const float w = spikeImage.getWidth();
+    const float h = spikeImage.getHeight();
+    const bool flip = processor->getFlipSignalState();
+
+    Graphics g(spikeImage);
+
+    for (int k = 0; k < receivedSpikes.size(); k++)
+    {
+        SorterSpikeContainer* s = receivedSpikes.getObjectPointerUnchecked(k);
+        const int numChannels = s->getChannel()->getNumChannels();
+        const int numSamples = s->getChannel()->getTotalSamples();
+
+        if (numSamples < 2)
+            continue;
+
+        // the channels side by side, one path for the whole spike
+        const float dx = w / (numChannels * numSamples - 1);
+        Path path;
+
+        for (int c = 0; c < numChannels; c++)
+        {
+            const float* data = s->getData() + c * numSamples;
+
+            for (int i = 0; i < numSamples; i++)
+            {
+                float y = h / 2 - data[i] / range * h;
+                if (flip)
+                    y = h - y;
+
+                const Point<float> point((c * numSamples + i) * dx, y);
+                if (i == 0)
+                    path.startNewSubPath(point);
+                else
+                    path.lineTo(point);
+            }
+        }
+
+        g.setColour(Colour(s->color[0], s->color[1], s->color[2]));
+        g.strokePath(path, PathStrokeType(1.0f));
+    }
+
+    receivedSpikes.clearQuick();
+
+    repaint();
+}
+
+void SpikeThumbnail::paint(Graphics& g)
+{
+    g.fillAll(Colours::black);
+
+    if (! spikeImage.isNull())
+        g.drawImageAt(spikeImage, 0, 0);
+
+    g.setColour(Colours::white);
+    g.setFont(Font("Small Text", 11, Font::plain));
+    g.drawText(name, 4, 2, getWidth() - 8, 12, Justification::left, true);
+
+    g.setColour(Colours::darkgrey);
+    g.drawRect(getLocalBounds());
+}
+
+void SpikeThumbnail::resized()
+{
+    spikeImage = getWidth() > 0 && getHeight() > 0 ? Image(Image::ARGB, getWidth(), getHeight(), true) : Image();
+}
+
+void SpikeThumbnail::mouseDown(const MouseEvent& event)
+{
+    // steps the electrode list of the editor, which updates the canvas
+    SpikeSorterEditor* ed = (SpikeSorterEditor*)processor->getEditor();
+    ed->setElectrodeComboBox(electrodeIndex - processor->getCurrentElectrodeIndex());
+}
+
+
 
 
 
 
 // ----------------------------------------------------------------
 
+// most spikes the plot of the selected electrode draws per refresh, the rest are dropped
+#define MAX_PLOT_SPIKES_PER_REFRESH 256
+
 SpikeHistogramPlot::SpikeHistogramPlot(SpikeSorter* prc,SpikeSorterCanvas* sdc, int electrodeID_, int p, String name_) :
     canvas(sdc), isSelected(false), plotType(p), electrodeID(electrodeID_),
-    limitsChanged(true), processor(prc), name(name_)
+    limitsChanged(true), processor(prc), name(name_), pcaRangeChanged(false)
 
 {
+    pendingSpikes.ensureStorageAllocated(MAX_PLOT_SPIKES_PER_REFRESH);
+    receivedSpikes.ensureStorageAllocated(MAX_PLOT_SPIKES_PER_REFRESH);
 
     font = Font("Default", 15, Font::plain);
 
@@ -656,24 +853,68 @@ void SpikeHistogramPlot::updateUnitsFromProcessor()
 
 void SpikeHistogramPlot::setPCARange(float p1min, float p2min, float p1max, float p2max)
 {
-    const ScopedLock myScopedLock(mut);
-    pAxes[0]->setPCARange(p1min, p2min, p1max, p2max);
+    // called by the processing thread when a PCA job finishes, applied by refresh()
+    const SpinLock::ScopedLockType pendingScopedLock(pendingLock);
+    pcaRange[0] = p1min;
+    pcaRange[1] = p2min;
+    pcaRange[2] = p1max;
+    pcaRange[3] = p2max;
+    pcaRangeChanged = true;
 }
 
 void SpikeHistogramPlot::processSpikeObject(SorterSpikePtr s)
 {
-    const ScopedLock myScopedLock(mut);
-    if (nWaveAx > 0)
+    const SpinLock::ScopedLockType pendingScopedLock(pendingLock);
+
+    if (pendingSpikes.size() < MAX_PLOT_SPIKES_PER_REFRESH)
+        pendingSpikes.add(s);
+}
+
+void SpikeHistogramPlot::refresh(float fade)
+{
+    bool rangeChanged;
+    float range[4];
+
     {
-        for (int i = 0; i < nWaveAx; i++)
-        {
-            wAxes[i]->updateSpikeData(s);
-        }
+        const SpinLock::ScopedLockType pendingScopedLock(pendingLock);
+        receivedSpikes.swapWith(pendingSpikes);
 
-        pAxes[0]->updateSpikeData(s);
+        rangeChanged = pcaRangeChanged;
+        pcaRangeChanged = false;
+        std::copy(pcaRange, pcaRange + 4, range);
+    }
 
+    const ScopedLock myScopedLock(mut);
 
+    if (rangeChanged)
+        pAxes[0]->setPCARange(range[0], range[1], range[2], range[3]);
+
+    // what the axes paint besides the spikes is read once here
+    int selectedUnitID, selectedBoxID;
+    processor->getActiveElectrode()->spikeSort->getSelectedUnitAndBox(selectedUnitID, selectedBoxID);
+    const double noise = processor->getSelectedElectrodeNoise();
+
+    for (int i = 0; i < nWaveAx; i++)
+    {
+        wAxes[i]->setNoiseLevel(noise);
+        wAxes[i]->setSelectedUnitAndBox(selectedUnitID, selectedBoxID);
+        wAxes[i]->fadeSpikes(fade);
+
+        for (int k = 0; k < receivedSpikes.size(); k++)
+            wAxes[i]->updateSpikeData(receivedSpikes.getObjectPointerUnchecked(k));
+
+        wAxes[i]->repaint();
     }
+
+    pAxes[0]->setSelectedUnitID(selectedUnitID);
+    pAxes[0]->fadeSpikes(fade);
+
+    for (int k = 0; k < receivedSpikes.size(); k++)
+        pAxes[0]->updateSpikeData(receivedSpikes.getObjectPointerUnchecked(k));
+
+    pAxes[0]->repaint();
+
+    receivedSpikes.clearQuick();
 }
 
 void SpikeHistogramPlot::select()
@@ -1031,9 +1272,12 @@ WaveformAxes::WaveformAxes(SpikeHistogramPlot* plt, SpikeSorter* p,int electrode
     channel(_channel),
     drawGrid(true),
     displayThresholdLevel(0.0f),
-    spikesReceivedSinceLastRedraw(0),
     spikeIndex(0),
     bufferSize(5),
+    spikeImageNeedsRedraw(true),
+    noiseLevel(0.0),
+    selectedUnitID(-1),
+    selectedBoxID(-1),
     range(250.0f),
     isOverThresholdSlider(false),
     isDraggingThresholdSlider(false),
@@ -1072,6 +1316,7 @@ void WaveformAxes::mouseWheelMove(const MouseEvent& event, const MouseWheelDetai
 void WaveformAxes::setSignalFlip(bool state)
 {
     signalFlipped = state;
+    spikeImageNeedsRedraw = true;
     repaint();
 }
 
@@ -1081,59 +1326,83 @@ void WaveformAxes::setRange(float r)
     //std::cout << "Setting range to " << r << std::endl;
 
     range = r;
+    spikeImageNeedsRedraw = true;
 
     repaint();
 }
 
-void WaveformAxes::plotSpike(SorterSpikePtr s, Graphics& g)
+void WaveformAxes::setNoiseLevel(double noise)
+{
+    noiseLevel = noise;
+}
+
+void WaveformAxes::setSelectedUnitAndBox(int unitID, int boxID)
+{
+    selectedUnitID = unitID;
+    selectedBoxID = boxID;
+}
+
+Path WaveformAxes::getSpikePath(SorterSpikePtr s)
 {
-	if (s.get() == nullptr) return;
     float h = getHeight();
 
-	g.setColour(Colour(s->color[0], s->color[1], s->color[2]));
-    //g.setColour(Colours::pink);
     //compute the spatial width for each waveform sample
-    float dx = getWidth()/float(s->getChannel()->getTotalSamples());
-
-    /*
-    float align = 8 * getWidth()/float(spikeBuffer[0].nSamples);
-    g.drawLine(align,
-                       0,
-                       align,
-                       h);
-    */
-	
 	int spikeSamples = s->getChannel()->getTotalSamples();
+    float dx = getWidth()/float(spikeSamples);
+
     // type corresponds to channel so we need to calculate the starting
     // sample based upon which channel is getting plotted
-	int offset = channel*spikeSamples; //spikeBuffer[0].nSamples * type; //
+	const float* data = s->getData() + channel*spikeSamples;
 
-    //int dSamples = 1;
+    Path path;
 
-    float x = 0.0f;
+	for (int i = 0; i < spikeSamples; i++)
+	{
+		float y = h - (h / 2 + data[i] / (range)* h);
 
+		if (signalFlipped)
+			y = h - y;
 
-	for (int i = 0; i < spikeSamples - 1; i++)
-	{
-		//std::cout << s.data[sampIdx] << std::endl;
+        if (i == 0)
+            path.startNewSubPath(0.0f, y);
+        else
+            path.lineTo(i * dx, y);
+	}
 
+    return path;
+}
 
-		float s1 = h - (h / 2 + s->getData()[offset + i] / (range)* h);
-		float s2 = h - (h / 2 + s->getData()[offset + i + 1] / (range)* h);
+void WaveformAxes::plotSpike(SorterSpikePtr s, Graphics& g)
+{
+	if (s.get() == nullptr) return;
 
-		if (signalFlipped)
-		{
-			s1 = h - s1;
-			s2 = h - s2;
-		}
-		g.drawLine(x,
-			s1,
-			x + dx,
-			s2);
-
-		x += dx;
-	}
+	g.setColour(Colour(s->color[0], s->color[1], s->color[2]));
+    g.strokePath(getSpikePath(s), PathStrokeType(1.0f));
+}
+
+void WaveformAxes::redrawSpikeImage()
+{
+    spikeImage.clear(spikeImage.getBounds());
+
+    Graphics g(spikeImage);
+
+    // oldest first, so that the latest spike is on top
+    for (int k = 1; k <= bufferSize; k++)
+        plotSpike(spikeBuffer[(spikeIndex + k) % bufferSize], g);
 
+    spikeImageNeedsRedraw = false;
+}
+
+void WaveformAxes::fadeSpikes(float fade)
+{
+    if (! spikeImage.isNull() && ! spikeImageNeedsRedraw)
+        spikeImage.multiplyAllAlphas(fade);
+}
+
+void WaveformAxes::resized()
+{
+    spikeImage = getWidth() > 0 && getHeight() > 0 ? Image(Image::ARGB, getWidth(), getHeight(), true) : Image();
+    spikeImageNeedsRedraw = true;
 }
 
 void WaveformAxes::drawThresholdSlider(Graphics& g)
@@ -1183,16 +1452,16 @@ bool WaveformAxes::updateSpikeData(SorterSpikePtr s)
         gotFirstSpike = true;
     }
 
-    if (spikesReceivedSinceLastRedraw < bufferSize)
-    {
-
-        spikeIndex++;
-        spikeIndex %= bufferSize;
+    spikeIndex++;
+    spikeIndex %= bufferSize;
 
-        spikeBuffer.set(spikeIndex, s);
-
-        spikesReceivedSinceLastRedraw++;
+    spikeBuffer.set(spikeIndex, s);
 
+    // new spikes are added to the image, which only has to be redrawn when the scaling changes
+    if (! spikeImage.isNull() && ! spikeImageNeedsRedraw)
+    {
+        Graphics g(spikeImage);
+        plotSpike(s, g);
     }
 
     return true;
@@ -1229,6 +1498,7 @@ void WaveformAxes::clear()
         spikeBuffer.add(nullptr);
     }
 
+    spikeImageNeedsRedraw = true;
     repaint();
 }
 
@@ -1632,9 +1902,6 @@ void WaveformAxes::drawBoxes(Graphics& g)
     float microsec_span = 40.0/30000.0 * 1e6;
     float microvolt_span = range/2;
 
-    int selectedUnitID, selectedBoxID;
-    processor->getActiveElectrode()->spikeSort->getSelectedUnitAndBox(selectedUnitID, selectedBoxID);
-
     // Typical spike is 40 samples, at 30kHz ~ 1.3 ms or 1300 usecs.
     for (int k = 0; k < units.size(); k++)
     {
@@ -1696,8 +1963,7 @@ void WaveformAxes::paint(Graphics& g)
     if (drawGrid)
         drawWaveformGrid(g);
 
-    double noise = processor->getSelectedElectrodeNoise();
-    String d = "STD: " + String(noise, 2) + "uV";
+    String d = "STD: " + String(noiseLevel, 2) + "uV";
     g.setFont(Font("Small Text", 13, Font::plain));
     g.setColour(Colours::white);
 
@@ -1708,28 +1974,15 @@ void WaveformAxes::paint(Graphics& g)
     drawThresholdSlider(g);
     drawBoxes(g);
     // if no spikes have been received then don't plot anything
-    if (!gotFirstSpike)
+    if (!gotFirstSpike || spikeImage.isNull())
     {
         return;
     }
 
+    if (spikeImageNeedsRedraw)
+        redrawSpikeImage();
 
-    for (int spikeNum = 0; spikeNum < bufferSize; spikeNum++)
-    {
-
-        if (spikeNum != spikeIndex && spikeBuffer[spikeNum] != nullptr)
-        {
-            g.setColour(Colours::grey);
-            plotSpike(spikeBuffer[spikeNum], g);
-        }
-
-    }
-
-    g.setColour(Colours::white);
-    if (spikeBuffer[spikeIndex] != nullptr)
-        plotSpike(spikeBuffer[spikeIndex], g);
-
-    spikesReceivedSinceLastRedraw = 0;
+    g.drawImageAt(spikeImage, 0, 0);
 
 }
 
@@ -1737,7 +1990,7 @@ void WaveformAxes::paint(Graphics& g)
 
 
 PCAProjectionAxes::PCAProjectionAxes(SpikeSorter* p) : GenericDrawAxes(0), processor(p), imageDim(500),
-    rangeX(250), rangeY(250), spikesReceivedSinceLastRedraw(0)
+    rangeX(250), rangeY(250), selectedUnitID(-1)
 {
     projectionImage = Image(Image::RGB, imageDim, imageDim, true);
     bufferSize = 600;
@@ -1791,13 +2044,16 @@ void PCAProjectionAxes::updateUnits(std::vector<PCAUnit> _units)
     units = _units;
 }
 
+void PCAProjectionAxes::setSelectedUnitID(int unitID)
+{
+    selectedUnitID = unitID;
+}
+
 void PCAProjectionAxes::drawUnit(Graphics& g, PCAUnit unit)
 {
     float w = getWidth();
     float h = getHeight();
 
-    int selectedUnitID, selectedBoxID;
-    processor->getActiveElectrode()->spikeSort->getSelectedUnitAndBox(selectedUnitID, selectedBoxID);
     g.setColour(Colour(unit.ColorRGB[0],unit.ColorRGB[1],unit.ColorRGB[2]));
     if (unit.poly.pts.size() > 2)
     {
@@ -1837,7 +2093,8 @@ void PCAProjectionAxes::drawUnit(Graphics& g, PCAUnit unit)
 void PCAProjectionAxes::paint(Graphics& g)
 {
 
-    spikesReceivedSinceLastRedraw = 0;
+    if (redrawSpikes)
+        redraw(false);
 
     g.drawImage(projectionImage,
                 0, 0, getWidth(), getHeight(),
@@ -1879,61 +2136,54 @@ void PCAProjectionAxes::paint(Graphics& g)
         }
     }
 
-    //Graphics im(projectionImage);
-
-    if (redrawSpikes)
-    {
-        // recompute image
-        //int w = getWidth();
-        //int h = getHeight();
-        projectionImage.clear(juce::Rectangle<int>(0, 0, projectionImage.getWidth(), projectionImage.getHeight()),
-                              Colours::black);
-
-        bool subsample = false;
-        int dk = (subsample) ? 5 : 1;
-
-        for (int k=0; k<bufferSize; k+=dk)
-        {
-            drawProjectedSpike(spikeBuffer[k]);
-        }
-        redrawSpikes = false;
-    }
-
 }
 
 
-void PCAProjectionAxes::drawProjectedSpike(SorterSpikePtr s)
+void PCAProjectionAxes::drawProjectedSpike(SorterSpikePtr s, Image::BitmapData& pixels)
 {
     if (s != nullptr && rangeSet)
     {
-        Graphics g(projectionImage);
-
-        g.setColour(Colour(s->color[0],s->color[1],s->color[2]));
+        const Colour colour(s->color[0],s->color[1],s->color[2]);
 
-        float x = (s->pcProj[0] - pcaMin[0]) / (pcaMax[0]-pcaMin[0]) * rangeX;
-        float y = (s->pcProj[1] - pcaMin[1]) / (pcaMax[1]-pcaMin[1]) * rangeY;
-        if (x >= 0 & y >= 0 & x <= rangeX & y <= rangeY)
-            g.fillEllipse(x,y,2,2);
+        // a 2x2 pixel point, written straight into the image
+        int x = int((s->pcProj[0] - pcaMin[0]) / (pcaMax[0]-pcaMin[0]) * rangeX);
+        int y = int((s->pcProj[1] - pcaMin[1]) / (pcaMax[1]-pcaMin[1]) * rangeY);
+        if (x >= 0 & y >= 0 & x < rangeX & y < rangeY)
+        {
+            pixels.setPixelColour(x, y, colour);
+            pixels.setPixelColour(x + 1, y, colour);
+            pixels.setPixelColour(x, y + 1, colour);
+            pixels.setPixelColour(x + 1, y + 1, colour);
+        }
     }
 }
 
 void PCAProjectionAxes::redraw(bool subsample)
 {
-    Graphics g(projectionImage);
-
     // recompute image
-    //int w = getWidth();
-    //int h = getHeight();
     projectionImage.clear(juce::Rectangle<int>(0, 0, projectionImage.getWidth(), projectionImage.getHeight()),
                           Colours::black);
 
+    Image::BitmapData pixels(projectionImage, Image::BitmapData::writeOnly);
+
     int dk = (subsample) ? 5 : 1;
 
-    for (int k=0; k<bufferSize; k+=dk)
+    for (int k=0; k<spikeBuffer.size(); k+=dk)
     {
-        drawProjectedSpike(spikeBuffer[k]);
+        drawProjectedSpike(spikeBuffer[k], pixels);
     }
 
+    redrawSpikes = false;
+}
+
+void PCAProjectionAxes::fadeSpikes(float fade)
+{
+    if (redrawSpikes)
+        return;
+
+    Graphics g(projectionImage);
+    g.setColour(Colours::black.withAlpha(1.0f - fade));
+    g.fillRect(0, 0, rangeX, rangeY);
 }
 
 void PCAProjectionAxes::setPCARange(float p1min, float p2min, float p1max, float p2max)
@@ -1952,18 +2202,16 @@ void PCAProjectionAxes::setPCARange(float p1min, float p2min, float p1max, float
 bool PCAProjectionAxes::updateSpikeData(SorterSpikePtr s)
 {
 
-    if (spikesReceivedSinceLastRedraw < bufferSize)
-    {
-
-        spikeIndex++;
-        spikeIndex %= bufferSize;
-
-        spikeBuffer.set(spikeIndex, s);
+    spikeIndex++;
+    spikeIndex %= bufferSize;
 
-        spikesReceivedSinceLastRedraw++;
-        //drawProjectedSpike(newSpike);
-        redrawSpikes = true;
+    spikeBuffer.set(spikeIndex, s);
 
+    // new spikes are added to the image, which only has to be redrawn when the range changes
+    if (! redrawSpikes)
+    {
+        Image::BitmapData pixels(projectionImage, Image::BitmapData::writeOnly);
+        drawProjectedSpike(s, pixels);
     }
     return true;
 }
@@ -56,12 +56,17 @@ class GenericAxes;
 class ProjectionAxes;
 class WaveAxes;
 class SpikePlot;
+class SpikeThumbnail;
 class RecordNode;
 
 /**
 
   Displays spike waveforms and projections for Spike Sorter
 
+  The selected electrode is shown in full, the others as thumbnails under it. The
+  processing thread only queues its spikes; they are drawn into images that fade
+  on each refresh, so a refresh costs the same however many spikes came in.
+
   @see SpikeDisplayNode, SpikeDisplayEditor, Visualizer
 
 */
@@ -95,6 +100,9 @@ public:
 
     void buttonClicked(Button* button);
 
+    /** Asks for a recording and re-sorts its spikes with the current units, see OfflineResorter */
+    void resortRecording();
+
     void startRecording() { } // unused
     void stopRecording() { } // unused
 
@@ -102,7 +110,7 @@ public:
 
     // added editAllThresholds
     ScopedPointer<UtilityButton> addPolygonUnitButton,
-                  addUnitButton, delUnitButton, addBoxButton, delBoxButton, rePCAButton,nextElectrode,prevElectrode,newIDbuttons,deleteAllUnits,editAllThresholds;
+                  addUnitButton, delUnitButton, addBoxButton, delBoxButton, rePCAButton,nextElectrode,prevElectrode,newIDbuttons,deleteAllUnits,editAllThresholds,resortButton;
 
 private:
     void removeUnitOrBox();
@@ -130,6 +138,10 @@ public:
     void removePlots();
     void clear();
     SpikeHistogramPlot* addSpikePlot(int numChannels, int electrodeNum, String name);
+    SpikeThumbnail* addThumbnail(int electrodeIndex, String name, float range);
+
+    /** Draws the spikes queued since the last refresh */
+    void refresh();
 
     void paint(Graphics& g);
 
@@ -153,7 +165,48 @@ private:
     Viewport* viewport;
 
     OwnedArray<SpikeHistogramPlot> spikePlots;
+    OwnedArray<SpikeThumbnail> thumbnails;
+
+
+};
+
+
+/**
+
+  Small view of the recent waveforms of an electrode that isn't selected, all its
+  channels side by side. Clicking it selects the electrode.
+
+*/
+
+class SpikeThumbnail : public Component
+{
+public:
+    SpikeThumbnail(SpikeSorter* processor, int electrodeIndex, String name, float range);
+    ~SpikeThumbnail();
+
+    /** Queues a spike for the next refresh. Called by the processing thread. */
+    void addSpike(SorterSpikePtr s);
+
+    /** Fades the waveforms drawn so far and draws the queued ones */
+    void refresh(float fade);
+
+    void paint(Graphics& g);
+    void resized();
+    void mouseDown(const MouseEvent& event);
+
+private:
+    SpikeSorter* processor;
+    int electrodeIndex;
+    String name;
+    float range;
 
+    SpinLock pendingLock;
+    ReferenceCountedArray<SorterSpikeContainer> pendingSpikes;
+    ReferenceCountedArray<SorterSpikeContainer> receivedSpikes;
+
+    Image spikeImage;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpikeThumbnail);
 
 };
 
@@ -215,11 +268,19 @@ public:
 	bool updateSpikeData(SorterSpikePtr s);
 	bool checkThreshold(SorterSpikePtr spike);
 
+    /** Multiplies the opacity of the waveforms drawn so far */
+    void fadeSpikes(float fade);
+
+    void setNoiseLevel(double noise);
+    void setSelectedUnitAndBox(int unitID, int boxID);
+
     void setSignalFlip(bool state);
     void paint(Graphics& g);
+    void resized();
     void isOverUnitBox(float x, float y, int& UnitID, int& BoxID, String& where) ;
 
 	void plotSpike(SorterSpikePtr s, Graphics& g);
+    Path getSpikePath(SorterSpikePtr s);
     void drawBoxes(Graphics& g);
 
     void clear();
@@ -265,8 +326,6 @@ private:
 
     void drawThresholdSlider(Graphics& g);
 
-    int spikesReceivedSinceLastRedraw;
-
     Font font;
     float mouseDownX, mouseDownY;
     float mouseOffsetX,mouseOffsetY;
@@ -275,6 +334,15 @@ private:
     int spikeIndex;
     int bufferSize;
 
+    // waveforms drawn so far, redrawn from spikeBuffer when the scaling changes
+    Image spikeImage;
+    bool spikeImageNeedsRedraw;
+    void redrawSpikeImage();
+
+    // copied on each refresh, so that painting doesn't wait for the sorter
+    double noiseLevel;
+    int selectedUnitID, selectedBoxID;
+
     float range;
 
     bool isOverThresholdSlider;
@@ -299,6 +367,11 @@ public:
 
     void setPCARange(float p1min, float p2min, float p1max, float p2max);
 	bool updateSpikeData(SorterSpikePtr s);
+
+    /** Darkens the points drawn so far */
+    void fadeSpikes(float fade);
+
+    void setSelectedUnitID(int unitID);
     void resized();
     void paint(Graphics& g);
     void setPolygonDrawingMode(bool on);
@@ -322,7 +395,7 @@ public:
 private:
     float prevx,prevy;
     bool inPolygonDrawingMode;
-	void drawProjectedSpike(SorterSpikePtr s);
+	void drawProjectedSpike(SorterSpikePtr s, Image::BitmapData& pixels);
 
     bool rangeSet;
     SpikeSorter* processor;
@@ -346,13 +419,12 @@ private:
     int rangeX;
     int rangeY;
 
-    int spikesReceivedSinceLastRedraw;
-
     float pcaMin[2],pcaMax[2];
     std::list<PointD> drawnPolygon;
 
     std::vector<PCAUnit> units;
     int isOverUnit;
+    int selectedUnitID;
     PCAUnit drawnUnit;
 
     bool redrawSpikes;
@@ -376,8 +448,13 @@ public:
     void setPCARange(float p1min, float p2min, float p1max, float p2max);
     void modifyRange(int index,bool up);
     void updateUnitsFromProcessor();
+
+    /** Queues a spike for the next refresh. Called by the processing thread. */
 	void processSpikeObject(SorterSpikePtr s);
 
+    /** Draws the spikes queued since the last refresh into the axes */
+    void refresh(float fade);
+
     SpikeSorterCanvas* canvas;
 
     bool isSelected;
@@ -430,6 +507,13 @@ private:
     CriticalSection mut;
     Font font;
 
+    // handed from the processing thread to refresh()
+    SpinLock pendingLock;
+    ReferenceCountedArray<SorterSpikeContainer> pendingSpikes;
+    ReferenceCountedArray<SorterSpikeContainer> receivedSpikes;
+    bool pcaRangeChanged;
+    float pcaRange[4];
+
 
 
 };
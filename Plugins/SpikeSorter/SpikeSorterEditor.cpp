@@ -329,6 +329,14 @@ void SpikeSorterEditor::buttonEvent(Button* button)
         configMenu.addSubMenu("Waveform",waveSizeMenu,true);
         configMenu.addItem(5,"Current Channel => Audio",true,processor->getAutoDacAssignmentStatus());
         configMenu.addItem(6,"Threshold => All channels",true,processor->getThresholdSyncStatus());
+        configMenu.addItem(9,"Template matching",true,processor->getTemplateMatchingState());
+
+        PopupMenu autoThresholdMenu;
+        const float autoThreshold = processor->getAutoThreshold();
+        autoThresholdMenu.addItem(8, "Off", true, autoThreshold == 0);
+        for (int k = 3; k <= 6; k++)
+            autoThresholdMenu.addItem(8 + k, String(k) + " x noise", true, autoThreshold == k);
+        configMenu.addSubMenu("Auto threshold", autoThresholdMenu);
 
         const int result = configMenu.show();
         switch (result)
@@ -359,6 +367,18 @@ void SpikeSorterEditor::buttonEvent(Button* button)
             case 7:
                 processor->setFlipSignalState(!processor->getFlipSignalState());
                 break;
+            case 8:
+                processor->setAutoThreshold(0);
+                break;
+            case 9:
+                processor->setTemplateMatchingState(!processor->getTemplateMatchingState());
+                break;
+            case 11:
+            case 12:
+            case 13:
+            case 14:
+                processor->setAutoThreshold(result - 8);
+                break;
         }
 
     }
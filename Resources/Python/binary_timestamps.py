@@ -0,0 +1,69 @@
+"""Loads the timestamps of a continuous file of a Binary format recording.
+
+Recordings made with "Sparse continuous timestamps" have a timestamp_runs.npy
+instead of timestamps.npy. Each row holds a sample number and the timestamp of
+that sample; the samples up to the next row count up by one from it, and the
+last row holds the total number of samples. This rebuilds the per-sample array,
+or the timestamps of just a range of samples, from either kind of file:
+
+Recordings of only the snippets around events also have a snippets.npy, with the
+sample number and timestamp of the start of each snippet, stored one after another.
+
+    python binary_timestamps.py <recording>/continuous/<folder>
+"""
+from __future__ import print_function
+import os
+import sys
+
+import numpy as np
+
+
+def load_runs(folder):
+    """Returns the (sample, timestamp) rows of a folder, or None if it has dense timestamps"""
+    path = os.path.join(folder, 'timestamp_runs.npy')
+    if not os.path.exists(path):
+        return None
+    return np.load(path, mmap_mode='r').reshape(-1, 2)
+
+
+def load_snippets(folder):
+    """Returns the (sample, timestamp) start of every snippet of a folder, or None if all the data was recorded"""
+    path = os.path.join(folder, 'snippets.npy')
+    if not os.path.exists(path):
+        return None
+    return np.load(path, mmap_mode='r').reshape(-1, 2)
+
+
+def timestamps_from_runs(runs, start=0, stop=None):
+    """Timestamps of the samples [start, stop) described by the rows of timestamp_runs.npy"""
+    if stop is None:
+        stop = int(runs[-1, 0])
+    samples = np.arange(start, max(start, stop), dtype=np.int64)
+    # run each sample belongs to; the last row only marks the end
+    run = np.searchsorted(runs[:-1, 0], samples, side='right') - 1
+    run = np.maximum(run, 0)
+    return runs[run, 1] + (samples - runs[run, 0])
+
+
+def load_timestamps(folder, start=0, stop=None):
+    """Timestamps of the samples [start, stop) of a continuous folder"""
+    runs = load_runs(folder)
+    if runs is not None:
+        return timestamps_from_runs(runs, start, stop)
+    timestamps = np.load(os.path.join(folder, 'timestamps.npy'), mmap_mode='r')
+    return np.array(timestamps[start:stop])
+
+
+def main(folder):
+    runs = load_runs(folder)
+    timestamps = load_timestamps(folder)
+    print('%d samples, first timestamp %d' % (len(timestamps), timestamps[0] if len(timestamps) else 0))
+    if runs is not None:
+        print('%d discontinuities' % (len(runs) - 2))
+    snippets = load_snippets(folder)
+    if snippets is not None:
+        print('%d snippets' % len(snippets))
+
+
+if __name__ == '__main__':
+    main(sys.argv[1])
@@ -0,0 +1,58 @@
+"""Reads live samples from the shared memory ring of a Network Sink.
+
+Run the GUI with a Network Sink set to "Shared mem.", start acquisition, then:
+
+    python shared_ring_reader.py /dev/shm/open-ephys
+
+The ring layout is documented in Source/Processors/NetworkSink/SharedMemoryRing.h.
+"""
+from __future__ import print_function
+import struct
+import sys
+import time
+
+import numpy as np
+
+HEADER = struct.Struct('<IHHIIfIq32x')
+MAGIC = 0x4D53454F
+
+
+def open_ring(path):
+    raw = np.memmap(path, dtype=np.uint8, mode='r')
+    magic, version, header_bytes, n_chans, capacity, rate, running, _ = \
+        HEADER.unpack(raw[:HEADER.size].tobytes())
+    assert magic == MAGIC, 'not an Open Ephys ring'
+    timestamps = np.frombuffer(raw, dtype='<i8', count=capacity, offset=header_bytes)
+    samples = np.frombuffer(raw, dtype='<f4', count=n_chans * capacity,
+                            offset=header_bytes + 8 * capacity).reshape(n_chans, capacity)
+    return raw, timestamps, samples, rate
+
+
+def write_index(raw):
+    return struct.unpack_from('<q', raw, 24)[0]
+
+
+def main(path):
+    raw, timestamps, samples, rate = open_ring(path)
+    capacity = samples.shape[1]
+    last = write_index(raw)
+    print('%d channels at %g Hz' % (samples.shape[0], rate))
+
+    while True:
+        time.sleep(0.05)
+        current = write_index(raw)
+        # older samples have been overwritten
+        first = max(last, current - capacity)
+        idx = np.arange(first, current) % capacity
+        block = samples[:, idx]
+        # samples may have been overwritten while copying
+        if write_index(raw) - capacity > first:
+            print('reader too slow, skipping ahead')
+        elif block.size:
+            print('%d samples from %d, channel 0 mean %.2f uV'
+                  % (block.shape[1], timestamps[idx[0]], block[0].mean()))
+        last = current
+
+
+if __name__ == '__main__':
+    main(sys.argv[1] if len(sys.argv) > 1 else '/dev/shm/open-ephys')
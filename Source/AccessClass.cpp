@@ -134,6 +134,8 @@ ActionBroadcaster* getBroadcaster()
 
 MidiBuffer* ExternalProcessorAccessor::getMidiBuffer(GenericProcessor* proc)
 {
+	// the caller may write to it, which leaves the processor's event index stale
+	proc->m_eventGeneration++;
 	return proc->m_currentMidiBuffer;
 }
 
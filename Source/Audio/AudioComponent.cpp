@@ -23,10 +23,245 @@
 
 
 #include "AudioComponent.h"
+#include "../Processors/DataThreads/DataThread.h"
 #include <stdio.h>
+#include <atomic>
 
-AudioComponent::AudioComponent() : isPlaying(false)
+/** Plays the graph's output on the audio device while the graph runs from the software
+clock, resampled from the clock's rate to the device's*/
+class AudioComponent::MonitorOutput : public AudioIODeviceCallback
 {
+public:
+    MonitorOutput(double sourceRate_, int sourceBlockSize_)
+        : sourceRate(sourceRate_), sourceBlockSize(sourceBlockSize_), deviceRate(0.0),
+          targetFill(0), primed(false), fifo(jmax(4096, int(sourceRate_))), samples(2, fifo.getTotalSize())
+    {}
+
+    /** Queues a block of the graph's output. Called by the driver thread after each block;
+    whatever doesn't fit is dropped*/
+    void push(const AudioSampleBuffer& block)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(block.getNumSamples(), start1, size1, start2, size2);
+
+        for (int ch = 0; ch < samples.getNumChannels(); ch++)
+        {
+            const int srcChannel = jmin(ch, block.getNumChannels() - 1);
+            if (size1 > 0)
+                samples.copyFrom(ch, start1, block, srcChannel, 0, size1);
+            if (size2 > 0)
+                samples.copyFrom(ch, start2, block, srcChannel, size1, size2);
+        }
+
+        fifo.finishedWrite(size1 + size2);
+    }
+
+    void audioDeviceAboutToStart(AudioIODevice* device) override
+    {
+        deviceRate = device->getCurrentSampleRate();
+        const int deviceBlock = device->getCurrentBufferSizeSamples();
+        const double ratio = sourceRate / jmax(1.0, deviceRate);
+
+        // enough queued to cover a device block and a clock block arriving late
+        targetFill = jmin(fifo.getTotalSize() / 2, int(std::ceil(deviceBlock * ratio)) + 2 * sourceBlockSize);
+        scratch.setSize(samples.getNumChannels(), int(std::ceil(deviceBlock * ratio * 1.01)) + 8);
+        for (int ch = 0; ch < numElementsInArray(interpolators); ch++)
+            interpolators[ch].reset();
+        fifo.reset();
+        primed = false;
+    }
+
+    void audioDeviceStopped() override
+    {
+        deviceRate = 0.0;
+    }
+
+    void audioDeviceIOCallback(const float** /*inputChannelData*/, int /*numInputChannels*/,
+                               float** outputChannelData, int numOutputChannels, int numSamples) override
+    {
+        for (int ch = 0; ch < numOutputChannels; ch++)
+            if (outputChannelData[ch] != nullptr)
+                FloatVectorOperations::clear(outputChannelData[ch], numSamples);
+
+        if (deviceRate <= 0)
+            return;
+
+        // the two clocks drift apart, so the queue is kept around its target by
+        // playing slightly faster or slower
+        const int ready = fifo.getNumReady();
+        double ratio = sourceRate / deviceRate;
+        if (ready > 2 * targetFill)
+            ratio *= 1.005;
+        else if (ready < targetFill / 2)
+            ratio *= 0.995;
+
+        if (!primed)
+            primed = ready >= targetFill;
+
+        const int needed = int(std::ceil(numSamples * ratio)) + 4;
+        if (!primed || ready < needed || needed > scratch.getNumSamples())
+        {
+            // underrun: wait for the queue to fill up again
+            primed = false;
+            return;
+        }
+
+        // the interpolator needs contiguous input
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(needed, start1, size1, start2, size2);
+        for (int ch = 0; ch < samples.getNumChannels(); ch++)
+        {
+            scratch.copyFrom(ch, 0, samples, ch, start1, size1);
+            if (size2 > 0)
+                scratch.copyFrom(ch, size1, samples, ch, start2, size2);
+        }
+
+        int used = 0;
+        for (int ch = 0; ch < jmin(numOutputChannels, samples.getNumChannels()); ch++)
+            if (outputChannelData[ch] != nullptr)
+                used = interpolators[ch].process(ratio, scratch.getReadPointer(ch), outputChannelData[ch], numSamples);
+
+        fifo.finishedRead(jmin(used, needed));
+    }
+
+private:
+    const double sourceRate;
+    const int sourceBlockSize;
+    double deviceRate;
+    int targetFill;
+    bool primed;
+    AbstractFifo fifo;
+    AudioSampleBuffer samples;
+    AudioSampleBuffer scratch;
+    LagrangeInterpolator interpolators[2];
+};
+
+/** Clocks the graph from a normal thread, one block right after the other*/
+class AudioComponent::BatchDriver : public Thread
+{
+public:
+    BatchDriver(AudioProcessorGraph* graph_, double sampleRate_, int bufferSize_, bool dataDriven_, double speed_,
+                double latencyTargetMs_ = 0.0, MonitorOutput* monitor_ = nullptr)
+        : Thread(dataDriven_ ? "Data driven processing" : (latencyTargetMs_ > 0 ? "Software clock" : "Batch processing")),
+          graph(graph_), sampleRate(sampleRate_),
+          bufferSize(bufferSize_), dataDriven(dataDriven_), speed(dataDriven_ ? 0.0 : speed_),
+          latencyTargetMs(latencyTargetMs_), monitor(monitor_),
+          numBlocks(0), numLatencyBlocks(0), totalLatencyTicks(0), maxLatencyTicks(0), numLateBlocks(0)
+    {}
+
+    void run() override
+    {
+        // what AudioProcessorPlayer does when a device starts
+        graph->setRateAndBufferSizeDetails(sampleRate, bufferSize);
+        graph->prepareToPlay(sampleRate, bufferSize);
+
+        AudioSampleBuffer buffer(jmax(1, graph->getTotalNumInputChannels(), graph->getTotalNumOutputChannels()), bufferSize);
+        MidiBuffer midiMessages;
+
+        // without new data the graph still runs once per buffer period, so sources that
+        // don't notify and the processors downstream keep going
+        const int timeoutMs = jmax(1, int(1000.0 * bufferSize / sampleRate));
+
+        // with a playback speed the blocks are spaced by their duration divided by it
+        const double blockMs = 1000.0 * bufferSize / sampleRate;
+        double pacingStartMs = Time::getMillisecondCounterHiRes();
+        int64 pacedBlocks = 0;
+
+        // software clock only: how long before each block the thread stops sleeping and
+        // spins instead, as sleeps can overshoot by a millisecond or more
+        double spinMs = latencyTargetMs > 0 ? 1.0 : 0.0;
+
+        while (!threadShouldExit())
+        {
+            int64 dataTicks = 0;
+            if (dataDriven)
+                dataTicks = DataThread::waitForNewData(timeoutMs);
+
+            buffer.clear();
+            midiMessages.clear();
+
+            {
+                const ScopedLock sl(graph->getCallbackLock());
+
+                if (!graph->isSuspended())
+                    graph->processBlock(buffer, midiMessages);
+            }
+
+            ++numBlocks;
+
+            if (monitor != nullptr)
+                monitor->push(buffer);
+
+            if (dataTicks != 0)
+            {
+                // from the data thread publishing the samples to the whole graph having processed them
+                int64 latency = Time::getHighResolutionTicks() - dataTicks;
+                ++numLatencyBlocks;
+                totalLatencyTicks += latency;
+                if (latency > maxLatencyTicks)
+                    maxLatencyTicks = latency;
+            }
+
+            if (speed > 0)
+            {
+                const double dueMs = pacingStartMs + ++pacedBlocks * blockMs / speed;
+                const double aheadMs = dueMs - Time::getMillisecondCounterHiRes();
+                if (aheadMs - spinMs >= 1.0)
+                {
+                    wait(int(aheadMs - spinMs));
+                }
+                else if (aheadMs < -1000.0)
+                {
+                    // fell far behind, e.g. a slow chain: carry on from here rather than rushing to catch up
+                    pacingStartMs = Time::getMillisecondCounterHiRes();
+                    pacedBlocks = 0;
+                    continue;
+                }
+
+                if (latencyTargetMs > 0)
+                {
+                    while (Time::getMillisecondCounterHiRes() < dueMs && !threadShouldExit())
+                        Thread::yield();
+
+                    if (Time::getMillisecondCounterHiRes() - dueMs > latencyTargetMs)
+                    {
+                        ++numLateBlocks;
+                        spinMs = jmin(spinMs * 2.0, blockMs / 2.0);
+                    }
+                }
+            }
+        }
+
+        graph->releaseResources();
+    }
+
+    AudioProcessorGraph* const graph;
+    const double sampleRate;
+    const int bufferSize;
+    const bool dataDriven;
+    const double speed;
+    const double latencyTargetMs;
+    MonitorOutput* const monitor;
+    std::atomic<int64> numBlocks;
+    std::atomic<int64> numLatencyBlocks;
+    std::atomic<int64> totalLatencyTicks;
+    std::atomic<int64> maxLatencyTicks;
+    std::atomic<int64> numLateBlocks;
+};
+
+AudioComponent::AudioComponent(bool useAudioDevice_)
+    : isPlaying(false), useAudioDevice(useAudioDevice_), graph(nullptr),
+      batchSampleRate(44100.0), batchBufferSize(1024), playbackSpeed(useAudioDevice_ ? 1.0 : 0.0), usingDriver(false),
+      useSoftwareClock(false), clockSampleRate(30000.0), clockBufferSize(64), clockLatencyTargetMs(0.5)
+{
+    graphPlayer = new AudioProcessorPlayer();
+
+    if (!useAudioDevice)
+    {
+        std::cout << "No audio device, callbacks come from the batch processing thread." << std::endl;
+        return;
+    }
+
     bool initialized = false;
     while (!initialized)
     {
@@ -69,11 +304,13 @@ AudioComponent::AudioComponent() : isPlaying(false)
     {
         String titleMessage = String("No audio device found");
         String contentMessage = String("Couldn't find an audio device. ") +
-                                String("Perhaps some other program has control of the default one.");
+                                String("Perhaps some other program has control of the default one. ") +
+                                String("The software clock will drive acquisition, without audio output.");
         AlertWindow::showMessageBox(AlertWindow::InfoIcon,
                                     titleMessage,
                                     contentMessage);
-        JUCEApplication::quit();
+        useSoftwareClock = true;
+        return;
     }
 
 
@@ -107,8 +344,6 @@ AudioComponent::AudioComponent() : isPlaying(false)
     std::cout << "Audio device sample rate: " <<  sr << std::endl;
     std::cout << "Audio device buffer size: " << buffSize << std::endl << std::endl;
 
-    graphPlayer = new AudioProcessorPlayer();
-
     stopDevice(); // reduces the amount of background processing when
     // device is not in use
 
@@ -125,6 +360,12 @@ AudioComponent::~AudioComponent()
 
 int AudioComponent::getBufferSize()
 {
+    if (!useAudioDevice)
+        return batchBufferSize;
+
+    if (useSoftwareClock)
+        return clockBufferSize;
+
     AudioDeviceManager::AudioDeviceSetup setup;
     deviceManager.getAudioDeviceSetup(setup);
 
@@ -133,14 +374,117 @@ int AudioComponent::getBufferSize()
 
 int AudioComponent::getBufferSizeMs()
 {
+    return int(float(getBufferSize())/getSampleRate()*1000);
+}
+
+double AudioComponent::getSampleRate()
+{
+    if (!useAudioDevice)
+        return batchSampleRate;
+
+    if (useSoftwareClock)
+        return clockSampleRate;
+
     AudioDeviceManager::AudioDeviceSetup setup;
     deviceManager.getAudioDeviceSetup(setup);
 
-    return int(float(setup.bufferSize)/setup.sampleRate*1000);
+    return setup.sampleRate;
+}
+
+bool AudioComponent::isHeadless() const
+{
+    return !useAudioDevice;
+}
+
+void AudioComponent::setBatchSettings(double sampleRate, int bufferSize)
+{
+    if (useAudioDevice || isPlaying)
+        return;
+
+    if (sampleRate > 0)
+        batchSampleRate = sampleRate;
+    if (bufferSize > 0)
+        batchBufferSize = bufferSize;
+}
+
+void AudioComponent::setPlaybackSpeed(double speed)
+{
+    playbackSpeed = jmax(0.0, speed);
+}
+
+double AudioComponent::getPlaybackSpeed() const
+{
+    return playbackSpeed;
+}
+
+void AudioComponent::resetPlaybackSpeed()
+{
+    playbackSpeed = useAudioDevice ? 1.0 : 0.0;
+}
+
+void AudioComponent::setSoftwareClock(bool enabled, double sampleRate, int bufferSize, double latencyTargetMs)
+{
+    if (!useAudioDevice || isPlaying)
+        return;
+
+    // without a device the software clock is the only choice
+    useSoftwareClock = enabled || deviceManager.getCurrentAudioDevice() == nullptr;
+    if (sampleRate > 0)
+        clockSampleRate = sampleRate;
+    if (bufferSize > 0)
+        clockBufferSize = bufferSize;
+    if (latencyTargetMs > 0)
+        clockLatencyTargetMs = latencyTargetMs;
+}
+
+bool AudioComponent::usesSoftwareClock() const
+{
+    return useAudioDevice && useSoftwareClock;
+}
+
+double AudioComponent::getSoftwareClockLatencyTargetMs() const
+{
+    return clockLatencyTargetMs;
+}
+
+int64 AudioComponent::getNumLateBlocks() const
+{
+    return batchDriver != nullptr ? batchDriver->numLateBlocks.load() : 0;
+}
+
+bool AudioComponent::isPaced() const
+{
+    return usingDriver || !useAudioDevice;
+}
+
+int64 AudioComponent::getNumBatchBlocks() const
+{
+    return batchDriver != nullptr ? batchDriver->numBlocks.load() : 0;
+}
+
+bool AudioComponent::isDataDriven() const
+{
+    return isPlaying && batchDriver != nullptr && batchDriver->dataDriven;
+}
+
+AudioComponent::LatencyStats AudioComponent::getDataDrivenLatency() const
+{
+    LatencyStats stats;
+
+    if (batchDriver != nullptr && batchDriver->numLatencyBlocks > 0)
+    {
+        const double ticksPerMs = Time::getHighResolutionTicksPerSecond() / 1000.0;
+        stats.numBlocks = batchDriver->numLatencyBlocks;
+        stats.meanMs = batchDriver->totalLatencyTicks / ticksPerMs / stats.numBlocks;
+        stats.maxMs = batchDriver->maxLatencyTicks / ticksPerMs;
+    }
+
+    return stats;
 }
 
 void AudioComponent::connectToProcessorGraph(AudioProcessorGraph* processorGraph)
 {
+    graph = processorGraph;
 
     graphPlayer->setProcessor(processorGraph);
 
@@ -148,6 +492,7 @@ void AudioComponent::connectToProcessorGraph(AudioProcessorGraph* processorGraph
 
 void AudioComponent::disconnectProcessorGraph()
 {
+    graph = nullptr;
 
     graphPlayer->setProcessor(0);
 
@@ -160,6 +505,9 @@ bool AudioComponent::callbacksAreActive()
 
 void AudioComponent::restartDevice()
 {
+    if (!useAudioDevice)
+        return;
+
     deviceManager.restartLastAudioDevice();
 
 }
@@ -173,7 +521,54 @@ void AudioComponent::stopDevice()
 void AudioComponent::beginCallbacks()
 {
 
-    if (!isPlaying)
+    if (!isPlaying && !useAudioDevice)
+    {
+        std::cout << std::endl << "Starting batch processing thread." << std::endl;
+        batchDriver = new BatchDriver(graph, batchSampleRate, batchBufferSize, DataThread::getNumDataDrivenSources() > 0, playbackSpeed);
+        batchDriver->startThread();
+        usingDriver = true;
+        isPlaying = true;
+    }
+    else if (!isPlaying && DataThread::getNumDataDrivenSources() > 0)
+    {
+        // a closed-loop source wants each block processed as soon as it arrives; the device
+        // buffer size only bounds the block length and the sound card is not used
+        std::cout << std::endl << "Starting data driven processing thread, audio output is disabled." << std::endl;
+        batchDriver = new BatchDriver(graph, getSampleRate(), getBufferSize(), true, 0.0);
+        batchDriver->startThread(9);
+        usingDriver = true;
+        isPlaying = true;
+    }
+    else if (!isPlaying && playbackSpeed != 1.0)
+    {
+        // played slower or faster than real time: the blocks keep the device's size and
+        // rate, but are clocked by a thread instead of the sound card
+        std::cout << std::endl << "Starting playback at " << (playbackSpeed > 0 ? String(playbackSpeed) + "x" : String("full"))
+                  << " speed, audio output is disabled." << std::endl;
+        batchDriver = new BatchDriver(graph, getSampleRate(), getBufferSize(), false, playbackSpeed);
+        batchDriver->startThread(8);
+        usingDriver = true;
+        isPlaying = true;
+    }
+    else if (!isPlaying && useSoftwareClock)
+    {
+        std::cout << std::endl << "Starting the software clock: " << clockBufferSize << " samples at "
+                  << clockSampleRate << " Hz, latency target " << clockLatencyTargetMs << " ms." << std::endl;
+
+        // the device only plays the monitor output, on its own callback
+        restartDevice();
+        if (deviceManager.getCurrentAudioDevice() != nullptr)
+        {
+            monitorOutput = new MonitorOutput(clockSampleRate, clockBufferSize);
+            deviceManager.addAudioCallback(monitorOutput);
+        }
+
+        batchDriver = new BatchDriver(graph, clockSampleRate, clockBufferSize, false, 1.0, clockLatencyTargetMs, monitorOutput);
+        batchDriver->startThread(10);
+        usingDriver = true;
+        isPlaying = true;
+    }
+    else if (!isPlaying)
     {
 
         //const MessageManagerLock mmLock;
@@ -246,6 +641,33 @@ void AudioComponent::endCallbacks()
     //     std::cout << "NOT THE MESSAGE THREAD -- AUDIO COMPONENT" << std::endl;
 
 
+    if (!useAudioDevice || usingDriver)
+    {
+        std::cout << std::endl << "Stopping batch processing thread." << std::endl;
+        if (batchDriver != nullptr)
+        {
+            batchDriver->signalThreadShouldExit();
+            batchDriver->waitForThreadToExit(-1);
+
+            LatencyStats latency = getDataDrivenLatency();
+            if (latency.numBlocks > 0)
+                std::cout << "Data to processed block latency: mean " << latency.meanMs << " ms, max "
+                          << latency.maxMs << " ms over " << latency.numBlocks << " blocks." << std::endl;
+            if (batchDriver->latencyTargetMs > 0)
+                std::cout << batchDriver->numLateBlocks.load() << " of " << batchDriver->numBlocks.load()
+                          << " blocks started later than the latency target." << std::endl;
+        }
+        if (monitorOutput != nullptr)
+        {
+            deviceManager.removeAudioCallback(monitorOutput);
+            monitorOutput = nullptr;
+            stopDevice();
+        }
+        usingDriver = false;
+        isPlaying = false;
+        return;
+    }
+
     std::cout << std::endl << "Removing audio callback." << std::endl;
     deviceManager.removeAudioCallback(graphPlayer);
     isPlaying = false;
@@ -265,6 +687,13 @@ void AudioComponent::endCallbacks()
 
 void AudioComponent::saveStateToXml(XmlElement* parent)
 {
+    if (!useAudioDevice)
+    {
+        parent->setAttribute("sampleRate", batchSampleRate);
+        parent->setAttribute("bufferSize", batchBufferSize);
+        return;
+    }
+
     // JUCE's audioState XML format (includes all info)
     ScopedPointer<XmlElement> audioState = deviceManager.createStateXml();
 
@@ -281,10 +710,23 @@ void AudioComponent::saveStateToXml(XmlElement* parent)
     parent->setAttribute("sampleRate", setup.sampleRate);
     parent->setAttribute("bufferSize", setup.bufferSize);
     parent->setAttribute("deviceType", deviceManager.getCurrentAudioDeviceType());
+
+    parent->setAttribute("softwareClock", useSoftwareClock);
+    parent->setAttribute("clockSampleRate", clockSampleRate);
+    parent->setAttribute("clockBufferSize", clockBufferSize);
+    parent->setAttribute("clockLatencyTargetMs", clockLatencyTargetMs);
 }
 
 void AudioComponent::loadStateFromXml(XmlElement* parent)
 {
+    if (!useAudioDevice)
+    {
+        // only the block timing matters without a device
+        int bufferSize = parent->getIntAttribute("bufferSize");
+        setBatchSettings(parent->getDoubleAttribute("sampleRate"), (bufferSize > 16 && bufferSize < 6000) ? bufferSize : 0);
+        return;
+    }
+
     forEachXmlChildElement(*parent, child)
     {
         if (!child->isTextElement())
@@ -333,4 +775,9 @@ void AudioComponent::loadStateFromXml(XmlElement* parent)
     }
 
     deviceManager.setAudioDeviceSetup(setup, true);
+
+    setSoftwareClock(parent->getBoolAttribute("softwareClock", false),
+                     parent->getDoubleAttribute("clockSampleRate", clockSampleRate),
+                     parent->getIntAttribute("clockBufferSize", clockBufferSize),
+                     parent->getDoubleAttribute("clockLatencyTargetMs", clockLatencyTargetMs));
 }
\ No newline at end of file
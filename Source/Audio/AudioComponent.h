@@ -31,9 +31,11 @@
   Interfaces with system audio hardware.
 
   Uses the audio card to generate the callbacks to run the ProcessorGraph
-  during data acquisition.
+  during data acquisition, or a software clock when the card's timing or
+  block sizes don't suit the experiment.
 
-  Sends output to the audio card for audio monitoring.
+  Sends output to the audio card for audio monitoring. With the software
+  clock, the output is resampled to the card's rate on its own callback.
 
   Determines the initial size of the sample buffer (crucial for
   real-time feedback latency).
@@ -47,8 +49,12 @@ class AudioComponent
 
 public:
     /** Constructor. Finds the audio component (if there is one), and sets the
-    default sample rate and buffer size.*/
-    AudioComponent();
+    default sample rate and buffer size.
+
+    If useAudioDevice is false no device is opened. The callbacks are then generated
+    by a background thread that clocks the ProcessorGraph as fast as the processors
+    allow, for batch processing of recorded files without a sound card.*/
+    AudioComponent(bool useAudioDevice = true);
     ~AudioComponent();
 
     /** Begins the audio callbacks that drive data acquisition.*/
@@ -82,6 +88,69 @@ public:
     /** Returns the buffer size (in ms) currently being used.*/
     int getBufferSizeMs();
 
+    /** Returns the sample rate of the callbacks.*/
+    double getSampleRate();
+
+    /** Returns true if the callbacks come from the batch processing thread instead of an audio device.*/
+    bool isHeadless() const;
+
+    /** Sets the sample rate and buffer size of the batch processing callbacks. Has no effect
+    with an audio device or while the callbacks are active.*/
+    void setBatchSettings(double sampleRate, int bufferSize);
+
+    /** Sets how fast the graph is clocked relative to real time, e.g. for replaying recorded
+    files. 1 runs from the audio device; other speeds clock the device's block size and rate
+    from a thread instead, with no audio output, and 0 runs as fast as the processors allow.
+    Defaults to 0 without an audio device. Takes effect when the callbacks begin.*/
+    void setPlaybackSpeed(double speed);
+
+    double getPlaybackSpeed() const;
+
+    /** Puts the playback speed back to its default, 1 with an audio device and 0 without.
+    Called when the processor that set it is removed or the signal chain is cleared.*/
+    void resetPlaybackSpeed();
+
+    /** Clocks the graph from a timer driven thread instead of the audio device, at the given
+    sample rate and block size, so block sizes and timing don't depend on the sound card.
+    Each block starts at most about latencyTargetMs after its due time: the thread sleeps
+    until shortly before it and spins the rest, spinning longer whenever a block starts
+    late. The audio device, if there is one, only plays the monitor output. Used
+    automatically when no audio device could be opened. Takes effect when the callbacks begin.*/
+    void setSoftwareClock(bool enabled, double sampleRate, int bufferSize, double latencyTargetMs);
+
+    /** Returns true if the graph is clocked by the software clock rather than the audio device.*/
+    bool usesSoftwareClock() const;
+
+    double getSoftwareClockLatencyTargetMs() const;
+
+    /** Returns the number of software clock blocks that started later than the latency target
+    since the callbacks began.*/
+    int64 getNumLateBlocks() const;
+
+    /** Returns true if the callbacks come from a thread rather than the audio device, so the
+    time between blocks doesn't follow the sample rate.*/
+    bool isPaced() const;
+
+    /** Returns the number of blocks processed by the batch processing thread since the callbacks began.*/
+    int64 getNumBatchBlocks() const;
+
+    /** Time from a DataThread publishing new samples to the ProcessorGraph having processed them.*/
+    struct LatencyStats
+    {
+        LatencyStats() : numBlocks(0), meanMs(0.0), maxMs(0.0) {}
+
+        int64 numBlocks;
+        double meanMs;
+        double maxMs;
+    };
+
+    /** Returns true if the callbacks run whenever a DataThread publishes new samples, which
+    happens when a source asked for it (see DataThread::setDrivesProcessing()).*/
+    bool isDataDriven() const;
+
+    /** Returns the latency measured by the data driven callbacks of the current or last run.*/
+    LatencyStats getDataDrivenLatency() const;
+
     /** Saves all audio settings that can be loaded to an XML element */
     void saveStateToXml(XmlElement* parent);
 
@@ -91,11 +160,28 @@ public:
     AudioDeviceManager deviceManager;
 
 private:
+    class BatchDriver;
+    class MonitorOutput;
 
     bool isPlaying;
 
+    const bool useAudioDevice;
+
     ScopedPointer<AudioProcessorPlayer> graphPlayer;
 
+    AudioProcessorGraph* graph;
+    ScopedPointer<BatchDriver> batchDriver;
+    double batchSampleRate;
+    int batchBufferSize;
+    double playbackSpeed;
+    bool usingDriver;
+
+    bool useSoftwareClock;
+    double clockSampleRate;
+    int clockBufferSize;
+    double clockLatencyTargetMs;
+    ScopedPointer<MonitorOutput> monitorOutput;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioComponent);
 
 };
@@ -0,0 +1,128 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "BatchRunner.h"
+#include "AccessClass.h"
+#include "Audio/AudioComponent.h"
+#include "Processors/ProcessorGraph/ProcessorGraph.h"
+#include "Processors/FileReader/FileReader.h"
+#include "UI/ControlPanel.h"
+
+BatchRunner::BatchRunner() : startTime(0), finished(false)
+{
+}
+
+BatchRunner::~BatchRunner()
+{
+    stopTimer();
+}
+
+bool BatchRunner::start(const String& recordDirectory, double speed)
+{
+    ProcessorGraph* graph = AccessClass::getProcessorGraph();
+    ControlPanel* controlPanel = AccessClass::getControlPanel();
+
+    Array<GenericProcessor*> processors = graph->getListOfProcessors();
+    for (int i = 0; i < processors.size(); i++)
+    {
+        FileReader* reader = dynamic_cast<FileReader*>(processors[i]);
+        if (reader != nullptr)
+        {
+            reader->setBatchMode(true);
+            readers.add(reader);
+        }
+    }
+
+    if (readers.size() == 0)
+    {
+        std::cerr << "Batch mode needs a File Reader as the source of the signal chain." << std::endl;
+        finish(false);
+        return false;
+    }
+
+    AccessClass::getAudioComponent()->setPlaybackSpeed(speed);
+
+    if (recordDirectory.isNotEmpty())
+        controlPanel->setRecordingDirectory(File::getCurrentWorkingDirectory().getChildFile(recordDirectory).getFullPathName());
+
+    startTime = Time::getMillisecondCounterHiRes();
+
+    // same path as pressing the record button: enables the processors and starts the callbacks
+    controlPanel->setRecordState(true);
+
+    if (!controlPanel->getAcquisitionState())
+    {
+        std::cerr << "Batch mode could not start acquisition." << std::endl;
+        finish(false);
+        return false;
+    }
+
+    startTimer(50);
+    return true;
+}
+
+bool BatchRunner::hasFinished() const
+{
+    return finished;
+}
+
+void BatchRunner::timerCallback()
+{
+    for (int i = 0; i < readers.size(); i++)
+    {
+        if (!readers[i]->hasReachedEnd())
+            return;
+    }
+
+    finish(true);
+}
+
+void BatchRunner::finish(bool success)
+{
+    stopTimer();
+
+    ControlPanel* controlPanel = AccessClass::getControlPanel();
+    if (controlPanel->getAcquisitionState())
+        controlPanel->setAcquisitionState(false); // also stops recording and waits for the record thread
+
+    if (success)
+    {
+        double seconds = (Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+        std::cout << "Batch run finished in " << seconds << " s, "
+                  << AccessClass::getAudioComponent()->getNumBatchBlocks() << " blocks." << std::endl;
+        for (int i = 0; i < readers.size(); i++)
+        {
+            double fileSeconds = readers[i]->getNumSamplesPlayed() / readers[i]->getDefaultSampleRate();
+            std::cout << "  " << readers[i]->getFile() << ": " << fileSeconds << " s of data, "
+                      << fileSeconds / jmax(seconds, 1e-9) << "x realtime" << std::endl;
+        }
+    }
+
+    for (int i = 0; i < readers.size(); i++)
+        readers[i]->setBatchMode(false);
+
+    finished = true;
+    JUCEApplication::getInstance()->setApplicationReturnValue(success ? 0 : 1);
+    JUCEApplication::getInstance()->systemRequestedQuit();
+}
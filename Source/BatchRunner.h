@@ -0,0 +1,73 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __BATCHRUNNER_H_3C9E1A4F__
+#define __BATCHRUNNER_H_3C9E1A4F__
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+class FileReader;
+
+/**
+
+  Runs a loaded signal chain over its recorded files and quits.
+
+  Used with a headless MainWindow, whose AudioComponent clocks the ProcessorGraph
+  from a background thread as fast as the processors allow. Every FileReader in the
+  chain is switched to batch mode so it plays its file once, the RecordNode records
+  the output, and once all readers reach the end of their files acquisition stops
+  and the application quits.
+
+  @see AudioComponent, FileReader, MainWindow
+
+*/
+
+class BatchRunner : private Timer
+{
+public:
+    BatchRunner();
+    ~BatchRunner();
+
+    /** Starts recording into recordDirectory, or the directory saved with the
+        signal chain if it is empty. The files are played at speed times real time,
+        0 for as fast as possible, whatever the signal chain was saved with.
+        Returns false if the chain can't be run. */
+    bool start(const String& recordDirectory, double speed = 0.0);
+
+    /** Returns true once the run has finished, successfully or not. */
+    bool hasFinished() const;
+
+private:
+    void timerCallback() override;
+
+    /** Stops acquisition, prints a summary and asks the application to quit. */
+    void finish(bool success);
+
+    Array<FileReader*> readers;
+    double startTime;
+    bool finished;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BatchRunner);
+};
+
+#endif  // __BATCHRUNNER_H_3C9E1A4F__
@@ -26,6 +26,7 @@
 #include "AccessClass.h"
 
 #include "Processors/ProcessorGraph/ProcessorGraph.h"
+#include "Processors/GenericProcessor/GlobalClock.h"
 #include "Processors/RecordNode/RecordNode.h"
 #include "UI/EditorViewport.h"
 #include "UI/ControlPanel.h"
@@ -73,6 +74,30 @@ namespace CoreServices
 		getBroadcaster()->sendActionMessage(text);
 	}
 
+	const ChannelStatistics& subscribeChannelStatistics(GenericProcessor* processor)
+	{
+		processor->subscribeToInputStatistics();
+		return processor->getInputStatistics();
+	}
+
+	void unsubscribeChannelStatistics(GenericProcessor* processor)
+	{
+		processor->unsubscribeFromInputStatistics();
+	}
+
+	void logMessage(RealtimeLog::Level level, const char* format, ...)
+	{
+		va_list args;
+		va_start(args, format);
+		RealtimeLog::writeV(level, format, args);
+		va_end(args);
+	}
+
+	bool postRecordingMessage(const String& text, juce::int64 timestamp)
+	{
+		return getProcessorGraph()->getMessageCenter()->postMessage(text, timestamp);
+	}
+
 	void highlightEditor(GenericEditor* ed)
 	{
 		getEditorViewport()->makeEditorVisible(ed);
@@ -80,6 +105,9 @@ namespace CoreServices
 
 	juce::int64 getGlobalTimestamp()
 	{
+		// while acquiring, straight from the last block of the timestamp source
+		if (GlobalClock::isRunning())
+			return GlobalClock::getTimestamp();
 		return getProcessorGraph()->getGlobalTimestamp(false);
 	}
 
@@ -88,8 +116,15 @@ namespace CoreServices
 		return getProcessorGraph()->getGlobalTimestampSourceFullId();
 	}
 
+	juce::int64 getSyncedTimestamp(uint32 sourceFullId, juce::int64 timestamp)
+	{
+		return getProcessorGraph()->getClockSync().toMasterTimestamp(sourceFullId, timestamp);
+	}
+
 	juce::int64 getSoftwareTimestamp()
 	{
+		if (GlobalClock::isRunning())
+			return GlobalClock::getSoftwareTimestamp();
 		return getProcessorGraph()->getGlobalTimestamp(true);
 	}
 
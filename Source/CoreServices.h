@@ -26,9 +26,11 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "Processors/PluginManager/OpenEphysPlugin.h"
+#include "Processors/GenericProcessor/RealtimeLog.h"
 
 class GenericEditor;
 class GenericProcessor;
+class ChannelStatistics;
 class SpikeChannel;
 class SpikeEvent;
 
@@ -55,12 +57,29 @@ PLUGIN_API void sendStatusMessage(const String& text);
 /** Sends a string to the message bar */
 PLUGIN_API void sendStatusMessage(const char* text);
 
+/** Prints a printf style message to the console. Safe to call from real-time threads, which it
+never blocks; see RealtimeLog for the rate limits */
+PLUGIN_API void logMessage(RealtimeLog::Level level, const char* format, ...);
+
+/** Has the running mean, RMS and noise level of every input channel of a processor
+computed, once for every subscriber, and returns them. Each call is balanced by one to
+unsubscribeChannelStatistics(). See ChannelStatistics */
+PLUGIN_API const ChannelStatistics& subscribeChannelStatistics(GenericProcessor* processor);
+PLUGIN_API void unsubscribeChannelStatistics(GenericProcessor* processor);
+
+/** Queues a text message to be saved to the recording as a MessageCenter event, stamped with the
+given global timestamp or, if it is negative, with the time it is sent. Can be called from any
+thread. Returns false if the GUI is not recording or the message queue is full */
+PLUGIN_API bool postRecordingMessage(const String& text, juce::int64 timestamp = -1);
+
 /** Highlights an editor */
 PLUGIN_API void highlightEditor(GenericEditor* ed);
 
 /** Gets the timestamp selected on the MessageCenter interface
 Defaults to the first hardware timestamp source or the software one if
-no hardware timestamping is present*/
+no hardware timestamping is present. While acquiring, it is interpolated
+from the last block of the source, so it is cheap and never goes back,
+from whichever thread it is called. @see GlobalClock */
 PLUGIN_API juce::int64 getGlobalTimestamp();
 
 /** Gets the sample rate selected on the MessageCenter interface
@@ -72,6 +91,11 @@ PLUGIN_API float getGlobalSampleRate();
 Returns 0 if timestamps are provided by the software high resolution timer */
 PLUGIN_API uint32 getGlobalTimestampSourceFullId();
 
+/** Converts a timestamp of the given source into the clock of the global timestamp source,
+using the TTL sync pulses shared by the devices. Returns the timestamp unchanged if clock
+sync is disabled or the source hasn't been paired with the master yet */
+PLUGIN_API juce::int64 getSyncedTimestamp(uint32 sourceFullId, juce::int64 timestamp);
+
 /** Gets the software timestamp based on a high resolution timer aligned to the start of each processing block */
 PLUGIN_API juce::int64 getSoftwareTimestamp();
 
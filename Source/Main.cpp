@@ -26,7 +26,14 @@
 #endif
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "MainWindow.h"
+#include "BatchRunner.h"
 #include "UI/LookAndFeel/CustomLookAndFeel.h"
+#include "Processors/RecordNode/RecordBenchmark.h"
+#include "Processors/Events/EventBenchmark.h"
+#include "Processors/ProcessorManager/ProcessorBenchmark.h"
+#include "Processors/RecordNode/RoundTripBenchmark.h"
+#include "Utils/StartupTiming.h"
+#include "Processors/GenericProcessor/RealtimeLog.h"
 
 #include <stdio.h>
 #include <fstream>
@@ -84,9 +91,95 @@ public:
 
 #endif
 
-        customLookAndFeel = new CustomLookAndFeel();
-        LookAndFeel::setDefaultLookAndFeel(customLookAndFeel);
+        // after the console is set up, so the printing thread writes to it
+        RealtimeLog::start();
 
+        // --benchmark-record [key=value ...] measures a record engine with synthetic data and quits
+        StringArray benchmarkOptions;
+        int benchmarkArg = parameters.indexOf("--benchmark-record", true);
+        if (benchmarkArg != -1)
+        {
+            benchmarkOptions.addArray(parameters, benchmarkArg + 1);
+            parameters.removeRange(benchmarkArg, parameters.size() - benchmarkArg);
+        }
+
+        // --benchmark-events [key=value ...] measures the event pipeline with synthetic events and quits
+        StringArray eventBenchmarkOptions;
+        int eventBenchmarkArg = parameters.indexOf("--benchmark-events", true);
+        if (eventBenchmarkArg != -1)
+        {
+            eventBenchmarkOptions.addArray(parameters, eventBenchmarkArg + 1);
+            parameters.removeRange(eventBenchmarkArg, parameters.size() - eventBenchmarkArg);
+        }
+
+        // --benchmark-processors [key=value ...] measures the process() cost of plugin processors and quits
+        StringArray processorBenchmarkOptions;
+        int processorBenchmarkArg = parameters.indexOf("--benchmark-processors", true);
+        if (processorBenchmarkArg != -1)
+        {
+            processorBenchmarkOptions.addArray(parameters, processorBenchmarkArg + 1);
+            parameters.removeRange(processorBenchmarkArg, parameters.size() - processorBenchmarkArg);
+        }
+
+        // --benchmark-roundtrip [key=value ...] records a synthetic chain, replays it, reports PASS or FAIL and quits
+        StringArray roundTripBenchmarkOptions;
+        int roundTripBenchmarkArg = parameters.indexOf("--benchmark-roundtrip", true);
+        if (roundTripBenchmarkArg != -1)
+        {
+            roundTripBenchmarkOptions.addArray(parameters, roundTripBenchmarkArg + 1);
+            parameters.removeRange(roundTripBenchmarkArg, parameters.size() - roundTripBenchmarkArg);
+        }
+
+        // --batch <chain.xml> [--record-dir <dir>] [--speed <x>] runs the chain over its files without a display or sound card
+        String recordDirectory;
+        int recordDirArg = parameters.indexOf("--record-dir", true);
+        if (recordDirArg != -1)
+        {
+            recordDirectory = parameters[recordDirArg + 1];
+            parameters.removeRange(recordDirArg, 2);
+        }
+        double batchSpeed = 0.0;
+        int speedArg = parameters.indexOf("--speed", true);
+        if (speedArg != -1)
+        {
+            batchSpeed = parameters[speedArg + 1].getDoubleValue();
+            parameters.removeRange(speedArg, 2);
+        }
+        int batchArg = parameters.indexOf("--batch", true);
+        if (batchArg != -1)
+            parameters.remove(batchArg);
+
+        {
+            StartupTiming::ScopedPhase phase("look and feel");
+            customLookAndFeel = new CustomLookAndFeel();
+            LookAndFeel::setDefaultLookAndFeel(customLookAndFeel);
+        }
+
+        // The event benchmark builds its own processors, so it doesn't need the window
+        if (eventBenchmarkArg != -1)
+        {
+            bool ok = EventBenchmark::runFromCommandLine(eventBenchmarkOptions);
+            setApplicationReturnValue(ok ? 0 : 1);
+            systemRequestedQuit();
+            return;
+        }
+
+        if (batchArg != -1)
+        {
+            if (parameters.isEmpty())
+            {
+                std::cerr << "--batch needs a signal chain file" << std::endl;
+                setApplicationReturnValue(1);
+                quit();
+                return;
+            }
+            File fileToLoad(File::getCurrentWorkingDirectory().getChildFile(parameters[0]));
+            mainWindow = new MainWindow(fileToLoad, true);
+            StartupTiming::report(std::cout);
+            batchRunner = new BatchRunner();
+            batchRunner->start(recordDirectory, batchSpeed);
+            return;
+        }
 
         // signal chain to load
         if (!parameters.isEmpty())
@@ -98,13 +191,45 @@ public:
         {
             mainWindow = new MainWindow();
         }
+        StartupTiming::report(std::cout);
+
+        if (benchmarkArg != -1)
+        {
+            bool ok = RecordBenchmark::runFromCommandLine(benchmarkOptions);
+            setApplicationReturnValue(ok ? 0 : 1);
+            systemRequestedQuit();
+        }
+
+        // The processors come from the plugins, which the main window loads
+        if (processorBenchmarkArg != -1)
+        {
+            bool ok = ProcessorBenchmark::runFromCommandLine(processorBenchmarkOptions);
+            setApplicationReturnValue(ok ? 0 : 1);
+            systemRequestedQuit();
+        }
+
+        // Needs the plugins, the record node and the audio settings the File Reader plays at
+        if (roundTripBenchmarkArg != -1)
+        {
+            bool ok = RoundTripBenchmark::runFromCommandLine(roundTripBenchmarkOptions);
+            setApplicationReturnValue(ok ? 0 : 1);
+            systemRequestedQuit();
+        }
     }
 
-    void shutdown() { }
+    void shutdown()
+    {
+        RealtimeLog::stop();
+    }
 
     //==============================================================================
     void systemRequestedQuit()
     {
+		if (mainWindow == nullptr)
+		{
+			quit();
+			return;
+		}
 		mainWindow->shutDownGUI();
         //std::cout << "Quit requested" << std::endl;
         quit();
@@ -129,6 +254,7 @@ public:
 private:
     ScopedPointer <MainWindow> mainWindow;
     ScopedPointer <CustomLookAndFeel> customLookAndFeel;
+    ScopedPointer <BatchRunner> batchRunner;
     std::ofstream console_out;
 };
 
@@ -24,6 +24,9 @@
 #include "MainWindow.h"
 #include "UI/UIComponent.h"
 #include "UI/EditorViewport.h"
+#include "Utils/XmlSnapshot.h"
+#include "Utils/StartupTiming.h"
+#include "Processors/GenericProcessor/ThreadPolicy.h"
 #include <stdio.h>
 //-----------------------------------------------------------------------
 
@@ -39,10 +42,11 @@ static inline File getSavedStateDirectory() {
 #endif
 }
 
-	MainWindow::MainWindow(const File& fileToLoad)
+	MainWindow::MainWindow(const File& fileToLoad, bool headless)
 : DocumentWindow(JUCEApplication::getInstance()->getApplicationName(),
 		Colour(Colours::black),
-		DocumentWindow::allButtons)
+		DocumentWindow::allButtons),
+	isHeadless(headless)
 {
 
 	setResizable(true,      // isResizable
@@ -53,17 +57,26 @@ static inline File getSavedStateDirectory() {
 	// Create ProcessorGraph and AudioComponent, and connect them.
 	// Callbacks will be set by the play button in the control panel
 
-	processorGraph = new ProcessorGraph();
+	{
+		StartupTiming::ScopedPhase phase("processor graph");
+		processorGraph = new ProcessorGraph();
+	}
 	std::cout << std::endl;
 	std::cout << "Created processor graph." << std::endl;
 	std::cout << std::endl;
 
-	audioComponent = new AudioComponent();
+	{
+		StartupTiming::ScopedPhase phase("audio component");
+		audioComponent = new AudioComponent(!headless);
+	}
 	std::cout << "Created audio component." << std::endl;
 
 	audioComponent->connectToProcessorGraph(processorGraph);
 
-	setContentOwned(new UIComponent(this, processorGraph, audioComponent), true);
+	{
+		StartupTiming::ScopedPhase phase("UI construction");
+		setContentOwned(new UIComponent(this, processorGraph, audioComponent), true);
+	}
 
 	UIComponent* ui = (UIComponent*) getContentComponent();
 
@@ -74,22 +87,44 @@ static inline File getSavedStateDirectory() {
 
 	addKeyListener(commandManager.getKeyMappings());
 
-	loadWindowBounds();
-	setUsingNativeTitleBar(true);
-	Component::addToDesktop(getDesktopWindowStyleFlags());  // prevents the maximize
-	// button from randomly disappearing
-	setVisible(true);
+	if (headless)
+	{
+		// laid out so the editors work, but never placed on a desktop
+		getContentComponent()->setBounds(0, 0, 800, 600);
 
-	// Constraining the window's size doesn't seem to work:
-	setResizeLimits(500, 500, 10000, 10000);
+		// the rig's thread policy still applies, even though the rest of the saved window is ignored
+		ScopedPointer<XmlElement> windowState = XmlDocument::parse(getSavedStateDirectory().getChildFile("windowState.xml"));
+		if (windowState != nullptr)
+		{
+			ThreadPolicy::loadSettings(windowState);
+			processorGraph->setNumRenderThreads(windowState->getIntAttribute("renderThreads", 1));
+		}
+	}
+	else
+	{
+		StartupTiming::ScopedPhase phase("window");
+		loadWindowBounds();
+		setUsingNativeTitleBar(true);
+		Component::addToDesktop(getDesktopWindowStyleFlags());  // prevents the maximize
+		// button from randomly disappearing
+		setVisible(true);
+
+		// Constraining the window's size doesn't seem to work:
+		setResizeLimits(500, 500, 10000, 10000);
+	}
 
     if (!fileToLoad.getFullPathName().isEmpty())
     {
+        StartupTiming::ScopedPhase phase("config load");
         ui->getEditorViewport()->loadState(fileToLoad);
     }
 	else if (shouldReloadOnStartup)
 	{
-		File file = getSavedStateDirectory().getChildFile("lastConfig.xml");
+		StartupTiming::ScopedPhase phase("config load");
+		// the last configuration is kept as a snapshot, older versions only wrote the XML
+		File file = getSavedStateDirectory().getChildFile("lastConfig").withFileExtension(XmlSnapshot::fileExtension);
+		if (!file.existsAsFile())
+			file = getSavedStateDirectory().getChildFile("lastConfig.xml");
 		ui->getEditorViewport()->loadState(file);
 	}
 
@@ -106,14 +141,18 @@ MainWindow::~MainWindow()
 		processorGraph->disableProcessors();
 	}
 
-	saveWindowBounds();
+	if (!isHeadless)
+		saveWindowBounds();
 
 	audioComponent->disconnectProcessorGraph();
 	UIComponent* ui = (UIComponent*) getContentComponent();
 	ui->disableDataViewport();
 
-	File file = getSavedStateDirectory().getChildFile("lastConfig.xml");
-	ui->getEditorViewport()->saveState(file);
+	if (!isHeadless)
+	{
+		File file = getSavedStateDirectory().getChildFile("lastConfig").withFileExtension(XmlSnapshot::fileExtension);
+		ui->getEditorViewport()->saveState(file);
+	}
 
 	setMenuBar(0);
 
@@ -152,6 +191,7 @@ void MainWindow::saveWindowBounds()
 
 	xml->setAttribute("version", JUCEApplication::getInstance()->getApplicationVersion());
 	xml->setAttribute("shouldReloadOnStartup", shouldReloadOnStartup);
+	xml->setAttribute("renderThreads", processorGraph->getNumRenderThreads());
 
 	XmlElement* bounds = new XmlElement("BOUNDS");
 	bounds->setAttribute("x",getScreenX());
@@ -177,6 +217,8 @@ void MainWindow::saveWindowBounds()
 
 	xml->addChildElement(recentDirectories);
 
+	ThreadPolicy::saveSettings(xml);
+
 	String error;
 
 	if (! xml->writeToFile(file, String::empty))
@@ -212,6 +254,9 @@ void MainWindow::loadWindowBounds()
 
 		shouldReloadOnStartup = xml->getBoolAttribute("shouldReloadOnStartup", false);
 
+		ThreadPolicy::loadSettings(xml);
+		processorGraph->setNumRenderThreads(xml->getIntAttribute("renderThreads", 1));
+
 		forEachXmlChildElement(*xml, e)
 		{
 
@@ -45,8 +45,11 @@ class MainWindow   : public DocumentWindow
 public:
 
     /** Initializes the MainWindow, creates the AudioComponent, ProcessorGraph,
-        and UIComponent, and sets the window boundaries. */
-    MainWindow(const File& fileToLoad = File());
+        and UIComponent, and sets the window boundaries.
+
+        A headless window is never shown, does not touch the saved window and
+        signal chain state, and runs the graph without an audio device. */
+    MainWindow(const File& fileToLoad = File(), bool headless = false);
 
     /** Destroys the AudioComponent, ProcessorGraph, and UIComponent, and saves the window boundaries. */
     ~MainWindow();
@@ -66,6 +69,9 @@ public:
 
 private:
 
+    /** True if the window runs the graph for batch processing, without being shown. */
+    const bool isHeadless;
+
     /** Saves the MainWindow's boundaries into the file "windowState.xml", located in the directory
         from which the GUI is run. */
     void saveWindowBounds();
@@ -37,7 +37,7 @@ AudioNode::AudioNode()
     //nextAvailableChannel = 2; // keep first two channels empty
     resetConnections();
 
-    tempBuffer = new AudioSampleBuffer(16, 1024);
+    tempBuffer = new AudioSampleBuffer(2, 1024);
 
 }
 
@@ -188,19 +188,16 @@ void AudioNode::recreateBuffers()
 {
 	numSamplesExpected.clear();
     samplesInBackupBuffer.clear();
-    samplesInOverflowBuffer.clear();
+    sourceBufferSampleRate.clear();
     ratio.clear();
     filters.clear();
-    bufferA.clear();
-    bufferB.clear();
-    bufferSwap.clear();
+    backupBuffers.clear();
 
     for (int i = 0; i < dataChannelArray.size(); i++)
     {
         // processor sample rate divided by sound card sample rate
         numSamplesExpected.add((int)(dataChannelArray[i]->getSampleRate()/destBufferSampleRate*float(estimatedSamples)) + 1);
         samplesInBackupBuffer.add(0);
-        samplesInOverflowBuffer.add(0);
         sourceBufferSampleRate.add(dataChannelArray[i]->getSampleRate());
 
         filters.add(new Dsp::SmoothedFilterDesign<Dsp::RBJ::Design::LowPass, 1> (1024));
@@ -208,14 +205,11 @@ void AudioNode::recreateBuffers()
         ratio.add(float(numSamplesExpected[i])/float(estimatedSamples));
         updateFilter(i);
 
-        bufferA.add(new AudioSampleBuffer(1,10000));
-        bufferB.add(new AudioSampleBuffer(1,10000));
-        bufferSwap.add(false);
+        backupBuffers.add(new AudioSampleBuffer(1,10000));
 
     }
 
-//    tempBuffer->setSize(getNumInputs(), 4096);
-    tempBuffer->setSize(1, 4096);
+    tempBuffer->setSize(2, 4096);
 }
 
 bool AudioNode::enable()
@@ -244,249 +238,113 @@ void AudioNode::updateFilter(int i)
 
 void AudioNode::process(AudioSampleBuffer& buffer)
 {
-    float gain;
-    int valuesNeeded = buffer.getNumSamples(); // samples needed to fill out the buffer
-
-    //std::cout << "Buffer size: " << buffer.getNumChannels() << std::endl;
+    const int valuesNeeded = buffer.getNumSamples(); // samples needed to fill out the buffer
 
     // clear the left and right channels
-    buffer.clear(0,0,buffer.getNumSamples());
-    buffer.clear(1,0,buffer.getNumSamples());
-
-    if (1)
-    {
-
-        AudioSampleBuffer* overflowBuffer;
-        AudioSampleBuffer* backupBuffer;
-
-        int nInputs = dataChannelArray.size();
-        if (nInputs > 0) // we have some channels
-        {
-
-//            tempBuffer->clear();
+    buffer.clear(0,0,valuesNeeded);
+    buffer.clear(1,0,valuesNeeded);
 
-            for (int i = 0; i < nInputs; i++) // cycle through them all
-            {
+    const int nInputs = jmin(dataChannelArray.size(), numSamplesExpected.size());
 
-                if (dataChannelArray[i]->isMonitored())
-                {
-                    tempBuffer->clear();
-                    //std::cout << "Processing channel " << i << std::endl;
+    bool anyMonitored = false;
+    for (int i = 0; i < nInputs && ! anyMonitored; i++)
+        anyMonitored = dataChannelArray[i]->isMonitored();
 
-                    if (!bufferSwap[i])
-                    {
-                        overflowBuffer = bufferA[i];
-                        backupBuffer = bufferB[i];
+    if (! anyMonitored)
+        return;
 
-                        bufferSwap.set(i,true);
-                    }
-                    else
-                    {
-                        overflowBuffer = bufferB[i];
-                        backupBuffer = bufferA[i];
+    float* mix = buffer.getWritePointer(0);
 
-                        bufferSwap.set(i,false);
-                    }
-
-                    backupBuffer->clear();
-
-                    samplesInOverflowBuffer.set(i,samplesInBackupBuffer[i]); // size of buffer after last round
-                    samplesInBackupBuffer.set(i,0);
-
-                    int orphanedSamples = 0;
-
-                    // 1. copy overflow buffer
+    for (int i = 0; i < nInputs; i++) // cycle through them all
+    {
+        if (! dataChannelArray[i]->isMonitored())
+            continue;
 
-                    int samplesToCopyFromOverflowBuffer =
-                        ((samplesInOverflowBuffer[i] <= numSamplesExpected[i]) ?
-                         samplesInOverflowBuffer[i] :
-                         numSamplesExpected[i]);
+        const int samplesExpected = numSamplesExpected[i];
 
-                    //std::cout << "Copying " << samplesToCopyFromOverflowBuffer << " samples from overflow buffer of " << samplesInOverflowBuffer[i] << " samples." << std::endl;
+        if (tempBuffer->getNumSamples() < jmax(samplesExpected, valuesNeeded))
+            tempBuffer->setSize(2, jmax(samplesExpected, valuesNeeded), false, false, true);
 
-                    if (samplesToCopyFromOverflowBuffer > 0) // need to re-add samples from backup buffer
-                    {
+        float* source = tempBuffer->getWritePointer(0);
+        float* resampled = tempBuffer->getWritePointer(1);
+        float* backup = backupBuffers[i]->getWritePointer(0);
 
-                        tempBuffer->addFrom(0,    // destination channel
-                                            0,                // destination start sample
-                                            *overflowBuffer,  // source
-                                            0,                // source channel
-                                            0,                // source start sample
-                                            samplesToCopyFromOverflowBuffer,    // number of samples
-                                            1.0f              // gain to apply
-                                           );
+        // Data are floats in units of microvolts, so dividing by bitVolts and 0x7fff (max value for 16b signed)
+        // rescales to between -1 and +1. Audio output starts So, maximum gain applied to maximum data would be 10.
+        const float gain = volume/(float(0x7fff) * dataChannelArray[i]->getBitVolts());
 
-                        int leftoverSamples = samplesInOverflowBuffer[i] - samplesToCopyFromOverflowBuffer;
+        const float* incoming = buffer.getReadPointer(i+2); // add 2 to account for output channels
+        const int samplesAvailable = getNumSourceSamples(dataChannelArray[i]->getSourceNodeID(), dataChannelArray[i]->getSubProcessorIdx());
 
-                        // std::cout << "Samples remaining in overflow buffer: " << leftoverSamples << std::endl;
+        // 1. the samples left over from the last block come first, then the incoming ones,
+        // and whatever is still missing is silence
+        const int samplesFromBackup = jmin(samplesInBackupBuffer[i], samplesExpected);
+        const int samplesFromIncoming = jmin(samplesExpected - samplesFromBackup, samplesAvailable);
 
-                        if (leftoverSamples > 0) // move remaining samples to the backup buffer
-                        {
+        FloatVectorOperations::copy(source, backup, samplesFromBackup);
+        FloatVectorOperations::copyWithMultiply(source + samplesFromBackup, incoming, gain, samplesFromIncoming);
+        FloatVectorOperations::clear(source + samplesFromBackup + samplesFromIncoming,
+                                     samplesExpected - samplesFromBackup - samplesFromIncoming);
 
-                            backupBuffer->addFrom(0, // destination channel
-                                                  0,                     // destination start sample
-                                                  *overflowBuffer,       // source
-                                                  0,                     // source channel
-                                                  samplesToCopyFromOverflowBuffer,         // source start sample
-                                                  leftoverSamples,       // number of samples
-                                                  1.0f                   // gain to apply
-                                                 );
-                        }
+        // 2. keep the samples that did not fit for the next block
+        int leftoverSamples = samplesInBackupBuffer[i] - samplesFromBackup;
 
-                        samplesInBackupBuffer.set(i,leftoverSamples);
-                    }
+        if (leftoverSamples > 0)
+            memmove(backup, backup + samplesFromBackup, sizeof(float) * leftoverSamples);
 
-                    gain = volume/(float(0x7fff) * dataChannelArray[i]->getBitVolts());
-                    // Data are floats in units of microvolts, so dividing by bitVolts and 0x7fff (max value for 16b signed)
-                    // rescales to between -1 and +1. Audio output starts So, maximum gain applied to maximum data would be 10.
+        const int orphanedSamples = samplesAvailable - samplesFromIncoming;
 
-                    int remainingSamples = numSamplesExpected[i] - samplesToCopyFromOverflowBuffer;
+        if (orphanedSamples > 0 && (leftoverSamples + orphanedSamples < backupBuffers[i]->getNumSamples()))
+        {
+            FloatVectorOperations::copyWithMultiply(backup + leftoverSamples, incoming + samplesFromIncoming, gain, orphanedSamples);
+            leftoverSamples += orphanedSamples;
+        }
 
-                    int samplesAvailable = getNumSourceSamples(dataChannelArray[i]->getSourceNodeID(), dataChannelArray[i]->getSubProcessorIdx());
+        samplesInBackupBuffer.set(i, leftoverSamples);
 
-                    int samplesToCopyFromIncomingBuffer = ((remainingSamples <= samplesAvailable) ?
-                                                           remainingSamples :
-                                                           samplesAvailable);
+        // 3. resample to the output rate, filtering on the side of the higher rate
 
-                    //std::cout << "Copying " << samplesToCopyFromIncomingBuffer << " samples from incoming buffer of " << samplesAvailable << " samples." << std::endl;
+        if (ratio[i] > 1.00001)
+        {
+            // pre-apply filter before downsampling
+            filters[i]->process(samplesExpected, &source);
+        }
 
+        // linear interpolation, as in "juce_ResamplingAudioSource.cpp"
+        const double step = ratio[i];
+        double subSampleOffset = 0.0;
+        int sourceBufferPos = 0;
 
-                    if (samplesToCopyFromIncomingBuffer > 0)
-                    {
+        for (int destBufferPos = 0; destBufferPos < valuesNeeded; destBufferPos++)
+        {
+            const int nextPos = jmin(sourceBufferPos + 1, samplesExpected - 1);
+            const float alpha = (float) subSampleOffset;
 
-                        //tempBuffer->addFrom(i,       // destination channel
-                        tempBuffer->addFrom(0,       // destination channel
-                                            samplesToCopyFromOverflowBuffer,           // destination start sample
-                                            buffer,      // source
-                                            i+2,           // source channel (add 2 to account for output channels)
-                                            0,           // source start sample
-                                            samplesToCopyFromIncomingBuffer, //  number of samples
-                                            gain       // gain to apply
-                                           );
+            resampled[destBufferPos] = source[sourceBufferPos] + alpha * (source[nextPos] - source[sourceBufferPos]);
 
-                        //if (destBufferPos == 0)
-                        //  std::cout << "Temp buffer 0 value: " << *tempBuffer->getReadPointer(i,0) << std::endl;
+            subSampleOffset += step;
 
-                    }
-
-                    orphanedSamples = samplesAvailable - samplesToCopyFromIncomingBuffer;
+            const int advance = (int) subSampleOffset;
+            subSampleOffset -= advance;
+            sourceBufferPos = jmin(sourceBufferPos + advance, samplesExpected - 1);
+        }
 
-                    // std::cout << "Samples remaining in incoming buffer: " << orphanedSamples << std::endl;
+        if (ratio[i] < 0.99999)
+        {
+            // apply the filter after upsampling, to this channel only
+            filters[i]->process(valuesNeeded, &resampled);
+        }
 
-                    if (orphanedSamples > 0 && (samplesInBackupBuffer[i] + orphanedSamples < backupBuffer->getNumSamples()))
-                    {
+        // 4. mix into the left channel
+        FloatVectorOperations::add(mix, resampled, valuesNeeded);
 
-                        backupBuffer->addFrom(0,                            // destination channel
-                                              samplesInBackupBuffer[i],     // destination start sample
-                                              buffer,                       // source
-                                              i+2,                          // source channel (add 2 to account for output channels)
-                                              remainingSamples,             // source start sample
-                                              orphanedSamples,              //  number of samples
-                                              gain                          // gain to apply
-                                             );
+    } // end cycling through channels
 
-                        samplesInBackupBuffer.set(i, samplesInBackupBuffer[i] + orphanedSamples);
+    // Simple implementation of a "noise gate" on audio output
+    expander.process(mix, valuesNeeded); // expand the left channel
 
-                    }
-
-                    // now that our tempBuffer is ready, we can filter it and copy it into the
-                    // original buffer
-
-                    //std::cout << "Ratio = " << ratio[i] << ", gain = " << gain << std::endl;
-                    //std::cout << "Values needed = " << valuesNeeded << ", channel = " << i << std::endl;
-
-                    if (ratio[i] > 1.00001)
-                    {
-                        // pre-apply filter before downsampling
-                        float* ptr = tempBuffer->getWritePointer(i);
-                        filters[i]->process(numSamplesExpected[i], &ptr);
-                    }
-
-                    // initialize variables
-                    int sourceBufferPos = 0;
-                    int sourceBufferSize = numSamplesExpected[i];
-                    float subSampleOffset = 0.0;
-                    int nextPos = (sourceBufferPos + 1) % sourceBufferSize;
-
-                    int destBufferPos;
-
-                    // code modified from "juce_ResamplingAudioSource.cpp":
-
-                    for (destBufferPos = 0; destBufferPos < valuesNeeded; destBufferPos++)
-                    {
-                        float gain = 1.0;
-                        float alpha = (float) subSampleOffset;
-                        float invAlpha = 1.0f - alpha;
-
-                        // std::cout << "Copying sample " << sourceBufferPos << std::endl;
-
-                        buffer.addFrom(0,    // destChannel
-                                       destBufferPos,  // destSampleOffset
-                                       *tempBuffer,     // source
-                                       //i,    // sourceChannel
-                                       0,       // sourceChannel
-                                       sourceBufferPos,// sourceSampleOffset
-                                       1,        // number of samples
-                                       invAlpha*gain);      // gain to apply to source
-
-                        buffer.addFrom(0,    // destChannel
-                                       destBufferPos,   // destSampleOffset
-                                       *tempBuffer,     // source
-                                       //i,      // sourceChannel
-                                       0,      // sourceChannel
-                                       nextPos,      // sourceSampleOffset
-                                       1,        // number of samples
-                                       alpha*gain);       // gain to apply to source
-
-                        // if (destBufferPos == 0)
-                        //std::cout << "Output buffer 0 value: " << *buffer.getReadPointer(i+2,destBufferPos) << std::endl;
-
-                        subSampleOffset += ratio[i];
-
-                        while (subSampleOffset >= 1.0)
-                        {
-                            if (++sourceBufferPos >= sourceBufferSize)
-                                sourceBufferPos = 0;
-
-                            nextPos = (sourceBufferPos + 1) % sourceBufferSize;
-                            subSampleOffset -= 1.0;
-                        }
-                    }
-
-                    if (ratio[i] < 0.99999)
-                    {
-                        // apply the filter after upsampling
-                        float* ptr = buffer.getWritePointer(0);
-                        filters[i]->process(destBufferPos, &ptr);
-                    }
-
-                    // now copy the channel into the output zone
-
-                    // buffer.addFrom(0,    // destChannel
-                    //                0,  // destSampleOffset
-                    //                buffer,     // source
-                    //                 i+2,    // sourceChannel
-                    //                 0,// sourceSampleOffset
-                    //                 valuesNeeded,        // number of samples
-                    //                 1.0);      // gain to apply to source
-
-                } // if channelPointers[i]->isMonitored
-            } // end cycling through channels
-
-            // Simple implementation of a "noise gate" on audio output
-            expander.process(buffer.getWritePointer(0), // expand the left channel
-                             buffer.getNumSamples());
-
-            // copy the signal into the right channel (no stereo audio yet!)
-            buffer.addFrom(1,    // destChannel
-                           0,  // destSampleOffset
-                           buffer,     // source
-                           0,    // sourceChannel
-                           0,// sourceSampleOffset
-                           valuesNeeded,        // number of samples
-                           1.0);      // gain to apply to source
-        }
-    }
+    // copy the signal into the right channel (no stereo audio yet!)
+    buffer.copyFrom(1, 0, buffer, 0, 0, valuesNeeded);
 }
 
 
@@ -514,6 +372,8 @@ Expander::Expander()
     env = 0.f;
     gain = 1.f;
 
+    transferGainsSize = 0;
+
     setAttack(1.0f);
     setRelease(1.0f);
     setRatio(1.2); // ratio > 1.0 will decrease gain below threshold
@@ -549,18 +409,74 @@ void Expander::setRelease(float value)
 }
 
 
+namespace
+{
+    // Approximations of log2 and exp2, whose combination is within 1% of pow() for the
+    // expander ratios, with no branches so that loops over them are vectorised
+
+    inline float fastLog2(float x)
+    {
+        int32 bits;
+        memcpy(&bits, &x, sizeof(bits));
+
+        const float exponent = float(((bits >> 23) & 255) - 128);
+        bits = (bits & 0x007fffff) | 0x3f800000;
+
+        float mantissa;
+        memcpy(&mantissa, &bits, sizeof(mantissa));
+
+        return exponent + (-0.34484843f * mantissa + 2.02466578f) * mantissa - 0.67487759f;
+    }
+
+    inline float fastExp2(float x)
+    {
+        x = jlimit(-126.f, 126.f, x);
+
+        const float whole = std::floor(x);
+        const float fraction = x - whole;
+        const int32 bits = (int32(whole) + 127) << 23;
+
+        float scale;
+        memcpy(&scale, &bits, sizeof(scale));
+
+        return scale * (1.f + fraction * (0.69583355f + fraction * (0.22606716f + fraction * 0.078024521f)));
+    }
+}
+
 void Expander::process(float* sampleData, int numSamples)
 {
-    float det, transfer_gain;
+    if (transferGainsSize < numSamples)
+    {
+        transferGains.allocate(numSamples, false);
+        transferGainsSize = numSamples;
+    }
+
+    float* const transfer = transferGains;
 
+    // the envelope follower is recursive
     for (int i = 0; i < numSamples; i++)
     {
-        det = fabs(sampleData[i]);
+        float det = fabs(sampleData[i]);
         det += 10e-30f; /* add tiny DC offset (-600dB) to prevent denormals */
 
         env = det >= env ? det : det + envelope_decay*(env-det);
 
-        transfer_gain = env < threshold ? pow(env, transfer_A) * transfer_B : output;
+        transfer[i] = env;
+    }
+
+    // transfer gain of every sample, env^A * B below the threshold
+    for (int i = 0; i < numSamples; i++)
+    {
+        const float e = transfer[i];
+        const float expanded = fastExp2(transfer_A * fastLog2(e)) * transfer_B;
+
+        transfer[i] = e < threshold ? expanded : output;
+    }
+
+    // the gain follows the transfer gain with its attack and release
+    for (int i = 0; i < numSamples; i++)
+    {
+        const float transfer_gain = transfer[i];
 
         gain = transfer_gain < gain ?
                transfer_gain + attack * (gain - transfer_gain) :
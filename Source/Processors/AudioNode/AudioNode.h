@@ -67,6 +67,8 @@ public:
   void setRelease(float);
   void reset();
 
+  /** Follows the envelope and applies the gain in two recursive passes, with the
+      transfer gain of every sample computed in between as one vectorised pass */
   void process(float* sampleData, int numSamples);
 
 private:
@@ -76,6 +78,9 @@ private:
     float   transfer_A, transfer_B;
     float   env, gain;
 
+    HeapBlock<float> transferGains;
+    int     transferGainsSize;
+
 };
 
 class AudioNode : public GenericProcessor
@@ -140,19 +145,16 @@ private:
     float volume;
     float noiseGateLevel; // in microvolts
 
-    OwnedArray<AudioSampleBuffer> bufferA;
-    OwnedArray<AudioSampleBuffer> bufferB;
+    /** Samples of each channel received beyond those needed by the last block, played first in the next one */
+    OwnedArray<AudioSampleBuffer> backupBuffers;
 
     Array<int> numSamplesExpected;
 
     Array<int> samplesInBackupBuffer;
-    Array<int> samplesInOverflowBuffer;
     Array<double> sourceBufferSampleRate;
     double destBufferSampleRate;
 	int estimatedSamples;
 
-    Array<bool> bufferSwap;
-
     Expander expander;
 
     // sample rate, timebase, and ratio info:
@@ -161,7 +163,7 @@ private:
     // major objects:
     OwnedArray<Dsp::Filter> filters;
 
-    // Temporary buffer for data
+    // Temporary buffer for data: the source samples of a channel, and the same resampled
     ScopedPointer<AudioSampleBuffer> tempBuffer;
 
 	//private map for datachannels with info relative to multiple processors
@@ -39,9 +39,6 @@ AudioResamplingNode::AudioResamplingNode()
                          44100.0, // sampleRate
                          128);    // blockSize
 
-    filter = new Dsp::SmoothedFilterDesign
-    <Dsp::RBJ::Design::LowPass, 1> (1024);
-
     if (destBufferIsTempBuffer)
         destBufferWidth = 1024;
     else
@@ -61,7 +58,6 @@ AudioResamplingNode::~AudioResamplingNode()
     delete[] continuousDataBuffer;
     deleteAndZero(tempBuffer);
     deleteAndZero(destBuffer);
-    delete filter;
 }
 
 
@@ -112,25 +108,17 @@ void AudioResamplingNode::prepareToPlay(double sampleRate_, int estimatedSamples
     // std::cout << "Temp buffer size: " << tempBuffer->getNumChannels() << " x "
     //           << tempBuffer->getNumSamples() << std::endl;
 
-    updateFilter();
+    ratio = sourceBufferSampleRate / destBufferSampleRate;
+    lastRatio = ratio;
+    updateResampler();
 
 }
 
-void AudioResamplingNode::updateFilter()
+void AudioResamplingNode::updateResampler()
 {
 
-    double cutoffFreq = (ratio > 1.0) ? 2 * destBufferSampleRate  // downsample
-                        : destBufferSampleRate / 2; // upsample
-
-    double sampleFreq = (ratio > 1.0) ? sourceBufferSampleRate // downsample
-                        : destBufferSampleRate;  // upsample
-
-    Dsp::Params params;
-    params[0] = sampleFreq; // sample rate
-    params[1] = cutoffFreq; // cutoff frequency
-    params[2] = 1.25; //Q //
-
-    filter->setParams(params);
+    // the resampler keeps its history across rate changes, so the output stays continuous
+    resampler.setup(getNumInputs(), sourceBufferSampleRate, destBufferSampleRate);
 
 }
 
@@ -143,109 +131,32 @@ void AudioResamplingNode::process(AudioSampleBuffer& buffer,
                                   MidiBuffer& midiMessages)
 {
 
-    int nSamps = buffer.getNumSamples(); // WRONG!!!!
-    int valuesNeeded;
-
-    if (destBufferIsTempBuffer)
-    {
-        ratio = float(nSamps) / float(buffer.getNumSamples());
-        valuesNeeded = buffer.getNumSamples();
-    }
-    else
-    {
-        ratio = sourceBufferSampleRate / destBufferSampleRate;
-        valuesNeeded = (int) buffer.getNumSamples() / ratio;
-        //std::cout << std::endl;
-        //std::cout << "Ratio: " << ratio << std::endl;
-        //std::cout << "Values needed: " << valuesNeeded << std::endl;
-    }
-
-
+    ratio = sourceBufferSampleRate / destBufferSampleRate;
 
     if (lastRatio != ratio)
     {
-        updateFilter();
+        updateResampler();
         lastRatio = ratio;
     }
 
+    const int numChannels = buffer.getNumChannels();
 
-    if (ratio > 1.0001)
-    {
-        // pre-apply filter before downsampling
-        filter->process(nSamps, buffer.getArrayOfWritePointers());
-    }
-
-
-    // initialize variables
-    tempBuffer->clear();
-    int sourceBufferPos = 0;
-    int sourceBufferSize = buffer.getNumSamples();
-    float subSampleOffset = 0.0;
-    int nextPos = (sourceBufferPos + 1) % sourceBufferSize;
-
-    int tempBufferPos;
-    //int totalSamples = 0;
+    if (resampler.getNumChannels() != numChannels)
+        resampler.setup(numChannels, sourceBufferSampleRate, destBufferSampleRate);
 
-    // code modified from "juce_ResamplingAudioSource.cpp":
+    const int tempBufferPos = resampler.getNumOutputSamples(buffer.getNumSamples());
 
-    for (tempBufferPos = 0; tempBufferPos < valuesNeeded; tempBufferPos++)
+    if (tempBuffer->getNumChannels() < numChannels
+        || tempBuffer->getNumSamples() < tempBufferPos)
     {
-        float gain = 1.0;
-        float alpha = (float) subSampleOffset;
-        float invAlpha = 1.0f - alpha;
-
-        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-        {
-
-            tempBuffer->addFrom(channel, 		// destChannel
-                                tempBufferPos,  // destSampleOffset
-                                buffer,			// source
-                                channel,		// sourceChannel
-                                sourceBufferPos,// sourceSampleOffset
-                                1,				// number of samples
-                                invAlpha*gain);      // gain to apply to source
-
-            tempBuffer->addFrom(channel, 		// destChannel
-                                tempBufferPos,   // destSampleOffset
-                                buffer,			// source
-                                channel,			// sourceChannel
-                                nextPos,		 	// sourceSampleOffset
-                                1,				// number of samples
-                                alpha*gain);     	 // gain to apply to source
-
-        }
-
-        subSampleOffset += ratio;
-
-
-
-        while (subSampleOffset >= 1.0)
-        {
-            if (++sourceBufferPos >= sourceBufferSize)
-                sourceBufferPos = 0;
-
-            nextPos = (sourceBufferPos + 1) % sourceBufferSize;
-            subSampleOffset -= 1.0;
-        }
+        tempBuffer->setSize(jmax(numChannels, tempBuffer->getNumChannels()),
+                            jmax(tempBufferPos, tempBuffer->getNumSamples()));
     }
 
-    // std::cout << sourceBufferPos << " " << tempBufferPos << std::endl;
-
-
-    if (ratio < 0.9999)
-    {
-
-        filter->process(tempBufferPos, tempBuffer->getArrayOfWritePointers());
-        // apply the filter after upsampling
-        ///////filter->process (totalSamples, buffer.getArrayOfChannels());
-    }
-    else if (ratio <= 1.0001)
-    {
-
-        // no resampling is being applied, no need to filter, BUT...
-        // keep the filter stoked with samples to avoid discontinuities
-
-    }
+    // filters and interpolates every channel in one pass
+    resampler.process(buffer.getNumSamples(),
+                      buffer.getArrayOfReadPointers(),
+                      tempBuffer->getArrayOfWritePointers());
 
     if (destBufferIsTempBuffer)
     {
@@ -261,10 +172,7 @@ void AudioResamplingNode::process(AudioSampleBuffer& buffer,
 
         // copy the temp buffer into the destination buffer
 
-        int pos = 0;
-
-        while (*tempBuffer->getWritePointer(0,pos) != 0)
-            pos++;
+        int pos = tempBufferPos;
 
         int spaceAvailable = destBufferWidth - destBufferPos;
         int blockSize1 = (spaceAvailable > pos) ? pos : spaceAvailable;
@@ -33,7 +33,8 @@
   Changes the sample rate of continuous data, specialized for increasing
   the sample rate to 44.1 kHz for audio output.
 
-  Code is based on Juce's ResamplingAudioSource class.
+  Resampling is done by a Dsp::PolyphaseResampler, which filters and
+  interpolates in a single pass.
 
   This processor could be vastly improved by implementing a scheme to handle
   inputs that do not provide the same amount of samples in each buffer. At the
@@ -55,7 +56,7 @@ public:
     {
         return destBuffer;
     }
-    void updateFilter();
+    void updateResampler();
 
     void prepareToPlay(double sampleRate, int estimatedSamplesPerBlock);
     void releaseResources();
@@ -77,7 +78,7 @@ private:
     int destBufferWidth;
 
     // major objects:
-    Dsp::Filter* filter;
+    Dsp::PolyphaseResampler resampler;
     AudioSampleBuffer* destBuffer;
     AudioSampleBuffer* tempBuffer;
 
@@ -154,6 +154,9 @@ InfoObjectCommon::InfoObjectCommon(uint16 idx, uint16 typeidx, float sampleRate,
 		m_sourceTypeIndex(typeidx),
 		m_sampleRate(sampleRate)
 {
+	m_sourceChannelInfo.processorID = getSourceNodeID();
+	m_sourceChannelInfo.subProcessorID = getSubProcessorIdx();
+	m_sourceChannelInfo.channelIDX = idx;
 }
 
 InfoObjectCommon::~InfoObjectCommon()
@@ -170,6 +173,11 @@ uint16 InfoObjectCommon::getSourceIndex() const
 	return m_sourceIndex;
 }
 
+const SourceChannelInfo& InfoObjectCommon::getSourceInfo() const
+{
+	return m_sourceChannelInfo;
+}
+
 uint16 InfoObjectCommon::getSourceTypeIndex() const
 {
 	return m_sourceTypeIndex;
@@ -253,6 +261,33 @@ DataChannel::DataChannelTypes DataChannel::getChannelType() const
 	return m_type;
 }
 
+static const char* hardwareHighPassIdentifier = "channelInfo.hardwareFilter.highPass";
+
+void DataChannel::setHardwareHighPass(float cutoffHz)
+{
+	MetaDataDescriptor desc(MetaDataDescriptor::FLOAT, 1, "Hardware high-pass",
+		"Cutoff in Hz of the high-pass filter applied by the acquisition hardware", hardwareHighPassIdentifier);
+	MetaDataValue val(desc);
+	val.setValue(cutoffHz);
+
+	const int index = findMetaData(MetaDataDescriptor::FLOAT, 1, hardwareHighPassIdentifier);
+	if (index < 0)
+		addMetaData(desc, val);
+	else
+		m_metaDataValueArray.set(index, new MetaDataValue(val));
+}
+
+float DataChannel::getHardwareHighPass() const
+{
+	const int index = findMetaData(MetaDataDescriptor::FLOAT, 1, hardwareHighPassIdentifier);
+	if (index < 0)
+		return 0;
+
+	float cutoffHz;
+	getMetaDataValue(index)->getValue(cutoffHz);
+	return cutoffHz;
+}
+
 bool DataChannel::isEnabled() const
 {
 	return m_isEnabled;
@@ -407,6 +442,37 @@ size_t EventChannel::getDataSize() const
 	return m_dataSize;
 }
 
+void EventChannel::setMaxRecordsPerEvent(unsigned int maxRecords)
+{
+	if (m_type < BINARY_BASE_VALUE || m_type >= INVALID)
+	{
+		jassertfalse;
+		return;
+	}
+	m_maxRecords = maxRecords;
+	m_dataSize = (maxRecords > 0) ? getBatchedDataSize(maxRecords) : getRecordSize();
+}
+
+unsigned int EventChannel::getMaxRecordsPerEvent() const
+{
+	return m_maxRecords;
+}
+
+bool EventChannel::isBatched() const
+{
+	return m_maxRecords > 0;
+}
+
+size_t EventChannel::getRecordSize() const
+{
+	return m_length * getTypeByteSize(m_type);
+}
+
+size_t EventChannel::getBatchedDataSize(unsigned int numRecords) const
+{
+	return sizeof(uint32) + numRecords * (sizeof(int32) + getRecordSize());
+}
+
 void EventChannel::setShouldBeRecorded(bool status)
 {
 	m_shouldBeRecorded = status;
@@ -525,6 +591,7 @@ bool EventChannel::checkEqual(const InfoObjectCommon& other, bool similar) const
 	if (m_type != o.m_type) return false;
 	if (m_numChannels != o.m_numChannels) return false;
 	if (m_length != o.m_length) return false;
+	if (m_maxRecords != o.m_maxRecords) return false;
 	if (similar && !hasSimilarMetadata(o)) return false;
 	if (!similar && !hasSameMetadata(o)) return false;
 	if (similar && !hasSimilarEventMetadata(o)) return false;
@@ -557,12 +624,9 @@ SpikeChannel::SpikeChannel(ElectrodeTypes type, GenericProcessor* source, const
 	jassert(n == getNumChannels(type));
 	for (int i = 0; i < n; i++)
 	{
-		SourceChannelInfo info;
 		const DataChannel* chan = sourceChannels[i];
-		info.processorID = chan->getSourceNodeID();
-		info.subProcessorID = chan->getSubProcessorIdx();
-		info.channelIDX = chan->getSourceIndex();
-		m_sourceInfo.add(info);
+		m_sourceInfo.add(chan->getSourceInfo());
+		m_currentNodeSourceChannels.add(-1);
 		m_channelBitVolts.add(chan->getBitVolts());
 	}
 	setDefaultNameAndDescription();
@@ -581,11 +645,21 @@ SpikeChannel::ElectrodeTypes SpikeChannel::getChannelType() const
 	return m_type;
 }
 
-Array<SourceChannelInfo> SpikeChannel::getSourceChannelInfo() const
+const Array<SourceChannelInfo>& SpikeChannel::getSourceChannelInfo() const
 {
 	return m_sourceInfo;
 }
 
+const SourceChannelInfo& SpikeChannel::getSourceChannelInfo(int chan) const
+{
+	return m_sourceInfo.getReference(chan);
+}
+
+const Array<int>& SpikeChannel::getCurrentNodeSourceChannels() const
+{
+	return m_currentNodeSourceChannels;
+}
+
 void SpikeChannel::setNumSamples(unsigned int preSamples, unsigned int postSamples)
 {
 	m_numPreSamples = preSamples;
@@ -644,6 +718,21 @@ size_t SpikeChannel::getChannelDataSize() const
 	return getTotalSamples()*sizeof(float);
 }
 
+void SpikeChannel::setInt16Waveforms(bool int16)
+{
+	m_int16Waveforms = int16;
+}
+
+bool SpikeChannel::hasInt16Waveforms() const
+{
+	return m_int16Waveforms;
+}
+
+size_t SpikeChannel::getWaveformDataSize() const
+{
+	return getTotalSamples()*getNumChannels()*(m_int16Waveforms ? sizeof(int16) : sizeof(float));
+}
+
 float SpikeChannel::getChannelBitVolts(int index) const
 {
 	if (index < 0 || index >= m_channelBitVolts.size())
@@ -684,6 +773,7 @@ bool SpikeChannel::checkEqual(const InfoObjectCommon& other, bool similar) const
 	if (m_type != o.m_type) return false;
 	if (m_numPostSamples != o.m_numPostSamples) return false;
 	if (m_numPreSamples != o.m_numPreSamples) return false;
+	if (m_int16Waveforms != o.m_int16Waveforms) return false;
 
 	int nChans = m_channelBitVolts.size();
 	if (nChans != o.m_channelBitVolts.size()) return false;
@@ -173,6 +173,10 @@ public:
 	to its subtype (HEADSTAGE, AUX or ADC for data channels, TTL, MESSAGE or BINARY for events, etc...) */
 	uint16 getSourceTypeIndex() const;
 
+	/** Gets the processor, subprocessor and index this channel originates from, as they appear in
+	the events of the channel. Built once, so it can be read for every event */
+	const SourceChannelInfo& getSourceInfo() const;
+
 	virtual InfoObjectType getInfoObjectType() const = 0;
 
 	bool isEqual(const InfoObjectCommon& other) const;
@@ -187,6 +191,7 @@ private:
 	/** Index of this particular subtype in the source processor */
 	const uint16 m_sourceTypeIndex;
 	const float m_sampleRate;
+	SourceChannelInfo m_sourceChannelInfo;
 };
 
 // ------- Main objects -------//
@@ -234,6 +239,13 @@ public:
 
 	DataChannelTypes getChannelType() const;
 
+	/** Records, as metadata, the cutoff of a high-pass filter the acquisition hardware
+	already applies to this channel, so that downstream filters can leave it out. */
+	void setHardwareHighPass(float cutoffHz);
+
+	/** Returns the cutoff of the high-pass applied by the hardware, or 0 if there is none */
+	float getHardwareHighPass() const;
+
 	//--------- STATUS METHODS ----------//
 	/** Toggled when a channel is disabled from further processing. */
 	bool isEnabled() const;
@@ -371,8 +383,29 @@ public:
 	*/
 	unsigned int getLength() const;
 
-	/** Gets the size of the event payload in bytes*/
+	/** Gets the size of the event payload in bytes. For batched channels this is the size of an event
+	carrying getMaxRecordsPerEvent() records, the largest an event can be*/
 	size_t getDataSize() const;
+
+	/** Makes a typed array channel batched: each event carries a variable number of records, up to
+	maxRecords, of getLength() elements each. Every record has its own sample offset relative to the
+	event timestamp, so producers of many small records can send one event per block instead of one per record.
+	Must be called before the channel is added to the processor. Zero turns batching off.
+	The payload of a batched event is laid out as
+	uint32 numRecords | int32 sampleOffsets[numRecords] | records[numRecords]
+	and is only as long as the records it holds*/
+	void setMaxRecordsPerEvent(unsigned int maxRecords);
+
+	/** Gets the maximum number of records in a batched event, zero if the channel is not batched*/
+	unsigned int getMaxRecordsPerEvent() const;
+
+	bool isBatched() const;
+
+	/** Gets the size in bytes of a single record, getLength() elements of the channel type*/
+	size_t getRecordSize() const;
+
+	/** Gets the payload size of a batched event carrying numRecords records*/
+	size_t getBatchedDataSize(unsigned int numRecords) const;
 	
 	/** Sets if the event should be recorded or not.
 		Note that this option does not prevent the event from actually being recorded, it simply states
@@ -425,6 +458,7 @@ private:
 	unsigned int m_numChannels{ 1 };
 	size_t m_dataSize{ 1 };
 	unsigned int m_length{ 1 };
+	unsigned int m_maxRecords{ 0 };
 	bool m_shouldBeRecorded{ true };
 
 	JUCE_LEAK_DETECTOR(EventChannel);
@@ -455,7 +489,15 @@ public:
 	ElectrodeTypes getChannelType() const;
 
 	/** Returns an array with info about the channels from which the spikes originate */
-	Array<SourceChannelInfo> getSourceChannelInfo() const;
+	const Array<SourceChannelInfo>& getSourceChannelInfo() const;
+
+	/** Returns the info about one of the channels from which the spikes originate */
+	const SourceChannelInfo& getSourceChannelInfo(int chan) const;
+
+	/** Gets, for each channel from which the spikes originate, the index of that data channel in the
+	processor which currently owns this copy of the info object, or -1 if it has no such channel.
+	Rebuilt with the channel indexes of the processor at every update */
+	const Array<int>& getCurrentNodeSourceChannels() const;
 
 	/** Sets the number of samples, pre and post peak */
 	void setNumSamples(unsigned int preSamples, unsigned int postSamples);
@@ -481,6 +523,16 @@ public:
 	/** Gets the size in bytes of one channel of the spike object*/
 	size_t getChannelDataSize() const;
 
+	/** Makes the spike events of this channel carry their waveforms as int16 multiples of the bitVolts
+	of each source channel instead of floats, halving their size. Must be set before acquisition starts */
+	void setInt16Waveforms(bool int16);
+
+	/** Returns true if the spike events carry their waveforms as int16 */
+	bool hasInt16Waveforms() const;
+
+	/** Gets the size in bytes of the waveforms in a serialized spike event */
+	size_t getWaveformDataSize() const;
+
 	/** Gets the number of channels associated with a specific electrode type */
 	static unsigned int getNumChannels(ElectrodeTypes type);
 
@@ -491,11 +543,15 @@ public:
 	void setDefaultNameAndDescription() override;
 private:
 	bool checkEqual(const InfoObjectCommon& other, bool similar) const override;
+	//This field should never be changed by anything except GenericProcessor base code
+	friend class GenericProcessor;
 	const ElectrodeTypes m_type;
 	Array<SourceChannelInfo> m_sourceInfo;
+	Array<int> m_currentNodeSourceChannels;
 	unsigned int m_numPreSamples{ 8 };
 	unsigned int m_numPostSamples{ 32 };
 	Array<float> m_channelBitVolts;
+	bool m_int16Waveforms{ false };
 
 	JUCE_LEAK_DETECTOR(DataChannel);
 };
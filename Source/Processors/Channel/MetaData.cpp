@@ -402,6 +402,7 @@ void MetaDataEventObject::addEventMetaData(MetaDataDescriptor* desc)
 		return;
 	}
 	m_eventMetaDataDescriptorArray.add(desc);
+	m_eventMetaDataOffsets.add(m_totalSize);
 	size_t size = desc->getDataSize();
 	m_totalSize += size;
 	if (m_maxSize < size)
@@ -417,6 +418,7 @@ void MetaDataEventObject::addEventMetaData(const MetaDataDescriptor& desc)
 		return;
 	}
 	m_eventMetaDataDescriptorArray.add(new MetaDataDescriptor(desc));
+	m_eventMetaDataOffsets.add(m_totalSize);
 	size_t size = desc.getDataSize();
 	m_totalSize += size;
 	if (m_maxSize < size)
@@ -428,6 +430,11 @@ size_t MetaDataEventObject::getTotalEventMetaDataSize() const
 	return m_totalSize;
 }
 
+size_t MetaDataEventObject::getEventMetaDataOffset(int index) const
+{
+	return m_eventMetaDataOffsets[index];
+}
+
 const MetaDataDescriptor* MetaDataEventObject::getEventMetaDataDescriptor(int index) const
 {
 	return m_eventMetaDataDescriptorArray[index];
@@ -518,15 +525,11 @@ bool MetaDataEvent::deserializeMetaData(const MetaDataEventObject* info, const v
 {
 	MetaDataValueArray metaData;
 	int nMetaData = info->getEventMetaDataCount();
-	size_t memIndex = 0;
+	if (info->getTotalEventMetaDataSize() > static_cast<size_t>(size)) return false; //check for buffer boundaries
 	for (int i = 0; i < nMetaData; i++)
 	{
 		const MetaDataDescriptor* desc = info->getEventMetaDataDescriptor(i);
-		size_t dataSize = desc->getDataSize();
-		if ((memIndex + dataSize) > size) return false; //check for buffer boundaries
-		
-		metaData.add(new MetaDataValue(*desc, (static_cast<const char*>(srcBuffer) + memIndex)));
-		memIndex += dataSize;
+		metaData.add(new MetaDataValue(*desc, (static_cast<const char*>(srcBuffer) + info->getEventMetaDataOffset(i))));
 	}
 	m_metaDataValues.swapWith(metaData);
 	return true;
@@ -534,6 +537,92 @@ bool MetaDataEvent::deserializeMetaData(const MetaDataEventObject* info, const v
 
 MetaDataEventLock::MetaDataEventLock() {}
 
+//MetaDataEventWriter
+MetaDataEventWriter::MetaDataEventWriter(const MetaDataEventObject* info, void* buffer)
+	: m_info(info), m_buffer(static_cast<char*>(buffer))
+{}
+
+bool MetaDataEventWriter::isValid() const
+{
+	return m_info != nullptr && m_buffer != nullptr;
+}
+
+template <typename T>
+void MetaDataEventWriter::setValue(int index, T data)
+{
+	if (!isValid()) return;
+	const MetaDataDescriptor* desc = m_info->getEventMetaDataDescriptor(index);
+	jassert(desc->getLength() == 1);
+	jassert(checkMetaDataType<T>(desc->getType()));
+	ignoreUnused(desc);
+	memcpy(m_buffer + m_info->getEventMetaDataOffset(index), &data, sizeof(T));
+}
+
+template <typename T>
+void MetaDataEventWriter::setValue(int index, const T* data)
+{
+	if (!isValid()) return;
+	const MetaDataDescriptor* desc = m_info->getEventMetaDataDescriptor(index);
+	jassert(checkMetaDataType<T>(desc->getType()));
+	memcpy(m_buffer + m_info->getEventMetaDataOffset(index), data, desc->getLength() * sizeof(T));
+}
+
+void MetaDataEventWriter::setValue(int index, const String& data)
+{
+	if (!isValid()) return;
+	const MetaDataDescriptor* desc = m_info->getEventMetaDataDescriptor(index);
+	jassert(desc->getType() == MetaDataDescriptor::CHAR);
+	data.copyToUTF8(m_buffer + m_info->getEventMetaDataOffset(index), desc->getDataSize());
+}
+
+void* MetaDataEventWriter::getRawValuePointer(int index) const
+{
+	if (!isValid()) return nullptr;
+	return m_buffer + m_info->getEventMetaDataOffset(index);
+}
+
+//MetaDataEventReader
+MetaDataEventReader::MetaDataEventReader(const MetaDataEventObject* info, const void* buffer)
+	: m_info(info), m_buffer(static_cast<const char*>(buffer))
+{}
+
+bool MetaDataEventReader::isValid() const
+{
+	return m_info != nullptr && m_buffer != nullptr;
+}
+
+template <typename T>
+void MetaDataEventReader::getValue(int index, T& data) const
+{
+	jassert(isValid());
+	jassert(checkMetaDataType<T>(m_info->getEventMetaDataDescriptor(index)->getType()));
+	memcpy(&data, m_buffer + m_info->getEventMetaDataOffset(index), sizeof(T));
+}
+
+template <typename T>
+void MetaDataEventReader::getValue(int index, T* data) const
+{
+	jassert(isValid());
+	const MetaDataDescriptor* desc = m_info->getEventMetaDataDescriptor(index);
+	jassert(checkMetaDataType<T>(desc->getType()));
+	memcpy(data, m_buffer + m_info->getEventMetaDataOffset(index), desc->getLength() * sizeof(T));
+}
+
+void MetaDataEventReader::getValue(int index, String& data) const
+{
+	jassert(isValid());
+	const MetaDataDescriptor* desc = m_info->getEventMetaDataDescriptor(index);
+	jassert(desc->getType() == MetaDataDescriptor::CHAR);
+	const char* str = m_buffer + m_info->getEventMetaDataOffset(index);
+	data = String::fromUTF8(str, int(strnlen(str, desc->getLength())));
+}
+
+const void* MetaDataEventReader::getRawValuePointer(int index) const
+{
+	jassert(isValid());
+	return m_buffer + m_info->getEventMetaDataOffset(index);
+}
+
 //Specific instantiations for templated metadata members.
 //This is done this way for two reasons
 //1-To have the actual binary code in the same translation unit, instead of replicated between GUI and plugins, as would happen if
@@ -615,6 +704,54 @@ template PLUGIN_API void MetaDataValue::getValue<double>(Array<double>&) const;
 
 template PLUGIN_API void MetaDataValue::getValue<void>(void*) const;
 
+template PLUGIN_API void MetaDataEventWriter::setValue<char>(int, char);
+template PLUGIN_API void MetaDataEventWriter::setValue<int8>(int, int8);
+template PLUGIN_API void MetaDataEventWriter::setValue<uint8>(int, uint8);
+template PLUGIN_API void MetaDataEventWriter::setValue<int16>(int, int16);
+template PLUGIN_API void MetaDataEventWriter::setValue<uint16>(int, uint16);
+template PLUGIN_API void MetaDataEventWriter::setValue<int32>(int, int32);
+template PLUGIN_API void MetaDataEventWriter::setValue<uint32>(int, uint32);
+template PLUGIN_API void MetaDataEventWriter::setValue<int64>(int, int64);
+template PLUGIN_API void MetaDataEventWriter::setValue<uint64>(int, uint64);
+template PLUGIN_API void MetaDataEventWriter::setValue<float>(int, float);
+template PLUGIN_API void MetaDataEventWriter::setValue<double>(int, double);
+
+template PLUGIN_API void MetaDataEventWriter::setValue<char>(int, const char*);
+template PLUGIN_API void MetaDataEventWriter::setValue<int8>(int, const int8*);
+template PLUGIN_API void MetaDataEventWriter::setValue<uint8>(int, const uint8*);
+template PLUGIN_API void MetaDataEventWriter::setValue<int16>(int, const int16*);
+template PLUGIN_API void MetaDataEventWriter::setValue<uint16>(int, const uint16*);
+template PLUGIN_API void MetaDataEventWriter::setValue<int32>(int, const int32*);
+template PLUGIN_API void MetaDataEventWriter::setValue<uint32>(int, const uint32*);
+template PLUGIN_API void MetaDataEventWriter::setValue<int64>(int, const int64*);
+template PLUGIN_API void MetaDataEventWriter::setValue<uint64>(int, const uint64*);
+template PLUGIN_API void MetaDataEventWriter::setValue<float>(int, const float*);
+template PLUGIN_API void MetaDataEventWriter::setValue<double>(int, const double*);
+
+template PLUGIN_API void MetaDataEventReader::getValue<char>(int, char&) const;
+template PLUGIN_API void MetaDataEventReader::getValue<int8>(int, int8&) const;
+template PLUGIN_API void MetaDataEventReader::getValue<uint8>(int, uint8&) const;
+template PLUGIN_API void MetaDataEventReader::getValue<int16>(int, int16&) const;
+template PLUGIN_API void MetaDataEventReader::getValue<uint16>(int, uint16&) const;
+template PLUGIN_API void MetaDataEventReader::getValue<int32>(int, int32&) const;
+template PLUGIN_API void MetaDataEventReader::getValue<uint32>(int, uint32&) const;
+template PLUGIN_API void MetaDataEventReader::getValue<int64>(int, int64&) const;
+template PLUGIN_API void MetaDataEventReader::getValue<uint64>(int, uint64&) const;
+template PLUGIN_API void MetaDataEventReader::getValue<float>(int, float&) const;
+template PLUGIN_API void MetaDataEventReader::getValue<double>(int, double&) const;
+
+template PLUGIN_API void MetaDataEventReader::getValue<char>(int, char*) const;
+template PLUGIN_API void MetaDataEventReader::getValue<int8>(int, int8*) const;
+template PLUGIN_API void MetaDataEventReader::getValue<uint8>(int, uint8*) const;
+template PLUGIN_API void MetaDataEventReader::getValue<int16>(int, int16*) const;
+template PLUGIN_API void MetaDataEventReader::getValue<uint16>(int, uint16*) const;
+template PLUGIN_API void MetaDataEventReader::getValue<int32>(int, int32*) const;
+template PLUGIN_API void MetaDataEventReader::getValue<uint32>(int, uint32*) const;
+template PLUGIN_API void MetaDataEventReader::getValue<int64>(int, int64*) const;
+template PLUGIN_API void MetaDataEventReader::getValue<uint64>(int, uint64*) const;
+template PLUGIN_API void MetaDataEventReader::getValue<float>(int, float*) const;
+template PLUGIN_API void MetaDataEventReader::getValue<double>(int, double*) const;
+
 //Helper function to compare identifier strings
 bool compareIdentifierStrings(const String& identifier, const String& compareWith)
 {
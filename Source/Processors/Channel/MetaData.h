@@ -221,6 +221,8 @@ public:
 	const MetaDataDescriptor* getEventMetaDataDescriptor(int index) const;
 	int findEventMetaData(MetaDataDescriptor::MetaDataTypes type, unsigned int length, String identifier = String::empty) const;
 	size_t getTotalEventMetaDataSize() const;
+	/** Gets the offset of a field inside the metadata block of an event, computed when the field was added */
+	size_t getEventMetaDataOffset(int index) const;
 	int getEventMetaDataCount() const;
 	//gets the largest metadata size, which can be useful to reserve buffers in advance
 	size_t getMaxEventMetaDataSize() const;
@@ -228,6 +230,7 @@ public:
 	bool hasSimilarEventMetadata(const MetaDataEventObject& other) const;
 protected:
 	MetaDataDescriptorArray m_eventMetaDataDescriptorArray;
+	Array<size_t> m_eventMetaDataOffsets;
 	MetaDataEventObject();
 	size_t m_totalSize{ 0 };
 	size_t m_maxSize{ 0 };
@@ -249,6 +252,63 @@ protected:
 	MetaDataValueArray m_metaDataValues;
 };
 
+/**
+Writes event metadata values straight into the metadata block of a serialized event, at the
+offsets the channel computed when its fields were added. Processors that send metadata with
+every event can fill it in place instead of building a MetaDataValueArray for each one.
+The types must match the descriptors, as with MetaDataValue. A writer on a null buffer
+does nothing.
+*/
+class PLUGIN_API MetaDataEventWriter
+{
+public:
+	MetaDataEventWriter(const MetaDataEventObject* info, void* buffer);
+
+	bool isValid() const;
+
+	template <typename T>
+	void setValue(int index, T data);
+
+	template <typename T>
+	void setValue(int index, const T* data);
+
+	/** Copies the string, truncated to the field length */
+	void setValue(int index, const String& data);
+
+	void* getRawValuePointer(int index) const;
+
+private:
+	const MetaDataEventObject* m_info;
+	char* m_buffer;
+};
+
+/**
+Reads event metadata values from the metadata block of a serialized event, without creating
+MetaDataValue objects. Valid only as long as the event data is.
+*/
+class PLUGIN_API MetaDataEventReader
+{
+public:
+	MetaDataEventReader(const MetaDataEventObject* info, const void* buffer);
+
+	bool isValid() const;
+
+	template <typename T>
+	void getValue(int index, T& data) const;
+
+	template <typename T>
+	void getValue(int index, T* data) const;
+
+	void getValue(int index, String& data) const;
+
+	/** The pointer is into the event data, so it may not be aligned to the value type */
+	const void* getRawValuePointer(int index) const;
+
+private:
+	const MetaDataEventObject* m_info;
+	const char* m_buffer;
+};
+
 //Helper function to compare identifier strings
 bool compareIdentifierStrings(const String& identifier, const String& compareWith);
 
@@ -21,43 +21,231 @@
 */
 
 #include "DataBuffer.h"
+#include "../GenericProcessor/ThreadPolicy.h"
 
 
-DataBuffer::DataBuffer (int chans, int size)
-    : abstractFifo  (size)
-    , buffer        (chans, size)
-    , numChans      (chans)
+BufferStats::BufferStats()
+    : samplesDropped    (0)
+    , highWaterMark     (0)
+    , capacity          (0)
+    , fillFraction      (0.0f)
+    , secondsFull       (0.0)
+{
+}
+
+
+void BufferStats::merge (const BufferStats& other)
+{
+    samplesDropped += other.samplesDropped;
+    highWaterMark   = jmax (highWaterMark, other.highWaterMark);
+    capacity        = jmax (capacity, other.capacity);
+    fillFraction    = jmax (fillFraction, other.fillFraction);
+    secondsFull     = jmax (secondsFull, other.secondsFull);
+}
+
+
+BufferStatsMonitor::BufferStatsMonitor()
+{
+    reset();
+}
+
+
+void BufferStatsMonitor::reset()
+{
+    samplesDropped = 0;
+    highWaterMark = 0;
+    ticksFull = 0;
+    fullSinceTicks = 0;
+}
+
+
+void BufferStatsMonitor::recordWrite (int numRequested, int numWritten, int numReady, int freeSpace)
+{
+    if (numWritten < numRequested)
+        samplesDropped += numRequested - numWritten;
+
+    if (numReady > highWaterMark)
+        highWaterMark = numReady;
+
+    // only query the clock while the buffer is, or has just stopped being, full
+    const bool isFull = freeSpace <= 0;
+    const int64 since = fullSinceTicks;
+
+    if (isFull && since == 0)
+    {
+        fullSinceTicks = Time::getHighResolutionTicks();
+    }
+    else if (! isFull && since != 0)
+    {
+        ticksFull += Time::getHighResolutionTicks() - since;
+        fullSinceTicks = 0;
+    }
+}
+
+
+BufferStats BufferStatsMonitor::getStats (int numReady, int capacity) const
 {
-    timestampBuffer.malloc (size);
-    eventCodeBuffer.malloc (size);
+    BufferStats s;
+    s.samplesDropped = samplesDropped;
+    s.highWaterMark = highWaterMark;
+    s.capacity = capacity;
+    s.fillFraction = capacity > 0 ? float (numReady) / float (capacity) : 0.0f;
+
+    int64 ticks = ticksFull;
+    const int64 since = fullSinceTicks;
+    if (since != 0)
+        ticks += Time::getHighResolutionTicks() - since;
+
+    s.secondsFull = Time::highResolutionTicksToSeconds (ticks);
+    return s;
+}
+
 
-	lastTimestamp = 0;
+DataBuffer::DataBuffer (int chans, int size)
+    : abstractFifo      (size)
+    , timestampRuns     (nullptr)
+    , eventChanges      (nullptr)
+    , numMarkSlots      (0)
+    , numChans          (chans)
+{
+    resize (chans, size);
 }
 
 
 DataBuffer::~DataBuffer() {}
 
 
+void DataBuffer::reset()
+{
+    writtenSamples = 0;
+    nextTimestamp = 0;
+    lastWrittenCode = 0;
+    numTimestampRuns = 0;
+    numEventChanges = 0;
+
+    readSamples = 0;
+    readTimestampRun = 0;
+    readEventChange = 0;
+    lastReadCode = 0;
+
+    lastTimestamp = 0;
+}
+
+
 void DataBuffer::clear()
 {
     buffer.clear();
     abstractFifo.reset();
-	lastTimestamp = 0;
+    reset();
+    stats.reset();
 }
 
 
 void DataBuffer::resize (int chans, int size)
 {
-    buffer.setSize (chans, size);
+    // the pages are first touched here, so they belong to the acquisition threads' NUMA node
+    ThreadPolicy::ScopedPlacement placement (ThreadPolicy::Acquisition);
 
-    timestampBuffer.malloc (size);
-    eventCodeBuffer.malloc (size);
+    sampleMemory.allocateAudioBuffer (buffer, chans, size);
+    abstractFifo.setTotalSize (size);
 
-	lastTimestamp = 0;
+    // the run covering the oldest unread sample is kept as well
+    numMarkSlots = size / samplesPerMarkSlot + 2;
+    timestampRuns = (Mark*) timestampRunMemory.allocate (numMarkSlots * sizeof (Mark));
+    eventChanges = (Mark*) eventChangeMemory.allocate (numMarkSlots * sizeof (Mark));
+
+    reset();
+    stats.reset();
 
     numChans = chans;
 }
 
+
+void DataBuffer::addTimestampRun (int64 sample, int64 timestamp)
+{
+    const int64 n = numTimestampRuns.load (std::memory_order_relaxed);
+    Mark& mark = timestampRuns[n % numMarkSlots];
+    mark.sample = sample;
+    mark.value = timestamp;
+    numTimestampRuns.store (n + 1, std::memory_order_release);
+}
+
+
+void DataBuffer::addTimestamps (const int64* timestamps, int offset, int numItems)
+{
+    const int64 firstSample = writtenSamples + offset;
+
+    for (int k = 0; k < numItems; ++k)
+    {
+        if (timestamps[k] != nextTimestamp || firstSample + k == 0)
+            addTimestampRun (firstSample + k, timestamps[k]);
+        nextTimestamp = timestamps[k] + 1;
+    }
+}
+
+
+void DataBuffer::addEventChange (int64 sample, uint64 code)
+{
+    const int64 n = numEventChanges.load (std::memory_order_relaxed);
+    Mark& mark = eventChanges[n % numMarkSlots];
+    mark.sample = sample;
+    mark.value = int64 (code);
+    numEventChanges.store (n + 1, std::memory_order_release);
+
+    lastWrittenCode = code;
+}
+
+
+void DataBuffer::addEventCodes (const uint64* eventCodes, int offset, int numItems)
+{
+    const int64 firstSample = writtenSamples + offset;
+
+    for (int k = 0; k < numItems; ++k)
+        if (eventCodes[k] != lastWrittenCode)
+            addEventChange (firstSample + k, eventCodes[k]);
+}
+
+
+int DataBuffer::getNumSamplesWithFreeMarks (const int64* timestamps, const uint64* eventCodes, int numItems) const
+{
+    int64 freeRuns = numMarkSlots - (numTimestampRuns.load (std::memory_order_relaxed) - readTimestampRun.load (std::memory_order_acquire));
+    int64 freeChanges = numMarkSlots - (numEventChanges.load (std::memory_order_relaxed) - readEventChange.load (std::memory_order_acquire));
+    int64 expectedTimestamp = nextTimestamp;
+    uint64 code = lastWrittenCode;
+
+    for (int k = 0; k < numItems; ++k)
+    {
+        if (timestamps[k] != expectedTimestamp || writtenSamples + k == 0)
+        {
+            if (--freeRuns < 0)
+                return k;
+        }
+        expectedTimestamp = timestamps[k] + 1;
+
+        if (eventCodes[k] != code)
+        {
+            if (--freeChanges < 0)
+                return k;
+            code = eventCodes[k];
+        }
+    }
+
+    return numItems;
+}
+
+
+void DataBuffer::finishWrite (int numRequested, int numItems)
+{
+    if (numItems > 0)
+        lastTimestamp = nextTimestamp - 1;
+
+    writtenSamples += numItems;
+
+    abstractFifo.finishedWrite (numItems);
+    stats.recordWrite (numRequested, numItems, abstractFifo.getNumReady(), abstractFifo.getFreeSpace());
+}
+
+
 int DataBuffer::addToBuffer (float* data, int64* timestamps, uint64* eventCodes, int numItems, int chunkSize)
 {
     int startIndex1, blockSize1, startIndex2, blockSize2;
@@ -68,14 +256,9 @@ int DataBuffer::addToBuffer (float* data, int64* timestamps, uint64* eventCodes,
     int si[2] = { startIndex1, startIndex2 };
     int cSize = 0;
     int idx = 0;
-    int blkIdx;
-
-	if (numItems > 0)
-		lastTimestamp = timestamps[numItems-1]; 
 
     for (int i = 0; bs[i] != 0; ++i)
     {                                // for each of the dest blocks we can write to...
-        blkIdx = 0;
         for (int j = 0; j < bs[i]; j+= chunkSize) 
         {                     // for each chunk...
             cSize = chunkSize <= bs[i] - j ? chunkSize : bs[i] - j;     // figure our how much you can write
@@ -87,80 +270,260 @@ int DataBuffer::addToBuffer (float* data, int64* timestamps, uint64* eventCodes,
                                  cSize);                         // (int num samples)
             }
 
-            for (int k = 0; k < cSize; ++k)
-            {
-                timestampBuffer[si[i] + blkIdx + k] = timestamps[idx + k];
-                eventCodeBuffer[si[i] + blkIdx + k] = eventCodes[idx + k];
-            }
             idx     += cSize;
-            blkIdx  += cSize;
         }
     }
 
-	
+    idx = getNumSamplesWithFreeMarks (timestamps, eventCodes, idx);
+
+    addTimestamps (timestamps, 0, idx);
+    addEventCodes (eventCodes, 0, idx);
 
     // finish write
-    abstractFifo.finishedWrite (idx);
+    finishWrite (numItems, idx);
+
+    return idx;
+}
+
+
+int DataBuffer::addInterleavedBlock (const float* data, const int64* timestamps, const uint64* eventCodes, int numItems)
+{
+    int startIndex1, blockSize1, startIndex2, blockSize2;
+
+    abstractFifo.prepareToWrite (numItems, startIndex1, blockSize1, startIndex2, blockSize2);
+
+    const int bs[2] = { blockSize1, blockSize2 };
+    const int si[2] = { startIndex1, startIndex2 };
+    int idx = 0;
+
+    for (int i = 0; i < 2; ++i)
+    {
+        if (bs[i] <= 0)
+            continue;
+
+        // de-interleave this region into each channel
+        for (int chan = 0; chan < numChans; ++chan)
+        {
+            float* dest = buffer.getWritePointer (chan, si[i]);
+            const float* src = data + (idx * numChans) + chan;
+
+            for (int k = 0; k < bs[i]; ++k)
+                dest[k] = src[k * numChans];
+        }
+
+        idx += bs[i];
+    }
+
+    idx = getNumSamplesWithFreeMarks (timestamps, eventCodes, idx);
+
+    addTimestamps (timestamps, 0, idx);
+    addEventCodes (eventCodes, 0, idx);
+
+    finishWrite (numItems, idx);
 
     return idx;
 }
 
 
+int DataBuffer::prepareToWrite (WriteSpans& spans, int numItems)
+{
+    abstractFifo.prepareToWrite (numItems,
+                                 spans.startIndex[0], spans.blockSize[0],
+                                 spans.startIndex[1], spans.blockSize[1]);
+
+    spans.numRequested = numItems;
+    spans.numItems = jmax (0, spans.blockSize[0]) + jmax (0, spans.blockSize[1]);
+    spans.firstTimestamp = nextTimestamp;
+
+    // finishedWrite() may add a timestamp run, so the write waits until there is room for one
+    if (numTimestampRuns.load (std::memory_order_relaxed) - readTimestampRun.load (std::memory_order_acquire) >= numMarkSlots)
+    {
+        spans.blockSize[0] = spans.blockSize[1] = 0;
+        spans.numItems = 0;
+    }
+
+    return spans.numItems;
+}
+
+
+float* DataBuffer::getWritePointer (const WriteSpans& spans, int channel, int region)
+{
+    return buffer.getWritePointer (channel, spans.startIndex[region]);
+}
+
+
+void DataBuffer::setFirstTimestamp (WriteSpans& spans, int64 timestamp)
+{
+    spans.firstTimestamp = timestamp;
+}
+
+
+void DataBuffer::setEventCode (WriteSpans& spans, int sampleOffset, uint64 code)
+{
+    jassert (sampleOffset >= 0);
+
+    // already cut short by an earlier change
+    if (sampleOffset >= spans.numItems || code == lastWrittenCode)
+        return;
+
+    if (numEventChanges.load (std::memory_order_relaxed) - readEventChange.load (std::memory_order_acquire) >= numMarkSlots)
+    {
+        spans.numItems = sampleOffset;
+        return;
+    }
+
+    addEventChange (writtenSamples + sampleOffset, code);
+}
+
+
+void DataBuffer::finishedWrite (const WriteSpans& spans)
+{
+    if (spans.numItems > 0)
+    {
+        if (spans.firstTimestamp != nextTimestamp || writtenSamples == 0)
+            addTimestampRun (writtenSamples, spans.firstTimestamp);
+        nextTimestamp = spans.firstTimestamp + spans.numItems;
+    }
+
+    finishWrite (spans.numRequested, spans.numItems);
+}
+
+
 int DataBuffer::getNumSamples() const { return abstractFifo.getNumReady(); }
 
 
-int DataBuffer::readAllFromBuffer (AudioSampleBuffer& data, uint64* timestamp, uint64* eventCodes, int maxSize, int dstStartChannel, int numChannels)
+BufferStats DataBuffer::getStats() const
 {
-    // check to see if the maximum size is smaller than the total number of available ints
+    return stats.getStats (abstractFifo.getNumReady(), abstractFifo.getTotalSize() - 1);
+}
 
-    // Better version (1/27/14)?
-    int numReady = abstractFifo.getNumReady();
-    int numItems = (maxSize < numReady) ? maxSize : numReady;
 
-    // Original version:
-    //int numItems = (maxSize < abstractFifo.getNumReady()) ?
-    //               maxSize : abstractFifo.getNumReady();
+size_t DataBuffer::getMemorySize() const
+{
+    return sampleMemory.getSize() + timestampRunMemory.getSize() + eventChangeMemory.getSize();
+}
 
-    int startIndex1, blockSize1, startIndex2, blockSize2;
-    abstractFifo.prepareToRead (numItems, startIndex1, blockSize1, startIndex2, blockSize2);
+
+int DataBuffer::readAllFromBuffer (AudioSampleBuffer& data, uint64* timestamp, uint64* eventCodes, int maxSize, int dstStartChannel, int numChannels)
+{
+    ReadSpans spans;
+    int numItems = prepareToRead (spans, maxSize);
 
 	int channelsToCopy = numChannels < 0 ? data.getNumChannels() : numChannels;
+    int destStart = 0;
 
-    if (blockSize1 > 0)
+    for (int region = 0; region < 2; ++region)
     {
+        const int blockSize = spans.blockSize[region];
+
+        if (blockSize <= 0)
+            continue;
+
         for (int chan = 0; chan < channelsToCopy; ++chan)
         {
             data.copyFrom (dstStartChannel+chan,            // destChan
-                           0,               // destStartSample
+                           destStart,       // destStartSample
                            buffer,          // source
                            chan,            // sourceChannel
-                           startIndex1,     // sourceStartSample
-                           blockSize1);     // numSamples
+                           spans.startIndex[region],        // sourceStartSample
+                           blockSize);      // numSamples
         }
 
-        memcpy (timestamp, timestampBuffer + startIndex1, 8);
-        memcpy (eventCodes, eventCodeBuffer + startIndex1, blockSize1 * 8);
-    }
-    else
-    {
-		memcpy(timestamp, &lastTimestamp, 8);
+        destStart += blockSize;
     }
 
-    if (blockSize2 > 0)
+    // expand the event code changes for callers that want a code per sample
+    uint64 code = spans.initialEventCode;
+    int nextChange = 0;
+    for (int k = 0; k < numItems; ++k)
     {
-        for (int chan = 0; chan < channelsToCopy; ++chan)
-        {
-            data.copyFrom (dstStartChannel+chan,            // destChan
-                           blockSize1,      // destStartSample
-                           buffer,          // source
-                           chan,            // sourceChannel
-                           startIndex2,     // sourceStartSample
-                           blockSize2);     // numSamples
-        }
-        memcpy (eventCodes + blockSize1, eventCodeBuffer + startIndex2, blockSize2 * 8);
+        while (nextChange < spans.numEventChanges && getEventChange (spans, nextChange).sampleOffset == k)
+            code = getEventChange (spans, nextChange++).code;
+        eventCodes[k] = code;
     }
 
-    abstractFifo.finishedRead (numItems);
+    *timestamp = getFirstTimestamp (spans);
+
+    finishedRead (spans);
 
     return numItems;
 }
+
+
+int DataBuffer::prepareToRead (ReadSpans& spans, int maxSize) const
+{
+    int numReady = abstractFifo.getNumReady();
+    spans.numItems = (maxSize < numReady) ? maxSize : numReady;
+
+    abstractFifo.prepareToRead (spans.numItems,
+                                spans.startIndex[0], spans.blockSize[0],
+                                spans.startIndex[1], spans.blockSize[1]);
+
+    // the marks of published samples were stored before the fifo published them
+    spans.firstSample = readSamples;
+
+    const int64 numRuns = numTimestampRuns.load (std::memory_order_acquire);
+    int64 run = readTimestampRun.load (std::memory_order_relaxed);
+    while (run + 1 < numRuns && timestampRuns[(run + 1) % numMarkSlots].sample <= readSamples)
+        ++run;
+    spans.timestampRun = run;
+
+    const int64 numChanges = numEventChanges.load (std::memory_order_acquire);
+    const int64 firstChange = readEventChange.load (std::memory_order_relaxed);
+    const int64 endSample = readSamples + spans.numItems;
+    int n = 0;
+    while (firstChange + n < numChanges && eventChanges[(firstChange + n) % numMarkSlots].sample < endSample)
+        ++n;
+
+    spans.initialEventCode = lastReadCode;
+    spans.numEventChanges = n;
+    spans.firstEventChange = firstChange;
+
+    return spans.numItems;
+}
+
+
+const float* DataBuffer::getReadPointer (const ReadSpans& spans, int channel, int region) const
+{
+    return buffer.getReadPointer (channel, spans.startIndex[region]);
+}
+
+
+DataBuffer::EventChange DataBuffer::getEventChange (const ReadSpans& spans, int index) const
+{
+    const Mark& mark = eventChanges[(spans.firstEventChange + index) % numMarkSlots];
+
+    EventChange change;
+    change.sampleOffset = int (mark.sample - spans.firstSample);
+    change.code = uint64 (mark.value);
+    return change;
+}
+
+
+int64 DataBuffer::getFirstTimestamp (const ReadSpans& spans) const
+{
+    if (spans.numItems <= 0)
+        return lastTimestamp;
+
+    const Mark& run = timestampRuns[spans.timestampRun % numMarkSlots];
+    return run.value + (spans.firstSample - run.sample);
+}
+
+
+void DataBuffer::finishedRead (const ReadSpans& spans)
+{
+    readSamples += spans.numItems;
+
+    // move on to the run covering the next unread sample, which frees the slots of the runs before it
+    const int64 numRuns = numTimestampRuns.load (std::memory_order_acquire);
+    int64 run = spans.timestampRun;
+    while (run + 1 < numRuns && timestampRuns[(run + 1) % numMarkSlots].sample <= readSamples)
+        ++run;
+    readTimestampRun.store (run, std::memory_order_release);
+
+    if (spans.numEventChanges > 0)
+        lastReadCode = getEventChange (spans, spans.numEventChanges - 1).code;
+    readEventChange.store (spans.firstEventChange + spans.numEventChanges, std::memory_order_release);
+
+    abstractFifo.finishedRead (spans.numItems);
+}
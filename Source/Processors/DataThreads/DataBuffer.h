@@ -25,16 +25,121 @@
 
 #include "../../../JuceLibraryCode/JuceHeader.h"
 #include "../PluginManager/OpenEphysPlugin.h"
+#include "../GenericProcessor/LockedMemoryBlock.h"
+#include <atomic>
+
+/** Snapshot of the load of a circular buffer, see BufferStatsMonitor */
+struct PLUGIN_API BufferStats
+{
+    BufferStats();
+
+    /** Samples that could not be written because the buffer was full */
+    int64 samplesDropped;
+
+    /** Largest number of samples waiting in the buffer since the last reset */
+    int highWaterMark;
+
+    /** Number of samples the buffer can hold */
+    int capacity;
+
+    /** Fraction of the buffer currently in use, from 0 to 1 */
+    float fillFraction;
+
+    /** Total time the buffer has spent full since the last reset, in seconds */
+    double secondsFull;
+
+    /** Combines the stats of two buffers, keeping the worst case of each field */
+    void merge (const BufferStats& other);
+};
+
+/**
+    Keeps overflow counters for a fifo. Written by the producer thread,
+    read from any thread through getStats().
+*/
+class PLUGIN_API BufferStatsMonitor
+{
+public:
+    BufferStatsMonitor();
+
+    void reset();
+
+    /** Called by the producer after each write with the fifo state after the write */
+    void recordWrite (int numRequested, int numWritten, int numReady, int freeSpace);
+
+    BufferStats getStats (int numReady, int capacity) const;
+
+private:
+    std::atomic<int64> samplesDropped;
+    std::atomic<int> highWaterMark;
+    std::atomic<int64> ticksFull;
+    std::atomic<int64> fullSinceTicks;
+};
 
 
 /**
     Manages reading and writing data to a circular buffer.
 
+    Samples are stored per channel. Timestamps and event codes are not stored
+    per sample: the buffer keeps the timestamp of the first sample of each run
+    of consecutive timestamps, usually one per write, and the samples at which
+    the event code (the TTL word) changes. Readers get the first timestamp of a
+    view and its list of event code changes.
+
+    Both are kept in rings with a slot for every samplesPerMarkSlot samples the
+    buffer can hold. A write that needs more marks than are free is cut short at
+    the first sample without one, and the rest is dropped as if the buffer was full.
+
     See @DataThread
 */
 class PLUGIN_API DataBuffer
 {
 public:
+    /** The event code changing at a sample of a ReadSpans view */
+    struct EventChange
+    {
+        /** Index of the sample in the view, counting across both regions */
+        int sampleOffset;
+        /** Event code from this sample on */
+        uint64 code;
+    };
+
+    /** Read-only view of the samples at the head of the buffer.
+
+        The samples are split in at most two contiguous regions because of the
+        circular layout. The view stays valid until finishedRead() is called.
+    */
+    struct ReadSpans
+    {
+        int numItems;
+        int startIndex[2];
+        int blockSize[2];
+
+        /** Event code in effect just before the first sample of the view */
+        uint64 initialEventCode;
+        /** Number of event code changes within the view, see getEventChange() */
+        int numEventChanges;
+
+        int64 firstSample;
+        int64 timestampRun;
+        int64 firstEventChange;
+    };
+
+    /** Writable view of the free space at the tail of the buffer, for sources that
+        decode their data straight into the channel arrays.
+
+        Like ReadSpans, the space is split in at most two contiguous regions. Nothing
+        is visible to the reader until finishedWrite() is called.
+    */
+    struct WriteSpans
+    {
+        int numRequested;
+        int numItems;
+        int startIndex[2];
+        int blockSize[2];
+
+        int64 firstTimestamp;
+    };
+
     DataBuffer (int chans, int size);
     ~DataBuffer();
 
@@ -55,24 +160,140 @@ public:
     */
     int addToBuffer (float* data, int64* timestamps, uint64* eventCodes, int numItems, int chunkSize=1);
 
+    /** Add a whole block of interleaved samples to the buffer with a single fifo reservation.
+
+        @param data Interleaved data, numItems frames of numChans consecutive floats each.
+        @param timestamps Array of timestamps. Same length as numItems.
+        @param eventCodes Array of event codes. Same length as numItems.
+        @param numItems Total number of samples per channel.
+
+        @return The number of items actually written. May be less than numItems if
+        the buffer doesn't have space.
+    */
+    int addInterleavedBlock (const float* data, const int64* timestamps, const uint64* eventCodes, int numItems);
+
+    /** Reserves space for up to numItems samples to be written in place.
+
+        The data of each region is filled through getWritePointer(), the timestamp
+        of the first sample is given with setFirstTimestamp() and any event code
+        changes with setEventCode(), then everything is published with finishedWrite().
+
+        @return The number of samples reserved. May be less than numItems if
+        the buffer doesn't have space.
+    */
+    int prepareToWrite (WriteSpans& spans, int numItems);
+
+    /** Returns the samples of a channel in one of the regions of a WriteSpans view.*/
+    float* getWritePointer (const WriteSpans& spans, int channel, int region);
+
+    /** Sets the timestamp of the first sample of a WriteSpans view. The following samples
+        have consecutive timestamps.*/
+    void setFirstTimestamp (WriteSpans& spans, int64 timestamp);
+
+    /** Sets the event code from a sample of a WriteSpans view on, counting across both
+        regions. Calls must come in sample order; the code stays the same as in the
+        previous write until it is set. If no event code slot is free, the view is
+        cut short before sampleOffset.*/
+    void setEventCode (WriteSpans& spans, int sampleOffset, uint64 code);
+
+    /** Publishes all the samples of a WriteSpans view to the reader.*/
+    void finishedWrite (const WriteSpans& spans);
+
     /** Returns the number of samples currently available in the buffer.*/
     int getNumSamples() const;
 
     /** Copies as many samples as possible from the DataBuffer to an AudioSampleBuffer.*/
     int readAllFromBuffer (AudioSampleBuffer& data, uint64* ts, uint64* eventCodes, int maxSize, int dstStartChannel = 0, int numChannels = -1);
 
+    /** Reserves up to maxSize samples for reading without copying them.
+
+        The data of each region can then be accessed through getReadPointer(), the
+        first timestamp through getFirstTimestamp() and the event code changes through
+        getEventChange(). The samples are released with finishedRead() once they
+        have been consumed.
+
+        @return The number of samples in the view.
+    */
+    int prepareToRead (ReadSpans& spans, int maxSize) const;
+
+    /** Returns the samples of a channel in one of the regions of a ReadSpans view.*/
+    const float* getReadPointer (const ReadSpans& spans, int channel, int region) const;
+
+    /** Returns one of the spans.numEventChanges event code changes of a ReadSpans view,
+        in sample order.*/
+    EventChange getEventChange (const ReadSpans& spans, int index) const;
+
+    /** Returns the timestamp of the first sample in a ReadSpans view, or of the
+        last written sample if the view is empty. Samples after the first one have
+        consecutive timestamps, except where the source skipped some.*/
+    int64 getFirstTimestamp (const ReadSpans& spans) const;
+
+    /** Releases the samples of a ReadSpans view back to the writer.*/
+    void finishedRead (const ReadSpans& spans);
+
+    /** Samples the buffer can hold for each timestamp run or event code change it can keep */
+    static const int samplesPerMarkSlot = 4;
+
+    /** Returns the overflow counters and current fill of the buffer.*/
+    BufferStats getStats() const;
+
+    /** Returns the bytes taken by the samples and the timestamp and event code rings.*/
+    size_t getMemorySize() const;
+
     /** Resizes the data buffer */
     void resize (int chans, int size);
 
 
 private:
+    /** A sample number, counting from the last clear(), and the timestamp or event code
+        that starts there */
+    struct Mark
+    {
+        int64 sample;
+        int64 value;
+    };
+
+    /** Called by the writer for each sample of a write with its timestamp, before
+        the write is published. Only stores the timestamps that don't follow the previous one.*/
+    void addTimestamps (const int64* timestamps, int offset, int numItems);
+    void addTimestampRun (int64 sample, int64 timestamp);
+    void addEventCodes (const uint64* eventCodes, int offset, int numItems);
+    void addEventChange (int64 sample, uint64 code);
+    /** Returns how many of the first numItems samples of a write have room for their marks */
+    int getNumSamplesWithFreeMarks (const int64* timestamps, const uint64* eventCodes, int numItems) const;
+    void finishWrite (int numRequested, int numItems);
+
+    void reset();
+
     AbstractFifo abstractFifo;
     AudioSampleBuffer buffer;
 
-    HeapBlock<int64> timestampBuffer;
-    HeapBlock<uint64> eventCodeBuffer;
+    // Rings of timestamp runs and event code changes. The writer only reuses the slots of
+    // the marks before readTimestampRun and readEventChange
+    Mark* timestampRuns;
+    Mark* eventChanges;
+    int numMarkSlots;
+
+    LockedMemoryBlock sampleMemory;
+    LockedMemoryBlock timestampRunMemory;
+    LockedMemoryBlock eventChangeMemory;
+
+    // written by the writer only
+    int64 writtenSamples;
+    int64 nextTimestamp;
+    uint64 lastWrittenCode;
+    std::atomic<int64> numTimestampRuns;
+    std::atomic<int64> numEventChanges;
+
+    // written by the reader only. readTimestampRun is the run covering readSamples
+    int64 readSamples;
+    std::atomic<int64> readTimestampRun;
+    std::atomic<int64> readEventChange;
+    uint64 lastReadCode;
+
+    BufferStatsMonitor stats;
 
-	int64 lastTimestamp;
+	std::atomic<int64> lastTimestamp;
 
     int numChans;
 
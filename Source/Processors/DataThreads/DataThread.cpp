@@ -22,13 +22,21 @@
 
 #include "DataThread.h"
 #include "../SourceNode/SourceNode.h"
+#include "../GenericProcessor/TraceRecorder.h"
+#include <atomic>
 
+namespace
+{
+    WaitableEvent newDataEvent;
+    std::atomic<int64> firstNotificationTicks(0);
+    std::atomic<int> numDataDrivenSources(0);
+}
 
 DataThread::DataThread (SourceNode* s)
     : Thread     ("Data Thread")
+    , drivesProcessing (false)
 {
     sn = s;
-    setPriority (10);
 
 	int nSub = getNumSubProcessors();
 	for (int i = 0; i < nSub; i++)
@@ -41,14 +49,22 @@ DataThread::DataThread (SourceNode* s)
 
 DataThread::~DataThread()
 {
+    setDrivesProcessing (false);
     //deleteAndZero(dataBuffer);
 }
 
 
 void DataThread::run()
 {
+    ThreadPolicy::applyToCurrentThread (ThreadPolicy::Acquisition);
+    loadMonitor.reset();
+    const char* traceName = TraceRecorder::getPooledName (sn->getName() + " updateBuffer");
+
     while (! threadShouldExit())
     {
+        TraceRecorder::Scope trace (traceName);
+        const int64 loopStart = Time::getHighResolutionTicks();
+
         if (! updateBuffer())
         {
             const MessageManagerLock mmLock (Thread::getCurrentThread());
@@ -58,10 +74,51 @@ void DataThread::run()
             std::cout << "Notifying source node to stop acqusition." << std::endl;
             sn->acquisitionStopped();
         }
+
+        loadMonitor.loopFinished (loopStart);
     }
 }
 
 
+ThreadLoadMonitor::Counters DataThread::getLoadCounters() const
+{
+    return loadMonitor.getCounters();
+}
+
+
+void DataThread::notifyNewData()
+{
+    int64 none = 0;
+    firstNotificationTicks.compare_exchange_strong (none, Time::getHighResolutionTicks());
+    newDataEvent.signal();
+}
+
+
+int64 DataThread::waitForNewData (int timeoutMs)
+{
+    if (! newDataEvent.wait (timeoutMs))
+        return 0;
+
+    return firstNotificationTicks.exchange (0);
+}
+
+
+int DataThread::getNumDataDrivenSources()
+{
+    return numDataDrivenSources;
+}
+
+
+void DataThread::setDrivesProcessing (bool shouldDrive)
+{
+    if (shouldDrive == drivesProcessing)
+        return;
+
+    drivesProcessing = shouldDrive;
+    numDataDrivenSources += shouldDrive ? 1 : -1;
+}
+
+
 DataBuffer* DataThread::getBufferAddress(int subProcessor) const
 {
 
@@ -69,6 +126,22 @@ DataBuffer* DataThread::getBufferAddress(int subProcessor) const
 }
 
 
+BufferStats DataThread::getBufferStats(int subProcessor) const
+{
+	if (DataBuffer* buffer = sourceBuffers[subProcessor])
+		return buffer->getStats();
+
+	return BufferStats();
+}
+
+
+void DataThread::getMemoryUsage(MemoryUsage& usage) const
+{
+	for (int i = 0; i < sourceBuffers.size(); i++)
+		usage.add(sourceBuffers.size() > 1 ? "Buffer " + String(i) : "Buffer", sourceBuffers[i]->getMemorySize());
+}
+
+
 void DataThread::getChannelInfo (Array<ChannelCustomInfo>& infoArray) const
 {
     infoArray.clear();
@@ -144,4 +217,9 @@ void DataThread::resizeBuffers()
 String DataThread::getChannelUnits(int chanIndex) const
 {
 	return String::empty;
+}
+
+float DataThread::getHardwareHighPass(int chanIndex) const
+{
+	return 0;
 }
\ No newline at end of file
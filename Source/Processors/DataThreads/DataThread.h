@@ -27,6 +27,8 @@
 #include <stdio.h>
 #include "DataBuffer.h"
 #include "../GenericProcessor/GenericProcessor.h"
+#include "../GenericProcessor/ThreadLoadMonitor.h"
+#include "../GenericProcessor/ThreadPolicy.h"
 
 class SourceNode;
 
@@ -68,6 +70,17 @@ public:
     /** Returns the address of the DataBuffer that the input source will fill.*/
     DataBuffer* getBufferAddress(int subProcessor) const;
 
+	/** Returns the overflow counters and fill level of the DataBuffer of a subprocessor.*/
+	BufferStats getBufferStats(int subProcessor) const;
+
+	/** Returns the updateBuffer() loop count and CPU time of the thread, see ThreadLoadMonitor.*/
+	ThreadLoadMonitor::Counters getLoadCounters() const;
+
+	/** Adds the bytes held by the DataBuffers and the major buffers of the thread. Threads
+	with large buffers of their own, such as a device's transfer buffers, override this,
+	calling the base class too. Called from the message thread.*/
+	virtual void getMemoryUsage(MemoryUsage& usage) const;
+
 	/** Called when the chain updates, to add, remove or resize the sourceBuffers' DataBuffers as needed*/
 	virtual void resizeBuffers();
 
@@ -139,9 +152,29 @@ public:
 
 	virtual String getChannelUnits(int chanIndex) const;
 
+	/** Returns the cutoff in Hz of a high-pass filter the hardware already applies to a channel,
+	or 0 if there is none. Passed downstream with the channel, see DataChannel::getHardwareHighPass().*/
+	virtual float getHardwareHighPass(int chanIndex) const;
+
+	/** Wakes up the processing callbacks when they are driven by incoming data (see
+	setDrivesProcessing()). Call right after new samples were written to the DataBuffer.*/
+	static void notifyNewData();
+
+	/** Waits until a data thread calls notifyNewData() or timeoutMs elapse. Returns the
+	high resolution tick count of the first notification since the previous call, or 0 on timeout.*/
+	static int64 waitForNewData(int timeoutMs);
+
+	/** Returns the number of data threads that asked to drive the processing callbacks.*/
+	static int getNumDataDrivenSources();
+
 protected:
     virtual void setDefaultChannelNames();
 
+	/** Asks for the processing callbacks to run as soon as this thread calls notifyNewData()
+	instead of once per audio buffer, for closed-loop experiments. Must be set before the
+	callbacks begin, usually in startAcquisition().*/
+	void setDrivesProcessing(bool shouldDrive);
+
     SourceNode* sn;
 
     Array<uint64> ttlEventWords;
@@ -152,6 +185,8 @@ protected:
 
 private:
     Time timer;
+	bool drivesProcessing;
+	ThreadLoadMonitor loadMonitor;
 
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DataThread);
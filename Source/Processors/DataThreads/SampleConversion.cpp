@@ -0,0 +1,383 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2016 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SampleConversion.h"
+
+#if defined(__AVX2__)
+ #include <immintrin.h>
+ #define OE_CONVERSION_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define OE_CONVERSION_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+ #include <arm_neon.h>
+ #define OE_CONVERSION_NEON 1
+#endif
+
+
+void SampleConversion::convertUInt16ToFloat (float* dest, const uint16* src, int numValues, float offset, float scale)
+{
+    int i = 0;
+
+#if OE_CONVERSION_AVX2
+    const __m256 off = _mm256_set1_ps (offset);
+    const __m256 sc = _mm256_set1_ps (scale);
+
+    for (; i + 8 <= numValues; i += 8)
+    {
+        __m128i words = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (src + i));
+        __m256 f = _mm256_cvtepi32_ps (_mm256_cvtepu16_epi32 (words));
+        _mm256_storeu_ps (dest + i, _mm256_mul_ps (_mm256_sub_ps (f, off), sc));
+    }
+#elif OE_CONVERSION_SSE2
+    const __m128 off = _mm_set1_ps (offset);
+    const __m128 sc = _mm_set1_ps (scale);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 8 <= numValues; i += 8)
+    {
+        __m128i words = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (src + i));
+        __m128 lo = _mm_cvtepi32_ps (_mm_unpacklo_epi16 (words, zero));
+        __m128 hi = _mm_cvtepi32_ps (_mm_unpackhi_epi16 (words, zero));
+        _mm_storeu_ps (dest + i, _mm_mul_ps (_mm_sub_ps (lo, off), sc));
+        _mm_storeu_ps (dest + i + 4, _mm_mul_ps (_mm_sub_ps (hi, off), sc));
+    }
+#elif OE_CONVERSION_NEON
+    const float32x4_t off = vdupq_n_f32 (offset);
+    const float32x4_t sc = vdupq_n_f32 (scale);
+
+    for (; i + 8 <= numValues; i += 8)
+    {
+        uint16x8_t words = vld1q_u16 (src + i);
+        float32x4_t lo = vcvtq_f32_u32 (vmovl_u16 (vget_low_u16 (words)));
+        float32x4_t hi = vcvtq_f32_u32 (vmovl_u16 (vget_high_u16 (words)));
+        vst1q_f32 (dest + i, vmulq_f32 (vsubq_f32 (lo, off), sc));
+        vst1q_f32 (dest + i + 4, vmulq_f32 (vsubq_f32 (hi, off), sc));
+    }
+#endif
+
+    for (; i < numValues; ++i)
+        dest[i] = (float (src[i]) - offset) * scale;
+}
+
+
+void SampleConversion::convertFloatToInt16 (int16* dest, int destStride, const float* src, int numValues, float scale)
+{
+    int i = 0;
+
+#if OE_CONVERSION_AVX2 || OE_CONVERSION_SSE2
+    const __m128 sc = _mm_set1_ps (scale);
+    const __m128 maxVal = _mm_set1_ps (32767.0f);
+    const __m128 minVal = _mm_set1_ps (-32767.0f);
+    int16 packed[8];
+
+    for (; i + 8 <= numValues; i += 8)
+    {
+        __m128 lo = _mm_min_ps (_mm_max_ps (_mm_mul_ps (_mm_loadu_ps (src + i), sc), minVal), maxVal);
+        __m128 hi = _mm_min_ps (_mm_max_ps (_mm_mul_ps (_mm_loadu_ps (src + i + 4), sc), minVal), maxVal);
+        __m128i words = _mm_packs_epi32 (_mm_cvtps_epi32 (lo), _mm_cvtps_epi32 (hi));
+
+        if (destStride == 1)
+        {
+            _mm_storeu_si128 (reinterpret_cast<__m128i*> (dest + i), words);
+        }
+        else
+        {
+            _mm_storeu_si128 (reinterpret_cast<__m128i*> (packed), words);
+            int16* d = dest + i * destStride;
+            for (int j = 0; j < 8; ++j)
+                d[j * destStride] = packed[j];
+        }
+    }
+#elif OE_CONVERSION_NEON && defined(__aarch64__)
+    const float32x4_t sc = vdupq_n_f32 (scale);
+    const float32x4_t maxVal = vdupq_n_f32 (32767.0f);
+    const float32x4_t minVal = vdupq_n_f32 (-32767.0f);
+    int16 packed[8];
+
+    for (; i + 8 <= numValues; i += 8)
+    {
+        float32x4_t lo = vminq_f32 (vmaxq_f32 (vmulq_f32 (vld1q_f32 (src + i), sc), minVal), maxVal);
+        float32x4_t hi = vminq_f32 (vmaxq_f32 (vmulq_f32 (vld1q_f32 (src + i + 4), sc), minVal), maxVal);
+        int16x8_t words = vcombine_s16 (vqmovn_s32 (vcvtnq_s32_f32 (lo)), vqmovn_s32 (vcvtnq_s32_f32 (hi)));
+
+        if (destStride == 1)
+        {
+            vst1q_s16 (dest + i, words);
+        }
+        else
+        {
+            vst1q_s16 (packed, words);
+            int16* d = dest + i * destStride;
+            for (int j = 0; j < 8; ++j)
+                d[j * destStride] = packed[j];
+        }
+    }
+#endif
+
+    for (; i < numValues; ++i)
+        dest[i * destStride] = (int16) roundToInt (jlimit (-32767.0f, 32767.0f, src[i] * scale));
+}
+
+void SampleConversion::convertFloatToInt16BE (int16* dest, const float* src, int numValues, float scale)
+{
+    int i = 0;
+
+#if OE_CONVERSION_AVX2 || OE_CONVERSION_SSE2
+    const __m128 sc = _mm_set1_ps (scale);
+    const __m128 maxVal = _mm_set1_ps (32767.0f);
+    const __m128 minVal = _mm_set1_ps (-32767.0f);
+
+    for (; i + 8 <= numValues; i += 8)
+    {
+        __m128 lo = _mm_min_ps (_mm_max_ps (_mm_mul_ps (_mm_loadu_ps (src + i), sc), minVal), maxVal);
+        __m128 hi = _mm_min_ps (_mm_max_ps (_mm_mul_ps (_mm_loadu_ps (src + i + 4), sc), minVal), maxVal);
+        __m128i words = _mm_packs_epi32 (_mm_cvtps_epi32 (lo), _mm_cvtps_epi32 (hi));
+        words = _mm_or_si128 (_mm_slli_epi16 (words, 8), _mm_srli_epi16 (words, 8));
+        _mm_storeu_si128 (reinterpret_cast<__m128i*> (dest + i), words);
+    }
+#elif OE_CONVERSION_NEON && defined(__aarch64__)
+    const float32x4_t sc = vdupq_n_f32 (scale);
+    const float32x4_t maxVal = vdupq_n_f32 (32767.0f);
+    const float32x4_t minVal = vdupq_n_f32 (-32767.0f);
+
+    for (; i + 8 <= numValues; i += 8)
+    {
+        float32x4_t lo = vminq_f32 (vmaxq_f32 (vmulq_f32 (vld1q_f32 (src + i), sc), minVal), maxVal);
+        float32x4_t hi = vminq_f32 (vmaxq_f32 (vmulq_f32 (vld1q_f32 (src + i + 4), sc), minVal), maxVal);
+        int16x8_t words = vcombine_s16 (vqmovn_s32 (vcvtnq_s32_f32 (lo)), vqmovn_s32 (vcvtnq_s32_f32 (hi)));
+        vst1q_s16 (dest + i, vreinterpretq_s16_u8 (vrev16q_u8 (vreinterpretq_u8_s16 (words))));
+    }
+#endif
+
+    for (; i < numValues; ++i)
+        dest[i] = (int16) ByteOrder::swapIfLittleEndian ((uint16) roundToInt (jlimit (-32767.0f, 32767.0f, src[i] * scale)));
+}
+
+void SampleConversion::gather (float* dest, const float* src, int srcStride, int numValues)
+{
+    if (srcStride == 1)
+    {
+        memcpy (dest, src, numValues * sizeof (float));
+        return;
+    }
+
+    for (int i = 0; i < numValues; ++i)
+        dest[i] = src[i * srcStride];
+}
+
+void SampleConversion::transposeUInt16ToFloat (float* dest, const uint16* src, int srcStride, int numRows, int numColumns, float offset, float scale)
+{
+    int r = 0;
+
+#if OE_CONVERSION_AVX2 || OE_CONVERSION_SSE2
+    const __m128 off = _mm_set1_ps (offset);
+    const __m128 sc = _mm_set1_ps (scale);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; r + 4 <= numRows; r += 4)
+    {
+        int c = 0;
+        for (; c + 4 <= numColumns; c += 4)
+        {
+            // 4x4 transpose of the converted words: rows are words in, columns out
+            const uint16* s = src + r * srcStride + c;
+            __m128 row0 = _mm_cvtepi32_ps (_mm_unpacklo_epi16 (_mm_loadl_epi64 (reinterpret_cast<const __m128i*> (s)), zero));
+            __m128 row1 = _mm_cvtepi32_ps (_mm_unpacklo_epi16 (_mm_loadl_epi64 (reinterpret_cast<const __m128i*> (s + srcStride)), zero));
+            __m128 row2 = _mm_cvtepi32_ps (_mm_unpacklo_epi16 (_mm_loadl_epi64 (reinterpret_cast<const __m128i*> (s + 2 * srcStride)), zero));
+            __m128 row3 = _mm_cvtepi32_ps (_mm_unpacklo_epi16 (_mm_loadl_epi64 (reinterpret_cast<const __m128i*> (s + 3 * srcStride)), zero));
+
+            _MM_TRANSPOSE4_PS (row0, row1, row2, row3);
+
+            float* d = dest + c * numRows + r;
+            _mm_storeu_ps (d, _mm_mul_ps (_mm_sub_ps (row0, off), sc));
+            _mm_storeu_ps (d + numRows, _mm_mul_ps (_mm_sub_ps (row1, off), sc));
+            _mm_storeu_ps (d + 2 * numRows, _mm_mul_ps (_mm_sub_ps (row2, off), sc));
+            _mm_storeu_ps (d + 3 * numRows, _mm_mul_ps (_mm_sub_ps (row3, off), sc));
+        }
+        for (; c < numColumns; ++c)
+        {
+            for (int j = r; j < r + 4; ++j)
+                dest[c * numRows + j] = (float (src[j * srcStride + c]) - offset) * scale;
+        }
+    }
+#elif OE_CONVERSION_NEON
+    const float32x4_t off = vdupq_n_f32 (offset);
+    const float32x4_t sc = vdupq_n_f32 (scale);
+
+    for (; r + 4 <= numRows; r += 4)
+    {
+        int c = 0;
+        for (; c + 4 <= numColumns; c += 4)
+        {
+            // 4x4 transpose of the converted words: rows are words in, columns out
+            const uint16* s = src + r * srcStride + c;
+            float32x4x2_t t01 = vtrnq_f32 (vcvtq_f32_u32 (vmovl_u16 (vld1_u16 (s))),
+                                           vcvtq_f32_u32 (vmovl_u16 (vld1_u16 (s + srcStride))));
+            float32x4x2_t t23 = vtrnq_f32 (vcvtq_f32_u32 (vmovl_u16 (vld1_u16 (s + 2 * srcStride))),
+                                           vcvtq_f32_u32 (vmovl_u16 (vld1_u16 (s + 3 * srcStride))));
+
+            float* d = dest + c * numRows + r;
+            vst1q_f32 (d, vmulq_f32 (vsubq_f32 (vcombine_f32 (vget_low_f32 (t01.val[0]), vget_low_f32 (t23.val[0])), off), sc));
+            vst1q_f32 (d + numRows, vmulq_f32 (vsubq_f32 (vcombine_f32 (vget_low_f32 (t01.val[1]), vget_low_f32 (t23.val[1])), off), sc));
+            vst1q_f32 (d + 2 * numRows, vmulq_f32 (vsubq_f32 (vcombine_f32 (vget_high_f32 (t01.val[0]), vget_high_f32 (t23.val[0])), off), sc));
+            vst1q_f32 (d + 3 * numRows, vmulq_f32 (vsubq_f32 (vcombine_f32 (vget_high_f32 (t01.val[1]), vget_high_f32 (t23.val[1])), off), sc));
+        }
+        for (; c < numColumns; ++c)
+        {
+            for (int j = r; j < r + 4; ++j)
+                dest[c * numRows + j] = (float (src[j * srcStride + c]) - offset) * scale;
+        }
+    }
+#endif
+
+    for (; r < numRows; ++r)
+    {
+        for (int c = 0; c < numColumns; ++c)
+            dest[c * numRows + r] = (float (src[r * srcStride + c]) - offset) * scale;
+    }
+}
+
+void SampleConversion::deinterleaveInt16ToFloat (float* const* dest, const int16* src, int numChannels, int numSamples, const float* scales)
+{
+    // 64 samples of a few hundred channels is well within L2, so the rows brought in for the
+    // first group of channels are still cached when the following groups are transposed
+    const int tileSamples = 64;
+
+    for (int tileStart = 0; tileStart < numSamples; tileStart += tileSamples)
+    {
+        const int tileEnd = jmin (numSamples, tileStart + tileSamples);
+        int c = 0;
+
+#if OE_CONVERSION_AVX2 || OE_CONVERSION_SSE2
+        for (; c + 8 <= numChannels; c += 8)
+        {
+            int i = tileStart;
+            for (; i + 8 <= tileEnd; i += 8)
+            {
+                // 8x8 transpose of 16-bit words: rows are samples in, channels out
+                const int16* s = src + i * numChannels + c;
+                __m128i a0 = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (s));
+                __m128i a1 = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (s + numChannels));
+                __m128i a2 = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (s + 2 * numChannels));
+                __m128i a3 = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (s + 3 * numChannels));
+                __m128i a4 = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (s + 4 * numChannels));
+                __m128i a5 = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (s + 5 * numChannels));
+                __m128i a6 = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (s + 6 * numChannels));
+                __m128i a7 = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (s + 7 * numChannels));
+
+                __m128i t0 = _mm_unpacklo_epi16 (a0, a1);
+                __m128i t1 = _mm_unpackhi_epi16 (a0, a1);
+                __m128i t2 = _mm_unpacklo_epi16 (a2, a3);
+                __m128i t3 = _mm_unpackhi_epi16 (a2, a3);
+                __m128i t4 = _mm_unpacklo_epi16 (a4, a5);
+                __m128i t5 = _mm_unpackhi_epi16 (a4, a5);
+                __m128i t6 = _mm_unpacklo_epi16 (a6, a7);
+                __m128i t7 = _mm_unpackhi_epi16 (a6, a7);
+
+                __m128i u0 = _mm_unpacklo_epi32 (t0, t2);
+                __m128i u1 = _mm_unpackhi_epi32 (t0, t2);
+                __m128i u2 = _mm_unpacklo_epi32 (t1, t3);
+                __m128i u3 = _mm_unpackhi_epi32 (t1, t3);
+                __m128i u4 = _mm_unpacklo_epi32 (t4, t6);
+                __m128i u5 = _mm_unpackhi_epi32 (t4, t6);
+                __m128i u6 = _mm_unpacklo_epi32 (t5, t7);
+                __m128i u7 = _mm_unpackhi_epi32 (t5, t7);
+
+                __m128i rows[8];
+                rows[0] = _mm_unpacklo_epi64 (u0, u4);
+                rows[1] = _mm_unpackhi_epi64 (u0, u4);
+                rows[2] = _mm_unpacklo_epi64 (u1, u5);
+                rows[3] = _mm_unpackhi_epi64 (u1, u5);
+                rows[4] = _mm_unpacklo_epi64 (u2, u6);
+                rows[5] = _mm_unpackhi_epi64 (u2, u6);
+                rows[6] = _mm_unpacklo_epi64 (u3, u7);
+                rows[7] = _mm_unpackhi_epi64 (u3, u7);
+
+                for (int j = 0; j < 8; ++j)
+                {
+                    const __m128 sc = _mm_set1_ps (scales[c + j]);
+                    // sign extend by placing each word in the upper half and shifting back down
+                    __m128 lo = _mm_cvtepi32_ps (_mm_srai_epi32 (_mm_unpacklo_epi16 (rows[j], rows[j]), 16));
+                    __m128 hi = _mm_cvtepi32_ps (_mm_srai_epi32 (_mm_unpackhi_epi16 (rows[j], rows[j]), 16));
+                    _mm_storeu_ps (dest[c + j] + i, _mm_mul_ps (lo, sc));
+                    _mm_storeu_ps (dest[c + j] + i + 4, _mm_mul_ps (hi, sc));
+                }
+            }
+            for (; i < tileEnd; ++i)
+            {
+                for (int j = 0; j < 8; ++j)
+                    dest[c + j][i] = float (src[i * numChannels + c + j]) * scales[c + j];
+            }
+        }
+#elif OE_CONVERSION_NEON && defined(__aarch64__)
+        for (; c + 8 <= numChannels; c += 8)
+        {
+            int i = tileStart;
+            for (; i + 8 <= tileEnd; i += 8)
+            {
+                // 8x8 transpose of 16-bit words: rows are samples in, channels out
+                const int16* s = src + i * numChannels + c;
+                int16x8x2_t t01 = vtrnq_s16 (vld1q_s16 (s), vld1q_s16 (s + numChannels));
+                int16x8x2_t t23 = vtrnq_s16 (vld1q_s16 (s + 2 * numChannels), vld1q_s16 (s + 3 * numChannels));
+                int16x8x2_t t45 = vtrnq_s16 (vld1q_s16 (s + 4 * numChannels), vld1q_s16 (s + 5 * numChannels));
+                int16x8x2_t t67 = vtrnq_s16 (vld1q_s16 (s + 6 * numChannels), vld1q_s16 (s + 7 * numChannels));
+
+                int32x4x2_t u02 = vtrnq_s32 (vreinterpretq_s32_s16 (t01.val[0]), vreinterpretq_s32_s16 (t23.val[0]));
+                int32x4x2_t u13 = vtrnq_s32 (vreinterpretq_s32_s16 (t01.val[1]), vreinterpretq_s32_s16 (t23.val[1]));
+                int32x4x2_t u46 = vtrnq_s32 (vreinterpretq_s32_s16 (t45.val[0]), vreinterpretq_s32_s16 (t67.val[0]));
+                int32x4x2_t u57 = vtrnq_s32 (vreinterpretq_s32_s16 (t45.val[1]), vreinterpretq_s32_s16 (t67.val[1]));
+
+                int16x8_t rows[8];
+                rows[0] = vreinterpretq_s16_s32 (vcombine_s32 (vget_low_s32 (u02.val[0]), vget_low_s32 (u46.val[0])));
+                rows[1] = vreinterpretq_s16_s32 (vcombine_s32 (vget_low_s32 (u13.val[0]), vget_low_s32 (u57.val[0])));
+                rows[2] = vreinterpretq_s16_s32 (vcombine_s32 (vget_low_s32 (u02.val[1]), vget_low_s32 (u46.val[1])));
+                rows[3] = vreinterpretq_s16_s32 (vcombine_s32 (vget_low_s32 (u13.val[1]), vget_low_s32 (u57.val[1])));
+                rows[4] = vreinterpretq_s16_s32 (vcombine_s32 (vget_high_s32 (u02.val[0]), vget_high_s32 (u46.val[0])));
+                rows[5] = vreinterpretq_s16_s32 (vcombine_s32 (vget_high_s32 (u13.val[0]), vget_high_s32 (u57.val[0])));
+                rows[6] = vreinterpretq_s16_s32 (vcombine_s32 (vget_high_s32 (u02.val[1]), vget_high_s32 (u46.val[1])));
+                rows[7] = vreinterpretq_s16_s32 (vcombine_s32 (vget_high_s32 (u13.val[1]), vget_high_s32 (u57.val[1])));
+
+                for (int j = 0; j < 8; ++j)
+                {
+                    const float32x4_t sc = vdupq_n_f32 (scales[c + j]);
+                    vst1q_f32 (dest[c + j] + i, vmulq_f32 (vcvtq_f32_s32 (vmovl_s16 (vget_low_s16 (rows[j]))), sc));
+                    vst1q_f32 (dest[c + j] + i + 4, vmulq_f32 (vcvtq_f32_s32 (vmovl_s16 (vget_high_s16 (rows[j]))), sc));
+                }
+            }
+            for (; i < tileEnd; ++i)
+            {
+                for (int j = 0; j < 8; ++j)
+                    dest[c + j][i] = float (src[i * numChannels + c + j]) * scales[c + j];
+            }
+        }
+#endif
+
+        for (; c < numChannels; ++c)
+        {
+            float* d = dest[c];
+            const float scale = scales[c];
+            for (int i = tileStart; i < tileEnd; ++i)
+                d[i] = float (src[i * numChannels + c]) * scale;
+        }
+    }
+}
@@ -0,0 +1,70 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2016 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SAMPLECONVERSION_H_INCLUDED
+#define SAMPLECONVERSION_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../PluginManager/OpenEphysPlugin.h"
+
+/**
+    Conversion kernels between raw integer samples and floats, for data coming from
+    acquisition hardware and data written to disk.
+
+    Uses SSE2, AVX2 or NEON when available at compile time, with a scalar fallback.
+
+    @see DataThread, DataBuffer
+*/
+class PLUGIN_API SampleConversion
+{
+public:
+    /** Converts unsigned 16-bit words to floats as (src[i] - offset) * scale.
+        src does not need to be aligned.*/
+    static void convertUInt16ToFloat (float* dest, const uint16* src, int numValues, float offset, float scale);
+
+    /** Converts floats to signed 16-bit integers as round(src[i] * scale), saturated to +-32767.
+        Results are stored destStride values apart, so they can be written straight into interleaved blocks.*/
+    static void convertFloatToInt16 (int16* dest, int destStride, const float* src, int numValues, float scale);
+
+    /** Same as convertFloatToInt16, with big-endian results stored contiguously.*/
+    static void convertFloatToInt16BE (int16* dest, const float* src, int numValues, float scale);
+
+    /** Gathers numValues floats spaced srcStride apart into a contiguous run.*/
+    static void gather (float* dest, const float* src, int srcStride, int numValues);
+
+    /** Converts a numRows x numColumns matrix of unsigned 16-bit words, whose rows start srcStride
+        words apart, to floats as (src - offset) * scale and transposes it, so that
+        dest[c * numRows + r] = (src[r * srcStride + c] - offset) * scale.
+        Used to split words interleaved by stream into one contiguous run per stream.*/
+    static void transposeUInt16ToFloat (float* dest, const uint16* src, int srcStride, int numRows, int numColumns, float offset, float scale);
+
+    /** Splits a block of interleaved signed 16-bit samples (numChannels per sample) into one
+        float buffer per channel, as dest[c][i] = src[i * numChannels + c] * scales[c].
+        The block is transposed in tiles small enough to stay in cache.*/
+    static void deinterleaveInt16ToFloat (float* const* dest, const int16* src, int numChannels, int numSamples, const float* scales);
+
+private:
+    SampleConversion() = delete;
+};
+
+
+#endif  // SAMPLECONVERSION_H_INCLUDED
@@ -100,11 +100,15 @@ public:
     template <class StateType, typename Sample>
     void process(int numSamples, Sample* dest, StateType& state) const
     {
-        while (--numSamples >= 0)
-        {
-            *dest = state.process(*dest, *this);
-            dest++;
-        }
+        state.template processBlock<double>(numSamples, dest, *this);
+    }
+
+    // Process a block of samples in the given form, with the arithmetic in
+    // single precision. Only suitable for cutoffs well away from zero and Nyquist.
+    template <class StateType, typename Sample>
+    void processFloat(int numSamples, Sample* dest, StateType& state) const
+    {
+        state.template processBlock<float>(numSamples, dest, *this);
     }
 
 protected:
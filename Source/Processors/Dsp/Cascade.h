@@ -74,6 +74,29 @@ public:
             return static_cast<Sample>(out);
         }
 
+        // Runs the block through one stage at a time, in tiles that keep the
+        // samples in the Accumulator type between stages
+        template <typename Accumulator, typename Sample>
+        void processBlock(int numSamples, Sample* dest, const Cascade& c)
+        {
+            enum { TileSamples = 64 };
+            Accumulator tile[TileSamples];
+
+            for (int start = 0; start < numSamples; start += TileSamples)
+            {
+                const int n = std::min(int(TileSamples), numSamples - start);
+
+                for (int i = 0; i < n; ++i)
+                    tile[i] = Accumulator(dest[start + i]);
+
+                for (int s = 0; s < c.m_numStages; ++s)
+                    m_stateArray[s].template processBlock<Accumulator>(n, tile, c.m_stageArray[s]);
+
+                for (int i = 0; i < n; ++i)
+                    dest[start + i] = static_cast<Sample>(tile[i]);
+            }
+        }
+
     protected:
         StateBase(StateType* stateArray)
             : m_stateArray(stateArray)
@@ -121,11 +144,15 @@ public:
     template <class StateType, typename Sample>
     void process(int numSamples, Sample* dest, StateType& state) const
     {
-        while (--numSamples >= 0)
-        {
-            *dest = state.process(*dest, *this);
-            dest++;
-        }
+        state.template processBlock<double>(numSamples, dest, *this);
+    }
+
+    // Process a block of samples in the given form, with the arithmetic in
+    // single precision. Only suitable for cutoffs well away from zero and Nyquist.
+    template <class StateType, typename Sample>
+    void processFloat(int numSamples, Sample* dest, StateType& state) const
+    {
+        state.template processBlock<float>(numSamples, dest, *this);
     }
 
 protected:
@@ -159,6 +186,19 @@ public:
             reset();
         }
 
+        // copies keep pointing at their own states
+        State(const State& other) : Cascade::StateBase <StateType> (m_states)
+        {
+            Cascade::StateBase <StateType>::m_stateArray = m_states;
+            std::copy(other.m_states, other.m_states + MaxStages, m_states);
+        }
+
+        State& operator=(const State& other)
+        {
+            std::copy(other.m_states, other.m_states + MaxStages, m_states);
+            return *this;
+        }
+
         void reset()
         {
             StateType* state = m_states;
@@ -45,8 +45,15 @@ THE SOFTWARE.
 #include "Biquad.h"
 #include "Cascade.h"
 #include "Filter.h"
+#include "FirDesign.h"
+#include "HalfBandDecimator.h"
+#include "MultiChannelCascade.h"
+#include "NoiseLevelEstimator.h"
+#include "OverlapSaveConvolver.h"
+#include "PolyphaseResampler.h"
 #include "PoleFilter.h"
 #include "SmoothedFilter.h"
+#include "Spectrum.h"
 #include "State.h"
 #include "Utilities.h"
 
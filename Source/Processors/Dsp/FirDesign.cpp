@@ -0,0 +1,130 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "Common.h"
+#include "FirDesign.h"
+#include "MathSupplement.h"
+
+namespace Dsp {
+
+namespace FirDesign {
+
+double besselI0(double x)
+{
+    // power series, which converges quickly for the betas used in filter design
+    const double q = x * x / 4;
+    double sum = 1.;
+    double term = 1.;
+
+    for (int k = 1; k < 100; ++k)
+    {
+        term *= q / (double(k) * k);
+        sum += term;
+        if (term < sum * 1e-16)
+            break;
+    }
+
+    return sum;
+}
+
+std::vector<double> kaiserWindow(int numTaps, double beta)
+{
+    std::vector<double> window(numTaps, 1.);
+    if (numTaps < 2)
+        return window;
+
+    const double half = (numTaps - 1) / 2.;
+    const double scale = 1. / besselI0(beta);
+
+    for (int n = 0; n < numTaps; ++n)
+    {
+        const double r = (n - half) / half;
+        window[n] = besselI0(beta * std::sqrt(std::max(0., 1. - r * r))) * scale;
+    }
+
+    return window;
+}
+
+static double sinc(double x)
+{
+    if (x == 0)
+        return 1.;
+    return std::sin(doublePi * x) / (doublePi * x);
+}
+
+std::vector<double> bandPass(double sampleRate,
+                             double lowCut,
+                             double highCut,
+                             int numTaps,
+                             double kaiserBeta)
+{
+    numTaps = std::max(1, numTaps) | 1;
+
+    // cutoffs in cycles per sample
+    const double f1 = std::max(0., lowCut / sampleRate);
+    const double f2 = std::min(0.5, highCut / sampleRate);
+
+    std::vector<double> taps = kaiserWindow(numTaps, kaiserBeta);
+    const int mid = numTaps / 2;
+
+    for (int n = 0; n < numTaps; ++n)
+    {
+        const double k = n - mid;
+        taps[n] *= 2 * f2 * sinc(2 * f2 * k) - 2 * f1 * sinc(2 * f1 * k);
+    }
+
+    // normalise the gain at the centre of the pass band
+    const double w = doublePi * (f1 + f2);
+    std::complex<double> gain(0., 0.);
+    for (int n = 0; n < numTaps; ++n)
+        gain += taps[n] * std::polar(1., -w * n);
+
+    const double magnitude = std::abs(gain);
+    if (magnitude > 0)
+        for (int n = 0; n < numTaps; ++n)
+            taps[n] /= magnitude;
+
+    return taps;
+}
+
+std::vector<double> hilbert(int numTaps, double kaiserBeta)
+{
+    numTaps = std::max(3, numTaps);
+    numTaps += (7 - numTaps % 4) % 4;
+
+    std::vector<double> taps = kaiserWindow(numTaps, kaiserBeta);
+    const int mid = numTaps / 2;
+
+    // the ideal response is 2 / (pi * k) for odd k and zero for even k
+    for (int n = 0; n < numTaps; ++n)
+    {
+        const int k = n - mid;
+        taps[n] *= (k % 2 != 0) ? 2. / (doublePi * k) : 0.;
+    }
+
+    return taps;
+}
+
+}
+
+}
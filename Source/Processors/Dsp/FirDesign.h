@@ -0,0 +1,69 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DSPFILTERS_FIRDESIGN_H
+#define DSPFILTERS_FIRDESIGN_H
+
+#include "Common.h"
+
+namespace Dsp
+{
+
+/*
+ * Linear phase FIR filters designed by the window method.
+ *
+ * The ideal band pass response is truncated to numTaps samples and shaped by a Kaiser
+ * window, whose beta trades stopband attenuation against transition width: a beta of 6
+ * gives about 60 dB of attenuation with transitions of roughly 3.6 * sampleRate / numTaps.
+ * The number of taps is always odd, so the filter delays every frequency by exactly
+ * (numTaps - 1) / 2 samples. The cutoffs are where the gain has fallen to half (-6 dB).
+ *
+ */
+namespace FirDesign
+{
+
+// Returns the taps of a band pass filter with unit gain at the centre of the pass band.
+// A low cut of zero gives a low pass filter.
+std::vector<double> PLUGIN_API bandPass(double sampleRate,
+                                        double lowCut,
+                                        double highCut,
+                                        int numTaps,
+                                        double kaiserBeta = 6.);
+
+// Returns the taps of a Hilbert transformer, which shifts the phase of every frequency by
+// a quarter of a cycle. numTaps is rounded up to 4 * n + 3, giving an antisymmetric filter
+// whose taps at even distances from the centre are zero. The gain is close to one from
+// about 2 * sampleRate / numTaps up to the same distance below the Nyquist frequency.
+std::vector<double> PLUGIN_API hilbert(int numTaps, double kaiserBeta = 6.);
+
+// Returns numTaps samples of a Kaiser window
+std::vector<double> PLUGIN_API kaiserWindow(int numTaps, double beta);
+
+// Modified Bessel function of the first kind, order zero
+double PLUGIN_API besselI0(double x);
+
+}
+
+}
+
+#endif
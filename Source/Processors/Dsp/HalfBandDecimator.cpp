@@ -0,0 +1,187 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "Common.h"
+#include "HalfBandDecimator.h"
+#include "FirDesign.h"
+#include "MathSupplement.h"
+
+namespace Dsp {
+
+HalfBandDecimator::HalfBandDecimator()
+    : m_numChannels(0)
+    , m_numStages(0)
+    , m_numTaps(3)
+{
+}
+
+void HalfBandDecimator::setup(int numChannels, int numStages, int numTaps)
+{
+    assert(numChannels >= 0 && numStages >= 0 && numStages < 16);
+
+    m_numChannels = numChannels;
+    m_numStages = numStages;
+
+    // 4 * n + 3 taps put non zero taps at both ends
+    m_numTaps = std::max(3, numTaps);
+    m_numTaps += (7 - m_numTaps % 4) % 4;
+
+    // windowed sinc cutting off at a quarter of the rate: the centre tap is one half
+    // and the taps at even distances from it are zero
+    const int half = m_numTaps / 2;
+    const std::vector<double> window = FirDesign::kaiserWindow(m_numTaps, 8.);
+    std::vector<double> taps;
+    double sum = 0;
+
+    for (int k = 1; k <= half; k += 2)
+    {
+        const double tap = std::sin(doublePi * k / 2) / (doublePi * k) * window[half + k];
+        taps.push_back(tap);
+        sum += 2 * tap;
+    }
+
+    // unit gain at DC
+    m_taps.resize(taps.size());
+    for (size_t j = 0; j < taps.size(); ++j)
+        m_taps[j] = float(taps[j] * 0.5 / sum);
+
+    m_history.assign(size_t(numChannels) * numStages * (m_numTaps - 1), 0.f);
+    m_skip.assign(size_t(numChannels) * numStages, 0);
+    m_work.assign(size_t(numChannels) * (m_numTaps - 1 + WorkSamples), 0.f);
+}
+
+int HalfBandDecimator::getDelay() const
+{
+    // (numTaps - 1) / 2 samples at the input rate of each stage
+    return (m_numTaps - 1) / 2 * (getFactor() - 1);
+}
+
+int HalfBandDecimator::getNumOutputSamples(int channel, int numInputSamples) const
+{
+    int numSamples = numInputSamples;
+
+    for (int s = 0; s < m_numStages; ++s)
+    {
+        const int skip = m_skip[size_t(channel) * m_numStages + s];
+        numSamples = numSamples > skip ? (numSamples - skip + 1) / 2 : 0;
+    }
+
+    return numSamples;
+}
+
+void HalfBandDecimator::reset(juce::uint64 inputPosition)
+{
+    std::fill(m_history.begin(), m_history.end(), 0.f);
+
+    // a stage keeps its inputs at even positions, and the position of the next input of
+    // stage s is the input position divided by 2^s, rounded up
+    const juce::uint64 offset = inputPosition % juce::uint64(getFactor());
+
+    for (int s = 0; s < m_numStages; ++s)
+    {
+        const char skip = char(((offset + (juce::uint64(1) << s) - 1) >> s) & 1);
+        for (int c = 0; c < m_numChannels; ++c)
+            m_skip[size_t(c) * m_numStages + s] = skip;
+    }
+}
+
+int HalfBandDecimator::process(int firstChannel,
+                               int numChannels,
+                               int numInputSamples,
+                               const float* const* input,
+                               float* const* output)
+{
+    int numOutputSamples = numInputSamples;
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        const float* x = input[c];
+        numOutputSamples = numInputSamples;
+
+        if (m_numStages == 0)
+        {
+            if (output[c] != x)
+                std::copy(x, x + numInputSamples, output[c]);
+            continue;
+        }
+
+        // each stage reads its input into its own work buffer first, so every stage can
+        // write to the output
+        for (int s = 0; s < m_numStages; ++s)
+        {
+            numOutputSamples = processStage(firstChannel + c, s, numOutputSamples, x, output[c]);
+            x = output[c];
+        }
+    }
+
+    return numOutputSamples;
+}
+
+int HalfBandDecimator::processStage(int channel, int stage, int numInputSamples, const float* input, float* output)
+{
+    const int historyLength = m_numTaps - 1;
+    const size_t index = size_t(channel) * m_numStages + stage;
+    float* const history = m_history.data() + index * historyLength;
+    float* const work = m_work.data() + size_t(channel) * (historyLength + WorkSamples);
+
+    const int numTaps = int(m_taps.size());
+    const float* const taps = m_taps.data();
+    const float* const centre = work + historyLength / 2;
+
+    int skip = m_skip[index];
+    int n = 0;
+
+    // the outputs written so far never pass the inputs read so far, so the input
+    // can be the output
+    for (int start = 0; start < numInputSamples; start += WorkSamples)
+    {
+        const int count = std::min(int(WorkSamples), numInputSamples - start);
+
+        // history followed by the new input
+        std::copy(history, history + historyLength, work);
+        std::copy(input + start, input + start + count, work + historyLength);
+
+        int i = skip;
+        for (; i < count; i += 2)
+        {
+            // the centre of the output of input i lies half the filter length back
+            const float* x = centre + i;
+            float acc = 0.5f * x[0];
+
+            for (int j = 0; j < numTaps; ++j)
+                acc += taps[j] * (x[-(2 * j + 1)] + x[2 * j + 1]);
+
+            output[n++] = acc;
+        }
+        skip = i - count;
+
+        // keep the newest samples for the next chunk
+        std::copy(work + count, work + count + historyLength, history);
+    }
+
+    m_skip[index] = char(skip);
+
+    return n;
+}
+
+}
@@ -0,0 +1,113 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DSPFILTERS_HALFBANDDECIMATOR_H
+#define DSPFILTERS_HALFBANDDECIMATOR_H
+
+#include "Common.h"
+
+namespace Dsp
+{
+
+/*
+ * Lowers the sample rate of many channels by a power of two with a cascade of half-band
+ * FIR filters.
+ *
+ * Each stage low passes at a quarter of its input rate and keeps every other sample. A
+ * half-band filter has every other tap equal to zero, and a stage only computes the
+ * samples it keeps, so numStages stages cost less than two stages of an ordinary FIR
+ * filter of the same length per input sample. The stages use the same Kaiser windowed
+ * taps, whose transition around a quarter of the rate is folded back on itself by the
+ * decimation: with 31 taps, signals below a third of the final output rate stay flat
+ * and clean of aliasing.
+ *
+ * Outputs are produced for the input samples whose position is a multiple of the
+ * decimation factor, counting from the position given to reset(). The filters delay the
+ * signal by getDelay() input samples.
+ *
+ */
+class PLUGIN_API HalfBandDecimator
+{
+public:
+    HalfBandDecimator();
+
+    // Sets the number of channels, the number of halvings of the sample rate, and the
+    // number of taps of each stage, rounded up to 4 * n + 3. The history of every channel
+    // is cleared.
+    void setup(int numChannels, int numStages, int numTaps = 31);
+
+    int getNumChannels() const
+    {
+        return m_numChannels;
+    }
+
+    int getNumStages() const
+    {
+        return m_numStages;
+    }
+
+    // Returns the ratio of the input rate to the output rate
+    int getFactor() const
+    {
+        return 1 << m_numStages;
+    }
+
+    // Returns the delay of the cascade, in input samples
+    int getDelay() const;
+
+    // Returns the number of samples the next call to process() will write for
+    // numInputSamples input samples of the given channel
+    int getNumOutputSamples(int channel, int numInputSamples) const;
+
+    // Clears the history of every channel. inputPosition is the position of the next
+    // input sample, outputs being produced at the positions that are multiples of
+    // getFactor().
+    void reset(juce::uint64 inputPosition = 0);
+
+    // Decimates numInputSamples samples of numChannels channels starting at firstChannel,
+    // and returns the number of samples written to each output. Output and input may be
+    // the same buffers. Disjoint ranges of channels can be processed concurrently.
+    int process(int firstChannel,
+                int numChannels,
+                int numInputSamples,
+                const float* const* input,
+                float* const* output);
+
+private:
+    int processStage(int channel, int stage, int numInputSamples, const float* input, float* output);
+
+    // input samples a stage copies into its work buffer at a time
+    static const int WorkSamples = 256;
+
+    int m_numChannels;
+    int m_numStages;
+    int m_numTaps;
+    std::vector<float> m_taps;      // the non zero taps on one side of the centre tap, nearest first
+    std::vector<float> m_history;   // last numTaps - 1 inputs of each stage of each channel
+    std::vector<char> m_skip;       // whether each stage of each channel drops its next input
+    std::vector<float> m_work;      // history and WorkSamples inputs of each channel, as stages run one at a time
+};
+
+}
+
+#endif
@@ -0,0 +1,158 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "Common.h"
+#include "MultiChannelCascade.h"
+#include "MathSupplement.h"
+
+namespace Dsp {
+
+MultiChannelCascade::MultiChannelCascade()
+    : m_numChannels(0)
+    , m_numStages(0)
+{
+}
+
+void MultiChannelCascade::setup(int numChannels, int maxStages)
+{
+    m_numChannels = numChannels;
+    m_numStages = maxStages;
+    m_coefficients.assign(size_t(numChannels) * maxStages * NumCoefficients, 0.);
+    m_state.assign(size_t(numChannels) * maxStages * 2, 0.);
+
+    for (int s = 0; s < maxStages; ++s)
+        std::fill(coefficient(s, 0), coefficient(s, 0) + numChannels, 1.);
+}
+
+void MultiChannelCascade::setCoefficients(int firstChannel, int numChannels, Cascade& cascade)
+{
+    assert(firstChannel >= 0 && firstChannel + numChannels <= m_numChannels);
+
+    for (int s = 0; s < m_numStages; ++s)
+    {
+        // Biquad stores its coefficients divided by a0
+        double c[NumCoefficients] = { 1., 0., 0., 0., 0. };
+        if (s < cascade.getNumStages())
+        {
+            const Cascade::Stage& stage = cascade[s];
+            const double a0 = stage.getA0();
+            c[0] = stage.getB0() / a0;
+            c[1] = stage.getB1() / a0;
+            c[2] = stage.getB2() / a0;
+            c[3] = stage.getA1() / a0;
+            c[4] = stage.getA2() / a0;
+        }
+
+        for (int i = 0; i < NumCoefficients; ++i)
+            std::fill(coefficient(s, i) + firstChannel, coefficient(s, i) + firstChannel + numChannels, c[i]);
+    }
+}
+
+void MultiChannelCascade::reset()
+{
+    std::fill(m_state.begin(), m_state.end(), 0.);
+}
+
+void MultiChannelCascade::process(int firstChannel, int numChannels, int numSamples, float* const* channels)
+{
+    assert(firstChannel >= 0 && firstChannel + numChannels <= m_numChannels);
+
+    for (int c = 0; c < numChannels; c += LaneWidth)
+        processGroup(firstChannel + c, std::min(int(LaneWidth), numChannels - c), numSamples, channels + c);
+}
+
+void MultiChannelCascade::processGroup(int firstChannel, int numLanes, int numSamples, float* const* channels)
+{
+    // Lanes past numLanes run on zeros with pass-through coefficients and are thrown away,
+    // so the loops below always have LaneWidth iterations
+    double tile[TileSamples][LaneWidth];
+
+    for (int start = 0; start < numSamples; start += TileSamples)
+    {
+        const int n = std::min(int(TileSamples), numSamples - start);
+
+        for (int i = 0; i < n; ++i)
+        {
+            for (int l = 0; l < LaneWidth; ++l)
+                tile[i][l] = (l < numLanes && channels[l] != nullptr) ? channels[l][start + i] : 0.;
+        }
+
+        for (int s = 0; s < m_numStages; ++s)
+        {
+            double b0[LaneWidth], b1[LaneWidth], b2[LaneWidth], a1[LaneWidth], a2[LaneWidth];
+            double v1[LaneWidth], v2[LaneWidth];
+            for (int l = 0; l < LaneWidth; ++l)
+            {
+                const bool used = l < numLanes;
+                b0[l] = used ? coefficient(s, 0)[firstChannel + l] : 1.;
+                b1[l] = used ? coefficient(s, 1)[firstChannel + l] : 0.;
+                b2[l] = used ? coefficient(s, 2)[firstChannel + l] : 0.;
+                a1[l] = used ? coefficient(s, 3)[firstChannel + l] : 0.;
+                a2[l] = used ? coefficient(s, 4)[firstChannel + l] : 0.;
+                v1[l] = used ? state(s, 0)[firstChannel + l] : 0.;
+                v2[l] = used ? state(s, 1)[firstChannel + l] : 0.;
+            }
+
+            // stages that pass every lane through unchanged, such as the second stage of
+            // filters designed with fewer sections than maxStages, are not run
+            bool passThrough = true;
+            for (int l = 0; l < LaneWidth; ++l)
+                passThrough = passThrough && b0[l] == 1. && b1[l] == 0. && b2[l] == 0. && a1[l] == 0. && a2[l] == 0.;
+            if (passThrough)
+                continue;
+
+            // the small alternating current of DenormalPrevention, added before the first stage
+            double vsa = (s == 0) ? anti_denormal_vsa : 0.;
+
+            for (int i = 0; i < n; ++i)
+            {
+                vsa = -vsa;
+                for (int l = 0; l < LaneWidth; ++l)
+                {
+                    const double w = tile[i][l] - a1[l] * v1[l] - a2[l] * v2[l] + vsa;
+                    tile[i][l] = b0[l] * w + b1[l] * v1[l] + b2[l] * v2[l];
+                    v2[l] = v1[l];
+                    v1[l] = w;
+                }
+            }
+
+            for (int l = 0; l < numLanes; ++l)
+            {
+                const bool skipped = channels[l] == nullptr;
+                state(s, 0)[firstChannel + l] = skipped ? 0. : v1[l];
+                state(s, 1)[firstChannel + l] = skipped ? 0. : v2[l];
+            }
+        }
+
+        for (int l = 0; l < numLanes; ++l)
+        {
+            if (channels[l] == nullptr)
+                continue;
+            float* dest = channels[l] + start;
+            for (int i = 0; i < n; ++i)
+                dest[i] = static_cast<float>(tile[i][l]);
+        }
+    }
+}
+
+}
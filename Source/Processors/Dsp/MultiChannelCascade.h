@@ -0,0 +1,91 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DSPFILTERS_MULTICHANNELCASCADE_H
+#define DSPFILTERS_MULTICHANNELCASCADE_H
+
+#include "Common.h"
+#include "Cascade.h"
+
+namespace Dsp
+{
+
+/*
+ * Applies a cascade of second order sections to many channels at once, in Direct Form II.
+ *
+ * Every channel has its own coefficients and state, stored channel by channel for each
+ * stage, so groups of LaneWidth adjacent channels are filtered together with the inner
+ * loops running across the channels, which the compiler turns into SIMD operations.
+ * The results are the same as a DirectFormII state per channel, in double precision.
+ *
+ */
+class PLUGIN_API MultiChannelCascade
+{
+public:
+    enum { LaneWidth = 8 };
+
+    MultiChannelCascade();
+
+    // Sets the number of channels and stages, passing every channel through unchanged
+    void setup(int numChannels, int maxStages);
+
+    int getNumChannels() const
+    {
+        return m_numChannels;
+    }
+
+    // Copies the coefficients of a cascade to numChannels channels from firstChannel.
+    // Stages beyond those of the cascade pass the signal through, and are skipped for
+    // groups of LaneWidth channels that all pass through them.
+    void setCoefficients(int firstChannel, int numChannels, Cascade& cascade);
+
+    void reset();
+
+    // Filters numSamples samples of numChannels channels from firstChannel in place.
+    // Channels whose pointer is null are skipped, and their state cleared.
+    void process(int firstChannel, int numChannels, int numSamples, float* const* channels);
+
+private:
+    void processGroup(int firstChannel, int numLanes, int numSamples, float* const* channels);
+
+    enum { NumCoefficients = 5, TileSamples = 64 };
+
+    double* coefficient(int stage, int index)
+    {
+        return &m_coefficients[(stage * NumCoefficients + index) * m_numChannels];
+    }
+
+    double* state(int stage, int index)
+    {
+        return &m_state[(stage * 2 + index) * m_numChannels];
+    }
+
+    int m_numChannels;
+    int m_numStages;
+    std::vector<double> m_coefficients;    // b0, b1, b2, a1, a2 of every channel, for each stage
+    std::vector<double> m_state;           // v[n-1], v[n-2] of every channel, for each stage
+};
+
+}
+
+#endif
@@ -0,0 +1,182 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "Common.h"
+#include "NoiseLevelEstimator.h"
+
+namespace Dsp {
+
+namespace {
+
+// bins of 1/8 octave from 2^-10 to 2^20
+const int firstExponent = -10;
+const int numBins = 30 * 8;
+
+// samples to take before the median is trusted
+const int warmUpSamples = 1000;
+
+// the weight of new samples is brought back to one before it overflows
+const double maxWeight = 1e100;
+
+// median of the absolute value of a normal variable, in standard deviations
+const double medianToDeviation = 1. / 0.6745;
+
+inline int binOf(float magnitude)
+{
+    // the exponent and the first three bits of the mantissa
+    juce::uint32 bits;
+    std::memcpy(&bits, &magnitude, sizeof(bits));
+
+    const int bin = int(bits >> 20) - ((127 + firstExponent) << 3);
+    return bin < 0 ? 0 : (bin < numBins ? bin : numBins - 1);
+}
+
+inline double lowerEdge(int bin)
+{
+    return std::ldexp(1. + (bin & 7) / 8., (bin >> 3) + firstExponent);
+}
+
+}
+
+NoiseLevelEstimator::NoiseLevelEstimator()
+    : m_numChannels(0)
+    , m_decimation(1)
+    , m_growth(1)
+{
+}
+
+void NoiseLevelEstimator::setup(int numChannels, double sampleRate, double timeConstant, int decimation)
+{
+    assert(numChannels >= 0 && sampleRate > 0 && timeConstant > 0);
+
+    m_numChannels = numChannels;
+    m_decimation = std::max(1, decimation);
+    m_growth = std::exp(m_decimation / (timeConstant * sampleRate));
+
+    m_bins.resize(size_t(numChannels) * numBins);
+    m_weight.resize(numChannels);
+    m_total.resize(numChannels);
+    m_below.resize(numChannels);
+    m_median.resize(numChannels);
+    m_phase.resize(numChannels);
+    m_numTaken.resize(numChannels);
+
+    reset();
+}
+
+void NoiseLevelEstimator::reset()
+{
+    std::fill(m_bins.begin(), m_bins.end(), 0.);
+    std::fill(m_weight.begin(), m_weight.end(), 1.);
+    std::fill(m_total.begin(), m_total.end(), 0.);
+    std::fill(m_below.begin(), m_below.end(), 0.);
+    std::fill(m_median.begin(), m_median.end(), 0);
+    std::fill(m_phase.begin(), m_phase.end(), 0);
+    std::fill(m_numTaken.begin(), m_numTaken.end(), 0);
+}
+
+void NoiseLevelEstimator::process(int channel, int numSamples, const float* samples)
+{
+    double* bins = &m_bins[size_t(channel) * numBins];
+    double weight = m_weight[channel];
+    double total = m_total[channel];
+    double below = m_below[channel];
+    int median = m_median[channel];
+    int numTaken = 0;
+    int i = m_phase[channel];
+
+    for (; i < numSamples; i += m_decimation)
+    {
+        const int bin = binOf(std::fabs(samples[i]));
+
+        bins[bin] += weight;
+        total += weight;
+
+        if (bin < median)
+            below += weight;
+
+        // keep below <= total / 2 < below + bins[median]
+        const double half = 0.5 * total;
+
+        while (median > 0 && below > half)
+            below -= bins[--median];
+
+        while (median < numBins - 1 && below + bins[median] <= half)
+            below += bins[median++];
+
+        weight *= m_growth;
+        ++numTaken;
+    }
+
+    m_phase[channel] = i - numSamples;
+    m_weight[channel] = weight;
+    m_total[channel] = total;
+    m_below[channel] = below;
+    m_median[channel] = median;
+    m_numTaken[channel] = std::min(warmUpSamples, m_numTaken[channel] + numTaken);
+
+    if (weight > maxWeight)
+        rescale(channel);
+}
+
+float NoiseLevelEstimator::getNoiseLevel(int channel) const
+{
+    if (m_numTaken[channel] < warmUpSamples)
+        return 0;
+
+    const double* bins = &m_bins[size_t(channel) * numBins];
+    const int median = m_median[channel];
+
+    // spread the samples of the median bin evenly across it
+    double fraction = bins[median] > 0 ? (0.5 * m_total[channel] - m_below[channel]) / bins[median] : 0.5;
+    fraction = std::max(0., std::min(1., fraction));
+
+    const double lower = lowerEdge(median);
+    const double level = lower + fraction * (lowerEdge(median + 1) - lower);
+
+    return float(level * medianToDeviation);
+}
+
+void NoiseLevelEstimator::rescale(int channel)
+{
+    double* bins = &m_bins[size_t(channel) * numBins];
+    const double scale = 1. / m_weight[channel];
+    double total = 0;
+    double below = 0;
+
+    // the sums are rebuilt rather than scaled, so rounding errors do not pile up
+    for (int b = 0; b < numBins; ++b)
+    {
+        bins[b] *= scale;
+        total += bins[b];
+
+        if (b < m_median[channel])
+            below += bins[b];
+    }
+
+    m_weight[channel] = 1;
+    m_total[channel] = total;
+    m_below[channel] = below;
+}
+
+}
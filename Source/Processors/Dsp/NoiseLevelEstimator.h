@@ -0,0 +1,86 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DSPFILTERS_NOISELEVELESTIMATOR_H
+#define DSPFILTERS_NOISELEVELESTIMATOR_H
+
+#include "Common.h"
+
+namespace Dsp
+{
+
+/*
+ * Tracks the noise level of many channels as the median absolute value of their
+ * samples, scaled to a standard deviation (median / 0.6745). Unlike the standard
+ * deviation, the median is barely moved by the spikes themselves.
+ *
+ * The absolute values of every decimation-th sample go into a histogram of 1/8 octave
+ * bins per channel, read straight from the bits of the float. Older samples fade out
+ * with the given time constant, so the estimate follows drift over a long recording.
+ * The bin holding the median is moved by at most a few bins per added sample, so reading
+ * the estimate costs the same as adding a sample.
+ *
+ */
+class PLUGIN_API NoiseLevelEstimator
+{
+public:
+    NoiseLevelEstimator();
+
+    // Sets the number of channels, their sample rate, the time constant over which the
+    // estimate forgets older samples, in seconds, and the stride between the samples
+    // that are taken into account. Every channel is cleared.
+    void setup(int numChannels, double sampleRate, double timeConstant = 10., int decimation = 8);
+
+    int getNumChannels() const
+    {
+        return m_numChannels;
+    }
+
+    // Clears every channel
+    void reset();
+
+    // Adds numSamples consecutive samples of a channel
+    void process(int channel, int numSamples, const float* samples);
+
+    // Returns the estimated standard deviation of the noise of a channel, or zero until
+    // enough samples have been seen
+    float getNoiseLevel(int channel) const;
+
+private:
+    void rescale(int channel);
+
+    int m_numChannels;
+    int m_decimation;
+    double m_growth;                 // factor by which the weight of new samples grows per sample taken
+    std::vector<double> m_bins;      // decayed count of every bin of every channel
+    std::vector<double> m_weight;    // weight of the next sample taken on each channel
+    std::vector<double> m_total;     // sum of the bins of each channel
+    std::vector<double> m_below;     // sum of the bins below the median bin of each channel
+    std::vector<int> m_median;       // bin holding the median of each channel
+    std::vector<int> m_phase;        // samples to skip before the next one is taken on each channel
+    std::vector<int> m_numTaken;     // samples taken on each channel, up to the warm up count
+};
+
+}
+
+#endif
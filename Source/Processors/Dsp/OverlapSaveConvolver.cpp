@@ -0,0 +1,237 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "Common.h"
+#include "OverlapSaveConvolver.h"
+
+namespace Dsp {
+
+OverlapSaveConvolver::OverlapSaveConvolver()
+    : m_fftSize(0)
+    , m_historyLength(0)
+{
+}
+
+OverlapSaveConvolver::~OverlapSaveConvolver()
+{
+}
+
+void OverlapSaveConvolver::setup(int numChannels, int maxTaps)
+{
+    const juce::ScopedWriteLock lock(m_lock);
+
+    maxTaps = std::max(1, maxTaps);
+
+    // frames of about four times the filter length keep most of every frame for new samples
+    int order = 6;
+    while ((1 << order) < 4 * maxTaps)
+        ++order;
+
+    if ((1 << order) != m_fftSize)
+    {
+        m_fftSize = 1 << order;
+        m_forward.reset(new juce::FFT(order, false));
+        m_inverse.reset(new juce::FFT(order, true));
+    }
+
+    m_historyLength = maxTaps - 1;
+    m_responses.clear();
+
+    Channel passThrough;
+    passThrough.response = -1;
+    passThrough.history.assign(m_historyLength, 0.f);
+    m_channels.assign(numChannels, passThrough);
+}
+
+void OverlapSaveConvolver::setImpulseResponse(int firstChannel, int numChannels, const std::vector<double>& taps)
+{
+    assert(firstChannel >= 0 && firstChannel + numChannels <= getNumChannels());
+
+    Response response;
+    response.taps.assign(taps.begin(), taps.begin() + std::min(int(taps.size()), m_historyLength + 1));
+
+    // responses only change on this thread, so they can be searched without the lock
+    int index = -1;
+    for (int r = 0; r < int(m_responses.size()) && index < 0; ++r)
+        if (m_responses[r].taps == response.taps)
+            index = r;
+
+    if (index < 0)
+    {
+        std::vector<juce::FFT::Complex> kernel(m_fftSize);
+        response.spectrum.resize(m_fftSize);
+
+        const float scale = 1.f / m_fftSize;
+        for (int n = 0; n < m_fftSize; ++n)
+        {
+            kernel[n].r = n < int(response.taps.size()) ? float(response.taps[n] * scale) : 0.f;
+            kernel[n].i = 0.f;
+        }
+
+        m_forward->perform(kernel.data(), response.spectrum.data());
+    }
+
+    const juce::ScopedWriteLock lock(m_lock);
+
+    if (index < 0)
+    {
+        index = int(m_responses.size());
+        m_responses.push_back(std::move(response));
+    }
+
+    for (int c = firstChannel; c < firstChannel + numChannels; ++c)
+        m_channels[c].response = index;
+
+    // drop responses no channel uses any more
+    std::vector<int> remap(m_responses.size(), -1);
+    for (const Channel& channel : m_channels)
+        if (channel.response >= 0)
+            remap[channel.response] = 0;
+
+    int used = 0;
+    for (int r = 0; r < int(m_responses.size()); ++r)
+    {
+        if (remap[r] < 0)
+            continue;
+        if (r != used)
+            m_responses[used] = std::move(m_responses[r]);
+        remap[r] = used++;
+    }
+    m_responses.resize(used);
+
+    for (Channel& channel : m_channels)
+        if (channel.response >= 0)
+            channel.response = remap[channel.response];
+}
+
+void OverlapSaveConvolver::reset()
+{
+    const juce::ScopedWriteLock lock(m_lock);
+
+    for (Channel& channel : m_channels)
+        std::fill(channel.history.begin(), channel.history.end(), 0.f);
+}
+
+void OverlapSaveConvolver::process(int firstChannel, int numChannels, int numSamples, float* const* channels)
+{
+    const juce::ScopedReadLock lock(m_lock);
+
+    assert(firstChannel >= 0 && firstChannel + numChannels <= getNumChannels());
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        Channel& channel = m_channels[firstChannel + c];
+
+        if (channels[c] == nullptr)
+        {
+            std::fill(channel.history.begin(), channel.history.end(), 0.f);
+            continue;
+        }
+
+        if (channel.response < 0)
+        {
+            // keep the history current, so the filter starts cleanly when it is set
+            const int kept = std::max(0, m_historyLength - numSamples);
+            std::copy(channel.history.end() - kept, channel.history.end(), channel.history.begin());
+            std::copy(channels[c] + numSamples - (m_historyLength - kept), channels[c] + numSamples,
+                      channel.history.begin() + kept);
+            continue;
+        }
+
+        if (c + 1 < numChannels
+            && channels[c + 1] != nullptr
+            && m_channels[firstChannel + c + 1].response == channel.response)
+        {
+            processFrames(channel, channels[c], &m_channels[firstChannel + c + 1], channels[c + 1], numSamples);
+            ++c;
+        }
+        else
+        {
+            processFrames(channel, channels[c], nullptr, nullptr, numSamples);
+        }
+    }
+}
+
+void OverlapSaveConvolver::processFrames(Channel& first, float* firstData, Channel* second, float* secondData, int numSamples)
+{
+    // scratch frames for each thread filtering channels
+    static thread_local std::vector<juce::FFT::Complex> frame;
+    static thread_local std::vector<juce::FFT::Complex> bins;
+    frame.resize(m_fftSize);
+    bins.resize(m_fftSize);
+
+    const juce::FFT::Complex* spectrum = m_responses[first.response].spectrum.data();
+    const int H = m_historyLength;
+    const int hop = m_fftSize - H;
+
+    for (int pos = 0; pos < numSamples; pos += hop)
+    {
+        const int n = std::min(hop, numSamples - pos);
+
+        for (int i = 0; i < H; ++i)
+        {
+            frame[i].r = first.history[i];
+            frame[i].i = second ? second->history[i] : 0.f;
+        }
+        for (int i = 0; i < n; ++i)
+        {
+            frame[H + i].r = firstData[pos + i];
+            frame[H + i].i = second ? secondData[pos + i] : 0.f;
+        }
+        for (int i = H + n; i < m_fftSize; ++i)
+        {
+            frame[i].r = 0.f;
+            frame[i].i = 0.f;
+        }
+
+        // the next frame starts with the last H input samples of this one
+        for (int i = 0; i < H; ++i)
+        {
+            first.history[i] = frame[n + i].r;
+            if (second)
+                second->history[i] = frame[n + i].i;
+        }
+
+        m_forward->perform(frame.data(), bins.data());
+
+        for (int k = 0; k < m_fftSize; ++k)
+        {
+            const juce::FFT::Complex x = bins[k];
+            const juce::FFT::Complex h = spectrum[k];
+            bins[k].r = x.r * h.r - x.i * h.i;
+            bins[k].i = x.r * h.i + x.i * h.r;
+        }
+
+        m_inverse->perform(bins.data(), frame.data());
+
+        // the first H outputs wrapped around the frame and are discarded
+        for (int i = 0; i < n; ++i)
+        {
+            firstData[pos + i] = frame[H + i].r;
+            if (second)
+                secondData[pos + i] = frame[H + i].i;
+        }
+    }
+}
+
+}
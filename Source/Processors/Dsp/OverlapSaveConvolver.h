@@ -0,0 +1,103 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DSPFILTERS_OVERLAPSAVECONVOLVER_H
+#define DSPFILTERS_OVERLAPSAVECONVOLVER_H
+
+#include "Common.h"
+
+namespace Dsp
+{
+
+/*
+ * Applies long FIR filters to many channels at once by FFT convolution, using the
+ * overlap-save method.
+ *
+ * Each block is filtered straight away in frames of the FFT size, the start of every frame
+ * holding the previous input samples of the channel, so the only delay is that of the
+ * filter itself. Adjacent channels with the same impulse response are transformed together,
+ * one as the real and one as the imaginary part of a complex frame: the impulse response is
+ * real, so the two filtered channels come back as the real and imaginary parts of the
+ * inverse transform.
+ *
+ * setup() and setImpulseResponse() must be called from a single thread, while process() may
+ * be called concurrently for disjoint sets of channels.
+ *
+ */
+class PLUGIN_API OverlapSaveConvolver
+{
+public:
+    OverlapSaveConvolver();
+    ~OverlapSaveConvolver();
+
+    // Sets the number of channels and the longest impulse response, passing every channel
+    // through unchanged
+    void setup(int numChannels, int maxTaps);
+
+    int getNumChannels() const
+    {
+        return int(m_channels.size());
+    }
+
+    int getMaxTaps() const
+    {
+        return m_historyLength + 1;
+    }
+
+    // Sets the impulse response of numChannels channels from firstChannel. Responses longer
+    // than getMaxTaps() are truncated.
+    void setImpulseResponse(int firstChannel, int numChannels, const std::vector<double>& taps);
+
+    void reset();
+
+    // Filters numSamples samples of numChannels channels from firstChannel in place.
+    // Channels whose pointer is null are skipped, and their history cleared.
+    void process(int firstChannel, int numChannels, int numSamples, float* const* channels);
+
+private:
+    struct Response
+    {
+        std::vector<double> taps;
+        std::vector<juce::FFT::Complex> spectrum;   // scaled by 1 / FFT size
+    };
+
+    struct Channel
+    {
+        int response;                 // index into m_responses, or -1 to pass through
+        std::vector<float> history;   // the last m_historyLength input samples
+    };
+
+    void processFrames(Channel& first, float* firstData, Channel* second, float* secondData, int numSamples);
+
+    int m_fftSize;
+    int m_historyLength;
+    std::unique_ptr<juce::FFT> m_forward;
+    std::unique_ptr<juce::FFT> m_inverse;
+    std::vector<Response> m_responses;
+    std::vector<Channel> m_channels;
+    juce::ReadWriteLock m_lock;   // written when responses change, read while filtering
+};
+
+}
+
+#endif
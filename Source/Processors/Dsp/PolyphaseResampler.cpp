@@ -0,0 +1,211 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "Common.h"
+#include "PolyphaseResampler.h"
+#include "FirDesign.h"
+
+namespace Dsp {
+
+PolyphaseResampler::PolyphaseResampler()
+    : m_numChannels(0)
+    , m_tapsPerPhase(0)
+    , m_up(1)
+    , m_down(1)
+    , m_inputIndex(0)
+    , m_phase(0)
+{
+}
+
+void PolyphaseResampler::setup(int numChannels,
+                               double inputRate,
+                               double outputRate,
+                               int tapsPerPhase,
+                               int maxPhases)
+{
+    assert(inputRate > 0 && outputRate > 0);
+
+    tapsPerPhase = std::max(2, tapsPerPhase);
+    maxPhases = std::max(1, maxPhases);
+
+    // closest fraction up / down of the rate ratio, from its continued fraction
+    const double ratio = outputRate / inputRate;
+    long long up = 1, down = 0, upPrev = 0, downPrev = 1;
+    double x = ratio;
+
+    for (int term = 0; term < 32; ++term)
+    {
+        const double a = std::floor(x);
+        const long long nextUp = (long long)a * up + upPrev;
+        const long long nextDown = (long long)a * down + downPrev;
+
+        if (nextUp > maxPhases || nextDown > (1 << 20))
+            break;
+
+        upPrev = up;
+        downPrev = down;
+        up = nextUp;
+        down = nextDown;
+
+        if (x - a < 1e-9)
+            break;
+        x = 1. / (x - a);
+    }
+
+    if (down == 0)
+    {
+        // the very first term overflowed: the ratio is above maxPhases
+        up = maxPhases;
+        down = 1;
+    }
+    else if (up == 0)
+    {
+        // the ratio is below 1 / 2^20
+        up = 1;
+        down = 1 << 20;
+    }
+
+    const int oldUp = m_up;
+    m_up = int(up);
+    m_down = int(down);
+
+    // decimating by D needs a D times longer filter for the same transition at the output rate
+    tapsPerPhase *= std::max(1, (m_down + m_up - 1) / m_up);
+
+    // keep the position of the next output in time
+    m_phase = std::min(m_up - 1, int(double(m_phase) * m_up / oldUp + 0.5));
+
+    if (numChannels != m_numChannels || tapsPerPhase != m_tapsPerPhase)
+    {
+        m_numChannels = numChannels;
+        m_tapsPerPhase = tapsPerPhase;
+
+        const int numGroups = (numChannels + LaneWidth - 1) / LaneWidth;
+        m_history.assign(size_t(numGroups) * (tapsPerPhase - 1) * LaneWidth, 0.f);
+        m_inputIndex = 0;
+        m_phase = 0;
+    }
+
+    design(inputRate, outputRate);
+}
+
+void PolyphaseResampler::design(double inputRate, double outputRate)
+{
+    // cut off a little below the lower of the two Nyquist frequencies
+    const double cutoff = 0.45 * std::min(inputRate, outputRate);
+    const int length = m_tapsPerPhase * m_up;
+
+    // an odd length keeps the prototype symmetric, the last tap stays zero
+    std::vector<double> prototype = FirDesign::bandPass(inputRate * m_up, 0., cutoff,
+                                                        length - 1 + (length % 2), 8.);
+    prototype.resize(length, 0.);
+
+    // bandPass() gives unit gain in the pass band at L times the input rate, and
+    // each phase only sees one in L of the zero stuffed samples
+    m_taps.resize(length);
+    for (int p = 0; p < m_up; ++p)
+        for (int k = 0; k < m_tapsPerPhase; ++k)
+            m_taps[p * m_tapsPerPhase + k] = float(prototype[p + k * m_up] * m_up);
+}
+
+int PolyphaseResampler::getNumOutputSamples(int numInputSamples) const
+{
+    // outputs fall every M steps of 1 / L input samples, the next one at m_inputIndex * L + m_phase
+    const long long first = (long long)m_inputIndex * m_up + m_phase;
+    const long long end = (long long)numInputSamples * m_up;
+
+    if (end <= first)
+        return 0;
+
+    return int((end - first + m_down - 1) / m_down);
+}
+
+void PolyphaseResampler::reset()
+{
+    std::fill(m_history.begin(), m_history.end(), 0.f);
+    m_inputIndex = 0;
+    m_phase = 0;
+}
+
+int PolyphaseResampler::process(int numInputSamples, const float* const* input, float* const* output)
+{
+    const int numOutputSamples = getNumOutputSamples(numInputSamples);
+
+    for (int c = 0; c < m_numChannels; c += LaneWidth)
+        processGroup(c, std::min(int(LaneWidth), m_numChannels - c), numInputSamples, input + c, output + c);
+
+    // advance to the first output of the next block
+    const long long next = (long long)m_inputIndex * m_up + m_phase + (long long)numOutputSamples * m_down;
+    m_inputIndex = int(next / m_up) - numInputSamples;
+    m_phase = int(next % m_up);
+
+    return numOutputSamples;
+}
+
+void PolyphaseResampler::processGroup(int firstChannel, int numLanes, int numInputSamples,
+                                      const float* const* input, float* const* output)
+{
+    const int K = m_tapsPerPhase;
+    const int historyLength = K - 1;
+    const size_t historySize = size_t(historyLength) * LaneWidth;
+    float* const history = m_history.data() + size_t(firstChannel / LaneWidth) * historySize;
+
+    // history followed by the new input, interleaved by lane. Lanes past numLanes stay zero.
+    m_work.resize(historySize + size_t(numInputSamples) * LaneWidth);
+    std::copy(history, history + historySize, m_work.begin());
+
+    float* const samples = m_work.data() + historySize;
+    for (int i = 0; i < numInputSamples; ++i)
+        for (int l = 0; l < LaneWidth; ++l)
+            samples[i * LaneWidth + l] = l < numLanes ? input[l][i] : 0.f;
+
+    int inputIndex = m_inputIndex;
+    int phase = m_phase;
+
+    for (int n = 0; inputIndex < numInputSamples; ++n)
+    {
+        const float* taps = m_taps.data() + size_t(phase) * K;
+        const float* x = samples + ptrdiff_t(inputIndex) * LaneWidth;
+
+        float acc[LaneWidth] = {};
+        for (int k = 0; k < K; ++k)
+        {
+            const float h = taps[k];
+            const float* xk = x - ptrdiff_t(k) * LaneWidth;
+            for (int l = 0; l < LaneWidth; ++l)
+                acc[l] += h * xk[l];
+        }
+
+        for (int l = 0; l < numLanes; ++l)
+            output[l][n] = acc[l];
+
+        phase += m_down;
+        inputIndex += phase / m_up;
+        phase %= m_up;
+    }
+
+    // keep the newest samples for the next block
+    std::copy(m_work.end() - historySize, m_work.end(), history);
+}
+
+}
@@ -0,0 +1,106 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DSPFILTERS_POLYPHASERESAMPLER_H
+#define DSPFILTERS_POLYPHASERESAMPLER_H
+
+#include "Common.h"
+
+namespace Dsp
+{
+
+/*
+ * Changes the sample rate of many channels by a rational factor L / M with a polyphase
+ * FIR filter.
+ *
+ * The output rate is the input rate times the closest fraction L / M with L no more than
+ * maxPhases. The anti-aliasing low pass is a Kaiser windowed sinc designed at L times the
+ * input rate and split into L phases of tapsPerPhase taps each, so every output sample is
+ * a single dot product of one phase with the latest input samples. When decimating, the
+ * number of taps per phase grows with M / L, so the filter stays as sharp at the output rate. As in
+ * MultiChannelCascade, groups of LaneWidth adjacent channels are resampled together with
+ * the inner loop running across the channels, which the compiler turns into SIMD operations.
+ *
+ * The filter delays the signal by about tapsPerPhase / 2 input samples. Changing the rates
+ * with setup() keeps the input history of every channel, so the output stays continuous.
+ *
+ */
+class PLUGIN_API PolyphaseResampler
+{
+public:
+    enum { LaneWidth = 8 };
+
+    PolyphaseResampler();
+
+    // Sets the number of channels and the conversion. The history of the channels is
+    // cleared when their number or the number of taps per phase changes.
+    void setup(int numChannels,
+               double inputRate,
+               double outputRate,
+               int tapsPerPhase = 16,
+               int maxPhases = 512);
+
+    int getNumChannels() const
+    {
+        return m_numChannels;
+    }
+
+    int getUpFactor() const
+    {
+        return m_up;
+    }
+
+    int getDownFactor() const
+    {
+        return m_down;
+    }
+
+    // Returns the number of samples the next call to process() will write for
+    // numInputSamples input samples
+    int getNumOutputSamples(int numInputSamples) const;
+
+    void reset();
+
+    // Resamples numInputSamples samples of every channel, writing getNumOutputSamples()
+    // samples to each output channel, and returns that number
+    int process(int numInputSamples, const float* const* input, float* const* output);
+
+private:
+    void design(double inputRate, double outputRate);
+    void processGroup(int firstChannel, int numLanes, int numInputSamples,
+                      const float* const* input, float* const* output);
+
+    int m_numChannels;
+    int m_tapsPerPhase;
+    int m_up;                       // L
+    int m_down;                     // M
+    int m_inputIndex;               // newest input sample of the next output, relative to the next block
+    int m_phase;                    // phase of the next output
+    std::vector<float> m_taps;      // tapsPerPhase taps of each phase, the taps of x[i], x[i-1]...
+    std::vector<float> m_history;   // last tapsPerPhase - 1 inputs of each group, interleaved by lane
+    std::vector<float> m_work;      // history and input of one group, interleaved by lane
+};
+
+}
+
+#endif
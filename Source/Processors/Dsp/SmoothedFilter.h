@@ -47,6 +47,12 @@ namespace Dsp
 /*
  * Implements smooth modulation of time-varying filter parameters
  *
+ * When the parameters change, the new coefficients are designed once and the
+ * previous ones are kept in m_transitionFilter. For the next transitionSamples
+ * samples every channel runs through both, with the old filter starting from a
+ * copy of the channel state, and the output is crossfaded linearly from the old
+ * filter to the new one.
+ *
  */
 template <class DesignClass,
          int Channels,
@@ -76,34 +82,35 @@ public:
         assert(m_remainingSamples >= 0);
 
         // first handle any transition samples
-        int remainingSamples = std::min(m_remainingSamples, numSamples);
+        const int remainingSamples = std::min(m_remainingSamples, numSamples);
 
         if (remainingSamples > 0)
         {
-            // interpolate parameters for each sample
-            const double t = 1. / m_remainingSamples;
-            double dp[maxParameters];
-            for (int i = 0; i < DesignClass::NumParams; ++i)
-                dp[i] = (this->getParams()[i] - m_transitionParams[i]) * t;
+            const int done = m_transitionSamples - m_remainingSamples;
+            const Sample step = Sample(1) / m_transitionSamples;
 
-            for (int n = 0; n < remainingSamples; ++n)
+            for (int i = 0; i < numChannels; ++i)
             {
-                for (int i = DesignClass::NumParams; --i >=0;)
-                    m_transitionParams[i] += dp[i];
+                Sample* dest = destChannelArray[i];
 
-                m_transitionFilter.setParams(m_transitionParams);
+                enum { TileSamples = 64 };
+                Sample old[TileSamples];
 
-                for (int i = numChannels; --i >= 0;)
+                for (int start = 0; start < remainingSamples; start += TileSamples)
                 {
-                    Sample* dest = destChannelArray[i]+n;
-                    *dest = this->m_state[i].process(*dest, m_transitionFilter);
+                    const int n = std::min(int(TileSamples), remainingSamples - start);
+
+                    std::copy(dest + start, dest + start + n, old);
+                    this->m_design.process(n, dest + start, this->m_state[i]);
+                    m_transitionFilter.process(n, old, m_transitionState[i]);
+
+                    const Sample t0 = (done + start + 1) * step;
+                    for (int k = 0; k < n; ++k)
+                        dest[start + k] = old[k] + (dest[start + k] - old[k]) * (t0 + k * step);
                 }
             }
 
             m_remainingSamples -= remainingSamples;
-
-            if (m_remainingSamples == 0)
-                m_transitionParams = this->getParams();
         }
 
         // do what's left
@@ -130,23 +137,34 @@ public:
 protected:
     void doSetParams(const Params& parameters)
     {
-        if (m_remainingSamples >= 0)
+        if (m_remainingSamples < 0)
+        {
+            // first time
+            m_remainingSamples = 0;
+        }
+        else if (m_transitionSamples > 0
+                 && 2 * m_remainingSamples <= m_transitionSamples)
         {
+            // fade from the filter that is currently heard the most. If a
+            // transition is less than half way through, it keeps its old filter.
+            m_transitionFilter.setParams(m_designParams);
+            m_transitionState = this->m_state;
             m_remainingSamples = m_transitionSamples;
         }
         else
         {
-            // first time
-            m_remainingSamples = 0;
-            m_transitionParams = parameters;
+            m_remainingSamples = m_transitionSamples;
         }
 
+        m_designParams = parameters;
         filter_type_t::doSetParams(parameters);
     }
 
 protected:
-    Params m_transitionParams;
+    Params m_designParams;         // parameters of m_design
     DesignClass m_transitionFilter;
+    ChannelsState <Channels,
+                  typename DesignClass::template State <StateType> > m_transitionState;
     int m_transitionSamples;
 
     int m_remainingSamples;        // remaining transition samples
@@ -0,0 +1,363 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#include "Common.h"
+#include "Spectrum.h"
+#include "MathSupplement.h"
+
+namespace Dsp {
+
+RealFFT::RealFFT()
+    : m_size(0)
+{
+}
+
+RealFFT::~RealFFT()
+{
+}
+
+void RealFFT::setSize(int size)
+{
+    if (size == m_size)
+        return;
+
+    int order = 0;
+    while ((1 << order) < size)
+        ++order;
+    assert((1 << order) == size);
+
+    m_size = 1 << order;
+    m_fft.reset(new juce::FFT(order, false));
+    m_frame.resize(m_size);
+    m_bins.resize(m_size);
+}
+
+void RealFFT::transform(const float* a, const float* b)
+{
+    juce::FFT::Complex* frame = m_frame.data();
+
+    if (b != nullptr)
+    {
+        for (int n = 0; n < m_size; ++n)
+        {
+            frame[n].r = a[n];
+            frame[n].i = b[n];
+        }
+    }
+    else
+    {
+        for (int n = 0; n < m_size; ++n)
+        {
+            frame[n].r = a[n];
+            frame[n].i = 0.f;
+        }
+    }
+
+    m_fft->perform(frame, m_bins.data());
+}
+
+void RealFFT::perform(const float* a, const float* b, juce::FFT::Complex* spectrumA, juce::FFT::Complex* spectrumB)
+{
+    transform(a, b);
+
+    const juce::FFT::Complex* bins = m_bins.data();
+    const int numBins = getNumBins();
+
+    if (b == nullptr)
+    {
+        std::copy(bins, bins + numBins, spectrumA);
+        return;
+    }
+
+    // with z = a + ib, A[k] = (Z[k] + conj(Z[N-k])) / 2 and B[k] = (Z[k] - conj(Z[N-k])) / 2i
+    for (int k = 0; k < numBins; ++k)
+    {
+        const juce::FFT::Complex z = bins[k];
+        const juce::FFT::Complex m = bins[(m_size - k) & (m_size - 1)];
+
+        spectrumA[k].r = 0.5f * (z.r + m.r);
+        spectrumA[k].i = 0.5f * (z.i - m.i);
+
+        if (spectrumB != nullptr)
+        {
+            spectrumB[k].r = 0.5f * (z.i + m.i);
+            spectrumB[k].i = -0.5f * (z.r - m.r);
+        }
+    }
+}
+
+void RealFFT::performPower(const float* a, const float* b, float* powerA, float* powerB)
+{
+    transform(a, b);
+
+    const juce::FFT::Complex* bins = m_bins.data();
+    const int numBins = getNumBins();
+
+    if (b == nullptr)
+    {
+        for (int k = 0; k < numBins; ++k)
+            powerA[k] = bins[k].r * bins[k].r + bins[k].i * bins[k].i;
+        return;
+    }
+
+    for (int k = 0; k < numBins; ++k)
+    {
+        const juce::FFT::Complex z = bins[k];
+        const juce::FFT::Complex m = bins[(m_size - k) & (m_size - 1)];
+
+        const float ar = z.r + m.r;
+        const float ai = z.i - m.i;
+        powerA[k] = 0.25f * (ar * ar + ai * ai);
+
+        if (powerB != nullptr)
+        {
+            const float br = z.i + m.i;
+            const float bi = z.r - m.r;
+            powerB[k] = 0.25f * (br * br + bi * bi);
+        }
+    }
+}
+
+//==============================================================================
+
+ShortTimeSpectrum::ShortTimeSpectrum()
+    : m_numChannels(0)
+    , m_hopSize(1)
+    , m_position(0)
+    , m_untilNextSegment(0)
+    , m_sampleRate(1.)
+    , m_scale(1.)
+{
+}
+
+ShortTimeSpectrum::~ShortTimeSpectrum()
+{
+}
+
+void ShortTimeSpectrum::setup(int numChannels, int segmentSize, int hopSize, double sampleRate)
+{
+    m_numChannels = std::max(0, numChannels);
+    m_hopSize = std::max(1, hopSize);
+    m_sampleRate = sampleRate > 0. ? sampleRate : 1.;
+
+    m_fft.setSize(segmentSize);
+    const int size = m_fft.getSize();
+
+    // periodic Hann window, the usual choice for Welch's method
+    m_window.resize(size);
+    double windowPower = 0.;
+    for (int n = 0; n < size; ++n)
+    {
+        m_window[n] = float(0.5 - 0.5 * std::cos(2. * doublePi * n / size));
+        windowPower += double(m_window[n]) * m_window[n];
+    }
+    m_scale = windowPower > 0. ? 1. / (m_sampleRate * windowPower) : 1.;
+
+    m_segmentA.resize(size);
+    m_segmentB.resize(size);
+    m_spectra.resize(size_t(m_numChannels) * getNumBins());
+
+    reset();
+}
+
+double ShortTimeSpectrum::getBinFrequency(int bin) const
+{
+    return getSegmentSize() > 0 ? bin * m_sampleRate / getSegmentSize() : 0.;
+}
+
+void ShortTimeSpectrum::reset()
+{
+    m_history.assign(size_t(m_numChannels) * getSegmentSize(), 0.f);
+    m_position = 0;
+    m_untilNextSegment = getSegmentSize();
+}
+
+void ShortTimeSpectrum::process(int numSamples, const float* const* channels)
+{
+    const int size = getSegmentSize();
+    if (m_numChannels == 0 || size == 0)
+        return;
+
+    int done = 0;
+    while (done < numSamples)
+    {
+        const int count = std::min(numSamples - done, m_untilNextSegment);
+
+        // copy into the rings, in at most two pieces
+        const int first = std::min(count, size - m_position);
+        for (int ch = 0; ch < m_numChannels; ++ch)
+        {
+            float* history = m_history.data() + size_t(ch) * size;
+
+            if (channels[ch] != nullptr)
+            {
+                std::copy(channels[ch] + done, channels[ch] + done + first, history + m_position);
+                std::copy(channels[ch] + done + first, channels[ch] + done + count, history);
+            }
+            else
+            {
+                std::fill(history + m_position, history + m_position + first, 0.f);
+                std::fill(history, history + count - first, 0.f);
+            }
+        }
+
+        m_position = (m_position + count) % size;
+        m_untilNextSegment -= count;
+        done += count;
+
+        if (m_untilNextSegment == 0)
+        {
+            computeSegment();
+            m_untilNextSegment = m_hopSize;
+        }
+    }
+}
+
+void ShortTimeSpectrum::computeSegment()
+{
+    const int size = getSegmentSize();
+    const int numBins = getNumBins();
+
+    // the oldest sample of every ring is at m_position
+    auto unwrap = [&](int channel, float* segment)
+    {
+        const float* history = m_history.data() + size_t(channel) * size;
+        const int wrap = size - m_position;
+        for (int n = 0; n < wrap; ++n)
+            segment[n] = history[m_position + n] * m_window[n];
+        for (int n = wrap; n < size; ++n)
+            segment[n] = history[n - wrap] * m_window[n];
+    };
+
+    for (int ch = 0; ch < m_numChannels; ch += 2)
+    {
+        float* powerA = m_spectra.data() + size_t(ch) * numBins;
+
+        unwrap(ch, m_segmentA.data());
+
+        if (ch + 1 < m_numChannels)
+        {
+            unwrap(ch + 1, m_segmentB.data());
+            m_fft.performPower(m_segmentA.data(), m_segmentB.data(), powerA, powerA + numBins);
+        }
+        else
+        {
+            m_fft.performPower(m_segmentA.data(), nullptr, powerA, nullptr);
+        }
+    }
+
+    // one-sided density: every bin but DC and Nyquist also holds the negative frequency
+    const float scale = float(m_scale);
+    for (int ch = 0; ch < m_numChannels; ++ch)
+    {
+        float* power = m_spectra.data() + size_t(ch) * numBins;
+        for (int k = 0; k < numBins; ++k)
+            power[k] *= (k == 0 || k == numBins - 1) ? scale : 2.f * scale;
+    }
+
+    addSegment(m_spectra.data());
+}
+
+//==============================================================================
+
+WelchPSD::WelchPSD()
+    : m_averageLength(0)
+    , m_numSegments(0)
+{
+}
+
+void WelchPSD::setAverageLength(int averageLength)
+{
+    m_averageLength = std::max(0, averageLength);
+}
+
+void WelchPSD::reset()
+{
+    ShortTimeSpectrum::reset();
+
+    m_numSegments = 0;
+    m_average.assign(size_t(getNumChannels()) * getNumBins(), 0.f);
+}
+
+const float* WelchPSD::getPSD(int channel) const
+{
+    if (m_numSegments == 0 || channel < 0 || channel >= getNumChannels())
+        return nullptr;
+
+    return m_average.data() + size_t(channel) * getNumBins();
+}
+
+void WelchPSD::addSegment(const float* spectra)
+{
+    ++m_numSegments;
+
+    // running mean, turning into an exponential average after m_averageLength segments
+    const int length = m_averageLength > 0 ? std::min(m_numSegments, m_averageLength) : m_numSegments;
+    const float weight = 1.f / length;
+
+    const size_t total = m_average.size();
+    float* average = m_average.data();
+    for (size_t i = 0; i < total; ++i)
+        average[i] += weight * (spectra[i] - average[i]);
+}
+
+//==============================================================================
+
+Spectrogram::Spectrogram()
+    : m_numColumns(1)
+    , m_numComputed(0)
+{
+}
+
+void Spectrogram::setNumColumns(int numColumns)
+{
+    m_numColumns = std::max(1, numColumns);
+    reset();
+}
+
+void Spectrogram::reset()
+{
+    ShortTimeSpectrum::reset();
+
+    m_numComputed = 0;
+    m_columns.assign(size_t(m_numColumns) * getNumChannels() * getNumBins(), 0.f);
+}
+
+const float* Spectrogram::getColumn(int channel, int age) const
+{
+    assert(channel >= 0 && channel < getNumChannels());
+    assert(age >= 0 && age < m_numColumns);
+
+    const juce::int64 column = ((m_numComputed - 1 - age) % m_numColumns + m_numColumns) % m_numColumns;
+    return m_columns.data() + (size_t(column) * getNumChannels() + channel) * getNumBins();
+}
+
+void Spectrogram::addSegment(const float* spectra)
+{
+    const size_t columnSize = size_t(getNumChannels()) * getNumBins();
+    const juce::int64 column = m_numComputed % m_numColumns;
+
+    std::copy(spectra, spectra + columnSize, m_columns.data() + size_t(column) * columnSize);
+    ++m_numComputed;
+}
+
+}
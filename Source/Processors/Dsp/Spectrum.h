@@ -0,0 +1,224 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DSPFILTERS_SPECTRUM_H
+#define DSPFILTERS_SPECTRUM_H
+
+#include "Common.h"
+
+namespace Dsp
+{
+
+/*
+ * Forward FFT of real signals, with the transform tables and work buffers kept between
+ * calls.
+ *
+ * Signals are transformed two at a time, as the real and imaginary parts of one complex
+ * frame, and the two spectra are separated afterwards using the conjugate symmetry of the
+ * spectrum of a real signal. A batch of channels thus costs half as many complex
+ * transforms as channels.
+ *
+ * An object must only be used by one thread at a time.
+ *
+ */
+class PLUGIN_API RealFFT
+{
+public:
+    RealFFT();
+    ~RealFFT();
+
+    // Sets the number of samples per transform, which must be a power of two. Does nothing
+    // if the size doesn't change.
+    void setSize(int size);
+
+    int getSize() const
+    {
+        return m_size;
+    }
+
+    // Number of non-negative frequency bins, up to and including the Nyquist frequency
+    int getNumBins() const
+    {
+        return m_size / 2 + 1;
+    }
+
+    // Computes the getNumBins() lower bins of the spectra of one or two signals of getSize()
+    // samples. b and spectrumB may be null to transform a single signal.
+    void perform(const float* a, const float* b, juce::FFT::Complex* spectrumA, juce::FFT::Complex* spectrumB);
+
+    // Same as perform(), but returns the squared magnitude of every bin
+    void performPower(const float* a, const float* b, float* powerA, float* powerB);
+
+private:
+    void transform(const float* a, const float* b);
+
+    int m_size;
+    std::unique_ptr<juce::FFT> m_fft;
+    std::vector<juce::FFT::Complex> m_frame;
+    std::vector<juce::FFT::Complex> m_bins;
+};
+
+/*
+ * Splits many channels into overlapping windowed segments and computes the power spectrum
+ * of each, for WelchPSD and Spectrogram.
+ *
+ * Every channel is given the same number of samples per call, so all of them complete a
+ * segment at the same time. Segments use a Hann window, and spectra are one-sided power
+ * spectral densities, in squared input units per Hz.
+ *
+ */
+class PLUGIN_API ShortTimeSpectrum
+{
+public:
+    ShortTimeSpectrum();
+    virtual ~ShortTimeSpectrum();
+
+    // Sets the number of channels, the segment length (a power of two), the number of samples
+    // between the starts of consecutive segments, and the sample rate. Every channel is cleared.
+    void setup(int numChannels, int segmentSize, int hopSize, double sampleRate);
+
+    int getNumChannels() const
+    {
+        return m_numChannels;
+    }
+
+    int getSegmentSize() const
+    {
+        return m_fft.getSize();
+    }
+
+    int getNumBins() const
+    {
+        return m_fft.getNumBins();
+    }
+
+    // Centre frequency of a bin, in Hz
+    double getBinFrequency(int bin) const;
+
+    // Clears the history of every channel
+    virtual void reset();
+
+    // Adds numSamples samples of every channel; channels whose pointer is null are taken as
+    // silent. Calls addSegment() for every segment completed.
+    void process(int numSamples, const float* const* channels);
+
+protected:
+    // Called with the spectral density of every channel of a completed segment, channel
+    // after channel, getNumBins() values each
+    virtual void addSegment(const float* spectra) = 0;
+
+private:
+    void computeSegment();
+
+    int m_numChannels;
+    int m_hopSize;
+    int m_position;                  // next sample written in the history of every channel
+    int m_untilNextSegment;          // samples left until the next segment is complete
+    double m_sampleRate;
+    std::vector<float> m_history;    // the last getSegmentSize() samples of each channel, as a ring
+    std::vector<float> m_window;
+    std::vector<float> m_segmentA;
+    std::vector<float> m_segmentB;
+    std::vector<float> m_spectra;
+    double m_scale;                  // from squared magnitude to one-sided density
+    RealFFT m_fft;
+};
+
+/*
+ * Averages the power spectral density of many channels with Welch's method.
+ *
+ * With averageLength at zero, every segment since the last reset() counts the same.
+ * Otherwise segments are averaged exponentially over about averageLength of them, so a
+ * live display follows changes in the signal.
+ *
+ */
+class PLUGIN_API WelchPSD : public ShortTimeSpectrum
+{
+public:
+    WelchPSD();
+
+    void setAverageLength(int averageLength);
+
+    void reset() override;
+
+    // Number of segments averaged so far
+    int getNumSegments() const
+    {
+        return m_numSegments;
+    }
+
+    // Averaged density of a channel, getNumBins() values, or null until a segment is complete
+    const float* getPSD(int channel) const;
+
+protected:
+    void addSegment(const float* spectra) override;
+
+private:
+    int m_averageLength;
+    int m_numSegments;
+    std::vector<float> m_average;
+};
+
+/*
+ * Keeps the most recent power spectral densities of many channels, one column per
+ * segment, in a ring of a fixed number of columns.
+ *
+ */
+class PLUGIN_API Spectrogram : public ShortTimeSpectrum
+{
+public:
+    Spectrogram();
+
+    // Sets the number of columns kept, and clears them
+    void setNumColumns(int numColumns);
+
+    int getNumColumns() const
+    {
+        return m_numColumns;
+    }
+
+    void reset() override;
+
+    // Total number of columns computed since the last reset(). The column computed
+    // age columns before the latest one is kept if age < min(getNumColumns(), this).
+    juce::int64 getNumColumnsComputed() const
+    {
+        return m_numComputed;
+    }
+
+    // Density of a channel in the column computed age columns before the latest one,
+    // getNumBins() values
+    const float* getColumn(int channel, int age) const;
+
+protected:
+    void addSegment(const float* spectra) override;
+
+private:
+    int m_numColumns;
+    juce::int64 m_numComputed;
+    std::vector<float> m_columns;    // column after column, all channels of each
+};
+
+}
+
+#endif
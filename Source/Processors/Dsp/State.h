@@ -48,10 +48,27 @@ namespace Dsp
  * Various forms of state information required to
  * process channels of actual sample data.
  *
+ * Besides process1(), which filters one sample, each form has a processBlock()
+ * that runs a whole block through the section with the state and coefficients
+ * held in locals of the Accumulator type, so cascades can be processed one stage
+ * at a time instead of one sample at a time. Instead of adding a very small
+ * amount to the input, processBlock() keeps denormals out of the state by
+ * flushing values that have decayed to almost nothing at the end of the block.
+ *
  */
 
 //------------------------------------------------------------------------------
 
+// State values below this are flushed to zero at the end of a block, long
+// before a decaying recursion could reach the denormal range
+template <typename Accumulator>
+inline Accumulator flushDenormal(const Accumulator v)
+{
+    return std::abs(v) < Accumulator(1e-30) ? Accumulator(0) : v;
+}
+
+//------------------------------------------------------------------------------
+
 /*
  * State for applying a second order section to a sample using Direct Form I
  *
@@ -92,6 +109,31 @@ public:
         return static_cast<Sample>(out);
     }
 
+    template <typename Accumulator, typename Sample>
+    void processBlock(int numSamples, Sample* samples, const BiquadBase& s)
+    {
+        const Accumulator b0 = Accumulator(s.m_b0), b1 = Accumulator(s.m_b1), b2 = Accumulator(s.m_b2);
+        const Accumulator a1 = Accumulator(s.m_a1), a2 = Accumulator(s.m_a2);
+        Accumulator x1 = Accumulator(m_x1), x2 = Accumulator(m_x2);
+        Accumulator y1 = Accumulator(m_y1), y2 = Accumulator(m_y2);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const Accumulator in = Accumulator(samples[i]);
+            const Accumulator out = b0*in + b1*x1 + b2*x2 - a1*y1 - a2*y2;
+            x2 = x1;
+            y2 = y1;
+            x1 = in;
+            y1 = out;
+            samples[i] = static_cast<Sample>(out);
+        }
+
+        m_x1 = flushDenormal(x1);
+        m_x2 = flushDenormal(x2);
+        m_y1 = flushDenormal(y1);
+        m_y2 = flushDenormal(y2);
+    }
+
 protected:
     double m_x2; // x[n-2]
     double m_y2; // y[n-2]
@@ -138,6 +180,25 @@ public:
         return static_cast<Sample>(out);
     }
 
+    template <typename Accumulator, typename Sample>
+    void processBlock(int numSamples, Sample* samples, const BiquadBase& s)
+    {
+        const Accumulator b0 = Accumulator(s.m_b0), b1 = Accumulator(s.m_b1), b2 = Accumulator(s.m_b2);
+        const Accumulator a1 = Accumulator(s.m_a1), a2 = Accumulator(s.m_a2);
+        Accumulator v1 = Accumulator(m_v1), v2 = Accumulator(m_v2);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const Accumulator w = Accumulator(samples[i]) - a1*v1 - a2*v2;
+            samples[i] = static_cast<Sample>(b0*w + b1*v1 + b2*v2);
+            v2 = v1;
+            v1 = w;
+        }
+
+        m_v1 = flushDenormal(v1);
+        m_v2 = flushDenormal(v2);
+    }
+
 private:
     double m_v1; // v[-1]
     double m_v2; // v[-2]
@@ -199,6 +260,13 @@ public:
         return static_cast<Sample>(out);
     }
 
+    template <typename Accumulator, typename Sample>
+    void processBlock(int numSamples, Sample* samples, const BiquadBase& s)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            samples[i] = process1(samples[i], s, 0.);
+    }
+
 private:
     double m_v;
     double m_s1;
@@ -245,6 +313,26 @@ public:
         return static_cast<Sample>(out);
     }
 
+    template <typename Accumulator, typename Sample>
+    void processBlock(int numSamples, Sample* samples, const BiquadBase& s)
+    {
+        const Accumulator b0 = Accumulator(s.m_b0), b1 = Accumulator(s.m_b1), b2 = Accumulator(s.m_b2);
+        const Accumulator a1 = Accumulator(s.m_a1), a2 = Accumulator(s.m_a2);
+        Accumulator s1 = Accumulator(m_s1_1), s2 = Accumulator(m_s2_1);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const Accumulator in = Accumulator(samples[i]);
+            const Accumulator out = s1 + b0*in;
+            s1 = s2 + b1*in - a1*out;
+            s2 = b2*in - a2*out;
+            samples[i] = static_cast<Sample>(out);
+        }
+
+        m_s1 = m_s1_1 = flushDenormal(s1);
+        m_s2 = m_s2_1 = flushDenormal(s2);
+    }
+
 private:
     double m_s1;
     double m_s1_1;
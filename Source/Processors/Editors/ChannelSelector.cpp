@@ -42,8 +42,11 @@ static const int DURATION_ANIMATION_COLLAPSE_MS = 200;
 
 ChannelSelector::ChannelSelector(bool createButtons, Font& titleFont_) :
     eventsOnly(false)
+    , parameterGrid (PARAMETER, titleFont_)
     , parameterSlicerChannelSelector (Channels::PARAM_CHANNELS,  "Parameter slicer channel selector component")
+    , audioGrid (AUDIO, titleFont_)
     , audioSlicerChannelSelector     (Channels::AUDIO_CHANNELS,  "Audio slicer channel selector component")
+    , recordGrid (RECORD, titleFont_)
     , recordSlicerChannelSelector    (Channels::RECORD_CHANNELS, "Record slicer channel selector component")
     , paramsToggled(true), paramsActive(true), recActive(true), radioStatus(false), isNotSink(createButtons)
     , moveRight(false), moveLeft(false), offsetLR(0), offsetUD(0), desiredOffset(0), titleFont(titleFont_), acquisitionIsActive(false)
@@ -80,29 +83,20 @@ ChannelSelector::ChannelSelector(bool createButtons, Font& titleFont_) :
     noneButton->addListener(this);
     addAndMakeVisible(noneButton);
 
-    // Buttons managers
+    // Channel grids
     // ====================================================================
-    addAndMakeVisible (audioButtonsManager);
-    addAndMakeVisible (recordButtonsManager);
-    addAndMakeVisible (parameterButtonsManager);
-
-    // Enable fast mode selection for buttons
-    audioButtonsManager.setFastSelectionModeEnabled     (true);
-    recordButtonsManager.setFastSelectionModeEnabled    (true);
-    parameterButtonsManager.setFastSelectionModeEnabled (true);
-
-    audioButtonsManager.setMinPaddingBetweenButtons     (0);
-    recordButtonsManager.setMinPaddingBetweenButtons    (0);
-    parameterButtonsManager.setMinPaddingBetweenButtons (0);
-
-    audioButtonsManager.setColour       (ButtonGroupManager::outlineColourId, Colour (0x0));
-    recordButtonsManager.setColour      (ButtonGroupManager::outlineColourId, Colour (0x0));
-    parameterButtonsManager.setColour   (ButtonGroupManager::outlineColourId, Colour (0x0));
-
-    // Register listeners for buttons
-    audioButtonsManager.setButtonListener      (this);
-    recordButtonsManager.setButtonListener     (this);
-    parameterButtonsManager.setButtonListener  (this);
+    addAndMakeVisible (audioGrid);
+    addAndMakeVisible (recordGrid);
+    addAndMakeVisible (parameterGrid);
+
+    // Enable fast mode selection for channels
+    audioGrid.setFastSelectionModeEnabled     (true);
+    recordGrid.setFastSelectionModeEnabled    (true);
+    parameterGrid.setFastSelectionModeEnabled (true);
+
+    audioGrid.setListener      (this);
+    recordGrid.setListener     (this);
+    parameterGrid.setListener  (this);
     // ====================================================================
 
     // Slicer channels selectors
@@ -133,13 +127,13 @@ ChannelSelector::ChannelSelector(bool createButtons, Font& titleFont_) :
 
 ChannelSelector::~ChannelSelector()
 {
-    // Just a temporary workaround as we don't want to delete these buttons managers by hands.
+    // Just a temporary workaround as we don't want to delete these channel grids by hands.
     // We will remove it after getting rid of the ugly calling of deleteAllChildren() method.
     // We should really use some RAII technuiqes to avoid calling this method.
     // TODO: refactor the code to follow RAII best principles and to avoid using raw pointers after merge with priyanjitdey94
-    removeChildComponent (&audioButtonsManager);
-    removeChildComponent (&recordButtonsManager);
-    removeChildComponent (&parameterButtonsManager);
+    removeChildComponent (&audioGrid);
+    removeChildComponent (&recordGrid);
+    removeChildComponent (&parameterGrid);
 
     removeChildComponent (&audioSlicerChannelSelector);
     removeChildComponent (&recordSlicerChannelSelector);
@@ -172,36 +166,24 @@ void ChannelSelector::paint(Graphics& g)
 
 void ChannelSelector::setNumChannels(int numChans)
 {
-    int difference = numChans - parameterButtonsManager.getNumButtons();
+    parameterGrid.setNumChannels (numChans, paramsToggled);
 
-    // std::cout << difference << " buttons needed." << std::endl;
-
-    if (difference > 0)
-    {
-        for (int n = 0; n < difference; n++)
-        {
-            addButton();
-        }
-    }
-    else if (difference < 0)
+    if (isNotSink)
     {
-        for (int n = 0; n < -difference; n++)
-        {
-            removeButton();
-        }
+        recordGrid.setNumChannels (numChans, false);
+        audioGrid.setNumChannels  (numChans, false);
     }
 
-    const int numButtons = parameterButtonsManager.getNumButtons();
     //Reassign numbers according to the actual channels (useful for channel mapper)
-    for (int n = 0; n < numButtons; ++n)
+    for (int n = 0; n < numChans; ++n)
     {
         int num = ( (GenericEditor*)getParentComponent())->getChannelDisplayNumber (n);
-        static_cast<ChannelSelectorButton*> (parameterButtonsManager.getButtonAt  (n))->setChannel (n + 1, num + 1);
+        parameterGrid.setDisplayNumber (n, num + 1);
 
         if (isNotSink)
         {
-            static_cast<ChannelSelectorButton*> (recordButtonsManager.getButtonAt (n))->setChannel (n + 1, num + 1);
-            static_cast<ChannelSelectorButton*> (audioButtonsManager.getButtonAt  (n))->setChannel (n + 1, num + 1);
+            recordGrid.setDisplayNumber (n, num + 1);
+            audioGrid.setDisplayNumber  (n, num + 1);
         }
     }
 
@@ -210,12 +192,12 @@ void ChannelSelector::setNumChannels(int numChans)
 
 int ChannelSelector::getNumChannels()
 {
-    return parameterButtonsManager.getNumButtons();
+    return parameterGrid.getNumChannels();
 }
 
 void ChannelSelector::shiftChannelsVertical(float amount)
 {
-    if (parameterButtonsManager.getNumButtons() > 16)
+    if (parameterGrid.getNumChannels() > 16)
     {
         offsetUD -= amount * 10;
         offsetUD = jmin(offsetUD, 0.0f);
@@ -232,9 +214,9 @@ void ChannelSelector::refreshButtonBoundaries()
     const int columnWidth   = getDesiredWidth() / (numColumnsGreaterThan100 + 1) + 1;
     const int rowHeight     = 14;
 
-    audioButtonsManager.setButtonSize      (columnWidth, rowHeight);
-    recordButtonsManager.setButtonSize     (columnWidth, rowHeight);
-    parameterButtonsManager.setButtonSize  (columnWidth, rowHeight);
+    audioGrid.setCellSize      (columnWidth, rowHeight);
+    recordGrid.setCellSize     (columnWidth, rowHeight);
+    parameterGrid.setCellSize  (columnWidth, rowHeight);
 
     const int xLoc = offsetLR + 3;
 
@@ -251,30 +233,30 @@ void ChannelSelector::refreshButtonBoundaries()
                                           .withY (audioSlicerChannelSelector.getY())
                                           .withHeight (audioSlicerChannelSelector.getHeight()));
 
-    // Set bounds for buttons managers
+    // Set bounds for channel grids
     // ===================================================================================================
     const int headerHeight              = 25;
     const int tabButtonHeight           = 15;
-    const int buttonsManagerWidth       = getDesiredWidth() - 6;
-    const int defaultButtonsManagerY    = headerHeight;
+    const int gridWidth                 = getDesiredWidth() - 6;
+    const int defaultGridY              = headerHeight;
 
     // We will use just some hacks to set initial y and height if height is zero,
-    // otherwise we will use the same bounds for buttons maangers
-    int buttonsManagerX = xLoc;
-    parameterButtonsManager.setBounds   (buttonsManagerX,
-                                         parameterButtonsManager.getHeight() == 0 ? defaultButtonsManagerY : parameterButtonsManager.getY(),
-                                         buttonsManagerWidth,
-                                         getHeight() - parameterButtonsManager.getY() - tabButtonHeight);
-    buttonsManagerX -= getDesiredWidth();
-    recordButtonsManager.setBounds      (buttonsManagerX,
-                                         recordButtonsManager.getHeight() == 0 ? defaultButtonsManagerY : recordButtonsManager.getY(),
-                                         buttonsManagerWidth,
-                                         getHeight() - recordButtonsManager.getY() - tabButtonHeight);
-    buttonsManagerX -= getDesiredWidth();
-    audioButtonsManager.setBounds       (buttonsManagerX,
-                                         audioButtonsManager.getHeight() == 0 ? defaultButtonsManagerY : audioButtonsManager.getY(),
-                                         buttonsManagerWidth,
-                                         getHeight() - audioButtonsManager.getY() - tabButtonHeight);
+    // otherwise we will use the same bounds for the grids
+    int gridX = xLoc;
+    parameterGrid.setBounds   (gridX,
+                               parameterGrid.getHeight() == 0 ? defaultGridY : parameterGrid.getY(),
+                               gridWidth,
+                               getHeight() - parameterGrid.getY() - tabButtonHeight);
+    gridX -= getDesiredWidth();
+    recordGrid.setBounds      (gridX,
+                               recordGrid.getHeight() == 0 ? defaultGridY : recordGrid.getY(),
+                               gridWidth,
+                               getHeight() - recordGrid.getY() - tabButtonHeight);
+    gridX -= getDesiredWidth();
+    audioGrid.setBounds       (gridX,
+                               audioGrid.getHeight() == 0 ? defaultGridY : audioGrid.getY(),
+                               gridWidth,
+                               getHeight() - audioGrid.getY() - tabButtonHeight);
     // ===================================================================================================
 
     /*
@@ -322,54 +304,16 @@ void ChannelSelector::timerCallback()
     refreshButtonBoundaries();
 }
 
-void ChannelSelector::addButton()
-{
-    const int size = parameterButtonsManager.getNumButtons();
-
-    ChannelSelectorButton* b = new ChannelSelectorButton (size + 1, PARAMETER, titleFont);
-    parameterButtonsManager.addButton (b);
-
-    if (paramsToggled)
-        b->setToggleState(true, dontSendNotification);
-    else
-        b->setToggleState(false, dontSendNotification);
-
-    if (!paramsActive)
-        b->setActive(false);
-
-    if (isNotSink)
-    {
-        ChannelSelectorButton* br = new ChannelSelectorButton(size + 1, RECORD, titleFont);
-        recordButtonsManager.addButton (br);
-
-        ChannelSelectorButton* ba = new ChannelSelectorButton(size + 1, AUDIO, titleFont);
-        audioButtonsManager.addButton (ba);
-    }
-}
-
-void ChannelSelector::removeButton()
-{
-    int size = parameterButtonsManager.getNumButtons();
-
-    parameterButtonsManager.removeButton (size - 1);
-
-    if (isNotSink)
-    {
-        recordButtonsManager.removeButton (size - 1);
-        audioButtonsManager.removeButton  (size - 1);
-    }
-}
-
 Array<int> ChannelSelector::getActiveChannels()
 {
     Array<int> a;
 
     if (! eventsOnly)
     {
-        const int numButtons = parameterButtonsManager.getNumButtons();
-        for (int i = 0; i < numButtons; ++i)
+        const int numChannels = parameterGrid.getNumChannels();
+        for (int i = 0; i < numChannels; ++i)
         {
-            if (parameterButtonsManager.getButtonAt (i)->getToggleState())
+            if (parameterGrid.getState (i))
                 a.add (i);
         }
     }
@@ -385,17 +329,17 @@ void ChannelSelector::setActiveChannels(Array<int> a)
 {
     //std::cout << "Setting active channels!" << std::endl;
 
-    const int numButtons = parameterButtonsManager.getNumButtons();
-    for (int i = 0; i < numButtons; ++i)
+    const int numChannels = parameterGrid.getNumChannels();
+    for (int i = 0; i < numChannels; ++i)
     {
-        parameterButtonsManager.getButtonAt (i)->setToggleState (false, dontSendNotification);
+        parameterGrid.setState (i, false, dontSendNotification);
     }
 
     for (int i = 0; i < a.size(); i++)
     {
-        if (a[i] < numButtons)
+        if (a[i] < numChannels)
         {
-            parameterButtonsManager.getButtonAt (a[i])->setToggleState (true, dontSendNotification);
+            parameterGrid.setState (a[i], true, dontSendNotification);
         }
     }
 }
@@ -403,53 +347,25 @@ void ChannelSelector::setActiveChannels(Array<int> a)
 void ChannelSelector::inactivateButtons()
 {
     paramsActive = false;
-
-    const int numButtons = parameterButtonsManager.getNumButtons();
-    for (int i = 0; i < numButtons; ++i)
-    {
-        const auto& button = static_cast<ChannelSelectorButton*> (parameterButtonsManager.getButtonAt (i));
-        button->setActive (false);
-        button->repaint();
-    }
+    parameterGrid.setActive (false);
 }
 
 void ChannelSelector::activateButtons()
 {
     paramsActive = true;
-
-    const int numButtons = parameterButtonsManager.getNumButtons();
-    for (int i = 0; i < numButtons; ++i)
-    {
-        const auto& button = static_cast<ChannelSelectorButton*> (parameterButtonsManager.getButtonAt (i));
-        button->setActive (true);
-        button->repaint();
-    }
+    parameterGrid.setActive (true);
 }
 
 void ChannelSelector::inactivateRecButtons()
 {
     recActive = false;
-
-    const int numButtons = recordButtonsManager.getNumButtons();
-    for (int i = 0; i < numButtons; ++i)
-    {
-        const auto& button = static_cast<ChannelSelectorButton*> (recordButtonsManager.getButtonAt (i));
-        button->setActive (false);
-        button->repaint();
-    }
+    recordGrid.setActive (false);
 }
 
 void ChannelSelector::activateRecButtons()
 {
     recActive = true;
-
-    const int numButtons = recordButtonsManager.getNumButtons();
-    for (int i = 0; i < numButtons; ++i)
-    {
-        const auto& button = static_cast<ChannelSelectorButton*> (recordButtonsManager.getButtonAt (i));
-        button->setActive (true);
-        button->repaint();
-    }
+    recordGrid.setActive (true);
 }
 
 void ChannelSelector::refreshParameterColors()
@@ -479,63 +395,51 @@ void ChannelSelector::setRadioStatus(bool radioOn)
     {
         radioStatus = radioOn;
 
-        const int numButtons = parameterButtonsManager.getNumButtons();
-        for (int i = 0; i < numButtons; ++i)
+        const int numChannels = parameterGrid.getNumChannels();
+        for (int i = 0; i < numChannels; ++i)
         {
-            parameterButtonsManager.getButtonAt (i)->setToggleState (false, dontSendNotification);
+            parameterGrid.setState (i, false, dontSendNotification);
         }
 
-        parameterButtonsManager.setRadioButtonMode (radioStatus);
+        parameterGrid.setRadioMode (radioStatus);
     }
 }
 
 bool ChannelSelector::getParamStatus(int chan)
 {
-    if (chan >= 0 && chan < parameterButtonsManager.getNumButtons())
-        return parameterButtonsManager.getButtonAt (chan)->getToggleState();
-    else
-        return false;
+    return parameterGrid.getState (chan);
 }
 
 bool ChannelSelector::getRecordStatus(int chan)
 {
-    if (chan >= 0 && chan < recordButtonsManager.getNumButtons())
-        return recordButtonsManager.getButtonAt (chan)->getToggleState();
-    else
-        return false;
+    return recordGrid.getState (chan);
 }
 
 bool ChannelSelector::getAudioStatus(int chan)
 {
-    if (chan >= 0 && chan < audioButtonsManager.getNumButtons())
-        return audioButtonsManager.getButtonAt (chan)->getToggleState();
-    else
-        return false;
+    return audioGrid.getState (chan);
 }
 
 void ChannelSelector::setParamStatus(int chan, bool b)
 {
-    if (chan >= 0 && chan < parameterButtonsManager.getNumButtons())
-        parameterButtonsManager.getButtonAt (chan)->setToggleState(b, sendNotification);
+    parameterGrid.setState (chan, b, sendNotification);
 }
 
 void ChannelSelector::setRecordStatus(int chan, bool b)
 {
-    if (chan >= 0 && chan < recordButtonsManager.getNumButtons())
-        recordButtonsManager.getButtonAt (chan)->setToggleState(b, sendNotification);
+    recordGrid.setState (chan, b, sendNotification);
 }
 
 void ChannelSelector::setAudioStatus(int chan, bool b)
 {
-    if (chan >= 0 && chan < audioButtonsManager.getNumButtons())
-        audioButtonsManager.getButtonAt (chan)->setToggleState (b, sendNotification);
+    audioGrid.setState (chan, b, sendNotification);
 }
 
 void ChannelSelector::clearAudio()
 {
-    const int numButtons = audioButtonsManager.getNumButtons();
-    for (int chan = 0; chan < numButtons; ++chan)
-        audioButtonsManager.getButtonAt (chan)->setToggleState (false, sendNotification);
+    const int numChannels = audioGrid.getNumChannels();
+    for (int chan = 0; chan < numChannels; ++chan)
+        audioGrid.setState (chan, false, sendNotification);
 }
 
 int ChannelSelector::getDesiredWidth()
@@ -591,17 +495,17 @@ void ChannelSelector::buttonClicked(Button* button)
         // select all active buttons
         if (offsetLR == recordOffset)
         {
-            for (int i = 0; i < recordButtonsManager.getNumButtons(); ++i)
+            for (int i = 0; i < recordGrid.getNumChannels(); ++i)
             {
-                recordButtonsManager.getButtonAt (i)->setToggleState (true, sendNotification);
+                recordGrid.setState (i, true, sendNotification);
             }
 
         }
         else if (offsetLR == parameterOffset)
         {
-            for (int i = 0; i < parameterButtonsManager.getNumButtons(); ++i)
+            for (int i = 0; i < parameterGrid.getNumChannels(); ++i)
             {
-                parameterButtonsManager.getButtonAt (i)->setToggleState (true, sendNotification);
+                parameterGrid.setState (i, true, sendNotification);
             }
         }
         else if (offsetLR == audioOffset)
@@ -614,23 +518,23 @@ void ChannelSelector::buttonClicked(Button* button)
         // deselect all active buttons
         if (offsetLR == recordOffset)
         {
-            for (int i = 0; i < recordButtonsManager.getNumButtons(); ++i)
+            for (int i = 0; i < recordGrid.getNumChannels(); ++i)
             {
-                recordButtonsManager.getButtonAt (i)->setToggleState (false, sendNotification);
+                recordGrid.setState (i, false, sendNotification);
             }
         }
         else if (offsetLR == parameterOffset)
         {
-            for (int i = 0; i < parameterButtonsManager.getNumButtons(); ++i)
+            for (int i = 0; i < parameterGrid.getNumChannels(); ++i)
             {
-                parameterButtonsManager.getButtonAt (i)->setToggleState (false, sendNotification);
+                parameterGrid.setState (i, false, sendNotification);
             }
         }
         else if (offsetLR == audioOffset)
         {
-            for (int i = 0; i < audioButtonsManager.getNumButtons(); ++i)
+            for (int i = 0; i < audioGrid.getNumChannels(); ++i)
             {
-                audioButtonsManager.getButtonAt (i)->setToggleState (false, sendNotification);
+                audioGrid.setState (i, false, sendNotification);
             }
         }
 
@@ -641,99 +545,101 @@ void ChannelSelector::buttonClicked(Button* button)
             editor->channelChanged (-1, false);
         }
     }
-    else
+    refreshParameterColors();
+}
+
+void ChannelSelector::channelSelectorGridChanged (ChannelSelectorGrid* grid, int channel)
+{
+    const bool status = grid->getState (channel);
+
+    if (grid->getType() == AUDIO)
     {
-        ChannelSelectorButton* b = (ChannelSelectorButton*)button;
+        // get audio node, and inform it of the change
+        GenericEditor* editor = (GenericEditor*)getParentComponent();
+
+        const DataChannel* ch = editor->getChannel(channel);
+
+     //   std::cout << "Requesting audio monitor for channel " << ch->nodeIndex + 1 << std::endl;
+
+        // change parameter directly on editor
+        //     This is another of those ugly things that will go away once the
+        //     probe audio system is implemented, but is needed to maintain compatibility
+        //     between the older recording system and the newer channel objects.
+        const_cast<DataChannel*>(ch)->setMonitored(status);
+
 
-        if (b->getType() == AUDIO)
+        if (acquisitionIsActive) // use setParameter to change audio node's copy of parameter safely, if running
         {
-            // get audio node, and inform it of the change
-            GenericEditor* editor = (GenericEditor*)getParentComponent();
-
-            const DataChannel* ch = editor->getChannel(b->getChannel() - 1);
-            //int channelNum = editor->getStartChannel() + b->getChannel() - 1;
-            bool status = b->getToggleState();
-
-         //   std::cout << "Requesting audio monitor for channel " << ch->nodeIndex + 1 << std::endl;
-            
-            // change parameter directly on editor
-            //     This is another of those ugly things that will go away once the
-            //     probe audio system is implemented, but is needed to maintain compatibility
-            //     between the older recording system and the newer channel objects.
-            const_cast<DataChannel*>(ch)->setMonitored(status);
-
-            
-            if (acquisitionIsActive) // use setParameter to change audio node's copy of parameter safely, if running
-            {
-                AccessClass::getProcessorGraph()->
-                getAudioNode()->setChannelStatus(ch, status);
-            }
+            AccessClass::getProcessorGraph()->
+            getAudioNode()->setChannelStatus(ch, status);
         }
-        else if (b->getType() == RECORD)
-        {
-			
-            // get record node, and inform it of the change
-            GenericEditor* editor = (GenericEditor*)getParentComponent();
+    }
+    else if (grid->getType() == RECORD)
+    {
 
-            const DataChannel* ch = editor->getChannel(b->getChannel() - 1);
-            //int channelNum = editor->getStartChannel() + b->getChannel() - 1;
-            bool status = b->getToggleState();
+        // get record node, and inform it of the change
+        GenericEditor* editor = (GenericEditor*)getParentComponent();
 
-            if (acquisitionIsActive) // use setParameter to change parameter safely
-            {
-                               
-                // disable toggling when acquisition is active
-                b->setToggleState(const_cast<DataChannel*>(ch)->getRecordState(), dontSendNotification);
-            }
-            else     // change parameter directly
-            {
-                //std::cout << "Setting record status for channel " << b->getChannel() << std::endl;
-
-				//This is another of those ugly things that will go away once the
-				//probe recording system is implemented, but is needed to maintain compatibility
-				//between the older recording system and the newer channel objects.
-                const_cast<DataChannel*>(ch)->setRecordState(status);
-            }
+        const DataChannel* ch = editor->getChannel(channel);
 
-            AccessClass::getGraphViewer()->repaint();
+        if (acquisitionIsActive) // use setParameter to change parameter safely
+        {
 
+            // disable toggling when acquisition is active
+            grid->setState(channel, const_cast<DataChannel*>(ch)->getRecordState(), dontSendNotification);
         }
-        else // parameter type
+        else     // change parameter directly
         {
-            GenericEditor* editor = (GenericEditor*) getParentComponent();
-            editor->channelChanged (b->getChannel() - 1, b->getToggleState());
+            //std::cout << "Setting record status for channel " << channel + 1 << std::endl;
 
-            // do nothing
-            if (radioStatus) // if radio buttons are active
-            {
-                // send a message to parent
-                GenericEditor* editor = (GenericEditor*) getParentComponent();
-                editor->channelChanged (b->getChannel(), b->getToggleState());
-            }
+            //This is another of those ugly things that will go away once the
+            //probe recording system is implemented, but is needed to maintain compatibility
+            //between the older recording system and the newer channel objects.
+            const_cast<DataChannel*>(ch)->setRecordState(status);
         }
 
+        AccessClass::getGraphViewer()->repaint();
+
+    }
+    else // parameter type
+    {
+        GenericEditor* editor = (GenericEditor*) getParentComponent();
+        editor->channelChanged (channel, status);
+
+        // do nothing
+        if (radioStatus) // if radio buttons are active
+        {
+            // send a message to parent
+            editor->channelChanged (channel + 1, status);
+        }
     }
+
     refreshParameterColors();
 }
 
 
-void ChannelSelector::changeChannelsSelectionButtonClicked (SlicerChannelSelectorComponent* sender,
-                                                            Button* buttonThatWasClicked,
-                                                            bool isSelect)
+ChannelSelectorGrid* ChannelSelector::getGrid (Channels::ChannelsType channelsType)
 {
-    const Channels::ChannelsType channelsType = sender->getChannelsType();
-
-    TiledButtonGroupManager* buttonsManager = nullptr;
     if (channelsType == Channels::AUDIO_CHANNELS)
-        buttonsManager = &audioButtonsManager;
+        return &audioGrid;
     else if (channelsType == Channels::RECORD_CHANNELS)
-        buttonsManager = &recordButtonsManager;
+        return &recordGrid;
     else if (channelsType == Channels::PARAM_CHANNELS)
-        buttonsManager = &parameterButtonsManager;
+        return &parameterGrid;
+
+    return nullptr;
+}
 
-    jassert (buttonsManager != nullptr);
 
-    Array<int> getBoxList = ListSliceParser::parseStringIntoRange (sender->getText(), audioButtonsManager.getNumButtons());
+void ChannelSelector::changeChannelsSelectionButtonClicked (SlicerChannelSelectorComponent* sender,
+                                                            Button* buttonThatWasClicked,
+                                                            bool isSelect)
+{
+    ChannelSelectorGrid* grid = getGrid (sender->getChannelsType());
+
+    jassert (grid != nullptr);
+
+    Array<int> getBoxList = ListSliceParser::parseStringIntoRange (sender->getText(), grid->getNumChannels());
     if (getBoxList.size() < 3)
         return;
 
@@ -744,7 +650,7 @@ void ChannelSelector::changeChannelsSelectionButtonClicked (SlicerChannelSelecto
         const int comd = getBoxList[i + 2];
         for (int fa = getBoxList[i]; fa <= lim; fa += comd)
         {
-            buttonsManager->getButtonAt (fa)->setToggleState (isSelect, sendNotification);
+            grid->setState (fa, isSelect, sendNotification);
         }
         i += 3;
     }
@@ -754,17 +660,9 @@ void ChannelSelector::changeChannelsSelectionButtonClicked (SlicerChannelSelecto
 void ChannelSelector::channelSelectorCollapsedStateChanged (SlicerChannelSelectorComponent* sender,
                                                             bool isCollapsed)
 {
-    const Channels::ChannelsType channelsType = sender->getChannelsType();
+    ChannelSelectorGrid* grid = getGrid (sender->getChannelsType());
 
-    TiledButtonGroupManager* buttonsManager = nullptr;
-    if (channelsType == Channels::AUDIO_CHANNELS)
-        buttonsManager = &audioButtonsManager;
-    else if (channelsType == Channels::RECORD_CHANNELS)
-        buttonsManager = &recordButtonsManager;
-    else if (channelsType == Channels::PARAM_CHANNELS)
-        buttonsManager = &parameterButtonsManager;
-
-    jassert (buttonsManager != nullptr);
+    jassert (grid != nullptr);
 
     const int headerHeight      = 25;
     const int tabButtonHeight   = 15;
@@ -774,10 +672,10 @@ void ChannelSelector::channelSelectorCollapsedStateChanged (SlicerChannelSelecto
         yPos += SlicerChannelSelectorComponent::MAX_HEIGHT - 20;
 
     const int height = getHeight() - yPos - tabButtonHeight;
-    const juce::Rectangle<int> finalBounds (buttonsManager->getX(), yPos, buttonsManager->getWidth(), height);
+    const juce::Rectangle<int> finalBounds (grid->getX(), yPos, grid->getWidth(), height);
 
     auto& componentAnimator = Desktop::getInstance().getAnimator();
-    componentAnimator.animateComponent (buttonsManager, finalBounds, 1.f, DURATION_ANIMATION_COLLAPSE_MS, false, 1.0, 1.0);
+    componentAnimator.animateComponent (grid, finalBounds, 1.f, DURATION_ANIMATION_COLLAPSE_MS, false, 1.0, 1.0);
 }
 
 ///////////// BUTTONS //////////////////////
@@ -979,75 +877,346 @@ void EditorButton::paintButton(Graphics& g, bool isMouseOver, bool isButtonDown)
 }
 
 
-ChannelSelectorButton::ChannelSelectorButton(int num_, int type_, Font& f) : Button("name")
+ChannelSelectorGrid::ChannelSelectorGrid (int type_, Font& font)
+    : type                  (type_)
+    , cellFont              (font)
+    , listener              (nullptr)
+    , isActive              (true)
+    , isRadioMode           (false)
+    , isFastSelectionMode   (false)
+    , cellWidth             (10)
+    , cellHeight            (10)
+    , numColumns            (1)
+    , padding               (0)
+    , scrollY               (0)
+    , hoverChannel          (-1)
+    , dragStartChannel      (-1)
+    , lastDragChannel       (-1)
+    , isDragging            (false)
 {
-    isActive = true;
-    num = num_;
-    displayNum = num_;
-    type = type_;
+    cellFont.setHeight (11);
+}
 
-    setClickingTogglesState(true);
 
-    buttonFont = f;
-    buttonFont.setHeight (11);
+void ChannelSelectorGrid::setListener (Listener* newListener)
+{
+    listener = newListener;
 }
 
-ChannelSelectorButton::~ChannelSelectorButton() {}
 
-int ChannelSelectorButton::getType()
+int ChannelSelectorGrid::getType() const
 {
     return type;
 }
 
-int ChannelSelectorButton::getChannel()
+
+void ChannelSelectorGrid::setNumChannels (int numChannels, bool stateOfNewChannels)
 {
-    return num;
+    const int oldNumChannels = states.size();
+
+    if (numChannels < oldNumChannels)
+    {
+        states.removeLast (oldNumChannels - numChannels);
+        displayNumbers.removeLast (oldNumChannels - numChannels);
+    }
+    else
+    {
+        states.ensureStorageAllocated (numChannels);
+        displayNumbers.ensureStorageAllocated (numChannels);
+
+        for (int i = oldNumChannels; i < numChannels; ++i)
+        {
+            states.add (stateOfNewChannels);
+            displayNumbers.add (i + 1);
+        }
+    }
+
+    if (hoverChannel >= numChannels)
+        hoverChannel = -1;
+
+    updateLayout();
 }
 
-void ChannelSelectorButton::setChannel(int n)
+
+int ChannelSelectorGrid::getNumChannels() const
+{
+    return states.size();
+}
+
+
+void ChannelSelectorGrid::setDisplayNumber (int channel, int displayNumber)
 {
-    num = n;
-    displayNum = n;
+    if (channel >= 0 && channel < displayNumbers.size() && displayNumbers[channel] != displayNumber)
+    {
+        displayNumbers.set (channel, displayNumber);
+        repaintChannel (channel);
+    }
 }
-void ChannelSelectorButton::setChannel(int n, int d)
+
+
+bool ChannelSelectorGrid::getState (int channel) const
 {
-    num = n;
-    displayNum = d;
+    return states[channel];
 }
 
-void ChannelSelectorButton::paintButton(Graphics& g, bool isMouseOver, bool isButtonDown)
+
+void ChannelSelectorGrid::setState (int channel, bool state, NotificationType notification)
 {
-    if (isActive)
+    if (channel < 0 || channel >= states.size() || states[channel] == state)
+        return;
+
+    // like a radio group: selecting one channel deselects the one that was selected
+    if (isRadioMode && state)
     {
-        if (getToggleState() == true)
-            g.setColour(Colours::orange);
+        for (int i = 0; i < states.size(); ++i)
+        {
+            if (i != channel && states[i])
+                setState (i, false, notification);
+        }
+    }
+
+    states.set (channel, state);
+    repaintChannel (channel);
+
+    if (notification != dontSendNotification && listener != nullptr)
+        listener->channelSelectorGridChanged (this, channel);
+}
+
+
+void ChannelSelectorGrid::setActive (bool shouldBeActive)
+{
+    isActive = shouldBeActive;
+    repaint();
+}
+
+
+void ChannelSelectorGrid::setRadioMode (bool shouldBeRadioMode)
+{
+    isRadioMode = shouldBeRadioMode;
+}
+
+
+void ChannelSelectorGrid::setFastSelectionModeEnabled (bool shouldUseFastSelection)
+{
+    isFastSelectionMode = shouldUseFastSelection;
+}
+
+
+void ChannelSelectorGrid::setCellSize (int newCellWidth, int newCellHeight)
+{
+    if (cellWidth == newCellWidth && cellHeight == newCellHeight)
+        return;
+
+    cellWidth  = newCellWidth;
+    cellHeight = newCellHeight;
+
+    updateLayout();
+}
+
+
+void ChannelSelectorGrid::resized()
+{
+    updateLayout();
+}
+
+
+void ChannelSelectorGrid::updateLayout()
+{
+    const int width = getWidth();
+
+    numColumns = jmax (1, width / cellWidth);
+    padding = jmax (0, (width - numColumns * cellWidth) / jmax (numColumns - 1, 1));
+
+    const int numRows = (states.size() + numColumns - 1) / numColumns;
+    const int contentHeight = numRows * (cellHeight + padding);
+    scrollY = jlimit (0, jmax (0, contentHeight - getHeight()), scrollY);
+
+    repaint();
+}
+
+
+juce::Rectangle<int> ChannelSelectorGrid::getCellBounds (int channel) const
+{
+    const int row    = channel / numColumns;
+    const int column = channel % numColumns;
+
+    return juce::Rectangle<int> (column * (cellWidth + padding), row * (cellHeight + padding) - scrollY,
+                                 cellWidth, cellHeight);
+}
+
+
+int ChannelSelectorGrid::getChannelAt (Point<int> position) const
+{
+    if (position.x < 0 || position.x >= getWidth() || position.y < 0 || position.y >= getHeight())
+        return -1;
+
+    const int column = position.x / (cellWidth + padding);
+    const int row    = (position.y + scrollY) / (cellHeight + padding);
+
+    // the padding between cells belongs to no channel
+    if (column >= numColumns
+        || position.x - column * (cellWidth + padding) >= cellWidth
+        || position.y + scrollY - row * (cellHeight + padding) >= cellHeight)
+        return -1;
+
+    const int channel = row * numColumns + column;
+
+    return channel < states.size() ? channel : -1;
+}
+
+
+void ChannelSelectorGrid::repaintChannel (int channel)
+{
+    if (channel >= 0)
+        repaint (getCellBounds (channel));
+}
+
+
+void ChannelSelectorGrid::paint (Graphics& g)
+{
+    const int numChannels = states.size();
+    if (numChannels == 0)
+        return;
+
+    // only the rows that need repainting are drawn
+    const juce::Rectangle<int> clip = g.getClipBounds();
+    const int rowHeight = cellHeight + padding;
+    const int firstRow  = jmax (0, (clip.getY() + scrollY) / rowHeight);
+    const int lastRow   = (clip.getBottom() + scrollY) / rowHeight;
+
+    const int firstChannel = firstRow * numColumns;
+    const int lastChannel  = jmin (numChannels - 1, (lastRow + 1) * numColumns - 1);
+
+    g.setFont (cellFont);
+
+    for (int channel = firstChannel; channel <= lastChannel; ++channel)
+    {
+        if (isActive)
+        {
+            if (states.getUnchecked (channel))
+                g.setColour (Colours::orange);
+            else
+                g.setColour (Colours::darkgrey);
+
+            if (channel == hoverChannel)
+                g.setColour (Colours::white);
+        }
         else
-            g.setColour(Colours::darkgrey);
+        {
+            if (states.getUnchecked (channel))
+                g.setColour (Colours::yellow);
+            else
+                g.setColour (Colours::lightgrey);
+        }
 
-        if (isMouseOver)
-            g.setColour(Colours::white);
+        g.drawText (String (displayNumbers.getUnchecked (channel)), getCellBounds (channel), Justification::centred, true);
     }
-    else
+}
+
+
+void ChannelSelectorGrid::mouseMove (const MouseEvent& e)
+{
+    const int channel = getChannelAt (e.getPosition());
+
+    if (channel != hoverChannel)
     {
-        if (getToggleState() == true)
-            g.setColour(Colours::yellow);
-        else
-            g.setColour(Colours::lightgrey);
+        repaintChannel (hoverChannel);
+        hoverChannel = channel;
+        repaintChannel (hoverChannel);
     }
+}
 
-    // g.fillRect(0,0,getWidth(),getHeight());
 
-    g.setFont(buttonFont);
+void ChannelSelectorGrid::mouseExit (const MouseEvent& e)
+{
+    repaintChannel (hoverChannel);
+    hoverChannel = -1;
+}
 
-    // g.drawRect(0,0,getWidth(),getHeight(),1.0);
 
-    g.drawText(String(displayNum), 0, 0, getWidth(), getHeight(), Justification::centred, true);
+void ChannelSelectorGrid::mouseDown (const MouseEvent& e)
+{
+    dragStartChannel = getChannelAt (e.getPosition());
+    lastDragChannel  = dragStartChannel;
+    isDragging = false;
 }
 
-void ChannelSelectorButton::setActive(bool t)
+
+void ChannelSelectorGrid::mouseDrag (const MouseEvent& e)
 {
-    isActive = t;
-    setClickingTogglesState(t);
+    if (! isFastSelectionMode || isRadioMode || ! isActive)
+        return;
+
+    const int channel = getChannelAt (e.getPosition());
+
+    if (channel == -1 || channel == lastDragChannel)
+        return;
+
+    // starting outside any channel, the range starts at the first one reached
+    if (dragStartChannel == -1)
+        dragStartChannel = channel;
+
+    isDragging = true;
+    lastDragChannel = channel;
+
+    // drag to select, shift + drag to deselect
+    const bool state = ! e.mods.isShiftDown();
+
+    const int fromChannel = jmin (dragStartChannel, lastDragChannel);
+    const int toChannel   = jmax (dragStartChannel, lastDragChannel);
+
+    for (int i = fromChannel; i <= toChannel; ++i)
+        setState (i, state, sendNotification);
+}
+
+
+void ChannelSelectorGrid::mouseUp (const MouseEvent& e)
+{
+    const int channel = getChannelAt (e.getPosition());
+
+    if (! isDragging && channel != -1 && channel == dragStartChannel)
+        channelClicked (channel);
+
+    isDragging = false;
+    dragStartChannel = -1;
+    lastDragChannel  = -1;
+}
+
+
+void ChannelSelectorGrid::channelClicked (int channel)
+{
+    // inactive channels don't toggle, but the click is still reported
+    if (! isActive || (isRadioMode && states[channel]))
+    {
+        if (listener != nullptr)
+            listener->channelSelectorGridChanged (this, channel);
+    }
+    else
+    {
+        setState (channel, ! states[channel], sendNotification);
+    }
+}
+
+
+void ChannelSelectorGrid::mouseWheelMove (const MouseEvent& e, const MouseWheelDetails& wheel)
+{
+    const int numRows = (states.size() + numColumns - 1) / numColumns;
+    const int maxScroll = jmax (0, numRows * (cellHeight + padding) - getHeight());
+
+    if (maxScroll == 0)
+    {
+        Component::mouseWheelMove (e, wheel);
+        return;
+    }
+
+    const int newScrollY = jlimit (0, maxScroll, scrollY - roundToInt (wheel.deltaY * 4 * (cellHeight + padding)));
+
+    if (newScrollY != scrollY)
+    {
+        scrollY = newScrollY;
+        hoverChannel = getChannelAt (e.getPosition());
+        repaint();
+    }
 }
 
 
@@ -26,13 +26,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "../../../JuceLibraryCode/JuceHeader.h"
 #include "../Editors/GenericEditor.h"
-#include "../../UI/Utils/TiledButtonGroupManager.h"
 #include "../Channel/InfoObjects.h"
 
 #include <stdio.h>
 
 class ChannelSelectorRegion;
-class ChannelSelectorButton;
 class EditorButton;
 class ChannelSelectorBox;
 class ShowAlertMessage;
@@ -115,6 +113,97 @@ private:
 };
 
 
+/**
+    The channels of one ChannelSelector tab, drawn as a grid of channel numbers.
+
+    The grid is a single component that paints the rows in view and finds the
+    channel under the mouse itself, so an editor with thousands of channels
+    costs one component per tab rather than one button per channel.
+
+    Clicking a channel toggles it. Dragging selects a range of channels, and
+    shift+drag deselects it. In radio mode at most one channel is selected.
+*/
+class ChannelSelectorGrid : public Component
+{
+public:
+    ChannelSelectorGrid (int type, Font& font);
+
+    class Listener
+    {
+    public:
+        virtual ~Listener() {}
+        /** Called when a channel is clicked, or its state is changed with sendNotification */
+        virtual void channelSelectorGridChanged (ChannelSelectorGrid* grid, int channel) = 0;
+    };
+
+    void setListener (Listener* listener);
+
+    /** One of the ChannelSelector tab types */
+    int getType() const;
+
+    /** Adds or removes channels at the end; added channels take the given state */
+    void setNumChannels (int numChannels, bool stateOfNewChannels);
+    int getNumChannels() const;
+
+    /** Sets the number shown for a channel, e.g. after a channel map */
+    void setDisplayNumber (int channel, int displayNumber);
+
+    bool getState (int channel) const;
+    void setState (int channel, bool state, NotificationType notification);
+
+    /** Inactive channels are drawn greyed out and are not toggled by clicks */
+    void setActive (bool isActive);
+
+    void setRadioMode (bool isRadioMode);
+    void setFastSelectionModeEnabled (bool isFastSelectionMode);
+
+    void setCellSize (int cellWidth, int cellHeight);
+
+    void paint (Graphics& g) override;
+    void resized() override;
+
+    void mouseMove (const MouseEvent& e) override;
+    void mouseExit (const MouseEvent& e) override;
+    void mouseDown (const MouseEvent& e) override;
+    void mouseDrag (const MouseEvent& e) override;
+    void mouseUp   (const MouseEvent& e) override;
+    void mouseWheelMove (const MouseEvent& e, const MouseWheelDetails& wheel) override;
+
+private:
+    /** Index of the channel at a position in the component, or -1 */
+    int getChannelAt (Point<int> position) const;
+    juce::Rectangle<int> getCellBounds (int channel) const;
+    void repaintChannel (int channel);
+    void updateLayout();
+
+    void channelClicked (int channel);
+
+    const int type;
+    Font cellFont;
+    Listener* listener;
+
+    Array<bool> states;
+    Array<int> displayNumbers;
+
+    bool isActive;
+    bool isRadioMode;
+    bool isFastSelectionMode;
+
+    int cellWidth;
+    int cellHeight;
+    int numColumns;
+    int padding;
+    int scrollY;
+
+    int hoverChannel;
+    int dragStartChannel;
+    int lastDragChannel;
+    bool isDragging;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChannelSelectorGrid)
+};
+
+
 /**
 Automatically creates an interactive editor for selecting channels.
 
@@ -127,6 +216,7 @@ channels to be selected for different purposes.
 class PLUGIN_API ChannelSelector : public Component
                                  , public Button::Listener
                                  , private SlicerChannelSelectorComponent::Listener
+                                 , private ChannelSelectorGrid::Listener
                                  , public Timer
 {
 public:
@@ -181,22 +271,22 @@ public:
     /** Called immediately after data acquisition ends.*/
     void stopAcquisition();
 
-    /** Inactivates all the ChannelSelectorButtons under the "param" tab.*/
+    /** Inactivates all the channels under the "param" tab.*/
     void inactivateButtons();
 
-    /** Activates all the ChannelSelectorButtons under the "param" tab.*/
+    /** Activates all the channels under the "param" tab.*/
     void activateButtons();
 
-    /** Inactivates all the ChannelSelectorButtons under the "rec" tab.*/
+    /** Inactivates all the channels under the "rec" tab.*/
     void inactivateRecButtons();
 
-    /** Activates all the ChannelSelectorButtons under the "rec" tab.*/
+    /** Activates all the channels under the "rec" tab.*/
     void activateRecButtons();
 
     /** Refreshes Parameter Colors on change*/
     void refreshParameterColors();
 
-    /** Controls the behavior of ChannelSelectorButtons; they can either behave
+    /** Controls the behavior of the channels; they can either behave
     like radio buttons (only one selected at a time) or like toggle buttons (an
     arbitrary number can be selected at once).*/
     void setRadioStatus(bool);
@@ -216,25 +306,22 @@ private:
     EditorButton* allButton;
     EditorButton* noneButton;
 
-    /** An array of ChannelSelectorButtons used to select the channels that
-    will be updated when a parameter is changed.
+    /** The channels that will be updated when a parameter is changed.
     paramBox: TextBox where user input is taken for param tab.
     */
-    TiledButtonGroupManager parameterButtonsManager;
+    ChannelSelectorGrid parameterGrid;
     SlicerChannelSelectorComponent parameterSlicerChannelSelector;
 
-    /** An array of ChannelSelectorButtons used to select the channels that
-    are sent to the audio monitor.
+    /** The channels that are sent to the audio monitor.
     audioBox: TextBox where user input is taken for audio tab
     */
-    TiledButtonGroupManager audioButtonsManager;
+    ChannelSelectorGrid audioGrid;
     SlicerChannelSelectorComponent audioSlicerChannelSelector;
 
-    /** An array of ChannelSelectorButtons used to select the channels that
-    will be written to disk when the record button is pressed.
+    /** The channels that will be written to disk when the record button is pressed.
     recordBox: TextBox where user input is taken for record tab
     */
-    TiledButtonGroupManager recordButtonsManager;
+    ChannelSelectorGrid recordGrid;
     SlicerChannelSelectorComponent recordSlicerChannelSelector;
 
     bool paramsToggled;
@@ -261,10 +348,10 @@ private:
 
     void resized();
 
-    void addButton();
-    void removeButton();
     void refreshButtonBoundaries();
 
+    ChannelSelectorGrid* getGrid (Channels::ChannelsType channelsType);
+
     /** Controls the speed of animations. */
     void timerCallback();
 
@@ -283,6 +370,9 @@ private:
                                                bool isCollapsed)    override;
     // =================================================================================================
 
+    /** Applies a change to a channel of one of the tabs */
+    void channelSelectorGridChanged (ChannelSelectorGrid* grid, int channel) override;
+
     Font& titleFont;
 
     enum { AUDIO, RECORD, PARAMETER };
@@ -328,39 +418,5 @@ private:
 };
 
 
-/**
-
-A button within the ChannelSelector representing an individual channel.
-
-@see ChannelSelector
-
-*/
-
-class ChannelSelectorButton : public Button
-{
-public:
-    ChannelSelectorButton(int num, int type, Font& f);
-    ~ChannelSelectorButton();
-
-    int getType();
-    int getChannel();
-    //Channel* getChannel() {return ch;}
-    void setActive(bool t);
-    void setChannel(int n);
-    void setChannel(int n, int d);
-
-private:
-    void paintButton(Graphics& g, bool isMouseOver, bool isButtonDown);
-
-    //Channel* ch;
-
-    int type;
-    int num;
-    int displayNum;
-    Font buttonFont;
-    bool isActive;
-};
-
-
 
 #endif  // __CHANNELSELECTOR_H_68124E35__
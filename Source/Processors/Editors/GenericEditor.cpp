@@ -41,7 +41,7 @@ GenericEditor::GenericEditor(GenericProcessor* owner, bool useDefaultParameterEd
     : AudioProcessorEditor(owner),
       desiredWidth(150), isFading(false), accumulator(0.0), acquisitionIsActive(false),
       drawerButton(0), drawerWidth(170),
-      drawerOpen(false), channelSelector(0), isSelected(false), isEnabled(true), isCollapsed(false), tNum(-1)
+      drawerOpen(false), channelSelector(0), processorPoller(*this), isSelected(false), isEnabled(true), isCollapsed(false), tNum(-1)
 {
     constructorInitialize(owner, useDefaultParameterEditors);
 }
@@ -333,10 +333,14 @@ void GenericEditor::editorStartAcquisition()
 
     acquisitionIsActive = true;
 
+    processorPoller.startTimerHz(30);
 }
 
 void GenericEditor::editorStopAcquisition()
 {
+	processorPoller.stopTimer();
+	updateFromProcessor();
+
 	stopAcquisition();
 
 	if (channelSelector != 0)
@@ -359,6 +363,7 @@ void GenericEditor::editorStopAcquisition()
 
 void GenericEditor::startAcquisition() {}
 void GenericEditor::stopAcquisition() {}
+void GenericEditor::updateFromProcessor() {}
 
 void GenericEditor::fadeIn()
 {
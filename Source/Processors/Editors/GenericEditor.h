@@ -142,6 +142,11 @@ public:
 	/** Called after the end of acquisition, to allow custom commands .*/
 	virtual void stopAcquisition();
 
+	/** Called on the message thread about 30 times a second during acquisition, and once more
+	after it ends. Editors showing state that changes in process() override this to read it from
+	atomics the processor updates, instead of the processor calling the editor from the audio thread. */
+	virtual void updateFromProcessor();
+
     /** Returns the name of the editor.*/
     String getName();
 
@@ -333,6 +338,17 @@ private:
     /** Used for fading in the editor. */
     virtual void timerCallback() override;
 
+    /** Calls updateFromProcessor() during acquisition, separate from the fading timer. */
+    class ProcessorPoller : public Timer
+    {
+    public:
+        ProcessorPoller(GenericEditor& e) : editor(e) {}
+        void timerCallback() override { editor.updateFromProcessor(); }
+    private:
+        GenericEditor& editor;
+    };
+    ProcessorPoller processorPoller;
+
     /** Stores the editor's background color. */
     Colour backgroundColor;
 
@@ -0,0 +1,577 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "EventBenchmark.h"
+#include "Events.h"
+#include "../GenericProcessor/GenericProcessor.h"
+#include "../RecordNode/RecordNode.h"
+#include "../ProcessorManager/BenchmarkHelpers.h"
+
+//Node ID of the synthetic source, the stages follow it. Kept below the ids of the special
+//processors, so the stages flag events as they do in a real chain
+#define EVENT_BENCHMARK_NODE_ID 800
+#define EVENT_BENCHMARK_SPIKE_PRE_SAMPLES 8
+#define EVENT_BENCHMARK_SPIKE_POST_SAMPLES 32
+
+/** Creates and serializes the synthetic events of every block*/
+class EventBenchmark::SyntheticSource : public GenericProcessor
+{
+public:
+	enum EventKind
+	{
+		TTL_KIND = 0,
+		TEXT_KIND,
+		BINARY_KIND,
+		SPIKE_KIND,
+		NUM_KINDS
+	};
+
+	SyntheticSource(const EventBenchmarkSettings& benchmarkSettings) :
+		GenericProcessor("Benchmark Event Source"),
+		m_benchmark(benchmarkSettings),
+		m_timestamp(0),
+		m_ttlWord(0)
+	{
+		setNodeId(EVENT_BENCHMARK_NODE_ID);
+		//Spike channels need data channels to come from
+		for (int i = 0; i < jmax(1, m_benchmark.numElectrodes); ++i)
+		{
+			DataChannel* chan = new DataChannel(DataChannel::HEADSTAGE_CHANNEL, m_benchmark.sampleRate, this);
+			chan->setBitVolts(0.195f);
+			dataChannelArray.add(chan);
+		}
+		settings.numOutputs = dataChannelArray.size();
+
+		m_ttlChannel = new EventChannel(EventChannel::TTL, m_benchmark.numTTLChannels, 1, m_benchmark.sampleRate, this);
+		m_textChannel = new EventChannel(EventChannel::TEXT, 1, m_benchmark.textLength, m_benchmark.sampleRate, this);
+		m_binaryChannel = new EventChannel(EventChannel::UINT8_ARRAY, 1, m_benchmark.binaryLength, m_benchmark.sampleRate, this);
+		eventChannelArray.add(m_ttlChannel);
+		eventChannelArray.add(m_textChannel);
+		eventChannelArray.add(m_binaryChannel);
+
+		for (int i = 0; i < m_benchmark.numElectrodes; ++i)
+		{
+			Array<const DataChannel*> sourceChannels;
+			sourceChannels.add(dataChannelArray[i]);
+			SpikeChannel* chan = new SpikeChannel(SpikeChannel::SINGLE, this, sourceChannels);
+			chan->setNumSamples(EVENT_BENCHMARK_SPIKE_PRE_SAMPLES, EVENT_BENCHMARK_SPIKE_POST_SAMPLES);
+			spikeChannelArray.add(chan);
+		}
+		updateChannelIndexes();
+
+		m_text = String::repeatedString("x", m_benchmark.textLength);
+		m_binaryData.malloc(m_benchmark.binaryLength);
+		for (int i = 0; i < m_benchmark.binaryLength; ++i)
+			m_binaryData[i] = uint8(i);
+		for (int s = 0; s < EVENT_BENCHMARK_SPIKE_PRE_SAMPLES + EVENT_BENCHMARK_SPIKE_POST_SAMPLES; ++s)
+		{
+			float x = float(s - EVENT_BENCHMARK_SPIKE_PRE_SAMPLES);
+			m_waveform.add(-80.0f * std::exp(-x * x / 8.0f));
+		}
+		m_thresholds.add(-50.0f);
+
+		for (int k = 0; k < NUM_KINDS; ++k)
+		{
+			m_accumulators[k] = 0;
+			m_counts[k] = 0;
+			m_ticks[k] = 0;
+		}
+	}
+
+	bool isSource() const override { return true; }
+	bool isGeneratesTimestamps() const override { return true; }
+	float getSampleRate(int) const override { return m_benchmark.sampleRate; }
+	float getDefaultSampleRate() const override { return m_benchmark.sampleRate; }
+
+	void process(AudioSampleBuffer& buffer) override
+	{
+		const int blockSize = buffer.getNumSamples();
+		setTimestampAndSamples(m_timestamp, blockSize);
+
+		int numEvents = takeEvents(TTL_KIND, m_benchmark.ttlRate, blockSize);
+		for (int i = 0; i < numEvents; ++i)
+		{
+			const int sample = (i * blockSize) / numEvents;
+			const uint16 bit = uint16(m_counts[TTL_KIND] % m_benchmark.numTTLChannels);
+			m_ttlWord ^= uint64(1) << bit;
+			int64 start = Time::getHighResolutionTicks();
+			TTLEventPtr event = TTLEvent::createTTLEvent(m_ttlChannel, m_timestamp + sample, &m_ttlWord, sizeof(m_ttlWord), bit);
+			if (event == nullptr)
+				break;
+			addEvent(m_ttlChannel, event, sample);
+			addTicks(TTL_KIND, start);
+		}
+
+		numEvents = takeEvents(TEXT_KIND, m_benchmark.textRate, blockSize);
+		for (int i = 0; i < numEvents; ++i)
+		{
+			const int sample = (i * blockSize) / numEvents;
+			int64 start = Time::getHighResolutionTicks();
+			TextEventPtr event = TextEvent::createTextEvent(m_textChannel, m_timestamp + sample, m_text);
+			if (event == nullptr)
+				break;
+			addEvent(m_textChannel, event, sample);
+			addTicks(TEXT_KIND, start);
+		}
+
+		numEvents = takeEvents(BINARY_KIND, m_benchmark.binaryRate, blockSize);
+		for (int i = 0; i < numEvents; ++i)
+		{
+			const int sample = (i * blockSize) / numEvents;
+			int64 start = Time::getHighResolutionTicks();
+			BinaryEventPtr event = BinaryEvent::createBinaryEvent(m_binaryChannel, m_timestamp + sample, m_binaryData.getData(), m_benchmark.binaryLength);
+			if (event == nullptr)
+				break;
+			addEvent(m_binaryChannel, event, sample);
+			addTicks(BINARY_KIND, start);
+		}
+
+		numEvents = spikeChannelArray.size() > 0 ? takeEvents(SPIKE_KIND, m_benchmark.spikeRate, blockSize) : 0;
+		for (int i = 0; i < numEvents; ++i)
+		{
+			const int sample = (i * blockSize) / numEvents;
+			const SpikeChannel* chan = spikeChannelArray[m_counts[SPIKE_KIND] % spikeChannelArray.size()];
+			//Filling the waveform is the detector's work, not serialization, so it is not timed
+			SpikeEvent::SpikeBuffer waveform(chan);
+			waveform.set(0, m_waveform.getRawDataPointer(), m_waveform.size());
+			int64 start = Time::getHighResolutionTicks();
+			SpikeEventPtr spike = SpikeEvent::createSpikeEvent(chan, m_timestamp + sample, m_thresholds, waveform, 0);
+			if (spike == nullptr)
+				break;
+			addSpike(chan, spike, sample);
+			addTicks(SPIKE_KIND, start);
+		}
+
+		m_timestamp += blockSize;
+	}
+
+	int64 getCount(int kind) const { return m_counts[kind]; }
+	int64 getTicks(int kind) const { return m_ticks[kind]; }
+
+	int64 getTotalCount() const
+	{
+		int64 total = 0;
+		for (int k = 0; k < NUM_KINDS; ++k)
+			total += m_counts[k];
+		return total;
+	}
+
+	static const char* getKindName(int kind)
+	{
+		static const char* names[NUM_KINDS] = { "TTL", "Text", "Binary", "Spike" };
+		return names[kind];
+	}
+
+private:
+	int takeEvents(int kind, float rate, int blockSize)
+	{
+		m_accumulators[kind] += double(rate) * blockSize / m_benchmark.sampleRate;
+		int numEvents = int(m_accumulators[kind]);
+		m_accumulators[kind] -= numEvents;
+		return numEvents;
+	}
+
+	void addTicks(int kind, int64 start)
+	{
+		m_ticks[kind] += Time::getHighResolutionTicks() - start;
+		m_counts[kind]++;
+	}
+
+	const EventBenchmarkSettings& m_benchmark;
+	EventChannel* m_ttlChannel;
+	EventChannel* m_textChannel;
+	EventChannel* m_binaryChannel;
+	int64 m_timestamp;
+	uint64 m_ttlWord;
+	String m_text;
+	HeapBlock<uint8> m_binaryData;
+	Array<float> m_waveform;
+	Array<float> m_thresholds;
+
+	double m_accumulators[NUM_KINDS];
+	int64 m_counts[NUM_KINDS];
+	int64 m_ticks[NUM_KINDS];
+};
+
+/** Processor of the chain. Looks at every event through the views, or when given queues,
+pushes them to the record queues as RecordNode does*/
+class EventBenchmark::Stage : public GenericProcessor
+{
+public:
+	Stage(int index, const GenericProcessor* source, EventMsgQueue* eventQueue, SpikeMsgQueue* spikeQueue) :
+		GenericProcessor(eventQueue != nullptr ? String("Benchmark Record Queue") : "Benchmark Stage " + String(index + 1)),
+		m_eventQueue(eventQueue),
+		m_spikeQueue(spikeQueue),
+		m_numEvents(0),
+		m_numSpikes(0),
+		m_numQueued(0),
+		m_queueTicks(0),
+		m_checksum(0)
+	{
+		setNodeId(EVENT_BENCHMARK_NODE_ID + 1 + index);
+		//Inherit the channels of the previous processor as update() does, which needs an editor
+		for (int i = 0; i < source->getTotalDataChannels(); ++i)
+			dataChannelArray.add(new DataChannel(*source->getDataChannel(i)));
+		for (int i = 0; i < source->getTotalEventChannels(); ++i)
+			eventChannelArray.add(new EventChannel(*source->getEventChannel(i)));
+		for (int i = 0; i < source->getTotalSpikeChannels(); ++i)
+			spikeChannelArray.add(new SpikeChannel(*source->getSpikeChannel(i)));
+		settings.numInputs = dataChannelArray.size();
+		settings.numOutputs = dataChannelArray.size();
+		updateChannelIndexes();
+	}
+
+	void process(AudioSampleBuffer&) override
+	{
+		checkForEvents(true);
+	}
+
+	void handleEvent(const EventChannel* eventInfo, const MidiMessage& event, int) override
+	{
+		m_numEvents++;
+		if (m_eventQueue != nullptr)
+		{
+			int64 start = Time::getHighResolutionTicks();
+			int eventIndex = getEventChannelIndex(Event::getSourceIndex(event), Event::getSourceID(event), Event::getSubProcessorIdx(event));
+			if (m_eventQueue->addEvent(event, Event::getTimestamp(event), eventIndex))
+				m_numQueued++;
+			m_queueTicks += Time::getHighResolutionTicks() - start;
+		}
+		else if (eventInfo->getChannelType() == EventChannel::TTL)
+		{
+			TTLEventView ttl(event, eventInfo);
+			if (ttl.isValid())
+				m_checksum += ttl.getState() ? 1 : 0;
+		}
+		else
+		{
+			EventView view(event, eventInfo);
+			if (view.isValid())
+				m_checksum += view.getChannel();
+		}
+	}
+
+	void handleSpike(const SpikeChannel* spikeInfo, const MidiMessage& event, int) override
+	{
+		m_numSpikes++;
+		if (m_spikeQueue != nullptr)
+		{
+			//The record node receives spike objects, so pay for the deserialization too
+			int64 start = Time::getHighResolutionTicks();
+			SpikeEventPtr spike = SpikeEvent::deserializeFromMessage(event, spikeInfo);
+			if (spike != nullptr && m_spikeQueue->addEvent(*spike, spike->getTimestamp(), getSpikeChannelIndex(spike)))
+				m_numQueued++;
+			m_queueTicks += Time::getHighResolutionTicks() - start;
+		}
+		else
+		{
+			SpikeEventView view(event, spikeInfo);
+			if (view.isValid())
+				m_checksum += view.getSortedID();
+		}
+	}
+
+	bool isQueueStage() const { return m_eventQueue != nullptr; }
+	int64 getNumEvents() const { return m_numEvents; }
+	int64 getNumSpikes() const { return m_numSpikes; }
+	int64 getNumQueued() const { return m_numQueued; }
+	int64 getQueueTicks() const { return m_queueTicks; }
+
+private:
+	EventMsgQueue* const m_eventQueue;
+	SpikeMsgQueue* const m_spikeQueue;
+	int64 m_numEvents;
+	int64 m_numSpikes;
+	int64 m_numQueued;
+	int64 m_queueTicks;
+	int64 m_checksum;
+};
+
+/** Empties the record queues, standing in for RecordThread*/
+class EventBenchmark::QueueReader : public Thread
+{
+public:
+	QueueReader(EventMsgQueue& eventQueue, SpikeMsgQueue& spikeQueue) :
+		Thread("Event benchmark queue reader"),
+		m_eventQueue(eventQueue),
+		m_spikeQueue(spikeQueue),
+		m_numRead(0),
+		m_bytesRead(0)
+	{}
+
+	void run() override
+	{
+		while (!threadShouldExit())
+		{
+			if (drain() == 0)
+				wait(1);
+		}
+		drain();
+	}
+
+	int64 getNumRead() const { return m_numRead; }
+	int64 getBytesRead() const { return m_bytesRead; }
+
+private:
+	int drain()
+	{
+		int numEvents = m_eventQueue.startRead(0);
+		for (int i = 0; i < numEvents; ++i)
+			m_bytesRead += m_eventQueue.getDataSize(i);
+		m_eventQueue.finishedRead();
+
+		int numSpikes = m_spikeQueue.startRead(0);
+		for (int i = 0; i < numSpikes; ++i)
+			m_bytesRead += m_spikeQueue.getDataSize(i);
+		m_spikeQueue.finishedRead();
+
+		m_numRead += numEvents + numSpikes;
+		return numEvents + numSpikes;
+	}
+
+	EventMsgQueue& m_eventQueue;
+	SpikeMsgQueue& m_spikeQueue;
+	int64 m_numRead;
+	int64 m_bytesRead;
+};
+
+EventBenchmarkSettings::EventBenchmarkSettings() :
+	numProcessors(4),
+	sampleRate(30000.0f),
+	blockSize(1024),
+	seconds(10.0),
+	ttlRate(10000.0f),
+	textRate(10.0f),
+	binaryRate(1000.0f),
+	spikeRate(1000.0f),
+	numTTLChannels(16),
+	textLength(64),
+	binaryLength(32),
+	numElectrodes(16),
+	useQueue(true)
+{
+}
+
+void EventBenchmarkSettings::parse(const StringArray& options)
+{
+	for (int i = 0; i < options.size(); ++i)
+	{
+		String key = options[i].upToFirstOccurrenceOf("=", false, false).toLowerCase();
+		String value = options[i].fromFirstOccurrenceOf("=", false, false);
+
+		if (key == "processors")
+			numProcessors = jmax(0, value.getIntValue());
+		else if (key == "rate")
+			sampleRate = jmax(1.0f, value.getFloatValue());
+		else if (key == "block")
+			blockSize = jmax(1, value.getIntValue());
+		else if (key == "seconds")
+			seconds = jmax(0.1, value.getDoubleValue());
+		else if (key == "ttl")
+			ttlRate = jmax(0.0f, value.getFloatValue());
+		else if (key == "text")
+			textRate = jmax(0.0f, value.getFloatValue());
+		else if (key == "binary")
+			binaryRate = jmax(0.0f, value.getFloatValue());
+		else if (key == "spikes")
+			spikeRate = jmax(0.0f, value.getFloatValue());
+		else if (key == "ttlchannels")
+			numTTLChannels = jlimit(1, 64, value.getIntValue());
+		else if (key == "textlength")
+			textLength = jmax(1, value.getIntValue());
+		else if (key == "binarylength")
+			binaryLength = jmax(1, value.getIntValue());
+		else if (key == "electrodes")
+			numElectrodes = jmax(0, value.getIntValue());
+		else if (key == "queue")
+			useQueue = value.getIntValue() != 0;
+		else
+			std::cerr << "Unknown event benchmark option " << options[i] << std::endl;
+	}
+}
+
+EventBenchmark::EventBenchmark(const EventBenchmarkSettings& settings) :
+	m_settings(settings),
+	m_numBlocks(0),
+	m_elapsedSeconds(0),
+	m_sourceTicks(0),
+	m_maxBufferBytes(0)
+{
+}
+
+EventBenchmark::~EventBenchmark()
+{
+	tearDown();
+}
+
+bool EventBenchmark::setUp()
+{
+	if (m_settings.ttlRate + m_settings.textRate + m_settings.binaryRate + m_settings.spikeRate <= 0)
+	{
+		std::cerr << "Event benchmark: no events to generate" << std::endl;
+		return false;
+	}
+
+	m_source = new SyntheticSource(m_settings);
+	m_source->enableProcessor();
+
+	if (m_settings.useQueue)
+	{
+		//Slots sized the same way RecordNode sizes them for its channels
+		size_t eventSlotSize = EVENT_BUFFER_MIN_SLOT_SIZE;
+		for (int i = 0; i < m_source->getTotalEventChannels(); ++i)
+		{
+			const EventChannel* chan = m_source->getEventChannel(i);
+			eventSlotSize = jmax(eventSlotSize, chan->getDataSize() + chan->getTotalEventMetaDataSize() + EVENT_BASE_SIZE);
+		}
+		size_t spikeSlotSize = EVENT_BUFFER_MIN_SLOT_SIZE;
+		for (int i = 0; i < m_source->getTotalSpikeChannels(); ++i)
+		{
+			const SpikeChannel* chan = m_source->getSpikeChannel(i);
+			spikeSlotSize = jmax(spikeSlotSize, chan->getWaveformDataSize() + chan->getTotalEventMetaDataSize() + SPIKE_BASE_SIZE
+				+ chan->getNumChannels()*sizeof(float));
+		}
+		m_eventQueue = new EventMsgQueue(EVENT_BUFFER_NEVENTS, int(eventSlotSize));
+		m_spikeQueue = new SpikeMsgQueue(SPIKE_BUFFER_NSPIKES, int(spikeSlotSize));
+		m_reader = new QueueReader(*m_eventQueue, *m_spikeQueue);
+	}
+
+	const GenericProcessor* previous = m_source;
+	const int numStages = m_settings.numProcessors + (m_settings.useQueue ? 1 : 0);
+	for (int i = 0; i < numStages; ++i)
+	{
+		bool queueStage = m_settings.useQueue && i == numStages - 1;
+		Stage* stage = new Stage(i, previous, queueStage ? m_eventQueue.get() : nullptr, queueStage ? m_spikeQueue.get() : nullptr);
+		stage->enableProcessor();
+		m_stages.add(stage);
+		m_stageTicks.add(0);
+		m_stageTimes.add(new ProcessTimeStatistics());
+		previous = stage;
+	}
+
+	m_buffer.setSize(m_source->getTotalDataChannels(), m_settings.blockSize);
+	m_buffer.clear();
+	m_eventBuffer.ensureSize(65536);
+	return true;
+}
+
+void EventBenchmark::tearDown()
+{
+	if (m_reader != nullptr && m_reader->isThreadRunning())
+	{
+		m_reader->signalThreadShouldExit();
+		m_reader->waitForThreadToExit(-1);
+	}
+}
+
+bool EventBenchmark::run()
+{
+	if (!setUp())
+	{
+		tearDown();
+		return false;
+	}
+
+	m_numBlocks = jmax(1, roundToInt(m_settings.seconds * m_settings.sampleRate / m_settings.blockSize));
+
+	if (m_reader != nullptr)
+		m_reader->startThread();
+
+	double start = Time::getMillisecondCounterHiRes();
+	for (int block = 0; block < m_numBlocks; ++block)
+	{
+		m_eventBuffer.clear();
+
+		int64 blockStart = Time::getHighResolutionTicks();
+		BenchmarkHelpers::processBlock(*m_source, m_buffer, m_eventBuffer);
+		int64 stageStart = Time::getHighResolutionTicks();
+		m_sourceTicks += stageStart - blockStart;
+		m_sourceTime.addSample(stageStart - blockStart);
+
+		for (int i = 0; i < m_stages.size(); ++i)
+		{
+			BenchmarkHelpers::processBlock(*m_stages[i], m_buffer, m_eventBuffer);
+			int64 stageEnd = Time::getHighResolutionTicks();
+			m_stageTicks.getReference(i) += stageEnd - stageStart;
+			m_stageTimes[i]->addSample(stageEnd - stageStart);
+			stageStart = stageEnd;
+		}
+		m_maxBufferBytes = jmax(m_maxBufferBytes, int64(m_eventBuffer.data.size()));
+	}
+	double end = Time::getMillisecondCounterHiRes();
+
+	tearDown();
+	m_elapsedSeconds = (end - start) / 1000.0;
+	return true;
+}
+
+void EventBenchmark::printReport(std::ostream& out) const
+{
+	const double seconds = jmax(m_elapsedSeconds, 1e-9);
+	const double dataSeconds = double(m_numBlocks) * m_settings.blockSize / m_settings.sampleRate;
+	const int64 numEvents = m_source->getTotalCount();
+
+	out << "Event benchmark: " << m_settings.numProcessors << " processors" << (m_settings.useQueue ? " and the record queues, " : ", ")
+		<< m_settings.sampleRate << " Hz, " << m_settings.blockSize << " sample blocks, " << dataSeconds << " s of data" << std::endl;
+	out << "  Throughput: " << numEvents << " events in " << seconds << " s, " << numEvents / seconds << " events/s, "
+		<< dataSeconds / seconds << "x realtime. Largest event buffer " << m_maxBufferBytes << " bytes" << std::endl;
+
+	ProcessTimeStatistics::Summary source = m_sourceTime.getSummary();
+	out << "  Source: " << BenchmarkHelpers::ticksToMs(m_sourceTicks) / m_numBlocks << " ms/block mean, "
+		<< source.p99Ms << " ms p99 (last " << ProcessTimeStatistics::windowSize << " blocks)" << std::endl;
+	for (int k = 0; k < SyntheticSource::NUM_KINDS; ++k)
+	{
+		int64 count = m_source->getCount(k);
+		out << "    " << SyntheticSource::getKindName(k) << ": " << count << " events, "
+			<< (count > 0 ? BenchmarkHelpers::ticksToNs(m_source->getTicks(k)) / count : 0) << " ns/event to create and serialize" << std::endl;
+	}
+
+	for (int i = 0; i < m_stages.size(); ++i)
+	{
+		const Stage* stage = m_stages[i];
+		ProcessTimeStatistics::Summary summary = m_stageTimes[i]->getSummary();
+		int64 numSeen = stage->getNumEvents() + stage->getNumSpikes();
+		out << "  " << stage->getName() << ": " << BenchmarkHelpers::ticksToMs(m_stageTicks[i]) / m_numBlocks << " ms/block mean, "
+			<< summary.p99Ms << " ms p99, " << stage->getProcessTimeSummary().meanMs << " ms in checkForEvents, "
+			<< (numSeen > 0 ? BenchmarkHelpers::ticksToNs(m_stageTicks[i]) / numSeen : 0) << " ns/event, " << numSeen << " events seen" << std::endl;
+		if (stage->isQueueStage())
+		{
+			out << "    Queues: " << stage->getNumQueued() << " queued, " << m_eventQueue->getNumOverruns() << " events and "
+				<< m_spikeQueue->getNumOverruns() << " spikes dropped, "
+				<< (numSeen > 0 ? BenchmarkHelpers::ticksToNs(stage->getQueueTicks()) / numSeen : 0) << " ns/event to queue, "
+				<< m_reader->getNumRead() << " read (" << m_reader->getBytesRead() << " bytes)" << std::endl;
+		}
+	}
+}
+
+bool EventBenchmark::runFromCommandLine(const StringArray& options)
+{
+	EventBenchmarkSettings settings;
+	settings.parse(options);
+
+	EventBenchmark benchmark(settings);
+	if (!benchmark.run())
+		return false;
+	benchmark.printReport(std::cout);
+	return true;
+}
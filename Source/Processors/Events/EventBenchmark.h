@@ -0,0 +1,119 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef EVENTBENCHMARK_H_INCLUDED
+#define EVENTBENCHMARK_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../GenericProcessor/ProcessTimeStatistics.h"
+#include "../RecordNode/EventQueue.h"
+
+struct EventBenchmarkSettings
+{
+	EventBenchmarkSettings();
+
+	/** Reads "key=value" options, e.g. processors=8 ttl=50000. Unknown keys are reported and ignored*/
+	void parse(const StringArray& options);
+
+	int numProcessors;
+	float sampleRate;
+	int blockSize;
+	double seconds;
+	//Events per second of each kind generated by the source
+	float ttlRate;
+	float textRate;
+	float binaryRate;
+	float spikeRate;
+	int numTTLChannels;
+	int textLength;
+	int binaryLength;
+	int numElectrodes;
+	bool useQueue;
+};
+
+/**
+
+  Measures how many events per second the event pipeline can carry, without hardware.
+
+  A synthetic source creates TTL, text, binary and spike events at the configured rates and
+  serializes them into the block's event buffer with the regular Events.cpp and GenericProcessor
+  code. The buffer then goes through a chain of processors whose process() only calls
+  checkForEvents(true) and reads a field of each event through the event views. Optionally a
+  last processor pushes everything into the record node's event and spike queues, the way
+  RecordNode does while recording, and a reader thread drains them.
+
+  Blocks are run back to back on the calling thread, so the report gives the cost of each
+  stage and the sustained event rate relative to realtime.
+
+  Started from the command line with --benchmark-events [key=value ...]
+
+  @see GenericProcessor::checkForEvents, EventMsgQueue
+
+*/
+class EventBenchmark
+{
+public:
+	EventBenchmark(const EventBenchmarkSettings& settings);
+	~EventBenchmark();
+
+	/** Runs the benchmark on the calling thread. Returns false if it could not be set up*/
+	bool run();
+
+	/** Writes the results of the last run*/
+	void printReport(std::ostream& out) const;
+
+	/** Parses the options, runs the benchmark and prints the report to stdout*/
+	static bool runFromCommandLine(const StringArray& options);
+
+private:
+	class SyntheticSource;
+	class Stage;
+	class QueueReader;
+
+	bool setUp();
+	void tearDown();
+
+	const EventBenchmarkSettings m_settings;
+
+	ScopedPointer<SyntheticSource> m_source;
+	OwnedArray<Stage> m_stages;
+	ScopedPointer<EventMsgQueue> m_eventQueue;
+	ScopedPointer<SpikeMsgQueue> m_spikeQueue;
+	ScopedPointer<QueueReader> m_reader;
+
+	AudioSampleBuffer m_buffer;
+	MidiBuffer m_eventBuffer;
+
+	//Results
+	int m_numBlocks;
+	double m_elapsedSeconds;
+	int64 m_sourceTicks;
+	ProcessTimeStatistics m_sourceTime;
+	Array<int64> m_stageTicks;
+	OwnedArray<ProcessTimeStatistics> m_stageTimes;
+	int64 m_maxBufferBytes;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EventBenchmark);
+};
+
+#endif  // EVENTBENCHMARK_H_INCLUDED
@@ -0,0 +1,165 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "EventIndex.h"
+
+EventIndex::EventIndex()
+	: m_base(nullptr)
+	, m_generation(0)
+	, m_isBuilt(false)
+{
+}
+
+void EventIndex::build(const MidiBuffer& buffer, uint32 generation)
+{
+	clear();
+
+	m_base = buffer.data.begin();
+	MidiBuffer::Iterator i(buffer);
+	const uint8* dataptr;
+	int dataSize;
+	int samplePosition;
+	while (i.getNextEvent(dataptr, dataSize, samplePosition))
+		add(dataptr, dataSize, samplePosition);
+
+	m_generation = generation;
+	m_isBuilt = true;
+}
+
+bool EventIndex::isCurrent(uint32 generation) const
+{
+	return m_isBuilt && m_generation == generation;
+}
+
+void EventIndex::clear()
+{
+	m_isBuilt = false;
+
+	m_baseType.clearQuick();
+	m_subType.clearQuick();
+	m_sourceID.clearQuick();
+	m_subProcessorIdx.clearQuick();
+	m_sourceIndex.clearQuick();
+	m_timestamp.clearQuick();
+	m_samplePosition.clearQuick();
+	m_offset.clearQuick();
+	m_size.clearQuick();
+	for (int i = 0; i < numElementsInArray(m_byType); i++)
+		m_byType[i].clearQuick();
+}
+
+void EventIndex::add(const uint8* data, int dataSize, int samplePosition)
+{
+	// Anything shorter than the common header isn't an Open Ephys event
+	if (dataSize < 16)
+		return;
+
+	//TODO: remove the mask when the probe system is implemented
+	const uint8 baseType = data[0] & 0x7F;
+	if (baseType >= numElementsInArray(m_byType))
+		return;
+
+	m_byType[baseType].add(m_baseType.size());
+
+	m_baseType.add(baseType);
+	m_subType.add(data[1]);
+	m_sourceID.add(*reinterpret_cast<const uint16*>(data + 2));
+	m_subProcessorIdx.add(*reinterpret_cast<const uint16*>(data + 4));
+	m_sourceIndex.add(*reinterpret_cast<const uint16*>(data + 6));
+	m_timestamp.add(*reinterpret_cast<const juce::int64*>(data + 8));
+	m_samplePosition.add(samplePosition);
+	m_offset.add(int(data - m_base));
+	m_size.add(dataSize);
+}
+
+int EventIndex::getNumEvents() const
+{
+	return m_baseType.size();
+}
+
+EventType EventIndex::getBaseType(int event) const
+{
+	return static_cast<EventType>(m_baseType[event]);
+}
+
+uint8 EventIndex::getSubType(int event) const
+{
+	return m_subType[event];
+}
+
+uint16 EventIndex::getSourceID(int event) const
+{
+	return m_sourceID[event];
+}
+
+uint16 EventIndex::getSubProcessorIdx(int event) const
+{
+	return m_subProcessorIdx[event];
+}
+
+uint16 EventIndex::getSourceIndex(int event) const
+{
+	return m_sourceIndex[event];
+}
+
+juce::int64 EventIndex::getTimestamp(int event) const
+{
+	return m_timestamp[event];
+}
+
+int EventIndex::getSamplePosition(int event) const
+{
+	return m_samplePosition[event];
+}
+
+const uint8* EventIndex::getData(int event) const
+{
+	return m_base + m_offset[event];
+}
+
+int EventIndex::getDataSize(int event) const
+{
+	return m_size[event];
+}
+
+const Array<int>& EventIndex::getEventsOfType(EventType type) const
+{
+	return m_byType[type];
+}
+
+void EventIndex::getEventsFromSource(EventType type, uint16 sourceID, uint16 subProcessorIdx, Array<int>& events) const
+{
+	events.clearQuick();
+	const Array<int>& ofType = m_byType[type];
+	for (int i = 0; i < ofType.size(); i++)
+	{
+		const int event = ofType.getUnchecked(i);
+		if (m_sourceID.getUnchecked(event) == sourceID && m_subProcessorIdx.getUnchecked(event) == subProcessorIdx)
+			events.add(event);
+	}
+}
+
+MidiMessage EventIndex::getMessage(int event) const
+{
+	return MidiMessage(getData(event), getDataSize(event), getSamplePosition(event));
+}
@@ -0,0 +1,108 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef EVENTINDEX_H_INCLUDED
+#define EVENTINDEX_H_INCLUDED
+
+#include "Events.h"
+
+/**
+	Decoded view of the events in a processor's buffer for the current block.
+
+	GenericProcessor builds it the first time it is needed in a block, so nodes
+	that never look at their events don't pay for it. The packet headers are
+	kept as parallel arrays (type, source, timestamp, sample position...) and
+	the packets are referred to by their offset into the MidiBuffer, not copied.
+	The index records the generation of the buffer it was built from; the
+	processor bumps its generation whenever it writes to the buffer, which
+	moves the packets, and the index is then rebuilt on its next use.
+
+	Processors can walk it directly, optionally restricted to one event type,
+	instead of iterating the MidiBuffer and building a MidiMessage per event.
+	getMessage() builds the MidiMessage that handleEvent() and handleSpike()
+	expect, for code that still works with those.
+
+	@see GenericProcessor::getEventIndex
+*/
+class PLUGIN_API EventIndex
+{
+public:
+	EventIndex();
+
+	/** Indexes every event of the buffer, keeping the allocated storage. The buffer
+	must not be written to while the index is in use. */
+	void build(const MidiBuffer& buffer, uint32 generation);
+
+	/** Whether the index was built from the buffer as it is at this generation */
+	bool isCurrent(uint32 generation) const;
+
+	/** Removes all events, keeping the allocated storage */
+	void clear();
+
+	int getNumEvents() const;
+
+	EventType getBaseType(int event) const;
+	/** Event channel type for processor events, system event type or electrode type for spikes */
+	uint8 getSubType(int event) const;
+	uint16 getSourceID(int event) const;
+	uint16 getSubProcessorIdx(int event) const;
+	uint16 getSourceIndex(int event) const;
+	juce::int64 getTimestamp(int event) const;
+	int getSamplePosition(int event) const;
+
+	/** The whole serialized packet, header included */
+	const uint8* getData(int event) const;
+	int getDataSize(int event) const;
+
+	/** Indexes of all events of one base type, in buffer order */
+	const Array<int>& getEventsOfType(EventType type) const;
+
+	/** Collects the events of one type coming from a given source processor */
+	void getEventsFromSource(EventType type, uint16 sourceID, uint16 subProcessorIdx, Array<int>& events) const;
+
+	/** Builds a MidiMessage holding the event, for handleEvent()/handleSpike() style code */
+	MidiMessage getMessage(int event) const;
+
+private:
+	void add(const uint8* data, int dataSize, int samplePosition);
+
+	const uint8* m_base;
+	uint32 m_generation;
+	bool m_isBuilt;
+
+	Array<uint8> m_baseType;
+	Array<uint8> m_subType;
+	Array<uint16> m_sourceID;
+	Array<uint16> m_subProcessorIdx;
+	Array<uint16> m_sourceIndex;
+	Array<juce::int64> m_timestamp;
+	Array<int> m_samplePosition;
+	Array<int> m_offset;
+	Array<int> m_size;
+
+	Array<int> m_byType[3];
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EventIndex);
+};
+
+#endif  // EVENTINDEX_H_INCLUDED
@@ -145,17 +145,22 @@ size_t SystemEvent::fillTimestampAndSamplesData(HeapBlock<char>& data, const Gen
 	* Timestamp - 8 bytes
 	* Buffer sample number - 4 bytes
 	*/
-	const int eventSize = 20;
-	data.malloc(eventSize);
+	data.malloc(TIMESTAMP_AND_SAMPLES_SIZE);
+	writeTimestampAndSamplesData(data, proc, subProcessorIdx, timestamp, nSamples);
+	return TIMESTAMP_AND_SAMPLES_SIZE;
+}
+
+void SystemEvent::writeTimestampAndSamplesData(void* dst, const GenericProcessor* proc, int16 subProcessorIdx, juce::int64 timestamp, uint32 nSamples)
+{
+	char* data = static_cast<char*>(dst);
 	data[0] = SYSTEM_EVENT;
 	data[1] = TIMESTAMP_AND_SAMPLES;
-	*reinterpret_cast<uint16*>(data.getData() + 2) = proc->getNodeId();
-	*reinterpret_cast<uint16*>(data.getData() + 4) = subProcessorIdx;
+	*reinterpret_cast<uint16*>(data + 2) = proc->getNodeId();
+	*reinterpret_cast<uint16*>(data + 4) = subProcessorIdx;
 	data[6] = 0;
 	data[7] = 0;
-	*reinterpret_cast<juce::int64*>(data.getData() + 8) = timestamp;
-	*reinterpret_cast<uint32*>(data.getData() + 16) = nSamples;
-	return eventSize;
+	*reinterpret_cast<juce::int64*>(data + 8) = timestamp;
+	*reinterpret_cast<uint32*>(data + 16) = nSamples;
 }
 
 size_t SystemEvent::fillTimestampSyncTextData(HeapBlock<char>& data, const GenericProcessor* proc, int16 subProcessorIdx, juce::int64 timestamp, bool softwareTime)
@@ -272,9 +277,19 @@ uint16 Event::getChannel() const
 	return m_channel;
 }
 
+size_t Event::getPayloadSize() const
+{
+	return m_channelInfo->getDataSize();
+}
+
+size_t Event::getSerializedSize() const
+{
+	return getPayloadSize() + m_channelInfo->getTotalEventMetaDataSize() + EVENT_BASE_SIZE;
+}
+
 bool Event::serializeHeader(EventChannel::EventChannelTypes type, char* buffer, size_t dstSize) const
 {
-	size_t dataSize = m_channelInfo->getDataSize();
+	size_t dataSize = getPayloadSize();
 	size_t eventSize = dataSize + EVENT_BASE_SIZE;
 	size_t totalSize = eventSize + m_channelInfo->getTotalEventMetaDataSize();
 	if (totalSize < dstSize)
@@ -293,6 +308,17 @@ bool Event::serializeHeader(EventChannel::EventChannelTypes type, char* buffer,
 	return true;
 }
 
+void Event::writeHeader(char* buffer, EventChannel::EventChannelTypes type, const EventChannel* channelInfo, juce::int64 timestamp, uint16 channel)
+{
+	*(buffer + 0) = PROCESSOR_EVENT;
+	*(buffer + 1) = static_cast<char>(type);
+	*(reinterpret_cast<uint16*>(buffer + 2)) = channelInfo->getSourceNodeID();
+	*(reinterpret_cast<uint16*>(buffer + 4)) = channelInfo->getSubProcessorIdx();
+	*(reinterpret_cast<uint16*>(buffer + 6)) = channelInfo->getSourceIndex();
+	*(reinterpret_cast<juce::int64*>(buffer + 8)) = timestamp;
+	*(reinterpret_cast<uint16*>(buffer + 16)) = channel;
+}
+
 bool Event::createChecks(const EventChannel* channelInfo, EventChannel::EventChannelTypes eventType, uint16 channel)
 {
 	if (!channelInfo) return false;
@@ -362,6 +388,27 @@ void TTLEvent::serialize(void* dstBuffer, size_t dstSize) const
 	serializeMetaData(buffer + eventSize);
 }
 
+bool TTLEvent::serializeTTL(void* dstBuffer, size_t dstSize, const EventChannel* channelInfo, juce::int64 timestamp, const void* eventData, uint16 channel)
+{
+	if (!createChecks(channelInfo, EventChannel::TTL, channel))
+	{
+		jassertfalse;
+		return false;
+	}
+
+	size_t dataSize = channelInfo->getDataSize();
+	if (dstSize < dataSize + EVENT_BASE_SIZE)
+	{
+		jassertfalse;
+		return false;
+	}
+
+	char* buffer = static_cast<char*>(dstBuffer);
+	writeHeader(buffer, EventChannel::TTL, channelInfo, timestamp, channel);
+	memcpy((buffer + EVENT_BASE_SIZE), eventData, dataSize);
+	return true;
+}
+
 TTLEventPtr TTLEvent::createTTLEvent(const EventChannel* channelInfo, juce::int64 timestamp, const void* eventData, int dataSize, uint16 channel)
 {
 
@@ -501,6 +548,28 @@ void TextEvent::serialize(void* dstBuffer, size_t dstSize) const
 	serializeMetaData(buffer + eventSize);
 }
 
+bool TextEvent::serializeText(void* dstBuffer, size_t dstSize, const EventChannel* channelInfo, juce::int64 timestamp, const char* text, size_t numBytes, uint16 channel)
+{
+	if (!createChecks(channelInfo, EventChannel::TEXT, channel))
+	{
+		jassertfalse;
+		return false;
+	}
+
+	size_t dataSize = channelInfo->getDataSize();
+	if (numBytes > dataSize || dstSize < dataSize + EVENT_BASE_SIZE)
+	{
+		jassertfalse;
+		return false;
+	}
+
+	char* buffer = static_cast<char*>(dstBuffer);
+	writeHeader(buffer, EventChannel::TEXT, channelInfo, timestamp, channel);
+	memcpy((buffer + EVENT_BASE_SIZE), text, numBytes);
+	zeromem((buffer + EVENT_BASE_SIZE + numBytes), dataSize - numBytes);
+	return true;
+}
+
 TextEventPtr TextEvent::createTextEvent(const EventChannel* channelInfo, juce::int64 timestamp, const String& text, uint16 channel)
 {
 	if (!createChecks(channelInfo, EventChannel::TEXT, channel))
@@ -606,16 +675,32 @@ TextEventPtr TextEvent::deserializeFromMessage(const MidiMessage& msg, const Eve
 //BinaryEvent
 BinaryEvent::BinaryEvent(const EventChannel* channelInfo, juce::int64 timestamp, uint16 channel, const void* data, EventChannel::EventChannelTypes type)
 	: Event(channelInfo, timestamp, channel),
-	m_type(type)
+	m_type(type),
+	m_numRecords(1)
 {
 	size_t size = m_channelInfo->getDataSize();
 	m_data.malloc(size);
 	memcpy(m_data.getData(), data, size);
 }
 
+BinaryEvent::BinaryEvent(const EventChannel* channelInfo, juce::int64 timestamp, uint16 channel, const void* records, const int32* sampleOffsets, uint32 numRecords, EventChannel::EventChannelTypes type)
+	: Event(channelInfo, timestamp, channel),
+	m_type(type),
+	m_numRecords(numRecords)
+{
+	//Allocated for the largest batch so the base copy constructor can copy it whole
+	m_data.calloc(m_channelInfo->getDataSize());
+	char* buffer = m_data.getData();
+	memcpy(buffer, &numRecords, sizeof(uint32));
+	if (sampleOffsets != nullptr)
+		memcpy(buffer + sizeof(uint32), sampleOffsets, numRecords * sizeof(int32));
+	memcpy(buffer + sizeof(uint32) + numRecords * sizeof(int32), records, numRecords * m_channelInfo->getRecordSize());
+}
+
 BinaryEvent::BinaryEvent(const BinaryEvent& other)
 	:Event(other),
-	m_type(other.m_type)
+	m_type(other.m_type),
+	m_numRecords(other.m_numRecords)
 {
 }
 
@@ -623,7 +708,38 @@ BinaryEvent::~BinaryEvent() {}
 
 const void* BinaryEvent::getBinaryDataPointer() const
 {
-	return m_data.getData();
+	return getRecordPointer(0);
+}
+
+int BinaryEvent::getNumRecords() const
+{
+	return int(m_numRecords);
+}
+
+const void* BinaryEvent::getRecordPointer(int record) const
+{
+	if (!m_channelInfo->isBatched())
+		return m_data.getData();
+	return m_data.getData() + sizeof(uint32) + m_numRecords * sizeof(int32) + record * m_channelInfo->getRecordSize();
+}
+
+int32 BinaryEvent::getRecordSampleOffset(int record) const
+{
+	if (!m_channelInfo->isBatched() || record < 0 || record >= int(m_numRecords))
+		return 0;
+	return reinterpret_cast<const int32*>(m_data.getData() + sizeof(uint32))[record];
+}
+
+juce::int64 BinaryEvent::getRecordTimestamp(int record) const
+{
+	return m_timestamp + getRecordSampleOffset(record);
+}
+
+size_t BinaryEvent::getPayloadSize() const
+{
+	if (m_channelInfo->isBatched())
+		return m_channelInfo->getBatchedDataSize(m_numRecords);
+	return m_channelInfo->getDataSize();
 }
 
 EventChannel::EventChannelTypes BinaryEvent::getBinaryType() const
@@ -654,7 +770,7 @@ void BinaryEvent::serialize(void* dstBuffer, size_t dstSize) const
 	if (!serializeHeader(m_type, buffer, dstSize))
 		return;
 	
-	size_t dataSize = m_channelInfo->getDataSize();
+	size_t dataSize = getPayloadSize();
 	size_t eventSize = dataSize + EVENT_BASE_SIZE;
 	memcpy((buffer + EVENT_BASE_SIZE), m_data.getData(), dataSize);
 	serializeMetaData(buffer + eventSize);
@@ -670,7 +786,7 @@ BinaryEventPtr BinaryEvent::createBinaryEvent(const EventChannel* channelInfo, j
 		return nullptr;
 	}
 
-	if (!createChecks(channelInfo, type, channel))
+	if (!createChecks(channelInfo, type, channel) || channelInfo->isBatched())
 	{
 		jassertfalse;
 		return nullptr;
@@ -695,7 +811,7 @@ BinaryEventPtr BinaryEvent::createBinaryEvent(const EventChannel* channelInfo, j
 		return nullptr;
 	}
 
-	if (!createChecks(channelInfo, type, channel, metaData))
+	if (!createChecks(channelInfo, type, channel, metaData) || channelInfo->isBatched())
 	{
 		jassertfalse;
 		return nullptr;
@@ -712,18 +828,121 @@ BinaryEventPtr BinaryEvent::createBinaryEvent(const EventChannel* channelInfo, j
 	return event;
 }
 
+bool BinaryEvent::serializeBinary(void* dstBuffer, size_t dstSize, const EventChannel* channelInfo, juce::int64 timestamp, const void* data, size_t numBytes, uint16 channel)
+{
+	if (!channelInfo
+		|| channelInfo->getChannelType() < EventChannel::BINARY_BASE_VALUE
+		|| channelInfo->getChannelType() >= EventChannel::INVALID
+		|| channel >= channelInfo->getNumChannels()
+		|| channelInfo->isBatched())
+	{
+		jassertfalse;
+		return false;
+	}
+
+	size_t dataSize = channelInfo->getDataSize();
+	size_t metaDataSize = channelInfo->getTotalEventMetaDataSize();
+	if (numBytes > dataSize || dstSize < EVENT_BASE_SIZE + dataSize + metaDataSize)
+	{
+		jassertfalse;
+		return false;
+	}
+
+	char* buffer = static_cast<char*>(dstBuffer);
+	writeHeader(buffer, channelInfo->getChannelType(), channelInfo, timestamp, channel);
+	memcpy(buffer + EVENT_BASE_SIZE, data, numBytes);
+	zeromem(buffer + EVENT_BASE_SIZE + numBytes, dataSize - numBytes + metaDataSize);
+	return true;
+}
+
+void* BinaryEvent::getMetaDataPointer(void* eventBuffer, const EventChannel* channelInfo)
+{
+	if (!eventBuffer) return nullptr;
+	return static_cast<char*>(eventBuffer) + EVENT_BASE_SIZE + channelInfo->getDataSize();
+}
+
+template<typename T>
+BinaryEventPtr BinaryEvent::createBinaryBatchEvent(const EventChannel* channelInfo, juce::int64 timestamp, const T* records, const int32* sampleOffsets, int numRecords, uint16 channel)
+{
+	EventChannel::EventChannelTypes type = getType<T>();
+	if (type == EventChannel::INVALID)
+	{
+		jassertfalse;
+		return nullptr;
+	}
+
+	if (!createChecks(channelInfo, type, channel) || !channelInfo->isBatched())
+	{
+		jassertfalse;
+		return nullptr;
+	}
+
+	if (numRecords < 1 || numRecords > int(channelInfo->getMaxRecordsPerEvent()))
+	{
+		jassertfalse;
+		return nullptr;
+	}
+
+	return new BinaryEvent(channelInfo, timestamp, channel, records, sampleOffsets, uint32(numRecords), type);
+}
+
+template<typename T>
+BinaryEventPtr BinaryEvent::createBinaryBatchEvent(const EventChannel* channelInfo, juce::int64 timestamp, const T* records, const int32* sampleOffsets, int numRecords, const MetaDataValueArray& metaData, uint16 channel)
+{
+	EventChannel::EventChannelTypes type = getType<T>();
+	if (type == EventChannel::INVALID)
+	{
+		jassertfalse;
+		return nullptr;
+	}
+
+	if (!createChecks(channelInfo, type, channel, metaData) || !channelInfo->isBatched())
+	{
+		jassertfalse;
+		return nullptr;
+	}
+
+	if (numRecords < 1 || numRecords > int(channelInfo->getMaxRecordsPerEvent()))
+	{
+		jassertfalse;
+		return nullptr;
+	}
+
+	BinaryEvent* event = new BinaryEvent(channelInfo, timestamp, channel, records, sampleOffsets, uint32(numRecords), type);
+	event->m_metaDataValues.addArray(metaData);
+	return event;
+}
+
 BinaryEventPtr BinaryEvent::deserializeFromMessage(const MidiMessage& msg, const EventChannel* channelInfo)
 {
 	size_t totalSize = msg.getRawDataSize();
 	size_t dataSize = channelInfo->getDataSize();
 	size_t metaDataSize = channelInfo->getTotalEventMetaDataSize();
+	const uint8* buffer = msg.getRawData();
+
+	//Batched events are only as long as the records they carry
+	uint32 numRecords = 1;
+	if (channelInfo->isBatched())
+	{
+		if (totalSize < EVENT_BASE_SIZE + sizeof(uint32))
+		{
+			jassertfalse;
+			return nullptr;
+		}
+		numRecords = *reinterpret_cast<const uint32*>(buffer + EVENT_BASE_SIZE);
+		if (numRecords < 1 || numRecords > channelInfo->getMaxRecordsPerEvent())
+		{
+			jassertfalse;
+			return nullptr;
+		}
+		dataSize = channelInfo->getBatchedDataSize(numRecords);
+	}
 
 	if (totalSize != (dataSize + EVENT_BASE_SIZE + metaDataSize))
 	{
 		jassertfalse;
 		return nullptr;
 	}
-	const uint8* buffer = msg.getRawData();
 	//TODO: remove the mask when the probe system is implemented
 	if (static_cast<EventType>(*(buffer + 0)&0x7F) != PROCESSOR_EVENT)
 	{
@@ -763,7 +982,15 @@ BinaryEventPtr BinaryEvent::deserializeFromMessage(const MidiMessage& msg, const
 	juce::int64 timestamp = *(reinterpret_cast<const juce::int64*>(buffer + 8));
 	uint16 channel = *(reinterpret_cast<const uint16*>(buffer + 16));
 
-	ScopedPointer<BinaryEvent> event = new BinaryEvent(channelInfo, timestamp, channel, (buffer + EVENT_BASE_SIZE), type);
+	ScopedPointer<BinaryEvent> event;
+	if (channelInfo->isBatched())
+	{
+		const uint8* payload = buffer + EVENT_BASE_SIZE;
+		event = new BinaryEvent(channelInfo, timestamp, channel, payload + sizeof(uint32) + numRecords * sizeof(int32),
+			reinterpret_cast<const int32*>(payload + sizeof(uint32)), numRecords, type);
+	}
+	else
+		event = new BinaryEvent(channelInfo, timestamp, channel, (buffer + EVENT_BASE_SIZE), type);
 	bool ret = true;
 	if (metaDataSize > 0)
 		ret = event->deserializeMetaData(channelInfo, (buffer + EVENT_BASE_SIZE + dataSize), metaDataSize);
@@ -778,6 +1005,38 @@ BinaryEventPtr BinaryEvent::deserializeFromMessage(const MidiMessage& msg, const
 }
 
 //SpikeEvent
+namespace
+{
+	/** Waveforms laid out as in a SpikeBuffer, to int16 multiples of the bitVolts of each channel */
+	void waveformsToInt16(const SpikeChannel* channelInfo, const float* source, int16* dest)
+	{
+		int nSamples = channelInfo->getTotalSamples();
+		for (int c = 0; c < channelInfo->getNumChannels(); c++)
+		{
+			float scale = 1.0f / channelInfo->getChannelBitVolts(c);
+			for (int s = 0; s < nSamples; s++)
+				dest[c*nSamples + s] = int16(jlimit(-32768, 32767, roundToInt(source[c*nSamples + s] * scale)));
+		}
+	}
+
+	/** Source may be unaligned, as it can point into an event packet */
+	void waveformsFromInt16(const SpikeChannel* channelInfo, const void* source, float* dest)
+	{
+		const char* src = static_cast<const char*>(source);
+		int nSamples = channelInfo->getTotalSamples();
+		for (int c = 0; c < channelInfo->getNumChannels(); c++)
+		{
+			float bitVolts = channelInfo->getChannelBitVolts(c);
+			for (int s = 0; s < nSamples; s++)
+			{
+				int16 value;
+				memcpy(&value, src + (c*nSamples + s) * sizeof(int16), sizeof(int16));
+				dest[c*nSamples + s] = value * bitVolts;
+			}
+		}
+	}
+}
+
 SpikeEvent::SpikeEvent(const SpikeChannel* channelInfo, juce::int64 timestamp, Array<float> thresholds, HeapBlock<float>& data, uint16 sortedID)
 	: EventBase(SPIKE_EVENT, timestamp, channelInfo->getSourceNodeID(), channelInfo->getSubProcessorIdx(), channelInfo->getSourceIndex()),
 	m_thresholds(thresholds),
@@ -796,6 +1055,12 @@ SpikeEvent::SpikeEvent(const SpikeEvent& other)
 	size_t size = m_channelInfo->getDataSize();
 	m_data.malloc(size, sizeof(char));
 	memcpy(m_data.getData(), other.m_data.getData(), size);
+	if (other.m_intData != nullptr)
+	{
+		size_t numSamples = m_channelInfo->getTotalSamples() * m_channelInfo->getNumChannels();
+		m_intData.malloc(numSamples);
+		memcpy(m_intData.getData(), other.m_intData.getData(), numSamples * sizeof(int16));
+	}
 }
 
 SpikeEvent::~SpikeEvent() {}
@@ -820,6 +1085,26 @@ const float* SpikeEvent::getDataPointer(int channel) const
 	return (m_data.getData() + (channel*m_channelInfo->getTotalSamples()));
 }
 
+const int16* SpikeEvent::getInt16DataPointer() const
+{
+	if (m_intData == nullptr)
+	{
+		m_intData.malloc(m_channelInfo->getTotalSamples() * m_channelInfo->getNumChannels());
+		waveformsToInt16(m_channelInfo, m_data.getData(), m_intData.getData());
+	}
+	return m_intData.getData();
+}
+
+const int16* SpikeEvent::getInt16DataPointer(int channel) const
+{
+	if ((channel < 0) || (channel >= m_channelInfo->getNumChannels()))
+	{
+		jassertfalse;
+		return nullptr;
+	}
+	return getInt16DataPointer() + (channel*m_channelInfo->getTotalSamples());
+}
+
 float SpikeEvent::getThreshold(int chan) const
 {
 	return m_thresholds[chan];
@@ -832,7 +1117,7 @@ const SpikeChannel* SpikeEvent::getChannelInfo() const
 
 void SpikeEvent::serialize(void* dstBuffer, size_t dstSize) const
 {
-	size_t dataSize = m_channelInfo->getDataSize();
+	size_t dataSize = m_channelInfo->getWaveformDataSize();
 	size_t eventSize = dataSize + SPIKE_BASE_SIZE + m_thresholds.size() * sizeof(float);
 	size_t totalSize = eventSize + m_channelInfo->getTotalEventMetaDataSize();
 	if (totalSize < dstSize)
@@ -856,10 +1141,46 @@ void SpikeEvent::serialize(void* dstBuffer, size_t dstSize) const
 		*(reinterpret_cast<float*>(buffer + memIdx)) = m_thresholds[i];
 		memIdx += sizeof(float);
 	}
-	memcpy((buffer + memIdx), m_data.getData(), dataSize);
+	if (m_channelInfo->hasInt16Waveforms())
+		memcpy((buffer + memIdx), getInt16DataPointer(), dataSize);
+	else
+		memcpy((buffer + memIdx), m_data.getData(), dataSize);
 	serializeMetaData(buffer + eventSize);
 }
 
+bool SpikeEvent::serializeSpike(void* dstBuffer, size_t dstSize, const SpikeChannel* channelInfo, juce::int64 timestamp, const float* thresholds, const float* data, uint16 sortedID)
+{
+	if (!channelInfo || channelInfo->getChannelType() == SpikeChannel::INVALID || channelInfo->getEventMetaDataCount() != 0)
+	{
+		jassertfalse;
+		return false;
+	}
+
+	size_t thresholdSize = channelInfo->getNumChannels() * sizeof(float);
+	size_t dataSize = channelInfo->getWaveformDataSize();
+	if (dstSize < SPIKE_BASE_SIZE + thresholdSize + dataSize)
+	{
+		jassertfalse;
+		return false;
+	}
+
+	char* buffer = static_cast<char*>(dstBuffer);
+
+	*(buffer + 0) = SPIKE_EVENT;
+	*(buffer + 1) = static_cast<char>(channelInfo->getChannelType());
+	*(reinterpret_cast<uint16*>(buffer + 2)) = channelInfo->getSourceNodeID();
+	*(reinterpret_cast<uint16*>(buffer + 4)) = channelInfo->getSubProcessorIdx();
+	*(reinterpret_cast<uint16*>(buffer + 6)) = channelInfo->getSourceIndex();
+	*(reinterpret_cast<juce::int64*>(buffer + 8)) = timestamp;
+	*(reinterpret_cast<uint16*>(buffer + 16)) = sortedID;
+	memcpy((buffer + SPIKE_BASE_SIZE), thresholds, thresholdSize);
+	if (channelInfo->hasInt16Waveforms())
+		waveformsToInt16(channelInfo, data, reinterpret_cast<int16*>(buffer + SPIKE_BASE_SIZE + thresholdSize));
+	else
+		memcpy((buffer + SPIKE_BASE_SIZE + thresholdSize), data, dataSize);
+	return true;
+}
+
 SpikeEvent* SpikeEvent::createBasicSpike(const SpikeChannel* channelInfo, juce::int64 timestamp, Array<float> thresholds, SpikeBuffer& dataSource, uint16 sortedID)
 {
 	if (!dataSource.m_ready)
@@ -941,7 +1262,7 @@ SpikeEventPtr SpikeEvent::deserializeFromMessage(const MidiMessage& msg, const S
 {
 	int nChans = channelInfo->getNumChannels();
 	size_t totalSize = msg.getRawDataSize();
-	size_t dataSize = channelInfo->getDataSize();
+	size_t dataSize = channelInfo->getWaveformDataSize();
 	size_t thresholdSize = nChans*sizeof(float);
 	size_t metaDataSize = channelInfo->getTotalEventMetaDataSize();
 
@@ -992,10 +1313,19 @@ SpikeEventPtr SpikeEvent::deserializeFromMessage(const MidiMessage& msg, const S
 	Array<float> thresholds;
 	thresholds.addArray(reinterpret_cast<const float*>(buffer + SPIKE_BASE_SIZE), nChans);
 	HeapBlock<float> data;
-	data.malloc(dataSize, sizeof(char));
-	memcpy(data.getData(), (buffer + SPIKE_BASE_SIZE + thresholdSize), dataSize);
+	data.malloc(channelInfo->getDataSize(), sizeof(char));
+	HeapBlock<int16> intData;
+	if (channelInfo->hasInt16Waveforms())
+	{
+		intData.malloc(dataSize, sizeof(char));
+		memcpy(intData.getData(), (buffer + SPIKE_BASE_SIZE + thresholdSize), dataSize);
+		waveformsFromInt16(channelInfo, intData.getData(), data.getData());
+	}
+	else
+		memcpy(data.getData(), (buffer + SPIKE_BASE_SIZE + thresholdSize), dataSize);
 
 	ScopedPointer<SpikeEvent> event = new SpikeEvent(channelInfo, timestamp, thresholds, data, sortedID);
+	event->m_intData.swapWith(intData);
 
 	bool ret = true;
 	if (metaDataSize > 0)
@@ -1047,7 +1377,7 @@ void  SpikeEvent::SpikeBuffer::set(const int chan, const float* source, const in
 		return;
 	}
 	jassert(chan >= 0 && chan < m_nChans && n <= m_nSamps);
-	memcpy(m_data.getData(), source, n*sizeof(float));
+	memcpy(m_data.getData() + chan*m_nSamps, source, n*sizeof(float));
 }
 
 void  SpikeEvent::SpikeBuffer::set(const int chan, const int start, const float* source, const int n)
@@ -1058,7 +1388,7 @@ void  SpikeEvent::SpikeBuffer::set(const int chan, const int start, const float*
 		return;
 	}
 	jassert(chan >= 0 && chan < m_nChans && (n + start) <= m_nSamps);
-	memcpy(m_data.getData() + start, source, n*sizeof(float));
+	memcpy(m_data.getData() + chan*m_nSamps + start, source, n*sizeof(float));
 }
 
 float SpikeEvent::SpikeBuffer::get(const int chan, const int samp)
@@ -1093,6 +1423,228 @@ const float* SpikeEvent::SpikeBuffer::getRawPointer()
 	return m_data.getData();
 }
 
+//Event views
+
+EventView::EventView(const MidiMessage& msg, const EventChannel* channelInfo)
+	: m_buffer(msg.getRawData()), m_channelInfo(channelInfo), m_metaDataOffset(0), m_valid(false)
+{
+	if (!channelInfo)
+		return;
+
+	size_t totalSize = msg.getRawDataSize();
+	size_t dataSize = channelInfo->getDataSize();
+	if (channelInfo->isBatched())
+	{
+		if (totalSize < EVENT_BASE_SIZE + sizeof(uint32))
+			return;
+		uint32 numRecords = *reinterpret_cast<const uint32*>(m_buffer + EVENT_BASE_SIZE);
+		if (numRecords < 1 || numRecords > channelInfo->getMaxRecordsPerEvent())
+			return;
+		dataSize = channelInfo->getBatchedDataSize(numRecords);
+	}
+	if (totalSize != (dataSize + EVENT_BASE_SIZE + channelInfo->getTotalEventMetaDataSize()))
+		return;
+	m_metaDataOffset = EVENT_BASE_SIZE + dataSize;
+
+	//TODO: remove the mask when the probe system is implemented
+	m_valid = static_cast<EventType>(*(m_buffer + 0) & 0x7F) == PROCESSOR_EVENT
+		&& static_cast<EventChannel::EventChannelTypes>(*(m_buffer + 1)) == channelInfo->getChannelType()
+		&& *reinterpret_cast<const uint16*>(m_buffer + 2) == channelInfo->getSourceNodeID()
+		&& *reinterpret_cast<const uint16*>(m_buffer + 4) == channelInfo->getSubProcessorIdx()
+		&& *reinterpret_cast<const uint16*>(m_buffer + 6) == channelInfo->getSourceIndex();
+}
+
+bool EventView::isValid() const
+{
+	return m_valid;
+}
+
+MetaDataEventReader EventView::getMetaData() const
+{
+	jassert(m_valid);
+	return MetaDataEventReader(m_channelInfo, m_buffer + m_metaDataOffset);
+}
+
+EventChannel::EventChannelTypes EventView::getEventType() const
+{
+	return static_cast<EventChannel::EventChannelTypes>(*(m_buffer + 1));
+}
+
+const EventChannel* EventView::getChannelInfo() const
+{
+	return m_channelInfo;
+}
+
+juce::int64 EventView::getTimestamp() const
+{
+	return *reinterpret_cast<const juce::int64*>(m_buffer + 8);
+}
+
+uint16 EventView::getChannel() const
+{
+	return *reinterpret_cast<const uint16*>(m_buffer + 16);
+}
+
+const void* EventView::getRawDataPointer() const
+{
+	return m_buffer + EVENT_BASE_SIZE;
+}
+
+TTLEventView::TTLEventView(const MidiMessage& msg, const EventChannel* channelInfo)
+	: EventView(msg, channelInfo)
+{
+	m_valid = m_valid && channelInfo->getChannelType() == EventChannel::TTL;
+}
+
+bool TTLEventView::getState() const
+{
+	int byteIndex = getChannel() / 8;
+	int bitIndex = getChannel() % 8;
+
+	char data = *(m_buffer + EVENT_BASE_SIZE + byteIndex);
+	return ((1 << bitIndex) & data);
+}
+
+const void* TTLEventView::getTTLWordPointer() const
+{
+	return getRawDataPointer();
+}
+
+SpikeEventView::SpikeEventView(const MidiMessage& msg, const SpikeChannel* channelInfo)
+	: m_buffer(msg.getRawData()), m_channelInfo(channelInfo), m_valid(false)
+{
+	if (!channelInfo || channelInfo->getChannelType() == SpikeChannel::INVALID)
+		return;
+
+	size_t totalSize = msg.getRawDataSize();
+	size_t thresholdSize = channelInfo->getNumChannels() * sizeof(float);
+	if (totalSize != (thresholdSize + channelInfo->getWaveformDataSize() + SPIKE_BASE_SIZE + channelInfo->getTotalEventMetaDataSize()))
+		return;
+
+	//TODO: remove the mask when the probe system is implemented
+	m_valid = static_cast<EventType>(*(m_buffer + 0) & 0x7F) == SPIKE_EVENT
+		&& static_cast<SpikeChannel::ElectrodeTypes>(*(m_buffer + 1)) == channelInfo->getChannelType()
+		&& *reinterpret_cast<const uint16*>(m_buffer + 2) == channelInfo->getSourceNodeID()
+		&& *reinterpret_cast<const uint16*>(m_buffer + 4) == channelInfo->getSubProcessorIdx()
+		&& *reinterpret_cast<const uint16*>(m_buffer + 6) == channelInfo->getSourceIndex();
+}
+
+bool SpikeEventView::isValid() const
+{
+	return m_valid;
+}
+
+const SpikeChannel* SpikeEventView::getChannelInfo() const
+{
+	return m_channelInfo;
+}
+
+juce::int64 SpikeEventView::getTimestamp() const
+{
+	return *reinterpret_cast<const juce::int64*>(m_buffer + 8);
+}
+
+uint16 SpikeEventView::getSourceID() const
+{
+	return *reinterpret_cast<const uint16*>(m_buffer + 2);
+}
+
+uint16 SpikeEventView::getSubProcessorIdx() const
+{
+	return *reinterpret_cast<const uint16*>(m_buffer + 4);
+}
+
+uint16 SpikeEventView::getSourceIndex() const
+{
+	return *reinterpret_cast<const uint16*>(m_buffer + 6);
+}
+
+uint16 SpikeEventView::getSortedID() const
+{
+	return *reinterpret_cast<const uint16*>(m_buffer + 16);
+}
+
+float SpikeEventView::getThreshold(int chan) const
+{
+	return reinterpret_cast<const float*>(m_buffer + SPIKE_BASE_SIZE)[chan];
+}
+
+bool SpikeEventView::hasInt16Data() const
+{
+	return m_channelInfo->hasInt16Waveforms();
+}
+
+const float* SpikeEventView::getDataPointer() const
+{
+	if (hasInt16Data())
+		return nullptr;
+	return reinterpret_cast<const float*>(m_buffer + SPIKE_BASE_SIZE + m_channelInfo->getNumChannels() * sizeof(float));
+}
+
+const float* SpikeEventView::getDataPointer(int channel) const
+{
+	if ((channel < 0) || (channel >= m_channelInfo->getNumChannels()) || hasInt16Data())
+	{
+		jassertfalse;
+		return nullptr;
+	}
+	return getDataPointer() + (channel*m_channelInfo->getTotalSamples());
+}
+
+const int16* SpikeEventView::getInt16DataPointer() const
+{
+	if (!hasInt16Data())
+		return nullptr;
+	return reinterpret_cast<const int16*>(m_buffer + SPIKE_BASE_SIZE + m_channelInfo->getNumChannels() * sizeof(float));
+}
+
+const int16* SpikeEventView::getInt16DataPointer(int channel) const
+{
+	if ((channel < 0) || (channel >= m_channelInfo->getNumChannels()) || !hasInt16Data())
+	{
+		jassertfalse;
+		return nullptr;
+	}
+	return getInt16DataPointer() + (channel*m_channelInfo->getTotalSamples());
+}
+
+float SpikeEventView::getSample(int channel, int sample) const
+{
+	const uint8* data = m_buffer + SPIKE_BASE_SIZE + m_channelInfo->getNumChannels() * sizeof(float);
+	int index = channel * m_channelInfo->getTotalSamples() + sample;
+	if (hasInt16Data())
+	{
+		int16 value;
+		memcpy(&value, data + index * sizeof(int16), sizeof(int16));
+		return value * m_channelInfo->getChannelBitVolts(channel);
+	}
+	float value;
+	memcpy(&value, data + index * sizeof(float), sizeof(float));
+	return value;
+}
+
+void SpikeEventView::copyData(float* dest) const
+{
+	const uint8* data = m_buffer + SPIKE_BASE_SIZE + m_channelInfo->getNumChannels() * sizeof(float);
+	if (hasInt16Data())
+		waveformsFromInt16(m_channelInfo, data, dest);
+	else
+		memcpy(dest, data, m_channelInfo->getDataSize());
+}
+
+void SpikeEventView::copyInt16Data(int16* dest) const
+{
+	const uint8* data = m_buffer + SPIKE_BASE_SIZE + m_channelInfo->getNumChannels() * sizeof(float);
+	if (hasInt16Data())
+	{
+		memcpy(dest, data, m_channelInfo->getWaveformDataSize());
+		return;
+	}
+	HeapBlock<float> floatData(m_channelInfo->getTotalSamples() * m_channelInfo->getNumChannels());
+	memcpy(floatData.getData(), data, m_channelInfo->getDataSize());
+	waveformsToInt16(m_channelInfo, floatData.getData(), dest);
+}
+
 //Template definitions
 template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryEvent<int8>(const EventChannel*, juce::int64, const int8* data, int, uint16);
 template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryEvent<uint8>(const EventChannel*, juce::int64, const uint8* data, int, uint16);
@@ -1115,3 +1667,25 @@ template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryEvent<juce::int64>(c
 template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryEvent<juce::uint64>(const EventChannel*, juce::int64, const juce::uint64* data, int, const MetaDataValueArray&, uint16);
 template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryEvent<float>(const EventChannel*, juce::int64, const float* data, int, const MetaDataValueArray&, uint16);
 template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryEvent<double>(const EventChannel*, juce::int64, const double* data, int, const MetaDataValueArray&, uint16);
+
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<int8>(const EventChannel*, juce::int64, const int8* records, const int32*, int, uint16);
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<uint8>(const EventChannel*, juce::int64, const uint8* records, const int32*, int, uint16);
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<int16>(const EventChannel*, juce::int64, const int16* records, const int32*, int, uint16);
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<uint16>(const EventChannel*, juce::int64, const uint16* records, const int32*, int, uint16);
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<int32>(const EventChannel*, juce::int64, const int32* records, const int32*, int, uint16);
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<uint32>(const EventChannel*, juce::int64, const uint32* records, const int32*, int, uint16);
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<juce::int64>(const EventChannel*, juce::int64, const juce::int64* records, const int32*, int, uint16);
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<juce::uint64>(const EventChannel*, juce::int64, const juce::uint64* records, const int32*, int, uint16);
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<float>(const EventChannel*, juce::int64, const float* records, const int32*, int, uint16);
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<double>(const EventChannel*, juce::int64, const double* records, const int32*, int, uint16);
+
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<int8>(const EventChannel*, juce::int64, const int8* records, const int32*, int, const MetaDataValueArray&, uint16);
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<uint8>(const EventChannel*, juce::int64, const uint8* records, const int32*, int, const MetaDataValueArray&, uint16);
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<int16>(const EventChannel*, juce::int64, const int16* records, const int32*, int, const MetaDataValueArray&, uint16);
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<uint16>(const EventChannel*, juce::int64, const uint16* records, const int32*, int, const MetaDataValueArray&, uint16);
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<int32>(const EventChannel*, juce::int64, const int32* records, const int32*, int, const MetaDataValueArray&, uint16);
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<uint32>(const EventChannel*, juce::int64, const uint32* records, const int32*, int, const MetaDataValueArray&, uint16);
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<juce::int64>(const EventChannel*, juce::int64, const juce::int64* records, const int32*, int, const MetaDataValueArray&, uint16);
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<juce::uint64>(const EventChannel*, juce::int64, const juce::uint64* records, const int32*, int, const MetaDataValueArray&, uint16);
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<float>(const EventChannel*, juce::int64, const float* records, const int32*, int, const MetaDataValueArray&, uint16);
+template PLUGIN_API BinaryEventPtr BinaryEvent::createBinaryBatchEvent<double>(const EventChannel*, juce::int64, const double* records, const int32*, int, const MetaDataValueArray&, uint16);
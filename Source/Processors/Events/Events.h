@@ -28,6 +28,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "../Channel/InfoObjects.h"
 #define EVENT_BASE_SIZE 18
 #define SPIKE_BASE_SIZE 18
+#define TIMESTAMP_AND_SAMPLES_SIZE 20
 
 class GenericProcessor;
 
@@ -119,6 +120,8 @@ class PLUGIN_API SystemEvent
 {
 public:
 	static size_t fillTimestampAndSamplesData(HeapBlock<char>& data, const GenericProcessor* proc, int16 subProcessorIdx, juce::int64 timestamp, uint32 nSamples);
+	/** Writes a TIMESTAMP_AND_SAMPLES packet into a buffer of at least TIMESTAMP_AND_SAMPLES_SIZE bytes */
+	static void writeTimestampAndSamplesData(void* data, const GenericProcessor* proc, int16 subProcessorIdx, juce::int64 timestamp, uint32 nSamples);
 	static size_t fillTimestampSyncTextData(HeapBlock<char>& data, const GenericProcessor* proc, int16 subProcessorIdx, juce::int64 timestamp, bool softwareTime = false);
 	static SystemEventType getSystemEventType(const MidiMessage& msg);
 	static uint32 getNumSamples(const MidiMessage& msg);
@@ -146,6 +149,9 @@ public:
 	/* Gets the raw data payload */
 	const void* getRawDataPointer() const;
 
+	/** Gets the number of bytes serialize() writes, header and metadata included*/
+	size_t getSerializedSize() const;
+
 	static EventChannel::EventChannelTypes getEventType(const MidiMessage& msg);
 	static EventPtr deserializeFromMessage(const MidiMessage& msg, const EventChannel* channelInfo);
 
@@ -153,6 +159,10 @@ protected:
 	Event(const EventChannel* channelInfo, juce::int64 timestamp, uint16 channel);
 	Event() = delete;
 	bool serializeHeader(EventChannel::EventChannelTypes type, char* buffer, size_t dstSize) const;
+	/** Size of the payload this event serializes, the channel data size unless the event is batched*/
+	virtual size_t getPayloadSize() const;
+	/** Writes the header of an event of the given channel, for the serializers that work without an event object*/
+	static void writeHeader(char* buffer, EventChannel::EventChannelTypes type, const EventChannel* channelInfo, juce::int64 timestamp, uint16 channel);
 	static bool createChecks(const EventChannel* channelInfo, EventChannel::EventChannelTypes eventType, uint16 channel);
 	static bool createChecks(const EventChannel* channelInfo, EventChannel::EventChannelTypes eventType, uint16 channel, const MetaDataValueArray& metaData);
 
@@ -183,6 +193,12 @@ public:
 	static TTLEventPtr createTTLEvent(const EventChannel* channelInfo, juce::int64 timestamp, const void* eventData, int dataSize, uint16 channel);
 	static TTLEventPtr createTTLEvent(const EventChannel* channelInfo, juce::int64 timestamp, const void* eventData, int dataSize, const MetaDataValueArray& metaData, uint16 channel);
 	static TTLEventPtr deserializeFromMessage(const MidiMessage& msg, const EventChannel* channelInfo);
+
+	/** Writes a TTL event for a channel without metadata straight into dstBuffer, which must
+	hold at least EVENT_BASE_SIZE + channelInfo->getDataSize() bytes. Only getDataSize()
+	bytes are read from eventData. Lets high-rate producers emit edges without creating a
+	TTLEvent object for each one. Returns false if the arguments do not describe a valid event. */
+	static bool serializeTTL(void* dstBuffer, size_t dstSize, const EventChannel* channelInfo, juce::int64 timestamp, const void* eventData, uint16 channel);
 private:
 	TTLEvent() = delete;
 	TTLEvent(const EventChannel* channelInfo, juce::int64 timestamp, uint16 channel, const void* eventData);
@@ -205,6 +221,12 @@ public:
 	static TextEventPtr createTextEvent(const EventChannel* channelInfo, juce::int64 timestamp, const String& text, uint16 channel = 0);
 	static TextEventPtr createTextEvent(const EventChannel* channelInfo, juce::int64 timestamp, const String& text, const MetaDataValueArray& metaData, uint16 channel = 0);
 	static TextEventPtr deserializeFromMessage(const MidiMessage& msg, const EventChannel* channelInfo);
+
+	/** Writes a text event for a channel without metadata straight into dstBuffer, which must hold at
+	least EVENT_BASE_SIZE + channelInfo->getDataSize() bytes. The numBytes bytes of UTF-8 text are
+	zero padded to the channel size. Lets callers with the text already in a buffer send it without
+	building a String or a TextEvent. Returns false if the arguments do not describe a valid event. */
+	static bool serializeText(void* dstBuffer, size_t dstSize, const EventChannel* channelInfo, juce::int64 timestamp, const char* text, size_t numBytes, uint16 channel = 0);
 private:
 	TextEvent() = delete;
 	TextEvent(const EventChannel* channelInfo, juce::int64 timestamp, uint16 channel, const String& text);
@@ -223,25 +245,64 @@ public:
 
 	void serialize(void* dstBuffer, size_t dstSize) const override;
 
+	/** Gets the event data. For batched events, the records, stored one after another*/
 	const void* getBinaryDataPointer() const;
 	EventChannel::EventChannelTypes getBinaryType() const;
 
+	/** Gets the number of records in the event. Always 1 for events of non-batched channels*/
+	int getNumRecords() const;
+
+	/** Gets a record of getChannelInfo()->getRecordSize() bytes*/
+	const void* getRecordPointer(int record) const;
+
+	/** Gets the sample offset of the record relative to the event timestamp. Always 0 for non-batched events*/
+	int32 getRecordSampleOffset(int record) const;
+
+	/** Gets the timestamp of a record, the event timestamp plus the record offset*/
+	juce::int64 getRecordTimestamp(int record) const;
+
 	template<typename T>
 	static BinaryEventPtr createBinaryEvent(const EventChannel* channelInfo, juce::int64 timestamp, const T* data, int dataSize, uint16 channel = 0);
 
 	template<typename T>
 	static BinaryEventPtr createBinaryEvent(const EventChannel* channelInfo, juce::int64 timestamp, const T* data, int dataSize, const MetaDataValueArray& metaData, uint16 channel = 0);
 
+	/** Creates an event for a batched channel.
+	@param records numRecords records of channelInfo->getLength() elements, one after another
+	@param sampleOffsets numRecords offsets, in samples, of each record relative to timestamp. Can be null if all are 0
+	@param numRecords Between 1 and channelInfo->getMaxRecordsPerEvent()
+	*/
+	template<typename T>
+	static BinaryEventPtr createBinaryBatchEvent(const EventChannel* channelInfo, juce::int64 timestamp, const T* records, const int32* sampleOffsets, int numRecords, uint16 channel = 0);
+
+	template<typename T>
+	static BinaryEventPtr createBinaryBatchEvent(const EventChannel* channelInfo, juce::int64 timestamp, const T* records, const int32* sampleOffsets, int numRecords, const MetaDataValueArray& metaData, uint16 channel = 0);
+
 	static BinaryEventPtr deserializeFromMessage(const MidiMessage& msg, const EventChannel* channelInfo);
-	
+
+	/** Writes an event of a non-batched binary channel straight into dstBuffer, which must hold at least
+	EVENT_BASE_SIZE + channelInfo->getDataSize() + channelInfo->getTotalEventMetaDataSize() bytes.
+	The numBytes bytes of data are zero padded to the channel size and the metadata block is zeroed,
+	to be filled in place through a MetaDataEventWriter on getMetaDataPointer(). Returns false if the
+	arguments do not describe a valid event. */
+	static bool serializeBinary(void* dstBuffer, size_t dstSize, const EventChannel* channelInfo, juce::int64 timestamp, const void* data, size_t numBytes, uint16 channel = 0);
+
+	/** Gets the metadata block of an event written by serializeBinary */
+	static void* getMetaDataPointer(void* eventBuffer, const EventChannel* channelInfo);
+
+protected:
+	size_t getPayloadSize() const override;
+
 private:
 	BinaryEvent() = delete;
 	BinaryEvent(const EventChannel* channelInfo, juce::int64 timestamp, uint16 channel, const void* data, EventChannel::EventChannelTypes type);
+	BinaryEvent(const EventChannel* channelInfo, juce::int64 timestamp, uint16 channel, const void* records, const int32* sampleOffsets, uint32 numRecords, EventChannel::EventChannelTypes type);
 	
 	template<typename T>
 	static EventChannel::EventChannelTypes getType();
 
 	const EventChannel::EventChannelTypes m_type;
+	const uint32 m_numRecords;
 	JUCE_LEAK_DETECTOR(BinaryEvent);
 };
 
@@ -292,6 +353,13 @@ public:
 
 	const float* getDataPointer(int channel) const;
 
+	/** Waveforms as int16 multiples of the bitVolts of each channel, channel after channel. For channels
+	with int16 waveforms these are the values the event was created from, for the others they are
+	converted on the first call */
+	const int16* getInt16DataPointer() const;
+
+	const int16* getInt16DataPointer(int channel) const;
+
 	float getThreshold(int chan) const;
 
 	uint16 getSortedID() const;
@@ -300,6 +368,13 @@ public:
 	static SpikeEventPtr createSpikeEvent(const SpikeChannel* channelInfo, juce::int64 timestamp, Array<float> thresholds, SpikeBuffer& dataSource, uint16 sortedID, const MetaDataValueArray& metaData);
 
 	static SpikeEventPtr deserializeFromMessage(const MidiMessage& msg, const SpikeChannel* channelInfo);
+
+	/** Writes a spike for a channel without metadata straight into dstBuffer, which must hold at least
+	SPIKE_BASE_SIZE + channelInfo->getNumChannels() * sizeof(float) + channelInfo->getWaveformDataSize() bytes.
+	thresholds holds one value per channel and data the waveforms, channel after channel, laid out as
+	in a SpikeBuffer. Lets detectors reuse their own storage instead of building a SpikeBuffer and a
+	SpikeEvent for each spike. Returns false if the arguments do not describe a valid spike. */
+	static bool serializeSpike(void* dstBuffer, size_t dstSize, const SpikeChannel* channelInfo, juce::int64 timestamp, const float* thresholds, const float* data, uint16 sortedID = 0);
 private:
 	SpikeEvent() = delete;
 	SpikeEvent(const SpikeChannel* channelInfo, juce::int64 timestamp, Array<float> thresholds, HeapBlock<float>& data, uint16 sortedID);
@@ -309,8 +384,99 @@ private:
 	const SpikeChannel* m_channelInfo;
 	const uint16 m_sortedID;
 	HeapBlock<float> m_data;
+	mutable HeapBlock<int16> m_intData;
 	JUCE_LEAK_DETECTOR(SpikeEvent);
 };
 
+/**
+Non-owning views over a serialized event or spike.
+
+They read the fields straight from the bytes of the MidiMessage they are built on, without
+allocating or copying anything, and are only valid as long as that message is. This is
+enough for handlers that just look at a few fields. Use the deserializeFromMessage methods
+when the event needs to be kept after the handler returns.
+
+A view built on data that doesn't match the given channel is not valid, and its other
+accessors must not be used.
+*/
+class PLUGIN_API EventView
+{
+public:
+	EventView(const MidiMessage& msg, const EventChannel* channelInfo);
+
+	bool isValid() const;
+
+	EventChannel::EventChannelTypes getEventType() const;
+	const EventChannel* getChannelInfo() const;
+	juce::int64 getTimestamp() const;
+
+	/** Gets the channel that triggered the event */
+	uint16 getChannel() const;
+
+	/* Gets the raw data payload */
+	const void* getRawDataPointer() const;
+
+	/** Reads the event metadata in place */
+	MetaDataEventReader getMetaData() const;
+
+protected:
+	const uint8* m_buffer;
+	const EventChannel* m_channelInfo;
+	size_t m_metaDataOffset;
+	bool m_valid;
+};
+
+class PLUGIN_API TTLEventView
+	: public EventView
+{
+public:
+	TTLEventView(const MidiMessage& msg, const EventChannel* channelInfo);
+
+	/** Gets the state true ='1' false = '0'*/
+	bool getState() const;
+
+	const void* getTTLWordPointer() const;
+};
+
+class PLUGIN_API SpikeEventView
+{
+public:
+	SpikeEventView(const MidiMessage& msg, const SpikeChannel* channelInfo);
+
+	bool isValid() const;
+
+	const SpikeChannel* getChannelInfo() const;
+	juce::int64 getTimestamp() const;
+	uint16 getSourceID() const;
+	uint16 getSubProcessorIdx() const;
+	uint16 getSourceIndex() const;
+	uint16 getSortedID() const;
+	float getThreshold(int chan) const;
+
+	/** Returns true if the waveforms are carried as int16, see SpikeChannel::setInt16Waveforms */
+	bool hasInt16Data() const;
+
+	/** Waveform samples, channel after channel. The pointer is into the event packet,
+	so it may not be aligned to a float boundary. Null for int16 waveforms. */
+	const float* getDataPointer() const;
+	const float* getDataPointer(int channel) const;
+
+	/** Same for int16 waveforms, null for float ones */
+	const int16* getInt16DataPointer() const;
+	const int16* getInt16DataPointer(int channel) const;
+
+	/** Reads one sample of either encoding, in the units of the float waveforms */
+	float getSample(int channel, int sample) const;
+
+	/** Copies the waveforms, converting them if the event carries the other encoding */
+	void copyData(float* dest) const;
+	void copyInt16Data(int16* dest) const;
+
+private:
+	const uint8* m_buffer;
+	const SpikeChannel* m_channelInfo;
+	bool m_valid;
+};
+
 
 #endif
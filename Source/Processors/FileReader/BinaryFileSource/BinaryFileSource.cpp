@@ -23,9 +23,67 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "BinaryFileSource.h"
 
+#include <algorithm>
+#include <limits>
+
+#if JUCE_LINUX || JUCE_MAC
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 using namespace BinarySource;
 
-BinaryFileSource::BinaryFileSource() : m_samplePos(0)
+//Columns of each row of continuous_index.npy
+#define INDEX_SAMPLE 0
+#define INDEX_OFFSET 1
+#define INDEX_ROW_SIZE 4
+
+namespace
+{
+	//Returns the array stored in a mapped .npy file and its size in bytes, or nullptr if the header isn't valid
+	const char* getNpyData(const MemoryMappedFile& file, size_t& dataBytes)
+	{
+		const char* data = static_cast<const char*>(file.getData());
+		size_t size = file.getSize();
+		if (data == nullptr || size < 10 || memcmp(data, "\x93NUMPY", 6) != 0)
+			return nullptr;
+
+		//Header length field is 2 bytes in version 1.0 files and 4 bytes in later versions
+		size_t headerEnd;
+		if (data[6] == 1)
+			headerEnd = 10 + (uint8(data[8]) | (uint8(data[9]) << 8));
+		else if (size >= 12)
+			headerEnd = 12 + ByteOrder::littleEndianInt(data + 8);
+		else
+			return nullptr;
+		if (headerEnd > size)
+			return nullptr;
+
+		dataBytes = size - headerEnd;
+		return data + headerEnd;
+	}
+
+	//Index of the record a folder of events or spikes belongs to, by processor, or -1
+	int findEventRecord(const Array<var>& records, const String& folderName, int sourceId, int sourceSubIdx, float sampleRate)
+	{
+		for (int i = 0; i < records.size(); i++)
+		{
+			String recordFolder = records[i]["folder_name"].toString().trimCharactersAtEnd("/");
+			if (folderName.startsWith(recordFolder + "/"))
+				return i;
+			if (sourceId >= 0 && int(records[i]["source_processor_id"]) == sourceId
+				&& int(records[i]["source_processor_sub_idx"]) == sourceSubIdx)
+				return i;
+		}
+
+		//Events from a processor downstream of the source, which can only go with a single record
+		if (records.size() == 1 && float(records[0]["sample_rate"]) == sampleRate)
+			return 0;
+		return -1;
+	}
+}
+
+BinaryFileSource::BinaryFileSource() : m_indexData(nullptr), m_indexRows(0), m_indexInterval(0), m_samplePos(0), m_startTimestamp(0)
 {}
 
 BinaryFileSource::~BinaryFileSource()
@@ -60,8 +118,12 @@ void BinaryFileSource::fillRecordInfo()
 	Identifier idChannels("channels");
 	Identifier idChannelName("channel_name");
 	Identifier idBitVolts("bit_volts");
+	Identifier idIndexFile("index_file");
+	Identifier idIndexInterval("index_interval");
+	Identifier idTimestampRuns("timestamp_runs_file");
 
 	int numProcessors = continuousData.size();
+	Array<var> records;
 
 	for (int i = 0; i < numProcessors; i++)
 	{
@@ -101,15 +163,292 @@ void BinaryFileSource::fillRecordInfo()
 		numRecords++;	
 
 		m_dataFileArray.add(dataFile);
+		records.add(record);
+
+		//Event and spike timestamps count from the same origin, so the first sample's locates them.
+		//Sparse timestamps are (sample, timestamp) rows, the first one starting at sample 0
+		String runsName = record[idTimestampRuns];
+		const size_t timestampOffset = runsName.isNotEmpty() ? sizeof(int64) : 0;
+		int64 startTimestamp = 0;
+		MemoryMappedFile timestampFile(dataFile.getSiblingFile(runsName.isNotEmpty() ? runsName : "timestamps.npy"), MemoryMappedFile::readOnly);
+		size_t timestampBytes = 0;
+		const char* timestamps = getNpyData(timestampFile, timestampBytes);
+		if (timestamps != nullptr && timestampBytes >= timestampOffset + sizeof(int64))
+			memcpy(&startTimestamp, timestamps + timestampOffset, sizeof(int64));
+		m_startTimestampArray.add(startTimestamp);
+
+		//Recordings made before the index was introduced don't have one
+		String indexName = record[idIndexFile];
+		if (indexName.isNotEmpty())
+		{
+			m_indexFileArray.add(dataFile.getSiblingFile(indexName));
+			m_indexIntervalArray.add(record[idIndexInterval]);
+		}
+		else
+		{
+			m_indexFileArray.add(File::nonexistent);
+			m_indexIntervalArray.add(0);
+		}
 		
 	}
 
+	fillEventInfo(records);
+}
+
+void BinaryFileSource::fillEventInfo(const Array<var>& records)
+{
+	Identifier idFolder("folder_name");
+	Identifier idSampleRate("sample_rate");
+	Identifier idChannelName("channel_name");
+	Identifier idNumChannels("num_channels");
+
+	var eventData = m_jsonData["events"];
+	for (int i = 0; i < eventData.size(); i++)
+	{
+		var events = eventData[i];
+		String folderName = events[idFolder].toString().trimCharactersAtEnd("/");
+		String groupName = folderName.fromLastOccurrenceOf("/", false, false);
+
+		RecordedEventChannelInfo chan;
+		if (groupName.startsWith("TTL"))
+			chan.kind = RecordedEventChannelInfo::TTL;
+		else if (groupName.startsWith("TEXT_group"))
+			chan.kind = RecordedEventChannelInfo::TEXT;
+		else
+			continue; //binary events aren't played back
+
+		chan.name = events[idChannelName];
+		chan.sampleRate = events[idSampleRate];
+		chan.numChannels = events[idNumChannels];
+		chan.textLength = 0;
+		chan.prePeakSamples = 0;
+		chan.postPeakSamples = 0;
+
+		int record = findEventRecord(records, folderName, -1, 0, chan.sampleRate);
+		if (record < 0 || chan.numChannels <= 0)
+			continue;
+
+		EventFolder folder;
+		folder.record = record;
+		folder.folder = m_rootPath.getChildFile("events").getChildFile(folderName);
+		folder.kind = chan.kind;
+		folder.firstChannel = infoArray.getReference(record).eventChannels.size();
+		folder.numChannels = 1;
+		m_eventFolders.add(folder);
+		infoArray.getReference(record).eventChannels.add(chan);
+	}
+
+	var spikeData = m_jsonData["spikes"];
+	for (int i = 0; i < spikeData.size(); i++)
+	{
+		var spikes = spikeData[i];
+		var electrodes = spikes["channels"];
+		if (electrodes.size() <= 0)
+			continue;
+
+		String folderName = spikes[idFolder].toString().trimCharactersAtEnd("/");
+		float sampleRate = spikes[idSampleRate];
+		var firstSources = electrodes[0]["source_channel_info"];
+		int sourceId = -1;
+		int sourceSubIdx = 0;
+		if (firstSources.size() > 0)
+		{
+			sourceId = firstSources[0]["source_processor_id"];
+			sourceSubIdx = firstSources[0]["source_processor_sub_idx"];
+		}
+		int record = findEventRecord(records, String(), sourceId, sourceSubIdx, sampleRate);
+		if (record < 0)
+			continue;
+
+		RecordInfo& info = infoArray.getReference(record);
+		var recordChannels = records[record]["channels"];
+
+		EventFolder folder;
+		folder.record = record;
+		folder.folder = m_rootPath.getChildFile("spikes").getChildFile(folderName);
+		folder.kind = RecordedEventChannelInfo::SPIKE;
+		folder.firstChannel = info.eventChannels.size();
+		folder.numChannels = electrodes.size();
+
+		for (int e = 0; e < electrodes.size(); e++)
+		{
+			var sources = electrodes[e]["source_channel_info"];
+
+			RecordedEventChannelInfo chan;
+			chan.kind = RecordedEventChannelInfo::SPIKE;
+			chan.name = electrodes[e][idChannelName];
+			chan.sampleRate = sampleRate;
+			chan.numChannels = sources.size();
+			chan.textLength = 0;
+			chan.prePeakSamples = int(spikes["pre_peak_samples"]);
+			chan.postPeakSamples = int(spikes["post_peak_samples"]);
+
+			//Find the recorded channel each electrode channel came from, by its index in the source processor
+			for (int c = 0; c < sources.size(); c++)
+			{
+				int sourceChannel = sources[c]["source_processor_channel"];
+				int recorded = jlimit(0, info.channels.size() - 1, sourceChannel);
+				for (int r = 0; r < recordChannels.size(); r++)
+				{
+					if (int(recordChannels[r]["source_processor_index"]) == sourceChannel)
+					{
+						recorded = r;
+						break;
+					}
+				}
+				chan.sourceChannels.add(recorded);
+			}
+			info.eventChannels.add(chan);
+		}
+		m_eventFolders.add(folder);
+	}
 }
 
 void BinaryFileSource::updateActiveRecord()
 {
 	m_dataFile = new MemoryMappedFile(m_dataFileArray[activeRecord.get()], MemoryMappedFile::readOnly);
 	m_samplePos = 0;
+
+#if JUCE_LINUX || JUCE_MAC
+	//Playback walks the file front to back, so aggressive readahead and early eviction suit it
+	if (m_dataFile->getData() != nullptr)
+		madvise(m_dataFile->getData(), m_dataFile->getSize(), MADV_SEQUENTIAL);
+#endif
+
+	m_indexInterval = m_indexIntervalArray[activeRecord.get()];
+	if (!openIndex(m_indexFileArray[activeRecord.get()]))
+	{
+		m_indexFile = nullptr;
+		m_indexData = nullptr;
+		m_indexRows = 0;
+	}
+
+	openEventStreams();
+}
+
+const void* BinaryFileSource::EventStream::map(const File& file, size_t rowBytes)
+{
+	if (!file.existsAsFile() || rowBytes == 0)
+		return nullptr;
+
+	MemoryMappedFile* mapped = files.add(new MemoryMappedFile(file, MemoryMappedFile::readOnly));
+	size_t dataBytes = 0;
+	const char* data = getNpyData(*mapped, dataBytes);
+
+	//Count rows from the file size, as for the index, and play only as many as every array has
+	if (data != nullptr)
+		numEvents = jmin(numEvents, int64(dataBytes / rowBytes));
+	return data;
+}
+
+void BinaryFileSource::openEventStreams()
+{
+	m_eventStreams.clear();
+	m_startTimestamp = m_startTimestampArray[activeRecord.get()];
+	RecordInfo& info = infoArray.getReference(activeRecord.get());
+
+	for (int i = 0; i < m_eventFolders.size(); i++)
+	{
+		const EventFolder& folder = m_eventFolders.getReference(i);
+		if (folder.record != activeRecord.get())
+			continue;
+
+		ScopedPointer<EventStream> stream = new EventStream();
+		stream->kind = folder.kind;
+		stream->firstChannel = folder.firstChannel;
+		stream->numChannels = folder.numChannels;
+		stream->numEvents = std::numeric_limits<int64>::max();
+		stream->cursor = 0;
+		stream->states = nullptr;
+		stream->text = nullptr;
+		stream->textBytes = 0;
+		stream->waveforms = nullptr;
+		stream->waveformSize = 0;
+		stream->electrodes = nullptr;
+		stream->clusters = nullptr;
+		stream->bitVolts = 0;
+
+		const RecordedEventChannelInfo& chan = info.eventChannels.getReference(folder.firstChannel);
+		bool valid;
+
+		switch (folder.kind)
+		{
+		case RecordedEventChannelInfo::TTL:
+			stream->timestamps = static_cast<const int64*>(stream->map(folder.folder.getChildFile("timestamps.npy"), sizeof(int64)));
+			stream->states = static_cast<const int16*>(stream->map(folder.folder.getChildFile("channel_states.npy"), sizeof(int16)));
+			valid = stream->timestamps != nullptr && stream->states != nullptr;
+			break;
+		case RecordedEventChannelInfo::TEXT:
+		{
+			stream->timestamps = static_cast<const int64*>(stream->map(folder.folder.getChildFile("timestamps.npy"), sizeof(int64)));
+			valid = stream->timestamps != nullptr && stream->numEvents > 0;
+			if (!valid)
+				break;
+
+			//The text length isn't in the json file, but each row of text.npy is one message
+			MemoryMappedFile* textFile = stream->files.add(new MemoryMappedFile(folder.folder.getChildFile("text.npy"), MemoryMappedFile::readOnly));
+			size_t textBytes = 0;
+			stream->text = getNpyData(*textFile, textBytes);
+			stream->textBytes = size_t(textBytes / stream->numEvents);
+			valid = stream->text != nullptr && stream->textBytes > 0;
+			if (valid)
+				info.eventChannels.getReference(folder.firstChannel).textLength = (unsigned int)stream->textBytes;
+			break;
+		}
+		case RecordedEventChannelInfo::SPIKE:
+			stream->waveformSize = chan.numChannels * (chan.prePeakSamples + chan.postPeakSamples);
+			stream->timestamps = static_cast<const int64*>(stream->map(folder.folder.getChildFile("spike_times.npy"), sizeof(int64)));
+			stream->waveforms = static_cast<const int16*>(stream->map(folder.folder.getChildFile("spike_waveforms.npy"), stream->waveformSize * sizeof(int16)));
+			stream->electrodes = static_cast<const uint16*>(stream->map(folder.folder.getChildFile("spike_electrode_indices.npy"), sizeof(uint16)));
+			stream->clusters = static_cast<const uint16*>(stream->map(folder.folder.getChildFile("spike_clusters.npy"), sizeof(uint16)));
+			stream->bitVolts = chan.sourceChannels.size() > 0 ? getChannelInfo(chan.sourceChannels[0]).bitVolts : 1.0f;
+			valid = stream->timestamps != nullptr && stream->waveforms != nullptr && stream->electrodes != nullptr;
+			break;
+		default:
+			valid = false;
+			break;
+		}
+
+		if (!valid || stream->numEvents == std::numeric_limits<int64>::max())
+		{
+			std::cerr << "Could not open the recorded events in " << folder.folder.getFullPathName() << std::endl;
+			continue;
+		}
+		m_eventStreams.add(stream.release());
+	}
+}
+
+bool BinaryFileSource::openIndex(const File& indexFile)
+{
+	if (m_indexInterval <= 0 || !indexFile.existsAsFile())
+		return false;
+
+	m_indexFile = new MemoryMappedFile(indexFile, MemoryMappedFile::readOnly);
+	size_t dataBytes = 0;
+	const char* data = getNpyData(*m_indexFile, dataBytes);
+	if (data == nullptr || ((data - static_cast<const char*>(m_indexFile->getData())) % sizeof(int64)) != 0)
+		return false;
+
+	//Count rows from the file size, so an index whose header wasn't updated before a crash can still be used
+	m_indexData = reinterpret_cast<const int64*>(data);
+	m_indexRows = dataBytes / (INDEX_ROW_SIZE * sizeof(int64));
+	return m_indexRows > 0;
+}
+
+int64 BinaryFileSource::getByteOffset(int64 sample) const
+{
+	int64 frameSize = getActiveNumChannels() * sizeof(int16);
+	if (m_indexData != nullptr)
+	{
+		int64 row = sample / m_indexInterval;
+		if (row < m_indexRows)
+		{
+			const int64* entry = m_indexData + row * INDEX_ROW_SIZE;
+			if (entry[INDEX_OFFSET] >= 0)
+				return entry[INDEX_OFFSET] + (sample - entry[INDEX_SAMPLE]) * frameSize;
+		}
+	}
+	return sample * frameSize;
 }
 
 void BinaryFileSource::seekTo(int64 sample)
@@ -131,7 +470,7 @@ int BinaryFileSource::readData(int16* buffer, int nSamples)
 		samplesToRead = nSamples;
 	}
 
-	int16* data = static_cast<int16*>(m_dataFile->getData()) + (m_samplePos * nChans);
+	int16* data = reinterpret_cast<int16*>(static_cast<char*>(m_dataFile->getData()) + getByteOffset(m_samplePos));
 
 	memcpy(buffer, data, samplesToRead*nChans*sizeof(int16));
     m_samplePos += samplesToRead;
@@ -149,6 +488,110 @@ void BinaryFileSource::processChannelData(int16* inBuffer, float* outBuffer, int
 	}
 }
 
+void BinaryFileSource::processBlockData(const int16* inBuffer, float* const* outBuffers, int numChannels, int64 numSamples)
+{
+	processInterleavedBlock(inBuffer, outBuffers, numChannels, numSamples);
+}
+
+const int16* BinaryFileSource::getMappedData(int64 sample, int numSamples)
+{
+	if (m_dataFile == nullptr || m_dataFile->getData() == nullptr || numSamples <= 0
+		|| sample < 0 || sample + numSamples > getActiveNumSamples())
+		return nullptr;
+
+	const int64 frameSize = getActiveNumChannels() * sizeof(int16);
+	const int64 start = getByteOffset(sample);
+	const int64 last = getByteOffset(sample + numSamples - 1);
+
+	//A gap recorded in the index means the samples aren't stored back to back
+	if (last - start != (numSamples - 1) * frameSize || last + frameSize > int64(m_dataFile->getSize()))
+		return nullptr;
+
+	return reinterpret_cast<const int16*>(static_cast<const char*>(m_dataFile->getData()) + start);
+}
+
+void BinaryFileSource::prefetch(int64 sample, int numSamples)
+{
+#if JUCE_LINUX || JUCE_MAC
+	if (m_dataFile == nullptr || m_dataFile->getData() == nullptr || numSamples <= 0)
+		return;
+
+	const int64 fileSize = m_dataFile->getSize();
+	const int64 pageSize = sysconf(_SC_PAGESIZE);
+	int64 start = getByteOffset(jlimit<int64>(0, getActiveNumSamples() - 1, sample));
+	int64 end = jmin(fileSize, start + int64(numSamples) * getActiveNumChannels() * int64(sizeof(int16)));
+	start -= start % pageSize;
+	if (end > start)
+		madvise(static_cast<char*>(m_dataFile->getData()) + start, size_t(end - start), MADV_WILLNEED);
+#else
+	ignoreUnused(sample, numSamples);
+#endif
+}
+
+void BinaryFileSource::seekEvents(int64 sample)
+{
+	for (int i = 0; i < m_eventStreams.size(); i++)
+	{
+		EventStream* stream = m_eventStreams[i];
+		const int64* end = stream->timestamps + stream->numEvents;
+		stream->cursor = std::lower_bound(stream->timestamps, end, m_startTimestamp + sample) - stream->timestamps;
+	}
+}
+
+bool BinaryFileSource::readNextEvent(int64 endSample, RecordedEvent& event)
+{
+	for (int i = 0; i < m_eventStreams.size(); i++)
+	{
+		EventStream* stream = m_eventStreams[i];
+
+		while (stream->cursor < stream->numEvents)
+		{
+			const int64 n = stream->cursor;
+			event.sample = stream->timestamps[n] - m_startTimestamp;
+			if (event.sample >= endSample)
+				break;
+			stream->cursor++;
+
+			event.eventChannel = stream->firstChannel;
+			event.line = 0;
+			event.state = false;
+			event.text = nullptr;
+			event.textBytes = 0;
+			event.waveform = nullptr;
+			event.waveformBitVolts = 0;
+			event.sortedId = 0;
+
+			switch (stream->kind)
+			{
+			case RecordedEventChannelInfo::TTL:
+				//Stored as the 1 based line, negative for a falling edge
+				if (stream->states[n] == 0)
+					continue;
+				event.line = std::abs(stream->states[n]) - 1;
+				event.state = stream->states[n] > 0;
+				break;
+			case RecordedEventChannelInfo::TEXT:
+				event.text = stream->text + n * stream->textBytes;
+				event.textBytes = strnlen(event.text, stream->textBytes);
+				break;
+			case RecordedEventChannelInfo::SPIKE:
+			{
+				const int electrode = int(stream->electrodes[n]) - 1;
+				if (electrode < 0 || electrode >= stream->numChannels)
+					continue;
+				event.eventChannel = stream->firstChannel + electrode;
+				event.waveform = stream->waveforms + n * stream->waveformSize;
+				event.waveformBitVolts = stream->bitVolts;
+				event.sortedId = stream->clusters != nullptr ? stream->clusters[n] : 0;
+				break;
+			}
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
 bool BinaryFileSource::isReady()
 {
 	return true;
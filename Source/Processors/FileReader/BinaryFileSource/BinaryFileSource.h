@@ -39,20 +39,81 @@ namespace BinarySource
 		void seekTo(int64 sample) override;
 
 		void processChannelData(int16* inBuffer, float* outBuffer, int channel, int64 numSamples) override;
+		void processBlockData(const int16* inBuffer, float* const* outBuffers, int numChannels, int64 numSamples) override;
+
+		const int16* getMappedData(int64 sample, int numSamples) override;
+		void prefetch(int64 sample, int numSamples) override;
 
 		bool isReady() override;
 
+		void seekEvents(int64 sample) override;
+		bool readNextEvent(int64 endSample, RecordedEvent& event) override;
+
 	private:
 		bool Open(File file) override;
 		void fillRecordInfo() override;
 		void updateActiveRecord() override;
 
+		/** Maps the seek index written next to the data file. Returns false if it is missing or invalid */
+		bool openIndex(const File& indexFile);
+		/** Byte offset of a sample in the active data file */
+		int64 getByteOffset(int64 sample) const;
+
+		/** Adds the event and spike folders of the recording to the records they belong to */
+		void fillEventInfo(const Array<var>& records);
+		/** Maps the event and spike arrays of the active record */
+		void openEventStreams();
+
+		/** An events or spikes folder of a record */
+		struct EventFolder
+		{
+			int record;
+			File folder;
+			RecordedEventChannelInfo::Kind kind;
+			int firstChannel;	// index of its first channel in the record's eventChannels
+			int numChannels;	// electrodes sharing a spike folder, 1 otherwise
+		};
+
+		/** The mapped arrays of an event folder of the active record, with its read position */
+		struct EventStream
+		{
+			OwnedArray<MemoryMappedFile> files;
+			RecordedEventChannelInfo::Kind kind;
+			int firstChannel;
+			int numChannels;
+			int64 numEvents;
+			int64 cursor;
+			const int64* timestamps;
+			const int16* states;		// TTL channel_states
+			const char* text;			// TEXT rows of textBytes
+			size_t textBytes;
+			const int16* waveforms;		// SPIKE rows of waveformSize samples
+			size_t waveformSize;
+			const uint16* electrodes;	// SPIKE, 1 based
+			const uint16* clusters;		// SPIKE
+			float bitVolts;
+
+			/** Maps a .npy file of the folder and returns its data, or nullptr if it has fewer than numEvents rows of rowBytes */
+			const void* map(const File& file, size_t rowBytes);
+		};
+
 		ScopedPointer<MemoryMappedFile> m_dataFile;
+		ScopedPointer<MemoryMappedFile> m_indexFile;
+		const int64* m_indexData;
+		int64 m_indexRows;
+		int m_indexInterval;
+		Array<File> m_indexFileArray;
+		Array<int> m_indexIntervalArray;
 		var m_jsonData;
 		Array<File> m_dataFileArray;
 
 		File m_rootPath;
 		int64 m_samplePos;
+
+		Array<int64> m_startTimestampArray;
+		Array<EventFolder> m_eventFolders;
+		OwnedArray<EventStream> m_eventStreams;
+		int64 m_startTimestamp;
 		
 	};
 }
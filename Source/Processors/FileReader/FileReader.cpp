@@ -23,11 +23,15 @@
 
 #include "FileReader.h"
 #include "FileReaderEditor.h"
+#include "FileReaderGroup.h"
 #include <stdio.h>
 #include "../../AccessClass.h"
 #include "../../Audio/AudioComponent.h"
 #include "../PluginManager/PluginManager.h"
+#include "../GenericProcessor/ThreadPolicy.h"
 #include "BinaryFileSource/BinaryFileSource.h"
+#include "OpenEphysFileSource/OpenEphysFileSource.h"
+#include <limits>
 
 
 FileReader::FileReader()
@@ -42,9 +46,27 @@ FileReader::FileReader()
     , stopSample            (0)
     , counter               (0)
     , bufferCacheWindow     (0)
-    , m_shouldFillBackBuffer(false)
+	, m_slotSize(0)
+	, m_readAheadDepth(3)
+	, m_readSlot(0)
+	, m_writeSlot(0)
+	, m_holdingSlot(false)
+	, m_playBuffer(nullptr)
 	, m_bufferSize(1024)
 	, m_sysSampleRate(44100)
+	, m_batchMode(false)
+	, m_samplesToPlay(0)
+	, m_reachedEnd(0)
+	, m_directRead(false)
+	, m_prefetchedUntil(0)
+	, m_group(nullptr)
+	, m_groupBlock(0)
+	, m_eventPosition(0)
+	, m_publishedPosition(0)
+	, m_samplesPlayed(0)
+	, m_readSource(nullptr)
+	, m_readItem(0)
+	, m_playItem(0)
 {
     setProcessorType (PROCESSOR_TYPE_SOURCE);
 
@@ -85,8 +107,15 @@ FileReader::FileReader()
 
 FileReader::~FileReader()
 {
+    if (m_group != nullptr)
+        m_group->removeMember (this);
+
     signalThreadShouldExit();
     notify();
+
+    // the speed is global to the graph, so it mustn't outlive the reader that set it
+    if (AudioComponent* audio = AccessClass::getAudioComponent())
+        audio->resetPlaybackSpeed();
 }
 
 
@@ -97,11 +126,84 @@ AudioProcessorEditor* FileReader::createEditor()
     return editor;
 }
 
+void FileReader::createDataChannels()
+{
+    GenericProcessor::createDataChannels();
+
+    if (!input) return;
+
+    // set here rather than in updateSettings(), so spike channels built on them get the right scale
+    for (int i = 0; i < currentNumChannels; i++)
+    {
+        dataChannelArray[i]->setBitVolts (channelInfo[i].bitVolts);
+        dataChannelArray[i]->setName (channelInfo[i].name);
+    }
+}
+
 void FileReader::createEventChannels()
 {
-    //editor = new FileReaderEditor (this, true);
+    m_recordedEventChannels.clear();
+    m_ttlWords.clear();
+
+    if (!input) return;
 
-    //return editor;
+    const int numChannels = input->getNumEventChannels();
+    for (int i = 0; i < numChannels; ++i)
+    {
+        const RecordedEventChannelInfo info = input->getEventChannelInfo (i);
+        EventChannel* chan = nullptr;
+
+        // TTL words are kept in a uint64, which is more lines than any source has
+        if (info.kind == RecordedEventChannelInfo::TTL)
+            chan = new EventChannel (EventChannel::TTL, jmin (info.numChannels, 64), 1, info.sampleRate, this);
+        else if (info.kind == RecordedEventChannelInfo::TEXT && info.textLength > 0)
+            chan = new EventChannel (EventChannel::TEXT, 1, info.textLength, info.sampleRate, this);
+
+        if (chan != nullptr)
+        {
+            if (info.name.isNotEmpty())
+                chan->setName (info.name);
+            eventChannelArray.add (chan);
+        }
+        m_recordedEventChannels.add (chan);
+        m_ttlWords.add (0);
+    }
+}
+
+void FileReader::createSpikeChannels()
+{
+    m_recordedSpikeChannels.clear();
+
+    if (!input) return;
+
+    const int numChannels = input->getNumEventChannels();
+    for (int i = 0; i < numChannels; ++i)
+    {
+        const RecordedEventChannelInfo info = input->getEventChannelInfo (i);
+        SpikeChannel* spk = nullptr;
+
+        if (info.kind == RecordedEventChannelInfo::SPIKE
+            && SpikeChannel::typeFromNumChannels (info.numChannels) != SpikeChannel::INVALID)
+        {
+            Array<const DataChannel*> chans;
+            for (int c = 0; c < info.sourceChannels.size(); ++c)
+            {
+                const DataChannel* ch = getDataChannel (info.sourceChannels[c]);
+                if (ch != nullptr)
+                    chans.add (ch);
+            }
+
+            if (chans.size() == info.numChannels)
+            {
+                spk = new SpikeChannel (SpikeChannel::typeFromNumChannels (info.numChannels), this, chans);
+                spk->setNumSamples (info.prePeakSamples, info.postPeakSamples);
+                if (info.name.isNotEmpty())
+                    spk->setName (info.name);
+                spikeChannelArray.add (spk);
+            }
+        }
+        m_recordedSpikeChannels.add (spk);
+    }
 }
 
 bool FileReader::isReady()
@@ -156,34 +258,118 @@ bool FileReader::enable()
 {
 	timestamp = 0;
 
-	AudioDeviceManager& adm = AccessClass::getAudioComponent()->deviceManager;
-	AudioDeviceManager::AudioDeviceSetup ads;
-	adm.getAudioDeviceSetup(ads);
-	m_sysSampleRate = ads.sampleRate;
-	m_bufferSize = ads.bufferSize;
+	AudioComponent* audio = AccessClass::getAudioComponent();
+	m_sysSampleRate = audio->getSampleRate();
+	m_bufferSize = audio->getBufferSize();
 	if (m_bufferSize == 0) m_bufferSize = 1024;
 
+	m_samplesToPlay = stopSample - currentSample;
+	m_reachedEnd.set(0);
+
+	m_readSource = input;
+	m_readItem = 0;
+	m_playItem = 0;
+	m_playingItem.set(0);
+	if (m_playlist.size() > 0)
+	{
+		// play the first entry from its start, the next one is opened by the reader thread
+		m_playlistSources.clear();
+		for (int i = 0; i < m_playlist.size(); ++i)
+			m_playlistSources.add(nullptr);
+
+		m_readSource = openFileSource(m_playlist[0].file, m_playlist[0].record);
+		if (m_readSource == nullptr)
+		{
+			std::cerr << "File Reader could not open " << m_playlist[0].file.getFullPathName() << std::endl;
+			return false;
+		}
+		m_playlistSources.set(0, m_readSource);
+
+		m_samplesToPlay = 0;
+		for (int i = 0; i < m_playlist.size(); ++i)
+			m_samplesToPlay += m_playlist[i].numSamples;
+
+		currentSample = 0;
+		m_readSource->seekTo(0);
+	}
+
 	m_samplesPerBuffer.set(m_bufferSize * (getDefaultSampleRate() / m_sysSampleRate));
 
-	bufferA.malloc(currentNumChannels * m_bufferSize * BUFFER_WINDOW_CACHE_SIZE);
-	bufferB.malloc(currentNumChannels * m_bufferSize * BUFFER_WINDOW_CACHE_SIZE);
+	// room for a cache of BUFFER_WINDOW_CACHE_SIZE windows, even when the file runs faster than the device
+	m_slotSize = size_t(currentNumChannels) * jmax(int(m_bufferSize), m_samplesPerBuffer.get()) * BUFFER_WINDOW_CACHE_SIZE;
+	bufferA.malloc(m_slotSize);
+
+	m_numUnderruns.set(0);
+	m_seekRequested.set(0);
+	m_seekReady.set(0);
+	m_seekBufferInUse.set(0);
 
-	readAndFillBufferCache(bufferA); // pre-fill the front buffer with a blocking read
+	// A mapped file is converted in place, which saves copying it through the buffer cache
+	m_directRead = m_playlist.size() == 0 && input->getMappedData(currentSample, 1) != nullptr;
+	m_playPosition.set(currentSample);
+	m_prefetchedUntil = currentSample;
+	m_prefetchTrigger.set(currentSample);
 
-	// set the backbuffer so that on the next call to process() we start with bufferA and buffer
-	// cache window id = 0
-	readBuffer = &bufferB;
+	m_eventPosition = currentSample;
+	m_publishedPosition.set (currentSample);
+	m_samplesPlayed.set (0);
+	m_readSource->seekEvents (currentSample);
+	for (int i = 0; i < m_ttlWords.size(); ++i)
+		m_ttlWords.set (i, 0);
+
+	m_groupBlock = 0;
+	m_cachesNeeded.set(1);
+
+	if (m_directRead)
+	{
+		m_directOutputs.malloc(currentNumChannels);
+		if (m_group != nullptr)
+			m_group->memberStarted(this);
+		else
+			startThread(); // start async prefetching
+		return isEnabled;
+	}
+
+	m_cache.malloc(m_slotSize * m_readAheadDepth);
+	m_seekBuffer.malloc(m_slotSize);
+
+	readAndFillBufferCache(m_cache); // pre-fill the first cache with a blocking read
+
+	// the next call to process() starts with the first cache and buffer cache window id = 0
+	m_readSlot = 0;
+	m_writeSlot = 1 % m_readAheadDepth;
+	m_holdingSlot = false;
+	m_numFilled.set(1);
+	m_playBuffer = nullptr;
 	bufferCacheWindow = 0;
-	m_shouldFillBackBuffer.set(false);
 
-	startThread(); // start async file reader thread
+	if (m_group != nullptr)
+		m_group->memberStarted(this); // the group's thread reads for all its members
+	else
+		startThread(); // start async file reader thread
 
 	return isEnabled;
 }
 
 bool FileReader::disable()
 {
-	stopThread(100);
+	if (m_group != nullptr)
+	{
+		m_group->memberStopped(this);
+	}
+	else
+	{
+		// a read can block for a while on a slow drive, so give it time to finish
+		signalThreadShouldExit();
+		notify();
+		stopThread(2000);
+	}
+
+	if (m_numUnderruns.get() > 0)
+		std::cout << "File Reader ran out of data read ahead " << m_numUnderruns.get() << " times, a deeper read ahead may help." << std::endl;
+
+	m_playlistSources.clear();
+	m_readSource = nullptr;
 	return true;
 }
 
@@ -210,23 +396,12 @@ bool FileReader::setFile (String fullpath)
     File file (fullpath);
 
     String ext = file.getFileExtension().toLowerCase().substring (1);
-    const int index = supportedExtensions[ext] - 1;
-    const bool isExtensionSupported = index >= 0;
 
-    if (isExtensionSupported)
-    {
-        const int index = supportedExtensions[ext] -1 ;
-		const int numPluginFileSources = AccessClass::getPluginManager()->getNumFileSources();
+    clearPlaylist();
 
-		if (index < numPluginFileSources)
-		{
-			Plugin::FileSourceInfo sourceInfo = AccessClass::getPluginManager()->getFileSourceInfo(index);
-			input = sourceInfo.creator();
-		}
-		else
-		{
-			input = createBuiltInFileSource(index - numPluginFileSources);
-		}
+    if (isFileExtensionSupported (ext))
+    {
+		input = createFileSource (ext);
 		if (!input)
 		{
 			std::cerr << "Error creating file source for extension " << ext << std::endl;
@@ -264,10 +439,40 @@ bool FileReader::setFile (String fullpath)
 }
 
 
+FileSource* FileReader::createFileSource (const String& ext) const
+{
+    const int index = supportedExtensions[ext] - 1;
+    if (index < 0)
+        return nullptr;
+
+    const int numPluginFileSources = AccessClass::getPluginManager()->getNumFileSources();
+    if (index < numPluginFileSources)
+    {
+        FileSourceCreator creator = AccessClass::getPluginManager()->getFileSourceCreator (index);
+        return creator != nullptr ? creator() : nullptr;
+    }
+
+    return createBuiltInFileSource (index - numPluginFileSources);
+}
+
+
+FileSource* FileReader::openFileSource (const File& file, int record) const
+{
+    ScopedPointer<FileSource> source = createFileSource (file.getFileExtension().toLowerCase().substring (1));
+    if (! source || ! source->OpenFile (file) || record < 0 || record >= source->getNumRecords())
+        return nullptr;
+
+    source->setActiveRecord (record);
+    return source.release();
+}
+
+
 void FileReader::setActiveRecording (int index)
 {
     if (!input) { return; }
 
+    clearPlaylist();
+
     input->setActiveRecord (index);
 
     currentNumChannels  = input->getActiveNumChannels();
@@ -300,17 +505,6 @@ String FileReader::getFile() const
 }
 
 
-void FileReader::updateSettings()
-{
-     if (!input) return;
-
-     for (int i=0; i < currentNumChannels; i++)
-     {
-         dataChannelArray[i]->setBitVolts(channelInfo[i].bitVolts);
-         dataChannelArray[i]->setName(channelInfo[i].name);
-     }
-}
-
 void FileReader::process (AudioSampleBuffer& buffer)
 {
     const int samplesNeededPerBuffer = int (float (buffer.getNumSamples()) * (getDefaultSampleRate() / m_sysSampleRate));
@@ -319,27 +513,68 @@ void FileReader::process (AudioSampleBuffer& buffer)
     //        integer value
     
     // if cache window id == 0, we need to read and cache BUFFER_WINDOW_CACHE_SIZE more buffer windows
-    if (bufferCacheWindow == 0)
+    bool haveData = true;
+    if (m_group != nullptr && !m_batchMode && !m_group->canPlayBlock (m_groupBlock++))
+    {
+        // another member has nothing read ahead, so the whole group holds its position
+        if (!hasDataReady())
+            ++m_numUnderruns;
+        haveData = false;
+    }
+    else if (m_directRead)
+    {
+        applySeek();
+    }
+    else if (bufferCacheWindow == 0)
     {
-        switchBuffer();
+        haveData = switchBuffer();
+    }
+
+    int samplesToOutput = samplesNeededPerBuffer;
+    if (m_batchMode)
+    {
+        const int64 samplesLeft = m_samplesToPlay - timestamp;
+        samplesToOutput = int (jlimit<int64> (0, samplesNeededPerBuffer, samplesLeft));
+        if (samplesLeft <= samplesNeededPerBuffer)
+            m_reachedEnd.set(1);
     }
     
-    for (int i = 0; i < currentNumChannels; ++i)
+    if (!haveData)
+    {
+        // underrun: output silence and try the same cache window again next time
+        for (int i = 0; i < currentNumChannels; ++i)
+            buffer.clear (i, 0, samplesToOutput);
+    }
+    else if (m_directRead)
+    {
+        readDirect (buffer, samplesToOutput);
+    }
+    else if (samplesToOutput > 0)
     {
-        // offset readBuffer index by current cache window count * buffer window size * num channels
-        input->processChannelData (*readBuffer + (samplesNeededPerBuffer * currentNumChannels * bufferCacheWindow),
-                                   buffer.getWritePointer (i, 0),
-                                   i,
-                                   samplesNeededPerBuffer);
+        // offset m_playBuffer index by current cache window count * buffer window size * num channels
+        input->processBlockData (m_playBuffer + (samplesNeededPerBuffer * currentNumChannels * bufferCacheWindow),
+                                 buffer.getArrayOfWritePointers(),
+                                 currentNumChannels,
+                                 samplesToOutput);
     }
     
-    setTimestampAndSamples(timestamp, samplesNeededPerBuffer);
-	timestamp += samplesNeededPerBuffer;
+    if (haveData)
+        addRecordedEvents (samplesToOutput);
 
-	static_cast<FileReaderEditor*> (getEditor())->setCurrentTime(samplesToMilliseconds(startSample + timestamp % (stopSample - startSample)));
+    setTimestampAndSamples(timestamp, samplesToOutput);
+	timestamp += samplesToOutput;
+
+	m_publishedPosition.set (m_eventPosition);
+	m_samplesPlayed.set (timestamp);
     
-    bufferCacheWindow += 1;
-    bufferCacheWindow %= BUFFER_WINDOW_CACHE_SIZE;
+    if (haveData)
+    {
+        bufferCacheWindow += 1;
+        bufferCacheWindow %= BUFFER_WINDOW_CACHE_SIZE;
+    }
+
+    // the cache being played is handed back before the next one is taken
+    m_cachesNeeded.set (bufferCacheWindow != 0 ? 0 : (m_holdingSlot ? 2 : 1));
 }
 
 
@@ -355,6 +590,11 @@ void FileReader::setParameter (int parameterIndex, float newValue)
         //set startTime
         case 1: 
             startSample = millisecondsToSamples (newValue);
+            if (isReading())
+            {
+                seekPlayback (startSample);
+                break;
+            }
             currentSample = startSample;
 
             static_cast<FileReaderEditor*> (getEditor())->setCurrentTime (samplesToMilliseconds (currentSample));
@@ -382,60 +622,392 @@ int64 FileReader::millisecondsToSamples (unsigned int ms) const
     return (int64) (currentSampleRate * float (ms) / 1000.f);
 }
 
-void FileReader::switchBuffer()
+bool FileReader::switchBuffer()
+{
+    if (m_holdingSlot)
+    {
+        m_readSlot = (m_readSlot + 1) % m_readAheadDepth;
+        --m_numFilled;
+        m_holdingSlot = false;
+        wakeReader();
+    }
+
+    if (m_seekBufferInUse.get() != 0)
+    {
+        m_seekBufferInUse.set (0);
+        wakeReader();
+    }
+
+    if (applySeek())
+        return true;
+
+    if (m_batchMode)
+    {
+        // without the audio clock there is no time for the reader thread to get ahead,
+        // so wait for it instead of playing a stale buffer
+        while (m_numFilled.get() == 0 && isReading())
+            m_cacheFilled.wait (100);
+    }
+
+    if (m_numFilled.get() == 0)
+    {
+        ++m_numUnderruns;
+        m_playBuffer = nullptr;
+        return false;
+    }
+
+    m_playBuffer = m_cache + m_readSlot * m_slotSize;
+    m_holdingSlot = true;
+    return true;
+}
+
+bool FileReader::applySeek()
 {
-    if (readBuffer == &bufferA)
-        readBuffer = &bufferB;
+    if (m_seekReady.get() == 0)
+        return false;
+
+    const int64 target = m_seekTarget.get();
+    if (m_directRead)
+    {
+        currentSample = target;
+        m_playPosition.set (target);
+    }
     else
-        readBuffer = &bufferA;
-    
-    m_shouldFillBackBuffer.set(true);
-    notify();
+    {
+        // the reader stopped filling once it read the seek target, so all the queued caches came before it
+        const int numQueued = m_numFilled.get();
+        m_readSlot = (m_readSlot + numQueued) % m_readAheadDepth;
+        m_numFilled -= numQueued;
+        m_playBuffer = m_seekBuffer;
+        m_seekBufferInUse.set (1);
+    }
+
+    m_eventPosition = target;
+    input->seekEvents (target);
+
+    m_seekReady.set (0);
+    wakeReader();
+    return true;
 }
 
-HeapBlock<int16>* FileReader::getFrontBuffer()
+void FileReader::seekPlayback (int64 sample)
 {
-    return readBuffer;
+    if (m_group != nullptr && m_group->isReading())
+        m_group->seekAll (double (sample) / currentSampleRate);
+    else
+        requestSeek (sample);
 }
 
-HeapBlock<int16>* FileReader::getBackBuffer()
+void FileReader::requestSeek (int64 sample)
 {
-    if (readBuffer == &bufferA) return &bufferB;
-    
-    return &bufferA;
+    // a playlist is always played whole
+    if (stopSample <= startSample || m_playlist.size() > 0)
+        return;
+
+    m_seekTarget.set (jlimit (startSample, stopSample - 1, sample));
+    m_seekRequested.set (1);
+    wakeReader();
+}
+
+void FileReader::wakeReader()
+{
+    if (m_group != nullptr)
+        m_group->wake();
+    else
+        notify();
+}
+
+bool FileReader::isReading() const
+{
+    return m_group != nullptr ? m_group->isReading() : isThreadRunning();
+}
+
+void FileReader::setPlaybackGroup (int index)
+{
+    FileReaderGroup* group = FileReaderGroup::getGroup (index);
+    if (group == m_group)
+        return;
+
+    if (m_group != nullptr)
+        m_group->removeMember (this);
+
+    m_group = group;
+
+    if (m_group != nullptr)
+        m_group->addMember (this);
+}
+
+int FileReader::getPlaybackGroup() const
+{
+    return m_group != nullptr ? m_group->getIndex() : 0;
+}
+
+void FileReader::readDirect (AudioSampleBuffer& buffer, int numSamples)
+{
+    if (stopSample <= startSample)
+        return;
+
+    int done = 0;
+    while (done < numSamples)
+    {
+        if (currentSample >= stopSample)
+        {
+            currentSample = startSample;
+            wakeReader(); // prefetch the start again
+        }
+
+        const int n = int (jmin<int64> (numSamples - done, stopSample - currentSample));
+        for (int i = 0; i < currentNumChannels; ++i)
+            m_directOutputs[i] = buffer.getWritePointer (i, done);
+
+        const int16* data = input->getMappedData (currentSample, n);
+        if (data == nullptr)
+        {
+            // not stored back to back, e.g. across a gap in the recording, so copy this part
+            input->seekTo (currentSample);
+            input->readData (bufferA, n);
+            data = bufferA;
+        }
+        input->processBlockData (data, m_directOutputs, currentNumChannels, n);
+
+        done += n;
+        currentSample += n;
+    }
+
+    m_playPosition.set (currentSample);
+    if (currentSample >= m_prefetchTrigger.get())
+        wakeReader();
+}
+
+bool FileReader::prefetchAhead()
+{
+    const int64 lookahead = int64 (currentSampleRate);
+    const int64 playPosition = m_playPosition.get();
+
+    // start over after looping back to the start
+    if (m_prefetchedUntil < playPosition || m_prefetchedUntil > playPosition + lookahead)
+        m_prefetchedUntil = playPosition;
+
+    if (m_prefetchedUntil - playPosition > lookahead / 2)
+    {
+        m_prefetchTrigger.set (m_prefetchedUntil - lookahead / 2);
+        return false;
+    }
+
+    // near the stop the start is loaded once, for playback looping back to it
+    const int64 end = jmin (stopSample, playPosition + lookahead);
+    const bool didPrefetch = end > m_prefetchedUntil;
+    if (didPrefetch)
+        input->prefetch (m_prefetchedUntil, int (end - m_prefetchedUntil));
+    if (didPrefetch && end == stopSample)
+        input->prefetch (startSample, int (jmin (lookahead, stopSample - startSample)));
+
+    m_prefetchedUntil = end;
+    m_prefetchTrigger.set (end - lookahead / 2);
+    return didPrefetch;
+}
+
+void FileReader::addRecordedEvents (int numSamples)
+{
+    const bool isPlaylist = m_playlist.size() > 0;
+    FileSource* source = isPlaylist ? m_playlistSources.getUnchecked (m_playItem) : input.get();
+    int64 stop = isPlaylist ? m_playlist.getReference (m_playItem).numSamples : stopSample;
+
+    if (stop <= (isPlaylist ? 0 : startSample))
+        return;
+
+    const bool hasEvents = m_recordedEventChannels.size() > 0;
+
+    int done = 0;
+    while (done < numSamples)
+    {
+        if (m_eventPosition >= stop && isPlaylist)
+        {
+            // the reader thread has opened the next entry before reading any of it, unless it failed to
+            const int next = (m_playItem + 1) % m_playlist.size();
+            if (m_playlistSources.getUnchecked (next) == nullptr)
+                return;
+
+            m_playItem = next;
+            m_playingItem.set (m_playItem);
+            source = m_playlistSources.getUnchecked (m_playItem);
+            stop = m_playlist.getReference (m_playItem).numSamples;
+            m_eventPosition = 0;
+            source->seekEvents (0);
+        }
+        else if (m_eventPosition >= stop)
+        {
+            m_eventPosition = startSample;
+            source->seekEvents (startSample);
+        }
+
+        const int n = int (jmin<int64> (numSamples - done, stop - m_eventPosition));
+
+        RecordedEvent event;
+        while (hasEvents && source->readNextEvent (m_eventPosition + n, event))
+        {
+            if (event.sample < m_eventPosition)
+                continue;
+
+            const int sampleNum = done + int (event.sample - m_eventPosition);
+            const int64 eventTimestamp = timestamp + sampleNum;
+
+            if (const EventChannel* chan = m_recordedEventChannels[event.eventChannel])
+            {
+                if (chan->getChannelType() == EventChannel::TEXT)
+                {
+                    addTextEvent (chan, eventTimestamp, event.text, event.textBytes, sampleNum);
+                }
+                else if (event.line < int (chan->getNumChannels()))
+                {
+                    uint64& word = m_ttlWords.getReference (event.eventChannel);
+                    if (event.state)
+                        word |= uint64 (1) << event.line;
+                    else
+                        word &= ~(uint64 (1) << event.line);
+
+                    addTTLEvent (chan, eventTimestamp, &word, uint16 (event.line), sampleNum);
+                }
+            }
+            else if (const SpikeChannel* spk = m_recordedSpikeChannels[event.eventChannel])
+            {
+                // waveforms are stored in units of the first channel's bitVolts
+                SpikeEvent::SpikeBuffer spikeData (spk);
+                const int numValues = int (spk->getTotalSamples() * spk->getNumChannels());
+                for (int s = 0; s < numValues; ++s)
+                    spikeData.set (s, event.waveform[s] * event.waveformBitVolts);
+
+                Array<float> thresholds;
+                thresholds.insertMultiple (0, 0.0f, spk->getNumChannels());
+
+                SpikeEventPtr spike = SpikeEvent::createSpikeEvent (spk, eventTimestamp, thresholds, spikeData, event.sortedId);
+                addSpike (spk, spike, sampleNum);
+            }
+        }
+
+        done += n;
+        m_eventPosition += n;
+    }
+}
+
+bool FileReader::readAheadStep()
+{
+    // a seek is read first, but not into the seek buffer while it is still being played
+    if (m_seekReady.get() == 0 && m_seekBufferInUse.get() == 0 && m_seekRequested.compareAndSetBool (0, 1))
+    {
+        const int64 target = m_seekTarget.get();
+        if (m_directRead)
+        {
+            input->prefetch (target, int (jmin<int64> (int64 (currentSampleRate), stopSample - target)));
+        }
+        else
+        {
+            input->seekTo (target);
+            currentSample = target;
+            readAndFillBufferCache (m_seekBuffer);
+        }
+        m_seekReady.set (1);
+        return true;
+    }
+
+    if (m_directRead)
+        return prefetchAhead();
+
+    // keep the ring full, stopping while a seek waits to be played
+    if (m_numFilled.get() < m_readAheadDepth && m_seekReady.get() == 0)
+    {
+        if (m_playlist.size() > 0)
+            updatePlaylistSources();
+
+        readAndFillBufferCache (m_cache + m_writeSlot * m_slotSize);
+        m_writeSlot = (m_writeSlot + 1) % m_readAheadDepth;
+        ++m_numFilled;
+        m_cacheFilled.signal();
+        return true;
+    }
+
+    return false;
+}
+
+double FileReader::getReadAheadTime() const
+{
+    if (m_seekReady.get() == 0 && m_seekBufferInUse.get() == 0 && m_seekRequested.get() != 0)
+        return 0.0;
+
+    if (m_directRead)
+    {
+        // only worth a read once playback has passed the trigger or looped back
+        const int64 playPosition = m_playPosition.get();
+        if (playPosition < m_prefetchTrigger.get() && m_prefetchedUntil >= playPosition)
+            return std::numeric_limits<double>::max();
+
+        return jmax (0.0, double (m_prefetchedUntil - playPosition) / currentSampleRate);
+    }
+
+    if (m_numFilled.get() >= m_readAheadDepth || m_seekReady.get() != 0)
+        return std::numeric_limits<double>::max();
+
+    return double (m_numFilled.get()) * m_samplesPerBuffer.get() * BUFFER_WINDOW_CACHE_SIZE / currentSampleRate;
+}
+
+bool FileReader::hasDataReady() const
+{
+    // direct reads and batch mode never output silence to wait for the disk
+    return m_directRead || m_batchMode || m_seekReady.get() != 0 || m_numFilled.get() >= m_cachesNeeded.get();
 }
 
 void FileReader::run()
 {
+    ThreadPolicy::applyToCurrentThread (ThreadPolicy::Acquisition);
+
     while (!threadShouldExit())
     {
-        if (m_shouldFillBackBuffer.compareAndSetBool(false, true))
+        while (!threadShouldExit() && readAheadStep())
         {
-            readAndFillBufferCache(*getBackBuffer());
         }
-        
-        wait(30);
+
+        // woken by process() when it frees a cache, passes the prefetch trigger or seeks
+        wait (500);
     }
 }
 
-void FileReader::readAndFillBufferCache(HeapBlock<int16> &cacheBuffer)
+void FileReader::readAndFillBufferCache(int16* cacheBuffer)
 {
     const int samplesNeededPerBuffer = m_samplesPerBuffer.get();
     const int samplesNeeded = samplesNeededPerBuffer * BUFFER_WINDOW_CACHE_SIZE;
     
+    const bool isPlaylist = m_playlist.size() > 0;
     int samplesRead = 0;
     
     // should only loop if reached end of file and resuming from start
     while (samplesRead < samplesNeeded)
     {
         int samplesToRead = samplesNeeded - samplesRead;
+        const int64 stop = isPlaylist ? m_playlist.getReference (m_readItem).numSamples : stopSample;
         
         // if reached end of file stream
-        if ( (currentSample + samplesToRead) > stopSample)
+        if ( (currentSample + samplesToRead) > stop)
         {
-            samplesToRead = stopSample - currentSample;
+            samplesToRead = stop - currentSample;
             if (samplesToRead > 0)
-                input->readData (cacheBuffer + samplesRead * currentNumChannels, samplesToRead);
+                m_readSource->readData (cacheBuffer + samplesRead * currentNumChannels, samplesToRead);
+
+            if (isPlaylist && readNextPlaylistEntry())
+            {
+                // carry on with the next entry in the same cache
+                samplesRead += samplesToRead;
+                continue;
+            }
+
+            if (m_batchMode || isPlaylist)
+            {
+                // played once, leave the rest of the cache silent
+                currentSample += samplesToRead;
+                samplesRead += samplesToRead;
+                zeromem (cacheBuffer + samplesRead * currentNumChannels,
+                         sizeof (int16) * (samplesNeeded - samplesRead) * currentNumChannels);
+                break;
+            }
             
             // reset stream to beginning
             input->seekTo (startSample);
@@ -443,7 +1015,7 @@ void FileReader::readAndFillBufferCache(HeapBlock<int16> &cacheBuffer)
         }
         else // else read the block needed
         {
-            input->readData (cacheBuffer + samplesRead * currentNumChannels, samplesToRead);
+            m_readSource->readData (cacheBuffer + samplesRead * currentNumChannels, samplesToRead);
             
             currentSample += samplesToRead;
         }
@@ -452,6 +1024,159 @@ void FileReader::readAndFillBufferCache(HeapBlock<int16> &cacheBuffer)
     }
 }
 
+bool FileReader::readNextPlaylistEntry()
+{
+    if (m_batchMode && m_readItem == m_playlist.size() - 1)
+        return false;
+
+    const int next = (m_readItem + 1) % m_playlist.size();
+    if (m_playlistSources.getUnchecked (next) == nullptr)
+        return false;
+
+    m_readItem = next;
+    m_readSource = m_playlistSources.getUnchecked (m_readItem);
+    m_readSource->seekTo (0);
+    currentSample = 0;
+    return true;
+}
+
+void FileReader::updatePlaylistSources()
+{
+    // given up after an entry failed to open
+    if (m_reachedEnd.get() != 0)
+        return;
+
+    const int numEntries = m_playlist.size();
+    const int next = (m_readItem + 1) % numEntries;
+
+    // process() plays from m_playingItem up to the entry being read, so keep those open
+    const int playing = m_playingItem.get();
+    const int numInUse = (next - playing + numEntries) % numEntries;
+    for (int i = 0; i < numEntries; ++i)
+    {
+        if ((i - playing + numEntries) % numEntries > numInUse && m_playlistSources.getUnchecked (i) != nullptr)
+            m_playlistSources.set (i, nullptr);
+    }
+
+    if (m_playlistSources.getUnchecked (next) == nullptr)
+    {
+        FileSource* source = openFileSource (m_playlist[next].file, m_playlist[next].record);
+        if (source == nullptr)
+        {
+            // checked when it was added, so the file has been moved since. Playback ends with this entry
+            std::cerr << "File Reader could not open " << m_playlist[next].file.getFullPathName() << std::endl;
+            m_reachedEnd.set (1);
+        }
+        m_playlistSources.set (next, source);
+    }
+}
+
+bool FileReader::addToPlaylist (const String& file, int record)
+{
+    if (!input)
+        return false;
+
+    ScopedPointer<FileSource> source = openFileSource (File (file), record);
+    if (!source)
+    {
+        std::cerr << "Could not open record " << record << " of " << file << std::endl;
+        return false;
+    }
+
+    bool matches = source->getActiveNumChannels() == currentNumChannels
+        && source->getActiveSampleRate() == currentSampleRate
+        && source->getActiveNumSamples() > 0
+        && source->getNumEventChannels() == input->getNumEventChannels();
+
+    for (int i = 0; matches && i < input->getNumEventChannels(); ++i)
+    {
+        const RecordedEventChannelInfo a = input->getEventChannelInfo (i);
+        const RecordedEventChannelInfo b = source->getEventChannelInfo (i);
+        matches = a.kind == b.kind && a.numChannels == b.numChannels && a.textLength == b.textLength
+            && a.prePeakSamples == b.prePeakSamples && a.postPeakSamples == b.postPeakSamples;
+    }
+
+    if (!matches)
+    {
+        std::cerr << source->getRecordName (record) << " of " << file << " has different channels from the selected recording" << std::endl;
+        return false;
+    }
+
+    PlaylistEntry entry;
+    entry.file = File (file);
+    entry.record = record;
+    entry.numSamples = source->getActiveNumSamples();
+    m_playlist.add (entry);
+    return true;
+}
+
+void FileReader::playAllRecordings()
+{
+    clearPlaylist();
+
+    if (!input)
+        return;
+
+    const int numRecords = input->getNumRecords();
+    for (int i = 0; i < numRecords; ++i)
+        addToPlaylist (getFile(), i);
+}
+
+void FileReader::clearPlaylist()
+{
+    m_playlist.clear();
+}
+
+int FileReader::getPlaylistSize() const
+{
+    return m_playlist.size();
+}
+
+void FileReader::setBatchMode (bool batch)
+{
+    m_batchMode = batch;
+}
+
+void FileReader::setReadAheadDepth (int numCaches)
+{
+    m_readAheadDepth = jlimit (2, 16, numCaches);
+}
+
+int FileReader::getReadAheadDepth() const
+{
+    return m_readAheadDepth;
+}
+
+int FileReader::getNumUnderruns() const
+{
+    return m_numUnderruns.get();
+}
+
+void FileReader::setPlaybackSpeed (double speed)
+{
+    AccessClass::getAudioComponent()->setPlaybackSpeed (speed);
+}
+
+double FileReader::getPlaybackSpeed() const
+{
+    return AccessClass::getAudioComponent()->getPlaybackSpeed();
+}
+
+bool FileReader::hasReachedEnd() const
+{
+    return m_reachedEnd.get() != 0;
+}
+
+int64 FileReader::getNumSamplesPlayed() const
+{
+    return m_samplesPlayed.get();
+}
+
+unsigned int FileReader::getPlaybackTime() const
+{
+    return samplesToMilliseconds (m_publishedPosition.get());
+}
+
 StringArray FileReader::getSupportedExtensions() const
 {
 	StringArray extensions;
@@ -467,7 +1192,7 @@ StringArray FileReader::getSupportedExtensions() const
 
 int FileReader::getNumBuiltInFileSources() const
 {
-	return 1;
+	return 2;
 }
 
 String FileReader::getBuiltInFileSourceExtensions(int index) const
@@ -476,6 +1201,8 @@ String FileReader::getBuiltInFileSourceExtensions(int index) const
 	{
 	case 0: //Binary
 		return "oebin";
+	case 1: //Open Ephys
+		return "openephys";
 	default:
 		return "";
 	}
@@ -487,6 +1214,8 @@ FileSource* FileReader::createBuiltInFileSource(int index) const
 	{
 	case 0:
 		return new BinarySource::BinaryFileSource();
+	case 1:
+		return new OpenEphysSource::OpenEphysFileSource();
 	default:
 		return nullptr;
 	}
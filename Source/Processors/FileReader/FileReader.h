@@ -31,6 +31,8 @@
 #include "../GenericProcessor/GenericProcessor.h"
 #include "FileSource.h"
 
+class FileReaderGroup;
+
 #define BUFFER_WINDOW_CACHE_SIZE 10
 
 
@@ -60,7 +62,6 @@ public:
     float getDefaultSampleRate()        const override;
     float getBitVolts (const DataChannel* chan)   const override;
 
-    void updateSettings() override;
     void setEnabledState (bool t)  override;
 	bool enable() override;
 	bool disable() override;
@@ -70,10 +71,70 @@ public:
 
     bool isFileSupported          (const String& filename) const;
     bool isFileExtensionSupported (const String& ext) const;
-    void createEventChannels();
 	StringArray getSupportedExtensions() const;
 
+	/** In batch mode the file is played once, from the current position to the stop time, and
+	    process() waits for the background reads instead of running ahead of them.
+	    Must be set before acquisition starts. */
+	void setBatchMode (bool batch);
+
+	/** Sets the playback speed relative to real time, 0 for as fast as the signal chain allows.
+	    Speeds other than 1 clock the whole graph without the audio device, see
+	    AudioComponent::setPlaybackSpeed. Timestamps follow the file's samples either way. */
+	void setPlaybackSpeed (double speed);
+	double getPlaybackSpeed() const;
+
+	/** Sets how many buffer caches of BUFFER_WINDOW_CACHE_SIZE windows the reader thread keeps
+	    read ahead of playback, 2 to 16. More ride out slower reads, e.g. on network drives.
+	    Must be set before acquisition starts. */
+	void setReadAheadDepth (int numCaches);
+	int getReadAheadDepth() const;
+
+	/** Moves playback to sample. The reader thread reads the new position first, and playback
+	    switches to it at the next cache boundary without waiting on the file. */
+	void seekPlayback (int64 sample);
+
+	/** Makes the reader play in lockstep with the others of playback group index, 1 to
+	    FileReaderGroup::numGroups, or on its own for 0. Seeks then move the whole group.
+	    Must be set before acquisition starts. @see FileReaderGroup */
+	void setPlaybackGroup (int index);
+	int getPlaybackGroup() const;
+
+	/** Adds a record of a file to the playlist. While the playlist isn't empty it is played
+	    instead of the selected record, each record whole and straight after the one before,
+	    looping at the end of the last. Timestamps carry on across records, and the reader
+	    thread opens the next record while the current one plays. The record must have the
+	    channels, sample rate and event channels of the selected record, whose bitVolts are
+	    used for all of them. Returns false if it doesn't. Must be called before acquisition starts. */
+	bool addToPlaylist (const String& file, int record);
+
+	/** Replaces the playlist with every record of the current file that can be played with the selected one */
+	void playAllRecordings();
+
+	void clearPlaylist();
+	int getPlaylistSize() const;
+
+	/** Returns the number of times playback found no data read ahead since acquisition started */
+	int getNumUnderruns() const;
+
+	/** Returns true once batch mode has output the last sample of the file */
+	bool hasReachedEnd() const;
+
+	/** Returns the number of samples output since acquisition started */
+	int64 getNumSamplesPlayed() const;
+
+	/** Returns the position in the record reached by playback, in ms. Updated after every
+	    block for the editor to poll, so process() never touches it. */
+	unsigned int getPlaybackTime() const;
+
+protected:
+    void createDataChannels()   override;
+    void createEventChannels()  override;
+    void createSpikeChannels()  override;
+
 private:
+    friend class FileReaderGroup;
+
     Array<const EventChannel*> moduleEventChannels;
     unsigned int count = 0;
     
@@ -90,7 +151,7 @@ private:
     int64 currentNumSamples;
     int64 startSample;
     int64 stopSample;
-    int64 bufferCacheWindow; // the current buffer window to read from readBuffer
+    int64 bufferCacheWindow; // the current buffer window to read from m_playBuffer
     Array<RecordedChannelInfo> channelInfo;
 
     // for testing purposes only
@@ -98,25 +159,133 @@ private:
 
     ScopedPointer<FileSource> input;
 
-    HeapBlock<int16> * readBuffer;      // Ptr to the current "front" buffer
-    HeapBlock<int16> bufferA;
-    HeapBlock<int16> bufferB;
+    HeapBlock<int16> bufferA;           // scratch for direct reads that can't be mapped
 
     HashMap<String, int> supportedExtensions;
     
-    Atomic<int> m_shouldFillBackBuffer;
     Atomic<int> m_samplesPerBuffer;
 
+	/** Ring of m_readAheadDepth buffer caches, filled by the reader thread from m_writeSlot
+	    and played by process() from m_readSlot. m_numFilled counts the caches ready to play,
+	    including the one being played while m_holdingSlot is set */
+	HeapBlock<int16> m_cache;
+	size_t m_slotSize;
+	int m_readAheadDepth;
+	int m_readSlot;
+	int m_writeSlot;
+	bool m_holdingSlot;
+	Atomic<int> m_numFilled;
+	WaitableEvent m_cacheFilled;
+	const int16* m_playBuffer;
+	Atomic<int> m_numUnderruns;
+
+	/** A seek is read into m_seekBuffer while the ring is still played. The reader then
+	    stops filling, so everything queued when process() takes it is from before the seek */
+	HeapBlock<int16> m_seekBuffer;
+	Atomic<int64> m_seekTarget;
+	Atomic<int> m_seekRequested;
+	Atomic<int> m_seekReady;
+	Atomic<int> m_seekBufferInUse;
+
 	unsigned int m_bufferSize;
 	float m_sysSampleRate;
+
+	bool m_batchMode;
+	int64 m_samplesToPlay;
+	Atomic<int> m_reachedEnd;
+
+	/** True while process() converts straight from the source's mapped file,
+	    with the reader thread only prefetching ahead of the play head */
+	bool m_directRead;
+	HeapBlock<float*> m_directOutputs;
+	Atomic<int64> m_playPosition;
+	Atomic<int64> m_prefetchTrigger;	// readDirect() wakes the reader once past here
+	int64 m_prefetchedUntil;
+
+	/** The group played in lockstep with, which then reads for this reader instead of its own
+	    thread. m_groupBlock counts the blocks played, and m_cachesNeeded the filled caches
+	    the next block needs to have data */
+	FileReaderGroup* m_group;
+	int64 m_groupBlock;
+	Atomic<int> m_cachesNeeded;
+
+	/** Plays numSamples from the mapped file at currentSample, looping at stopSample */
+	void readDirect (AudioSampleBuffer& buffer, int numSamples);
+
+	/** Asks the source to load the data about a second ahead of the play head. Returns false
+	    if it was already loaded that far */
+	bool prefetchAhead();
+
+	/** Output channels for the source's recorded event channels, by their index in the
+	    source; nullptr where the channel is of the other kind or can't be played */
+	Array<const EventChannel*> m_recordedEventChannels;
+	Array<const SpikeChannel*> m_recordedSpikeChannels;
+	Array<uint64> m_ttlWords;
+	int64 m_eventPosition;              // record position of the next sample played
+	Atomic<int64> m_publishedPosition;  // m_eventPosition once the block is done
+	Atomic<int64> m_samplesPlayed;
+
+	struct PlaylistEntry
+	{
+		File file;
+		int record;
+		int64 numSamples;
+	};
+
+	/** m_playlistSources holds an opened source for each entry being read or played, and
+	    nullptr for the others. The reader thread reads m_readItem, opening the entry after it
+	    in advance, and closes entries once process() has played them. */
+	Array<PlaylistEntry> m_playlist;
+	OwnedArray<FileSource> m_playlistSources;
+	FileSource* m_readSource;           // input, or the source of m_readItem
+	int m_readItem;
+	int m_playItem;                     // the entry process() plays events from
+	Atomic<int> m_playingItem;          // m_playItem, for the reader thread
+
+	/** Creates a source for files with the given extension, or returns nullptr if it isn't supported */
+	FileSource* createFileSource (const String& ext) const;
+
+	/** Creates a source for the file's format, opens it and activates record, or returns nullptr */
+	FileSource* openFileSource (const File& file, int record) const;
+
+	/** Moves the reader thread on to the next playlist entry. Returns false at the end of the
+	    playlist in batch mode */
+	bool readNextPlaylistEntry();
+
+	/** Opens the entry after m_readItem and closes those process() is done with */
+	void updatePlaylistSources();
+
+	/** Adds the recorded events and spikes of the next numSamples samples of the file to the
+	    current block and advances m_eventPosition, looping at stopSample like the continuous data */
+	void addRecordedEvents (int numSamples);
     
-    /** Swaps the backbuffer to the front and flags the background reader
-        thread to update the new backbuffer */
-    void switchBuffer();
-    
-    HeapBlock<int16>* getFrontBuffer();
-    HeapBlock<int16>* getBackBuffer();
-    
+    /** Hands the played cache back to the reader thread and points m_playBuffer at the next
+        one, or at a seek target that has been read. Returns false on an underrun */
+    bool switchBuffer();
+
+    /** Points playback at a seek the reader thread has finished. Returns false if there is none */
+    bool applySeek();
+
+    /** Moves playback of this reader alone to sample, see seekPlayback() */
+    void requestSeek (int64 sample);
+
+    /** Wakes whichever thread reads ahead for this reader */
+    void wakeReader();
+
+    /** Returns true while a thread reads ahead for this reader */
+    bool isReading() const;
+
+    /** Does the next piece of reading ahead: reads a seek target, prefetches or fills one
+        buffer cache. Returns false if there was nothing to do */
+    bool readAheadStep();
+
+    /** Returns how far reading is ahead of playback in seconds, or the largest double if
+        there is nothing to read. The group reads for the member with the least first */
+    double getReadAheadTime() const;
+
+    /** Returns true if the next block has data to play without waiting on a read */
+    bool hasDataReady() const;
+
     /** Executes the background thread task */
     void run() override;
     
@@ -124,7 +293,7 @@ private:
      
         This method will read into the buffer that passed in by the param 
      */
-    void readAndFillBufferCache(HeapBlock<int16> &cacheBuffer);
+    void readAndFillBufferCache(int16* cacheBuffer);
 
 	//Methods for built-in file sources
 	int getNumBuiltInFileSources() const;
@@ -24,9 +24,18 @@
 #include "FileReaderEditor.h"
 
 #include "FileReader.h"
+#include "FileReaderGroup.h"
 
 #include <stdio.h>
 
+namespace
+{
+    // item ids are the index + 1, 0 plays as fast as the signal chain allows
+    const double playbackSpeeds[] = { 0.1, 0.25, 0.5, 1.0, 2.0, 4.0, 8.0, 16.0, 0.0 };
+    const int numPlaybackSpeeds = sizeof (playbackSpeeds) / sizeof (playbackSpeeds[0]);
+    const int realTimeSpeedId = 4;
+}
+
 FileReaderEditor::FileReaderEditor (GenericProcessor* parentNode, bool useDefaultParameterEditors = true)
     : GenericEditor (parentNode, useDefaultParameterEditors)
     , fileReader   (static_cast<FileReader*> (parentNode))
@@ -45,10 +54,29 @@ FileReaderEditor::FileReaderEditor (GenericProcessor* parentNode, bool useDefaul
     addAndMakeVisible (fileNameLabel);
 
     recordSelector = new ComboBox ("Recordings");
-    recordSelector->setBounds (30, 50, 120, 20);
+    recordSelector->setBounds (30, 50, 85, 20);
     recordSelector->addListener (this);
     addAndMakeVisible (recordSelector);
 
+    speedSelector = new ComboBox ("Playback speed");
+    speedSelector->setBounds (120, 50, 55, 20);
+    for (int i = 0; i < numPlaybackSpeeds; ++i)
+        speedSelector->addItem (playbackSpeeds[i] > 0 ? String (playbackSpeeds[i]) + "x" : String ("Max"), i + 1);
+    speedSelector->setSelectedId (realTimeSpeedId, dontSendNotification);
+    speedSelector->setTooltip ("Playback speed. Speeds other than 1x disable audio output");
+    speedSelector->addListener (this);
+    addAndMakeVisible (speedSelector);
+
+    groupSelector = new ComboBox ("Playback group");
+    groupSelector->setBounds (180, 50, 45, 20);
+    groupSelector->addItem ("-", 1);
+    for (int i = 1; i <= FileReaderGroup::numGroups; ++i)
+        groupSelector->addItem ("G" + String (i), i + 1);
+    groupSelector->setSelectedId (1, dontSendNotification);
+    groupSelector->setTooltip ("Plays in lockstep with the other File Readers of the same group, with aligned timestamps");
+    groupSelector->addListener (this);
+    addAndMakeVisible (groupSelector);
+
     currentTime = new DualTimeComponent (this, false);
     currentTime->setBounds (5, 80, 175, 20);
     addAndMakeVisible (currentTime);
@@ -57,7 +85,7 @@ FileReaderEditor::FileReaderEditor (GenericProcessor* parentNode, bool useDefaul
     timeLimits->setBounds (5, 105, 175, 20);
     addAndMakeVisible (timeLimits);
 
-    desiredWidth = 180;
+    desiredWidth = 230;
 
     setEnabledState (false);
 }
@@ -177,7 +205,25 @@ void FileReaderEditor::setCurrentTime (unsigned int ms)
 
 void FileReaderEditor::comboBoxChanged (ComboBox* combo)
 {
-    fileReader->setParameter (0, combo->getSelectedId() - 1);
+    if (combo == speedSelector)
+    {
+        fileReader->setPlaybackSpeed (playbackSpeeds[combo->getSelectedId() - 1]);
+        return;
+    }
+    else if (combo == groupSelector)
+    {
+        fileReader->setPlaybackGroup (combo->getSelectedId() - 1);
+        return;
+    }
+
+    // the last item plays every recording back to back, with the channels of the first
+    const bool playAll = combo->getSelectedId() == combo->getNumItems() && combo->getNumItems() > 1;
+    fileReader->setParameter (0, playAll ? 0 : combo->getSelectedId() - 1);
+    if (playAll)
+        fileReader->playAllRecordings();
+
+    // playlist entries are always played whole
+    timeLimits->setEnable (fileReader->getPlaylistSize() == 0);
     CoreServices::updateSignalChain (this);
 }
 
@@ -185,6 +231,7 @@ void FileReaderEditor::comboBoxChanged (ComboBox* combo)
 void FileReaderEditor::populateRecordings (FileSource* source)
 {
     recordSelector->clear (dontSendNotification);
+    timeLimits->setEnable (true);
 
     const int numRecords = source->getNumRecords();
     for (int i = 0; i < numRecords; ++i)
@@ -193,6 +240,12 @@ void FileReaderEditor::populateRecordings (FileSource* source)
         recordSelector->addItem (source->getRecordName (i), i + 1);
     }
 
+    if (numRecords > 1)
+    {
+        recordSelector->addSeparator();
+        recordSelector->addItem ("All recordings", numRecords + 1);
+    }
+
     recordSelector->setSelectedId (1, dontSendNotification);
 }
 
@@ -214,14 +267,24 @@ void FileReaderEditor::clearEditor()
 void FileReaderEditor::startAcquisition()
 {
     recordSelector->setEnabled (false);
+    speedSelector->setEnabled (false);
+    groupSelector->setEnabled (false);
     timeLimits->setEnable (false);
 }
 
 
+void FileReaderEditor::updateFromProcessor()
+{
+    setCurrentTime (fileReader->getPlaybackTime());
+}
+
+
 void FileReaderEditor::stopAcquisition()
 {
     recordSelector->setEnabled (true);
-    timeLimits->setEnable (true);
+    speedSelector->setEnabled (true);
+    groupSelector->setEnabled (true);
+    timeLimits->setEnable (fileReader->getPlaylistSize() == 0);
 }
 
 
@@ -236,6 +299,11 @@ void FileReaderEditor::saveCustomParameters (XmlElement* xml)
     childNode = xml->createNewChildElement ("TIME_LIMITS");
     childNode->setAttribute ("start_time",  (double)timeLimits->getTimeMilliseconds (0));
     childNode->setAttribute ("stop_time",   (double)timeLimits->getTimeMilliseconds (1));
+
+    childNode = xml->createNewChildElement ("PLAYBACK");
+    childNode->setAttribute ("speed", playbackSpeeds[jmax (1, speedSelector->getSelectedId()) - 1]);
+    childNode->setAttribute ("read_ahead", fileReader->getReadAheadDepth());
+    childNode->setAttribute ("group", fileReader->getPlaybackGroup());
 }
 
 
@@ -263,6 +331,18 @@ void FileReaderEditor::loadCustomParameters (XmlElement* xml)
             setPlaybackStopTime (time);
             timeLimits->setTimeMilliseconds (1, time);
         }
+        else if (element->hasTagName ("PLAYBACK"))
+        {
+            const double speed = element->getDoubleAttribute ("speed", 1.0);
+            fileReader->setReadAheadDepth (element->getIntAttribute ("read_ahead", fileReader->getReadAheadDepth()));
+            groupSelector->setSelectedId (jlimit (0, int (FileReaderGroup::numGroups), element->getIntAttribute ("group", 0)) + 1, sendNotificationSync);
+
+            for (int i = 0; i < numPlaybackSpeeds; ++i)
+            {
+                if (playbackSpeeds[i] == speed)
+                    speedSelector->setSelectedId (i + 1, sendNotificationSync);
+            }
+        }
     }
 }
 
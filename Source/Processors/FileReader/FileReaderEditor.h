@@ -69,6 +69,7 @@ public:
 
 	void startAcquisition() override;
 	void stopAcquisition()  override;
+	void updateFromProcessor() override;
 
     void setFile (String file);
 
@@ -83,6 +84,8 @@ private:
     ScopedPointer<UtilityButton>        fileButton;
     ScopedPointer<Label>                fileNameLabel;
     ScopedPointer<ComboBox>             recordSelector;
+    ScopedPointer<ComboBox>             speedSelector;
+    ScopedPointer<ComboBox>             groupSelector;
     ScopedPointer<DualTimeComponent>    currentTime;
     ScopedPointer<DualTimeComponent>    timeLimits;
 
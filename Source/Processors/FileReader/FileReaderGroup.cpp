@@ -0,0 +1,194 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2016 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "FileReaderGroup.h"
+#include "FileReader.h"
+#include "../GenericProcessor/ThreadPolicy.h"
+#include <limits>
+
+class FileReaderGroup::Registry : private DeletedAtShutdown
+{
+public:
+	Registry()
+	{
+		for (int i = 0; i < numGroups; ++i)
+			groups.add(new FileReaderGroup(i + 1));
+	}
+
+	~Registry()
+	{
+		clearSingletonInstance();
+	}
+
+	OwnedArray<FileReaderGroup> groups;
+
+	juce_DeclareSingleton(Registry, false);
+};
+
+juce_ImplementSingleton(FileReaderGroup::Registry);
+
+
+FileReaderGroup* FileReaderGroup::getGroup(int index)
+{
+	if (index < 1 || index > numGroups)
+		return nullptr;
+
+	return Registry::getInstance()->groups[index - 1];
+}
+
+FileReaderGroup::FileReaderGroup(int index)
+	: Thread("filereader_Group_Reader_" + String(index))
+	, m_index(index)
+	, m_decidedBlock(-1)
+	, m_blockReady(false)
+{
+}
+
+FileReaderGroup::~FileReaderGroup()
+{
+	stopThread(2000);
+}
+
+int FileReaderGroup::getIndex() const
+{
+	return m_index;
+}
+
+void FileReaderGroup::addMember(FileReader* reader)
+{
+	m_members.addIfNotAlreadyThere(reader);
+}
+
+void FileReaderGroup::removeMember(FileReader* reader)
+{
+	memberStopped(reader);
+	m_members.removeFirstMatchingValue(reader);
+}
+
+int FileReaderGroup::getNumMembers() const
+{
+	return m_members.size();
+}
+
+void FileReaderGroup::memberStarted(FileReader* reader)
+{
+	{
+		const ScopedLock lock(m_activeLock);
+		m_active.addIfNotAlreadyThere(reader);
+		m_decidedBlock = -1;
+	}
+
+	if (!isThreadRunning())
+		startThread();
+	else
+		notify();
+}
+
+void FileReaderGroup::memberStopped(FileReader* reader)
+{
+	bool isLast;
+	{
+		// waits for a read for the member to finish
+		const ScopedLock lock(m_activeLock);
+		m_active.removeFirstMatchingValue(reader);
+		isLast = m_active.size() == 0;
+	}
+
+	if (isLast && isThreadRunning())
+	{
+		// a read can block for a while on a slow drive, so give it time to finish
+		signalThreadShouldExit();
+		notify();
+		stopThread(2000);
+	}
+}
+
+void FileReaderGroup::wake()
+{
+	notify();
+}
+
+bool FileReaderGroup::isReading() const
+{
+	return isThreadRunning();
+}
+
+bool FileReaderGroup::canPlayBlock(int64 block)
+{
+	const SpinLock::ScopedLockType lock(m_blockLock);
+
+	// decided by the first member to play the block, from what every member has read ahead
+	if (block != m_decidedBlock)
+	{
+		m_decidedBlock = block;
+		m_blockReady = true;
+		for (int i = 0; i < m_active.size() && m_blockReady; ++i)
+			m_blockReady = m_active.getUnchecked(i)->hasDataReady();
+	}
+
+	return m_blockReady;
+}
+
+void FileReaderGroup::seekAll(double seconds)
+{
+	for (int i = 0; i < m_active.size(); ++i)
+	{
+		FileReader* member = m_active.getUnchecked(i);
+		member->requestSeek(int64(seconds * member->currentSampleRate));
+	}
+}
+
+void FileReaderGroup::run()
+{
+	ThreadPolicy::applyToCurrentThread(ThreadPolicy::Acquisition);
+
+	while (!threadShouldExit())
+	{
+		bool didRead = false;
+		{
+			const ScopedLock lock(m_activeLock);
+
+			// the member with the least read ahead goes first, so the files are read in the
+			// order they are played
+			FileReader* next = nullptr;
+			double least = std::numeric_limits<double>::max();
+			for (int i = 0; i < m_active.size(); ++i)
+			{
+				const double readAhead = m_active.getUnchecked(i)->getReadAheadTime();
+				if (readAhead < least)
+				{
+					least = readAhead;
+					next = m_active.getUnchecked(i);
+				}
+			}
+
+			if (next != nullptr)
+				didRead = next->readAheadStep();
+		}
+
+		// woken by the members when they free a cache, pass their prefetch trigger or seek
+		if (!didRead && !threadShouldExit())
+			wait(500);
+	}
+}
@@ -0,0 +1,110 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2016 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef FILEREADERGROUP_H_INCLUDED
+#define FILEREADERGROUP_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+
+class FileReader;
+
+/**
+	Plays several File Readers in lockstep, e.g. the recordings of the probes of one session.
+
+	The readers of a group share one reader thread instead of each running its own. It
+	always reads next for the member with the least time read ahead of playback, so the
+	files are read cache by cache in the order their samples are played, every member
+	stays about the same time ahead and a slow file can't starve the others of the disk.
+
+	A group also keeps its members on a common clock. Once per block it decides for all of
+	them whether the block can be played, and if any member has nothing read ahead they all
+	output silence and hold their position. A slow file then never shifts its data against the
+	others, whose timestamps stay aligned with it. Seeking any member moves all of them to the
+	same time in their recordings.
+
+	Members join with FileReader::setPlaybackGroup() before acquisition starts. The thread runs
+	while any member acquires.
+
+	@see FileReader
+*/
+class FileReaderGroup : private Thread
+{
+public:
+	enum { numGroups = 4 };
+
+	/** Returns group 1 to numGroups, creating it the first time. Message thread only */
+	static FileReaderGroup* getGroup(int index);
+
+	~FileReaderGroup();
+
+	int getIndex() const;
+
+	void addMember(FileReader* reader);
+	void removeMember(FileReader* reader);
+	int getNumMembers() const;
+
+	/** Called from enable() of every member. Starts the thread with the first one */
+	void memberStarted(FileReader* reader);
+
+	/** Called from disable() of every member, after any read for it has finished. Stops the
+	thread with the last one */
+	void memberStopped(FileReader* reader);
+
+	/** Wakes the reader thread, after a member freed a cache or asked for a seek */
+	void wake();
+
+	/** Returns true while the reader thread runs, i.e. while any member acquires */
+	bool isReading() const;
+
+	/** Returns whether the members can play their block number block, counted from the start
+	of acquisition. All members get the same answer for the same block. Audio thread */
+	bool canPlayBlock(int64 block);
+
+	/** Moves every acquiring member to the given time in its recording */
+	void seekAll(double seconds);
+
+private:
+	class Registry;
+
+	FileReaderGroup(int index);
+
+	void run() override;
+
+	const int m_index;
+
+	Array<FileReader*> m_members;
+
+	/** Members acquiring. Only changed from enable() and disable(), before and after the audio
+	thread runs, and held by the reader thread while it reads for one of them */
+	Array<FileReader*> m_active;
+	CriticalSection m_activeLock;
+
+	SpinLock m_blockLock;
+	int64 m_decidedBlock;
+	bool m_blockReady;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FileReaderGroup);
+};
+
+#endif  // FILEREADERGROUP_H_INCLUDED
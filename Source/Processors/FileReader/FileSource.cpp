@@ -22,6 +22,7 @@
 */
 
 #include "FileSource.h"
+#include "../DataThreads/SampleConversion.h"
 
 
 FileSource::FileSource() 
@@ -29,6 +30,7 @@ FileSource::FileSource()
     , numRecords    (0)
     , activeRecord  (-1)
     , filename      ("")
+    , numBlockScales(0)
 {
 }
 
@@ -104,11 +106,73 @@ RecordedChannelInfo FileSource::getChannelInfo (int channel) const
 }
 
 
+int FileSource::getNumEventChannels() const
+{
+    return infoArray[activeRecord.get()].eventChannels.size();
+}
+
+
+RecordedEventChannelInfo FileSource::getEventChannelInfo (int index) const
+{
+    return infoArray[activeRecord.get()].eventChannels[index];
+}
+
+
+void FileSource::processBlockData (const int16* inBuffer, float* const* outBuffers, int numChannels, int64 numSamples)
+{
+    for (int i = 0; i < numChannels; ++i)
+        processChannelData (const_cast<int16*> (inBuffer), outBuffers[i], i, numSamples);
+}
+
+
+const int16* FileSource::getMappedData (int64, int)
+{
+    return nullptr;
+}
+
+
+void FileSource::prefetch (int64, int)
+{
+}
+
+
+void FileSource::seekEvents (int64)
+{
+}
+
+
+bool FileSource::readNextEvent (int64, RecordedEvent&)
+{
+    return false;
+}
+
+
+void FileSource::processInterleavedBlock (const int16* inBuffer, float* const* outBuffers, int numChannels, int64 numSamples)
+{
+    // filled by setActiveRecord(), so that the audio thread neither allocates nor copies
+    // the channel infos
+    jassert (numChannels <= numBlockScales);
+    numChannels = jmin (numChannels, numBlockScales);
+
+    SampleConversion::deinterleaveInt16ToFloat (outBuffers, inBuffer, numChannels, int (numSamples), blockScales);
+}
+
+
 void FileSource::setActiveRecord (int index)
 {
 //    activeRecord = index;
     activeRecord.set(index);
     updateActiveRecord();
+
+    const int numChannels = getActiveNumChannels();
+    if (numChannels > numBlockScales)
+    {
+        blockScales.realloc (numChannels);
+        numBlockScales = numChannels;
+    }
+
+    for (int i = 0; i < numChannels; ++i)
+        blockScales[i] = getChannelInfo (i).bitVolts;
 }
 
 
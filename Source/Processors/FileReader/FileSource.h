@@ -35,6 +35,43 @@ struct RecordedChannelInfo
 };
 
 
+/** A TTL, text or spike channel stored alongside the continuous data of a record */
+struct RecordedEventChannelInfo
+{
+    enum Kind
+    {
+        TTL,
+        TEXT,
+        SPIKE
+    };
+
+    Kind kind;
+    String name;
+    float sampleRate;
+    int numChannels;                // TTL lines or electrode channels
+    unsigned int textLength;        // TEXT only
+    unsigned int prePeakSamples;    // SPIKE only
+    unsigned int postPeakSamples;   // SPIKE only
+    Array<int> sourceChannels;      // SPIKE only, the continuous channels of the electrode
+};
+
+
+/** One event read back by FileSource::readNextEvent(). The pointers belong to the source
+    and stay valid until the active record changes. */
+struct RecordedEvent
+{
+    int64 sample;                   // relative to the first sample of the active record
+    int eventChannel;               // index of its RecordedEventChannelInfo
+    int line;                       // TTL line
+    bool state;                     // TTL state
+    const char* text;               // TEXT, textBytes long and not null terminated
+    size_t textBytes;
+    const int16* waveform;          // SPIKE, numChannels blocks of pre + post peak samples
+    float waveformBitVolts;         // SPIKE, scale of the waveform samples
+    uint16 sortedId;                // SPIKE
+};
+
+
 class PLUGIN_API FileSource
 {
 public:
@@ -57,6 +94,9 @@ public:
     RecordedChannelInfo getChannelInfo (int recordIndex, int channel) const;
     RecordedChannelInfo getChannelInfo (int channel) const;
 
+    int getNumEventChannels() const;
+    RecordedEventChannelInfo getEventChannelInfo (int index) const;
+
     void setActiveRecord (int index);
 
     bool OpenFile (File file);
@@ -65,17 +105,45 @@ public:
 
     virtual int readData (int16* buffer, int nSamples) = 0;
     virtual void processChannelData (int16* inBuffer, float* outBuffer, int channel, int64 numSamples) = 0;
+
+    /** Converts a whole block returned by readData() into one float buffer per channel.
+        The default calls processChannelData() for each channel; sources storing interleaved
+        int16 samples should override it with processInterleavedBlock(). */
+    virtual void processBlockData (const int16* inBuffer, float* const* outBuffers, int numChannels, int64 numSamples);
+
+    /** Returns the samples from sample to sample + numSamples in place, laid out like the buffer
+        filled by readData(), or nullptr if the source can't provide them without copying. When the
+        first sample is available FileReader plays straight from here instead of double buffering. */
+    virtual const int16* getMappedData (int64 sample, int numSamples);
+
+    /** Hints that the given samples will be read soon, so the source can start loading them. */
+    virtual void prefetch (int64 sample, int numSamples);
     virtual void seekTo (int64 sample) = 0;
 
+    /** Moves the event read position of the active record to its first event at or after
+        sample. Called when playback starts and every time it loops. */
+    virtual void seekEvents (int64 sample);
+
+    /** Reads the next event of the active record before endSample into event and advances
+        past it. Events come in time order within each event channel, but the channels are
+        read one after another. Returns false once there is none left before endSample. */
+    virtual bool readNextEvent (int64 endSample, RecordedEvent& event);
+
     virtual bool isReady();
 
 protected:
+    /** De-interleaves a block of int16 samples, numChannels per sample, scaling each channel by
+        the bitVolts of the active record. The block is transposed in cache-sized tiles with
+        vector conversions, so the data is only streamed through the cache once. */
+    void processInterleavedBlock (const int16* inBuffer, float* const* outBuffers, int numChannels, int64 numSamples);
+
     struct RecordInfo
     {
         String name;
         Array<RecordedChannelInfo> channels;
         int64 numSamples;
         float sampleRate;
+        Array<RecordedEventChannelInfo> eventChannels;
     };
     Array<RecordInfo> infoArray;
 
@@ -86,6 +154,10 @@ protected:
 
 
 private:
+    // bitVolts of each channel of the active record, filled by setActiveRecord()
+    HeapBlock<float> blockScales;
+    int numBlockScales;
+
     virtual bool Open (File file) = 0;
     virtual void fillRecordInfo() = 0;
     virtual void updateActiveRecord() = 0;
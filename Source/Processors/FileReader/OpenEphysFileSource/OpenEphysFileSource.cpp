@@ -0,0 +1,430 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "OpenEphysFileSource.h"
+#include <map>
+
+using namespace OpenEphysSource;
+
+//Layout of the .continuous files written by OriginalRecording
+#define HEADER_SIZE 1024
+#define BLOCK_LENGTH 1024
+//timestamp, sample count and recording number, samples, record marker
+#define RECORD_HEADER_SIZE (8 + 2 + 2)
+#define RECORD_SIZE (RECORD_HEADER_SIZE + BLOCK_LENGTH*2 + 10)
+//Records read at a time while indexing
+#define INDEX_CHUNK_RECORDS 256
+
+namespace
+{
+	const uint8 recordMarker[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 255 };
+	const char indexMagic[8] = { 'O', 'E', 'I', 'N', 'D', 'E', 'X', '1' };
+
+	bool isValidRecord(const char* record)
+	{
+		return ByteOrder::littleEndianShort(record + 8) == BLOCK_LENGTH
+			&& memcmp(record + RECORD_SIZE - 10, recordMarker, 10) == 0;
+	}
+
+	//Byte offset of the first record starting after from, found by its preceding marker, or -1
+	int64 findNextRecord(FileInputStream& in, int64 from, int64 end)
+	{
+		HeapBlock<char> chunk(65536);
+		int64 pos = from;
+		while (pos + 10 < end)
+		{
+			in.setPosition(pos);
+			int got = in.read(chunk, int(jmin<int64>(65536, end - pos)));
+			if (got < 10)
+				return -1;
+			for (int i = 0; i <= got - 10; i++)
+			{
+				if (memcmp(chunk + i, recordMarker, 10) == 0)
+					return pos + i + 10;
+			}
+			pos += got - 9;
+		}
+		return -1;
+	}
+
+	//Cached indexes go in the user's data folder, as the recordings can be on read only shares
+	File getIndexCacheFile(const File& file, int64 startPos)
+	{
+		return File::getSpecialLocation(File::userApplicationDataDirectory)
+			.getChildFile("open-ephys").getChildFile("FileReaderIndex")
+			.getChildFile(String::toHexString(file.getFullPathName().hashCode64()) + "_" + String(startPos) + ".idx");
+	}
+}
+
+OpenEphysFileSource::ChannelJob::ChannelJob(OpenEphysFileSource& s)
+	: ThreadPoolJob("Open Ephys file reader"), firstChannel(0), lastChannel(0), indexing(false), source(s)
+{}
+
+ThreadPoolJob::JobStatus OpenEphysFileSource::ChannelJob::runJob()
+{
+	for (int c = firstChannel; c < lastChannel; c++)
+	{
+		if (indexing)
+			source.indexChannel(c);
+		else
+			source.readChannel(c);
+	}
+	return jobHasFinished;
+}
+
+namespace
+{
+	const int numReadThreads = jlimit(1, 8, SystemStats::getNumCpus());
+}
+
+OpenEphysFileSource::OpenEphysFileSource()
+	: m_pool(numReadThreads), m_samplePos(0), m_readBuffer(nullptr), m_readStart(0), m_readSamples(0)
+{
+	for (int i = 0; i < numReadThreads; i++)
+		m_jobs.add(new ChannelJob(*this));
+}
+
+OpenEphysFileSource::~OpenEphysFileSource()
+{
+	m_pool.removeAllJobs(true, -1);
+}
+
+bool OpenEphysFileSource::Open(File file)
+{
+	XmlDocument doc(file);
+	m_xml = doc.getDocumentElement();
+	if (m_xml == nullptr || !m_xml->hasTagName("EXPERIMENT"))
+	{
+		m_xml = nullptr;
+		return false;
+	}
+
+	m_rootPath = file.getParentDirectory();
+
+	return true;
+}
+
+void OpenEphysFileSource::fillRecordInfo()
+{
+	//Files are appended to by each recording unless they are separate, so a recording ends where the next one starts
+	std::multimap<String, int64> positions;
+	forEachXmlChildElementWithTagName(*m_xml, recording, "RECORDING")
+	{
+		forEachXmlChildElementWithTagName(*recording, processor, "PROCESSOR")
+		{
+			forEachXmlChildElementWithTagName(*processor, channel, "CHANNEL")
+			{
+				positions.insert(std::make_pair(channel->getStringAttribute("filename"), int64(channel->getDoubleAttribute("position"))));
+			}
+		}
+	}
+
+	forEachXmlChildElementWithTagName(*m_xml, recording, "RECORDING")
+	{
+		forEachXmlChildElementWithTagName(*recording, processor, "PROCESSOR")
+		{
+			RecordInfo info;
+			info.name = "Recording " + recording->getStringAttribute("number") + " (" + processor->getStringAttribute("id") + ")";
+			info.sampleRate = recording->getDoubleAttribute("samplerate");
+			info.numSamples = -1;
+
+			Array<ChannelLocation> locations;
+			forEachXmlChildElementWithTagName(*processor, channel, "CHANNEL")
+			{
+				ChannelLocation location;
+				location.file = m_rootPath.getChildFile(channel->getStringAttribute("filename"));
+				if (!location.file.existsAsFile())
+					continue;
+
+				location.startPos = int64(channel->getDoubleAttribute("position"));
+				location.endPos = location.file.getSize();
+				auto range = positions.equal_range(channel->getStringAttribute("filename"));
+				for (auto it = range.first; it != range.second; ++it)
+				{
+					if (it->second > location.startPos && it->second < location.endPos)
+						location.endPos = it->second;
+				}
+
+				//A new file starts with its header
+				if (location.startPos < HEADER_SIZE)
+					location.startPos = HEADER_SIZE;
+
+				//Until it is indexed, assume the file holds nothing but complete records
+				int64 numSamples = (location.endPos - location.startPos) / RECORD_SIZE * BLOCK_LENGTH;
+				if (info.numSamples < 0 || numSamples < info.numSamples)
+					info.numSamples = numSamples;
+
+				RecordedChannelInfo cInfo;
+				cInfo.name = channel->getStringAttribute("name");
+				cInfo.bitVolts = channel->getDoubleAttribute("bitVolts");
+				info.channels.add(cInfo);
+				locations.add(location);
+			}
+
+			if (locations.size() == 0 || info.numSamples <= 0)
+				continue;
+
+			//The sample rate saved with the recording is that of its last processor, so prefer the file header's
+			FileInputStream header(locations[0].file);
+			if (header.openedOk())
+			{
+				HeapBlock<char> text(HEADER_SIZE + 1, true);
+				header.read(text, HEADER_SIZE);
+				String rate = String(text.getData()).fromFirstOccurrenceOf("header.sampleRate = ", false, false).upToFirstOccurrenceOf(";", false, false);
+				if (rate.getDoubleValue() > 0)
+					info.sampleRate = rate.getDoubleValue();
+			}
+
+			infoArray.add(info);
+			m_locationArray.add(locations);
+			numRecords++;
+		}
+	}
+}
+
+void OpenEphysFileSource::updateActiveRecord()
+{
+	m_channels.clear();
+	m_samplePos = 0;
+
+	const Array<ChannelLocation>& locations = m_locationArray.getReference(activeRecord.get());
+	for (int i = 0; i < locations.size(); i++)
+	{
+		ChannelFile* chan = m_channels.add(new ChannelFile());
+		chan->location = locations[i];
+		chan->stream = new FileInputStream(chan->location.file);
+		chan->scratchSize = 0;
+		if (!chan->stream->openedOk())
+			std::cerr << "Could not open " << chan->location.file.getFullPathName() << std::endl;
+	}
+
+	runChannelJobs(true);
+
+	//Play as far as every channel has data
+	int64 numRecords = -1;
+	for (int i = 0; i < m_channels.size(); i++)
+	{
+		if (numRecords < 0 || m_channels[i]->index.size() < numRecords)
+			numRecords = m_channels[i]->index.size();
+	}
+	infoArray.getReference(activeRecord.get()).numSamples = jmax<int64>(0, numRecords) * BLOCK_LENGTH;
+}
+
+void OpenEphysFileSource::runChannelJobs(bool indexing)
+{
+	const int numChannels = m_channels.size();
+	const int numJobs = jmin(m_jobs.size(), numChannels);
+
+	for (int i = 0; i < numJobs; i++)
+	{
+		ChannelJob* job = m_jobs[i];
+		job->firstChannel = numChannels * i / numJobs;
+		job->lastChannel = numChannels * (i + 1) / numJobs;
+		job->indexing = indexing;
+		m_pool.addJob(job, false);
+	}
+
+	for (int i = 0; i < numJobs; i++)
+		m_pool.waitForJobToFinish(m_jobs[i], -1);
+}
+
+void OpenEphysFileSource::indexChannel(int channel)
+{
+	ChannelFile& chan = *m_channels[channel];
+	const ChannelLocation& location = chan.location;
+	if (!chan.stream->openedOk())
+		return;
+
+	File cacheFile = getIndexCacheFile(location.file, location.startPos);
+	const int64 fileSize = location.file.getSize();
+	const int64 modified = location.file.getLastModificationTime().toMilliseconds();
+
+	FileInputStream cached(cacheFile);
+	if (cached.openedOk())
+	{
+		char magic[8];
+		if (cached.read(magic, 8) == 8 && memcmp(magic, indexMagic, 8) == 0
+			&& cached.readInt64() == fileSize && cached.readInt64() == modified && cached.readInt64() == location.endPos)
+		{
+			const int64 numEntries = cached.readInt64();
+			if (numEntries >= 0 && cached.getTotalLength() - cached.getPosition() == numEntries * int64(sizeof(RecordEntry)))
+			{
+				chan.index.resize(int(numEntries));
+				if (numEntries == 0 || cached.read(chan.index.getRawDataPointer(), int(numEntries * sizeof(RecordEntry))) == int(numEntries * sizeof(RecordEntry)))
+					return;
+			}
+		}
+	}
+
+	if (!buildIndex(chan))
+		return;
+
+	cacheFile.getParentDirectory().createDirectory();
+	FileOutputStream out(cacheFile);
+	if (out.openedOk())
+	{
+		out.setPosition(0);
+		out.truncate();
+		out.write(indexMagic, 8);
+		out.writeInt64(fileSize);
+		out.writeInt64(modified);
+		out.writeInt64(location.endPos);
+		out.writeInt64(chan.index.size());
+		out.write(chan.index.getRawDataPointer(), chan.index.size() * sizeof(RecordEntry));
+	}
+}
+
+bool OpenEphysFileSource::buildIndex(ChannelFile& chan)
+{
+	FileInputStream& in = *chan.stream;
+	const int64 end = chan.location.endPos;
+	HeapBlock<char> chunk(INDEX_CHUNK_RECORDS * RECORD_SIZE);
+
+	chan.index.clearQuick();
+	int64 pos = chan.location.startPos;
+	while (pos + RECORD_SIZE <= end)
+	{
+		in.setPosition(pos);
+		const int64 wanted = jmin<int64>(INDEX_CHUNK_RECORDS, (end - pos) / RECORD_SIZE) * RECORD_SIZE;
+		const int numRead = in.read(chunk, int(wanted)) / RECORD_SIZE;
+		if (numRead <= 0)
+			break;
+
+		int r = 0;
+		for (; r < numRead; r++)
+		{
+			const char* record = chunk + r * RECORD_SIZE;
+			if (!isValidRecord(record))
+				break;
+
+			RecordEntry entry;
+			entry.timestamp = ByteOrder::littleEndianInt64(record);
+			entry.offset = pos + r * RECORD_SIZE;
+			chan.index.add(entry);
+		}
+		pos += r * RECORD_SIZE;
+
+		//A damaged record, e.g. from a crash, is skipped up to the next record marker
+		if (r < numRead)
+		{
+			std::cerr << "Skipping a damaged record at byte " << pos << " of " << chan.location.file.getFileName() << std::endl;
+			pos = findNextRecord(in, pos + 1, end);
+			if (pos < 0)
+				break;
+		}
+	}
+
+	return in.getStatus().wasOk();
+}
+
+void OpenEphysFileSource::seekTo(int64 sample)
+{
+	int64 numSamples = getActiveNumSamples();
+	m_samplePos = (numSamples > 0) ? sample % numSamples : 0;
+}
+
+int OpenEphysFileSource::readData(int16* buffer, int nSamples)
+{
+	int64 samplesToRead = jmin<int64>(nSamples, getActiveNumSamples() - m_samplePos);
+	if (samplesToRead <= 0)
+		return 0;
+
+	m_readBuffer = buffer;
+	m_readStart = m_samplePos;
+	m_readSamples = int(samplesToRead);
+	runChannelJobs(false);
+
+	m_samplePos += samplesToRead;
+	return int(samplesToRead);
+}
+
+void OpenEphysFileSource::readChannel(int channel)
+{
+	ChannelFile& chan = *m_channels[channel];
+	const int numChannels = m_channels.size();
+	const int64 numEntries = chan.index.size();
+
+	int done = 0;
+	while (done < m_readSamples)
+	{
+		const int64 sample = m_readStart + done;
+		const int64 first = sample / BLOCK_LENGTH;
+		if (first >= numEntries)
+			break;
+
+		//Read the records that follow each other in the file in one go
+		const int64 lastWanted = jmin(numEntries - 1, (sample + m_readSamples - done - 1) / BLOCK_LENGTH);
+		int64 last = first;
+		while (last < lastWanted && chan.index.getReference(int(last + 1)).offset == chan.index.getReference(int(last)).offset + RECORD_SIZE)
+			last++;
+
+		const size_t bytes = size_t(last - first + 1) * RECORD_SIZE;
+		if (bytes > chan.scratchSize)
+		{
+			chan.scratch.realloc(bytes);
+			chan.scratchSize = bytes;
+		}
+
+		chan.stream->setPosition(chan.index.getReference(int(first)).offset);
+		const int numRead = chan.stream->read(chan.scratch, int(bytes));
+		if (numRead < int(bytes))
+			zeromem(chan.scratch + jmax(0, numRead), bytes - jmax(0, numRead));
+
+		for (int64 r = first; r <= last; r++)
+		{
+			const char* samples = chan.scratch + (r - first) * RECORD_SIZE + RECORD_HEADER_SIZE;
+			const int from = (r == first) ? int(sample % BLOCK_LENGTH) : 0;
+			const int n = jmin(BLOCK_LENGTH - from, m_readSamples - done);
+
+			//Samples are stored big endian
+			int16* dest = m_readBuffer + done * numChannels + channel;
+			for (int i = 0; i < n; i++)
+				dest[i * numChannels] = int16(ByteOrder::bigEndianShort(samples + (from + i) * 2));
+			done += n;
+		}
+	}
+
+	for (; done < m_readSamples; done++)
+		m_readBuffer[done * numChannels + channel] = 0;
+}
+
+void OpenEphysFileSource::processChannelData(int16* inBuffer, float* outBuffer, int channel, int64 numSamples)
+{
+	int n = getActiveNumChannels();
+	float bitVolts = getChannelInfo(channel).bitVolts;
+
+	for (int i = 0; i < numSamples; i++)
+	{
+		*(outBuffer + i) = *(inBuffer + (n*i) + channel) * bitVolts;
+	}
+}
+
+void OpenEphysFileSource::processBlockData(const int16* inBuffer, float* const* outBuffers, int numChannels, int64 numSamples)
+{
+	processInterleavedBlock(inBuffer, outBuffers, numChannels, numSamples);
+}
+
+bool OpenEphysFileSource::isReady()
+{
+	return true;
+}
@@ -0,0 +1,123 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef OPENEPHYSFILESOURCE_H_INCLUDED
+#define OPENEPHYSFILESOURCE_H_INCLUDED
+
+#include "../FileSource.h"
+
+namespace OpenEphysSource
+{
+	/**
+	Plays recordings in the Open Ephys format, described by a .openephys file with one
+	.continuous file per channel. Each recording of each processor is a record.
+
+	The files are located by an index of their records, timestamps and byte offsets, which is
+	built the first time a record is played and cached in the application data folder. The
+	channel files of a block are read in parallel.
+	*/
+	class OpenEphysFileSource : public FileSource
+	{
+	public:
+		OpenEphysFileSource();
+		~OpenEphysFileSource();
+
+		int readData(int16* buffer, int nSamples) override;
+
+		void seekTo(int64 sample) override;
+
+		void processChannelData(int16* inBuffer, float* outBuffer, int channel, int64 numSamples) override;
+		void processBlockData(const int16* inBuffer, float* const* outBuffers, int numChannels, int64 numSamples) override;
+
+		bool isReady() override;
+
+	private:
+		bool Open(File file) override;
+		void fillRecordInfo() override;
+		void updateActiveRecord() override;
+
+		struct RecordEntry
+		{
+			int64 timestamp;
+			int64 offset;
+		};
+
+		/** The part of a .continuous file holding a channel of a record */
+		struct ChannelLocation
+		{
+			File file;
+			int64 startPos;
+			int64 endPos;
+		};
+
+		/** A channel file of the active record */
+		struct ChannelFile
+		{
+			ChannelLocation location;
+			ScopedPointer<FileInputStream> stream;
+			Array<RecordEntry> index;
+			HeapBlock<char> scratch;
+			size_t scratchSize;
+		};
+
+		/** Runs indexChannel() or readChannel() over a range of channels on the thread pool */
+		class ChannelJob : public ThreadPoolJob
+		{
+		public:
+			ChannelJob(OpenEphysFileSource& source);
+			JobStatus runJob() override;
+
+			int firstChannel;
+			int lastChannel;
+			bool indexing;
+
+		private:
+			OpenEphysFileSource& source;
+		};
+
+		/** Runs a job for every channel of the active record, split over the pool, and waits for them */
+		void runChannelJobs(bool indexing);
+
+		/** Loads the index of a channel from the cache, or builds and caches it */
+		void indexChannel(int channel);
+		bool buildIndex(ChannelFile& chan);
+
+		/** Reads m_readSamples samples from m_readStart of a channel into its column of m_readBuffer */
+		void readChannel(int channel);
+
+		ScopedPointer<XmlElement> m_xml;
+		File m_rootPath;
+		Array<Array<ChannelLocation>> m_locationArray;
+
+		OwnedArray<ChannelFile> m_channels;
+		OwnedArray<ChannelJob> m_jobs;
+		ThreadPool m_pool;
+
+		int64 m_samplePos;
+		int16* m_readBuffer;
+		int64 m_readStart;
+		int m_readSamples;
+	};
+}
+
+#endif
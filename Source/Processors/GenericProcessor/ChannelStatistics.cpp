@@ -0,0 +1,158 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "ChannelStatistics.h"
+#include "../Dsp/NoiseLevelEstimator.h"
+#include <cmath>
+
+namespace
+{
+	/** Sum and sum of squares of a block, on four lanes the compiler can keep in one vector */
+	void sumBlock(const float* samples, int numSamples, double& sum, double& sumOfSquares)
+	{
+		float s[4] = { 0, 0, 0, 0 };
+		float q[4] = { 0, 0, 0, 0 };
+		int i = 0;
+		for (; i + 4 <= numSamples; i += 4)
+		{
+			for (int l = 0; l < 4; l++)
+			{
+				const float x = samples[i + l];
+				s[l] += x;
+				q[l] += x * x;
+			}
+		}
+		for (; i < numSamples; i++)
+		{
+			s[0] += samples[i];
+			q[0] += samples[i] * samples[i];
+		}
+		sum = double(s[0]) + s[1] + s[2] + s[3];
+		sumOfSquares = double(q[0]) + q[1] + q[2] + q[3];
+	}
+}
+
+ChannelStatistics::ChannelStatistics()
+	: m_numChannels(0),
+	m_sampleRate(0),
+	m_timeConstant(10.0f),
+	m_noise(new Dsp::NoiseLevelEstimator()),
+	m_sequence(0)
+{
+}
+
+ChannelStatistics::~ChannelStatistics()
+{
+}
+
+void ChannelStatistics::setup(int numChannels, float sampleRate, float timeConstant)
+{
+	m_numChannels = jmax(0, numChannels);
+	m_sampleRate = sampleRate;
+	m_timeConstant = timeConstant;
+
+	m_noise->setup(m_numChannels, jmax(1.0f, sampleRate), timeConstant);
+	m_mean.allocate(jmax(1, m_numChannels), true);
+	m_meanSquare.allocate(jmax(1, m_numChannels), true);
+	m_started.allocate(jmax(1, m_numChannels), true);
+	m_snapshot.allocate(jmax(1, m_numChannels), true);
+}
+
+void ChannelStatistics::reset()
+{
+	m_noise->reset();
+	if (m_numChannels == 0)
+		return;
+
+	m_mean.clear(m_numChannels);
+	m_meanSquare.clear(m_numChannels);
+	m_started.clear(m_numChannels);
+	m_sequence.fetch_add(1, std::memory_order_acq_rel);
+	m_snapshot.clear(m_numChannels);
+	m_sequence.fetch_add(1, std::memory_order_release);
+}
+
+void ChannelStatistics::process(int channel, int numSamples, const float* samples)
+{
+	if (channel < 0 || channel >= m_numChannels || numSamples <= 0)
+		return;
+
+	double sum, sumOfSquares;
+	sumBlock(samples, numSamples, sum, sumOfSquares);
+
+	// the first block sets the averages, so they don't have to climb from zero
+	double weight = 1.0;
+	if (m_started[channel])
+		weight = 1.0 - std::exp(-numSamples / (jmax(1.0f, m_sampleRate) * m_timeConstant));
+	m_started[channel] = 1;
+
+	m_mean[channel] += weight * (sum / numSamples - m_mean[channel]);
+	m_meanSquare[channel] += weight * (sumOfSquares / numSamples - m_meanSquare[channel]);
+	m_noise->process(channel, numSamples, samples);
+}
+
+void ChannelStatistics::publish()
+{
+	m_sequence.fetch_add(1, std::memory_order_acq_rel);
+	std::atomic_thread_fence(std::memory_order_release);
+	for (int c = 0; c < m_numChannels; c++)
+	{
+		Values& values = m_snapshot[c];
+		values.mean = float(m_mean[c]);
+		values.rms = float(std::sqrt(m_meanSquare[c]));
+		values.noise = m_noise->getNoiseLevel(c);
+	}
+	m_sequence.fetch_add(1, std::memory_order_release);
+}
+
+ChannelStatistics::Values ChannelStatistics::getValues(int channel) const
+{
+	Values values = { 0, 0, 0 };
+	if (channel < 0 || channel >= m_numChannels)
+		return values;
+
+	// retried if the processing thread published while the values were copied
+	for (;;)
+	{
+		const uint32 before = m_sequence.load(std::memory_order_acquire);
+		if ((before & 1) == 0)
+		{
+			values = m_snapshot[channel];
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (m_sequence.load(std::memory_order_relaxed) == before)
+				return values;
+		}
+		Thread::yield();
+	}
+}
+
+float ChannelStatistics::getNoiseLevel(int channel) const
+{
+	return getValues(channel).noise;
+}
+
+size_t ChannelStatistics::getMemorySize() const
+{
+	return size_t(m_numChannels) * (2 * sizeof(double) + sizeof(char) + sizeof(Values));
+}
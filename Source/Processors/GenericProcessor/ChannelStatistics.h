@@ -0,0 +1,111 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef CHANNELSTATISTICS_H_INCLUDED
+#define CHANNELSTATISTICS_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "../PluginManager/OpenEphysPlugin.h"
+#include <atomic>
+
+namespace Dsp
+{
+	class NoiseLevelEstimator;
+}
+
+/**
+	Running mean, RMS and noise level of every channel of a processor's input.
+
+	Computed incrementally, block after block, on the thread processing the data:
+	the mean and mean square of each block are blended into exponential averages
+	with the given time constant, and the noise level is the median absolute
+	deviation of Dsp::NoiseLevelEstimator, scaled to a standard deviation. At the
+	end of every block the values are published to a snapshot, which any thread can
+	read without locking or waiting on the one processing the data.
+
+	A processor computes these for its input while anyone is subscribed to them,
+	see GenericProcessor::subscribeToInputStatistics() and
+	CoreServices::subscribeChannelStatistics(), so a processor, its editor and its
+	canvas share one computation instead of each keeping their own.
+
+	@see Dsp::NoiseLevelEstimator
+*/
+class PLUGIN_API ChannelStatistics
+{
+public:
+	struct Values
+	{
+		float mean;
+		float rms;
+		/** Median based standard deviation of the noise, zero until it has warmed up */
+		float noise;
+	};
+
+	ChannelStatistics();
+	~ChannelStatistics();
+
+	/** Sets the number of channels, their sample rate and the time constant of the
+	averages, in seconds, and clears them. Not while processing. */
+	void setup(int numChannels, float sampleRate, float timeConstant = 10.0f);
+
+	int getNumChannels() const { return m_numChannels; }
+
+	/** Clears every channel. Not while processing. */
+	void reset();
+
+	/** Adds numSamples consecutive samples of a channel. From the processing thread */
+	void process(int channel, int numSamples, const float* samples);
+
+	/** Makes the values of the channels processed so far visible to getValues().
+	From the processing thread, once per block */
+	void publish();
+
+	/** Returns the last published values of a channel. From any thread */
+	Values getValues(int channel) const;
+
+	/** Shortcut for getValues(channel).noise */
+	float getNoiseLevel(int channel) const;
+
+	/** Bytes taken by the running values of the channels */
+	size_t getMemorySize() const;
+
+private:
+	int m_numChannels;
+	float m_sampleRate;
+	float m_timeConstant;
+
+	// processing thread
+	ScopedPointer<Dsp::NoiseLevelEstimator> m_noise;
+	HeapBlock<double> m_mean;
+	HeapBlock<double> m_meanSquare;
+	HeapBlock<char> m_started;
+
+	// published, behind a sequence counter that is odd while they are written
+	HeapBlock<Values> m_snapshot;
+	std::atomic<uint32> m_sequence;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChannelStatistics);
+};
+
+#endif  // CHANNELSTATISTICS_H_INCLUDED
@@ -23,9 +23,16 @@
 #include "GenericProcessor.h"
 #include "../../UI/UIComponent.h"
 #include "../../AccessClass.h"
+#include "ProcessorThreadPool.h"
+#include "TraceRecorder.h"
+#include "GlobalClock.h"
 
 #include <exception>
 
+// Set while a parallelFor() range runs, so events added from it go to that range's buffer
+static thread_local MidiBuffer* rangeEventBuffer = nullptr;
+static thread_local int rangeIndexOfThread = 0;
+
 
 const String GenericProcessor::m_unusedNameString("xxx-UNUSED-OPEN-EPHYS-xxx");
 
@@ -41,12 +48,19 @@ GenericProcessor::GenericProcessor(const String& name)
 	, editor(nullptr)
 	, parametersAsXml(nullptr)
 	, sendSampleCount(true)
+	, m_statisticsSubscribers(0)
+	, m_settingsChanged(true)
+	, m_settingsGeneration(0)
 	, m_processorType(PROCESSOR_TYPE_UTILITY)
 	, m_name(name)
 	, m_isParamsWereLoaded(false)
+	, m_eventGeneration(0)
+	, m_eventScratchStride(0)
+	, m_eventClassesOfInterest(ALL_EVENT_CLASSES)
 {
 	settings.numInputs = settings.numOutputs = 0;
 	m_lastProcessTime = Time::getHighResolutionTicks();
+	m_traceName = TraceRecorder::getPooledName(name);
 }
 
 
@@ -65,6 +79,7 @@ AudioProcessorEditor* GenericProcessor::createEditor()
 void GenericProcessor::setNodeId(int id)
 {
 	nodeId = id;
+	m_traceName = TraceRecorder::getPooledName(m_name + " (" + String(id) + ")");
 
 	if (editor != 0)
 	{
@@ -303,8 +318,54 @@ void GenericProcessor::clearSettings()
 }
 
 
+void GenericProcessor::setSettingsChanged()
+{
+	m_settingsChanged = true;
+}
+
+
+uint32 GenericProcessor::getSettingsGeneration() const
+{
+	return m_settingsGeneration;
+}
+
+
+Array<GenericProcessor*> GenericProcessor::getSettingsSources() const
+{
+	Array<GenericProcessor*> sources;
+	sources.add(sourceNode);
+	return sources;
+}
+
+
+Array<uint32> GenericProcessor::getSettingsSourceStamp() const
+{
+	Array<GenericProcessor*> sources = getSettingsSources();
+	Array<uint32> stamp;
+
+	for (int i = 0; i < sources.size(); ++i)
+	{
+		stamp.add(sources[i] != nullptr ? uint32(sources[i]->getNodeId()) : 0);
+		stamp.add(sources[i] != nullptr ? sources[i]->getSettingsGeneration() : 0);
+	}
+
+	return stamp;
+}
+
+
 void GenericProcessor::update()
 {
+	// the info objects are only rebuilt if this processor or one upstream of it changed,
+	// so the ones of the unchanged part of the signal chain are kept as they are
+	Array<uint32> sourceStamp = getSettingsSourceStamp();
+
+	if (!m_settingsChanged && sourceStamp == m_settingsSourceStamp)
+		return;
+
+	m_settingsChanged = false;
+	m_settingsSourceStamp.swapWith(sourceStamp);
+	++m_settingsGeneration;
+
 	std::cout << getName() << " updating settings." << std::endl;
 
 	// ---- RESET EVERYTHING ---- ///
@@ -389,6 +450,7 @@ void GenericProcessor::update()
 	updateSettings(); // allow processors to change custom settings
 
 	updateChannelIndexes();
+	m_inputStatistics.setup(dataChannelArray.size(), getSampleRate());
 
 	m_needsToSendTimestampMessages.clear();
 	m_needsToSendTimestampMessages.insertMultiple(-1, false, getNumSubProcessors());
@@ -452,6 +514,79 @@ void GenericProcessor::updateChannelIndexes(bool updateNodeID)
 		}
 		uint32 sourceID = getProcessorFullId(channel->getSourceNodeID(), channel->getSubProcessorIdx());
 		spikeChannelMap[sourceID][channel->getSourceIndex()] = i;
+
+		// the data channels of the electrode, so the spike paths don't have to look them up
+		const Array<SourceChannelInfo>& sources = channel->getSourceChannelInfo();
+		for (int j = 0; j < sources.size(); j++)
+		{
+			const SourceChannelInfo& source = sources.getReference(j);
+			channel->m_currentNodeSourceChannels.set(j, getDataChannelIndex(source.channelIDX, source.processorID, source.subProcessorID));
+		}
+	}
+
+	updateSourceTable();
+}
+
+void GenericProcessor::updateSourceTable()
+{
+	Array<uint32> sourceIds;
+	Array<int> channelSlots;
+
+	for (int i = 0; i < dataChannelArray.size(); i++)
+	{
+		uint32 sourceID = getProcessorFullId(dataChannelArray[i]->getSourceNodeID(), dataChannelArray[i]->getSubProcessorIdx());
+		int slot = sourceIds.indexOf(sourceID);
+		if (slot < 0)
+		{
+			slot = sourceIds.size();
+			sourceIds.add(sourceID);
+		}
+		channelSlots.add(slot);
+	}
+
+	// Processors generating timestamps write their own, so give them a slot even without channels
+	for (int i = 0; i < getNumSubProcessors(); i++)
+		sourceIds.addIfNotAlreadyThere(getProcessorFullId(nodeId, i));
+
+	// Keep the last known values across the rebuild
+	Array<uint32> sourceNumSamples;
+	Array<juce::uint64> sourceTimestamps;
+	for (int i = 0; i < sourceIds.size(); i++)
+	{
+		sourceNumSamples.add(getNumSourceSamples(sourceIds[i]));
+		sourceTimestamps.add(getSourceTimestamp(sourceIds[i]));
+	}
+
+	m_sourceIds.swapWith(sourceIds);
+	m_sourceNumSamples.swapWith(sourceNumSamples);
+	m_sourceTimestamps.swapWith(sourceTimestamps);
+	m_channelSourceSlots.swapWith(channelSlots);
+}
+
+int GenericProcessor::findSourceSlot(uint32 fullSourceID) const
+{
+	// Only a handful of sources feed any one processor, a scan beats hashing here
+	const int numSources = m_sourceIds.size();
+	for (int i = 0; i < numSources; i++)
+	{
+		if (m_sourceIds.getUnchecked(i) == fullSourceID)
+			return i;
+	}
+	return -1;
+}
+
+void GenericProcessor::storeSourceTimestamp(uint32 fullSourceID, juce::uint64 timestamp, uint32 nSamples)
+{
+	const int slot = findSourceSlot(fullSourceID);
+	if (slot >= 0)
+	{
+		m_sourceTimestamps.getReference(slot) = timestamp;
+		m_sourceNumSamples.getReference(slot) = nSamples;
+	}
+	else
+	{
+		timestamps[fullSourceID] = timestamp;
+		numSamples[fullSourceID] = nSamples;
 	}
 }
 
@@ -575,6 +710,11 @@ void GenericProcessor::disableEditor()
 /** Used to get the number of samples in a given buffer, for a given channel. */
 uint32 GenericProcessor::getNumSamples(int channelNum) const
 {
+	// Channels are only looked up in the table while it matches the channel array;
+	// processors that edit their channels outside update() take the slow path
+	if (channelNum >= 0 && channelNum < m_channelSourceSlots.size() && m_channelSourceSlots.size() == dataChannelArray.size())
+		return m_sourceNumSamples.getUnchecked(m_channelSourceSlots.getUnchecked(channelNum));
+
 	int sourceNodeId = 0;
 	int subProcessorId = 0;
 	int nSamples = 0;
@@ -592,14 +732,7 @@ uint32 GenericProcessor::getNumSamples(int channelNum) const
 
 	// std::cout << "Requesting samples for channel " << channelNum << " with source node " << sourceNodeId << std::endl;
 	uint32 sourceID = getProcessorFullId(sourceNodeId, subProcessorId);
-	try
-	{
-		nSamples = numSamples.at(sourceID);
-	}
-	catch (...)
-	{
-		return 0;
-	}
+	nSamples = getNumSourceSamples(sourceID);
 
 	//std::cout << nSamples << " were found." << std::endl;
 
@@ -610,6 +743,9 @@ uint32 GenericProcessor::getNumSamples(int channelNum) const
 /** Used to get the timestamp for a given buffer, for a given source node. */
 juce::uint64 GenericProcessor::getTimestamp(int channelNum) const
 {
+	if (channelNum >= 0 && channelNum < m_channelSourceSlots.size() && m_channelSourceSlots.size() == dataChannelArray.size())
+		return m_sourceTimestamps.getUnchecked(m_channelSourceSlots.getUnchecked(channelNum));
+
 	int sourceNodeId = 0;
 	int subProcessorIdx = 0;
 	int64 ts = 0;
@@ -626,14 +762,7 @@ juce::uint64 GenericProcessor::getTimestamp(int channelNum) const
 	}
 
 	uint32 sourceID = getProcessorFullId(sourceNodeId, subProcessorIdx);
-	try
-	{
-		ts = timestamps.at(sourceID);
-	}
-	catch (...)
-	{
-		return 0;
-	}
+	ts = getSourceTimestamp(sourceID);
 
 	return ts;
 }
@@ -645,16 +774,12 @@ uint32 GenericProcessor::getNumSourceSamples(uint16 processorID, uint16 subProce
 
 uint32 GenericProcessor::getNumSourceSamples(uint32 fullSourceID) const
 {
-	uint32 nSamples;
-	try
-	{
-		nSamples = numSamples.at(fullSourceID);
-	}
-	catch (...)
-	{
-		return 0;
-	}
-	return nSamples;
+	const int slot = findSourceSlot(fullSourceID);
+	if (slot >= 0)
+		return m_sourceNumSamples.getUnchecked(slot);
+
+	std::map<uint32, uint32>::const_iterator it = numSamples.find(fullSourceID);
+	return it != numSamples.end() ? it->second : 0;
 }
 
 juce::uint64 GenericProcessor::getSourceTimestamp(uint16 processorID, uint16 subProcessorIdx) const
@@ -664,16 +789,12 @@ juce::uint64 GenericProcessor::getSourceTimestamp(uint16 processorID, uint16 sub
 
 juce::uint64 GenericProcessor::getSourceTimestamp(uint32 fullSourceID) const
 {
-	juce::uint64 ts;
-	try
-	{
-		ts = timestamps.at(fullSourceID);
-	}
-	catch (...)
-	{
-		return 0;
-	}
-	return ts;
+	const int slot = findSourceSlot(fullSourceID);
+	if (slot >= 0)
+		return m_sourceTimestamps.getUnchecked(slot);
+
+	std::map<uint32, juce::int64>::const_iterator it = timestamps.find(fullSourceID);
+	return it != timestamps.end() ? it->second : 0;
 }
 
 
@@ -684,17 +805,14 @@ void GenericProcessor::setTimestampAndSamples(juce::uint64 timestamp, uint32 nSa
 	MidiBuffer& eventBuffer = *m_currentMidiBuffer;
 	//std::cout << "Setting timestamp to " << timestamp << std:;endl;
 
-	HeapBlock<char> data;
-	size_t dataSize = SystemEvent::fillTimestampAndSamplesData(data, this, subProcessorIdx, timestamp, nSamples);
-
-
-	eventBuffer.addEvent(data, dataSize, 0);
+	// Sent every block, so write it straight into the buffer instead of a temporary block
+	SystemEvent::writeTimestampAndSamplesData(eventBuffer.reserveEvent(TIMESTAMP_AND_SAMPLES_SIZE, 0), this, subProcessorIdx, timestamp, nSamples);
+	m_eventGeneration++;
 
 	uint32 sourceID = getProcessorFullId(nodeId, subProcessorIdx);
 
-	//since the processor generating the timestamp won't get the event, add it to the map
-	timestamps[sourceID] = timestamp;
-	numSamples[sourceID] = nSamples;
+	//since the processor generating the timestamp won't get the event, add it to the table
+	storeSourceTimestamp(sourceID, timestamp, nSamples);
 
 	if (m_needsToSendTimestampMessages[subProcessorIdx] && nSamples > 0)
 	{
@@ -722,6 +840,9 @@ int GenericProcessor::processEventBuffer()
 
 	MidiBuffer& eventBuffer = *m_currentMidiBuffer;
 
+	// a new block: the event index is only built again if something asks for it
+	m_eventGeneration++;
+
 	if (eventBuffer.getNumEvents() > 0)
 	{
 		MidiBuffer::Iterator i(eventBuffer);
@@ -742,8 +863,7 @@ int GenericProcessor::processEventBuffer()
 
 				juce::uint64 timestamp = *reinterpret_cast<const juce::uint64*>(dataptr + 8);
 				uint32 nSamples = *reinterpret_cast<const uint32*>(dataptr + 16);
-				numSamples[sourceID] = nSamples;
-				timestamps[sourceID] = timestamp;
+				storeSourceTimestamp(sourceID, timestamp, nSamples);
 			}
 			//set the "recorded" bit on the first byte. This will go away when the probe system is implemented.
 			//doing a const cast is always a bad idea, but there's no better way to do this until whe change the event record system
@@ -756,50 +876,142 @@ int GenericProcessor::processEventBuffer()
 }
 
 
+void GenericProcessor::setEventClassesOfInterest(int eventClasses)
+{
+	m_eventClassesOfInterest = eventClasses;
+}
+
+void GenericProcessor::mergeDeferredEvents()
+{
+	if (m_deferredEvents.isEmpty())
+		return;
+
+	MidiBuffer& eventBuffer = *m_currentMidiBuffer;
+	m_eventGeneration++;
+	if (eventBuffer.isEmpty())
+	{
+		eventBuffer.swapWith(m_deferredEvents);
+		m_deferredEvents.clear();
+		return;
+	}
+
+	// Both lists are sorted, so merge them in one pass. At equal sample positions
+	// the events already in the buffer go first, as with MidiBuffer::addEvents()
+	m_mergedEvents.clear();
+	m_mergedEvents.ensureSize(eventBuffer.data.size() + m_deferredEvents.data.size());
+
+	MidiBuffer::Iterator existing(eventBuffer);
+	MidiBuffer::Iterator deferred(m_deferredEvents);
+	const uint8* existingData;
+	const uint8* deferredData;
+	int existingSize, deferredSize, existingPos, deferredPos;
+	bool hasExisting = existing.getNextEvent(existingData, existingSize, existingPos);
+	bool hasDeferred = deferred.getNextEvent(deferredData, deferredSize, deferredPos);
+
+	while (hasExisting || hasDeferred)
+	{
+		if (hasExisting && (!hasDeferred || existingPos <= deferredPos))
+		{
+			m_mergedEvents.appendEvent(existingData, existingSize, existingPos);
+			hasExisting = existing.getNextEvent(existingData, existingSize, existingPos);
+		}
+		else
+		{
+			m_mergedEvents.appendEvent(deferredData, deferredSize, deferredPos);
+			hasDeferred = deferred.getNextEvent(deferredData, deferredSize, deferredPos);
+		}
+	}
+
+	eventBuffer.swapWith(m_mergedEvents);
+	m_deferredEvents.clear();
+}
+
+void GenericProcessor::updateEventIndex()
+{
+	// handlers write to the deferred list, which is never indexed
+	jassert(m_currentMidiBuffer != &m_deferredEvents);
+
+	if (!m_eventIndex.isCurrent(m_eventGeneration))
+		m_eventIndex.build(*m_currentMidiBuffer, m_eventGeneration);
+}
+
+MidiBuffer* GenericProcessor::getEventTarget()
+{
+	if (rangeEventBuffer != nullptr)
+		return rangeEventBuffer;
+
+	// writing to the block's buffer moves the packets the event index refers to
+	if (m_currentMidiBuffer != &m_deferredEvents)
+		m_eventGeneration++;
+
+	return m_currentMidiBuffer;
+}
+
+const EventIndex& GenericProcessor::getEventIndex()
+{
+	if (m_currentMidiBuffer != &m_deferredEvents)
+		updateEventIndex();
+
+	return m_eventIndex;
+}
+
 int GenericProcessor::checkForEvents(bool checkForSpikes)
 {
 	if (m_currentMidiBuffer->getNumEvents() > 0)
 	{
 		//Since adding events to the buffer inside this loop could be dangerous, create a temporal event buffer
 		//so any call to addEvent will operate on it;
-		MidiBuffer temporalEventBuffer;
+		updateEventIndex();
+
+		//Adding events to the buffer while going through it could be dangerous, so anything the handlers
+		//add goes to a deferred list instead, merged back in a single pass once process() returns
 		MidiBuffer* originalEventBuffer = m_currentMidiBuffer;
-		m_currentMidiBuffer = &temporalEventBuffer;
+		m_currentMidiBuffer = &m_deferredEvents;
 		// int m = midiMessages.getNumEvents();
 		//std::cout << m << " events received by node " << getNodeId() << std::endl;
 
-		MidiBuffer::Iterator i(*originalEventBuffer);
-		MidiMessage message(0xf4);
+		const int wanted = m_eventClassesOfInterest & (checkForSpikes ? ALL_EVENT_CLASSES : ~SPIKE_EVENT_CLASS);
 
-		int samplePosition = 0;
-		i.setNextSamplePosition(samplePosition);
-
-		while (i.getNextEvent(message, samplePosition))
+		// The headers are already decoded, so only the events that are actually
+		// dispatched get a MidiMessage built for them
+		for (int n = 0; n < m_eventIndex.getNumEvents(); n++)
 		{
-			uint16 sourceId = EventBase::getSourceID(message);
-			uint16 subProc = EventBase::getSubProcessorIdx(message);
-			uint16 index = EventBase::getSourceIndex(message);
-			if (EventBase::getBaseType(message) == EventType::PROCESSOR_EVENT)
+			const EventType type = m_eventIndex.getBaseType(n);
+			const uint8 subType = m_eventIndex.getSubType(n);
+
+			int eventClass = 0;
+			if (type == EventType::PROCESSOR_EVENT)
+				eventClass = subType == EventChannel::TTL ? TTL_EVENT_CLASS
+					: subType == EventChannel::TEXT ? TEXT_EVENT_CLASS : BINARY_EVENT_CLASS;
+			else if (type == EventType::SYSTEM_EVENT && subType == SystemEventType::TIMESTAMP_SYNC_TEXT)
+				eventClass = SYNC_TEXT_EVENT_CLASS;
+			else if (type == EventType::SPIKE_EVENT)
+				eventClass = SPIKE_EVENT_CLASS;
+
+			if ((eventClass & wanted) == 0)
+				continue;
+
+			uint16 sourceId = m_eventIndex.getSourceID(n);
+			uint16 subProc = m_eventIndex.getSubProcessorIdx(n);
+			uint16 index = m_eventIndex.getSourceIndex(n);
+			if (type == EventType::PROCESSOR_EVENT)
 			{
 				int eventIndex = getEventChannelIndex(index, sourceId, subProc);
 				if (eventIndex >= 0)
-					handleEvent(eventChannelArray[eventIndex], message, samplePosition);
+					handleEvent(eventChannelArray[eventIndex], m_eventIndex.getMessage(n), m_eventIndex.getSamplePosition(n));
 			}
-			else if (EventBase::getBaseType(message) == EventType::SYSTEM_EVENT && SystemEvent::getSystemEventType(message) == SystemEventType::TIMESTAMP_SYNC_TEXT)
+			else if (type == EventType::SYSTEM_EVENT)
 			{
-				handleTimestampSyncTexts(message);
+				handleTimestampSyncTexts(m_eventIndex.getMessage(n));
 			}
-			else if (checkForSpikes && EventBase::getBaseType(message) == EventType::SPIKE_EVENT)
+			else
 			{
 				int spikeIndex = getSpikeChannelIndex(index, sourceId, subProc);
 				if (spikeIndex >= 0)
-					handleSpike(spikeChannelArray[index], message, samplePosition);
+					handleSpike(spikeChannelArray[spikeIndex], m_eventIndex.getMessage(n), m_eventIndex.getSamplePosition(n));
 			}
 		}
-		//Restore the original buffer pointer and, if some new event has been added here, copy it to the original buffer
 		m_currentMidiBuffer = originalEventBuffer;
-		if (temporalEventBuffer.getNumEvents() > 0)
-			m_currentMidiBuffer->addEvents(temporalEventBuffer, 0, -1, 0);
 
 		return 0;
 	}
@@ -814,10 +1026,59 @@ void GenericProcessor::addEvent(int channelIndex, const Event* event, int sample
 
 void GenericProcessor::addEvent(const EventChannel* channel, const Event* event, int sampleNum)
 {
-	size_t size = channel->getDataSize() + channel->getTotalEventMetaDataSize() + EVENT_BASE_SIZE;
-	HeapBlock<char> buffer(size);
-	event->serialize(buffer, size);
-	m_currentMidiBuffer->addEvent(buffer, size, sampleNum >= 0 ? sampleNum : 0);
+	// Batched binary events are shorter than the channel maximum, so the size comes from the event
+	size_t size = event->getSerializedSize();
+	MidiBuffer* target = getEventTarget();
+	event->serialize(target->reserveEvent(int(size), sampleNum >= 0 ? sampleNum : 0), size);
+}
+
+uint8* GenericProcessor::getEventScratch(size_t size)
+{
+	// sized by enableProcessor() with one block per range of the thread pool
+	jassert(rangeIndexOfThread >= 0 && rangeIndexOfThread < jmax(1, m_rangeEventBuffers.size()));
+	if (size > m_eventScratchStride || m_eventScratch == nullptr)
+	{
+		jassertfalse;
+		return nullptr;
+	}
+	return m_eventScratch + size_t(rangeIndexOfThread) * m_eventScratchStride;
+}
+
+uint8* GenericProcessor::commitEvent(const uint8* data, size_t size, int sampleNum)
+{
+	uint8* event = getEventTarget()->reserveEvent(int(size), sampleNum >= 0 ? sampleNum : 0);
+	if (event != nullptr)
+		memcpy(event, data, size);
+	return event;
+}
+
+// The events below are serialized into scratch first, so that one failing its checks
+// never leaves a half written packet in the event buffer
+
+void GenericProcessor::addTTLEvent(const EventChannel* channel, juce::int64 timestamp, const void* ttlWord, uint16 channelBit, int sampleNum)
+{
+	size_t size = channel->getDataSize() + EVENT_BASE_SIZE;
+	uint8* scratch = getEventScratch(size);
+	if (scratch != nullptr && TTLEvent::serializeTTL(scratch, size, channel, timestamp, ttlWord, channelBit))
+		commitEvent(scratch, size, sampleNum);
+}
+
+void GenericProcessor::addTextEvent(const EventChannel* channel, juce::int64 timestamp, const char* text, size_t numBytes, int sampleNum)
+{
+	size_t size = channel->getDataSize() + EVENT_BASE_SIZE;
+	uint8* scratch = getEventScratch(size);
+	if (scratch != nullptr && TextEvent::serializeText(scratch, size, channel, timestamp, text, numBytes))
+		commitEvent(scratch, size, sampleNum);
+}
+
+MetaDataEventWriter GenericProcessor::addBinaryEvent(const EventChannel* channel, juce::int64 timestamp, const void* data, size_t numBytes, int sampleNum)
+{
+	size_t size = EVENT_BASE_SIZE + channel->getDataSize() + channel->getTotalEventMetaDataSize();
+	uint8* scratch = getEventScratch(size);
+	if (scratch == nullptr || !BinaryEvent::serializeBinary(scratch, size, channel, timestamp, data, numBytes))
+		return MetaDataEventWriter(channel, nullptr);
+	uint8* event = commitEvent(scratch, size, sampleNum);
+	return MetaDataEventWriter(channel, event != nullptr ? BinaryEvent::getMetaDataPointer(event, channel) : nullptr);
 }
 
 void GenericProcessor::addSpike(int channelIndex, const SpikeEvent* event, int sampleNum)
@@ -827,21 +1088,100 @@ void GenericProcessor::addSpike(int channelIndex, const SpikeEvent* event, int s
 
 void GenericProcessor::addSpike(const SpikeChannel* channel, const SpikeEvent* event, int sampleNum)
 {
-	size_t size = channel->getDataSize() + channel->getTotalEventMetaDataSize() + SPIKE_BASE_SIZE + channel->getNumChannels()*sizeof(float);
-	HeapBlock<char> buffer(size);
-	event->serialize(buffer, size);
-	m_currentMidiBuffer->addEvent(buffer, size, sampleNum >= 0 ? sampleNum : 0);
+	size_t size = channel->getWaveformDataSize() + channel->getTotalEventMetaDataSize() + SPIKE_BASE_SIZE + channel->getNumChannels()*sizeof(float);
+	MidiBuffer* target = getEventTarget();
+	event->serialize(target->reserveEvent(int(size), sampleNum >= 0 ? sampleNum : 0), size);
+}
+
+void GenericProcessor::addSpike(const SpikeChannel* channel, juce::int64 timestamp, const float* thresholds, const float* waveforms, uint16 sortedID, int sampleNum)
+{
+	size_t size = channel->getWaveformDataSize() + SPIKE_BASE_SIZE + channel->getNumChannels()*sizeof(float);
+	uint8* scratch = getEventScratch(size);
+	if (scratch != nullptr && SpikeEvent::serializeSpike(scratch, size, channel, timestamp, thresholds, waveforms, sortedID))
+		commitEvent(scratch, size, sampleNum);
+}
+
+
+namespace
+{
+	class ParallelRangeJob : public ProcessorThreadPool::Job
+	{
+	public:
+		ParallelRangeJob(GenericProcessor::ParallelRangeTask& task, OwnedArray<MidiBuffer>& eventBuffers, int numItems, int numRanges)
+			: m_task(task), m_eventBuffers(eventBuffers), m_numItems(numItems), m_numRanges(numRanges)
+		{}
+
+		void runRange(int rangeIndex) override
+		{
+			MidiBuffer* previous = rangeEventBuffer;
+			const int previousIndex = rangeIndexOfThread;
+			rangeEventBuffer = m_eventBuffers[rangeIndex];
+			rangeIndexOfThread = rangeIndex;
+			m_task.run(m_numItems * rangeIndex / m_numRanges, m_numItems * (rangeIndex + 1) / m_numRanges);
+			rangeEventBuffer = previous;
+			rangeIndexOfThread = previousIndex;
+		}
+
+	private:
+		GenericProcessor::ParallelRangeTask& m_task;
+		OwnedArray<MidiBuffer>& m_eventBuffers;
+		const int m_numItems;
+		const int m_numRanges;
+	};
 }
 
+void GenericProcessor::runParallel(int numItems, ParallelRangeTask& task)
+{
+	ProcessorThreadPool* pool = ProcessorThreadPool::getInstanceWithoutCreating();
+	const int numRanges = jmin(numItems, m_rangeEventBuffers.size());
+
+	if (pool != nullptr && numRanges > 1)
+	{
+		for (int i = 0; i < numRanges; i++)
+			m_rangeEventBuffers[i]->clear();
+
+		ParallelRangeJob job(task, m_rangeEventBuffers, numItems, numRanges);
+		if (pool->run(job, numRanges))
+		{
+			// Ranges are contiguous and merged in order, and MidiBuffer keeps events at
+			// the same sample in insertion order, so this matches a serial loop
+			MidiBuffer& eventBuffer = *getEventTarget();
+			for (int i = 0; i < numRanges; i++)
+				eventBuffer.addEvents(*m_rangeEventBuffers[i], 0, -1, 0);
+			return;
+		}
+	}
+
+	// Pool busy or not worth splitting: do the work on this thread
+	task.run(0, numItems);
+}
+
+int GenericProcessor::getMaxParallelRanges() const
+{
+	return jmax(1, m_rangeEventBuffers.size());
+}
+
+int GenericProcessor::getParallelRangeIndex()
+{
+	return rangeIndexOfThread;
+}
 
 void GenericProcessor::processBlock(AudioSampleBuffer& buffer, MidiBuffer& eventBuffer)
 {
+	TraceRecorder::Scope trace(m_traceName);
+
 	m_currentMidiBuffer = &eventBuffer;
 	processEventBuffer(); // extract buffer sizes and timestamps,
 	// set flag on all TTL events to zero
 
+	if (m_statisticsSubscribers.load(std::memory_order_relaxed) > 0)
+		updateInputStatistics(buffer);
+
 	m_lastProcessTime = Time::getHighResolutionTicks();
 	process(buffer);
+	GlobalClock::publishBlock(this);
+	mergeDeferredEvents();
+	m_processTime.addSample(Time::getHighResolutionTicks() - m_lastProcessTime);
 
 }
 
@@ -885,30 +1225,28 @@ int GenericProcessor::getTotalConfigurationObjects() const
 	return configurationObjectArray.size();
 }
 
+int GenericProcessor::findChannelIndex(const ChannelIndexMap& map, uint32 sourceID, int channelIdx)
+{
+	// misses are common for events from other branches, so no exceptions here
+	ChannelIndexMap::const_iterator source = map.find(sourceID);
+	if (source == map.end())
+		return -1;
+	ChannelIndexes::const_iterator channel = source->second.find(channelIdx);
+	if (channel == source->second.end())
+		return -1;
+	return channel->second;
+}
+
 int GenericProcessor::getDataChannelIndex(int channelIdx, int processorID, int subProcessorIdx) const
 {
 	uint32 sourceID = getProcessorFullId(processorID, subProcessorIdx);
-	try
-	{
-		return dataChannelMap.at(sourceID).at(channelIdx);
-	}
-	catch (...)
-	{
-		return -1;
-	}
+	return findChannelIndex(dataChannelMap, sourceID, channelIdx);
 }
 
 int GenericProcessor::getEventChannelIndex(int channelIdx, int processorID, int subProcessorIdx) const
 {
 	uint32 sourceID = getProcessorFullId(processorID, subProcessorIdx);
-	try
-	{
-		return eventChannelMap.at(sourceID).at(channelIdx);
-	}
-	catch (...)
-	{
-		return -1;
-	}
+	return findChannelIndex(eventChannelMap, sourceID, channelIdx);
 }
 
 int GenericProcessor::getEventChannelIndex(const Event* event) const
@@ -919,14 +1257,7 @@ int GenericProcessor::getEventChannelIndex(const Event* event) const
 int GenericProcessor::getSpikeChannelIndex(int channelIdx, int processorID, int subProcessorIdx) const
 {
 	uint32 sourceID = getProcessorFullId(processorID, subProcessorIdx);
-	try
-	{
-		return spikeChannelMap.at(sourceID).at(channelIdx);
-	}
-	catch (...)
-	{
-		return -1;
-	}
+	return findChannelIndex(spikeChannelMap, sourceID, channelIdx);
 }
 
 int GenericProcessor::getSpikeChannelIndex(const SpikeEvent* event) const
@@ -1035,44 +1366,60 @@ void GenericProcessor::saveCustomChannelParametersToXml(XmlElement* channelInfo,
 
 void GenericProcessor::loadFromXml()
 {
+	setSettingsChanged();
 	update(); // make sure settings are updated
-	if (parametersAsXml != nullptr)
+	loadProcessorParametersFromXml();
+	loadChannelSettingsFromXml();
+}
+
+
+void GenericProcessor::loadProcessorParametersFromXml()
+{
+	if (parametersAsXml != nullptr && !m_isParamsWereLoaded)
 	{
-		if (!m_isParamsWereLoaded)
-		{
-			std::cout << "Loading parameters for " << m_name << std::endl;
+		std::cout << "Loading parameters for " << m_name << std::endl;
 
-			// use parametersAsXml to restore state
-			loadCustomParametersFromXml();
+		// use parametersAsXml to restore state
+		loadCustomParametersFromXml();
 
-			// load editor parameters
-			forEachXmlChildElement(*parametersAsXml, xmlNode)
+		// load editor parameters
+		forEachXmlChildElement(*parametersAsXml, xmlNode)
+		{
+			if (xmlNode->hasTagName("EDITOR"))
 			{
-				if (xmlNode->hasTagName("EDITOR"))
-				{
-					getEditor()->loadEditorParameters(xmlNode);
-				}
+				getEditor()->loadEditorParameters(xmlNode);
 			}
 		}
+	}
+
+	m_isParamsWereLoaded = true;
+}
+
+
+void GenericProcessor::loadChannelSettingsFromXml()
+{
+	if (parametersAsXml != nullptr)
+	{
+		Array<XmlElement*> dataChannels, eventChannels, spikeChannels;
 		forEachXmlChildElement(*parametersAsXml, xmlNode)
 		{
 			if (xmlNode->hasTagName("CHANNEL"))
 			{
-				loadChannelParametersFromXml(xmlNode, InfoObjectCommon::DATA_CHANNEL);
+				dataChannels.add(xmlNode);
 			}
 			else if (xmlNode->hasTagName("EVENTCHANNEL"))
 			{
-				loadChannelParametersFromXml(xmlNode, InfoObjectCommon::EVENT_CHANNEL);
+				eventChannels.add(xmlNode);
 			}
 			else if (xmlNode->hasTagName("SPIKECHANNEL"))
 			{
-				loadChannelParametersFromXml(xmlNode, InfoObjectCommon::SPIKE_CHANNEL);
+				spikeChannels.add(xmlNode);
 			}
 		}
-
+		loadAllChannelParametersFromXml(dataChannels, InfoObjectCommon::DATA_CHANNEL);
+		loadAllChannelParametersFromXml(eventChannels, InfoObjectCommon::EVENT_CHANNEL);
+		loadAllChannelParametersFromXml(spikeChannels, InfoObjectCommon::SPIKE_CHANNEL);
 	}
-
-	m_isParamsWereLoaded = true;
 }
 
 
@@ -1098,6 +1445,13 @@ void GenericProcessor::loadChannelParametersFromXml(XmlElement* channelInfo, Inf
 }
 
 
+void GenericProcessor::loadAllChannelParametersFromXml(const Array<XmlElement*>& channelElements, InfoObjectCommon::InfoObjectType type)
+{
+	for (int i = 0; i < channelElements.size(); ++i)
+		loadChannelParametersFromXml(channelElements[i], type);
+}
+
+
 void GenericProcessor::loadCustomParametersFromXml() { }
 void GenericProcessor::loadCustomChannelParametersFromXml(XmlElement* channelInfo, InfoObjectCommon::InfoObjectType type) { }
 
@@ -1155,8 +1509,13 @@ bool GenericProcessor::isParameterAutomatable(int parameterIndex) const { return
 bool GenericProcessor::isMetaParameter(int parameterIndex) const { return false; }
 
 bool GenericProcessor::canSendSignalTo(GenericProcessor*) const { return true; }
+bool GenericProcessor::readsContinuousData() const { return true; }
+bool GenericProcessor::modifiesContinuousData() const { return true; }
+bool GenericProcessor::readsEvents() const { return true; }
+bool GenericProcessor::emitsEvents() const { return true; }
 
 bool GenericProcessor::isReady()                { return isEnabled; }
+bool GenericProcessor::prepareForAcquisition()  { return true; }
 bool GenericProcessor::isEnabledState() const   { return isEnabled; }
 
 bool GenericProcessor::isGeneratesTimestamps() const { return false; }
@@ -1239,6 +1598,34 @@ void GenericProcessor::setEnabledState(bool t)
 bool GenericProcessor::enableProcessor()
 {
 	m_lastProcessTime = Time::getHighResolutionTicks();
+	m_processTime.reset();
+	m_inputStatistics.reset();
+
+	// Start the worker threads and size the range buffers here, on the message
+	// thread, so that parallelFor() never allocates inside process()
+	const int numRanges = ProcessorThreadPool::getInstance()->getNumWorkers() + 1;
+	while (m_rangeEventBuffers.size() < numRanges)
+	{
+		MidiBuffer* eventBuffer = new MidiBuffer();
+		eventBuffer->ensureSize(4096);
+		m_rangeEventBuffers.add(eventBuffer);
+	}
+
+	size_t maxEventSize = 0;
+	for (int i = 0; i < eventChannelArray.size(); i++)
+	{
+		const EventChannel* channel = eventChannelArray[i];
+		maxEventSize = jmax(maxEventSize, EVENT_BASE_SIZE + channel->getDataSize() + channel->getTotalEventMetaDataSize());
+	}
+	for (int i = 0; i < spikeChannelArray.size(); i++)
+	{
+		const SpikeChannel* channel = spikeChannelArray[i];
+		maxEventSize = jmax(maxEventSize, SPIKE_BASE_SIZE + channel->getWaveformDataSize() + channel->getTotalEventMetaDataSize()
+			+ channel->getNumChannels() * sizeof(float));
+	}
+	m_eventScratchStride = maxEventSize;
+	m_eventScratch.allocate(jmax(size_t(1), size_t(numRanges) * maxEventSize), true);
+
 	return enable();
 }
 
@@ -1292,6 +1679,47 @@ int64 GenericProcessor::getLastProcessedsoftwareTime() const
 	return m_lastProcessTime;
 }
 
+ProcessTimeStatistics::Summary GenericProcessor::getProcessTimeSummary() const
+{
+	return m_processTime.getSummary();
+}
+
+double GenericProcessor::getLastProcessTimeMs() const
+{
+	return m_processTime.getLastMs();
+}
+
+void GenericProcessor::subscribeToInputStatistics()
+{
+	m_statisticsSubscribers.fetch_add(1);
+}
+
+void GenericProcessor::unsubscribeFromInputStatistics()
+{
+	// an unbalanced call must not leave the count negative
+	jassert(m_statisticsSubscribers.load() > 0);
+	if (m_statisticsSubscribers.fetch_sub(1) <= 0)
+		m_statisticsSubscribers.fetch_add(1);
+}
+
+const ChannelStatistics& GenericProcessor::getInputStatistics() const
+{
+	return m_inputStatistics;
+}
+
+void GenericProcessor::getMemoryUsage(MemoryUsage& usage) const
+{
+	usage.add("Input statistics", m_inputStatistics.getMemorySize());
+}
+
+void GenericProcessor::updateInputStatistics(const AudioSampleBuffer& buffer)
+{
+	const int numChannels = jmin(m_inputStatistics.getNumChannels(), buffer.getNumChannels());
+	for (int c = 0; c < numChannels; c++)
+		m_inputStatistics.process(c, jmin(int(getNumSamples(c)), buffer.getNumSamples()), buffer.getReadPointer(c));
+	m_inputStatistics.publish();
+}
+
 void ChannelCreationIndexes::clearChannelCreationCounts()
 {
 	dataChannelCount = 0;
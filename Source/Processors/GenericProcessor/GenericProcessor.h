@@ -27,12 +27,17 @@
 #include <JuceHeader.h>
 #include "../Editors/GenericEditor.h"
 #include "../Parameter/Parameter.h"
+#include "../Parameter/ChannelParameterBlock.h"
 #include "../../CoreServices.h"
 #include "../PluginManager/PluginClass.h"
 #include "../../Processors/Dsp/LinearSmoothedValueAtomic.h"
 #include "../../Processors/PluginManager/PluginIDs.h"
 #include "../Channel/InfoObjects.h"
 #include "../Events/Events.h"
+#include "../Events/EventIndex.h"
+#include "ProcessTimeStatistics.h"
+#include "ChannelStatistics.h"
+#include "MemoryUsage.h"
 
 #include <time.h>
 #include <stdio.h>
@@ -231,6 +236,11 @@ public:
         streams. Rather than use the default JUCE processBlock() method, processBlock()
         automatically calls process() in order to add the 'nSamples' variable to indicate
         the number of samples in the current buffer.
+
+        Every channel of continuousBuffer starts on a LockedMemoryBlock::channelAlignment
+        byte boundary and is padded up to the next LockedMemoryBlock::getChannelStride()
+        samples, so aligned vector loads and stores may run past its last sample. Processors
+        that don't modify continuous data may read the padding but never write it.
     */
     virtual void process (AudioSampleBuffer& continuousBuffer) = 0;
 
@@ -334,9 +344,36 @@ public:
         when this is not possible.*/
     virtual bool canSendSignalTo (GenericProcessor*) const;
 
+    /** Returns true if process() looks at the continuous data (the default). Informative only:
+        the graph always passes the data on, since the processors after this one may need it.*/
+    virtual bool readsContinuousData() const;
+
+    /** Returns true if process() may write to the continuous data it is given (the default).
+
+        Processors that only read it (recorders, displays, outputs) can return false; the graph
+        then hands them the channels of their sources instead of a copy, so they must never
+        write to the buffer.*/
+    virtual bool modifiesContinuousData() const;
+
+    /** Returns true if the processor handles incoming events or spikes (the default). Informative
+        only: the timestamp events are always delivered, as every processor needs them.*/
+    virtual bool readsEvents() const;
+
+    /** Returns true if the processor may add events or spikes to the stream (the default).
+
+        A processor that neither modifies the continuous data nor emits events passes its inputs on
+        unchanged, so the processors after it are run from its sources, at the same time as it.*/
+    virtual bool emitsEvents() const;
+
     /** Returns true if a processor is ready to process data (e.g., all of its parameters are initialized, and its data source is connected).*/
     virtual bool isReady();
 
+    /** Called at the start of acquisition, before isReady(), on a worker thread and at the same time
+        as the other processors. Does the slow preparation that needs neither the message thread nor
+        other processors, such as device handshakes or buffer allocation. Returns false if acquisition
+        can't start.*/
+    virtual bool prepareForAcquisition();
+
 	bool enableProcessor();
 
     /** Called immediately prior to the start of data acquisition, once all processors in the signal chain have indicated they are ready to process data.*/
@@ -417,9 +454,18 @@ public:
     /** Resets the 'settings' struct to its default state.*/
     virtual void clearSettings();
 
-    /** Default method for updating settings, called by every processor.*/
+    /** Default method for updating settings, called by every processor.
+        Does nothing unless setSettingsChanged() was called or the settings of a
+        processor returned by getSettingsSources() were rebuilt since the last call.*/
     void update();
 
+    /** Makes the next update() rebuild the info objects of this processor, and so
+        those of every processor downstream of it.*/
+    void setSettingsChanged();
+
+    /** Incremented every time update() rebuilds the info objects of this processor.*/
+    uint32 getSettingsGeneration() const;
+
 	/** Toggles record ON for all channels */
     void setAllChannelsToRecord();
 
@@ -446,9 +492,18 @@ public:
     /** Saving custom settings for each channel. */
 	virtual void saveCustomChannelParametersToXml(XmlElement* channelElement, int channelNumber, InfoObjectCommon::InfoObjectType channelType);
 
-    /** Load generic settings from XML (called by all processors). */
+    /** Load generic settings from XML (called by all processors). Updates the settings of
+        the processor, then restores its own and its channels' parameters. */
     void loadFromXml();
 
+    /** Restores the custom parameters of the processor and its editor from parametersAsXml,
+        the first time it is called. The settings aren't updated; see ProcessorGraph::restoreParameters(). */
+    void loadProcessorParametersFromXml();
+
+    /** Restores the parameters of every channel from parametersAsXml. The channels have to be
+        up to date. */
+    void loadChannelSettingsFromXml();
+
     /** Load custom settings from XML*/
     virtual void loadCustomParametersFromXml();
 
@@ -458,6 +513,10 @@ public:
     /** Load custom parameters for each channel. */
 	virtual void loadCustomChannelParametersFromXml(XmlElement* channelElement, InfoObjectCommon::InfoObjectType channelType);
 
+	/** Load the parameters of all the channels of one type. Calls loadChannelParametersFromXml() for each
+	by default; processors whose per-channel setup is costly can override it to apply them in bulk. */
+	virtual void loadAllChannelParametersFromXml(const Array<XmlElement*>& channelElements, InfoObjectCommon::InfoObjectType channelType);
+
     /** Holds loaded parameters */
     XmlElement* parametersAsXml;
 
@@ -520,6 +579,28 @@ public:
 
 	juce::int64 getLastProcessedsoftwareTime() const;
 
+	/** Returns how long process() has been taking over the last blocks. Called from the message thread. */
+	ProcessTimeStatistics::Summary getProcessTimeSummary() const;
+
+	/** Returns how long the last call to process() took. Safe to call from the audio thread. */
+	double getLastProcessTimeMs() const;
+
+	/** While at least one subscription is held, every block of the input is added to
+	getInputStatistics() before process() sees it. Each call is balanced by one to
+	unsubscribeFromInputStatistics(). Safe to call while acquiring. */
+	void subscribeToInputStatistics();
+	void unsubscribeFromInputStatistics();
+
+	/** Running mean, RMS and noise level of every input data channel, which can be read
+	from any thread. Only kept up to date while subscribed to. */
+	const ChannelStatistics& getInputStatistics() const;
+
+	/** Adds the bytes held by the major buffers of the processor, to size the RAM of a rig
+	and to spot structures that keep growing during a session. Processors with buffers
+	that grow with the channel count or the session length override this, calling the
+	base class too. Called from the message thread, see MemoryUsage. */
+	virtual void getMemoryUsage(MemoryUsage& usage) const;
+
 	static uint32 getProcessorFullId(uint16 processorId, uint16 subprocessorIdx);
 
 	static uint16 getNodeIdFromFullId(uint32 fullId);
@@ -540,6 +621,14 @@ public:
 		String identifier;
 	};
 
+	/** Work handed to runParallel(), called once per contiguous range of items */
+	class PLUGIN_API ParallelRangeTask
+	{
+	public:
+		virtual ~ParallelRangeTask() {}
+		virtual void run(int firstItem, int lastItem) = 0;
+	};
+
 protected:
 	/** Used to set the timestamp for a given buffer, for a given source node. */
 	void setTimestampAndSamples(juce::uint64 timestamp, uint32 nSamples, int subProcessorIdx = 0);
@@ -548,6 +637,22 @@ protected:
 	Set respondToSpikes to true if the processor should also search for spikes*/
 	virtual int checkForEvents(bool respondToSpikes = false);
 
+	/** Event classes that checkForEvents() can pass to the handlers */
+	enum EventClass
+	{
+		TTL_EVENT_CLASS = 1 << 0,
+		TEXT_EVENT_CLASS = 1 << 1,
+		BINARY_EVENT_CLASS = 1 << 2,
+		SPIKE_EVENT_CLASS = 1 << 3,
+		SYNC_TEXT_EVENT_CLASS = 1 << 4,
+		ALL_EVENT_CLASSES = 0x1F
+	};
+
+	/** Restricts checkForEvents() to the given EventClass flags, so that handlers are only
+	called for the events the processor cares about. All classes are dispatched by default;
+	spikes are still only dispatched when checkForEvents(true) is called. */
+	void setEventClassesOfInterest(int eventClasses);
+
 	/** Makes it easier for processors to respond to incoming events, such as TTLs.
 
 	Called by checkForEvents(). */
@@ -561,6 +666,11 @@ protected:
 	/** Responds to TIMESTAMP_SYNC_TEXT system events, in case a processor needs to listen to them (useful for the record node) */
 	virtual void handleTimestampSyncTexts(const MidiMessage& event);
 
+	/** Returns the events in the current block's buffer, decoded. Can be used from process()
+	instead of checkForEvents() to go through events without building MidiMessages. The index
+	is built on first use and rebuilt after the processor adds events to the buffer. */
+	const EventIndex& getEventIndex();
+
 	/** Returns the default number of datachannels outputs for a specific type and a specific subprocessor
 	Called by createDataChannels(). It is not needed to implement if createDataChannels() is overriden */
 	virtual int getDefaultNumDataOutputs(DataChannel::DataChannelTypes type, int subProcessorIdx = 0) const;
@@ -580,9 +690,51 @@ protected:
 	void addEvent(int channelIndex, const Event* event, int sampleNum);
 	void addEvent(const EventChannel* channel, const Event* event, int sampleNum);
 
+	/** Adds a TTL event for a channel without metadata without building a TTLEvent first.
+	ttlWord must point to at least channel->getDataSize() bytes. */
+	void addTTLEvent(const EventChannel* channel, juce::int64 timestamp, const void* ttlWord, uint16 channelBit, int sampleNum);
+
+	/** Adds a text event for a channel without metadata from numBytes bytes of UTF-8 text,
+	without building a String or a TextEvent first. */
+	void addTextEvent(const EventChannel* channel, juce::int64 timestamp, const char* text, size_t numBytes, int sampleNum);
+
+	/** Adds an event for a non-batched binary channel from numBytes bytes of data, and returns a writer
+	to fill its metadata in place, without building a BinaryEvent or a MetaDataValueArray. */
+	MetaDataEventWriter addBinaryEvent(const EventChannel* channel, juce::int64 timestamp, const void* data, size_t numBytes, int sampleNum);
+
 	void addSpike(int channelIndex, const SpikeEvent* event, int sampleNum);
 	void addSpike(const SpikeChannel* channel, const SpikeEvent* event, int sampleNum);
 
+	/** Adds a spike for a channel without metadata from one threshold per channel and the waveforms,
+	channel after channel, without building a SpikeBuffer or a SpikeEvent first. */
+	void addSpike(const SpikeChannel* channel, juce::int64 timestamp, const float* thresholds, const float* waveforms, uint16 sortedID, int sampleNum);
+
+	/** Splits the items [0, numItems) into contiguous ranges that are processed
+	concurrently on the processor thread pool, calling fn(firstItem, lastItem) for
+	each range with lastItem exclusive. Returns once all ranges are done.
+
+	Meant to be called from process() for independent per-channel or per-electrode
+	work; fn must only touch state belonging to its own items. Events and spikes
+	added from fn are merged back in item order, so the resulting event buffer is
+	identical to the one a plain loop over the items would produce. */
+	template <typename RangeFunction>
+	void parallelFor(int numItems, RangeFunction fn)
+	{
+		RangeFunctionTask<RangeFunction> task(fn);
+		runParallel(numItems, task);
+	}
+
+	/** Non-template version of parallelFor() */
+	void runParallel(int numItems, ParallelRangeTask& task);
+
+	/** Most ranges parallelFor() splits its items into. Known once the processor has been
+	enabled, so scratch buffers for every range can be allocated in enable() */
+	int getMaxParallelRanges() const;
+
+	/** Index of the parallelFor() range running on the calling thread, below getMaxParallelRanges(),
+	to pick that range's scratch buffer. 0 when called outside parallelFor() */
+	static int getParallelRangeIndex();
+
 	/** Method to create the data channels pertaining to this processor, called automatically by update()*/
 	virtual void createDataChannels();
 
@@ -601,16 +753,49 @@ protected:
 	/** Custom method for updating settings, called automatically by update() after creating the info objects.*/
 	virtual void updateSettings();
 
+	/** Returns the processors the info objects of this one are copied from. Only the
+	sourceNode by default; processors with more than one input have to override this */
+	virtual Array<GenericProcessor*> getSettingsSources() const;
+
 	void updateChannelIndexes(bool updateNodeID = true);
 
 private:
+	/** Timestamps and sample counts of sources that no data channel comes from */
 	std::map<uint32, uint32> numSamples;
 	std::map<uint32, juce::int64> timestamps;
 
+	/** Dense table of the sources the data channels come from, rebuilt by updateChannelIndexes(),
+	so that getNumSamples() and getTimestamp() are plain array reads */
+	Array<uint32> m_sourceIds;
+	Array<uint32> m_sourceNumSamples;
+	Array<juce::uint64> m_sourceTimestamps;
+	Array<int> m_channelSourceSlots;
+
+	void updateSourceTable();
+	int findSourceSlot(uint32 fullSourceID) const;
+	void storeSourceTimestamp(uint32 fullSourceID, juce::uint64 timestamp, uint32 nSamples);
+
 	juce::int64 m_lastProcessTime;
 
+	ProcessTimeStatistics m_processTime;
+
+	void updateInputStatistics(const AudioSampleBuffer& buffer);
+
+	ChannelStatistics m_inputStatistics;
+	std::atomic<int> m_statisticsSubscribers;
+
+	/** Name of the processBlock() events in traces, see TraceRecorder */
+	const char* m_traceName;
+
 	void createDataChannelsByType(DataChannel::DataChannelTypes type);
 
+	/** Node id and settings generation of each of the getSettingsSources() */
+	Array<uint32> getSettingsSourceStamp() const;
+
+	bool m_settingsChanged;
+	uint32 m_settingsGeneration;
+	Array<uint32> m_settingsSourceStamp;
+
 	/** Each processor has a unique integer ID that can be used to identify it.*/
 	int nodeId;
 
@@ -621,6 +806,21 @@ private:
     /** Extracts sample counts and timestamps from the MidiBuffer. */
     int processEventBuffer ();
 
+	/** Indexes the current buffer if it changed since the index was last built */
+	void updateEventIndex();
+
+	/** Returns the buffer the add*() helpers write to, and invalidates the event index if
+	that is the block's buffer */
+	MidiBuffer* getEventTarget();
+
+	/** Returns the calling range's scratch block for serializing an event of the given size
+	before it is checked, or nullptr if the size is over the largest of this processor's channels */
+	uint8* getEventScratch(size_t size);
+
+	/** Copies an event serialized in the scratch block into the buffer the add*() helpers
+	write to, and returns where it went */
+	uint8* commitEvent(const uint8* data, size_t size, int sampleNum);
+
     /** The type of the processor. */
     PluginProcessorType m_processorType;
 
@@ -639,11 +839,42 @@ private:
 
 	MidiBuffer* m_currentMidiBuffer;
 
+	EventIndex m_eventIndex;
+	/** Bumped by every write to the current buffer, and at every block */
+	uint32 m_eventGeneration;
+
+	/** Events added by handlers during checkForEvents(), merged into the buffer after process() */
+	MidiBuffer m_deferredEvents;
+	MidiBuffer m_mergedEvents;
+	int m_eventClassesOfInterest;
+
+	/** Merges m_deferredEvents into the current buffer by sample position */
+	void mergeDeferredEvents();
+
+	/** One event buffer per range used by runParallel(), merged in order afterwards */
+	OwnedArray<MidiBuffer> m_rangeEventBuffers;
+
+	/** One block per range the add*() helpers serialize into, m_eventScratchStride bytes each,
+	sized by enableProcessor() for the largest event of this processor's channels */
+	HeapBlock<uint8> m_eventScratch;
+	size_t m_eventScratchStride;
+
+	template <typename RangeFunction>
+	class RangeFunctionTask : public ParallelRangeTask
+	{
+	public:
+		RangeFunctionTask(RangeFunction& fn) : m_fn(fn) {}
+		void run(int firstItem, int lastItem) override { m_fn(firstItem, lastItem); }
+	private:
+		RangeFunction& m_fn;
+	};
+
 	typedef std::map<uint16, int> ChannelIndexes;
 	typedef std::unordered_map<uint32, ChannelIndexes> ChannelIndexMap;
 	ChannelIndexMap dataChannelMap;
 	ChannelIndexMap eventChannelMap;
 	ChannelIndexMap spikeChannelMap;
+	static int findChannelIndex(const ChannelIndexMap& map, uint32 sourceID, int channelIdx);
 
 	
 
@@ -0,0 +1,154 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "GlobalClock.h"
+#include "GenericProcessor.h"
+#include <limits>
+
+namespace
+{
+	// fraction bits of Snapshot::samplesPerTick
+	const int fractionBits = 32;
+
+	std::atomic<bool> running{ false };
+	std::atomic<int64> softwareStart{ 0 };
+	int sourceSubIdx = 0;
+	double speed = 1.0;
+
+	// the published snapshot, behind a sequence counter that is odd while it is written
+	std::atomic<uint32> sequence{ 0 };
+	std::atomic<int64> blockStartTicks{ 0 };
+	std::atomic<int64> blockEndTicks{ 0 };
+	std::atomic<int64> blockTimestamp{ 0 };
+	std::atomic<int64> numSamples{ 0 };
+	std::atomic<int64> samplesPerTick{ 0 };
+	std::atomic<float> sampleRate{ 0 };
+
+	void publish(int64 startTicks, int64 timestamp, int64 samples, float rate)
+	{
+		const int64 perTick = int64(rate * speed / Time::getHighResolutionTicksPerSecond() * double(int64(1) << fractionBits) + 0.5);
+
+		// past the end tick the timestamp holds, so the multiply never sees more than a block of ticks.
+		// Unpaced, the timestamps don't move between blocks at all
+		int64 endTicks = std::numeric_limits<int64>::max();
+		if (perTick > 0)
+			endTicks = startTicks + ((samples << fractionBits) + perTick - 1) / perTick;
+
+		sequence.fetch_add(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		blockStartTicks.store(startTicks, std::memory_order_relaxed);
+		blockEndTicks.store(endTicks, std::memory_order_relaxed);
+		blockTimestamp.store(timestamp, std::memory_order_relaxed);
+		numSamples.store(samples, std::memory_order_relaxed);
+		samplesPerTick.store(perTick, std::memory_order_relaxed);
+		sampleRate.store(rate, std::memory_order_relaxed);
+		sequence.fetch_add(1, std::memory_order_release);
+	}
+}
+
+std::atomic<const GenericProcessor*> GlobalClock::s_source{ nullptr };
+
+void GlobalClock::start(const GenericProcessor* source, int subProcessorIdx, double playbackSpeed)
+{
+	// nothing is published by the source while it is changed
+	s_source.store(nullptr);
+	sourceSubIdx = subProcessorIdx;
+	speed = playbackSpeed;
+
+	if (source != nullptr)
+		publish(Time::getHighResolutionTicks(), int64(source->getSourceTimestamp(source->getNodeId(), subProcessorIdx)),
+			0, source->getSampleRate(subProcessorIdx));
+	else
+		publish(0, 0, 0, 0);
+
+	softwareStart.store(Time::getHighResolutionTicks());
+	s_source.store(source);
+	running.store(true);
+}
+
+void GlobalClock::stop()
+{
+	running.store(false);
+	s_source.store(nullptr);
+}
+
+bool GlobalClock::isRunning()
+{
+	return running.load(std::memory_order_relaxed);
+}
+
+void GlobalClock::publishSourceBlock(const GenericProcessor* processor)
+{
+	const uint16 nodeId = processor->getNodeId();
+	publish(processor->getLastProcessedsoftwareTime(),
+		int64(processor->getSourceTimestamp(nodeId, sourceSubIdx)),
+		processor->getNumSourceSamples(nodeId, sourceSubIdx),
+		processor->getSampleRate(sourceSubIdx));
+}
+
+GlobalClock::Snapshot GlobalClock::getSnapshot()
+{
+	Snapshot snapshot;
+
+	// retried if the source published while the values were copied
+	for (;;)
+	{
+		const uint32 before = sequence.load(std::memory_order_acquire);
+		if ((before & 1) == 0)
+		{
+			snapshot.blockStartTicks = blockStartTicks.load(std::memory_order_relaxed);
+			snapshot.blockEndTicks = blockEndTicks.load(std::memory_order_relaxed);
+			snapshot.blockTimestamp = blockTimestamp.load(std::memory_order_relaxed);
+			snapshot.numSamples = numSamples.load(std::memory_order_relaxed);
+			snapshot.samplesPerTick = samplesPerTick.load(std::memory_order_relaxed);
+			snapshot.sampleRate = sampleRate.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (sequence.load(std::memory_order_relaxed) == before)
+				return snapshot;
+		}
+		Thread::yield();
+	}
+}
+
+int64 GlobalClock::getTimestamp(const Snapshot& snapshot, int64 ticks)
+{
+	if (ticks <= snapshot.blockStartTicks)
+		return snapshot.blockTimestamp;
+	if (ticks >= snapshot.blockEndTicks)
+		return snapshot.blockTimestamp + snapshot.numSamples;
+
+	return snapshot.blockTimestamp + (((ticks - snapshot.blockStartTicks) * snapshot.samplesPerTick) >> fractionBits);
+}
+
+int64 GlobalClock::getTimestamp()
+{
+	if (s_source.load(std::memory_order_relaxed) == nullptr)
+		return getSoftwareTimestamp();
+
+	return getTimestamp(getSnapshot(), Time::getHighResolutionTicks());
+}
+
+int64 GlobalClock::getSoftwareTimestamp()
+{
+	return Time::getHighResolutionTicks() - softwareStart.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,103 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GLOBALCLOCK_H_INCLUDED
+#define GLOBALCLOCK_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "../PluginManager/OpenEphysPlugin.h"
+#include <atomic>
+
+class GenericProcessor;
+
+/**
+	The clock behind CoreServices::getGlobalTimestamp() and getSoftwareTimestamp().
+
+	Every time the global timestamp source finishes a block, it publishes the
+	high resolution tick its block started at, the timestamp of its first sample,
+	the number of samples and the sample rate, behind a sequence counter. Any
+	thread then gets a timestamp from the last such snapshot with one multiply,
+	instead of converting ticks through seconds and asking the source for its
+	sample rate and timestamp every call.
+
+	Timestamps run on from the start of the source's block at its sample rate
+	times the playback speed, and stop at the end of the block until the next
+	one is published. As long as the source's blocks follow each other, they
+	therefore never go backwards, whichever thread reads them.
+
+	@see CoreServices, ProcessorGraph
+*/
+class PLUGIN_API GlobalClock
+{
+public:
+	struct Snapshot
+	{
+		/** High resolution tick the source started its block at */
+		int64 blockStartTicks{ 0 };
+		/** Tick the block ends at, from which the timestamp holds */
+		int64 blockEndTicks{ 0 };
+		/** Timestamp of the first sample of the block */
+		int64 blockTimestamp{ 0 };
+		/** Samples of the block, the timestamps go no further than its end */
+		int64 numSamples{ 0 };
+		/** Samples per tick, as a 32.32 fixed point fraction */
+		int64 samplesPerTick{ 0 };
+		float sampleRate{ 0 };
+	};
+
+	/** Sets the source of the global timestamps, or none to use the software clock,
+	and restarts the software clock. Called by the ProcessorGraph when acquisition starts */
+	static void start(const GenericProcessor* source, int subProcessorIdx, double playbackSpeed);
+
+	/** Called by the ProcessorGraph when acquisition stops */
+	static void stop();
+
+	/** Whether acquisition is running. Outside of it, ProcessorGraph::getGlobalTimestamp()
+	works the timestamps out from the source directly */
+	static bool isRunning();
+
+	/** Publishes the block just processed when the processor is the global timestamp
+	source. Called by every processor after process(), from the thread that ran it */
+	static void publishBlock(const GenericProcessor* processor)
+	{
+		if (processor == s_source.load(std::memory_order_relaxed))
+			publishSourceBlock(processor);
+	}
+
+	/** Timestamp of the global source, or software ticks when there is none. Any thread */
+	static int64 getTimestamp();
+
+	/** High resolution ticks since acquisition started. Any thread */
+	static int64 getSoftwareTimestamp();
+
+	/** The last block published. Any thread */
+	static Snapshot getSnapshot();
+
+private:
+	static void publishSourceBlock(const GenericProcessor* processor);
+	static int64 getTimestamp(const Snapshot& snapshot, int64 ticks);
+
+	static std::atomic<const GenericProcessor*> s_source;
+};
+
+#endif  // GLOBALCLOCK_H_INCLUDED
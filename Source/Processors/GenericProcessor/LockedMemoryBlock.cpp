@@ -0,0 +1,210 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "LockedMemoryBlock.h"
+#include "ThreadPolicy.h"
+#include <atomic>
+
+#if JUCE_WINDOWS
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// Blocks smaller than a huge page stay on normal pages
+	const size_t HUGE_PAGE_BYTES = 2 * 1024 * 1024;
+
+	std::atomic<bool> reportedLockFailure(false);
+
+	size_t roundUp(size_t size, size_t multiple)
+	{
+		return (size + multiple - 1) / multiple * multiple;
+	}
+
+	void reportLockFailure()
+	{
+		if (reportedLockFailure.exchange(true))
+			return;
+#if JUCE_WINDOWS
+		std::cout << "Could not lock buffers in RAM, the working set of the process is too small" << std::endl;
+#else
+		std::cout << "Could not lock buffers in RAM, raise the memlock limit (ulimit -l) of the user" << std::endl;
+#endif
+	}
+}
+
+LockedMemoryBlock::LockedMemoryBlock()
+	: m_data(nullptr),
+	m_size(0),
+	m_mapped(false),
+	m_locked(false),
+	m_largePages(false),
+	m_numChannels(0),
+	m_channelStride(0)
+{
+}
+
+LockedMemoryBlock::~LockedMemoryBlock()
+{
+	free();
+}
+
+void* LockedMemoryBlock::allocate(size_t numBytes)
+{
+	free();
+
+	if (numBytes == 0)
+		return nullptr;
+
+	if (!ThreadPolicy::getUseLockedMemory())
+		return allocateFromHeap(numBytes);
+
+#if JUCE_WINDOWS
+	const size_t largePage = GetLargePageMinimum();
+	if (largePage > 0 && numBytes >= largePage)
+	{
+		// needs the "Lock pages in memory" privilege; large pages are never paged out
+		m_size = roundUp(numBytes, largePage);
+		m_data = VirtualAlloc(nullptr, m_size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		m_largePages = m_locked = m_data != nullptr;
+	}
+	if (m_data == nullptr)
+	{
+		m_size = numBytes;
+		m_data = VirtualAlloc(nullptr, m_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		if (m_data == nullptr)
+			return allocateFromHeap(numBytes);
+		m_locked = VirtualLock(m_data, m_size) != 0;
+	}
+#else
+	if (numBytes >= HUGE_PAGE_BYTES)
+	{
+		m_size = roundUp(numBytes, HUGE_PAGE_BYTES);
+#ifdef MAP_HUGETLB
+		// only succeeds if huge pages were reserved, see /proc/sys/vm/nr_hugepages
+		m_data = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (m_data == MAP_FAILED)
+			m_data = nullptr;
+		m_largePages = m_data != nullptr;
+#endif
+	}
+	if (m_data == nullptr)
+	{
+		m_size = roundUp(numBytes, size_t(sysconf(_SC_PAGESIZE)));
+		m_data = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (m_data == MAP_FAILED)
+		{
+			m_data = nullptr;
+			return allocateFromHeap(numBytes);
+		}
+#ifdef MADV_HUGEPAGE
+		// falls back on transparent huge pages
+		if (m_size >= HUGE_PAGE_BYTES)
+			m_largePages = madvise(m_data, m_size, MADV_HUGEPAGE) == 0;
+#endif
+	}
+	m_locked = mlock(m_data, m_size) == 0;
+#endif
+
+	m_mapped = true;
+	if (!m_locked)
+		reportLockFailure();
+
+	// fault every page in now rather than on first use by a real-time thread
+	zeromem(m_data, m_size);
+	return m_data;
+}
+
+void* LockedMemoryBlock::allocateFromHeap(size_t numBytes)
+{
+	m_heap.malloc(numBytes);
+	m_data = m_heap.getData();
+	m_size = numBytes;
+
+	// touched here, so the pages belong to the NUMA node of the calling thread
+	zeromem(m_data, m_size);
+	return m_data;
+}
+
+void LockedMemoryBlock::allocateAudioBuffer(AudioSampleBuffer& buffer, int numChannels, int numSamples)
+{
+	numChannels = jmax(numChannels, 0);
+	numSamples = jmax(numSamples, 0);
+	const size_t samplesPerChannel = size_t(getChannelStride(numSamples));
+
+	// mapped blocks start on a page, heap ones only as aligned as malloc makes them
+	char* block = (char*)allocate(samplesPerChannel * size_t(numChannels) * sizeof(float) + channelAlignment);
+	float* data = (float*)((pointer_sized_uint(block) + channelAlignment - 1) & ~pointer_sized_uint(channelAlignment - 1));
+
+	m_channels.malloc(jmax(1, numChannels));
+	for (int i = 0; i < numChannels; i++)
+		m_channels[i] = data + samplesPerChannel * i;
+	m_numChannels = numChannels;
+	m_channelStride = int(samplesPerChannel);
+
+	buffer.setDataToReferTo(m_channels, numChannels, numSamples);
+	buffer.clear();
+}
+
+void LockedMemoryBlock::resizeAudioBuffer(AudioSampleBuffer& buffer, int numSamples)
+{
+	if (numSamples > m_channelStride || m_data == nullptr)
+		allocateAudioBuffer(buffer, m_numChannels, numSamples);
+	else if (numSamples != buffer.getNumSamples())
+		buffer.setDataToReferTo(m_channels, m_numChannels, jmax(numSamples, 0));
+}
+
+int LockedMemoryBlock::getChannelStride(int numSamples)
+{
+	// at least numSamples, rounded up to whole aligned vectors
+	return (jmax(numSamples, 1) + alignedSamples - 1) / alignedSamples * alignedSamples;
+}
+
+void LockedMemoryBlock::free()
+{
+	if (m_mapped)
+	{
+#if JUCE_WINDOWS
+		VirtualFree(m_data, 0, MEM_RELEASE);
+#else
+		if (m_locked)
+			munlock(m_data, m_size);
+		munmap(m_data, m_size);
+#endif
+	}
+	m_heap.free();
+
+	m_data = nullptr;
+	m_size = 0;
+	m_mapped = false;
+	m_locked = false;
+	m_largePages = false;
+	m_numChannels = 0;
+	m_channelStride = 0;
+}
@@ -0,0 +1,106 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef LOCKEDMEMORYBLOCK_H_INCLUDED
+#define LOCKEDMEMORYBLOCK_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "../PluginManager/OpenEphysPlugin.h"
+
+/**
+	Zeroed memory for the large buffers shared with real-time threads.
+
+	When ThreadPolicy::getUseLockedMemory() is set, blocks of a few MB or more
+	are backed by huge pages (large pages on Windows) where the OS has them,
+	and every block is locked in RAM and touched when it is allocated. The
+	real-time threads then never take a page fault or wait for a swapped out
+	page. Otherwise, and whenever the OS refuses, the memory comes from the
+	heap as usual.
+
+	Blocks are allocated from the message thread when the signal chain is
+	updated, before acquisition starts.
+
+	The audio buffers laid out by allocateAudioBuffer() follow the contract the
+	graph, DataBuffer and DataQueue buffers give to processors: every channel
+	starts on a channelAlignment byte boundary, and its stride is a whole number
+	of alignedSamples samples. The samples between the end of a channel and the
+	start of the next are padding, so SIMD code may run its last vector past the
+	end of the channel instead of handling a scalar tail.
+
+	@see DataBuffer, DataQueue, ThreadPolicy
+*/
+class PLUGIN_API LockedMemoryBlock
+{
+public:
+	LockedMemoryBlock();
+	~LockedMemoryBlock();
+
+	/** Replaces the block with numBytes of zeroed memory */
+	void* allocate(size_t numBytes);
+
+	/** Sizes a buffer and points its channels into this block, which then
+	holds its samples. The buffer must not be resized other than through this
+	method or resizeAudioBuffer() afterwards. The samples are cleared. */
+	void allocateAudioBuffer(AudioSampleBuffer& buffer, int numChannels, int numSamples);
+
+	/** Changes the number of samples of the buffer given to allocateAudioBuffer(),
+	keeping its channels where they are. Only allocates, clearing the samples,
+	if the buffer was laid out for fewer samples. */
+	void resizeAudioBuffer(AudioSampleBuffer& buffer, int numSamples);
+
+	/** Number of samples between the starts of two channels of a buffer of numSamples */
+	static int getChannelStride(int numSamples);
+
+	static const int channelAlignment = 64;
+	static const int alignedSamples = channelAlignment / sizeof(float);
+
+	void free();
+
+	void* getData() const { return m_data; }
+
+	/** Bytes taken by the block, rounded up to whole pages when it was mapped */
+	size_t getSize() const { return m_size; }
+
+	/** True if the block is locked in RAM */
+	bool isLocked() const { return m_locked; }
+
+	/** True if the block is backed by huge or large pages */
+	bool usesLargePages() const { return m_largePages; }
+
+private:
+	void* allocateFromHeap(size_t numBytes);
+
+	void* m_data;
+	size_t m_size;
+	bool m_mapped;
+	bool m_locked;
+	bool m_largePages;
+	HeapBlock<char> m_heap;
+	HeapBlock<float*> m_channels;
+	int m_numChannels;
+	int m_channelStride;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LockedMemoryBlock);
+};
+
+#endif  // LOCKEDMEMORYBLOCK_H_INCLUDED
@@ -0,0 +1,104 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "MemoryUsage.h"
+
+MemoryUsage::MemoryUsage()
+{
+}
+
+void MemoryUsage::add(const String& name, int64 numBytes)
+{
+	if (numBytes <= 0)
+		return;
+
+	for (int i = 0; i < m_entries.size(); i++)
+	{
+		if (m_entries.getReference(i).name == name)
+		{
+			m_entries.getReference(i).bytes += numBytes;
+			return;
+		}
+	}
+
+	Entry entry;
+	entry.name = name;
+	entry.bytes = numBytes;
+	m_entries.add(entry);
+}
+
+void MemoryUsage::add(const String& prefix, const MemoryUsage& other)
+{
+	for (int i = 0; i < other.m_entries.size(); i++)
+		add(prefix + ": " + other.m_entries.getReference(i).name, other.m_entries.getReference(i).bytes);
+}
+
+int MemoryUsage::getNumEntries() const
+{
+	return m_entries.size();
+}
+
+String MemoryUsage::getName(int index) const
+{
+	return isPositiveAndBelow(index, m_entries.size()) ? m_entries.getReference(index).name : String();
+}
+
+int64 MemoryUsage::getBytes(int index) const
+{
+	return isPositiveAndBelow(index, m_entries.size()) ? m_entries.getReference(index).bytes : 0;
+}
+
+int64 MemoryUsage::getTotalBytes() const
+{
+	int64 total = 0;
+	for (int i = 0; i < m_entries.size(); i++)
+		total += m_entries.getReference(i).bytes;
+	return total;
+}
+
+String MemoryUsage::getDescription() const
+{
+	Array<Entry> sorted(m_entries);
+	std::sort(sorted.begin(), sorted.end(), [](const Entry& a, const Entry& b) { return a.bytes > b.bytes; });
+
+	StringArray lines;
+	for (int i = 0; i < sorted.size(); i++)
+		lines.add(sorted.getReference(i).name + ": " + formatBytes(sorted.getReference(i).bytes));
+	return lines.joinIntoString("\n");
+}
+
+String MemoryUsage::formatBytes(int64 numBytes)
+{
+	if (numBytes < 1024)
+		return String(numBytes) + " B";
+	if (numBytes < 1024 * 1024)
+		return String(numBytes / 1024.0, 1) + " kB";
+	if (numBytes < int64(1024) * 1024 * 1024)
+		return String(numBytes / (1024.0 * 1024.0), 1) + " MB";
+	return String(numBytes / (1024.0 * 1024.0 * 1024.0), 2) + " GB";
+}
+
+int64 MemoryUsage::getBytes(const AudioSampleBuffer& buffer)
+{
+	return int64(buffer.getNumChannels()) * buffer.getNumSamples() * sizeof(float);
+}
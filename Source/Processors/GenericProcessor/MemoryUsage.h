@@ -0,0 +1,80 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef MEMORYUSAGE_H_INCLUDED
+#define MEMORYUSAGE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "../PluginManager/OpenEphysPlugin.h"
+
+/**
+	The bytes held by the major structures of a processor, DataThread or
+	RecordEngine, one entry per structure.
+
+	Filled by their getMemoryUsage() from the message thread, which reads the
+	sizes of buffers the real-time threads may be working in. Only the sizes are
+	read, so an entry can lag behind a buffer being resized, which is fine for
+	display. Small members and the memory of JUCE objects are not counted; the
+	entries are meant to show what grows with the channel count and the length
+	of a session.
+
+	@see GenericProcessor::getMemoryUsage(), DataThread, RecordEngine
+*/
+class PLUGIN_API MemoryUsage
+{
+public:
+	MemoryUsage();
+
+	/** Adds the bytes of a structure. Entries with the same name are summed */
+	void add(const String& name, int64 numBytes);
+
+	/** Adds every entry of another usage, with its name prefixed */
+	void add(const String& prefix, const MemoryUsage& other);
+
+	int getNumEntries() const;
+	String getName(int index) const;
+	int64 getBytes(int index) const;
+
+	int64 getTotalBytes() const;
+
+	/** One line per entry, largest first */
+	String getDescription() const;
+
+	/** "512 B", "12.3 kB", "4.5 MB" or "1.25 GB" */
+	static String formatBytes(int64 numBytes);
+
+	/** Bytes of the samples of a buffer that owns them. For one laid out in a
+	LockedMemoryBlock, add the size of the block instead */
+	static int64 getBytes(const AudioSampleBuffer& buffer);
+
+private:
+	struct Entry
+	{
+		String name;
+		int64 bytes;
+	};
+
+	Array<Entry> m_entries;
+};
+
+#endif  // MEMORYUSAGE_H_INCLUDED
@@ -0,0 +1,76 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ProcessTimeStatistics.h"
+#include <algorithm>
+
+ProcessTimeStatistics::ProcessTimeStatistics()
+{
+	reset();
+}
+
+void ProcessTimeStatistics::reset()
+{
+	FloatVectorOperations::clear(m_durationsMs, windowSize);
+	m_numBlocks = 0;
+}
+
+void ProcessTimeStatistics::addSample(int64 ticks)
+{
+	const int64 n = m_numBlocks.load(std::memory_order_relaxed);
+	m_durationsMs[n % windowSize] = float(Time::highResolutionTicksToSeconds(ticks) * 1000.0);
+	m_numBlocks.store(n + 1, std::memory_order_release);
+}
+
+double ProcessTimeStatistics::getLastMs() const
+{
+	const int64 n = m_numBlocks.load(std::memory_order_acquire);
+	return n > 0 ? m_durationsMs[(n - 1) % windowSize] : 0;
+}
+
+ProcessTimeStatistics::Summary ProcessTimeStatistics::getSummary() const
+{
+	Summary summary;
+	summary.numBlocks = m_numBlocks.load(std::memory_order_acquire);
+	if (summary.numBlocks == 0)
+		return summary;
+
+	const int count = int(jmin<int64>(summary.numBlocks, windowSize));
+	std::vector<float> window(m_durationsMs, m_durationsMs + count);
+
+	summary.lastMs = m_durationsMs[(summary.numBlocks - 1) % windowSize];
+
+	double total = 0;
+	for (float d : window)
+	{
+		total += d;
+		summary.maxMs = jmax<double>(summary.maxMs, d);
+	}
+	summary.meanMs = total / count;
+
+	const int p99Index = jmin(count - 1, int(count * 0.99));
+	std::nth_element(window.begin(), window.begin() + p99Index, window.end());
+	summary.p99Ms = window[p99Index];
+
+	return summary;
+}
@@ -0,0 +1,75 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef PROCESSTIMESTATISTICS_H_INCLUDED
+#define PROCESSTIMESTATISTICS_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "../PluginManager/OpenEphysPlugin.h"
+#include <atomic>
+
+/**
+	Keeps the durations of the most recent processing calls of a processor or of
+	the whole graph callback.
+
+	addSample() is lock free and meant for the audio thread. getSummary() copies
+	the window and should only be called from the message thread; a summary taken
+	while blocks are being added may mix in a measurement from the current block,
+	which is fine for display.
+
+	@see GenericProcessor, ProcessorGraph
+*/
+class PLUGIN_API ProcessTimeStatistics
+{
+public:
+	struct Summary
+	{
+		double meanMs{ 0 };
+		double maxMs{ 0 };
+		double p99Ms{ 0 };
+		double lastMs{ 0 };
+		/** Blocks measured since the last reset, not limited to the window */
+		int64 numBlocks{ 0 };
+	};
+
+	ProcessTimeStatistics();
+
+	/** Adds the duration of one call, in high resolution ticks */
+	void addSample(int64 ticks);
+
+	void reset();
+
+	/** Statistics over the last windowSize calls */
+	Summary getSummary() const;
+
+	/** Duration of the most recent call. Lock free, so it can be read from the audio thread. */
+	double getLastMs() const;
+
+	static const int windowSize = 512;
+
+private:
+	float m_durationsMs[windowSize];
+	std::atomic<int64> m_numBlocks;
+};
+
+#endif  // PROCESSTIMESTATISTICS_H_INCLUDED
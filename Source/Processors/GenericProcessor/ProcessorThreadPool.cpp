@@ -0,0 +1,143 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ProcessorThreadPool.h"
+#include "ThreadPolicy.h"
+
+class ProcessorThreadPool::Worker : public Thread
+{
+public:
+	Worker(ProcessorThreadPool& owner, int index)
+		: Thread("Processor worker " + String(index)), m_owner(owner)
+	{}
+
+	~Worker()
+	{
+		signalThreadShouldExit();
+		m_work.signal();
+		stopThread(1000);
+	}
+
+	void wake()
+	{
+		m_work.signal();
+	}
+
+	void run() override
+	{
+		ThreadPolicy::applyToCurrentThread(ThreadPolicy::Compute);
+		while (!threadShouldExit())
+		{
+			if (!m_work.wait(100))
+				continue;
+			m_owner.runRanges();
+		}
+	}
+
+private:
+	ProcessorThreadPool& m_owner;
+	WaitableEvent m_work;
+};
+
+juce_ImplementSingleton(ProcessorThreadPool);
+
+ProcessorThreadPool::ProcessorThreadPool()
+	: m_numRanges(0)
+{
+	m_inUse = false;
+	m_job = nullptr;
+	m_nextRange = 0;
+	m_completedRanges = 0;
+	m_busyWorkers = 0;
+
+	// Leave room for the audio thread and for the graph's own render threads
+	const int numWorkers = jlimit(0, 7, SystemStats::getNumCpus() / 2 - 1);
+	for (int i = 0; i < numWorkers; i++)
+	{
+		Worker* worker = new Worker(*this, i);
+		m_workers.add(worker);
+		worker->startThread(9);
+	}
+}
+
+ProcessorThreadPool::~ProcessorThreadPool()
+{
+	m_workers.clear();
+	clearSingletonInstance();
+}
+
+int ProcessorThreadPool::getNumWorkers() const
+{
+	return m_workers.size();
+}
+
+bool ProcessorThreadPool::run(Job& job, int numRanges)
+{
+	bool expected = false;
+	if (m_workers.size() == 0 || !m_inUse.compare_exchange_strong(expected, true))
+		return false;
+
+	// Counters are reset before the job is published, so a worker woken late by
+	// the previous job can never see a stale range index
+	m_numRanges = numRanges;
+	m_completedRanges = 0;
+	m_nextRange = 0;
+	m_job = &job;
+
+	const int numToWake = jmin(m_workers.size(), numRanges - 1);
+	for (int i = 0; i < numToWake; i++)
+		m_workers[i]->wake();
+
+	runRanges();
+
+	while (m_completedRanges.load() < numRanges)
+		Thread::yield();
+
+	// A worker may have picked up the job pointer without finding a range left;
+	// wait for it to let go before the job goes out of scope
+	m_job = nullptr;
+	while (m_busyWorkers.load() > 0)
+		Thread::yield();
+
+	m_inUse = false;
+	return true;
+}
+
+void ProcessorThreadPool::runRanges()
+{
+	m_busyWorkers.fetch_add(1);
+
+	if (Job* job = m_job.load())
+	{
+		for (;;)
+		{
+			const int range = m_nextRange.fetch_add(1);
+			if (range >= m_numRanges)
+				break;
+			job->runRange(range);
+			m_completedRanges.fetch_add(1);
+		}
+	}
+
+	m_busyWorkers.fetch_sub(1);
+}
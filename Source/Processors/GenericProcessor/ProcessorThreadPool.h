@@ -0,0 +1,81 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef PROCESSORTHREADPOOL_H_INCLUDED
+#define PROCESSORTHREADPOOL_H_INCLUDED
+
+#include <JuceHeader.h>
+#include <atomic>
+
+/**
+	Persistent worker threads used by GenericProcessor::parallelFor().
+
+	The threads are started once, from the message thread, and then sleep until
+	a processor hands them a job, so nothing is allocated or created from the
+	audio callback. Only one job runs at a time: if another processor already
+	owns the pool, run() returns false and the caller processes its work itself.
+
+	@see GenericProcessor
+*/
+class ProcessorThreadPool : private DeletedAtShutdown
+{
+public:
+	/** A job split into a fixed number of ranges */
+	class Job
+	{
+	public:
+		virtual ~Job() {}
+		virtual void runRange(int rangeIndex) = 0;
+	};
+
+	ProcessorThreadPool();
+	~ProcessorThreadPool();
+
+	/** Runs all ranges of the job, on the calling thread and the workers, and
+	returns once all of them are done. Returns false without running anything
+	if the pool is busy with another job. */
+	bool run(Job& job, int numRanges);
+
+	/** Number of worker threads, not counting the thread calling run() */
+	int getNumWorkers() const;
+
+	juce_DeclareSingleton(ProcessorThreadPool, false);
+
+private:
+	class Worker;
+
+	void runRanges();
+
+	OwnedArray<Worker> m_workers;
+
+	std::atomic<bool> m_inUse;
+	std::atomic<Job*> m_job;
+	int m_numRanges;
+	std::atomic<int> m_nextRange;
+	std::atomic<int> m_completedRanges;
+	std::atomic<int> m_busyWorkers;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProcessorThreadPool);
+};
+
+#endif  // PROCESSORTHREADPOOL_H_INCLUDED
@@ -0,0 +1,284 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "RealtimeLog.h"
+#include <atomic>
+#include <cstdio>
+
+namespace
+{
+	struct LogMessage
+	{
+		RealtimeLog::Level level;
+		char text[RealtimeLog::maxMessageLength];
+	};
+
+	/** Written by the thread holding it only, read by the printing thread only */
+	struct ThreadLog
+	{
+		char threadName[64];
+		LogMessage messages[RealtimeLog::messagesPerThread];
+		std::atomic<uint64> numWritten;
+		std::atomic<uint64> numRead;
+		std::atomic<uint32> numDropped;
+		std::atomic<bool> inUse;
+		// rate limiting, touched by the owning thread only
+		int64 windowStart;
+		int windowMessages;
+	};
+
+	class LogPrinter;
+
+	/** The rings are all allocated up front, so a thread takes one without a lock */
+	struct LogState
+	{
+		LogState()
+		{
+			for (int i = 0; i < RealtimeLog::maxThreads; i++)
+			{
+				logs[i].threadName[0] = 0;
+				logs[i].numWritten = 0;
+				logs[i].numRead = 0;
+				logs[i].numDropped = 0;
+				logs[i].inUse = false;
+			}
+		}
+
+		ThreadLog logs[RealtimeLog::maxThreads];
+		std::atomic<uint32> numUnregisteredDropped{ 0 };
+		CriticalSection printerLock;
+		ScopedPointer<LogPrinter> printer;
+	};
+
+	std::atomic<int> minimumLevel(RealtimeLog::LOG_INFO);
+	std::atomic<bool> printerRunning(false);
+
+	// Never deleted, like the trace buffers: threads may log while the application exits
+	LogState& getState()
+	{
+		static LogState* state = new LogState();
+		return *state;
+	}
+
+	void printMessage(RealtimeLog::Level level, const char* text)
+	{
+		std::ostream& out = level >= RealtimeLog::LOG_WARNING ? std::cerr : std::cout;
+		out << text << '\n';
+	}
+
+	/** Prints the pending messages of every thread. Called by one thread at a time */
+	void printPending(LogState& state)
+	{
+		for (int i = 0; i < RealtimeLog::maxThreads; i++)
+		{
+			ThreadLog& log = state.logs[i];
+			const uint64 end = log.numWritten.load(std::memory_order_acquire);
+			uint64 n = log.numRead.load(std::memory_order_relaxed);
+			for (; n < end; n++)
+			{
+				const LogMessage& message = log.messages[n % RealtimeLog::messagesPerThread];
+				printMessage(message.level, message.text);
+			}
+			log.numRead.store(n, std::memory_order_release);
+
+			const uint32 dropped = log.numDropped.exchange(0, std::memory_order_acquire);
+			if (dropped > 0)
+				std::cerr << "(" << dropped << " messages from " << log.threadName << " dropped)" << '\n';
+		}
+
+		const uint32 unregistered = state.numUnregisteredDropped.exchange(0, std::memory_order_relaxed);
+		if (unregistered > 0)
+			std::cerr << "(" << unregistered << " messages dropped, more than "
+				<< RealtimeLog::maxThreads << " threads are logging)" << '\n';
+
+		std::cout.flush();
+		std::cerr.flush();
+	}
+
+	class LogPrinter : public Thread
+	{
+	public:
+		LogPrinter() : Thread("Log printer") {}
+
+		void run() override
+		{
+			while (!threadShouldExit())
+			{
+				printPending(getState());
+				wait(20);
+			}
+		}
+	};
+
+	/** Gives the ring back for another thread when its thread exits */
+	struct LogHolder
+	{
+		ThreadLog* log{ nullptr };
+
+		~LogHolder()
+		{
+			if (log != nullptr)
+				log->inUse.store(false, std::memory_order_release);
+		}
+	};
+
+	thread_local LogHolder currentLog;
+
+	void setThreadName(ThreadLog& log)
+	{
+		const char* name = "Audio thread";
+		if (Thread* thread = Thread::getCurrentThread())
+			name = thread->getThreadName().toRawUTF8();
+		else
+		{
+			MessageManager* mm = MessageManager::getInstanceWithoutCreating();
+			if (mm != nullptr && mm->isThisTheMessageThread())
+				name = "Message thread";
+		}
+
+		strncpy(log.threadName, name, sizeof(log.threadName) - 1);
+		log.threadName[sizeof(log.threadName) - 1] = 0;
+	}
+
+	/** Claims a free ring for the calling thread, or returns nullptr if all are taken */
+	ThreadLog* acquireLog()
+	{
+		LogState& state = getState();
+
+		// a ring is only taken over once its messages have been printed
+		for (int i = 0; i < RealtimeLog::maxThreads; i++)
+		{
+			ThreadLog& candidate = state.logs[i];
+			bool expected = false;
+			if (candidate.inUse.load(std::memory_order_relaxed)
+				|| !candidate.inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+				continue;
+
+			if (candidate.numRead.load(std::memory_order_acquire) != candidate.numWritten.load(std::memory_order_relaxed)
+				|| candidate.numDropped.load(std::memory_order_relaxed) != 0)
+			{
+				candidate.inUse.store(false, std::memory_order_release);
+				continue;
+			}
+
+			setThreadName(candidate);
+			candidate.windowStart = 0;
+			candidate.windowMessages = 0;
+			currentLog.log = &candidate;
+			return &candidate;
+		}
+
+		return nullptr;
+	}
+}
+
+void RealtimeLog::write(Level level, const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	writeV(level, format, args);
+	va_end(args);
+}
+
+void RealtimeLog::writeV(Level level, const char* format, va_list args)
+{
+	if (!isLogged(level))
+		return;
+
+	if (!printerRunning.load(std::memory_order_acquire))
+	{
+		char text[maxMessageLength];
+		vsnprintf(text, maxMessageLength, format, args);
+		printMessage(level, text);
+		(level >= LOG_WARNING ? std::cerr : std::cout).flush();
+		return;
+	}
+
+	ThreadLog* log = currentLog.log;
+	if (log == nullptr)
+		log = acquireLog();
+	if (log == nullptr)
+	{
+		getState().numUnregisteredDropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	const int64 now = Time::getHighResolutionTicks();
+	if (now - log->windowStart >= Time::getHighResolutionTicksPerSecond())
+	{
+		log->windowStart = now;
+		log->windowMessages = 0;
+	}
+
+	const uint64 n = log->numWritten.load(std::memory_order_relaxed);
+	if (log->windowMessages >= maxMessagesPerSecond
+		|| n - log->numRead.load(std::memory_order_acquire) >= uint64(messagesPerThread))
+	{
+		log->numDropped.fetch_add(1, std::memory_order_release);
+		return;
+	}
+	log->windowMessages++;
+
+	LogMessage& message = log->messages[n % messagesPerThread];
+	message.level = level;
+	vsnprintf(message.text, maxMessageLength, format, args);
+	log->numWritten.store(n + 1, std::memory_order_release);
+}
+
+void RealtimeLog::setMinimumLevel(Level level)
+{
+	minimumLevel = level;
+}
+
+bool RealtimeLog::isLogged(Level level)
+{
+	return level >= minimumLevel.load(std::memory_order_relaxed);
+}
+
+void RealtimeLog::start()
+{
+	LogState& state = getState();
+	const ScopedLock sl(state.printerLock);
+	if (state.printer == nullptr)
+		state.printer = new LogPrinter();
+	// below the data and record threads, the console is the least urgent of them
+	state.printer->startThread(3);
+	printerRunning = true;
+}
+
+void RealtimeLog::stop()
+{
+	LogState& state = getState();
+	ScopedPointer<LogPrinter> printer;
+	{
+		const ScopedLock sl(state.printerLock);
+		printerRunning = false;
+		printer = state.printer.release();
+	}
+	if (printer != nullptr)
+		printer->stopThread(1000);
+
+	const ScopedLock sl(state.printerLock);
+	printPending(state);
+}
@@ -0,0 +1,83 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef REALTIMELOG_H_INCLUDED
+#define REALTIMELOG_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "../PluginManager/OpenEphysPlugin.h"
+#include <cstdarg>
+
+/**
+	Console logging that real-time threads can use without waiting on the console.
+
+	A message is formatted printf style straight into a ring buffer owned by the
+	calling thread, which takes no lock and allocates nothing. The rings of up to
+	maxThreads threads are allocated with the log, and a thread claims one with its
+	first message. A background thread prints the messages, so a slow console never
+	stalls the thread that logged them.
+
+	Each thread may log maxMessagesPerSecond messages per second; the messages over
+	that, those that find the thread's ring full, and those of threads finding no
+	free ring are dropped and reported as a count. Messages below the minimum level are discarded before being formatted.
+
+	Until start() is called, and after stop(), messages are printed by the thread
+	logging them. Plugins log through CoreServices::logMessage().
+
+	@see TraceRecorder, CoreServices
+*/
+class PLUGIN_API RealtimeLog
+{
+public:
+	enum Level
+	{
+		LOG_DEBUG = 0,
+		LOG_INFO,
+		LOG_WARNING,
+		LOG_ERROR
+	};
+
+	/** Logs a printf style message. Longer messages than maxMessageLength are truncated */
+	static void write(Level level, const char* format, ...);
+	static void writeV(Level level, const char* format, va_list args);
+
+	static void setMinimumLevel(Level level);
+	static bool isLogged(Level level);
+
+	/** Starts the thread printing the messages */
+	static void start();
+
+	/** Prints the messages left and stops the printing thread */
+	static void stop();
+
+	static const int messagesPerThread = 256;
+	static const int maxMessageLength = 248;
+	static const int maxMessagesPerSecond = 20;
+	static const int maxThreads = 32;
+
+private:
+	RealtimeLog() = delete;
+};
+
+#endif  // REALTIMELOG_H_INCLUDED
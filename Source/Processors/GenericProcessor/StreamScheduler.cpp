@@ -0,0 +1,209 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "StreamScheduler.h"
+#include "GenericProcessor.h"
+
+StreamScheduler::StreamScheduler()
+	: m_processor(nullptr)
+{
+}
+
+StreamScheduler::~StreamScheduler()
+{
+}
+
+void StreamScheduler::update(const GenericProcessor* processor)
+{
+	OwnedArray<Stream> streams;
+	m_processor = processor;
+
+	for (int i = 0; i < processor->getTotalDataChannels(); i++)
+	{
+		const DataChannel* chan = processor->getDataChannel(i);
+		const uint32 sourceId = GenericProcessor::getProcessorFullId(chan->getSourceNodeID(), chan->getSubProcessorIdx());
+
+		Stream* stream = nullptr;
+		for (int s = 0; s < streams.size() && stream == nullptr; s++)
+		{
+			if (streams[s]->sourceId == sourceId)
+				stream = streams[s];
+		}
+		if (stream == nullptr)
+		{
+			stream = streams.add(new Stream());
+			stream->sourceId = sourceId;
+			stream->sampleRate = chan->getSampleRate();
+			stream->batchLength = 0;
+			stream->batchFill = 0;
+			stream->batchTimestamp = 0;
+
+			for (int s = 0; s < m_streams.size(); s++)
+			{
+				if (m_streams[s]->sourceId == sourceId)
+				{
+					stream->callback = m_streams[s]->callback;
+					stream->batchLength = m_streams[s]->batchLength;
+				}
+			}
+		}
+		stream->channels.add(i);
+	}
+
+	m_streams.swapWith(streams);
+	for (int s = 0; s < m_streams.size(); s++)
+	{
+		Stream& stream = *m_streams[s];
+		stream.viewChannels.calloc(stream.channels.size());
+		setBatchLength(s, stream.batchLength);
+	}
+}
+
+int StreamScheduler::getNumStreams() const
+{
+	return m_streams.size();
+}
+
+uint32 StreamScheduler::getSourceId(int stream) const
+{
+	return m_streams[stream]->sourceId;
+}
+
+float StreamScheduler::getSampleRate(int stream) const
+{
+	return m_streams[stream]->sampleRate;
+}
+
+const Array<int>& StreamScheduler::getChannels(int stream) const
+{
+	return m_streams[stream]->channels;
+}
+
+void StreamScheduler::setCallback(int stream, Callback callback)
+{
+	m_streams[stream]->callback = callback;
+}
+
+void StreamScheduler::setBatchLength(int stream, int numSamples)
+{
+	Stream& s = *m_streams[stream];
+	s.batchLength = jmax(0, numSamples);
+	s.batchFill = 0;
+	if (s.batchLength > 0)
+		s.batchMemory.allocateAudioBuffer(s.batch, s.channels.size(), s.batchLength);
+	else
+		s.batchMemory.free();
+}
+
+void StreamScheduler::setBatchDuration(float seconds)
+{
+	for (int s = 0; s < m_streams.size(); s++)
+		setBatchLength(s, roundToInt(seconds * m_streams[s]->sampleRate));
+}
+
+void StreamScheduler::process(AudioSampleBuffer& buffer)
+{
+	for (int s = 0; s < m_streams.size(); s++)
+	{
+		Stream& stream = *m_streams[s];
+		if (!stream.callback)
+			continue;
+
+		const int firstChannel = stream.channels.getUnchecked(0);
+		Block block;
+		block.sourceId = stream.sourceId;
+		block.sampleRate = stream.sampleRate;
+		block.timestamp = m_processor->getTimestamp(firstChannel);
+		block.numSamples = jmin(int(m_processor->getNumSamples(firstChannel)), buffer.getNumSamples());
+		if (block.numSamples <= 0)
+			continue;
+
+		if (stream.batchLength > 0)
+			processBatched(stream, buffer, block);
+		else
+			processInPlace(stream, buffer, block);
+	}
+}
+
+void StreamScheduler::processInPlace(Stream& stream, AudioSampleBuffer& buffer, const Block& block)
+{
+	// pointed at the graph's channels again only when they move, which keeps
+	// setDataToReferTo() and its allocation out of the steady state
+	bool changed = stream.view.getNumSamples() != block.numSamples;
+	const int numChannels = stream.channels.size();
+	for (int c = 0; c < numChannels; c++)
+	{
+		float* channel = buffer.getWritePointer(stream.channels.getUnchecked(c));
+		if (stream.viewChannels[c] != channel)
+		{
+			stream.viewChannels[c] = channel;
+			changed = true;
+		}
+	}
+	if (changed)
+		stream.view.setDataToReferTo(stream.viewChannels, numChannels, block.numSamples);
+
+	stream.callback(stream.view, block);
+}
+
+void StreamScheduler::processBatched(Stream& stream, const AudioSampleBuffer& buffer, const Block& block)
+{
+	// the stream jumped, e.g. after dropped samples: the batch so far goes on its own
+	if (stream.batchFill > 0 && block.timestamp != stream.batchTimestamp + stream.batchFill)
+		finishBatch(stream);
+
+	int done = 0;
+	while (done < block.numSamples)
+	{
+		if (stream.batchFill == 0)
+			stream.batchTimestamp = block.timestamp + done;
+
+		const int count = jmin(block.numSamples - done, stream.batchLength - stream.batchFill);
+		for (int c = 0; c < stream.channels.size(); c++)
+			stream.batch.copyFrom(c, stream.batchFill, buffer, stream.channels.getUnchecked(c), done, count);
+		stream.batchFill += count;
+		done += count;
+
+		if (stream.batchFill == stream.batchLength)
+			finishBatch(stream);
+	}
+}
+
+void StreamScheduler::finishBatch(Stream& stream)
+{
+	Block batch;
+	batch.sourceId = stream.sourceId;
+	batch.sampleRate = stream.sampleRate;
+	batch.timestamp = stream.batchTimestamp;
+	batch.numSamples = stream.batchFill;
+	stream.batchFill = 0;
+
+	stream.callback(stream.batch, batch);
+}
+
+void StreamScheduler::reset()
+{
+	for (int s = 0; s < m_streams.size(); s++)
+		m_streams[s]->batchFill = 0;
+}
@@ -0,0 +1,135 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef STREAMSCHEDULER_H_INCLUDED
+#define STREAMSCHEDULER_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "../PluginManager/OpenEphysPlugin.h"
+#include "LockedMemoryBlock.h"
+#include <functional>
+
+class GenericProcessor;
+
+/**
+	Splits the input of a processor into its streams, one per source subprocessor,
+	and runs a callback per stream at that stream's own block length.
+
+	The graph calls every processor once per audio callback, with a buffer sized
+	for the fastest stream, while each stream fills only getNumSamples() of it:
+	a 2.5 kHz LFP stream next to a 30 kHz amplifier one gets a twelfth of the
+	samples. Processors owning a StreamScheduler call process() from their own
+	process(); each stream with a callback then gets a buffer holding only its
+	channels and its samples.
+
+	A stream given a batch length is gathered instead, and its callback runs once
+	that many samples have arrived, so low-rate streams can be handled in fewer,
+	larger blocks. The callback then gets a copy of the data: changes to it don't
+	reach the graph, so batching is meant for processors that only read their
+	input. A batch is handed over early, with fewer samples, when the timestamps
+	of its stream jump.
+
+	update() and the setters are called from the message thread while not
+	acquiring, usually from updateSettings(); process() and reset() from the
+	audio thread.
+
+	@see GenericProcessor::getNumSamples
+*/
+class PLUGIN_API StreamScheduler
+{
+public:
+	struct Block
+	{
+		/** Full id of the source subprocessor, see GenericProcessor::getProcessorFullId */
+		uint32 sourceId;
+		float sampleRate;
+		/** Timestamp of the first sample */
+		juce::uint64 timestamp;
+		/** Samples of each channel to process, which can be fewer than the buffer holds */
+		int numSamples;
+	};
+
+	typedef std::function<void(AudioSampleBuffer& streamBuffer, const Block& block)> Callback;
+
+	StreamScheduler();
+	~StreamScheduler();
+
+	/** Rebuilds the streams from the data channels of the processor. The callbacks and
+	batch lengths of sources that are still there are kept. */
+	void update(const GenericProcessor* processor);
+
+	int getNumStreams() const;
+	uint32 getSourceId(int stream) const;
+	float getSampleRate(int stream) const;
+
+	/** Indexes, in the processor's data channels, of the channels of a stream. The
+	stream buffers hold them in this order. */
+	const Array<int>& getChannels(int stream) const;
+
+	void setCallback(int stream, Callback callback);
+
+	/** Gathers a stream into batches of numSamples. 0 hands over every block as it
+	comes, in the graph's buffer. */
+	void setBatchLength(int stream, int numSamples);
+
+	/** Sets the batch length of every stream to the samples it produces in the given
+	time, so the fast streams keep their blocks and the slow ones are gathered. */
+	void setBatchDuration(float seconds);
+
+	/** Runs the callbacks of the streams in this block of the processor's input */
+	void process(AudioSampleBuffer& buffer);
+
+	/** Drops the partial batches, e.g. when acquisition starts */
+	void reset();
+
+private:
+	struct Stream
+	{
+		uint32 sourceId;
+		float sampleRate;
+		Array<int> channels;
+		Callback callback;
+
+		// the streams handed over in place refer to the graph's channels
+		AudioSampleBuffer view;
+		HeapBlock<float*> viewChannels;
+
+		int batchLength;
+		AudioSampleBuffer batch;
+		LockedMemoryBlock batchMemory;
+		int batchFill;
+		juce::uint64 batchTimestamp;
+	};
+
+	void processInPlace(Stream& stream, AudioSampleBuffer& buffer, const Block& block);
+	void processBatched(Stream& stream, const AudioSampleBuffer& buffer, const Block& block);
+	void finishBatch(Stream& stream);
+
+	const GenericProcessor* m_processor;
+	OwnedArray<Stream> m_streams;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StreamScheduler);
+};
+
+#endif  // STREAMSCHEDULER_H_INCLUDED
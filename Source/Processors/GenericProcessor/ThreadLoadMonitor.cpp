@@ -0,0 +1,123 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ThreadLoadMonitor.h"
+
+#if JUCE_WINDOWS
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif JUCE_MAC
+#include <mach/mach.h>
+#include <pthread.h>
+#else
+#include <time.h>
+#endif
+
+namespace
+{
+	// How often the monitored thread reads its CPU time, which is a system call
+	const double CPU_READ_INTERVAL_SEC = 0.05;
+
+	/** CPU time used by the calling thread, in nanoseconds */
+	int64 getCurrentThreadCpuNanos()
+	{
+#if JUCE_WINDOWS
+		FILETIME creation, exit, kernel, user;
+		if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+			return 0;
+		const int64 kernel100ns = (int64(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+		const int64 user100ns = (int64(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+		return (kernel100ns + user100ns) * 100;
+#elif JUCE_MAC
+		thread_basic_info_data_t info;
+		mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+		if (thread_info(pthread_mach_thread_np(pthread_self()), THREAD_BASIC_INFO, (thread_info_t)&info, &count) != KERN_SUCCESS)
+			return 0;
+		return (int64(info.user_time.seconds) + info.system_time.seconds) * 1000000000
+			+ (int64(info.user_time.microseconds) + info.system_time.microseconds) * 1000;
+#else
+		timespec ts;
+		if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+			return 0;
+		return int64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+	}
+}
+
+ThreadLoadMonitor::ThreadLoadMonitor()
+{
+	m_numLoops = 0;
+	m_loopTicks = 0;
+	m_cpuNanos = 0;
+	m_cpuTicks = 0;
+}
+
+void ThreadLoadMonitor::reset()
+{
+	m_numLoops = 0;
+	m_loopTicks = 0;
+	readCpuTime(Time::getHighResolutionTicks());
+}
+
+void ThreadLoadMonitor::loopFinished(int64 loopStartTicks)
+{
+	const int64 now = Time::getHighResolutionTicks();
+	m_loopTicks.fetch_add(now - loopStartTicks, std::memory_order_relaxed);
+	m_numLoops.fetch_add(1, std::memory_order_relaxed);
+
+	if (Time::highResolutionTicksToSeconds(now - m_cpuTicks.load(std::memory_order_relaxed)) >= CPU_READ_INTERVAL_SEC)
+		readCpuTime(now);
+}
+
+void ThreadLoadMonitor::readCpuTime(int64 now)
+{
+	m_cpuNanos.store(getCurrentThreadCpuNanos(), std::memory_order_relaxed);
+	m_cpuTicks.store(now, std::memory_order_release);
+}
+
+ThreadLoadMonitor::Counters ThreadLoadMonitor::getCounters() const
+{
+	Counters counters;
+	counters.cpuTicks = m_cpuTicks.load(std::memory_order_acquire);
+	counters.cpuNanos = m_cpuNanos.load(std::memory_order_relaxed);
+	counters.numLoops = m_numLoops.load(std::memory_order_relaxed);
+	counters.loopTicks = m_loopTicks.load(std::memory_order_relaxed);
+	return counters;
+}
+
+ThreadLoadMonitor::Load ThreadLoadMonitor::getLoad(const Counters& previous, const Counters& current)
+{
+	Load load;
+	const double seconds = Time::highResolutionTicksToSeconds(current.cpuTicks - previous.cpuTicks);
+	const int64 numLoops = current.numLoops - previous.numLoops;
+	if (seconds <= 0 || numLoops < 0 || current.cpuNanos < previous.cpuNanos)
+		return load;
+
+	load.loopsPerSecond = numLoops / seconds;
+	load.utilisation = jlimit(0.0, 1.0, (current.cpuNanos - previous.cpuNanos) * 1e-9 / seconds);
+	if (numLoops > 0)
+		load.meanLoopMs = Time::highResolutionTicksToSeconds(current.loopTicks - previous.loopTicks) * 1000.0 / numLoops;
+	return load;
+}
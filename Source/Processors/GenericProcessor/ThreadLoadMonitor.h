@@ -0,0 +1,90 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef THREADLOADMONITOR_H_INCLUDED
+#define THREADLOADMONITOR_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "../PluginManager/OpenEphysPlugin.h"
+#include <atomic>
+
+/**
+	Counts the loops of a worker thread and the CPU time it uses.
+
+	The monitored thread calls reset() when it starts and loopFinished() after
+	each pass of its loop; both are lock free, and the thread's CPU time is only
+	read every few tens of milliseconds. Any thread can take getCounters(), and
+	getLoad() turns two of them into rates, so each reader keeps its own previous
+	counters and readers do not disturb each other.
+
+	@see DataThread, RecordThread
+*/
+class PLUGIN_API ThreadLoadMonitor
+{
+public:
+	struct Counters
+	{
+		int64 numLoops{ 0 };
+		/** Time spent inside the loop, in high resolution ticks */
+		int64 loopTicks{ 0 };
+		/** CPU time used by the thread, in nanoseconds */
+		int64 cpuNanos{ 0 };
+		/** High resolution tick count when cpuNanos was read */
+		int64 cpuTicks{ 0 };
+	};
+
+	struct Load
+	{
+		double loopsPerSecond{ 0 };
+		/** CPU time over wall clock time, from 0 to 1 */
+		double utilisation{ 0 };
+		/** Mean duration of a loop, including any time spent waiting inside it */
+		double meanLoopMs{ 0 };
+	};
+
+	ThreadLoadMonitor();
+
+	/** Called by the monitored thread when it starts running */
+	void reset();
+
+	/** Called by the monitored thread at the end of every loop */
+	void loopFinished(int64 loopStartTicks);
+
+	Counters getCounters() const;
+
+	/** Load between two sets of counters. Returns an empty Load if no time passed
+	or the thread was restarted in between. */
+	static Load getLoad(const Counters& previous, const Counters& current);
+
+private:
+	void readCpuTime(int64 now);
+
+	std::atomic<int64> m_numLoops;
+	std::atomic<int64> m_loopTicks;
+	std::atomic<int64> m_cpuNanos;
+	std::atomic<int64> m_cpuTicks;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ThreadLoadMonitor);
+};
+
+#endif  // THREADLOADMONITOR_H_INCLUDED
@@ -0,0 +1,272 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ThreadPolicy.h"
+#include <atomic>
+
+#if JUCE_WINDOWS
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif JUCE_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+	const char* const roleTags[ThreadPolicy::NUM_ROLES] = { "ACQUISITION", "AUDIOCALLBACK", "WRITER", "COMPUTE" };
+
+	struct PolicyState
+	{
+		PolicyState()
+		{
+			// DataThreads always asked for the highest priority
+			settings[ThreadPolicy::Acquisition].priority = 10;
+			for (int i = 0; i < ThreadPolicy::NUM_ROLES; i++)
+				reportedFailure[i] = false;
+			useLockedMemory = false;
+		}
+
+		CriticalSection lock;
+		ThreadPolicy::RoleSettings settings[ThreadPolicy::NUM_ROLES];
+		std::atomic<bool> reportedFailure[ThreadPolicy::NUM_ROLES];
+		std::atomic<bool> useLockedMemory;
+	};
+
+	PolicyState& getState()
+	{
+		static PolicyState state;
+		return state;
+	}
+
+	void reportFailure(ThreadPolicy::Role role, const String& what)
+	{
+		if (getState().reportedFailure[role].exchange(true))
+			return;
+		std::cout << "Thread policy: could not set the " << what << " of the "
+			<< ThreadPolicy::getRoleName(role) << " threads" << std::endl;
+	}
+
+	/** Pins the calling thread to a set of CPUs. Returns false if the OS refused or
+	can't pin threads */
+	bool pinCurrentThread(const Array<int>& cpus)
+	{
+#if JUCE_LINUX
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (int i = 0; i < cpus.size(); i++)
+			if (cpus[i] >= 0 && cpus[i] < CPU_SETSIZE)
+				CPU_SET(cpus[i], &set);
+		return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif JUCE_WINDOWS
+		DWORD_PTR mask = 0;
+		for (int i = 0; i < cpus.size(); i++)
+			if (cpus[i] >= 0 && cpus[i] < int(sizeof(DWORD_PTR) * 8))
+				mask |= DWORD_PTR(1) << cpus[i];
+		return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+		// macOS only takes affinity hints between threads, not CPU numbers
+		ignoreUnused(cpus);
+		return false;
+#endif
+	}
+}
+
+ThreadPolicy::RoleSettings ThreadPolicy::getSettings(Role role)
+{
+	jassert(role >= 0 && role < NUM_ROLES);
+	PolicyState& state = getState();
+	const ScopedLock sl(state.lock);
+	return state.settings[role];
+}
+
+void ThreadPolicy::setSettings(Role role, const RoleSettings& settings)
+{
+	jassert(role >= 0 && role < NUM_ROLES);
+	PolicyState& state = getState();
+	const ScopedLock sl(state.lock);
+	state.settings[role] = settings;
+	state.settings[role].priority = jlimit(-1, 10, settings.priority);
+	state.reportedFailure[role] = false;
+}
+
+void ThreadPolicy::applyToCurrentThread(Role role)
+{
+	const RoleSettings settings = getSettings(role);
+
+	if (settings.priority >= 0 && !Thread::setCurrentThreadPriority(settings.priority))
+		reportFailure(role, "priority");
+
+	const Array<int> cpus = getCpus(role);
+	if (cpus.size() > 0 && !pinCurrentThread(cpus))
+		reportFailure(role, "CPU affinity");
+}
+
+Array<int> ThreadPolicy::getCpus(Role role)
+{
+	const RoleSettings settings = getSettings(role);
+
+	if (settings.cpus.isNotEmpty())
+		return parseCpuList(settings.cpus);
+
+#if JUCE_LINUX
+	if (settings.numaNode >= 0)
+	{
+		File nodeCpus("/sys/devices/system/node/node" + String(settings.numaNode) + "/cpulist");
+		if (nodeCpus.existsAsFile())
+			return parseCpuList(nodeCpus.loadFileAsString());
+		reportFailure(role, "NUMA node");
+	}
+#endif
+
+	return Array<int>();
+}
+
+bool ThreadPolicy::getUseLockedMemory()
+{
+	return getState().useLockedMemory;
+}
+
+void ThreadPolicy::setUseLockedMemory(bool shouldLock)
+{
+	getState().useLockedMemory = shouldLock;
+}
+
+String ThreadPolicy::getRoleName(Role role)
+{
+	switch (role)
+	{
+	case Acquisition: return "acquisition";
+	case AudioCallback: return "audio callback";
+	case Writer: return "writer";
+	case Compute: return "compute";
+	default: return String::empty;
+	}
+}
+
+void ThreadPolicy::saveSettings(XmlElement* parent)
+{
+	XmlElement* xml = new XmlElement("THREADPOLICY");
+	xml->setAttribute("lockedMemory", getUseLockedMemory());
+
+	for (int i = 0; i < NUM_ROLES; i++)
+	{
+		const RoleSettings settings = getSettings(Role(i));
+		XmlElement* e = new XmlElement(roleTags[i]);
+		e->setAttribute("priority", settings.priority);
+		e->setAttribute("cpus", settings.cpus);
+		e->setAttribute("numaNode", settings.numaNode);
+		xml->addChildElement(e);
+	}
+
+	parent->addChildElement(xml);
+}
+
+void ThreadPolicy::loadSettings(const XmlElement* parent)
+{
+	const XmlElement* xml = parent->getChildByName("THREADPOLICY");
+	if (xml == nullptr)
+		return;
+
+	setUseLockedMemory(xml->getBoolAttribute("lockedMemory", getUseLockedMemory()));
+
+	for (int i = 0; i < NUM_ROLES; i++)
+	{
+		const XmlElement* e = xml->getChildByName(roleTags[i]);
+		if (e == nullptr)
+			continue;
+
+		RoleSettings settings = getSettings(Role(i));
+		settings.priority = e->getIntAttribute("priority", settings.priority);
+		settings.cpus = e->getStringAttribute("cpus", settings.cpus);
+		settings.numaNode = e->getIntAttribute("numaNode", settings.numaNode);
+		setSettings(Role(i), settings);
+	}
+}
+
+Array<int> ThreadPolicy::parseCpuList(const String& list)
+{
+	const int numCpus = SystemStats::getNumCpus();
+	Array<int> cpus;
+	StringArray ranges;
+	ranges.addTokens(list, ",", String::empty);
+
+	for (int i = 0; i < ranges.size(); i++)
+	{
+		const String range = ranges[i].trim();
+		if (range.isEmpty())
+			continue;
+
+		// entries that aren't a CPU number or a range of them are ignored
+		const String firstText = range.upToFirstOccurrenceOf("-", false, false).trim();
+		const String lastText = range.containsChar('-') ? range.fromFirstOccurrenceOf("-", false, false).trim() : firstText;
+		if (firstText.isEmpty() || lastText.isEmpty()
+			|| !firstText.containsOnly("0123456789") || !lastText.containsOnly("0123456789"))
+			continue;
+
+		const int first = firstText.getIntValue();
+		const int last = jmin(lastText.getIntValue(), numCpus - 1);
+		for (int cpu = first; cpu <= last; cpu++)
+			cpus.addIfNotAlreadyThere(cpu);
+	}
+	return cpus;
+}
+
+ThreadPolicy::ScopedPlacement::ScopedPlacement(Role role)
+	: m_pinned(false)
+{
+	const Array<int> cpus = getCpus(role);
+	if (cpus.size() == 0)
+		return;
+
+#if JUCE_LINUX
+	m_previousAffinity.calloc(sizeof(cpu_set_t));
+	if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), (cpu_set_t*)m_previousAffinity.getData()) != 0)
+		return;
+	m_pinned = pinCurrentThread(cpus);
+#elif JUCE_WINDOWS
+	// SetThreadAffinityMask() returns the previous mask, so pin to the current
+	// CPU first to read it back
+	m_previousAffinity.calloc(sizeof(DWORD_PTR));
+	DWORD_PTR previous = SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << GetCurrentProcessorNumber());
+	if (previous == 0)
+		return;
+	*(DWORD_PTR*)m_previousAffinity.getData() = previous;
+	m_pinned = true;
+	pinCurrentThread(cpus);
+#endif
+}
+
+ThreadPolicy::ScopedPlacement::~ScopedPlacement()
+{
+	if (!m_pinned)
+		return;
+
+#if JUCE_LINUX
+	pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), (cpu_set_t*)m_previousAffinity.getData());
+#elif JUCE_WINDOWS
+	SetThreadAffinityMask(GetCurrentThread(), *(DWORD_PTR*)m_previousAffinity.getData());
+#endif
+}
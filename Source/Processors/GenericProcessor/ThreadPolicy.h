@@ -0,0 +1,125 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef THREADPOLICY_H_INCLUDED
+#define THREADPOLICY_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "../PluginManager/OpenEphysPlugin.h"
+
+/**
+	Scheduling priority, CPU pinning and NUMA placement of the GUI's threads.
+
+	Threads are grouped by role, and each thread applies the settings of its
+	role to itself with applyToCurrentThread() when it starts running. The
+	settings are saved with the window state, so a rig is configured once,
+	and are set from the Edit menu's thread settings dialog.
+
+	Priorities above 0 ask for the round-robin real-time class on Linux and
+	macOS, which is only granted when the user is allowed to (rtprio limits
+	on Linux); otherwise the thread keeps its normal priority and a message
+	is logged once.
+
+	Buffers filled or read by a role are allocated inside a ScopedPlacement,
+	so that their pages are first touched, and thus allocated, on the NUMA
+	node the role runs on.
+
+	@see DataThread, RecordThread, ProcessorThreadPool
+*/
+class PLUGIN_API ThreadPolicy
+{
+public:
+	enum Role
+	{
+		/** DataThreads, the threads reading from hardware and the FileReader */
+		Acquisition = 0,
+		/** The audio device callback or the thread driving the signal chain */
+		AudioCallback,
+		/** The record thread and the file writers of the record engines */
+		Writer,
+		/** Worker pools: processor workers, graph render threads, PCA */
+		Compute,
+		NUM_ROLES
+	};
+
+	struct RoleSettings
+	{
+		/** JUCE priority from 0 to 10, or -1 to keep the priority the thread was started with */
+		int priority{ -1 };
+		/** CPUs the threads may run on, as a list such as "0-7,16-23". Empty for any CPU */
+		String cpus;
+		/** NUMA node to run on and to allocate the role's buffers from, or -1. Only used on
+		Linux, and only when no CPUs are given */
+		int numaNode{ -1 };
+	};
+
+	/**
+		Runs the calling thread on the CPUs of a role for as long as it lives,
+		then restores the thread's previous affinity. Memory allocated and
+		cleared meanwhile ends up on the role's NUMA node.
+	*/
+	class PLUGIN_API ScopedPlacement
+	{
+	public:
+		explicit ScopedPlacement(Role role);
+		~ScopedPlacement();
+
+	private:
+		HeapBlock<char> m_previousAffinity;
+		bool m_pinned;
+
+		JUCE_DECLARE_NON_COPYABLE(ScopedPlacement);
+	};
+
+	static RoleSettings getSettings(Role role);
+	static void setSettings(Role role, const RoleSettings& settings);
+
+	/** Applies the priority and CPUs of a role to the calling thread */
+	static void applyToCurrentThread(Role role);
+
+	/** CPUs a role runs on, from its CPU list or its NUMA node. Empty if the role can use any CPU */
+	static Array<int> getCpus(Role role);
+
+	static String getRoleName(Role role);
+
+	/** If set, the large buffers shared with real-time threads are locked in RAM
+	and backed by huge pages, see LockedMemoryBlock. Takes effect the next time
+	the buffers are allocated, on a signal chain update */
+	static bool getUseLockedMemory();
+	static void setUseLockedMemory(bool shouldLock);
+
+	/** Adds a THREADPOLICY element with the settings of every role */
+	static void saveSettings(XmlElement* parent);
+
+	/** Reads the settings from the THREADPOLICY child of an element, if there is one */
+	static void loadSettings(const XmlElement* parent);
+
+	/** Parses a CPU list such as "0-3,8,10-11". CPUs past the last one of the machine and
+	entries that can't be read are left out */
+	static Array<int> parseCpuList(const String& list);
+
+private:
+	ThreadPolicy() = delete;
+};
+
+#endif  // THREADPOLICY_H_INCLUDED
@@ -0,0 +1,227 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "TraceRecorder.h"
+#include <atomic>
+
+namespace
+{
+	struct TraceEvent
+	{
+		const char* name;
+		int64 start;
+		int64 end;
+	};
+
+	struct ThreadBuffer
+	{
+		String threadName;
+		int threadIndex;
+		HeapBlock<TraceEvent> events;
+		std::atomic<uint64> numWritten;
+		std::atomic<bool> inUse;
+	};
+
+	struct TraceState
+	{
+		CriticalSection lock;
+		OwnedArray<ThreadBuffer> buffers;
+		StringArray names;
+		int numThreads{ 0 };
+	};
+
+	std::atomic<bool> tracingEnabled(false);
+
+	// Never deleted: threads may still be finishing their last scope while the
+	// application exits
+	TraceState& getState()
+	{
+		static TraceState* state = new TraceState();
+		return *state;
+	}
+
+	/** Gives the buffer back for another thread when its thread exits */
+	struct BufferHolder
+	{
+		ThreadBuffer* buffer{ nullptr };
+
+		~BufferHolder()
+		{
+			if (buffer != nullptr)
+				buffer->inUse = false;
+		}
+	};
+
+	thread_local BufferHolder currentBuffer;
+
+	String getCurrentThreadName()
+	{
+		if (Thread* thread = Thread::getCurrentThread())
+			return thread->getThreadName();
+
+		MessageManager* mm = MessageManager::getInstanceWithoutCreating();
+		if (mm != nullptr && mm->isThisTheMessageThread())
+			return "Message thread";
+
+		// the audio device's callback thread is the main one that JUCE did not start
+		return "Audio thread";
+	}
+
+	ThreadBuffer* acquireBuffer()
+	{
+		TraceState& state = getState();
+		const ScopedLock sl(state.lock);
+
+		ThreadBuffer* buffer = nullptr;
+		for (int i = 0; i < state.buffers.size() && buffer == nullptr; i++)
+		{
+			if (!state.buffers[i]->inUse)
+				buffer = state.buffers[i];
+		}
+		if (buffer == nullptr)
+		{
+			buffer = state.buffers.add(new ThreadBuffer());
+			buffer->events.allocate(TraceRecorder::eventsPerThread, false);
+		}
+
+		buffer->threadName = getCurrentThreadName();
+		buffer->threadIndex = ++state.numThreads;
+		buffer->numWritten = 0;
+		buffer->inUse = true;
+		currentBuffer.buffer = buffer;
+		return buffer;
+	}
+
+	String escapeJson(const String& text)
+	{
+		return text.replace("\\", "\\\\").replace("\"", "\\\"");
+	}
+}
+
+void TraceRecorder::setEnabled(bool enabled)
+{
+	tracingEnabled = enabled;
+}
+
+bool TraceRecorder::isEnabled()
+{
+	return tracingEnabled.load(std::memory_order_relaxed);
+}
+
+void TraceRecorder::addEvent(const char* name, int64 startTicks, int64 endTicks)
+{
+	ThreadBuffer* buffer = currentBuffer.buffer;
+	if (buffer == nullptr)
+		buffer = acquireBuffer();
+
+	const uint64 n = buffer->numWritten.load(std::memory_order_relaxed);
+	TraceEvent& event = buffer->events[n % eventsPerThread];
+	event.name = name;
+	event.start = startTicks;
+	event.end = endTicks;
+	buffer->numWritten.store(n + 1, std::memory_order_release);
+}
+
+const char* TraceRecorder::getPooledName(const String& name)
+{
+	TraceState& state = getState();
+	const ScopedLock sl(state.lock);
+
+	int index = state.names.indexOf(name);
+	if (index < 0)
+	{
+		index = state.names.size();
+		state.names.add(name);
+	}
+	// the text of a String never moves, and names are never removed
+	return state.names[index].toRawUTF8();
+}
+
+bool TraceRecorder::writeChromeTrace(const File& file)
+{
+	TraceState& state = getState();
+
+	struct ThreadEvents
+	{
+		String name;
+		int index;
+		Array<TraceEvent> events;
+	};
+	OwnedArray<ThreadEvents> threads;
+	int64 firstTicks = 0;
+
+	{
+		const ScopedLock sl(state.lock);
+		for (int i = 0; i < state.buffers.size(); i++)
+		{
+			const ThreadBuffer* buffer = state.buffers[i];
+			const uint64 end = buffer->numWritten.load(std::memory_order_acquire);
+			const uint64 begin = end > eventsPerThread ? end - eventsPerThread : 0;
+
+			ThreadEvents* thread = threads.add(new ThreadEvents());
+			thread->name = buffer->threadName;
+			thread->index = buffer->threadIndex;
+			for (uint64 n = begin; n < end; n++)
+				thread->events.add(buffer->events[n % eventsPerThread]);
+
+			// drop whatever the thread overwrote while it was being copied
+			const uint64 written = buffer->numWritten.load(std::memory_order_acquire);
+			const uint64 firstValid = written > eventsPerThread ? written - eventsPerThread : 0;
+			if (firstValid > begin)
+				thread->events.removeRange(0, int(jmin(firstValid - begin, uint64(thread->events.size()))));
+
+			for (const TraceEvent& event : thread->events)
+			{
+				if (firstTicks == 0 || event.start < firstTicks)
+					firstTicks = event.start;
+			}
+		}
+	}
+
+	FileOutputStream out(file);
+	if (out.failedToOpen())
+		return false;
+	out.setPosition(0);
+	out.truncate();
+
+	const double microsecondsPerTick = 1e6 / double(Time::getHighResolutionTicksPerSecond());
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+	for (const ThreadEvents* thread : threads)
+	{
+		out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->index
+			<< ",\"args\":{\"name\":\"" << escapeJson(thread->name) << "\"}}";
+		first = false;
+
+		for (const TraceEvent& event : thread->events)
+		{
+			out << ",\n{\"name\":\"" << escapeJson(event.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->index
+				<< ",\"ts\":" << String((event.start - firstTicks) * microsecondsPerTick, 3)
+				<< ",\"dur\":" << String((event.end - event.start) * microsecondsPerTick, 3) << "}";
+		}
+	}
+	out << "\n]}\n";
+	out.flush();
+
+	return out.getStatus().wasOk();
+}
@@ -0,0 +1,90 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef TRACERECORDER_H_INCLUDED
+#define TRACERECORDER_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "../PluginManager/OpenEphysPlugin.h"
+
+/**
+	Keeps a timeline of what the real-time threads were doing, for post-mortems.
+
+	Code marks the sections worth seeing with a TraceRecorder::Scope. While tracing
+	is enabled, each scope adds one event to a ring buffer owned by the calling
+	thread, holding its last eventsPerThread events; writing one is a couple of
+	stores and takes no lock. While disabled, a scope only loads a flag.
+
+	writeChromeTrace() dumps every thread's buffer as a Chrome trace, which can be
+	opened in chrome://tracing or Perfetto. Threads that have exited keep their
+	events until a new thread takes over their buffer.
+
+	Event names must outlive the trace: pass string literals, or names returned by
+	getPooledName().
+
+	@see ProcessorGraph, GenericProcessor
+*/
+class PLUGIN_API TraceRecorder
+{
+public:
+	class PLUGIN_API Scope
+	{
+	public:
+		explicit Scope(const char* name)
+			: m_name(name), m_start(isEnabled() ? Time::getHighResolutionTicks() : 0)
+		{}
+
+		~Scope()
+		{
+			if (m_start != 0)
+				addEvent(m_name, m_start, Time::getHighResolutionTicks());
+		}
+
+	private:
+		const char* m_name;
+		const int64 m_start;
+
+		JUCE_DECLARE_NON_COPYABLE(Scope);
+	};
+
+	static void setEnabled(bool enabled);
+	static bool isEnabled();
+
+	/** Records a section of the calling thread, in high resolution ticks */
+	static void addEvent(const char* name, int64 startTicks, int64 endTicks);
+
+	/** Returns a copy of the name that stays valid for the lifetime of the application.
+	Takes a lock, so call it when setting up rather than from a real-time thread. */
+	static const char* getPooledName(const String& name);
+
+	/** Writes the events of every thread as Chrome trace JSON. Returns false if the file
+	could not be written. Can be called while tracing. */
+	static bool writeChromeTrace(const File& file);
+
+	static const int eventsPerThread = 16384;
+
+private:
+	TraceRecorder() = delete;
+};
+
+#endif  // TRACERECORDER_H_INCLUDED
@@ -214,6 +214,14 @@ void Merger::addSettingsFromSourceNode(GenericProcessor* sn)
 
 }
 
+Array<GenericProcessor*> Merger::getSettingsSources() const
+{
+    Array<GenericProcessor*> sources;
+    sources.add(sourceNodeA);
+    sources.add(sourceNodeB);
+    return sources;
+}
+
 void Merger::updateSettings()
 {
 
@@ -65,6 +65,7 @@ public:
     void setMergerSourceNode(GenericProcessor* sn) override;
 
     void updateSettings() override;
+    Array<GenericProcessor*> getSettingsSources() const override;
     void addSettingsFromSourceNode(GenericProcessor* sn);
 
     bool stillHasSource() const override;
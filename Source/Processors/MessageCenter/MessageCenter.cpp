@@ -26,10 +26,12 @@
 #include "../ProcessorGraph/ProcessorGraph.h"
 #include "../../AccessClass.h"
 #define MAX_MSG_LENGTH 512
+#define MAX_QUEUED_MSGS 256
 //---------------------------------------------------------------------
 
 MessageCenter::MessageCenter() :
-GenericProcessor("Message Center"), newEventAvailable(false), isRecording(false)
+GenericProcessor("Message Center"), isRecording(false), needsToSendTimestampMessage(false),
+messageQueue(MAX_QUEUED_MSGS, MAX_MSG_LENGTH)
 {
 
     setPlayConfigDetails(0, // number of inputs
@@ -65,9 +67,8 @@ AudioProcessorEditor* MessageCenter::createEditor()
 
 void MessageCenter::setParameter(int parameterIndex, float newValue)
 {
-    if (isRecording)
+    if (isRecording && postMessage(messageCenterEditor->getLabelString()))
     {
-        newEventAvailable = true;
         messageCenterEditor->messageReceived(true);
     }
     else
@@ -77,6 +78,14 @@ void MessageCenter::setParameter(int parameterIndex, float newValue)
 
 }
 
+bool MessageCenter::postMessage(const String& text, juce::int64 timestamp)
+{
+    if (!isRecording)
+        return false;
+
+    return messageQueue.post(text, timestamp);
+}
+
 bool MessageCenter::enable()
 {
     messageCenterEditor->startAcquisition();
@@ -103,18 +112,52 @@ void MessageCenter::process(AudioSampleBuffer& buffer)
         needsToSendTimestampMessage = false;
     }
 
-    if (newEventAvailable)
+    // The reports below are formatted into this buffer and written straight into the
+    // event buffer, so that nothing is allocated on the audio thread
+    char report[MAX_MSG_LENGTH];
+
+    // Callbacks that overran their buffer duration, so that a recording can show afterwards
+    // whether the chain kept up. Misses from outside a recording are only counted.
+    ProcessorGraph::DeadlineMiss miss;
+    while (AccessClass::getProcessorGraph()->getNextDeadlineMiss(miss))
     {
-        //int numBytes = 0;
+        if (!isRecording)
+            continue;
 
-        String eventString = messageCenterEditor->getLabelString();
+        int length = snprintf(report, MAX_MSG_LENGTH, "Deadline miss: callback took %.3f ms of %.3f ms",
+            miss.elapsedMs, miss.budgetMs);
+        if (miss.slowestProcessor != nullptr && length >= 0 && length < MAX_MSG_LENGTH)
+            length += snprintf(report + length, MAX_MSG_LENGTH - length, ", slowest was %s (%d) at %.3f ms",
+                miss.slowestProcessor->getName().toRawUTF8(), miss.slowestProcessor->getNodeId(), miss.slowestMs);
 
-		eventString = eventString.dropLastCharacters(eventString.length() - MAX_MSG_LENGTH);
+        addTextEvent(getEventChannel(0), miss.timestamp, report, jlimit(0, MAX_MSG_LENGTH - 1, length), 0);
+    }
 
-		TextEventPtr event = TextEvent::createTextEvent(getEventChannel(0), CoreServices::getGlobalTimestamp(), eventString);
-		addEvent(getEventChannel(0), event, 0);
+    // Sync pulses paired with the global timestamp source. Together they form the table
+    // that maps every device's timestamps onto the master clock.
+    ClockSync::SyncPoint point;
+    while (AccessClass::getProcessorGraph()->getClockSync().getNextSyncPoint(point))
+    {
+        if (!isRecording)
+            continue;
+
+        const int length = snprintf(report, MAX_MSG_LENGTH, "Clock sync: source %d.%d timestamp %lld master %lld slope %.9f residual %.2f",
+            int(GenericProcessor::getNodeIdFromFullId(point.sourceFullId)),
+            int(GenericProcessor::getSubProcessorFromFullId(point.sourceFullId)),
+            (long long) point.sourceTimestamp, (long long) point.masterTimestamp, point.slope, point.lastResidual);
 
-        newEventAvailable = false;
+        addTextEvent(getEventChannel(0), point.masterTimestamp, report, jlimit(0, MAX_MSG_LENGTH - 1, length), 0);
+    }
+
+    // Messages posted from the UI or other threads, already copied into the queue's slots
+    const char* text;
+    int numBytes;
+    juce::int64 timestamp;
+    while (messageQueue.startRead(text, numBytes, timestamp))
+    {
+        if (isRecording)
+            addTextEvent(getEventChannel(0), timestamp < 0 ? CoreServices::getGlobalTimestamp() : timestamp, text, numBytes, 0);
+        messageQueue.finishedRead();
     }
 
 
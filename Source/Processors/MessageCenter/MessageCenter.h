@@ -29,6 +29,7 @@
 #include <stdio.h>
 
 #include "../GenericProcessor/GenericProcessor.h"
+#include "TextMessageQueue.h"
 
 class MessageCenterEditor;
 
@@ -55,6 +56,11 @@ public:
     /** Called when new events arrive. */
     void setParameter(int parameterIndex, float newValue) override;
 
+    /** Queues a message to be sent as a text event on the next block. Can be called
+    from any thread. A negative timestamp stamps the message when it is sent.
+    Returns false if the message was not queued. */
+    bool postMessage(const String& text, juce::int64 timestamp = -1);
+
     /** Creates the MessageCenterEditor (located in the UI component). */
     AudioProcessorEditor* createEditor() override;
 
@@ -78,10 +84,11 @@ public:
 	void addSpecialProcessorChannels(Array<EventChannel*>& channel);
 private:
 
-    bool newEventAvailable;
     bool isRecording;
     bool needsToSendTimestampMessage;
 
+    TextMessageQueue messageQueue;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MessageCenter);
 
 };
@@ -0,0 +1,103 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "TextMessageQueue.h"
+
+// Each slot carries a sequence number saying whose turn it is: equal to the position of the
+// next write into it when free, position + 1 once written, and position + numSlots when read.
+// Producers claim a position with a compare-and-swap and publish the slot by setting its
+// sequence, so the reader never sees a half written message.
+
+TextMessageQueue::TextMessageQueue(int numSlots, int maxBytes)
+	: m_numSlots(nextPowerOfTwo(jmax(numSlots, 2))),
+	m_mask(m_numSlots - 1),
+	m_maxBytes(jmax(maxBytes, 1)),
+	m_writePos(0),
+	m_readPos(0),
+	m_numDropped(0)
+{
+	m_slots.calloc(m_numSlots);
+	m_text.calloc(m_numSlots * (m_maxBytes + 1));
+	for (size_t i = 0; i < m_numSlots; ++i)
+		m_slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+TextMessageQueue::~TextMessageQueue()
+{
+}
+
+bool TextMessageQueue::post(const String& text, juce::int64 timestamp)
+{
+	size_t pos = m_writePos.load(std::memory_order_relaxed);
+	Slot* slot;
+	for (;;)
+	{
+		slot = &m_slots[pos & m_mask];
+		size_t seq = slot->sequence.load(std::memory_order_acquire);
+		intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+		if (diff == 0)
+		{
+			if (m_writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+		{
+			m_numDropped++;
+			return false;
+		}
+		else
+			pos = m_writePos.load(std::memory_order_relaxed);
+	}
+
+	char* dest = m_text + (pos & m_mask) * (m_maxBytes + 1);
+	// copyToUTF8 counts the terminating null and never splits a character
+	size_t written = text.copyToUTF8(dest, m_maxBytes + 1);
+	slot->numBytes = written > 0 ? int(written - 1) : 0;
+	slot->timestamp = timestamp;
+	slot->sequence.store(pos + 1, std::memory_order_release);
+	return true;
+}
+
+bool TextMessageQueue::startRead(const char*& text, int& numBytes, juce::int64& timestamp)
+{
+	Slot& slot = m_slots[m_readPos & m_mask];
+	if (slot.sequence.load(std::memory_order_acquire) != m_readPos + 1)
+		return false;
+
+	text = m_text + (m_readPos & m_mask) * (m_maxBytes + 1);
+	numBytes = slot.numBytes;
+	timestamp = slot.timestamp;
+	return true;
+}
+
+void TextMessageQueue::finishedRead()
+{
+	Slot& slot = m_slots[m_readPos & m_mask];
+	slot.sequence.store(m_readPos + m_numSlots, std::memory_order_release);
+	m_readPos++;
+}
+
+int64 TextMessageQueue::getNumDropped() const
+{
+	return m_numDropped.load();
+}
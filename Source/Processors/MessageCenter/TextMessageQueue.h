@@ -0,0 +1,85 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef TEXTMESSAGEQUEUE_H_INCLUDED
+#define TEXTMESSAGEQUEUE_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include <atomic>
+
+/**
+	Bounded queue of text messages waiting to be sent as events.
+
+	Any number of threads (the message thread, network control...) can post
+	messages, and a single consumer, usually the audio thread, reads them. All
+	storage is allocated up front: each slot holds up to maxBytes of UTF-8 text,
+	longer messages are truncated at a character boundary. Neither side takes a
+	lock or allocates, and a post to a full queue is dropped and counted.
+
+	@see MessageCenter
+*/
+class TextMessageQueue
+{
+public:
+	/** numSlots is rounded up to a power of two */
+	TextMessageQueue(int numSlots, int maxBytes);
+	~TextMessageQueue();
+
+	/** Copies the text into a free slot. A negative timestamp leaves it to the consumer
+	to stamp the message when it is read. Can be called from any thread. Returns false
+	if the queue was full. */
+	bool post(const String& text, juce::int64 timestamp = -1);
+
+	/** Gets the oldest message, if any. The text is not null terminated and stays valid
+	until finishedRead() is called. Only one thread can read. */
+	bool startRead(const char*& text, int& numBytes, juce::int64& timestamp);
+
+	/** Frees the slot of the message got from the last successful startRead() */
+	void finishedRead();
+
+	/** Returns the number of messages dropped because the queue was full */
+	int64 getNumDropped() const;
+
+private:
+	struct Slot
+	{
+		std::atomic<size_t> sequence;
+		juce::int64 timestamp;
+		int numBytes;
+	};
+
+	const size_t m_numSlots;
+	const size_t m_mask;
+	const int m_maxBytes;
+
+	HeapBlock<Slot> m_slots;
+	HeapBlock<char> m_text;
+
+	std::atomic<size_t> m_writePos;
+	size_t m_readPos;
+	std::atomic<int64> m_numDropped;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TextMessageQueue);
+};
+
+#endif  // TEXTMESSAGEQUEUE_H_INCLUDED
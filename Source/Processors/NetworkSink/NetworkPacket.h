@@ -0,0 +1,80 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef NETWORKPACKET_H_INCLUDED
+#define NETWORKPACKET_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+
+// "OEND" in a little-endian uint32
+#define NETWORK_PACKET_MAGIC 0x444E454F
+#define NETWORK_PACKET_VERSION 1
+
+// Largest payload of a UDP datagram
+#define MAX_PACKET_BYTES 65507
+
+/**
+    Datagram format of the network streams sent by the NetworkSink and received by
+    the Network Source plugin, so that GUI instances can be chained across machines.
+
+    Every datagram starts with a Header, all fields little-endian.
+
+    Sample packets follow it with numSamples frames of numChannels samples each,
+    interleaved (first frame channel 0, first frame channel 1, ...), as int16 or
+    float32 depending on format. int16 samples are scaled by a bit volts value both
+    ends agree on; float32 samples are microvolts. sampleIndex is the timestamp of
+    the first frame and increases by numSamples from one packet to the next.
+
+    Event packets carry numSamples events, each as a uint16 byte count followed by
+    the serialized event, as laid out by the Event and SpikeEvent classes. numChannels
+    and sampleIndex are 0, events carry their own timestamps.
+
+    timestamp is the sender's clock in microseconds, only kept for reference.
+
+    @see NetworkSink
+*/
+namespace NetworkPacket
+{
+    enum Format
+    {
+        INT16_SAMPLES = 0,
+        FLOAT32_SAMPLES = 1,
+        EVENTS = 2
+    };
+
+    struct Header
+    {
+        uint32 magic;         // NETWORK_PACKET_MAGIC
+        uint16 version;       // NETWORK_PACKET_VERSION
+        uint16 format;        // Format
+        uint16 numChannels;
+        uint16 numSamples;
+        uint32 reserved;      // 0
+        int64 sampleIndex;
+        int64 timestamp;
+    };
+
+    static_assert (sizeof (Header) == 32, "network packet header must stay 32 bytes");
+}
+
+#endif  // NETWORKPACKET_H_INCLUDED
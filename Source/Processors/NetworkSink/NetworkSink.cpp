@@ -0,0 +1,388 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "NetworkSink.h"
+#include "NetworkSinkEditor.h"
+#include "../DataThreads/SampleConversion.h"
+
+class NetworkSink::SenderThread : public Thread
+{
+public:
+    SenderThread (NetworkSink* owner_)
+        : Thread ("Network sink"), owner (owner_), socket (false)
+    {}
+
+    void run() override
+    {
+        // the slots still queued when acquisition stops are sent before exiting
+        while (true)
+        {
+            const int64 read = owner->readIndex.load (std::memory_order_relaxed);
+
+            if (read == owner->writeIndex.load (std::memory_order_acquire))
+            {
+                if (threadShouldExit())
+                    break;
+
+                dataReady.wait (10);
+                continue;
+            }
+
+            const int slot = int (read % NUM_PACKET_SLOTS);
+
+            // blocks while the socket buffer is full, then the slots fill up and new packets are dropped
+            if (socket.write (owner->host, owner->port, owner->slots + size_t (slot) * MAX_PACKET_BYTES, owner->slotSizes[slot]) < 0)
+                owner->numSendErrors++;
+            else
+                owner->numPacketsSent++;
+
+            owner->readIndex.store (read + 1, std::memory_order_release);
+        }
+    }
+
+    NetworkSink* const owner;
+    DatagramSocket socket;
+    WaitableEvent dataReady;
+};
+
+
+NetworkSink::NetworkSink()
+    : GenericProcessor ("Network Sink"),
+      transport (UDP_TRANSPORT), host ("127.0.0.1"), port (5000), ringName ("open-ephys"), ringSeconds (2.0f), format (NetworkPacket::FLOAT32_SAMPLES),
+      framesPerPacket (64), bitVolts (0.195f), maxFrames (64),
+      dataFrames (0), dataSampleIndex (0), eventBytes (0), numEvents (0),
+      writeIndex (0), readIndex (0),
+      numPacketsSent (0), numPacketsDropped (0), numSendErrors (0)
+{
+    setProcessorType (PROCESSOR_TYPE_SINK);
+
+    dataPayload.malloc (MAX_PACKET_BYTES);
+    eventPayload.malloc (MAX_PACKET_BYTES);
+}
+
+NetworkSink::~NetworkSink()
+{
+}
+
+AudioProcessorEditor* NetworkSink::createEditor()
+{
+    editor = new NetworkSinkEditor (this);
+    return editor;
+}
+
+void NetworkSink::setTransport (Transport transport_)
+{
+    if (transport_ == UDP_TRANSPORT || transport_ == SHARED_MEMORY_TRANSPORT)
+        transport = transport_;
+}
+
+NetworkSink::Transport NetworkSink::getTransport() const
+{
+    return transport;
+}
+
+void NetworkSink::setRing (const String& name, float seconds)
+{
+    if (File::createLegalFileName (name.trim()).isNotEmpty())
+        ringName = File::createLegalFileName (name.trim());
+    if (seconds > 0)
+        ringSeconds = seconds;
+}
+
+String NetworkSink::getRingName() const
+{
+    return ringName;
+}
+
+float NetworkSink::getRingSeconds() const
+{
+    return ringSeconds;
+}
+
+void NetworkSink::setDestination (const String& host_, int port_)
+{
+    host = host_.trim();
+    port = jlimit (1, 65535, port_);
+}
+
+String NetworkSink::getHost() const
+{
+    return host;
+}
+
+int NetworkSink::getPort() const
+{
+    return port;
+}
+
+void NetworkSink::setFormat (NetworkPacket::Format format_)
+{
+    if (format_ == NetworkPacket::INT16_SAMPLES || format_ == NetworkPacket::FLOAT32_SAMPLES)
+        format = format_;
+}
+
+NetworkPacket::Format NetworkSink::getFormat() const
+{
+    return format;
+}
+
+void NetworkSink::setFramesPerPacket (int numFrames)
+{
+    framesPerPacket = jlimit (1, 65535, numFrames);
+}
+
+int NetworkSink::getFramesPerPacket() const
+{
+    return framesPerPacket;
+}
+
+void NetworkSink::setBitVolts (float bitVolts_)
+{
+    if (bitVolts_ > 0)
+        bitVolts = bitVolts_;
+}
+
+float NetworkSink::getBitVolts() const
+{
+    return bitVolts;
+}
+
+NetworkSink::Stats NetworkSink::getStats() const
+{
+    Stats stats;
+    stats.numPacketsSent = numPacketsSent;
+    stats.numPacketsDropped = numPacketsDropped;
+    stats.numSendErrors = numSendErrors;
+    return stats;
+}
+
+bool NetworkSink::enable()
+{
+    channels = getEditor()->getActiveChannels();
+
+    if (transport == SHARED_MEMORY_TRANSPORT)
+    {
+        const float sampleRate = channels.size() > 0 ? getDataChannel (channels[0])->getSampleRate() : getDefaultSampleRate();
+        if (!ring.open (ringName, channels.size(), int (ceil (ringSeconds * sampleRate)), sampleRate))
+            return false;
+
+        std::cout << "Network sink writing " << channels.size() << " channels to " << ring.getFile().getFullPathName() << std::endl;
+        return true;
+    }
+
+    const int sampleBytes = format == NetworkPacket::INT16_SAMPLES ? 2 : 4;
+    const int payloadBytes = MAX_PACKET_BYTES - int (sizeof (NetworkPacket::Header));
+
+    if (channels.size() * sampleBytes > payloadBytes)
+    {
+        std::cerr << "Network sink: " << channels.size() << " channels don't fit in a packet, sending the first "
+                  << payloadBytes / sampleBytes << std::endl;
+        channels.removeRange (payloadBytes / sampleBytes, channels.size());
+    }
+
+    maxFrames = channels.size() > 0 ? jmin (framesPerPacket, payloadBytes / (channels.size() * sampleBytes)) : framesPerPacket;
+
+    if (slots.getData() == nullptr)
+        slots.malloc (size_t (NUM_PACKET_SLOTS) * MAX_PACKET_BYTES);
+
+    dataFrames = 0;
+    eventBytes = 0;
+    numEvents = 0;
+    writeIndex = 0;
+    readIndex = 0;
+    numPacketsSent = 0;
+    numPacketsDropped = 0;
+    numSendErrors = 0;
+
+    std::cout << "Network sink sending " << channels.size() << " channels to " << host << ":" << port
+              << " in packets of " << maxFrames << " frames." << std::endl;
+
+    sender = new SenderThread (this);
+    sender->startThread();
+
+    return true;
+}
+
+bool NetworkSink::disable()
+{
+    if (ring.isOpen())
+    {
+        ring.close();
+        return true;
+    }
+
+    if (dataFrames > 0)
+        sendDataPacket();
+
+    if (sender != nullptr)
+    {
+        sender->signalThreadShouldExit();
+        sender->dataReady.signal();
+        sender->waitForThreadToExit (1000);
+        sender = nullptr;
+    }
+
+    Stats stats = getStats();
+    std::cout << "Network sink sent " << stats.numPacketsSent << " packets, dropped " << stats.numPacketsDropped
+              << ", " << stats.numSendErrors << " send errors." << std::endl;
+
+    return true;
+}
+
+bool NetworkSink::queuePacket (NetworkPacket::Format packetFormat, int numChannels, int numSamples,
+                               int64 sampleIndex, const char* payload, int numBytes)
+{
+    const int64 write = writeIndex.load (std::memory_order_relaxed);
+
+    if (write - readIndex.load (std::memory_order_acquire) >= NUM_PACKET_SLOTS)
+    {
+        numPacketsDropped++;
+        return false;
+    }
+
+    const int slot = int (write % NUM_PACKET_SLOTS);
+    char* packet = slots + size_t (slot) * MAX_PACKET_BYTES;
+
+    NetworkPacket::Header header;
+    header.magic = NETWORK_PACKET_MAGIC;
+    header.version = NETWORK_PACKET_VERSION;
+    header.format = uint16 (packetFormat);
+    header.numChannels = uint16 (numChannels);
+    header.numSamples = uint16 (numSamples);
+    header.reserved = 0;
+    header.sampleIndex = sampleIndex;
+    header.timestamp = int64 (Time::getMillisecondCounterHiRes() * 1000.0);
+
+    memcpy (packet, &header, sizeof (header));
+    memcpy (packet + sizeof (header), payload, numBytes);
+    slotSizes[slot] = int (sizeof (header)) + numBytes;
+
+    writeIndex.store (write + 1, std::memory_order_release);
+    sender->dataReady.signal();
+
+    return true;
+}
+
+void NetworkSink::sendDataPacket()
+{
+    const int sampleBytes = format == NetworkPacket::INT16_SAMPLES ? 2 : 4;
+
+    queuePacket (format, channels.size(), dataFrames, dataSampleIndex,
+                 dataPayload, dataFrames * channels.size() * sampleBytes);
+    dataFrames = 0;
+}
+
+void NetworkSink::sendEventPacket()
+{
+    if (numEvents == 0)
+        return;
+
+    queuePacket (NetworkPacket::EVENTS, 0, numEvents, 0, eventPayload, eventBytes);
+    numEvents = 0;
+    eventBytes = 0;
+}
+
+void NetworkSink::addEventToPacket (const MidiMessage& event)
+{
+    const int size = event.getRawDataSize();
+    const int payloadBytes = MAX_PACKET_BYTES - int (sizeof (NetworkPacket::Header));
+
+    if (size + 2 > payloadBytes)
+        return;
+
+    if (eventBytes + size + 2 > payloadBytes || numEvents == 65535)
+        sendEventPacket();
+
+    const uint16 numBytes = uint16 (size);
+    memcpy (eventPayload + eventBytes, &numBytes, 2);
+    memcpy (eventPayload + eventBytes + 2, event.getRawData(), size);
+    eventBytes += size + 2;
+    numEvents++;
+}
+
+void NetworkSink::handleEvent (const EventChannel* eventInfo, const MidiMessage& event, int samplePosition)
+{
+    addEventToPacket (event);
+}
+
+void NetworkSink::handleSpike (const SpikeChannel* spikeInfo, const MidiMessage& event, int samplePosition)
+{
+    addEventToPacket (event);
+}
+
+void NetworkSink::process (AudioSampleBuffer& buffer)
+{
+    if (ring.isOpen())
+    {
+        if (channels.size() > 0)
+            ring.write (buffer, channels, getNumSamples (channels[0]), getTimestamp (channels[0]));
+        return;
+    }
+
+    checkForEvents (true);
+    sendEventPacket();
+
+    const int numChans = channels.size();
+    if (numChans == 0)
+        return;
+
+    const int nSamples = getNumSamples (channels[0]);
+    const int64 timestamp = getTimestamp (channels[0]);
+    const int sampleBytes = format == NetworkPacket::INT16_SAMPLES ? 2 : 4;
+
+    // a packet holds consecutive samples only
+    if (dataFrames > 0 && dataSampleIndex + dataFrames != timestamp)
+        sendDataPacket();
+
+    int start = 0;
+    while (start < nSamples)
+    {
+        if (dataFrames == 0)
+            dataSampleIndex = timestamp + start;
+
+        const int numFrames = jmin (nSamples - start, maxFrames - dataFrames);
+        char* frames = dataPayload + dataFrames * numChans * sampleBytes;
+
+        for (int i = 0; i < numChans; i++)
+        {
+            const float* src = buffer.getReadPointer (channels[i], start);
+
+            if (format == NetworkPacket::INT16_SAMPLES)
+            {
+                SampleConversion::convertFloatToInt16 (reinterpret_cast<int16*> (frames) + i, numChans, src, numFrames, 1.0f / bitVolts);
+            }
+            else
+            {
+                float* dest = reinterpret_cast<float*> (frames) + i;
+                for (int k = 0; k < numFrames; k++)
+                    dest[k * numChans] = src[k];
+            }
+        }
+
+        dataFrames += numFrames;
+        start += numFrames;
+
+        if (dataFrames == maxFrames)
+            sendDataPacket();
+    }
+}
@@ -0,0 +1,161 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef NETWORKSINK_H_INCLUDED
+#define NETWORKSINK_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../GenericProcessor/GenericProcessor.h"
+#include "NetworkPacket.h"
+#include "SharedMemoryRing.h"
+#include <atomic>
+
+// Packets waiting for the sender thread
+#define NUM_PACKET_SLOTS 64
+
+/**
+    Streams the selected continuous channels, and all events and spikes, to another
+    machine over UDP, in the NetworkPacket format.
+
+    Samples are batched into packets of a set number of frames, across processing
+    blocks if needed. The packets are queued in preallocated slots and sent by a
+    separate thread, so the processing callbacks never wait on the network. When the
+    network can't keep up and the slots are full, new packets are dropped and counted.
+
+    The sink can instead write the continuous samples into a SharedMemoryRing, for
+    readers on the same machine. The samples are then copied once per block with
+    no packets or sender thread, and events are not sent.
+
+    The channels selected in the channel selector when acquisition starts are sent.
+    They must share a sample rate, the packets carry a single sample index.
+
+    @see NetworkPacket, GenericProcessor
+*/
+class NetworkSink : public GenericProcessor
+{
+public:
+    NetworkSink();
+    ~NetworkSink();
+
+    AudioProcessorEditor* createEditor() override;
+
+    void process (AudioSampleBuffer& buffer) override;
+    bool modifiesContinuousData() const override { return false; }
+    bool emitsEvents() const override { return false; }
+
+    bool enable() override;
+    bool disable() override;
+
+    enum Transport
+    {
+        UDP_TRANSPORT = 0,
+        SHARED_MEMORY_TRANSPORT = 1
+    };
+
+    void setTransport (Transport transport);
+    Transport getTransport() const;
+
+    /** Name of the shared memory ring file, and how many seconds of data it holds.*/
+    void setRing (const String& name, float seconds);
+    String getRingName() const;
+    float getRingSeconds() const;
+
+    /** Destination of the packets, a host name or address, or a multicast group.
+        Only changes while not acquiring, like the other settings.*/
+    void setDestination (const String& host, int port);
+    String getHost() const;
+    int getPort() const;
+
+    void setFormat (NetworkPacket::Format format);
+    NetworkPacket::Format getFormat() const;
+
+    /** Number of frames batched in a packet, lowered if needed for the packet to fit in a datagram.*/
+    void setFramesPerPacket (int numFrames);
+    int getFramesPerPacket() const;
+
+    /** Microvolts per bit of int16 samples.*/
+    void setBitVolts (float bitVolts);
+    float getBitVolts() const;
+
+    struct Stats
+    {
+        int64 numPacketsSent;
+        // packets that found no free slot
+        int64 numPacketsDropped;
+        int64 numSendErrors;
+    };
+    Stats getStats() const;
+
+private:
+    class SenderThread;
+
+    void handleEvent (const EventChannel* eventInfo, const MidiMessage& event, int samplePosition) override;
+    void handleSpike (const SpikeChannel* spikeInfo, const MidiMessage& event, int samplePosition) override;
+
+    /** Copies a packet into a free slot for the sender thread. Returns false, and counts
+        the packet as dropped, if all the slots are in use.*/
+    bool queuePacket (NetworkPacket::Format packetFormat, int numChannels, int numSamples,
+                      int64 sampleIndex, const char* payload, int numBytes);
+
+    void addEventToPacket (const MidiMessage& event);
+    void sendDataPacket();
+    void sendEventPacket();
+
+    Transport transport;
+    String host;
+    int port;
+    String ringName;
+    float ringSeconds;
+    SharedMemoryRing ring;
+    NetworkPacket::Format format;
+    int framesPerPacket;
+    float bitVolts;
+
+    // channels sent, in order, and the frames that fit in a packet with them
+    Array<int> channels;
+    int maxFrames;
+
+    // packets being filled, copied to a slot when they are complete
+    HeapBlock<char> dataPayload;
+    int dataFrames;
+    int64 dataSampleIndex;
+    HeapBlock<char> eventPayload;
+    int eventBytes;
+    int numEvents;
+
+    // single producer (the processing callbacks), single consumer (the sender thread)
+    HeapBlock<char> slots;
+    int slotSizes[NUM_PACKET_SLOTS];
+    std::atomic<int64> writeIndex;
+    std::atomic<int64> readIndex;
+
+    ScopedPointer<SenderThread> sender;
+
+    std::atomic<int64> numPacketsSent;
+    std::atomic<int64> numPacketsDropped;
+    std::atomic<int64> numSendErrors;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NetworkSink);
+};
+
+#endif  // NETWORKSINK_H_INCLUDED
@@ -0,0 +1,202 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "NetworkSinkEditor.h"
+#include "NetworkSink.h"
+
+NetworkSinkEditor::NetworkSinkEditor (GenericProcessor* parentNode)
+    : GenericEditor (parentNode, false), statusTimer (this)
+{
+    sink = static_cast<NetworkSink*> (parentNode);
+
+    desiredWidth = 180;
+
+    hostLabel = addSetting ("Host", sink->getHost(), 25);
+    portLabel = addSetting ("Port", String (sink->getPort()), 45);
+    framesLabel = addSetting ("Frames", String (sink->getFramesPerPacket()), 65);
+    framesLabel->setTooltip ("Samples per channel batched in a packet");
+
+    formatSelector = new ComboBox ("Format");
+    formatSelector->addItem ("float32", NetworkPacket::FLOAT32_SAMPLES + 1);
+    formatSelector->addItem ("int16", NetworkPacket::INT16_SAMPLES + 1);
+    formatSelector->setSelectedId (sink->getFormat() + 1, dontSendNotification);
+    formatSelector->setBounds (10, 85, 75, 18);
+    formatSelector->addListener (this);
+    addAndMakeVisible (formatSelector);
+
+    transportSelector = new ComboBox ("Transport");
+    transportSelector->addItem ("UDP", NetworkSink::UDP_TRANSPORT + 1);
+    transportSelector->addItem ("Shared mem.", NetworkSink::SHARED_MEMORY_TRANSPORT + 1);
+    transportSelector->setSelectedId (sink->getTransport() + 1, dontSendNotification);
+    transportSelector->setTooltip ("Shared memory writes the samples into a ring file that processes on this machine can map");
+    transportSelector->setBounds (95, 85, 75, 18);
+    transportSelector->addListener (this);
+    addAndMakeVisible (transportSelector);
+
+    statusLabel = new Label ("Status", String::empty);
+    statusLabel->setFont (Font ("Small Text", 10, Font::plain));
+    statusLabel->setBounds (10, 105, 160, 18);
+    statusLabel->setColour (Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible (statusLabel);
+
+    updateTransport();
+}
+
+NetworkSinkEditor::~NetworkSinkEditor()
+{
+}
+
+Label* NetworkSinkEditor::addSetting (const String& name, const String& value, int y)
+{
+    Label* title = new Label (name, name);
+    title->setFont (Font ("Small Text", 10, Font::plain));
+    title->setBounds (10, y, 60, 18);
+    title->setColour (Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible (title);
+    staticLabels.add (title);
+
+    Label* setting = new Label (name + " value", value);
+    setting->setFont (Font ("Small Text", 10, Font::plain));
+    setting->setEditable (true, false, false);
+    setting->addListener (this);
+    setting->setBounds (70, y, 100, 18);
+    setting->setColour (Label::textColourId, Colours::darkgrey);
+    setting->setColour (Label::backgroundColourId, Colours::lightgrey);
+    addAndMakeVisible (setting);
+    return setting;
+}
+
+void NetworkSinkEditor::labelTextChanged (Label* label)
+{
+    updateSettings();
+}
+
+void NetworkSinkEditor::comboBoxChanged (ComboBox* comboBox)
+{
+    if (comboBox == formatSelector)
+    {
+        sink->setFormat (NetworkPacket::Format (formatSelector->getSelectedId() - 1));
+    }
+    else if (comboBox == transportSelector)
+    {
+        sink->setTransport (NetworkSink::Transport (transportSelector->getSelectedId() - 1));
+        updateTransport();
+    }
+}
+
+void NetworkSinkEditor::updateTransport()
+{
+    const bool udp = sink->getTransport() == NetworkSink::UDP_TRANSPORT;
+
+    staticLabels[0]->setText (udp ? "Host" : "Name", dontSendNotification);
+    hostLabel->setText (udp ? sink->getHost() : sink->getRingName(), dontSendNotification);
+    hostLabel->setTooltip (udp ? "Host name, address or multicast group the packets are sent to"
+                               : "Name of the ring file, in /dev/shm on Linux and the temporary directory elsewhere");
+    portLabel->setEnabled (udp);
+    framesLabel->setEnabled (udp);
+    formatSelector->setEnabled (udp);
+}
+
+void NetworkSinkEditor::updateSettings()
+{
+    if (sink->getTransport() == NetworkSink::UDP_TRANSPORT)
+        sink->setDestination (hostLabel->getText(), portLabel->getText().getIntValue());
+    else
+        sink->setRing (hostLabel->getText(), sink->getRingSeconds());
+    sink->setFramesPerPacket (framesLabel->getText().getIntValue());
+
+    updateTransport();
+    portLabel->setText (String (sink->getPort()), dontSendNotification);
+    framesLabel->setText (String (sink->getFramesPerPacket()), dontSendNotification);
+}
+
+void NetworkSinkEditor::startAcquisition()
+{
+    hostLabel->setEnabled (false);
+    portLabel->setEnabled (false);
+    framesLabel->setEnabled (false);
+    formatSelector->setEnabled (false);
+    transportSelector->setEnabled (false);
+    statusTimer.startTimer (500);
+}
+
+void NetworkSinkEditor::stopAcquisition()
+{
+    statusTimer.stopTimer();
+    updateStatus();
+
+    hostLabel->setEnabled (true);
+    transportSelector->setEnabled (true);
+    updateTransport();
+}
+
+void NetworkSinkEditor::updateStatus()
+{
+    if (sink->getTransport() == NetworkSink::SHARED_MEMORY_TRANSPORT)
+    {
+        statusLabel->setText (String::empty, dontSendNotification);
+        return;
+    }
+
+    NetworkSink::Stats stats = sink->getStats();
+    statusLabel->setText ("Sent " + String (stats.numPacketsSent) + ", dropped " + String (stats.numPacketsDropped),
+                          dontSendNotification);
+}
+
+void NetworkSinkEditor::saveCustomParameters (XmlElement* xml)
+{
+    XmlElement* parameters = xml->createNewChildElement ("NETWORKSINK");
+
+    parameters->setAttribute ("host", sink->getHost());
+    parameters->setAttribute ("port", sink->getPort());
+    parameters->setAttribute ("framesPerPacket", sink->getFramesPerPacket());
+    parameters->setAttribute ("format", int (sink->getFormat()));
+    parameters->setAttribute ("bitVolts", sink->getBitVolts());
+    parameters->setAttribute ("transport", int (sink->getTransport()));
+    parameters->setAttribute ("ringName", sink->getRingName());
+    parameters->setAttribute ("ringSeconds", sink->getRingSeconds());
+}
+
+void NetworkSinkEditor::loadCustomParameters (XmlElement* xml)
+{
+    forEachXmlChildElement (*xml, subNode)
+    {
+        if (subNode->hasTagName ("NETWORKSINK"))
+        {
+            sink->setDestination (subNode->getStringAttribute ("host", sink->getHost()),
+                                  subNode->getIntAttribute ("port", sink->getPort()));
+            sink->setFramesPerPacket (subNode->getIntAttribute ("framesPerPacket", sink->getFramesPerPacket()));
+            sink->setFormat (NetworkPacket::Format (subNode->getIntAttribute ("format", sink->getFormat())));
+            sink->setBitVolts (float (subNode->getDoubleAttribute ("bitVolts", sink->getBitVolts())));
+            sink->setTransport (NetworkSink::Transport (subNode->getIntAttribute ("transport", sink->getTransport())));
+            sink->setRing (subNode->getStringAttribute ("ringName", sink->getRingName()),
+                           float (subNode->getDoubleAttribute ("ringSeconds", sink->getRingSeconds())));
+
+            transportSelector->setSelectedId (sink->getTransport() + 1, dontSendNotification);
+            updateTransport();
+            portLabel->setText (String (sink->getPort()), dontSendNotification);
+            framesLabel->setText (String (sink->getFramesPerPacket()), dontSendNotification);
+            formatSelector->setSelectedId (sink->getFormat() + 1, dontSendNotification);
+        }
+    }
+}
@@ -0,0 +1,92 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef NETWORKSINKEDITOR_H_INCLUDED
+#define NETWORKSINKEDITOR_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../Editors/GenericEditor.h"
+
+class NetworkSink;
+
+/**
+    User interface for the NetworkSink: destination, sample format and packet size,
+    and the packet counters while acquiring.
+
+    @see NetworkSink
+*/
+class NetworkSinkEditor : public GenericEditor,
+    public Label::Listener,
+    public ComboBox::Listener
+{
+public:
+    NetworkSinkEditor (GenericProcessor* parentNode);
+    ~NetworkSinkEditor();
+
+    void labelTextChanged (Label* label) override;
+    void comboBoxChanged (ComboBox* comboBox) override;
+
+    void startAcquisition() override;
+    void stopAcquisition() override;
+
+    void saveCustomParameters (XmlElement* xml) override;
+    void loadCustomParameters (XmlElement* xml) override;
+
+private:
+    // GenericEditor already uses its Timer
+    class StatusTimer : public Timer
+    {
+    public:
+        StatusTimer (NetworkSinkEditor* editor_) : editor (editor_) {}
+        void timerCallback() override { editor->updateStatus(); }
+
+    private:
+        NetworkSinkEditor* editor;
+    };
+
+    /** Shows the packet counters of the sink.*/
+    void updateStatus();
+
+    Label* addSetting (const String& name, const String& value, int y);
+
+    /** Reads the labels into the sink, then shows the values it accepted.*/
+    void updateSettings();
+
+    /** Shows the destination of the selected transport.*/
+    void updateTransport();
+
+    NetworkSink* sink;
+
+    OwnedArray<Label> staticLabels;
+    ScopedPointer<Label> hostLabel;
+    ScopedPointer<Label> portLabel;
+    ScopedPointer<Label> framesLabel;
+    ScopedPointer<ComboBox> formatSelector;
+    ScopedPointer<ComboBox> transportSelector;
+    ScopedPointer<Label> statusLabel;
+    StatusTimer statusTimer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NetworkSinkEditor);
+};
+
+#endif  // NETWORKSINKEDITOR_H_INCLUDED
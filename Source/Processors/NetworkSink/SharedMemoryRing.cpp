@@ -0,0 +1,146 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SharedMemoryRing.h"
+#include "../RecordNode/DataQueue.h"
+
+static_assert (sizeof (SharedMemoryRing::Header) == 64, "shared ring header must stay 64 bytes");
+
+SharedMemoryRing::SharedMemoryRing()
+    : header (nullptr), timestamps (nullptr), samples (nullptr),
+      numChannels (0), capacity (0), writeIndex (0)
+{
+}
+
+SharedMemoryRing::~SharedMemoryRing()
+{
+    close();
+}
+
+bool SharedMemoryRing::open (const String& name, int numChannels_, int capacity_, float sampleRate)
+{
+    close();
+
+    File shm ("/dev/shm");
+    file = (shm.isDirectory() ? shm : File::getSpecialLocation (File::tempDirectory)).getChildFile (name);
+
+    numChannels = numChannels_;
+    capacity = jmax (1, capacity_);
+
+    const int64 numBytes = int64 (sizeof (Header)) + int64 (capacity) * (sizeof (int64) + int64 (numChannels) * sizeof (float));
+
+    // size the file before mapping it, the unwritten pages stay sparse
+    file.deleteFile();
+    {
+        FileOutputStream stream (file);
+        if (stream.failedToOpen() || !stream.setPosition (numBytes - 1) || !stream.writeByte (0))
+        {
+            std::cerr << "Shared memory ring: could not create " << file.getFullPathName() << std::endl;
+            return false;
+        }
+    }
+
+    map = new MemoryMappedFile (file, MemoryMappedFile::readWrite);
+    if (map->getData() == nullptr || map->getSize() < size_t (numBytes))
+    {
+        std::cerr << "Shared memory ring: could not map " << file.getFullPathName() << std::endl;
+        map = nullptr;
+        return false;
+    }
+
+    char* base = static_cast<char*> (map->getData());
+    header = reinterpret_cast<Header*> (base);
+    timestamps = reinterpret_cast<int64*> (base + sizeof (Header));
+    samples = reinterpret_cast<float*> (timestamps + capacity);
+    writeIndex = 0;
+
+    zeromem (header, sizeof (Header));
+    header->version = SHARED_RING_VERSION;
+    header->headerBytes = uint16 (sizeof (Header));
+    header->numChannels = uint32 (numChannels);
+    header->capacity = uint32 (capacity);
+    header->sampleRate = sampleRate;
+    header->running = 1;
+
+    // readers check the magic last
+    std::atomic_thread_fence (std::memory_order_release);
+    header->magic = SHARED_RING_MAGIC;
+
+    return true;
+}
+
+void SharedMemoryRing::close()
+{
+    if (map == nullptr)
+        return;
+
+    header->running = 0;
+    map = nullptr;
+    header = nullptr;
+    timestamps = nullptr;
+    samples = nullptr;
+}
+
+bool SharedMemoryRing::isOpen() const
+{
+    return map != nullptr;
+}
+
+File SharedMemoryRing::getFile() const
+{
+    return file;
+}
+
+void SharedMemoryRing::write (const AudioSampleBuffer& buffer, const Array<int>& channels, int numSamples, int64 timestamp)
+{
+    // only the newest samples survive a block longer than the ring
+    const int skip = jmax (0, numSamples - capacity);
+    writeIndex += skip;
+    timestamp += skip;
+    numSamples -= skip;
+
+    CircularBufferIndexes idx;
+    idx.index1 = int (writeIndex % capacity);
+    idx.size1 = jmin (numSamples, capacity - idx.index1);
+    idx.index2 = 0;
+    idx.size2 = numSamples - idx.size1;
+
+    for (int i = 0; i < channels.size(); i++)
+    {
+        const float* src = buffer.getReadPointer (channels[i], skip);
+        float* dest = samples + size_t (i) * capacity;
+
+        memcpy (dest + idx.index1, src, idx.size1 * sizeof (float));
+        memcpy (dest + idx.index2, src + idx.size1, idx.size2 * sizeof (float));
+    }
+
+    for (int k = 0; k < idx.size1; k++)
+        timestamps[idx.index1 + k] = timestamp + k;
+    for (int k = 0; k < idx.size2; k++)
+        timestamps[idx.index2 + k] = timestamp + idx.size1 + k;
+
+    writeIndex += numSamples;
+
+    std::atomic_thread_fence (std::memory_order_release);
+    reinterpret_cast<std::atomic<int64>*> (&header->writeIndex)->store (writeIndex, std::memory_order_relaxed);
+}
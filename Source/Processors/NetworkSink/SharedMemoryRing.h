@@ -0,0 +1,99 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SHAREDMEMORYRING_H_INCLUDED
+#define SHAREDMEMORYRING_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include <atomic>
+
+// "OESM" in a little-endian uint32
+#define SHARED_RING_MAGIC 0x4D53454F
+#define SHARED_RING_VERSION 1
+
+/**
+    Multichannel ring buffer in a memory mapped file, so that other processes on the
+    same machine (Python, MATLAB...) can map it and read live data without copies.
+
+    The file is placed in /dev/shm on Linux, so it only lives in memory, and in the
+    temporary directory elsewhere. It holds a 64 byte Header, then capacity int64
+    timestamps, then one block of capacity float samples per channel, in microvolts.
+    Sample number n of the stream is at index n % capacity of each block.
+
+    writeIndex is the number of samples written since the ring was opened. It is
+    updated after the samples, so a reader can take the samples below writeIndex,
+    then read writeIndex again: samples at or below the new value minus capacity
+    may have been overwritten in the meantime.
+
+    @see NetworkSink
+*/
+class SharedMemoryRing
+{
+public:
+    struct Header
+    {
+        uint32 magic;          // SHARED_RING_MAGIC
+        uint16 version;        // SHARED_RING_VERSION
+        uint16 headerBytes;    // 64, the offset of the timestamps
+        uint32 numChannels;
+        uint32 capacity;       // samples per channel
+        float sampleRate;
+        uint32 running;        // 1 while acquisition is active
+        int64 writeIndex;
+        uint8 reserved[32];
+    };
+
+    SharedMemoryRing();
+    ~SharedMemoryRing();
+
+    /** Creates, or replaces, the ring file and maps it. Returns false if that failed.*/
+    bool open (const String& name, int numChannels, int capacity, float sampleRate);
+
+    /** Marks the ring as stopped and unmaps it. The file stays until the next open().*/
+    void close();
+
+    bool isOpen() const;
+
+    /** Returns the file a reader has to map.*/
+    File getFile() const;
+
+    /** Appends numSamples samples of the given channels of buffer, the first one with
+        the given timestamp, then publishes them by advancing writeIndex.*/
+    void write (const AudioSampleBuffer& buffer, const Array<int>& channels, int numSamples, int64 timestamp);
+
+private:
+    File file;
+    ScopedPointer<MemoryMappedFile> map;
+
+    Header* header;
+    int64* timestamps;
+    float* samples;
+
+    int numChannels;
+    int capacity;
+    int64 writeIndex;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SharedMemoryRing);
+};
+
+#endif  // SHAREDMEMORYRING_H_INCLUDED
@@ -0,0 +1,129 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __CHANNELPARAMETERBLOCK_H_7A1C03E2__
+#define __CHANNELPARAMETERBLOCK_H_7A1C03E2__
+
+#include <JuceHeader.h>
+
+/**
+    Holds the value of a per-channel setting for every channel, contiguously and with its
+    own type, for processors to read directly in process().
+
+    The message thread edits its own copy with set(), and publish() makes all the changes
+    made since the last call visible to the audio thread at once. The audio thread calls
+    acquire() once per block and reads the returned values for the rest of it, so it never
+    sees a half-applied batch and never waits for the message thread.
+
+    T must be a plain type such as float, int or bool. setNumChannels() must not be called
+    while acquisition is active.
+
+    @see GenericProcessor
+*/
+template <typename T>
+class ChannelParameterBlock
+{
+public:
+    ChannelParameterBlock() : numChannels (0), pendingUpdate (0) {}
+
+    /** Changes the number of channels, keeping the values of the ones that remain
+        and setting the new ones to defaultValue. Message thread only. */
+    void setNumChannels (int newNumChannels, T defaultValue)
+    {
+        const SpinLock::ScopedLockType sl (lock);
+
+        edited.realloc (newNumChannels);
+        shared.realloc (newNumChannels);
+        live.realloc (newNumChannels);
+
+        for (int i = numChannels; i < newNumChannels; ++i)
+            edited[i] = defaultValue;
+
+        numChannels = newNumChannels;
+        copyValues (shared, edited);
+        copyValues (live, edited);
+        pendingUpdate = 0;
+    }
+
+    int getNumChannels() const noexcept    { return numChannels; }
+
+    /** Returns the value last set from the message thread, published or not. */
+    T get (int channel) const noexcept
+    {
+        return isPositiveAndBelow (channel, numChannels) ? edited[channel] : T();
+    }
+
+    /** Changes the value of a channel, seen by process() after the next publish(). */
+    void set (int channel, T value) noexcept
+    {
+        if (isPositiveAndBelow (channel, numChannels))
+            edited[channel] = value;
+    }
+
+    /** Changes the value of several channels, seen by process() after the next publish(). */
+    void set (const Array<int>& channels, T value) noexcept
+    {
+        for (int i = 0; i < channels.size(); ++i)
+            set (channels[i], value);
+    }
+
+    /** Makes every value set since the last call visible to the audio thread. */
+    void publish()
+    {
+        const SpinLock::ScopedLockType sl (lock);
+        copyValues (shared, edited);
+        pendingUpdate = 1;
+    }
+
+    /** Returns the published values, numChannels of them, taking in the latest batch
+        if one is waiting and the message thread isn't publishing one right now. Audio thread only. */
+    const T* acquire() noexcept
+    {
+        if (pendingUpdate.get() != 0 && lock.tryEnter())
+        {
+            copyValues (live, shared);
+            pendingUpdate = 0;
+            lock.exit();
+        }
+        return live;
+    }
+
+private:
+    void copyValues (HeapBlock<T>& dest, const HeapBlock<T>& source) const noexcept
+    {
+        for (int i = 0; i < numChannels; ++i)
+            dest[i] = source[i];
+    }
+
+    HeapBlock<T> edited; // message thread
+    HeapBlock<T> shared; // guarded by lock
+    HeapBlock<T> live;   // audio thread
+    int numChannels;
+
+    SpinLock lock;
+    Atomic<int> pendingUpdate;
+
+    JUCE_DECLARE_NON_COPYABLE (ChannelParameterBlock)
+};
+
+
+#endif  // __CHANNELPARAMETERBLOCK_H_7A1C03E2__
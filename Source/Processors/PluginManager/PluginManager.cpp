@@ -70,7 +70,40 @@ static void errorMsg(const char *file, int line, const char *msg) {
 #define ERROR_MSG(msg) errorMsg(__FILE__, __LINE__, msg)
 
 
+namespace
+{
+	// The plugin metadata goes in the user's data folder, as the plugin folder might not be writable
+	File getPluginCacheFile()
+	{
+		return File::getSpecialLocation(File::userApplicationDataDirectory)
+			.getChildFile("open-ephys").getChildFile("PluginCache.xml");
+	}
+
+	// Size and modification time, as hashing every library would read them all at startup
+	String getFileStamp(const File& file)
+	{
+		int64 size = 0;
+		int64 modified = 0;
+
+		Array<File> files;
+		if (file.isDirectory()) // OS X bundles
+			file.findChildFiles(files, File::findFiles, true);
+		else
+			files.add(file);
+
+		for (int i = 0; i < files.size(); i++)
+		{
+			size += files[i].getSize();
+			modified = jmax(modified, files[i].getLastModificationTime().toMilliseconds());
+		}
+
+		return String(size) + "_" + String(modified);
+	}
+}
+
+
 PluginManager::PluginManager()
+	: pluginCacheChanged(false)
 {
 #ifdef WIN32
 	File sharedPath = File::getSpecialLocation(File::currentApplicationFile).getParentDirectory().getChildFile("shared");
@@ -94,6 +127,10 @@ void PluginManager::loadAllPlugins()
 	paths.add(File::getSpecialLocation(File::currentApplicationFile).getParentDirectory().getChildFile("plugins"));
 #endif
 
+    pluginCache = XmlDocument::parse(getPluginCacheFile());
+    if (pluginCache != nullptr && pluginCache->getIntAttribute("apiVersion") != PLUGIN_API_VER)
+        pluginCache = nullptr;
+
     for (auto &pluginPath : paths) {
         if (!pluginPath.isDirectory()) {
             std::cout << "Plugin path not found: " << pluginPath.getFullPathName() << std::endl;
@@ -101,6 +138,12 @@ void PluginManager::loadAllPlugins()
             loadPlugins(pluginPath);
         }
     }
+
+    // libraries that were removed also change the cache
+    if (pluginCacheChanged || pluginCache == nullptr || pluginCache->getNumChildElements() != libArray.size())
+        savePluginCache();
+
+    pluginCache = nullptr;
 }
 
 void PluginManager::loadPlugins(const File &pluginPath) {
@@ -123,7 +166,19 @@ void PluginManager::loadPlugins(const File &pluginPath) {
 	for (int i = 0; i < foundDLLs.size(); i++)
 	{
 		std::cout << "Loading Plugin: " << foundDLLs[i].getFileNameWithoutExtension() << "... " << std::flush;
-		int res = loadPlugin(foundDLLs[i].getFullPathName());
+
+		const String path = foundDLLs[i].getFullPathName();
+		const String fileStamp = getFileStamp(foundDLLs[i]);
+
+		if (const XmlElement* cached = findCachedLibrary(path, fileStamp))
+		{
+			std::cout << "Found in cache with " << addCachedLibrary(*cached) << " plugins" << std::endl;
+			continue;
+		}
+
+		pluginCacheChanged = true;
+
+		int res = loadPlugin(path);
 		if (res < 0)
 		{
 			std::cout << " DLL Load FAILED" << std::endl;
@@ -143,7 +198,9 @@ void PluginManager::loadPlugins(const File &pluginPath) {
 	 and works inside the same POSIX thread as the GUI.
  */
 
-int PluginManager::loadPlugin(const String& pluginLoc) {
+bool PluginManager::openLibrary(const String& pluginLoc, decltype(LoadedLibInfo::handle)& libHandle,
+	Plugin::LibraryInfo& libInfo, PluginInfoFunction& piFunction)
+{
 	/*
 	Load in the selected processor. This takes the
 	dynamic object (.so) and copies it into RAM
@@ -180,7 +237,7 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 	if (!handle) {
 		ERROR_MSG("Failed to load plugin DLL");
 		closeHandle(handle);
-		return -1;
+		return false;
 	}
 
 	LibraryInfoFunction infoFunction = 0;
@@ -197,20 +254,19 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 	{
 		ERROR_MSG("Failed to load function 'getLibInfo'");
 		closeHandle(handle);
-		return -1;
+		return false;
 	}
 
-	Plugin::LibraryInfo libInfo;
 	infoFunction(&libInfo);
 
 	if (libInfo.apiVersion != PLUGIN_API_VER)
 	{
 		std::cerr << pluginLoc << " invalid version" << std::endl;
 		closeHandle(handle);
-		return -1;
+		return false;
 	}
 
-	PluginInfoFunction piFunction = 0;
+	piFunction = 0;
 #ifdef WIN32
 	piFunction = (PluginInfoFunction)GetProcAddress(handle, "getPluginInfo");
 #elif defined(__APPLE__)
@@ -224,15 +280,29 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 	{
         ERROR_MSG("Failed to load function 'getPluginInfo'");
 		closeHandle(handle);
-		return -1;
+		return false;
 	}
 
+	libHandle = handle;
+	return true;
+}
+
+int PluginManager::loadPlugin(const String& pluginLoc) {
+	decltype(LoadedLibInfo::handle) handle = 0;
+	Plugin::LibraryInfo libInfo;
+	PluginInfoFunction piFunction = 0;
+
+	if (!openLibrary(pluginLoc, handle, libInfo, piFunction))
+		return -1;
+
 	LoadedLibInfo lib;
 	lib.apiVersion = libInfo.apiVersion;
 	lib.name = libInfo.name;
 	lib.libVersion = libInfo.libVersion;
 	lib.numPlugins = libInfo.numPlugins;
 	lib.handle = handle;
+	lib.path = pluginLoc;
+	lib.fileStamp = getFileStamp(File(pluginLoc));
 
 	libArray.add(lib);
 
@@ -250,6 +320,7 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 			info.name = pInfo.processor.name;
 			info.type = pInfo.processor.type;
 			info.libIndex = libArray.size()-1;
+			info.pluginIndex = i;
 			processorPlugins.add(info);
 			break;
 		}
@@ -259,6 +330,7 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 			info.creator = pInfo.recordEngine.creator;
 			info.name = pInfo.recordEngine.name;
 			info.libIndex = libArray.size() - 1;
+			info.pluginIndex = i;
 			recordEnginePlugins.add(info);
 			break;
 		}
@@ -268,6 +340,7 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 			info.creator = pInfo.dataThread.creator;
 			info.name = pInfo.dataThread.name;
 			info.libIndex = libArray.size() - 1;
+			info.pluginIndex = i;
 			dataThreadPlugins.add(info);
 			break;
 		}
@@ -277,7 +350,8 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 			info.creator = pInfo.fileSource.creator;
 			info.name = pInfo.fileSource.name;
 			info.extensions = pInfo.fileSource.extensions;
-			info.libIndex = libArray.size();
+			info.libIndex = libArray.size() - 1;
+			info.pluginIndex = i;
 			fileSourcePlugins.add(info);
 			break;
 		}
@@ -291,6 +365,229 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 	return lib.numPlugins;
 }
 
+bool PluginManager::loadLibrary(int libIndex)
+{
+	if (libIndex < 0 || libIndex >= libArray.size())
+		return false;
+
+	LoadedLibInfo& lib = libArray.getReference(libIndex);
+	if (lib.handle)
+		return true;
+
+	std::cout << "Loading cached plugin library " << lib.path << std::endl;
+
+	decltype(LoadedLibInfo::handle) handle = 0;
+	Plugin::LibraryInfo libInfo;
+	PluginInfoFunction piFunction = 0;
+
+	if (!openLibrary(lib.path, handle, libInfo, piFunction))
+		return false;
+
+	if (String(libInfo.name) != String(lib.name) || libInfo.libVersion != lib.libVersion)
+	{
+		std::cerr << lib.path << " does not match the plugin cache" << std::endl;
+		closeHandle(handle);
+		return false;
+	}
+
+	lib.handle = handle;
+
+	// the names are kept from the cache, which has the same ones
+	Plugin::PluginInfo pInfo;
+	for (auto& info : processorPlugins)
+		if (info.libIndex == libIndex && !piFunction(info.pluginIndex, &pInfo) && pInfo.type == Plugin::PLUGIN_TYPE_PROCESSOR)
+			info.creator = pInfo.processor.creator;
+	for (auto& info : recordEnginePlugins)
+		if (info.libIndex == libIndex && !piFunction(info.pluginIndex, &pInfo) && pInfo.type == Plugin::PLUGIN_TYPE_RECORD_ENGINE)
+			info.creator = pInfo.recordEngine.creator;
+	for (auto& info : dataThreadPlugins)
+		if (info.libIndex == libIndex && !piFunction(info.pluginIndex, &pInfo) && pInfo.type == Plugin::PLUGIN_TYPE_DATA_THREAD)
+			info.creator = pInfo.dataThread.creator;
+	for (auto& info : fileSourcePlugins)
+		if (info.libIndex == libIndex && !piFunction(info.pluginIndex, &pInfo) && pInfo.type == Plugin::PLUGIN_TYPE_FILE_SOURCE)
+			info.creator = pInfo.fileSource.creator;
+
+	return true;
+}
+
+const char* PluginManager::storeString(const String& s)
+{
+	cachedStrings.add(s);
+	return cachedStrings.getReference(cachedStrings.size() - 1).toRawUTF8();
+}
+
+const XmlElement* PluginManager::findCachedLibrary(const String& path, const String& fileStamp) const
+{
+	if (pluginCache == nullptr)
+		return nullptr;
+
+	forEachXmlChildElementWithTagName(*pluginCache, libXml, "LIBRARY")
+	{
+		if (libXml->getStringAttribute("path") == path && libXml->getStringAttribute("stamp") == fileStamp)
+			return libXml;
+	}
+	return nullptr;
+}
+
+int PluginManager::addCachedLibrary(const XmlElement& libXml)
+{
+	LoadedLibInfo lib;
+	lib.apiVersion = PLUGIN_API_VER;
+	lib.name = storeString(libXml.getStringAttribute("name"));
+	lib.libVersion = libXml.getIntAttribute("version");
+	lib.numPlugins = 0;
+	lib.handle = 0;
+	lib.path = libXml.getStringAttribute("path");
+	lib.fileStamp = libXml.getStringAttribute("stamp");
+
+	const int libIndex = libArray.size();
+
+	forEachXmlChildElementWithTagName(libXml, pluginXml, "PLUGIN")
+	{
+		const char* name = storeString(pluginXml->getStringAttribute("name"));
+		const int pluginIndex = pluginXml->getIntAttribute("index");
+
+		switch (pluginXml->getIntAttribute("type"))
+		{
+		case Plugin::PLUGIN_TYPE_PROCESSOR:
+		{
+			LoadedPluginInfo<Plugin::ProcessorInfo> info;
+			info.creator = nullptr;
+			info.name = name;
+			info.type = (Plugin::ProcessorType)pluginXml->getIntAttribute("processorType", Plugin::InvalidProcessor);
+			info.libIndex = libIndex;
+			info.pluginIndex = pluginIndex;
+			processorPlugins.add(info);
+			break;
+		}
+		case Plugin::PLUGIN_TYPE_RECORD_ENGINE:
+		{
+			LoadedPluginInfo<Plugin::RecordEngineInfo> info;
+			info.creator = nullptr;
+			info.name = name;
+			info.libIndex = libIndex;
+			info.pluginIndex = pluginIndex;
+			recordEnginePlugins.add(info);
+			break;
+		}
+		case Plugin::PLUGIN_TYPE_DATA_THREAD:
+		{
+			LoadedPluginInfo<Plugin::DataThreadInfo> info;
+			info.creator = nullptr;
+			info.name = name;
+			info.libIndex = libIndex;
+			info.pluginIndex = pluginIndex;
+			dataThreadPlugins.add(info);
+			break;
+		}
+		case Plugin::PLUGIN_TYPE_FILE_SOURCE:
+		{
+			LoadedPluginInfo<Plugin::FileSourceInfo> info;
+			info.creator = nullptr;
+			info.name = name;
+			info.extensions = storeString(pluginXml->getStringAttribute("extensions"));
+			info.libIndex = libIndex;
+			info.pluginIndex = pluginIndex;
+			fileSourcePlugins.add(info);
+			break;
+		}
+		default:
+			continue;
+		}
+		lib.numPlugins++;
+	}
+
+	libArray.add(lib);
+	return lib.numPlugins;
+}
+
+void PluginManager::savePluginCache() const
+{
+	XmlElement cache("PLUGINCACHE");
+	cache.setAttribute("apiVersion", PLUGIN_API_VER);
+
+	for (int l = 0; l < libArray.size(); l++)
+	{
+		XmlElement* libXml = cache.createNewChildElement("LIBRARY");
+		libXml->setAttribute("path", libArray[l].path);
+		libXml->setAttribute("stamp", libArray[l].fileStamp);
+		libXml->setAttribute("name", libArray[l].name);
+		libXml->setAttribute("version", libArray[l].libVersion);
+
+		for (const auto& info : processorPlugins)
+		{
+			if (info.libIndex != l)
+				continue;
+			XmlElement* pluginXml = libXml->createNewChildElement("PLUGIN");
+			pluginXml->setAttribute("type", Plugin::PLUGIN_TYPE_PROCESSOR);
+			pluginXml->setAttribute("index", info.pluginIndex);
+			pluginXml->setAttribute("name", info.name);
+			pluginXml->setAttribute("processorType", info.type);
+		}
+		for (const auto& info : recordEnginePlugins)
+		{
+			if (info.libIndex != l)
+				continue;
+			XmlElement* pluginXml = libXml->createNewChildElement("PLUGIN");
+			pluginXml->setAttribute("type", Plugin::PLUGIN_TYPE_RECORD_ENGINE);
+			pluginXml->setAttribute("index", info.pluginIndex);
+			pluginXml->setAttribute("name", info.name);
+		}
+		for (const auto& info : dataThreadPlugins)
+		{
+			if (info.libIndex != l)
+				continue;
+			XmlElement* pluginXml = libXml->createNewChildElement("PLUGIN");
+			pluginXml->setAttribute("type", Plugin::PLUGIN_TYPE_DATA_THREAD);
+			pluginXml->setAttribute("index", info.pluginIndex);
+			pluginXml->setAttribute("name", info.name);
+		}
+		for (const auto& info : fileSourcePlugins)
+		{
+			if (info.libIndex != l)
+				continue;
+			XmlElement* pluginXml = libXml->createNewChildElement("PLUGIN");
+			pluginXml->setAttribute("type", Plugin::PLUGIN_TYPE_FILE_SOURCE);
+			pluginXml->setAttribute("index", info.pluginIndex);
+			pluginXml->setAttribute("name", info.name);
+			pluginXml->setAttribute("extensions", info.extensions);
+		}
+	}
+
+	File file = getPluginCacheFile();
+	file.getParentDirectory().createDirectory();
+	if (!cache.writeToFile(file, String::empty))
+		std::cout << "Could not write the plugin cache to " << file.getFullPathName() << std::endl;
+}
+
+ProcessorCreator PluginManager::getProcessorCreator(int index)
+{
+	if (index < 0 || index >= processorPlugins.size() || !loadLibrary(processorPlugins[index].libIndex))
+		return nullptr;
+	return processorPlugins[index].creator;
+}
+
+DataThreadCreator PluginManager::getDataThreadCreator(int index)
+{
+	if (index < 0 || index >= dataThreadPlugins.size() || !loadLibrary(dataThreadPlugins[index].libIndex))
+		return nullptr;
+	return dataThreadPlugins[index].creator;
+}
+
+EngineManagerCreator PluginManager::getRecordEngineCreator(int index)
+{
+	if (index < 0 || index >= recordEnginePlugins.size() || !loadLibrary(recordEnginePlugins[index].libIndex))
+		return nullptr;
+	return recordEnginePlugins[index].creator;
+}
+
+FileSourceCreator PluginManager::getFileSourceCreator(int index)
+{
+	if (index < 0 || index >= fileSourcePlugins.size() || !loadLibrary(fileSourcePlugins[index].libIndex))
+		return nullptr;
+	return fileSourcePlugins[index].creator;
+}
+
 int PluginManager::getNumProcessors() const
 {
 	return processorPlugins.size();
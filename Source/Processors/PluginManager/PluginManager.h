@@ -39,6 +39,7 @@
 
 struct LoadedLibInfo : public Plugin::LibraryInfo
 {
+	/** Null for libraries known only from the plugin cache, until one of their plugins is used */
 #ifdef WIN32
 	HINSTANCE handle;
 #elif defined(__APPLE__)
@@ -46,12 +47,15 @@ struct LoadedLibInfo : public Plugin::LibraryInfo
 #else
 	void* handle;
 #endif
+	String path;
+	String fileStamp;
 };
 
 template<class T>
 struct LoadedPluginInfo : public T
 {
 	int libIndex;
+	int pluginIndex; // index passed to the library's getPluginInfo
 };
 
 
@@ -83,7 +87,33 @@ public:
 	int getLibraryVersion(int index) const;
 	int getLibraryIndexFromPlugin(Plugin::PluginType type, int index);
 
+	/** The creators are only known once the plugin library is loaded. These load it if the
+	plugin was found in the plugin cache and not used yet, and return nullptr if that fails. */
+	ProcessorCreator getProcessorCreator(int index);
+	DataThreadCreator getDataThreadCreator(int index);
+	EngineManagerCreator getRecordEngineCreator(int index);
+	FileSourceCreator getFileSourceCreator(int index);
+
 private:
+	/** Opens a library and checks its API version, printing the reason if it fails */
+	bool openLibrary(const String& path, decltype(LoadedLibInfo::handle)& handle,
+		Plugin::LibraryInfo& libInfo, PluginInfoFunction& piFunction);
+
+	/** Loads a library known from the plugin cache and fills in the creators of its plugins */
+	bool loadLibrary(int libIndex);
+
+	/** Adds the plugins of a library from its plugin cache entry, without loading it */
+	int addCachedLibrary(const XmlElement& libXml);
+	const XmlElement* findCachedLibrary(const String& path, const String& fileStamp) const;
+	void savePluginCache() const;
+
+	/** Keeps the strings of cached plugins alive, as the info structures only point to them */
+	const char* storeString(const String&);
+
+	ScopedPointer<XmlElement> pluginCache;
+	bool pluginCacheChanged;
+	StringArray cachedStrings;
+
 	Array<LoadedLibInfo> libArray;
 	Array<LoadedPluginInfo<Plugin::ProcessorInfo>> processorPlugins;
 	Array<LoadedPluginInfo<Plugin::DataThreadInfo>> dataThreadPlugins;
@@ -0,0 +1,298 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2016 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <stdio.h>
+
+PROCESSORHEADERS
+
+
+PROCESSORCLASSNAME::PROCESSORCLASSNAME()
+    : GenericProcessor ("PLUGINGUINAME")
+    , mailboxChanged (true)
+    , displayFifo (DISPLAY_RING_FRAMES)
+    , numDisplayChannels (0)
+    , numDroppedDisplayFrames (0)
+{
+    setProcessorType (PROCESSORTYPE);
+
+    // Open Ephys Plugin Generator will insert generated code for parameters here. Don't edit this section.
+    //[OPENEPHYS_PARAMETERS_SECTION_BEGIN]
+    //[OPENEPHYS_PARAMETERS_SECTION_END]
+
+    // the mailbox starts from the default of every parameter, and a unit gain if there is none
+    for (int i = 0; i < MAX_PARAMETERS; ++i)
+        mailbox[i] = 0.0f;
+    mailbox[GAIN] = 1.0f;
+
+    for (int i = 0; i < jmin (parameters.size(), int (MAX_PARAMETERS)); ++i)
+        mailbox[i] = float (parameters[i]->getDefaultValue());
+
+    for (int i = 0; i < MAX_PARAMETERS; ++i)
+        blockValues[i] = mailbox[i];
+}
+
+
+PROCESSORCLASSNAME::~PROCESSORCLASSNAME()
+{
+}
+
+
+/**
+  If the processor uses a custom editor, this method must be present.
+*/
+AudioProcessorEditor* PROCESSORCLASSNAME::createEditor()
+{
+    editor = new EDITORCLASSNAME (this, true);
+
+    return editor;
+}
+
+
+void PROCESSORCLASSNAME::setParameter (int parameterIndex, float newValue)
+{
+    if (isPositiveAndBelow (parameterIndex, int (MAX_PARAMETERS)))
+    {
+        mailbox[parameterIndex].store (newValue, std::memory_order_relaxed);
+        mailboxChanged.store (true, std::memory_order_release);
+    }
+
+    // keeps the generated parameters and their editor controls in step
+    if (isPositiveAndBelow (parameterIndex, parameters.size()))
+        GenericProcessor::setParameter (parameterIndex, newValue);
+}
+
+
+void PROCESSORCLASSNAME::updateSettings()
+{
+    processedChannels.clearQuick();
+
+    for (int i = 0; i < getNumInputs(); ++i)
+        processedChannels.add (i);
+
+    numDisplayChannels = jmin (processedChannels.size(), int (MAX_DISPLAY_CHANNELS));
+    displayRing.allocate ((size_t) DISPLAY_RING_FRAMES * jmax (1, numDisplayChannels), true);
+    displayFrame.allocate ((size_t) jmax (1, numDisplayChannels), true);
+}
+
+
+bool PROCESSORCLASSNAME::enable()
+{
+    displayFifo.reset();
+    numDroppedDisplayFrames = 0;
+    mailboxChanged = true;
+
+    return true;
+}
+
+
+int PROCESSORCLASSNAME::getNumDisplayChannels() const
+{
+    return numDisplayChannels;
+}
+
+
+int PROCESSORCLASSNAME::getNumDroppedDisplayFrames() const
+{
+    return numDroppedDisplayFrames;
+}
+
+
+void PROCESSORCLASSNAME::collectParameters()
+{
+    if (! mailboxChanged.exchange (false, std::memory_order_acquire))
+        return;
+
+    for (int i = 0; i < MAX_PARAMETERS; ++i)
+        blockValues[i] = mailbox[i].load (std::memory_order_relaxed);
+}
+
+
+void PROCESSORCLASSNAME::process (AudioSampleBuffer& buffer)
+{
+    collectParameters();
+
+    const int numChannels = processedChannels.size();
+    if (numChannels == 0)
+        return;
+
+    const float gain = blockValues[GAIN];
+
+    /* =============================================================================
+      Every task gets a contiguous range of channels. Keep the work of a channel in
+      kernels over the whole block (FloatVectorOperations, or plain loops over
+      float arrays the compiler can vectorise), and do not allocate, lock or
+      touch the editor from here: the ranges run at the same time on several threads.
+      =============================================================================== */
+    parallelFor (numChannels, [this, &buffer, gain] (int firstChannel, int lastChannel)
+    {
+        for (int i = firstChannel; i < lastChannel; ++i)
+        {
+            const int chan = processedChannels.getUnchecked (i);
+            const int numSamples = getNumSamples (chan);
+            float* samples = buffer.getWritePointer (chan);
+
+            removeMeanAndScale (samples, numSamples, gain);
+
+            if (i < numDisplayChannels)
+                displayFrame[i] = peakToPeak (samples, numSamples);
+        }
+    });
+
+    pushDisplayFrame();
+}
+
+
+void PROCESSORCLASSNAME::removeMeanAndScale (float* samples, int numSamples, float gain)
+{
+    if (numSamples <= 0)
+        return;
+
+    // independent partial sums let the compiler keep them in one vector register
+    float sums[4] = { 0, 0, 0, 0 };
+    int n = 0;
+    for (; n + 4 <= numSamples; n += 4)
+    {
+        sums[0] += samples[n];
+        sums[1] += samples[n + 1];
+        sums[2] += samples[n + 2];
+        sums[3] += samples[n + 3];
+    }
+    for (; n < numSamples; ++n)
+        sums[0] += samples[n];
+
+    const float mean = (sums[0] + sums[1] + sums[2] + sums[3]) / numSamples;
+
+    FloatVectorOperations::add (samples, -mean, numSamples);
+    FloatVectorOperations::multiply (samples, gain, numSamples);
+}
+
+
+float PROCESSORCLASSNAME::peakToPeak (const float* samples, int numSamples)
+{
+    if (numSamples <= 0)
+        return 0.0f;
+
+    return FloatVectorOperations::findMinAndMax (samples, numSamples).getLength();
+}
+
+
+void PROCESSORCLASSNAME::pushDisplayFrame()
+{
+    if (numDisplayChannels == 0)
+        return;
+
+    int start1, size1, start2, size2;
+    displayFifo.prepareToWrite (1, start1, size1, start2, size2);
+
+    if (size1 + size2 == 0)
+    {
+        ++numDroppedDisplayFrames;
+        return;
+    }
+
+    const int frame = size1 > 0 ? start1 : start2;
+    FloatVectorOperations::copy (displayRing + (size_t) frame * numDisplayChannels, displayFrame, numDisplayChannels);
+    displayFifo.finishedWrite (1);
+}
+
+
+int PROCESSORCLASSNAME::readDisplayFrames (float* dest, int maxFrames)
+{
+    if (numDisplayChannels == 0)
+        return 0;
+
+    int start1, size1, start2, size2;
+    displayFifo.prepareToRead (maxFrames, start1, size1, start2, size2);
+
+    if (size1 > 0)
+        FloatVectorOperations::copy (dest, displayRing + (size_t) start1 * numDisplayChannels, size1 * numDisplayChannels);
+    if (size2 > 0)
+        FloatVectorOperations::copy (dest + (size_t) size1 * numDisplayChannels,
+                                     displayRing + (size_t) start2 * numDisplayChannels, size2 * numDisplayChannels);
+
+    displayFifo.finishedRead (size1 + size2);
+    return size1 + size2;
+}
+
+
+void PROCESSORCLASSNAME::saveCustomParametersToXml (XmlElement* parentElement)
+{
+    XmlElement* mainNode = parentElement->createNewChildElement ("PROCESSORCLASSNAME");
+    mainNode->setAttribute ("numParameters", getNumParameters());
+
+    // Open Ephys Plugin Generator will insert generated code to save parameters here. Don't edit this section.
+    //[OPENEPHYS_PARAMETERS_SAVE_SECTION_BEGIN]
+    for (int i = 0; i < getNumParameters(); ++i)
+    {
+        XmlElement* parameterNode = mainNode->createNewChildElement ("Parameter");
+
+        auto parameter = getParameterObject(i);
+        parameterNode->setAttribute ("name", parameter->getName());
+        parameterNode->setAttribute ("type", parameter->getParameterTypeString());
+
+        auto parameterValue = getParameterVar (i, currentChannel);
+
+        if (parameter->isBoolean())
+            parameterNode->setAttribute ("value", (int)parameterValue);
+        else if (parameter->isContinuous() || parameter->isDiscrete() || parameter->isNumerical())
+            parameterNode->setAttribute ("value", (double)parameterValue);
+    }
+    //[OPENEPHYS_PARAMETERS_SAVE_SECTION_END]
+}
+
+
+void PROCESSORCLASSNAME::loadCustomParametersFromXml()
+{
+    if (parametersAsXml == nullptr) // prevent double-loading
+        return;
+
+    // use parametersAsXml to restore state
+
+    // Open Ephys Plugin Generator will insert generated code to load parameters here. Don't edit this section.
+    //[OPENEPHYS_PARAMETERS_LOAD_SECTION_BEGIN]
+    forEachXmlChildElement (*parametersAsXml, mainNode)
+    {
+        if (mainNode->hasTagName ("PROCESSORCLASSNAME"))
+        {
+            int parameterIdx = -1;
+
+            forEachXmlChildElement (*mainNode, parameterNode)
+            {
+                if (parameterNode->hasTagName ("Parameter"))
+                {
+                    ++parameterIdx;
+
+                    String parameterType = parameterNode->getStringAttribute ("type");
+                    if (parameterType == "Boolean")
+                        setParameter (parameterIdx, parameterNode->getBoolAttribute ("value"));
+                    else if (parameterType == "Continuous" || parameterType == "Numerical")
+                        setParameter (parameterIdx, parameterNode->getDoubleAttribute ("value"));
+                    else if (parameterType == "Discrete")
+                        setParameter (parameterIdx, parameterNode->getIntAttribute ("value"));
+                }
+            }
+        }
+    }
+    //[OPENEPHYS_PARAMETERS_LOAD_SECTION_END]
+}
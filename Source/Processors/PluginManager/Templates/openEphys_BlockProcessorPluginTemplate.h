@@ -0,0 +1,137 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2016 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef HEADERGUARD
+#define HEADERGUARD
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+#include <ProcessorHeaders.h>
+#include <atomic>
+
+/**
+    This class serves as a template for processors that work on whole blocks.
+
+    process() splits the channels into ranges that run on the processor thread pool
+    with parallelFor(), and every range runs the vector kernels below over whole
+    channels, so nothing is done sample by sample in scalar code.
+
+    Values set from the editor are posted to a lock-free mailbox and taken once at the
+    start of every block, so a block is always processed with one set of values and the
+    audio thread never waits for the message thread.
+
+    After every block, one peak to peak value per displayed channel is pushed to a display
+    ring, which a visualizer empties from its own timer. If the visualizer falls behind,
+    frames are dropped instead of holding up the processor.
+
+    @see GenericProcessor
+*/
+class PROCESSORCLASSNAME : public GenericProcessor
+
+{
+public:
+    /** The class constructor, used to initialize any members. */
+    PROCESSORCLASSNAME();
+
+    /** The class destructor, used to deallocate memory */
+    ~PROCESSORCLASSNAME();
+
+    /** If the processor has a custom editor, this method must be defined to instantiate it. */
+    AudioProcessorEditor* createEditor() override;
+
+    /** Runs the kernels over ranges of channels on the processor thread pool. */
+    void process (AudioSampleBuffer& buffer) override;
+
+    /** Posts the value to the mailbox, to be used from the next block. Safe to call while acquiring. */
+    void setParameter (int parameterIndex, float newValue) override;
+
+    /** Picks the processed channels and sizes the display ring. */
+    void updateSettings() override;
+
+    /** Empties the display ring and makes the next block take the mailbox values. */
+    bool enable() override;
+
+    /** Saving custom settings to XML. */
+    virtual void saveCustomParametersToXml (XmlElement* parentElement) override;
+
+    /** Load custom settings from XML*/
+    virtual void loadCustomParametersFromXml() override;
+
+    enum
+    {
+        /** Index of the parameter used by the example kernel as a gain */
+        GAIN = 0,
+        /** Parameter indices the mailbox holds */
+        MAX_PARAMETERS = 32,
+
+        /** Frames the display ring holds, one per block */
+        DISPLAY_RING_FRAMES = 256,
+        MAX_DISPLAY_CHANNELS = 64
+    };
+
+    /** Number of values in every frame of the display ring */
+    int getNumDisplayChannels() const;
+
+    /** Copies up to maxFrames frames of the display ring into dest, oldest first, and returns
+        how many were copied. Must only be called from one thread, usually the visualizer's timer. */
+    int readDisplayFrames (float* dest, int maxFrames);
+
+    /** Frames dropped because the display ring was full */
+    int getNumDroppedDisplayFrames() const;
+
+private:
+    /** Example kernel: removes the block mean of a channel and scales it. */
+    static void removeMeanAndScale (float* samples, int numSamples, float gain);
+
+    /** Difference between the largest and the smallest sample. */
+    static float peakToPeak (const float* samples, int numSamples);
+
+    /** Copies the mailbox into blockValues if anything was posted since the last block. */
+    void collectParameters();
+
+    /** Pushes displayFrame to the display ring, or drops it if the ring is full. */
+    void pushDisplayFrame();
+
+    // parameter mailbox, written from any thread and read at the start of every block
+    std::atomic<float> mailbox[MAX_PARAMETERS];
+    std::atomic<bool> mailboxChanged;
+    /** The values the current block is processed with. Audio thread only */
+    float blockValues[MAX_PARAMETERS];
+
+    /** Indices of the processed channels, set in updateSettings */
+    Array<int> processedChannels;
+
+    // display ring, written by the audio thread and read by the visualizer
+    AbstractFifo displayFifo;
+    HeapBlock<float> displayRing;
+    HeapBlock<float> displayFrame;
+    int numDisplayChannels;
+    std::atomic<int> numDroppedDisplayFrames;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PROCESSORCLASSNAME);
+};
+
+
+#endif  // HEADERGUARD
@@ -0,0 +1,135 @@
+/*
+   ------------------------------------------------------------------
+
+   This file is part of the Open Ephys GUI
+   Copyright (C) 2016 Open Ephys
+
+   ------------------------------------------------------------------
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "EDITORCANVASCLASSNAME.h"
+#include "PROCESSORCLASSNAME.h"
+
+
+EDITORCANVASCLASSNAME::EDITORCANVASCLASSNAME (PROCESSORCLASSNAME* processor_)
+    : processor  (processor_)
+    , frames     ((size_t) PROCESSORCLASSNAME::DISPLAY_RING_FRAMES * PROCESSORCLASSNAME::MAX_DISPLAY_CHANNELS)
+    , history    (Image::RGB, HISTORY_FRAMES, PROCESSORCLASSNAME::MAX_DISPLAY_CHANNELS, true)
+    , nextColumn (0)
+    , scale      (1.0f)
+{
+    // Open Ephys Plugin Generator will insert generated code for editor here. Don't edit this section.
+    //[OPENEPHYS_EDITOR_PRE_CONSTRUCTOR_SECTION_BEGIN]
+
+    //m_contentLookAndFeel = new LOOKANDFEELCLASSNAME();
+    //content.setLookAndFeel (m_contentLookAndFeel);
+    addAndMakeVisible (&content);
+
+    //[OPENEPHYS_EDITOR_PRE_CONSTRUCTOR_SECTION_END]
+}
+
+
+EDITORCANVASCLASSNAME::~EDITORCANVASCLASSNAME()
+{
+}
+
+
+void EDITORCANVASCLASSNAME::paint (Graphics& g)
+{
+    g.fillAll (Colours::black);
+
+    const int numChannels = processor->getNumDisplayChannels();
+    if (numChannels == 0)
+        return;
+
+    // oldest columns on the left: the part after nextColumn, then the one before it
+    g.setImageResamplingQuality (Graphics::lowResamplingQuality);
+
+    const int width = getWidth();
+    const int oldWidth = width * (HISTORY_FRAMES - nextColumn) / HISTORY_FRAMES;
+    g.drawImage (history, 0, 0, oldWidth, getHeight(), nextColumn, 0, HISTORY_FRAMES - nextColumn, numChannels);
+    g.drawImage (history, oldWidth, 0, width - oldWidth, getHeight(), 0, 0, nextColumn, numChannels);
+}
+
+
+void EDITORCANVASCLASSNAME::resized()
+{
+    content.setBounds (getLocalBounds());
+}
+
+
+void EDITORCANVASCLASSNAME::refreshState()
+{
+}
+
+
+void EDITORCANVASCLASSNAME::update()
+{
+    history.clear (history.getBounds(), Colours::black);
+    nextColumn = 0;
+    scale = 1.0f;
+    repaint();
+}
+
+
+void EDITORCANVASCLASSNAME::refresh()
+{
+    const int numChannels = processor->getNumDisplayChannels();
+    const int numFrames = processor->readDisplayFrames (frames, PROCESSORCLASSNAME::DISPLAY_RING_FRAMES);
+
+    for (int f = 0; f < numFrames; ++f)
+        drawFrame (frames + (size_t) f * numChannels, numChannels);
+
+    if (numFrames > 0)
+        repaint();
+}
+
+
+void EDITORCANVASCLASSNAME::drawFrame (const float* frame, int numChannels)
+{
+    const float frameMax = FloatVectorOperations::findMaximum (frame, numChannels);
+    scale = jmax (frameMax, scale * 0.999f, 1.0e-6f);
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        const float level = jlimit (0.0f, 1.0f, frame[c] / scale);
+        history.setPixelAt (nextColumn, c, Colour::greyLevel (level));
+    }
+
+    nextColumn = (nextColumn + 1) % HISTORY_FRAMES;
+}
+
+
+void EDITORCANVASCLASSNAME::beginAnimation()
+{
+    startCallbacks();
+}
+
+
+void EDITORCANVASCLASSNAME::endAnimation()
+{
+    stopCallbacks();
+}
+
+
+void EDITORCANVASCLASSNAME::setParameter (int parameter, float newValue)
+{
+}
+
+
+void EDITORCANVASCLASSNAME::setParameter (int parameter, int val1, int val2, float newValue)
+{
+}
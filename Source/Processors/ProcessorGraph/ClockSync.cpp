@@ -0,0 +1,261 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ClockSync.h"
+#include "../GenericProcessor/GenericProcessor.h"
+
+#include <cmath>
+#include <limits>
+
+// Edges are paired when their wall clock times, or the current model's prediction,
+// are this close. The sync pulses must be spaced well beyond it.
+#define MATCH_TOLERANCE_S 0.1
+// Weight kept by the older pulses each time a new one is added
+#define FORGETTING_FACTOR 0.99
+
+ClockSync::ClockSync()
+	: m_master(nullptr),
+	m_masterFullId(0),
+	m_masterSampleRate(0),
+	m_syncLine(-1),
+	m_syncPointFifo(numElementsInArray(m_syncPoints))
+{
+}
+
+ClockSync::~ClockSync()
+{
+}
+
+void ClockSync::setSyncLine(int line)
+{
+	m_syncLine = line;
+}
+
+int ClockSync::getSyncLine() const
+{
+	return m_syncLine;
+}
+
+void ClockSync::reset(uint32 masterFullId, float masterSampleRate)
+{
+	const SpinLock::ScopedLockType lock(m_lock);
+	m_sources.clear();
+	m_master = nullptr;
+	m_masterFullId = masterFullId;
+	m_masterSampleRate = masterSampleRate;
+	m_syncPointFifo.reset();
+}
+
+void ClockSync::addSource(uint32 sourceFullId, float sampleRate)
+{
+	if (m_syncLine < 0 || m_masterFullId == 0)
+		return;
+
+	const SpinLock::ScopedLockType lock(m_lock);
+	if (findSource(sourceFullId) != nullptr)
+		return;
+
+	Source* source = new Source();
+	zerostruct(*source);
+	source->fullId = sourceFullId;
+	source->sampleRate = sampleRate;
+	source->lastMasterTimestamp = std::numeric_limits<int64>::min();
+	source->slope = m_masterSampleRate / sampleRate;
+	m_sources.add(source);
+
+	if (sourceFullId == m_masterFullId)
+		m_master = source;
+}
+
+ClockSync::Source* ClockSync::findSource(uint32 fullId) const
+{
+	for (int i = 0; i < m_sources.size(); i++)
+	{
+		if (m_sources.getUnchecked(i)->fullId == fullId)
+			return m_sources.getUnchecked(i);
+	}
+	return nullptr;
+}
+
+void ClockSync::addEdge(uint32 sourceFullId, int64 timestamp, int64 blockTicks, int samplesToBlockEnd)
+{
+	const SpinLock::ScopedLockType lock(m_lock);
+	Source* source = findSource(sourceFullId);
+	if (source == nullptr || m_master == nullptr)
+		return;
+
+	Edge& edge = source->edges[source->nextEdge];
+	edge.timestamp = timestamp;
+	edge.seconds = Time::highResolutionTicksToSeconds(blockTicks) - samplesToBlockEnd / source->sampleRate;
+	edge.matched = false;
+	source->nextEdge = (source->nextEdge + 1) % NUM_EDGES;
+	source->numEdges = jmin(source->numEdges + 1, int(NUM_EDGES));
+
+	// Sources may be rendered in any order, so the master's edge can arrive before or
+	// after the matching edges of the other devices
+	if (source == m_master)
+	{
+		for (int i = 0; i < m_sources.size(); i++)
+		{
+			Source* other = m_sources.getUnchecked(i);
+			if (other == m_master)
+				continue;
+			for (int e = 0; e < other->numEdges; e++)
+			{
+				if (!other->edges[e].matched && tryMatch(*other, other->edges[e], edge))
+					break;
+			}
+		}
+	}
+	else
+	{
+		for (int e = 0; e < m_master->numEdges; e++)
+		{
+			if (tryMatch(*source, edge, m_master->edges[e]))
+				break;
+		}
+	}
+}
+
+bool ClockSync::tryMatch(Source& source, Edge& edge, const Edge& masterEdge)
+{
+	if (masterEdge.timestamp <= source.lastMasterTimestamp)
+		return false;
+
+	bool close;
+	if (source.numPulses >= 2)
+		close = std::abs(predict(source, edge.timestamp) - masterEdge.timestamp) <= MATCH_TOLERANCE_S * m_masterSampleRate;
+	else
+		close = std::abs(edge.seconds - masterEdge.seconds) <= MATCH_TOLERANCE_S;
+
+	if (!close)
+		return false;
+
+	edge.matched = true;
+	source.lastMasterTimestamp = masterEdge.timestamp;
+	addPair(source, edge.timestamp, masterEdge.timestamp);
+	return true;
+}
+
+void ClockSync::addPair(Source& source, int64 sourceTimestamp, int64 masterTimestamp)
+{
+	if (source.numPulses == 0)
+	{
+		source.sourceOrigin = sourceTimestamp;
+		source.masterOrigin = masterTimestamp;
+		source.lastResidual = 0;
+	}
+	else
+	{
+		source.lastResidual = predict(source, sourceTimestamp) - masterTimestamp;
+	}
+
+	// Weighted running means and co-moments (West's update), which stay accurate
+	// over long recordings where sums of squares would not
+	const double x = double(sourceTimestamp - source.sourceOrigin);
+	const double y = double(masterTimestamp - source.masterOrigin);
+	source.weight = FORGETTING_FACTOR * source.weight + 1.0;
+	const double dx = x - source.meanSource;
+	source.meanSource += dx / source.weight;
+	source.meanMaster += (y - source.meanMaster) / source.weight;
+	source.covSourceSource = FORGETTING_FACTOR * source.covSourceSource + dx * (x - source.meanSource);
+	source.covSourceMaster = FORGETTING_FACTOR * source.covSourceMaster + dx * (y - source.meanMaster);
+	source.numPulses++;
+
+	if (source.numPulses >= 2 && source.covSourceSource > 0)
+		source.slope = source.covSourceMaster / source.covSourceSource;
+
+	int start1, size1, start2, size2;
+	m_syncPointFifo.prepareToWrite(1, start1, size1, start2, size2);
+	if (size1 > 0)
+	{
+		SyncPoint& point = m_syncPoints[start1];
+		point.sourceFullId = source.fullId;
+		point.sourceTimestamp = sourceTimestamp;
+		point.masterTimestamp = masterTimestamp;
+		point.slope = source.slope;
+		point.lastResidual = source.lastResidual;
+		m_syncPointFifo.finishedWrite(1);
+	}
+}
+
+double ClockSync::predict(const Source& source, int64 timestamp) const
+{
+	const double x = double(timestamp - source.sourceOrigin);
+	return double(source.masterOrigin) + source.meanMaster + source.slope * (x - source.meanSource);
+}
+
+bool ClockSync::getModel(uint32 sourceFullId, Model& model) const
+{
+	const SpinLock::ScopedLockType lock(m_lock);
+	const Source* source = findSource(sourceFullId);
+	if (source == nullptr || source->numPulses == 0)
+		return false;
+
+	model.numPulses = source->numPulses;
+	model.slope = source->slope;
+	model.driftPpm = (source->slope * source->sampleRate / m_masterSampleRate - 1.0) * 1e6;
+	model.lastResidual = source->lastResidual;
+	return true;
+}
+
+int64 ClockSync::toMasterTimestamp(uint32 sourceFullId, int64 timestamp) const
+{
+	const SpinLock::ScopedLockType lock(m_lock);
+	const Source* source = findSource(sourceFullId);
+	if (source == nullptr || source->numPulses == 0)
+		return timestamp;
+
+	return static_cast<int64>(std::floor(predict(*source, timestamp) + 0.5));
+}
+
+bool ClockSync::getNextSyncPoint(SyncPoint& point)
+{
+	int start1, size1, start2, size2;
+	m_syncPointFifo.prepareToRead(1, start1, size1, start2, size2);
+	if (size1 == 0)
+		return false;
+
+	point = m_syncPoints[start1];
+	m_syncPointFifo.finishedRead(1);
+	return true;
+}
+
+void ClockSync::printSummary() const
+{
+	for (int i = 0; i < m_sources.size(); i++)
+	{
+		const Source* source = m_sources.getUnchecked(i);
+		if (source == m_master)
+			continue;
+
+		Model model;
+		if (getModel(source->fullId, model))
+			std::cout << "Clock sync " << GenericProcessor::getNodeIdFromFullId(source->fullId) << "."
+			<< GenericProcessor::getSubProcessorFromFullId(source->fullId) << ": " << model.numPulses
+			<< " pulses, drift " << model.driftPpm << " ppm, last residual " << model.lastResidual << " samples" << std::endl;
+		else
+			std::cout << "Clock sync " << GenericProcessor::getNodeIdFromFullId(source->fullId) << "."
+			<< GenericProcessor::getSubProcessorFromFullId(source->fullId) << ": no pulses paired with the master" << std::endl;
+	}
+}
@@ -0,0 +1,159 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CLOCKSYNC_H_INCLUDED
+#define CLOCKSYNC_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+
+/**
+	Aligns the clocks of several acquisition devices that share a TTL sync signal.
+
+	Every device is wired to the same pulse train on the same TTL line. Source
+	nodes report the rising edges they see on that line, and each edge of a
+	secondary source is paired with the edge of the global timestamp source that
+	arrived at about the same time. From these pairs a linear model of the
+	source's clock against the master clock is kept, with older pulses slowly
+	forgotten so the model follows temperature-driven drift.
+
+	The pairs are also queued as a sync table, which the MessageCenter writes into
+	the recording, so that timestamps can be realigned offline as well.
+
+	@see ProcessorGraph, SourceNode
+*/
+class ClockSync
+{
+public:
+	ClockSync();
+	~ClockSync();
+
+	/** Sets the TTL line, counting from 0, that carries the sync pulses on every
+	device. -1 disables synchronization. Takes effect when acquisition starts. */
+	void setSyncLine(int line);
+
+	int getSyncLine() const;
+
+	/** Clears all sources and models. Called when acquisition starts, with the
+	source that provides the global timestamps. A masterFullId of 0 (software
+	timer) disables synchronization for this run. */
+	void reset(uint32 masterFullId, float masterSampleRate);
+
+	/** Registers a stream that may report sync edges. Called from the source's enable(). */
+	void addSource(uint32 sourceFullId, float sampleRate);
+
+	/** Reports a rising edge on the sync line. Called from the source's process(),
+	possibly from several render threads at once. blockTicks is the high resolution
+	tick count at the start of the block and samplesToBlockEnd the number of samples
+	in the block that follow the edge, which give a rough wall clock time used to
+	pair the edge with one from the master. */
+	void addEdge(uint32 sourceFullId, int64 timestamp, int64 blockTicks, int samplesToBlockEnd);
+
+	/** Clock model of one source against the master */
+	struct Model
+	{
+		/** Number of pulses that have been paired with the master */
+		int numPulses;
+		/** Master samples per source sample */
+		double slope;
+		/** Deviation of the source clock rate from its nominal rate, in parts per million */
+		double driftPpm;
+		/** Error of the model's prediction for the last pulse, in master samples */
+		double lastResidual;
+	};
+
+	/** Returns false if the source has no model yet */
+	bool getModel(uint32 sourceFullId, Model& model) const;
+
+	/** Converts a timestamp of the given source into the master clock. Returns the
+	timestamp unchanged if the source has not been paired with the master yet. */
+	int64 toMasterTimestamp(uint32 sourceFullId, int64 timestamp) const;
+
+	/** One entry of the sync table */
+	struct SyncPoint
+	{
+		uint32 sourceFullId;
+		int64 sourceTimestamp;
+		int64 masterTimestamp;
+		double slope;
+		double lastResidual;
+	};
+
+	/** Takes the oldest sync point that hasn't been reported yet. Called by the
+	MessageCenter from the graph callback. */
+	bool getNextSyncPoint(SyncPoint& point);
+
+	/** Prints the model of every source. Called when acquisition stops. */
+	void printSummary() const;
+
+private:
+	enum { NUM_EDGES = 8 };
+
+	struct Edge
+	{
+		int64 timestamp;
+		double seconds;
+		bool matched;
+	};
+
+	struct Source
+	{
+		uint32 fullId;
+		float sampleRate;
+		Edge edges[NUM_EDGES];
+		int numEdges;
+		int nextEdge;
+		int64 lastMasterTimestamp;
+
+		// Exponentially weighted regression of master timestamps against source
+		// timestamps, both relative to the first pair to keep the doubles precise
+		int64 sourceOrigin;
+		int64 masterOrigin;
+		int numPulses;
+		double weight;
+		double meanSource;
+		double meanMaster;
+		double covSourceSource;
+		double covSourceMaster;
+		double slope;
+		double lastResidual;
+	};
+
+	Source* findSource(uint32 fullId) const;
+	bool tryMatch(Source& source, Edge& edge, const Edge& masterEdge);
+	void addPair(Source& source, int64 sourceTimestamp, int64 masterTimestamp);
+	double predict(const Source& source, int64 timestamp) const;
+
+	mutable SpinLock m_lock;
+	OwnedArray<Source> m_sources;
+	Source* m_master;
+	uint32 m_masterFullId;
+	float m_masterSampleRate;
+	int m_syncLine;
+
+	AbstractFifo m_syncPointFifo;
+	SyncPoint m_syncPoints[64];
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ClockSync);
+};
+
+#endif
@@ -0,0 +1,451 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ParallelGraphRenderer.h"
+#include "../GenericProcessor/ThreadPolicy.h"
+
+class ParallelGraphRenderer::Worker : public Thread
+{
+public:
+	Worker(ParallelGraphRenderer& owner, int index)
+		: Thread("Graph render thread " + String(index)), m_owner(owner)
+	{}
+
+	~Worker()
+	{
+		signalThreadShouldExit();
+		m_work.signal();
+		stopThread(1000);
+	}
+
+	void startBlock()
+	{
+		m_work.signal();
+	}
+
+	void run() override
+	{
+		// renders part of the audio callback's graph, so it shares its CPUs
+		ThreadPolicy::applyToCurrentThread(ThreadPolicy::AudioCallback);
+		while (!threadShouldExit())
+		{
+			if (!m_work.wait(100))
+				continue;
+			if (threadShouldExit())
+				break;
+			m_owner.renderSteps();
+			m_owner.m_activeWorkers.fetch_sub(1);
+		}
+	}
+
+private:
+	ParallelGraphRenderer& m_owner;
+	WaitableEvent m_work;
+};
+
+ParallelGraphRenderer::ParallelGraphRenderer(AudioProcessorGraph& graph, uint32 outputNodeId)
+	: m_graph(graph), m_outputNodeId(outputNodeId), m_numSamples(0)
+{
+	m_readIndex = 0;
+	m_writeIndex = 0;
+	m_numCompleted = 0;
+	m_activeWorkers = 0;
+}
+
+ParallelGraphRenderer::~ParallelGraphRenderer()
+{
+	m_workers.clear();
+}
+
+int ParallelGraphRenderer::getNumThreads() const
+{
+	return m_workers.size() + 1;
+}
+
+bool ParallelGraphRenderer::prepare(int maxBlockSize, int numThreads, const Array<uint32>& ignoredForWidth,
+	const Array<uint32>& readOnlyNodes, const Array<uint32>& passThroughNodes)
+{
+	m_workers.clear();
+	m_steps.clear();
+	m_roots.clear();
+	m_outputs.clear();
+
+	// keyed by int, as DefaultHashFunctions has no uint32 overload
+	HashMap<int, int> stepForNode;
+	for (int i = 0; i < m_graph.getNumNodes(); i++)
+	{
+		AudioProcessorGraph::Node* node = m_graph.getNode(i);
+		if (node->nodeId == m_outputNodeId)
+			continue;
+
+		Step* step = new Step();
+		step->processor = node->getProcessor();
+		step->nodeId = node->nodeId;
+		step->numChannels = jmax(1, step->processor->getTotalNumInputChannels(), step->processor->getTotalNumOutputChannels());
+		step->readOnly = readOnlyNodes.contains(node->nodeId);
+		step->passThrough = step->readOnly && passThroughNodes.contains(node->nodeId);
+		step->output = &step->buffer;
+		step->sharedSamples = -1;
+		step->numDependencies = 0;
+		step->pending = 0;
+		stepForNode.set(int(node->nodeId), m_steps.size());
+		m_steps.add(step);
+	}
+
+	const int numSteps = m_steps.size();
+	if (numSteps < 2)
+		return false;
+
+	for (int i = 0; i < m_graph.getNumConnections(); i++)
+	{
+		const AudioProcessorGraph::Connection* c = m_graph.getConnection(i);
+		if (!stepForNode.contains(int(c->sourceNodeId)))
+			continue;
+		const int source = stepForNode[int(c->sourceNodeId)];
+
+		if (c->destNodeId == m_outputNodeId)
+		{
+			if (c->sourceChannelIndex != AudioProcessorGraph::midiChannelIndex)
+				m_outputs.add({ source, c->sourceChannelIndex, c->destChannelIndex, true, false });
+			continue;
+		}
+		if (!stepForNode.contains(int(c->destNodeId)))
+			continue;
+		Step* step = m_steps[stepForNode[int(c->destNodeId)]];
+
+		if (c->destChannelIndex == AudioProcessorGraph::midiChannelIndex)
+		{
+			// The serial renderer walks the connection list backwards when merging
+			// event inputs; keep the same order so both produce identical buffers
+			step->midiInputs.insert(0, source);
+		}
+		else if (c->destChannelIndex < step->numChannels && c->sourceChannelIndex < m_steps[source]->numChannels)
+		{
+			bool add = false;
+			for (int n = 0; n < step->audioInputs.size(); n++)
+				add = add || step->audioInputs.getReference(n).destChannel == c->destChannelIndex;
+			step->audioInputs.add({ source, c->sourceChannelIndex, c->destChannelIndex, add, false });
+		}
+	}
+
+	for (int i = 0; i < numSteps; i++)
+	{
+		Step* step = m_steps[i];
+		step->bufferMemory.allocateAudioBuffer(step->buffer, step->numChannels, maxBlockSize);
+		step->midi.ensureSize(8192);
+		for (int c = 0; c < step->numChannels; c++)
+		{
+			int numInputs = 0;
+			int input = -1;
+			for (int n = 0; n < step->audioInputs.size(); n++)
+			{
+				if (step->audioInputs.getReference(n).destChannel == c)
+				{
+					numInputs++;
+					input = n;
+				}
+			}
+			if (numInputs == 0)
+				step->clearedChannels.add(c);
+
+			// Summed or unconnected channels still need storage of their own
+			if (step->readOnly && numInputs == 1)
+			{
+				step->audioInputs.getReference(input).shared = true;
+				step->sharedInputs.add(input);
+			}
+			else
+				step->sharedInputs.add(-1);
+		}
+
+		if (step->readOnly)
+		{
+			step->channelPointers.calloc(step->numChannels);
+			step->sharedBuffer.setDataToReferTo(step->buffer.getArrayOfWritePointers(), step->numChannels, maxBlockSize);
+			step->output = &step->sharedBuffer;
+		}
+	}
+
+	// A pass-through step hands on its shared channels and its incoming events
+	// unchanged, so whatever follows it can read them from its sources and run
+	// alongside it instead of after it. The ignored nodes wait on every branch
+	// anyway, and the Record node relies on the events it gets from a processor
+	// having been marked as seen by it, so they are left alone.
+	for (int i = 0; i < numSteps; i++)
+	{
+		Step* step = m_steps[i];
+		if (ignoredForWidth.contains(step->nodeId))
+			continue;
+
+		for (int n = 0; n < step->audioInputs.size(); n++)
+		{
+			ChannelInput& in = step->audioInputs.getReference(n);
+			for (int depth = 0; depth < numSteps && in.sourceStep != i; depth++)
+			{
+				const Step* source = m_steps[in.sourceStep];
+				const int shared = source->passThrough ? source->sharedInputs[in.sourceChannel] : -1;
+				if (shared < 0)
+					break;
+				const ChannelInput& upstream = source->audioInputs.getReference(shared);
+				in.sourceStep = upstream.sourceStep;
+				in.sourceChannel = upstream.sourceChannel;
+			}
+		}
+
+		Array<int> midiInputs;
+		for (int n = 0; n < step->midiInputs.size(); n++)
+			addMidiSources(step->midiInputs[n], midiInputs, numSteps);
+		step->midiInputs.swapWith(midiInputs);
+	}
+
+	Array<Array<int>> dependencies;
+	dependencies.resize(numSteps);
+	for (int i = 0; i < numSteps; i++)
+	{
+		Step* step = m_steps[i];
+		Array<int> sources(step->midiInputs);
+		for (int n = 0; n < step->audioInputs.size(); n++)
+			sources.add(step->audioInputs.getReference(n).sourceStep);
+
+		for (int source : sources)
+		{
+			if (source != i && !dependencies.getReference(i).contains(source))
+			{
+				dependencies.getReference(i).add(source);
+				m_steps[source]->dependents.add(i);
+			}
+		}
+	}
+
+	// Kahn's algorithm, both to reject cycles and to find how many branches
+	// could actually run side by side
+	Array<int> level;
+	level.insertMultiple(0, 0, numSteps);
+	Array<int> remaining;
+	Array<int> ready;
+	for (int i = 0; i < numSteps; i++)
+	{
+		Step* step = m_steps[i];
+		step->numDependencies = dependencies.getReference(i).size();
+		remaining.add(step->numDependencies);
+		if (step->numDependencies == 0)
+		{
+			m_roots.add(i);
+			ready.add(i);
+		}
+	}
+
+	int numVisited = 0;
+	while (numVisited < ready.size())
+	{
+		const int i = ready[numVisited++];
+		for (int d : m_steps[i]->dependents)
+		{
+			level.set(d, jmax(level[d], level[i] + 1));
+			remaining.set(d, remaining[d] - 1);
+			if (remaining[d] == 0)
+				ready.add(d);
+		}
+	}
+	if (numVisited != numSteps)
+		return false;
+
+	HashMap<int, int> stepsPerLevel;
+	int width = 0;
+	for (int i = 0; i < numSteps; i++)
+	{
+		if (ignoredForWidth.contains(m_steps[i]->nodeId))
+			continue;
+		const int count = stepsPerLevel[level[i]] + 1;
+		stepsPerLevel.set(level[i], count);
+		width = jmax(width, count);
+	}
+
+	m_readyQueue.allocate(numSteps, false);
+
+	const int numWorkers = jmax(0, jmin(numThreads, width) - 1);
+	for (int i = 0; i < numWorkers; i++)
+	{
+		Worker* worker = new Worker(*this, i);
+		m_workers.add(worker);
+		worker->startThread(9);
+	}
+
+	return true;
+}
+
+void ParallelGraphRenderer::process(AudioSampleBuffer& buffer, MidiBuffer& midiMessages)
+{
+	const int numSteps = m_steps.size();
+
+	m_numSamples = buffer.getNumSamples();
+	for (int i = 0; i < numSteps; i++)
+	{
+		m_steps[i]->pending = m_steps[i]->numDependencies;
+		m_readyQueue[i] = -1;
+	}
+	m_readIndex = 0;
+	m_writeIndex = 0;
+	m_numCompleted = 0;
+
+	for (int i = 0; i < m_roots.size(); i++)
+		publish(m_roots[i]);
+
+	m_activeWorkers = m_workers.size();
+	for (int i = 0; i < m_workers.size(); i++)
+		m_workers[i]->startBlock();
+
+	renderSteps();
+
+	// Workers still hold the shared schedule until they have seen the block finish
+	while (m_activeWorkers.load() > 0)
+		Thread::yield();
+
+	buffer.clear();
+	for (int i = 0; i < m_outputs.size(); i++)
+	{
+		const ChannelInput& out = m_outputs.getReference(i);
+		if (out.destChannel < buffer.getNumChannels())
+			buffer.addFrom(out.destChannel, 0, *m_steps[out.sourceStep]->output, out.sourceChannel, 0, m_numSamples);
+	}
+
+	midiMessages.clear();
+}
+
+void ParallelGraphRenderer::renderSteps()
+{
+	const int numSteps = m_steps.size();
+
+	while (m_numCompleted.load() < numSteps)
+	{
+		const int index = claim();
+		if (index < 0)
+		{
+			Thread::yield();
+			continue;
+		}
+
+		Step& step = *m_steps[index];
+		renderStep(step);
+
+		for (int d : step.dependents)
+		{
+			if (m_steps[d]->pending.fetch_sub(1) == 1)
+				publish(d);
+		}
+		m_numCompleted.fetch_add(1);
+	}
+}
+
+void ParallelGraphRenderer::renderStep(Step& step)
+{
+	// only allocates if the device sends a longer block than the graph was prepared for
+	step.bufferMemory.resizeAudioBuffer(step.buffer, m_numSamples);
+
+	for (int i = 0; i < step.audioInputs.size(); i++)
+	{
+		const ChannelInput& in = step.audioInputs.getReference(i);
+		if (in.shared)
+			continue;
+		const AudioSampleBuffer& source = *m_steps[in.sourceStep]->output;
+		if (in.add)
+			step.buffer.addFrom(in.destChannel, 0, source, in.sourceChannel, 0, m_numSamples);
+		else
+			step.buffer.copyFrom(in.destChannel, 0, source, in.sourceChannel, 0, m_numSamples);
+	}
+	for (int i = 0; i < step.clearedChannels.size(); i++)
+		step.buffer.clear(step.clearedChannels[i], 0, m_numSamples);
+
+	step.midi.clear();
+	for (int i = 0; i < step.midiInputs.size(); i++)
+		step.midi.addEvents(m_steps[step.midiInputs[i]]->midi, 0, -1, 0);
+
+	if (step.readOnly)
+		updateSharedChannels(step);
+
+	step.processor->processBlock(*step.output, step.midi);
+}
+
+void ParallelGraphRenderer::updateSharedChannels(Step& step)
+{
+	// The sources' channel pointers move when the block size changes, so the
+	// shared buffer is only pointed at them again when something differs; that
+	// keeps setDataToReferTo() and its allocation out of the steady state
+	bool changed = step.sharedSamples != m_numSamples;
+	for (int c = 0; c < step.numChannels; c++)
+	{
+		const int input = step.sharedInputs[c];
+		const float* channel;
+		if (input < 0)
+			channel = step.buffer.getReadPointer(c);
+		else
+		{
+			const ChannelInput& in = step.audioInputs.getReference(input);
+			channel = m_steps[in.sourceStep]->output->getReadPointer(in.sourceChannel);
+		}
+
+		if (step.channelPointers[c] != channel)
+		{
+			step.channelPointers[c] = const_cast<float*>(channel);
+			changed = true;
+		}
+	}
+
+	if (changed)
+	{
+		step.sharedBuffer.setDataToReferTo(step.channelPointers, step.numChannels, m_numSamples);
+		step.sharedSamples = m_numSamples;
+	}
+}
+
+void ParallelGraphRenderer::publish(int stepIndex)
+{
+	const int slot = m_writeIndex.fetch_add(1);
+	m_readyQueue[slot] = stepIndex;
+}
+
+void ParallelGraphRenderer::addMidiSources(int source, Array<int>& sources, int depth) const
+{
+	const Step* step = m_steps[source];
+	if (!step->passThrough || depth == 0)
+		sources.add(source);
+	else
+	{
+		for (int i = 0; i < step->midiInputs.size(); i++)
+			addMidiSources(step->midiInputs[i], sources, depth - 1);
+	}
+}
+
+int ParallelGraphRenderer::claim()
+{
+	int slot = m_readIndex.load();
+	while (slot < m_writeIndex.load())
+	{
+		const int stepIndex = m_readyQueue[slot].load();
+		if (stepIndex < 0)
+			return -1; // published slot not filled in yet
+		if (m_readIndex.compare_exchange_weak(slot, slot + 1))
+			return stepIndex;
+	}
+	return -1;
+}
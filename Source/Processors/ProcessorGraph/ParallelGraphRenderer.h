@@ -0,0 +1,144 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef PARALLELGRAPHRENDERER_H_INCLUDED
+#define PARALLELGRAPHRENDERER_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../GenericProcessor/LockedMemoryBlock.h"
+#include <atomic>
+
+/**
+	Renders an AudioProcessorGraph with independent branches running concurrently.
+
+	The dependency graph is built from the graph's connections when acquisition
+	starts. Every node gets its own audio and event buffers, so nodes that do not
+	feed each other (e.g. two sources, or the outputs of a Splitter) can be
+	processed at the same time on a small pool of persistent worker threads. The
+	audio thread takes part in the work and only returns once every node,
+	including the Record and Audio nodes which depend on all branches, is done.
+
+	Event inputs are merged in a fixed order, so the MidiBuffer a node receives
+	does not depend on which thread processed its sources.
+
+	Nodes that only read their continuous data (see
+	GenericProcessor::modifiesContinuousData()) are not given copies: each of
+	their channels fed by a single connection refers to the source's channel
+	directly, so the Record node or a display after a Splitter costs no copy.
+	Read-only nodes that emit no events either pass their inputs on unchanged:
+	the nodes after them read from their sources instead, and so run at the
+	same time as them rather than waiting.
+
+	The node buffers are laid out by LockedMemoryBlock, so every channel a
+	processor is given, its own or shared, is aligned and padded as described
+	there.
+
+	@see ProcessorGraph
+*/
+class ParallelGraphRenderer
+{
+public:
+	ParallelGraphRenderer(AudioProcessorGraph& graph, uint32 outputNodeId);
+	~ParallelGraphRenderer();
+
+	/** Builds the schedule from the current nodes and connections. Must be called
+	while the graph is not being rendered, after the nodes have been prepared.
+	Nodes in ignoredForWidth do not count as independent branches (e.g. sinks or
+	the MessageCenter); nodes in readOnlyNodes never write to their buffer and
+	may share their sources' channels, and those also in passThroughNodes add
+	no events. Returns false if the graph has a cycle, in which case the serial
+	renderer should be used. */
+	bool prepare(int maxBlockSize, int numThreads, const Array<uint32>& ignoredForWidth,
+		const Array<uint32>& readOnlyNodes, const Array<uint32>& passThroughNodes);
+
+	/** Renders one block. Called from the audio thread. */
+	void process(AudioSampleBuffer& buffer, MidiBuffer& midiMessages);
+
+	/** Returns the number of threads, including the audio thread, used for rendering */
+	int getNumThreads() const;
+
+private:
+	struct ChannelInput
+	{
+		int sourceStep;
+		int sourceChannel;
+		int destChannel;
+		bool add;
+		bool shared; // the destination refers to the source channel instead of copying it
+	};
+
+	struct Step
+	{
+		AudioProcessor* processor;
+		uint32 nodeId;
+		int numChannels;
+		bool readOnly;
+		bool passThrough; // read-only and emits no events
+		AudioSampleBuffer buffer;
+		LockedMemoryBlock bufferMemory;
+		MidiBuffer midi;
+
+		// What the processor is given and what its dependents read: buffer itself,
+		// or for read-only steps sharedBuffer, which refers to channelPointers
+		AudioSampleBuffer* output;
+		AudioSampleBuffer sharedBuffer;
+		HeapBlock<float*> channelPointers;
+		Array<int> sharedInputs; // per channel, index into audioInputs or -1
+		int sharedSamples;
+
+		Array<ChannelInput> audioInputs;
+		Array<int> clearedChannels;
+		Array<int> midiInputs;
+		Array<int> dependents;
+		int numDependencies;
+		std::atomic<int> pending;
+	};
+
+	class Worker;
+
+	void renderSteps();
+	void renderStep(Step& step);
+	void updateSharedChannels(Step& step);
+	void addMidiSources(int source, Array<int>& sources, int depth) const;
+	void publish(int stepIndex);
+	int claim();
+
+	AudioProcessorGraph& m_graph;
+	const uint32 m_outputNodeId;
+
+	OwnedArray<Step> m_steps;
+	Array<int> m_roots;
+	Array<ChannelInput> m_outputs;
+	OwnedArray<Worker> m_workers;
+
+	HeapBlock<std::atomic<int>> m_readyQueue;
+	std::atomic<int> m_readIndex;
+	std::atomic<int> m_writeIndex;
+	std::atomic<int> m_numCompleted;
+	std::atomic<int> m_activeWorkers;
+	int m_numSamples;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParallelGraphRenderer);
+};
+
+#endif  // PARALLELGRAPHRENDERER_H_INCLUDED
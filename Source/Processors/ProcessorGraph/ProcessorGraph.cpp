@@ -25,9 +25,15 @@
 #include <utility>
 #include <vector>
 #include <map>
+#include <algorithm>
 
 #include "ProcessorGraph.h"
+#include "ParallelGraphRenderer.h"
+#include "../GenericProcessor/TraceRecorder.h"
 #include "../GenericProcessor/GenericProcessor.h"
+#include "../GenericProcessor/GlobalClock.h"
+#include "../GenericProcessor/ProcessorThreadPool.h"
+#include "../GenericProcessor/ThreadPolicy.h"
 
 #include "../AudioNode/AudioNode.h"
 #include "../RecordNode/RecordNode.h"
@@ -37,11 +43,17 @@
 #include "../../UI/UIComponent.h"
 #include "../../UI/EditorViewport.h"
 #include "../../UI/TimestampSourceSelection.h"
+#include "../../Audio/AudioComponent.h"
 
 #include "../ProcessorManager/ProcessorManager.h"
 
-ProcessorGraph::ProcessorGraph() : currentNodeId(100)
+ProcessorGraph::ProcessorGraph() : currentNodeId(100),
+    m_numRenderThreads(1),
+    m_liveEditDepth(0),
+    m_deadlineMissFifo(numElementsInArray(m_deadlineMisses))
 {
+    m_numDeadlineMisses = 0;
+    m_policyThread = nullptr;
 
     // The ProcessorGraph will always have 0 inputs (all content is generated within graph)
     // but it will have N outputs, where N is the number of channels for the audio monitor
@@ -143,6 +155,9 @@ void ProcessorGraph::clearSignalChain()
         removeProcessor(processors[i]);
     }
 
+    // a loaded chain starts at the default speed; its File Reader re-applies a saved one
+    AccessClass::getAudioComponent()->resetPlaybackSpeed();
+
 }
 
 void ProcessorGraph::changeListenerCallback(ChangeBroadcaster* source)
@@ -176,22 +191,22 @@ void ProcessorGraph::restoreParameters()
 
     std::cout << "Restoring parameters for each processor..." << std::endl;
 
-    for (int i = 0; i < getNumNodes(); i++)
-    {
-        Node* node = getNode(i);
+    const double startTime = Time::getMillisecondCounterHiRes();
 
-        int nodeId = node->nodeId;
+    Array<GenericProcessor*> processors = getListOfProcessors();
 
-        if (nodeId != OUTPUT_NODE_ID &&
-            nodeId != AUDIO_NODE_ID &&
-            nodeId != RECORD_NODE_ID &&
-            nodeId != MESSAGE_CENTER_ID)
-        {
-            GenericProcessor* p =(GenericProcessor*) node->getProcessor();
-            p->loadFromXml();
-        }
-    }
+    // The processors were updated as they were added, so their channels already exist.
+    // What they restore is passed down the signal chain once, after all of them, instead
+    // of updating every processor after its own parameters and again after the next ones.
+    for (int i = 0; i < processors.size(); i++)
+        processors[i]->loadProcessorParametersFromXml();
+
+    AccessClass::getEditorViewport()->makeEditorVisible(nullptr, false, true);
+
+    for (int i = 0; i < processors.size(); i++)
+        processors[i]->loadChannelSettingsFromXml();
 
+    std::cout << "Parameters restored in " << int(Time::getMillisecondCounterHiRes() - startTime) << " ms" << std::endl;
 }
 
 Array<GenericProcessor*> ProcessorGraph::getListOfProcessors()
@@ -221,6 +236,8 @@ Array<GenericProcessor*> ProcessorGraph::getListOfProcessors()
 
 void ProcessorGraph::clearConnections()
 {
+    // the connections of the graph itself are only replaced by applyConnections()
+    m_queuedConnections.clear();
 
     for (int i = 0; i < getNumNodes(); i++)
     {
@@ -229,12 +246,6 @@ void ProcessorGraph::clearConnections()
 
         if (nodeId != OUTPUT_NODE_ID)
         {
-
-            if (nodeId != RECORD_NODE_ID && nodeId != AUDIO_NODE_ID)
-            {
-                disconnectNode(node->nodeId);
-            }
-
             GenericProcessor* p = (GenericProcessor*) node->getProcessor();
             p->resetConnections();
 
@@ -242,16 +253,78 @@ void ProcessorGraph::clearConnections()
     }
 
     // connect audio subnetwork
-    for (int n = 0; n < 2; n++)
+    queueConnections(AUDIO_NODE_ID, 0,
+                     OUTPUT_NODE_ID, 0, 2);
+
+    queueConnections(MESSAGE_CENTER_ID, midiChannelIndex,
+                     RECORD_NODE_ID, midiChannelIndex);
+}
+
+
+void ProcessorGraph::queueConnections(uint32 sourceNodeId, int firstSourceChannel,
+    uint32 destNodeId, int firstDestChannel, int numChannels)
+{
+    if (firstSourceChannel < 0 || firstDestChannel < 0)
+        return;
+
+    for (int n = 0; n < numChannels; n++)
+        m_queuedConnections.push_back(Connection(sourceNodeId, firstSourceChannel + n,
+                                                 destNodeId, firstDestChannel + n));
+}
+
+
+static bool connectionIsBefore(const AudioProcessorGraph::Connection& a, const AudioProcessorGraph::Connection& b)
+{
+    if (a.sourceNodeId != b.sourceNodeId)
+        return a.sourceNodeId < b.sourceNodeId;
+    if (a.destNodeId != b.destNodeId)
+        return a.destNodeId < b.destNodeId;
+    if (a.sourceChannelIndex != b.sourceChannelIndex)
+        return a.sourceChannelIndex < b.sourceChannelIndex;
+    return a.destChannelIndex < b.destChannelIndex;
+}
+
+
+int ProcessorGraph::applyConnections()
+{
+    std::vector<Connection>& wanted = m_queuedConnections;
+    std::sort(wanted.begin(), wanted.end(), connectionIsBefore);
+
+    std::vector<Connection> kept;
+    kept.reserve(getNumConnections());
+
+    int numChanged = 0;
+
+    // from the end, so that the indices of the connections still to check don't change
+    for (int i = getNumConnections(); --i >= 0;)
     {
+        const Connection* c = getConnection(i);
 
-        addConnection(AUDIO_NODE_ID, n,
-                      OUTPUT_NODE_ID, n);
+        if (std::binary_search(wanted.begin(), wanted.end(), *c, connectionIsBefore))
+        {
+            kept.push_back(*c);
+        }
+        else
+        {
+            removeConnection(i);
+            numChanged++;
+        }
+    }
 
+    std::sort(kept.begin(), kept.end(), connectionIsBefore);
+
+    for (const Connection& c : wanted)
+    {
+        if (!std::binary_search(kept.begin(), kept.end(), c, connectionIsBefore)
+            && addConnection(c.sourceNodeId, c.sourceChannelIndex, c.destNodeId, c.destChannelIndex))
+        {
+            numChanged++;
+        }
     }
 
-    addConnection(MESSAGE_CENTER_ID, midiChannelIndex,
-                  RECORD_NODE_ID, midiChannelIndex);
+    m_queuedConnections.clear();
+
+    return numChanged;
 }
 
 
@@ -427,6 +500,10 @@ void ProcessorGraph::updateConnections(Array<SignalChainTabButton*, CriticalSect
             connectProcessors(conn.source, dest, conn.connectContinuous, conn.connectEvents);
         }
     }
+
+    const int numQueued = int(m_queuedConnections.size());
+    const int numChanged = applyConnections();
+    std::cout << "Changed " << numChanged << " of " << numQueued << " connections." << std::endl;
 	
 	getAudioNode()->updatePlaybackBuffer();
 	//Update RecordNode internal channel mappings
@@ -445,27 +522,29 @@ void ProcessorGraph::connectProcessors(GenericProcessor* source, GenericProcesso
     std::cout << "     Connecting " << source->getName() << " " << source->getNodeId(); //" channel ";
     std::cout << " to " << dest->getName() << " " << dest->getNodeId() << std::endl;
 
-    // 1. connect continuous channels
+    // 1. connect continuous channels, to the next free inputs of the dest
     if (connectContinuous)
     {
-        for (int chan = 0; chan < source->getNumOutputs(); chan++)
-        {
-            //std::cout << chan << " ";
+        const int numChannels = source->getNumOutputs();
+        const int firstDestChannel = dest->getNextChannel(false);
 
-            addConnection(source->getNodeId(),         // sourceNodeID
-                          chan,                        // sourceNodeChannelIndex
-                          dest->getNodeId(),           // destNodeID
-                          dest->getNextChannel(true)); // destNodeChannelIndex
-        }
+        for (int chan = 0; chan < numChannels; chan++)
+            dest->getNextChannel(true);
+
+        queueConnections(source->getNodeId(),                                  // sourceNodeID
+                         0,                                                    // first sourceNodeChannelIndex
+                         dest->getNodeId(),                                    // destNodeID
+                         firstDestChannel,                                     // first destNodeChannelIndex
+                         jmin(numChannels, dest->getNumInputs() - firstDestChannel));
     }
 
     // 2. connect event channel
     if (connectEvents)
     {
-        addConnection(source->getNodeId(),    // sourceNodeID
-                      midiChannelIndex,       // sourceNodeChannelIndex
-                      dest->getNodeId(),      // destNodeID
-                      midiChannelIndex);      // destNodeChannelIndex
+        queueConnections(source->getNodeId(),    // sourceNodeID
+                         midiChannelIndex,       // sourceNodeChannelIndex
+                         dest->getNodeId(),      // destNodeID
+                         midiChannelIndex);      // destNodeChannelIndex
     }
 
 }
@@ -484,31 +563,31 @@ void ProcessorGraph::connectProcessorToAudioAndRecordNodes(GenericProcessor* sou
 
         getAudioNode()->addInputChannel(source, chan);
 
-        addConnection(source->getNodeId(),                   // sourceNodeID
-                      chan,                                  // sourceNodeChannelIndex
-                      AUDIO_NODE_ID,                         // destNodeID
-                      getAudioNode()->getNextChannel(true)); // destNodeChannelIndex
+        queueConnections(source->getNodeId(),                   // sourceNodeID
+                         chan,                                  // sourceNodeChannelIndex
+                         AUDIO_NODE_ID,                         // destNodeID
+                         getAudioNode()->getNextChannel(true)); // destNodeChannelIndex
 
         getRecordNode()->addInputChannel(source, chan);
 
-        addConnection(source->getNodeId(),                    // sourceNodeID
-                      chan,                                   // sourceNodeChannelIndex
-                      RECORD_NODE_ID,                         // destNodeID
-                      getRecordNode()->getNextChannel(true)); // destNodeChannelIndex
+        queueConnections(source->getNodeId(),                    // sourceNodeID
+                         chan,                                   // sourceNodeChannelIndex
+                         RECORD_NODE_ID,                         // destNodeID
+                         getRecordNode()->getNextChannel(true)); // destNodeChannelIndex
 
     }
 
     // connect event channel
-    addConnection(source->getNodeId(),    // sourceNodeID
-                  midiChannelIndex,       // sourceNodeChannelIndex
-                  RECORD_NODE_ID,         // destNodeID
-                  midiChannelIndex);      // destNodeChannelIndex
+    queueConnections(source->getNodeId(),    // sourceNodeID
+                     midiChannelIndex,       // sourceNodeChannelIndex
+                     RECORD_NODE_ID,         // destNodeID
+                     midiChannelIndex);      // destNodeChannelIndex
 
     // connect event channel
-    addConnection(source->getNodeId(),    // sourceNodeID
-                  midiChannelIndex,       // sourceNodeChannelIndex
-                  AUDIO_NODE_ID,          // destNodeID
-                  midiChannelIndex);      // destNodeChannelIndex
+    queueConnections(source->getNodeId(),    // sourceNodeID
+                     midiChannelIndex,       // sourceNodeChannelIndex
+                     AUDIO_NODE_ID,          // destNodeID
+                     midiChannelIndex);      // destNodeChannelIndex
 
 
     getRecordNode()->addInputChannel(source, midiChannelIndex);
@@ -576,6 +655,10 @@ void ProcessorGraph::removeProcessor(GenericProcessor* processor)
 
     int nodeId = processor->getNodeId();
 
+    // during a live edit it was already stopped; only its editor still shows acquisition
+    if (m_liveEditDepth > 0)
+        processor->disableEditor();
+
     disconnectNode(nodeId);
     removeNode(nodeId);
 
@@ -609,8 +692,31 @@ void ProcessorGraph::removeProcessor(GenericProcessor* processor)
 
 }
 
+namespace
+{
+	// prepares one processor per range, timing each
+	class PrepareJob : public ProcessorThreadPool::Job
+	{
+	public:
+		PrepareJob(const Array<GenericProcessor*>& p)
+			: processors(p), results(p.size(), 0), times(p.size(), 0.0) {}
+
+		void runRange(int rangeIndex) override
+		{
+			const double start = Time::getMillisecondCounterHiRes();
+			results[rangeIndex] = processors[rangeIndex]->prepareForAcquisition() ? 1 : 0;
+			times[rangeIndex] = Time::getMillisecondCounterHiRes() - start;
+		}
+
+		const Array<GenericProcessor*>& processors;
+		std::vector<char> results;
+		std::vector<double> times;
+	};
+}
+
 bool ProcessorGraph::enableProcessors()
 {
+    const double startTime = Time::getMillisecondCounterHiRes();
 
     updateConnections(AccessClass::getEditorViewport()->requestSignalChain());
 
@@ -624,40 +730,60 @@ bool ProcessorGraph::enableProcessors()
         return false;
     }
 
+    Array<GenericProcessor*> processors;
+
     for (int i = 0; i < getNumNodes(); i++)
     {
-
         Node* node = getNode(i);
 
         if (node->nodeId != OUTPUT_NODE_ID)
-        {
-            GenericProcessor* p = (GenericProcessor*) node->getProcessor();
-            allClear = p->isReady();
+            processors.add((GenericProcessor*) node->getProcessor());
+    }
 
-            if (!allClear)
-            {
-                std::cout << p->getName() << " said it's not OK." << std::endl;
-                //	sendActionMessage("Could not initialize acquisition.");
-                AccessClass::getUIComponent()->disableCallbacks();
-                return false;
+    // device handshakes and allocations of the processors don't depend on each other, so
+    // they run at the same time; the rest of the start-up stays on the message thread
+    PrepareJob prepareJob(processors);
 
-            }
-        }
+    if (! ProcessorThreadPool::getInstance()->run(prepareJob, processors.size()))
+    {
+        for (int i = 0; i < processors.size(); i++)
+            prepareJob.runRange(i);
     }
 
-    for (int i = 0; i < getNumNodes(); i++)
+    std::vector<double> readyTimes(processors.size(), 0.0);
+    std::vector<double> enableTimes(processors.size(), 0.0);
+
+    for (int i = 0; i < processors.size(); i++)
     {
+        GenericProcessor* p = processors[i];
 
-        Node* node = getNode(i);
+        const double readyStart = Time::getMillisecondCounterHiRes();
+        allClear = prepareJob.results[i] && p->isReady();
+        readyTimes[i] = Time::getMillisecondCounterHiRes() - readyStart;
 
-        if (node->nodeId != OUTPUT_NODE_ID)
+        if (!allClear)
         {
-            GenericProcessor* p = (GenericProcessor*) node->getProcessor();
-            p->enableEditor();
-            p->enableProcessor();
+            std::cout << p->getName() << " said it's not OK." << std::endl;
+            //	sendActionMessage("Could not initialize acquisition.");
+            AccessClass::getUIComponent()->disableCallbacks();
+            return false;
+
         }
     }
 
+	// Sources register their streams with the clock sync as they are enabled
+	m_clockSync.reset(getGlobalTimestampSourceFullId(), getGlobalSampleRate(false));
+
+    for (int i = 0; i < processors.size(); i++)
+    {
+        GenericProcessor* p = processors[i];
+
+        const double enableStart = Time::getMillisecondCounterHiRes();
+        p->enableEditor();
+        p->enableProcessor();
+        enableTimes[i] = Time::getMillisecondCounterHiRes() - enableStart;
+    }
+
     AccessClass::getEditorViewport()->signalChainCanBeEdited(false);
 
 	//Update special channels indexes, at the end
@@ -667,8 +793,19 @@ bool ProcessorGraph::enableProcessors()
 
     //	sendActionMessage("Acquisition started.");
 	m_startSoftTimestamp = Time::getHighResolutionTicks();
+	m_playbackSpeed = AccessClass::getAudioComponent()->getPlaybackSpeed();
+	GlobalClock::start(m_timestampSource, m_timestampSourceSubIdx, m_playbackSpeed);
 	if (m_timestampWindow)
 		m_timestampWindow->setAcquisitionState(true);
+
+    std::cout << "Acquisition started in " << int(Time::getMillisecondCounterHiRes() - startTime) << " ms" << std::endl;
+    for (int i = 0; i < processors.size(); i++)
+    {
+        std::cout << "    " << processors[i]->getNodeId() << " " << processors[i]->getName()
+                  << ": prepare " << int(prepareJob.times[i]) << " ms, ready " << int(readyTimes[i])
+                  << " ms, enable " << int(enableTimes[i]) << " ms" << std::endl;
+    }
+
     return true;
 }
 
@@ -677,6 +814,8 @@ bool ProcessorGraph::disableProcessors()
 
     std::cout << "Disabling processors..." << std::endl;
 
+	GlobalClock::stop();
+
     bool allClear;
 
     for (int i = 0; i < getNumNodes(); i++)
@@ -701,11 +840,133 @@ bool ProcessorGraph::disableProcessors()
     AccessClass::getEditorViewport()->signalChainCanBeEdited(true);
 	if (m_timestampWindow)
 		m_timestampWindow->setAcquisitionState(false);
+	m_clockSync.printSummary();
     //	sendActionMessage("Acquisition ended.");
 
     return true;
 }
 
+ProcessorGraph::LiveEdit::LiveEdit(ProcessorGraph& g)
+    : graph(g), startTime(Time::getMillisecondCounterHiRes())
+{
+    graph.beginLiveEdit(stoppedProcessors);
+}
+
+ProcessorGraph::LiveEdit::~LiveEdit()
+{
+    graph.endLiveEdit(stoppedProcessors);
+
+    std::cout << "Signal chain edited during acquisition in "
+              << int(Time::getMillisecondCounterHiRes() - startTime) << " ms" << std::endl;
+}
+
+bool ProcessorGraph::isEditingLive() const
+{
+    return m_liveEditDepth > 0;
+}
+
+void ProcessorGraph::beginLiveEdit(Array<GenericProcessor*>& stopped)
+{
+    // the recorded channels can't change under an open recording
+    jassert(!CoreServices::getRecordingStatus());
+
+    if (m_liveEditDepth++ > 0)
+        return;
+
+    // takes the callback lock just long enough to let the callback in progress finish;
+    // the callbacks that follow skip the graph until the edit ends, so none sees the
+    // chain half changed and none has to wait for the edit
+    suspendProcessing(true);
+
+    // the sources go on filling their buffers; everything that takes channels
+    // from them is stopped, as their channels may change
+    for (int i = 0; i < getNumNodes(); i++)
+    {
+        Node* node = getNode(i);
+        if (node->nodeId == OUTPUT_NODE_ID || node->nodeId == MESSAGE_CENTER_ID)
+            continue;
+
+        GenericProcessor* p = (GenericProcessor*) node->getProcessor();
+        if (p->isSource())
+            continue;
+
+        p->disableProcessor();
+        stopped.add(p);
+    }
+}
+
+void ProcessorGraph::endLiveEdit(const Array<GenericProcessor*>& stopped)
+{
+    if (--m_liveEditDepth > 0)
+        return;
+
+    updateConnections(AccessClass::getEditorViewport()->requestSignalChain());
+
+    Array<GenericProcessor*> processors;
+    Array<GenericProcessor*> added;
+
+    for (int i = 0; i < getNumNodes(); i++)
+    {
+        Node* node = getNode(i);
+        if (node->nodeId == OUTPUT_NODE_ID || node->nodeId == MESSAGE_CENTER_ID)
+            continue;
+
+        GenericProcessor* p = (GenericProcessor*) node->getProcessor();
+        if (stopped.contains(p))
+            processors.add(p);
+        else if (!p->isSource())
+        {
+            processors.add(p);
+            added.add(p);
+        }
+    }
+
+    PrepareJob prepareJob(processors);
+
+    if (! ProcessorThreadPool::getInstance()->run(prepareJob, processors.size()))
+    {
+        for (int i = 0; i < processors.size(); i++)
+            prepareJob.runRange(i);
+    }
+
+    String failed;
+
+    for (int i = 0; i < processors.size() && failed.isEmpty(); i++)
+    {
+        if (!prepareJob.results[i] || !processors[i]->isReady())
+            failed = processors[i]->getName();
+    }
+
+    if (failed.isEmpty())
+    {
+        for (int i = 0; i < processors.size(); i++)
+        {
+            if (added.contains(processors[i]))
+                processors[i]->enableEditor();
+            processors[i]->enableProcessor();
+        }
+
+        getRecordNode()->updateRecordChannelIndexes();
+        getAudioNode()->updateRecordChannelIndexes();
+
+        // builds the schedules of the new chain beside the old ones; only swapping
+        // them in takes the callback lock
+        AudioProcessorGraph::prepareToPlay(getSampleRate(), getBlockSize());
+        prepareRenderer(getBlockSize());
+    }
+    else
+    {
+        std::cout << failed << " said it's not OK." << std::endl;
+        CoreServices::sendStatusMessage(failed + " could not start, acquisition stopped.");
+
+        // the old schedules may still point at removed processors, so the graph stays
+        // suspended until the callbacks have stopped
+        AccessClass::getUIComponent()->disableCallbacks();
+    }
+
+    suspendProcessing(false);
+}
+
 void ProcessorGraph::setRecordState(bool isRecording)
 {
 
@@ -791,14 +1052,18 @@ void ProcessorGraph::getTimestampSources(int& selectedSource, int& selectedSubId
 
 int64 ProcessorGraph::getGlobalTimestamp(bool softwareOnly) const
 {
+	if (GlobalClock::isRunning())
+		return softwareOnly ? GlobalClock::getSoftwareTimestamp() : GlobalClock::getTimestamp();
+
 	if (softwareOnly || !m_timestampSource)
 	{
 		return (Time::getHighResolutionTicks() - m_startSoftTimestamp);
 	}
 	else
 	{
+		//Time since the last block advances the source clock by the playback speed, so nothing when unpaced
 		return static_cast<int64>((Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - m_timestampSource->getLastProcessedsoftwareTime())
-			* m_timestampSource->getSampleRate(m_timestampSourceSubIdx)) + m_timestampSource->getSourceTimestamp(m_timestampSource->getNodeId(), m_timestampSourceSubIdx));
+			* m_timestampSource->getSampleRate(m_timestampSourceSubIdx) * m_playbackSpeed) + m_timestampSource->getSourceTimestamp(m_timestampSource->getNodeId(), m_timestampSourceSubIdx));
 	}
 }
 
@@ -822,7 +1087,187 @@ uint32 ProcessorGraph::getGlobalTimestampSourceFullId() const
 	return GenericProcessor::getProcessorFullId(m_timestampSource->getNodeId(), m_timestampSourceSubIdx);
 }
 
+ClockSync& ProcessorGraph::getClockSync()
+{
+	return m_clockSync;
+}
+
 void ProcessorGraph::setTimestampWindow(TimestampSourceSelectionWindow* window)
 {
 	m_timestampWindow = window;
 }
+
+void ProcessorGraph::setNumRenderThreads(int numThreads)
+{
+	m_numRenderThreads = jmax(1, numThreads);
+}
+
+int ProcessorGraph::getNumRenderThreads() const
+{
+	return m_numRenderThreads;
+}
+
+void ProcessorGraph::prepareToPlay(double sampleRate, int estimatedSamplesPerBlock)
+{
+	AudioProcessorGraph::prepareToPlay(sampleRate, estimatedSamplesPerBlock);
+	m_callbackTime.reset();
+	m_numDeadlineMisses = 0;
+	m_deadlineMissFifo.reset();
+	m_policyThread = nullptr;
+
+	prepareRenderer(estimatedSamplesPerBlock);
+}
+
+void ProcessorGraph::prepareRenderer(int estimatedSamplesPerBlock)
+{
+	m_timedProcessors.clear();
+	Array<uint32> readOnly;
+	Array<uint32> passThrough;
+	for (int i = 0; i < getNumNodes(); i++)
+	{
+		if (GenericProcessor* p = dynamic_cast<GenericProcessor*>(getNode(i)->getProcessor()))
+		{
+			m_timedProcessors.add(p);
+			if (!p->modifiesContinuousData())
+				readOnly.add(getNode(i)->nodeId);
+			if (!p->modifiesContinuousData() && !p->emitsEvents())
+				passThrough.add(getNode(i)->nodeId);
+		}
+	}
+
+	// The sinks and the MessageCenter wait on every branch or do no real work,
+	// so they don't make a chain worth splitting across threads
+	Array<uint32> ignored;
+	ignored.add(RECORD_NODE_ID);
+	ignored.add(AUDIO_NODE_ID);
+	ignored.add(MESSAGE_CENTER_ID);
+
+	// Also used with a single thread: its buffers are the aligned ones the
+	// plugins are promised, and it spares read-only processors (the Record
+	// node, displays) a copy of their inputs
+	ScopedPointer<ParallelGraphRenderer> renderer = new ParallelGraphRenderer(*this, OUTPUT_NODE_ID);
+	if (!renderer->prepare(estimatedSamplesPerBlock, m_numRenderThreads, ignored, readOnly, passThrough))
+		renderer = nullptr;
+	else
+		std::cout << "Rendering signal chain on " << renderer->getNumThreads() << " threads" << std::endl;
+
+	const ScopedLock sl(getCallbackLock());
+	m_parallelRenderer.swapWith(renderer);
+}
+
+void ProcessorGraph::releaseResources()
+{
+	{
+		const ScopedLock sl(getCallbackLock());
+		m_parallelRenderer = nullptr;
+		m_timedProcessors.clear();
+	}
+	AudioProcessorGraph::releaseResources();
+
+	if (m_numDeadlineMisses.load() > 0)
+		std::cout << m_numDeadlineMisses.load() << " callbacks took longer than their buffer duration" << std::endl;
+}
+
+void ProcessorGraph::processBlock(AudioSampleBuffer& buffer, MidiBuffer& midiMessages)
+{
+	TraceRecorder::Scope trace("Graph callback");
+
+	// The callback runs on a thread owned by the audio device or the batch driver,
+	// so the policy is applied by the first callback on each new thread
+	const Thread::ThreadID callbackThread = Thread::getCurrentThreadId();
+	if (m_policyThread.exchange(callbackThread) != callbackThread)
+		ThreadPolicy::applyToCurrentThread(ThreadPolicy::AudioCallback);
+
+	const int64 start = Time::getHighResolutionTicks();
+	const int64 startTimestamp = getGlobalTimestamp(false);
+
+	if (m_parallelRenderer != nullptr)
+		m_parallelRenderer->process(buffer, midiMessages);
+	else
+		AudioProcessorGraph::processBlock(buffer, midiMessages);
+
+	const int64 elapsed = Time::getHighResolutionTicks() - start;
+	m_callbackTime.addSample(elapsed);
+	checkDeadline(startTimestamp, elapsed, buffer.getNumSamples());
+}
+
+void ProcessorGraph::checkDeadline(int64 startTimestamp, int64 elapsedTicks, int numSamples)
+{
+	if (getSampleRate() <= 0)
+		return;
+
+	const double budgetMs = numSamples / getSampleRate() * 1000.0;
+	const double elapsedMs = Time::highResolutionTicksToSeconds(elapsedTicks) * 1000.0;
+	if (elapsedMs <= budgetMs)
+		return;
+
+	m_numDeadlineMisses.fetch_add(1);
+
+	DeadlineMiss miss;
+	miss.timestamp = startTimestamp;
+	miss.elapsedMs = elapsedMs;
+	miss.budgetMs = budgetMs;
+	miss.slowestProcessor = nullptr;
+	miss.slowestMs = 0;
+	for (int i = 0; i < m_timedProcessors.size(); i++)
+	{
+		const double ms = m_timedProcessors[i]->getLastProcessTimeMs();
+		if (ms > miss.slowestMs)
+		{
+			miss.slowestMs = ms;
+			miss.slowestProcessor = m_timedProcessors[i];
+		}
+	}
+
+	// If the MessageCenter can't keep up the miss is still counted, just not written
+	int start1, size1, start2, size2;
+	m_deadlineMissFifo.prepareToWrite(1, start1, size1, start2, size2);
+	if (size1 > 0)
+	{
+		m_deadlineMisses[start1] = miss;
+		m_deadlineMissFifo.finishedWrite(1);
+	}
+}
+
+int64 ProcessorGraph::getNumDeadlineMisses() const
+{
+	return m_numDeadlineMisses.load();
+}
+
+bool ProcessorGraph::getNextDeadlineMiss(DeadlineMiss& miss)
+{
+	int start1, size1, start2, size2;
+	m_deadlineMissFifo.prepareToRead(1, start1, size1, start2, size2);
+	if (size1 == 0)
+		return false;
+
+	miss = m_deadlineMisses[start1];
+	m_deadlineMissFifo.finishedRead(1);
+	return true;
+}
+
+double ProcessorGraph::getCallbackBudgetMs() const
+{
+	return getSampleRate() > 0 ? getBlockSize() / getSampleRate() * 1000.0 : 0;
+}
+
+ProcessTimeStatistics::Summary ProcessorGraph::getProcessorLoads(Array<ProcessorLoad>& loads, double& budgetMs) const
+{
+	budgetMs = getCallbackBudgetMs();
+
+	loads.clear();
+	for (int i = 0; i < getNumNodes(); i++)
+	{
+		GenericProcessor* p = dynamic_cast<GenericProcessor*>(getNode(i)->getProcessor());
+		if (p == nullptr)
+			continue;
+
+		ProcessorLoad load;
+		load.processor = p;
+		load.time = p->getProcessTimeSummary();
+		load.budgetFraction = budgetMs > 0 ? load.time.meanMs / budgetMs : 0;
+		loads.add(load);
+	}
+
+	return m_callbackTime.getSummary();
+}
@@ -27,6 +27,10 @@
 #include "../../../JuceLibraryCode/JuceHeader.h"
 
 #include "../../AccessClass.h"
+#include "../GenericProcessor/ProcessTimeStatistics.h"
+#include "ClockSync.h"
+#include <atomic>
+#include <vector>
 
 class GenericProcessor;
 class RecordNode;
@@ -34,6 +38,7 @@ class AudioNode;
 class MessageCenter;
 class SignalChainTabButton;
 class TimestampSourceSelectionWindow;
+class ParallelGraphRenderer;
 
 /**
   Owns all processors and constructs the signal chain.
@@ -66,6 +71,33 @@ public:
     bool enableProcessors();
     bool disableProcessors();
 
+    /** Lets processors be added to, removed from and reconnected in the signal chain
+        while acquisition runs, for as long as it exists.
+
+        The graph is suspended, so the callbacks go on without running it, and every
+        processor but the sources and the MessageCenter is stopped; the sources keep
+        acquiring into their own buffers. When it is deleted, the new processors are
+        prepared, the connections and the render schedule are rebuilt beside the old
+        ones and swapped in, and the graph is resumed. The callback lock is only taken
+        to suspend, swap and resume. Only meant for the message thread while not recording.
+    */
+    class LiveEdit
+    {
+    public:
+        LiveEdit(ProcessorGraph& graph);
+        ~LiveEdit();
+
+    private:
+        ProcessorGraph& graph;
+        Array<GenericProcessor*> stoppedProcessors;
+        double startTime;
+
+        JUCE_DECLARE_NON_COPYABLE(LiveEdit);
+    };
+
+    /** Returns true while a LiveEdit is open */
+    bool isEditingLive() const;
+
     RecordNode* getRecordNode();
     AudioNode* getAudioNode();
     MessageCenter* getMessageCenter();
@@ -99,8 +131,59 @@ public:
 
 	uint32 getGlobalTimestampSourceFullId() const;
 
+	/** Aligns the other sources to the global timestamp source using shared TTL sync pulses */
+	ClockSync& getClockSync();
+
 	void setTimestampWindow(TimestampSourceSelectionWindow* window);
 
+	/** Sets how many threads, including the audio thread, may render independent
+	branches of the signal chain. 1, the default, renders the whole graph serially.
+	Saved with the window state. Takes effect the next time acquisition starts. */
+	void setNumRenderThreads(int numThreads);
+
+	int getNumRenderThreads() const;
+
+	/** Process time of one processor in the current signal chain */
+	struct ProcessorLoad
+	{
+		GenericProcessor* processor;
+		ProcessTimeStatistics::Summary time;
+		/** Mean process time as a fraction of the callback budget */
+		double budgetFraction;
+	};
+
+	/** Fills loads with the process time of every processor in the graph and returns
+	the statistics of the whole graph callback. budgetMs is set to the duration of
+	one buffer, which is the time a callback may take before it falls behind. */
+	ProcessTimeStatistics::Summary getProcessorLoads(Array<ProcessorLoad>& loads, double& budgetMs) const;
+
+	/** Returns the duration of one buffer in milliseconds */
+	double getCallbackBudgetMs() const;
+
+	/** A graph callback that took longer than the duration of its buffer */
+	struct DeadlineMiss
+	{
+		/** Global timestamp at the start of the callback */
+		int64 timestamp;
+		double elapsedMs;
+		double budgetMs;
+		const GenericProcessor* slowestProcessor;
+		double slowestMs;
+	};
+
+	/** Returns the number of callbacks that overran since acquisition started */
+	int64 getNumDeadlineMisses() const;
+
+	/** Takes the oldest deadline miss that hasn't been reported yet. Called by the
+	MessageCenter from the graph callback, which writes them to the recording. */
+	bool getNextDeadlineMiss(DeadlineMiss& miss);
+
+	void prepareToPlay(double sampleRate, int estimatedSamplesPerBlock) override;
+	void releaseResources() override;
+
+	using AudioProcessorGraph::processBlock;
+	void processBlock(AudioSampleBuffer& buffer, MidiBuffer& midiMessages) override;
+
 private:
     int currentNodeId;
 
@@ -118,11 +201,49 @@ private:
         bool connectContinuous, bool connectEvents);
     void connectProcessorToAudioAndRecordNodes(GenericProcessor* source);
 
+    /** Queues numChannels channel connections, from consecutive source channels to consecutive
+        dest channels, for applyConnections(). Channels below zero are skipped, as addConnection()
+        would refuse them. */
+    void queueConnections(uint32 sourceNodeId, int firstSourceChannel,
+        uint32 destNodeId, int firstDestChannel, int numChannels = 1);
+
+    /** Makes the connections of the graph the ones queued since clearConnections(). Only the
+        connections that changed are removed or added, so editing one processor doesn't rebuild
+        the connections of the whole signal chain. Returns the number of connections changed. */
+    int applyConnections();
+
+    // connections wanted by the signal chain being built by updateConnections()
+    std::vector<Connection> m_queuedConnections;
+
 	int64 m_startSoftTimestamp{ 0 };
+	double m_playbackSpeed{ 1.0 };
 	const GenericProcessor* m_timestampSource{ nullptr };
 	int m_timestampSourceSubIdx;
 	Array<const GenericProcessor*> m_validTimestampSources;
 	WeakReference<TimestampSourceSelectionWindow> m_timestampWindow;
+	ClockSync m_clockSync;
+
+	int m_numRenderThreads;
+	ScopedPointer<ParallelGraphRenderer> m_parallelRenderer;
+
+	ProcessTimeStatistics m_callbackTime;
+
+	void checkDeadline(int64 startTimestamp, int64 elapsedTicks, int numSamples);
+
+	/** Builds the render schedule of the current nodes and connections and swaps it in */
+	void prepareRenderer(int estimatedSamplesPerBlock);
+
+	void beginLiveEdit(Array<GenericProcessor*>& stopped);
+	void endLiveEdit(const Array<GenericProcessor*>& stopped);
+	int m_liveEditDepth;
+
+	Array<GenericProcessor*> m_timedProcessors;
+	std::atomic<int64> m_numDeadlineMisses;
+	AbstractFifo m_deadlineMissFifo;
+	DeadlineMiss m_deadlineMisses[64];
+
+	/** Callback thread the audio callback ThreadPolicy was last applied to */
+	std::atomic<Thread::ThreadID> m_policyThread;
 };
 
 
@@ -0,0 +1,127 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "BenchmarkHelpers.h"
+
+//Samples of synthetic data per channel, played in a loop
+#define BENCHMARK_TABLE_SAMPLES 16384
+
+double BenchmarkHelpers::ticksToNs(int64 ticks)
+{
+	return Time::highResolutionTicksToSeconds(ticks) * 1e9;
+}
+
+double BenchmarkHelpers::ticksToMs(int64 ticks)
+{
+	return Time::highResolutionTicksToSeconds(ticks) * 1e3;
+}
+
+void BenchmarkHelpers::processBlock(AudioProcessor& processor, AudioSampleBuffer& buffer, MidiBuffer& eventBuffer)
+{
+	processor.processBlock(buffer, eventBuffer);
+}
+
+BenchmarkSource::BenchmarkSource(int nodeId, int numChannels, float sampleRate) :
+	GenericProcessor("Benchmark Source"),
+	m_sampleRate(sampleRate),
+	m_timestamp(0),
+	m_position(0)
+{
+	setNodeId(nodeId);
+	for (int i = 0; i < numChannels; ++i)
+	{
+		DataChannel* chan = new DataChannel(DataChannel::HEADSTAGE_CHANNEL, sampleRate, this);
+		chan->setBitVolts(0.195f);
+		chan->setRecordState(true);
+		dataChannelArray.add(chan);
+	}
+	settings.numOutputs = dataChannelArray.size();
+	updateChannelIndexes();
+}
+
+void BenchmarkSource::addTTLChannel()
+{
+	eventChannelArray.add(new EventChannel(EventChannel::TTL, 8, 1, m_sampleRate, this));
+	updateChannelIndexes();
+}
+
+void BenchmarkSource::addElectrodes(int numElectrodes)
+{
+	for (int i = 0; i < numElectrodes; ++i)
+	{
+		Array<const DataChannel*> sourceChannels;
+		sourceChannels.add(dataChannelArray[i]);
+		SpikeChannel* chan = new SpikeChannel(SpikeChannel::SINGLE, this, sourceChannels);
+		chan->setNumSamples(spikePreSamples, spikePostSamples);
+		spikeChannelArray.add(chan);
+	}
+	updateChannelIndexes();
+}
+
+bool BenchmarkSource::enable()
+{
+	const int numChannels = dataChannelArray.size();
+	if (m_table.getNumChannels() == numChannels)
+		return true;
+
+	//Noise and LFP in microvolts, and the spikes
+	Random random(1);
+	m_table.setSize(numChannels, BENCHMARK_TABLE_SAMPLES);
+	for (int c = 0; c < numChannels; ++c)
+	{
+		float* data = m_table.getWritePointer(c);
+		for (int s = 0; s < BENCHMARK_TABLE_SAMPLES; ++s)
+		{
+			float noise = (random.nextFloat() + random.nextFloat() + random.nextFloat() - 1.5f) * 20.0f;
+			data[s] = noise + 50.0f * std::sin(2.0f * float_Pi * 8.0f * s / m_sampleRate);
+		}
+		int spike = random.nextInt(roundToInt(0.02f * m_sampleRate));
+		while (spike + spikePreSamples + spikePostSamples < BENCHMARK_TABLE_SAMPLES)
+		{
+			for (int s = 0; s < spikePreSamples + spikePostSamples; ++s)
+			{
+				float x = float(s - spikePreSamples);
+				data[spike + s] += -120.0f * std::exp(-x * x / 8.0f) + 30.0f * std::exp(-(x - 8.0f) * (x - 8.0f) / 32.0f);
+			}
+			spike += roundToInt((0.02f + 0.02f * random.nextFloat()) * m_sampleRate);
+		}
+	}
+	return true;
+}
+
+void BenchmarkSource::process(AudioSampleBuffer& buffer)
+{
+	const int blockSize = buffer.getNumSamples();
+	setTimestampAndSamples(m_timestamp, blockSize);
+
+	int done = 0;
+	while (done < blockSize && m_table.getNumSamples() > 0)
+	{
+		const int count = jmin(blockSize - done, BENCHMARK_TABLE_SAMPLES - m_position);
+		for (int c = 0; c < m_table.getNumChannels(); ++c)
+			buffer.copyFrom(c, done, m_table, c, m_position, count);
+		done += count;
+		m_position = (m_position + count) % BENCHMARK_TABLE_SAMPLES;
+	}
+	m_timestamp += blockSize;
+}
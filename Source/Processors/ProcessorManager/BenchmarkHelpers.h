@@ -0,0 +1,88 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef BENCHMARKHELPERS_H_INCLUDED
+#define BENCHMARKHELPERS_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../GenericProcessor/GenericProcessor.h"
+
+/** Tools shared by the command line benchmarks*/
+namespace BenchmarkHelpers
+{
+	double ticksToNs(int64 ticks);
+	double ticksToMs(int64 ticks);
+
+	/** Runs a block through a processor as the graph does. GenericProcessor keeps processBlock
+	private, the graph calls it through AudioProcessor*/
+	void processBlock(AudioProcessor& processor, AudioSampleBuffer& buffer, MidiBuffer& eventBuffer);
+}
+
+/**
+
+  Source processor of the benchmarks.
+
+  It owns the info objects of its data channels, all set to record, and optionally of a TTL
+  channel and of single electrodes on its first channels. Once enabled, it copies precomputed
+  synthetic neural data into every block: noise, an 8 Hz LFP and a spike every 20 to 40 ms on
+  every channel, staggered across channels so detectors see a steady load. Its own time is
+  only that of the copy.
+
+  @see ProcessorBenchmark, RecordBenchmark, RoundTripBenchmark
+
+*/
+class BenchmarkSource : public GenericProcessor
+{
+public:
+	BenchmarkSource(int nodeId, int numChannels, float sampleRate);
+
+	/** Adds an 8 line TTL event channel*/
+	void addTTLChannel();
+
+	/** Adds a single electrode on each of the first numElectrodes channels*/
+	void addElectrodes(int numElectrodes);
+
+	bool isSource() const override { return true; }
+	bool isGeneratesTimestamps() const override { return true; }
+	float getSampleRate(int) const override { return m_sampleRate; }
+	float getDefaultSampleRate() const override { return m_sampleRate; }
+
+	/** Computes the synthetic data, the first time only*/
+	bool enable() override;
+
+	void process(AudioSampleBuffer& buffer) override;
+
+	/** Samples before and after the peak of the synthetic spikes and of the electrodes*/
+	static const int spikePreSamples = 8;
+	static const int spikePostSamples = 32;
+
+private:
+	const float m_sampleRate;
+	AudioSampleBuffer m_table;
+	int64 m_timestamp;
+	int m_position;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BenchmarkSource);
+};
+
+#endif  // BENCHMARKHELPERS_H_INCLUDED
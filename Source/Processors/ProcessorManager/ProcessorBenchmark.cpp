@@ -0,0 +1,296 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ProcessorBenchmark.h"
+#include "BenchmarkHelpers.h"
+#include "ProcessorManager.h"
+#include "../GenericProcessor/GenericProcessor.h"
+
+//Node ID of the synthetic source, the processor under test follows it. Kept below the ids
+//of the special processors, as in the event benchmark
+#define PROCESSOR_BENCHMARK_NODE_ID 850
+
+ProcessorBenchmarkSettings::ProcessorBenchmarkSettings() :
+	sampleRate(30000.0f),
+	seconds(2.0),
+	warmupSeconds(0.2)
+{
+	processors.add("Bandpass Filter");
+	processors.add("Common Avg Ref");
+	processors.add("Channel Map");
+	processors.add("Spike Detector");
+	processors.add("Spike Sorter");
+	processors.add("Phase Detector");
+	processors.add("Rectifier");
+	channelCounts.add(32);
+	channelCounts.add(128);
+	channelCounts.add(512);
+	blockSizes.add(128);
+	blockSizes.add(1024);
+}
+
+static Array<int> parseIntList(const String& value)
+{
+	StringArray tokens;
+	tokens.addTokens(value, ",", String::empty);
+	Array<int> values;
+	for (int i = 0; i < tokens.size(); ++i)
+	{
+		if (tokens[i].getIntValue() > 0)
+			values.add(tokens[i].getIntValue());
+	}
+	return values;
+}
+
+void ProcessorBenchmarkSettings::parse(const StringArray& options)
+{
+	for (int i = 0; i < options.size(); ++i)
+	{
+		String key = options[i].upToFirstOccurrenceOf("=", false, false).toLowerCase();
+		String value = options[i].fromFirstOccurrenceOf("=", false, false);
+
+		if (key == "processors")
+		{
+			//Underscores stand for spaces, so names can be given without quoting
+			processors.clear();
+			processors.addTokens(value.replaceCharacter('_', ' '), ",", String::empty);
+			processors.trim();
+			processors.removeEmptyStrings();
+		}
+		else if (key == "channels")
+			channelCounts = parseIntList(value);
+		else if (key == "blocks")
+			blockSizes = parseIntList(value);
+		else if (key == "rate")
+			sampleRate = jmax(1.0f, value.getFloatValue());
+		else if (key == "seconds")
+			seconds = jmax(0.01, value.getDoubleValue());
+		else if (key == "warmup")
+			warmupSeconds = jmax(0.0, value.getDoubleValue());
+		else if (key == "settings")
+			settingsFile = File::getCurrentWorkingDirectory().getChildFile(value);
+		else
+			std::cerr << "Unknown processor benchmark option " << options[i] << std::endl;
+	}
+}
+
+ProcessorBenchmark::ProcessorBenchmark(const ProcessorBenchmarkSettings& settings) :
+	m_settings(settings)
+{
+	if (m_settings.settingsFile != File::nonexistent)
+	{
+		m_savedChain = XmlDocument::parse(m_settings.settingsFile);
+		if (m_savedChain == nullptr)
+			std::cerr << "Processor benchmark: could not read " << m_settings.settingsFile.getFullPathName() << std::endl;
+	}
+}
+
+ProcessorBenchmark::~ProcessorBenchmark()
+{
+}
+
+int ProcessorBenchmark::findProcessor(const String& name)
+{
+	for (int i = 0; i < ProcessorManager::getNumProcessors(PluginProcessor); ++i)
+	{
+		String processorName;
+		int type;
+		ProcessorManager::getProcessorNameAndType(PluginProcessor, i, processorName, type);
+		if (processorName.equalsIgnoreCase(name))
+			return i;
+	}
+	return -1;
+}
+
+XmlElement* ProcessorBenchmark::createSettings(const String& name, int numChannels) const
+{
+	if (m_savedChain != nullptr)
+	{
+		XmlElement* chain = m_savedChain->getChildByName("SIGNALCHAIN");
+		if (chain == nullptr)
+			chain = m_savedChain;
+		forEachXmlChildElementWithTagName(*chain, processor, "PROCESSOR")
+		{
+			if (processor->getStringAttribute("name").fromLastOccurrenceOf("/", false, false).equalsIgnoreCase(name))
+				return new XmlElement(*processor);
+		}
+	}
+	return createDefaultSettings(name, numChannels);
+}
+
+XmlElement* ProcessorBenchmark::createDefaultSettings(const String& name, int numChannels)
+{
+	//Both spike processors only look at the channels of their electrodes, so give them
+	//tetrodes over all the channels, in the format they save
+	const bool detector = name.equalsIgnoreCase("Spike Detector");
+	const bool sorter = name.equalsIgnoreCase("Spike Sorter");
+	if (!detector && !sorter)
+		return nullptr;
+
+	XmlElement* processor = new XmlElement("PROCESSOR");
+	processor->setAttribute("name", name);
+	XmlElement* parent = processor;
+	if (sorter)
+	{
+		parent = processor->createNewChildElement("SpikeSorter");
+		parent->setAttribute("activeElectrode", 0);
+		parent->setAttribute("numPreSamples", BenchmarkSource::spikePreSamples);
+		parent->setAttribute("numPostSamples", BenchmarkSource::spikePostSamples);
+		parent->setAttribute("uniqueID", numChannels / 4);
+	}
+
+	for (int e = 0; e < numChannels / 4; ++e)
+	{
+		XmlElement* electrode = parent->createNewChildElement("ELECTRODE");
+		electrode->setAttribute("name", "Tetrode " + String(e + 1));
+		electrode->setAttribute("numChannels", 4);
+		electrode->setAttribute("prePeakSamples", BenchmarkSource::spikePreSamples);
+		electrode->setAttribute("postPeakSamples", BenchmarkSource::spikePostSamples);
+		electrode->setAttribute("electrodeID", e + 1);
+		for (int c = 0; c < 4; ++c)
+		{
+			XmlElement* channel = electrode->createNewChildElement("SUBCHANNEL");
+			channel->setAttribute("ch", e * 4 + c);
+			channel->setAttribute("thresh", 50.0);
+			channel->setAttribute("isActive", true);
+		}
+	}
+	return processor;
+}
+
+bool ProcessorBenchmark::runCase(int pluginIndex, const String& name, int numChannels, int blockSize, Result& result)
+{
+	ScopedPointer<BenchmarkSource> source = new BenchmarkSource(PROCESSOR_BENCHMARK_NODE_ID, numChannels, m_settings.sampleRate);
+	source->enableProcessor();
+
+	ScopedPointer<GenericProcessor> processor = ProcessorManager::createProcessor(PluginProcessor, pluginIndex);
+	if (processor == nullptr)
+	{
+		std::cerr << "Processor benchmark: could not create " << name << std::endl;
+		return false;
+	}
+	processor->setNodeId(PROCESSOR_BENCHMARK_NODE_ID + 1);
+	//update() also updates the editor, so it needs one as in the signal chain
+	processor->createEditor();
+	processor->setSourceNode(source);
+
+	ScopedPointer<XmlElement> processorSettings = createSettings(name, numChannels);
+	if (processorSettings != nullptr)
+	{
+		processor->parametersAsXml = processorSettings;
+		processor->loadFromXml();
+	}
+	else
+		processor->update();
+
+	if (!processor->prepareForAcquisition() || !processor->isReady())
+	{
+		std::cerr << "Processor benchmark: " << name << " is not ready with " << numChannels << " channels" << std::endl;
+		processor->parametersAsXml = nullptr;
+		return false;
+	}
+	processor->enableEditor();
+	processor->enableProcessor();
+
+	AudioSampleBuffer buffer(jmax(numChannels, processor->getNumOutputs()), blockSize);
+	buffer.clear();
+	MidiBuffer eventBuffer;
+	eventBuffer.ensureSize(65536);
+
+	const int numWarmupBlocks = roundToInt(m_settings.warmupSeconds * m_settings.sampleRate / blockSize);
+	const int numBlocks = jmax(1, roundToInt(m_settings.seconds * m_settings.sampleRate / blockSize));
+	ProcessTimeStatistics blockTimes;
+	int64 totalTicks = 0;
+
+	for (int block = 0; block < numWarmupBlocks + numBlocks; ++block)
+	{
+		eventBuffer.clear();
+		BenchmarkHelpers::processBlock(*source, buffer, eventBuffer);
+
+		int64 start = Time::getHighResolutionTicks();
+		BenchmarkHelpers::processBlock(*processor, buffer, eventBuffer);
+		int64 ticks = Time::getHighResolutionTicks() - start;
+
+		if (block >= numWarmupBlocks)
+		{
+			totalTicks += ticks;
+			blockTimes.addSample(ticks);
+		}
+	}
+
+	processor->disableEditor();
+	processor->disableProcessor();
+	processor->parametersAsXml = nullptr;
+
+	const double samples = double(numBlocks) * blockSize;
+	result.nsPerSample = BenchmarkHelpers::ticksToNs(totalTicks) / (samples * numChannels);
+	result.meanBlockMs = BenchmarkHelpers::ticksToNs(totalTicks) / numBlocks / 1e6;
+	result.p99BlockMs = blockTimes.getSummary().p99Ms;
+	result.realtimeFactor = samples / m_settings.sampleRate / jmax(1e-9, Time::highResolutionTicksToSeconds(totalTicks));
+	return true;
+}
+
+bool ProcessorBenchmark::run(std::ostream& out)
+{
+	out << "Processor benchmark: " << m_settings.sampleRate << " Hz, " << m_settings.seconds << " s of data per case" << std::endl;
+
+	bool allRan = true;
+	for (int p = 0; p < m_settings.processors.size(); ++p)
+	{
+		const String& name = m_settings.processors[p];
+		int pluginIndex = findProcessor(name);
+		if (pluginIndex < 0)
+		{
+			std::cerr << "Processor benchmark: no plugin processor named " << name << std::endl;
+			allRan = false;
+			continue;
+		}
+
+		out << "  " << name << std::endl;
+		for (int c = 0; c < m_settings.channelCounts.size(); ++c)
+		{
+			for (int b = 0; b < m_settings.blockSizes.size(); ++b)
+			{
+				Result result;
+				if (!runCase(pluginIndex, name, m_settings.channelCounts[c], m_settings.blockSizes[b], result))
+				{
+					allRan = false;
+					continue;
+				}
+				out << "    " << m_settings.channelCounts[c] << " channels, " << m_settings.blockSizes[b] << " sample blocks: "
+					<< result.nsPerSample << " ns/sample/channel, " << result.meanBlockMs << " ms/block mean, "
+					<< result.p99BlockMs << " ms p99, " << result.realtimeFactor << "x realtime" << std::endl;
+			}
+		}
+	}
+	return allRan;
+}
+
+bool ProcessorBenchmark::runFromCommandLine(const StringArray& options)
+{
+	ProcessorBenchmarkSettings settings;
+	settings.parse(options);
+
+	ProcessorBenchmark benchmark(settings);
+	return benchmark.run(std::cout);
+}
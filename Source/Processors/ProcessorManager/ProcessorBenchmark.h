@@ -0,0 +1,112 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef PROCESSORBENCHMARK_H_INCLUDED
+#define PROCESSORBENCHMARK_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../GenericProcessor/GenericProcessor.h"
+#include "../GenericProcessor/ProcessTimeStatistics.h"
+
+struct ProcessorBenchmarkSettings
+{
+	ProcessorBenchmarkSettings();
+
+	/** Reads "key=value" options, e.g. channels=64,256 blocks=128,1024. Unknown keys are reported and ignored*/
+	void parse(const StringArray& options);
+
+	/** Plugin processor names, as shown in the processor list*/
+	StringArray processors;
+	Array<int> channelCounts;
+	Array<int> blockSizes;
+	float sampleRate;
+	double seconds;
+	double warmupSeconds;
+
+	/** Saved signal chain whose PROCESSOR elements configure the processors of the same name*/
+	File settingsFile;
+};
+
+/**
+
+  Measures the process() cost of plugin processors outside a running signal chain.
+
+  For every processor, channel count and block size, the processor is created from its
+  plugin, connected to a BenchmarkSource and updated and enabled as the graph would do.
+  Blocks of synthetic neural data (noise, an 8 Hz LFP and spikes every few tens of ms on
+  every channel) are then run through it back to back on the calling thread. The source
+  only copies precomputed data into the buffer and its time is not counted.
+
+  Processors that do nothing until configured, such as the spike detector and sorter, get
+  tetrodes over all channels. Any processor can instead take the settings saved for it in a
+  signal chain file (settings=<file>).
+
+  The report gives ns per sample per channel, the mean and p99 block time and the realtime
+  factor of each case, so changes in the cost of a processor show before they do on a rig.
+
+  Started from the command line with --benchmark-processors [key=value ...], or by building
+  the benchmarks target.
+
+  @see EventBenchmark, RecordBenchmark
+
+*/
+class ProcessorBenchmark
+{
+public:
+	ProcessorBenchmark(const ProcessorBenchmarkSettings& settings);
+	~ProcessorBenchmark();
+
+	/** Runs every case on the calling thread, printing a line per case. Returns false if a
+	processor could not be found or set up*/
+	bool run(std::ostream& out);
+
+	static bool runFromCommandLine(const StringArray& options);
+
+	/** Index of the plugin processor with the given name, or -1*/
+	static int findProcessor(const String& name);
+
+	/** Settings for the processors that do nothing until configured: tetrodes over all the
+	channels for the spike detector and sorter. nullptr for the others*/
+	static XmlElement* createDefaultSettings(const String& name, int numChannels);
+
+private:
+	struct Result
+	{
+		double nsPerSample;
+		double meanBlockMs;
+		double p99BlockMs;
+		double realtimeFactor;
+	};
+
+	bool runCase(int pluginIndex, const String& name, int numChannels, int blockSize, Result& result);
+
+	/** Settings for the processor, from the settings file or the defaults. nullptr if none*/
+	XmlElement* createSettings(const String& name, int numChannels) const;
+
+	const ProcessorBenchmarkSettings m_settings;
+	ScopedPointer<XmlElement> m_savedChain;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProcessorBenchmark);
+};
+
+#endif  // PROCESSORBENCHMARK_H_INCLUDED
@@ -31,11 +31,13 @@
 #include "../FileReader/FileReader.h"
 #include "../Merger/Merger.h"
 #include "../Splitter/Splitter.h"
+#include "../NetworkSink/NetworkSink.h"
+#include "../RecordPoint/RecordPoint.h"
 
 #include "../PlaceholderProcessor/PlaceholderProcessor.h"
 
 /** Total number of builtin processors **/
-#define BUILTIN_PROCESSORS 3
+#define BUILTIN_PROCESSORS 5
 
 namespace ProcessorManager
 {
@@ -61,6 +63,14 @@ namespace ProcessorManager
 			name = "File Reader";
 			type = SourceProcessor;
 			break;
+		case 3:
+			name = "Network Sink";
+			type = SinkProcessor;
+			break;
+		case 4:
+			name = "Record Point";
+			type = UtilityProcessor;
+			break;
 		default:
 			name = String::empty;
 			type = -1;
@@ -86,6 +96,12 @@ namespace ProcessorManager
 		case 2:
 			proc = new FileReader();
 			break;
+		case 3:
+			proc = new NetworkSink();
+			break;
+		case 4:
+			proc = new RecordPoint();
+			break;
 		default:
 			return nullptr;
 		}
@@ -148,8 +164,10 @@ namespace ProcessorManager
 			break;
 		case PluginProcessor:
 			{
-				Plugin::ProcessorInfo info = AccessClass::getPluginManager()->getProcessorInfo(index);
-				GenericProcessor* proc = info.creator();
+				ProcessorCreator creator = AccessClass::getPluginManager()->getProcessorCreator(index);
+				if (creator == nullptr)
+					return nullptr;
+				GenericProcessor* proc = creator();
 				proc->setPluginData(Plugin::PLUGIN_TYPE_PROCESSOR, index);
 				return proc;
 				break;
@@ -157,7 +175,10 @@ namespace ProcessorManager
 		case DataThreadProcessor:
 		{
 			Plugin::DataThreadInfo info = AccessClass::getPluginManager()->getDataThreadInfo(index);
-			GenericProcessor* proc = new SourceNode(info.name, info.creator);
+			DataThreadCreator creator = AccessClass::getPluginManager()->getDataThreadCreator(index);
+			if (creator == nullptr)
+				return nullptr;
+			GenericProcessor* proc = new SourceNode(info.name, creator);
 			proc->setPluginData(Plugin::PLUGIN_TYPE_DATA_THREAD, index);
 			return proc;
 			break;
@@ -186,9 +207,11 @@ namespace ProcessorManager
 					if (procName.equalsIgnoreCase(info.name))
 					{
 						int libIndex = pm->getLibraryIndexFromPlugin(Plugin::PLUGIN_TYPE_PROCESSOR, i);
-						if (libName.equalsIgnoreCase(pm->getLibraryName(libIndex)) && libVersion == pm->getLibraryVersion(libIndex))
+						ProcessorCreator creator;
+						if (libName.equalsIgnoreCase(pm->getLibraryName(libIndex)) && libVersion == pm->getLibraryVersion(libIndex)
+							&& (creator = pm->getProcessorCreator(i)) != nullptr)
 						{
-							proc = info.creator();
+							proc = creator();
 							proc->setPluginData(Plugin::PLUGIN_TYPE_PROCESSOR, i);
 							return proc;
 						}
@@ -203,9 +226,11 @@ namespace ProcessorManager
 					if (procName.equalsIgnoreCase(info.name))
 					{
 						int libIndex = pm->getLibraryIndexFromPlugin(Plugin::PLUGIN_TYPE_DATA_THREAD, i);
-						if (libName.equalsIgnoreCase(pm->getLibraryName(libIndex)) && libVersion == pm->getLibraryVersion(libIndex))
+						DataThreadCreator creator;
+						if (libName.equalsIgnoreCase(pm->getLibraryName(libIndex)) && libVersion == pm->getLibraryVersion(libIndex)
+							&& (creator = pm->getDataThreadCreator(i)) != nullptr)
 						{
-							proc = new SourceNode(info.name, info.creator);
+							proc = new SourceNode(info.name, creator);
 							proc->setPluginData(Plugin::PLUGIN_TYPE_DATA_THREAD, i);
 							return proc;
 						}
@@ -22,6 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "BinaryRecording.h"
+#include "../FileSyncer.h"
 
 #define MAX_BUFFER_SIZE 40960
 
@@ -32,6 +33,7 @@ BinaryRecording::BinaryRecording()
     m_scaledBuffer.malloc(MAX_BUFFER_SIZE);
     m_intBuffer.malloc(MAX_BUFFER_SIZE);
     m_tsBuffer.malloc(MAX_BUFFER_SIZE);
+    m_bufferSize = MAX_BUFFER_SIZE;
 }
 
 BinaryRecording::~BinaryRecording()
@@ -78,6 +80,7 @@ void BinaryRecording::openFiles(File rootFolder, int experimentNumber, int recor
     Array<var> jsonContinuousfiles;
     Array<var> jsonChannels;
     StringArray continuousFileNames;
+    StringArray continuousFolders;
     int lastId = 0;
     for (int proc = 0; proc < nProcessors; proc++)
     {
@@ -119,11 +122,35 @@ void BinaryRecording::openFiles(File rootFolder, int experimentNumber, int recor
             if (!found)
             {
                 String datPath = getProcessorString(channelInfo);
-                continuousFileNames.add(contPath + datPath + "continuous.dat");
-
-                ScopedPointer<NpyFile> tFile = new NpyFile(contPath + datPath + "timestamps.npy", NpyType(BaseType::INT64,1));
+                continuousFileNames.add(contPath + datPath + getContinuousFileName());
+                continuousFolders.add(contPath + datPath);
+
+                ScopedPointer<NpyFile> tFile;
+                if (m_sparseTimestamps)
+                    tFile = new NpyFile(contPath + datPath + "timestamp_runs.npy", NpyType(BaseType::INT64, 2));
+                else
+                    tFile = new NpyFile(contPath + datPath + "timestamps.npy", NpyType(BaseType::INT64,1));
+                if (m_deferredNpyHeaders)
+                    tFile->setDeferredHeaderUpdates(m_sparseTimestamps ? 0 : timestampPreallocateBytes, npyHeaderIntervalMs);
                 m_dataTimestampFiles.add(tFile.release());
 
+                ContinuousIndex* index = new ContinuousIndex();
+                index->file = new NpyFile(contPath + datPath + "continuous_index.npy", NpyType(BaseType::INT64, 4));
+                if (m_deferredNpyHeaders)
+                    index->file->setDeferredHeaderUpdates(0, npyHeaderIntervalMs);
+                index->numChannels = 0;
+                index->nextSample = 0;
+                index->expectedTimestamp = -1;
+                index->discontinuity = false;
+                index->numTimestamps = 0;
+                if (isSnippetRecording())
+                {
+                    index->snippetFile = new NpyFile(contPath + datPath + "snippets.npy", NpyType(BaseType::INT64, 2));
+                    if (m_deferredNpyHeaders)
+                        index->snippetFile->setDeferredHeaderUpdates(0, npyHeaderIntervalMs);
+                }
+                m_continuousIndexes.add(index);
+
                 m_fileIndexes.set(recordedChan, nInfoArrays);
                 m_channelIndexes.set(recordedChan, 0);
                 indexedChannelCount.add(1);
@@ -144,12 +171,19 @@ void BinaryRecording::openFiles(File rootFolder, int experimentNumber, int recor
             }
         }
         lastId = indexedDataChannels.size();
+
+        WriteBuffers* buffers = new WriteBuffers();
+        buffers->ts.malloc(MAX_BUFFER_SIZE);
+        buffers->size = MAX_BUFFER_SIZE;
+        buffers->scales.malloc(jmax(1, recChans));
+        m_writeBuffers.add(buffers);
     }
     int nFiles = continuousFileNames.size();
     for (int i = 0; i < nFiles; i++)
     {
         int numChannels = jsonChannels.getReference(i).size();
-        ScopedPointer<SequentialBlockFile> bFile = new SequentialBlockFile(numChannels, samplesPerBlock);
+        float sampleRate = jsonContinuousfiles.getReference(i).getProperty("sample_rate", 0);
+        ScopedPointer<SequentialBlockFile> bFile = createContinuousFile(numChannels, samplesPerBlock, sampleRate);
         if (bFile->openFile(continuousFileNames[i]))
             m_DataFiles.add(bFile.release());
         else
@@ -157,16 +191,37 @@ void BinaryRecording::openFiles(File rootFolder, int experimentNumber, int recor
         DynamicObject::Ptr jsonFile = jsonContinuousfiles.getReference(i).getDynamicObject();
         jsonFile->setProperty("num_channels", numChannels);
         jsonFile->setProperty("channels", jsonChannels.getReference(i));
-    }
-
-    int nChans = getNumRecordedChannels();
-    //Timestamps
-    Array<uint32> procIDs;
-    for (int i = 0; i < nChans; i++)
-    {
-        if (i == 0)
-            std::cout << "Start timestamp: " << getTimestamp(i) << std::endl;
-        m_startTS.add(getTimestamp(i));
+        jsonFile->setProperty("index_file", "continuous_index.npy");
+        jsonFile->setProperty("index_interval", indexInterval);
+        //Readers that find this rebuild timestamps.npy from it, see Resources/Python/binary_timestamps.py
+        if (m_sparseTimestamps)
+            jsonFile->setProperty("timestamp_runs_file", "timestamp_runs.npy");
+        //Only the samples around the trigger events were written, one snippet after another
+        if (isSnippetRecording())
+            jsonFile->setProperty("snippet_file", "snippets.npy");
+        m_continuousIndexes[i]->numChannels = numChannels;
+        if (getSegmentBytes(numChannels, samplesPerBlock, sampleRate) > 0)
+            jsonFile->setProperty("segment_manifest", SegmentedBlockWriter::getManifestName(File(continuousFileNames[i])));
+        addContinuousFileProperties(jsonFile);
+
+        if (m_writeOverviews)
+        {
+            Array<int> factors(overviewFactors, numElementsInArray(overviewFactors));
+            ContinuousOverview* overview = new ContinuousOverview(continuousFolders[i], numChannels, factors);
+            if (m_deferredNpyHeaders)
+                overview->setDeferredHeaderUpdates(npyHeaderIntervalMs);
+            m_overviews.add(overview);
+
+            Array<var> jsonOverviews;
+            for (int f = 0; f < factors.size(); f++)
+            {
+                DynamicObject::Ptr jsonOverview = new DynamicObject();
+                jsonOverview->setProperty("file", ContinuousOverview::getFileName(factors[f]));
+                jsonOverview->setProperty("decimation", factors[f]);
+                jsonOverviews.add(var(jsonOverview));
+            }
+            jsonFile->setProperty("overview_files", jsonOverviews);
+        }
     }
 
     int nEvents = getNumRecordedEvents();
@@ -221,6 +276,7 @@ void BinaryRecording::openFiles(File rootFolder, int experimentNumber, int recor
         createChannelMetaData(chan, jsonChannel);
 
         rec->metaDataFile = createEventMetadataFile(chan, eventPath + eventName + "metadata.npy", jsonChannel);
+        setDeferredHeaderUpdates(rec);
         m_eventFiles.add(rec.release());
         jsonEventFiles.add(var(jsonChannel));
     }
@@ -245,7 +301,7 @@ void BinaryRecording::openFiles(File rootFolder, int experimentNumber, int recor
         Array<var> jsonChannelInfo;
         for (int i = 0; i < numSpikeChannels; i++)
         {
-            SourceChannelInfo sourceInfo = ch->getSourceChannelInfo()[i];
+            const SourceChannelInfo& sourceInfo = ch->getSourceChannelInfo(i);
             DynamicObject::Ptr jsonSpikeChInfo = new DynamicObject();
             jsonSpikeChInfo->setProperty("source_processor_id", sourceInfo.processorID);
             jsonSpikeChInfo->setProperty("source_processor_sub_idx", sourceInfo.subProcessorID);
@@ -306,6 +362,7 @@ void BinaryRecording::openFiles(File rootFolder, int experimentNumber, int recor
             jsonFile->setProperty("post_peak_samples", (int)ch->getPostPeakSamples());
 
             rec->metaDataFile = createEventMetadataFile(ch, spikePath + spikeName + "metadata.npy", jsonFile);
+            setDeferredHeaderUpdates(rec);
             m_spikeFiles.add(rec.release());
             jsonSpikeFiles.add(var(jsonFile));
         }
@@ -328,9 +385,14 @@ void BinaryRecording::openFiles(File rootFolder, int experimentNumber, int recor
     else
     {
         m_syncTextFile = syncFile.createOutputStream();
+        if (m_syncTextFile)
+            FileSyncer::getInstance()->addFile(syncFile);
     }
+    m_syncTextChecksum.reset();
 
     m_recordingNum = recordingNumber;
+    m_basePath = basepath;
+    m_rootFolder = rootFolder;
 
     DynamicObject::Ptr jsonSettingsFile = new DynamicObject();
     jsonSettingsFile->setProperty("GUI version", CoreServices::getGUIVersion());
@@ -448,9 +510,92 @@ void BinaryRecording::createChannelMetaData(const MetaDataInfoObject* channel, D
     jsonFile->setProperty("channel_metadata", jsonMetaData);
 }
 
+void BinaryRecording::startChannelBlock(bool lastBlock)
+{
+    //The events and spikes of the previous pass
+    flushAllEvents();
+}
+
 void BinaryRecording::closeFiles()
 {
+    flushAllEvents();
+    for (int i = 0; i < m_overviews.size(); i++)
+        m_overviews[i]->finish();
+    //A last row with the total number of samples, so readers know where the final run ends
+    if (m_sparseTimestamps)
+    {
+        for (int i = 0; i < m_continuousIndexes.size(); i++)
+        {
+            ContinuousIndex* index = m_continuousIndexes[i];
+            if (index->expectedTimestamp < 0)
+                continue;
+            int64 row[2] = { index->numTimestamps, index->expectedTimestamp };
+            m_dataTimestampFiles[i]->writeData(row, sizeof(row));
+            m_dataTimestampFiles[i]->increaseRecordCount();
+        }
+    }
+    Array<File> files = writeChecksums();
+    //Mirrored once closed, as some files are only complete when destroyed
     resetChannels();
+    for (int i = 0; i < files.size(); i++)
+        mirrorFile(files[i], m_rootFolder);
+    mirrorSettingsFiles(m_rootFolder);
+}
+
+void BinaryRecording::segmentFinished(const File& segment)
+{
+    mirrorFile(segment, m_rootFolder);
+}
+
+Array<File> BinaryRecording::writeChecksums()
+{
+    File folder(m_basePath);
+    ChecksumManifest manifest(folder);
+
+    for (int i = 0; i < m_DataFiles.size(); i++)
+    {
+        if (m_DataFiles[i] == nullptr)
+            continue;
+        m_DataFiles[i]->close();
+        m_DataFiles[i]->addChecksums(manifest);
+    }
+    for (int i = 0; i < m_dataTimestampFiles.size(); i++)
+        manifest.addFile(m_dataTimestampFiles[i]->getFile(), m_dataTimestampFiles[i]->getChecksum());
+    for (int i = 0; i < m_continuousIndexes.size(); i++)
+    {
+        const ContinuousIndex* index = m_continuousIndexes[i];
+        manifest.addFile(index->file->getFile(), index->file->getChecksum());
+        if (index->snippetFile)
+            manifest.addFile(index->snippetFile->getFile(), index->snippetFile->getChecksum());
+    }
+    for (int i = 0; i < m_overviews.size(); i++)
+        m_overviews[i]->addChecksums(manifest);
+    for (int i = 0; i < m_eventFiles.size(); i++)
+        addChecksums(m_eventFiles[i], manifest);
+    for (int i = 0; i < m_spikeFiles.size(); i++)
+        addChecksums(m_spikeFiles[i], manifest);
+    if (m_syncTextFile)
+        manifest.addFile(m_syncTextFile->getFile(), m_syncTextChecksum);
+    //Written in one go when the recording started
+    manifest.addFileContents(folder.getChildFile("structure.oebin"));
+
+    File manifestFile = folder.getChildFile(ChecksumManifest::getDefaultFileName());
+    manifest.writeToFile(manifestFile);
+    Array<File> files = manifest.getFiles();
+    files.add(manifestFile);
+    return files;
+}
+
+void BinaryRecording::addChecksums(const EventRecording* rec, ChecksumManifest& manifest)
+{
+    if (!rec)
+        return;
+    const NpyFile* files[] = { rec->mainFile, rec->timestampFile, rec->metaDataFile, rec->channelFile, rec->extraFile };
+    for (int i = 0; i < numElementsInArray(files); i++)
+    {
+        if (files[i])
+            manifest.addFile(files[i]->getFile(), files[i]->getChecksum());
+    }
 }
 
 void BinaryRecording::resetChannels()
@@ -459,11 +604,19 @@ void BinaryRecording::resetChannels()
     m_channelIndexes.clear();
     m_fileIndexes.clear();
     m_dataTimestampFiles.clear();
+    m_continuousIndexes.clear();
+    m_overviews.clear();
     m_eventFiles.clear();
     m_spikeChannelIndexes.clear();
     m_spikeFileIndexes.clear();
     m_spikeFiles.clear();
-    m_syncTextFile = nullptr;
+    if (m_syncTextFile)
+    {
+        File syncFile = m_syncTextFile->getFile();
+        m_syncTextFile = nullptr;
+        FileSyncer::getInstance()->fileClosed(syncFile);
+    }
+    m_writeBuffers.clear();
 
     m_scaledBuffer.malloc(MAX_BUFFER_SIZE);
     m_intBuffer.malloc(MAX_BUFFER_SIZE);
@@ -475,51 +628,253 @@ void BinaryRecording::resetChannels()
 void BinaryRecording::writeData(int writeChannel, int realChannel, const float* buffer,
                                 int size)
 {
-    if (size > m_bufferSize)
-    // shouldn't happen, and if it does it'll be slow, but better this than crashing
+    //Each processor has its own buffers, as processors may be written from different threads
+    WriteBuffers* buffers = m_writeBuffers[getProcessorFromChannel(writeChannel)];
+    //Samples are converted straight into the file blocks, no intermediate buffers needed
+    float scale = 1.0f / getDataChannel(realChannel)->getBitVolts();
+    int fileIndex = m_fileIndexes[writeChannel];
+    int64 baseTS = getTimestamp(writeChannel);
+    int64 position = baseTS - m_startTS[writeChannel];
+    if (isSnippetRecording())
     {
-        std::cerr << "Write buffer overrun, resizing to" << size << std::endl;
-        m_bufferSize = size;
-        m_scaledBuffer.malloc(size);
-        m_intBuffer.malloc(size);
-        m_tsBuffer.malloc(size);
+        if (m_channelIndexes[writeChannel] == 0)
+            updateSnippets(fileIndex, baseTS);
+        position = getSnippetPosition(fileIndex, baseTS);
     }
-    double multFactor = 1 / (float(0x7fff) * getDataChannel(realChannel)->getBitVolts());
-    FloatVectorOperations::copyWithMultiply(m_scaledBuffer.getData(), buffer, multFactor,
-                                            size);
-    AudioDataConverters::convertFloatToInt16LE(m_scaledBuffer.getData(), m_intBuffer.getData(),
-                                               size);
-    int fileIndex = m_fileIndexes[writeChannel];
-    m_DataFiles[fileIndex]->writeChannel(getTimestamp(writeChannel) - m_startTS[writeChannel],
+    m_DataFiles[fileIndex]->writeChannel(position,
                                          m_channelIndexes[writeChannel],
-                                         m_intBuffer.getData(), size);
+                                         buffer, size, scale);
+    if (m_writeOverviews)
+        m_overviews[fileIndex]->writeChannel(m_channelIndexes[writeChannel], buffer, size, scale);
 
     if (m_channelIndexes[writeChannel] == 0)
+        writeFileTimestamps(fileIndex, buffers, position, baseTS, size);
+}
+
+void BinaryRecording::writeDataBlock(int firstWriteChannel, int numChannels, const float* const* data, int size)
+{
+    int fileIndex = m_fileIndexes[firstWriteChannel];
+    int firstIndex = m_channelIndexes[firstWriteChannel];
+    //Channels that don't follow each other in the same file are written one at a time
+    for (int c = 1; c < numChannels; c++)
     {
-        int64 baseTS = getTimestamp(writeChannel);
-        //Let's hope that the compiler is smart enough to vectorize this.
-        for (int i = 0; i < size; i++)
+        if ((int) m_fileIndexes[firstWriteChannel + c] != fileIndex || (int) m_channelIndexes[firstWriteChannel + c] != firstIndex + c)
         {
-            m_tsBuffer[i] = (baseTS + i);
+            RecordEngine::writeDataBlock(firstWriteChannel, numChannels, data, size);
+            return;
+        }
+    }
+
+    WriteBuffers* buffers = m_writeBuffers[getProcessorFromChannel(firstWriteChannel)];
+    //All the channels of a block come from the same source, so they share their timestamps
+    int64 baseTS = getTimestamp(firstWriteChannel);
+    int64 position = baseTS - m_startTS[firstWriteChannel];
+    if (isSnippetRecording())
+    {
+        if (firstIndex == 0)
+            updateSnippets(fileIndex, baseTS);
+        position = getSnippetPosition(fileIndex, baseTS);
+    }
+    for (int c = 0; c < numChannels; c++)
+        buffers->scales[c] = 1.0f / getDataChannel(getRealChannel(firstWriteChannel + c))->getBitVolts();
+
+    m_DataFiles[fileIndex]->writeChannels(position, firstIndex, numChannels, data, buffers->scales, size);
+    if (m_writeOverviews)
+    {
+        for (int c = 0; c < numChannels; c++)
+            m_overviews[fileIndex]->writeChannel(firstIndex + c, data[c], size, buffers->scales[c]);
+    }
+
+    if (firstIndex == 0)
+        writeFileTimestamps(fileIndex, buffers, position, baseTS, size);
+}
+
+void BinaryRecording::writeFileTimestamps(int fileIndex, WriteBuffers* buffers, int64 position, int64 baseTS, int size)
+{
+    if (m_sparseTimestamps)
+    {
+        writeTimestampRun(fileIndex, baseTS, size);
+    }
+    else
+    {
+        //Written in chunks of the preallocated buffer, so large writes don't reallocate it
+        for (int start = 0; start < size; start += buffers->size)
+        {
+            int n = jmin(buffers->size, size - start);
+            for (int i = 0; i < n; i++)
+            {
+                buffers->ts[i] = (baseTS + start + i);
+            }
+            m_dataTimestampFiles[fileIndex]->writeData(buffers->ts, n*sizeof(int64));
         }
-        m_dataTimestampFiles[fileIndex]->writeData(m_tsBuffer, size*sizeof(int64));
         m_dataTimestampFiles[fileIndex]->increaseRecordCount(size);
     }
+    updateContinuousIndex(fileIndex, position, baseTS, size);
+    m_continuousIndexes[fileIndex]->numTimestamps += size;
+}
+
+void BinaryRecording::updateContinuousIndex(int fileIndex, int64 pos, int64 baseTS, int size)
+{
+    ContinuousIndex* index = m_continuousIndexes[fileIndex];
+    if (index->expectedTimestamp >= 0 && baseTS != index->expectedTimestamp)
+        index->discontinuity = true;
+    index->expectedTimestamp = baseTS + size;
+
+    while (index->nextSample < pos + size)
+    {
+        int64 sample = index->nextSample;
+        int64 row[4] = { sample, getContinuousByteOffset(index->numChannels, sample), baseTS + (sample - pos), index->discontinuity ? 1 : 0 };
+        index->file->writeData(row, sizeof(row));
+        index->file->increaseRecordCount();
+        if (sample >= pos)
+            index->discontinuity = false;
+        index->nextSample += indexInterval;
+    }
+}
+
+//Must run before updateContinuousIndex, which moves expectedTimestamp on
+void BinaryRecording::writeTimestampRun(int fileIndex, int64 baseTS, int size)
+{
+    ContinuousIndex* index = m_continuousIndexes[fileIndex];
+    if (index->expectedTimestamp < 0 || baseTS != index->expectedTimestamp)
+    {
+        int64 row[2] = { index->numTimestamps, baseTS };
+        m_dataTimestampFiles[fileIndex]->writeData(row, sizeof(row));
+        m_dataTimestampFiles[fileIndex]->increaseRecordCount();
+    }
+}
+
+void BinaryRecording::updateSnippets(int fileIndex, int64 baseTS)
+{
+    ContinuousIndex* index = m_continuousIndexes[fileIndex];
+    if (index->expectedTimestamp >= 0 && baseTS == index->expectedTimestamp)
+        return;
+
+    index->snippetSamples.add(index->numTimestamps);
+    index->snippetTimestamps.add(baseTS);
+    int64 row[2] = { index->numTimestamps, baseTS };
+    index->snippetFile->writeData(row, sizeof(row));
+    index->snippetFile->increaseRecordCount();
+}
+
+int64 BinaryRecording::getSnippetPosition(int fileIndex, int64 timestamp) const
+{
+    //The other channels of the file are written just after the first one, so the snippet is one of the last
+    const ContinuousIndex* index = m_continuousIndexes[fileIndex];
+    for (int i = index->snippetTimestamps.size() - 1; i >= 0; i--)
+    {
+        if (index->snippetTimestamps.getUnchecked(i) <= timestamp)
+            return index->snippetSamples.getUnchecked(i) + (timestamp - index->snippetTimestamps.getUnchecked(i));
+    }
+    return 0;
+}
+
+String BinaryRecording::getContinuousFileName() const
+{
+    return "continuous.dat";
+}
+
+SequentialBlockFile* BinaryRecording::createContinuousFile(int numChannels, int samplesPerBlock, float sampleRate)
+{
+    int64 segmentBytes = getSegmentBytes(numChannels, samplesPerBlock, sampleRate);
+    if (segmentBytes > 0)
+        return new SequentialBlockFile(numChannels, samplesPerBlock, new SegmentedBlockWriter(m_directWrites, segmentBytes, numChannels * sizeof(int16), this));
+    return new SequentialBlockFile(numChannels, samplesPerBlock, m_directWrites);
+}
+
+int64 BinaryRecording::getSegmentBytes(int numChannels, int samplesPerBlock, float sampleRate) const
+{
+    int64 limit = 0;
+    if (m_segmentMegabytes > 0)
+        limit = int64(m_segmentMegabytes) << 20;
+    if (m_segmentSeconds > 0 && sampleRate > 0)
+    {
+        int64 bytes = int64(m_segmentSeconds * double(sampleRate)) * numChannels * sizeof(int16);
+        limit = (limit > 0) ? jmin(limit, bytes) : bytes;
+    }
+    if (limit <= 0)
+        return 0;
+
+    //Segments hold whole blocks
+    int64 blockBytes = int64(numChannels) * samplesPerBlock * sizeof(int16);
+    return jmax<int64>(1, limit / blockBytes) * blockBytes;
+}
+
+void BinaryRecording::addContinuousFileProperties(DynamicObject* jsonFile)
+{
+}
+
+int64 BinaryRecording::getContinuousByteOffset(int numChannels, int64 sampleNumber) const
+{
+    return sampleNumber * numChannels * sizeof(int16);
+}
+
+bool BinaryRecording::supportsParallelChannelWrites() const
+{
+    //Continuous files never span more than one recorded processor
+    return true;
+}
+
+bool BinaryRecording::supportsSnippetRecording() const
+{
+    return true;
+}
+
+bool BinaryRecording::supportsPreparedFiles() const
+{
+    //The start timestamps are only needed to place the samples, see recordingStarted
+    return true;
+}
+
+void BinaryRecording::recordingStarted()
+{
+    int nChans = getNumRecordedChannels();
+    m_startTS.clearQuick();
+    for (int i = 0; i < nChans; i++)
+    {
+        if (i == 0)
+            std::cout << "Start timestamp: " << getTimestamp(i) << std::endl;
+        m_startTS.add(getTimestamp(i));
+    }
+}
+
+void BinaryRecording::discardFiles()
+{
+    //Nothing was recorded, so no checksums or mirrors, and the empty folders go too
+    resetChannels();
+    File recordingFolder(m_basePath);
+    File experimentFolder = recordingFolder.getParentDirectory();
+    recordingFolder.deleteRecursively();
+    if (experimentFolder.getNumberOfChildFiles(File::findFilesAndDirectories) == 0)
+        experimentFolder.deleteFile();
 }
 
 
+void BinaryRecording::getMemoryUsage(MemoryUsage& usage) const
+{
+    int64 conversion = int64(m_bufferSize) * (sizeof(float) + sizeof(int16) + sizeof(int64));
+    for (int i = 0; i < m_writeBuffers.size(); i++)
+        conversion += int64(m_writeBuffers[i]->size) * sizeof(int64);
+    usage.add("Conversion buffers", conversion);
+
+    int64 blocks = 0;
+    for (int i = 0; i < m_DataFiles.size(); i++)
+        blocks += m_DataFiles[i]->getMemorySize();
+    usage.add("File blocks", blocks);
+}
+
 void BinaryRecording::addSpikeElectrode(int index, const SpikeChannel* elec)
 {
 }
 
-void BinaryRecording::writeEventMetaData(const MetaDataEvent* event, NpyFile* file)
+void BinaryRecording::writeEventMetaData(const MetaDataEvent* event, EventRecording* rec)
 {
-    if (!file || !event) return;
+    if (!rec->metaDataFile || !event) return;
     int nMetaData = event->getMetadataValueCount();
     for (int i = 0; i < nMetaData; i++)
     {
         const MetaDataValue* val = event->getMetaDataValue(i);
-        file->writeData(val->getRawValuePointer(), val->getDataSize());
+        rec->metaDataColumn.write(val->getRawValuePointer(), val->getDataSize());
     }
 }
 
@@ -527,29 +882,47 @@ void BinaryRecording::writeEvent(int eventIndex, const MidiMessage& event)
 {
     EventPtr ev = Event::deserializeFromMessage(event, getEventChannel(eventIndex));
     EventRecording* rec = m_eventFiles[eventIndex];
-    if (!rec) return;
+    if (!rec || !ev) return;
     const EventChannel* info = getEventChannel(eventIndex);
+
+    if (info->isBatched())
+    {
+        //Each record is written as an event of its own, so the files look the same as for a non-batched channel
+        BinaryEvent* batch = static_cast<BinaryEvent*>(ev.get());
+        uint16 chan = batch->getChannel() + 1;
+        for (int r = 0; r < batch->getNumRecords(); r++)
+        {
+            int64 ts = batch->getRecordTimestamp(r);
+            rec->timestampColumn.write(&ts, sizeof(int64));
+            rec->channelColumn.write(&chan, sizeof(uint16));
+            rec->mainColumn.write(batch->getRecordPointer(r), info->getRecordSize());
+            writeEventMetaData(batch, rec);
+            eventQueued(rec);
+        }
+        return;
+    }
+
     int64 ts = ev->getTimestamp();
-    rec->timestampFile->writeData(&ts, sizeof(int64));
+    rec->timestampColumn.write(&ts, sizeof(int64));
 
     uint16 chan = ev->getChannel() +1;
-    rec->channelFile->writeData(&chan, sizeof(uint16));
+    rec->channelColumn.write(&chan, sizeof(uint16));
 
     if (ev->getEventType() == EventChannel::TTL)
     {
         TTLEvent* ttl = static_cast<TTLEvent*>(ev.get());
         int16 data = (ttl->getChannel()+1) * (ttl->getState() ? 1 : -1);
-        rec->mainFile->writeData(&data, sizeof(int16));
+        rec->mainColumn.write(&data, sizeof(int16));
         if (rec->extraFile)
-            rec->extraFile->writeData(ttl->getTTLWordPointer(), info->getDataSize());
+            rec->extraColumn.write(ttl->getTTLWordPointer(), info->getDataSize());
     }
     else
     {
-        rec->mainFile->writeData(ev->getRawDataPointer(), info->getDataSize());
+        rec->mainColumn.write(ev->getRawDataPointer(), info->getDataSize());
     }
 
-    writeEventMetaData(ev.get(), rec->metaDataFile);
-    increaseEventCounts(rec);
+    writeEventMetaData(ev.get(), rec);
+    eventQueued(rec);
 }
 
 void BinaryRecording::writeTimestampSyncText(uint16 sourceID, uint16 sourceIdx,
@@ -557,7 +930,10 @@ void BinaryRecording::writeTimestampSyncText(uint16 sourceID, uint16 sourceIdx,
 {
     if (!m_syncTextFile)
         return;
-    m_syncTextFile->writeText(text + "\n", false, false);
+    //The bytes writeText would write, which turns every newline into CRLF
+    String line = (text + "\n").replace("\n", "\r\n");
+    m_syncTextFile->write(line.toRawUTF8(), line.getNumBytesAsUTF8());
+    m_syncTextChecksum.update(line.toRawUTF8(), line.getNumBytesAsUTF8());
 }
 
 
@@ -578,30 +954,86 @@ void BinaryRecording::writeSpike(int electrodeIndex, const SpikeEvent* spike)
         m_scaledBuffer.malloc(totalSamples);
         m_intBuffer.malloc(totalSamples);
     }
-    double multFactor = 1 / (float(0x7fff) * channel->getChannelBitVolts(0));
-    FloatVectorOperations::copyWithMultiply(m_scaledBuffer.getData(), spike->getDataPointer(), multFactor, totalSamples);
-    AudioDataConverters::convertFloatToInt16LE(m_scaledBuffer.getData(), m_intBuffer.getData(), totalSamples);
-    rec->mainFile->writeData(m_intBuffer.getData(), totalSamples*sizeof(int16));
+    if (channel->hasInt16Waveforms())
+    {
+        //Already in bitVolts steps, as sent by the source
+        rec->mainColumn.write(spike->getInt16DataPointer(), totalSamples*sizeof(int16));
+    }
+    else
+    {
+        double multFactor = 1 / (float(0x7fff) * channel->getChannelBitVolts(0));
+        FloatVectorOperations::copyWithMultiply(m_scaledBuffer.getData(), spike->getDataPointer(), multFactor, totalSamples);
+        AudioDataConverters::convertFloatToInt16LE(m_scaledBuffer.getData(), m_intBuffer.getData(), totalSamples);
+        rec->mainColumn.write(m_intBuffer.getData(), totalSamples*sizeof(int16));
+    }
 
     int64 ts = spike->getTimestamp();
-    rec->timestampFile->writeData(&ts, sizeof(int64));
+    rec->timestampColumn.write(&ts, sizeof(int64));
 
-    rec->channelFile->writeData(&spikeChannel, sizeof(uint16));
+    rec->channelColumn.write(&spikeChannel, sizeof(uint16));
 
     uint16 sortedID = spike->getSortedID();
-    rec->extraFile->writeData(&sortedID, sizeof(uint16));
-    writeEventMetaData(spike, rec->metaDataFile);
+    rec->extraColumn.write(&sortedID, sizeof(uint16));
+    writeEventMetaData(spike, rec);
 
-    increaseEventCounts(rec);
+    eventQueued(rec);
 }
 
-void BinaryRecording::increaseEventCounts(EventRecording* rec)
+void BinaryRecording::setDeferredHeaderUpdates(EventRecording* rec)
 {
-    rec->mainFile->increaseRecordCount();
-    rec->timestampFile->increaseRecordCount();
-    if (rec->extraFile) rec->extraFile->increaseRecordCount();
-    if (rec->channelFile) rec->channelFile->increaseRecordCount();
-    if (rec->metaDataFile) rec->metaDataFile->increaseRecordCount();
+    if (!m_deferredNpyHeaders)
+        return;
+    rec->mainFile->setDeferredHeaderUpdates(eventPreallocateBytes, npyHeaderIntervalMs);
+    rec->timestampFile->setDeferredHeaderUpdates(eventPreallocateBytes, npyHeaderIntervalMs);
+    if (rec->extraFile) rec->extraFile->setDeferredHeaderUpdates(eventPreallocateBytes, npyHeaderIntervalMs);
+    if (rec->channelFile) rec->channelFile->setDeferredHeaderUpdates(eventPreallocateBytes, npyHeaderIntervalMs);
+    if (rec->metaDataFile) rec->metaDataFile->setDeferredHeaderUpdates(eventPreallocateBytes, npyHeaderIntervalMs);
+}
+
+void BinaryRecording::increaseEventCounts(EventRecording* rec, int count)
+{
+    rec->mainFile->increaseRecordCount(count);
+    rec->timestampFile->increaseRecordCount(count);
+    if (rec->extraFile) rec->extraFile->increaseRecordCount(count);
+    if (rec->channelFile) rec->channelFile->increaseRecordCount(count);
+    if (rec->metaDataFile) rec->metaDataFile->increaseRecordCount(count);
+}
+
+void BinaryRecording::eventQueued(EventRecording* rec)
+{
+    rec->numPending++;
+    if (rec->numPending >= eventFlushRecords || rec->mainColumn.getDataSize() >= eventFlushBytes)
+        flushEvents(rec);
+}
+
+static void writeColumn(NpyFile* file, MemoryOutputStream& column)
+{
+    if (file && column.getDataSize() > 0)
+        file->writeData(column.getData(), column.getDataSize());
+    //Keeps the memory for the next records
+    column.reset();
+}
+
+void BinaryRecording::flushEvents(EventRecording* rec)
+{
+    if (!rec || rec->numPending == 0)
+        return;
+    writeColumn(rec->mainFile, rec->mainColumn);
+    writeColumn(rec->timestampFile, rec->timestampColumn);
+    writeColumn(rec->metaDataFile, rec->metaDataColumn);
+    writeColumn(rec->channelFile, rec->channelColumn);
+    writeColumn(rec->extraFile, rec->extraColumn);
+    //Counted once the data is in the files, so the headers never count records they don't hold
+    increaseEventCounts(rec, rec->numPending);
+    rec->numPending = 0;
+}
+
+void BinaryRecording::flushAllEvents()
+{
+    for (int i = 0; i < m_eventFiles.size(); i++)
+        flushEvents(m_eventFiles[i]);
+    for (int i = 0; i < m_spikeFiles.size(); i++)
+        flushEvents(m_spikeFiles[i]);
 }
 
 RecordEngineManager* BinaryRecording::getEngineManager()
@@ -611,12 +1043,44 @@ RecordEngineManager* BinaryRecording::getEngineManager()
     EngineParameter* param;
     param = new EngineParameter(EngineParameter::BOOL, 0, "Record TTL full words", true);
     man->addParameter(param);
+    param = new EngineParameter(EngineParameter::BOOL, 1, "Unbuffered continuous writes", false);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::BOOL, 2, "Batch .npy header updates", false);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::BOOL, 3, "Write min/max overview files", false);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::INT, 4, "Continuous segment size (MB, 0 for one file)", 0, 0, 1 << 20);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::INT, 5, "Continuous segment length (s, 0 for one file)", 0, 0, 1 << 20);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::BOOL, 6, "Sparse continuous timestamps", false);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::STR, 7, "Mirror folder (empty for none)", "");
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::INT, 8, "Mirror bandwidth (MB/s, 0 for no limit)", 0, 0, 1 << 16);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::MULTI, 9, "Disk sync|None|Periodic|On close", 0);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::INT, 10, "Periodic sync interval (s)", 5, 1, 3600);
+    man->addParameter(param);
     return man;
 }
 
 void BinaryRecording::setParameter(EngineParameter& parameter)
 {
     boolParameter(0, m_saveTTLWords);
+    boolParameter(1, m_directWrites);
+    boolParameter(2, m_deferredNpyHeaders);
+    boolParameter(3, m_writeOverviews);
+    intParameter(4, m_segmentMegabytes);
+    intParameter(5, m_segmentSeconds);
+    boolParameter(6, m_sparseTimestamps);
+    strParameter(7, m_mirrorFolder);
+    intParameter(8, m_mirrorBandwidth);
+    setMirror(m_mirrorFolder, m_mirrorBandwidth);
+    multiParameter(9, m_syncPolicy);
+    intParameter(10, m_syncSeconds);
+    FileSyncer::getInstance()->setPolicy(FileSyncer::Policy(m_syncPolicy), m_syncSeconds);
 }
 
 String BinaryRecording::jsonTypeValue(BaseType type)
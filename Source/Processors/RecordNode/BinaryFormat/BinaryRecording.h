@@ -26,11 +26,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "../RecordEngine.h"
 #include "SequentialBlockFile.h"
 #include "NpyFile.h"
+#include "ContinuousOverview.h"
 
 namespace BinaryRecordingEngine
 {
 
-    class BinaryRecording : public RecordEngine
+    class BinaryRecording : public RecordEngine, private SegmentedBlockWriter::Listener
     {
     public:
         BinaryRecording();
@@ -39,16 +40,34 @@ namespace BinaryRecordingEngine
         String getEngineID() const override;
         void openFiles(File rootFolder, int experimentNumber, int recordingNumber) override;
         void closeFiles() override;
+        void startChannelBlock(bool lastBlock) override;
         void writeData(int writeChannel, int realChannel, const float* buffer, int size) override;
+        void writeDataBlock(int firstWriteChannel, int numChannels, const float* const* data, int size) override;
         void writeEvent(int eventIndex, const MidiMessage& event) override;
         void resetChannels() override;
         void addSpikeElectrode(int index, const SpikeChannel* elec) override;
         void writeSpike(int electrodeIndex, const SpikeEvent* spike) override;
         void writeTimestampSyncText(uint16 sourceID, uint16 sourceIdx, int64 timestamp, float, String text) override;
         void setParameter(EngineParameter& parameter) override;
+        bool supportsParallelChannelWrites() const override;
+        bool supportsSnippetRecording() const override;
+        bool supportsPreparedFiles() const override;
+        void recordingStarted() override;
+        void discardFiles() override;
+        void getMemoryUsage(MemoryUsage& usage) const override;
 
         static RecordEngineManager* getEngineManager();
 
+    protected:
+        /** Name of the continuous data file inside each processor folder */
+        virtual String getContinuousFileName() const;
+        /** Creates the writer of one continuous file, before it is opened */
+        virtual SequentialBlockFile* createContinuousFile(int numChannels, int samplesPerBlock, float sampleRate);
+        /** Adds format-specific properties to the description of a continuous file in structure.oebin */
+        virtual void addContinuousFileProperties(DynamicObject* jsonFile);
+        /** Byte offset of a sample in a continuous file, or -1 if it can't be computed from the sample number */
+        virtual int64 getContinuousByteOffset(int numChannels, int64 sampleNumber) const;
+
     private:
 
         class EventRecording
@@ -59,22 +78,68 @@ namespace BinaryRecordingEngine
             ScopedPointer<NpyFile> metaDataFile;
             ScopedPointer<NpyFile> channelFile;
             ScopedPointer<NpyFile> extraFile;
+            //Records not written yet, one column per file, see flushEvents
+            MemoryOutputStream mainColumn;
+            MemoryOutputStream timestampColumn;
+            MemoryOutputStream metaDataColumn;
+            MemoryOutputStream channelColumn;
+            MemoryOutputStream extraColumn;
+            int numPending{ 0 };
         };
 
 
         NpyFile* createEventMetadataFile(const MetaDataEventObject* channel, String fileName, DynamicObject* jsonObject);
         void createChannelMetaData(const MetaDataInfoObject* channel, DynamicObject* jsonObject);
-        void writeEventMetaData(const MetaDataEvent* event, NpyFile* file);
-        void increaseEventCounts(EventRecording* rec);
+        void writeEventMetaData(const MetaDataEvent* event, EventRecording* rec);
+        void increaseEventCounts(EventRecording* rec, int count);
+        /** Counts a record added to the columns, which are written once large enough */
+        void eventQueued(EventRecording* rec);
+        /** Writes the columns of the pending records to their files, one write per file */
+        void flushEvents(EventRecording* rec);
+        void flushAllEvents();
+        void setDeferredHeaderUpdates(EventRecording* rec);
+        static void addChecksums(const EventRecording* rec, ChecksumManifest& manifest);
+        /** Closes the continuous files and writes checksums.json, with the checksums of every file of the recording.
+            Returns those files and checksums.json */
+        Array<File> writeChecksums();
+        /** Copies finished segments to the mirror while the recording goes on */
+        void segmentFinished(const File& segment) override;
         static String jsonTypeValue(BaseType type);
         static String getProcessorString(const InfoObjectCommon* channelInfo);
 
         bool m_saveTTLWords{ true };
+        bool m_directWrites{ false };
+        bool m_deferredNpyHeaders{ false };
+        bool m_writeOverviews{ false };
+        //Store (sample, timestamp) rows where timestamps jump instead of one timestamp per sample
+        bool m_sparseTimestamps{ false };
+        //Continuous files are split into segments of at most this size and length, when not 0
+        int m_segmentMegabytes{ 0 };
+        int m_segmentSeconds{ 0 };
+        //Finished files are copied there, if set
+        String m_mirrorFolder;
+        int m_mirrorBandwidth{ 0 };
+        //FileSyncer::Policy, and its interval for periodic syncs
+        int m_syncPolicy{ 0 };
+        int m_syncSeconds{ 5 };
+        /** Size in bytes of the segments of a continuous file, or 0 to write it whole */
+        int64 getSegmentBytes(int numChannels, int samplesPerBlock, float sampleRate) const;
+
+        /** Timestamp buffer for the continuous data of one recorded processor, so different
+            processors can be written from different threads */
+        struct WriteBuffers
+        {
+            HeapBlock<int64> ts;
+            int size;
+            //One per recorded channel of the processor, for writeDataBlock
+            HeapBlock<float> scales;
+        };
 
         HeapBlock<float> m_scaledBuffer;
         HeapBlock<int16> m_intBuffer;
         HeapBlock<int64> m_tsBuffer;
         int m_bufferSize;
+        OwnedArray<WriteBuffers> m_writeBuffers;
 
         OwnedArray<SequentialBlockFile> m_DataFiles;
         Array<unsigned int> m_channelIndexes;
@@ -82,7 +147,39 @@ namespace BinaryRecordingEngine
         OwnedArray<EventRecording> m_eventFiles;
         OwnedArray<EventRecording> m_spikeFiles;
         OwnedArray<NpyFile> m_dataTimestampFiles;
+
+        /** Seek index of a continuous file. Holds one row every indexInterval samples with the
+            sample number, its byte offset, its timestamp and whether timestamps jumped since the last row */
+        struct ContinuousIndex
+        {
+            ScopedPointer<NpyFile> file;
+            int numChannels;
+            int64 nextSample;
+            int64 expectedTimestamp;
+            bool discontinuity;
+            int64 numTimestamps;
+            /** Snippet recordings only: (sample, timestamp) of the start of every snippet */
+            ScopedPointer<NpyFile> snippetFile;
+            Array<int64> snippetSamples;
+            Array<int64> snippetTimestamps;
+        };
+        OwnedArray<ContinuousIndex> m_continuousIndexes;
+        /** Adds the rows of a block written at sample position to the seek index */
+        void updateContinuousIndex(int fileIndex, int64 position, int64 baseTS, int size);
+        /** Writes the timestamps and index entries of a block of a file, once for all its channels */
+        void writeFileTimestamps(int fileIndex, WriteBuffers* buffers, int64 position, int64 baseTS, int size);
+        /** Starts a new snippet if the block doesn't follow on from the previous one. Called for the first channel of a file,
+            before updateContinuousIndex */
+        void updateSnippets(int fileIndex, int64 baseTS);
+        /** Position in the file of a sample with the given timestamp, snippets being stored one after another */
+        int64 getSnippetPosition(int fileIndex, int64 timestamp) const;
+        /** Adds a row to the timestamp runs of a continuous file if the block doesn't follow on from the previous one */
+        void writeTimestampRun(int fileIndex, int64 baseTS, int size);
+        OwnedArray<ContinuousOverview> m_overviews;
         ScopedPointer<FileOutputStream> m_syncTextFile;
+        FileChecksum m_syncTextChecksum;
+        String m_basePath;
+        File m_rootFolder;
 
         Array<unsigned int> m_spikeFileIndexes;
         Array<uint16> m_spikeChannelIndexes;
@@ -93,6 +190,16 @@ namespace BinaryRecordingEngine
 
         //Compile-time constants
         const int samplesPerBlock{ 4096 };
+        const int indexInterval{ 4096 };
+        //Decimation factors of the overview levels
+        const int overviewFactors[2]{ 64, 4096 };
+        //Deferred .npy header updates
+        const int npyHeaderIntervalMs{ 2000 };
+        const int64 eventPreallocateBytes{ 1 << 20 };
+        //Pending records are also written at the start of every record thread pass
+        const int eventFlushRecords{ 4096 };
+        const size_t eventFlushBytes{ 256 << 10 };
+        const int64 timestampPreallocateBytes{ 16 << 20 };
 
     };
 
@@ -0,0 +1,604 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "BlockFileWriter.h"
+#include "../FileSyncer.h"
+#include "../../GenericProcessor/ThreadPolicy.h"
+
+#if JUCE_WINDOWS
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#endif
+
+using namespace BinaryRecordingEngine;
+
+BlockFileWriter* BlockFileWriter::createWriter(bool direct)
+{
+    if (direct)
+        return new DirectBlockWriter();
+    return new StreamBlockWriter();
+}
+
+void* BlockFileWriter::allocateAligned(size_t numBytes)
+{
+#if JUCE_WINDOWS
+    return _aligned_malloc(numBytes, BLOCK_FILE_ALIGNMENT);
+#else
+    void* data = nullptr;
+    if (posix_memalign(&data, BLOCK_FILE_ALIGNMENT, numBytes) != 0)
+        return nullptr;
+    return data;
+#endif
+}
+
+void BlockFileWriter::freeAligned(void* data)
+{
+#if JUCE_WINDOWS
+    _aligned_free(data);
+#else
+    free(data);
+#endif
+}
+
+StreamBlockWriter::StreamBlockWriter()
+{
+}
+
+StreamBlockWriter::~StreamBlockWriter()
+{
+}
+
+bool StreamBlockWriter::open(const File& file)
+{
+    m_fileName = file;
+    m_checksum.reset();
+    m_file = file.createOutputStream(streamBufferSize);
+    if (m_file == nullptr)
+        return false;
+    FileSyncer::getInstance()->addFile(file);
+    return true;
+}
+
+bool StreamBlockWriter::writeBlock(const void* data, size_t numBytes)
+{
+    if (m_file == nullptr || !m_file->write(data, numBytes))
+        return false;
+    m_checksum.update(data, numBytes);
+    return true;
+}
+
+bool StreamBlockWriter::writeTail(const void* data, size_t numBytes)
+{
+    return writeBlock(data, numBytes);
+}
+
+void StreamBlockWriter::close()
+{
+    if (m_file == nullptr)
+        return;
+    m_file = nullptr;
+    FileSyncer::getInstance()->fileClosed(m_fileName);
+}
+
+void StreamBlockWriter::addChecksums(ChecksumManifest& manifest) const
+{
+    manifest.addFile(m_fileName, m_checksum);
+}
+
+DirectBlockWriter::DirectBlockWriter(int numBuffers) :
+    Thread("Direct block writer"),
+    m_handle(-1),
+    m_directOpen(false),
+    m_queue(numBuffers + 1), //An AbstractFifo holds one item less than its size
+    m_bufferCapacity(0),
+    m_spaceAvailable(false),
+    m_closed(true),
+    m_failed(false)
+{
+    m_buffers.insertMultiple(0, nullptr, numBuffers + 1);
+    m_sizes.insertMultiple(0, 0, numBuffers + 1);
+}
+
+DirectBlockWriter::~DirectBlockWriter()
+{
+    close();
+    for (int i = 0; i < m_buffers.size(); i++)
+        freeAligned(m_buffers[i]);
+}
+
+bool DirectBlockWriter::open(const File& file)
+{
+    m_fileName = file;
+    m_failed = false;
+    m_checksum.reset();
+    m_queue.reset();
+    if (!openDirect())
+    {
+        std::cerr << "Unbuffered writes not available for " << file.getFullPathName() << ", using a regular stream" << std::endl;
+        m_stream = file.createOutputStream(0);
+        if (m_stream == nullptr)
+            return false;
+    }
+    m_closed = false;
+    FileSyncer::getInstance()->addFile(file);
+    startThread();
+    return true;
+}
+
+bool DirectBlockWriter::writeBlock(const void* data, size_t numBytes)
+{
+    if (m_closed)
+        return false;
+
+    if (numBytes > m_bufferCapacity)
+    {
+        //Normally only on the first block. Buffers can only be replaced once the writer thread is idle
+        while (m_queue.getNumReady() > 0)
+            m_spaceAvailable.wait(50);
+        m_bufferCapacity = (numBytes + BLOCK_FILE_ALIGNMENT - 1) & ~size_t(BLOCK_FILE_ALIGNMENT - 1);
+        for (int i = 0; i < m_buffers.size(); i++)
+        {
+            freeAligned(m_buffers[i]);
+            m_buffers.set(i, allocateAligned(m_bufferCapacity));
+            if (m_buffers[i] == nullptr)
+            {
+                m_bufferCapacity = 0;
+                return false;
+            }
+        }
+    }
+
+    int pos1, size1, pos2, size2;
+    m_queue.prepareToWrite(1, pos1, size1, pos2, size2);
+    while (size1 == 0)
+    {
+        m_spaceAvailable.wait(100);
+        m_queue.prepareToWrite(1, pos1, size1, pos2, size2);
+    }
+    memcpy(m_buffers[pos1], data, numBytes);
+    m_sizes.set(pos1, numBytes);
+    m_queue.finishedWrite(1);
+    notify();
+    return !m_failed;
+}
+
+bool DirectBlockWriter::writeTail(const void* data, size_t numBytes)
+{
+    if (m_closed)
+        return false;
+
+    stopThread(-1);
+    m_closed = true;
+    if (m_directOpen && !switchToStream())
+        return false;
+    if (numBytes > 0 && !m_stream->write(data, numBytes))
+        return false;
+    m_checksum.update(data, numBytes);
+    return !m_failed;
+}
+
+void DirectBlockWriter::close()
+{
+    if (isThreadRunning())
+        stopThread(-1);
+    closeDirect();
+    m_stream = nullptr;
+    if (!m_closed)
+        FileSyncer::getInstance()->fileClosed(m_fileName);
+    m_closed = true;
+}
+
+void DirectBlockWriter::addChecksums(ChecksumManifest& manifest) const
+{
+    manifest.addFile(m_fileName, m_checksum);
+}
+
+void DirectBlockWriter::run()
+{
+    ThreadPolicy::applyToCurrentThread (ThreadPolicy::Writer);
+
+    //Keep going after being asked to exit until every queued block is on disk
+    while (true)
+    {
+        if (m_queue.getNumReady() == 0)
+        {
+            if (threadShouldExit())
+                break;
+            wait(100);
+            continue;
+        }
+        int pos1, size1, pos2, size2;
+        m_queue.prepareToRead(1, pos1, size1, pos2, size2);
+        writeQueuedBlock(m_buffers[pos1], m_sizes[pos1]);
+        m_queue.finishedRead(1);
+        m_spaceAvailable.signal();
+    }
+}
+
+bool DirectBlockWriter::writeQueuedBlock(const void* data, size_t numBytes)
+{
+    //Computed here rather than in writeBlock, to keep it off the caller's thread
+    m_checksum.update(data, numBytes);
+    if (m_directOpen)
+    {
+        if (writeDirect(data, numBytes))
+            return true;
+        std::cerr << "Unbuffered write failed for " << m_fileName.getFullPathName() << ", reverting to a regular stream" << std::endl;
+        if (!switchToStream())
+        {
+            m_failed = true;
+            return false;
+        }
+    }
+    if (m_stream != nullptr && m_stream->write(data, numBytes))
+        return true;
+    m_failed = true;
+    return false;
+}
+
+bool DirectBlockWriter::switchToStream()
+{
+    closeDirect();
+    //Existing files are opened for appending, so this continues after the last unbuffered block
+    m_stream = m_fileName.createOutputStream(0);
+    return m_stream != nullptr;
+}
+
+#if JUCE_WINDOWS
+
+bool DirectBlockWriter::openDirect()
+{
+    HANDLE h = CreateFileW(m_fileName.getFullPathName().toWideCharPointer(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+        CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING | FILE_FLAG_WRITE_THROUGH, nullptr);
+    if (h == INVALID_HANDLE_VALUE)
+        return false;
+    m_handle = (pointer_sized_int)h;
+    m_directOpen = true;
+    return true;
+}
+
+bool DirectBlockWriter::writeDirect(const void* data, size_t numBytes)
+{
+    DWORD written = 0;
+    if (!WriteFile((HANDLE)m_handle, data, (DWORD)numBytes, &written, nullptr))
+        return false;
+    return written == numBytes;
+}
+
+void DirectBlockWriter::closeDirect()
+{
+    if (m_directOpen)
+        CloseHandle((HANDLE)m_handle);
+    m_directOpen = false;
+    m_handle = -1;
+}
+
+#else
+
+bool DirectBlockWriter::openDirect()
+{
+#if JUCE_LINUX
+    int fd = ::open(m_fileName.getFullPathName().toRawUTF8(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+    if (fd < 0)
+        return false;
+#else
+    int fd = ::open(m_fileName.getFullPathName().toRawUTF8(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+    if (fcntl(fd, F_NOCACHE, 1) == -1)
+    {
+        ::close(fd);
+        return false;
+    }
+#endif
+    m_handle = fd;
+    m_directOpen = true;
+    return true;
+}
+
+bool DirectBlockWriter::writeDirect(const void* data, size_t numBytes)
+{
+    ssize_t written = ::write((int)m_handle, data, numBytes);
+    return written == (ssize_t)numBytes;
+}
+
+void DirectBlockWriter::closeDirect()
+{
+    if (m_directOpen)
+        ::close((int)m_handle);
+    m_directOpen = false;
+    m_handle = -1;
+}
+
+#endif
+
+SegmentedBlockWriter::SegmentedBlockWriter(bool direct, int64 segmentBytes, int bytesPerSample, Listener* listener) :
+    Thread("Segmented block writer"),
+    m_direct(direct),
+    m_segmentBytes(segmentBytes),
+    m_bytesPerSample(bytesPerSample),
+    m_listener(listener),
+    m_currentBytes(0),
+    m_failed(false),
+    m_nextRequested(false),
+    m_opening(false),
+    m_numReported(0)
+{
+}
+
+SegmentedBlockWriter::~SegmentedBlockWriter()
+{
+    close();
+}
+
+String SegmentedBlockWriter::getManifestName(const File& file)
+{
+    return file.getFileNameWithoutExtension() + "_segments.json";
+}
+
+File SegmentedBlockWriter::getSegmentFile(int index) const
+{
+    return m_file.getSiblingFile(m_file.getFileNameWithoutExtension() + "_" + String(index).paddedLeft('0', 4) + m_file.getFileExtension());
+}
+
+BlockFileWriter* SegmentedBlockWriter::openSegment(int index)
+{
+    File file = getSegmentFile(index);
+    ScopedPointer<BlockFileWriter> writer = createWriter(m_direct);
+    if (file.create().failed() || !writer->open(file))
+    {
+        std::cerr << "Error creating segment file " << file.getFullPathName() << std::endl;
+        return nullptr;
+    }
+    return writer.release();
+}
+
+bool SegmentedBlockWriter::open(const File& file)
+{
+    //The segments are written instead of the file itself, which the caller may have created
+    m_file = file;
+    if (m_file.existsAsFile() && m_file.getSize() == 0)
+        m_file.deleteFile();
+
+    m_current = openSegment(0);
+    if (m_current == nullptr)
+        return false;
+
+    Segment segment = { getSegmentFile(0), 0, false, FileChecksum() };
+    m_segments.add(segment);
+    m_currentBytes = 0;
+    m_currentChecksum.reset();
+    m_closedSegments.clear();
+    m_numReported = 0;
+    m_failed = false;
+    startThread();
+    notify();
+    return true;
+}
+
+bool SegmentedBlockWriter::writeBlock(const void* data, size_t numBytes)
+{
+    if (m_current == nullptr)
+        return false;
+
+    if (m_currentBytes > 0 && m_currentBytes + int64(numBytes) > m_segmentBytes && !startNextSegment())
+        return false;
+
+    bool ok = m_current->writeBlock(data, numBytes);
+    m_currentBytes += numBytes;
+    m_currentChecksum.update(data, numBytes);
+    {
+        const ScopedLock sl(m_lock);
+        Segment& segment = m_segments.getReference(m_segments.size() - 1);
+        segment.numBytes = m_currentBytes;
+        segment.checksum = m_currentChecksum;
+    }
+
+    if (m_currentBytes >= m_segmentBytes * openNextAt)
+    {
+        const ScopedLock sl(m_lock);
+        if (!m_nextRequested)
+        {
+            m_nextRequested = true;
+            notify();
+        }
+    }
+    return ok && !m_failed;
+}
+
+bool SegmentedBlockWriter::startNextSegment()
+{
+    //Take the segment opened by the thread once it's done with it
+    ScopedPointer<BlockFileWriter> next;
+    while (true)
+    {
+        const ScopedLock sl(m_lock);
+        if (!m_opening)
+        {
+            //and keep the thread from opening it while it is opened here
+            next = m_next.release();
+            m_nextRequested = false;
+            break;
+        }
+        const ScopedUnlock su(m_lock);
+        Thread::sleep(1);
+    }
+    //Normally ready, unless the blocks come faster than a file can be created
+    if (next == nullptr)
+        next = openSegment(m_segments.size());
+    if (next == nullptr)
+    {
+        m_failed = true;
+        return false;
+    }
+
+    {
+        const ScopedLock sl(m_lock);
+        m_segments.getReference(m_segments.size() - 1).complete = true;
+        Segment segment = { getSegmentFile(m_segments.size()), 0, false, FileChecksum() };
+        m_segments.add(segment);
+        m_finished.add(m_current.release());
+        m_nextRequested = false;
+    }
+    m_current = next.release();
+    m_currentBytes = 0;
+    m_currentChecksum.reset();
+    notify();
+    return true;
+}
+
+bool SegmentedBlockWriter::writeTail(const void* data, size_t numBytes)
+{
+    if (m_current == nullptr)
+        return false;
+
+    if (numBytes > 0 && m_currentBytes > 0 && m_currentBytes + int64(numBytes) > m_segmentBytes && !startNextSegment())
+        return false;
+
+    bool ok = m_current->writeTail(data, numBytes);
+    m_currentBytes += numBytes;
+    m_currentChecksum.update(data, numBytes);
+    const ScopedLock sl(m_lock);
+    Segment& segment = m_segments.getReference(m_segments.size() - 1);
+    segment.numBytes = m_currentBytes;
+    segment.checksum = m_currentChecksum;
+    return ok && !m_failed;
+}
+
+void SegmentedBlockWriter::close()
+{
+    if (m_segments.size() == 0)
+        return;
+
+    stopThread(-1);
+    if (m_current != nullptr)
+        m_current->close();
+    m_current = nullptr;
+    m_finished.clear();
+
+    //A segment opened ahead but never written to is removed
+    if (m_next != nullptr)
+    {
+        m_next->close();
+        m_next = nullptr;
+        getSegmentFile(m_segments.size()).deleteFile();
+    }
+
+    m_segments.getReference(m_segments.size() - 1).complete = true;
+    writeManifest();
+    m_closedSegments.swapWith(m_segments);
+    m_segments.clear();
+}
+
+void SegmentedBlockWriter::addChecksums(ChecksumManifest& manifest) const
+{
+    for (int i = 0; i < m_closedSegments.size(); i++)
+        manifest.addFile(m_closedSegments.getReference(i).file, m_closedSegments.getReference(i).checksum);
+    manifest.addFileContents(m_file.getSiblingFile(getManifestName(m_file)));
+}
+
+void SegmentedBlockWriter::run()
+{
+    ThreadPolicy::applyToCurrentThread (ThreadPolicy::Writer);
+
+    while (!threadShouldExit())
+    {
+        bool openNext;
+        int nextIndex;
+        OwnedArray<BlockFileWriter> finished;
+        Array<File> finishedFiles;
+        {
+            const ScopedLock sl(m_lock);
+            openNext = m_nextRequested && m_next == nullptr;
+            nextIndex = m_segments.size();
+            m_opening = openNext;
+            finished.swapWith(m_finished);
+            //Segments are marked complete as their writer is handed over
+            for (; m_numReported < m_segments.size() && m_segments.getReference(m_numReported).complete; m_numReported++)
+                finishedFiles.add(m_segments.getReference(m_numReported).file);
+        }
+
+        //Closing can take a while, as it waits for the last blocks to reach the disk
+        for (int i = 0; i < finished.size(); i++)
+            finished[i]->close();
+        if (finished.size() > 0)
+            writeManifest();
+        for (int i = 0; m_listener != nullptr && i < finishedFiles.size(); i++)
+            m_listener->segmentFinished(finishedFiles[i]);
+
+        if (openNext)
+        {
+            BlockFileWriter* next = openSegment(nextIndex);
+            const ScopedLock sl(m_lock);
+            m_next = next;
+            m_opening = false;
+        }
+
+        wait(200);
+    }
+}
+
+void SegmentedBlockWriter::writeManifest()
+{
+    Array<var> jsonSegments;
+    {
+        const ScopedLock sl(m_lock);
+        int64 firstSample = 0;
+        for (int i = 0; i < m_segments.size(); i++)
+        {
+            const Segment& segment = m_segments.getReference(i);
+            DynamicObject::Ptr jsonSegment = new DynamicObject();
+            jsonSegment->setProperty("file", segment.file.getFileName());
+            jsonSegment->setProperty("first_sample", firstSample);
+            jsonSegment->setProperty("num_samples", segment.numBytes / m_bytesPerSample);
+            jsonSegment->setProperty("complete", segment.complete);
+            //Lets finished segments be checked as soon as they are moved off
+            if (segment.complete)
+                jsonSegment->setProperty("crc32c", segment.checksum.toString());
+            jsonSegments.add(var(jsonSegment));
+            firstSample += segment.numBytes / m_bytesPerSample;
+        }
+    }
+
+    DynamicObject::Ptr jsonManifest = new DynamicObject();
+    jsonManifest->setProperty("segments", jsonSegments);
+
+    //Replaced in one go, so it can be read at any time
+    File manifest = m_file.getSiblingFile(getManifestName(m_file));
+    TemporaryFile temp(manifest);
+    {
+        FileOutputStream stream(temp.getFile());
+        if (!stream.openedOk())
+            return;
+        jsonManifest->writeAsJSON(stream, 2, false);
+    }
+    if (!temp.overwriteTargetFileWithTemporary())
+        std::cerr << "Error writing " << manifest.getFullPathName() << std::endl;
+}
@@ -0,0 +1,217 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef BLOCKFILEWRITER_H
+#define BLOCKFILEWRITER_H
+
+#include "../../../../JuceLibraryCode/JuceHeader.h"
+#include "../FileChecksum.h"
+#include <atomic>
+
+//Alignment of block memory, sizes and file offsets required for unbuffered writes
+#define BLOCK_FILE_ALIGNMENT 4096
+
+namespace BinaryRecordingEngine
+{
+
+    /**
+    Destination of the blocks of a SequentialBlockFile.
+    Full blocks are written with writeBlock, in order. The data given to it must be BLOCK_FILE_ALIGNMENT
+    aligned and its size a multiple of it. The last, possibly partial, block is written with writeTail,
+    after which only close can be called. Writers keep the checksum of the files they write, which
+    addChecksums adds to a manifest once they are closed.
+    */
+    class BlockFileWriter
+    {
+    public:
+        virtual ~BlockFileWriter() {}
+
+        virtual bool open(const File& file) = 0;
+        virtual bool writeBlock(const void* data, size_t numBytes) = 0;
+        virtual bool writeTail(const void* data, size_t numBytes) = 0;
+        virtual void close() = 0;
+        /** Adds the files written and their checksums. Only valid after close */
+        virtual void addChecksums(ChecksumManifest& manifest) const { }
+
+        /** Creates a writer. With direct set, writes bypass the OS page cache when the platform and
+        the file system allow it, falling back to a regular stream otherwise */
+        static BlockFileWriter* createWriter(bool direct);
+
+        static void* allocateAligned(size_t numBytes);
+        static void freeAligned(void* data);
+    };
+
+    /** Writes blocks through a JUCE FileOutputStream */
+    class StreamBlockWriter : public BlockFileWriter
+    {
+    public:
+        StreamBlockWriter();
+        ~StreamBlockWriter();
+
+        bool open(const File& file) override;
+        bool writeBlock(const void* data, size_t numBytes) override;
+        bool writeTail(const void* data, size_t numBytes) override;
+        void close() override;
+        void addChecksums(ChecksumManifest& manifest) const override;
+
+    private:
+        ScopedPointer<FileOutputStream> m_file;
+        File m_fileName;
+        FileChecksum m_checksum;
+
+        //Compile-time parameters
+        const int streamBufferSize{ 0 };
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StreamBlockWriter);
+    };
+
+    /**
+    Writes blocks with unbuffered I/O (O_DIRECT on Linux, F_NOCACHE on OS X, FILE_FLAG_NO_BUFFERING on Windows)
+    from a background thread, so the caller only waits for a copy into one of the in-flight buffers.
+    If the file can't be opened or written unbuffered it reverts to a FileOutputStream, which is also
+    used to append the unaligned tail of the file.
+    */
+    class DirectBlockWriter : public BlockFileWriter, private Thread
+    {
+    public:
+        DirectBlockWriter(int numBuffers = 4);
+        ~DirectBlockWriter();
+
+        bool open(const File& file) override;
+        bool writeBlock(const void* data, size_t numBytes) override;
+        bool writeTail(const void* data, size_t numBytes) override;
+        void close() override;
+        void addChecksums(ChecksumManifest& manifest) const override;
+
+    private:
+        void run() override;
+
+        /** Writes a block from the writer thread, switching to the stream on failure */
+        bool writeQueuedBlock(const void* data, size_t numBytes);
+        /** Closes the unbuffered handle and reopens the file as a regular stream */
+        bool switchToStream();
+
+        bool openDirect();
+        bool writeDirect(const void* data, size_t numBytes);
+        void closeDirect();
+
+        File m_fileName;
+        pointer_sized_int m_handle;
+        bool m_directOpen;
+        ScopedPointer<FileOutputStream> m_stream;
+
+        AbstractFifo m_queue;
+        Array<void*> m_buffers;
+        Array<size_t> m_sizes;
+        size_t m_bufferCapacity;
+        WaitableEvent m_spaceAvailable;
+        bool m_closed;
+        std::atomic<bool> m_failed;
+        //Updated by the writer thread, and by writeTail once it has stopped
+        FileChecksum m_checksum;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DirectBlockWriter);
+    };
+
+    /**
+    Splits the blocks into segment files of at most segmentBytes, a multiple of the block size,
+    each written by its own writer. For a file name.dat, segment i is name_<i>.dat and
+    name_segments.json lists the segments written so far, with the first sample of each and
+    whether it is complete, so finished segments can be moved off while recording goes on.
+
+    A background thread opens the next segment before the current one is full, and closes
+    and lists the finished ones, so the caller doesn't wait for either.
+    */
+    class SegmentedBlockWriter : public BlockFileWriter, private Thread
+    {
+    public:
+        /** Told of every segment once it is complete and closed, from the thread of the writer */
+        class Listener
+        {
+        public:
+            virtual ~Listener() {}
+            virtual void segmentFinished(const File& segment) = 0;
+        };
+
+        SegmentedBlockWriter(bool direct, int64 segmentBytes, int bytesPerSample, Listener* listener = nullptr);
+        ~SegmentedBlockWriter();
+
+        bool open(const File& file) override;
+        bool writeBlock(const void* data, size_t numBytes) override;
+        bool writeTail(const void* data, size_t numBytes) override;
+        void close() override;
+        /** Adds every segment and the segment list */
+        void addChecksums(ChecksumManifest& manifest) const override;
+
+        static String getManifestName(const File& file);
+
+    private:
+        void run() override;
+
+        File getSegmentFile(int index) const;
+        BlockFileWriter* openSegment(int index);
+        /** Switches to the next segment, opening it here if the thread hasn't yet */
+        bool startNextSegment();
+        void writeManifest();
+
+        struct Segment
+        {
+            File file;
+            int64 numBytes;
+            bool complete;
+            FileChecksum checksum;
+        };
+
+        const bool m_direct;
+        const int64 m_segmentBytes;
+        const int m_bytesPerSample;
+        Listener* const m_listener;
+        File m_file;
+
+        ScopedPointer<BlockFileWriter> m_current;
+        int64 m_currentBytes;
+        FileChecksum m_currentChecksum;
+        bool m_failed;
+        //The segments of the last file closed
+        Array<Segment> m_closedSegments;
+
+        //Shared with the thread
+        CriticalSection m_lock;
+        ScopedPointer<BlockFileWriter> m_next;
+        bool m_nextRequested;
+        bool m_opening;
+        OwnedArray<BlockFileWriter> m_finished;
+        Array<Segment> m_segments;
+        //Segments the listener has been told of
+        int m_numReported;
+
+        //Compile-time parameters
+        //The next segment is opened once the current one is this full
+        const double openNextAt{ 0.75 };
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SegmentedBlockWriter);
+    };
+
+}
+
+#endif
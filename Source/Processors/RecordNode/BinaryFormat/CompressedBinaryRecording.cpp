@@ -0,0 +1,91 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "CompressedBinaryRecording.h"
+#include "CompressedBlockWriter.h"
+
+using namespace BinaryRecordingEngine;
+
+CompressedBinaryRecording::CompressedBinaryRecording()
+{
+}
+
+CompressedBinaryRecording::~CompressedBinaryRecording()
+{
+}
+
+String CompressedBinaryRecording::getEngineID() const
+{
+    return "COMPRESSEDBINARY";
+}
+
+bool CompressedBinaryRecording::supportsParallelChannelWrites() const
+{
+    //Each continuous file has its own writer and codec
+    return true;
+}
+
+String CompressedBinaryRecording::getContinuousFileName() const
+{
+    return "continuous.oebc";
+}
+
+SequentialBlockFile* CompressedBinaryRecording::createContinuousFile(int numChannels, int samplesPerBlock, float sampleRate)
+{
+    return new SequentialBlockFile(numChannels, samplesPerBlock, new CompressedBlockWriter(numChannels, samplesPerBlock));
+}
+
+void CompressedBinaryRecording::addContinuousFileProperties(DynamicObject* jsonFile)
+{
+    jsonFile->setProperty("compression", "delta_bitpack");
+    jsonFile->setProperty("compression_version", CompressedBlockWriter::FORMAT_VERSION);
+    jsonFile->setProperty("chunk_index", CompressedBlockWriter::getIndexFileName());
+}
+
+int64 CompressedBinaryRecording::getContinuousByteOffset(int numChannels, int64 sampleNumber) const
+{
+    //Offsets depend on the compressed size of every chunk, see the chunk index instead
+    return -1;
+}
+
+RecordEngineManager* CompressedBinaryRecording::getEngineManager()
+{
+    RecordEngineManager* man = new RecordEngineManager("COMPRESSEDBINARY", "Compressed binary",
+                                                       &(engineFactory<CompressedBinaryRecording>));
+    EngineParameter* param;
+    param = new EngineParameter(EngineParameter::BOOL, 0, "Record TTL full words", true);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::BOOL, 3, "Write min/max overview files", false);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::BOOL, 6, "Sparse continuous timestamps", false);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::STR, 7, "Mirror folder (empty for none)", "");
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::INT, 8, "Mirror bandwidth (MB/s, 0 for no limit)", 0, 0, 1 << 16);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::MULTI, 9, "Disk sync|None|Periodic|On close", 0);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::INT, 10, "Periodic sync interval (s)", 5, 1, 3600);
+    man->addParameter(param);
+    return man;
+}
@@ -0,0 +1,59 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef COMPRESSEDBINARYRECORDING_H
+#define COMPRESSEDBINARYRECORDING_H
+
+#include "BinaryRecording.h"
+
+namespace BinaryRecordingEngine
+{
+
+    /**
+    Binary format with losslessly compressed continuous data.
+    Events, spikes and metadata are written as in BinaryRecording. Continuous data goes to
+    continuous.oebc files, one compressed chunk per block, with a chunk_index.npy seek index.
+
+    @see CompressedBlockWriter, CompressedBlockCodec
+    */
+    class CompressedBinaryRecording : public BinaryRecording
+    {
+    public:
+        CompressedBinaryRecording();
+        ~CompressedBinaryRecording();
+
+        String getEngineID() const override;
+        bool supportsParallelChannelWrites() const override;
+
+        static RecordEngineManager* getEngineManager();
+
+    protected:
+        String getContinuousFileName() const override;
+        SequentialBlockFile* createContinuousFile(int numChannels, int samplesPerBlock, float sampleRate) override;
+        void addContinuousFileProperties(DynamicObject* jsonFile) override;
+        int64 getContinuousByteOffset(int numChannels, int64 sampleNumber) const override;
+    };
+
+}
+
+#endif
@@ -0,0 +1,164 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "CompressedBlockCodec.h"
+
+using namespace BinaryRecordingEngine;
+
+CompressedBlockCodec::CompressedBlockCodec(int nChannels, int maxSamples) :
+    m_nChannels(nChannels),
+    m_maxSamples(maxSamples),
+    m_residuals(maxSamples)
+{
+}
+
+CompressedBlockCodec::~CompressedBlockCodec()
+{
+}
+
+size_t CompressedBlockCodec::getMaxEncodedSize(int numSamples) const
+{
+    //Differences of int16 values need up to 17 bits once zigzag encoded
+    size_t numFrames = (numSamples + FRAME_SIZE - 1) / FRAME_SIZE;
+    size_t perChannel = sizeof(int16) + numFrames * (1 + (FRAME_SIZE * 17 + 7) / 8);
+    return CHUNK_HEADER_SIZE + m_nChannels * perChannel;
+}
+
+size_t CompressedBlockCodec::encode(const int16* interleaved, int numSamples, uint8* dest)
+{
+    jassert(numSamples <= m_maxSamples);
+    uint8* p = dest + CHUNK_HEADER_SIZE;
+
+    for (int chan = 0; chan < m_nChannels && numSamples > 0; chan++)
+    {
+        const int16* src = interleaved + chan;
+        int16 first = src[0];
+        memcpy(p, &first, sizeof(int16));
+        p += sizeof(int16);
+
+        int numResiduals = numSamples - 1;
+        int prev = first;
+        for (int i = 0; i < numResiduals; i++)
+        {
+            int value = src[(i + 1) * m_nChannels];
+            int32 diff = value - prev;
+            prev = value;
+            m_residuals[i] = (uint32(diff) << 1) ^ uint32(diff >> 31);
+        }
+
+        for (int frame = 0; frame < numResiduals; frame += FRAME_SIZE)
+        {
+            int len = jmin(int(FRAME_SIZE), numResiduals - frame);
+            const uint32* res = m_residuals + frame;
+            uint32 maxValue = 0;
+            for (int i = 0; i < len; i++)
+                maxValue |= res[i];
+            uint8 bits = 0;
+            while (bits < 32 && (maxValue >> bits) != 0)
+                bits++;
+            *p++ = bits;
+            if (bits == 0)
+                continue;
+
+            uint64 acc = 0;
+            int accBits = 0;
+            for (int i = 0; i < len; i++)
+            {
+                acc |= uint64(res[i]) << accBits;
+                accBits += bits;
+                while (accBits >= 8)
+                {
+                    *p++ = uint8(acc & 0xFF);
+                    acc >>= 8;
+                    accBits -= 8;
+                }
+            }
+            if (accBits > 0)
+                *p++ = uint8(acc & 0xFF);
+        }
+    }
+
+    uint32 payloadSize = uint32(p - dest - CHUNK_HEADER_SIZE);
+    uint32 samples = uint32(numSamples);
+    memcpy(dest, &payloadSize, sizeof(uint32));
+    memcpy(dest + 4, &samples, sizeof(uint32));
+    return p - dest;
+}
+
+int CompressedBlockCodec::decode(const uint8* src, size_t srcSize, int16* interleaved, int maxSamples) const
+{
+    if (srcSize < CHUNK_HEADER_SIZE)
+        return -1;
+
+    uint32 payloadSize, samples;
+    memcpy(&payloadSize, src, sizeof(uint32));
+    memcpy(&samples, src + 4, sizeof(uint32));
+    int numSamples = int(samples);
+    if (srcSize < CHUNK_HEADER_SIZE + payloadSize || numSamples > maxSamples)
+        return -1;
+
+    const uint8* p = src + CHUNK_HEADER_SIZE;
+    const uint8* end = p + payloadSize;
+
+    for (int chan = 0; chan < m_nChannels && numSamples > 0; chan++)
+    {
+        if (end - p < int(sizeof(int16)))
+            return -1;
+        int16 first;
+        memcpy(&first, p, sizeof(int16));
+        p += sizeof(int16);
+        int16* dst = interleaved + chan;
+        dst[0] = first;
+
+        int numResiduals = numSamples - 1;
+        int prev = first;
+        for (int frame = 0; frame < numResiduals; frame += FRAME_SIZE)
+        {
+            int len = jmin(int(FRAME_SIZE), numResiduals - frame);
+            if (p >= end)
+                return -1;
+            int bits = *p++;
+            if (bits > 17 || (end - p) < (len * bits + 7) / 8)
+                return -1;
+
+            uint64 acc = 0;
+            int accBits = 0;
+            const uint32 mask = (bits == 0) ? 0 : (0xFFFFFFFFu >> (32 - bits));
+            for (int i = 0; i < len; i++)
+            {
+                while (accBits < bits)
+                {
+                    acc |= uint64(*p++) << accBits;
+                    accBits += 8;
+                }
+                uint32 res = uint32(acc) & mask;
+                acc >>= bits;
+                accBits -= bits;
+                int32 diff = int32(res >> 1) ^ -int32(res & 1);
+                prev += diff;
+                dst[(frame + i + 1) * m_nChannels] = int16(prev);
+            }
+        }
+    }
+    return numSamples;
+}
@@ -0,0 +1,73 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef COMPRESSEDBLOCKCODEC_H
+#define COMPRESSEDBLOCKCODEC_H
+
+#include "../../../../JuceLibraryCode/JuceHeader.h"
+
+namespace BinaryRecordingEngine
+{
+
+    /**
+    Lossless coder for blocks of interleaved int16 samples.
+
+    Each channel is stored as its first sample followed by the zigzag-encoded differences between
+    consecutive samples, bit-packed in frames of FRAME_SIZE values that each use the smallest bit
+    width able to hold the frame's largest residual.
+
+    Encoded chunk layout (little endian):
+    uint32 payload size in bytes (not counting this 8 byte header)
+    uint32 number of samples per channel
+    for every channel: int16 first sample, then for every frame: uint8 bit width, packed residuals
+    */
+    class CompressedBlockCodec
+    {
+    public:
+        enum { FRAME_SIZE = 128, CHUNK_HEADER_SIZE = 8 };
+
+        CompressedBlockCodec(int nChannels, int maxSamples);
+        ~CompressedBlockCodec();
+
+        /** Upper bound of the encoded size of a chunk of numSamples samples per channel */
+        size_t getMaxEncodedSize(int numSamples) const;
+
+        /** Encodes numSamples interleaved samples per channel. dest must hold getMaxEncodedSize bytes.
+        Returns the number of bytes written, header included */
+        size_t encode(const int16* interleaved, int numSamples, uint8* dest);
+
+        /** Decodes a chunk produced by encode into maxSamples interleaved samples per channel at most.
+        Returns the number of samples per channel, or -1 if the chunk is malformed */
+        int decode(const uint8* src, size_t srcSize, int16* interleaved, int maxSamples) const;
+
+    private:
+        const int m_nChannels;
+        const int m_maxSamples;
+        HeapBlock<uint32> m_residuals;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CompressedBlockCodec);
+    };
+
+}
+
+#endif
@@ -0,0 +1,113 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "CompressedBlockWriter.h"
+#include "../FileSyncer.h"
+
+using namespace BinaryRecordingEngine;
+
+CompressedBlockWriter::CompressedBlockWriter(int nChannels, int samplesPerBlock) :
+    m_nChannels(nChannels),
+    m_samplesPerBlock(samplesPerBlock),
+    m_codec(nChannels, samplesPerBlock),
+    m_samplesWritten(0)
+{
+    m_encoded.malloc(m_codec.getMaxEncodedSize(samplesPerBlock));
+}
+
+CompressedBlockWriter::~CompressedBlockWriter()
+{
+    close();
+}
+
+bool CompressedBlockWriter::open(const File& file)
+{
+    m_file = file.createOutputStream(streamBufferSize);
+    if (!m_file)
+        return false;
+    FileSyncer::getInstance()->addFile(file);
+
+    MemoryOutputStream header(FILE_HEADER_SIZE);
+    header.write("OECB", 4);
+    header.writeShort(FORMAT_VERSION);
+    header.writeShort(short(m_nChannels));
+    header.writeInt(m_samplesPerBlock);
+    header.writeInt(CompressedBlockCodec::FRAME_SIZE);
+    m_file->write(header.getData(), header.getDataSize());
+    m_fileName = file;
+    m_checksum.reset();
+    m_checksum.update(header.getData(), header.getDataSize());
+
+    m_indexFileName = file.getSiblingFile(getIndexFileName());
+    m_index = new NpyFile(m_indexFileName.getFullPathName(), NpyType(BaseType::INT64, 2));
+    m_samplesWritten = 0;
+    return true;
+}
+
+bool CompressedBlockWriter::writeBlock(const void* data, size_t numBytes)
+{
+    return writeChunk(data, numBytes);
+}
+
+bool CompressedBlockWriter::writeTail(const void* data, size_t numBytes)
+{
+    if (numBytes == 0)
+        return true;
+    return writeChunk(data, numBytes);
+}
+
+void CompressedBlockWriter::close()
+{
+    if (m_index)
+        m_indexChecksum = m_index->getChecksum();
+    m_index = nullptr;
+    if (m_file)
+    {
+        m_file = nullptr;
+        FileSyncer::getInstance()->fileClosed(m_fileName);
+    }
+}
+
+void CompressedBlockWriter::addChecksums(ChecksumManifest& manifest) const
+{
+    manifest.addFile(m_fileName, m_checksum);
+    manifest.addFile(m_indexFileName, m_indexChecksum);
+}
+
+bool CompressedBlockWriter::writeChunk(const void* data, size_t numBytes)
+{
+    if (!m_file)
+        return false;
+
+    int numSamples = int(numBytes / (m_nChannels * sizeof(int16)));
+    int64 entry[2] = { m_samplesWritten, m_file->getPosition() };
+    size_t encodedSize = m_codec.encode(static_cast<const int16*>(data), numSamples, m_encoded);
+    if (!m_file->write(m_encoded, encodedSize))
+        return false;
+    m_checksum.update(m_encoded, encodedSize);
+
+    m_index->writeData(entry, sizeof(entry));
+    m_index->increaseRecordCount();
+    m_samplesWritten += numSamples;
+    return true;
+}
@@ -0,0 +1,81 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef COMPRESSEDBLOCKWRITER_H
+#define COMPRESSEDBLOCKWRITER_H
+
+#include "BlockFileWriter.h"
+#include "CompressedBlockCodec.h"
+#include "NpyFile.h"
+
+namespace BinaryRecordingEngine
+{
+
+    /**
+    Compresses every block of a SequentialBlockFile into one chunk of the output file.
+
+    The file starts with a 16 byte header: "OECB", uint16 version, uint16 number of channels,
+    uint32 samples per block and uint32 codec frame size, followed by the encoded chunks.
+    A chunk_index.npy file next to it holds, for every chunk, its first sample number and its
+    byte offset in the file, so any block can be located without decoding the preceding ones.
+    */
+    class CompressedBlockWriter : public BlockFileWriter
+    {
+    public:
+        CompressedBlockWriter(int nChannels, int samplesPerBlock);
+        ~CompressedBlockWriter();
+
+        bool open(const File& file) override;
+        bool writeBlock(const void* data, size_t numBytes) override;
+        bool writeTail(const void* data, size_t numBytes) override;
+        void close() override;
+        void addChecksums(ChecksumManifest& manifest) const override;
+
+        static String getIndexFileName() { return "chunk_index.npy"; }
+
+        enum { FORMAT_VERSION = 1, FILE_HEADER_SIZE = 16 };
+
+    private:
+        bool writeChunk(const void* data, size_t numBytes);
+
+        const int m_nChannels;
+        const int m_samplesPerBlock;
+        CompressedBlockCodec m_codec;
+        HeapBlock<uint8> m_encoded;
+        ScopedPointer<FileOutputStream> m_file;
+        ScopedPointer<NpyFile> m_index;
+        int64 m_samplesWritten;
+        File m_fileName;
+        FileChecksum m_checksum;
+        File m_indexFileName;
+        FileChecksum m_indexChecksum;
+
+        //Compile-time parameters
+        const int streamBufferSize{ 1 << 20 };
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CompressedBlockWriter);
+    };
+
+}
+
+#endif
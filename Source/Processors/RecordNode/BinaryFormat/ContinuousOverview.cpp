@@ -0,0 +1,174 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ContinuousOverview.h"
+#include "../../DataThreads/SampleConversion.h"
+
+using namespace BinaryRecordingEngine;
+
+ContinuousOverview::ContinuousOverview(String basePath, int numChannels, const Array<int>& factors)
+    : m_numChannels(numChannels), m_firstFactor(factors[0]), m_rowsWritten(0)
+{
+    for (int i = 0; i < factors.size(); i++)
+    {
+        Level* level = new Level();
+        level->file = new NpyFile(basePath + getFileName(factors[i]), NpyType(BaseType::INT16, 2), numChannels);
+        level->ratio = (i == 0) ? factors[0] : factors[i] / factors[i - 1];
+        level->row.malloc(numChannels * 2);
+        level->count = 0;
+        m_levels.add(level);
+    }
+
+    m_min.malloc(numChannels);
+    m_max.malloc(numChannels);
+    m_scale.calloc(numChannels);
+    m_count.calloc(numChannels);
+    m_channelRows.calloc(numChannels);
+}
+
+String ContinuousOverview::getFileName(int factor)
+{
+    return "overview_" + String(factor) + ".npy";
+}
+
+void ContinuousOverview::setDeferredHeaderUpdates(int updateIntervalMs)
+{
+    for (int i = 0; i < m_levels.size(); i++)
+        m_levels[i]->file->setDeferredHeaderUpdates(0, updateIntervalMs);
+}
+
+void ContinuousOverview::writeChannel(int channel, const float* data, int nSamples, float scale)
+{
+    m_scale[channel] = scale;
+    int done = 0;
+    while (done < nSamples)
+    {
+        int n = jmin(nSamples - done, m_firstFactor - m_count[channel]);
+        Range<float> range = FloatVectorOperations::findMinAndMax(data + done, n);
+        if (m_count[channel] == 0)
+        {
+            m_min[channel] = range.getStart();
+            m_max[channel] = range.getEnd();
+        }
+        else
+        {
+            m_min[channel] = jmin(m_min[channel], range.getStart());
+            m_max[channel] = jmax(m_max[channel], range.getEnd());
+        }
+        m_count[channel] += n;
+        done += n;
+
+        if (m_count[channel] == m_firstFactor)
+            finishChannelRow(channel);
+    }
+    writeFinishedRows();
+}
+
+void ContinuousOverview::finishChannelRow(int channel)
+{
+    int rowSize = m_numChannels * 2;
+    int row = int(m_channelRows[channel] - m_rowsWritten);
+    if (m_pendingRows.size() < (row + 1) * rowSize)
+        m_pendingRows.insertMultiple(-1, 0, (row + 1) * rowSize - m_pendingRows.size());
+
+    //Rounded and saturated like the samples in continuous.dat
+    float values[2] = { m_min[channel], m_max[channel] };
+    SampleConversion::convertFloatToInt16(m_pendingRows.getRawDataPointer() + row * rowSize + channel * 2, 1, values, 2, m_scale[channel]);
+
+    m_channelRows[channel]++;
+    m_count[channel] = 0;
+}
+
+void ContinuousOverview::writeFinishedRows()
+{
+    int64 finished = m_channelRows[0];
+    for (int i = 1; i < m_numChannels; i++)
+        finished = jmin(finished, m_channelRows[i]);
+
+    int numRows = int(finished - m_rowsWritten);
+    if (numRows <= 0)
+        return;
+
+    addRows(0, m_pendingRows.getRawDataPointer(), numRows);
+    m_pendingRows.removeRange(0, numRows * m_numChannels * 2);
+    m_rowsWritten = finished;
+}
+
+void ContinuousOverview::addRows(int levelIndex, const int16* rows, int numRows)
+{
+    int rowSize = m_numChannels * 2;
+    m_levels[levelIndex]->file->writeData(rows, numRows * rowSize * sizeof(int16));
+    m_levels[levelIndex]->file->increaseRecordCount(numRows);
+
+    if (levelIndex + 1 >= m_levels.size())
+        return;
+
+    Level* next = m_levels[levelIndex + 1];
+    for (int r = 0; r < numRows; r++)
+    {
+        const int16* row = rows + r * rowSize;
+        if (next->count == 0)
+        {
+            memcpy(next->row, row, rowSize * sizeof(int16));
+        }
+        else
+        {
+            for (int i = 0; i < rowSize; i += 2)
+            {
+                next->row[i] = jmin(next->row[i], row[i]);
+                next->row[i + 1] = jmax(next->row[i + 1], row[i + 1]);
+            }
+        }
+
+        if (++next->count == next->ratio)
+        {
+            addRows(levelIndex + 1, next->row, 1);
+            next->count = 0;
+        }
+    }
+}
+
+void ContinuousOverview::finish()
+{
+    for (int i = 0; i < m_numChannels; i++)
+    {
+        if (m_count[i] > 0)
+            finishChannelRow(i);
+    }
+    writeFinishedRows();
+
+    for (int i = 1; i < m_levels.size(); i++)
+    {
+        if (m_levels[i]->count > 0)
+        {
+            addRows(i, m_levels[i]->row, 1);
+            m_levels[i]->count = 0;
+        }
+    }
+}
+
+void ContinuousOverview::addChecksums(ChecksumManifest& manifest) const
+{
+    for (int i = 0; i < m_levels.size(); i++)
+        manifest.addFile(m_levels[i]->file->getFile(), m_levels[i]->file->getChecksum());
+}
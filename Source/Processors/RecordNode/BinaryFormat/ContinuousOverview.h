@@ -0,0 +1,89 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CONTINUOUSOVERVIEW_H
+#define CONTINUOUSOVERVIEW_H
+
+#include "../../../../JuceLibraryCode/JuceHeader.h"
+#include "NpyFile.h"
+
+namespace BinaryRecordingEngine
+{
+
+    /**
+    Min/max decimation pyramid of a continuous file, so long recordings can be displayed zoomed
+    out without reading them at full rate. Each level is written to overview_<factor>.npy next to
+    the data file, with a row every factor samples holding the minimum and maximum of each channel
+    over them, shape (rows, channels, 2), as int16 in the units of continuous.dat.
+
+    Each factor must be a multiple of the one before, and is built from the rows of the one before.
+    Channels can be written in any order, but they must all get the same samples. The last rows
+    cover the samples left when finish() is called.
+    */
+    class ContinuousOverview
+    {
+    public:
+        ContinuousOverview(String basePath, int numChannels, const Array<int>& factors);
+
+        void setDeferredHeaderUpdates(int updateIntervalMs);
+
+        void writeChannel(int channel, const float* data, int nSamples, float scale);
+
+        /** Writes the partial rows of the last samples. Nothing can be written after it */
+        void finish();
+        /** Adds the level files and their checksums, once finished */
+        void addChecksums(ChecksumManifest& manifest) const;
+
+        static String getFileName(int factor);
+
+    private:
+        struct Level
+        {
+            ScopedPointer<NpyFile> file;
+            int ratio;                  // rows of the level below in one row
+            HeapBlock<int16> row;       // the row being built
+            int count;
+        };
+
+        /** Stores the min/max of the current first level row of a channel */
+        void finishChannelRow(int channel);
+        /** Writes the first level rows every channel has finished */
+        void writeFinishedRows();
+        void addRows(int level, const int16* rows, int numRows);
+
+        const int m_numChannels;
+        int m_firstFactor;
+        OwnedArray<Level> m_levels;
+
+        HeapBlock<float> m_min;
+        HeapBlock<float> m_max;
+        HeapBlock<float> m_scale;
+        HeapBlock<int> m_count;
+        HeapBlock<int64> m_channelRows;     // first level rows finished by each channel
+        int64 m_rowsWritten;
+        Array<int16> m_pendingRows;         // rows from m_rowsWritten, finished by some channels only
+    };
+
+}
+
+#endif
@@ -25,42 +25,123 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define FILEMEMORYBLOCK_H
 
 #include "../../../../JuceLibraryCode/JuceHeader.h"
+#include "BlockFileWriter.h"
+#include "../../GenericProcessor/RealtimeLog.h"
 
 namespace BinaryRecordingEngine
 {
 
+    /**
+    Interleaved block of samples of a file. Blocks can be flushed and reused for a later offset.
+    Memory is not cleared on reuse. Instead, the range written to each channel is tracked and
+    only the samples outside it are zeroed when writing the block. The range is kept contiguous:
+    a write that leaves a gap after or before it zeroes the gap.
+    */
     template <class StorageType = int16>
     class FileMemoryBlock
     {
     public:
-        FileMemoryBlock(FileOutputStream* file, int blockSize, uint64 offset) :
-            m_data(blockSize, true),
+        FileMemoryBlock(BlockFileWriter* file, int nChannels, int samplesPerBlock, uint64 offset) :
             m_file(file),
-            m_blockSize(blockSize),
-            m_offset(offset)
-        {};
+            m_nChannels(nChannels),
+            m_samplesPerBlock(samplesPerBlock),
+            m_blockSize(nChannels*samplesPerBlock),
+            m_offset(offset),
+            m_firstWritten(nChannels),
+            m_lastWritten(nChannels)
+        {
+            //Aligned so the block can be written unbuffered
+            m_data = static_cast<StorageType*>(BlockFileWriter::allocateAligned(m_blockSize*sizeof(StorageType)));
+            resetWrittenRanges();
+        };
         ~FileMemoryBlock() {
             if (!m_flushed)
             {
-                m_file->write(m_data, m_blockSize*sizeof(StorageType));
+                flush();
             }
+            BlockFileWriter::freeAligned(m_data);
         };
 
         inline uint64 getOffset() { return m_offset; }
-        inline StorageType* getData() { return m_data.getData(); }
+        inline StorageType* getData() { return m_data; }
+
+        /** Records that samples [start, end) of a channel have been written */
+        inline void markWritten(int channel, int start, int end)
+        {
+            int& first = m_firstWritten[channel];
+            int& last = m_lastWritten[channel];
+            if (first >= last)
+            {
+                first = start;
+                last = end;
+                return;
+            }
+            //Stale samples between the range and the write
+            for (int i = last; i < start; i++)
+                m_data[i*m_nChannels + channel] = 0;
+            for (int i = end; i < first; i++)
+                m_data[i*m_nChannels + channel] = 0;
+            first = jmin(first, start);
+            last = jmax(last, end);
+        }
+
+        void flush()
+        {
+            clearUnwritten(m_samplesPerBlock);
+            m_file->writeBlock(m_data, m_blockSize*sizeof(StorageType));
+            m_flushed = true;
+        }
+
         void partialFlush(size_t size, bool markFlushed = true)
         {
-            std::cout << "flushing last block " << size << std::endl;
-            m_file->write(m_data, size*sizeof(StorageType));
+            RealtimeLog::write(RealtimeLog::LOG_DEBUG, "flushing last block %d", int(size));
+            clearUnwritten(int(size / m_nChannels));
+            m_file->writeTail(m_data, size*sizeof(StorageType));
             if (markFlushed)
                 m_flushed = true;
         }
 
+        /** Reuses a flushed block for a new offset */
+        void reuse(uint64 offset)
+        {
+            jassert(m_flushed);
+            m_offset = offset;
+            m_flushed = false;
+            resetWrittenRanges();
+        }
+
     private:
-        HeapBlock<StorageType> m_data;
-        FileOutputStream* const m_file;
+        void resetWrittenRanges()
+        {
+            for (int i = 0; i < m_nChannels; i++)
+            {
+                m_firstWritten[i] = m_samplesPerBlock;
+                m_lastWritten[i] = 0;
+            }
+        }
+
+        /** Zeroes the samples of each channel, up to numSamples, that were not written since the last reuse */
+        void clearUnwritten(int numSamples)
+        {
+            for (int chan = 0; chan < m_nChannels; chan++)
+            {
+                int first = jmin(m_firstWritten[chan], numSamples);
+                int last = jmax(m_lastWritten[chan], first);
+                for (int i = 0; i < first; i++)
+                    m_data[i*m_nChannels + chan] = 0;
+                for (int i = last; i < numSamples; i++)
+                    m_data[i*m_nChannels + chan] = 0;
+            }
+        }
+
+        StorageType* m_data;
+        BlockFileWriter* const m_file;
+        const int m_nChannels;
+        const int m_samplesPerBlock;
         const int m_blockSize;
-        const uint64 m_offset;
+        uint64 m_offset;
+        HeapBlock<int> m_firstWritten;
+        HeapBlock<int> m_lastWritten;
         bool m_flushed{ false };
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FileMemoryBlock);
     };
@@ -30,9 +30,40 @@ https://github.com/numpy/numpy/blob/master/numpy/lib/format.py
 */
 
 #include "NpyFile.h"
+#include "../FileSyncer.h"
+
+#if JUCE_LINUX || JUCE_MAC
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 using namespace BinaryRecordingEngine;
 
+/** Reserves disk space for the first numBytes of a file without changing its size. Best effort */
+static void reserveFileSpace(const File& file, int64 numBytes)
+{
+#if JUCE_LINUX
+    int fd = ::open(file.getFullPathName().toRawUTF8(), O_WRONLY);
+    if (fd < 0)
+        return;
+    fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, numBytes);
+    ::close(fd);
+#elif JUCE_MAC
+    int64 currentSize = file.getSize();
+    if (numBytes <= currentSize)
+        return;
+    int fd = ::open(file.getFullPathName().toRawUTF8(), O_WRONLY);
+    if (fd < 0)
+        return;
+    fstore_t store = { F_ALLOCATEALL, F_PEOFPOSMODE, 0, numBytes - currentSize, 0 };
+    fcntl(fd, F_PREALLOCATE, &store);
+    ::close(fd);
+#else
+    //On Windows the stream holds the file without write sharing, so space can't be reserved through a second handle
+    ignoreUnused(file, numBytes);
+#endif
+}
+
 NpyFile::NpyFile(String path, const Array<NpyType>& typeList)
 {
     m_dim1 = 1;
@@ -76,17 +107,18 @@ bool NpyFile::openFile(String path)
         return false;
     }
     file.deleteFile(); // overwrite, never append a new .npy file to end of an existing one
-    // output stream buffer size defaults to 32768 bytes, but is irrelevant because
-    // each updateHeader() call triggers a m_file->flush() to disk:
+    // output stream buffer size defaults to 32768 bytes. Each updateHeader() call hands
+    // the buffer to the OS, and FileSyncer decides when it reaches the disk
     m_file = file.createOutputStream();
     if (!m_file)
         return false;
+    FileSyncer::getInstance()->addFile(file);
 
     m_okOpen = true;
     return true;
 }
 
-String NpyFile::getShapeString()
+String NpyFile::getShapeString() const
 {
     String shape;
     shape.preallocateBytes(32);
@@ -151,14 +183,20 @@ void NpyFile::writeHeader(const Array<NpyType>& typeList)
     m_file->write(&strHeaderLen, sizeof(uint16));
     m_file->write(strHeader.toUTF8(), strHeaderLen);
     m_headerLen = m_file->getPosition(); // total header length
-    m_file->flush();
+
+    // keep a copy, so the checksum of the final header can be computed without reading it back
+    MemoryOutputStream header(m_header, false);
+    header.write(&magicNum, sizeof(uint8));
+    header.write(magicStr.toUTF8(), magicStr.getNumBytesAsUTF8());
+    header.write(&ver, sizeof(uint16));
+    header.write(&strHeaderLen, sizeof(uint16));
+    header.write(strHeader.toUTF8(), strHeaderLen);
 }
 
 void NpyFile::updateHeader()
 {
-    // overwrite the shape part of the header - even without explicitly calling
-    // m_file->flush(), overwriting seems to trigger a flush to disk,
-    // while appending to end of file does not
+    // overwrite the shape part of the header. Seeking writes out the stream buffer, without
+    // forcing it to the disk, which would stall the writer thread
     int64 currentPos = m_file->getPosition(); // returns int64, necessary for big files
     if (m_file->setPosition(m_shapePos))
     {
@@ -168,7 +206,6 @@ void NpyFile::updateHeader()
             std::cerr << "Error. Header has grown too big to update in-place " << std::endl;
         }
         m_file->write(newShape.toUTF8(), newShape.getNumBytesAsUTF8());
-        m_file->flush(); // not necessary, already flushed due to overwrite? do it anyway
         m_file->setPosition(currentPos); // restore position to end of file
     }
     else
@@ -181,19 +218,102 @@ void NpyFile::updateHeader()
 NpyFile::~NpyFile()
 {
     updateHeader();
+    if (m_file)
+    {
+        File file = m_file->getFile();
+        m_file = nullptr;
+        FileSyncer::getInstance()->fileClosed(file);
+    }
+    if (m_journal)
+    {
+        //The header is up to date, the journal is no longer needed
+        File journalFile = m_journal->getFile();
+        m_journal = nullptr;
+        journalFile.deleteFile();
+    }
+}
+
+void NpyFile::setDeferredHeaderUpdates(int64 preallocateBytes, int updateIntervalMs)
+{
+    if (!m_okOpen)
+        return;
+
+    m_deferredHeader = true;
+    m_updateIntervalMs = updateIntervalMs;
+    m_lastHeaderUpdate = Time::getMillisecondCounter();
+    m_preallocateBytes = preallocateBytes;
+
+    File journalFile(m_file->getFile().getFullPathName() + ".journal");
+    journalFile.deleteFile();
+    //Unbuffered, so records reach the OS as soon as they are written, without forcing a disk flush
+    m_journal = journalFile.createOutputStream(0);
+    writeJournalRecord();
+    preallocate();
+}
+
+void NpyFile::writeJournalRecord()
+{
+    if (!m_journal)
+        return;
+    int64 record[2] = { m_recordCount, m_file->getPosition() };
+    m_journal->write(record, sizeof(record));
+}
+
+void NpyFile::preallocate()
+{
+    int64 pos = m_file->getPosition();
+    if (m_preallocateBytes <= 0 || pos + m_preallocateBytes / 2 < m_preallocatedEnd)
+        return;
+    m_preallocatedEnd = pos + m_preallocateBytes;
+    reserveFileSpace(m_file->getFile(), m_preallocatedEnd);
 }
 
 void NpyFile::writeData(const void* data, size_t size)
 {
     m_file->write(data, size);
+    m_dataChecksum.update(data, size);
+}
+
+FileChecksum NpyFile::getChecksum() const
+{
+    FileChecksum checksum;
+    if (!m_okOpen)
+        return checksum;
+    // the header as updateHeader() leaves it, followed by the data
+    MemoryBlock header(m_header);
+    String shape = getShapeString();
+    header.copyFrom(shape.toUTF8(), int(m_shapePos), jmin(shape.getNumBytesAsUTF8(), header.getSize() - m_shapePos));
+    checksum.update(header.getData(), header.getSize());
+    checksum.append(m_dataChecksum);
+    return checksum;
+}
+
+File NpyFile::getFile() const
+{
+    return m_okOpen ? m_file->getFile() : File();
 }
 
 void NpyFile::increaseRecordCount(int count)
 {
     int64 old_recordCount = m_recordCount;
     m_recordCount += count;
-    if ((old_recordCount / recordBufferSize) != (m_recordCount / recordBufferSize))
-        updateHeader(); // crossed recordBufferSize threshold, update header
+    bool crossed = (old_recordCount / recordBufferSize) != (m_recordCount / recordBufferSize);
+    if (!m_deferredHeader)
+    {
+        if (crossed)
+            updateHeader(); // crossed recordBufferSize threshold, update header
+        return;
+    }
+
+    if (crossed)
+        writeJournalRecord();
+    uint32 now = Time::getMillisecondCounter();
+    if (now - m_lastHeaderUpdate >= uint32(m_updateIntervalMs))
+    {
+        updateHeader();
+        m_lastHeaderUpdate = now;
+        preallocate();
+    }
 }
 
 NpyType::NpyType(String n, BaseType t, size_t l)
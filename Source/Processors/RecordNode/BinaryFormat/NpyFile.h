@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define NPYFILE_H
 
 #include "../RecordEngine.h"
+#include "../FileChecksum.h"
 
 namespace BinaryRecordingEngine
 {
@@ -53,12 +54,26 @@ namespace BinaryRecordingEngine
         ~NpyFile();
         void writeData(const void* data, size_t size);
         void increaseRecordCount(int count = 1);
+
+        /** Switches to deferred header updates. Instead of rewriting the header, and flushing the file,
+        every recordBufferSize records, the header is rewritten at most every updateIntervalMs and on close.
+        In between, the record count is appended to a <file>.journal sidecar, removed on close, so a file
+        whose header is stale after a crash can still be recovered. Disk space is reserved
+        preallocateBytes at a time, without changing the file size, where the platform allows it.*/
+        void setDeferredHeaderUpdates(int64 preallocateBytes, int updateIntervalMs);
+        /** Checksum of the file as it will be once closed, with the header for the records written so far */
+        FileChecksum getChecksum() const;
+        File getFile() const;
+
     private:
         bool openFile(String path);
-        String getShapeString();
+        String getShapeString() const;
         void writeHeader(const Array<NpyType>& typeList);
         void updateHeader();
+        void writeJournalRecord();
+        void preallocate();
         ScopedPointer<FileOutputStream> m_file;
+        ScopedPointer<FileOutputStream> m_journal;
         int64 m_headerLen; // total header length
         bool m_okOpen{ false };
         int64 m_recordCount{ 0 };
@@ -66,6 +81,15 @@ namespace BinaryRecordingEngine
         unsigned int m_dim1;
         unsigned int m_dim2;
 
+        bool m_deferredHeader{ false };
+        int m_updateIntervalMs{ 0 };
+        uint32 m_lastHeaderUpdate{ 0 };
+        int64 m_preallocateBytes{ 0 };
+        int64 m_preallocatedEnd{ 0 };
+        //The header as first written, and the checksum of everything after it
+        MemoryBlock m_header;
+        FileChecksum m_dataChecksum;
+
         // Compile-time constants
 
         // flush file buffer to disk and update the .npy header every this many records:
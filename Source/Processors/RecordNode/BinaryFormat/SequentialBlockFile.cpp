@@ -22,11 +22,27 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "SequentialBlockFile.h"
+#include "../../DataThreads/SampleConversion.h"
+#include "../../GenericProcessor/RealtimeLog.h"
 
 using namespace BinaryRecordingEngine;
 
-SequentialBlockFile::SequentialBlockFile(int nChannels, int samplesPerBlock) :
+SequentialBlockFile::SequentialBlockFile(int nChannels, int samplesPerBlock, bool directWrites) :
 m_file(nullptr),
+m_directWrites(directWrites),
+m_nChannels(nChannels),
+m_samplesPerBlock(samplesPerBlock),
+m_blockSize(nChannels*samplesPerBlock),
+m_lastBlockFill(0)
+{
+    m_memBlocks.ensureStorageAllocated(blockArrayInitSize);
+    for (int i = 0; i < nChannels; i++)
+        m_currentBlock.add(-1);
+}
+
+SequentialBlockFile::SequentialBlockFile(int nChannels, int samplesPerBlock, BlockFileWriter* writer) :
+m_file(writer),
+m_directWrites(false),
 m_nChannels(nChannels),
 m_samplesPerBlock(samplesPerBlock),
 m_blockSize(nChannels*samplesPerBlock),
@@ -38,6 +54,11 @@ m_lastBlockFill(0)
 }
 
 SequentialBlockFile::~SequentialBlockFile()
+{
+    close();
+}
+
+void SequentialBlockFile::close()
 {
     //Ensure that all remaining blocks are flushed in order. Keep the last one
     int n = m_memBlocks.size();
@@ -47,7 +68,24 @@ SequentialBlockFile::~SequentialBlockFile()
     }
 
     //manually flush the last one to avoid trailing zeroes
-    m_memBlocks[0]->partialFlush(m_lastBlockFill * m_nChannels);
+    if (m_memBlocks.size() > 0)
+    {
+        m_memBlocks[0]->partialFlush(m_lastBlockFill * m_nChannels);
+        m_memBlocks.clear();
+    }
+    if (m_file)
+        m_file->close();
+}
+
+void SequentialBlockFile::addChecksums(ChecksumManifest& manifest) const
+{
+    if (m_file)
+        m_file->addChecksums(manifest);
+}
+
+size_t SequentialBlockFile::getMemorySize() const
+{
+    return size_t(m_memBlocks.size() + m_freeBlocks.size()) * m_blockSize * sizeof(int16);
 }
 
 bool SequentialBlockFile::openFile(String filename)
@@ -56,22 +94,33 @@ bool SequentialBlockFile::openFile(String filename)
     Result res = file.create();
     if (res.failed())
     {
-        std::cerr << "Error creating file " << filename << ":" << res.getErrorMessage() << std::endl;
+        RealtimeLog::write(RealtimeLog::LOG_ERROR, "Error creating file %s: %s", filename.toRawUTF8(), res.getErrorMessage().toRawUTF8());
         return false;
     }
-    m_file = file.createOutputStream(streamBufferSize);
     if (!m_file)
+        m_file = BlockFileWriter::createWriter(m_directWrites);
+    if (!m_file->open(file))
+    {
+        m_file = nullptr;
         return false;
+    }
 
-    m_memBlocks.add(new FileBlock(m_file, m_blockSize, 0));
+    m_memBlocks.add(getFreeBlock(0));
     return true;
 }
 
 bool SequentialBlockFile::writeChannel(uint64 startPos, int channel, int16* data, int nSamples)
 {
-    if (!m_file)
-        return false;
+    return writeSamples(startPos, channel, data, nullptr, 0, nSamples);
+}
 
+bool SequentialBlockFile::writeChannel(uint64 startPos, int channel, const float* data, int nSamples, float scale)
+{
+    return writeSamples(startPos, channel, nullptr, data, scale, nSamples);
+}
+
+int SequentialBlockFile::findStartBlock(uint64 startPos, int channel, int nSamples)
+{
     int bIndex = m_memBlocks.size() - 1;
     if ((bIndex < 0) || (m_memBlocks[bIndex]->getOffset() + m_samplesPerBlock) < (startPos + nSamples))
         allocateBlocks(startPos, nSamples);
@@ -83,11 +132,68 @@ bool SequentialBlockFile::writeChannel(uint64 startPos, int channel, int16* data
     }
     if (bIndex < 0)
     {
-        std::cerr << "BINARY WRITER: Memory block unloaded ahead of time for chan " << channel << " start " << startPos << " ns " << nSamples << " first " << m_memBlocks[0]->getOffset() <<std::endl;
+        RealtimeLog::write(RealtimeLog::LOG_ERROR, "BINARY WRITER: Memory block unloaded ahead of time for chan %d start %lld ns %d first %lld",
+            channel, (long long)startPos, nSamples, (long long)m_memBlocks[0]->getOffset());
         for (int i = 0; i < m_nChannels; i++)
-            std::cout << "channel " << i << " last block " << m_currentBlock[i] << std::endl;
+            RealtimeLog::write(RealtimeLog::LOG_DEBUG, "channel %d last block %d", i, m_currentBlock[i]);
+    }
+    return bIndex;
+}
+
+bool SequentialBlockFile::writeChannels(uint64 startPos, int firstChannel, int numChannels, const float* const* data, const float* scales, int nSamples)
+{
+    if (!m_file)
         return false;
+
+    int bIndex = findStartBlock(startPos, firstChannel, nSamples);
+    if (bIndex < 0)
+        return false;
+
+    int writtenSamples = 0;
+    int startIdx = startPos - m_memBlocks[bIndex]->getOffset();
+    int lastBlockIdx = m_memBlocks.size() - 1;
+    while (writtenSamples < nSamples)
+    {
+        int16* blockPtr = m_memBlocks[bIndex]->getData();
+        int samplesToWrite = jmin((nSamples - writtenSamples), (m_samplesPerBlock - startIdx));
+
+        //The block is filled a tile of samples at a time, so the rows being interleaved
+        //stay in cache while every channel is written into them
+        for (int tile = 0; tile < samplesToWrite; tile += interleaveTileSamples)
+        {
+            int tileSamples = jmin(interleaveTileSamples, samplesToWrite - tile);
+            int16* tilePtr = blockPtr + (startIdx + tile)*m_nChannels + firstChannel;
+            for (int c = 0; c < numChannels; c++)
+                SampleConversion::convertFloatToInt16(tilePtr + c, m_nChannels, data[c] + writtenSamples + tile, tileSamples, scales[c]);
+        }
+        for (int c = 0; c < numChannels; c++)
+            m_memBlocks[bIndex]->markWritten(firstChannel + c, startIdx, startIdx + samplesToWrite);
+        writtenSamples += samplesToWrite;
+
+        //Update the last block fill index
+        size_t samplePos = startIdx + samplesToWrite;
+        if (bIndex == lastBlockIdx && samplePos > m_lastBlockFill)
+        {
+            m_lastBlockFill = samplePos;
+        }
+
+        startIdx = 0;
+        bIndex++;
     }
+    for (int c = 0; c < numChannels; c++)
+        m_currentBlock.set(firstChannel + c, bIndex - 1);
+    return true;
+}
+
+bool SequentialBlockFile::writeSamples(uint64 startPos, int channel, const int16* data, const float* floatData, float scale, int nSamples)
+{
+    if (!m_file)
+        return false;
+
+    int bIndex = findStartBlock(startPos, channel, nSamples);
+    if (bIndex < 0)
+        return false;
+
     int writtenSamples = 0;
     int startIdx = startPos - m_memBlocks[bIndex]->getOffset();
     int startMemPos = startIdx*m_nChannels;
@@ -97,17 +203,27 @@ bool SequentialBlockFile::writeChannel(uint64 startPos, int channel, int16* data
     {
         int16* blockPtr = m_memBlocks[bIndex]->getData();
         int samplesToWrite = jmin((nSamples - writtenSamples), (m_samplesPerBlock - startIdx));
-        for (int i = 0; i < samplesToWrite; i++)
+        if (floatData)
         {
-            //if (writtenSamples == 0 && *(data + dataIdx) == 0)
-            //{
-            //  std::cout << "Found a zero." << std::endl;
-            //  break;
-            //}
-
-            *(blockPtr + startMemPos + channel + i*m_nChannels) = *(data + dataIdx);
-            dataIdx++;
+            //Scale, round and saturate straight into the interleaved block
+            SampleConversion::convertFloatToInt16(blockPtr + startMemPos + channel, m_nChannels, floatData + dataIdx, samplesToWrite, scale);
+            dataIdx += samplesToWrite;
         }
+        else
+        {
+            for (int i = 0; i < samplesToWrite; i++)
+            {
+                //if (writtenSamples == 0 && *(data + dataIdx) == 0)
+                //{
+                //  std::cout << "Found a zero." << std::endl;
+                //  break;
+                //}
+
+                *(blockPtr + startMemPos + channel + i*m_nChannels) = *(data + dataIdx);
+                dataIdx++;
+            }
+        }
+        m_memBlocks[bIndex]->markWritten(channel, startIdx, startIdx + samplesToWrite);
         writtenSamples += samplesToWrite;
 
         //Update the last block fill index
@@ -142,7 +258,13 @@ void SequentialBlockFile::allocateBlocks(uint64 startIndex, int numSamples)
         m_currentBlock.set(i, m_currentBlock[i] - minBlock);
     }
 
-    m_memBlocks.removeRange(0, minBlock);
+    int numToRemove = jlimit(0, m_memBlocks.size(), (int)minBlock);
+    for (int i = 0; i < numToRemove; i++)
+    {
+        FileBlock* block = m_memBlocks.removeAndReturn(0);
+        block->flush();
+        m_freeBlocks.add(block);
+    }
 
     //for (int i = 0; i < minBlock; i++)
     //{
@@ -159,9 +281,19 @@ void SequentialBlockFile::allocateBlocks(uint64 startIndex, int numSamples)
     for (int i = 0; i < newBlocks; i++)
     {
         lastOffset += m_samplesPerBlock;
-        m_memBlocks.add(new FileBlock(m_file, m_blockSize, lastOffset));
+        m_memBlocks.add(getFreeBlock(lastOffset));
     }
     if (newBlocks > 0)
         m_lastBlockFill = 0; //we've added some new blocks, so the last one will be empty
 }
 
+FileBlock* SequentialBlockFile::getFreeBlock(uint64 offset)
+{
+    if (m_freeBlocks.size() > 0)
+    {
+        FileBlock* block = m_freeBlocks.removeAndReturn(m_freeBlocks.size() - 1);
+        block->reuse(offset);
+        return block;
+    }
+    return new FileBlock(m_file, m_nChannels, m_samplesPerBlock, offset);
+}
@@ -34,27 +34,53 @@ namespace BinaryRecordingEngine
     class SequentialBlockFile
     {
     public:
-        SequentialBlockFile(int nChannels, int samplesPerBlock);
+        /** With directWrites set, blocks are written bypassing the OS page cache when possible */
+        SequentialBlockFile(int nChannels, int samplesPerBlock, bool directWrites = false);
+        /** Writes the blocks through the given writer, which the file takes ownership of */
+        SequentialBlockFile(int nChannels, int samplesPerBlock, BlockFileWriter* writer);
         ~SequentialBlockFile();
 
         bool openFile(String filename);
         bool writeChannel(uint64 startPos, int channel, int16* data, int nSamples);
+        /** Converts float samples to int16 as round(data[i] * scale) while copying them into the blocks */
+        bool writeChannel(uint64 startPos, int channel, const float* data, int nSamples, float scale);
+        /** Writes the same samples of numChannels consecutive channels at once, converting each as
+        writeChannel does with its own scale. Cheaper than one writeChannel per channel, as every
+        part of the interleaved blocks is only brought into cache once */
+        bool writeChannels(uint64 startPos, int firstChannel, int numChannels, const float* const* data, const float* scales, int nSamples);
+
+        /** Flushes the remaining blocks and closes the file. Called on destruction if not called before */
+        void close();
+        /** Adds the files written and their checksums. Only valid after close */
+        void addChecksums(ChecksumManifest& manifest) const;
+
+        /** Bytes taken by the blocks being filled and the ones kept for reuse */
+        size_t getMemorySize() const;
 
     private:
-        ScopedPointer<FileOutputStream> m_file;
+        ScopedPointer<BlockFileWriter> m_file;
+        const bool m_directWrites;
         const int m_nChannels;
         const int m_samplesPerBlock;
         const int m_blockSize;
         OwnedArray<FileBlock> m_memBlocks;
+        //Flushed blocks kept for reuse, so the writer doesn't allocate in steady state
+        OwnedArray<FileBlock> m_freeBlocks;
         Array<int> m_currentBlock;
         size_t m_lastBlockFill;
 
         void allocateBlocks(uint64 startIndex, int numSamples);
+        FileBlock* getFreeBlock(uint64 offset);
+        /** Allocates the blocks for the samples and returns the index of the one startPos falls in, or -1 if it was already flushed */
+        int findStartBlock(uint64 startPos, int channel, int nSamples);
+        /** Common implementation of writeChannel. Converts from floatData when it is not null */
+        bool writeSamples(uint64 startPos, int channel, const int16* data, const float* floatData, float scale, int nSamples);
 
 
         //Compile-time parameters
-        const int streamBufferSize{ 0 };
         const int blockArrayInitSize{ 128 };
+        //Samples per channel interleaved at a time by writeChannels
+        const int interleaveTileSamples{ 64 };
 
     };
 
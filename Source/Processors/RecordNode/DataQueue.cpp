@@ -22,6 +22,8 @@
 */
 #include "../../../JuceLibraryCode/JuceHeader.h"
 #include "DataQueue.h"
+#include "../GenericProcessor/ThreadPolicy.h"
+#include "../GenericProcessor/RealtimeLog.h"
 
 DataQueue::DataQueue(int blockSize, int nBlocks) :
 m_buffer(0, blockSize*nBlocks),
@@ -35,26 +37,23 @@ m_maxSize(blockSize*nBlocks)
 DataQueue::~DataQueue()
 {}
 
-void DataQueue::setChannels(int nChans)
+void DataQueue::setChannels(const Array<int>& channelGroups)
 {
 	if (m_readInProgress)
 		return;
 
-	m_fifos.clear();
-	m_readSamples.clear();
-	m_numChans = nChans;
-	m_timestamps.clear();
-	m_lastReadTimestamps.clear();
+	m_groups.clear();
+	m_channelGroups = channelGroups;
+	m_numChans = channelGroups.size();
 
-	for (int i = 0; i < nChans; ++i)
+	for (int i = 0; i < m_numChans; ++i)
 	{
-		m_fifos.add(new AbstractFifo(m_maxSize));
-		m_readSamples.add(0);
-		m_timestamps.add(new Array<int64>());
-		m_timestamps.getLast()->resize(m_numBlocks);
-		m_lastReadTimestamps.add(0);
+		int group = channelGroups[i];
+		while (m_groups.size() <= group)
+			m_groups.add(new ChannelGroup(m_maxSize, m_numBlocks));
+		m_groups[group]->channels.add(i);
 	}
-	m_buffer.setSize(nChans, m_maxSize);
+	allocateBuffer(m_maxSize);
 }
 
 void DataQueue::resize(int nBlocks)
@@ -66,18 +65,28 @@ void DataQueue::resize(int nBlocks)
 	m_maxSize = size;
 	m_numBlocks = nBlocks;
 
-	for (int i = 0; i < m_numChans; ++i)
+	for (int i = 0; i < m_groups.size(); ++i)
 	{
-		m_fifos[i]->setTotalSize(size);
-		m_fifos[i]->reset();
-		m_readSamples.set(i, 0);
-		m_timestamps[i]->resize(nBlocks);
-		m_lastReadTimestamps.set(i, 0);
+		ChannelGroup* group = m_groups[i];
+		group->fifo.setTotalSize(size);
+		group->fifo.reset();
+		group->readSamples = 0;
+		group->timestamps.resize(nBlocks);
+		group->lastReadTimestamp = 0;
+		group->stats.reset();
 	}
-	m_buffer.setSize(m_numChans, size);
+	allocateBuffer(size);
+}
+
+void DataQueue::allocateBuffer(int size)
+{
+	// The queue is filled from the audio callback, so its pages are first touched,
+	// and allocated, on the NUMA node of that thread
+	ThreadPolicy::ScopedPlacement placement(ThreadPolicy::AudioCallback);
+	m_bufferMemory.allocateAudioBuffer(m_buffer, m_numChans, size);
 }
 
-void DataQueue::fillTimestamps(int channel, int index, int size, int64 timestamp)
+void DataQueue::fillTimestamps(ChannelGroup* group, int index, int size, int64 timestamp)
 {
 	//Search for the next block start.
 	int blockMod = index % m_blockSize;
@@ -103,41 +112,62 @@ void DataQueue::fillTimestamps(int channel, int index, int size, int64 timestamp
 		if ((blockStartPos + i) < (index + size))
 		{
 			int64 ts = startTimestamp + (i*m_blockSize);
-			m_timestamps[channel]->set(blockIdx, ts);
+			group->timestamps.set(blockIdx, ts);
 		}
 
 	}
 }
 
-void DataQueue::writeChannel(const AudioSampleBuffer& buffer, int channel, int sourceChannel, int nSamples, int64 timestamp)
+void DataQueue::writeGroup(const AudioSampleBuffer& buffer, int group, const Array<int>& sourceChannels, int nSamples, int64 timestamp, int ringSamples)
 {
-	int index1, size1, index2, size2;
-	m_fifos[channel]->prepareToWrite(nSamples, index1, size1, index2, size2);
-	if ((size1 + size2) < nSamples)
-	{ //TODO: turn this into a proper notification. Probably returning a bool.
-		std::cerr << "Recording Data Queue Overflow" << std::endl;
+	ChannelGroup* g = m_groups[group];
+	if (ringSamples > 0)
+	{
+		//Act as the reader and drop the oldest samples
+		int ready = g->fifo.getNumReady();
+		int excess = ready + nSamples - jmin(ringSamples, m_maxSize - 1);
+		if (excess > 0)
+			g->fifo.finishedRead(jmin(excess, ready));
 	}
-	m_buffer.copyFrom(channel,
-		index1,
-		buffer,
-		sourceChannel,
-		0,
-		size1);
-	
-	fillTimestamps(channel, index1, size1, timestamp);
-	
-	if (size2 > 0)
+
+	int index1, size1, index2, size2;
+	g->fifo.prepareToWrite(nSamples, index1, size1, index2, size2);
+
+	const int nChans = g->channels.size();
+	for (int i = 0; i < nChans; ++i)
 	{
+		int channel = g->channels.getUnchecked(i);
+		int sourceChannel = sourceChannels.getUnchecked(channel);
 		m_buffer.copyFrom(channel,
-			index2,
+			index1,
 			buffer,
 			sourceChannel,
-			size1,
-			size2);
+			0,
+			size1);
 
-		fillTimestamps(channel, index2, size2, timestamp + size1);
+		if (size2 > 0)
+		{
+			m_buffer.copyFrom(channel,
+				index2,
+				buffer,
+				sourceChannel,
+				size1,
+				size2);
+		}
+	}
+
+	fillTimestamps(g, index1, size1, timestamp);
+	if (size2 > 0)
+		fillTimestamps(g, index2, size2, timestamp + size1);
+
+	g->fifo.finishedWrite(size1 + size2);
+	//A ring is full on purpose
+	if (ringSamples <= 0)
+	{
+		g->stats.recordWrite(nSamples * nChans, (size1 + size2) * nChans, g->fifo.getNumReady(), g->fifo.getFreeSpace());
+		if (size1 + size2 < nSamples)
+			RealtimeLog::write(RealtimeLog::LOG_WARNING, "Record data queue full: %d samples of %d channels dropped", nSamples - size1 - size2, nChans);
 	}
-	m_fifos[channel]->finishedWrite(size1 + size2);
 }
 
 /* 
@@ -152,45 +182,37 @@ const AudioSampleBuffer& DataQueue::getAudioBufferReference() const
 	return m_buffer;
 }
 
-bool DataQueue::startRead(Array<CircularBufferIndexes>& indexes, Array<int64>& timestamps, int nMax)
+bool DataQueue::startRead(Array<CircularBufferIndexes>& indexes, Array<int64>& timestamps, int nMax, bool drain)
 {
 	//This should never happen, but it never hurts to be on the safe side.
 	if (m_readInProgress)
 		return false;
 
 	m_readInProgress = true;
-	indexes.clear(); //Just in case it's not empty already
-	timestamps.clear();
-
-	for (int chan = 0; chan < m_numChans; ++chan)
+	for (int i = 0; i < m_groups.size(); ++i)
 	{
-		CircularBufferIndexes idx;
-		int readyToRead = m_fifos[chan]->getNumReady();
+		ChannelGroup* group = m_groups[i];
+		CircularBufferIndexes& idx = group->readIndexes;
+		int readyToRead = group->fifo.getNumReady();
+		if (!drain)
+			readyToRead = jmax(0, readyToRead - group->holdBack);
 		int samplesToRead = ((readyToRead > nMax) && (nMax > 0)) ? nMax : readyToRead;
 
-		m_fifos[chan]->prepareToRead(samplesToRead, idx.index1, idx.size1, idx.index2, idx.size2);
-		indexes.add(idx);
-		m_readSamples.set(chan, idx.size1 + idx.size2);
-		
-		int blockMod = idx.index1 % m_blockSize;
-		int blockDiff = (blockMod == 0) ? 0 : (m_blockSize - blockMod);
+		group->fifo.prepareToRead(samplesToRead, idx.index1, idx.size1, idx.index2, idx.size2);
+		group->readSamples = idx.size1 + idx.size2;
 
-		//If the next timestamp block is within the data we're reading, include the translated timestamp in the output
-		if (blockDiff < (idx.size1 + idx.size2))
-		{
-			int blockIdx = ((idx.index1 + blockDiff) / m_blockSize) % m_numBlocks;
-			int64 ts = m_timestamps[chan]->getUnchecked(blockIdx) - blockDiff;
-			timestamps.add(ts);
-			//update to the end of the block
-			m_lastReadTimestamps.set(chan, ts+ idx.size1 + idx.size2);
-		}
-		//If not, copy the last sent again 
-		else
-		{
-			int64 ts = m_lastReadTimestamps[chan];
-			timestamps.add(ts);
-			m_lastReadTimestamps.set(chan, ts + idx.size1 + idx.size2);
-		}
+		//update to the end of the block
+		group->lastReadTimestamp = getTimestampAt(group, idx.index1, group->readSamples) + group->readSamples;
+	}
+
+	//Indexes and timestamps are still handed out per channel
+	indexes.clearQuick(); //Just in case it's not empty already. Keeps the storage to avoid reallocating on every read
+	timestamps.clearQuick();
+	for (int chan = 0; chan < m_numChans; ++chan)
+	{
+		const ChannelGroup* group = m_groups.getUnchecked(m_channelGroups.getUnchecked(chan));
+		indexes.add(group->readIndexes);
+		timestamps.add(group->lastReadTimestamp - group->readSamples);
 	}
 	return true;
 }
@@ -200,19 +222,73 @@ void DataQueue::stopRead()
 	if (!m_readInProgress)
 		return;
 
-	for (int i = 0; i < m_numChans; ++i)
+	for (int i = 0; i < m_groups.size(); ++i)
 	{
-		m_fifos[i]->finishedRead(m_readSamples[i]);
-		m_readSamples.set(i, 0);
+		m_groups[i]->fifo.finishedRead(m_groups[i]->readSamples);
+		m_groups[i]->readSamples = 0;
 	}
 	m_readInProgress = false;
 }
 
-void DataQueue::getTimestampsForBlock(int idx, Array<int64>& timestamps) const
+int64 DataQueue::getTimestampAt(const ChannelGroup* group, int index, int numSamples) const
 {
-	timestamps.clear();
-	for (int chan = 0; chan < m_numChans; ++chan)
+	int blockMod = index % m_blockSize;
+	int blockDiff = (blockMod == 0) ? 0 : (m_blockSize - blockMod);
+
+	//If the next timestamp block is within the data, use the translated timestamp
+	if (blockDiff < numSamples)
+		return group->timestamps.getUnchecked(((index + blockDiff) / m_blockSize) % m_numBlocks) - blockDiff;
+	//If not, continue from the last one sent
+	return group->lastReadTimestamp;
+}
+
+void DataQueue::getReadTimestamps(Array<int64>& timestamps)
+{
+	for (int i = 0; i < m_groups.size(); ++i)
 	{
-		timestamps.add((*m_timestamps[chan])[idx]);
+		ChannelGroup* group = m_groups[i];
+		int index1, size1, index2, size2;
+		group->fifo.prepareToRead(group->fifo.getNumReady(), index1, size1, index2, size2);
+		if (size1 + size2 > 0)
+			group->lastReadTimestamp = getTimestampAt(group, index1, size1 + size2);
 	}
-}
\ No newline at end of file
+
+	timestamps.clearQuick();
+	for (int chan = 0; chan < m_numChans; ++chan)
+		timestamps.add(m_groups[m_channelGroups[chan]]->lastReadTimestamp);
+}
+
+void DataQueue::setReadHoldBack(const Array<int>& samples)
+{
+	for (int i = 0; i < m_groups.size(); ++i)
+		m_groups[i]->holdBack = jmax(0, samples[i]);
+}
+
+int DataQueue::getChannelGroup(int channel) const
+{
+	return m_channelGroups[channel];
+}
+
+BufferStats DataQueue::getStats() const
+{
+	//Each group fills on its own, so the worst group is reported and the drops are summed
+	BufferStats stats;
+	for (int i = 0; i < m_groups.size(); ++i)
+		stats.merge(m_groups[i]->stats.getStats(m_groups[i]->fifo.getNumReady(), m_maxSize - 1));
+
+	return stats;
+}
+
+size_t DataQueue::getMemorySize() const
+{
+	size_t bytes = m_bufferMemory.getSize();
+	for (int i = 0; i < m_groups.size(); ++i)
+		bytes += size_t(m_groups[i]->timestamps.size()) * sizeof(int64);
+	return bytes;
+}
+
+void DataQueue::resetStats()
+{
+	for (int i = 0; i < m_groups.size(); ++i)
+		m_groups[i]->stats.reset();
+}
@@ -25,6 +25,7 @@
 #define DATAQUEUE_H_INCLUDED
 
 #include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../DataThreads/DataBuffer.h"
 
 struct CircularBufferIndexes
 {
@@ -34,31 +35,82 @@ struct CircularBufferIndexes
 	int size2;
 };
 
+/**
+	Circular buffer of the continuous data waiting to be written to disk.
+
+	Channels are grouped by the source they come from, as all channels of a source
+	have the same number of samples and timestamps in every block. Each group has a
+	single FIFO and block timestamp track, and is written with a single call.
+
+	Groups can also be written as rings while no thread reads them, keeping only the
+	newest samples, so the data from before a recording starts can be written first.
+*/
 class DataQueue
 {
 public:
 	DataQueue(int blockSize, int nBlocks);
 	~DataQueue();
-	void setChannels(int nChans);
+	/** Sets the number of channels, one per entry, and the group each belongs to. Group numbers must be consecutive from 0 */
+	void setChannels(const Array<int>& channelGroups);
 	void resize(int nBlocks);
-	void getTimestampsForBlock(int idx, Array<int64>& timestamps) const;
+	/** Gets the timestamp of the first sample waiting in each channel, and makes it the start of the next read.
+	Only call from the reader thread, before its first startRead */
+	void getReadTimestamps(Array<int64>& timestamps);
+
+	/** Sets, for each group, how many of the newest samples startRead leaves in the queue.
+	Only call from the reader thread, before its first startRead */
+	void setReadHoldBack(const Array<int>& samples);
+	/** Returns the group a channel belongs to */
+	int getChannelGroup(int channel) const;
+
+	/** Returns the overflow counters of the queue, kept per group. Fill values are those of the fullest group
+	and the dropped samples are those of all groups */
+	BufferStats getStats() const;
+	void resetStats();
+	/** Returns the bytes taken by the samples and the block timestamps of the queue */
+	size_t getMemorySize() const;
 
 	//Only the methods after this comment are considered thread-safe.
 	//Caution must be had to avoid calling more than one of the methods above simulatenously
-	void writeChannel(const AudioSampleBuffer& buffer, int channel, int sourceChannel, int nSamples, int64 timestamp);
-	bool startRead(Array<CircularBufferIndexes>& indexes, Array<int64>& timestamps, int nMax);
+	/** Writes all the channels of a group. sourceChannels holds the channel of the buffer for each queue channel.
+	If ringSamples is greater than 0, the oldest samples are discarded to keep at most that many in the group,
+	which is only safe while no thread reads the queue */
+	void writeGroup(const AudioSampleBuffer& buffer, int group, const Array<int>& sourceChannels, int nSamples, int64 timestamp, int ringSamples = 0);
+	/** Starts reading up to nMax samples of each group. If drain is true the samples held back are read as well */
+	bool startRead(Array<CircularBufferIndexes>& indexes, Array<int64>& timestamps, int nMax, bool drain = false);
 	const AudioSampleBuffer& getAudioBufferReference() const;
 	void stopRead();
 	
 
 private:
-	void fillTimestamps(int channel, int index, int size, int64 timestamp);
-
-	OwnedArray<AbstractFifo> m_fifos;
+	struct ChannelGroup
+	{
+		ChannelGroup(int size, int nBlocks) : fifo(size), readSamples(0), holdBack(0), lastReadTimestamp(0)
+		{
+			timestamps.resize(nBlocks);
+		}
+
+		AbstractFifo fifo;
+		Array<int> channels;
+		Array<int64> timestamps;
+		CircularBufferIndexes readIndexes;
+		int readSamples;
+		int holdBack;
+		int64 lastReadTimestamp;
+		//Written by the thread writing the group
+		BufferStatsMonitor stats;
+	};
+
+	void allocateBuffer(int size);
+	void fillTimestamps(ChannelGroup* group, int index, int size, int64 timestamp);
+	/** Timestamp of the sample at index, with numSamples written from there on. Uses the end of the last read
+	if no timestamp block starts within them */
+	int64 getTimestampAt(const ChannelGroup* group, int index, int numSamples) const;
+
+	OwnedArray<ChannelGroup> m_groups;
+	Array<int> m_channelGroups;
 	AudioSampleBuffer m_buffer;
-	Array<int> m_readSamples;
-	OwnedArray<Array<int64>> m_timestamps;
-	Array<int64> m_lastReadTimestamps;
+	LockedMemoryBlock m_bufferMemory;
 
 	int m_numChans;
 	const int m_blockSize;
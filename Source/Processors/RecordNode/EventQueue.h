@@ -27,6 +27,7 @@
 #include "../../../JuceLibraryCode/JuceHeader.h"
 #include "../Events/Events.h"
 #include <vector>
+#include <atomic>
 
 template <class MsgContainer>
 class AsyncEventMessage :
@@ -130,10 +131,182 @@ private:
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EventQueue);
 };
+/** Serialization traits for PooledEventQueue. Each specialization reports the serialized size of an event
+and writes it into a slot, without allocating */
+template <class EventClass>
+struct PooledEventSerializer;
+
+template <>
+struct PooledEventSerializer<MidiMessage>
+{
+	static size_t getSize(const MidiMessage& ev) { return ev.getRawDataSize(); }
+	static void write(const MidiMessage& ev, char* dst, size_t size) { memcpy(dst, ev.getRawData(), size); }
+};
+
+template <>
+struct PooledEventSerializer<SpikeEvent>
+{
+	static size_t getSize(const SpikeEvent& ev)
+	{
+		const SpikeChannel* chan = ev.getChannelInfo();
+		return chan->getWaveformDataSize() + chan->getTotalEventMetaDataSize() + SPIKE_BASE_SIZE + chan->getNumChannels()*sizeof(float);
+	}
+	static void write(const SpikeEvent& ev, char* dst, size_t size) { ev.serialize(dst, size); }
+};
+
+/**
+Fixed-slot variant of EventQueue. Events are serialized into a preallocated slab instead of being copied
+into heap-allocated containers, so addEvent is safe to call from the audio thread.
+The reader accesses the raw serialized data in place between startRead and finishedRead.
+Events that do not fit, either because the queue is full or because they are larger than a slot,
+are counted as overruns.
+*/
+template <class EventClass>
+class PooledEventQueue
+{
+public:
+	typedef PooledEventSerializer<EventClass> Serializer;
+
+	PooledEventQueue(int numSlots, int slotSize) :
+		m_fifo(numSlots),
+		m_numOverruns(0),
+		m_readPos1(0), m_readSize1(0), m_readPos2(0), m_readSize2(0)
+	{
+		allocate(slotSize);
+	}
+
+	~PooledEventQueue()
+	{}
+
+	int getRemainingEvents() const
+	{
+		return m_fifo.getNumReady();
+	}
+
+	void reset()
+	{
+		m_fifo.reset();
+		m_numOverruns = 0;
+		m_readSize1 = m_readSize2 = 0;
+	}
+
+	/** Not thread safe. Only call while no thread is reading or writing */
+	void resize(int numSlots, int slotSize)
+	{
+		m_fifo.setTotalSize(numSlots);
+		allocate(slotSize);
+		reset();
+	}
+
+	int getSlotSize() const
+	{
+		return m_slotSize;
+	}
+
+	/** Bytes taken by the slots */
+	size_t getMemorySize() const
+	{
+		return size_t(m_fifo.getTotalSize()) * m_slotStride;
+	}
+
+	/** Number of events rejected since the last reset */
+	int getNumOverruns() const
+	{
+		return m_numOverruns.load();
+	}
+
+	/** With overwriteOldest, a full queue drops its oldest event instead of the new one. Only safe while no thread reads the queue */
+	bool addEvent(const EventClass& ev, int64 t, int extra = 0, bool overwriteOldest = false)
+	{
+		size_t size = Serializer::getSize(ev);
+		int pos1, size1, pos2, size2;
+		size1 = 0;
+		if (overwriteOldest && m_fifo.getFreeSpace() < 1 && m_fifo.getNumReady() > 0)
+			m_fifo.finishedRead(1);
+		m_fifo.prepareToWrite(1, pos1, size1, pos2, size2);
+
+		/* Never overwrite data the reader might be accessing. Skip the event and count it instead */
+		if (size1 < 1 || size > size_t(m_slotSize))
+		{
+			++m_numOverruns;
+			return false;
+		}
+		char* slot = getSlot(pos1);
+		SlotHeader* header = reinterpret_cast<SlotHeader*>(slot);
+		header->timestamp = t;
+		header->extra = extra;
+		header->size = int(size);
+		Serializer::write(ev, slot + sizeof(SlotHeader), size);
+		m_fifo.finishedWrite(1);
+		return true;
+	}
+
+	/** Gives access to up to max events (all available if max <= 0). Returns the number of events that
+	can be accessed with the getters until finishedRead is called */
+	int startRead(int max)
+	{
+		int numAvailable = m_fifo.getNumReady();
+		int numToRead = ((max < numAvailable) && (max > 0)) ? max : numAvailable;
+		m_fifo.prepareToRead(numToRead, m_readPos1, m_readSize1, m_readPos2, m_readSize2);
+		return m_readSize1 + m_readSize2;
+	}
+
+	int64 getTimestamp(int i) const { return getReadHeader(i)->timestamp; }
+	int getExtra(int i) const { return getReadHeader(i)->extra; }
+	int getDataSize(int i) const { return getReadHeader(i)->size; }
+	const uint8* getData(int i) const
+	{
+		return reinterpret_cast<const uint8*>(getReadHeader(i)) + sizeof(SlotHeader);
+	}
+
+	void finishedRead()
+	{
+		m_fifo.finishedRead(m_readSize1 + m_readSize2);
+		m_readSize1 = m_readSize2 = 0;
+	}
+
+private:
+	struct SlotHeader
+	{
+		int64 timestamp;
+		int extra;
+		int size;
+	};
+
+	void allocate(int slotSize)
+	{
+		m_slotSize = slotSize;
+		//Keep every header 8-byte aligned
+		m_slotStride = (sizeof(SlotHeader) + slotSize + 7) & ~size_t(7);
+		m_slab.malloc(m_slotStride * m_fifo.getTotalSize());
+	}
+
+	char* getSlot(int pos) const
+	{
+		return m_slab + pos * m_slotStride;
+	}
+
+	const SlotHeader* getReadHeader(int i) const
+	{
+		int pos = (i < m_readSize1) ? m_readPos1 + i : m_readPos2 + (i - m_readSize1);
+		return reinterpret_cast<const SlotHeader*>(getSlot(pos));
+	}
+
+	AbstractFifo m_fifo;
+	HeapBlock<char> m_slab;
+	int m_slotSize;
+	size_t m_slotStride;
+	std::atomic<int> m_numOverruns;
+
+	int m_readPos1, m_readSize1, m_readPos2, m_readSize2;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PooledEventQueue);
+};
+
 //NOTE: Events are sent as midimessages while spikes as spike objects due to the difference on how they are passed to the record node.
 //Once the probe system is implemented, this will be normalized
-typedef EventQueue<MidiMessage> EventMsgQueue;
-typedef EventQueue<SpikeEvent> SpikeMsgQueue;
+typedef PooledEventQueue<MidiMessage> EventMsgQueue;
+typedef PooledEventQueue<SpikeEvent> SpikeMsgQueue;
 typedef ReferenceCountedObjectPtr<AsyncEventMessage<MidiMessage>> EventMessagePtr;
 typedef ReferenceCountedObjectPtr<AsyncEventMessage<SpikeEvent>> SpikeMessagePtr;
 
@@ -0,0 +1,305 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "FileChecksum.h"
+
+//The SSE4.2 version is built on every x86 target and picked at run time, so builds for
+//baseline x86-64 still use the instruction on the machines that have it
+#if JUCE_INTEL && (JUCE_MSVC || JUCE_GCC || JUCE_CLANG)
+ #include <nmmintrin.h>
+ #define OE_CRC_SSE42 1
+ #if JUCE_MSVC || defined(__SSE4_2__)
+  #define OE_CRC_SSE42_TARGET
+ #else
+  #define OE_CRC_SSE42_TARGET __attribute__((target("sse4.2")))
+ #endif
+#elif defined(__ARM_FEATURE_CRC32)
+ #include <arm_acle.h>
+ #define OE_CRC_ARM 1
+#endif
+
+//Buffer of the files read to seed a checksum
+#define CHECKSUM_READ_BUFFER_SIZE (1 << 20)
+//Reflected CRC-32C polynomial
+#define CRC32C_POLY 0x82F63B78u
+
+namespace
+{
+#if !OE_CRC_ARM
+	/** Tables for slicing by 8 bytes, built on first use */
+	struct CrcTables
+	{
+		CrcTables()
+		{
+			for (uint32 i = 0; i < 256; i++)
+			{
+				uint32 crc = i;
+				for (int j = 0; j < 8; j++)
+					crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1)));
+				table[0][i] = crc;
+			}
+			for (int t = 1; t < 8; t++)
+				for (int i = 0; i < 256; i++)
+					table[t][i] = (table[t - 1][i] >> 8) ^ table[0][table[t - 1][i] & 0xff];
+		}
+
+		uint32 table[8][256];
+	};
+
+	const CrcTables& getTables()
+	{
+		static const CrcTables tables;
+		return tables;
+	}
+#endif
+
+#if OE_CRC_SSE42
+	OE_CRC_SSE42_TARGET uint32 updateCrcSse42(uint32 crc, const uint8* data, size_t numBytes)
+	{
+		for (; numBytes > 0 && (reinterpret_cast<pointer_sized_uint>(data) & 7) != 0; numBytes--)
+			crc = _mm_crc32_u8(crc, *data++);
+ #if JUCE_64BIT
+		uint64 crc64 = crc;
+		for (; numBytes >= 8; numBytes -= 8, data += 8)
+			crc64 = _mm_crc32_u64(crc64, *reinterpret_cast<const uint64*>(data));
+		crc = uint32(crc64);
+ #else
+		for (; numBytes >= 4; numBytes -= 4, data += 4)
+			crc = _mm_crc32_u32(crc, *reinterpret_cast<const uint32*>(data));
+ #endif
+		for (; numBytes > 0; numBytes--)
+			crc = _mm_crc32_u8(crc, *data++);
+		return crc;
+	}
+
+	bool hasSse42()
+	{
+ #ifdef __SSE4_2__
+		return true;
+ #else
+		static const bool available = SystemStats::hasSSE42();
+		return available;
+ #endif
+	}
+#endif
+
+	/** Updates a CRC-32C, before its final inversion, with numBytes bytes */
+	uint32 updateCrc(uint32 crc, const uint8* data, size_t numBytes)
+	{
+#if OE_CRC_ARM
+		for (; numBytes > 0 && (reinterpret_cast<pointer_sized_uint>(data) & 7) != 0; numBytes--)
+			crc = __crc32cb(crc, *data++);
+		for (; numBytes >= 8; numBytes -= 8, data += 8)
+			crc = __crc32cd(crc, *reinterpret_cast<const uint64*>(data));
+		for (; numBytes > 0; numBytes--)
+			crc = __crc32cb(crc, *data++);
+#else
+ #if OE_CRC_SSE42
+		if (hasSse42())
+			return updateCrcSse42(crc, data, numBytes);
+ #endif
+		const CrcTables& tables = getTables();
+		const uint32 (*t)[256] = tables.table;
+		for (; numBytes >= 8; numBytes -= 8, data += 8)
+		{
+			//Little-endian words, as the instructions read them
+			uint32 lo = crc ^ (uint32(data[0]) | uint32(data[1]) << 8 | uint32(data[2]) << 16 | uint32(data[3]) << 24);
+			uint32 hi = uint32(data[4]) | uint32(data[5]) << 8 | uint32(data[6]) << 16 | uint32(data[7]) << 24;
+			crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24]
+				^ t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+		}
+		for (; numBytes > 0; numBytes--)
+			crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xff];
+#endif
+		return crc;
+	}
+
+	uint32 gf2MatrixTimes(const uint32* matrix, uint32 vector)
+	{
+		uint32 sum = 0;
+		for (; vector != 0; vector >>= 1, matrix++)
+		{
+			if (vector & 1)
+				sum ^= *matrix;
+		}
+		return sum;
+	}
+
+	void gf2MatrixSquare(uint32* square, const uint32* matrix)
+	{
+		for (int n = 0; n < 32; n++)
+			square[n] = gf2MatrixTimes(matrix, matrix[n]);
+	}
+}
+
+FileChecksum::FileChecksum()
+	: m_crc(0), m_numBytes(0)
+{
+}
+
+void FileChecksum::reset()
+{
+	m_crc = 0;
+	m_numBytes = 0;
+}
+
+void FileChecksum::update(const void* data, size_t numBytes)
+{
+	if (numBytes == 0)
+		return;
+	m_crc = ~updateCrc(~m_crc, static_cast<const uint8*>(data), numBytes);
+	m_numBytes += numBytes;
+}
+
+void FileChecksum::append(const FileChecksum& other)
+{
+	m_crc = combine(m_crc, other.m_crc, other.m_numBytes);
+	m_numBytes += other.m_numBytes;
+}
+
+bool FileChecksum::updateFromFile(const File& file, int64 numBytes)
+{
+	FileInputStream stream(file);
+	if (stream.failedToOpen())
+		return false;
+	if (numBytes < 0)
+		numBytes = stream.getTotalLength();
+
+	HeapBlock<char> buffer(CHECKSUM_READ_BUFFER_SIZE);
+	while (numBytes > 0)
+	{
+		int numRead = stream.read(buffer, int(jmin(numBytes, int64(CHECKSUM_READ_BUFFER_SIZE))));
+		if (numRead <= 0)
+			return false;
+		update(buffer, numRead);
+		numBytes -= numRead;
+	}
+	return true;
+}
+
+uint32 FileChecksum::getValue() const
+{
+	return m_crc;
+}
+
+int64 FileChecksum::getNumBytes() const
+{
+	return m_numBytes;
+}
+
+String FileChecksum::toString() const
+{
+	return String::toHexString(int(m_crc)).paddedLeft('0', 8);
+}
+
+uint32 FileChecksum::compute(const void* data, size_t numBytes)
+{
+	return ~updateCrc(~0u, static_cast<const uint8*>(data), numBytes);
+}
+
+uint32 FileChecksum::combine(uint32 crcA, uint32 crcB, int64 lengthB)
+{
+	//Appending lengthB zero bytes to A is a linear operator, applied by repeated squaring as in zlib
+	if (lengthB <= 0)
+		return crcA;
+
+	uint32 even[32];
+	uint32 odd[32];
+	odd[0] = CRC32C_POLY;
+	uint32 row = 1;
+	for (int n = 1; n < 32; n++)
+	{
+		odd[n] = row;
+		row <<= 1;
+	}
+	//Operators for two and then four zero bits
+	gf2MatrixSquare(even, odd);
+	gf2MatrixSquare(odd, even);
+
+	do
+	{
+		gf2MatrixSquare(even, odd);
+		if (lengthB & 1)
+			crcA = gf2MatrixTimes(even, crcA);
+		lengthB >>= 1;
+		if (lengthB == 0)
+			break;
+		gf2MatrixSquare(odd, even);
+		if (lengthB & 1)
+			crcA = gf2MatrixTimes(odd, crcA);
+		lengthB >>= 1;
+	} while (lengthB != 0);
+
+	return crcA ^ crcB;
+}
+
+ChecksumManifest::ChecksumManifest(const File& folder)
+	: m_folder(folder)
+{
+}
+
+void ChecksumManifest::addFile(const File& file, const FileChecksum& checksum)
+{
+	DynamicObject::Ptr entry = new DynamicObject();
+	//Forward slashes whatever the system, like the folder names in structure.oebin
+	entry->setProperty("path", file.getRelativePathFrom(m_folder).replaceCharacter('\\', '/'));
+	entry->setProperty("bytes", checksum.getNumBytes());
+	entry->setProperty("crc32c", checksum.toString());
+
+	const ScopedLock sl(m_lock);
+	m_files.add(var(entry));
+	m_paths.add(file);
+}
+
+void ChecksumManifest::addFileContents(const File& file)
+{
+	FileChecksum checksum;
+	if (checksum.updateFromFile(file))
+		addFile(file, checksum);
+}
+
+bool ChecksumManifest::writeToFile(const File& file) const
+{
+	DynamicObject::Ptr json = new DynamicObject();
+	json->setProperty("algorithm", "crc32c");
+	{
+		const ScopedLock sl(m_lock);
+		json->setProperty("files", m_files);
+	}
+
+	file.deleteFile();
+	FileOutputStream stream(file);
+	if (stream.failedToOpen())
+	{
+		std::cerr << "Error creating checksum file " << file.getFullPathName() << std::endl;
+		return false;
+	}
+	json->writeAsJSON(stream, 2, false);
+	return true;
+}
+
+Array<File> ChecksumManifest::getFiles() const
+{
+	const ScopedLock sl(m_lock);
+	return m_paths;
+}
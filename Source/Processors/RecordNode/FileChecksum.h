@@ -0,0 +1,98 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef FILECHECKSUM_H_INCLUDED
+#define FILECHECKSUM_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../PluginManager/OpenEphysPlugin.h"
+
+/**
+	CRC-32C (Castagnoli) of a file, computed from the bytes as they are written, so recorded
+	files never have to be read back to be archived.
+
+	Uses the SSE4.2 CRC instruction when the CPU has it, checked at run time, or the ARMv8
+	one when built for it, with a table fallback. Checksums can be joined, so a file whose header is rewritten at the end can
+	keep the checksum of its data and add the final header once it is known.
+
+	@see ChecksumManifest
+*/
+class PLUGIN_API FileChecksum
+{
+public:
+	FileChecksum();
+
+	void reset();
+	void update(const void* data, size_t numBytes);
+	/** Adds the bytes of another checksum after the ones of this */
+	void append(const FileChecksum& other);
+	/** Reads the first numBytes of a file, or all of it if negative. Only for files written before the
+	checksum could follow them */
+	bool updateFromFile(const File& file, int64 numBytes = -1);
+
+	uint32 getValue() const;
+	int64 getNumBytes() const;
+	/** The value as 8 hexadecimal digits */
+	String toString() const;
+
+	/** CRC-32C of a block of memory */
+	static uint32 compute(const void* data, size_t numBytes);
+	/** Checksum of the bytes of A followed by the lengthB bytes of B, from the checksums of both */
+	static uint32 combine(uint32 crcA, uint32 crcB, int64 lengthB);
+
+private:
+	uint32 m_crc;
+	int64 m_numBytes;
+};
+
+/**
+	List of the files of a recording, with their size and checksum, written as JSON:
+	{"algorithm": "crc32c", "files": [{"path": ..., "bytes": ..., "crc32c": ...}, ...]}
+	with paths relative to the folder of the list. Files can be added from any thread.
+*/
+class PLUGIN_API ChecksumManifest
+{
+public:
+	explicit ChecksumManifest(const File& folder);
+
+	void addFile(const File& file, const FileChecksum& checksum);
+	/** Reads a small file written in one go, such as a settings file, and adds it */
+	void addFileContents(const File& file);
+
+	bool writeToFile(const File& file) const;
+
+	/** The files added so far, in order */
+	Array<File> getFiles() const;
+
+	static String getDefaultFileName() { return "checksums.json"; }
+
+private:
+	const File m_folder;
+	CriticalSection m_lock;
+	Array<var> m_files;
+	Array<File> m_paths;
+
+	JUCE_DECLARE_NON_COPYABLE(ChecksumManifest);
+};
+
+#endif  // FILECHECKSUM_H_INCLUDED
@@ -0,0 +1,172 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "FileMirror.h"
+
+FileMirror::FileMirror() :
+	Thread("File mirror"),
+	m_copying(false),
+	m_bytesPerSecond(0),
+	m_buffer(FILE_MIRROR_BUFFER_SIZE),
+	m_periodStart(0),
+	m_periodBytes(0)
+{
+}
+
+FileMirror::~FileMirror()
+{
+	//A copy can only be interrupted between two buffers
+	stopThread(-1);
+	if (m_jobs.size() > 0)
+		std::cerr << m_jobs.size() << " files were not copied to the mirror, starting with " << m_jobs.getReference(0).source.getFullPathName() << std::endl;
+}
+
+void FileMirror::addFile(const File& source, const File& destination)
+{
+	{
+		const ScopedLock sl(m_lock);
+		for (int i = 0; i < m_jobs.size(); i++)
+		{
+			if (m_jobs.getReference(i).source == source && m_jobs.getReference(i).destination == destination)
+				return;
+		}
+		Job job = { source, destination, 0 };
+		m_jobs.add(job);
+	}
+	if (!isThreadRunning())
+	{
+		startThread(2);
+		return;
+	}
+	notify();
+}
+
+void FileMirror::setBandwidth(int64 bytesPerSecond)
+{
+	m_bytesPerSecond = bytesPerSecond;
+}
+
+int FileMirror::getNumPending() const
+{
+	const ScopedLock sl(m_lock);
+	return m_jobs.size() + (m_copying ? 1 : 0);
+}
+
+void FileMirror::run()
+{
+	while (!threadShouldExit())
+	{
+		Job job;
+		{
+			const ScopedLock sl(m_lock);
+			if (m_jobs.size() == 0)
+			{
+				const ScopedUnlock su(m_lock);
+				wait(-1);
+				continue;
+			}
+			job = m_jobs.remove(0);
+			m_copying = true;
+		}
+
+		bool ok = isUpToDate(job) || copyFile(job);
+		if (!ok && !threadShouldExit())
+		{
+			//Network shares come and go, so try again after the rest of the queue
+			if (++job.attempts < maxAttempts)
+			{
+				std::cerr << "Error copying " << job.source.getFullPathName() << " to " << job.destination.getFullPathName() << ", retrying" << std::endl;
+				wait(retryDelayMs);
+			}
+			else
+			{
+				std::cerr << "Giving up copying " << job.source.getFullPathName() << " to " << job.destination.getFullPathName() << std::endl;
+			}
+		}
+
+		const ScopedLock sl(m_lock);
+		//Put back at the end if it has to be tried again, or at the start if the thread is stopping
+		if (!ok && threadShouldExit())
+			m_jobs.insert(0, job);
+		else if (!ok && job.attempts < maxAttempts)
+			m_jobs.add(job);
+		m_copying = false;
+	}
+}
+
+bool FileMirror::isUpToDate(const Job& job) const
+{
+	return job.destination.existsAsFile()
+		&& job.destination.getSize() == job.source.getSize()
+		&& job.destination.getLastModificationTime() >= job.source.getLastModificationTime();
+}
+
+bool FileMirror::copyFile(const Job& job)
+{
+	ScopedPointer<FileInputStream> input = job.source.createInputStream();
+	if (input == nullptr)
+		return false;
+
+	if (job.destination.getParentDirectory().createDirectory().failed())
+		return false;
+
+	//Only renamed once complete, so a copy cut short never looks like a finished file
+	TemporaryFile temp(job.destination);
+	{
+		FileOutputStream output(temp.getFile(), FILE_MIRROR_BUFFER_SIZE);
+		if (!output.openedOk())
+			return false;
+
+		m_periodStart = Time::getMillisecondCounter();
+		m_periodBytes = 0;
+		while (!input->isExhausted())
+		{
+			if (threadShouldExit())
+				return false;
+
+			int numRead = input->read(m_buffer, FILE_MIRROR_BUFFER_SIZE);
+			if (numRead < 0)
+				return false;
+			if (numRead > 0 && !output.write(m_buffer, numRead))
+				return false;
+			throttle(numRead);
+		}
+		output.flush();
+		if (output.getStatus().failed())
+			return false;
+	}
+	return temp.overwriteTargetFileWithTemporary();
+}
+
+void FileMirror::throttle(int64 numBytes)
+{
+	int64 bytesPerSecond = m_bytesPerSecond.get();
+	if (bytesPerSecond <= 0)
+		return;
+
+	m_periodBytes += numBytes;
+	int64 dueMs = m_periodBytes * 1000 / bytesPerSecond;
+	int64 elapsedMs = Time::getMillisecondCounter() - m_periodStart;
+	if (dueMs > elapsedMs)
+		wait(int(dueMs - elapsedMs));
+}
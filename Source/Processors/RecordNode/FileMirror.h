@@ -0,0 +1,93 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef FILEMIRROR_H_INCLUDED
+#define FILEMIRROR_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+
+//Size of the one buffer the copies go through
+#define FILE_MIRROR_BUFFER_SIZE (1 << 20)
+
+/**
+	Copies finished recording files to a second location, such as a network share, from its own
+	low priority thread, so the recording is archived while it goes on instead of after the session.
+
+	addFile only queues the file names, so it never waits for the copy and can be called from the
+	record thread or any writer thread. Copies go through a single buffer, can be limited to a
+	bandwidth so they don't compete with the recording for the disk, and are written under a
+	temporary name, so the mirror only has complete files. Files already in the mirror with the same
+	size and a newer date are skipped, and failed copies are retried for a while before giving up.
+
+	@see RecordEngine::mirrorFile
+*/
+class FileMirror : private Thread
+{
+public:
+	FileMirror();
+	/** Waits for the file being copied, leaving the ones still queued */
+	~FileMirror();
+
+	/** Queues a copy of source to destination, unless it is already queued */
+	void addFile(const File& source, const File& destination);
+
+	/** Limits the copies to a number of bytes per second, 0 for no limit */
+	void setBandwidth(int64 bytesPerSecond);
+
+	/** Files queued or being copied */
+	int getNumPending() const;
+
+private:
+	void run() override;
+
+	struct Job
+	{
+		File source;
+		File destination;
+		int attempts;
+	};
+
+	bool isUpToDate(const Job& job) const;
+	/** Copies a file through the buffer, returns false if it failed or the thread is stopping */
+	bool copyFile(const Job& job);
+	/** Sleeps as long as needed to keep the bytes copied under the bandwidth */
+	void throttle(int64 numBytes);
+
+	CriticalSection m_lock;
+	Array<Job> m_jobs;
+	bool m_copying;
+	Atomic<int64> m_bytesPerSecond;
+
+	HeapBlock<char> m_buffer;
+	//Start of the current throttling period, and the bytes copied since
+	uint32 m_periodStart;
+	int64 m_periodBytes;
+
+	//Compile-time parameters
+	const int maxAttempts{ 10 };
+	const int retryDelayMs{ 5000 };
+
+	JUCE_DECLARE_NON_COPYABLE(FileMirror);
+};
+
+#endif  // FILEMIRROR_H_INCLUDED
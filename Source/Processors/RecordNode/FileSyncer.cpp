@@ -0,0 +1,172 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "FileSyncer.h"
+
+#if JUCE_WINDOWS
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+juce_ImplementSingleton(FileSyncer);
+
+FileSyncer::FileSyncer() :
+	Thread("File syncer"),
+	m_policy(SYNC_NONE),
+	m_intervalMs(0)
+{
+}
+
+FileSyncer::~FileSyncer()
+{
+	stopThread(-1);
+	syncClosedFiles();
+	clearSingletonInstance();
+}
+
+void FileSyncer::setPolicy(Policy policy, int intervalSeconds)
+{
+	{
+		const ScopedLock sl(m_lock);
+		m_policy = policy;
+		m_intervalMs = jmax(1, intervalSeconds) * 1000;
+	}
+	if (policy != SYNC_NONE && !isThreadRunning())
+		startThread();
+	notify();
+}
+
+FileSyncer::Policy FileSyncer::getPolicy() const
+{
+	const ScopedLock sl(m_lock);
+	return m_policy;
+}
+
+void FileSyncer::addFile(const File& file)
+{
+	const ScopedLock sl(m_lock);
+	m_openFiles.addIfNotAlreadyThere(file);
+}
+
+void FileSyncer::fileClosed(const File& file)
+{
+	const ScopedLock sl(m_lock);
+	m_openFiles.removeFirstMatchingValue(file);
+	if (m_policy == SYNC_NONE)
+		return;
+	m_closedFiles.addIfNotAlreadyThere(file);
+	notify();
+}
+
+void FileSyncer::run()
+{
+	uint32 lastSync = Time::getMillisecondCounter();
+	while (!threadShouldExit())
+	{
+		Array<File> openFiles;
+		int timeout = -1;
+		{
+			const ScopedLock sl(m_lock);
+			if (m_policy == SYNC_PERIODIC)
+			{
+				uint32 elapsed = Time::getMillisecondCounter() - lastSync;
+				if (elapsed >= uint32(m_intervalMs))
+				{
+					openFiles = m_openFiles;
+					lastSync += elapsed;
+					elapsed = 0;
+				}
+				timeout = m_intervalMs - int(elapsed);
+			}
+		}
+
+		syncClosedFiles();
+		//May fail for files still open elsewhere, see the class description
+		for (int i = 0; i < openFiles.size() && !threadShouldExit(); i++)
+			syncFile(openFiles[i]);
+
+		wait(timeout);
+	}
+}
+
+void FileSyncer::syncClosedFiles()
+{
+	Array<File> closedFiles;
+	{
+		const ScopedLock sl(m_lock);
+		closedFiles.swapWith(m_closedFiles);
+	}
+
+	Array<File> folders;
+	for (int i = 0; i < closedFiles.size(); i++)
+	{
+		if (!syncFile(closedFiles[i]))
+			std::cerr << "Error syncing " << closedFiles[i].getFullPathName() << std::endl;
+		folders.addIfNotAlreadyThere(closedFiles[i].getParentDirectory());
+	}
+#if ! JUCE_WINDOWS
+	//So new files can be found after a crash
+	for (int i = 0; i < folders.size(); i++)
+		syncFile(folders[i]);
+#endif
+}
+
+#if JUCE_WINDOWS
+
+bool FileSyncer::syncFile(const File& file)
+{
+	HANDLE h = CreateFileW(file.getFullPathName().toWideCharPointer(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (h == INVALID_HANDLE_VALUE)
+		return false;
+	bool ok = FlushFileBuffers(h) != 0;
+	CloseHandle(h);
+	return ok;
+}
+
+#else
+
+bool FileSyncer::syncFile(const File& file)
+{
+	//A read-only descriptor is enough to flush what any other one wrote
+	int fd = ::open(file.getFullPathName().toRawUTF8(), O_RDONLY);
+	if (fd < 0)
+		return false;
+#if JUCE_MAC
+	//fsync doesn't flush the drive cache on OS X
+	bool ok = fcntl(fd, F_FULLFSYNC) != -1 || fsync(fd) == 0;
+#elif JUCE_LINUX
+	bool ok = fdatasync(fd) == 0;
+#else
+	bool ok = fsync(fd) == 0;
+#endif
+	::close(fd);
+	return ok;
+}
+
+#endif
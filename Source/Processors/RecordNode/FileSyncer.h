@@ -0,0 +1,85 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef FILESYNCER_H_INCLUDED
+#define FILESYNCER_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../PluginManager/OpenEphysPlugin.h"
+
+/**
+	Forces recorded files to the disk from its own thread, following the durability setting of the
+	record engine, so the threads writing the files never wait for a disk flush.
+
+	Writers tell it of every file they open and close. With SYNC_NONE the files are left to the
+	operating system, which writes them back when it sees fit. With SYNC_PERIODIC every open file is
+	synced every interval, bounding what a crash or power loss can take, and files are synced once
+	more when closed. With SYNC_ON_CLOSE files, such as the segments of a continuous file, are only
+	synced once closed.
+
+	Syncs go through a handle of their own, so on Windows, where the streams of the files don't share
+	write access, open files can't be synced and only SYNC_ON_CLOSE has an effect.
+*/
+class PLUGIN_API FileSyncer : private Thread,
+	private DeletedAtShutdown
+{
+public:
+	enum Policy
+	{
+		SYNC_NONE = 0,
+		SYNC_PERIODIC,
+		SYNC_ON_CLOSE
+	};
+
+	FileSyncer();
+	/** Syncs the files closed and not yet synced */
+	~FileSyncer();
+
+	void setPolicy(Policy policy, int intervalSeconds);
+	Policy getPolicy() const;
+
+	/** Starts following a file being written */
+	void addFile(const File& file);
+	/** Stops following a file, and syncs it unless the policy is SYNC_NONE. The file must be closed */
+	void fileClosed(const File& file);
+
+	/** Flushes a file, and the file system metadata needed to read it back, to the disk */
+	static bool syncFile(const File& file);
+
+	juce_DeclareSingleton(FileSyncer, false);
+
+private:
+	void run() override;
+	/** Syncs the files closed since the last call, and the folders holding them */
+	void syncClosedFiles();
+
+	CriticalSection m_lock;
+	Policy m_policy;
+	int m_intervalMs;
+	Array<File> m_openFiles;
+	Array<File> m_closedFiles;
+
+	JUCE_DECLARE_NON_COPYABLE(FileSyncer);
+};
+
+#endif  // FILESYNCER_H_INCLUDED
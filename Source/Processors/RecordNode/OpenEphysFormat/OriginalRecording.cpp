@@ -24,17 +24,22 @@
 #include "OriginalRecording.h"
 #include "../../../AccessClass.h"
 #include "../../../Audio/AudioComponent.h"
+#include "../../DataThreads/SampleConversion.h"
+#include "../FileSyncer.h"
+
+/** Writes to a file, adding the bytes written to its checksum */
+static size_t writeAndChecksum(const void* data, size_t numBytes, FILE* file, FileChecksum& checksum)
+{
+    size_t count = fwrite(data, 1, numBytes, file);
+    checksum.update(data, count);
+    return count;
+}
 
 OriginalRecording::OriginalRecording() : separateFiles(false),
-    recordingNumber(0), experimentNumber(0),  zeroBuffer(1, 50000),
+    recordingNumber(0), experimentNumber(0), mirrorBandwidth(0), syncPolicy(0), syncSeconds(5),
 	eventFile(nullptr), messageFile(nullptr), lastProcId(0), procIndex(0)
 {
-    /*continuousDataIntegerBuffer = new int16[10000];
-    continuousDataFloatBuffer = new float[10000];
-
-    recordMarker = new char[10];*/
-	continuousDataIntegerBuffer.malloc(10000);
-	continuousDataFloatBuffer.malloc(10000);
+    /*recordMarker = new char[10];*/
 	recordMarker.malloc(10);
 
     for (int i = 0; i < 9; i++)
@@ -42,8 +47,6 @@ OriginalRecording::OriginalRecording() : separateFiles(false),
         recordMarker[i] = i;
     }
     recordMarker[9] = 255;
-
-    zeroBuffer.clear();
 }
 
 OriginalRecording::~OriginalRecording()
@@ -57,9 +60,7 @@ OriginalRecording::~OriginalRecording()
     {
         if (spikeFileArray[i] != nullptr) fclose(spikeFileArray[i]);
     }
- /*   delete continuousDataFloatBuffer;
-    delete continuousDataIntegerBuffer;
-    delete recordMarker;*/
+ /*   delete recordMarker;*/
 }
 
 String OriginalRecording::getEngineID() const
@@ -70,12 +71,19 @@ String OriginalRecording::getEngineID() const
 void OriginalRecording::addSpikeElectrode(int index, const SpikeChannel* elec)
 {
     spikeFileArray.add(nullptr);
+    spikeChecksums.add(new FileChecksum());
+    spikeFiles.add(File());
 }
 
 void OriginalRecording::resetChannels()
 {
     fileArray.clear();
+    continuousBuffers.clear();
     spikeFileArray.clear();
+    continuousChecksums.clear();
+    spikeChecksums.clear();
+    continuousFiles.clear();
+    spikeFiles.clear();
     blockIndex.clear();
     processorArray.clear();
     samplesSinceLastTimestamp.clear();
@@ -100,6 +108,10 @@ void OriginalRecording::openFiles(File rootFolder, int experimentNumber, int rec
 	{
 		const DataChannel* ch = getDataChannel(getRealChannel(i));
 		openFile(rootFolder, ch, getRealChannel(i));
+		ContinuousWriteBuffer* buffer = new ContinuousWriteBuffer();
+		buffer->data.malloc(RECORDS_PER_WRITE * RECORD_SIZE);
+		buffer->used = 0;
+		continuousBuffers.add(buffer);
 		blockIndex.add(0);
 		samplesSinceLastTimestamp.add(0);
 	}
@@ -137,10 +149,12 @@ void OriginalRecording::openFile(File rootFolder, const InfoObjectCommon* ch, in
     File f = File(fullPath);
 
     bool fileExists = f.exists();
+    FileChecksum checksum = fileExists ? getExistingChecksum(f) : FileChecksum();
 
     diskWriteLock.enter();
 
     chFile = fopen(fullPath.toUTF8(), "ab");
+    FileSyncer::getInstance()->addFile(f);
 
     if (!fileExists)
     {
@@ -151,7 +165,7 @@ void OriginalRecording::openFile(File rootFolder, const InfoObjectCommon* ch, in
         std::cout << "File ID: " << chFile << ", number of bytes: " << header.getNumBytesAsUTF8() << std::endl;
 
 
-        fwrite(header.toUTF8(), 1, header.getNumBytesAsUTF8(), chFile);
+        writeAndChecksum(header.toUTF8(), header.getNumBytesAsUTF8(), chFile, checksum);
 
         std::cout << "Wrote header." << std::endl;
 
@@ -165,10 +179,16 @@ void OriginalRecording::openFile(File rootFolder, const InfoObjectCommon* ch, in
     }
 
     if (isEvent)
+    {
         eventFile = chFile;
+        eventChecksum = checksum;
+        eventFileName = f;
+    }
     else
     {
         fileArray.add(chFile);
+        continuousChecksums.add(new FileChecksum(checksum));
+        continuousFiles.add(f);
         if (ch->getCurrentNodeID() != lastProcId)
         {
             lastProcId = ch->getCurrentNodeID();
@@ -207,16 +227,20 @@ void OriginalRecording::openSpikeFile(File rootFolder, const SpikeChannel* elec,
     File f = File(fullPath);
 
     bool fileExists = f.exists();
+    FileChecksum checksum = fileExists ? getExistingChecksum(f) : FileChecksum();
 
     diskWriteLock.enter();
 
     spFile = fopen(fullPath.toUTF8(),"ab");
+    FileSyncer::getInstance()->addFile(f);
 
     if (!fileExists)
     {
         String header = generateSpikeHeader(elec);
-        fwrite(header.toUTF8(), 1, header.getNumBytesAsUTF8(), spFile);
+        writeAndChecksum(header.toUTF8(), header.getNumBytesAsUTF8(), spFile, checksum);
     }
+    *spikeChecksums[channelIndex] = checksum;
+    spikeFiles.set(channelIndex, f);
     diskWriteLock.exit();
     spikeFileArray.set(channelIndex,spFile);
 
@@ -241,10 +265,14 @@ void OriginalRecording::openMessageFile(File rootFolder)
     File f = File(fullPath);
 
     //bool fileExists = f.exists();
+    FileChecksum checksum = f.exists() ? getExistingChecksum(f) : FileChecksum();
 
     diskWriteLock.enter();
 
     mFile = fopen(fullPath.toUTF8(),"ab");
+    FileSyncer::getInstance()->addFile(f);
+    messageChecksum = checksum;
+    messageFileName = f;
 
     //If this file needs a header, it goes here
 
@@ -404,10 +432,10 @@ void OriginalRecording::writeMessage(String message, uint16 processorID, uint16
     String timestampText(timestamp);
 
     diskWriteLock.enter();
-    fwrite(timestampText.toUTF8(),1,timestampText.length(),messageFile);
-    fwrite(" ",1,1,messageFile);
-    fwrite(message.toUTF8(),1,msgLength,messageFile);
-    fwrite("\n",1,1,messageFile);
+    writeAndChecksum(timestampText.toUTF8(), timestampText.length(), messageFile, messageChecksum);
+    writeAndChecksum(" ", 1, messageFile, messageChecksum);
+    writeAndChecksum(message.toUTF8(), msgLength, messageFile, messageChecksum);
+    writeAndChecksum("\n", 1, messageFile, messageChecksum);
     diskWriteLock.exit();
 
 }
@@ -437,10 +465,7 @@ void OriginalRecording::writeTTLEvent(int eventIndex, const MidiMessage& event)
 
     diskWriteLock.enter();
 
-    fwrite(&data,					// ptr
-           sizeof(uint8),   							// size of each element
-           16, 		  						// count
-           eventFile);   			// ptr to FILE object
+    writeAndChecksum(&data, 16, eventFile, eventChecksum);
 
     diskWriteLock.exit();
 }
@@ -498,79 +523,77 @@ void OriginalRecording::writeContinuousBuffer(const float* data, int nSamples, i
 	if (fileArray[writeChannel] == nullptr)
         return;
 
-    // scale the data back into the range of int16
-    float scaleFactor =  float(0x7fff) * getDataChannel(getRealChannel(writeChannel))->getBitVolts();
-
-    for (int n = 0; n < nSamples; n++)
+	if (blockIndex[writeChannel] == 0)
     {
-        *(continuousDataFloatBuffer+n) = *(data+n) / scaleFactor;
+		writeTimestampAndSampleCount(writeChannel);
     }
-    AudioDataConverters::convertFloatToInt16BE(continuousDataFloatBuffer, continuousDataIntegerBuffer, nSamples);
 
-	if (blockIndex[writeChannel] == 0)
+    // scale the data back into the range of int16, straight into the write buffer
+    ContinuousWriteBuffer* buffer = continuousBuffers[writeChannel];
+    int16* dest = reinterpret_cast<int16*>(buffer->data + buffer->used);
+    if (data != nullptr)
     {
-		writeTimestampAndSampleCount(fileArray[writeChannel], writeChannel);
+        float scale = 1.0f / getDataChannel(getRealChannel(writeChannel))->getBitVolts();
+        SampleConversion::convertFloatToInt16BE(dest, data, nSamples, scale);
     }
-
-    diskWriteLock.enter();
-
-    size_t count = fwrite(continuousDataIntegerBuffer, // ptr
-                          2,                               // size of each element
-                          nSamples,                        // count
-						  fileArray[writeChannel]); // ptr to FILE object
-
-    //std::cout << channel << " : " << nSamples << " : " << count << std::endl;
-
-    jassert(count == nSamples); // make sure all the data was written
-    (void)count;  // Suppress unused variable warning in release builds
-
-    diskWriteLock.exit();
+    else
+    {
+        zeromem(dest, nSamples * sizeof(int16));
+    }
+    buffer->used += nSamples * sizeof(int16);
 
 	if (blockIndex[writeChannel] + nSamples == BLOCK_LENGTH)
     {
-		writeRecordMarker(fileArray[writeChannel]);
+		writeRecordMarker(writeChannel);
     }
 }
 
-void OriginalRecording::writeTimestampAndSampleCount(FILE* file, int channel)
+void OriginalRecording::writeTimestampAndSampleCount(int channel)
 {
-    diskWriteLock.enter();
-
     uint16 samps = BLOCK_LENGTH;
 
    // int sourceNodeId = getChannel(channel)->sourceNodeId;
 
     int64 ts = getTimestamp(channel) + samplesSinceLastTimestamp[channel];
 
-    fwrite(&ts,                       // ptr
-           8,                               // size of each element
-           1,                               // count
-           file); // ptr to FILE object
-
-    fwrite(&samps,                           // ptr
-           2,                               // size of each element
-           1,                               // count
-           file); // ptr to FILE object
+    ContinuousWriteBuffer* buffer = continuousBuffers[channel];
+    char* dest = buffer->data + buffer->used;
+    memcpy(dest, &ts, 8);
+    memcpy(dest + 8, &samps, 2);
+    memcpy(dest + 10, &recordingNumber, 2);
+    buffer->used += 12;
+}
 
-    fwrite(&recordingNumber,                         // ptr
-           2,                               // size of each element
-           1,                               // count
-           file); // ptr to FILE object
+void OriginalRecording::writeRecordMarker(int channel)
+{
+    // write a 10-byte marker indicating the end of a record
+    ContinuousWriteBuffer* buffer = continuousBuffers[channel];
+    memcpy(buffer->data + buffer->used, recordMarker, 10);
+    buffer->used += 10;
 
-    diskWriteLock.exit();
+    //Records are only ever started in an empty buffer or after a complete one, so a full record always fits
+    if (buffer->used + RECORD_SIZE > RECORDS_PER_WRITE * RECORD_SIZE)
+        flushContinuousBuffer(channel);
 }
 
-void OriginalRecording::writeRecordMarker(FILE* file)
+void OriginalRecording::flushContinuousBuffer(int channel)
 {
-    // write a 10-byte marker indicating the end of a record
+    ContinuousWriteBuffer* buffer = continuousBuffers[channel];
+    if (buffer->used == 0 || fileArray[channel] == nullptr)
+        return;
 
-    diskWriteLock.enter();
-    fwrite(recordMarker,        // ptr
-           1,                   // size of each element
-           10,                  // count
-           file);               // ptr to FILE object
+    size_t count = writeAndChecksum(buffer->data, buffer->used, fileArray[channel], *continuousChecksums[channel]);
 
-    diskWriteLock.exit();
+    jassert(count == buffer->used); // make sure all the data was written
+    (void)count;  // Suppress unused variable warning in release builds
+
+    buffer->used = 0;
+}
+
+bool OriginalRecording::supportsParallelChannelWrites() const
+{
+    //Every continuous channel has its own file and write buffer
+    return true;
 }
 
 void OriginalRecording::closeFiles()
@@ -582,14 +605,14 @@ void OriginalRecording::closeFiles()
             if (blockIndex[i] < BLOCK_LENGTH)
             {
                 // fill out the rest of the current buffer
-                writeContinuousBuffer(zeroBuffer.getReadPointer(0), BLOCK_LENGTH - blockIndex[i], i);
-                diskWriteLock.enter();
+                writeContinuousBuffer(nullptr, BLOCK_LENGTH - blockIndex[i], i);
+                flushContinuousBuffer(i);
                 fclose(fileArray[i]);
-                diskWriteLock.exit();
             }
         }
     }
 	fileArray.clear();
+	continuousBuffers.clear();
 	blockIndex.clear();
 	samplesSinceLastTimestamp.clear();
     for (int i = 0; i < spikeFileArray.size(); i++)
@@ -617,8 +640,77 @@ void OriginalRecording::closeFiles()
         diskWriteLock.exit();
     }
 
-    writeXml();
+    //Data still in the stdio buffers at a periodic sync is only synced here
+    FileSyncer* syncer = FileSyncer::getInstance();
+    for (int i = 0; i < continuousFiles.size(); i++)
+        syncer->fileClosed(continuousFiles[i]);
+    for (int i = 0; i < spikeFiles.size(); i++)
+    {
+        if (spikeFiles[i] != File())
+            syncer->fileClosed(spikeFiles[i]);
+    }
+    syncer->fileClosed(eventFileName);
+    syncer->fileClosed(messageFileName);
+
+    File xmlFile = writeXml();
+    writeChecksums(xmlFile);
+    continuousChecksums.clear();
+    continuousFiles.clear();
+}
 
+FileChecksum OriginalRecording::getExistingChecksum(const File& file)
+{
+    std::map<String, FileChecksum>::const_iterator known = knownChecksums.find(file.getFullPathName());
+    if (known != knownChecksums.end() && known->second.getNumBytes() == file.getSize())
+        return known->second;
+
+    //Only when the file was written by an earlier acquisition
+    FileChecksum checksum;
+    checksum.updateFromFile(file);
+    return checksum;
+}
+
+void OriginalRecording::writeChecksums(const File& xmlFile)
+{
+    File folder(recordPath);
+    ChecksumManifest manifest(folder);
+    Array<File> files;
+    Array<const FileChecksum*> checksums;
+    for (int i = 0; i < continuousFiles.size(); i++)
+    {
+        files.add(continuousFiles[i]);
+        checksums.add(continuousChecksums[i]);
+    }
+    for (int i = 0; i < spikeFiles.size(); i++)
+    {
+        files.add(spikeFiles[i]);
+        checksums.add(spikeChecksums[i]);
+    }
+    files.add(eventFileName);
+    checksums.add(&eventChecksum);
+    files.add(messageFileName);
+    checksums.add(&messageChecksum);
+
+    for (int i = 0; i < files.size(); i++)
+    {
+        if (files[i] == File())
+            continue;
+        manifest.addFile(files[i], *checksums[i]);
+        knownChecksums[files[i].getFullPathName()] = *checksums[i];
+    }
+    manifest.addFileContents(xmlFile);
+
+    String name = "checksums";
+    if (experimentNumber > 1)
+        name += "_" + String(experimentNumber);
+    File manifestFile(recordPath + name + ".json");
+    manifest.writeToFile(manifestFile);
+
+    files = manifest.getFiles();
+    files.add(manifestFile);
+    for (int i = 0; i < files.size(); i++)
+        mirrorFile(files[i], folder);
+    mirrorSettingsFiles(folder);
 }
 
 // void OriginalRecording::updateTimeStamp(int64 timestamp)
@@ -658,14 +750,23 @@ void OriginalRecording::writeSpike(int electrodeIndex, const SpikeEvent* spike)
 
 	int ptrIdx = 0;
 	uint16* dataIntPtr = reinterpret_cast<uint16*>(spikeBuffer.getData() + 42);
-	const float* spikeDataPtr = spike->getDataPointer();
-	for (int i = 0; i < numChannels; i++)
+	if (channel->hasInt16Waveforms())
 	{
-		const float bitVolts = channel->getChannelBitVolts(i);
-		for (int j = 0; j < chanSamples; j++)
+		const int16* spikeIntPtr = spike->getInt16DataPointer();
+		for (; ptrIdx < totalSamples; ptrIdx++)
+			*(dataIntPtr + ptrIdx) = uint16(*(spikeIntPtr + ptrIdx) + 32768);
+	}
+	else
+	{
+		const float* spikeDataPtr = spike->getDataPointer();
+		for (int i = 0; i < numChannels; i++)
 		{
-			*(dataIntPtr + ptrIdx) = uint16(*(spikeDataPtr + ptrIdx) / bitVolts + 32768);
-			ptrIdx++;
+			const float bitVolts = channel->getChannelBitVolts(i);
+			for (int j = 0; j < chanSamples; j++)
+			{
+				*(dataIntPtr + ptrIdx) = uint16(*(spikeDataPtr + ptrIdx) / bitVolts + 32768);
+				ptrIdx++;
+			}
 		}
 	}
 	ptrIdx = totalSamples * 2 + 42;
@@ -683,17 +784,14 @@ void OriginalRecording::writeSpike(int electrodeIndex, const SpikeEvent* spike)
 
     diskWriteLock.enter();
 
-    fwrite(spikeBuffer, 1, totalBytes, spikeFileArray[electrodeIndex]);
+    writeAndChecksum(spikeBuffer, totalBytes, spikeFileArray[electrodeIndex], *spikeChecksums[electrodeIndex]);
 
-    fwrite(&recordingNumber,                         // ptr
-           2,                               // size of each element
-           1,                               // count
-           spikeFileArray[electrodeIndex]); // ptr to FILE object
+    writeAndChecksum(&recordingNumber, 2, spikeFileArray[electrodeIndex], *spikeChecksums[electrodeIndex]);
 
     diskWriteLock.exit();
 }
 
-void OriginalRecording::writeXml()
+File OriginalRecording::writeXml()
 {
     String name = recordPath + "Continuous_Data";
     if (experimentNumber > 1)
@@ -735,6 +833,7 @@ void OriginalRecording::writeXml()
     }
     xml->addChildElement(rec);
     xml->writeToFile(file,String::empty);
+    return file;
 }
 
 void OriginalRecording::setParameter(EngineParameter& parameter)
@@ -742,6 +841,12 @@ void OriginalRecording::setParameter(EngineParameter& parameter)
     boolParameter(0, separateFiles);
     boolParameter(1, renameFiles);
     strParameter(2, renamedPrefix);
+    strParameter(3, mirrorFolder);
+    intParameter(4, mirrorBandwidth);
+    setMirror(mirrorFolder, mirrorBandwidth);
+    multiParameter(5, syncPolicy);
+    intParameter(6, syncSeconds);
+    FileSyncer::getInstance()->setPolicy(FileSyncer::Policy(syncPolicy), syncSeconds);
 }
 
 RecordEngineManager* OriginalRecording::getEngineManager()
@@ -754,5 +859,13 @@ RecordEngineManager* OriginalRecording::getEngineManager()
     man->addParameter(param);
     param = new EngineParameter(EngineParameter::STR, 2, "Renamed files prefix", "CH");
     man->addParameter(param);
+    param = new EngineParameter(EngineParameter::STR, 3, "Mirror folder (empty for none)", "");
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::INT, 4, "Mirror bandwidth (MB/s, 0 for no limit)", 0, 0, 1 << 16);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::MULTI, 5, "Disk sync|None|Periodic|On close", 0);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::INT, 6, "Periodic sync interval (s)", 5, 1, 3600);
+    man->addParameter(param);
     return man;
 }
@@ -26,11 +26,16 @@
 #include "../../../../JuceLibraryCode/JuceHeader.h"
 
 #include "../RecordEngine.h"
+#include "../FileChecksum.h"
 #include <stdio.h>
 #include <map>
 
 #define HEADER_SIZE 1024
 #define BLOCK_LENGTH 1024
+//timestamp, sample count and recording number, samples, record marker
+#define RECORD_SIZE (8 + 2 + 2 + BLOCK_LENGTH*2 + 10)
+//Records of a continuous channel coalesced into each write
+#define RECORDS_PER_WRITE 32
 
 #define VERSION 0.4
 
@@ -54,6 +59,7 @@ public:
 	void addSpikeElectrode(int index, const SpikeChannel* elec) override;
 	void writeSpike(int electrodeIndex, const SpikeEvent* spike) override;
 	void writeTimestampSyncText(uint16 sourceID, uint16 sourceIdx, int64 timestamp, float sourceSampleRate, String text) override;
+	bool supportsParallelChannelWrites() const override;
 
     static RecordEngineManager* getEngineManager();
 
@@ -62,8 +68,9 @@ private:
     void openFile(File rootFolder, const InfoObjectCommon* ch, int channelIndex);
     String generateHeader(const InfoObjectCommon* ch);
     void writeContinuousBuffer(const float* data, int nSamples, int channel);
-    void writeTimestampAndSampleCount(FILE* file, int channel);
-    void writeRecordMarker(FILE* file);
+    void writeTimestampAndSampleCount(int channel);
+    void writeRecordMarker(int channel);
+    void flushContinuousBuffer(int channel);
 
     void openSpikeFile(File rootFolder, const SpikeChannel* elec, int channelIndex);
     String generateSpikeHeader(const SpikeChannel* elec);
@@ -72,7 +79,14 @@ private:
     void writeTTLEvent(int eventIndex, const MidiMessage& event);
     void writeMessage(String message, uint16 processorID, uint16 channel, int64 timestamp);
 
-    void writeXml();
+    /** Writes the .openephys settings file and returns it */
+    File writeXml();
+
+    /** Checksum of what a file holds before it is appended to, from the last recording when possible */
+    FileChecksum getExistingChecksum(const File& file);
+    /** Writes checksums.json with every file of the experiment, and remembers their checksums for the next recording.
+    The files are then mirrored, if a mirror folder is set */
+    void writeChecksums(const File& xmlFile);
 
     bool separateFiles;
     Array<int> blockIndex;
@@ -83,31 +97,47 @@ private:
     bool renameFiles;
     String renamedPrefix;
 
-    /** Holds data that has been converted from float to int16 before
-        saving.
-    */
-	HeapBlock<int16> continuousDataIntegerBuffer;
-    //int16* continuousDataIntegerBuffer;
-
-    /** Holds data that has been converted from float to int16 before
-        saving.
-    */
-	HeapBlock<float> continuousDataFloatBuffer;
-    //float* continuousDataFloatBuffer;
+    /** Finished files are copied there, if set. As files are appended to by every recording,
+    they are copied whole again after each one */
+    String mirrorFolder;
+    int mirrorBandwidth;
+    /** FileSyncer::Policy, and its interval for periodic syncs */
+    int syncPolicy;
+    int syncSeconds;
 
     /** Used to indicate the end of each record */
 	HeapBlock<uint8> recordMarker;
     //char* recordMarker;
 
-    AudioSampleBuffer zeroBuffer;
+    /** Records of one continuous channel waiting to be written. Each channel only
+        touches its own buffer and file, so continuous writes need no lock. */
+    struct ContinuousWriteBuffer
+    {
+        HeapBlock<char> data;
+        size_t used;
+    };
+    OwnedArray<ContinuousWriteBuffer> continuousBuffers;
 
     FILE* eventFile;
     FILE* messageFile;
     Array<FILE*> fileArray;
     Array<FILE*> spikeFileArray;
 
+    /** Serializes event, spike and message file writes */
     CriticalSection diskWriteLock;
 
+    /** Checksums of the whole files, continuous ones updated by their own writers, the rest under diskWriteLock */
+    OwnedArray<FileChecksum> continuousChecksums;
+    OwnedArray<FileChecksum> spikeChecksums;
+    FileChecksum eventChecksum;
+    FileChecksum messageChecksum;
+    Array<File> continuousFiles;
+    Array<File> spikeFiles;
+    File eventFileName;
+    File messageFileName;
+    /** As the files are appended to by every recording of an experiment */
+    std::map<String, FileChecksum> knownChecksums;
+
     struct ChannelInfo
     {
         String name;
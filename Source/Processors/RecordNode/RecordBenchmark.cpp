@@ -0,0 +1,489 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "RecordBenchmark.h"
+#include "RecordNode.h"
+#include "RecordEngine.h"
+#include "RecordThread.h"
+#include "DataQueue.h"
+#include "../ProcessorManager/BenchmarkHelpers.h"
+#include "../ProcessorGraph/ProcessorGraph.h"
+#include "../../AccessClass.h"
+
+//Node IDs of the synthetic sources. Kept away from the ids the graph assigns to real processors
+#define BENCHMARK_NODE_ID 900
+//Distinct blocks of synthetic data cycled by the producer
+#define BENCHMARK_NUM_BLOCKS 8
+
+RecordBenchmarkSettings::RecordBenchmarkSettings() :
+	engineID("RAWBINARY"),
+	numChannels(64),
+	numProcessors(1),
+	sampleRate(30000.0f),
+	blockSize(1024),
+	seconds(10.0),
+	eventRate(10.0f),
+	spikeRate(100.0f),
+	numElectrodes(16),
+	numWriterThreads(1),
+	maxLatencyMs(RECORD_THREAD_MAX_LATENCY_MS),
+	realtime(true),
+	keepFiles(false),
+	outputDirectory(File::getSpecialLocation(File::tempDirectory).getChildFile("open-ephys-benchmark"))
+{
+}
+
+void RecordBenchmarkSettings::parse(const StringArray& options)
+{
+	for (int i = 0; i < options.size(); ++i)
+	{
+		String key = options[i].upToFirstOccurrenceOf("=", false, false).toLowerCase();
+		String value = options[i].fromFirstOccurrenceOf("=", false, false);
+
+		if (key == "engine")
+			engineID = value.toUpperCase();
+		else if (key == "channels")
+			numChannels = jmax(1, value.getIntValue());
+		else if (key == "processors")
+			numProcessors = jmax(1, value.getIntValue());
+		else if (key == "rate")
+			sampleRate = jmax(1.0f, value.getFloatValue());
+		else if (key == "block")
+			blockSize = jmax(1, value.getIntValue());
+		else if (key == "seconds")
+			seconds = jmax(0.1, value.getDoubleValue());
+		else if (key == "events")
+			eventRate = jmax(0.0f, value.getFloatValue());
+		else if (key == "spikes")
+			spikeRate = jmax(0.0f, value.getFloatValue());
+		else if (key == "electrodes")
+			numElectrodes = jmax(0, value.getIntValue());
+		else if (key == "threads")
+			numWriterThreads = jmax(1, value.getIntValue());
+		else if (key == "latency")
+			maxLatencyMs = jmax(1, value.getIntValue());
+		else if (key == "realtime")
+			realtime = value.getIntValue() != 0;
+		else if (key == "keep")
+			keepFiles = value.getIntValue() != 0;
+		else if (key == "dir")
+			outputDirectory = File::getCurrentWorkingDirectory().getChildFile(value);
+		else if (key.startsWith("param."))
+			engineParameters.set(key.fromFirstOccurrenceOf("param.", false, false), value);
+		else
+			std::cerr << "Unknown record benchmark option " << options[i] << std::endl;
+	}
+	numProcessors = jmin(numProcessors, numChannels);
+}
+
+RecordBenchmark::RecordBenchmark(const RecordBenchmarkSettings& settings) :
+	m_settings(settings),
+	m_recordNode(nullptr),
+	m_timestamp(0),
+	m_eventAccumulator(0),
+	m_spikeAccumulator(0),
+	m_nextElectrode(0),
+	m_samplesWritten(0),
+	m_eventsWritten(0),
+	m_spikesWritten(0),
+	m_elapsedSeconds(0),
+	m_drainSeconds(0),
+	m_bytesOnDisk(0),
+	m_samplesDropped(0),
+	m_eventOverruns(0),
+	m_spikeOverruns(0)
+{
+}
+
+RecordBenchmark::~RecordBenchmark()
+{
+	tearDown();
+}
+
+bool RecordBenchmark::setUp()
+{
+	m_recordNode = AccessClass::getProcessorGraph()->getRecordNode();
+	if (m_recordNode == nullptr || m_recordNode->isRecording)
+	{
+		std::cerr << "Record benchmark: the record node is not available" << std::endl;
+		return false;
+	}
+
+	for (int i = 0; i < RecordEngineManager::getNumOfBuiltInEngines(); ++i)
+	{
+		ScopedPointer<RecordEngineManager> manager = RecordEngineManager::createBuiltInEngineManager(i);
+		if (manager->getID() == m_settings.engineID)
+		{
+			m_manager = manager.release();
+			break;
+		}
+	}
+	if (m_manager == nullptr)
+	{
+		std::cerr << "Record benchmark: unknown built-in record engine " << m_settings.engineID << std::endl;
+		return false;
+	}
+
+	StringArray parameterIds = m_settings.engineParameters.getAllKeys();
+	for (int i = 0; i < m_manager->getNumParameters(); ++i)
+	{
+		EngineParameter& param = m_manager->getParameter(i);
+		if (!parameterIds.contains(String(param.id)))
+			continue;
+		String value = m_settings.engineParameters[String(param.id)];
+		switch (param.type)
+		{
+		case EngineParameter::BOOL:
+			param.boolParam.value = value.getIntValue() != 0 || value.equalsIgnoreCase("true");
+			break;
+		case EngineParameter::INT:
+			param.intParam.value = value.getIntValue();
+			break;
+		case EngineParameter::FLOAT:
+			param.floatParam.value = value.getFloatValue();
+			break;
+		case EngineParameter::MULTI:
+			param.multiParam.value = value.getIntValue();
+			break;
+		default:
+			param.strParam.value = value;
+			break;
+		}
+	}
+
+	RecordEngine* engine = m_manager->instantiateEngine();
+	if (engine == nullptr)
+		return false;
+	engine->registerManager(m_manager);
+	m_engines.add(engine);
+
+	//Register the synthetic channels the same way the processor graph does, so the engine
+	//reads their info objects from the record node as in a real acquisition
+	m_recordNode->resetConnections();
+	engine->resetChannels();
+
+	Array<int> channelMap;
+	Array<int> chanProcessor;
+	Array<int> chanOrder;
+	OwnedArray<RecordProcessorInfo> procInfo;
+	int channel = 0;
+	for (int p = 0; p < m_settings.numProcessors; ++p)
+	{
+		int numChans = m_settings.numChannels / m_settings.numProcessors
+			+ (p < m_settings.numChannels % m_settings.numProcessors ? 1 : 0);
+		BenchmarkSource* source = new BenchmarkSource(BENCHMARK_NODE_ID + p, numChans, m_settings.sampleRate);
+		m_sources.add(source);
+		if (p == 0)
+		{
+			if (m_settings.eventRate > 0)
+				source->addTTLChannel();
+			if (m_settings.spikeRate > 0)
+				source->addElectrodes(jmin(m_settings.numElectrodes, numChans));
+		}
+
+		m_recordNode->registerProcessor(source);
+		engine->registerProcessor(source);
+
+		RecordProcessorInfo* info = new RecordProcessorInfo();
+		info->processorId = source->getNodeId();
+		for (int ch = 0; ch < numChans; ++ch)
+		{
+			m_recordNode->addInputChannel(source, ch);
+			engine->addDataChannel(channel, m_recordNode->getDataChannel(channel));
+			channelMap.add(channel);
+			chanProcessor.add(p);
+			chanOrder.add(ch);
+			info->recordedChannels.add(channel);
+			channel++;
+		}
+		procInfo.add(info);
+		m_recordNode->addInputChannel(source, AudioProcessorGraph::midiChannelIndex);
+
+		if (source->getTotalSpikeChannels() > 0)
+		{
+			m_recordNode->registerSpikeSource(source);
+			engine->registerSpikeSource(source);
+			for (int i = 0; i < source->getTotalSpikeChannels(); ++i)
+			{
+				int index = m_recordNode->addSpikeElectrode(source->getSpikeChannel(i));
+				engine->addSpikeElectrode(index, m_recordNode->getSpikeChannel(index));
+			}
+		}
+	}
+
+	engine->configureEngine();
+	engine->startAcquisition();
+	engine->setChannelMapping(channelMap, chanProcessor, chanOrder, procInfo);
+
+	size_t eventSlotSize = EVENT_BUFFER_MIN_SLOT_SIZE;
+	if (m_recordNode->getTotalEventChannels() > 0)
+	{
+		const EventChannel* chan = m_recordNode->getEventChannel(0);
+		eventSlotSize = jmax(eventSlotSize, chan->getDataSize() + chan->getTotalEventMetaDataSize() + EVENT_BASE_SIZE);
+		m_eventBuffer.malloc(eventSlotSize);
+	}
+	size_t spikeSlotSize = EVENT_BUFFER_MIN_SLOT_SIZE;
+	for (int i = 0; i < m_recordNode->getTotalSpikeChannels(); ++i)
+	{
+		const SpikeChannel* chan = m_recordNode->getSpikeChannel(i);
+		spikeSlotSize = jmax(spikeSlotSize, chan->getWaveformDataSize() + chan->getTotalEventMetaDataSize() + SPIKE_BASE_SIZE
+			+ chan->getNumChannels()*sizeof(float));
+	}
+
+	m_dataQueue = new DataQueue(WRITE_BLOCK_LENGTH, DATA_BUFFER_NBLOCKS);
+	m_dataQueue->setChannels(chanProcessor);
+	m_channelMap = channelMap;
+	m_eventQueue = new EventMsgQueue(EVENT_BUFFER_NEVENTS, int(eventSlotSize));
+	m_spikeQueue = new SpikeMsgQueue(SPIKE_BUFFER_NSPIKES, int(spikeSlotSize));
+
+	m_rootFolder = m_settings.outputDirectory.getChildFile("benchmark_" + Time::getCurrentTime().formatted("%Y-%m-%d_%H-%M-%S"));
+	Result res = m_rootFolder.createDirectory();
+	if (res.failed())
+	{
+		std::cerr << "Record benchmark: cannot create " << m_rootFolder.getFullPathName() << ": " << res.getErrorMessage() << std::endl;
+		return false;
+	}
+
+	m_recordThread = new RecordThread(m_engines);
+	m_recordThread->setQueuePointers(m_dataQueue, m_eventQueue, m_spikeQueue);
+	m_recordThread->setFileComponents(m_rootFolder, 1, 0);
+	m_recordThread->setChannelMap(channelMap);
+	m_recordThread->setChannelGroups(chanProcessor);
+	m_recordThread->setNumWriterThreads(m_settings.numWriterThreads);
+	m_recordThread->setWakeupParameters(RECORD_THREAD_WAKEUP_SAMPLES, m_settings.maxLatencyMs);
+	m_recordThread->setFirstBlockFlag(false);
+
+	//Sinusoids plus noise, so compressing engines see data closer to a real recording than a constant
+	for (int b = 0; b < BENCHMARK_NUM_BLOCKS; ++b)
+	{
+		AudioSampleBuffer* block = new AudioSampleBuffer(m_settings.numChannels, m_settings.blockSize);
+		for (int ch = 0; ch < m_settings.numChannels; ++ch)
+		{
+			float* dest = block->getWritePointer(ch);
+			double freq = 5.0 + ch % 32;
+			for (int i = 0; i < m_settings.blockSize; ++i)
+			{
+				double t = double(b * m_settings.blockSize + i) / m_settings.sampleRate;
+				dest[i] = float(100.0 * std::sin(2.0 * double_Pi * freq * t)) + (m_random.nextFloat() - 0.5f) * 40.0f;
+			}
+		}
+		m_blocks.add(block);
+	}
+	return true;
+}
+
+void RecordBenchmark::tearDown()
+{
+	if (m_recordThread != nullptr && m_recordThread->isThreadRunning())
+	{
+		m_recordThread->signalThreadShouldExit();
+		m_recordThread->waitForThreadToExit(-1);
+	}
+	m_recordThread = nullptr;
+	m_engines.clear();
+
+	if (m_recordNode != nullptr && m_sources.size() > 0)
+		m_recordNode->resetConnections();
+	m_sources.clear();
+
+	if (!m_settings.keepFiles && m_rootFolder.isDirectory())
+		m_rootFolder.deleteRecursively();
+}
+
+void RecordBenchmark::produceBlock(int block)
+{
+	const AudioSampleBuffer& buffer = *m_blocks[block % m_blocks.size()];
+	const int blockSize = m_settings.blockSize;
+
+	for (int p = 0; p < m_sources.size(); ++p)
+		m_dataQueue->writeGroup(buffer, p, m_channelMap, blockSize, m_timestamp);
+	m_recordThread->notifyDataWritten(blockSize);
+	m_samplesWritten += blockSize;
+
+	//Time the newest sample will wait in the queue if the writer keeps its current pace
+	BufferStats stats = m_dataQueue->getStats();
+	m_fillFraction.add(stats.fillFraction);
+	m_residencyMs.add(1000.0f * stats.fillFraction * stats.capacity / m_settings.sampleRate);
+
+	m_eventAccumulator += double(m_settings.eventRate) * blockSize / m_settings.sampleRate;
+	int numEvents = int(m_eventAccumulator);
+	m_eventAccumulator -= numEvents;
+	if (numEvents > 0 && m_recordNode->getTotalEventChannels() > 0)
+	{
+		const EventChannel* chan = m_recordNode->getEventChannel(0);
+		size_t size = chan->getDataSize() + chan->getTotalEventMetaDataSize() + EVENT_BASE_SIZE;
+		for (int i = 0; i < numEvents; ++i)
+		{
+			int64 ts = m_timestamp + (int64(i) * blockSize) / numEvents;
+			uint16 bit = uint16(m_eventsWritten % 8);
+			uint8 word = (m_eventsWritten / 8) % 2 == 0 ? uint8(1 << bit) : 0;
+			TTLEventPtr event = TTLEvent::createTTLEvent(chan, ts, &word, sizeof(word), bit);
+			if (event == nullptr)
+				break;
+			event->serialize(m_eventBuffer, size);
+			m_eventQueue->addEvent(MidiMessage(m_eventBuffer, int(size)), ts, 0);
+			m_recordThread->notifyEventWritten();
+			m_eventsWritten++;
+		}
+	}
+
+	m_spikeAccumulator += double(m_settings.spikeRate) * blockSize / m_settings.sampleRate;
+	int numSpikes = int(m_spikeAccumulator);
+	m_spikeAccumulator -= numSpikes;
+	int numElectrodes = m_recordNode->getTotalSpikeChannels();
+	if (numSpikes > 0 && numElectrodes > 0)
+	{
+		for (int i = 0; i < numSpikes; ++i)
+		{
+			int electrode = m_nextElectrode;
+			m_nextElectrode = (m_nextElectrode + 1) % numElectrodes;
+			const SpikeChannel* chan = m_recordNode->getSpikeChannel(electrode);
+			int64 ts = m_timestamp + (int64(i) * blockSize) / numSpikes;
+
+			SpikeEvent::SpikeBuffer waveform(chan);
+			Array<float> thresholds;
+			for (int ch = 0; ch < int(chan->getNumChannels()); ++ch)
+			{
+				for (int s = 0; s < int(chan->getTotalSamples()); ++s)
+				{
+					float x = float(s - int(chan->getPrePeakSamples()));
+					waveform.set(ch, s, -80.0f * std::exp(-x * x / 8.0f) + (m_random.nextFloat() - 0.5f) * 10.0f);
+				}
+				thresholds.add(-50.0f);
+			}
+			SpikeEventPtr spike = SpikeEvent::createSpikeEvent(chan, ts, thresholds, waveform, 0);
+			if (spike == nullptr)
+				break;
+			m_spikeQueue->addEvent(*spike, ts, electrode);
+			m_spikesWritten++;
+		}
+	}
+
+	m_timestamp += blockSize;
+}
+
+bool RecordBenchmark::run()
+{
+	if (!setUp())
+	{
+		tearDown();
+		return false;
+	}
+
+	const int numBlocks = jmax(1, roundToInt(m_settings.seconds * m_settings.sampleRate / m_settings.blockSize));
+	const double blockMs = 1000.0 * m_settings.blockSize / m_settings.sampleRate;
+
+	m_recordThread->startThread();
+	double start = Time::getMillisecondCounterHiRes();
+	for (int block = 0; block < numBlocks; ++block)
+	{
+		if (m_settings.realtime)
+		{
+			double wait = start + block * blockMs - Time::getMillisecondCounterHiRes();
+			if (wait >= 1.0)
+				Thread::sleep(int(wait));
+		}
+		else
+		{
+			//Keep half the queue free so the measured rate is the writer's, not the drop rate
+			while (m_dataQueue->getStats().fillFraction > 0.5f)
+				Thread::sleep(1);
+		}
+		produceBlock(block);
+		if (block == 0)
+			m_recordThread->setFirstBlockFlag(true);
+	}
+	double produced = Time::getMillisecondCounterHiRes();
+
+	m_recordThread->signalThreadShouldExit();
+	m_recordThread->waitForThreadToExit(-1);
+	double end = Time::getMillisecondCounterHiRes();
+
+	m_elapsedSeconds = (end - start) / 1000.0;
+	m_drainSeconds = (end - produced) / 1000.0;
+	m_samplesDropped = m_dataQueue->getStats().samplesDropped;
+	m_eventOverruns = m_eventQueue->getNumOverruns();
+	m_spikeOverruns = m_spikeQueue->getNumOverruns();
+
+	m_bytesOnDisk = 0;
+	Array<File> files;
+	m_rootFolder.findChildFiles(files, File::findFiles, true);
+	for (int i = 0; i < files.size(); ++i)
+		m_bytesOnDisk += files[i].getSize();
+
+	tearDown();
+	return true;
+}
+
+static float getPercentile(const Array<float>& sorted, float percentile)
+{
+	if (sorted.size() == 0)
+		return 0;
+	int index = jlimit(0, sorted.size() - 1, roundToInt(percentile / 100.0f * (sorted.size() - 1)));
+	return sorted[index];
+}
+
+void RecordBenchmark::printReport(std::ostream& out) const
+{
+	const double seconds = jmax(m_elapsedSeconds, 1e-9);
+	const double payloadBytes = double(m_samplesWritten) * m_settings.numChannels * sizeof(int16);
+
+	Array<float> residency(m_residencyMs);
+	residency.sort();
+	float meanFill = 0;
+	float maxFill = 0;
+	for (int i = 0; i < m_fillFraction.size(); ++i)
+	{
+		meanFill += m_fillFraction[i];
+		maxFill = jmax(maxFill, m_fillFraction[i]);
+	}
+	if (m_fillFraction.size() > 0)
+		meanFill /= m_fillFraction.size();
+
+	out << "Record benchmark: " << (m_manager != nullptr ? m_manager->getName() : m_settings.engineID) << std::endl;
+	out << "  " << m_settings.numChannels << " channels in " << m_settings.numProcessors << " processors, "
+		<< m_settings.sampleRate << " Hz, " << m_settings.blockSize << " sample blocks, "
+		<< (m_settings.realtime ? "paced" : "unpaced") << ", " << m_settings.numWriterThreads << " writer threads" << std::endl;
+	out << "  Continuous: " << m_samplesWritten << " samples per channel in " << seconds << " s, "
+		<< payloadBytes / seconds / 1e6 << " MB/s, " << (m_samplesWritten / m_settings.sampleRate) / seconds << "x realtime" << std::endl;
+	out << "  On disk: " << m_bytesOnDisk << " bytes (" << (payloadBytes > 0 ? m_bytesOnDisk / payloadBytes : 0) << " of int16 payload)" << std::endl;
+	out << "  Events: " << m_eventsWritten << " queued, " << m_eventOverruns << " dropped. Spikes: "
+		<< m_spikesWritten << " queued, " << m_spikeOverruns << " dropped" << std::endl;
+	out << "  Queue residency (ms): p50 " << getPercentile(residency, 50) << ", p95 " << getPercentile(residency, 95)
+		<< ", p99 " << getPercentile(residency, 99) << ", max " << getPercentile(residency, 100) << std::endl;
+	out << "  Queue fill: mean " << meanFill * 100 << "%, max " << maxFill * 100 << "%, "
+		<< m_samplesDropped << " samples dropped" << std::endl;
+	out << "  Drain after last block: " << m_drainSeconds << " s" << std::endl;
+}
+
+bool RecordBenchmark::runFromCommandLine(const StringArray& options)
+{
+	RecordBenchmarkSettings settings;
+	settings.parse(options);
+
+	RecordBenchmark benchmark(settings);
+	if (!benchmark.run())
+		return false;
+	benchmark.printReport(std::cout);
+	return true;
+}
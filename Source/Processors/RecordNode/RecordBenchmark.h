@@ -0,0 +1,138 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef RECORDBENCHMARK_H_INCLUDED
+#define RECORDBENCHMARK_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "EventQueue.h"
+
+class RecordEngine;
+class RecordEngineManager;
+class RecordThread;
+class DataQueue;
+class RecordNode;
+class BenchmarkSource;
+
+struct RecordBenchmarkSettings
+{
+	RecordBenchmarkSettings();
+
+	/** Reads "key=value" options, e.g. channels=384 rate=30000. Unknown keys are reported and ignored*/
+	void parse(const StringArray& options);
+
+	String engineID;
+	int numChannels;
+	int numProcessors;
+	float sampleRate;
+	int blockSize;
+	double seconds;
+	float eventRate;
+	float spikeRate;
+	int numElectrodes;
+	int numWriterThreads;
+	int maxLatencyMs;
+	bool realtime;
+	bool keepFiles;
+	File outputDirectory;
+
+	/** Values for the engine parameters, keyed by parameter id (param.<id>=value)*/
+	StringPairArray engineParameters;
+};
+
+/**
+
+  Measures the throughput of a record engine without acquisition hardware.
+
+  Synthetic source processors are registered with the RecordNode so engines see regular
+  channel info objects. A producer loop on the calling thread then plays the role of the
+  audio thread, filling a DataQueue and the event and spike queues that a RecordThread
+  drains into the engine.
+
+  When paced (realtime=1) blocks are produced at the configured sample rate and the report
+  shows whether the engine keeps up. Unpaced, the producer fills the queue as fast as the
+  engine empties it, giving the maximum sustained write rate.
+
+  Started from the command line with --benchmark-record [key=value ...]
+
+  @see RecordThread, RecordEngine
+
+*/
+class RecordBenchmark
+{
+public:
+	RecordBenchmark(const RecordBenchmarkSettings& settings);
+	~RecordBenchmark();
+
+	/** Runs the benchmark on the calling thread. Returns false if it could not be set up*/
+	bool run();
+
+	/** Writes the results of the last run*/
+	void printReport(std::ostream& out) const;
+
+	/** Parses the options, runs the benchmark and prints the report to stdout*/
+	static bool runFromCommandLine(const StringArray& options);
+
+private:
+	bool setUp();
+	void tearDown();
+	void produceBlock(int block);
+
+	const RecordBenchmarkSettings m_settings;
+
+	RecordNode* m_recordNode;
+	OwnedArray<BenchmarkSource> m_sources;
+	OwnedArray<AudioSampleBuffer> m_blocks;
+	ScopedPointer<RecordEngineManager> m_manager;
+	OwnedArray<RecordEngine> m_engines;
+	ScopedPointer<RecordThread> m_recordThread;
+	ScopedPointer<DataQueue> m_dataQueue;
+	ScopedPointer<EventMsgQueue> m_eventQueue;
+	ScopedPointer<SpikeMsgQueue> m_spikeQueue;
+	Array<int> m_channelMap;
+	File m_rootFolder;
+
+	int64 m_timestamp;
+	double m_eventAccumulator;
+	double m_spikeAccumulator;
+	int m_nextElectrode;
+	Random m_random;
+	HeapBlock<char> m_eventBuffer;
+
+	//Results
+	Array<float> m_residencyMs;
+	Array<float> m_fillFraction;
+	int64 m_samplesWritten;
+	int m_eventsWritten;
+	int m_spikesWritten;
+	double m_elapsedSeconds;
+	double m_drainSeconds;
+	int64 m_bytesOnDisk;
+	int64 m_samplesDropped;
+	int m_eventOverruns;
+	int m_spikeOverruns;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RecordBenchmark);
+};
+
+#endif  // RECORDBENCHMARK_H_INCLUDED
@@ -23,15 +23,17 @@
 
 #include "RecordEngine.h"
 #include "RecordNode.h"
+#include "FileMirror.h"
 #include "../ProcessorGraph/ProcessorGraph.h"
 #include "../../AccessClass.h"
 
 #include "EngineConfigWindow.h"
 #include "OpenEphysFormat/OriginalRecording.h"
 #include "BinaryFormat/BinaryRecording.h"
+#include "BinaryFormat/CompressedBinaryRecording.h"
 
 RecordEngine::RecordEngine()
-    : manager (nullptr)
+    : manager (nullptr), snippetRecording (false)
 {
 }
 
@@ -51,8 +53,67 @@ void RecordEngine::addSpikeElectrode(int index, const SpikeChannel* chan) {}
 
 void RecordEngine::startChannelBlock (bool lastBlock) {}
 
+void RecordEngine::writeDataBlock (int firstWriteChannel, int numChannels, const float* const* buffers, int size)
+{
+    for (int i = 0; i < numChannels; ++i)
+        writeData (firstWriteChannel + i, getRealChannel (firstWriteChannel + i), buffers[i], size);
+}
+
 void RecordEngine::endChannelBlock (bool lastBlock) {}
 
+bool RecordEngine::supportsParallelChannelWrites() const { return false; }
+
+bool RecordEngine::supportsSnippetRecording() const { return false; }
+
+void RecordEngine::recordingStarted() {}
+
+bool RecordEngine::supportsPreparedFiles() const { return false; }
+
+void RecordEngine::discardFiles() { closeFiles(); }
+
+void RecordEngine::setSnippetRecording (bool snippets)
+{
+    snippetRecording = snippets;
+}
+
+bool RecordEngine::isSnippetRecording() const
+{
+    return snippetRecording;
+}
+
+void RecordEngine::setMirror (const String& folder, int megabytesPerSecond)
+{
+    mirrorFolder = folder.trim();
+    if (mirrorFolder.isNotEmpty() && ! File::isAbsolutePath (mirrorFolder))
+    {
+        std::cerr << "Mirror folder " << mirrorFolder << " is not an absolute path, files won't be mirrored" << std::endl;
+        mirrorFolder = String::empty;
+    }
+    AccessClass::getProcessorGraph()->getRecordNode()->getFileMirror()->setBandwidth (int64 (megabytesPerSecond) << 20);
+}
+
+bool RecordEngine::isMirroring() const
+{
+    return mirrorFolder.isNotEmpty();
+}
+
+void RecordEngine::mirrorFile (const File& file, const File& rootFolder) const
+{
+    if (! isMirroring() || ! file.existsAsFile())
+        return;
+
+    File destination = File (mirrorFolder).getChildFile (rootFolder.getFileName()).getChildFile (file.getRelativePathFrom (rootFolder));
+    AccessClass::getProcessorGraph()->getRecordNode()->getFileMirror()->addFile (file, destination);
+}
+
+void RecordEngine::mirrorSettingsFiles (const File& rootFolder) const
+{
+    Array<File> settings;
+    rootFolder.findChildFiles (settings, File::findFiles, false, "settings*.xml");
+    for (int i = 0; i < settings.size(); i++)
+        mirrorFile (settings[i], rootFolder);
+}
+
 const DataChannel* RecordEngine::getDataChannel (int index) const
 {
     return AccessClass::getProcessorGraph()->getRecordNode()->getDataChannel (index);
@@ -76,7 +137,11 @@ String RecordEngine::generateDateString() const
 void RecordEngine::updateTimestamps (const Array<int64>& ts, int channel)
 {
     if (channel < 0)
-        timestamps = ts;
+    {
+        // copy in place to keep the storage between write blocks
+        timestamps.clearQuick();
+        timestamps.addArray (ts);
+    }
     else
         timestamps.set (channel, ts[channel]);
 }
@@ -145,6 +210,8 @@ void RecordEngine::startAcquisition() {}
 
 void RecordEngine::directoryChanged() {}
 
+void RecordEngine::getMemoryUsage (MemoryUsage&) const {}
+
 void RecordEngine::registerManager (RecordEngineManager* recordManager)
 {
     manager = recordManager;
@@ -246,7 +313,7 @@ void RecordEngineManager::addParameter (EngineParameter* param)
 
 int RecordEngineManager::getNumOfBuiltInEngines()
 {
-    return 2;
+    return 3;
 }
 
 RecordEngineManager* RecordEngineManager::createBuiltInEngineManager (int index)
@@ -257,6 +324,8 @@ RecordEngineManager* RecordEngineManager::createBuiltInEngineManager (int index)
 			return BinaryRecordingEngine::BinaryRecording::getEngineManager();
         case 1:
             return OriginalRecording::getEngineManager();
+        case 2:
+            return BinaryRecordingEngine::CompressedBinaryRecording::getEngineManager();
 
         default:
             return nullptr;
@@ -274,6 +343,8 @@ RecordEngine* RecordEngineManager::instantiateEngine()
 		return new OriginalRecording();
 	else if (id == "RAWBINARY")
 		return new BinaryRecordingEngine::BinaryRecording();
+	else if (id == "COMPRESSEDBINARY")
+		return new BinaryRecordingEngine::CompressedBinaryRecording();
 
     return nullptr;
 }
@@ -67,13 +67,15 @@ public:
         3-startAcquisition
       When recording starts (in the specified order):
         1-directoryChanged (if needed)
-        2-(setChannelMapping)
+        2-(setChannelMapping), (setSnippetRecording)
         3-(updateTimestamps*)
         4-openFiles*
+        5-recordingStarted*
       During recording: (RecordThread loop)
         1-(updateTimestamps*) (can be called in a per-channel basis when the circular buffer wraps)
         2-startChannelBlock*
-        3-writeData* (per channel. Can be called more than once to account for the circular buffer wrap)
+        3-writeDataBlock* (per run of channels of a source, calling writeData per channel by default.
+          Can be called more than once to account for the circular buffer wrap)
         4-endChannelBlock*
         4-writeEvent* (if needed)
         5-writeSpike* (if needed)
@@ -82,6 +84,10 @@ public:
 
       Methods marked with a * are called via the RecordThread thread.
       Methods marked with parenthesis are not overloaded methods
+
+      Engines that support prepared files get openFiles while acquiring, before the recording
+      starts and without its first timestamps, which are only known from recordingStarted on.
+      If that recording never starts, discardFiles is called instead of closeFiles.
     */
 
     /** Called for registering parameters */
@@ -94,6 +100,19 @@ public:
         and do all the necessary cleanups */
     virtual void closeFiles() = 0;
 
+    /** Called once the first block of the recording has arrived and the files are open.
+        getTimestamp returns the first timestamp of every channel from here on */
+    virtual void recordingStarted();
+
+    /** Returns true if openFiles doesn't depend on the timestamps of the recording, so the files
+        can be created while acquiring, ahead of the recording. Those engines must remove what
+        openFiles created in discardFiles. False by default. */
+    virtual bool supportsPreparedFiles() const;
+
+    /** Called instead of closeFiles on files opened ahead of a recording that never started,
+        e.g. because acquisition stopped first. Closes the files by default */
+    virtual void discardFiles();
+
     /** Called by the record thread before it starts writing the channels to disk */
     virtual void startChannelBlock (bool lastBlock);
 
@@ -101,9 +120,26 @@ public:
         care must be taken to only read the specified number of bytes.  */
     virtual void writeData (int writeChannel, int realChannel, const float* buffer, int size) = 0;
 
+    /** Writes the same samples of numChannels consecutive recorded channels, from firstWriteChannel
+        on, which come from the same source and recorded processor. The record thread calls this
+        instead of writeData, so engines can write the channels of a block together. Calls writeData
+        for each channel by default */
+    virtual void writeDataBlock (int firstWriteChannel, int numChannels, const float* const* buffers, int size);
+
     /** Called by the record thread after it has written a channel block */
     virtual void endChannelBlock (bool lastBlock);
 
+    /** Returns true if writeData can be called simultaneously from several threads for channels
+        that belong to different recorded processors (see getProcessorFromChannel). Channels of the
+        same processor are always written in order from a single thread, between the
+        startChannelBlock and endChannelBlock calls. False by default. */
+    virtual bool supportsParallelChannelWrites() const;
+
+    /** Returns true if the engine can record only snippets of the continuous data. In that mode
+        the timestamps passed to writeData jump forward at the start of every snippet, and the
+        samples in between are never written. False by default. */
+    virtual bool supportsSnippetRecording() const;
+
     /** Write a single event to disk.  */
     virtual void writeEvent (int eventChannel, const MidiMessage& event) = 0;
 
@@ -139,6 +175,9 @@ public:
       */
     void setChannelMapping (const Array<int>& channels, const Array<int>& chanProcessor, const Array<int>& chanOrder, OwnedArray<RecordProcessorInfo>& processors);
 
+    /** Called prior to opening files, to tell whether only snippets of the continuous data will be written */
+    void setSnippetRecording (bool snippets);
+
     /** Called after all channels and spike groups have been registered,
         just before acquisition starts */
     virtual void startAcquisition();
@@ -146,6 +185,10 @@ public:
     /** Called when the recording directory changes during an acquisition */
     virtual void directoryChanged();
 
+    /** Adds the bytes held by the major buffers of the engine, such as the blocks waiting
+        to be written. Called from the message thread, see GenericProcessor::getMemoryUsage() */
+    virtual void getMemoryUsage (MemoryUsage& usage) const;
+
     void registerManager (RecordEngineManager* engineManager);
     void configureEngine();
 
@@ -205,6 +248,24 @@ protected:
 	*/
 	const String& getLatestSettingsXml() const;
 
+    /** Returns true if the current recording only writes snippets of the continuous data */
+    bool isSnippetRecording() const;
+
+    /** Sets the folder mirrorFile copies files to, empty to not mirror, and the bandwidth
+        the copies can use in MB/s, 0 for no limit. Usually called from setParameter */
+    void setMirror (const String& folder, int megabytesPerSecond);
+
+    /** Returns true if finished files are copied to a mirror folder */
+    bool isMirroring() const;
+
+    /** Queues a finished file to be copied to the mirror folder, at the same path relative to
+        the parent of rootFolder. The copy is made by a background thread with its own buffer,
+        so this can be called from the record thread or any writer thread */
+    void mirrorFile (const File& file, const File& rootFolder) const;
+
+    /** Mirrors the settings files RecordNode writes in rootFolder */
+    void mirrorSettingsFiles (const File& rootFolder) const;
+
 private:
     Array<int64> timestamps;
     Array<int> channelMap;
@@ -212,7 +273,9 @@ private:
     Array<int> chanOrderMap;
 
     RecordEngineManager* manager;
+    bool snippetRecording;
     OwnedArray<RecordProcessorInfo> recordProcessors;
+    String mirrorFolder;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RecordEngine);
 };
@@ -29,6 +29,8 @@
 #include "RecordEngine.h"
 #include "RecordThread.h"
 #include "DataQueue.h"
+#include "SnippetGate.h"
+#include "FileMirror.h"
 
 #define EVERY_ENGINE for(int eng = 0; eng < engineArray.size(); eng++) engineArray[eng]
 
@@ -42,6 +44,18 @@ RecordNode::RecordNode()
     isRecording = false;
 	shouldRecord = true;
 	setFirstBlock = false;
+	m_preTriggerSeconds = 0;
+	m_preTriggerReady = false;
+	m_preTriggerBuffering = false;
+	m_bufferingBlock = false;
+	m_snippetPreMs = 0;
+	m_snippetPostMs = 0;
+	m_snippetTTLLine = -1;
+	m_snippetSpikes = false;
+	m_recordingSnippets = false;
+	m_recordingPrepared = false;
+	m_preparedSnippets = false;
+	m_preparedNewDirectory = false;
 
     settings.numInputs = 0;
     settings.numOutputs = 0;
@@ -57,9 +71,11 @@ RecordNode::RecordNode()
 
 	m_recordThread = new RecordThread(engineArray);
 	m_dataQueue = new DataQueue(WRITE_BLOCK_LENGTH, DATA_BUFFER_NBLOCKS);
-	m_eventQueue = new EventMsgQueue(EVENT_BUFFER_NEVENTS);
-	m_spikeQueue = new SpikeMsgQueue(SPIKE_BUFFER_NSPIKES);
+	m_eventQueue = new EventMsgQueue(EVENT_BUFFER_NEVENTS, EVENT_BUFFER_MIN_SLOT_SIZE);
+	m_spikeQueue = new SpikeMsgQueue(SPIKE_BUFFER_NSPIKES, EVENT_BUFFER_MIN_SLOT_SIZE);
 	m_recordThread->setQueuePointers(m_dataQueue, m_eventQueue, m_spikeQueue);
+	m_snippetGate = new SnippetGate();
+	m_fileMirror = new FileMirror();
 }
 
 
@@ -262,23 +278,26 @@ void RecordNode::setParameter(int parameterIndex, float newValue)
 
 		// std::cout << "START RECORDING." << std::endl;
 
-		if (newDirectoryNeeded)
-		{
-			createNewDirectory();
-			recordingNumber = 0;
-			experimentNumber = 1;
-			settingsNeeded = true;
-			EVERY_ENGINE->directoryChanged();
-		}
-		else
-		{
-			recordingNumber++; // increment recording number within this directory
-		}
+		RecordedChannels recorded;
+		getRecordedChannels(recorded);
+		std::cout << "Num Recording Processors: " << recorded.procInfo.size() << std::endl;
 
-		if (!rootFolder.exists())
+		bool snippets = isSnippetMode();
+		if (snippets && !enginesRecordSnippets())
 		{
-			rootFolder.createDirectory();
+			CoreServices::sendStatusMessage("The record engine can't record snippets, recording all the data");
+			snippets = false;
 		}
+
+		//Files prepared for other channels, snippets or directory are of no use
+		if (m_recordingPrepared && (newDirectoryNeeded || recorded.channelMap != m_preparedChannelMap || snippets != m_preparedSnippets))
+			discardPreparedRecording();
+		bool prepared = m_recordingPrepared;
+		m_recordingPrepared = false;
+
+		if (!prepared)
+			startRecordThread(recorded, snippets);
+
 		if (settingsNeeded)
 		{
 			String settingsFileName = rootFolder.getFullPathName() + File::separator + "settings" + ((experimentNumber > 1) ? "_" + String(experimentNumber) : String::empty) + ".xml";
@@ -286,57 +305,36 @@ void RecordNode::setParameter(int parameterIndex, float newValue)
 			settingsNeeded = false;
 		}
 
-		m_recordThread->setFileComponents(rootFolder, experimentNumber, recordingNumber);
-
-		channelMap.clear();
-		int totChans = dataChannelArray.size();
-		OwnedArray<RecordProcessorInfo> procInfo;
-		Array<int> chanProcessorMap;
-		Array<int> chanOrderinProc;
-		int lastProcessor = -1;
-		int procIndex = -1;
-		int chanProcOrder = 0;
-		for (int ch = 0; ch < totChans; ++ch)
+		//The queues already hold the pre-trigger data, which the record thread writes first.
+		//Buffering goes on until the audio thread switches to recording, so no samples are missed.
+		//The record thread only reads them after the first block, so it can be running already
+		if (!m_preTriggerReady || recorded.channelMap != channelMap)
+		{
+			stopPreTriggerBuffering();
+			if (m_preTriggerReady)
+				CoreServices::sendStatusMessage("Recorded channels changed, pre-trigger data discarded");
+			setQueueChannels(recorded);
+		}
+		m_preTriggerReady = false;
+		m_dataQueue->resetStats();
+
+		if (snippets)
 		{
-			DataChannel* chan = dataChannelArray[ch];
-			if (chan->getRecordState())
+			Array<int> preSamples, postSamples;
+			for (int group = 0; group < m_groupSampleRates.size(); ++group)
 			{
-				channelMap.add(ch);
-				//This is bassed on the assumption that all channels from the same processor are added contiguously
-				//If this behaviour changes, this check should be most thorough
-				if (chan->getCurrentNodeID() != lastProcessor)
-				{
-					lastProcessor = chan->getCurrentNodeID();
-					RecordProcessorInfo* pi = new RecordProcessorInfo();
-					pi->processorId = chan->getCurrentNodeID();
-					procInfo.add(pi);
-					procIndex++;
-					chanProcOrder = 0;
-				}
-				procInfo.getLast()->recordedChannels.add(channelMap.size() - 1);
-				chanProcessorMap.add(procIndex);
-				chanOrderinProc.add(chanProcOrder);
-				chanProcOrder++;
+				preSamples.add(roundToInt(m_snippetPreMs * m_groupSampleRates[group] / 1000.0f));
+				postSamples.add(roundToInt(m_snippetPostMs * m_groupSampleRates[group] / 1000.0f));
 			}
+			m_snippetGate->setWindows(preSamples, postSamples);
 		}
-		std::cout << "Num Recording Processors: " << procInfo.size() << std::endl;
-		int numRecordedChannels = channelMap.size();
-
-		m_validBlocks.clear();
-		m_validBlocks.insertMultiple(0, false, numRecordedChannels);
-
-		//WARNING: If at some point we record at more that one recordEngine at once, we should change this, as using OwnedArrays only works for the first
-		EVERY_ENGINE->setChannelMapping(channelMap, chanProcessorMap, chanOrderinProc, procInfo);
-		m_recordThread->setChannelMap(channelMap);
-		m_dataQueue->setChannels(numRecordedChannels);
-		m_eventQueue->reset();
-		m_spikeQueue->reset();
-		m_recordThread->setFirstBlockFlag(false);
+		m_recordingSnippets = snippets;
 
+		m_recordThread->setFirstBlockFlag(false);
 		setFirstBlock = false;
-		m_recordThread->startThread();
 
 		isRecording = true;
+		stopPreTriggerBuffering();
 		hasRecorded = true;
 
 	}
@@ -370,6 +368,36 @@ void RecordNode::setParameter(int parameterIndex, float newValue)
 				}
 			}
 
+			//Pre-trigger buffering starts again once the record thread has drained the queues
+			if (m_preTriggerSeconds > 0 && !isSnippetMode() && isProcessing)
+				startPreTriggerBuffering();
+
+			if (m_recordingSnippets)
+			{
+				m_recordingSnippets = false;
+				std::cout << "Recorded " << m_snippetGate->getNumSnippets() << " snippets" << std::endl;
+				if (m_snippetGate->getNumOverruns() > 0)
+					CoreServices::sendStatusMessage("Warning: " + String(m_snippetGate->getNumOverruns()) + " snippet triggers were dropped while recording");
+			}
+
+			BufferStats stats = m_dataQueue->getStats();
+			if (stats.samplesDropped > 0)
+			{
+				std::cerr << "Recording data queue overflowed: " << stats.samplesDropped << " samples dropped, "
+					<< stats.secondsFull << " s full" << std::endl;
+				CoreServices::sendStatusMessage("Warning: " + String(stats.samplesDropped) + " samples were dropped while recording");
+			}
+			int eventOverruns = m_eventQueue->getNumOverruns();
+			int spikeOverruns = m_spikeQueue->getNumOverruns();
+			if (eventOverruns > 0 || spikeOverruns > 0)
+			{
+				std::cerr << "Recording event queues overflowed: " << eventOverruns << " events and "
+					<< spikeOverruns << " spikes dropped" << std::endl;
+				CoreServices::sendStatusMessage("Warning: " + String(eventOverruns) + " events and " + String(spikeOverruns) + " spikes were dropped while recording");
+			}
+
+			//The files of the next recording are created while acquisition goes on
+			prepareRecording();
 		}
 	}
 	else if (parameterIndex == 2)
@@ -414,7 +442,7 @@ void RecordNode::setParameter(int parameterIndex, float newValue)
 		{
 			CoreServices::sendStatusMessage("Turning record thread off.");
 			shouldRecord = false;
-			
+			discardPreparedRecording();
 		}
 		else
 		{
@@ -424,11 +452,177 @@ void RecordNode::setParameter(int parameterIndex, float newValue)
 	}
 }
 
+void RecordNode::startRecordThread(RecordedChannels& recorded, bool snippets)
+{
+	if (newDirectoryNeeded)
+	{
+		createNewDirectory();
+		recordingNumber = 0;
+		experimentNumber = 1;
+		settingsNeeded = true;
+		EVERY_ENGINE->directoryChanged();
+	}
+	else
+	{
+		recordingNumber++; // increment recording number within this directory
+	}
+
+	if (!rootFolder.exists())
+	{
+		rootFolder.createDirectory();
+	}
+
+	m_recordThread->setFileComponents(rootFolder, experimentNumber, recordingNumber);
+
+	EVERY_ENGINE->setSnippetRecording(snippets);
+	m_recordThread->setSnippetGate(snippets ? m_snippetGate.get() : nullptr);
+
+	//WARNING: If at some point we record at more that one recordEngine at once, we should change this, as using OwnedArrays only works for the first
+	EVERY_ENGINE->setChannelMapping(recorded.channelMap, recorded.processorMap, recorded.orderInProcessor, recorded.procInfo);
+	m_recordThread->setChannelMap(recorded.channelMap);
+	m_recordThread->setChannelGroups(recorded.processorMap);
+	m_recordThread->setFirstBlockFlag(false);
+
+	setFirstBlock = false;
+	m_recordThread->startThread();
+}
+
+void RecordNode::prepareRecording()
+{
+	if (!isProcessing || !shouldRecord || isRecording || m_recordingPrepared)
+		return;
+
+	bool anyPrepared = false;
+	for (int eng = 0; eng < engineArray.size(); eng++)
+		anyPrepared = anyPrepared || engineArray[eng]->supportsPreparedFiles();
+	if (!anyPrepared)
+		return;
+
+	RecordedChannels recorded;
+	getRecordedChannels(recorded);
+	m_preparedChannelMap = recorded.channelMap;
+	m_preparedSnippets = isSnippetMode() && enginesRecordSnippets();
+	m_preparedNewDirectory = newDirectoryNeeded;
+	m_preparedDirectory = rootFolder;
+
+	startRecordThread(recorded, m_preparedSnippets);
+	m_recordingPrepared = true;
+}
+
+void RecordNode::discardPreparedRecording()
+{
+	if (!m_recordingPrepared)
+		return;
+	m_recordingPrepared = false;
+
+	//Without a first block the thread removes the files it opened on its way out
+	m_recordThread->signalThreadShouldExit();
+	m_recordThread->waitForThreadToExit(-1);
+
+	//Back to the directory and numbers the recording would have taken
+	if (m_preparedNewDirectory)
+	{
+		if (rootFolder.getNumberOfChildFiles(File::findFilesAndDirectories) == 0)
+			rootFolder.deleteFile();
+		rootFolder = m_preparedDirectory;
+		newDirectoryNeeded = true;
+	}
+	else
+	{
+		recordingNumber--;
+	}
+}
+
+bool RecordNode::enginesRecordSnippets() const
+{
+	for (int eng = 0; eng < engineArray.size(); eng++)
+	{
+		if (!engineArray[eng]->supportsSnippetRecording())
+			return false;
+	}
+	return true;
+}
+
 bool RecordNode::getRecordThreadStatus()
 {
 	return shouldRecord;
 }
 
+void RecordNode::setNumWriterThreads(int numThreads)
+{
+	m_recordThread->setNumWriterThreads(numThreads);
+}
+
+int RecordNode::getNumWriterThreads() const
+{
+	return m_recordThread->getNumWriterThreads();
+}
+
+void RecordNode::setMaxWriteLatency(int maxLatencyMs)
+{
+	m_recordThread->setWakeupParameters(RECORD_THREAD_WAKEUP_SAMPLES, maxLatencyMs);
+}
+
+int RecordNode::getMaxWriteLatency() const
+{
+	return m_recordThread->getMaxLatencyMs();
+}
+
+BufferStats RecordNode::getDataQueueStats() const
+{
+	return m_dataQueue->getStats();
+}
+
+void RecordNode::getMemoryUsage(MemoryUsage& usage) const
+{
+	GenericProcessor::getMemoryUsage(usage);
+
+	usage.add("Data queue", m_dataQueue->getMemorySize());
+	usage.add("Event queue", m_eventQueue->getMemorySize());
+	usage.add("Spike queue", m_spikeQueue->getMemorySize());
+
+	for (int i = 0; i < engineArray.size(); i++)
+	{
+		MemoryUsage engineUsage;
+		engineArray[i]->getMemoryUsage(engineUsage);
+		usage.add(engineArray[i]->getEngineID(), engineUsage);
+	}
+}
+
+int64 RecordNode::getNumBytesWritten() const
+{
+	return m_recordThread->getNumBytesWritten();
+}
+
+double RecordNode::getConfiguredDataRate() const
+{
+	double samplesPerSecond = 0;
+	for (int ch = 0; ch < dataChannelArray.size(); ch++)
+	{
+		if (dataChannelArray[ch]->getRecordState())
+			samplesPerSecond += dataChannelArray[ch]->getSampleRate();
+	}
+	return samplesPerSecond * sizeof(int16) * jmax(1, engineArray.size());
+}
+
+int64 RecordNode::getFreeBytes() const
+{
+	return dataDirectory.getBytesFreeOnVolume();
+}
+
+ThreadLoadMonitor::Counters RecordNode::getRecordThreadLoadCounters() const
+{
+	return m_recordThread->getLoadCounters();
+}
+
+bool RecordNode::prepareForAcquisition()
+{
+    // engines may allocate their buffers here, while the other processors prepare
+    EVERY_ENGINE->configureEngine();
+    EVERY_ENGINE->startAcquisition();
+    return true;
+}
+
 bool RecordNode::enable()
 {
     if (hasRecorded)
@@ -440,19 +634,49 @@ bool RecordNode::enable()
 
     //When starting a recording, if a new directory is needed it gets rewritten. Else is incremented by one.
     recordingNumber = -1;
-    EVERY_ENGINE->configureEngine();
-    EVERY_ENGINE->startAcquisition();
     isProcessing = true;
+
+    //The pre-trigger ring is allocated here, so buffering never allocates.
+    //Snippet recordings hold back their pre-trigger windows in the queue instead
+    bool snippets = isSnippetMode();
+    if (snippets && m_preTriggerSeconds > 0)
+        CoreServices::sendStatusMessage("Pre-trigger buffering is off while recording snippets");
+    if ((m_preTriggerSeconds > 0 || snippets) && shouldRecord)
+    {
+        RecordedChannels recorded;
+        getRecordedChannels(recorded);
+
+        float maxSampleRate = 0;
+        for (int i = 0; i < recorded.channelMap.size(); ++i)
+            maxSampleRate = jmax(maxSampleRate, dataChannelArray[recorded.channelMap[i]]->getSampleRate());
+        float bufferSeconds = snippets ? m_snippetPreMs / 1000.0f : float(m_preTriggerSeconds);
+        m_dataQueue->resize(DATA_BUFFER_NBLOCKS + int(std::ceil(bufferSeconds * maxSampleRate / WRITE_BLOCK_LENGTH)));
+        if (!snippets)
+        {
+            setQueueChannels(recorded);
+            startPreTriggerBuffering();
+        }
+    }
+    else
+    {
+        m_dataQueue->resize(DATA_BUFFER_NBLOCKS);
+    }
+
+    //Directory and files are created now, so pressing record only has to start writing
+    prepareRecording();
     return true;
 }
 
 
 bool RecordNode::disable()
 {
+    isProcessing = false;
+
     // close files if necessary
     setParameter(0, 10.0f);
-
-    isProcessing = false;
+    discardPreparedRecording();
+    stopPreTriggerBuffering();
+    m_preTriggerReady = false;
 
     return true;
 }
@@ -463,6 +687,181 @@ float RecordNode::getFreeSpace() const
 }
 
 
+void RecordNode::getRecordedChannels(RecordedChannels& recorded) const
+{
+	int totChans = dataChannelArray.size();
+	Array<uint32> groupSources;
+	int lastProcessor = -1;
+	int procIndex = -1;
+	int chanProcOrder = 0;
+	for (int ch = 0; ch < totChans; ++ch)
+	{
+		const DataChannel* chan = dataChannelArray[ch];
+		if (chan->getRecordState())
+		{
+			recorded.channelMap.add(ch);
+			//This is bassed on the assumption that all channels from the same processor are added contiguously
+			//If this behaviour changes, this check should be most thorough
+			if (chan->getCurrentNodeID() != lastProcessor)
+			{
+				lastProcessor = chan->getCurrentNodeID();
+				RecordProcessorInfo* pi = new RecordProcessorInfo();
+				pi->processorId = chan->getCurrentNodeID();
+				recorded.procInfo.add(pi);
+				procIndex++;
+				chanProcOrder = 0;
+			}
+			recorded.procInfo.getLast()->recordedChannels.add(recorded.channelMap.size() - 1);
+			recorded.processorMap.add(procIndex);
+			recorded.orderInProcessor.add(chanProcOrder);
+			chanProcOrder++;
+
+			//Channels of the same source always have the same samples and timestamps
+			uint32 sourceId = getProcessorFullId(chan->getSourceNodeID(), chan->getSubProcessorIdx());
+			int group = groupSources.indexOf(sourceId);
+			if (group < 0)
+			{
+				group = groupSources.size();
+				groupSources.add(sourceId);
+				recorded.groupChannels.add(recorded.channelMap.size() - 1);
+				recorded.groupRingSamples.add(int(m_preTriggerSeconds * chan->getSampleRate()));
+				recorded.groupSources.add(sourceId);
+				recorded.groupSampleRates.add(chan->getSampleRate());
+			}
+			recorded.sourceGroups.add(group);
+		}
+	}
+}
+
+void RecordNode::setQueueChannels(const RecordedChannels& recorded)
+{
+	channelMap = recorded.channelMap;
+	m_groupChannels = recorded.groupChannels;
+	m_groupRingSamples = recorded.groupRingSamples;
+	m_groupSources = recorded.groupSources;
+	m_groupSampleRates = recorded.groupSampleRates;
+	m_validBlocks.clear();
+	m_validBlocks.insertMultiple(0, false, m_groupChannels.size());
+	m_dataQueue->setChannels(recorded.sourceGroups);
+	resizeEventQueues();
+}
+
+void RecordNode::startPreTriggerBuffering()
+{
+	m_dataQueue->resetStats();
+	m_preTriggerReady = true;
+	m_preTriggerBuffering = true;
+}
+
+void RecordNode::stopPreTriggerBuffering()
+{
+	//Waits for the audio thread to finish the block it may be buffering
+	const SpinLock::ScopedLockType lock(m_preTriggerLock);
+	m_preTriggerBuffering = false;
+}
+
+void RecordNode::setPreTriggerSeconds(int seconds)
+{
+	if (isProcessing)
+		return;
+	m_preTriggerSeconds = jmax(0, seconds);
+}
+
+int RecordNode::getPreTriggerSeconds() const
+{
+	return m_preTriggerSeconds;
+}
+
+void RecordNode::setSnippetWindow(int preMs, int postMs)
+{
+	if (isProcessing)
+		return;
+	m_snippetPreMs = jmax(0, preMs);
+	m_snippetPostMs = jmax(0, postMs);
+}
+
+int RecordNode::getSnippetPreMs() const
+{
+	return m_snippetPreMs;
+}
+
+int RecordNode::getSnippetPostMs() const
+{
+	return m_snippetPostMs;
+}
+
+void RecordNode::setSnippetTriggers(int ttlLine, bool spikes)
+{
+	if (isProcessing)
+		return;
+	m_snippetTTLLine = jmax(-1, ttlLine);
+	m_snippetSpikes = spikes;
+}
+
+int RecordNode::getSnippetTTLLine() const
+{
+	return m_snippetTTLLine;
+}
+
+bool RecordNode::getSnippetSpikeTriggers() const
+{
+	return m_snippetSpikes;
+}
+
+bool RecordNode::isSnippetMode() const
+{
+	return (m_snippetPreMs > 0 || m_snippetPostMs > 0) && (m_snippetTTLLine >= 0 || m_snippetSpikes);
+}
+
+void RecordNode::addSnippetTrigger(uint32 sourceId, int64 timestamp, float sampleRate)
+{
+	//Sources have their own clocks, so the trigger is placed at the same time from the start of their blocks
+	double offsetSeconds = (sampleRate > 0) ? (timestamp - int64(getSourceTimestamp(sourceId))) / double(sampleRate) : 0;
+	for (int group = 0; group < m_groupSources.size(); ++group)
+	{
+		if (m_groupSources.getUnchecked(group) == sourceId)
+		{
+			m_snippetGate->addTrigger(group, timestamp);
+		}
+		else
+		{
+			int64 blockTimestamp = int64(getTimestamp(channelMap[m_groupChannels[group]]));
+			m_snippetGate->addTrigger(group, blockTimestamp + int64(std::floor(offsetSeconds * m_groupSampleRates.getUnchecked(group) + 0.5)));
+		}
+	}
+}
+
+/** Reads the line and state of a TTL event straight from the message, as deserializing it allocates */
+static bool isTTLRisingEdge(const MidiMessage& event, int line)
+{
+	if (Event::getBaseType(event) != PROCESSOR_EVENT || Event::getEventType(event) != EventChannel::TTL)
+		return false;
+	const uint8* data = event.getRawData();
+	int channel = *reinterpret_cast<const uint16*>(data + 16);
+	if (channel != line || event.getRawDataSize() <= EVENT_BASE_SIZE + channel / 8)
+		return false;
+	return (data[EVENT_BASE_SIZE + channel / 8] >> (channel % 8)) & 1;
+}
+
+void RecordNode::resizeEventQueues()
+{
+	size_t eventSlotSize = EVENT_BUFFER_MIN_SLOT_SIZE;
+	for (int i = 0; i < eventChannelArray.size(); ++i)
+	{
+		const EventChannel* chan = eventChannelArray[i];
+		eventSlotSize = jmax(eventSlotSize, chan->getDataSize() + chan->getTotalEventMetaDataSize() + EVENT_BASE_SIZE);
+	}
+	size_t spikeSlotSize = EVENT_BUFFER_MIN_SLOT_SIZE;
+	for (int i = 0; i < spikeChannelArray.size(); ++i)
+	{
+		const SpikeChannel* chan = spikeChannelArray[i];
+		spikeSlotSize = jmax(spikeSlotSize, chan->getWaveformDataSize() + chan->getTotalEventMetaDataSize() + SPIKE_BASE_SIZE
+			+ chan->getNumChannels()*sizeof(float));
+	}
+	m_eventQueue->resize(EVENT_BUFFER_NEVENTS, int(eventSlotSize));
+	m_spikeQueue->resize(SPIKE_BUFFER_NSPIKES, int(spikeSlotSize));
+}
+
 void RecordNode::handleEvent(const EventChannel* eventInfo, const MidiMessage& event, int samplePosition)
 {
     if (true)
@@ -477,11 +876,45 @@ void RecordNode::handleEvent(const EventChannel* eventInfo, const MidiMessage& e
 				else
 					eventIndex = -1;
 				if (isRecording && shouldRecord)
+				{
 					m_eventQueue->addEvent(event, timestamp, eventIndex);
+					m_recordThread->notifyEventWritten();
+					if (m_recordingSnippets.load() && eventInfo && m_snippetTTLLine >= 0 && isTTLRisingEdge(event, m_snippetTTLLine))
+						addSnippetTrigger(getProcessorFullId(Event::getSourceID(event), Event::getSubProcessorIdx(event)), timestamp, eventInfo->getSampleRate());
+				}
+				else if (m_bufferingBlock)
+				{
+					m_eventQueue->addEvent(event, timestamp, eventIndex, true);
+				}
             }
     }
 }
 
+int RecordNode::queueData(const AudioSampleBuffer& buffer, bool preTrigger)
+{
+	int numGroups = m_groupChannels.size();
+	int maxSamples = 0;
+	for (int group = 0; group < numGroups; ++group)
+	{
+		int realChan = channelMap[m_groupChannels[group]];
+		int nSamples = getNumSamples(realChan);
+		int64 timestamp = getTimestamp(realChan);
+		bool shouldWrite = m_validBlocks[group];
+		if (!shouldWrite && nSamples > 0)
+		{
+			shouldWrite = true;
+			m_validBlocks.set(group, true);
+		}
+
+		if (shouldWrite)
+		{
+			m_dataQueue->writeGroup(buffer, group, channelMap, nSamples, timestamp, preTrigger ? m_groupRingSamples[group] : 0);
+			maxSamples = jmax(maxSamples, nSamples);
+		}
+	}
+	return maxSamples;
+}
+
 void RecordNode::handleTimestampSyncTexts(const MidiMessage& event)
 {
 	handleEvent(nullptr, event, 0);
@@ -490,36 +923,39 @@ void RecordNode::handleTimestampSyncTexts(const MidiMessage& event)
 void RecordNode::process(AudioSampleBuffer& buffer)
 {
 	
+	//Before a recording, keep the latest data and events in the queues. The message thread
+	//takes the lock to stop this, so the block is either fully buffered or skipped
+	m_bufferingBlock = false;
+	if (!isRecording && shouldRecord && m_preTriggerBuffering.load() && m_preTriggerLock.tryEnter())
+	{
+		m_bufferingBlock = m_preTriggerBuffering.load();
+		if (!m_bufferingBlock)
+			m_preTriggerLock.exit();
+	}
+
 	// FIRST: cycle through events -- extract the TTLs and the timestamps
     checkForEvents();
 
-    if (isRecording && shouldRecord)
+    if (m_bufferingBlock)
+    {
+		queueData(buffer, true);
+		m_bufferingBlock = false;
+		m_preTriggerLock.exit();
+    }
+    else if (isRecording && shouldRecord)
     {
         // SECOND: write channel data
-		int recordChans = channelMap.size();
-		for (int chan = 0; chan < recordChans; ++chan)
-		{
-			int realChan = channelMap[chan];
-			int nSamples = getNumSamples(realChan);
-			int timestamp = getTimestamp(realChan);
-			bool shouldWrite = m_validBlocks[chan];
-			if (!shouldWrite && nSamples > 0)
-			{
-				shouldWrite = true;
-				m_validBlocks.set(chan, true);
-			}
-
-			if (shouldWrite)
-				m_dataQueue->writeChannel(buffer, chan, realChan, nSamples, timestamp);
-		}
+		int maxSamples = queueData(buffer, false);
+		int numGroups = m_groupChannels.size();
+		m_recordThread->notifyDataWritten(maxSamples);
 
         //  std::cout << nSamples << " " << samplesWritten << " " << blockIndex << std::endl;
 		if (!setFirstBlock)
 		{
 			bool shouldSetFlag = true;
-			for (int chan = 0; chan < recordChans; ++chan)
+			for (int group = 0; group < numGroups; ++group)
 			{
-				if (!m_validBlocks[chan])
+				if (!m_validBlocks[group])
 				{
 					shouldSetFlag = false;
 					break;
@@ -569,7 +1005,20 @@ void RecordNode::writeSpike(const SpikeEvent* spike, const SpikeChannel* spikeEl
 	{
 		int electrodeIndex = getSpikeChannelIndex(spikeElectrode->getSourceIndex(), spikeElectrode->getSourceNodeID(), spikeElectrode->getSubProcessorIdx());
 		if (electrodeIndex >= 0)
+		{
 			m_spikeQueue->addEvent(*spike, spike->getTimestamp(), electrodeIndex);
+			m_recordThread->notifyEventWritten();
+		}
+		if (m_recordingSnippets.load() && m_snippetSpikes && electrodeIndex >= 0)
+			addSnippetTrigger(getProcessorFullId(spikeElectrode->getSourceNodeID(), spikeElectrode->getSubProcessorIdx()),
+				spike->getTimestamp(), spikeElectrode->getSampleRate());
+	}
+	else if (shouldRecord && m_preTriggerBuffering.load() && m_preTriggerLock.tryEnter())
+	{
+		int electrodeIndex = getSpikeChannelIndex(spikeElectrode->getSourceIndex(), spikeElectrode->getSourceNodeID(), spikeElectrode->getSubProcessorIdx());
+		if (m_preTriggerBuffering.load() && electrodeIndex >= 0)
+			m_spikeQueue->addEvent(*spike, spike->getTimestamp(), electrodeIndex, true);
+		m_preTriggerLock.exit();
 	}
 }
 
@@ -588,6 +1037,11 @@ File RecordNode::getDataDirectory() const
 	return rootFolder;
 }
 
+FileMirror* RecordNode::getFileMirror() const
+{
+	return m_fileMirror;
+}
+
 void RecordNode::updateRecordChannelIndexes()
 {
 	//Keep the nodeIDs of the original processor from each channel comes from
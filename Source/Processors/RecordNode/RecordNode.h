@@ -31,15 +31,22 @@
 
 #include "../GenericProcessor/GenericProcessor.h"
 #include "EventQueue.h"
+#include "../DataThreads/DataBuffer.h"
+#include "../GenericProcessor/ThreadLoadMonitor.h"
 
 #define WRITE_BLOCK_LENGTH 1024
 #define DATA_BUFFER_NBLOCKS 300
 #define EVENT_BUFFER_NEVENTS 512
 #define SPIKE_BUFFER_NSPIKES 512
+//Smallest event queue slot. Must hold timestamp sync texts, which have no channel to size them from
+#define EVENT_BUFFER_MIN_SLOT_SIZE 512
 
 class RecordEngine;
+struct RecordProcessorInfo;
 class RecordThread;
 class DataQueue;
+class SnippetGate;
+class FileMirror;
 
 /**
 
@@ -63,6 +70,8 @@ public:
     /** Handle incoming data and decide which files and events to write to disk.
     */
     void process(AudioSampleBuffer& buffer) override;
+    bool modifiesContinuousData() const override { return false; }
+    bool emitsEvents() const override { return false; }
 
 
     /** Overrides implementation in GenericProcessor; used to change recording parameters
@@ -88,6 +97,9 @@ public:
     */
     void addInputChannel(const GenericProcessor* sourceNode, int chan);
 
+    /** Configures the record engines, on a worker thread at the start of acquisition */
+    bool prepareForAcquisition() override;
+
     bool enable();
     bool disable();
 
@@ -152,12 +164,67 @@ public:
 	/** Get the last settings.xml in string form. Since the string will be large, returns a const ref.*/
 	const String& getLastSettingsXml() const;
 
+	/** Copies finished files to the mirror folders of the engines. Lives as long as the node, so
+	the copies go on between recordings and acquisitions */
+	FileMirror* getFileMirror() const;
+
 	//Called by ProcessorGraph
 	void updateRecordChannelIndexes();
 	void addSpecialProcessorChannels(Array<EventChannel*>& channels);
 
 	bool getRecordThreadStatus();
 
+	/** Sets how many threads write continuous data to disk. With more than one, record engines,
+	and recorded processors of engines that allow it, are written in parallel.
+	Has no effect while recording.*/
+	void setNumWriterThreads(int numThreads);
+	int getNumWriterThreads() const;
+
+	/** Sets the longest time, in milliseconds, queued data can wait before the record thread
+	writes it to disk. Has no effect while recording.*/
+	void setMaxWriteLatency(int maxLatencyMs);
+	int getMaxWriteLatency() const;
+
+	/** Returns the overflow counters of the queue between the audio thread and the record thread*/
+	BufferStats getDataQueueStats() const;
+
+	/** Adds the queues to the record thread and the buffers of every record engine*/
+	void getMemoryUsage(MemoryUsage& usage) const override;
+
+	/** Returns the number of bytes of data, events and spikes written in the current or last
+	recording, see RecordThread::getNumBytesWritten()*/
+	int64 getNumBytesWritten() const;
+
+	/** Returns the bytes per second the continuous channels currently set to record will take,
+	for all record engines*/
+	double getConfiguredDataRate() const;
+
+	/** Returns the free space on the volume of the data directory, in bytes*/
+	int64 getFreeBytes() const;
+
+	/** Returns the write pass count and CPU time of the record thread*/
+	ThreadLoadMonitor::Counters getRecordThreadLoadCounters() const;
+
+	/** Sets how many seconds of the channels and events set to record are kept in memory while
+	acquiring, and written at the start of the next recording, or 0 to only write from when
+	recording starts. The memory is allocated when acquisition starts, so it takes effect from
+	the next one. Has no effect while acquiring.*/
+	void setPreTriggerSeconds(int seconds);
+	int getPreTriggerSeconds() const;
+
+	/** Sets the milliseconds of continuous data written before and after every trigger when only
+	snippets around events are recorded, overlapping snippets being merged. Both 0 record all the
+	data, as when there are no triggers. Replaces pre-trigger buffering. Has no effect while acquiring.*/
+	void setSnippetWindow(int preMs, int postMs);
+	int getSnippetPreMs() const;
+	int getSnippetPostMs() const;
+
+	/** Sets what opens a snippet: the rising edges of a TTL line of any event channel, or -1 for
+	none, and the spikes of any electrode. Has no effect while acquiring.*/
+	void setSnippetTriggers(int ttlLine, bool spikes);
+	int getSnippetTTLLine() const;
+	bool getSnippetSpikeTriggers() const;
+
 private:
 
     /** Keep the RecordNode informed of acquisition and record states.
@@ -201,6 +268,51 @@ private:
 
 	virtual void handleTimestampSyncTexts(const MidiMessage& event);
 
+	/** Resizes the event and spike queue slots to fit the largest event of the current channels */
+	void resizeEventQueues();
+
+	/** The channels set to record, and how they are grouped by processor and by source */
+	struct RecordedChannels
+	{
+		Array<int> channelMap;
+		OwnedArray<RecordProcessorInfo> procInfo;
+		Array<int> processorMap;
+		Array<int> orderInProcessor;
+		Array<int> sourceGroups;
+		Array<int> groupChannels;
+		Array<int> groupRingSamples;
+		Array<uint32> groupSources;
+		Array<float> groupSampleRates;
+	};
+	void getRecordedChannels(RecordedChannels& recorded) const;
+	/** Sets up the queues for the given channels, discarding what they hold */
+	void setQueueChannels(const RecordedChannels& recorded);
+
+	/** Writes the data of every source to the queue, as a ring when buffering before a recording.
+	Returns the largest number of samples written */
+	int queueData(const AudioSampleBuffer& buffer, bool preTrigger);
+
+	void startPreTriggerBuffering();
+	/** Returns once the audio thread has stopped writing to the queues */
+	void stopPreTriggerBuffering();
+
+	/** Returns true if the snippet settings make recordings only write snippets */
+	bool isSnippetMode() const;
+	/** Returns true if every record engine can write only snippets */
+	bool enginesRecordSnippets() const;
+
+	/** Takes the directory and numbers of the next recording and starts the record thread on
+	the given channels. The thread opens the files, and waits for the first block to write them */
+	void startRecordThread(RecordedChannels& recorded, bool snippets);
+	/** Starts the record thread for the next recording while acquiring, so the engines that
+	support it create its directory and files before recording is pressed */
+	void prepareRecording();
+	/** Stops a record thread started by prepareRecording whose recording never started,
+	removing the files and, if it was new, the directory */
+	void discardPreparedRecording();
+	/** Adds a snippet trigger for every source, moving the timestamp from the clock of the triggering source to theirs */
+	void addSnippetTrigger(uint32 sourceId, int64 timestamp, float sampleRate);
+
     /**RecordEngines loaded**/
     OwnedArray<RecordEngine> engineArray;
 
@@ -210,10 +322,41 @@ private:
 	ScopedPointer<SpikeMsgQueue> m_spikeQueue;
 	
 	Array<int> m_recordedChannelMap;
+	/** First recorded channel of each source, whose channels are queued together */
+	Array<int> m_groupChannels;
 	Array<bool> m_validBlocks;
 
+	int m_preTriggerSeconds;
+	/** Samples of each source kept while buffering */
+	Array<int> m_groupRingSamples;
+	/** The queues hold data buffered for the next recording */
+	bool m_preTriggerReady;
+	std::atomic<bool> m_preTriggerBuffering;
+	SpinLock m_preTriggerLock;
+	/** The block being processed is buffered, only used by the audio thread */
+	bool m_bufferingBlock;
+
+	ScopedPointer<SnippetGate> m_snippetGate;
+	int m_snippetPreMs;
+	int m_snippetPostMs;
+	int m_snippetTTLLine;
+	bool m_snippetSpikes;
+	/** The current recording only writes snippets */
+	std::atomic<bool> m_recordingSnippets;
+	Array<uint32> m_groupSources;
+	Array<float> m_groupSampleRates;
+
+	/** The record thread is running ahead of a recording, with these settings */
+	bool m_recordingPrepared;
+	Array<int> m_preparedChannelMap;
+	bool m_preparedSnippets;
+	bool m_preparedNewDirectory;
+	File m_preparedDirectory;
+
 	String m_lastSettingsText;
 
+	ScopedPointer<FileMirror> m_fileMirror;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RecordNode);
 
 };
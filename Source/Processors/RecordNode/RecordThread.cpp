@@ -26,15 +26,51 @@
 #include "../../AccessClass.h"
 #include "../ProcessorGraph/ProcessorGraph.h"
 #include "RecordNode.h"
+#include "../GenericProcessor/TraceRecorder.h"
+#include "../GenericProcessor/RealtimeLog.h"
+#include "../GenericProcessor/ThreadPolicy.h"
+#include "SnippetGate.h"
 
 #define EVERY_ENGINE for(int eng = 0; eng < m_engineArray.size(); eng++) m_engineArray[eng]
 
+/** Writes a fixed set of channel runs to one engine. Re-queued on every write pass*/
+class RecordThread::ChannelWriteJob : public ThreadPoolJob
+{
+public:
+	ChannelWriteJob(RecordThread& owner, RecordEngine* engine) :
+		ThreadPoolJob("Record write job"),
+		m_owner(owner),
+		m_engine(engine)
+	{}
+
+	JobStatus runJob() override
+	{
+		for (int i = 0; i < runs.size(); ++i)
+			m_owner.writeRun(m_engine, m_owner.m_channelRuns.getReference(runs.getUnchecked(i)));
+		return jobHasFinished;
+	}
+
+	/** Indexes in m_channelRuns */
+	Array<int> runs;
+
+private:
+	RecordThread& m_owner;
+	RecordEngine* const m_engine;
+};
+
 
 RecordThread::RecordThread(const OwnedArray<RecordEngine>& engines) :
 Thread("Record Thread"),
 m_engineArray(engines),
+m_snippetGate(nullptr),
 m_receivedFirstBlock(false),
-m_cleanExit(true)
+m_cleanExit(true),
+m_pendingSamples(0),
+m_pendingEvents(0),
+m_bytesWritten(0),
+m_wakeupSamples(RECORD_THREAD_WAKEUP_SAMPLES),
+m_maxLatencyMs(RECORD_THREAD_MAX_LATENCY_MS),
+m_numWriterThreads(1)
 {
 }
 
@@ -60,6 +96,90 @@ void RecordThread::setChannelMap(const Array<int>& channels)
 	m_numChannels = channels.size();
 }
 
+void RecordThread::setChannelGroups(const Array<int>& chanProcessor)
+{
+	if (isThreadRunning())
+		return;
+	m_channelGroups = chanProcessor;
+}
+
+void RecordThread::setNumWriterThreads(int numThreads)
+{
+	if (isThreadRunning())
+		return;
+	m_numWriterThreads = jmax(1, numThreads);
+}
+
+int RecordThread::getNumWriterThreads() const
+{
+	return m_numWriterThreads;
+}
+
+void RecordThread::createChannelRuns()
+{
+	m_channelRuns.clearQuick();
+	for (int chan = 0; chan < m_numChannels; ++chan)
+	{
+		const int queueGroup = m_dataQueue->getChannelGroup(chan);
+		if (m_channelRuns.size() > 0)
+		{
+			ChannelRun& last = m_channelRuns.getReference(m_channelRuns.size() - 1);
+			const int previous = last.firstChannel + last.numChannels - 1;
+			if (m_dataQueue->getChannelGroup(previous) == queueGroup && m_channelGroups[previous] == m_channelGroups[chan])
+			{
+				++last.numChannels;
+				continue;
+			}
+		}
+		ChannelRun run = { chan, 1 };
+		m_channelRuns.add(run);
+	}
+	m_readPointers.resize(m_numChannels);
+	m_wrapReadPointers.resize(m_numChannels);
+}
+
+void RecordThread::createWriteJobs()
+{
+	m_writeJobs.clear();
+	m_writerPool = nullptr;
+
+	if (m_numWriterThreads <= 1)
+		return;
+
+	for (int eng = 0; eng < m_engineArray.size(); eng++)
+	{
+		RecordEngine* engine = m_engineArray[eng];
+		if (engine->supportsParallelChannelWrites())
+		{
+			//one job per recorded processor, channels kept in order inside each job
+			HashMap<int, ChannelWriteJob*> groupJobs;
+			for (int run = 0; run < m_channelRuns.size(); ++run)
+			{
+				int group = m_channelGroups[m_channelRuns.getReference(run).firstChannel];
+				if (!groupJobs.contains(group))
+				{
+					ChannelWriteJob* job = new ChannelWriteJob(*this, engine);
+					m_writeJobs.add(job);
+					groupJobs.set(group, job);
+				}
+				groupJobs[group]->runs.add(run);
+			}
+		}
+		else
+		{
+			ChannelWriteJob* job = new ChannelWriteJob(*this, engine);
+			for (int run = 0; run < m_channelRuns.size(); ++run)
+				job->runs.add(run);
+			m_writeJobs.add(job);
+		}
+	}
+
+	if (m_writeJobs.size() > 1)
+		m_writerPool = new ThreadPool(jmin(m_numWriterThreads, m_writeJobs.size()));
+	else
+		m_writeJobs.clear();
+}
+
 void RecordThread::setQueuePointers(DataQueue* data, EventMsgQueue* events, SpikeMsgQueue* spikes)
 {
 	m_dataQueue = data;
@@ -67,6 +187,50 @@ void RecordThread::setQueuePointers(DataQueue* data, EventMsgQueue* events, Spik
 	m_spikeQueue = spikes;
 }
 
+void RecordThread::setSnippetGate(SnippetGate* gate)
+{
+	if (isThreadRunning())
+		return;
+	m_snippetGate = gate;
+}
+
+void RecordThread::setWakeupParameters(int sampleThreshold, int maxLatencyMs)
+{
+	if (isThreadRunning())
+		return;
+	m_wakeupSamples = jmax(1, sampleThreshold);
+	m_maxLatencyMs = jmax(1, maxLatencyMs);
+}
+
+int RecordThread::getMaxLatencyMs() const
+{
+	return m_maxLatencyMs;
+}
+
+void RecordThread::notifyDataWritten(int numSamples)
+{
+	int previous = m_pendingSamples.fetch_add(numSamples);
+	//Only signal when crossing the threshold, not on every block after it
+	if (previous < m_wakeupSamples && previous + numSamples >= m_wakeupSamples)
+		notify();
+}
+
+void RecordThread::notifyEventWritten()
+{
+	if (++m_pendingEvents == BLOCK_MAX_WRITE_EVENTS)
+		notify();
+}
+
+int64 RecordThread::getNumBytesWritten() const
+{
+	return m_bytesWritten.load();
+}
+
+ThreadLoadMonitor::Counters RecordThread::getLoadCounters() const
+{
+	return m_loadMonitor.getCounters();
+}
+
 void RecordThread::setFirstBlockFlag(bool state)
 {
 	m_receivedFirstBlock = state;
@@ -77,88 +241,241 @@ void RecordThread::run()
 {
 	const AudioSampleBuffer& dataBuffer = m_dataQueue->getAudioBufferReference();
 	bool closeEarly = true;
-	//1-Wait until the first block has arrived, so we can align the timestamps
+	ThreadPolicy::applyToCurrentThread(ThreadPolicy::Writer);
+	//1-Create the files of the engines that don't need the timestamps right away. When the
+	//thread is started ahead of the recording, this happens before it starts
+	m_preparedEngines.clearQuick();
+	for (int eng = 0; eng < m_engineArray.size(); eng++)
+	{
+		bool prepared = m_engineArray[eng]->supportsPreparedFiles() && !threadShouldExit();
+		if (prepared)
+			m_engineArray[eng]->openFiles(m_rootFolder, m_experimentNumber, m_recordingNumber);
+		m_preparedEngines.add(prepared);
+	}
+
+	//2-Wait until the first block has arrived, so we can align the timestamps
 	while (!m_receivedFirstBlock && !threadShouldExit())
 	{
 		wait(1);
 	}
 
-	//2-Open Files 
+	//3-Open the remaining files
 	if (!threadShouldExit())
 	{
 		m_cleanExit = false;
 		closeEarly = false;
-		Array<int64> timestamps;
-		m_dataQueue->getTimestampsForBlock(0, timestamps);
+		m_bytesWritten = 0;
+		m_loadMonitor.reset();
+		m_dataQueue->getReadTimestamps(m_timestamps);
+		//Samples can only be written once the triggers that could open a window over them have arrived
+		m_dataQueue->setReadHoldBack(m_snippetGate != nullptr ? m_snippetGate->getPreSamples() : Array<int>());
+		m_gateTimestamps.clear();
+		for (int eng = 0; m_snippetGate != nullptr && eng < m_engineArray.size(); eng++)
+		{
+			m_gateTimestamps.add(new Array<int64>());
+			m_gateTimestamps.getLast()->insertMultiple(0, 0, m_numChannels);
+		}
 
-		EVERY_ENGINE->updateTimestamps(timestamps);
-		EVERY_ENGINE->openFiles(m_rootFolder, m_experimentNumber, m_recordingNumber);
+		EVERY_ENGINE->updateTimestamps(m_timestamps);
+		for (int eng = 0; eng < m_engineArray.size(); eng++)
+		{
+			if (!m_preparedEngines[eng])
+				m_engineArray[eng]->openFiles(m_rootFolder, m_experimentNumber, m_recordingNumber);
+		}
+		EVERY_ENGINE->recordingStarted();
+		createChannelRuns();
+		createWriteJobs();
 	}
-	//3-Normal loop
+	//4-Normal loop. Sleep until the audio thread has queued enough to be worth a write,
+	//or the maximum latency expires, instead of polling the queues
 	while (!threadShouldExit())
 	{
-		writeData(dataBuffer, BLOCK_MAX_WRITE_SAMPLES, BLOCK_MAX_WRITE_EVENTS, BLOCK_MAX_WRITE_SPIKES);
+		m_pendingSamples = 0;
+		m_pendingEvents = 0;
+		const int64 passStart = Time::getHighResolutionTicks();
+		bool morePending = writeData(dataBuffer, BLOCK_MAX_WRITE_SAMPLES, BLOCK_MAX_WRITE_EVENTS, BLOCK_MAX_WRITE_SPIKES);
+		m_loadMonitor.loopFinished(passStart);
+		if (!morePending && m_pendingSamples < m_wakeupSamples && m_pendingEvents < BLOCK_MAX_WRITE_EVENTS)
+			wait(m_maxLatencyMs);
 	}
-	std::cout << "Exiting record thread" << std::endl;
-	//4-Before closing the thread, try to write the remaining samples
+	RealtimeLog::write(RealtimeLog::LOG_INFO, "Exiting record thread");
+	//5-Before closing the thread, try to write the remaining samples
 	if (!closeEarly)
 	{
 		writeData(dataBuffer, -1, -1, -1, true);
 
-		std::cout << "Closing files" << std::endl;
-		//5-Close files
+		RealtimeLog::write(RealtimeLog::LOG_INFO, "Closing files");
+		//6-Close files
+		m_writerPool = nullptr;
+		m_writeJobs.clear();
 		EVERY_ENGINE->closeFiles();
 	}
+	else
+	{
+		//The recording never started, so the files created for it are removed
+		for (int eng = 0; eng < m_engineArray.size(); eng++)
+		{
+			if (m_preparedEngines[eng])
+				m_engineArray[eng]->discardFiles();
+		}
+	}
 	m_cleanExit = true;
 	m_receivedFirstBlock = false;
 }
 
-void RecordThread::writeData(const AudioSampleBuffer& dataBuffer, int maxSamples, int maxEvents, int maxSpikes, bool lastBlock)
+bool RecordThread::writeData(const AudioSampleBuffer& dataBuffer, int maxSamples, int maxEvents, int maxSpikes, bool lastBlock)
 {
-	Array<int64> timestamps;
-	Array<CircularBufferIndexes> idx;
-	m_dataQueue->startRead(idx, timestamps, maxSamples);
-	EVERY_ENGINE->updateTimestamps(timestamps);
+	TraceRecorder::Scope trace("RecordThread::writeData");
+	bool morePending = false;
+	m_dataQueue->startRead(m_indexes, m_timestamps, maxSamples, lastBlock);
+	//After the read, so the windows cover every sample it holds
+	if (m_snippetGate != nullptr)
+		m_snippetGate->updateWindows();
+	EVERY_ENGINE->updateTimestamps(m_timestamps);
 	EVERY_ENGINE->startChannelBlock(lastBlock);
+
+	//Timestamps of the second part of each channel, for when the circular buffer wraps
+	m_wrapTimestamps.resize(m_numChannels);
+	int64 numSamples = 0;
 	for (int chan = 0; chan < m_numChannels; ++chan)
 	{
-		if (idx[chan].size1 > 0)
+		const CircularBufferIndexes& idx = m_indexes.getReference(chan);
+		m_wrapTimestamps.set(chan, m_timestamps[chan] + idx.size1);
+		m_readPointers.set(chan, idx.size1 > 0 ? dataBuffer.getReadPointer(chan, idx.index1) : nullptr);
+		m_wrapReadPointers.set(chan, idx.size2 > 0 ? dataBuffer.getReadPointer(chan, idx.index2) : nullptr);
+		if (m_snippetGate != nullptr)
+			numSamples += m_snippetGate->getNumGatedSamples(m_dataQueue->getChannelGroup(chan), m_timestamps[chan], idx.size1 + idx.size2);
+		else
+			numSamples += idx.size1 + idx.size2;
+		if (maxSamples > 0 && (idx.size1 + idx.size2) >= maxSamples)
+			morePending = true;
+	}
+
+	if (m_writerPool != nullptr)
+	{
+		for (int i = 0; i < m_writeJobs.size(); ++i)
+			m_writerPool->addJob(m_writeJobs[i], false);
+		for (int i = 0; i < m_writeJobs.size(); ++i)
+			m_writerPool->waitForJobToFinish(m_writeJobs[i], -1);
+	}
+	else
+	{
+		for (int run = 0; run < m_channelRuns.size(); ++run)
 		{
-			EVERY_ENGINE->writeData(chan, m_channelArray[chan], dataBuffer.getReadPointer(chan, idx[chan].index1), idx[chan].size1);
-			if (idx[chan].size2 > 0)
-			{
-				timestamps.set(chan, timestamps[chan] + idx[chan].size1);
-				EVERY_ENGINE->updateTimestamps(timestamps, chan);
-				EVERY_ENGINE->writeData(chan, m_channelArray[chan], dataBuffer.getReadPointer(chan, idx[chan].index2), idx[chan].size2);
-			}
+			for (int eng = 0; eng < m_engineArray.size(); eng++)
+				writeRun(m_engineArray[eng], m_channelRuns.getReference(run));
 		}
 	}
 	m_dataQueue->stopRead();
 	EVERY_ENGINE->endChannelBlock(lastBlock);
+	if (m_snippetGate != nullptr)
+	{
+		for (int chan = 0; chan < m_numChannels; ++chan)
+		{
+			const CircularBufferIndexes& idx = m_indexes.getReference(chan);
+			m_snippetGate->discardWindowsBefore(m_dataQueue->getChannelGroup(chan), m_timestamps[chan] + idx.size1 + idx.size2);
+		}
+	}
+	int64 numBytes = numSamples * sizeof(int16);
 
-	std::vector<EventMessagePtr> events;
-	int nEvents = m_eventQueue->getEvents(events, maxEvents);
+	RecordNode* recordNode = AccessClass::getProcessorGraph()->getRecordNode();
+	int nEvents = m_eventQueue->startRead(maxEvents);
 	for (int ev = 0; ev < nEvents; ++ev)
 	{
-		const MidiMessage& event = events[ev]->getData();
+		const MidiMessage event(m_eventQueue->getData(ev), m_eventQueue->getDataSize(ev));
 		if (SystemEvent::getBaseType(event) == SYSTEM_EVENT)
 		{
 			uint16 sourceID = SystemEvent::getSourceID(event);
 			uint16 subProcIdx = SystemEvent::getSubProcessorIdx(event);
 			int64 timestamp = SystemEvent::getTimestamp(event);
 				EVERY_ENGINE->writeTimestampSyncText(sourceID, subProcIdx, timestamp,
-				AccessClass::getProcessorGraph()->getRecordNode()->getSourceTimestamp(sourceID, subProcIdx),
+				recordNode->getSourceTimestamp(sourceID, subProcIdx),
 				SystemEvent::getSyncText(event));
 		}
 		else
-			EVERY_ENGINE->writeEvent(events[ev]->getExtra(), events[ev]->getData());
+			EVERY_ENGINE->writeEvent(m_eventQueue->getExtra(ev), event);
+		numBytes += m_eventQueue->getDataSize(ev);
 	}
+	m_eventQueue->finishedRead();
 
-	std::vector<SpikeMessagePtr> spikes;
-	int nSpikes = m_spikeQueue->getEvents(spikes, maxSpikes);
+	int nSpikes = m_spikeQueue->startRead(maxSpikes);
 	for (int sp = 0; sp < nSpikes; ++sp)
 	{
-		EVERY_ENGINE->writeSpike(spikes[sp]->getExtra(), &spikes[sp]->getData());
+		int electrodeIndex = m_spikeQueue->getExtra(sp);
+		const MidiMessage msg(m_spikeQueue->getData(sp), m_spikeQueue->getDataSize(sp));
+		SpikeEventPtr spike = SpikeEvent::deserializeFromMessage(msg, recordNode->getSpikeChannel(electrodeIndex));
+		if (spike != nullptr)
+			EVERY_ENGINE->writeSpike(electrodeIndex, spike);
+		numBytes += m_spikeQueue->getDataSize(sp);
+	}
+	m_spikeQueue->finishedRead();
+	m_bytesWritten.fetch_add(numBytes * m_engineArray.size());
+
+	if ((maxEvents > 0 && nEvents >= maxEvents) || (maxSpikes > 0 && nSpikes >= maxSpikes))
+		morePending = true;
+
+	return morePending;
+}
+
+void RecordThread::writeRun(RecordEngine* engine, const ChannelRun& run)
+{
+	if (m_snippetGate != nullptr)
+	{
+		for (int i = 0; i < run.numChannels; ++i)
+			writeGatedChannel(engine, run.firstChannel + i);
+		return;
+	}
+
+	//The channels of a source share one FIFO, so they all have the same read indexes
+	const CircularBufferIndexes& idx = m_indexes.getReference(run.firstChannel);
+	if (idx.size1 > 0)
+	{
+		engine->writeDataBlock(run.firstChannel, run.numChannels, m_readPointers.getRawDataPointer() + run.firstChannel, idx.size1);
+		if (idx.size2 > 0)
+		{
+			for (int i = 0; i < run.numChannels; ++i)
+				engine->updateTimestamps(m_wrapTimestamps, run.firstChannel + i);
+			engine->writeDataBlock(run.firstChannel, run.numChannels, m_wrapReadPointers.getRawDataPointer() + run.firstChannel, idx.size2);
+		}
+	}
+}
+
+void RecordThread::writeGatedChannel(RecordEngine* engine, int chan)
+{
+	const AudioSampleBuffer& dataBuffer = m_dataQueue->getAudioBufferReference();
+	const CircularBufferIndexes& idx = m_indexes.getReference(chan);
+	const int numSamples = idx.size1 + idx.size2;
+	const int64 firstTimestamp = m_timestamps[chan];
+	Array<int64>& timestamps = *m_gateTimestamps[m_engineArray.indexOf(engine)];
+	const Array<SnippetGate::Window>& windows = m_snippetGate->getWindows(m_dataQueue->getChannelGroup(chan));
+
+	for (int w = 0; w < windows.size(); ++w)
+	{
+		const SnippetGate::Window& window = windows.getReference(w);
+		if (window.start - firstTimestamp >= numSamples)
+			break;
+		int start = int(jmax<int64>(0, window.start - firstTimestamp));
+		int end = int(jmin<int64>(numSamples, window.end - firstTimestamp));
+
+		//A range can span the circular buffer wrap
+		while (start < end)
+		{
+			int index, size;
+			if (start < idx.size1)
+			{
+				index = idx.index1 + start;
+				size = jmin(end, idx.size1) - start;
+			}
+			else
+			{
+				index = idx.index2 + start - idx.size1;
+				size = end - start;
+			}
+			timestamps.set(chan, firstTimestamp + start);
+			engine->updateTimestamps(timestamps, chan);
+			engine->writeData(chan, m_channelArray[chan], dataBuffer.getReadPointer(chan, index), size);
+			start += size;
+		}
 	}
 }
 
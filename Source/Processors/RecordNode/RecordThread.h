@@ -27,13 +27,17 @@
 #include "../../../JuceLibraryCode/JuceHeader.h"
 #include "EventQueue.h"
 #include "DataQueue.h"
+#include "../GenericProcessor/ThreadLoadMonitor.h"
 #include <atomic>
 
 #define BLOCK_MAX_WRITE_SAMPLES 4096
 #define BLOCK_MAX_WRITE_EVENTS 32
 #define BLOCK_MAX_WRITE_SPIKES 32
+#define RECORD_THREAD_WAKEUP_SAMPLES 1024
+#define RECORD_THREAD_MAX_LATENCY_MS 50
 
 class RecordEngine;
+class SnippetGate;
 
 
 class RecordThread : public Thread
@@ -43,15 +47,79 @@ public:
 	~RecordThread();
 	void setFileComponents(File rootFolder, int experimentNumber, int recordingNumber);
 	void setChannelMap(const Array<int>& channels);
+
+	/** Sets the recorded processor index of each recorded channel. Used to split the channels
+	in groups that can be written in parallel.*/
+	void setChannelGroups(const Array<int>& chanProcessor);
+
+	/** Sets the number of threads used to write continuous data. With more than one, each engine
+	gets its own job and engines that support it are further split by recorded processor.
+	Files keep their write order. Only applied when the thread is stopped.*/
+	void setNumWriterThreads(int numThreads);
+	int getNumWriterThreads() const;
 	void setQueuePointers(DataQueue* data, EventMsgQueue* events, SpikeMsgQueue* spikes);
 
+	/** Sets the gate that selects the continuous samples to write, or nullptr to write them all.
+	Only applied when the thread is stopped.*/
+	void setSnippetGate(SnippetGate* gate);
+
+	/** Opens the files of the engines that support it as soon as the thread starts, and the others
+	once the first block has arrived. The thread can thus be started ahead of the recording, and
+	stopping it before then removes the files it created.*/
 	void run() override;
 
 	void setFirstBlockFlag(bool state);
 	void forceCloseFiles();
 
+	/** Called from the audio thread after samples have been added to the data queue.
+	Wakes the thread once the pending samples reach the wakeup threshold.*/
+	void notifyDataWritten(int numSamples);
+
+	/** Called from the audio thread after an event or spike has been queued.
+	Wakes the thread once a full write block of events is pending.*/
+	void notifyEventWritten();
+
+	/** Sets how many pending samples wake the thread and the maximum time, in milliseconds,
+	the thread sleeps before flushing whatever is queued. Only applied when the thread is stopped.*/
+	void setWakeupParameters(int sampleThreshold, int maxLatencyMs);
+
+	/** Returns the maximum time, in milliseconds, the thread sleeps before flushing the queues*/
+	int getMaxLatencyMs() const;
+
+	/** Returns the number of bytes of continuous data, events and spikes handed to the
+	engines since the current or last recording started, counting samples as the 16 bit integers the
+	engines store. Safe to call from any thread.*/
+	int64 getNumBytesWritten() const;
+
+	/** Returns the write pass count and CPU time of the thread, see ThreadLoadMonitor.*/
+	ThreadLoadMonitor::Counters getLoadCounters() const;
+
 private:
-	void writeData(const AudioSampleBuffer& buffer, int maxSamples, int maxEvents, int maxSpikes, bool lastBlock = false);
+	class ChannelWriteJob;
+
+	/** Builds the list of write jobs for the current engines and channel groups*/
+	void createWriteJobs();
+
+	/** Consecutive channels of the same source and recorded processor, written with a single
+	RecordEngine::writeDataBlock call*/
+	struct ChannelRun
+	{
+		int firstChannel;
+		int numChannels;
+	};
+
+	/** Splits the channels into runs. Needs the channel groups of the data queue*/
+	void createChannelRuns();
+
+	/** Writes the current read block of a run of channels to an engine*/
+	void writeRun(RecordEngine* engine, const ChannelRun& run);
+
+	/** Writes the parts of the current read block of a channel that are inside the snippet windows*/
+	void writeGatedChannel(RecordEngine* engine, int chan);
+
+	/** Writes a block of queued data, events and spikes. Returns true if any of the queues
+	had more data than could be written in one pass.*/
+	bool writeData(const AudioSampleBuffer& buffer, int maxSamples, int maxEvents, int maxSpikes, bool lastBlock = false);
 
 	const OwnedArray<RecordEngine>& m_engineArray;
 	Array<int> m_channelArray;
@@ -59,10 +127,36 @@ private:
 	DataQueue* m_dataQueue;
 	EventMsgQueue* m_eventQueue;
 	SpikeMsgQueue *m_spikeQueue;
+	SnippetGate* m_snippetGate;
 
 	std::atomic<bool> m_receivedFirstBlock;
 	std::atomic<bool> m_cleanExit;
 
+	std::atomic<int> m_pendingSamples;
+	std::atomic<int> m_pendingEvents;
+	std::atomic<int64> m_bytesWritten;
+	ThreadLoadMonitor m_loadMonitor;
+	int m_wakeupSamples;
+	int m_maxLatencyMs;
+
+	Array<int> m_channelGroups;
+	Array<ChannelRun> m_channelRuns;
+	int m_numWriterThreads;
+	ScopedPointer<ThreadPool> m_writerPool;
+	OwnedArray<ChannelWriteJob> m_writeJobs;
+
+	//Reused between passes so the write loop does not allocate
+	Array<int64> m_timestamps;
+	Array<int64> m_wrapTimestamps;
+	//Where the two parts of each channel's read block start in the queue buffer
+	Array<const float*> m_readPointers;
+	Array<const float*> m_wrapReadPointers;
+	Array<CircularBufferIndexes> m_indexes;
+	//Timestamps of the snippet ranges, per engine as engines may be written from different threads
+	OwnedArray<Array<int64>> m_gateTimestamps;
+	//Engines whose files were opened before the first block, see RecordEngine::supportsPreparedFiles
+	Array<bool> m_preparedEngines;
+
 	File m_rootFolder;
 	int m_experimentNumber;
 	int m_recordingNumber;
@@ -0,0 +1,602 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "RoundTripBenchmark.h"
+#include "RecordNode.h"
+#include "RecordEngine.h"
+#include "RecordThread.h"
+#include "DataQueue.h"
+#include "../ProcessorGraph/ProcessorGraph.h"
+#include "../ProcessorManager/ProcessorManager.h"
+#include "../ProcessorManager/ProcessorBenchmark.h"
+#include "../ProcessorManager/BenchmarkHelpers.h"
+#include "../FileReader/FileReader.h"
+#include "../DataThreads/SampleConversion.h"
+#include "../../Audio/AudioComponent.h"
+#include "../../AccessClass.h"
+
+//Node IDs of the filter, detector and reader. The synthetic source takes the one before
+#define ROUNDTRIP_BENCHMARK_NODE_ID 860
+//Blocks the replay may return no samples for before it is given up
+#define ROUNDTRIP_BENCHMARK_MAX_STALLS 1000
+
+enum RoundTripStages
+{
+	SOURCE_STAGE = 0,
+	FILTER_STAGE,
+	DETECTOR_STAGE,
+	RECORD_QUEUE_STAGE,
+	REPLAY_STAGE
+};
+
+RoundTripBenchmarkSettings::RoundTripBenchmarkSettings() :
+	numChannels(64),
+	sampleRate(30000.0f),
+	blockSize(1024),
+	seconds(10.0),
+	numWriterThreads(1),
+	realtime(true),
+	keepFiles(false),
+	outputDirectory(File::getSpecialLocation(File::tempDirectory).getChildFile("open-ephys-benchmark"))
+{
+}
+
+void RoundTripBenchmarkSettings::parse(const StringArray& options)
+{
+	for (int i = 0; i < options.size(); ++i)
+	{
+		String key = options[i].upToFirstOccurrenceOf("=", false, false).toLowerCase();
+		String value = options[i].fromFirstOccurrenceOf("=", false, false);
+
+		if (key == "channels")
+			numChannels = jmax(4, value.getIntValue());
+		else if (key == "rate")
+			sampleRate = jmax(1.0f, value.getFloatValue());
+		else if (key == "block")
+			blockSize = jmax(1, value.getIntValue());
+		else if (key == "seconds")
+			seconds = jmax(0.1, value.getDoubleValue());
+		else if (key == "threads")
+			numWriterThreads = jmax(1, value.getIntValue());
+		else if (key == "realtime")
+			realtime = value.getIntValue() != 0;
+		else if (key == "keep")
+			keepFiles = value.getIntValue() != 0;
+		else if (key == "dir")
+			outputDirectory = File::getCurrentWorkingDirectory().getChildFile(value);
+		else
+			std::cerr << "Unknown round trip benchmark option " << options[i] << std::endl;
+	}
+}
+
+RoundTripBenchmark::Stage::Stage(const String& stageName) :
+	name(stageName),
+	totalTicks(0)
+{
+}
+
+void RoundTripBenchmark::Stage::add(int64 ticks)
+{
+	totalTicks += ticks;
+	blockTimes.addSample(ticks);
+}
+
+void RoundTripBenchmark::Fingerprint::reset(int numChannels)
+{
+	channels.clear();
+	for (int c = 0; c < numChannels; ++c)
+		channels.add(new FileChecksum());
+	scratchSize = 0;
+	numSamples = 0;
+	numSpikes = 0;
+	spikeTimestampSum = 0;
+}
+
+void RoundTripBenchmark::Fingerprint::addBlock(const AudioSampleBuffer& buffer, const Array<float>& scales, int blockSamples)
+{
+	if (blockSamples <= 0)
+		return;
+	if (blockSamples > scratchSize)
+	{
+		scratchSize = blockSamples;
+		scratch.malloc(scratchSize);
+	}
+
+	//Quantized the way the Binary format writes the samples, so both passes hash what is on disk
+	for (int c = 0; c < channels.size(); ++c)
+	{
+		SampleConversion::convertFloatToInt16(scratch, 1, buffer.getReadPointer(c), blockSamples, scales[c]);
+		channels[c]->update(scratch, size_t(blockSamples) * sizeof(int16));
+	}
+	numSamples += blockSamples;
+}
+
+void RoundTripBenchmark::Fingerprint::addSpike(int64 timestamp)
+{
+	//Electrodes are replayed one after another, so only an order free sum can be compared
+	numSpikes++;
+	spikeTimestampSum += timestamp;
+}
+
+RoundTripBenchmark::RoundTripBenchmark(const RoundTripBenchmarkSettings& settings) :
+	m_settings(settings),
+	m_recordNode(nullptr),
+	m_recordSeconds(0),
+	m_drainSeconds(0),
+	m_replaySeconds(0),
+	m_bytesOnDisk(0),
+	m_samplesDropped(0),
+	m_spikeOverruns(0),
+	m_replayUnderruns(0),
+	m_mismatchedChannels(0),
+	m_completed(false)
+{
+	m_recorded.reset(0);
+	m_replayed.reset(0);
+	m_stages.add(new Stage("Synthetic source"));
+	m_stages.add(new Stage("Bandpass Filter"));
+	m_stages.add(new Stage("Spike Detector"));
+	m_stages.add(new Stage("Record queues"));
+	m_stages.add(new Stage("File Reader replay"));
+}
+
+RoundTripBenchmark::~RoundTripBenchmark()
+{
+	tearDown();
+}
+
+GenericProcessor* RoundTripBenchmark::createProcessor(const String& name, int nodeId, GenericProcessor* source)
+{
+	const int pluginIndex = ProcessorBenchmark::findProcessor(name);
+	if (pluginIndex < 0)
+	{
+		std::cerr << "Round trip benchmark: no plugin processor named " << name << std::endl;
+		return nullptr;
+	}
+
+	ScopedPointer<GenericProcessor> processor = ProcessorManager::createProcessor(PluginProcessor, pluginIndex);
+	if (processor == nullptr)
+	{
+		std::cerr << "Round trip benchmark: could not create " << name << std::endl;
+		return nullptr;
+	}
+	processor->setNodeId(nodeId);
+	//update() also updates the editor, so it needs one as in the signal chain
+	processor->createEditor();
+	processor->setSourceNode(source);
+
+	ScopedPointer<XmlElement> processorSettings = ProcessorBenchmark::createDefaultSettings(name, m_settings.numChannels);
+	if (processorSettings != nullptr)
+	{
+		processor->parametersAsXml = processorSettings;
+		processor->loadFromXml();
+	}
+	else
+		processor->update();
+	processor->parametersAsXml = nullptr;
+
+	if (!processor->prepareForAcquisition() || !processor->isReady())
+	{
+		std::cerr << "Round trip benchmark: " << name << " is not ready with " << m_settings.numChannels << " channels" << std::endl;
+		return nullptr;
+	}
+	processor->enableEditor();
+	processor->enableProcessor();
+	return processor.release();
+}
+
+bool RoundTripBenchmark::setUpRecording()
+{
+	m_recordNode = AccessClass::getProcessorGraph()->getRecordNode();
+	if (m_recordNode == nullptr || m_recordNode->isRecording)
+	{
+		std::cerr << "Round trip benchmark: the record node is not available" << std::endl;
+		m_recordNode = nullptr;
+		return false;
+	}
+
+	m_source = new BenchmarkSource(ROUNDTRIP_BENCHMARK_NODE_ID - 1, m_settings.numChannels, m_settings.sampleRate);
+	m_source->enableProcessor();
+	m_filter = createProcessor("Bandpass Filter", ROUNDTRIP_BENCHMARK_NODE_ID, m_source);
+	if (m_filter == nullptr)
+		return false;
+	m_detector = createProcessor("Spike Detector", ROUNDTRIP_BENCHMARK_NODE_ID + 1, m_filter);
+	if (m_detector == nullptr)
+		return false;
+
+	//The Binary format, as it is the one BinaryFileSource reads back
+	for (int i = 0; i < RecordEngineManager::getNumOfBuiltInEngines(); ++i)
+	{
+		ScopedPointer<RecordEngineManager> manager = RecordEngineManager::createBuiltInEngineManager(i);
+		if (manager->getID() == "RAWBINARY")
+		{
+			m_manager = manager.release();
+			break;
+		}
+	}
+	if (m_manager == nullptr)
+	{
+		std::cerr << "Round trip benchmark: the Binary record engine is not available" << std::endl;
+		return false;
+	}
+	RecordEngine* engine = m_manager->instantiateEngine();
+	if (engine == nullptr)
+		return false;
+	engine->registerManager(m_manager);
+	m_engines.add(engine);
+
+	//Register the detector's outputs the same way the processor graph does, as in the
+	//record benchmark, so the engine reads their info objects from the record node
+	m_recordNode->resetConnections();
+	engine->resetChannels();
+	m_recordNode->registerProcessor(m_detector);
+	engine->registerProcessor(m_detector);
+
+	Array<int> chanProcessor;
+	Array<int> chanOrder;
+	OwnedArray<RecordProcessorInfo> procInfo;
+	RecordProcessorInfo* info = new RecordProcessorInfo();
+	info->processorId = m_detector->getNodeId();
+	for (int ch = 0; ch < m_settings.numChannels; ++ch)
+	{
+		m_recordNode->addInputChannel(m_detector, ch);
+		engine->addDataChannel(ch, m_recordNode->getDataChannel(ch));
+		m_channelMap.add(ch);
+		chanProcessor.add(0);
+		chanOrder.add(ch);
+		info->recordedChannels.add(ch);
+		m_scales.add(1.0f / m_recordNode->getDataChannel(ch)->getBitVolts());
+	}
+	procInfo.add(info);
+	m_recordNode->addInputChannel(m_detector, AudioProcessorGraph::midiChannelIndex);
+
+	m_recordNode->registerSpikeSource(m_detector);
+	engine->registerSpikeSource(m_detector);
+	size_t spikeSlotSize = EVENT_BUFFER_MIN_SLOT_SIZE;
+	for (int i = 0; i < m_detector->getTotalSpikeChannels(); ++i)
+	{
+		const SpikeChannel* chan = m_detector->getSpikeChannel(i);
+		int index = m_recordNode->addSpikeElectrode(chan);
+		engine->addSpikeElectrode(index, m_recordNode->getSpikeChannel(index));
+		m_electrodeIndexes.add(index);
+		spikeSlotSize = jmax(spikeSlotSize, chan->getWaveformDataSize() + chan->getTotalEventMetaDataSize() + SPIKE_BASE_SIZE
+			+ chan->getNumChannels()*sizeof(float));
+	}
+
+	engine->configureEngine();
+	engine->startAcquisition();
+	engine->setChannelMapping(m_channelMap, chanProcessor, chanOrder, procInfo);
+
+	m_dataQueue = new DataQueue(WRITE_BLOCK_LENGTH, DATA_BUFFER_NBLOCKS);
+	m_dataQueue->setChannels(chanProcessor);
+	m_eventQueue = new EventMsgQueue(EVENT_BUFFER_NEVENTS, EVENT_BUFFER_MIN_SLOT_SIZE);
+	m_spikeQueue = new SpikeMsgQueue(SPIKE_BUFFER_NSPIKES, int(spikeSlotSize));
+
+	m_rootFolder = m_settings.outputDirectory.getChildFile("roundtrip_" + Time::getCurrentTime().formatted("%Y-%m-%d_%H-%M-%S"));
+	Result res = m_rootFolder.createDirectory();
+	if (res.failed())
+	{
+		std::cerr << "Round trip benchmark: cannot create " << m_rootFolder.getFullPathName() << ": " << res.getErrorMessage() << std::endl;
+		return false;
+	}
+
+	m_recordThread = new RecordThread(m_engines);
+	m_recordThread->setQueuePointers(m_dataQueue, m_eventQueue, m_spikeQueue);
+	m_recordThread->setFileComponents(m_rootFolder, 1, 0);
+	m_recordThread->setChannelMap(m_channelMap);
+	m_recordThread->setChannelGroups(chanProcessor);
+	m_recordThread->setNumWriterThreads(m_settings.numWriterThreads);
+	m_recordThread->setFirstBlockFlag(false);
+
+	m_recorded.reset(m_settings.numChannels);
+	return true;
+}
+
+void RoundTripBenchmark::queueSpikes(const MidiBuffer& eventBuffer)
+{
+	MidiBuffer::Iterator i(eventBuffer);
+	MidiMessage message;
+	int samplePosition;
+
+	while (i.getNextEvent(message, samplePosition))
+	{
+		if (EventBase::getBaseType(message) != SPIKE_EVENT)
+			continue;
+
+		EventBasePtr event = EventBase::deserializeFromMessage(message, m_detector);
+		const SpikeEvent* spike = static_cast<const SpikeEvent*>(event.get());
+		if (spike == nullptr)
+			continue;
+
+		int electrode = m_detector->getSpikeChannelIndex(spike);
+		if (electrode < 0 || electrode >= m_electrodeIndexes.size())
+			continue;
+		if (m_spikeQueue->addEvent(*spike, spike->getTimestamp(), m_electrodeIndexes[electrode]))
+			m_recorded.addSpike(spike->getTimestamp());
+	}
+}
+
+bool RoundTripBenchmark::record()
+{
+	const int blockSize = m_settings.blockSize;
+	const int numBlocks = jmax(1, roundToInt(m_settings.seconds * m_settings.sampleRate / blockSize));
+	const double blockMs = 1000.0 * blockSize / m_settings.sampleRate;
+
+	AudioSampleBuffer buffer(jmax(m_settings.numChannels, m_detector->getNumOutputs()), blockSize);
+	buffer.clear();
+	MidiBuffer eventBuffer;
+	eventBuffer.ensureSize(65536);
+	GenericProcessor* chain[] = { m_source, m_filter, m_detector };
+	int64 timestamp = 0;
+
+	m_recordThread->startThread();
+	double start = Time::getMillisecondCounterHiRes();
+	for (int block = 0; block < numBlocks; ++block)
+	{
+		if (m_settings.realtime)
+		{
+			double wait = start + block * blockMs - Time::getMillisecondCounterHiRes();
+			if (wait >= 1.0)
+				Thread::sleep(int(wait));
+		}
+		else
+		{
+			//Keep half the queue free so the measured rate is the chain's, not the drop rate
+			while (m_dataQueue->getStats().fillFraction > 0.5f)
+				Thread::sleep(1);
+		}
+
+		eventBuffer.clear();
+		for (int p = SOURCE_STAGE; p <= DETECTOR_STAGE; ++p)
+		{
+			int64 begin = Time::getHighResolutionTicks();
+			BenchmarkHelpers::processBlock(*chain[p], buffer, eventBuffer);
+			m_stages[p]->add(Time::getHighResolutionTicks() - begin);
+		}
+
+		int64 begin = Time::getHighResolutionTicks();
+		m_dataQueue->writeGroup(buffer, 0, m_channelMap, blockSize, timestamp);
+		m_recordThread->notifyDataWritten(blockSize);
+		queueSpikes(eventBuffer);
+		m_stages[RECORD_QUEUE_STAGE]->add(Time::getHighResolutionTicks() - begin);
+		if (block == 0)
+			m_recordThread->setFirstBlockFlag(true);
+
+		m_recorded.addBlock(buffer, m_scales, blockSize);
+		timestamp += blockSize;
+	}
+	double produced = Time::getMillisecondCounterHiRes();
+
+	m_recordThread->signalThreadShouldExit();
+	m_recordThread->waitForThreadToExit(-1);
+	double end = Time::getMillisecondCounterHiRes();
+
+	m_recordSeconds = (end - start) / 1000.0;
+	m_drainSeconds = (end - produced) / 1000.0;
+	m_samplesDropped = m_dataQueue->getStats().samplesDropped;
+	m_spikeOverruns = m_spikeQueue->getNumOverruns();
+
+	for (int p = FILTER_STAGE; p <= DETECTOR_STAGE; ++p)
+	{
+		chain[p]->disableEditor();
+		chain[p]->disableProcessor();
+	}
+
+	//Close the files before they are read back
+	m_recordThread = nullptr;
+	m_engines.clear();
+	m_recordNode->resetConnections();
+
+	Array<File> files;
+	m_rootFolder.findChildFiles(files, File::findFiles, true);
+	for (int i = 0; i < files.size(); ++i)
+		m_bytesOnDisk += files[i].getSize();
+	return true;
+}
+
+bool RoundTripBenchmark::replay()
+{
+	Array<File> structureFiles;
+	m_rootFolder.findChildFiles(structureFiles, File::findFiles, true, "structure.oebin");
+	if (structureFiles.size() != 1)
+	{
+		std::cerr << "Round trip benchmark: found " << structureFiles.size() << " recordings in " << m_rootFolder.getFullPathName() << std::endl;
+		return false;
+	}
+
+	//FileReader plays at the device's block size and rate, and can only output as many samples as a block holds
+	AudioComponent* audio = AccessClass::getAudioComponent();
+	const int blockSize = audio->getBufferSize() > 0 ? audio->getBufferSize() : 1024;
+	if (audio->getSampleRate() < m_settings.sampleRate)
+	{
+		std::cerr << "Round trip benchmark: the audio device runs at " << audio->getSampleRate()
+			<< " Hz, replaying " << m_settings.sampleRate << " Hz needs at least as much" << std::endl;
+		return false;
+	}
+
+	m_reader = new FileReader();
+	m_reader->setNodeId(ROUNDTRIP_BENCHMARK_NODE_ID + 2);
+	m_reader->createEditor();
+	if (!m_reader->setFile(structureFiles[0].getFullPathName()))
+	{
+		std::cerr << "Round trip benchmark: File Reader could not open " << structureFiles[0].getFullPathName() << std::endl;
+		return false;
+	}
+	m_reader->setBatchMode(true);
+	m_reader->update();
+	if (!m_reader->isReady())
+		return false;
+	m_reader->enableEditor();
+	m_reader->enableProcessor();
+
+	const int numChannels = m_reader->getNumOutputs();
+	Array<float> scales;
+	for (int c = 0; c < numChannels; ++c)
+		scales.add(1.0f / m_reader->getDataChannel(c)->getBitVolts());
+	m_replayed.reset(numChannels);
+
+	AudioSampleBuffer buffer(jmax(1, numChannels), blockSize);
+	buffer.clear();
+	MidiBuffer eventBuffer;
+	eventBuffer.ensureSize(65536);
+	Stage& stage = *m_stages[REPLAY_STAGE];
+	int64 played = 0;
+	int stalls = 0;
+	bool ok = true;
+
+	double start = Time::getMillisecondCounterHiRes();
+	while (!m_reader->hasReachedEnd())
+	{
+		eventBuffer.clear();
+		int64 begin = Time::getHighResolutionTicks();
+		BenchmarkHelpers::processBlock(*m_reader, buffer, eventBuffer);
+		stage.add(Time::getHighResolutionTicks() - begin);
+
+		const int64 total = m_reader->getNumSamplesPlayed();
+		const int numSamples = int(total - played);
+		played = total;
+		m_replayed.addBlock(buffer, scales, numSamples);
+
+		MidiBuffer::Iterator i(eventBuffer);
+		MidiMessage message;
+		int samplePosition;
+		while (i.getNextEvent(message, samplePosition))
+		{
+			if (EventBase::getBaseType(message) != SPIKE_EVENT)
+				continue;
+			EventBasePtr spike = EventBase::deserializeFromMessage(message, m_reader);
+			if (spike != nullptr)
+				m_replayed.addSpike(spike->getTimestamp());
+		}
+
+		stalls = numSamples > 0 ? 0 : stalls + 1;
+		if (stalls > ROUNDTRIP_BENCHMARK_MAX_STALLS)
+		{
+			std::cerr << "Round trip benchmark: File Reader stopped after " << played << " samples" << std::endl;
+			ok = false;
+			break;
+		}
+	}
+	m_replaySeconds = (Time::getMillisecondCounterHiRes() - start) / 1000.0;
+	m_replayUnderruns = m_reader->getNumUnderruns();
+
+	m_reader->disableEditor();
+	m_reader->disableProcessor();
+
+	m_mismatchedChannels = 0;
+	for (int c = 0; c < jmax(m_recorded.channels.size(), m_replayed.channels.size()); ++c)
+	{
+		const FileChecksum* recorded = m_recorded.channels[c];
+		const FileChecksum* replayed = m_replayed.channels[c];
+		if (recorded == nullptr || replayed == nullptr || recorded->getValue() != replayed->getValue()
+			|| recorded->getNumBytes() != replayed->getNumBytes())
+			m_mismatchedChannels++;
+	}
+	return ok;
+}
+
+void RoundTripBenchmark::tearDown()
+{
+	if (m_recordThread != nullptr && m_recordThread->isThreadRunning())
+	{
+		m_recordThread->signalThreadShouldExit();
+		m_recordThread->waitForThreadToExit(-1);
+	}
+	m_recordThread = nullptr;
+	m_engines.clear();
+
+	if (m_recordNode != nullptr)
+		m_recordNode->resetConnections();
+	m_recordNode = nullptr;
+
+	m_reader = nullptr;
+	m_detector = nullptr;
+	m_filter = nullptr;
+	m_source = nullptr;
+
+	if (!m_settings.keepFiles && m_rootFolder.isDirectory())
+		m_rootFolder.deleteRecursively();
+}
+
+bool RoundTripBenchmark::run()
+{
+	m_completed = false;
+	bool ok = setUpRecording() && record() && replay();
+	m_completed = ok;
+	tearDown();
+	return ok;
+}
+
+bool RoundTripBenchmark::hasPassed() const
+{
+	return m_completed
+		&& m_samplesDropped == 0
+		&& m_spikeOverruns == 0
+		&& m_mismatchedChannels == 0
+		&& m_recorded.numSamples == m_replayed.numSamples
+		&& m_recorded.numSpikes == m_replayed.numSpikes
+		&& m_recorded.spikeTimestampSum == m_replayed.spikeTimestampSum;
+}
+
+void RoundTripBenchmark::printReport(std::ostream& out) const
+{
+	out << "Round trip benchmark: " << m_settings.numChannels << " channels, " << m_settings.sampleRate << " Hz, "
+		<< m_settings.blockSize << " sample blocks, " << m_settings.seconds << " s, "
+		<< (m_settings.realtime ? "paced" : "unpaced") << ", " << m_settings.numWriterThreads << " writer threads" << std::endl;
+
+	for (int p = 0; p < m_stages.size(); ++p)
+	{
+		const Stage& stage = *m_stages[p];
+		const int64 samples = p == REPLAY_STAGE ? m_replayed.numSamples : m_recorded.numSamples;
+		const int numChannels = p == REPLAY_STAGE ? m_replayed.channels.size() : m_settings.numChannels;
+		const double seconds = jmax(1e-9, Time::highResolutionTicksToSeconds(stage.totalTicks));
+		const ProcessTimeStatistics::Summary summary = stage.blockTimes.getSummary();
+
+		out << "  " << stage.name << ": " << double(samples) * numChannels / seconds / 1e6 << " Msamples/s, "
+			<< samples / m_settings.sampleRate / seconds << "x realtime, "
+			<< 1000.0 * seconds / jmax<int64>(1, summary.numBlocks) << " ms/block mean, " << summary.p99Ms << " ms p99" << std::endl;
+	}
+
+	const double payloadBytes = double(m_recorded.numSamples) * m_settings.numChannels * sizeof(int16);
+	out << "  Writer: " << m_bytesOnDisk << " bytes on disk, " << payloadBytes / jmax(1e-9, m_recordSeconds) / 1e6
+		<< " MB/s over the record pass, " << m_drainSeconds << " s drain after the last block" << std::endl;
+	out << "  Replay: " << m_replayed.numSamples / m_settings.sampleRate / jmax(1e-9, m_replaySeconds)
+		<< "x realtime overall, " << m_replayUnderruns << " underruns" << std::endl;
+	out << "  Dropped: " << m_samplesDropped << " samples, " << m_spikeOverruns << " spikes" << std::endl;
+	out << "  Continuous: " << m_recorded.numSamples << " samples per channel recorded, " << m_replayed.numSamples << " replayed, "
+		<< m_mismatchedChannels << " of " << m_settings.numChannels << " channels differ" << std::endl;
+	out << "  Spikes: " << m_recorded.numSpikes << " recorded, " << m_replayed.numSpikes << " replayed, timestamps "
+		<< (m_recorded.spikeTimestampSum == m_replayed.spikeTimestampSum ? "match" : "differ") << std::endl;
+	out << "Round trip: " << (hasPassed() ? "PASS" : "FAIL") << std::endl;
+}
+
+bool RoundTripBenchmark::runFromCommandLine(const StringArray& options)
+{
+	RoundTripBenchmarkSettings settings;
+	settings.parse(options);
+
+	RoundTripBenchmark benchmark(settings);
+	benchmark.run();
+	benchmark.printReport(std::cout);
+	return benchmark.hasPassed();
+}
@@ -0,0 +1,173 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ROUNDTRIPBENCHMARK_H_INCLUDED
+#define ROUNDTRIPBENCHMARK_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "EventQueue.h"
+#include "FileChecksum.h"
+#include "../GenericProcessor/ProcessTimeStatistics.h"
+
+class GenericProcessor;
+class RecordEngine;
+class RecordEngineManager;
+class RecordThread;
+class DataQueue;
+class RecordNode;
+class FileReader;
+
+struct RoundTripBenchmarkSettings
+{
+	RoundTripBenchmarkSettings();
+
+	/** Reads "key=value" options, e.g. channels=384 seconds=60. Unknown keys are reported and ignored*/
+	void parse(const StringArray& options);
+
+	int numChannels;
+	float sampleRate;
+	int blockSize;
+	double seconds;
+	int numWriterThreads;
+	bool realtime;
+	bool keepFiles;
+	File outputDirectory;
+};
+
+/**
+
+  Records a synthetic signal chain and plays the recording back, to qualify a build or a rig
+  configuration with a single pass or fail.
+
+  The record pass runs the synthetic source of the processor benchmark through the bandpass
+  filter and spike detector plugins, and hands the continuous data and the detected spikes
+  to a RecordThread writing the Binary format, as the RecordNode would. Blocks are produced at
+  the sample rate (realtime=1, the default) or back to back for a fixed amount of data.
+
+  The replay pass opens the recording in a FileReader in batch mode, which reads it through
+  BinaryFileSource as fast as it can, and runs it back to back on the calling thread.
+
+  The report gives the throughput of every stage, the samples and spikes the record queues
+  dropped, and whether the replay is bit exact: the CRC-32C of every channel, quantized to the
+  int16 steps that are written, must match between the record and replay passes, as must the
+  number of samples and the number and timestamps of the spikes. The run passes when nothing
+  was dropped and everything matched.
+
+  Started from the command line with --benchmark-roundtrip [key=value ...]
+
+  @see RecordBenchmark, ProcessorBenchmark, FileReader
+
+*/
+class RoundTripBenchmark
+{
+public:
+	RoundTripBenchmark(const RoundTripBenchmarkSettings& settings);
+	~RoundTripBenchmark();
+
+	/** Runs both passes on the calling thread. Returns false if they could not be set up*/
+	bool run();
+
+	/** True if the last run dropped nothing and replayed exactly what was recorded*/
+	bool hasPassed() const;
+
+	/** Writes the results of the last run*/
+	void printReport(std::ostream& out) const;
+
+	/** Parses the options, runs the benchmark and prints the report to stdout. Returns hasPassed()*/
+	static bool runFromCommandLine(const StringArray& options);
+
+private:
+	/** Time spent in one stage, over all its blocks*/
+	struct Stage
+	{
+		Stage(const String& stageName);
+
+		void add(int64 ticks);
+
+		String name;
+		int64 totalTicks;
+		ProcessTimeStatistics blockTimes;
+	};
+
+	/** Per channel checksums of the int16 samples, and the spikes, seen by one pass*/
+	struct Fingerprint
+	{
+		void reset(int numChannels);
+		void addBlock(const AudioSampleBuffer& buffer, const Array<float>& scales, int numSamples);
+		void addSpike(int64 timestamp);
+
+		OwnedArray<FileChecksum> channels;
+		HeapBlock<int16> scratch;
+		int scratchSize;
+		int64 numSamples;
+		int numSpikes;
+		int64 spikeTimestampSum;
+	};
+
+	bool setUpRecording();
+	bool record();
+	bool replay();
+	void tearDown();
+
+	/** Queues the spikes the detector added to the block*/
+	void queueSpikes(const MidiBuffer& eventBuffer);
+
+	/** Creates a plugin processor fed by source, configured as the processor benchmark does*/
+	GenericProcessor* createProcessor(const String& name, int nodeId, GenericProcessor* source);
+
+	const RoundTripBenchmarkSettings m_settings;
+
+	RecordNode* m_recordNode;
+	ScopedPointer<GenericProcessor> m_source;
+	ScopedPointer<GenericProcessor> m_filter;
+	ScopedPointer<GenericProcessor> m_detector;
+	ScopedPointer<RecordEngineManager> m_manager;
+	OwnedArray<RecordEngine> m_engines;
+	ScopedPointer<RecordThread> m_recordThread;
+	ScopedPointer<DataQueue> m_dataQueue;
+	ScopedPointer<EventMsgQueue> m_eventQueue;
+	ScopedPointer<SpikeMsgQueue> m_spikeQueue;
+	Array<int> m_channelMap;
+	Array<int> m_electrodeIndexes;
+	Array<float> m_scales;
+	File m_rootFolder;
+	ScopedPointer<FileReader> m_reader;
+
+	//Results
+	OwnedArray<Stage> m_stages;
+	Fingerprint m_recorded;
+	Fingerprint m_replayed;
+	double m_recordSeconds;
+	double m_drainSeconds;
+	double m_replaySeconds;
+	int64 m_bytesOnDisk;
+	int64 m_samplesDropped;
+	int m_spikeOverruns;
+	int m_replayUnderruns;
+	int m_mismatchedChannels;
+	bool m_completed;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RoundTripBenchmark);
+};
+
+#endif  // ROUNDTRIPBENCHMARK_H_INCLUDED
@@ -0,0 +1,151 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SnippetGate.h"
+
+SnippetGate::SnippetGate() :
+m_fifo(SNIPPET_TRIGGER_QUEUE_SIZE),
+m_overruns(0),
+m_numSnippets(0)
+{
+	m_triggers.malloc(SNIPPET_TRIGGER_QUEUE_SIZE);
+}
+
+SnippetGate::~SnippetGate()
+{}
+
+void SnippetGate::setWindows(const Array<int>& preSamples, const Array<int>& postSamples)
+{
+	m_preSamples = preSamples;
+	m_postSamples = postSamples;
+	m_windows.clear();
+	for (int i = 0; i < preSamples.size(); ++i)
+		m_windows.add(new Array<Window>());
+	m_fifo.reset();
+	m_overruns = 0;
+	m_numSnippets = 0;
+}
+
+const Array<int>& SnippetGate::getPreSamples() const
+{
+	return m_preSamples;
+}
+
+void SnippetGate::addTrigger(int group, int64 timestamp)
+{
+	const SpinLock::ScopedLockType lock(m_writeLock);
+	int index1, size1, index2, size2;
+	m_fifo.prepareToWrite(1, index1, size1, index2, size2);
+	if (size1 + size2 < 1)
+	{
+		++m_overruns;
+		return;
+	}
+	Trigger& trigger = m_triggers[size1 > 0 ? index1 : index2];
+	trigger.group = group;
+	trigger.timestamp = timestamp;
+	m_fifo.finishedWrite(1);
+}
+
+void SnippetGate::updateWindows()
+{
+	int index1, size1, index2, size2;
+	m_fifo.prepareToRead(m_fifo.getNumReady(), index1, size1, index2, size2);
+	for (int i = 0; i < size1 + size2; ++i)
+	{
+		const Trigger& trigger = m_triggers[i < size1 ? index1 + i : index2 + i - size1];
+		if (trigger.group >= 0 && trigger.group < m_windows.size())
+			addWindow(trigger.group, trigger.timestamp - m_preSamples[trigger.group], trigger.timestamp + m_postSamples[trigger.group] + 1);
+	}
+	m_fifo.finishedRead(size1 + size2);
+}
+
+void SnippetGate::addWindow(int group, int64 start, int64 end)
+{
+	Array<Window>& windows = *m_windows[group];
+
+	//Triggers mostly arrive in order, so search from the end
+	int i = windows.size();
+	while (i > 0 && windows.getReference(i - 1).start > start)
+		--i;
+
+	if (i > 0 && windows.getReference(i - 1).end >= start)
+	{
+		--i;
+		windows.getReference(i).end = jmax(windows.getReference(i).end, end);
+	}
+	else
+	{
+		Window window = { start, end };
+		windows.insert(i, window);
+		++m_numSnippets;
+	}
+
+	//The window may now reach the ones after it
+	Window& merged = windows.getReference(i);
+	while (i + 1 < windows.size() && windows.getReference(i + 1).start <= merged.end)
+	{
+		merged.end = jmax(merged.end, windows.getReference(i + 1).end);
+		windows.remove(i + 1);
+		--m_numSnippets;
+	}
+}
+
+const Array<SnippetGate::Window>& SnippetGate::getWindows(int group) const
+{
+	return *m_windows[group];
+}
+
+int SnippetGate::getNumGatedSamples(int group, int64 timestamp, int numSamples) const
+{
+	const Array<Window>& windows = *m_windows[group];
+	int64 end = timestamp + numSamples;
+	int64 count = 0;
+	for (int i = 0; i < windows.size(); ++i)
+	{
+		const Window& window = windows.getReference(i);
+		if (window.start >= end)
+			break;
+		count += jmax<int64>(0, jmin(window.end, end) - jmax(window.start, timestamp));
+	}
+	return int(count);
+}
+
+void SnippetGate::discardWindowsBefore(int group, int64 timestamp)
+{
+	Array<Window>& windows = *m_windows[group];
+	int n = 0;
+	while (n < windows.size() && windows.getReference(n).end <= timestamp)
+		++n;
+	windows.removeRange(0, n);
+}
+
+int SnippetGate::getNumSnippets() const
+{
+	return m_numSnippets;
+}
+
+int SnippetGate::getNumOverruns() const
+{
+	return m_overruns.load();
+}
@@ -0,0 +1,108 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SNIPPETGATE_H_INCLUDED
+#define SNIPPETGATE_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include <atomic>
+
+#define SNIPPET_TRIGGER_QUEUE_SIZE 4096
+
+/**
+	Decides which continuous samples are written when recording only snippets around events.
+
+	The audio thread adds a trigger for every source group, in the timestamps of that group,
+	and the record thread turns them into windows of samples from preSamples before to
+	postSamples after each trigger, merging the windows that overlap. As the data waiting
+	in the queue must have all the triggers that could open a window over it, the queue
+	holds back the last preSamples of each group until the recording ends.
+
+	@see RecordThread, DataQueue
+*/
+class SnippetGate
+{
+public:
+	/** Samples [start, end) of a group, in its timestamps */
+	struct Window
+	{
+		int64 start;
+		int64 end;
+	};
+
+	SnippetGate();
+	~SnippetGate();
+
+	/** Sets the window of every group, in samples, and clears all triggers and windows.
+	Only call while no thread uses the gate */
+	void setWindows(const Array<int>& preSamples, const Array<int>& postSamples);
+
+	/** Samples before each trigger, per group */
+	const Array<int>& getPreSamples() const;
+
+	/** Queues a trigger for a group. Called from the audio threads, never allocates */
+	void addTrigger(int group, int64 timestamp);
+
+	//Only the methods after this comment may be called from the record thread,
+	//and must not be called while the writer threads use the windows
+	/** Turns the triggers queued so far into windows */
+	void updateWindows();
+
+	/** Merged windows of a group, in timestamp order */
+	const Array<Window>& getWindows(int group) const;
+
+	/** Number of samples from timestamp on that fall inside a window */
+	int getNumGatedSamples(int group, int64 timestamp, int numSamples) const;
+
+	/** Forgets the windows that end at or before timestamp */
+	void discardWindowsBefore(int group, int64 timestamp);
+
+	/** Number of snippets opened, after merging, since the windows were set */
+	int getNumSnippets() const;
+	/** Number of triggers lost because the trigger queue was full */
+	int getNumOverruns() const;
+
+private:
+	struct Trigger
+	{
+		int group;
+		int64 timestamp;
+	};
+
+	void addWindow(int group, int64 start, int64 end);
+
+	AbstractFifo m_fifo;
+	HeapBlock<Trigger> m_triggers;
+	//Spikes can come from other threads than the events
+	SpinLock m_writeLock;
+	std::atomic<int> m_overruns;
+
+	Array<int> m_preSamples;
+	Array<int> m_postSamples;
+	OwnedArray<Array<Window>> m_windows;
+	int m_numSnippets;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SnippetGate);
+};
+
+#endif  // SNIPPETGATE_H_INCLUDED
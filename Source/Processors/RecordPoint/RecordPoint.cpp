@@ -2,7 +2,7 @@
     ------------------------------------------------------------------
 
     This file is part of the Open Ephys GUI
-    Copyright (C) 2013 Open Ephys
+    Copyright (C) 2014 Open Ephys
 
     ------------------------------------------------------------------
 
@@ -21,39 +21,26 @@
 
 */
 
-#include "LfpDisplayEditor.h"
-
-using namespace LfpDisplayNodeBeta;
-
-
-LfpDisplayEditor::LfpDisplayEditor(GenericProcessor* parentNode, bool useDefaultParameterEditors=true)
-    : VisualizerEditor(parentNode, useDefaultParameterEditors)
+#include "RecordPoint.h"
 
+RecordPoint::RecordPoint()
+    : GenericProcessor ("Record Point"), numKnownChannels (0)
 {
-
-    tabText = "LFP";
-
-    desiredWidth = 180;
-
+    // not a utility, so the processor graph connects it to the RecordNode
+    setProcessorType (PROCESSOR_TYPE_FILTER);
 }
 
-LfpDisplayEditor::~LfpDisplayEditor()
+RecordPoint::~RecordPoint()
 {
 }
 
-
-Visualizer* LfpDisplayEditor::createNewCanvas()
+void RecordPoint::process (AudioSampleBuffer& buffer)
 {
-
-    LfpDisplayNode* processor = (LfpDisplayNode*) getProcessor();
-    return new LfpDisplayCanvas(processor);
-
 }
 
-// not really being used (yet)...
-void LfpDisplayEditor::buttonEvent(Button* button)
+void RecordPoint::updateSettings()
 {
-
-
+    for (int i = numKnownChannels; i < dataChannelArray.size(); i++)
+        dataChannelArray[i]->setRecordState (true);
+    numKnownChannels = jmax (numKnownChannels, dataChannelArray.size());
 }
-
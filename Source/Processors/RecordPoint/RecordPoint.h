@@ -0,0 +1,63 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef RECORDPOINT_H_INCLUDED
+#define RECORDPOINT_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../GenericProcessor/GenericProcessor.h"
+
+/**
+    Marks a point of the signal chain to record from.
+
+    The channels are passed on untouched, and as the processor neither writes to
+    its buffer nor emits events the graph hands its inputs straight on, without
+    copies. Like every processor, its channels are connected to the RecordNode,
+    which records them in their own files, named after the record point, next
+    to those of any other point. New channels are set to record, so a point
+    placed after a filter records the filtered data with no further setup while
+    the source keeps recording the raw data. All points are written by the same
+    record thread.
+
+    @see RecordNode
+*/
+class RecordPoint : public GenericProcessor
+{
+public:
+    RecordPoint();
+    ~RecordPoint();
+
+    void process (AudioSampleBuffer& buffer) override;
+    bool modifiesContinuousData() const override { return false; }
+    bool emitsEvents() const override { return false; }
+
+    void updateSettings() override;
+
+private:
+    /** Channels seen in earlier updates, which keep the record state set on them */
+    int numKnownChannels;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RecordPoint);
+};
+
+#endif  // RECORDPOINT_H_INCLUDED
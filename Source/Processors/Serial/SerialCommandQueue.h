@@ -0,0 +1,300 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __SERIALCOMMANDQUEUE_H_4D2B9E61__
+#define __SERIALCOMMANDQUEUE_H_4D2B9E61__
+
+#include <JuceHeader.h>
+#include "../../CoreServices.h"
+
+/**
+    Sends commands to a serial device from a thread of its own, so that slow or stalled
+    writes never hold up the audio callback.
+
+    The audio thread queues commands with push(), which never blocks, and the worker thread
+    passes them to sendCommand() in order. The time from push() until sendCommand() returns
+    is measured for every command that was sent.
+
+    Commands queued with pushAt() are held until the global timestamp reaches their target,
+    e.g. a number of samples after the event that caused them, and sent as close to it as
+    the clock allows. How far from the target each of them was actually sent is written to
+    the recording as a MessageCenter message, and summed up in getStatistics(). Scheduled
+    commands still waiting when the queue is stopped are dropped.
+
+    CommandType must be a plain copyable struct. Only one thread may push at a time, and the
+    subclass must call stop() in its destructor, since sendCommand() is virtual.
+
+    @see ArduinoOutput, PulsePalOutput
+*/
+template <typename CommandType>
+class SerialCommandQueue : private Thread
+{
+public:
+    SerialCommandQueue (const String& threadName, int capacity)
+        : Thread (threadName)
+        , fifo (capacity)
+        , numSent (0)
+        , numSkipped (0)
+        , numDropped (0)
+        , totalLatencyTicks (0)
+        , maxLatencyTicks (0)
+        , numScheduled (0)
+        , totalJitter (0)
+        , maxJitter (0)
+    {
+        commands.malloc (capacity);
+    }
+
+    virtual ~SerialCommandQueue()
+    {
+        jassert (! isThreadRunning());
+    }
+
+    /** Empties the queue, resets the statistics and starts the worker thread. */
+    void start()
+    {
+        stop();
+
+        fifo.reset();
+        numSent = 0;
+        numSkipped = 0;
+        numDropped = 0;
+        totalLatencyTicks = 0;
+        maxLatencyTicks = 0;
+        numScheduled = 0;
+        totalJitter = 0;
+        maxJitter = 0;
+
+        startThread (8);
+    }
+
+    /** Sends the commands still queued and stops the worker thread. Commands pushed
+        afterwards are kept until resume() or dropped by start(). */
+    void stop()
+    {
+        signalThreadShouldExit();
+        commandAvailable.signal();
+        stopThread (2000);
+    }
+
+    /** Restarts the worker thread after stop(), keeping the queue and the statistics,
+        e.g. once the device has been written to directly. */
+    void resume()
+    {
+        startThread (8);
+    }
+
+    /** Queues a command for the worker thread. Returns false, and counts the command as
+        dropped, if the queue is full. */
+    bool push (const CommandType& command)
+    {
+        return pushAt (command, -1);
+    }
+
+    /** Queues a command to be sent when the global timestamp reaches targetTimestamp, or at
+        once if it is negative or already past. Returns false if the queue is full. */
+    bool pushAt (const CommandType& command, juce::int64 targetTimestamp)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (1, start1, size1, start2, size2);
+
+        if (size1 == 0)
+        {
+            ++numDropped;
+            return false;
+        }
+
+        commands[start1].command = command;
+        commands[start1].queuedTicks = Time::getHighResolutionTicks();
+        commands[start1].targetTimestamp = targetTimestamp;
+        fifo.finishedWrite (1);
+
+        commandAvailable.signal();
+        return true;
+    }
+
+    /** Global timestamp delayMs after a timestamp of the given source, converted with the
+        clock sync of the processor graph, for pushAt() */
+    static juce::int64 getTargetTimestamp (uint32 sourceFullId, juce::int64 timestamp, double delayMs)
+    {
+        return CoreServices::getSyncedTimestamp (sourceFullId, timestamp)
+            + (juce::int64) (delayMs * CoreServices::getGlobalSampleRate() / 1000.0);
+    }
+
+    int getNumSent() const      { return numSent.get(); }
+    int getNumSkipped() const   { return numSkipped.get(); }
+    int getNumDropped() const   { return numDropped.get(); }
+
+    double getMeanLatencyMs() const
+    {
+        const int sent = numSent.get();
+        return sent > 0 ? Time::highResolutionTicksToSeconds (totalLatencyTicks.get()) * 1000.0 / sent : 0.0;
+    }
+
+    double getMaxLatencyMs() const
+    {
+        return Time::highResolutionTicksToSeconds (maxLatencyTicks.get()) * 1000.0;
+    }
+
+    /** Mean and largest distance between the target of the scheduled commands and the
+        global timestamp when they were sent, in samples of the global clock */
+    double getMeanJitter() const
+    {
+        const int scheduled = numScheduled.get();
+        return scheduled > 0 ? double (totalJitter.get()) / scheduled : 0.0;
+    }
+
+    juce::int64 getMaxJitter() const    { return maxJitter.get(); }
+
+    /** One line summary of the statistics, for the log */
+    String getStatistics() const
+    {
+        String statistics = String (getNumSent()) + " commands sent, mean latency " + String (getMeanLatencyMs(), 3)
+            + " ms, max " + String (getMaxLatencyMs(), 3) + " ms, "
+            + String (getNumSkipped()) + " redundant, " + String (getNumDropped()) + " dropped";
+
+        if (numScheduled.get() > 0)
+            statistics += ", " + String (numScheduled.get()) + " scheduled, mean jitter " + String (getMeanJitter(), 1)
+                + " samples, max " + String (getMaxJitter());
+
+        return statistics;
+    }
+
+protected:
+    /** Called on the worker thread for every queued command, in order. Returns false if the
+        command was redundant and nothing had to be written. */
+    virtual bool sendCommand (const CommandType& command) = 0;
+
+private:
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            commandAvailable.wait (100);
+            sendQueuedCommands (false);
+        }
+
+        // whatever was pushed before stop()
+        sendQueuedCommands (true);
+    }
+
+    void sendQueuedCommands (bool stopping)
+    {
+        int start1, size1, start2, size2;
+
+        while (fifo.getNumReady() > 0)
+        {
+            fifo.prepareToRead (1, start1, size1, start2, size2);
+            const QueuedCommand queued = commands[start1];
+
+            if (queued.targetTimestamp >= 0 && ! stopping && ! waitForTimestamp (queued.targetTimestamp))
+                return; // stopping, it's dropped in the last pass unless it's due by then
+
+            if (queued.targetTimestamp >= 0 && stopping && CoreServices::getGlobalTimestamp() < queued.targetTimestamp)
+            {
+                fifo.finishedRead (1);
+                ++numDropped;
+                continue;
+            }
+
+            fifo.finishedRead (1);
+
+            if (sendCommand (queued.command))
+            {
+                const int64 latency = Time::getHighResolutionTicks() - queued.queuedTicks;
+                totalLatencyTicks += latency;
+                if (latency > maxLatencyTicks.get())
+                    maxLatencyTicks = latency;
+                ++numSent;
+
+                if (queued.targetTimestamp >= 0)
+                    logJitter (queued.targetTimestamp, CoreServices::getGlobalTimestamp());
+            }
+            else
+            {
+                ++numSkipped;
+            }
+        }
+    }
+
+    /** Sleeps until the global timestamp reaches target, spinning for the last couple of
+        milliseconds. Returns false if the thread was asked to exit meanwhile. */
+    bool waitForTimestamp (juce::int64 target)
+    {
+        const double samplesPerMs = CoreServices::getGlobalSampleRate() / 1000.0;
+
+        while (! threadShouldExit())
+        {
+            const juce::int64 remaining = target - CoreServices::getGlobalTimestamp();
+
+            if (remaining <= 0 || samplesPerMs <= 0)
+                return true;
+
+            const double remainingMs = remaining / samplesPerMs;
+
+            if (remainingMs > 2.0)
+                wait (int (remainingMs - 1.0));
+            else
+                Thread::yield();
+        }
+
+        return false;
+    }
+
+    void logJitter (juce::int64 target, juce::int64 sent)
+    {
+        const juce::int64 jitter = sent - target;
+        const juce::int64 distance = jitter < 0 ? -jitter : jitter;
+
+        totalJitter += distance;
+        if (distance > maxJitter.get())
+            maxJitter = distance;
+        ++numScheduled;
+
+        CoreServices::postRecordingMessage (getThreadName() + " scheduled output: target " + String (target)
+            + " sent " + String (sent) + " jitter " + String (jitter), sent);
+    }
+
+    struct QueuedCommand
+    {
+        CommandType command;
+        int64 queuedTicks;
+        juce::int64 targetTimestamp;
+    };
+
+    AbstractFifo fifo;
+    HeapBlock<QueuedCommand> commands;
+    WaitableEvent commandAvailable;
+
+    Atomic<int> numSent;
+    Atomic<int> numSkipped;
+    Atomic<int> numDropped;
+    Atomic<int64> totalLatencyTicks;
+    Atomic<int64> maxLatencyTicks;
+    Atomic<int> numScheduled;
+    Atomic<juce::int64> totalJitter;
+    Atomic<juce::int64> maxJitter;
+
+    JUCE_DECLARE_NON_COPYABLE (SerialCommandQueue);
+};
+
+#endif  // __SERIALCOMMANDQUEUE_H_4D2B9E61__
@@ -0,0 +1,215 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __SERIALREADER_H_8A61C3F4__
+#define __SERIALREADER_H_8A61C3F4__
+
+#include <JuceHeader.h>
+#include "ofSerial.h"
+#include "../../CoreServices.h"
+
+/**
+    Reads a serial port from a thread of its own, so that the audio thread can take what
+    has arrived without ever waiting for the device.
+
+    The worker thread waits on the port with ofSerial::readBytes() and a timeout (select()
+    on Linux and OS X, comm timeouts on Windows), and puts whatever each read returns into
+    a ring of bytes, together with the global timestamp it arrived at. The audio thread
+    takes the bytes back with readChunk() or readBytes(), which never block. Both rings are
+    single producer, single consumer, so only one thread may read at a time.
+
+    When the ring is full the worker stops reading, and the bytes wait in the driver's
+    buffer until the consumer has caught up. A failed read stops the worker and is reported
+    by hasFailed().
+
+    The output side is SerialCommandQueue, which writes queued commands in the same way.
+
+    @see SerialInput, SerialCommandQueue
+*/
+class SerialReader : private Thread
+{
+public:
+    SerialReader (const String& threadName, int capacityBytes, int maxChunks)
+        : Thread (threadName)
+        , port (nullptr)
+        , bytes (capacityBytes)
+        , chunks (maxChunks)
+        , chunkBytesRead (0)
+        , failed (false)
+    {
+        byteData.malloc (capacityBytes);
+        chunkData.malloc (maxChunks);
+    }
+
+    ~SerialReader()
+    {
+        stop();
+    }
+
+    /** Empties the rings and starts reading the port, which must stay open until stop() */
+    void start (ofSerial& serial)
+    {
+        stop();
+
+        port = &serial;
+        bytes.reset();
+        chunks.reset();
+        chunkBytesRead = 0;
+        failed = false;
+
+        startThread (8);
+    }
+
+    /** Stops the worker thread. The bytes it read are kept until the next start(). */
+    void stop()
+    {
+        // a read never waits longer than readTimeoutMs for the port
+        stopThread (2 * readTimeoutMs);
+    }
+
+    /** Number of bytes received and not taken yet */
+    int getNumReady() const
+    {
+        return bytes.getNumReady();
+    }
+
+    /** Copies up to maxBytes of the oldest read into dest, and returns how many were copied,
+        or 0 if nothing is waiting. timestamp is set to the global timestamp they arrived at;
+        what is left of a read longer than maxBytes comes with the next call. */
+    int readChunk (unsigned char* dest, int maxBytes, juce::int64& timestamp)
+    {
+        if (chunks.getNumReady() == 0)
+            return 0;
+
+        int start1, size1, start2, size2;
+        chunks.prepareToRead (1, start1, size1, start2, size2);
+        const Chunk& chunk = chunkData[start1];
+
+        const int numBytes = jmin (maxBytes, chunk.numBytes - chunkBytesRead);
+        timestamp = chunk.timestamp;
+        copyBytes (dest, numBytes);
+
+        chunkBytesRead += numBytes;
+        if (chunkBytesRead == chunk.numBytes)
+        {
+            chunkBytesRead = 0;
+            chunks.finishedRead (1);
+        }
+
+        return numBytes;
+    }
+
+    /** Copies up to maxBytes of the bytes waiting into dest, across reads, and returns how
+        many were copied */
+    int readBytes (unsigned char* dest, int maxBytes)
+    {
+        int numRead = 0;
+        juce::int64 timestamp;
+
+        while (numRead < maxBytes)
+        {
+            const int n = readChunk (dest + numRead, maxBytes - numRead, timestamp);
+            if (n == 0)
+                break;
+            numRead += n;
+        }
+
+        return numRead;
+    }
+
+    /** True once a read failed, e.g. because the device was unplugged */
+    bool hasFailed() const
+    {
+        return failed.get() != 0;
+    }
+
+private:
+    void run() override
+    {
+        int start1, size1, start2, size2;
+
+        while (! threadShouldExit())
+        {
+            if (bytes.getFreeSpace() == 0 || chunks.getFreeSpace() == 0)
+            {
+                wait (1);
+                continue;
+            }
+
+            // the contiguous part of the free space, the rest is filled by the next read
+            bytes.prepareToWrite (bytes.getFreeSpace(), start1, size1, start2, size2);
+
+            const int bytesRead = port->readBytes (byteData + start1, size1, readTimeoutMs);
+
+            if (bytesRead == OF_SERIAL_NO_DATA)
+                continue;
+
+            if (bytesRead < 0)
+            {
+                failed = 1;
+                return;
+            }
+
+            bytes.finishedWrite (bytesRead);
+
+            chunks.prepareToWrite (1, start1, size1, start2, size2);
+            chunkData[start1].timestamp = CoreServices::getGlobalTimestamp();
+            chunkData[start1].numBytes = bytesRead;
+            chunks.finishedWrite (1);
+        }
+    }
+
+    void copyBytes (unsigned char* dest, int numBytes)
+    {
+        int start1, size1, start2, size2;
+        bytes.prepareToRead (numBytes, start1, size1, start2, size2);
+
+        if (size1 > 0)
+            memcpy (dest, byteData + start1, (size_t) size1);
+        if (size2 > 0)
+            memcpy (dest + size1, byteData + start2, (size_t) size2);
+
+        bytes.finishedRead (size1 + size2);
+    }
+
+    static const int readTimeoutMs = 100;
+
+    struct Chunk
+    {
+        juce::int64 timestamp;
+        int numBytes;
+    };
+
+    ofSerial* port;
+
+    AbstractFifo bytes;
+    HeapBlock<unsigned char> byteData;
+    AbstractFifo chunks;
+    HeapBlock<Chunk> chunkData;
+    int chunkBytesRead; // of the oldest chunk, by the consumer
+
+    Atomic<int> failed;
+
+    JUCE_DECLARE_NON_COPYABLE (SerialReader);
+};
+
+#endif  // __SERIALREADER_H_8A61C3F4__
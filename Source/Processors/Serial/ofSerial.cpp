@@ -8,6 +8,7 @@
 
 #if defined( TARGET_OSX ) || defined( TARGET_LINUX )
 #include <sys/ioctl.h>
+#include <sys/select.h>
 #include <getopt.h>
 #include <dirent.h>
 #endif
@@ -597,6 +598,68 @@ int ofSerial::readBytes(unsigned char* buffer, int length)
     //---------------------------------------------
 }
 
+//----------------------------------------------------------------
+int ofSerial::readBytes(unsigned char* buffer, int length, int timeoutMs)
+{
+
+    if (!bInited)
+    {
+        //ofLog(OF_LOG_ERROR,"ofSerial: serial not inited");
+        return OF_SERIAL_ERROR;
+    }
+
+    //---------------------------------------------
+#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(fd, &readSet);
+
+    struct timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+
+    int nReady = select(fd + 1, &readSet, NULL, NULL, &timeout);
+    if (nReady < 0)
+        return errno == EINTR ? OF_SERIAL_NO_DATA : OF_SERIAL_ERROR;
+    if (nReady == 0)
+        return OF_SERIAL_NO_DATA;
+
+    int nRead = read(fd, buffer, length);
+    if (nRead < 0)
+        return errno == EAGAIN ? OF_SERIAL_NO_DATA : OF_SERIAL_ERROR;
+    // readable but empty: the device has gone away
+    if (nRead == 0)
+        return OF_SERIAL_ERROR;
+    return nRead;
+#endif
+    //---------------------------------------------
+
+    //---------------------------------------------
+#ifdef TARGET_WIN32
+    // with these timeouts ReadFile returns what is buffered at once, or waits
+    // up to timeoutMs for the first byte
+    COMMTIMEOUTS tOut;
+    GetCommTimeouts(hComm,&tOut);
+    COMMTIMEOUTS waitOut = tOut;
+    waitOut.ReadIntervalTimeout=MAXDWORD;
+    waitOut.ReadTotalTimeoutMultiplier=MAXDWORD;
+    waitOut.ReadTotalTimeoutConstant=timeoutMs;
+    SetCommTimeouts(hComm,&waitOut);
+
+    DWORD nRead = 0;
+    BOOL success = ReadFile(hComm,buffer,length,&nRead,0);
+    SetCommTimeouts(hComm,&tOut);
+
+    if (!success)
+    {
+        //ofLog(OF_LOG_ERROR,"ofSerial: trouble reading from port");
+        return OF_SERIAL_ERROR;
+    }
+    return nRead == 0 ? OF_SERIAL_NO_DATA : (int)nRead;
+#endif
+    //---------------------------------------------
+}
+
 //----------------------------------------------------------------
 bool ofSerial::writeByte(unsigned char singleByte)
 {
@@ -95,6 +95,8 @@ public:
 
 
     int             readBytes(unsigned char* buffer, int length);
+    // waits up to timeoutMs for data, returns OF_SERIAL_NO_DATA if none arrived
+    int             readBytes(unsigned char* buffer, int length, int timeoutMs);
     int             writeBytes(unsigned char* buffer, int length);
     bool            writeByte(unsigned char singleByte);
     int             readByte();  // returns -1 on no read or error...
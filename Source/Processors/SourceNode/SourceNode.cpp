@@ -26,6 +26,7 @@
 #include <stdio.h>
 #include "../../AccessClass.h"
 #include "../PluginManager/OpenEphysPlugin.h"
+#include "../ProcessorGraph/ProcessorGraph.h"
 
 
 SourceNode::SourceNode (const String& name_, DataThreadCreator dt)
@@ -34,6 +35,8 @@ SourceNode::SourceNode (const String& name_, DataThreadCreator dt)
     , wasDisabled           (true)
     , dataThread            (nullptr)
     , ttlState              (0)
+    , syncLine              (-1)
+    , clockSync             (nullptr)
 {
     setProcessorType (PROCESSOR_TYPE_SOURCE);
 
@@ -84,6 +87,14 @@ DataThread* SourceNode::getThread() const
 	return dataThread;
 }
 
+void SourceNode::getMemoryUsage(MemoryUsage& usage) const
+{
+	GenericProcessor::getMemoryUsage(usage);
+
+	if (dataThread != nullptr)
+		dataThread->getMemoryUsage(usage);
+}
+
 int SourceNode::getTTLState() const
 {
 	return ttlState;
@@ -94,7 +105,6 @@ int SourceNode::getTTLState() const
 void SourceNode::resizeBuffers()
 {
 	inputBuffers.clear();
-	eventCodeBuffers.clear();
 	eventStates.clear();
 	if (dataThread != nullptr)
 	{
@@ -103,7 +113,6 @@ void SourceNode::resizeBuffers()
 		for (int i = 0; i < numSubProcs; i++)
 		{
 			inputBuffers.add(dataThread->getBufferAddress(i));
-			eventCodeBuffers.add(new MemoryBlock(10000*sizeof(uint64)));
 			eventStates.add(0);
 		}
 	}
@@ -135,6 +144,9 @@ void SourceNode::updateSettings()
 			String unit = dataThread->getChannelUnits(i);
 			if (unit.isNotEmpty())
 				dataChannelArray[i]->setDataUnits(unit);
+			float highPass = dataThread->getHardwareHighPass(i);
+			if (highPass > 0)
+				dataChannelArray[i]->setHardwareHighPass(highPass);
 		}
 	}
 }
@@ -323,6 +335,14 @@ bool SourceNode::enable()
 
     stopTimer();
 
+    clockSync = &AccessClass::getProcessorGraph()->getClockSync();
+    syncLine = clockSync->getSyncLine();
+    if (syncLine >= 0)
+    {
+        for (int sub = 0; sub < getNumSubProcessors(); sub++)
+            clockSync->addSource(getProcessorFullId(getNodeId(), sub), getSampleRate(sub));
+    }
+
     if (dataThread != nullptr)
     {
         dataThread->startAcquisition();
@@ -376,12 +396,26 @@ void SourceNode::process(AudioSampleBuffer& buffer)
 {
 	int nSubs = dataThread->getNumSubProcessors();
 	int copiedChannels = 0;
+	DataBuffer::ReadSpans spans;
 
 	for (int sub = 0; sub < nSubs; sub++)
 	{
 		int channelsToCopy = getNumOutputs(sub);
-		
-		int nSamples = inputBuffers[sub]->readAllFromBuffer(buffer, &timestamp, static_cast<uint64*>(eventCodeBuffers[sub]->getData()), buffer.getNumSamples(), copiedChannels, channelsToCopy);
+		DataBuffer* input = inputBuffers[sub];
+
+		int nSamples = input->prepareToRead(spans, buffer.getNumSamples());
+		timestamp = input->getFirstTimestamp(spans);
+
+		int destStart = 0;
+		for (int region = 0; region < 2; region++)
+		{
+			int blockSize = spans.blockSize[region];
+			if (blockSize <= 0)
+				continue;
+			for (int chan = 0; chan < channelsToCopy; chan++)
+				buffer.copyFrom(copiedChannels + chan, destStart, input->getReadPointer(spans, chan, region), blockSize);
+			destStart += blockSize;
+		}
 		copiedChannels += channelsToCopy;
 
 		setTimestampAndSamples(timestamp, nSamples, sub); 
@@ -389,28 +423,41 @@ void SourceNode::process(AudioSampleBuffer& buffer)
 		if (ttlChannels[sub])
 		{
 			int numEventChannels = ttlChannels[sub]->getNumChannels();
-			// fill event buffer
+			const uint64 channelMask = numEventChannels >= 64 ? ~uint64(0) : (uint64(1) << numEventChannels) - 1;
+			// the buffer only holds the samples where the TTL word changes, so the edges
+			// come straight from its list of changes
 			uint64 last = eventStates[sub];
-			for (int i = 0; i < nSamples; ++i)
+			// the word may already differ from ours when the view starts, e.g. after a reset
+			const bool startsChanged = spans.initialEventCode != last
+				&& (spans.numEventChanges == 0 || input->getEventChange(spans, 0).sampleOffset > 0);
+			const int first = startsChanged ? -1 : 0;
+			for (int i = first; i < spans.numEventChanges; i++)
 			{
-				uint64 current = *(static_cast<uint64*>(eventCodeBuffers[sub]->getData()) + i);
-				//If there has been no change to the TTL word, avoid doing anything at all here
-				if (last != current)
+				DataBuffer::EventChange change;
+				if (i < 0)
 				{
-					//Create a TTL event for each bit that has changed
-					for (int c = 0; c < numEventChannels; ++c)
-					{
-						if (((current >> c) & 0x01) != ((last >> c) & 0x01))
-						{
-							TTLEventPtr event = TTLEvent::createTTLEvent(ttlChannels[sub], timestamp + i, &current, sizeof(uint64), c);
-							addEvent(ttlChannels[sub], event, i);
-						}
-					}
-					last = current;
+					change.sampleOffset = 0;
+					change.code = spans.initialEventCode;
 				}
+				else
+					change = input->getEventChange(spans, i);
+
+				//Visit only the bits that flipped, lowest first, and write each edge straight into the event buffer
+				uint64 edges = (change.code ^ last) & channelMask;
+				while (edges != 0)
+				{
+					const int c = countNumberOfBits((edges & (~edges + 1)) - 1);
+					addTTLEvent(ttlChannels[sub], timestamp + change.sampleOffset, &change.code, c, change.sampleOffset);
+					if (c == syncLine && ((change.code >> c) & 1))
+						clockSync->addEdge(getProcessorFullId(getNodeId(), sub), timestamp + change.sampleOffset, getLastProcessedsoftwareTime(), nSamples - change.sampleOffset);
+					edges &= edges - 1;
+				}
+				last = change.code;
 			}
 			eventStates.set(sub, last);
 		}
+
+		input->finishedRead(spans);
 	}
 }
 
@@ -30,6 +30,8 @@
 #include "../GenericProcessor/GenericProcessor.h"
 #include "../../UI/UIComponent.h"
 
+class ClockSync;
+
 
 /**
   Creates and controls a thread for reading data from external sources.
@@ -83,6 +85,8 @@ public:
 
 	DataThread* getThread() const;
 
+	void getMemoryUsage(MemoryUsage& usage) const override;
+
 	int getTTLState() const;
 
     bool tryEnablingEditor();
@@ -108,13 +112,16 @@ private:
     uint64 timestamp;
     //uint64* eventCodeBuffer;
     //int* eventChannelState;
-    OwnedArray<MemoryBlock> eventCodeBuffers;
 	Array<uint64> eventStates;
 	Array<EventChannel*> ttlChannels;
 
     int ttlState;
 	void resizeBuffers();
 
+	/** Rising edges on this TTL line are reported to the clock sync, -1 if disabled */
+	int syncLine;
+	ClockSync* clockSync;
+
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SourceNode);
 };
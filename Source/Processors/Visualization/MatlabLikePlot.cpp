@@ -22,6 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "MatlabLikePlot.h"
+#include "../Dsp/Spectrum.h"
 /**********************************************************************/
 MatlabLikePlot::MatlabLikePlot()
 {
@@ -284,7 +285,7 @@ void MatlabLikePlot::plotxy(XYline l)
 		l.removeMean();
 	}
 
-	drawComponent->plotxy(l);
+	drawComponent->plotxy(std::move(l));
 }
 
 
@@ -613,7 +614,7 @@ void AxesComponent::paint(Graphics &g)
 
 }
 /*************************************************************************/
-XYline::XYline(float x0_, float dx_, std::vector<float> y_, float gain_, juce::Colour color_) : gain(gain_), dx(dx_), x0(x0_), y(y_), color(color_)
+XYline::XYline(float x0_, float dx_, std::vector<float> y_, float gain_, juce::Colour color_) : gain(gain_), dx(dx_), x0(x0_), y(std::move(y_)), color(color_)
 {
 	// adjust gain
 	numpts = y.size();
@@ -661,17 +662,81 @@ void XYline::smooth(std::vector<float> smoothKernel)
 		}
 		smoothy[k] = response;
 	}
-	y = smoothy;
+	y.swap(smoothy);
+	levelMin.clear();
+	levelMax.clear();
 }
 
 void XYline::getYRange(float xmin, float xmax, double &lowestValue, double &highestValue)
 {
 	int startIndex = MIN(numpts,MAX(0, (xmin-x0)/dx));
 	int endIndex = MIN(numpts,MAX(0, (xmax-x0)/dx));
-	for (int k=startIndex;k<endIndex;k++)
+	if (endIndex <= startIndex)
+		return;
+
+	float lo, hi;
+	getSampleRange(startIndex, endIndex, lo, hi);
+	lowestValue = MIN(lowestValue,lo);
+	highestValue =MAX(highestValue,hi);
+}
+
+void XYline::buildLevelsOfDetail()
+{
+	levelMin.clear();
+	levelMax.clear();
+
+	for (;;)
+	{
+		const std::vector<float>& srcMin = levelMin.empty() ? y : levelMin.back();
+		const std::vector<float>& srcMax = levelMax.empty() ? y : levelMax.back();
+		if (srcMin.size() < 4)
+			break;
+
+		// only whole pairs, a trailing point is read from the level below
+		const size_t n = srcMin.size() / 2;
+		std::vector<float> dstMin(n), dstMax(n);
+		for (size_t k = 0; k < n; k++)
+		{
+			dstMin[k] = MIN(srcMin[2*k], srcMin[2*k+1]);
+			dstMax[k] = MAX(srcMax[2*k], srcMax[2*k+1]);
+		}
+		levelMin.push_back(std::move(dstMin));
+		levelMax.push_back(std::move(dstMax));
+	}
+}
+
+void XYline::getSampleRange(int first, int last, float &lo, float &hi)
+{
+	if (levelMin.empty() && numpts >= 4)
+		buildLevelsOfDetail();
+
+	lo = y[first];
+	hi = y[first];
+
+	const int numLevels = levelMin.size();
+	for (int k = first; k < last;)
 	{
-		lowestValue = MIN(lowestValue,y[k]);
-		highestValue =MAX(highestValue,y[k]);
+		// the coarsest bucket starting at k that ends before last
+		int level = -1;
+		while (level + 1 < numLevels
+			&& (k & ((2 << (level + 1)) - 1)) == 0
+			&& k + (2 << (level + 1)) <= last
+			&& (k >> (level + 2)) < (int) levelMin[level + 1].size())
+			level++;
+
+		if (level < 0)
+		{
+			lo = MIN(lo, y[k]);
+			hi = MAX(hi, y[k]);
+			k++;
+		}
+		else
+		{
+			const int bucket = k >> (level + 1);
+			lo = MIN(lo, levelMin[level][bucket]);
+			hi = MAX(hi, levelMax[level][bucket]);
+			k += 2 << level;
+		}
 	}
 }
 
@@ -691,6 +756,8 @@ void XYline::removeMean()
 	{
 		y[k] = (y[k]-mean)*gain;
 	}	
+	levelMin.clear();
+	levelMax.clear();
 }
 
 
@@ -745,241 +812,34 @@ float XYline::interp_cubic(float x_sample, bool &inrange)
 	}
 }
 
-/*
- FFT/IFFT routine. (see pages 507-508 of Numerical Recipes in C)
-
- Inputs:
-	data : vector of complex* data points of size 2*NFFT+1.
-		* the n'th complex number x(n), for 0 <= n <= length(x)-1, is stored as:
-			data[2*n] = real(x(n))
-			data[2*n+1] = imag(x(n))
-		if length(Nx) < NFFT, the remainder of the array must be padded with zeros
-
-	nn : FFT order NFFT. This MUST be a power of 2 and >= length(x).
-	isign:  if set to 1, 
-				computes the forward FFT
-			if set to -1, 
-				computes Inverse FFT - in this case the output values have
-				to be manually normalized by multiplying with 1/NFFT.
- Outputs:
-	data[] : The FFT or IFFT results are stored in data, overwriting the input.
-
-
-	
-void XYline::four1(std::vector<float> &data, int nn, int isign)
-{
-    int n, mmax, m, j, istep, i;
-    double wtemp, wr, wpr, wpi, wi, theta;
-    double tempr, tempi;
-    const double twopi = 6.28318530718;
-    n = nn << 1;
-    j = 1;
-    for (i = 1; i < n; i += 2) {
-	if (j > i) {
-	    tempr = data[j-1];     data[j-1] = data[i-1];     data[i-1] = tempr;
-	    tempr = data[j+1-1]; data[j+1-1] = data[i+1-1]; data[i+1-1] = tempr;
-	}
-	m = n >> 1;
-	while (m >= 2 && j > m) {
-	    j -= m;
-	    m >>= 1;
-	}
-	j += m;
-    }
-    mmax = 2;
-    while (n > mmax) {
-	istep = 2*mmax;
-	theta = twopi/(isign*mmax);
-	wtemp = sin(0.5*theta);
-	wpr = -2.0*wtemp*wtemp;
-	wpi = sin(theta);
-	wr = 1.0;
-	wi = 0.0;
-	for (m = 1; m < mmax; m += 2) {
-	    for (i = m; i <= n; i += istep) {
-		j =i + mmax;
-		tempr = wr*data[j-1]   - wi*data[j+1-1];
-		tempi = wr*data[j+1-1] + wi*data[j-1];
-		data[j-1]   = data[i-1]   - tempr;
-		data[j+1-1] = data[i+1-1] - tempi;
-		data[i-1] += tempr;
-		data[i+1-1] += tempi;
-	    }
-	    wr = (wtemp = wr)*wpr - wi*wpi + wr;
-	    wi = wi*wpr + wtemp*wpi + wi;
-	}
-	mmax = istep;
-    }
-}
-
-
 XYline XYline::getFFT()
 {
 	int Nx = numpts;
-	// calculate NFFT as the next higher power of 2 >= Nx 
-	int NFFT = (int)pow(2.0, ceil(log((double)Nx)/log(2.0)));
-	std::vector<float> X;
-	X.resize(2*NFFT); // to hold complex 
-
-	// Storing x(n) in a complex array to make it work with four1. 
-	//This is needed even though x(n) is purely real in this case. 
-	for(int i=0; i<Nx; i++)
-	{
-		X[2*i] = y[i];
-		X[2*i+1] = 0.0;
-	}
-	// pad the remainder of the array with zeros (0 + 0 j) 
-	for(int i=Nx; i<NFFT; i++)
-	{
-		X[2*i] = 0.0;
-		X[2*i+1] = 0.0;
-	}
-
-	// calculate FFT 
-	four1(X, NFFT, 1);
-
-
-	// now convert to power spectrum, and remove the second half of the signal (mirror symmetry of real function).
-	float Fs = 1.0/dx;
-	float df = (NFFT/2+1) / (Fs/2);
-	std::vector<float> powerspectrum;
-	powerspectrum.resize(NFFT/2+1);
-	for (int k=0;k<NFFT/2+1;k++)
-	{
-		powerspectrum[k] = log10(2 *  sqrt(X[2*k]*X[2*k]+ X[2*k+1]*X[2*k+1]));
-	}
-
-	return XYline(0,df, powerspectrum,1.0, color);
-}
-
-*/
-
-
-
-
-
-/************************************************
-* FFT code from the book Numerical Recipes in C *
-* Visit www.nr.com for the licence.             *
-************************************************/
-
-// The following line must be defined before including math.h to correctly define M_PI
-
-#define PI	3.14159265359	/* pi to machine precision, defined in math.h */
-#define TWOPI	(2.0*PI)
-
-/*
- FFT/IFFT routine. (see pages 507-508 of Numerical Recipes in C)
-
- Inputs:
-	data[] : array of complex* data points of size 2*NFFT+1.
-		data[0] is unused,
-		* the n'th complex number x(n), for 0 <= n <= length(x)-1, is stored as:
-			data[2*n+1] = real(x(n))
-			data[2*n+2] = imag(x(n))
-		if length(Nx) < NFFT, the remainder of the array must be padded with zeros
-
-	nn : FFT order NFFT. This MUST be a power of 2 and >= length(x).
-	isign:  if set to 1, 
-				computes the forward FFT
-			if set to -1, 
-				computes Inverse FFT - in this case the output values have
-				to be manually normalized by multiplying with 1/NFFT.
- Outputs:
-	data[] : The FFT or IFFT results are stored in data, overwriting the input.
-*/
-
-void XYline::four1(double data[], int nn, int isign)
-{
-    int n, mmax, m, j, istep, i;
-    double wtemp, wr, wpr, wpi, wi, theta;
-    double tempr, tempi;
-    
-    n = nn << 1;
-    j = 1;
-    for (i = 1; i < n; i += 2) {
-	if (j > i) {
-	    tempr = data[j];     data[j] = data[i];     data[i] = tempr;
-	    tempr = data[j+1]; data[j+1] = data[i+1]; data[i+1] = tempr;
-	}
-	m = n >> 1;
-	while (m >= 2 && j > m) {
-	    j -= m;
-	    m >>= 1;
-	}
-	j += m;
-    }
-    mmax = 2;
-    while (n > mmax) {
-	istep = 2*mmax;
-	theta = TWOPI/(isign*mmax);
-	wtemp = sin(0.5*theta);
-	wpr = -2.0*wtemp*wtemp;
-	wpi = sin(theta);
-	wr = 1.0;
-	wi = 0.0;
-	for (m = 1; m < mmax; m += 2) {
-	    for (i = m; i <= n; i += istep) {
-		j =i + mmax;
-		tempr = wr*data[j]   - wi*data[j+1];
-		tempi = wr*data[j+1] + wi*data[j];
-		data[j]   = data[i]   - tempr;
-		data[j+1] = data[i+1] - tempi;
-		data[i] += tempr;
-		data[i+1] += tempi;
-	    }
-	    wr = (wtemp = wr)*wpr - wi*wpi + wr;
-	    wi = wi*wpr + wtemp*wpi + wi;
-	}
-	mmax = istep;
-    }
-}
-
-/******************************************/
-
-XYline XYline::getFFT()
-{
-	int Nx = numpts;
-	// calculate NFFT as the next higher power of 2 >= Nx 
-	int NFFT = (int)pow(2.0, ceil(log((double)Nx)/log(2.0)));
-
-	int i;
-
-	double *data_aug;
-
-	/* calculate NFFT as the next higher power of 2 >= Nx */
-	NFFT = (int)pow(2.0, ceil(log((double)Nx)/log(2.0)));
-
-	/* allocate memory for NFFT complex numbers (note the +1) */
-	data_aug = (double *) malloc((2*NFFT+1) * sizeof(double));
-
-	/* Storing x(n) in a complex array to make it work with four1. 
-	This is needed even though x(n) is purely real in this case. */
-	for(i=0; i<Nx; i++)
-	{
-		data_aug[2*i+1] = y[i];
-		data_aug[2*i+2] = 0.0;
-	}
-	/* pad the remainder of the array with zeros (0 + 0 j) */
-	for(i=Nx; i<NFFT; i++)
-	{
-		data_aug[2*i+1] = 0.0;
-		data_aug[2*i+2] = 0.0;
-	}
-
-	four1(data_aug, NFFT, 1);
-
-
-	// now convert to power spectrum, and remove the second half of the signal (mirror symmetry of real function).
+	// zero pad to the next power of 2 >= Nx
+	int NFFT = 1;
+	while (NFFT < Nx)
+		NFFT <<= 1;
+
+	// the transform tables and buffers are kept from one call to the next
+	static thread_local Dsp::RealFFT fft;
+	static thread_local std::vector<float> padded;
+	static thread_local std::vector<float> power;
+	fft.setSize(NFFT);
+	padded.assign(NFFT, 0.0f);
+	std::copy(y.begin(), y.begin() + Nx, padded.begin());
+	power.resize(fft.getNumBins());
+
+	fft.performPower(padded.data(), nullptr, power.data(), nullptr);
+
+	// now convert to amplitude spectrum, only keeping the non-negative frequencies (mirror symmetry of real function).
 	float Fs = 1.0/dx;
 	float df =((Fs/2)/(NFFT/2));
 	std::vector<float> powerspectrum;
 	powerspectrum.resize(NFFT/2+1);
 	for (int k=0;k<NFFT/2+1;k++)
 	{
-		powerspectrum[k] = sqrt(data_aug[2*k+1]/NFFT*data_aug[2*k+1]/NFFT+ data_aug[2*k+2]/NFFT*data_aug[2*k+2]/NFFT);
+		powerspectrum[k] = sqrt(power[k]) / NFFT;
 	}
-	delete data_aug;
 
 	return XYline(0,df, powerspectrum,1.0, color);
 }
@@ -1003,8 +863,15 @@ void XYline::draw(Graphics &g, float xmin, float xmax, float ymin, float ymax, i
 		return;
 	}
 	// function is given in [x,y], where dx is fixed and known.
-	// use bilinear interpolation.
+	// with several points per pixel, the envelope shows all of them, so it is its own bounds
 	float xrange = xmax-xmin;
+	if (xrange / dx >= 2 * plotWidth)
+	{
+		drawEnvelope(g, xmin, xmax, ymin, ymax, plotWidth, plotHeight);
+		return;
+	}
+
+	// use bilinear interpolation.
 	int screenQuantization ;
 	if (xrange  < 100 * 1e-3)  // if we are looking at a region that is smaller than 50 ms, try to get better visualization...
 	{
@@ -1084,6 +951,44 @@ void XYline::draw(Graphics &g, float xmin, float xmax, float ymin, float ymax, i
 
 }
 
+void XYline::drawEnvelope(Graphics &g, float xmin, float xmax, float ymin, float ymax, int plotWidth, int plotHeight)
+{
+	const float pointsPerPixel = (xmax - xmin) / dx / plotWidth;
+	const float firstPoint = (xmin - x0) / dx;
+	const float scaley = plotHeight / (ymax - ymin);
+
+	bool prevDrawn = false;
+	float prevLo = 0, prevHi = 0;
+	for (int i = 0; i < plotWidth; i++)
+	{
+		const int first = MAX(0, (int) floor(firstPoint + i * pointsPerPixel));
+		const int last = MIN(numpts, (int) floor(firstPoint + (i + 1) * pointsPerPixel));
+		if (last <= first)
+		{
+			prevDrawn = false;
+			continue;
+		}
+
+		float lo, hi;
+		getSampleRange(first, last, lo, hi);
+
+		// reaching to the neighbouring column keeps the trace joined
+		float top = hi, bottom = lo;
+		if (prevDrawn)
+		{
+			top = MAX(top, prevLo);
+			bottom = MIN(bottom, prevHi);
+		}
+		prevLo = lo;
+		prevHi = hi;
+		prevDrawn = true;
+
+		const float yTop = plotHeight - (top - ymin) * scaley;
+		const float yBottom = plotHeight - (bottom - ymin) * scaley;
+		g.drawVerticalLine(i, yTop, MAX(yBottom, yTop + 1.0f));
+	}
+}
+
 /*************************************************************************/
 DrawComponent::DrawComponent(MatlabLikePlot *mlp_) : mlp(mlp_)
 {
@@ -1162,7 +1067,7 @@ void DrawComponent::plotxy(XYline l)
 {
 	l.getYRange(xmin,xmax,lowestValue, highestValue);
 	if (std::abs(lowestValue) < 1e10 && std::abs(highestValue) < 1e10)
-		lines.push_back(l);
+		lines.push_back(std::move(l));
 }
 	
 void DrawComponent::clearplot()
@@ -42,6 +42,9 @@
 /* A plotting class that you can derive from. Handles all basic pan-zoom, tick marks, tick labels
 You only need to implement the drawing of the actual curves in the given range*/
 /************************/
+/* Lines are moved into the plot, never copied. When there are two or more points per pixel,
+only the minimum and maximum under each pixel column are drawn, taken from a pyramid of
+min/max levels built on the first such draw and kept until the points change*/
 class PLUGIN_API XYline
 {
 public:
@@ -50,6 +53,9 @@ public:
 
 	// for pure vertical lines
 	XYline(float x0_, float ymin, float ymax, juce::Colour color_) ;
+
+	XYline(XYline&& other) = default;
+	XYline& operator=(XYline&& other) = default;
 	XYline getFFT();
 	void draw(Graphics &g, float xmin, float xmax, float ymin, float ymax, int width, int height, bool showBounds);
 	void getYRange(float xmin, float xmax, double &lowestValue, double &highestValue);
@@ -57,19 +63,27 @@ public:
 	void smooth(std::vector<float> kernel);
 	int getNumPoints();
 private:
-	void four1(std::vector<float> &data, int nn, int isign);
-	void four1(double data[], int nn, int isign);
-
 	float interp(float x_sample, bool &inrange);
 	float interp_bilinear(float x_sample, bool &inrange);
 
 	float interp_cubic(float x_sample, bool &inrange);
+
+	/* draws the min/max envelope of the points under every pixel column */
+	void drawEnvelope(Graphics &g, float xmin, float xmax, float ymin, float ymax, int plotWidth, int plotHeight);
+	/* minimum and maximum of the points [first, last), from the coarsest levels that fit */
+	void getSampleRange(int first, int last, float &lo, float &hi);
+	void buildLevelsOfDetail();
+
 	bool sortedX, fixedDx,  verticalLine;
 	float gain,dx, x0,xn,mean;
 	int numpts;
 	std::vector<float> x;
 	std::vector<float> y;
+	// level k holds the minimum and maximum of every 2^(k+1) points
+	std::vector<std::vector<float>> levelMin, levelMax;
 	juce::Colour color;
+
+	JUCE_DECLARE_NON_COPYABLE(XYline);
 };
 
 enum DrawComponentMode {ZOOM = 1, PAN = 2, VERTICAL_SHIFT = 3, THRES_UPDATE = 4};
@@ -22,27 +22,27 @@
 */
 
 #include "Visualizer.h"
+#include "VisualizerScheduler.h"
 
 Visualizer::Visualizer()
 {
 	refreshRate = 50;    // 50 Hz default refresh rate
 }
 
-Visualizer::~Visualizer() {}
-
-void Visualizer::startCallbacks()
+Visualizer::~Visualizer()
 {
-	startTimer(1/float(refreshRate)*1000.0f);
+	stopCallbacks();
 }
 
-void Visualizer::stopCallbacks()
+void Visualizer::startCallbacks()
 {
-	stopTimer();
+	VisualizerScheduler::getInstance()->addVisualizer(this);
 }
 
-void Visualizer::timerCallback()
+void Visualizer::stopCallbacks()
 {
-	refresh();
+	if (VisualizerScheduler* scheduler = VisualizerScheduler::getInstanceWithoutCreating())
+		scheduler->removeVisualizer(this);
 }
 
 void Visualizer::saveVisualizerParameters(XmlElement* xml) { }
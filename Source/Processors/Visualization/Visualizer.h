@@ -31,12 +31,14 @@
 
   Abstract base class for displaying data.
 
-  @see LfpDisplayCanvas, SpikeDisplayCanvas
+  While callbacks are running, refresh() is called by the VisualizerScheduler,
+  which shares one timer between all visualizers and skips hidden ones.
+
+  @see LfpDisplayCanvas, SpikeDisplayCanvas, VisualizerScheduler
 
 */
 
-class PLUGIN_API Visualizer : public Component,
-    public Timer
+class PLUGIN_API Visualizer : public Component
 
 {
 public:
@@ -64,16 +66,13 @@ public:
     /** Called by an editor to initiate a parameter change.*/
     virtual void setParameter(int, int, int, float) = 0;
 
-    /** Starts the timer callbacks. */
+    /** Starts calling refresh() at refreshRate. */
 	void startCallbacks();
 
-    /** Stops the timer callbacks. */
+    /** Stops calling refresh(). */
 	void stopCallbacks();
 
-    /** Called whenever the timer is triggered. */
-	void timerCallback();
-
-    /** Refresh rate in Hz. */
+    /** Refresh rate in Hz. Read when callbacks start; slowed down while the audio load is high. */
     float refreshRate;
 
 
@@ -0,0 +1,181 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "VisualizerScheduler.h"
+#include "Visualizer.h"
+#include "../../AccessClass.h"
+#include "../../Audio/AudioComponent.h"
+#include "../GenericProcessor/TraceRecorder.h"
+
+namespace
+{
+	// Fraction of the audio callback time budget above which refreshes slow down,
+	// and below which they speed up again
+	const double HIGH_AUDIO_LOAD = 0.75;
+	const double LOW_AUDIO_LOAD = 0.5;
+	const int MAX_THROTTLE = 8;
+
+	double getRefreshPeriod(const Visualizer* visualizer)
+	{
+		return 1000.0 / jmax(1.0f, visualizer->refreshRate);
+	}
+}
+
+juce_ImplementSingleton(VisualizerScheduler);
+
+VisualizerScheduler::VisualizerScheduler()
+	: m_throttle(1)
+{
+}
+
+VisualizerScheduler::~VisualizerScheduler()
+{
+	stopTimer();
+	clearSingletonInstance();
+}
+
+void VisualizerScheduler::addVisualizer(Visualizer* visualizer)
+{
+	for (int i = 0; i < m_entries.size(); i++)
+	{
+		if (m_entries.getReference(i).visualizer == visualizer)
+			return;
+	}
+
+	Entry entry;
+	entry.visualizer = visualizer;
+	entry.nextRefresh = Time::getMillisecondCounterHiRes();
+	entry.traceName = TraceRecorder::getPooledName((visualizer->getName().isEmpty() ? String("Visualizer") : visualizer->getName()) + " refresh");
+	m_entries.add(entry);
+
+	updateTimer();
+}
+
+void VisualizerScheduler::removeVisualizer(Visualizer* visualizer)
+{
+	for (int i = 0; i < m_entries.size(); i++)
+	{
+		if (m_entries.getReference(i).visualizer == visualizer)
+		{
+			m_entries.remove(i);
+			updateTimer();
+			return;
+		}
+	}
+}
+
+int VisualizerScheduler::getThrottle() const
+{
+	return m_throttle;
+}
+
+ProcessTimeStatistics::Summary VisualizerScheduler::getRefreshTimeSummary() const
+{
+	return m_refreshTime.getSummary();
+}
+
+int VisualizerScheduler::getNumVisualizers() const
+{
+	return m_entries.size();
+}
+
+bool VisualizerScheduler::updateThrottle()
+{
+	AudioComponent* audio = AccessClass::getAudioComponent();
+	if (audio == nullptr)
+		return false;
+
+	const double load = audio->deviceManager.getCpuUsage();
+
+	int throttle = m_throttle;
+	if (load > HIGH_AUDIO_LOAD)
+		throttle = jmin(throttle * 2, MAX_THROTTLE);
+	else if (load < LOW_AUDIO_LOAD)
+		throttle = jmax(throttle / 2, 1);
+
+	if (throttle == m_throttle)
+		return false;
+
+	m_throttle = throttle;
+	return true;
+}
+
+void VisualizerScheduler::updateTimer()
+{
+	if (m_entries.size() == 0)
+	{
+		stopTimer();
+		m_throttle = 1;
+		return;
+	}
+
+	double period = getRefreshPeriod(m_entries.getReference(0).visualizer);
+	for (int i = 1; i < m_entries.size(); i++)
+		period = jmin(period, getRefreshPeriod(m_entries.getReference(i).visualizer));
+
+	const int interval = jmax(1, roundToInt(period * m_throttle));
+	if (interval != getTimerInterval())
+		startTimer(interval);
+}
+
+void VisualizerScheduler::timerCallback()
+{
+	if (updateThrottle())
+		updateTimer();
+
+	// Refresh everything due before the next tick now, so visualizers with
+	// close refresh rates are redrawn together
+	const double now = Time::getMillisecondCounterHiRes();
+	const double due = now + getTimerInterval() / 2;
+
+	// refresh() may start or stop callbacks, so work on a copy of the list
+	Array<Visualizer*> toRefresh;
+	for (int i = 0; i < m_entries.size(); i++)
+	{
+		Entry& entry = m_entries.getReference(i);
+		if (entry.nextRefresh > due || !entry.visualizer->isShowing())
+			continue;
+
+		entry.nextRefresh = now + getRefreshPeriod(entry.visualizer) * m_throttle;
+		toRefresh.add(entry.visualizer);
+	}
+
+	if (toRefresh.size() == 0)
+		return;
+
+	TraceRecorder::Scope trace("VisualizerScheduler::timerCallback");
+	const int64 start = Time::getHighResolutionTicks();
+	for (int i = 0; i < toRefresh.size(); i++)
+	{
+		for (int j = 0; j < m_entries.size(); j++)
+		{
+			if (m_entries.getReference(j).visualizer == toRefresh[i])
+			{
+				TraceRecorder::Scope refreshTrace(m_entries.getReference(j).traceName);
+				toRefresh[i]->refresh();
+				break;
+			}
+		}
+	}
+	m_refreshTime.addSample(Time::getHighResolutionTicks() - start);
+}
@@ -0,0 +1,94 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef VISUALIZERSCHEDULER_H_INCLUDED
+#define VISUALIZERSCHEDULER_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../GenericProcessor/ProcessTimeStatistics.h"
+
+class Visualizer;
+
+/**
+	Drives the refresh() calls of every running Visualizer from a single timer.
+
+	Visualizers register through Visualizer::startCallbacks(). On every tick the
+	scheduler refreshes the ones that are due, so all of them are redrawn in the
+	same message-thread callback instead of each firing its own timer. Visualizers
+	that are not showing (a background tab, or a minimised DataWindow) are skipped
+	until they become visible again.
+
+	The audio device load is checked on every tick: while the audio callback uses
+	more than a set fraction of its time budget, refresh periods are doubled (up to
+	a limit), and they are brought back down once the load drops.
+
+	@see Visualizer
+*/
+class VisualizerScheduler : private Timer,
+	private DeletedAtShutdown
+{
+public:
+	VisualizerScheduler();
+	~VisualizerScheduler();
+
+	/** Starts refreshing the visualizer at its refreshRate */
+	void addVisualizer(Visualizer* visualizer);
+
+	/** Stops refreshing the visualizer. Safe to call if it was never added. */
+	void removeVisualizer(Visualizer* visualizer);
+
+	/** Current multiplier applied to all refresh periods, 1 when the audio load is low */
+	int getThrottle() const;
+
+	/** Time taken by the refresh() calls of each tick that refreshed anything */
+	ProcessTimeStatistics::Summary getRefreshTimeSummary() const;
+
+	/** Number of visualizers currently being refreshed, shown or not */
+	int getNumVisualizers() const;
+
+	juce_DeclareSingleton(VisualizerScheduler, false);
+
+private:
+	void timerCallback() override;
+
+	/** Adjusts m_throttle to the audio device load and returns true if it changed */
+	bool updateThrottle();
+
+	/** Restarts the timer at the shortest refresh period of all visualizers */
+	void updateTimer();
+
+	struct Entry
+	{
+		Visualizer* visualizer;
+		double nextRefresh;
+		const char* traceName;
+	};
+
+	Array<Entry> m_entries;
+	int m_throttle;
+	ProcessTimeStatistics m_refreshTime;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VisualizerScheduler);
+};
+
+#endif  // VISUALIZERSCHEDULER_H_INCLUDED
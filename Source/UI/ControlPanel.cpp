@@ -27,7 +27,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <math.h>
 #include "../AccessClass.h"
 #include "../Processors/RecordNode/RecordEngine.h"
+#include "../Processors/RecordNode/RecordThread.h"
 #include "../Processors/PluginManager/PluginManager.h"
+#include "../Processors/SourceNode/SourceNode.h"
 
 
 const int SIZE_AUDIO_EDITOR_MAX_WIDTH = 500;
@@ -96,7 +98,7 @@ RecordButton::~RecordButton()
 }
 
 
-CPUMeter::CPUMeter() : Label("CPU Meter","0.0"), cpu(0.0f), lastCpu(0.0f)
+CPUMeter::CPUMeter() : Label("CPU Meter","0.0"), cpu(0.0f), lastCpu(0.0f), bufferFill(0.0f), samplesDropped(false)
 {
 
     font = Font("Small Text", 12, Font::plain);
@@ -106,19 +108,40 @@ CPUMeter::CPUMeter() : Label("CPU Meter","0.0"), cpu(0.0f), lastCpu(0.0f)
     // font = Font(typeface);
     // font.setHeight(12);
 
-    setTooltip("CPU usage");
+    setTooltip("CPU usage (click for details)");
 }
 
 CPUMeter::~CPUMeter()
 {
 }
 
+void CPUMeter::mouseDown(const MouseEvent&)
+{
+    if (ControlPanel* controlPanel = findParentComponentOfClass<ControlPanel>())
+        controlPanel->showPerformancePanel();
+}
+
 void CPUMeter::updateCPU(float usage)
 {
     lastCpu = cpu;
     cpu = usage;
 }
 
+void CPUMeter::updateBufferStats(const BufferStats& sourceStats, const BufferStats& recordStats)
+{
+    bufferFill = jmax(sourceStats.fillFraction, recordStats.fillFraction);
+    samplesDropped = sourceStats.samplesDropped > 0 || recordStats.samplesDropped > 0;
+
+    String tip = "CPU usage";
+    tip << "\nSource buffers: " << String(sourceStats.fillFraction * 100.0f, 1) << "% full, peak "
+        << sourceStats.highWaterMark << " samples, " << String(sourceStats.samplesDropped) << " dropped";
+    tip << "\nRecord queue: " << String(recordStats.fillFraction * 100.0f, 1) << "% full, peak "
+        << recordStats.highWaterMark << " samples, " << String(recordStats.samplesDropped) << " dropped";
+    if (samplesDropped)
+        tip << "\nTime spent full: " << String(jmax(sourceStats.secondsFull, recordStats.secondsFull), 2) << " s";
+    setTooltip(tip);
+}
+
 void CPUMeter::paint(Graphics& g)
 {
     g.fillAll(Colours::grey);
@@ -126,17 +149,45 @@ void CPUMeter::paint(Graphics& g)
     g.setColour(Colours::yellow);
     g.fillRect(0.0f,0.0f,getWidth()*cpu,float(getHeight()));
 
-    g.setColour(Colours::black);
+    // buffer fill level along the bottom edge
+    g.setColour(samplesDropped ? Colours::red : Colours::orange);
+    g.fillRect(0.0f,getHeight()-3.0f,getWidth()*bufferFill,3.0f);
+
+    g.setColour(samplesDropped ? Colours::red : Colours::black);
     g.drawRect(0,0,getWidth(),getHeight(),1);
 
+    g.setColour(Colours::black);
+
     g.setFont(font);
     g.drawSingleLineText("CPU",65,12);
 
 }
 
 
-DiskSpaceMeter::DiskSpaceMeter()
+namespace
+{
+    // The disk must sustain this many times the recorded rate, for this many consecutive
+    // meter updates, not to be flagged
+    const double WRITE_RATE_MARGIN = 1.25;
+    const int SLOW_UPDATES_BEFORE_WARNING = 20;
 
+    // Weight of the latest measurement in the smoothed write rates
+    const double WRITE_RATE_SMOOTHING = 0.1;
+
+    String formatDuration(double seconds)
+    {
+        if (seconds >= 100 * 3600)
+            return ">99h";
+        const int minutes = int(seconds / 60);
+        if (minutes >= 60)
+            return String(minutes / 60) + "h" + String(minutes % 60).paddedLeft('0', 2);
+        return String(minutes) + "m";
+    }
+}
+
+DiskSpaceMeter::DiskSpaceMeter()
+    : diskFree(0), freeBytes(0), requiredRate(0), sustainedRate(0), showForecast(false),
+      numSlowUpdates(0), lastBytesWritten(0), lastUpdateTime(0)
 {
 
     font = Font("Small Text", 12, Font::plain);
@@ -159,6 +210,64 @@ void DiskSpaceMeter::updateDiskSpace(float percent)
     diskFree = percent;
 }
 
+void DiskSpaceMeter::updateWriteRate(int64 bytesFree, double configuredRate, int64 bytesWritten,
+                                     const ThreadLoadMonitor::Counters& writerLoad, bool acquiring, bool recording)
+{
+    const double now = Time::getMillisecondCounterHiRes();
+    freeBytes = bytesFree;
+    showForecast = acquiring && configuredRate > 0;
+
+    if (!recording || lastUpdateTime == 0 || bytesWritten < lastBytesWritten)
+    {
+        // A new recording: start measuring from here, keeping the last sustained rate
+        requiredRate = configuredRate;
+        numSlowUpdates = 0;
+    }
+    else
+    {
+        const double seconds = (now - lastUpdateTime) / 1000.0;
+        const double busySeconds = Time::highResolutionTicksToSeconds(writerLoad.loopTicks - lastWriterLoad.loopTicks);
+        const double bytes = double(bytesWritten - lastBytesWritten);
+
+        // Events and spikes only show up in what was actually written
+        if (seconds > 0)
+        {
+            const double measured = requiredRate + WRITE_RATE_SMOOTHING * (bytes / seconds - requiredRate);
+            requiredRate = jmax(configuredRate, measured);
+        }
+        if (busySeconds > 0 && bytes > 0)
+        {
+            const double sustained = bytes / busySeconds;
+            sustainedRate = sustainedRate > 0 ? sustainedRate + WRITE_RATE_SMOOTHING * (sustained - sustainedRate) : sustained;
+        }
+
+        if (sustainedRate > 0 && sustainedRate < requiredRate * WRITE_RATE_MARGIN)
+            numSlowUpdates++;
+        else
+            numSlowUpdates = 0;
+    }
+
+    lastBytesWritten = recording ? bytesWritten : 0;
+    lastWriterLoad = writerLoad;
+    lastUpdateTime = recording ? now : 0;
+
+    String tip = "Disk space available: " + File::descriptionOfSizeInBytes(freeBytes);
+    if (showForecast && requiredRate > 0)
+        tip << "\n" << formatDuration(freeBytes / requiredRate) << " left at "
+            << String(requiredRate / 1e6, 2) << " MB/s";
+    if (sustainedRate > 0)
+        tip << "\nDisk sustained " << String(sustainedRate / 1e6, 1) << " MB/s in the "
+            << (recording ? "current" : "last") << " recording";
+    if (isFallingBehind())
+        tip << "\nWarning: the disk is barely keeping up with the data being recorded";
+    setTooltip(tip);
+}
+
+bool DiskSpaceMeter::isFallingBehind() const
+{
+    return numSlowUpdates >= SLOW_UPDATES_BEFORE_WARNING;
+}
+
 void DiskSpaceMeter::paint(Graphics& g)
 {
 
@@ -168,12 +277,24 @@ void DiskSpaceMeter::paint(Graphics& g)
     if (diskFree > 0)
         g.fillRect(0.0f,0.0f,getWidth()*diskFree,float(getHeight()));
 
-    g.setColour(Colours::black);
+    // share of the measured disk capacity the recording needs, along the bottom edge
+    const bool fallingBehind = isFallingBehind();
+    if (lastUpdateTime > 0 && sustainedRate > 0)
+    {
+        g.setColour(fallingBehind ? Colours::red : Colours::orange);
+        g.fillRect(0.0f,getHeight()-3.0f,getWidth()*float(jmin(1.0, requiredRate/sustainedRate)),3.0f);
+    }
+
+    g.setColour(fallingBehind ? Colours::red : Colours::black);
     g.drawRect(0,0,getWidth(),getHeight(),1);
 
+    g.setColour(Colours::black);
     g.setFont(font);
     g.drawSingleLineText("DF",75,12);
 
+    if (showForecast && requiredRate > 0)
+        g.drawSingleLineText(formatDuration(freeBytes/requiredRate),4,12);
+
 }
 
 Clock::Clock() : isRunning(false), isRecording(false)
@@ -475,7 +596,52 @@ ControlPanel::ControlPanel(ProcessorGraph* graph_, AudioComponent* audio_)
 
 ControlPanel::~ControlPanel()
 {
+    if (performanceWindow != nullptr)
+        delete performanceWindow.get();
+}
+
+void ControlPanel::showPerformancePanel()
+{
+    if (performanceWindow == nullptr)
+        performanceWindow = new PerformanceWindow();
+
+    performanceWindow->setVisible(true);
+    performanceWindow->toFront(true);
+}
+
+void ControlPanel::showRecordSettings()
+{
+    RecordNode* recordNode = graph->getRecordNode();
+
+    AlertWindow w("Record settings",
+                  "The pre-trigger buffer keeps the last seconds of the data set to record while acquiring, "
+                  "and writes them at the start of the next recording.\n\n"
+                  "With a snippet window, only the data around each trigger is written instead: the rising "
+                  "edges of a TTL line (-1 for none) and/or every spike. A window of 0 and 0 ms records everything.",
+                  AlertWindow::NoIcon);
+
+    w.addTextEditor("preTriggerSeconds", String(recordNode->getPreTriggerSeconds()), "Pre-trigger seconds:");
+    w.addTextEditor("snippetPreMs", String(recordNode->getSnippetPreMs()), "Snippet ms before a trigger:");
+    w.addTextEditor("snippetPostMs", String(recordNode->getSnippetPostMs()), "Snippet ms after a trigger:");
+    w.addTextEditor("snippetTTLLine", String(recordNode->getSnippetTTLLine()), "Snippet TTL line:");
+
+    StringArray spikeOptions;
+    spikeOptions.add("No");
+    spikeOptions.add("Yes");
+    w.addComboBox("snippetSpikes", spikeOptions, "Snippets on spikes:");
+    w.getComboBoxComponent("snippetSpikes")->setSelectedItemIndex(recordNode->getSnippetSpikeTriggers() ? 1 : 0, dontSendNotification);
+
+    w.addButton("OK", 1, KeyPress(KeyPress::returnKey));
+    w.addButton("Cancel", 0, KeyPress(KeyPress::escapeKey));
+
+    if (w.runModalLoop() != 1)
+        return;
 
+    recordNode->setPreTriggerSeconds(jmax(0, w.getTextEditorContents("preTriggerSeconds").getIntValue()));
+    recordNode->setSnippetWindow(jmax(0, w.getTextEditorContents("snippetPreMs").getIntValue()),
+                                 jmax(0, w.getTextEditorContents("snippetPostMs").getIntValue()));
+    recordNode->setSnippetTriggers(jmax(-1, w.getTextEditorContents("snippetTTLLine").getIntValue()),
+                                   w.getComboBoxComponent("snippetSpikes")->getSelectedItemIndex() == 1);
 }
 
 void ControlPanel::setRecordState(bool t)
@@ -540,8 +706,11 @@ void ControlPanel::updateRecordEngineList()
 	{
 		Plugin::RecordEngineInfo info;
 		info = AccessClass::getPluginManager()->getRecordEngineInfo(i);
+		EngineManagerCreator creator = AccessClass::getPluginManager()->getRecordEngineCreator(i);
+		if (creator == nullptr)
+			continue;
 		recordSelector->addItem(info.name, id++);
-		recordEngines.add(info.creator());
+		recordEngines.add(creator());
 	}
 	if (selectedEngine < 1)
 		recordSelector->setSelectedId(1, sendNotification);
@@ -1005,6 +1174,19 @@ void ControlPanel::refreshMeters()
     if (playButton->getToggleState())
     {
         cpuMeter->updateCPU(audio->deviceManager.getCpuUsage());
+
+        BufferStats sourceStats;
+        Array<GenericProcessor*> processors = graph->getListOfProcessors();
+        for (int i = 0; i < processors.size(); i++)
+        {
+            SourceNode* source = dynamic_cast<SourceNode*>(processors[i]);
+            if (source != nullptr && source->getThread() != nullptr)
+            {
+                for (int sub = 0; sub < source->getNumSubProcessors(); sub++)
+                    sourceStats.merge(source->getThread()->getBufferStats(sub));
+            }
+        }
+        cpuMeter->updateBufferStats(sourceStats, graph->getRecordNode()->getDataQueueStats());
     }
     else
     {
@@ -1015,7 +1197,14 @@ void ControlPanel::refreshMeters()
 
     masterClock->repaint();
 
-    diskMeter->updateDiskSpace(graph->getRecordNode()->getFreeSpace());
+    RecordNode* recordNode = graph->getRecordNode();
+    const bool wasFallingBehind = diskMeter->isFallingBehind();
+    diskMeter->updateDiskSpace(recordNode->getFreeSpace());
+    diskMeter->updateWriteRate(recordNode->getFreeBytes(), recordNode->getConfiguredDataRate(),
+                               recordNode->getNumBytesWritten(), recordNode->getRecordThreadLoadCounters(),
+                               playButton->getToggleState(), recordButton->getToggleState());
+    if (diskMeter->isFallingBehind() && !wasFallingBehind)
+        CoreServices::sendStatusMessage("Warning: the data disk is barely keeping up with the recording");
     diskMeter->repaint();
 
     if (initialize)
@@ -1095,6 +1284,13 @@ void ControlPanel::saveStateToXml(XmlElement* xml)
     controlPanelState->setAttribute("prependText",prependText->getText());
     controlPanelState->setAttribute("appendText",appendText->getText());
     controlPanelState->setAttribute("recordEngine",recordEngines[recordSelector->getSelectedId()-1]->getID());
+    controlPanelState->setAttribute("preTriggerSeconds", graph->getRecordNode()->getPreTriggerSeconds());
+    controlPanelState->setAttribute("snippetPreMs", graph->getRecordNode()->getSnippetPreMs());
+    controlPanelState->setAttribute("snippetPostMs", graph->getRecordNode()->getSnippetPostMs());
+    controlPanelState->setAttribute("snippetTTLLine", graph->getRecordNode()->getSnippetTTLLine());
+    controlPanelState->setAttribute("snippetSpikes", graph->getRecordNode()->getSnippetSpikeTriggers());
+    controlPanelState->setAttribute("maxWriteLatencyMs", graph->getRecordNode()->getMaxWriteLatency());
+    controlPanelState->setAttribute("numWriterThreads", graph->getRecordNode()->getNumWriterThreads());
 
     audioEditor->saveStateToXml(xml);
 
@@ -1132,6 +1328,12 @@ void ControlPanel::loadStateFromXml(XmlElement* xml)
 				}
 			}
 
+            graph->getRecordNode()->setPreTriggerSeconds(xmlNode->getIntAttribute("preTriggerSeconds", 0));
+            graph->getRecordNode()->setSnippetWindow(xmlNode->getIntAttribute("snippetPreMs", 0), xmlNode->getIntAttribute("snippetPostMs", 0));
+            graph->getRecordNode()->setSnippetTriggers(xmlNode->getIntAttribute("snippetTTLLine", -1), xmlNode->getBoolAttribute("snippetSpikes", false));
+            graph->getRecordNode()->setMaxWriteLatency(xmlNode->getIntAttribute("maxWriteLatencyMs", RECORD_THREAD_MAX_LATENCY_MS));
+            graph->getRecordNode()->setNumWriterThreads(xmlNode->getIntAttribute("numWriterThreads", 1));
+
             bool isOpen = xmlNode->getBoolAttribute("isOpen");
             openState(isOpen);
 
@@ -33,6 +33,7 @@
 #include "LookAndFeel/CustomLookAndFeel.h"
 #include "../AccessClass.h"
 #include "../Processors/Editors/GenericEditor.h" // for UtilityButton
+#include "PerformancePanel.h"
 #include <queue>
 
 /**
@@ -106,6 +107,13 @@ public:
          the ControlPanel. */
     void updateCPU(float usage);
 
+    /** Updates the buffer fill level and overflow counters shown
+        below the CPU load. Called by the ControlPanel. */
+    void updateBufferStats(const BufferStats& sourceStats, const BufferStats& recordStats);
+
+    /** Opens the PerformancePanel. */
+    void mouseDown(const MouseEvent& e) override;
+
     /** Draws the CPUMeter. */
     void paint(Graphics& g);
 
@@ -116,6 +124,9 @@ private:
     float cpu;
     float lastCpu;
 
+    float bufferFill;
+    bool samplesDropped;
+
 };
 
 /**
@@ -125,7 +136,13 @@ private:
   The DiskSpaceMeter is located in the ControlPanel. When the GUI is launched (or the data directory
   is changed), a built-in JUCE method is used to find the amount of free space.
 
-  Note that the DiskSpaceMeter currently displays only relative, not absolute disk space.
+  While acquiring, it also shows how long the free space lasts at the rate being recorded, and
+  while recording it measures the rate the record thread and disk actually sustain (bytes written
+  per second spent writing). A strip along the bottom shows how much of that capacity is used, and
+  the meter turns red once it has stayed close to the required rate for a few seconds, before the
+  record queue starts to fill.
+
+  Note that the bar itself shows only relative, not absolute disk space.
 
   @see ControlPanel
 
@@ -141,6 +158,15 @@ public:
     	the ControlPanel. */
     void updateDiskSpace(float percent);
 
+    /** Updates the time-to-full forecast. configuredRate is the bytes per second of the
+        channels set to record; bytesWritten and writerLoad are the record thread totals of
+        the current recording. Called by the ControlPanel. */
+    void updateWriteRate(int64 freeBytes, double configuredRate, int64 bytesWritten,
+                         const ThreadLoadMonitor::Counters& writerLoad, bool acquiring, bool recording);
+
+    /** Returns true if the disk has been writing barely faster than the data arrive. */
+    bool isFallingBehind() const;
+
     /** Draws the DiskSpaceMeter. */
     void paint(Graphics& g);
 
@@ -150,6 +176,16 @@ private:
 
     float diskFree;
 
+    int64 freeBytes;
+    double requiredRate;
+    double sustainedRate;
+    bool showForecast;
+    int numSlowUpdates;
+
+    int64 lastBytesWritten;
+    ThreadLoadMonitor::Counters lastWriterLoad;
+    double lastUpdateTime;
+
 };
 
 /**
@@ -369,6 +405,15 @@ public:
 
 	bool setSelectedRecordEngineId(String id);
 
+    /** Opens the window showing the load of the audio callback, data threads, record
+        thread and visualizers, or brings it to the front. */
+    void showPerformancePanel();
+
+    /** Asks for the record node options that are otherwise only set from the saved
+        configuration, such as the pre-trigger buffer and the snippet recording. They take effect when acquisition
+        next starts, so the dialog isn't offered while acquiring. */
+    void showRecordSettings();
+
     ScopedPointer<RecordButton> recordButton;
 private:
     ScopedPointer<PlayButton> playButton;
@@ -376,6 +421,7 @@ private:
     ScopedPointer<Clock> masterClock;
     ScopedPointer<CPUMeter> cpuMeter;
     ScopedPointer<DiskSpaceMeter> diskMeter;
+    WeakReference<PerformanceWindow> performanceWindow;
     ScopedPointer<FilenameComponent> filenameComponent;
     ScopedPointer<UtilityButton> newDirectoryButton;
     ScopedPointer<ControlPanelButton> cpb;
@@ -30,6 +30,7 @@
 #include "../Processors/MessageCenter/MessageCenterEditor.h"
 #include "ProcessorList.h"
 #include "../Processors/ProcessorGraph/ProcessorGraph.h"
+#include "../Utils/XmlSnapshot.h"
 
 EditorViewport::EditorViewport()
     : leftmostEditor(0),
@@ -177,7 +178,7 @@ bool EditorViewport::isInterestedInDragSource(const SourceDetails& dragSourceDet
 
 void EditorViewport::itemDragEnter(const SourceDetails& dragSourceDetails)
 {
-    if (canEdit)
+    if (canEdit || !CoreServices::getRecordingStatus())
     {
         somethingIsBeingDraggedOver = true;
         repaint();
@@ -190,7 +191,7 @@ void EditorViewport::itemDragMove(const SourceDetails& dragSourceDetails)
     int x = dragSourceDetails.localPosition.getX();
     // int y = dragSourceDetails.localPosition.getY();
 
-    if (canEdit)
+    if (canEdit || !CoreServices::getRecordingStatus())
     {
         bool foundInsertionPoint = false;
 
@@ -239,8 +240,20 @@ void EditorViewport::itemDropped(const SourceDetails& dragSourceDetails)
 	var descr = dragSourceDetails.description;
 	Array<var>* description = descr.getArray();
 
-    if (canEdit)
+    const bool live = !canEdit && canEditLive((*description)[4].toString() == "Sources");
+
+    if (!canEdit && !live)
+    {
+        somethingIsBeingDraggedOver = false;
+        repaint();
+    }
+
+    if (canEdit || live)
     {
+        // the new processor is started with the rest of the chain when the edit ends
+        ScopedPointer<ProcessorGraph::LiveEdit> liveEdit;
+        if (live)
+            liveEdit = new ProcessorGraph::LiveEdit(*AccessClass::getProcessorGraph());
 
         message = "last filter dropped: " + (*description)[1].toString();
 
@@ -319,7 +332,14 @@ void EditorViewport::makeEditorVisible(GenericEditor* editor, bool highlight, bo
 	if (editor == 0)
 	{
 		if (updateSettings)
+		{
+			// no particular processor changed, so rebuild the settings of all of them
+			Array<GenericProcessor*> processors = AccessClass::getProcessorGraph()->getListOfProcessors();
+			for (int i = 0; i < processors.size(); i++)
+				processors[i]->setSettingsChanged();
+
 			signalChainManager->updateProcessorSettings();
+		}
 		return;
 	}
 
@@ -352,11 +372,34 @@ void EditorViewport::makeEditorVisible(GenericEditor* editor, bool highlight, bo
 
 }
 
+bool EditorViewport::canEditLive(bool isSource)
+{
+    if (isSource)
+    {
+        CoreServices::sendStatusMessage("Sources can't be added or removed while acquisition is active.");
+        return false;
+    }
+
+    if (CoreServices::getRecordingStatus())
+    {
+        CoreServices::sendStatusMessage("Stop recording to add or remove processors.");
+        return false;
+    }
+
+    return true;
+}
+
 void EditorViewport::deleteNode(GenericEditor* editor)
 {
 
-    if (canEdit)
+    const bool live = !canEdit && canEditLive(editor->getProcessor()->isSource());
+
+    if (canEdit || live)
     {
+        ScopedPointer<ProcessorGraph::LiveEdit> liveEdit;
+        if (live)
+            liveEdit = new ProcessorGraph::LiveEdit(*AccessClass::getProcessorGraph());
+
         indexOfMovingComponent = editorArray.indexOf(editor);
         editor->setVisible(false);
 
@@ -561,17 +604,25 @@ bool EditorViewport::keyPressed(const KeyPress& key)
 
     //std::cout << "Editor viewport received " << key.getKeyCode() << std::endl;
 
-    if (canEdit && editorArray.size() > 0)
+    const bool deleting = key.getKeyCode() == key.deleteKey || key.getKeyCode() == key.backspaceKey;
+
+    // during acquisition only deleting is allowed, as far as deleteNode() accepts it
+    if ((canEdit || deleting) && editorArray.size() > 0)
     {
 
         ModifierKeys mk = key.getModifiers();
 
-        if (key.getKeyCode() == key.deleteKey || key.getKeyCode() == key.backspaceKey)
+        if (deleting)
         {
 
             if (!mk.isAnyModifierKeyDown())
             {
 
+                // all the selected processors go in a single edit
+                ScopedPointer<ProcessorGraph::LiveEdit> liveEdit;
+                if (!canEdit && !CoreServices::getRecordingStatus())
+                    liveEdit = new ProcessorGraph::LiveEdit(*AccessClass::getProcessorGraph());
+
                 Array<GenericEditor*> editorsToRemove;
 
                 for (int i = 0; i < editorArray.size(); i++)
@@ -703,7 +754,7 @@ void EditorViewport::mouseDown(const MouseEvent& e)
                 else
                     m.addItem(3, "Collapse", true);
 
-                if (canEdit)
+                if (canEdit || (!editorArray[i]->getProcessor()->isSource() && !CoreServices::getRecordingStatus()))
                     m.addItem(2, "Delete", true);
                 else
                     m.addItem(2, "Delete", false);
@@ -1311,6 +1362,7 @@ const String EditorViewport::saveState(File fileToUse, String* xmlText)
 	AccessClass::getProcessorGraph()->getTimestampSources(tsID, tsSubID);
 	timestampSettings->setAttribute("selected_index", tsID);
 	timestampSettings->setAttribute("selected_sub_index", tsSubID);
+	timestampSettings->setAttribute("sync_line", AccessClass::getProcessorGraph()->getClockSync().getSyncLine());
 	xml->addChildElement(timestampSettings);
 
     //Resets Save Order for processors, allowing them to be saved again without omitting themselves from the order.
@@ -1324,7 +1376,12 @@ const String EditorViewport::saveState(File fileToUse, String* xmlText)
     AccessClass::getProcessorList()->saveStateToXml(xml);
     AccessClass::getUIComponent()->saveStateToXml(xml);  // save the UI settings
 
-    if (! xml->writeToFile(currentFile, String::empty))
+    // XML is kept for any other extension, so that configurations can still be read and edited
+    const bool written = currentFile.hasFileExtension(XmlSnapshot::fileExtension)
+        ? XmlSnapshot::write(*xml, currentFile)
+        : xml->writeToFile(currentFile, String::empty);
+
+    if (! written)
         error = "Couldn't write to file ";
     else
         error = "Saved configuration as ";
@@ -1366,8 +1423,16 @@ const String EditorViewport::loadState(File fileToLoad)
 
     Array<GenericProcessor*> splitPoints;
 
-    XmlDocument doc(currentFile);
-    XmlElement* xml = doc.getDocumentElement();
+    XmlElement* xml;
+    if (XmlSnapshot::isSnapshot(currentFile))
+    {
+        xml = XmlSnapshot::read(currentFile);
+    }
+    else
+    {
+        XmlDocument doc(currentFile);
+        xml = doc.getDocumentElement();
+    }
 
     if (xml == 0 || ! xml->hasTagName("SETTINGS"))
     {
@@ -1503,6 +1568,14 @@ const String EditorViewport::loadState(File fileToLoad)
 						}
 					}
 
+					//The beta LFP viewer was merged back into the LFP viewer
+					if (procDesc[4].toString().equalsIgnoreCase("LFP viewer Beta"))
+					{
+						procDesc.set(1, "LFP Viewer"); //pluginName
+						procDesc.set(4, "LFP viewer"); //libraryName
+						procDesc.set(5, 1); //libraryVersion
+					}
+
                     SourceDetails sd = SourceDetails(procDesc,
                                                      0,
                                                      Point<int>(0,0));
@@ -1582,6 +1655,7 @@ const String EditorViewport::loadState(File fileToLoad)
 			int tsID = element->getIntAttribute("selected_index", -1);
 			int tsSubID = element->getIntAttribute("selected_sub_index");
 			AccessClass::getProcessorGraph()->setTimestampSource(tsID, tsSubID);
+			AccessClass::getProcessorGraph()->getClockSync().setSyncLine(element->getIntAttribute("sync_line", -1));
 		}
 
     }
@@ -1603,8 +1677,6 @@ const String EditorViewport::loadState(File fileToLoad)
 
     refreshEditors();
 
-    AccessClass::getProcessorGraph()->restoreParameters();
-
     String error = "Opened ";
     error += currentFile.getFileName();
 
@@ -177,6 +177,11 @@ public:
 
 private:
 
+    /** Returns true if a processor can be added or removed while acquisition runs,
+    which it can unless it is a source or a recording is open. Says why not in the
+    status bar otherwise. */
+    bool canEditLive(bool isSource);
+
     String message;
     bool somethingIsBeingDraggedOver;
     bool shiftDown;
@@ -22,6 +22,7 @@
  */
 
 #include "GraphViewer.h"
+#include "../Processors/ProcessorGraph/ProcessorGraph.h"
 
 GraphViewer::GraphViewer()
 {
@@ -29,6 +30,8 @@ GraphViewer::GraphViewer()
     currentVersionText = "GUI version " + app->getApplicationVersion();
     
     rootNum = 0;
+
+    startTimer (500);
 }
 
 
@@ -37,6 +40,13 @@ GraphViewer::~GraphViewer()
 }
 
 
+void GraphViewer::timerCallback()
+{
+    if (CoreServices::getAcquisitionStatus() && isShowing())
+        repaint();
+}
+
+
 void GraphViewer::addNode (GenericEditor* editor)
 {
     GraphNode* gn = new GraphNode (editor, this);
@@ -252,6 +262,18 @@ void GraphViewer::paint (Graphics& g)
     
     g.setFont (Font("Small Text", 14, Font::plain));
     g.drawFittedText (currentVersionText, 40, 40, getWidth()-50, getHeight()-45, Justification::bottomRight, 100);
+
+    // Callback budget breakdown: where the time of one buffer goes
+    Array<ProcessorGraph::ProcessorLoad> loads;
+    double budgetMs = 0;
+    ProcessTimeStatistics::Summary callback = AccessClass::getProcessorGraph()->getProcessorLoads (loads, budgetMs);
+
+    if (callback.numBlocks > 0 && budgetMs > 0)
+    {
+        String text = "Callback " + String (callback.meanMs, 2) + " ms of " + String (budgetMs, 1)
+            + " ms budget (p99 " + String (callback.p99Ms, 2) + ", max " + String (callback.maxMs, 2) + ")";
+        g.drawFittedText (text, 40, 40, getWidth()-50, getHeight()-65, Justification::bottomRight, 1);
+    }
     
     // Draw connections
     const int numAvailableNodes = availableNodes.size();
@@ -469,4 +491,32 @@ void GraphNode::paint (Graphics& g)
     g.fillEllipse (2, 2, 16, 16);
     
     g.drawText (getName(), 25, 0, getWidth() - 25, 20, Justification::left, true);
+
+    ProcessTimeStatistics::Summary time = editor->getProcessor()->getProcessTimeSummary();
+    if (time.numBlocks > 0)
+    {
+        const double budgetMs = AccessClass::getProcessorGraph()->getCallbackBudgetMs();
+        String text = String (time.meanMs, 2) + " / " + String (time.p99Ms, 2) + " ms";
+        if (budgetMs > 0)
+            text << " (" << String (100.0 * time.meanMs / budgetMs, 1) << "%)";
+
+        g.setFont (Font ("Small Text", 11, Font::plain));
+        g.drawText (text, 25, 18, getWidth() - 25, 14, Justification::left, true);
+    }
+
+    MemoryUsage memory;
+    editor->getProcessor()->getMemoryUsage (memory);
+    if (memory.getTotalBytes() > 0)
+    {
+        g.setFont (Font ("Small Text", 11, Font::plain));
+        g.drawText (MemoryUsage::formatBytes (memory.getTotalBytes()), 25, 32, getWidth() - 25, 14, Justification::left, true);
+    }
+}
+
+
+String GraphNode::getTooltip()
+{
+    MemoryUsage memory;
+    editor->getProcessor()->getMemoryUsage (memory);
+    return memory.getDescription();
 }
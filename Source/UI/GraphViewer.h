@@ -41,12 +41,16 @@
 
 
 class GraphNode : public Component
+                , public TooltipClient
 {
 public:
     GraphNode (GenericEditor* editor, GraphViewer* g);
     ~GraphNode();
     
     void paint (Graphics& g)    override;
+
+    /** Lists the memory taken by the processor's buffers */
+    String getTooltip() override;
     
     void mouseEnter (const MouseEvent& event) override;
     void mouseExit  (const MouseEvent& event) override;
@@ -85,6 +89,7 @@ private:
 
 
 class GraphViewer : public Component
+                  , private Timer
 {
 public:
     GraphViewer();
@@ -104,6 +109,9 @@ public:
     
     
 private:
+    /** Repaints the process time of each node while acquisition is running. */
+    void timerCallback() override;
+
     void connectNodes (int, int, Graphics&);
     void checkLayout (GraphNode*);
     
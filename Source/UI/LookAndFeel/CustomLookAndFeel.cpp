@@ -24,40 +24,29 @@
 #include "CustomLookAndFeel.h"
 #include "../CustomArrowButton.h"
 
-CustomLookAndFeel::CustomLookAndFeel() :
-    // third argument to MIS means don't copy the binary data to make a new stream
-    cpmonoExtraLightStream(BinaryData::cpmonoextralightserialized,
-                           BinaryData::cpmonoextralightserializedSize,
-                           false),
-    cpmonoLightStream(BinaryData::cpmonolightserialized,
-                      BinaryData::cpmonolightserializedSize,
-                      false),
-    cpmonoPlainStream(BinaryData::cpmonoplainserialized,
-                      BinaryData::cpmonoplainserializedSize,
-                      false),
-    cpmonoBoldStream(BinaryData::cpmonoboldserialized,
-                     BinaryData::cpmonoboldserializedSize,
-                     false),
-    cpmonoBlackStream(BinaryData::cpmonoblackserialized,
-                      BinaryData::cpmonoblackserializedSize,
-                      false),
-    misoRegularStream(BinaryData::misoserialized,
-                      BinaryData::misoserializedSize,
-                      false),
-    silkscreenStream(BinaryData::silkscreenserialized,
-                     BinaryData::silkscreenserializedSize,
-                     false),
-    // heap allocation is necessary here, because otherwise the typefaces are
-    // deleted too soon (there's a singleton typefacecache that holds references
-    // to them whenever they're used).
-    cpmonoExtraLight(new CustomTypeface(cpmonoExtraLightStream)),
-    cpmonoLight(new CustomTypeface(cpmonoLightStream)),
-    cpmonoPlain(new CustomTypeface(cpmonoPlainStream)),
-    cpmonoBold(new CustomTypeface(cpmonoBoldStream)),
-    cpmonoBlack(new CustomTypeface(cpmonoBlackStream)),
-    misoRegular(new CustomTypeface(misoRegularStream)),
-    silkscreen(new CustomTypeface(silkscreenStream))
+namespace
+{
+    struct EmbeddedTypeface
+    {
+        const char* name;
+        const char* data;
+        int size;
+    };
+
+    // the serialized typefaces in BinaryData, in the order of CustomLookAndFeel::EmbeddedTypefaces
+    const EmbeddedTypeface embeddedTypefaces[] =
+    {
+        { "Default Extra Light", BinaryData::cpmonoextralightserialized, BinaryData::cpmonoextralightserializedSize },
+        { "Default Light", BinaryData::cpmonolightserialized, BinaryData::cpmonolightserializedSize },
+        { "Default", BinaryData::cpmonoplainserialized, BinaryData::cpmonoplainserializedSize },
+        { "Default Bold", BinaryData::cpmonoboldserialized, BinaryData::cpmonoboldserializedSize },
+        { "Default Black", BinaryData::cpmonoblackserialized, BinaryData::cpmonoblackserializedSize },
+        { "Paragraph", BinaryData::misoserialized, BinaryData::misoserializedSize },
+        { "Small Text", BinaryData::silkscreenserialized, BinaryData::silkscreenserializedSize }
+    };
+}
 
+CustomLookAndFeel::CustomLookAndFeel()
 {
 
     // UNCOMMENT AFTER UPDATE
@@ -103,39 +92,14 @@ Typeface::Ptr CustomLookAndFeel::getTypefaceForFont(const Font& font)
 
     // some of these names might be unnecessary, and there may be good ones
     // missing.  adjust as needed
-    if (typefaceName.equalsIgnoreCase("Default Extra Light"))
-    {
-        return cpmonoExtraLight;
-    }
-    else if (typefaceName.equalsIgnoreCase("Default Light"))
-    {
-        return cpmonoLight;
-    }
-    else if (typefaceName.equalsIgnoreCase("Default"))
-    {
-        return cpmonoPlain;
-    }
-    else if (typefaceName.equalsIgnoreCase("Default Bold"))
-    {
-        return cpmonoBold;
-    }
-    else if (typefaceName.equalsIgnoreCase("Default Black"))
+    for (int i = 0; i < numEmbeddedTypefaces; ++i)
     {
-        return cpmonoBlack;
-    }
-    else if (typefaceName.equalsIgnoreCase("Paragraph"))
-    {
-        return misoRegular;
-    }
-    else if (typefaceName.equalsIgnoreCase("Small Text"))
-    {
-        return silkscreen;
-    }
-    else   // default
-    {
-        return LookAndFeel::getTypefaceForFont(font);
+        if (typefaceName.equalsIgnoreCase(embeddedTypefaces[i].name))
+            return getEmbeddedTypeface(i);
     }
 
+    return LookAndFeel::getTypefaceForFont(font);
+
     // UNCOMMENT AFTER UPDATE
     // if (typefaceMap.contains(typefaceName))
     //     return typefaceMap[typefaceName];
@@ -143,6 +107,25 @@ Typeface::Ptr CustomLookAndFeel::getTypefaceForFont(const Font& font)
     //     return LookAndFeel::getTypefaceForFont(font);
 }
 
+Typeface::Ptr CustomLookAndFeel::getEmbeddedTypeface(int index)
+{
+    // each typeface is only deserialized the first time a font asks for it, most of
+    // them aren't needed to draw the first window
+    const ScopedLock sl(typefaceLock);
+
+    if (typefaces[index] == nullptr)
+    {
+        // the third argument means don't copy the binary data to make a new stream.
+        // heap allocation is necessary here, because otherwise the typefaces are
+        // deleted too soon (there's a singleton typefacecache that holds references
+        // to them whenever they're used).
+        MemoryInputStream stream(embeddedTypefaces[index].data, embeddedTypefaces[index].size, false);
+        typefaces[index] = new CustomTypeface(stream);
+    }
+
+    return typefaces[index];
+}
+
 //==================================================================
 // SCROLL BAR METHODS :
 //==================================================================
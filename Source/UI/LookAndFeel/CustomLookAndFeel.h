@@ -118,23 +118,23 @@ private:
     // this maps strings to customtypeface pointers
     HashMap<String, Typeface::Ptr> typefaceMap;
 
-    MemoryInputStream
-    cpmonoExtraLightStream,
-    cpmonoLightStream,
-    cpmonoPlainStream,
-    cpmonoBoldStream,
-    cpmonoBlackStream,
-    misoRegularStream,
-    silkscreenStream;
-
-    Typeface::Ptr
-    cpmonoExtraLight,
-    cpmonoLight,
-    cpmonoPlain,
-    cpmonoBold,
-    cpmonoBlack,
-    misoRegular,
-    silkscreen;
+    enum EmbeddedTypefaces
+    {
+        cpmonoExtraLight = 0,
+        cpmonoLight,
+        cpmonoPlain,
+        cpmonoBold,
+        cpmonoBlack,
+        misoRegular,
+        silkscreen,
+        numEmbeddedTypefaces
+    };
+
+    /** Returns one of the typefaces compiled into BinaryData, loading it on first use */
+    Typeface::Ptr getEmbeddedTypeface(int index);
+
+    Typeface::Ptr typefaces[numEmbeddedTypefaces];
+    CriticalSection typefaceLock;
 
 };
 
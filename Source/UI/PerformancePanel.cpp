@@ -0,0 +1,377 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "PerformancePanel.h"
+#include "../AccessClass.h"
+#include "../CoreServices.h"
+#include "../Audio/AudioComponent.h"
+#include "../Processors/ProcessorGraph/ProcessorGraph.h"
+#include "../Processors/SourceNode/SourceNode.h"
+#include "../Processors/RecordNode/RecordNode.h"
+#include "../Processors/Visualization/VisualizerScheduler.h"
+#include "../Processors/GenericProcessor/TraceRecorder.h"
+
+namespace
+{
+	const int ROW_HEIGHT = 36;
+	const int NAME_WIDTH = 150;
+	const int TEXT_WIDTH = 300;
+	const int SPARKLINE_WIDTH = 160;
+	const int MARGIN = 8;
+	const int BUTTON_HEIGHT = 24;
+
+	// Fraction of the callback budget, or of a buffer, above which a row turns red
+	const double WARNING_LOAD = 0.75;
+	const float WARNING_FILL = 0.5f;
+}
+
+PerformancePanel::PerformancePanel()
+{
+	m_captureButton = new ToggleButton("Capture trace");
+	m_captureButton->setColour(ToggleButton::textColourId, Colours::white);
+	m_captureButton->setToggleState(TraceRecorder::isEnabled(), dontSendNotification);
+	m_captureButton->addListener(this);
+	addAndMakeVisible(m_captureButton);
+
+	m_saveButton = new TextButton("Save trace...");
+	m_saveButton->addListener(this);
+	addAndMakeVisible(m_saveButton);
+
+	setSize(NAME_WIDTH + TEXT_WIDTH + SPARKLINE_WIDTH + 4 * MARGIN, ROW_HEIGHT + BUTTON_HEIGHT + 3 * MARGIN);
+	timerCallback();
+	startTimer(250);
+}
+
+PerformancePanel::~PerformancePanel()
+{
+	stopTimer();
+}
+
+PerformancePanel::Row& PerformancePanel::getRow(const String& key, const String& name, float scale)
+{
+	for (int i = 0; i < m_rows.size(); i++)
+	{
+		if (m_rows[i]->key == key)
+		{
+			m_rows[i]->name = name;
+			return *m_rows[i];
+		}
+	}
+
+	Row* row = new Row();
+	row->key = key;
+	row->name = name;
+	row->warning = false;
+	row->updated = false;
+	row->scale = scale;
+	row->numValues = 0;
+	row->previousBytes = 0;
+	row->previousTime = 0;
+	return *m_rows.add(row);
+}
+
+void PerformancePanel::addValue(Row& row, float value, const String& text, bool warning)
+{
+	if (row.numValues == historySize)
+	{
+		memmove(row.history, row.history + 1, (historySize - 1) * sizeof(float));
+		row.numValues--;
+	}
+	row.history[row.numValues++] = value;
+	row.text = text;
+	row.warning = warning;
+	row.updated = true;
+}
+
+void PerformancePanel::timerCallback()
+{
+	for (int i = 0; i < m_rows.size(); i++)
+		m_rows[i]->updated = false;
+
+	updateCallbackRow();
+	updateSourceRows();
+	updateRecordRow();
+	updateVisualizerRow();
+	updateMemoryRow();
+
+	// sources removed from the signal chain
+	for (int i = m_rows.size(); --i >= 0;)
+	{
+		if (!m_rows[i]->updated)
+			m_rows.remove(i);
+	}
+
+	setSize(getWidth(), m_rows.size() * ROW_HEIGHT + BUTTON_HEIGHT + 3 * MARGIN);
+	repaint();
+}
+
+void PerformancePanel::resized()
+{
+	const int y = getHeight() - MARGIN - BUTTON_HEIGHT;
+	m_captureButton->setBounds(MARGIN, y, 140, BUTTON_HEIGHT);
+	m_saveButton->setBounds(2 * MARGIN + 140, y, 110, BUTTON_HEIGHT);
+}
+
+void PerformancePanel::buttonClicked(Button* button)
+{
+	if (button == m_captureButton)
+	{
+		TraceRecorder::setEnabled(m_captureButton->getToggleState());
+	}
+	else if (button == m_saveButton)
+	{
+		FileChooser fc("Save trace", CoreServices::getDefaultUserSaveDirectory().getChildFile("trace.json"), "*.json");
+		if (fc.browseForFileToSave(true))
+		{
+			const File file = fc.getResult();
+			if (TraceRecorder::writeChromeTrace(file))
+				CoreServices::sendStatusMessage("Saved trace to " + file.getFullPathName());
+			else
+				CoreServices::sendStatusMessage("Could not write trace to " + file.getFullPathName());
+		}
+	}
+}
+
+void PerformancePanel::updateCallbackRow()
+{
+	ProcessorGraph* graph = AccessClass::getProcessorGraph();
+	Row& row = getRow("callback", "Audio callback", 1.0f);
+
+	Array<ProcessorGraph::ProcessorLoad> loads;
+	double budgetMs = 0;
+	const ProcessTimeStatistics::Summary callback = graph->getProcessorLoads(loads, budgetMs);
+
+	if (!CoreServices::getAcquisitionStatus() || callback.numBlocks == 0 || budgetMs <= 0)
+	{
+		addValue(row, 0, "Not acquiring", false);
+		return;
+	}
+
+	const double load = callback.meanMs / budgetMs;
+	const int64 misses = graph->getNumDeadlineMisses();
+	String text = String(roundToInt(load * 100)) + "% of " + String(budgetMs, 1) + " ms, max "
+		+ String(callback.maxMs, 2) + " ms";
+	if (AudioComponent* audio = AccessClass::getAudioComponent())
+		text += ", device " + String(roundToInt(audio->deviceManager.getCpuUsage() * 100)) + "%";
+	if (misses > 0)
+		text += ", " + String(misses) + " overruns";
+
+	addValue(row, float(load), text, load > WARNING_LOAD || misses > 0);
+}
+
+void PerformancePanel::updateSourceRows()
+{
+	Array<GenericProcessor*> processors = AccessClass::getProcessorGraph()->getListOfProcessors();
+	for (int i = 0; i < processors.size(); i++)
+	{
+		SourceNode* source = dynamic_cast<SourceNode*>(processors[i]);
+		if (source == nullptr || source->getThread() == nullptr)
+			continue;
+
+		DataThread* thread = source->getThread();
+		Row& row = getRow("source" + String(source->getNodeId()),
+			source->getName() + " (" + String(source->getNodeId()) + ")", 1.0f);
+
+		BufferStats stats;
+		for (int sub = 0; sub < source->getNumSubProcessors(); sub++)
+			stats.merge(thread->getBufferStats(sub));
+
+		const ThreadLoadMonitor::Counters counters = thread->getLoadCounters();
+		const ThreadLoadMonitor::Load load = ThreadLoadMonitor::getLoad(row.previousLoad, counters);
+		row.previousLoad = counters;
+
+		if (!thread->isThreadRunning())
+		{
+			addValue(row, 0, "Not running", stats.samplesDropped > 0);
+			continue;
+		}
+
+		String text = String(roundToInt(load.loopsPerSecond)) + " loops/s, " + String(roundToInt(load.utilisation * 100))
+			+ "% CPU, buffer " + String(roundToInt(stats.fillFraction * 100)) + "% full";
+		if (stats.samplesDropped > 0)
+			text += ", " + String(stats.samplesDropped) + " dropped";
+
+		addValue(row, float(load.utilisation), text, stats.samplesDropped > 0 || stats.fillFraction > WARNING_FILL);
+	}
+}
+
+void PerformancePanel::updateRecordRow()
+{
+	RecordNode* recordNode = AccessClass::getProcessorGraph()->getRecordNode();
+	Row& row = getRow("record", "Record thread", 0);
+
+	const BufferStats stats = recordNode->getDataQueueStats();
+	const ThreadLoadMonitor::Counters counters = recordNode->getRecordThreadLoadCounters();
+	const ThreadLoadMonitor::Load load = ThreadLoadMonitor::getLoad(row.previousLoad, counters);
+	row.previousLoad = counters;
+
+	const double now = Time::getMillisecondCounterHiRes();
+	const int64 bytes = recordNode->getNumBytesWritten();
+	const double seconds = (now - row.previousTime) / 1000.0;
+	double megabytesPerSecond = 0;
+	if (row.previousTime > 0 && seconds > 0 && bytes >= row.previousBytes)
+		megabytesPerSecond = (bytes - row.previousBytes) / 1e6 / seconds;
+	row.previousBytes = bytes;
+	row.previousTime = now;
+
+	if (!CoreServices::getRecordingStatus())
+	{
+		addValue(row, 0, "Not recording", stats.samplesDropped > 0);
+		return;
+	}
+
+	String text = String(megabytesPerSecond, 2) + " MB/s, queue " + String(roundToInt(stats.fillFraction * 100))
+		+ "% full, " + String(roundToInt(load.utilisation * 100)) + "% CPU";
+	if (stats.samplesDropped > 0)
+		text += ", " + String(stats.samplesDropped) + " dropped";
+
+	addValue(row, float(megabytesPerSecond), text, stats.samplesDropped > 0 || stats.fillFraction > WARNING_FILL);
+}
+
+void PerformancePanel::updateVisualizerRow()
+{
+	Row& row = getRow("visualizers", "Visualizers", 0);
+
+	VisualizerScheduler* scheduler = VisualizerScheduler::getInstanceWithoutCreating();
+	if (scheduler == nullptr || scheduler->getNumVisualizers() == 0)
+	{
+		addValue(row, 0, "None running", false);
+		return;
+	}
+
+	const ProcessTimeStatistics::Summary refresh = scheduler->getRefreshTimeSummary();
+	String text = String(scheduler->getNumVisualizers()) + " running, refresh " + String(refresh.meanMs, 1)
+		+ " ms, max " + String(refresh.maxMs, 1) + " ms";
+	if (scheduler->getThrottle() > 1)
+		text += ", slowed down " + String(scheduler->getThrottle()) + "x";
+
+	addValue(row, float(refresh.lastMs), text, scheduler->getThrottle() > 1);
+}
+
+void PerformancePanel::updateMemoryRow()
+{
+	Row& row = getRow("memory", "Memory", 0);
+
+	Array<GenericProcessor*> processors = AccessClass::getProcessorGraph()->getListOfProcessors();
+	if (RecordNode* recordNode = AccessClass::getProcessorGraph()->getRecordNode())
+		processors.addIfNotAlreadyThere(recordNode);
+
+	int64 total = 0;
+	int64 largest = 0;
+	String largestName;
+	for (int i = 0; i < processors.size(); i++)
+	{
+		MemoryUsage usage;
+		processors[i]->getMemoryUsage(usage);
+		const int64 bytes = usage.getTotalBytes();
+		total += bytes;
+		if (bytes > largest)
+		{
+			largest = bytes;
+			largestName = processors[i]->getName() + " (" + String(processors[i]->getNodeId()) + ")";
+		}
+	}
+
+	String text = MemoryUsage::formatBytes(total) + " in " + String(processors.size()) + " processors";
+	if (largest > 0)
+		text += ", most in " + largestName + " (" + MemoryUsage::formatBytes(largest) + ")";
+
+	addValue(row, float(total / (1024.0 * 1024.0)), text, false);
+}
+
+void PerformancePanel::paint(Graphics& g)
+{
+	g.fillAll(Colour(58, 58, 58));
+	g.setFont(Font("Small Text", 13, Font::plain));
+
+	for (int i = 0; i < m_rows.size(); i++)
+	{
+		const Row& row = *m_rows[i];
+		const int y = MARGIN + i * ROW_HEIGHT;
+		const Colour textColour = row.warning ? Colour(255, 90, 80) : Colours::lightgrey;
+
+		g.setColour(Colours::white);
+		g.drawText(row.name, MARGIN, y, NAME_WIDTH, ROW_HEIGHT, Justification::centredLeft, true);
+
+		g.setColour(textColour);
+		g.drawText(row.text, 2 * MARGIN + NAME_WIDTH, y, TEXT_WIDTH, ROW_HEIGHT, Justification::centredLeft, true);
+
+		drawSparkline(g, row, Rectangle<float>(float(3 * MARGIN + NAME_WIDTH + TEXT_WIDTH), float(y + 4),
+			float(SPARKLINE_WIDTH), float(ROW_HEIGHT - 8)));
+	}
+}
+
+void PerformancePanel::drawSparkline(Graphics& g, const Row& row, Rectangle<float> area) const
+{
+	g.setColour(Colour(40, 40, 40));
+	g.fillRect(area);
+
+	if (row.numValues < 2)
+		return;
+
+	float scale = row.scale;
+	if (scale <= 0)
+	{
+		for (int i = 0; i < row.numValues; i++)
+			scale = jmax(scale, row.history[i]);
+		if (scale <= 0)
+			return;
+	}
+
+	// newest value on the right, one point per poll
+	const float step = area.getWidth() / (historySize - 1);
+	const float x0 = area.getRight() - (row.numValues - 1) * step;
+	Path path;
+	for (int i = 0; i < row.numValues; i++)
+	{
+		const float y = area.getBottom() - jlimit(0.0f, 1.0f, row.history[i] / scale) * area.getHeight();
+		if (i == 0)
+			path.startNewSubPath(x0, y);
+		else
+			path.lineTo(x0 + i * step, y);
+	}
+
+	g.setColour(row.warning ? Colour(255, 90, 80) : Colour(110, 200, 130));
+	g.strokePath(path, PathStrokeType(1.2f));
+}
+
+PerformanceWindow::PerformanceWindow()
+	: DocumentWindow("Performance", Colours::darkgrey, DocumentWindow::closeButton)
+{
+	setUsingNativeTitleBar(true);
+	setResizable(false, false);
+	m_panel = new PerformancePanel();
+	setContentNonOwned(m_panel, true);
+	centreWithSize(getWidth(), getHeight());
+}
+
+PerformanceWindow::~PerformanceWindow()
+{
+	masterReference.clear();
+}
+
+void PerformanceWindow::closeButtonPressed()
+{
+	setVisible(false);
+	delete this;
+}
@@ -0,0 +1,118 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2017 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef PERFORMANCEPANEL_H_INCLUDED
+#define PERFORMANCEPANEL_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "../Processors/GenericProcessor/ThreadLoadMonitor.h"
+
+/**
+	Shows the load of every thread that can make a recording fall behind.
+
+	One row each for the audio callback, the DataThread of every source, the
+	RecordThread and the visualizers, with the current figures and a sparkline of
+	the last half minute. Rows turn red when data is being dropped or a deadline
+	is close, so problems show up before data is lost. A last row adds up the
+	memory the processors report, so buffers that keep growing show up as a
+	rising sparkline. Polls four times a second while it is open.
+
+	The buttons at the bottom start a trace capture of the real-time threads and
+	save it as a Chrome trace, to see what each thread was doing when a row
+	turned red.
+
+	@see ControlPanel, ThreadLoadMonitor
+*/
+class PerformancePanel : public Component,
+	private Timer,
+	private Button::Listener
+{
+public:
+	PerformancePanel();
+	~PerformancePanel();
+
+	void paint(Graphics& g) override;
+	void resized() override;
+
+	static const int historySize = 120;
+
+private:
+	void timerCallback() override;
+	void buttonClicked(Button* button) override;
+
+	struct Row
+	{
+		String key;
+		String name;
+		String text;
+		bool warning;
+		bool updated;
+		/** Full scale of the sparkline, or 0 to fit the history */
+		float scale;
+		float history[historySize];
+		int numValues;
+
+		// counters of the previous poll, to turn totals into rates
+		ThreadLoadMonitor::Counters previousLoad;
+		int64 previousBytes;
+		double previousTime;
+	};
+
+	/** Returns the row with the given key, adding it at the end if needed */
+	Row& getRow(const String& key, const String& name, float scale);
+
+	void addValue(Row& row, float value, const String& text, bool warning);
+
+	void updateCallbackRow();
+	void updateSourceRows();
+	void updateRecordRow();
+	void updateVisualizerRow();
+	void updateMemoryRow();
+
+	void drawSparkline(Graphics& g, const Row& row, Rectangle<float> area) const;
+
+	OwnedArray<Row> m_rows;
+
+	ScopedPointer<ToggleButton> m_captureButton;
+	ScopedPointer<TextButton> m_saveButton;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PerformancePanel);
+};
+
+class PerformanceWindow : public DocumentWindow
+{
+public:
+	PerformanceWindow();
+	~PerformanceWindow();
+	void closeButtonPressed() override;
+
+private:
+	ScopedPointer<PerformancePanel> m_panel;
+
+	WeakReference<PerformanceWindow>::Master masterReference;
+	friend class WeakReference<PerformanceWindow>;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PerformanceWindow);
+};
+
+#endif  // PERFORMANCEPANEL_H_INCLUDED
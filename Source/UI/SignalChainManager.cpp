@@ -165,6 +165,11 @@ void SignalChainManager::updateVisibleEditors(GenericEditor* activeEditor,
 
     enum actions {ADD, MOVE, REMOVE, ACTIVATE, UPDATE};
 
+    // changes to the structure of the chain are picked up by update() itself,
+    // but a change to the settings of a processor has to be flagged
+    if (action == UPDATE && activeEditor != nullptr)
+        activeEditor->getProcessor()->setSettingsChanged();
+
     // Step 1: update the editor array
     if (action == ADD)
     {
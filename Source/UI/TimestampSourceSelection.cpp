@@ -30,7 +30,7 @@ TimestampSourceSelectionWindow::TimestampSourceSelectionWindow()
 	: DocumentWindow("Global timestamp source selection", Colours::red,
 	DocumentWindow::closeButton)
 {
-	centreWithSize(300, 200);
+	centreWithSize(300, 260);
 	setUsingNativeTitleBar(true);
 	setResizable(false, false);
 	m_selectorComponent = new TimestampSourceSelectionComponent();
@@ -63,11 +63,20 @@ void TimestampSourceSelectionWindow::closeButtonPressed()
 //Component
 TimestampSourceSelectionComponent::TimestampSourceSelectionComponent()
 {
-	setSize(300, 200);
+	setSize(300, 260);
 	m_selector = new ComboBox("Timestamp Sources");
 	m_selector->setBounds(50, 150, 200, 30);
 	m_selector->addListener(this);
 	addAndMakeVisible(m_selector);
+
+	m_syncLineSelector = new ComboBox("Sync Line");
+	m_syncLineSelector->setBounds(50, 215, 200, 30);
+	m_syncLineSelector->addItem("No clock sync", 1);
+	for (int i = 0; i < 8; i++)
+		m_syncLineSelector->addItem("Sync pulses on TTL " + String(i + 1), i + 2);
+	m_syncLineSelector->setSelectedId(AccessClass::getProcessorGraph()->getClockSync().getSyncLine() + 2, dontSendNotification);
+	m_syncLineSelector->addListener(this);
+	addAndMakeVisible(m_syncLineSelector);
 	updateProcessorList();
 }
 
@@ -109,10 +118,17 @@ void TimestampSourceSelectionComponent::updateProcessorList()
 		}
 	}
 	m_selector->setSelectedId(selected, dontSendNotification);
+	m_syncLineSelector->setSelectedId(AccessClass::getProcessorGraph()->getClockSync().getSyncLine() + 2, dontSendNotification);
 }
 
 void TimestampSourceSelectionComponent::comboBoxChanged(ComboBox* c)
 {
+	if (c == m_syncLineSelector)
+	{
+		AccessClass::getProcessorGraph()->getClockSync().setSyncLine(c->getSelectedId() - 2);
+		return;
+	}
+
 	int selected = c->getSelectedId() - 2;
 	int sourceIdx, subIdx;
 	if (selected < 0)
@@ -131,6 +147,7 @@ void TimestampSourceSelectionComponent::comboBoxChanged(ComboBox* c)
 void TimestampSourceSelectionComponent::setAcquisitionState(bool s)
 {
 	m_selector->setEnabled(!s);
+	m_syncLineSelector->setEnabled(!s);
 }
 
 void TimestampSourceSelectionComponent::paint(Graphics& g)
@@ -142,4 +159,5 @@ void TimestampSourceSelectionComponent::paint(Graphics& g)
 		"Processors that generate events not based on any existing data streams but do not generate their "
 		"own timestamps will use both the timestamps and sample rate of the selected processor as reference.",
 		10, 30, 280);
+	g.drawMultiLineText("Align the other devices with shared sync pulses:", 10, 205, 280);
 }
\ No newline at end of file
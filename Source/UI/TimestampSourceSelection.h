@@ -48,6 +48,7 @@ private:
 		int subProcessorIndex;
 	};
 	ScopedPointer<ComboBox> m_selector;
+	ScopedPointer<ComboBox> m_syncLineSelector;
 	Array<SourceInfo> m_sourcesArray;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TimestampSourceSelectionComponent);
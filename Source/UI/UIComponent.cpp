@@ -23,6 +23,7 @@
 
 #include "UIComponent.h"
 #include "../Processors/PluginManager/PluginManager.h"
+#include "../Utils/StartupTiming.h"
 #include <stdio.h>
 
 #include "InfoLabel.h"
@@ -35,6 +36,7 @@
 #include "../Processors/ProcessorGraph/ProcessorGraph.h"
 #include "../Audio/AudioComponent.h"
 #include "../MainWindow.h"
+#include "../Processors/GenericProcessor/ThreadPolicy.h"
 
 	UIComponent::UIComponent(MainWindow* mainWindow_, ProcessorGraph* pgraph, AudioComponent* audio_)
 : mainWindow(mainWindow_), processorGraph(pgraph), audio(audio_)
@@ -90,7 +92,10 @@
 
 	AccessClass::setUIComponent(this);
 
-	getPluginManager()->loadAllPlugins();
+	{
+		StartupTiming::ScopedPhase phase("plugin scan");
+		getPluginManager()->loadAllPlugins();
+	}
 
 	getProcessorList()->fillItemList();
 	controlPanel->updateChildComponents();
@@ -388,6 +393,8 @@ PopupMenu UIComponent::getMenuForIndex(int menuIndex, const String& menuName)
 		menu.addCommandItem(commandManager, clearSignalChain);
 		menu.addSeparator();
 		menu.addCommandItem(commandManager, openTimestampSelectionWindow);
+		menu.addCommandItem(commandManager, openRecordSettings);
+		menu.addCommandItem(commandManager, openThreadSettings);
 
 	}
 	else if (menuIndex == 2)
@@ -440,7 +447,9 @@ void UIComponent::getAllCommands(Array <CommandID>& commands)
 		toggleFileInfo,
 		showHelp,
 		resizeWindow,
-		openTimestampSelectionWindow
+		openTimestampSelectionWindow,
+		openRecordSettings,
+		openThreadSettings
 	};
 
 	commands.addArray(ids, numElementsInArray(ids));
@@ -537,6 +546,16 @@ void UIComponent::getCommandInfo(CommandID commandID, ApplicationCommandInfo& re
 			result.setInfo("Reset window bounds", "Reset window bounds", "General", 0);
 			break;
 
+		case openRecordSettings:
+			result.setInfo("Record settings...", "Set the record node options that take effect when acquisition starts.", "General", 0);
+			result.setActive(!acquisitionStarted);
+			break;
+
+		case openThreadSettings:
+			result.setInfo("Thread settings...", "Set the priority, CPUs and NUMA node of the GUI's threads.", "General", 0);
+			result.setActive(!acquisitionStarted);
+			break;
+
 		default:
 			break;
 	};
@@ -654,6 +673,14 @@ bool UIComponent::perform(const InvocationInfo& info)
 			mainWindow->centreWithSize(800, 600);
 			break;
 
+		case openRecordSettings:
+			controlPanel->showRecordSettings();
+			break;
+
+		case openThreadSettings:
+			showThreadSettings();
+			break;
+
 		case openTimestampSelectionWindow:
 			if (timestampWindow == nullptr)
 			{
@@ -712,6 +739,53 @@ void UIComponent::setRecentlyUsedFilenames(const StringArray& filenames)
 	controlPanel->setRecentlyUsedFilenames(filenames);
 }
 
+void UIComponent::showThreadSettings()
+{
+	AlertWindow w("Thread settings",
+		"Priorities go from 0 to 10, or -1 to keep the thread's own. CPUs are lists such as \"0-3,8\", "
+		"empty for any CPU; the NUMA node (-1 for none) is only used on Linux when no CPUs are given. "
+		"The threads pick up the changes the next time acquisition starts.",
+		AlertWindow::NoIcon);
+
+	for (int i = 0; i < ThreadPolicy::NUM_ROLES; i++)
+	{
+		const ThreadPolicy::Role role = ThreadPolicy::Role(i);
+		const ThreadPolicy::RoleSettings settings = ThreadPolicy::getSettings(role);
+		const String name = ThreadPolicy::getRoleName(role);
+		const String label = name.substring(0, 1).toUpperCase() + name.substring(1);
+
+		w.addTextEditor("priority" + String(i), String(settings.priority), label + " priority:");
+		w.addTextEditor("cpus" + String(i), settings.cpus, label + " CPUs:");
+		w.addTextEditor("numaNode" + String(i), String(settings.numaNode), label + " NUMA node:");
+	}
+
+	w.addTextEditor("renderThreads", String(processorGraph->getNumRenderThreads()), "Render threads:");
+
+	StringArray lockOptions;
+	lockOptions.add("No");
+	lockOptions.add("Yes");
+	w.addComboBox("lockedMemory", lockOptions, "Lock buffers in RAM:");
+	w.getComboBoxComponent("lockedMemory")->setSelectedItemIndex(ThreadPolicy::getUseLockedMemory() ? 1 : 0, dontSendNotification);
+
+	w.addButton("OK", 1, KeyPress(KeyPress::returnKey));
+	w.addButton("Cancel", 0, KeyPress(KeyPress::escapeKey));
+
+	if (w.runModalLoop() != 1)
+		return;
+
+	for (int i = 0; i < ThreadPolicy::NUM_ROLES; i++)
+	{
+		ThreadPolicy::RoleSettings settings;
+		settings.priority = w.getTextEditorContents("priority" + String(i)).getIntValue();
+		settings.cpus = w.getTextEditorContents("cpus" + String(i)).trim();
+		settings.numaNode = jmax(-1, w.getTextEditorContents("numaNode" + String(i)).getIntValue());
+		ThreadPolicy::setSettings(ThreadPolicy::Role(i), settings);
+	}
+
+	processorGraph->setNumRenderThreads(jmax(1, w.getTextEditorContents("renderThreads").getIntValue()));
+	ThreadPolicy::setUseLockedMemory(w.getComboBoxComponent("lockedMemory")->getSelectedItemIndex() == 1);
+}
+
 //%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 
 EditorViewportButton::EditorViewportButton(UIComponent* ui) : UI(ui)
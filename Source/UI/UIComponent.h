@@ -172,6 +172,10 @@ private:
     of the MainWindow, or to account for opening/closing events.*/
     void resized();
 
+    /** Opens a dialog with the thread policy of every role, the locked memory option and
+    the number of render threads. They are saved with the window state. */
+    void showThreadSettings();
+
     /** Contains codes for common user commands to which the application must react.*/
     enum CommandIDs
     {
@@ -189,7 +193,9 @@ private:
         resizeWindow            = 0x2012,
         reloadOnStartup         = 0x2013,
         saveConfigurationAs     = 0x2014,
-		openTimestampSelectionWindow = 0x2015
+		openTimestampSelectionWindow = 0x2015,
+		openRecordSettings      = 0x2016,
+		openThreadSettings      = 0x2017
     };
 
     File currentConfigFile;
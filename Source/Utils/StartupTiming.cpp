@@ -0,0 +1,72 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "StartupTiming.h"
+
+int StartupTiming::currentDepth = 0;
+
+Array<StartupTiming::Phase>& StartupTiming::getPhases()
+{
+    static Array<Phase> phases;
+    return phases;
+}
+
+StartupTiming::ScopedPhase::ScopedPhase (const String& name)
+{
+    Phase phase;
+    phase.name = name;
+    phase.depth = currentDepth++;
+    phase.ms = 0;
+
+    // added when started, so a phase is listed before the ones nested in it
+    index = getPhases().size();
+    getPhases().add (phase);
+    startTicks = Time::getHighResolutionTicks();
+}
+
+StartupTiming::ScopedPhase::~ScopedPhase()
+{
+    const double ms = 1000.0 * Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTicks);
+    getPhases().getReference (index).ms = ms;
+    --currentDepth;
+}
+
+void StartupTiming::report (std::ostream& out)
+{
+    Array<Phase>& phases = getPhases();
+    if (phases.size() == 0)
+        return;
+
+    double total = 0;
+    out << "Startup times:" << std::endl;
+    for (int i = 0; i < phases.size(); ++i)
+    {
+        const Phase& phase = phases.getReference (i);
+        out << String::repeatedString ("  ", phase.depth + 1) << phase.name << ": " << String (phase.ms, 1) << " ms" << std::endl;
+        if (phase.depth == 0)
+            total += phase.ms;
+    }
+    out << "  total: " << String (total, 1) << " ms" << std::endl;
+
+    phases.clear();
+}
@@ -0,0 +1,68 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2017 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __STARTUPTIMING_H_
+#define __STARTUPTIMING_H_
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+#include <iostream>
+
+/*
+StartupTiming Class: Records how long each phase of the application start takes, such as
+the plugin scan, the construction of the UI and the loading of the last configuration.
+A phase is timed by a ScopedPhase on the stack; phases started inside another one are
+reported indented under it. Only used from the message thread while starting up.
+*/
+class StartupTiming
+{
+public:
+    class ScopedPhase
+    {
+    public:
+        explicit ScopedPhase (const String& name);
+        ~ScopedPhase();
+
+    private:
+        int index;
+        int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedPhase);
+    };
+
+    /** Prints every phase recorded so far, in the order they started, and clears them */
+    static void report (std::ostream& out);
+
+private:
+    struct Phase
+    {
+        String name;
+        int depth;
+        double ms;
+    };
+
+    static Array<Phase>& getPhases();
+    static int currentDepth;
+};
+
+
+#endif  //__STARTUPTIMING_H_
@@ -0,0 +1,203 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "XmlSnapshot.h"
+
+namespace
+{
+    const char snapshotMagic[8] = { 'O', 'E', 'S', 'N', 'A', 'P', 0, 1 };
+}
+
+const char* const XmlSnapshot::fileExtension = ".oesnap";
+
+
+class XmlSnapshot::Writer
+{
+public:
+    explicit Writer (OutputStream& s) : out (s) {}
+
+    void writeElement (const XmlElement& e)
+    {
+        // text elements have no tag, only their text
+        if (e.isTextElement())
+        {
+            writeString (String::empty);
+            writeString (e.getText());
+            return;
+        }
+
+        writeString (e.getTagName());
+
+        const int numAttributes = e.getNumAttributes();
+        out.writeCompressedInt (numAttributes);
+        for (int i = 0; i < numAttributes; ++i)
+        {
+            writeString (e.getAttributeName (i));
+            writeString (e.getAttributeValue (i));
+        }
+
+        out.writeCompressedInt (e.getNumChildElements());
+        forEachXmlChildElement (e, child)
+            writeElement (*child);
+    }
+
+private:
+    /** Strings are written the first time they are seen, then by index + 1 */
+    void writeString (const String& s)
+    {
+        if (s.isEmpty())
+        {
+            out.writeCompressedInt (0);
+            return;
+        }
+
+        const int index = strings.contains (s) ? strings[s] : -1;
+        if (index >= 0)
+        {
+            out.writeCompressedInt (index + 2);
+        }
+        else
+        {
+            out.writeCompressedInt (1);
+            out.writeString (s);
+            strings.set (s, strings.size());
+        }
+    }
+
+    OutputStream& out;
+    HashMap<String, int> strings;
+};
+
+
+class XmlSnapshot::Reader
+{
+public:
+    explicit Reader (InputStream& s) : in (s) {}
+
+    XmlElement* readElement (int depth)
+    {
+        String tag;
+        if (depth > 256 || ! readString (tag))
+            return nullptr;
+
+        if (tag.isEmpty())
+        {
+            String text;
+            return readString (text) ? XmlElement::createTextElement (text) : nullptr;
+        }
+
+        ScopedPointer<XmlElement> e = new XmlElement (tag);
+
+        const int numAttributes = in.readCompressedInt();
+        for (int i = 0; i < numAttributes; ++i)
+        {
+            String name, value;
+            if (! readString (name) || ! readString (value) || name.isEmpty())
+                return nullptr;
+            e->setAttribute (name, value);
+        }
+
+        const int numChildren = in.readCompressedInt();
+        for (int i = 0; i < numChildren; ++i)
+        {
+            XmlElement* child = readElement (depth + 1);
+            if (child == nullptr)
+                return nullptr;
+            e->addChildElement (child);
+        }
+
+        return e.release();
+    }
+
+private:
+    bool readString (String& s)
+    {
+        if (in.isExhausted())
+            return false;
+
+        const int index = in.readCompressedInt();
+        if (index == 0)
+        {
+            s = String::empty;
+        }
+        else if (index == 1)
+        {
+            s = in.readString();
+            strings.add (s);
+        }
+        else if (index - 2 < strings.size())
+        {
+            s = strings[index - 2];
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    InputStream& in;
+    StringArray strings;
+};
+
+
+bool XmlSnapshot::isSnapshot (const File& file)
+{
+    FileInputStream in (file);
+    char magic[sizeof (snapshotMagic)];
+
+    return ! in.failedToOpen()
+        && in.read (magic, sizeof (magic)) == sizeof (magic)
+        && memcmp (magic, snapshotMagic, sizeof (magic)) == 0;
+}
+
+
+XmlElement* XmlSnapshot::read (const File& file)
+{
+    if (! isSnapshot (file))
+        return nullptr;
+
+    // the whole file is read at once, as small stream reads are slow on network shares
+    MemoryBlock data;
+    if (! file.loadFileAsData (data))
+        return nullptr;
+
+    MemoryInputStream in (data, false);
+    in.skipNextBytes (sizeof (snapshotMagic));
+
+    return Reader (in).readElement (0);
+}
+
+
+bool XmlSnapshot::write (const XmlElement& xml, const File& file)
+{
+    MemoryOutputStream data;
+    data.write (snapshotMagic, sizeof (snapshotMagic));
+    Writer (data).writeElement (xml);
+
+    TemporaryFile temp (file);
+    if (! temp.getFile().replaceWithData (data.getData(), data.getDataSize()))
+        return false;
+
+    return temp.overwriteTargetFileWithTemporary();
+}
@@ -0,0 +1,56 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __XMLSNAPSHOT_H_
+#define __XMLSNAPSHOT_H_
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+
+/*
+XmlSnapshot Class: Stores an XmlElement tree, such as a saved signal chain, in a compact
+binary form that loads without any text parsing. Every tag, attribute name and value is
+written once and later referred to by its index, so the repeated per-channel elements of
+large chains cost a few bytes each.
+Files are recognized by their first bytes, so a snapshot can be loaded whatever its name.
+*/
+class XmlSnapshot
+{
+public:
+    /** Extension used for snapshots, XML is written for any other */
+    static const char* const fileExtension;
+
+    static bool isSnapshot (const File& file);
+
+    /** Returns nullptr if the file is not a valid snapshot. The caller owns the element. */
+    static XmlElement* read (const File& file);
+
+    static bool write (const XmlElement& xml, const File& file);
+
+private:
+    class Writer;
+    class Reader;
+};
+
+
+
+#endif  //__XMLSNAPSHOT_H_